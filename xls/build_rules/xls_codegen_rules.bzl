@@ -250,7 +250,7 @@ def validate_verilog_filename(verilog_filename, use_system_verilog):
         fail("Verilog filename must contain the '%s' extension." %
              _VERILOG_FILE_EXTENSION)
 
-def xls_ir_verilog_impl(ctx, src, conv_info):
+def xls_ir_verilog_impl(ctx, src, conv_info, flow = None):
     """The core implementation of the 'xls_ir_verilog' rule.
 
     Generates a Verilog file, module signature file, block file, Verilog line
@@ -260,6 +260,10 @@ def xls_ir_verilog_impl(ctx, src, conv_info):
       ctx: The current rule's context object.
       src: The source file.
       conv_info: The ConvIrInfo for the source containing original input files and any interface proto.
+      flow: Optional struct collecting the stages of a dslx_to_verilog_main
+        action, to which the code generation is added instead of creating an
+        action. `src` and `conv_info` must then come from the same flow, as
+        the IR and interface are passed to code generation in memory.
 
     Returns:
       A tuple with the following elements in the order presented:
@@ -269,7 +273,7 @@ def xls_ir_verilog_impl(ctx, src, conv_info):
     """
     codegen_tool = ctx.executable._xls_codegen_tool
     my_generated_files = []
-    runfiles_list = [src.ir_file] + conv_info.original_input_files
+    runfiles_list = ([src.ir_file] if flow == None else []) + conv_info.original_input_files
 
     # default arguments
     if ctx.file.codegen_options_proto == None:
@@ -296,8 +300,11 @@ def xls_ir_verilog_impl(ctx, src, conv_info):
         # Mixing proto options and normal ones is not supported. If proto
         # options are being used the user will need to have put the interface
         # proto in manually.
-        final_args += " --ir_interface_proto={}".format(conv_info.ir_interface.path)
-        runfiles_list.append(conv_info.ir_interface)
+        if flow != None:
+            final_args += " --codegen_use_ir_interface=true"
+        else:
+            final_args += " --ir_interface_proto={}".format(conv_info.ir_interface.path)
+            runfiles_list.append(conv_info.ir_interface)
 
     uses_fdo = _uses_fdo(codegen_args)
     if (uses_fdo):
@@ -405,20 +412,26 @@ def xls_ir_verilog_impl(ctx, src, conv_info):
         sched_config_textproto_file.path,
     )
 
-    ctx.actions.run_shell(
-        outputs = my_generated_files,
-        tools = tools,
-        inputs = runfiles.files,
-        command = "{} {} {} 2>&1 | tee {}".format(
-            codegen_tool.path,
-            src.ir_file.path,
-            final_args,
-            log_file.path,
-        ),
-        mnemonic = "GenerateVerilog",
-        progress_message = "Compiling %s" % verilog_file.short_path,
-        toolchain = None,
-    )
+    if flow != None:
+        flow.shell_args.append(final_args)
+        flow.outputs.extend(my_generated_files)
+        flow.log_files.append(log_file)
+        flow.inputs.append(runfiles.files)
+    else:
+        ctx.actions.run_shell(
+            outputs = my_generated_files,
+            tools = tools,
+            inputs = runfiles.files,
+            command = "{} {} {} 2>&1 | tee {}".format(
+                codegen_tool.path,
+                src.ir_file.path,
+                final_args,
+                log_file.path,
+            ),
+            mnemonic = "GenerateVerilog",
+            progress_message = "Compiling %s" % verilog_file.short_path,
+            toolchain = None,
+        )
 
     # Set top to match module_name if it is set
     if "module_name" in codegen_args:
@@ -102,12 +102,16 @@ def _get_dslx_test_cmdline(ctx, src, all_srcs, append_cmd_line_args = True):
 
     DSLX_TEST_FLAGS = (
         "compare",
+        "compare_sample_rate",
+        "compare_batch_size",
         "dslx_path",
         "warnings_as_errors",
         "disable_warnings",
         "enable_warnings",
         "max_ticks",
         "format_preference",
+        "quickcheck_threads",
+        "jobs",
     )
 
     dslx_test_args = dict(_dslx_test_args)
@@ -735,6 +739,9 @@ def _xls_dslx_generate_cpp_type_files_impl(ctx):
     if ctx.attr.namespace:
         my_args.add("--namespaces={}".format(ctx.attr.namespace))
 
+    if ctx.attr.native_views:
+        my_args.add("--native_views")
+
     ctx.actions.run(
         outputs = [cc_file, h_file],
         tools = [cpp_transpiler_tool],
@@ -759,6 +766,11 @@ def _xls_dslx_generate_cpp_type_files_impl(ctx):
 
 xls_dslx_generate_cpp_type_files_attrs = {
     "namespace": attr.string(doc = "The C++ namespace to generate the code in (e.g., `foo::bar`)."),
+    "native_views": attr.bool(
+        doc = "Whether to also emit views of the generated structs which " +
+              "access values held in the native layout of the JIT in place.",
+        default = False,
+    ),
     "source_file": attr.output(
         doc = "The filename of the generated source file. The filename must " +
               "have a '" + _CC_FILE_EXTENSION + "' extension.",
@@ -117,7 +117,18 @@ def get_xls_ir_opt_ir_generated_files(args):
     """
     return [args.get("opt_ir_file")]
 
-def _convert_to_ir(ctx, src):
+# Flags of the IR converter and optimizer which are renamed in the
+# dslx_to_verilog_main tool, as their names are taken by codegen flags there.
+_FLOW_IR_CONV_FLAG_NAMES = {
+    "top": "dslx_top",
+}
+
+_FLOW_IR_OPT_FLAG_NAMES = {
+    "top": "opt_top",
+    "opt_level": "ir_opt_level",
+}
+
+def _convert_to_ir(ctx, src, flow = None):
     """Returns the runfiles and a File referencing the converted IR file.
 
     Creates an action in the context to convert a DSLX source file to an
@@ -126,6 +137,10 @@ def _convert_to_ir(ctx, src):
     Args:
       ctx: The current rule's context object.
       src: The source file.
+      flow: If set, no action is created. Instead the arguments, inputs and
+        outputs of the conversion are added to this struct (see
+        _new_xls_flow in xls_rules.bzl), to be run as part of a single
+        dslx_to_verilog_main action.
     Returns:
       A tuple with the following elements in the order presented:
         1. The runfiles to convert the IR file.
@@ -140,6 +155,8 @@ def _convert_to_ir(ctx, src):
         "disable_warnings",
         "convert_tests",
         "default_fifo_config",
+        "conversion_threads",
+        "lazy_typecheck",
     )
 
     # With runs outside a monorepo, the execution root for the workspace of
@@ -165,11 +182,12 @@ def _convert_to_ir(ctx, src):
     is_args_valid(ir_conv_args, IR_CONV_FLAGS)
 
     ir_conv_args["top"] = ctx.attr.dslx_top
-    my_args = ctx.actions.args()
+    flag_names = _FLOW_IR_CONV_FLAG_NAMES if flow != None else {}
+    my_args = flow.arguments if flow != None else ctx.actions.args()
     for flag, value in ir_conv_args.items():
         # NB Using format because some of the values are 'true/false' which
         # don't mix well with short-flags.
-        my_args.add("--{}={}".format(flag, value))
+        my_args.add("--{}={}".format(flag_names.get(flag, flag), value))
 
     ir_filename = get_output_filename_value(
         ctx,
@@ -179,12 +197,17 @@ def _convert_to_ir(ctx, src):
     ir_file = ctx.actions.declare_file(ir_filename)
     interface_proto = ctx.actions.declare_file(ctx.attr.name + ".interface.binpb")
     my_args.add("-interface_proto_file", interface_proto.path)
-    my_args.add("-output_file", ir_file.path)
+    my_args.add("-output_ir_path" if flow != None else "-output_file", ir_file.path)
     my_args.add(src.path)
 
     # Get runfiles
     runfiles = get_runfiles_for_xls(ctx, [], [src])
 
+    if flow != None:
+        flow.outputs.extend([ir_file, interface_proto])
+        flow.inputs.append(runfiles.files)
+        return runfiles, ir_file, interface_proto
+
     ctx.actions.run(
         outputs = [ir_file, interface_proto],
         # The IR converter executable is a tool needed by the action.
@@ -199,7 +222,7 @@ def _convert_to_ir(ctx, src):
     )
     return runfiles, ir_file, interface_proto
 
-def _optimize_ir(ctx, src, original_input_files):
+def _optimize_ir(ctx, src, original_input_files, flow = None):
     """Returns the runfiles and a File referencing the optimized IR file.
 
     Creates an action in the context to optimize an IR file.
@@ -208,6 +231,9 @@ def _optimize_ir(ctx, src, original_input_files):
       ctx: The current rule's context object.
       src: The source file.
       original_input_files: All original source files that produced this IR file (used for errors).
+      flow: If set, the optimization is added to this struct instead of
+        creating an action; see _convert_to_ir. `src` must then be the IR
+        converted in the same flow.
     Returns:
       A tuple with the following elements in the order presented:
         1. The runfiles to optimize the IR file.
@@ -232,13 +258,16 @@ def _optimize_ir(ctx, src, original_input_files):
     if ctx.attr.top:
         opt_ir_args.setdefault("top", ctx.attr.top)
 
-    args = ctx.actions.args()
-    args.add(src.ir_file)
+    flag_names = _FLOW_IR_OPT_FLAG_NAMES if flow != None else {}
+    args = flow.arguments if flow != None else ctx.actions.args()
+    if flow == None:
+        # In a flow the IR is passed to the optimizer in memory.
+        args.add(src.ir_file)
 
     for flag, value in opt_ir_args.items():
         # Need to handle that some flag values are things like 'true' and
         # 'false' that need to be handled carefully.
-        args.add("--{}={}".format(flag, value))
+        args.add("--{}={}".format(flag_names.get(flag, flag), value))
 
     if ctx.attr.ram_rewrites:
         ram_rewrites = []
@@ -252,7 +281,7 @@ def _optimize_ir(ctx, src, original_input_files):
         ctx.attr.name + _OPT_IR_FILE_EXTENSION,
     )
     opt_ir_file = ctx.actions.declare_file(opt_ir_filename)
-    args.add("--output_path", opt_ir_file)
+    args.add("--output_opt_ir_path" if flow != None else "--output_path", opt_ir_file)
 
     # Get runfiles
     ram_rewrite_files = []
@@ -269,7 +298,13 @@ def _optimize_ir(ctx, src, original_input_files):
         ctx.attr.name + _OPT_LOG_FILE_EXTENSION,
     )
     log_file = ctx.actions.declare_file(opt_log_filename)
-    args.add("--alsologto", log_file)
+    args.add("--opt_log_path" if flow != None else "--alsologto", log_file)
+
+    if flow != None:
+        runfiles = get_runfiles_for_xls(ctx, [], ram_rewrite_files + debug_src_files + original_input_files)
+        flow.outputs.extend([opt_ir_file, log_file])
+        flow.inputs.append(runfiles.files)
+        return runfiles, opt_ir_file
 
     runfiles = get_runfiles_for_xls(ctx, [], [src.ir_file] + ram_rewrite_files + debug_src_files + original_input_files)
     ctx.actions.run(
@@ -312,6 +347,8 @@ def get_ir_equivalence_test_cmd(
     IR_EQUIVALENCE_FLAGS = (
         "timeout",
         "activation_count",
+        "portfolio",
+        "partition_output_bits",
     )
 
     ir_equivalence_args = dict(ctx.attr.ir_equivalence_args)
@@ -601,13 +638,16 @@ xls_dslx_ir_attrs = dicts.add(
     },
 )
 
-def xls_dslx_ir_impl(ctx):
+def xls_dslx_ir_impl(ctx, flow = None):
     """The implementation of the 'xls_dslx_ir' rule.
 
     Converts a DSLX source file to an IR file.
 
     Args:
       ctx: The current rule's context object.
+      flow: Optional struct collecting the stages of a dslx_to_verilog_main
+        action, to which the conversion is added instead of creating an
+        action. See _convert_to_ir.
 
     Returns:
       A tuple with the following elements in the order presented:
@@ -624,7 +664,7 @@ def xls_dslx_ir_impl(ctx):
 
     src = srcs[0]
 
-    runfiles, ir_file, interface_proto = _convert_to_ir(ctx, src)
+    runfiles, ir_file, interface_proto = _convert_to_ir(ctx, src, flow)
 
     dslx_info = get_DslxInfo_from_dslx_library_as_input(ctx)
     return [
@@ -691,7 +731,7 @@ An IR conversion with a top entity defined.
     ),
 )
 
-def xls_ir_opt_ir_impl(ctx, src, original_input_files):
+def xls_ir_opt_ir_impl(ctx, src, original_input_files, flow = None):
     """The implementation of the 'xls_ir_opt_ir' rule.
 
     Optimizes an IR file.
@@ -700,6 +740,9 @@ def xls_ir_opt_ir_impl(ctx, src, original_input_files):
       ctx: The current rule's context object.
       src: The source IrFileInfo.
       original_input_files: All original source files that produced this IR file (used for errors).
+      flow: Optional struct collecting the stages of a dslx_to_verilog_main
+        action, to which the optimization is added instead of creating an
+        action. See _optimize_ir.
 
     Returns:
       A tuple with the following elements in the order presented:
@@ -708,7 +751,7 @@ def xls_ir_opt_ir_impl(ctx, src, original_input_files):
         1. The list of built files.
         1. The runfiles.
     """
-    runfiles, opt_ir_file = _optimize_ir(ctx, src, original_input_files)
+    runfiles, opt_ir_file = _optimize_ir(ctx, src, original_input_files, flow)
     return [
         IrFileInfo(ir_file = opt_ir_file),
         OptIrArgInfo(
@@ -381,7 +381,8 @@ def xls_dslx_cpp_type_library(
         name,
         src,
         deps = [],
-        namespace = None):
+        namespace = None,
+        native_views = False):
     """Creates a cc_library target for transpiled DSLX types.
 
     This macros invokes the DSLX-to-C++ transpiler and compiles the result as
@@ -391,6 +392,8 @@ def xls_dslx_cpp_type_library(
       name: The name of the eventual cc_library.
       src: The DSLX file whose types to compile as C++.
       namespace: The C++ namespace to generate the code in (e.g., `foo::bar`).
+      native_views: Whether to also emit views of the generated structs which
+        access values held in the native layout of the JIT in place.
     """
     xls_dslx_generate_cpp_type_files(
         name = name + "_generate_sources",
@@ -399,6 +402,7 @@ def xls_dslx_cpp_type_library(
         header_file = name + ".h",
         deps = deps,
         namespace = namespace,
+        native_views = native_views,
     )
 
     native.cc_library(
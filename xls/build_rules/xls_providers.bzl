@@ -124,10 +124,16 @@ CODEGEN_FIELDS = {
     "emit_sv_types": "Whether or not to honor the #[sv_type(NAME)] annotations in the source DSLX.",
     "codegen_version": "Version of codegen to use (0=default).",
     "materialize_internal_fifos": "Whether or not to materialize internal fifos directly in Verilog.",
+    "pack_pipeline_registers": "Whether or not to pack the values carried between pipeline " +
+                               "stages into a single register per stage.",
     "randomize_order_seed": "If present, the seed used to randomize the order of lines in the " +
                             "output, as a comma-separated list of one or more 32-bit integers. " +
                             "If empty, will use a default order. This can be useful for creating " +
                             "multiple equivalent Verilog outputs to exercise a synthesis pipeline.",
+    "codegen_threads": "Number of threads used to generate the Verilog modules of the blocks " +
+                       "of a design concurrently.",
+    "bill_of_materials_limit": "Maximum number of entries in the bill of materials of the " +
+                               "block metrics. Negative values do not limit it.",
 }
 
 SCHEDULING_FIELDS = {
@@ -161,6 +167,13 @@ SCHEDULING_FIELDS = {
                              "(full throughput).\n" +
                              "\n" +
                              "If zero or negative, no throughput bound will be enforced.",
+    "modulo_resource_sharing": "If true, schedule operations modulo the worst-case " +
+                               "throughput so that operations which `--area_model` " +
+                               "deems more expensive than the muxes needed to share " +
+                               "them never need more instances than the initiation " +
+                               "interval requires.",
+    "area_model": "Area model used to pick the operations to share with " +
+                  "`--modulo_resource_sharing`.",
     "additional_input_delay_ps": "The additional delay added to each input. Note that " +
                                  "flow-controlled channel operations all have inputs and " +
                                  "outputs, so this delay is added to sends and receives.",
@@ -197,7 +210,13 @@ SCHEDULING_FIELDS = {
     "fdo_synthesis_libraries": "Synthesis and STA libraries.",
     "fdo_default_driver_cell": "Cell to assume is driving primary inputs.",
     "fdo_default_load": "Cell to assume is being driven by primary outputs.",
+    "fdo_synthesis_workers": "Maximum number of concurrent FDO synthesis jobs.",
     "multi_proc": "If true, schedule all procs and codegen them all.",
+    "scheduling_threads": "Number of threads to use to schedule independent " +
+                          "procs and functions concurrently.",
+    "clock_search_threads": "Number of candidate clock periods to check in " +
+                            "parallel when searching for the minimum " +
+                            "feasible clock period.",
     "simulation_macro_name": "Name of the Verilog macro used to guard simulation-only " +
                              "constructs. If prefixed with `!` the polarity of the guard " +
                              "is inverted.",
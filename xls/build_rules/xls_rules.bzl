@@ -64,13 +64,67 @@ _xls_dslx_opt_ir_attrs = dicts.add(
     xls_toolchain_attrs,
 )
 
-def _xls_dslx_opt_ir_impl(ctx):
+def _new_xls_flow(ctx):
+    """Returns a struct collecting the stages of a dslx_to_verilog_main action.
+
+    Passing the struct as the 'flow' argument of xls_dslx_ir_impl,
+    xls_ir_opt_ir_impl and xls_ir_verilog_impl declares the outputs of each
+    stage without creating its action. _run_xls_flow then creates a single
+    action running all the stages in one process, which hands the IR from stage
+    to stage in memory instead of writing and re-parsing it.
+
+    Args:
+      ctx: The current rule's context object.
+
+    Returns:
+      A struct with the following fields:
+        arguments: The Args of the tool.
+        shell_args: Arguments of the tool which are expanded by the shell.
+        inputs: A list of depsets of input files.
+        outputs: A list of the output files.
+        log_files: The files to which the output of the tool is written.
+    """
+    return struct(
+        arguments = ctx.actions.args(),
+        shell_args = [],
+        inputs = [],
+        outputs = [],
+        log_files = [],
+    )
+
+def _run_xls_flow(ctx, flow, progress_message):
+    """Creates the action running the stages collected in a flow.
+
+    Args:
+      ctx: The current rule's context object.
+      flow: The struct returned by _new_xls_flow.
+      progress_message: The progress message of the action.
+    """
+    flow_tool = ctx.executable._xls_dslx_verilog_tool
+    ctx.actions.run_shell(
+        outputs = flow.outputs,
+        tools = [flow_tool],
+        inputs = depset(transitive = flow.inputs),
+        arguments = [flow.arguments],
+        command = "set -o pipefail; {} \"$@\" {} 2>&1 | tee {}".format(
+            flow_tool.path,
+            " ".join(flow.shell_args),
+            " ".join([log_file.path for log_file in flow.log_files]),
+        ),
+        mnemonic = "DslxToVerilog",
+        progress_message = progress_message,
+        toolchain = None,
+    )
+
+def _xls_dslx_opt_ir_impl(ctx, flow = None):
     """The implementation of the 'xls_dslx_opt_ir' rule.
 
     Converts a DSLX file to an IR and optimizes the IR.
 
     Args:
       ctx: The current rule's context object.
+      flow: Optional struct returned by _new_xls_flow to which the stages are
+        added instead of creating their actions.
     Returns:
       A tuple with the following elements in the order presented:
         1. The IrFileInfo of the resulting opt ir.
@@ -81,12 +135,13 @@ def _xls_dslx_opt_ir_impl(ctx):
         1. The runfiles.
     """
     dslx_conv_result_ir, dslx_info, ir_conv_info, ir_built_files, ir_runfiles = (
-        xls_dslx_ir_impl(ctx)
+        xls_dslx_ir_impl(ctx, flow)
     )
     opt_result_ir, ir_opt_info, opt_ir_built_files, opt_ir_runfiles = xls_ir_opt_ir_impl(
         ctx,
         dslx_conv_result_ir,
         ir_conv_info.original_input_files,
+        flow,
     )
     return [
         opt_result_ir,
@@ -280,7 +335,8 @@ def _xls_dslx_verilog_impl(ctx):
     """The implementation of the 'xls_dslx_verilog' rule.
 
     Converts a DSLX file to an IR, optimizes the IR, and generates a verilog
-    file from the optimized IR.
+    file from the optimized IR. With the 'single_action' attribute set, the
+    three stages are run by one dslx_to_verilog_main action.
 
     Args:
       ctx: The current rule's context object.
@@ -291,6 +347,7 @@ def _xls_dslx_verilog_impl(ctx):
       CodegenInfo provider.
       DefaultInfo provider.
     """
+    flow = _new_xls_flow(ctx) if ctx.attr.single_action else None
     (
         ir_result,
         dslx_info,
@@ -298,12 +355,19 @@ def _xls_dslx_verilog_impl(ctx):
         ir_opt_info,
         built_files,
         runfiles,
-    ) = _xls_dslx_opt_ir_impl(ctx)
+    ) = _xls_dslx_opt_ir_impl(ctx, flow)
     codegen_info, verilog_built_files, verilog_runfiles = xls_ir_verilog_impl(
         ctx,
         ir_result,
         ir_conv_info,
+        flow,
     )
+    if flow != None:
+        _run_xls_flow(
+            ctx,
+            flow,
+            "Compiling DSLX file to Verilog: %s" % codegen_info.verilog_file.short_path,
+        )
     return [
         dslx_info,
         ir_conv_info,
@@ -322,6 +386,16 @@ _dslx_verilog_attrs = dicts.add(
     xls_dslx_ir_attrs,
     xls_ir_opt_ir_attrs,
     xls_ir_verilog_attrs,
+    {
+        "single_action": attr.bool(
+            doc = "If true, the IR conversion, optimization and code " +
+                  "generation run in a single action of the " +
+                  "//xls/tools:dslx_to_verilog_main tool, which passes the " +
+                  "IR between the stages in memory instead of writing and " +
+                  "re-parsing it. The same files are generated.",
+            default = False,
+        ),
+    },
     CONFIG["xls_outs_attrs"],
     xls_toolchain_attrs,
 )
@@ -345,6 +419,21 @@ Examples:
         dslx_top = "d",
     )
     ```
+
+1. Running all the stages in a single action.
+
+    ```
+    xls_dslx_verilog(
+        name = "d_verilog",
+        srcs = ["d.x"],
+        deps = [":bc_dslx"],
+        codegen_args = {
+            "pipeline_stages": "1",
+        },
+        dslx_top = "d",
+        single_action = True,
+    )
+    ```
     """,
     implementation = _xls_dslx_verilog_impl,
     attrs = _dslx_verilog_attrs,
@@ -43,6 +43,8 @@ _DEFAULT_BENCHMARK_CODEGEN_TARGET = "//xls/dev_tools:benchmark_codegen_main"
 
 _DEFAULT_CODEGEN_TARGET = "//xls/tools:codegen_main"
 
+_DEFAULT_DSLX_VERILOG_TARGET = "//xls/tools:dslx_to_verilog_main"
+
 _DEFAULT_JIT_WRAPPER_TARGET = "//xls/jit:jit_wrapper_generator_main"
 
 _DEFAULT_CPP_TRANSPILER_TARGET = "//xls/dslx/cpp_transpiler:cpp_transpiler_main"
@@ -138,6 +140,14 @@ xls_toolchain_attrs = {
         executable = True,
         cfg = "exec",
     ),
+    "_xls_dslx_verilog_tool": attr.label(
+        doc = "The target of the executable running the IR conversion, IR " +
+              "optimization and codegen in a single process.",
+        default = Label(_DEFAULT_DSLX_VERILOG_TARGET),
+        allow_single_file = True,
+        executable = True,
+        cfg = "exec",
+    ),
     "_xls_jit_wrapper_tool": attr.label(
         doc = "The target of the JIT wrapper executable.",
         default = Label(_DEFAULT_JIT_WRAPPER_TARGET),
@@ -156,6 +166,7 @@ def _xls_toolchain_impl(ctx):
         ctx.attr._xls_codegen_tool,
         ctx.attr._xls_cpp_transpiler_tool,
         ctx.attr._xls_dslx_interpreter_tool,
+        ctx.attr._xls_dslx_verilog_tool,
         ctx.attr._xls_jit_wrapper_tool,
         ctx.attr._xls_ir_converter_tool,
         ctx.attr._xls_ir_equivalence_tool,
@@ -16,17 +16,31 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/union_find.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/function.h"
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/proc.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/passes/bdd_function.h"
 #include "xls/passes/bdd_query_engine.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "z3/src/api/z3_api.h"
 
 namespace xls {
 
@@ -48,9 +62,216 @@ bool UseNodeInBddEngine(const Node* node) {
          node->Is<CompareOp>();
 }
 
+// Whether `node` is a leaf of the cone of a predicate, i.e., has a value which
+// is left unknown rather than computed from its operands: parameters, state,
+// side-effecting operations such as receives, and calls of other functions.
+bool IsConeLeaf(const Node* node) {
+  return node->Is<Param>() || node->Is<StateRead>() ||
+         OpIsSideEffecting(node->op()) || node->Is<Invoke>() ||
+         node->Is<Map>() || node->Is<CountedFor>() ||
+         node->Is<DynamicCountedFor>();
+}
+
+// A group of send predicates whose cones share nodes. Predicates in different
+// clusters depend on disjoint sets of unknowns, so they are independent.
+struct PredicateCluster {
+  std::vector<Node*> predicates;
+  // The union of the cones of `predicates`, in no particular order.
+  std::vector<Node*> cone;
+};
+
+// Partitions `predicates` into clusters, in order of their first predicate.
+std::vector<PredicateCluster> ClusterPredicates(
+    absl::Span<Node* const> predicates) {
+  // The first predicate whose cone reached each node.
+  absl::flat_hash_map<Node*, int64_t> owner;
+  UnionFind<int64_t> clusters;
+  std::vector<Node*> stack;
+  for (int64_t i = 0; i < predicates.size(); ++i) {
+    clusters.Insert(i);
+    stack.push_back(predicates[i]);
+    while (!stack.empty()) {
+      Node* node = stack.back();
+      stack.pop_back();
+      auto [it, inserted] = owner.insert({node, i});
+      if (!inserted) {
+        // The rest of this node's cone was already visited from here or from
+        // the predicate which owns it.
+        clusters.Union(i, it->second);
+        continue;
+      }
+      if (!IsConeLeaf(node)) {
+        stack.insert(stack.end(), node->operands().begin(),
+                     node->operands().end());
+      }
+    }
+  }
+
+  absl::flat_hash_map<int64_t, int64_t> cluster_index;
+  std::vector<PredicateCluster> result;
+  for (int64_t i = 0; i < predicates.size(); ++i) {
+    auto [it, inserted] =
+        cluster_index.insert({clusters.Find(i), result.size()});
+    if (inserted) {
+      result.emplace_back();
+    }
+    result[it->second].predicates.push_back(predicates[i]);
+  }
+  for (const auto& [node, i] : owner) {
+    result[cluster_index.at(clusters.Find(i))].cone.push_back(node);
+  }
+  return result;
+}
+
+// A BDD of a copy of the cones of a predicate cluster, which answers every
+// query about the cluster's predicates. The leaves of the cones become
+// parameters of the copy.
+class ConeBdd {
+ public:
+  static absl::StatusOr<std::unique_ptr<ConeBdd>> Create(
+      const PredicateCluster& cluster,
+      const absl::flat_hash_map<Node*, int64_t>& topo_index,
+      int64_t path_limit) {
+    auto cone_bdd = absl::WrapUnique(new ConeBdd());
+    XLS_RETURN_IF_ERROR(cone_bdd->Build(cluster, topo_index, path_limit));
+    return cone_bdd;
+  }
+
+  absl::Span<Node* const> predicates() const { return predicates_; }
+  const BddQueryEngine& query_engine() const { return *query_engine_; }
+
+  // Returns a Z3 translation of the copy, translating it on first use.
+  absl::StatusOr<solvers::z3::IrTranslator*> GetTranslator() {
+    if (translator_ == nullptr) {
+      XLS_ASSIGN_OR_RETURN(translator_,
+                           solvers::z3::IrTranslator::CreateAndTranslate(
+                               function_, /*allow_unsupported=*/true));
+    }
+    return translator_.get();
+  }
+
+ private:
+  ConeBdd() : package_("bdd_io_analysis_cone") {}
+
+  absl::Status Build(const PredicateCluster& cluster,
+                     const absl::flat_hash_map<Node*, int64_t>& topo_index,
+                     int64_t path_limit) {
+    function_ = package_.AddFunction(
+        std::make_unique<Function>("predicate_cones", &package_));
+    std::vector<Node*> cone = cluster.cone;
+    std::sort(cone.begin(), cone.end(), [&](Node* a, Node* b) {
+      return topo_index.at(a) < topo_index.at(b);
+    });
+    absl::flat_hash_map<Node*, Node*> copies;
+    std::vector<Node*> operands;
+    for (Node* node : cone) {
+      if (IsConeLeaf(node)) {
+        XLS_ASSIGN_OR_RETURN(Type * type,
+                             package_.MapTypeFromOtherPackage(node->GetType()));
+        XLS_ASSIGN_OR_RETURN(copies[node], function_->MakeNodeWithName<Param>(
+                                               node->loc(), type,
+                                               node->GetName()));
+        continue;
+      }
+      operands.clear();
+      for (Node* operand : node->operands()) {
+        operands.push_back(copies.at(operand));
+      }
+      XLS_ASSIGN_OR_RETURN(copies[node],
+                           node->CloneInNewFunction(operands, function_));
+    }
+    for (Node* predicate : cluster.predicates) {
+      predicates_.push_back(copies.at(predicate));
+    }
+    XLS_RETURN_IF_ERROR(function_->set_return_value(predicates_.front()));
+
+    query_engine_ =
+        std::make_unique<BddQueryEngine>(path_limit, UseNodeInBddEngine);
+    return query_engine_->Populate(function_).status();
+  }
+
+  Package package_;
+  Function* function_ = nullptr;
+  std::vector<Node*> predicates_;
+  std::unique_ptr<BddQueryEngine> query_engine_;
+  std::unique_ptr<solvers::z3::IrTranslator> translator_;
+};
+
+// Returns whether Z3 proves the single-bit `condition` unsatisfiable.
+absl::StatusOr<bool> Z3ProvesUnsatisfiable(
+    solvers::z3::IrTranslator* translator, Z3_ast condition, int64_t rlimit) {
+  Z3_context ctx = translator->ctx();
+  solvers::z3::ScopedErrorHandler seh(ctx);
+  translator->SetRlimit(rlimit);
+  Z3_solver solver = solvers::z3::CreateSolver(ctx, 1);
+  Z3_solver_assert(ctx, solver,
+                   solvers::z3::BitVectorToBoolean(ctx, condition));
+  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
+  Z3_solver_dec_ref(ctx, solver);
+  XLS_RETURN_IF_ERROR(seh.status());
+  return satisfiable == Z3_L_FALSE;
+}
+
+// Returns whether at most one predicate of `cone_bdd` can be true at a time.
+absl::StatusOr<bool> AtMostOnePredicateTrue(
+    ConeBdd& cone_bdd, const StreamingOutputExclusivityOptions& options) {
+  absl::Span<Node* const> predicates = cone_bdd.predicates();
+  if (cone_bdd.query_engine().AtMostOneNodeTrue(predicates)) {
+    return true;
+  }
+  if (!options.z3_rlimit.has_value()) {
+    return false;
+  }
+  // Only the pairs which the BDD cannot tell apart are left to Z3.
+  for (int64_t i = 0; i < predicates.size(); ++i) {
+    for (int64_t j = i + 1; j < predicates.size(); ++j) {
+      if (cone_bdd.query_engine().AtMostOneNodeTrue(
+              {predicates[i], predicates[j]})) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(solvers::z3::IrTranslator * translator,
+                           cone_bdd.GetTranslator());
+      Z3_ast both = Z3_mk_bvand(translator->ctx(),
+                                translator->GetTranslation(predicates[i]),
+                                translator->GetTranslation(predicates[j]));
+      XLS_ASSIGN_OR_RETURN(
+          bool exclusive,
+          Z3ProvesUnsatisfiable(translator, both, *options.z3_rlimit));
+      if (!exclusive) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Returns whether some predicate of `cone_bdd` may be true.
+absl::StatusOr<bool> AnyPredicateMayBeTrue(
+    ConeBdd& cone_bdd, const StreamingOutputExclusivityOptions& options) {
+  for (Node* predicate : cone_bdd.predicates()) {
+    if (cone_bdd.query_engine().IsAllZeros(predicate)) {
+      continue;
+    }
+    if (!options.z3_rlimit.has_value()) {
+      return true;
+    }
+    XLS_ASSIGN_OR_RETURN(solvers::z3::IrTranslator * translator,
+                         cone_bdd.GetTranslator());
+    XLS_ASSIGN_OR_RETURN(
+        bool always_false,
+        Z3ProvesUnsatisfiable(translator, translator->GetTranslation(predicate),
+                              *options.z3_rlimit));
+    if (!always_false) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace
 
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc) {
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    Proc* proc, const StreamingOutputExclusivityOptions& options) {
   // Find all send nodes associated with streaming channels.
   int64_t streaming_send_count = 0;
   std::vector<Node*> send_predicates;
@@ -87,13 +308,35 @@ absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc) {
     return false;
   }
 
-  // Use BDD query engine to determine predicates are such that
-  // if one is true, the rest are false.
-  BddQueryEngine query_engine(BddFunction::kDefaultPathLimit,
-                              UseNodeInBddEngine);
-  XLS_RETURN_IF_ERROR(query_engine.Populate(proc).status());
-
-  return query_engine.AtMostOneNodeTrue(send_predicates);
+  // Use BDDs to determine that the predicates are such that if one is true,
+  // the rest are false. Within a cluster this is asked of the cluster's BDD;
+  // across clusters, the predicates are independent, so at most one cluster
+  // may have a predicate which can be true at all.
+  std::vector<PredicateCluster> clusters = ClusterPredicates(send_predicates);
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  for (Node* node : TopoSort(proc)) {
+    topo_index.emplace(node, topo_index.size());
+  }
+  int64_t clusters_which_may_send = 0;
+  for (const PredicateCluster& cluster : clusters) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<ConeBdd> cone_bdd,
+        ConeBdd::Create(cluster, topo_index, options.bdd_path_limit));
+    XLS_ASSIGN_OR_RETURN(bool exclusive,
+                         AtMostOnePredicateTrue(*cone_bdd, options));
+    if (!exclusive) {
+      return false;
+    }
+    if (clusters.size() == 1) {
+      break;
+    }
+    XLS_ASSIGN_OR_RETURN(bool may_send,
+                         AnyPredicateMayBeTrue(*cone_bdd, options));
+    if (may_send && ++clusters_which_may_send > 1) {
+      return false;
+    }
+  }
+  return true;
 }
 
 }  // namespace xls
@@ -15,16 +15,34 @@
 #ifndef XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 #define XLS_CODEGEN_BDD_IO_ANALYSIS_H_
 
+#include <cstdint>
+#include <optional>
+
 #include "absl/status/statusor.h"
 #include "xls/ir/function_base.h"
+#include "xls/passes/bdd_function.h"
 
 namespace xls {
 
+struct StreamingOutputExclusivityOptions {
+  // The path limit of the BDD expressions; see BddFunction.
+  int64_t bdd_path_limit = BddFunction::kDefaultPathLimit;
+
+  // If set, predicates which the BDDs cannot prove mutually exclusive are
+  // checked with Z3, using this resource limit per query (0 for no limit).
+  std::optional<int64_t> z3_rlimit;
+};
+
 // Determines if streaming outputs are mutually exclusive.
 //
+// The send predicates are grouped by the nodes their cones share, and each
+// group is analyzed with a BDD over a copy of just its cones, so the cost
+// depends on the logic feeding the predicates rather than on the size of the
+// proc.
+//
 // TODO(tedhong): 2022-02-09 Add analysis of I/O dependencies
-// TODO(tedhong): 2022-02-09 Add additional exclusivity analysis
-absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(Proc* proc);
+absl::StatusOr<bool> AreStreamingOutputsMutuallyExclusive(
+    Proc* proc, const StreamingOutputExclusivityOptions& options = {});
 
 }  // namespace xls
 
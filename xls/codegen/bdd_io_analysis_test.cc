@@ -212,5 +212,117 @@ TEST_F(BddIOAnalysisPassTest, NonMutuallyExclusiveSendIf) {
   EXPECT_EQ(mutually_exclusive, false);
 }
 
+TEST_F(BddIOAnalysisPassTest, IndependentSendIf) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in0,
+      package.CreateStreamingChannel("in0", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in1,
+      package.CreateStreamingChannel("in1", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in0_val = pb.Receive(in0);
+  BValue in1_val = pb.Receive(in1);
+
+  BValue one = pb.Literal(UBits(1, 32));
+
+  // The predicates depend on different receives, so both may be true.
+  pb.SendIf(out0, pb.Eq(in0_val, one), in0_val);
+  pb.SendIf(out1, pb.Eq(in1_val, one), in1_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(bool mutually_exclusive,
+                           AreStreamingOutputsMutuallyExclusive(proc));
+  EXPECT_EQ(mutually_exclusive, false);
+}
+
+TEST_F(BddIOAnalysisPassTest, IndependentSendIfWithNeverTruePredicate) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in0,
+      package.CreateStreamingChannel("in0", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in1,
+      package.CreateStreamingChannel("in1", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in0_val = pb.Receive(in0);
+  BValue in1_val = pb.Receive(in1);
+
+  BValue one = pb.Literal(UBits(1, 32));
+  BValue never = pb.Literal(UBits(0, 1));
+
+  pb.SendIf(out0, pb.Eq(in0_val, one), in0_val);
+  pb.SendIf(out1, pb.And(pb.Eq(in1_val, one), never), in1_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(bool mutually_exclusive,
+                           AreStreamingOutputsMutuallyExclusive(proc));
+  EXPECT_EQ(mutually_exclusive, true);
+}
+
+TEST_F(BddIOAnalysisPassTest, ArithmeticallyExclusiveSendIfNeedsZ3) {
+  auto package_ptr = std::make_unique<Package>(TestName());
+  Package& package = *package_ptr;
+
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out0,
+      package.CreateStreamingChannel("out0", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out1,
+      package.CreateStreamingChannel("out1", ChannelOps::kSendOnly, u32));
+
+  TokenlessProcBuilder pb(TestName(), /*token_name=*/"tkn", &package);
+
+  BValue in_val = pb.Receive(in);
+
+  BValue zero = pb.Literal(UBits(0, 32));
+  BValue one = pb.Literal(UBits(1, 32));
+
+  // The BDD does not evaluate adds, so it cannot tell that `in + 1` is
+  // nonzero when `in` is zero.
+  pb.SendIf(out0, pb.Eq(pb.Add(in_val, one), zero), in_val);
+  pb.SendIf(out1, pb.Eq(in_val, zero), in_val);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(bool bdd_mutually_exclusive,
+                           AreStreamingOutputsMutuallyExclusive(proc));
+  EXPECT_EQ(bdd_mutually_exclusive, false);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      bool z3_mutually_exclusive,
+      AreStreamingOutputsMutuallyExclusive(
+          proc, StreamingOutputExclusivityOptions{.z3_rlimit = 0}));
+  EXPECT_EQ(z3_mutually_exclusive, true);
+}
+
 }  // namespace
 }  // namespace xls
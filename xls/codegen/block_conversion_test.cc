@@ -667,6 +667,67 @@ TEST_F(BlockConversionTest, ZeroWidthPipeline) {
   EXPECT_EQ(unit.top_block->GetRegisters().size(), 4);
 }
 
+TEST_F(BlockConversionTest, PackedPipelineRegisters) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue t = fb.Param(
+      "t", p->GetTupleType({p->GetBitsType(4), p->GetBitsType(4)}));
+  BValue not_x = fb.Not(x);
+  BValue neg_y = fb.Negate(y);
+  BValue t0 = fb.TupleIndex(t, 0);
+  BValue result = fb.Concat({not_x, neg_y, t0});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(result));
+
+  PipelineSchedule schedule(f,
+                            ScheduleCycleMap({{x.node(), 0},
+                                              {y.node(), 0},
+                                              {t.node(), 0},
+                                              {not_x.node(), 0},
+                                              {neg_y.node(), 0},
+                                              {t0.node(), 1},
+                                              {result.node(), 1}}),
+                            /*length=*/2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CodegenPassUnit unit,
+      FunctionBaseToPipelinedBlock(schedule,
+                                   CodegenOptions()
+                                       .flop_inputs(false)
+                                       .flop_outputs(false)
+                                       .clock_name("clk")
+                                       .pack_pipeline_registers(true),
+                                   f));
+  Block* block = unit.top_block;
+
+  // `not_x` and `neg_y` share a register; the tuple has one of its own.
+  EXPECT_EQ(block->GetRegisters().size(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Register * packed, block->GetRegister("p0_packed"));
+  EXPECT_EQ(packed->type(), p->GetBitsType(40));
+  EXPECT_THAT(GetOutputPort(block),
+              m::OutputPort(m::Concat(
+                  m::BitSlice(m::RegisterRead("p0_packed"), /*start=*/8,
+                              /*width=*/32),
+                  m::BitSlice(m::RegisterRead("p0_packed"), /*start=*/0,
+                              /*width=*/8),
+                  m::TupleIndex(m::RegisterRead(), 0))));
+
+  std::vector<absl::flat_hash_map<std::string, Value>> inputs = {
+      {{"x", Value(UBits(0x12345678, 32))},
+       {"y", Value(UBits(3, 8))},
+       {"t", Value::Tuple({Value(UBits(5, 4)), Value(UBits(9, 4))})}},
+      {{"x", Value(UBits(0, 32))},
+       {"y", Value(UBits(0, 8))},
+       {"t", Value::Tuple({Value(UBits(0, 4)), Value(UBits(0, 4))})}},
+  };
+  std::vector<absl::flat_hash_map<std::string, Value>> outputs;
+  XLS_ASSERT_OK_AND_ASSIGN(outputs, InterpretSequentialBlock(block, inputs));
+  ASSERT_EQ(outputs.size(), 2);
+  EXPECT_EQ(outputs[1].at("out"),
+            Value(UBits((uint64_t{0xedcba987} << 12) | (0xfd << 4) | 5, 44)));
+}
+
 // Verifies that an implicit token, as generated by the DSLX IR converter, is
 // appropriately plumbed into the wrapping block during conversion.
 TEST_F(BlockConversionTest, ImplicitToken) {
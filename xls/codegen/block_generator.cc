@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <deque>
 #include <initializer_list>
+#include <memory>
 #include <optional>
 #include <random>
 #include <string>
@@ -48,10 +49,12 @@
 #include "xls/codegen/op_override.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/codegen/verilog_line_map_stream.h"
 #include "xls/common/casts.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/format_preference.h"
@@ -59,6 +62,7 @@
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 #include "xls/ir/register.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
@@ -1041,6 +1045,109 @@ absl::StatusOr<std::vector<Block*>> GatherInstantiatedBlocks(Block* top) {
   return blocks;
 }
 
+// The destination of the Verilog line map: a proto collected in memory, or a
+// file written as the modules are emitted. At most one is set.
+struct LineMapSink {
+  VerilogLineMap* proto = nullptr;
+  VerilogLineMapWriter* writer = nullptr;
+
+  bool enabled() const { return proto != nullptr || writer != nullptr; }
+};
+
+// Adds to `sink` the mappings recorded in `line_info`, offsetting the Verilog
+// lines by `line_offset`.
+absl::Status AddLineMappings(const LineInfo& line_info, int64_t line_offset,
+                             Package* package, const LineMapSink& sink) {
+  for (const VastNode* vast_node : line_info.nodes()) {
+    std::optional<std::vector<LineSpan>> spans =
+        line_info.LookupNode(vast_node);
+    if (!spans.has_value()) {
+      return absl::InternalError("Unbalanced calls to LineInfo::{Start, End}");
+    }
+    for (const LineSpan& span : spans.value()) {
+      SourceInfo info = vast_node->loc();
+      for (const SourceLocation& loc : info.locations) {
+        int64_t line = static_cast<int32_t>(loc.lineno());
+        std::string source_file =
+            package->GetFilename(loc.fileno()).value_or("");
+        if (sink.writer != nullptr) {
+          XLS_RETURN_IF_ERROR(sink.writer->Add(source_file, line, line,
+                                               span.StartLine() + line_offset,
+                                               span.EndLine() + line_offset));
+          continue;
+        }
+        VerilogLineMapping* mapping = sink.proto->add_mapping();
+        mapping->set_source_file(source_file);
+        mapping->mutable_source_span()->set_line_start(line);
+        mapping->mutable_source_span()->set_line_end(line);
+        mapping->set_verilog_file("");  // to be updated later on
+        mapping->mutable_verilog_span()->set_line_start(span.StartLine() +
+                                                        line_offset);
+        mapping->mutable_verilog_span()->set_line_end(span.EndLine() +
+                                                      line_offset);
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+// The module of a single block, generated into a file of its own.
+struct ModuleFragment {
+  std::unique_ptr<VerilogFile> file;
+  LineInfo line_info;
+  std::string text;
+  absl::Status status;
+};
+
+// Generates the modules of `blocks` concurrently, each into its own file, and
+// returns their texts concatenated in the order of `blocks`. The result is
+// identical to generating every module into a single file.
+absl::StatusOr<std::string> GenerateModulesConcurrently(
+    absl::Span<Block* const> blocks, Block* top, const CodegenOptions& options,
+    const LineMapSink& line_map_sink,
+    const absl::flat_hash_map<InputPort*, std::string>& input_port_sv_types,
+    const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types) {
+  std::vector<ModuleFragment> fragments(blocks.size());
+  {
+    ThreadPool thread_pool(std::min<int64_t>(options.codegen_threads(),
+                                             blocks.size()));
+    for (int64_t i = 0; i < blocks.size(); ++i) {
+      thread_pool.Schedule([&, i]() {
+        ModuleFragment& fragment = fragments[i];
+        fragment.file = std::make_unique<VerilogFile>(
+            options.use_system_verilog() ? FileType::kSystemVerilog
+                                         : FileType::kVerilog);
+        fragment.status =
+            BlockGenerator::Generate(blocks[i], fragment.file.get(), options,
+                                     input_port_sv_types, output_port_sv_types);
+        if (fragment.status.ok()) {
+          fragment.text = fragment.file->Emit(
+              line_map_sink.enabled() ? &fragment.line_info : nullptr);
+        }
+      });
+    }
+    thread_pool.WaitForIdle();
+  }
+
+  std::string text;
+  int64_t line_offset = 0;
+  for (const ModuleFragment& fragment : fragments) {
+    XLS_RETURN_IF_ERROR(fragment.status);
+    if (!text.empty()) {
+      // Modules are separated by two blank lines.
+      absl::StrAppend(&text, "\n\n");
+      line_offset += 2;
+    }
+    if (line_map_sink.enabled()) {
+      XLS_RETURN_IF_ERROR(AddLineMappings(fragment.line_info, line_offset,
+                                          top->package(), line_map_sink));
+    }
+    absl::StrAppend(&text, fragment.text);
+    line_offset += absl::c_count(fragment.text, '\n');
+  }
+  return text;
+}
+
 }  // namespace
 
 absl::StatusOr<std::string> GenerateVerilog(
@@ -1054,42 +1161,44 @@ absl::StatusOr<std::string> GenerateVerilog(
 
   XLS_ASSIGN_OR_RETURN(std::vector<Block*> blocks,
                        GatherInstantiatedBlocks(top));
-  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
-                                                : FileType::kVerilog);
-  for (Block* block : blocks) {
-    XLS_RETURN_IF_ERROR(BlockGenerator::Generate(
-        block, &file, options, input_port_sv_types, output_port_sv_types));
-    if (block != blocks.back()) {
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-      file.Add(file.Make<BlankLine>(SourceInfo()));
-    }
+  std::unique_ptr<VerilogLineMapWriter> line_map_writer;
+  LineMapSink line_map_sink;
+  if (options.verilog_line_map_stream_path().has_value()) {
+    XLS_ASSIGN_OR_RETURN(line_map_writer,
+                         VerilogLineMapWriter::Create(
+                             *options.verilog_line_map_stream_path()));
+    line_map_sink.writer = line_map_writer.get();
+  } else {
+    line_map_sink.proto = verilog_line_map;
   }
 
-  LineInfo line_info;
-  std::string text = file.Emit(&line_info);
-  if (verilog_line_map != nullptr) {
-    for (const VastNode* vast_node : line_info.nodes()) {
-      std::optional<std::vector<LineSpan>> spans =
-          line_info.LookupNode(vast_node);
-      if (!spans.has_value()) {
-        return absl::InternalError(
-            "Unbalanced calls to LineInfo::{Start, End}");
-      }
-      for (const LineSpan& span : spans.value()) {
-        SourceInfo info = vast_node->loc();
-        for (const SourceLocation& loc : info.locations) {
-          int64_t line = static_cast<int32_t>(loc.lineno());
-          VerilogLineMapping* mapping = verilog_line_map->add_mapping();
-          mapping->set_source_file(
-              top->package()->GetFilename(loc.fileno()).value_or(""));
-          mapping->mutable_source_span()->set_line_start(line);
-          mapping->mutable_source_span()->set_line_end(line);
-          mapping->set_verilog_file("");  // to be updated later on
-          mapping->mutable_verilog_span()->set_line_start(span.StartLine());
-          mapping->mutable_verilog_span()->set_line_end(span.EndLine());
-        }
+  std::string text;
+  if (options.codegen_threads() > 1 && blocks.size() > 1) {
+    XLS_ASSIGN_OR_RETURN(
+        text, GenerateModulesConcurrently(blocks, top, options, line_map_sink,
+                                          input_port_sv_types,
+                                          output_port_sv_types));
+  } else {
+    VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                  : FileType::kVerilog);
+    for (Block* block : blocks) {
+      XLS_RETURN_IF_ERROR(BlockGenerator::Generate(
+          block, &file, options, input_port_sv_types, output_port_sv_types));
+      if (block != blocks.back()) {
+        file.Add(file.Make<BlankLine>(SourceInfo()));
+        file.Add(file.Make<BlankLine>(SourceInfo()));
       }
     }
+
+    LineInfo line_info;
+    text = file.Emit(line_map_sink.enabled() ? &line_info : nullptr);
+    if (line_map_sink.enabled()) {
+      XLS_RETURN_IF_ERROR(AddLineMappings(line_info, /*line_offset=*/0,
+                                          top->package(), line_map_sink));
+    }
+  }
+  if (line_map_writer != nullptr) {
+    XLS_RETURN_IF_ERROR(line_map_writer->Close());
   }
 
   VLOG(2) << "Verilog output:";
@@ -1098,5 +1207,15 @@ absl::StatusOr<std::string> GenerateVerilog(
   return text;
 }
 
+absl::StatusOr<std::string> GenerateModuleVerilog(
+    Block* block, const CodegenOptions& options) {
+  VerilogFile file(options.use_system_verilog() ? FileType::kSystemVerilog
+                                                : FileType::kVerilog);
+  XLS_RETURN_IF_ERROR(BlockGenerator::Generate(block, &file, options,
+                                               /*input_port_sv_types=*/{},
+                                               /*output_port_sv_types=*/{}));
+  return file.Emit();
+}
+
 }  // namespace verilog
 }  // namespace xls
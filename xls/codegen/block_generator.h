@@ -30,6 +30,11 @@ namespace verilog {
 // Generates and returns (System)Verilog text implementing the given top-level
 // block. The text will include a Verilog module corresponding to the given
 // block as well as module definitions for any instantiated blocks.
+//
+// If `verilog_line_map` is given the mappings from Verilog lines to source
+// lines are added to it, unless the options set a
+// verilog_line_map_stream_path, in which case they are written to that file
+// instead.
 absl::StatusOr<std::string> GenerateVerilog(
     Block* top, const CodegenOptions& options,
     VerilogLineMap* verilog_line_map = nullptr,
@@ -38,6 +43,12 @@ absl::StatusOr<std::string> GenerateVerilog(
     const absl::flat_hash_map<OutputPort*, std::string>& output_port_sv_types =
         {});
 
+// Generates and returns (System)Verilog text for the module of the given block
+// alone. Unlike GenerateVerilog no modules are emitted for the blocks it
+// instantiates; those must be emitted separately.
+absl::StatusOr<std::string> GenerateModuleVerilog(
+    Block* block, const CodegenOptions& options);
+
 }  // namespace verilog
 }  // namespace xls
 
@@ -43,6 +43,10 @@
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/op_override_impls.h"
 #include "xls/codegen/signature_generator.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/codegen/verilog_line_map_stream.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
@@ -1548,6 +1552,86 @@ TEST_P(BlockGeneratorTest, DiamondDependencyInstantiations) {
   XLS_ASSERT_OK(tb->Run());
 }
 
+TEST_P(BlockGeneratorTest, ConcurrentGenerationMatchesSerial) {
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * sub_block,
+                           MakeSubtractBlock("subtractor", &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * delegator0,
+      MakeDelegatingBlock("delegator0", sub_block, &package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Block * delegator1,
+      MakeDelegatingBlock("delegator1", sub_block, &package));
+
+  BlockBuilder bb("my_block", &package);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      xls::Instantiation * instantiation0,
+      bb.block()->AddBlockInstantiation("deleg0", delegator0));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      xls::Instantiation * instantiation1,
+      bb.block()->AddBlockInstantiation("deleg1", delegator1));
+  BValue j = bb.InputPort("j", u32);
+  BValue k = bb.InputPort("k", u32);
+  bb.InstantiationInput(instantiation0, "x", j);
+  bb.InstantiationInput(instantiation0, "y", k);
+  bb.InstantiationInput(instantiation1, "x", k);
+  bb.InstantiationInput(instantiation1, "y", j);
+  bb.OutputPort("j_minus_k", bb.InstantiationOutput(instantiation0, "z"));
+  bb.OutputPort("k_minus_j", bb.InstantiationOutput(instantiation1, "z"));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  VerilogLineMap serial_line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string serial,
+      GenerateVerilog(block, codegen_options(), &serial_line_map));
+  VerilogLineMap concurrent_line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string concurrent,
+      GenerateVerilog(block, codegen_options().codegen_threads(4),
+                      &concurrent_line_map));
+  EXPECT_EQ(concurrent, serial);
+  EXPECT_EQ(concurrent_line_map.DebugString(), serial_line_map.DebugString());
+}
+
+TEST_P(BlockGeneratorTest, StreamedLineMapMatchesInMemoryLineMap) {
+  Package package(TestBaseName());
+  Type* u32 = package.GetBitsType(32);
+  SourceLocation loc0 = package.AddSourceLocation("foo.x", Lineno(3), Colno(1));
+  SourceLocation loc1 = package.AddSourceLocation("bar.x", Lineno(7), Colno(5));
+
+  BlockBuilder bb(TestBaseName(), &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  BValue sum = bb.Add(a, b, SourceInfo(loc0));
+  bb.OutputPort("out", bb.Subtract(sum, b, SourceInfo(loc1)));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  VerilogLineMap line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string verilog,
+      GenerateVerilog(block, codegen_options(), &line_map));
+  ASSERT_GT(line_map.mapping_size(), 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file, TempFile::Create());
+  VerilogLineMap unused_line_map;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string streamed_verilog,
+      GenerateVerilog(block,
+                      codegen_options().verilog_line_map_stream_path(
+                          temp_file.path().string()),
+                      &unused_line_map));
+  EXPECT_EQ(streamed_verilog, verilog);
+  EXPECT_EQ(unused_line_map.mapping_size(), 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string data,
+                           GetFileContents(temp_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(VerilogLineMap streamed_line_map,
+                           DecodeVerilogLineMap(data));
+  EXPECT_EQ(streamed_line_map.DebugString(), line_map.DebugString());
+}
+
 TEST_P(BlockGeneratorTest, LoopbackFifoInstantiation) {
   constexpr std::string_view ir_text = R"(package test
 
@@ -338,9 +338,15 @@ absl::Status GenerateBomEntry(Node* node, BomEntryProto* proto) {
   return absl::OkStatus();
 }
 
-// Generate a bill of materials.
-absl::Status GenerateBom(Block* block, BlockMetricsProto* proto) {
+// Generate a bill of materials of at most `limit` entries (if given).
+absl::Status GenerateBom(Block* block, std::optional<int64_t> limit,
+                         BlockMetricsProto* proto) {
   for (Node* node : block->nodes()) {
+    if (limit.has_value() && proto->bill_of_materials_size() >= *limit) {
+      proto->set_bill_of_materials_omitted(block->node_count() -
+                                           proto->bill_of_materials_size());
+      break;
+    }
     BomEntryProto* bom_entry = proto->add_bill_of_materials();
     XLS_RETURN_IF_ERROR(GenerateBomEntry(node, bom_entry));
   }
@@ -351,7 +357,8 @@ absl::Status GenerateBom(Block* block, BlockMetricsProto* proto) {
 }  // namespace
 
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
-    Block* block, const DelayEstimator* delay_estimator) {
+    Block* block, const DelayEstimator* delay_estimator,
+    std::optional<int64_t> bill_of_materials_limit) {
   BlockMetricsProto proto;
   proto.set_flop_count(GenerateFlopCount(block));
   proto.set_feedthrough_path_exists(HasFeedthroughPass(block));
@@ -361,7 +368,7 @@ absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
     XLS_RETURN_IF_ERROR(SetDelayFields(block, *delay_estimator, &proto));
   }
 
-  XLS_RETURN_IF_ERROR(GenerateBom(block, &proto));
+  XLS_RETURN_IF_ERROR(GenerateBom(block, bill_of_materials_limit, &proto));
 
   return proto;
 }
@@ -15,6 +15,8 @@
 #ifndef XLS_CODEGEN_BLOCK_METRICS_H_
 #define XLS_CODEGEN_BLOCK_METRICS_H_
 
+#include <cstdint>
+#include <optional>
 
 #include "absl/status/statusor.h"
 #include "xls/codegen/xls_metrics.pb.h"
@@ -26,9 +28,13 @@ namespace xls::verilog {
 // Collects and generate metrics related to the contents of the block.
 // (ex. flop count, number of operations, etc...).
 //
+// If `bill_of_materials_limit` is given the bill of materials holds at most
+// that many entries, so the size of the metrics of large blocks is bounded.
+//
 // TODO(tedhong): 2022-01-28 Add a class around the proto.
 absl::StatusOr<BlockMetricsProto> GenerateBlockMetrics(
-    Block* block, const DelayEstimator* delay_estimator = nullptr);
+    Block* block, const DelayEstimator* delay_estimator = nullptr,
+    std::optional<int64_t> bill_of_materials_limit = std::nullopt);
 
 }  // namespace xls::verilog
 
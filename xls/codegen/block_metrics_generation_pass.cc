@@ -32,8 +32,11 @@ absl::StatusOr<bool> BlockMetricsGenerationPass::RunInternal(
       return absl::InvalidArgumentError(
           "Block metrics should be run after signature generation.");
     }
-    XLS_ASSIGN_OR_RETURN(BlockMetricsProto block_metrics,
-                         GenerateBlockMetrics(block, options.delay_estimator));
+    XLS_ASSIGN_OR_RETURN(
+        BlockMetricsProto block_metrics,
+        GenerateBlockMetrics(
+            block, options.delay_estimator,
+            options.codegen_options.bill_of_materials_limit()));
     XLS_RETURN_IF_ERROR(metadata.signature->ReplaceBlockMetrics(block_metrics));
     changed = true;
   }
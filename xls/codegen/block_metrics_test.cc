@@ -304,6 +304,34 @@ TEST(BlockMetricsGeneratorTest, BillOfMaterials) {
   EXPECT_EQ(proto.bill_of_materials(5).maximum_input_width(), 32);
   EXPECT_EQ(proto.bill_of_materials(5).number_of_arguments(), 1);
   EXPECT_EQ(proto.bill_of_materials(5).location_size(), 0);
+  EXPECT_FALSE(proto.has_bill_of_materials_omitted());
+}
+
+TEST(BlockMetricsGeneratorTest, BillOfMaterialsLimit) {
+  Package package("test");
+
+  Type* u32 = package.GetBitsType(32);
+  BlockBuilder bb("test_block", &package);
+  BValue a = bb.InputPort("a", u32);
+  BValue b = bb.InputPort("b", u32);
+  bb.OutputPort("z", bb.Subtract(a, b));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      BlockMetricsProto proto,
+      GenerateBlockMetrics(block, /*delay_estimator=*/nullptr,
+                           /*bill_of_materials_limit=*/2));
+  ASSERT_EQ(proto.bill_of_materials_size(), 2);
+  EXPECT_EQ(proto.bill_of_materials(0).op(), ToOpProto(Op::kInputPort));
+  EXPECT_EQ(proto.bill_of_materials(1).op(), ToOpProto(Op::kInputPort));
+  EXPECT_EQ(proto.bill_of_materials_omitted(), 2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      proto, GenerateBlockMetrics(block, /*delay_estimator=*/nullptr,
+                                  /*bill_of_materials_limit=*/4));
+  EXPECT_EQ(proto.bill_of_materials_size(), 4);
+  EXPECT_FALSE(proto.has_bill_of_materials_omitted());
 }
 
 TEST(BlockMetricsGeneratorTest, DelayMetrics) {
@@ -246,12 +246,21 @@ class CloneNodesIntoBlockHandler {
   }
 
   // Add pipeline registers. A register is needed for each node which is
-  // scheduled at or before this cycle and has a use after this cycle.
+  // scheduled at or before this cycle and has a use after this cycle. If the
+  // options ask for it, the non-empty bits-typed values share a single packed
+  // register instead.
   absl::Status AddNextPipelineStage(const PipelineSchedule& schedule,
                                     int64_t stage) {
+    std::vector<Node*> packed_nodes;
     for (Node* function_base_node : function_base_->nodes()) {
       if (schedule.IsLiveOutOfCycle(function_base_node, stage)) {
         Node* node = node_map_.at(function_base_node);
+        if (options_.pack_pipeline_registers() &&
+            node->GetType()->IsBits() &&
+            node->GetType()->GetFlatBitCount() > 0) {
+          packed_nodes.push_back(function_base_node);
+          continue;
+        }
 
         XLS_ASSIGN_OR_RETURN(
             Node * node_after_stage,
@@ -263,6 +272,17 @@ class CloneNodesIntoBlockHandler {
       }
     }
 
+    if (packed_nodes.size() == 1) {
+      Node* node = node_map_.at(packed_nodes.front());
+      XLS_ASSIGN_OR_RETURN(
+          node_map_[packed_nodes.front()],
+          CreatePipelineRegistersForNode(
+              PipelineSignalName(node->GetName(), stage), node, stage,
+              result_.pipeline_registers.at(stage)));
+    } else if (packed_nodes.size() > 1) {
+      XLS_RETURN_IF_ERROR(CreatePackedPipelineRegister(packed_nodes, stage));
+    }
+
     return absl::OkStatus();
   }
 
@@ -824,6 +844,44 @@ class CloneNodesIntoBlockHandler {
     return PipelineRegister{reg, reg_write, reg_read};
   }
 
+  // Creates a single pipeline register holding the concatenation of the
+  // (bits-typed) values of `function_base_nodes` after `stage`, and slices
+  // each value back out of it. The values share one register write and thus
+  // one load enable, which the flow control logic adds once rather than once
+  // per value.
+  absl::Status CreatePackedPipelineRegister(
+      absl::Span<Node* const> function_base_nodes, Stage stage) {
+    std::vector<Node*> values;
+    values.reserve(function_base_nodes.size());
+    for (Node* function_base_node : function_base_nodes) {
+      values.push_back(node_map_.at(function_base_node));
+    }
+    XLS_ASSIGN_OR_RETURN(Node * packed,
+                         block()->MakeNode<xls::Concat>(SourceInfo(), values));
+    result_.node_to_stage_map[packed] = stage;
+    XLS_ASSIGN_OR_RETURN(
+        PipelineRegister pipe_reg,
+        CreatePipelineRegister(PipelineSignalName("packed", stage), packed,
+                               stage));
+    result_.pipeline_registers.at(stage).push_back(pipe_reg);
+
+    // The first operand of a concat is its most significant.
+    int64_t start = packed->BitCountOrDie();
+    for (int64_t i = 0; i < values.size(); ++i) {
+      Node* value = values[i];
+      int64_t width = value->BitCountOrDie();
+      start -= width;
+      XLS_ASSIGN_OR_RETURN(
+          Node * unpacked,
+          block()->MakeNodeWithName<BitSlice>(
+              value->loc(), pipe_reg.reg_read, start, width,
+              PipelineSignalName(value->GetName(), stage)));
+      result_.node_to_stage_map[unpacked] = stage + 1;
+      node_map_[function_base_nodes[i]] = unpacked;
+    }
+    return absl::OkStatus();
+  }
+
   // Returns true if tuple_type has a zero width element at the top level.
   bool HasZeroWidthType(TupleType* tuple_type) {
     CHECK(tuple_type != nullptr);
@@ -74,7 +74,12 @@ CodegenOptions::CodegenOptions(const CodegenOptions& options)
       simulation_macro_name_(options.simulation_macro_name_),
       codegen_version_(options.codegen_version_),
       materialize_internal_fifos_(options.materialize_internal_fifos_),
-      randomize_order_seed_(options.randomize_order_seed_) {
+      randomize_order_seed_(options.randomize_order_seed_),
+      codegen_threads_(options.codegen_threads_),
+      retime_registers_(options.retime_registers_),
+      pack_pipeline_registers_(options.pack_pipeline_registers_),
+      verilog_line_map_stream_path_(options.verilog_line_map_stream_path_),
+      bill_of_materials_limit_(options.bill_of_materials_limit_) {
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
   }
@@ -114,6 +119,11 @@ CodegenOptions& CodegenOptions::operator=(const CodegenOptions& options) {
   codegen_version_ = options.codegen_version_;
   materialize_internal_fifos_ = options.materialize_internal_fifos_;
   randomize_order_seed_ = options.randomize_order_seed_;
+  codegen_threads_ = options.codegen_threads_;
+  retime_registers_ = options.retime_registers_;
+  pack_pipeline_registers_ = options.pack_pipeline_registers_;
+  verilog_line_map_stream_path_ = options.verilog_line_map_stream_path_;
+  bill_of_materials_limit_ = options.bill_of_materials_limit_;
 
   for (auto& [op, op_override] : options.op_overrides_) {
     op_overrides_.insert_or_assign(op, op_override->Clone());
@@ -344,6 +344,56 @@ class CodegenOptions {
     return randomize_order_seed_;
   }
 
+  // The number of threads used to generate the modules of the blocks of a
+  // design concurrently. Values of one or less generate them serially. The
+  // output is the same either way.
+  CodegenOptions& codegen_threads(int64_t value) {
+    codegen_threads_ = value;
+    return *this;
+  }
+  int64_t codegen_threads() const { return codegen_threads_; }
+
+  // Whether to retime the pipeline registers of each block, moving them across
+  // the combinational logic to minimize the clock period (as estimated by the
+  // delay estimator given to the codegen passes) and then the number of
+  // register bits at that period.
+  CodegenOptions& retime_registers(bool value) {
+    retime_registers_ = value;
+    return *this;
+  }
+  bool retime_registers() const { return retime_registers_; }
+
+  // Whether to pack the bits-typed values carried from each pipeline stage to
+  // the next into a single register per stage, which shares one load enable,
+  // rather than giving each value a register of its own.
+  CodegenOptions& pack_pipeline_registers(bool value) {
+    pack_pipeline_registers_ = value;
+    return *this;
+  }
+  bool pack_pipeline_registers() const { return pack_pipeline_registers_; }
+
+  // If set, the Verilog line map is written to this path while the Verilog is
+  // emitted, in the format of VerilogLineMapWriter, instead of being returned
+  // in a VerilogLineMap proto.
+  CodegenOptions& verilog_line_map_stream_path(
+      std::optional<std::string> value) {
+    verilog_line_map_stream_path_ = std::move(value);
+    return *this;
+  }
+  const std::optional<std::string>& verilog_line_map_stream_path() const {
+    return verilog_line_map_stream_path_;
+  }
+
+  // The maximum number of entries in the bill of materials of the block
+  // metrics. Entries beyond the limit are counted but not recorded.
+  CodegenOptions& bill_of_materials_limit(std::optional<int64_t> value) {
+    bill_of_materials_limit_ = value;
+    return *this;
+  }
+  std::optional<int64_t> bill_of_materials_limit() const {
+    return bill_of_materials_limit_;
+  }
+
  private:
   std::optional<std::string> entry_;
   std::optional<std::string> module_name_;
@@ -380,6 +430,11 @@ class CodegenOptions {
   Version codegen_version_ = Version::kDefault;
   bool materialize_internal_fifos_ = false;
   std::vector<int32_t> randomize_order_seed_;
+  int64_t codegen_threads_ = 1;
+  bool retime_registers_ = false;
+  bool pack_pipeline_registers_ = false;
+  std::optional<std::string> verilog_line_map_stream_path_;
+  std::optional<int64_t> bill_of_materials_limit_;
 };
 
 template <typename Sink>
@@ -24,31 +24,34 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
-#include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/ir/block.h"
 #include "xls/ir/instantiation.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/node.h"
 
 namespace xls::verilog {
 
 std::string CodegenPassUnit::DumpIr() const {
+  StringIrSink sink;
+  DumpIrTo(sink);
+  return sink.Release();
+}
+
+void CodegenPassUnit::DumpIrTo(IrSink& sink) const {
   // Dump the Package and metadata. The metadata is commented out ('//') so the
   // output is parsable.
-  std::string out =
-      absl::StrFormat("// Generating code for proc: %s\n\n", name());
-  absl::StrAppend(&out, package->DumpIr());
+  sink.Append("// Generating code for proc: ", name(), "\n\n");
+  package->DumpIrTo(sink);
   for (const auto& [_, block_metadata] : metadata) {
     if (block_metadata.signature.has_value()) {
       for (auto line :
            absl::StrSplit(block_metadata.signature->ToString(), '\n')) {
-        absl::StrAppend(&out, "// ", line, "\n");
+        sink.Append("// ", line, "\n");
       }
     }
   }
-  return out;
 }
 int64_t CodegenPassUnit::GetNodeCount() const {
   return package->GetNodeCount();
@@ -33,6 +33,7 @@
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/block.h"
 #include "xls/ir/instantiation.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
@@ -312,6 +313,7 @@ struct CodegenPassUnit {
 
   // These methods are required by CompoundPassBase.
   std::string DumpIr() const;
+  void DumpIrTo(IrSink& sink) const;
   const std::string& name() const {
     CHECK_NE(top_block, nullptr);
     return top_block->name();
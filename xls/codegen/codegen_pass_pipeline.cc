@@ -34,6 +34,7 @@
 #include "xls/codegen/ram_rewrite_pass.h"
 #include "xls/codegen/register_combining_pass.h"
 #include "xls/codegen/register_legalization_pass.h"
+#include "xls/codegen/register_retiming_pass.h"
 #include "xls/codegen/side_effect_condition_pass.h"
 #include "xls/codegen/signature_generation_pass.h"
 #include "xls/codegen/trace_verbosity_pass.h"
@@ -107,6 +108,10 @@ std::unique_ptr<CodegenCompoundPass> CreateCodegenPassPipeline() {
       std::make_unique<CsePass>(/*common_literals=*/false));
   top->Add<CodegenWrapperPass>(std::make_unique<BasicSimplificationPass>());
 
+  // Optionally move pipeline registers across the simplified logic to minimize
+  // the estimated clock period.
+  top->Add<RegisterRetimingPass>();
+
   // Swap out fifo instantiations with materialized fifos if required by codegen
   // options.
   top->Add<MaybeMaterializeInternalFifoPass>();
@@ -15,27 +15,45 @@
 #include "xls/codegen/pipeline_generator.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/block_conversion.h"
 #include "xls/codegen/block_generator.h"
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/codegen/codegen_pass_pipeline.h"
 #include "xls/codegen/module_signature.h"
+#include "xls/codegen/vast/vast.h"
 #include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/name_uniquer.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value_utils.h"
 #include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
@@ -145,5 +163,299 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
       unit.metadata.at(unit.top_block).signature.value()};
 }
 
+
+namespace {
+
+bool HasBits(Node* node) { return node->GetType()->GetFlatBitCount() > 0; }
+
+// The values entering and leaving one pipeline stage through its ports.
+struct StageInterface {
+  std::vector<Node*> inputs;
+  std::vector<Node*> outputs;
+
+  bool empty() const { return inputs.empty() && outputs.empty(); }
+};
+
+// Generates a pipelined module one stage at a time. Each stage is converted
+// into a block of its own in a scratch package, emitted as Verilog and
+// discarded before the next stage is converted; only its port interface is
+// kept to build the top module. The top module instantiates the stage modules
+// and holds the pipeline registers between them.
+class PartitionedPipelineGenerator {
+ public:
+  PartitionedPipelineGenerator(const PipelineSchedule& schedule,
+                               Function* func, const CodegenOptions& options)
+      : schedule_(schedule),
+        func_(func),
+        options_(options),
+        top_name_(options.module_name().has_value()
+                      ? std::string(*options.module_name())
+                      : SanitizeIdentifier(func->name())),
+        package_(absl::StrFormat("%s_partitioned", top_name_)),
+        port_uniquer_(/*separator=*/"__") {
+    // Stage and top modules have no pipeline stages of their own.
+    options_.emit_as_pipeline(false);
+  }
+
+  absl::StatusOr<ModuleGeneratorResult> Generate();
+
+ private:
+  std::string StageName(int64_t stage) const {
+    return absl::StrFormat("%s_stage_%d", top_name_, stage);
+  }
+
+  // Name of the stage ports carrying the value of `node`.
+  const std::string& PortName(Node* node) {
+    auto [it, inserted] = port_names_.try_emplace(node);
+    if (inserted) {
+      it->second = port_uniquer_.GetSanitizedUniqueName(node->GetName());
+    }
+    return it->second;
+  }
+
+  // Converts the nodes of `stage` into a block and appends its module to
+  // `verilog`. Returns the values crossing the boundary of the stage.
+  absl::StatusOr<StageInterface> GenerateStage(int64_t stage,
+                                               std::string& verilog);
+
+  // Adds to `package_` a block with the ports of the module of `stage`, which
+  // stands in for that module when instantiated by the top block.
+  absl::Status AddStageInterfaceBlock(int64_t stage,
+                                      const StageInterface& interface);
+
+  // Builds the top block instantiating the stage modules.
+  absl::StatusOr<Block*> BuildTopBlock(
+      absl::Span<const StageInterface> interfaces);
+
+  const PipelineSchedule& schedule_;
+  Function* func_;
+  CodegenOptions options_;
+  std::string top_name_;
+  // Holds the top block and the stage interface blocks.
+  Package package_;
+  absl::flat_hash_map<int64_t, Block*> stage_blocks_;
+  // The last stage in which each node is used. The return value is used after
+  // the final stage.
+  absl::flat_hash_map<Node*, int64_t> last_use_;
+  NameUniquer port_uniquer_;
+  absl::flat_hash_map<Node*, std::string> port_names_;
+};
+
+absl::StatusOr<StageInterface> PartitionedPipelineGenerator::GenerateStage(
+    int64_t stage, std::string& verilog) {
+  Package package(StageName(stage));
+  Block* block =
+      package.AddBlock(std::make_unique<Block>(StageName(stage), &package));
+  StageInterface interface;
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (Node* node : schedule_.nodes_in_cycle(stage)) {
+    // Parameters are ports of the top module; stages using them receive them
+    // through input ports.
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<Node*> operands;
+    operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      auto it = node_map.find(operand);
+      if (it == node_map.end()) {
+        Node* value;
+        if (HasBits(operand)) {
+          XLS_ASSIGN_OR_RETURN(
+              Type * type, package.MapTypeFromOtherPackage(operand->GetType()));
+          XLS_ASSIGN_OR_RETURN(
+              value,
+              block->AddInputPort(PortName(operand), type, operand->loc()));
+          interface.inputs.push_back(operand);
+        } else {
+          XLS_ASSIGN_OR_RETURN(
+              value, block->MakeNode<xls::Literal>(
+                         operand->loc(), ZeroOfType(operand->GetType())));
+        }
+        it = node_map.emplace(operand, value).first;
+      }
+      operands.push_back(it->second);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * clone,
+                         node->CloneInNewFunction(operands, block));
+    node_map[node] = clone;
+    auto last_use = last_use_.find(node);
+    if (last_use != last_use_.end() && last_use->second > stage &&
+        HasBits(node)) {
+      XLS_RETURN_IF_ERROR(
+          block->AddOutputPort(PortName(node), clone, node->loc()).status());
+      interface.outputs.push_back(node);
+    }
+  }
+  if (interface.empty()) {
+    // Nothing observable happens in this stage.
+    return interface;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string text,
+                       GenerateModuleVerilog(block, options_));
+  absl::StrAppend(&verilog, text, "\n\n");
+  return interface;
+}
+
+absl::Status PartitionedPipelineGenerator::AddStageInterfaceBlock(
+    int64_t stage, const StageInterface& interface) {
+  Block* block =
+      package_.AddBlock(std::make_unique<Block>(StageName(stage), &package_));
+  for (Node* input : interface.inputs) {
+    XLS_ASSIGN_OR_RETURN(Type * type,
+                         package_.MapTypeFromOtherPackage(input->GetType()));
+    XLS_RETURN_IF_ERROR(block->AddInputPort(PortName(input), type).status());
+  }
+  for (Node* output : interface.outputs) {
+    XLS_ASSIGN_OR_RETURN(Node * zero,
+                         block->MakeNode<xls::Literal>(
+                             SourceInfo(), ZeroOfType(output->GetType())));
+    XLS_RETURN_IF_ERROR(block->AddOutputPort(PortName(output), zero).status());
+  }
+  stage_blocks_[stage] = block;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Block*> PartitionedPipelineGenerator::BuildTopBlock(
+    absl::Span<const StageInterface> interfaces) {
+  BlockBuilder bb(top_name_, &package_);
+  XLS_RETURN_IF_ERROR(bb.AddClockPort(*options_.clock_name()));
+
+  // The values live at the current point of the pipeline, in a deterministic
+  // order.
+  std::vector<std::pair<Node*, BValue>> live;
+  for (Param* param : func_->params()) {
+    XLS_ASSIGN_OR_RETURN(Type * type,
+                         package_.MapTypeFromOtherPackage(param->GetType()));
+    live.push_back({param, bb.InputPort(param->name(), type)});
+  }
+  // Registers the live values which are used after `stage` into pipeline
+  // registers numbered `register_stage`, dropping those which are not.
+  auto register_live = [&](int64_t stage, int64_t register_stage) {
+    std::vector<std::pair<Node*, BValue>> registered;
+    for (auto& [node, value] : live) {
+      if (last_use_.at(node) <= stage) {
+        continue;
+      }
+      if (HasBits(node)) {
+        value = bb.InsertRegister(
+            PipelineSignalName(PortName(node), register_stage), value);
+      }
+      registered.push_back({node, value});
+    }
+    live = std::move(registered);
+  };
+
+  if (options_.flop_inputs()) {
+    register_live(/*stage=*/-1, /*register_stage=*/0);
+  }
+  for (int64_t stage = 0; stage < interfaces.size(); ++stage) {
+    const StageInterface& interface = interfaces[stage];
+    if (!interface.empty()) {
+      absl::flat_hash_map<Node*, BValue> values(live.begin(), live.end());
+      XLS_ASSIGN_OR_RETURN(
+          BlockInstantiation * instantiation,
+          bb.block()->AddBlockInstantiation(absl::StrFormat("stage_%d", stage),
+                                            stage_blocks_.at(stage)));
+      for (Node* input : interface.inputs) {
+        XLS_RET_CHECK(values.contains(input)) << input->GetName();
+        bb.InstantiationInput(instantiation, PortName(input),
+                              values.at(input));
+      }
+      for (Node* output : interface.outputs) {
+        live.push_back({output, bb.InstantiationOutput(instantiation,
+                                                       PortName(output))});
+      }
+    }
+    if (stage + 1 < interfaces.size() || options_.flop_outputs()) {
+      register_live(stage, /*register_stage=*/stage + 1);
+    }
+  }
+
+  Node* return_value = func_->return_value();
+  BValue output;
+  if (HasBits(return_value)) {
+    auto it = absl::c_find_if(
+        live, [&](const auto& entry) { return entry.first == return_value; });
+    XLS_RET_CHECK(it != live.end());
+    output = it->second;
+  } else {
+    output = bb.Literal(ZeroOfType(return_value->GetType()));
+  }
+  bb.OutputPort(options_.output_port_name(), output);
+  return bb.Build();
+}
+
+absl::StatusOr<ModuleGeneratorResult> PartitionedPipelineGenerator::Generate() {
+  XLS_RET_CHECK_EQ(schedule_.function_base(), func_);
+  if (!options_.clock_name().has_value()) {
+    return absl::InvalidArgumentError(
+        "Clock name must be specified when generating a pipelined block");
+  }
+  if (options_.reset().has_value() || options_.valid_control().has_value()) {
+    return absl::UnimplementedError(
+        "Partitioned pipeline generation does not support reset or valid "
+        "signals");
+  }
+  if ((options_.flop_inputs() &&
+       options_.flop_inputs_kind() != CodegenOptions::IOKind::kFlop) ||
+      (options_.flop_outputs() &&
+       options_.flop_outputs_kind() != CodegenOptions::IOKind::kFlop)) {
+    return absl::UnimplementedError(
+        "Partitioned pipeline generation only supports flopped inputs and "
+        "outputs");
+  }
+
+  const int64_t stage_count = schedule_.length();
+  for (Node* node : func_->nodes()) {
+    int64_t& last_use = last_use_[node];
+    for (Node* user : node->users()) {
+      last_use = std::max(last_use, schedule_.cycle(user));
+    }
+  }
+  last_use_[func_->return_value()] = stage_count;
+
+  std::string verilog;
+  std::vector<StageInterface> interfaces;
+  interfaces.reserve(stage_count);
+  for (int64_t stage = 0; stage < stage_count; ++stage) {
+    XLS_ASSIGN_OR_RETURN(StageInterface interface,
+                         GenerateStage(stage, verilog));
+    if (!interface.empty()) {
+      XLS_RETURN_IF_ERROR(AddStageInterfaceBlock(stage, interface));
+    }
+    interfaces.push_back(std::move(interface));
+  }
+
+  XLS_ASSIGN_OR_RETURN(Block * top, BuildTopBlock(interfaces));
+  XLS_ASSIGN_OR_RETURN(std::string top_text,
+                       GenerateModuleVerilog(top, options_));
+  absl::StrAppend(&verilog, top_text);
+
+  ModuleSignatureBuilder signature_builder(top_name_);
+  signature_builder.WithClock(*options_.clock_name());
+  signature_builder.WithPipelineInterface(
+      /*latency=*/stage_count - 1 + (options_.flop_inputs() ? 1 : 0) +
+          (options_.flop_outputs() ? 1 : 0),
+      /*initiation_interval=*/1);
+  for (Param* param : func_->params()) {
+    signature_builder.AddDataInput(param->name(), param->GetType());
+  }
+  signature_builder.AddDataOutput(options_.output_port_name(),
+                                  func_->return_value()->GetType());
+  XLS_ASSIGN_OR_RETURN(ModuleSignature signature, signature_builder.Build());
+  return ModuleGeneratorResult{verilog, VerilogLineMap(), signature};
+}
+
+}  // namespace
+
+absl::StatusOr<ModuleGeneratorResult> ToPartitionedPipelineModuleText(
+    const PipelineSchedule& schedule, Function* func,
+    const CodegenOptions& options) {
+  VLOG(2) << "Generating partitioned pipelined module for function:";
+  XLS_VLOG_LINES(2, schedule.ToString());
+  return PartitionedPipelineGenerator(schedule, func, options).Generate();
+}
+
 }  // namespace verilog
 }  // namespace xls
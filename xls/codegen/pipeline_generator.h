@@ -66,6 +66,18 @@ absl::StatusOr<ModuleGeneratorResult> ToPipelineModuleText(
     const CodegenOptions& options = BuildPipelineOptions(),
     const DelayEstimator* delay_estimator = nullptr);
 
+// Emits the given function as a pipelined module which follows the given
+// schedule, generating the pipeline one stage at a time. Each stage is emitted
+// as a combinational module of its own before the next stage is converted,
+// and a top module stitches the stage modules together with the pipeline
+// registers. Peak memory follows the size of the largest stage rather than the
+// size of the function, so this is suited to very large functions. The latency
+// is the number of stage boundaries plus the input and output flops. Reset and
+// valid signals are not supported.
+absl::StatusOr<ModuleGeneratorResult> ToPartitionedPipelineModuleText(
+    const PipelineSchedule& schedule, Function* func,
+    const CodegenOptions& options = BuildPipelineOptions());
+
 }  // namespace verilog
 }  // namespace xls
 
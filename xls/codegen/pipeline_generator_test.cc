@@ -22,6 +22,7 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -49,6 +50,7 @@ namespace verilog {
 namespace {
 
 using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
 using ::testing::ContainsRegex;
 using ::testing::HasSubstr;
 using ::testing::Not;
@@ -1160,6 +1162,90 @@ proc ii_greater_than_one(st: bits[32], init={0}) {
                                  result.verilog_text);
 }
 
+TEST_P(PipelineGeneratorTest, PartitionedPipeline) {
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  BValue a = fb.Param("a", package.GetBitsType(8));
+  BValue b = fb.Param("b", package.GetBitsType(8));
+  BValue c = fb.Param("c", package.GetBitsType(8));
+  BValue sum = fb.Add(a, b);
+  BValue product = fb.UMul(sum, c);
+  BValue difference = fb.Subtract(product, a);
+  fb.Tuple({fb.Add(difference, sum), fb.Tuple({}), b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(4)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPartitionedPipelineModuleText(
+          schedule, func,
+          BuildPipelineOptions().use_system_verilog(UseSystemVerilog())));
+  EXPECT_EQ(result.signature.proto().pipeline().latency(), 5);
+  EXPECT_THAT(result.verilog_text,
+              ContainsRegex(absl::StrFormat("module %s_stage_[0-3]",
+                                            TestBaseName())));
+
+  ModuleSimulator simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  EXPECT_THAT(
+      simulator.RunFunction({{"a", Value(UBits(3, 8))},
+                             {"b", Value(UBits(4, 8))},
+                             {"c", Value(UBits(5, 8))}}),
+      IsOkAndHolds(Value::Tuple(
+          {Value(UBits(39, 8)), Value::Tuple({}), Value(UBits(4, 8))})));
+}
+
+TEST_P(PipelineGeneratorTest, PartitionedPipelineWithoutFlops) {
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  BValue x = fb.Param("x", package.GetBitsType(16));
+  BValue y = fb.Param("y", package.GetBitsType(16));
+  fb.Add(fb.UMul(x, y), fb.Not(x));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(3)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPartitionedPipelineModuleText(schedule, func,
+                                      BuildPipelineOptions()
+                                          .flop_inputs(false)
+                                          .flop_outputs(false)
+                                          .use_system_verilog(
+                                              UseSystemVerilog())));
+  EXPECT_EQ(result.signature.proto().pipeline().latency(), 2);
+
+  ModuleSimulator simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  EXPECT_THAT(simulator.RunAndReturnSingleOutput(
+                  {{"x", UBits(7, 16)}, {"y", UBits(100, 16)}}),
+              IsOkAndHolds(UBits(692, 16)));
+}
+
+TEST_P(PipelineGeneratorTest, PartitionedPipelineRejectsReset) {
+  Package package(TestBaseName());
+  FunctionBuilder fb(TestBaseName(), &package);
+  fb.Param("x", package.GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(1)));
+  EXPECT_THAT(ToPartitionedPipelineModuleText(
+                  schedule, func,
+                  BuildPipelineOptions().reset("rst", /*asynchronous=*/false,
+                                               /*active_low=*/false,
+                                               /*reset_data_path=*/false)),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
 INSTANTIATE_TEST_SUITE_P(PipelineGeneratorTestInstantiation,
                          PipelineGeneratorTest,
                          testing::ValuesIn(kDefaultSimulationTargets),
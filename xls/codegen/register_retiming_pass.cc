@@ -0,0 +1,589 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/block.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/register.h"
+#include "xls/ir/source_location.h"
+
+namespace xls::verilog {
+
+namespace {
+
+// Maximum number of sweeps of the register minimization.
+constexpr int64_t kMaxMinimizationRounds = 4;
+
+// A connection from the value of `source_node` to operand `operand_no` of
+// `consumer` through `weight` retimable registers.
+struct RetimingEdge {
+  Node* source_node;
+  Node* consumer;
+  int64_t operand_no;
+  // Index of the retiming vertex of the source and the consumer. Fixed nodes
+  // (ports, fixed registers, side-effecting operations, ...) all map to the
+  // single host vertex.
+  int64_t source;
+  int64_t sink;
+  int64_t weight;
+  // Whether the edge carries a value which needs no registers (literals,
+  // tokens and zero-width values). Such edges constrain nothing and are
+  // connected directly to their source after retiming.
+  bool free;
+  // Index of the source group of non-free edges.
+  int64_t group = -1;
+};
+
+// The edges leaving a single node. After retiming the node drives a chain of
+// registers as long as its most-registered edge.
+struct SourceGroup {
+  Node* node;
+  int64_t bit_count;
+  std::vector<int64_t> edges;
+};
+
+// The retiming graph of a block. Vertices 0..n-1 are the retimable nodes and
+// vertex n is the host.
+class RetimingGraph {
+ public:
+  int64_t vertex_count() const { return vertices_.size(); }
+  int64_t host() const { return vertices_.size(); }
+
+  // Builds the graph for `block`. Returns std::nullopt if the block has nothing
+  // to retime or cannot be retimed.
+  static absl::StatusOr<std::optional<RetimingGraph>> Create(
+      Block* block, const CodegenMetadata& metadata,
+      const DelayEstimator& delay_estimator);
+
+  // Returns the weight of `edge` under retiming `r`.
+  int64_t RetimedWeight(const RetimingEdge& edge,
+                        const std::vector<int64_t>& r) const {
+    return edge.weight + r[edge.sink] - r[edge.source];
+  }
+
+  // Returns the maximum combinational delay under retiming `r`, or
+  // std::nullopt if `r` introduces a combinational cycle.
+  std::optional<int64_t> Period(const std::vector<int64_t>& r) const;
+
+  // Returns a legal retiming with a period of at most `period`, or
+  // std::nullopt if none was found.
+  std::optional<std::vector<int64_t>> FindRetiming(int64_t period) const;
+
+  // Greedily adjusts `r` to reduce the number of register bits while keeping
+  // the period at most `period`.
+  void MinimizeRegisters(int64_t period, std::vector<int64_t>& r) const;
+
+  // Returns the number of register bits needed under retiming `r`.
+  int64_t RegisterBits(const std::vector<int64_t>& r) const;
+
+  // Rewrites the block to implement retiming `r`.
+  absl::Status Apply(const std::vector<int64_t>& r, Block* block,
+                     CodegenMetadata& metadata) const;
+
+  int64_t max_vertex_delay() const {
+    return *std::max_element(delays_.begin(), delays_.end());
+  }
+  int64_t original_register_bits() const { return original_register_bits_; }
+
+ private:
+  // Raises `r` until every edge has a non-negative retimed weight. Returns
+  // false if that is not possible.
+  bool Legalize(std::vector<int64_t>& r) const;
+
+  // Returns whether every edge incident to `v` is legal under `r`.
+  bool IsLegalAt(int64_t v, const std::vector<int64_t>& r) const;
+
+  // Returns the length of the register chain of `group` under `r`.
+  int64_t GroupDepth(const SourceGroup& group,
+                     const std::vector<int64_t>& r) const;
+
+  // Returns the register bits of `group` under `r`.
+  int64_t GroupBits(const SourceGroup& group,
+                    const std::vector<int64_t>& r) const;
+
+  // Returns the arrival time of every vertex under `r`, or std::nullopt if
+  // the zero-weight edges form a cycle.
+  std::optional<std::vector<int64_t>> Arrivals(
+      const std::vector<int64_t>& r) const;
+
+  std::vector<Node*> vertices_;
+  std::vector<int64_t> delays_;
+  std::vector<RetimingEdge> edges_;
+  std::vector<SourceGroup> groups_;
+  // Per vertex, the non-free edges which start at or end at it.
+  std::vector<std::vector<int64_t>> in_edges_;
+  std::vector<std::vector<int64_t>> out_edges_;
+  // Per vertex, its source group.
+  std::vector<int64_t> vertex_group_;
+  std::vector<Register*> retimable_registers_;
+  int64_t original_register_bits_ = 0;
+};
+
+bool IsFixedNode(Node* node) {
+  return node->Is<InputPort>() || node->Is<OutputPort>() ||
+         node->Is<RegisterRead>() || node->Is<RegisterWrite>() ||
+         node->Is<InstantiationInput>() || node->Is<InstantiationOutput>() ||
+         OpIsSideEffecting(node->op());
+}
+
+bool IsFreeSource(Node* node) {
+  return node->Is<Literal>() || node->GetType()->IsToken() ||
+         node->GetType()->GetFlatBitCount() == 0;
+}
+
+absl::StatusOr<std::optional<RetimingGraph>> RetimingGraph::Create(
+    Block* block, const CodegenMetadata& metadata,
+    const DelayEstimator& delay_estimator) {
+  absl::flat_hash_set<Register*> state_registers;
+  for (const std::optional<StateRegister>& state_reg :
+       metadata.streaming_io_and_pipeline.state_registers) {
+    if (state_reg.has_value()) {
+      state_registers.insert(state_reg->reg);
+    }
+  }
+
+  RetimingGraph graph;
+  // Write of each retimable register, keyed by the register.
+  absl::flat_hash_map<Register*, RegisterWrite*> retimable;
+  for (Register* reg : block->GetRegisters()) {
+    if (reg->reset().has_value() || state_registers.contains(reg)) {
+      continue;
+    }
+    absl::StatusOr<RegisterWrite*> write = block->GetRegisterWrite(reg);
+    if (!write.ok() || !block->GetRegisterRead(reg).ok()) {
+      continue;
+    }
+    if ((*write)->load_enable().has_value() || (*write)->reset().has_value()) {
+      continue;
+    }
+    retimable[reg] = *write;
+    graph.retimable_registers_.push_back(reg);
+    graph.original_register_bits_ += reg->type()->GetFlatBitCount();
+  }
+  if (retimable.empty()) {
+    return std::nullopt;
+  }
+  auto is_wire = [&](Node* node) {
+    if (node->Is<RegisterRead>()) {
+      return retimable.contains(node->As<RegisterRead>()->GetRegister());
+    }
+    return node->Is<RegisterWrite>() &&
+           retimable.contains(node->As<RegisterWrite>()->GetRegister());
+  };
+
+  absl::flat_hash_map<Node*, int64_t> vertex_index;
+  for (Node* node : block->nodes()) {
+    if (is_wire(node) || IsFixedNode(node) || node->Is<Literal>()) {
+      continue;
+    }
+    vertex_index[node] = graph.vertices_.size();
+    graph.vertices_.push_back(node);
+    absl::StatusOr<int64_t> delay =
+        delay_estimator.GetOperationDelayInPs(node);
+    graph.delays_.push_back(delay.ok() ? *delay : 0);
+  }
+  if (graph.vertices_.empty()) {
+    return std::nullopt;
+  }
+  if (graph.vertices_.size() > RegisterRetimingPass::kMaxRetimingNodes) {
+    VLOG(2) << "Not retiming block " << block->name() << ": "
+            << graph.vertices_.size() << " retimable nodes.";
+    return std::nullopt;
+  }
+  const int64_t n = graph.vertices_.size();
+  auto index_of = [&](Node* node) {
+    auto it = vertex_index.find(node);
+    return it == vertex_index.end() ? n : it->second;
+  };
+
+  absl::flat_hash_map<Node*, int64_t> group_index;
+  graph.in_edges_.resize(n);
+  graph.out_edges_.resize(n);
+  graph.vertex_group_.assign(n, -1);
+  for (Node* consumer : block->nodes()) {
+    if (is_wire(consumer)) {
+      continue;
+    }
+    for (int64_t i = 0; i < consumer->operand_count(); ++i) {
+      Node* source = consumer->operand(i);
+      int64_t weight = 0;
+      while (is_wire(source)) {
+        if (weight > static_cast<int64_t>(retimable.size())) {
+          VLOG(2) << "Not retiming block " << block->name()
+                  << ": register-only cycle through " << source->GetName();
+          return std::nullopt;
+        }
+        source =
+            retimable.at(source->As<RegisterRead>()->GetRegister())->data();
+        ++weight;
+      }
+      const int64_t edge_index = graph.edges_.size();
+      graph.edges_.push_back(RetimingEdge{.source_node = source,
+                        .consumer = consumer,
+                        .operand_no = i,
+                        .source = index_of(source),
+                        .sink = index_of(consumer),
+                        .weight = weight,
+                        .free = IsFreeSource(source)});
+      RetimingEdge& edge = graph.edges_.back();
+      if (edge.free) {
+        continue;
+      }
+      if (edge.source != n) {
+        graph.out_edges_[edge.source].push_back(edge_index);
+      }
+      if (edge.sink != n) {
+        graph.in_edges_[edge.sink].push_back(edge_index);
+      }
+      auto [it, inserted] =
+          group_index.try_emplace(source, graph.groups_.size());
+      if (inserted) {
+        graph.groups_.push_back(SourceGroup{
+            .node = source, .bit_count = source->GetType()->GetFlatBitCount()});
+        if (edge.source != n) {
+          graph.vertex_group_[edge.source] = it->second;
+        }
+      }
+      graph.groups_[it->second].edges.push_back(edge_index);
+      edge.group = it->second;
+    }
+  }
+  return graph;
+}
+
+std::optional<std::vector<int64_t>> RetimingGraph::Arrivals(
+    const std::vector<int64_t>& r) const {
+  const int64_t n = vertex_count();
+  std::vector<int64_t> pending(n, 0);
+  for (int64_t v = 0; v < n; ++v) {
+    for (int64_t e : in_edges_[v]) {
+      const RetimingEdge& edge = edges_[e];
+      if (edge.source != host() && RetimedWeight(edge, r) == 0) {
+        ++pending[v];
+      }
+    }
+  }
+  std::vector<int64_t> arrival(delays_);
+  std::deque<int64_t> ready;
+  for (int64_t v = 0; v < n; ++v) {
+    if (pending[v] == 0) {
+      ready.push_back(v);
+    }
+  }
+  int64_t visited = 0;
+  while (!ready.empty()) {
+    int64_t u = ready.front();
+    ready.pop_front();
+    ++visited;
+    for (int64_t e : out_edges_[u]) {
+      const RetimingEdge& edge = edges_[e];
+      if (edge.sink == host() || RetimedWeight(edge, r) != 0) {
+        continue;
+      }
+      arrival[edge.sink] =
+          std::max(arrival[edge.sink], arrival[u] + delays_[edge.sink]);
+      if (--pending[edge.sink] == 0) {
+        ready.push_back(edge.sink);
+      }
+    }
+  }
+  if (visited != n) {
+    return std::nullopt;
+  }
+  return arrival;
+}
+
+std::optional<int64_t> RetimingGraph::Period(
+    const std::vector<int64_t>& r) const {
+  std::optional<std::vector<int64_t>> arrival = Arrivals(r);
+  if (!arrival.has_value()) {
+    return std::nullopt;
+  }
+  return *std::max_element(arrival->begin(), arrival->end());
+}
+
+bool RetimingGraph::Legalize(std::vector<int64_t>& r) const {
+  for (int64_t pass = 0; pass <= vertex_count() + 1; ++pass) {
+    bool changed = false;
+    for (const RetimingEdge& edge : edges_) {
+      if (!edge.free && RetimedWeight(edge, r) < 0) {
+        r[edge.sink] = r[edge.source] - edge.weight;
+        changed = true;
+      }
+    }
+    if (!changed) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool RetimingGraph::IsLegalAt(int64_t v, const std::vector<int64_t>& r) const {
+  for (const std::vector<int64_t>* edges : {&in_edges_[v], &out_edges_[v]}) {
+    for (int64_t e : *edges) {
+      if (RetimedWeight(edges_[e], r) < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+std::optional<std::vector<int64_t>> RetimingGraph::FindRetiming(
+    int64_t period) const {
+  // A variant of the FEAS algorithm of Leiserson and Saxe: every vertex whose
+  // arrival time exceeds the period pulls a register from its outputs to its
+  // inputs until no such vertex remains. The host is pinned so the latency
+  // from every fixed node to every other is unchanged; edges made illegal by
+  // a move are repaired by raising their sink, which is monotone and so
+  // converges whenever a retiming exists.
+  std::vector<int64_t> r(vertex_count() + 1, 0);
+  for (int64_t round = 0; round <= vertex_count() + 1; ++round) {
+    if (!Legalize(r)) {
+      return std::nullopt;
+    }
+    std::optional<std::vector<int64_t>> arrival = Arrivals(r);
+    if (!arrival.has_value()) {
+      return std::nullopt;
+    }
+    bool moved = false;
+    for (int64_t v = 0; v < vertex_count(); ++v) {
+      if ((*arrival)[v] > period) {
+        ++r[v];
+        moved = true;
+      }
+    }
+    if (!moved) {
+      // Legalization may have raised the host; re-pin it at zero.
+      const int64_t offset = r[host()];
+      for (int64_t& value : r) {
+        value -= offset;
+      }
+      return r;
+    }
+  }
+  return std::nullopt;
+}
+
+int64_t RetimingGraph::GroupDepth(const SourceGroup& group,
+                                  const std::vector<int64_t>& r) const {
+  int64_t depth = 0;
+  for (int64_t e : group.edges) {
+    depth = std::max(depth, RetimedWeight(edges_[e], r));
+  }
+  return depth;
+}
+
+int64_t RetimingGraph::GroupBits(const SourceGroup& group,
+                                 const std::vector<int64_t>& r) const {
+  return GroupDepth(group, r) * group.bit_count;
+}
+
+int64_t RetimingGraph::RegisterBits(const std::vector<int64_t>& r) const {
+  int64_t bits = 0;
+  for (const SourceGroup& group : groups_) {
+    bits += GroupBits(group, r);
+  }
+  return bits;
+}
+
+void RetimingGraph::MinimizeRegisters(int64_t period,
+                                      std::vector<int64_t>& r) const {
+  // Moving a vertex only changes the register chains of the vertex itself and
+  // of the sources feeding it.
+  auto local_bits = [&](int64_t v) {
+    absl::flat_hash_set<int64_t> groups;
+    if (vertex_group_[v] != -1) {
+      groups.insert(vertex_group_[v]);
+    }
+    for (int64_t e : in_edges_[v]) {
+      groups.insert(edges_[e].group);
+    }
+    int64_t bits = 0;
+    for (int64_t g : groups) {
+      bits += GroupBits(groups_[g], r);
+    }
+    return bits;
+  };
+  for (int64_t round = 0; round < kMaxMinimizationRounds; ++round) {
+    bool improved = false;
+    for (int64_t v = 0; v < vertex_count(); ++v) {
+      for (int64_t step : {-1, 1}) {
+        const int64_t before = local_bits(v);
+        r[v] += step;
+        if (IsLegalAt(v, r) && local_bits(v) < before) {
+          std::optional<int64_t> new_period = Period(r);
+          if (new_period.has_value() && *new_period <= period) {
+            improved = true;
+            continue;
+          }
+        }
+        r[v] -= step;
+      }
+    }
+    if (!improved) {
+      break;
+    }
+  }
+}
+
+absl::Status RetimingGraph::Apply(const std::vector<int64_t>& r, Block* block,
+                                  CodegenMetadata& metadata) const {
+  // Build the register chain of each source and point every consumer at the
+  // stage of the chain it needs.
+  absl::flat_hash_map<Node*, std::vector<Node*>> chains;
+  for (const SourceGroup& group : groups_) {
+    std::vector<Node*>& taps = chains[group.node];
+    taps.push_back(group.node);
+    const int64_t depth = GroupDepth(group, r);
+    for (int64_t stage = 1; stage <= depth; ++stage) {
+      XLS_ASSIGN_OR_RETURN(
+          Register * reg,
+          block->AddRegister(absl::StrCat(group.node->GetName(), "_retimed"),
+                             group.node->GetType()));
+      XLS_RETURN_IF_ERROR(block
+                              ->MakeNode<RegisterWrite>(
+                                  /*loc=*/SourceInfo(), taps.back(),
+                                  /*load_enable=*/std::nullopt,
+                                  /*reset=*/std::nullopt, reg)
+                              .status());
+      XLS_ASSIGN_OR_RETURN(RegisterRead * read,
+                           block->MakeNodeWithName<RegisterRead>(
+                               /*loc=*/SourceInfo(), reg,
+                               /*name=*/reg->name()));
+      taps.push_back(read);
+    }
+  }
+  for (const RetimingEdge& edge : edges_) {
+    Node* tap = edge.free
+                    ? edge.source_node
+                    : chains.at(edge.source_node).at(RetimedWeight(edge, r));
+    if (edge.consumer->operand(edge.operand_no) != tap) {
+      XLS_RETURN_IF_ERROR(
+          edge.consumer->ReplaceOperandNumber(edge.operand_no, tap));
+    }
+  }
+
+  // Remove the original registers: writes first as they may use the reads of
+  // other retimed registers.
+  absl::flat_hash_set<Register*> removed(retimable_registers_.begin(),
+                                         retimable_registers_.end());
+  std::vector<RegisterRead*> reads;
+  for (Register* reg : retimable_registers_) {
+    XLS_ASSIGN_OR_RETURN(RegisterWrite * write, block->GetRegisterWrite(reg));
+    XLS_ASSIGN_OR_RETURN(RegisterRead * read, block->GetRegisterRead(reg));
+    XLS_RETURN_IF_ERROR(block->RemoveNode(write));
+    reads.push_back(read);
+  }
+  for (RegisterRead* read : reads) {
+    XLS_RET_CHECK(read->users().empty()) << read->GetName();
+    XLS_RETURN_IF_ERROR(block->RemoveNode(read));
+  }
+  for (Register* reg : retimable_registers_) {
+    XLS_RETURN_IF_ERROR(block->RemoveRegister(reg));
+  }
+  for (auto& stage : metadata.streaming_io_and_pipeline.pipeline_registers) {
+    std::erase_if(stage, [&](const PipelineRegister& pr) {
+      return removed.contains(pr.reg);
+    });
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> RunOnBlock(Block* block, CodegenMetadata& metadata,
+                                const DelayEstimator& delay_estimator) {
+  XLS_ASSIGN_OR_RETURN(std::optional<RetimingGraph> graph,
+                       RetimingGraph::Create(block, metadata, delay_estimator));
+  if (!graph.has_value()) {
+    return false;
+  }
+  std::vector<int64_t> best(graph->vertex_count() + 1, 0);
+  std::optional<int64_t> original_period = graph->Period(best);
+  XLS_RET_CHECK(original_period.has_value())
+      << "Combinational cycle in block " << block->name();
+
+  // The period can never drop below the slowest single operation.
+  int64_t lo = graph->max_vertex_delay();
+  int64_t hi = *original_period;
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    std::optional<std::vector<int64_t>> r = graph->FindRetiming(mid);
+    if (r.has_value()) {
+      hi = *graph->Period(*r);
+      best = *std::move(r);
+    } else {
+      lo = mid + 1;
+    }
+  }
+  graph->MinimizeRegisters(hi, best);
+
+  const int64_t bits = graph->RegisterBits(best);
+  VLOG(2) << "Retiming block " << block->name() << ": period "
+          << *original_period << " -> " << hi << ", register bits "
+          << graph->original_register_bits() << " -> " << bits;
+  if (hi >= *original_period && bits >= graph->original_register_bits()) {
+    return false;
+  }
+  XLS_RETURN_IF_ERROR(graph->Apply(best, block, metadata));
+  return true;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> RegisterRetimingPass::RunInternal(
+    CodegenPassUnit* unit, const CodegenPassOptions& options,
+    CodegenPassResults* results) const {
+  if (!options.codegen_options.retime_registers()) {
+    return false;
+  }
+  if (options.delay_estimator == nullptr) {
+    VLOG(2) << "Not retiming registers: no delay estimator given.";
+    return false;
+  }
+  bool changed = false;
+  for (auto& [block, metadata] : unit->metadata) {
+    XLS_ASSIGN_OR_RETURN(
+        bool block_changed,
+        RunOnBlock(block, metadata, *options.delay_estimator));
+    changed = changed || block_changed;
+  }
+  if (changed) {
+    unit->GcMetadata();
+  }
+  return changed;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,56 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+#define XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
+
+#include <cstdint>
+
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_pass.h"
+
+namespace xls::verilog {
+
+// Moves pipeline registers across the combinational logic of each block
+// (Leiserson-Saxe retiming) to minimize the clock period estimated by the
+// delay estimator in the pass options, and then the number of register bits
+// needed at that period.
+//
+// Only registers without a reset or load enable which do not hold proc state
+// are moved. All other registers, the ports, instantiations and side-effecting
+// operations are fixed, so the latency of every path between them is
+// preserved. The values held by retimed registers before the pipeline first
+// fills may differ, as they do for any register without a reset.
+//
+// The pass only runs when CodegenOptions::retime_registers() is set and a
+// delay estimator is given.
+class RegisterRetimingPass : public CodegenPass {
+ public:
+  // Blocks with more retimable operations than this are left untouched.
+  static constexpr int64_t kMaxRetimingNodes = 2048;
+
+  RegisterRetimingPass()
+      : CodegenPass("register_retiming",
+                    "Retime pipeline registers to minimize the clock period") {}
+  ~RegisterRetimingPass() override = default;
+
+  absl::StatusOr<bool> RunInternal(CodegenPassUnit* unit,
+                                   const CodegenPassOptions& options,
+                                   CodegenPassResults* results) const override;
+};
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_REGISTER_RETIMING_PASS_H_
@@ -0,0 +1,210 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/register_retiming_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/codegen_options.h"
+#include "xls/codegen/codegen_pass.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/interpreter/block_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+
+namespace xls::verilog {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+// Unit delay delay estimator.
+class TestDelayEstimator : public DelayEstimator {
+ public:
+  TestDelayEstimator() : DelayEstimator("test") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    switch (node->op()) {
+      case Op::kInputPort:
+      case Op::kOutputPort:
+      case Op::kLiteral:
+      case Op::kRegisterRead:
+      case Op::kRegisterWrite:
+        return 0;
+      default:
+        return 1;
+    }
+  }
+};
+
+class RegisterRetimingPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Block* block, bool retime_registers = true) {
+    CodegenPassUnit unit(block->package(), block);
+    CodegenPassOptions options;
+    options.codegen_options.retime_registers(retime_registers);
+    options.delay_estimator = &delay_estimator_;
+    CodegenPassResults results;
+    return RegisterRetimingPass().Run(&unit, options, &results);
+  }
+
+  // Returns the longest register-to-register delay of `block`.
+  int64_t Period(Block* block) {
+    absl::flat_hash_map<Node*, int64_t> arrival;
+    int64_t period = 0;
+    for (Node* node : TopoSort(block)) {
+      int64_t start = 0;
+      if (!node->Is<RegisterRead>()) {
+        for (Node* operand : node->operands()) {
+          start = std::max(start, arrival[operand]);
+        }
+      }
+      arrival[node] = start + *delay_estimator_.GetOperationDelayInPs(node);
+      period = std::max(period, arrival[node]);
+    }
+    return period;
+  }
+
+  int64_t RegisterBits(Block* block) {
+    int64_t bits = 0;
+    for (Register* reg : block->GetRegisters()) {
+      bits += reg->type()->GetFlatBitCount();
+    }
+    return bits;
+  }
+
+  // Simulates `block` on `inputs` and returns the outputs from cycle `latency`
+  // on, after which the initial register values no longer matter.
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> Simulate(
+      Block* block,
+      const std::vector<absl::flat_hash_map<std::string, uint64_t>>& inputs,
+      int64_t latency) {
+    absl::StatusOr<std::vector<absl::flat_hash_map<std::string, uint64_t>>>
+        outputs = InterpretSequentialBlock(block, inputs);
+    EXPECT_TRUE(outputs.ok()) << outputs.status();
+    if (!outputs.ok()) {
+      return {};
+    }
+    return std::vector<absl::flat_hash_map<std::string, uint64_t>>(
+        outputs->begin() + latency, outputs->end());
+  }
+
+  TestDelayEstimator delay_estimator_;
+};
+
+TEST_F(RegisterRetimingPassTest, BalancesUnbalancedPipeline) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue x = bb.Add(a, bb.Literal(UBits(3, 8)));
+  x = bb.Not(x);
+  x = bb.UMul(x, a);
+  x = bb.Subtract(x, a);
+  x = bb.InsertRegister("r0", x);
+  x = bb.InsertRegister("r1", x);
+  bb.OutputPort("out", x);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs;
+  for (uint64_t i = 0; i < 32; ++i) {
+    inputs.push_back({{"a", (i * 37) % 256}});
+  }
+  auto expected = Simulate(block, inputs, /*latency=*/2);
+  EXPECT_EQ(Period(block), 4);
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_EQ(Period(block), 2);
+  EXPECT_EQ(Simulate(block, inputs, /*latency=*/2), expected);
+
+  // Already optimal.
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+}
+
+TEST_F(RegisterRetimingPassTest, MovesRegistersAcrossNarrowingOperations) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InsertRegister("a_reg", bb.InputPort("a", p->GetBitsType(8)));
+  BValue b = bb.InsertRegister("b_reg", bb.InputPort("b", p->GetBitsType(8)));
+  bb.OutputPort("out", bb.Add(a, b));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  std::vector<absl::flat_hash_map<std::string, uint64_t>> inputs;
+  for (uint64_t i = 0; i < 32; ++i) {
+    inputs.push_back({{"a", (i * 37) % 256}, {"b", (i * 11) % 256}});
+  }
+  auto expected = Simulate(block, inputs, /*latency=*/1);
+  EXPECT_EQ(RegisterBits(block), 16);
+
+  // The period is already minimal; a single register after the add halves
+  // the register bits.
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_EQ(Period(block), 1);
+  EXPECT_EQ(RegisterBits(block), 8);
+  EXPECT_EQ(Simulate(block, inputs, /*latency=*/1), expected);
+}
+
+TEST_F(RegisterRetimingPassTest, RegistersWithResetAreFixed) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue rst = bb.InputPort("rst", p->GetBitsType(1));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue x = bb.Not(bb.Negate(bb.Not(a)));
+  x = bb.InsertRegister("r0", x, rst,
+                        xls::Reset{.reset_value = Value(UBits(0, 8)),
+                                   .asynchronous = false,
+                                   .active_low = false});
+  bb.OutputPort("out", x);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block), IsOkAndHolds(false));
+  EXPECT_EQ(Period(block), 3);
+}
+
+TEST_F(RegisterRetimingPassTest, DisabledByDefault) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  BValue a = bb.InputPort("a", p->GetBitsType(8));
+  BValue x = bb.Not(bb.Negate(bb.Not(a)));
+  x = bb.InsertRegister("r0", x);
+  bb.OutputPort("out", bb.InsertRegister("r1", x));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  EXPECT_THAT(Run(block, /*retime_registers=*/false), IsOkAndHolds(false));
+  EXPECT_EQ(Period(block), 3);
+  EXPECT_THAT(Run(block), IsOkAndHolds(true));
+  EXPECT_EQ(Period(block), 1);
+}
+
+}  // namespace
+}  // namespace xls::verilog
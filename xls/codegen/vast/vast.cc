@@ -76,6 +76,26 @@ void LineInfoIncrease(LineInfo* line_info, int64_t delta) {
   }
 }
 
+// Returns the text of `node` as streamed by its EmitTo() override. Nodes which
+// override EmitTo() implement Emit() with this.
+std::string EmitViaWriter(const VastNode* node, LineInfo* line_info) {
+  VastWriter out;
+  node->EmitTo(&out, line_info);
+  return std::move(out).Release();
+}
+
+// Streams `expr` into `out`, wrapped in parentheses if `paren_wrap` is true.
+void EmitMaybeParenWrapped(VastWriter* out, const Expression* expr,
+                           bool paren_wrap, LineInfo* line_info) {
+  if (paren_wrap) {
+    out->Write("(");
+  }
+  expr->EmitTo(out, line_info);
+  if (paren_wrap) {
+    out->Write(")");
+  }
+}
+
 // Converts a `DataKind` to its SystemVerilog name, if any. Emitting a data type
 // in most contexts requires the containing entity to emit both the `DataKind`
 // and the `DataType`, at least one of which should emit as nonempty.
@@ -297,6 +317,28 @@ void LineInfo::End(const VastNode* node) {
 
 void LineInfo::Increase(int64_t delta) { current_line_number_ += delta; }
 
+void VastWriter::Write(std::string_view text) {
+  while (!text.empty()) {
+    size_t newline = text.find('\n');
+    std::string_view line = text.substr(0, newline);
+    if (!line.empty()) {
+      // As with Indent(), empty lines are not indented to avoid trailing
+      // whitespace.
+      if (at_line_start_) {
+        text_.append(indent_, ' ');
+      }
+      text_.append(line);
+      at_line_start_ = false;
+    }
+    if (newline == std::string_view::npos) {
+      return;
+    }
+    text_.push_back('\n');
+    at_line_start_ = true;
+    text.remove_prefix(newline + 1);
+  }
+}
+
 std::optional<std::vector<LineSpan>> LineInfo::LookupNode(
     const VastNode* node) const {
   if (!spans_.contains(node)) {
@@ -433,16 +475,17 @@ UnpackedArrayType* VerilogFile::UnpackedArrayType(
 }
 
 std::string VerilogFile::Emit(LineInfo* line_info) const {
-  auto file_member_str = [=](const FileMember& member) -> std::string {
-    return absl::visit([=](auto* m) { return m->Emit(line_info); }, member);
-  };
+  VastWriter out;
+  EmitTo(&out, line_info);
+  return std::move(out).Release();
+}
 
-  std::string out;
+void VerilogFile::EmitTo(VastWriter* out, LineInfo* line_info) const {
   for (const FileMember& member : members_) {
-    absl::StrAppend(&out, file_member_str(member), "\n");
+    absl::visit([=](auto* m) { m->EmitTo(out, line_info); }, member);
+    out->Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  return out;
 }
 
 LocalParamItemRef* LocalParam::AddItem(std::string_view name, Expression* value,
@@ -467,23 +510,29 @@ std::string CaseArm::Emit(LineInfo* line_info) const {
 }
 
 std::string StatementBlock::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void StatementBlock::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   // TODO(meheff): We can probably be smarter about optionally emitting the
   // begin/end.
   if (statements_.empty()) {
+    out->Write("begin end");
     LineInfoEnd(line_info, this);
-    return "begin end";
+    return;
   }
-  std::string result = "begin\n";
+  out->Write("begin\n");
   LineInfoIncrease(line_info, 1);
-  std::vector<std::string> lines;
+  out->Indent();
   for (const auto& statement : statements_) {
-    lines.push_back(statement->Emit(line_info));
+    statement->EmitTo(out, line_info);
+    out->Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(absl::StrJoin(lines, "\n")), "\nend");
+  out->Dedent();
+  out->Write("end");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 GenerateLoop::GenerateLoop(LogicRef* genvar, Expression* init,
@@ -1006,8 +1055,9 @@ GenvarDef::GenvarDef(std::string_view name, VerilogFile* file,
 namespace {
 
 // "Match" statement for emitting a ModuleMember.
-std::string EmitModuleMember(LineInfo* line_info, const ModuleMember& member) {
-  return absl::visit([=](auto* d) { return d->Emit(line_info); }, member);
+void EmitModuleMember(VastWriter* out, LineInfo* line_info,
+                      const ModuleMember& member) {
+  absl::visit([=](auto* d) { d->EmitTo(out, line_info); }, member);
 }
 
 // Visitor for emitting a VerilogPackageMember.
@@ -1019,22 +1069,29 @@ std::string EmitVerilogPackageMember(LineInfo* line_info,
 }  // namespace
 
 std::string ModuleSection::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void ModuleSection::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::vector<std::string> elements;
+  bool first = true;
   for (const ModuleMember& member : members_) {
     if (std::holds_alternative<ModuleSection*>(member)) {
       if (std::get<ModuleSection*>(member)->members_.empty()) {
         continue;
       }
     }
-    elements.push_back(EmitModuleMember(line_info, member));
+    if (!first) {
+      out->Write("\n");
+    }
+    first = false;
+    EmitModuleMember(out, line_info, member);
     LineInfoIncrease(line_info, 1);
   }
-  if (!elements.empty()) {
+  if (!first) {
     LineInfoIncrease(line_info, -1);
   }
   LineInfoEnd(line_info, this);
-  return absl::StrJoin(elements, "\n");
 }
 
 std::string VerilogPackageSection::Emit(LineInfo* line_info) const {
@@ -1057,11 +1114,18 @@ std::string VerilogPackageSection::Emit(LineInfo* line_info) const {
 }
 
 std::string ContinuousAssignment::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void ContinuousAssignment::EmitTo(VastWriter* out,
+                                  LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string lhs = lhs_->Emit(line_info);
-  std::string rhs = rhs_->Emit(line_info);
+  out->Write("assign ");
+  lhs_->EmitTo(out, line_info);
+  out->Write(" = ");
+  rhs_->EmitTo(out, line_info);
+  out->Write(";");
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("assign %s = %s;", lhs, rhs);
 }
 
 std::string Comment::Emit(LineInfo* line_info) const {
@@ -1192,31 +1256,35 @@ std::string SystemFunctionCall::Emit(LineInfo* line_info) const {
 }
 
 std::string Module::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Module::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrCat("module ", name_);
+  out->Write(absl::StrCat("module ", name_));
   if (ports_.empty()) {
-    absl::StrAppend(&result, ";\n");
+    out->Write(";\n");
     LineInfoIncrease(line_info, 1);
   } else {
-    absl::StrAppend(&result, "(\n  ");
+    out->Write("(\n");
     LineInfoIncrease(line_info, 1);
-    absl::StrAppend(
-        &result,
-        absl::StrJoin(ports_, ",\n  ", [=](std::string* out, const Port& port) {
-          std::string wire_str = port.wire->EmitNoSemi(line_info);
-          CHECK(CannotStripWhitespace(wire_str));
-          absl::StrAppendFormat(out, "%s %s", ToString(port.direction),
-                                wire_str);
-          LineInfoIncrease(line_info, 1);
-        }));
-    absl::StrAppend(&result, "\n);\n");
+    for (int64_t i = 0; i < ports_.size(); ++i) {
+      std::string wire_str = ports_[i].wire->EmitNoSemi(line_info);
+      CHECK(CannotStripWhitespace(wire_str));
+      out->Write(absl::StrFormat("  %s %s%s", ToString(ports_[i].direction),
+                                 wire_str, i + 1 < ports_.size() ? ",\n" : ""));
+      LineInfoIncrease(line_info, 1);
+    }
+    out->Write("\n);\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, Indent(top_.Emit(line_info)), "\n");
+  out->Indent();
+  top_.EmitTo(out, line_info);
+  out->Dedent();
+  out->Write("\n");
   LineInfoIncrease(line_info, 1);
-  absl::StrAppend(&result, "endmodule");
+  out->Write("endmodule");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string VerilogPackage::Emit(LineInfo* line_info) const {
@@ -1307,6 +1375,10 @@ static bool IsScalarLogicRef(IndexableExpression* expr) {
 }
 
 std::string Slice::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Slice::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   if (IsScalarLogicRef(subject_)) {
     // If subject is scalar (no width given in declaration) then avoid slicing
@@ -1315,27 +1387,39 @@ std::string Slice::Emit(LineInfo* line_info) const {
     // and perform the equivalent logic at a higher abstraction level than VAST.
     CHECK(hi_->IsLiteralWithValue(0)) << hi_->Emit(nullptr);
     CHECK(lo_->IsLiteralWithValue(0)) << lo_->Emit(nullptr);
-    std::string result = subject_->Emit(line_info);
+    subject_->EmitTo(out, line_info);
     LineInfoEnd(line_info, this);
-    return result;
+    return;
   }
-  std::string subject = subject_->Emit(line_info);
-  std::string hi = hi_->Emit(line_info);
-  std::string lo = lo_->Emit(line_info);
+  subject_->EmitTo(out, line_info);
+  out->Write("[");
+  hi_->EmitTo(out, line_info);
+  out->Write(":");
+  lo_->EmitTo(out, line_info);
+  out->Write("]");
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s[%s:%s]", subject, hi, lo);
 }
 
 std::string PartSelect::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void PartSelect::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string subject = subject_->Emit(line_info);
-  std::string start = start_->Emit(line_info);
-  std::string width = width_->Emit(line_info);
+  subject_->EmitTo(out, line_info);
+  out->Write("[");
+  start_->EmitTo(out, line_info);
+  out->Write(" +: ");
+  width_->EmitTo(out, line_info);
+  out->Write("]");
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s[%s +: %s]", subject, start, width);
 }
 
 std::string Index::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Index::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   if (IsScalarLogicRef(subject_)) {
     // If subject is scalar (no width given in declaration) then avoid indexing
@@ -1344,14 +1428,15 @@ std::string Index::Emit(LineInfo* line_info) const {
     // and perform the equivalent logic at a higher abstraction level than VAST.
     CHECK(index_->IsLiteralWithValue(0)) << absl::StreamFormat(
         "%s[%s]", subject_->Emit(nullptr), index_->Emit(nullptr));
-    std::string result = subject_->Emit(line_info);
+    subject_->EmitTo(out, line_info);
     LineInfoEnd(line_info, this);
-    return result;
+    return;
   }
-  std::string subject = subject_->Emit(line_info);
-  std::string index = index_->Emit(line_info);
+  subject_->EmitTo(out, line_info);
+  out->Write("[");
+  index_->EmitTo(out, line_info);
+  out->Write("]");
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s[%s]", subject, index);
 }
 
 // Returns the given string wrapped in parentheses.
@@ -1360,18 +1445,20 @@ static std::string ParenWrap(std::string_view s) {
 }
 
 std::string Ternary::Emit(LineInfo* line_info) const {
-  auto maybe_paren_wrap = [this, line_info](Expression* e) {
-    if (e->precedence() <= precedence()) {
-      return ParenWrap(e->Emit(line_info));
-    }
-    return e->Emit(line_info);
+  return EmitViaWriter(this, line_info);
+}
+
+void Ternary::EmitTo(VastWriter* out, LineInfo* line_info) const {
+  auto emit_maybe_paren_wrapped = [&](Expression* e) {
+    EmitMaybeParenWrapped(out, e, e->precedence() <= precedence(), line_info);
   };
   LineInfoStart(line_info, this);
-  std::string result = absl::StrFormat("%s ? %s : %s", maybe_paren_wrap(test_),
-                                       maybe_paren_wrap(consequent_),
-                                       maybe_paren_wrap(alternate_));
+  emit_maybe_paren_wrapped(test_);
+  out->Write(" ? ");
+  emit_maybe_paren_wrapped(consequent_);
+  out->Write(" : ");
+  emit_maybe_paren_wrapped(alternate_);
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Parameter::Emit(LineInfo* line_info) const {
@@ -1512,6 +1599,10 @@ std::string LocalParam::Emit(LineInfo* line_info) const {
 }
 
 std::string BinaryInfix::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void BinaryInfix::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   auto is_unary_reduction = [](Expression* e) {
     return e->IsUnary() && e->AsUnaryOrDie()->IsReduction();
@@ -1523,34 +1614,40 @@ std::string BinaryInfix::Emit(LineInfo* line_info) const {
   // reduction operations should be wrapped in parenthesis unconditionally
   // because some consumers of verilog emit warnings/errors for this
   // error-prone construct (e.g., `|x || |y`)
-  std::string lhs_string =
-      (lhs_->precedence() < precedence() || is_unary_reduction(lhs_))
-          ? ParenWrap(lhs_->Emit(line_info))
-          : lhs_->Emit(line_info);
-  std::string rhs_string =
-      (rhs_->precedence() <= precedence() || is_unary_reduction(rhs_))
-          ? ParenWrap(rhs_->Emit(line_info))
-          : rhs_->Emit(line_info);
+  EmitMaybeParenWrapped(
+      out, lhs_,
+      lhs_->precedence() < precedence() || is_unary_reduction(lhs_),
+      line_info);
+  out->Write(absl::StrCat(" ", op_, " "));
+  EmitMaybeParenWrapped(
+      out, rhs_,
+      rhs_->precedence() <= precedence() || is_unary_reduction(rhs_),
+      line_info);
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s %s %s", lhs_string, op_, rhs_string);
 }
 
 std::string Concat::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Concat::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result;
   if (replication_ != nullptr) {
-    absl::StrAppend(&result, "{", replication_->Emit(line_info));
+    out->Write("{");
+    replication_->EmitTo(out, line_info);
   }
-  absl::StrAppendFormat(
-      &result, "{%s}",
-      absl::StrJoin(args_, ", ", [=](std::string* out, Expression* e) {
-        absl::StrAppend(out, e->Emit(line_info));
-      }));
+  out->Write("{");
+  for (int64_t i = 0; i < args_.size(); ++i) {
+    if (i != 0) {
+      out->Write(", ");
+    }
+    args_[i]->EmitTo(out, line_info);
+  }
+  out->Write("}");
   if (replication_ != nullptr) {
-    absl::StrAppend(&result, "}");
+    out->Write("}");
   }
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string ArrayAssignmentPattern::Emit(LineInfo* line_info) const {
@@ -1564,16 +1661,18 @@ std::string ArrayAssignmentPattern::Emit(LineInfo* line_info) const {
 }
 
 std::string Unary::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Unary::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   // Nested unary ops should be wrapped in parentheses as this is required by
   // some consumers of Verilog.
-  std::string result =
-      absl::StrFormat("%s%s", op_,
-                      ((arg_->precedence() < precedence()) || arg_->IsUnary())
-                          ? ParenWrap(arg_->Emit(line_info))
-                          : arg_->Emit(line_info));
+  out->Write(op_);
+  EmitMaybeParenWrapped(
+      out, arg_, arg_->precedence() < precedence() || arg_->IsUnary(),
+      line_info);
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 StatementBlock* Case::AddCaseArm(CaseLabel label) {
@@ -1611,21 +1710,26 @@ static std::string CaseTypeToString(CaseType case_type) {
 }
 
 std::string Case::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Case::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result = absl::StrFormat(
-      "%s (%s)\n", CaseTypeToString(case_type_), subject_->Emit(line_info));
+  out->Write(absl::StrCat(CaseTypeToString(case_type_), " ("));
+  subject_->EmitTo(out, line_info);
+  out->Write(")\n");
   LineInfoIncrease(line_info, 1);
+  out->Indent();
   for (auto& arm : arms_) {
-    std::string arm_string = arm->Emit(line_info);
-    std::string stmts_string = arm->statements()->Emit(line_info);
-    absl::StrAppend(&result,
-                    Indent(absl::StrFormat("%s: %s", arm_string, stmts_string)),
-                    "\n");
+    arm->EmitTo(out, line_info);
+    out->Write(": ");
+    arm->statements()->EmitTo(out, line_info);
+    out->Write("\n");
     LineInfoIncrease(line_info, 1);
   }
-  absl::StrAppend(&result, "endcase");
+  out->Dedent();
+  out->Write("endcase");
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 Conditional::Conditional(Expression* condition, VerilogFile* file,
@@ -1644,21 +1748,25 @@ StatementBlock* Conditional::AddAlternate(Expression* condition) {
 }
 
 std::string Conditional::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void Conditional::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result;
-  std::string cond = condition_->Emit(line_info);
-  std::string conseq = consequent()->Emit(line_info);
-  absl::StrAppendFormat(&result, "if (%s) %s", cond, conseq);
+  out->Write("if (");
+  condition_->EmitTo(out, line_info);
+  out->Write(") ");
+  consequent()->EmitTo(out, line_info);
   for (auto& alternate : alternates_) {
-    absl::StrAppend(&result, " else ");
+    out->Write(" else ");
     if (alternate.first != nullptr) {
-      absl::StrAppendFormat(&result, "if (%s) ",
-                            alternate.first->Emit(line_info));
+      out->Write("if (");
+      alternate.first->EmitTo(out, line_info);
+      out->Write(") ");
     }
-    absl::StrAppend(&result, alternate.second->Emit(line_info));
+    alternate.second->EmitTo(out, line_info);
   }
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string ConditionalDirectiveKindToString(ConditionalDirectiveKind kind) {
@@ -1836,19 +1944,30 @@ std::string Forever::Emit(LineInfo* line_info) const {
 }
 
 std::string BlockingAssignment::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void BlockingAssignment::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string lhs_str = lhs()->Emit(line_info);
-  std::string rhs_str = rhs()->Emit(line_info);
+  lhs()->EmitTo(out, line_info);
+  out->Write(" = ");
+  rhs()->EmitTo(out, line_info);
+  out->Write(";");
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s = %s;", lhs_str, rhs_str);
 }
 
 std::string NonblockingAssignment::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void NonblockingAssignment::EmitTo(VastWriter* out,
+                                   LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string lhs_str = lhs()->Emit(line_info);
-  std::string rhs_str = rhs()->Emit(line_info);
+  lhs()->EmitTo(out, line_info);
+  out->Write(" <= ");
+  rhs()->EmitTo(out, line_info);
+  out->Write(";");
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s <= %s;", lhs_str, rhs_str);
 }
 
 std::string ReturnStatement::Emit(LineInfo* line_info) const {
@@ -1877,25 +1996,32 @@ std::string EmitSensitivityListElement(LineInfo* line_info,
 }  // namespace
 
 std::string AlwaysBase::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void AlwaysBase::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   LineInfoIncrease(line_info, NumberOfNewlines(name()));
   std::string sensitivity_list = absl::StrJoin(
       sensitivity_list_, " or ",
-      [=](std::string* out, const SensitivityListElement& e) {
-        absl::StrAppend(out, EmitSensitivityListElement(line_info, e));
+      [=](std::string* result, const SensitivityListElement& e) {
+        absl::StrAppend(result, EmitSensitivityListElement(line_info, e));
       });
-  std::string statements = statements_->Emit(line_info);
+  out->Write(absl::StrFormat("%s @ (%s) ", name(), sensitivity_list));
+  statements_->EmitTo(out, line_info);
   LineInfoEnd(line_info, this);
-  return absl::StrFormat("%s @ (%s) %s", name(), sensitivity_list, statements);
 }
 
 std::string AlwaysComb::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void AlwaysComb::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
   LineInfoIncrease(line_info, NumberOfNewlines(name()));
-  std::string result =
-      absl::StrFormat("%s %s", name(), statements_->Emit(line_info));
+  out->Write(absl::StrCat(name(), " "));
+  statements_->EmitTo(out, line_info);
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Initial::Emit(LineInfo* line_info) const {
@@ -1943,8 +2069,11 @@ void AlwaysFlop::AddRegister(LogicRef* reg, Expression* reg_next,
 }
 
 std::string AlwaysFlop::Emit(LineInfo* line_info) const {
+  return EmitViaWriter(this, line_info);
+}
+
+void AlwaysFlop::EmitTo(VastWriter* out, LineInfo* line_info) const {
   LineInfoStart(line_info, this);
-  std::string result;
   std::string sensitivity_list =
       absl::StrCat("posedge ", clk_->Emit(line_info));
   if (rst_.has_value() && rst_->asynchronous) {
@@ -1952,10 +2081,9 @@ std::string AlwaysFlop::Emit(LineInfo* line_info) const {
                           (rst_->active_low ? "negedge" : "posedge"),
                           rst_->signal->Emit(line_info));
   }
-  absl::StrAppendFormat(&result, "always @ (%s) %s", sensitivity_list,
-                        top_block_->Emit(line_info));
+  out->Write(absl::StrFormat("always @ (%s) ", sensitivity_list));
+  top_block_->EmitTo(out, line_info);
   LineInfoEnd(line_info, this);
-  return result;
 }
 
 std::string Instantiation::Emit(LineInfo* line_info) const {
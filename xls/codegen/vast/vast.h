@@ -154,6 +154,33 @@ class LineInfo {
 // characters are replaced with '_'.
 std::string SanitizeIdentifier(std::string_view name);
 
+// Buffer into which VAST nodes stream their emitted text, so that a whole file
+// is built up in a single string rather than by concatenating the strings of
+// every subexpression. Nonempty lines started while the indentation level is
+// raised are indented, mirroring what Indent() does to emitted text.
+class VastWriter {
+ public:
+  VastWriter() = default;
+
+  void Write(std::string_view text);
+
+  // Raises (lowers) the indentation of subsequently started lines by
+  // `spaces`.
+  void Indent(int64_t spaces = 2) { indent_ += spaces; }
+  void Dedent(int64_t spaces = 2) {
+    CHECK_GE(indent_, spaces);
+    indent_ -= spaces;
+  }
+
+  const std::string& text() const { return text_; }
+  std::string Release() && { return std::move(text_); }
+
+ private:
+  std::string text_;
+  int64_t indent_ = 0;
+  bool at_line_start_ = true;
+};
+
 // Base type for a VAST node. All nodes are owned by a VerilogFile.
 class VastNode {
  public:
@@ -168,6 +195,13 @@ class VastNode {
 
   virtual std::string Emit(LineInfo* line_info) const = 0;
 
+  // Appends the text of this node to `out`, recording line spans in
+  // `line_info` if it is non-null. Nodes with children override this to stream
+  // the children into `out`; for those Emit() is a wrapper around EmitTo().
+  virtual void EmitTo(VastWriter* out, LineInfo* line_info) const {
+    out->Write(Emit(line_info));
+  }
+
  private:
   VerilogFile* file_;
   SourceInfo loc_;
@@ -629,6 +663,7 @@ class BlockingAssignment final : public AssignmentBase {
       : AssignmentBase(lhs, rhs, file, loc) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 };
 
 // Represents a nonblocking assignment  ("lhs <= rhs;").
@@ -639,6 +674,7 @@ class NonblockingAssignment final : public AssignmentBase {
       : AssignmentBase(lhs, rhs, file, loc) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 };
 
 // Represents an explicit SystemVerilog function return statement. The
@@ -671,6 +707,7 @@ class StatementBlock final : public VastNode {
   inline T* Add(const SourceInfo& loc, Args&&... args);
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
   absl::Span<Statement* const> statements() const { return statements_; }
 
@@ -778,6 +815,7 @@ class Case final : public Statement {
   StatementBlock* AddCaseArm(CaseLabel label);
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   Expression* subject_;
@@ -799,6 +837,7 @@ class Conditional final : public Statement {
   StatementBlock* AddAlternate(Expression* condition = nullptr);
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   Expression* condition_;
@@ -1486,6 +1525,7 @@ class Unary final : public Operator {
            op_ == "^" || op_ == "~^";
   }
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
   Expression* arg() const { return arg_; }
 
@@ -1519,6 +1559,7 @@ class AlwaysFlop final : public VastNode {
                    Expression* reset_value = nullptr);
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   LogicRef* clk_;
@@ -1560,6 +1601,7 @@ class AlwaysBase : public StructuredProcedure {
       : StructuredProcedure(file, loc),
         sensitivity_list_(sensitivity_list.begin(), sensitivity_list.end()) {}
   std::string Emit(LineInfo* line_info) const override;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const override;
 
  protected:
   virtual std::string name() const = 0;
@@ -1584,6 +1626,7 @@ class AlwaysComb final : public AlwaysBase {
   explicit AlwaysComb(VerilogFile* file, const SourceInfo& loc)
       : AlwaysBase({}, file, loc) {}
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  protected:
   std::string name() const final { return "always_comb"; }
@@ -1622,6 +1665,7 @@ class Concat final : public Expression {
         replication_(replication) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
   absl::Span<Expression* const> args() const { return args_; }
 
@@ -1653,6 +1697,7 @@ class BinaryInfix final : public Operator {
         rhs_(ABSL_DIE_IF_NULL(rhs)) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
   Expression* lhs() const { return lhs_; }
 
@@ -1773,6 +1818,7 @@ class Slice final : public Expression {
       : Expression(file, loc), subject_(subject), hi_(hi), lo_(lo) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   IndexableExpression* subject_;
@@ -1793,6 +1839,7 @@ class PartSelect final : public Expression {
         width_(width) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   IndexableExpression* subject_;
@@ -1810,6 +1857,7 @@ class Index final : public IndexableExpression {
       : IndexableExpression(file, loc), subject_(subject), index_(index) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   IndexableExpression* subject_;
@@ -1829,6 +1877,7 @@ class Ternary final : public Expression {
         alternate_(alternate) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
   int64_t precedence() const final { return 0; }
 
   Expression* test() const { return test_; }
@@ -1854,6 +1903,7 @@ class ContinuousAssignment final : public VastNode {
       : VastNode(file, loc), lhs_(lhs), rhs_(rhs) {}
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   Expression* lhs_;
@@ -2207,6 +2257,7 @@ class ModuleSection final : public VastNode {
   const std::vector<ModuleMember>& members() const { return members_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   std::vector<ModuleMember> members_;
@@ -2307,6 +2358,7 @@ class Module final : public VastNode {
   const std::string& name() const { return name_; }
 
   std::string Emit(LineInfo* line_info) const final;
+  void EmitTo(VastWriter* out, LineInfo* line_info) const final;
 
  private:
   // Add the given Def as a port on the module.
@@ -2464,6 +2516,8 @@ class VerilogFile {
   }
 
   std::string Emit(LineInfo* line_info = nullptr) const;
+  // Streams the text of the file into `out`; equivalent to appending Emit().
+  void EmitTo(VastWriter* out, LineInfo* line_info = nullptr) const;
 
   verilog::Slice* Slice(IndexableExpression* subject, Expression* hi,
                         Expression* lo, const SourceInfo& loc) {
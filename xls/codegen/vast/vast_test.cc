@@ -2351,6 +2351,63 @@ TEST_P(VastTest, SimpleGenerateLoop) {
 endmodule)");
 }
 
+TEST(VastWriterTest, IndentsNonemptyLines) {
+  VastWriter out;
+  out.Write("begin\n");
+  out.Indent();
+  out.Write("a;\n\nb");
+  out.Write(" + c;\n");
+  out.Dedent();
+  out.Write("end");
+  EXPECT_EQ(out.text(), "begin\n  a;\n\n  b + c;\nend");
+}
+
+TEST_P(VastTest, EmitToSharedWriter) {
+  VerilogFile f(GetFileType());
+  SourceInfo si;
+  Module* m = f.AddModule("top", si);
+  LogicRef* clk = m->AddInput("clk", f.ScalarType(si), si);
+  LogicRef* a = m->AddInput("a", f.BitVectorType(8, si), si);
+  LogicRef* b = m->AddInput("b", f.BitVectorType(8, si), si);
+  LogicRef* out = m->AddOutput("out", f.BitVectorType(8, si), si);
+  LogicRef* r = m->AddReg("r", f.BitVectorType(8, si), si);
+  m->Add<ContinuousAssignment>(si, out,
+                               f.Ternary(f.Equals(a, b, si), f.Negate(r, si),
+                                         f.Concat({f.Slice(a, 7, 4, si),
+                                                   f.Slice(b, 3, 0, si)},
+                                                  si),
+                                         si));
+  AlwaysFlop* af = m->Add<AlwaysFlop>(si, clk);
+  af->AddRegister(r, f.Add(a, b, si), si);
+
+  LineInfo line_info;
+  const std::string expected = f.Emit(&line_info);
+  EXPECT_EQ(expected, R"(module top(
+  input wire clk,
+  input wire [7:0] a,
+  input wire [7:0] b,
+  output wire [7:0] out
+);
+  reg [7:0] r;
+  assign out = a == b ? -r : {a[7:4], b[3:0]};
+  always @ (posedge clk) begin
+    r <= a + b;
+  end
+endmodule
+)");
+
+  // Streaming into a writer which already holds text appends the same text and
+  // records the same line spans.
+  VastWriter writer;
+  writer.Write("// header\n");
+  LineInfo streamed_line_info;
+  f.EmitTo(&writer, &streamed_line_info);
+  EXPECT_EQ(writer.text(), absl::StrCat("// header\n", expected));
+  for (const VastNode* node : line_info.nodes()) {
+    EXPECT_EQ(streamed_line_info.LookupNode(node), line_info.LookupNode(node));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(VastTestInstantiation, VastTest,
                          testing::Values(false, true),
                          [](const testing::TestParamInfo<bool>& info) {
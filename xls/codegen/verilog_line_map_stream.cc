@@ -0,0 +1,167 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/verilog_line_map_stream.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/varint.h"
+
+namespace xls::verilog {
+namespace {
+
+// Records are flushed to the file once this many bytes are buffered.
+constexpr int64_t kFlushThreshold = int64_t{1} << 20;
+
+// Reads the records of an encoded line map.
+class Decoder {
+ public:
+  explicit Decoder(std::string_view data) : data_(data) {}
+
+  bool AtEnd() const { return data_.empty(); }
+
+  absl::StatusOr<uint64_t> ReadVarint() { return ConsumeVarint(data_); }
+
+  absl::StatusOr<int64_t> ReadZigZag() { return ConsumeZigZagVarint(data_); }
+
+  absl::StatusOr<std::string_view> ReadString() {
+    XLS_ASSIGN_OR_RETURN(uint64_t size, ReadVarint());
+    if (size > data_.size()) {
+      return absl::InvalidArgumentError("Truncated Verilog line map string");
+    }
+    std::string_view result = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return result;
+  }
+
+ private:
+  std::string_view data_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<VerilogLineMapWriter>>
+VerilogLineMapWriter::Create(const std::filesystem::path& path) {
+  XLS_RETURN_IF_ERROR(SetFileContents(path, kVerilogLineMapStreamMagic));
+  return absl::WrapUnique(new VerilogLineMapWriter(path));
+}
+
+absl::Status VerilogLineMapWriter::Add(std::string_view source_file,
+                                       int64_t source_start,
+                                       int64_t source_end,
+                                       int64_t verilog_start,
+                                       int64_t verilog_end) {
+  if (source_end < source_start || verilog_end < verilog_start) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid Verilog line mapping from lines [%d, %d] to [%d, %d]",
+        source_start, source_end, verilog_start, verilog_end));
+  }
+  auto [it, inserted] =
+      file_indices_.try_emplace(source_file, file_indices_.size());
+  if (it->second == previous_file_index_) {
+    AppendVarint(0, buffer_);
+  } else {
+    AppendVarint(it->second + 1, buffer_);
+    if (inserted) {
+      AppendVarint(source_file.size(), buffer_);
+      absl::StrAppend(&buffer_, source_file);
+    }
+    previous_file_index_ = it->second;
+  }
+  AppendZigZagVarint(source_start - previous_source_start_, buffer_);
+  AppendVarint(source_end - source_start, buffer_);
+  AppendZigZagVarint(verilog_start - previous_verilog_start_, buffer_);
+  AppendVarint(verilog_end - verilog_start, buffer_);
+  previous_source_start_ = source_start;
+  previous_verilog_start_ = verilog_start;
+  return FlushIfFull();
+}
+
+absl::Status VerilogLineMapWriter::FlushIfFull() {
+  if (buffer_.size() < kFlushThreshold) {
+    return absl::OkStatus();
+  }
+  return Close();
+}
+
+absl::Status VerilogLineMapWriter::Close() {
+  if (buffer_.empty()) {
+    return absl::OkStatus();
+  }
+  XLS_RETURN_IF_ERROR(AppendStringToFile(path_, buffer_));
+  buffer_.clear();
+  return absl::OkStatus();
+}
+
+absl::StatusOr<VerilogLineMap> DecodeVerilogLineMap(
+    std::string_view data, std::string_view verilog_file) {
+  if (!data.starts_with(kVerilogLineMapStreamMagic)) {
+    return absl::InvalidArgumentError(
+        "Data does not start with the Verilog line map header");
+  }
+  data.remove_prefix(kVerilogLineMapStreamMagic.size());
+
+  VerilogLineMap map;
+  Decoder decoder(data);
+  std::vector<std::string_view> files;
+  int64_t file_index = -1;
+  int64_t source_start = 0;
+  int64_t verilog_start = 0;
+  while (!decoder.AtEnd()) {
+    XLS_ASSIGN_OR_RETURN(uint64_t file_ref, decoder.ReadVarint());
+    if (file_ref > 0) {
+      file_index = file_ref - 1;
+      if (file_index == files.size()) {
+        XLS_ASSIGN_OR_RETURN(std::string_view file, decoder.ReadString());
+        files.push_back(file);
+      }
+    }
+    if (file_index < 0 || file_index >= files.size()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid Verilog line map file ref: %d", file_ref));
+    }
+    XLS_ASSIGN_OR_RETURN(int64_t source_delta, decoder.ReadZigZag());
+    XLS_ASSIGN_OR_RETURN(uint64_t source_lines, decoder.ReadVarint());
+    XLS_ASSIGN_OR_RETURN(int64_t verilog_delta, decoder.ReadZigZag());
+    XLS_ASSIGN_OR_RETURN(uint64_t verilog_lines, decoder.ReadVarint());
+    source_start += source_delta;
+    verilog_start += verilog_delta;
+
+    VerilogLineMapping* mapping = map.add_mapping();
+    mapping->set_source_file(files[file_index]);
+    mapping->mutable_source_span()->set_line_start(source_start);
+    mapping->mutable_source_span()->set_line_end(source_start + source_lines);
+    mapping->set_verilog_file(verilog_file);
+    mapping->mutable_verilog_span()->set_line_start(verilog_start);
+    mapping->mutable_verilog_span()->set_line_end(verilog_start +
+                                                  verilog_lines);
+  }
+  return map;
+}
+
+}  // namespace xls::verilog
@@ -0,0 +1,91 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_CODEGEN_VERILOG_LINE_MAP_STREAM_H_
+#define XLS_CODEGEN_VERILOG_LINE_MAP_STREAM_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+
+namespace xls::verilog {
+
+// The header of files written by VerilogLineMapWriter.
+inline constexpr std::string_view kVerilogLineMapStreamMagic = "XLSVLM01";
+
+// Writes a Verilog line map to a file as it is produced, rather than
+// collecting it in a VerilogLineMap proto, so that the memory used does not
+// grow with the size of the map.
+//
+// The file holds the magic string `kVerilogLineMapStreamMagic` followed by one
+// record per mapping. Each record is a sequence of varints:
+//
+//   * The source file: zero if it is the same as that of the previous record,
+//     otherwise one plus its index in the order in which the source files first
+//     appear. The first appearance of a file is followed by the length and the
+//     bytes of its name.
+//   * The zigzag-encoded difference between the first source line and that of
+//     the previous record, then the number of source lines less one.
+//   * The same for the Verilog lines.
+//
+// The Verilog file is not recorded; it is the file emitted alongside the map.
+class VerilogLineMapWriter {
+ public:
+  // Creates (or truncates) the file at `path` and writes the header to it.
+  static absl::StatusOr<std::unique_ptr<VerilogLineMapWriter>> Create(
+      const std::filesystem::path& path);
+
+  // Adds a mapping from the inclusive range of source lines `[source_start,
+  // source_end]` of `source_file` to the Verilog lines `[verilog_start,
+  // verilog_end]`.
+  absl::Status Add(std::string_view source_file, int64_t source_start,
+                   int64_t source_end, int64_t verilog_start,
+                   int64_t verilog_end);
+
+  // Writes any buffered records to the file. Must be called once all mappings
+  // have been added; records still buffered when the writer is destroyed are
+  // lost.
+  absl::Status Close();
+
+ private:
+  explicit VerilogLineMapWriter(std::filesystem::path path)
+      : path_(std::move(path)) {}
+
+  absl::Status FlushIfFull();
+
+  std::filesystem::path path_;
+  std::string buffer_;
+  absl::flat_hash_map<std::string, int64_t> file_indices_;
+  int64_t previous_file_index_ = -1;
+  int64_t previous_source_start_ = 0;
+  int64_t previous_verilog_start_ = 0;
+};
+
+// Decodes the contents of a file written by VerilogLineMapWriter, setting the
+// Verilog file of every mapping to `verilog_file`.
+absl::StatusOr<VerilogLineMap> DecodeVerilogLineMap(
+    std::string_view data, std::string_view verilog_file = "");
+
+}  // namespace xls::verilog
+
+#endif  // XLS_CODEGEN_VERILOG_LINE_MAP_STREAM_H_
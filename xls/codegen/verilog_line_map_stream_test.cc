@@ -0,0 +1,125 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/codegen/verilog_line_map_stream.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/codegen/verilog_line_map.pb.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/proto_test_utils.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::verilog {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::xls::proto_testing::EqualsProto;
+
+TEST(VerilogLineMapStreamTest, RoundTrip) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerilogLineMapWriter> writer,
+                           VerilogLineMapWriter::Create(temp_file.path()));
+  XLS_ASSERT_OK(writer->Add("a.x", 10, 10, 3, 5));
+  XLS_ASSERT_OK(writer->Add("a.x", 7, 8, 6, 6));
+  XLS_ASSERT_OK(writer->Add("b.x", 1, 1, 2, 9));
+  XLS_ASSERT_OK(writer->Add("a.x", 12, 12, 10, 10));
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string data,
+                           GetFileContents(temp_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(VerilogLineMap map,
+                           DecodeVerilogLineMap(data, "out.v"));
+  EXPECT_THAT(map, EqualsProto(R"pb(
+                mapping {
+                  source_file: "a.x"
+                  source_span { line_start: 10 line_end: 10 }
+                  verilog_file: "out.v"
+                  verilog_span { line_start: 3 line_end: 5 }
+                }
+                mapping {
+                  source_file: "a.x"
+                  source_span { line_start: 7 line_end: 8 }
+                  verilog_file: "out.v"
+                  verilog_span { line_start: 6 line_end: 6 }
+                }
+                mapping {
+                  source_file: "b.x"
+                  source_span { line_start: 1 line_end: 1 }
+                  verilog_file: "out.v"
+                  verilog_span { line_start: 2 line_end: 9 }
+                }
+                mapping {
+                  source_file: "a.x"
+                  source_span { line_start: 12 line_end: 12 }
+                  verilog_file: "out.v"
+                  verilog_span { line_start: 10 line_end: 10 }
+                }
+              )pb"));
+}
+
+TEST(VerilogLineMapStreamTest, FlushesLargeMaps) {
+  constexpr int64_t kMappings = 500000;
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerilogLineMapWriter> writer,
+                           VerilogLineMapWriter::Create(temp_file.path()));
+  for (int64_t i = 0; i < kMappings; ++i) {
+    XLS_ASSERT_OK(writer->Add(i % 2 == 0 ? "even.x" : "odd.x", i, i + 1,
+                              1000 * i, 1000 * i + 999));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string data,
+                           GetFileContents(temp_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(VerilogLineMap map, DecodeVerilogLineMap(data));
+  ASSERT_EQ(map.mapping_size(), kMappings);
+  for (int64_t i = 0; i < kMappings; ++i) {
+    const VerilogLineMapping& mapping = map.mapping(i);
+    EXPECT_EQ(mapping.source_file(), i % 2 == 0 ? "even.x" : "odd.x");
+    EXPECT_EQ(mapping.source_span().line_start(), i);
+    EXPECT_EQ(mapping.source_span().line_end(), i + 1);
+    EXPECT_EQ(mapping.verilog_span().line_start(), 1000 * i);
+    EXPECT_EQ(mapping.verilog_span().line_end(), 1000 * i + 999);
+  }
+}
+
+TEST(VerilogLineMapStreamTest, RejectsInvalidData) {
+  EXPECT_THAT(DecodeVerilogLineMap("not a line map"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("header")));
+  std::string truncated(kVerilogLineMapStreamMagic);
+  truncated.push_back('\x01');
+  EXPECT_THAT(DecodeVerilogLineMap(truncated),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Truncated")));
+}
+
+TEST(VerilogLineMapStreamTest, RejectsInvertedSpans) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile temp_file, TempFile::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<VerilogLineMapWriter> writer,
+                           VerilogLineMapWriter::Create(temp_file.path()));
+  EXPECT_THAT(writer->Add("a.x", 3, 2, 1, 1),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls::verilog
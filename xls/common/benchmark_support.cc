@@ -16,15 +16,20 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
 
 // Workaround absl and benchmark:: fighting for flags.
 // TODO(https://github.com/google/xls/issues/1150): 2023-11-10 We should try to
 // remove this workaround at some point.
 ABSL_FLAG(std::optional<std::string>, benchmark_filter, std::nullopt,
           "regex to select benchmarks to run");
+ABSL_FLAG(std::optional<std::string>, benchmark_out, std::nullopt,
+          "file to which to write benchmark results as JSON, in addition to "
+          "the console report");
 
 namespace xls {
 
@@ -34,10 +39,19 @@ void RunSpecifiedBenchmarks() {
   // want to always run gtests so we can't use the standard BENCHMARK_MAIN
   // macro. This replicates the parts that configure benchmarks and run them
   // with our filters.
-  int fake_argc = 1;
-  char fake_argv[] = "benchmark";
-  char* fake_argv_ptr = &fake_argv[0];
-  benchmark::Initialize(&fake_argc, &fake_argv_ptr);
+  std::vector<std::string> fake_args = {"benchmark"};
+  if (absl::GetFlag(FLAGS_benchmark_out)) {
+    fake_args.push_back(
+        absl::StrCat("--benchmark_out=", *absl::GetFlag(FLAGS_benchmark_out)));
+    fake_args.push_back("--benchmark_out_format=json");
+  }
+  std::vector<char*> fake_argv;
+  fake_argv.reserve(fake_args.size());
+  for (std::string& arg : fake_args) {
+    fake_argv.push_back(arg.data());
+  }
+  int fake_argc = fake_argv.size();
+  benchmark::Initialize(&fake_argc, fake_argv.data());
 
   // Only run benchmarks if requested.
   if (absl::GetFlag(FLAGS_benchmark_filter)) {
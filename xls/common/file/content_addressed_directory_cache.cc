@@ -0,0 +1,163 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/content_addressed_directory_cache.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>  // NOLINT
+#include <utility>
+
+#include "absl/base/no_destructor.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/ADT/StringExtras.h"
+#include "llvm/include/llvm/Support/SHA256.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<ContentAddressedDirectoryCache>>
+ContentAddressedDirectoryCache::Create(const std::filesystem::path& directory,
+                                       const Options& options) {
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(directory));
+  return absl::WrapUnique(
+      new ContentAddressedDirectoryCache(directory, options));
+}
+
+/* static */ ContentAddressedDirectoryCache*
+ContentAddressedDirectoryCache::GetDefault(const Options& options) {
+  static absl::Mutex mutex(absl::kConstInit);
+  // Keyed by environment variable; null if the variable names no usable
+  // directory.
+  static absl::NoDestructor<
+      absl::flat_hash_map<std::string, ContentAddressedDirectoryCache*>>
+      defaults;
+  absl::MutexLock lock(&mutex);
+  auto [it, inserted] =
+      defaults->try_emplace(options.directory_env_var, nullptr);
+  if (!inserted) {
+    return it->second;
+  }
+  const char* directory =
+      std::getenv(std::string(options.directory_env_var).c_str());
+  if (directory == nullptr || *directory == '\0') {
+    return nullptr;
+  }
+  absl::StatusOr<std::unique_ptr<ContentAddressedDirectoryCache>> cache =
+      Create(directory, options);
+  if (!cache.ok()) {
+    LOG(WARNING) << "Unable to use " << options.description
+                 << " cache directory " << directory << ": " << cache.status();
+    return nullptr;
+  }
+  it->second = cache->release();
+  return it->second;
+}
+
+/* static */ std::string ContentAddressedDirectoryCache::ComputeKey(
+    absl::Span<const std::string_view> components) {
+  llvm::SHA256 hasher;
+  for (std::string_view component : components) {
+    hasher.update(absl::StrCat(component.size(), ":"));
+    hasher.update(component);
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::filesystem::path ContentAddressedDirectoryCache::EntryPath(
+    std::string_view key) const {
+  return *directory_ / absl::StrCat(key, options_.extension);
+}
+
+std::optional<std::string> ContentAddressedDirectoryCache::Lookup(
+    std::string_view key) {
+  if (keep_in_memory()) {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      hits_.fetch_add(1, std::memory_order_relaxed);
+      VLOG(2) << absl::StreamFormat("%s cache hit for %s", options_.description,
+                                    key);
+      return it->second;
+    }
+  }
+  absl::StatusOr<std::string> contents =
+      directory_.has_value() ? GetFileContents(EntryPath(key))
+                             : absl::NotFoundError("No cache directory");
+  if (!contents.ok()) {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    VLOG(2) << absl::StreamFormat("%s cache miss for %s", options_.description,
+                                  key);
+    return std::nullopt;
+  }
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  VLOG(2) << absl::StreamFormat("%s cache hit for %s", options_.description,
+                                key);
+  if (keep_in_memory()) {
+    absl::MutexLock lock(&mutex_);
+    entries_.emplace(key, *contents);
+  }
+  return *std::move(contents);
+}
+
+absl::Status ContentAddressedDirectoryCache::Store(std::string_view key,
+                                                   std::string_view contents) {
+  if (keep_in_memory()) {
+    absl::MutexLock lock(&mutex_);
+    entries_.insert_or_assign(key, contents);
+  }
+  if (!directory_.has_value()) {
+    return absl::OkStatus();
+  }
+  // Write to a uniquely named temporary file and rename it into place so that
+  // concurrent readers and writers always see a complete entry.
+  std::filesystem::path temp_path =
+      *directory_ /
+      absl::StrFormat("%s.tmp.%d.%d", key, getpid(),
+                      next_temp_id_.fetch_add(1, std::memory_order_relaxed));
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, contents));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, EntryPath(key), ec);
+  if (ec) {
+    absl::Status status = absl::InternalError(
+        absl::StrFormat("Unable to store %s %s in cache: %s",
+                        options_.description, key, ec.message()));
+    std::filesystem::remove(temp_path, ec);
+    return status;
+  }
+  return absl::OkStatus();
+}
+
+void ContentAddressedDirectoryCache::RecordUnusableEntry() {
+  hits_.fetch_sub(1, std::memory_order_relaxed);
+  misses_.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace xls
@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_CONTENT_ADDRESSED_DIRECTORY_CACHE_H_
+#define XLS_COMMON_FILE_CONTENT_ADDRESSED_DIRECTORY_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A persistent cache of byte strings stored in a directory on disk, one file
+// per entry, keyed by a digest of everything the entry depends on (see
+// ComputeKey). Entries may also be kept in memory. Thread-safe, and a cache
+// directory may be shared by concurrent processes.
+//
+// Users derive keys and serialize values; this class only stores them.
+class ContentAddressedDirectoryCache {
+ public:
+  // Describes a kind of cache. The strings must outlive the cache; they are
+  // expected to be literals.
+  struct Options {
+    // Name of the environment variable which, if set, names the directory
+    // used by the cache returned by GetDefault.
+    std::string_view directory_env_var;
+    // Appended to a key to form the name of the file holding its entry.
+    std::string_view extension;
+    // Describes the entries in log and error messages, e.g. "JIT object".
+    std::string_view description;
+    // Whether entries read from or written to the directory are also kept in
+    // memory, so repeated lookups don't read the file again.
+    bool keep_in_memory = false;
+  };
+
+  // Creates a cache which is only kept in memory.
+  explicit ContentAddressedDirectoryCache(const Options& options)
+      : options_(options) {}
+
+  // Creates a cache backed by `directory`, creating the directory if
+  // necessary.
+  static absl::StatusOr<std::unique_ptr<ContentAddressedDirectoryCache>>
+  Create(const std::filesystem::path& directory, const Options& options);
+
+  // Returns the process-wide cache backed by the directory named by
+  // `options.directory_env_var`, or nullptr if the variable is unset or the
+  // directory cannot be created.
+  static ContentAddressedDirectoryCache* GetDefault(const Options& options);
+
+  // Returns a digest of `components`. Each component is length-prefixed so
+  // distinct inputs can't collide by shifting bytes between components.
+  static std::string ComputeKey(absl::Span<const std::string_view> components);
+
+  // Returns the entry stored under `key` or std::nullopt if there is none.
+  // Updates the hit/miss counters.
+  std::optional<std::string> Lookup(std::string_view key);
+
+  // Stores `contents` under `key`. Writes to disk are atomic so concurrent
+  // readers never observe a partially written entry.
+  absl::Status Store(std::string_view key, std::string_view contents);
+
+  // Counts a lookup which found an entry that the user could not deserialize
+  // as a miss rather than a hit.
+  void RecordUnusableEntry();
+
+  const std::optional<std::filesystem::path>& directory() const {
+    return directory_;
+  }
+
+  int64_t hits() const { return hits_.load(std::memory_order_relaxed); }
+  int64_t misses() const { return misses_.load(std::memory_order_relaxed); }
+
+ private:
+  ContentAddressedDirectoryCache(std::filesystem::path directory,
+                                 const Options& options)
+      : options_(options), directory_(std::move(directory)) {}
+
+  bool keep_in_memory() const {
+    return options_.keep_in_memory || !directory_.has_value();
+  }
+  std::filesystem::path EntryPath(std::string_view key) const;
+
+  Options options_;
+  std::optional<std::filesystem::path> directory_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, std::string> entries_
+      ABSL_GUARDED_BY(mutex_);
+  std::atomic<int64_t> hits_ = 0;
+  std::atomic<int64_t> misses_ = 0;
+  std::atomic<int64_t> next_temp_id_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_CONTENT_ADDRESSED_DIRECTORY_CACHE_H_
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/content_addressed_directory_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using ::testing::Eq;
+using ::testing::Optional;
+
+constexpr ContentAddressedDirectoryCache::Options kOptions = {
+    .directory_env_var = "XLS_TEST_CACHE_DIR_WHICH_IS_NEVER_SET",
+    .extension = ".test",
+    .description = "test"};
+
+TEST(ContentAddressedDirectoryCacheTest, StoreAndLookup) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ContentAddressedDirectoryCache> cache,
+      ContentAddressedDirectoryCache::Create(temp_dir.path() / "cache",
+                                             kOptions));
+
+  EXPECT_EQ(cache->Lookup("abc"), std::nullopt);
+  EXPECT_EQ(cache->misses(), 1);
+  EXPECT_EQ(cache->hits(), 0);
+
+  XLS_ASSERT_OK(cache->Store("abc", std::string("con\0tents", 9)));
+  EXPECT_TRUE(std::filesystem::exists(temp_dir.path() / "cache" / "abc.test"));
+  EXPECT_THAT(cache->Lookup("abc"), Optional(Eq(std::string("con\0tents", 9))));
+  EXPECT_EQ(cache->misses(), 1);
+  EXPECT_EQ(cache->hits(), 1);
+}
+
+TEST(ContentAddressedDirectoryCacheTest, PersistsAcrossInstances) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<ContentAddressedDirectoryCache> cache,
+        ContentAddressedDirectoryCache::Create(temp_dir.path(), kOptions));
+    XLS_ASSERT_OK(cache->Store("abc", "contents"));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ContentAddressedDirectoryCache> cache,
+      ContentAddressedDirectoryCache::Create(temp_dir.path(), kOptions));
+  EXPECT_THAT(cache->Lookup("abc"), Optional(Eq("contents")));
+  EXPECT_EQ(cache->Lookup("def"), std::nullopt);
+  EXPECT_EQ(cache->hits(), 1);
+  EXPECT_EQ(cache->misses(), 1);
+}
+
+TEST(ContentAddressedDirectoryCacheTest, InMemoryOnly) {
+  ContentAddressedDirectoryCache cache(kOptions);
+  EXPECT_EQ(cache.directory(), std::nullopt);
+  EXPECT_EQ(cache.Lookup("abc"), std::nullopt);
+  XLS_ASSERT_OK(cache.Store("abc", "contents"));
+  EXPECT_THAT(cache.Lookup("abc"), Optional(Eq("contents")));
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST(ContentAddressedDirectoryCacheTest, KeepInMemory) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  ContentAddressedDirectoryCache::Options options = kOptions;
+  options.keep_in_memory = true;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ContentAddressedDirectoryCache> cache,
+      ContentAddressedDirectoryCache::Create(temp_dir.path(), options));
+  XLS_ASSERT_OK(cache->Store("abc", "contents"));
+
+  // The entry is still found once the file holding it is gone.
+  std::filesystem::remove(temp_dir.path() / "abc.test");
+  EXPECT_THAT(cache->Lookup("abc"), Optional(Eq("contents")));
+  EXPECT_EQ(cache->hits(), 1);
+}
+
+TEST(ContentAddressedDirectoryCacheTest, RecordUnusableEntry) {
+  ContentAddressedDirectoryCache cache(kOptions);
+  XLS_ASSERT_OK(cache.Store("abc", "garbage"));
+  ASSERT_TRUE(cache.Lookup("abc").has_value());
+  cache.RecordUnusableEntry();
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+TEST(ContentAddressedDirectoryCacheTest, KeyIsLengthPrefixed) {
+  std::string key = ContentAddressedDirectoryCache::ComputeKey({"ab", "c"});
+  EXPECT_EQ(ContentAddressedDirectoryCache::ComputeKey({"ab", "c"}), key);
+  EXPECT_NE(ContentAddressedDirectoryCache::ComputeKey({"a", "bc"}), key);
+  EXPECT_NE(ContentAddressedDirectoryCache::ComputeKey({"abc"}), key);
+  EXPECT_NE(ContentAddressedDirectoryCache::ComputeKey({"ab", "c", ""}), key);
+}
+
+TEST(ContentAddressedDirectoryCacheTest, NoDefaultWithoutEnvironmentVariable) {
+  EXPECT_EQ(ContentAddressedDirectoryCache::GetDefault(kOptions), nullptr);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,84 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/file/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/file_descriptor.h"
+#include "xls/common/status/error_code_to_status.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<MappedFile> MappedFile::Open(
+    const std::filesystem::path& path) {
+  FileDescriptor fd(open(path.c_str(), O_RDONLY));
+  if (fd.get() < 0) {
+    return ErrnoToStatus(errno) << "Could not open " << path.string();
+  }
+  struct stat st;
+  if (fstat(fd.get(), &st) != 0) {
+    return ErrnoToStatus(errno) << "Could not stat " << path.string();
+  }
+  if (!S_ISREG(st.st_mode)) {
+    return absl::FailedPreconditionError(
+        absl::StrCat(path.string(), " is not a regular file"));
+  }
+  size_t size = st.st_size;
+  if (size == 0) {
+    return MappedFile(nullptr, 0);
+  }
+  // The mapping stays valid after the descriptor is closed.
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd.get(), 0);
+  if (data == MAP_FAILED) {
+    return ErrnoToStatus(errno) << "Could not map " << path.string();
+  }
+  madvise(data, size, MADV_SEQUENTIAL);
+  return MappedFile(data, size);
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+
+MappedFile::MappedFile(MappedFile&& other)
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) {
+  if (this != &other) {
+    Unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+void MappedFile::Unmap() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+    data_ = nullptr;
+    size_ = 0;
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,60 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_FILE_MAPPED_FILE_H_
+#define XLS_COMMON_FILE_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <filesystem>  // NOLINT
+#include <string_view>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// RAII wrapper around a read-only, private memory mapping of a regular file.
+// The file is advised to be read sequentially.
+class MappedFile {
+ public:
+  // Maps the file at `path`. Returns a FailedPrecondition error if `path` is
+  // not a regular file (e.g. a pipe), for which callers may fall back to
+  // reading the file. An empty file yields an empty mapping.
+  static absl::StatusOr<MappedFile> Open(const std::filesystem::path& path);
+
+  ~MappedFile();
+
+  // MappedFile is movable but not copyable.
+  MappedFile(MappedFile&& other);
+  MappedFile& operator=(MappedFile&& other);
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  const void* data() const { return data_; }
+  size_t size() const { return size_; }
+  std::string_view contents() const {
+    return std::string_view(static_cast<const char*>(data_), size_);
+  }
+
+ private:
+  MappedFile(void* data, size_t size) : data_(data), size_(size) {}
+
+  void Unmap();
+
+  void* data_;
+  size_t size_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_FILE_MAPPED_FILE_H_
@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/resource_usage.h"
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <fstream>
+#include <optional>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+thread_local int64_t analysis_timer_depth = 0;
+thread_local absl::Duration analysis_time_on_thread = absl::ZeroDuration();
+
+}  // namespace
+
+std::optional<int64_t> GetCurrentRssBytes() {
+  // The second field of statm is the number of resident pages.
+  std::ifstream statm("/proc/self/statm");
+  int64_t size_pages;
+  int64_t resident_pages;
+  if (!(statm >> size_pages >> resident_pages)) {
+    return std::nullopt;
+  }
+  int64_t page_size = sysconf(_SC_PAGESIZE);
+  if (page_size <= 0) {
+    return std::nullopt;
+  }
+  return resident_pages * page_size;
+}
+
+std::optional<int64_t> GetPeakRssBytes() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) {
+    return std::nullopt;
+  }
+#ifdef __APPLE__
+  // Reported in bytes on macOS and kilobytes elsewhere.
+  return static_cast<int64_t>(usage.ru_maxrss);
+#else
+  return static_cast<int64_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+ScopedAnalysisTimer::ScopedAnalysisTimer() {
+  if (analysis_timer_depth++ == 0) {
+    start_ = absl::Now();
+  }
+}
+
+ScopedAnalysisTimer::~ScopedAnalysisTimer() {
+  if (--analysis_timer_depth == 0) {
+    analysis_time_on_thread += absl::Now() - start_;
+  }
+}
+
+// static
+absl::Duration ScopedAnalysisTimer::ElapsedOnThisThread() {
+  return analysis_time_on_thread;
+}
+
+}  // namespace xls
@@ -0,0 +1,55 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_RESOURCE_USAGE_H_
+#define XLS_COMMON_RESOURCE_USAGE_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/time/time.h"
+
+namespace xls {
+
+// Returns the current resident set size of this process in bytes, or
+// std::nullopt if it cannot be determined on this platform.
+std::optional<int64_t> GetCurrentRssBytes();
+
+// Returns the largest resident set size of this process so far in bytes, or
+// std::nullopt if it cannot be determined on this platform.
+std::optional<int64_t> GetPeakRssBytes();
+
+// Accumulates the wall time spent constructing compiler analyses (e.g.,
+// populating query engines) on the current thread, so that profiles can
+// attribute analysis time to whatever is running on the thread. Nested timers
+// only count the outermost scope.
+class ScopedAnalysisTimer {
+ public:
+  ScopedAnalysisTimer();
+  ~ScopedAnalysisTimer();
+
+  ScopedAnalysisTimer(const ScopedAnalysisTimer&) = delete;
+  ScopedAnalysisTimer& operator=(const ScopedAnalysisTimer&) = delete;
+
+  // Total time spent inside (outermost) timers on this thread. Callers are
+  // expected to take differences of this value around the region of interest.
+  static absl::Duration ElapsedOnThisThread();
+
+ private:
+  absl::Time start_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_RESOURCE_USAGE_H_
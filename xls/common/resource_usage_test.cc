@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/resource_usage.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace xls {
+namespace {
+
+TEST(ResourceUsageTest, RssIsPositive) {
+  std::optional<int64_t> current = GetCurrentRssBytes();
+  std::optional<int64_t> peak = GetPeakRssBytes();
+  ASSERT_TRUE(current.has_value());
+  ASSERT_TRUE(peak.has_value());
+  EXPECT_GT(*current, 0);
+  EXPECT_GT(*peak, 0);
+}
+
+TEST(ResourceUsageTest, PeakRssGrowsWithAllocation) {
+  std::optional<int64_t> before = GetPeakRssBytes();
+  ASSERT_TRUE(before.has_value());
+  // Touch every page so the memory is actually resident.
+  std::vector<char> buffer(int64_t{256} << 20, 1);
+  std::optional<int64_t> after = GetPeakRssBytes();
+  ASSERT_TRUE(after.has_value());
+  EXPECT_GE(*after, *before);
+  EXPECT_GE(*after, static_cast<int64_t>(buffer.size()));
+}
+
+TEST(ResourceUsageTest, AnalysisTimerCountsOutermostScopeOnly) {
+  absl::Duration before = ScopedAnalysisTimer::ElapsedOnThisThread();
+  absl::Time start = absl::Now();
+  {
+    ScopedAnalysisTimer outer;
+    {
+      ScopedAnalysisTimer inner;
+      absl::SleepFor(absl::Milliseconds(10));
+    }
+  }
+  absl::Duration wall = absl::Now() - start;
+  absl::Duration elapsed =
+      ScopedAnalysisTimer::ElapsedOnThisThread() - before;
+  EXPECT_GE(elapsed, absl::Milliseconds(10));
+  EXPECT_LE(elapsed, wall);
+}
+
+}  // namespace
+}  // namespace xls
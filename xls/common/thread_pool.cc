@@ -0,0 +1,187 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "absl/log/check.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+// Identifies the pool and worker index of the current thread, if it is a
+// worker thread.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int64_t current_worker = -1;
+
+}  // namespace
+
+ThreadPool::ThreadPool(int64_t num_threads) {
+  if (num_threads <= 0) {
+    num_threads = std::max(AvailableCPUs(), 1);
+  }
+  queues_.reserve(num_threads);
+  for (int64_t i = 0; i < num_threads; ++i) {
+    queues_.push_back(std::make_unique<WorkerQueue>());
+  }
+  workers_.reserve(num_threads);
+  for (int64_t i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Thread>([this, i]() { WorkerLoop(i); }));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  WaitForIdle();
+  {
+    absl::MutexLock lock(&mutex_);
+    shutting_down_ = true;
+  }
+  for (std::unique_ptr<Thread>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+void ThreadPool::Schedule(std::function<void()> task) {
+  int64_t index;
+  if (current_pool == this) {
+    index = current_worker;
+  } else {
+    absl::MutexLock lock(&mutex_);
+    index = next_queue_;
+    next_queue_ = (next_queue_ + 1) % num_threads();
+  }
+  {
+    WorkerQueue& queue = *queues_[index];
+    absl::MutexLock lock(&queue.mutex);
+    queue.tasks.push_back(std::move(task));
+  }
+  // The task must be visible in a queue before it is counted so that a worker
+  // which claims it is guaranteed to find it.
+  absl::MutexLock lock(&mutex_);
+  ++queued_;
+  ++outstanding_;
+}
+
+void ThreadPool::ParallelFor(int64_t n, int64_t grain,
+                             absl::FunctionRef<void(int64_t)> fn) {
+  grain = std::max<int64_t>(grain, 1);
+  const int64_t chunk_count = (n + grain - 1) / grain;
+  if (chunk_count <= 1) {
+    for (int64_t i = 0; i < n; ++i) {
+      fn(i);
+    }
+    return;
+  }
+  struct State {
+    State(int64_t chunk_count, absl::FunctionRef<void(int64_t)> fn)
+        : chunk_count(chunk_count),
+          fn(fn),
+          remaining(static_cast<int>(chunk_count)) {}
+    const int64_t chunk_count;
+    // Only called for claimed chunks, all of which finish before ParallelFor
+    // returns.
+    const absl::FunctionRef<void(int64_t)> fn;
+    std::atomic<int64_t> next_chunk = 0;
+    absl::BlockingCounter remaining;
+  };
+  // Tasks which start after all chunks are claimed still touch the state, so
+  // it is shared with them rather than living on this stack frame.
+  auto state = std::make_shared<State>(chunk_count, fn);
+  auto run_chunks = [state, n, grain]() {
+    for (int64_t chunk = state->next_chunk.fetch_add(1);
+         chunk < state->chunk_count; chunk = state->next_chunk.fetch_add(1)) {
+      const int64_t end = std::min(n, (chunk + 1) * grain);
+      for (int64_t i = chunk * grain; i < end; ++i) {
+        state->fn(i);
+      }
+      state->remaining.DecrementCount();
+    }
+  };
+  const int64_t helpers = std::min(num_threads(), chunk_count - 1);
+  for (int64_t i = 0; i < helpers; ++i) {
+    Schedule(run_chunks);
+  }
+  run_chunks();
+  state->remaining.Wait();
+}
+
+void ThreadPool::WaitForIdle() {
+  CHECK(current_pool != this) << "WaitForIdle called from a worker thread";
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(
+      +[](int64_t* outstanding) { return *outstanding == 0; }, &outstanding_));
+}
+
+bool ThreadPool::TryTakeTask(int64_t index, std::function<void()>& task) {
+  {
+    WorkerQueue& own = *queues_[index];
+    absl::MutexLock lock(&own.mutex);
+    if (!own.tasks.empty()) {
+      task = std::move(own.tasks.back());
+      own.tasks.pop_back();
+      return true;
+    }
+  }
+  for (int64_t i = 1; i < num_threads(); ++i) {
+    WorkerQueue& victim = *queues_[(index + i) % num_threads()];
+    absl::MutexLock lock(&victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::WorkerLoop(int64_t index) {
+  current_pool = this;
+  current_worker = index;
+  auto has_work_or_shutdown = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return queued_ > 0 || shutting_down_;
+  };
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(&has_work_or_shutdown));
+      if (queued_ == 0) {
+        return;
+      }
+      // Claim one of the queued tasks.
+      --queued_;
+    }
+    std::function<void()> task;
+    // A claimed task is guaranteed to be in some queue, but another worker
+    // may race us to the queue we would have found it in, so keep looking.
+    while (!TryTakeTask(index, task)) {
+    }
+    task();
+    // Destroy the task (and anything it captured) before reporting it done.
+    task = nullptr;
+    absl::MutexLock lock(&mutex_);
+    --outstanding_;
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,94 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_THREAD_POOL_H_
+#define XLS_COMMON_THREAD_POOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+
+// A fixed-size pool of worker threads with per-worker task deques. Tasks
+// scheduled from a worker thread are pushed onto that worker's own deque and
+// are popped LIFO (for locality); idle workers steal FIFO from the other
+// workers' deques. Tasks scheduled from outside the pool are distributed
+// round-robin.
+//
+// The destructor waits for all scheduled tasks to finish before joining the
+// workers. ThreadPool is thread-safe.
+class ThreadPool {
+ public:
+  // Creates a pool with `num_threads` workers. If `num_threads` is zero or
+  // negative, AvailableCPUs() workers are created.
+  explicit ThreadPool(int64_t num_threads = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Schedules `task` to run on some worker thread.
+  void Schedule(std::function<void()> task);
+
+  // Calls `fn(i)` for every i in [0, n), in chunks of `grain` consecutive
+  // indices spread over the workers, and returns once every call has finished.
+  // The calling thread works on chunks too and only waits for chunks other
+  // threads have already claimed, so ParallelFor may be called from a task
+  // running on this pool without deadlocking. Calls for different indices may
+  // run concurrently.
+  void ParallelFor(int64_t n, int64_t grain,
+                   absl::FunctionRef<void(int64_t)> fn);
+
+  // Blocks until every task scheduled so far (and every task those tasks
+  // schedule) has finished. Must not be called from a worker thread.
+  void WaitForIdle();
+
+  int64_t num_threads() const { return static_cast<int64_t>(workers_.size()); }
+
+ private:
+  struct WorkerQueue {
+    absl::Mutex mutex;
+    std::deque<std::function<void()>> tasks ABSL_GUARDED_BY(mutex);
+  };
+
+  void WorkerLoop(int64_t index);
+
+  // Takes a task from worker `index`'s own queue, or steals one from another
+  // worker. Returns false if no task is available anywhere.
+  bool TryTakeTask(int64_t index, std::function<void()>& task);
+
+  std::vector<std::unique_ptr<WorkerQueue>> queues_;
+  std::vector<std::unique_ptr<Thread>> workers_;
+
+  // Guards the bookkeeping used to park idle workers and to wait for idleness.
+  absl::Mutex mutex_;
+  // Number of tasks which are scheduled but not yet started.
+  int64_t queued_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of tasks which are scheduled or running.
+  int64_t outstanding_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t next_queue_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool shutting_down_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_THREAD_POOL_H_
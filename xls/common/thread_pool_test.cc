@@ -0,0 +1,93 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/thread_pool.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+TEST(ThreadPoolTest, RunsAllTasks) {
+  ThreadPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  std::atomic<int64_t> count = 0;
+  for (int64_t i = 0; i < 1000; ++i) {
+    pool.Schedule([&count]() { ++count; });
+  }
+  pool.WaitForIdle();
+  EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ThreadPoolTest, TasksCanScheduleTasks) {
+  ThreadPool pool(3);
+  std::atomic<int64_t> count = 0;
+  std::function<void(int64_t)> fan_out = [&](int64_t depth) {
+    ++count;
+    if (depth == 0) {
+      return;
+    }
+    pool.Schedule([&, depth]() { fan_out(depth - 1); });
+    pool.Schedule([&, depth]() { fan_out(depth - 1); });
+  };
+  pool.Schedule([&]() { fan_out(9); });
+  pool.WaitForIdle();
+  // A full binary tree of depth 9 has 2^10 - 1 nodes.
+  EXPECT_EQ(count.load(), 1023);
+}
+
+TEST(ThreadPoolTest, DestructorWaitsForTasks) {
+  std::atomic<int64_t> count = 0;
+  {
+    ThreadPool pool(2);
+    for (int64_t i = 0; i < 100; ++i) {
+      pool.Schedule([&count]() { ++count; });
+    }
+  }
+  EXPECT_EQ(count.load(), 100);
+}
+
+TEST(ThreadPoolTest, ParallelForVisitsEachIndexOnce) {
+  ThreadPool pool(4);
+  std::vector<std::atomic<int64_t>> visits(1000);
+  pool.ParallelFor(visits.size(), /*grain=*/7,
+                   [&](int64_t i) { ++visits[i]; });
+  for (const std::atomic<int64_t>& v : visits) {
+    EXPECT_EQ(v.load(), 1);
+  }
+}
+
+// Every worker of the pool runs a ParallelFor of its own; the callers make
+// progress on their own loops rather than waiting for the busy workers.
+TEST(ThreadPoolTest, ParallelForFromWorkers) {
+  ThreadPool pool(2);
+  std::atomic<int64_t> count = 0;
+  pool.ParallelFor(4, /*grain=*/1, [&](int64_t) {
+    pool.ParallelFor(100, /*grain=*/10, [&](int64_t) { ++count; });
+  });
+  EXPECT_EQ(count.load(), 400);
+}
+
+TEST(ThreadPoolTest, DefaultThreadCount) {
+  ThreadPool pool;
+  EXPECT_GE(pool.num_threads(), 1);
+}
+
+}  // namespace
+}  // namespace xls
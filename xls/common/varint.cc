@@ -0,0 +1,62 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/varint.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+
+namespace xls {
+
+void AppendVarint(uint64_t value, std::string& out) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+void AppendZigZagVarint(int64_t value, std::string& out) {
+  AppendVarint((static_cast<uint64_t>(value) << 1) ^
+                   static_cast<uint64_t>(value >> 63),
+               out);
+}
+
+absl::StatusOr<uint64_t> ConsumeVarint(std::string_view& data) {
+  uint64_t value = 0;
+  for (int64_t shift = 0; shift < 64; shift += 7) {
+    if (data.empty()) {
+      return absl::InvalidArgumentError("Truncated varint");
+    }
+    uint8_t byte = static_cast<uint8_t>(data.front());
+    data.remove_prefix(1);
+    value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return value;
+    }
+  }
+  return absl::InvalidArgumentError("Overlong varint");
+}
+
+absl::StatusOr<int64_t> ConsumeZigZagVarint(std::string_view& data) {
+  XLS_ASSIGN_OR_RETURN(uint64_t value, ConsumeVarint(data));
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}  // namespace xls
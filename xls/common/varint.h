@@ -0,0 +1,46 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_COMMON_VARINT_H_
+#define XLS_COMMON_VARINT_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+
+namespace xls {
+
+// Variable-length integers: seven bits per byte, least significant group
+// first, with the high bit set on all but the last byte. This is the encoding
+// of protocol buffer varints and of the gate deltas of binary AIGER files.
+
+// Appends `value` to `out` as a varint.
+void AppendVarint(uint64_t value, std::string& out);
+
+// Appends `value` to `out` as a zigzag-encoded varint, so that values of small
+// magnitude take few bytes whatever their sign.
+void AppendZigZagVarint(int64_t value, std::string& out);
+
+// Reads a varint from the front of `data` and removes it. Returns an error if
+// `data` ends within the varint or the varint doesn't fit in 64 bits.
+absl::StatusOr<uint64_t> ConsumeVarint(std::string_view& data);
+
+// Reads a zigzag-encoded varint from the front of `data` and removes it.
+absl::StatusOr<int64_t> ConsumeZigZagVarint(std::string_view& data);
+
+}  // namespace xls
+
+#endif  // XLS_COMMON_VARINT_H_
@@ -0,0 +1,105 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/common/varint.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(VarintTest, Encoding) {
+  std::string out;
+  AppendVarint(0, out);
+  EXPECT_EQ(out, std::string("\x00", 1));
+  out.clear();
+  AppendVarint(0x7f, out);
+  EXPECT_EQ(out, "\x7f");
+  out.clear();
+  AppendVarint(300, out);
+  EXPECT_EQ(out, "\xac\x02");
+  out.clear();
+  AppendVarint(std::numeric_limits<uint64_t>::max(), out);
+  EXPECT_EQ(out.size(), 10);
+}
+
+TEST(VarintTest, RoundTrip) {
+  const uint64_t kValues[] = {0, 1, 127, 128, 16383, 16384, uint64_t{1} << 35,
+                              std::numeric_limits<uint64_t>::max()};
+  std::string out;
+  for (uint64_t value : kValues) {
+    AppendVarint(value, out);
+  }
+  std::string_view data = out;
+  for (uint64_t value : kValues) {
+    EXPECT_THAT(ConsumeVarint(data), IsOkAndHolds(value));
+  }
+  EXPECT_TRUE(data.empty());
+}
+
+TEST(VarintTest, ZigZagRoundTrip) {
+  const int64_t kValues[] = {0,
+                             -1,
+                             1,
+                             -64,
+                             64,
+                             std::numeric_limits<int64_t>::min(),
+                             std::numeric_limits<int64_t>::max()};
+  std::string out;
+  for (int64_t value : kValues) {
+    AppendZigZagVarint(value, out);
+  }
+  std::string_view data = out;
+  for (int64_t value : kValues) {
+    EXPECT_THAT(ConsumeZigZagVarint(data), IsOkAndHolds(value));
+  }
+  EXPECT_TRUE(data.empty());
+
+  // Small magnitudes take one byte whatever their sign.
+  out.clear();
+  AppendZigZagVarint(-64, out);
+  EXPECT_EQ(out.size(), 1);
+}
+
+TEST(VarintTest, MalformedInput) {
+  std::string_view truncated = "\x80\x80";
+  EXPECT_THAT(ConsumeVarint(truncated),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Truncated")));
+  std::string_view empty;
+  EXPECT_THAT(ConsumeVarint(empty),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Truncated")));
+  std::string overlong(10, '\x80');
+  overlong.push_back('\x01');
+  std::string_view data = overlong;
+  EXPECT_THAT(ConsumeVarint(data),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Overlong")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -18,8 +18,10 @@
 #include <cstdint>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 
@@ -40,6 +42,12 @@ class AreaEstimator {
     return delay_estimator_->GetOperationDelayInPs(node);
   }
 
+  // Returns the estimated areas of the given nodes, in the same order.
+  absl::StatusOr<std::vector<int64_t>> GetOperationAreas(
+      absl::Span<Node* const> nodes) const {
+    return delay_estimator_->GetOperationDelaysInPs(nodes);
+  }
+
  private:
   const DelayEstimator* delay_estimator_;
 };
@@ -30,6 +30,7 @@ namespace xls {
 namespace {
 
 using ::absl_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
 
 class AreaEstimatorTest : public IrTestBase {};
 
@@ -52,6 +53,8 @@ TEST_F(AreaEstimatorTest, AreaModelTesting2Point5MuxPerNode) {
           "area_model_testing_2_point_5_mux_per_node"));
   EXPECT_THAT(area_estimator->GetOperationArea(add_node), IsOkAndHolds(5));
   EXPECT_THAT(area_estimator->GetOperationArea(mux_node), IsOkAndHolds(2));
+  EXPECT_THAT(area_estimator->GetOperationAreas({add_node, mux_node}),
+              IsOkAndHolds(ElementsAre(5, 2)));
 }
 
 TEST_F(AreaEstimatorTest, AreaModelIce40Multiply) {
@@ -18,7 +18,9 @@
 #include <memory>
 #include <optional>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
@@ -57,21 +59,48 @@ absl::Status BasicIntegrationAlgorithm::Initialize() {
 absl::StatusOr<std::unique_ptr<IntegrationFunction>>
 BasicIntegrationAlgorithm::Run() {
   while (!ready_nodes_.empty()) {
+    // Only nodes with the same op can be merged, so bucket the candidate merge
+    // targets by op, preserving their order in the function.
+    absl::flat_hash_map<Op, std::vector<Node*>> targets_by_op;
+    for (Node* internal_node : integration_function_->function()->nodes()) {
+      // TODO(jbaileyhandle): Relax this requirement so that
+      // it only applies to integration-generated muxes.
+      if (integration_function_->IsMappingTarget(internal_node)) {
+        targets_by_op[internal_node->op()].push_back(internal_node);
+      }
+    }
+
     std::optional<BasicIntegrationMove> move;
     for (auto node_itr = ready_nodes_.begin(); node_itr != ready_nodes_.end();
          ++node_itr) {
-      // Check insertion cost.
-      XLS_ASSIGN_OR_RETURN(int64_t insert_cost,
-                           integration_function_->GetInsertNodeCost(*node_itr));
+      // Moves are only replaced by strictly cheaper ones and no move costs
+      // less than zero, so nothing can displace a zero-cost move.
+      if (move.has_value() && move.value().cost <= 0) {
+        break;
+      }
+
+      // Check insertion cost. This only depends on the node itself, so it is
+      // computed once per node.
+      auto [insert_cost_itr, inserted] = insert_costs_.try_emplace(*node_itr);
+      if (inserted) {
+        XLS_ASSIGN_OR_RETURN(
+            insert_cost_itr->second,
+            integration_function_->GetInsertNodeCost(*node_itr));
+      }
+      int64_t insert_cost = insert_cost_itr->second;
       if (!move.has_value() || insert_cost < move.value().cost) {
         move = MakeInsertMove(node_itr, insert_cost);
       }
 
       // Check merge cost.
-      for (Node* internal_node : integration_function_->function()->nodes()) {
-        // TODO(jbaileyhandle): Relax this requirement so that
-        // it only applies to integration-generated muxes.
-        if (!integration_function_->IsMappingTarget(internal_node)) {
+      auto targets_itr = targets_by_op.find((*node_itr)->op());
+      if (targets_itr == targets_by_op.end()) {
+        continue;
+      }
+      for (Node* internal_node : targets_itr->second) {
+        // Evaluating a merge performs and then reverts it, so first rule out
+        // nodes which can't be merged at all.
+        if (!(*node_itr)->IsDefinitelyEqualTo(internal_node)) {
           continue;
         }
 
@@ -97,6 +126,7 @@ BasicIntegrationAlgorithm::Run() {
         ExecuteMove(integration_function_.get(), move.value()).status());
 
     // Update ready_nodes_.
+    insert_costs_.erase(move.value().node);
     ready_nodes_.erase(move.value().node_itr);
     for (Node* user : move.value().node->users()) {
       EnqueueNodeIfReady(user);
@@ -20,6 +20,7 @@
 #include <list>
 #include <memory>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -101,6 +102,9 @@ class BasicIntegrationAlgorithm
   // Track all nodes that have ever been inserted into 'ready_nodes_'.
   absl::flat_hash_set<Node*> queued_nodes_;
 
+  // Cost of inserting each node in 'ready_nodes_', once computed.
+  absl::flat_hash_map<Node*, int64_t> insert_costs_;
+
   // Function combining the source functions.
   std::unique_ptr<IntegrationFunction> integration_function_;
 };
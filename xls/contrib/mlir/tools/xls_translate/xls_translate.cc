@@ -24,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
@@ -49,6 +50,7 @@
 #include "mlir/include/mlir/IR/Diagnostics.h"
 #include "mlir/include/mlir/IR/Location.h"
 #include "mlir/include/mlir/IR/SymbolTable.h"
+#include "mlir/include/mlir/IR/Threading.h"
 #include "mlir/include/mlir/IR/TypeUtilities.h"
 #include "mlir/include/mlir/IR/Types.h"
 #include "mlir/include/mlir/IR/Value.h"
@@ -1177,6 +1179,20 @@ FailureOr<std::unique_ptr<Package>> mlirXlsToXls(
     return failure();
   }
 
+  // Converting DSLX files dominates translation time and each file converts
+  // independently, so do so up front (in parallel when the context allows).
+  // The results are still merged into the package in module order below.
+  std::vector<std::string> dslx_files;
+  for (auto file_import_op : module.getOps<ImportDslxFilePackageOp>()) {
+    auto file_name =
+        findDslxFile(file_import_op.getFilename().str(), dslx_search_path);
+    if (failed(file_name)) {
+      return failure();
+    }
+    dslx_files.push_back(file_name->string());
+  }
+  dslx_cache.prefetch(dslx_files, module.getContext());
+
   for (auto& op : module.getBodyRegion().front()) {
     // Handle file imports.
     if (auto file_import_op = dyn_cast<ImportDslxFilePackageOp>(op)) {
@@ -1436,12 +1452,10 @@ LogicalResult MlirXlsToXlsTranslate(Operation* op, llvm::raw_ostream& output,
   return success();
 }
 
-absl::StatusOr<std::shared_ptr<const Package>> DslxPackageCache::import(
+namespace {
+
+absl::StatusOr<std::shared_ptr<const Package>> convertDslxFile(
     const std::string& fileName) {
-  auto it = cache.find(fileName);
-  if (it != cache.end()) {
-    return it->second;
-  }
   absl::StatusOr<std::string> package_string_or = ::xls::ConvertDslxPathToIr(
       fileName, ::xls::GetDefaultDslxStdlibPath(), {});
   if (!package_string_or.ok()) {
@@ -1453,9 +1467,44 @@ absl::StatusOr<std::shared_ptr<const Package>> DslxPackageCache::import(
     return package_or.status();
   }
 
-  std::shared_ptr<const Package> package = std::move(package_or.value());
-  cache[fileName] = package;
+  return std::shared_ptr<const Package>(std::move(package_or.value()));
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<const Package>> DslxPackageCache::import(
+    const std::string& fileName) {
+  auto it = cache.find(fileName);
+  if (it != cache.end()) {
+    return it->second;
+  }
+  absl::StatusOr<std::shared_ptr<const Package>> package =
+      convertDslxFile(fileName);
+  if (package.ok()) {
+    cache[fileName] = *package;
+  }
   return package;
 }
 
+void DslxPackageCache::prefetch(ArrayRef<std::string> fileNames,
+                                MLIRContext* context) {
+  std::vector<std::string> missing;
+  absl::flat_hash_set<std::string> seen;
+  for (const std::string& fileName : fileNames) {
+    if (!cache.contains(fileName) && seen.insert(fileName).second) {
+      missing.push_back(fileName);
+    }
+  }
+  std::vector<absl::StatusOr<std::shared_ptr<const Package>>> packages(
+      missing.size());
+  mlir::parallelFor(context, 0, missing.size(), [&](size_t i) {
+    packages[i] = convertDslxFile(missing[i]);
+  });
+  for (auto [fileName, package] : llvm::zip(missing, packages)) {
+    if (package.ok()) {
+      cache[fileName] = *package;
+    }
+  }
+}
+
 }  // namespace mlir::xls
@@ -32,6 +32,7 @@
 #include "xls/tools/scheduling_options_flags.pb.h"
 
 namespace mlir {
+class MLIRContext;
 class Operation;
 }  // namespace mlir
 
@@ -54,6 +55,11 @@ class DslxPackageCache {
   absl::StatusOr<std::shared_ptr<const ::xls::Package>> import(
       const std::string& fileName);
 
+  // Converts all of `fileNames` that are not yet cached, in parallel if
+  // multithreading is enabled on `context`. Files that fail to convert are
+  // not cached, so their errors are reported by a later call to `import`.
+  void prefetch(ArrayRef<std::string> fileNames, MLIRContext* context);
+
  private:
   absl::flat_hash_map<std::string, std::shared_ptr<const ::xls::Package>> cache;
 };
@@ -12,22 +12,20 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <utility>
-
 #include "llvm/include/llvm/ADT/DenseMap.h"
 #include "llvm/include/llvm/ADT/STLExtras.h"
+#include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/ADT/StringRef.h"
 #include "mlir/include/mlir/IR/AttrTypeSubElements.h"
-#include "mlir/include/mlir/IR/Builders.h"
+#include "mlir/include/mlir/IR/Block.h"
 #include "mlir/include/mlir/IR/BuiltinAttributes.h"
 #include "mlir/include/mlir/IR/BuiltinOps.h"
 #include "mlir/include/mlir/IR/MLIRContext.h"
-#include "mlir/include/mlir/IR/PatternMatch.h"
 #include "mlir/include/mlir/IR/SymbolTable.h"
+#include "mlir/include/mlir/IR/Threading.h"
 #include "mlir/include/mlir/IR/Value.h"
 #include "mlir/include/mlir/IR/Visitors.h"
 #include "mlir/include/mlir/Support/LLVM.h"
-#include "mlir/include/mlir/Transforms/GreedyPatternRewriteDriver.h"
 #include "xls/contrib/mlir/IR/xls_ops.h"
 #include "xls/contrib/mlir/transforms/passes.h"  // IWYU pragma: keep
 
@@ -45,54 +43,65 @@ class InstantiateEprocsPass
   void runOnOperation() override;
 };
 
-class InstantiateEprocPattern : public OpRewritePattern<InstantiateEprocOp> {
- public:
-  InstantiateEprocPattern(MLIRContext* context, SymbolTable& symbolTable)
-      : OpRewritePattern<InstantiateEprocOp>(context),
-        symbolTable(symbolTable) {}
-
-  LogicalResult matchAndRewrite(InstantiateEprocOp op,
-                                PatternRewriter& rewriter) const override {
-    EprocOp eproc =
-        symbolTable.lookup<EprocOp>(op.getEprocAttr().getLeafReference());
-    if (!eproc) {
-      return failure();
-    }
-    Operation* cloned = rewriter.clone(*eproc);
-    // All instantiated eprocs now must be kept, unlike the template they have
-    // been cloned from.
-    cast<EprocOp>(cloned).setDiscardable(false);
-    symbolTable.insert(cloned);
-
-    DenseMap<StringRef, StringRef> localToGlobal;
-    for (auto [global, local] :
-         llvm::zip(op.getGlobalChannels(), op.getLocalChannels())) {
-      localToGlobal[cast<FlatSymbolRefAttr>(local).getValue()] =
-          cast<FlatSymbolRefAttr>(global).getValue();
-    }
-    mlir::AttrTypeReplacer replacer;
-    replacer.addReplacement([&](SymbolRefAttr attr) {
-      return SymbolRefAttr::get(op.getContext(),
-                                localToGlobal[attr.getLeafReference()]);
-    });
-    replacer.recursivelyReplaceElementsIn(cloned);
-    op.erase();
-    return success();
+// Rewrites the channel references of a freshly cloned eproc from the local
+// channels of the template to the global channels of the instantiation.
+void remapChannels(Operation* cloned, InstantiateEprocOp op) {
+  DenseMap<StringRef, StringRef> localToGlobal;
+  for (auto [global, local] :
+       llvm::zip(op.getGlobalChannels(), op.getLocalChannels())) {
+    localToGlobal[cast<FlatSymbolRefAttr>(local).getValue()] =
+        cast<FlatSymbolRefAttr>(global).getValue();
   }
-
- private:
-  SymbolTable& symbolTable;
-};
+  mlir::AttrTypeReplacer replacer;
+  replacer.addReplacement([&](SymbolRefAttr attr) {
+    return SymbolRefAttr::get(op.getContext(),
+                              localToGlobal[attr.getLeafReference()]);
+  });
+  replacer.recursivelyReplaceElementsIn(cloned);
+}
 
 }  // namespace
 
 void InstantiateEprocsPass::runOnOperation() {
   ModuleOp module = getOperation();
   SymbolTable symbolTable(module);
-  RewritePatternSet patterns(&getContext());
-  patterns.add<InstantiateEprocPattern>(patterns.getContext(), symbolTable);
-  if (failed(mlir::applyPatternsGreedily(module, std::move(patterns)))) {
-    signalPassFailure();
+
+  // Resolve every instantiation up front; the symbol table is only read while
+  // the clones are built.
+  struct Instantiation {
+    InstantiateEprocOp op;
+    EprocOp eproc;
+    Operation* cloned = nullptr;
+  };
+  SmallVector<Instantiation> instantiations;
+  module.walk([&](InstantiateEprocOp op) {
+    EprocOp eproc =
+        symbolTable.lookup<EprocOp>(op.getEprocAttr().getLeafReference());
+    if (eproc) {
+      instantiations.push_back({op, eproc});
+    }
+  });
+
+  // Cloning and channel remapping only touch the (detached) clone, so
+  // instantiations are built in parallel when the context allows it.
+  mlir::parallelForEach(&getContext(), instantiations,
+                        [](Instantiation& instantiation) {
+                          Operation* cloned = instantiation.eproc->clone();
+                          // All instantiated eprocs now must be kept, unlike
+                          // the template they have been cloned from.
+                          cast<EprocOp>(cloned).setDiscardable(false);
+                          remapChannels(cloned, instantiation.op);
+                          instantiation.cloned = cloned;
+                        });
+
+  // Inserting into the module uniquifies symbol names, which must happen in
+  // program order to keep the output deterministic.
+  for (Instantiation& instantiation : instantiations) {
+    Block* block = instantiation.op->getBlock();
+    block->getOperations().insert(instantiation.op->getIterator(),
+                                  instantiation.cloned);
+    symbolTable.insert(instantiation.cloned);
+    instantiation.op.erase();
   }
 }
 
@@ -33,6 +33,7 @@
 #include "mlir/include/mlir/IR/IRMapping.h"
 #include "mlir/include/mlir/IR/PatternMatch.h"
 #include "mlir/include/mlir/IR/SymbolTable.h"
+#include "mlir/include/mlir/IR/Threading.h"
 #include "mlir/include/mlir/IR/Value.h"
 #include "mlir/include/mlir/IR/Visitors.h"
 #include "mlir/include/mlir/Support/LLVM.h"
@@ -84,6 +85,31 @@ class ProcElaborationPass
   void runOnOperation() override;
 };
 
+// An eproc whose body is yet to be cloned from the sproc it elaborates.
+struct PendingEprocBody {
+  SprocOp sproc;
+  EprocOp eproc;
+  // The channel bound to each channel argument of the sproc's next region.
+  SmallVector<SymbolRefAttr> channels;
+};
+
+// Clones the next region of the sproc into the eproc, binding its channel
+// arguments to the eproc's channels. Only the eproc's own region is mutated,
+// and both ops are isolated from above, so bodies may be built in parallel.
+void buildEprocBody(const PendingEprocBody& pending) {
+  SprocOp sproc = pending.sproc;
+  EprocOp eproc = pending.eproc;
+  IRMapping mapping;
+  sproc.getNext().cloneInto(&eproc.getBody(), mapping);
+  llvm::DenseMap<Value, SymbolRefAttr> chanMap;
+  for (auto [arg, chan] :
+       llvm::zip(sproc.getNextChannels(), pending.channels)) {
+    chanMap[mapping.lookup(arg)] = chan;
+  }
+  replaceStructuredChannelOps(eproc.getBody(), chanMap);
+  eproc.getBody().front().eraseArguments(0, sproc.getNextChannels().size());
+}
+
 struct EprocAndChannels {
   // A discardable eproc.
   EprocOp eproc;
@@ -95,15 +121,20 @@ class ElaborationContext
     : public InterpreterContext<ElaborationContext, ChanOp> {
  public:
   explicit ElaborationContext(OpBuilder& builder, SymbolTable& symbolTable,
-                              DenseMap<SprocOp, EprocAndChannels>& procCache)
-      : builder(builder), symbolTable(symbolTable), procCache(procCache) {}
+                              DenseMap<SprocOp, EprocAndChannels>& procCache,
+                              std::vector<PendingEprocBody>& pendingBodies)
+      : builder(builder),
+        symbolTable(symbolTable),
+        procCache(procCache),
+        pendingBodies(pendingBodies) {}
 
   OpBuilder& getBuilder() { return builder; }
 
   // Creates an eproc for the given sproc if none has yet been created. New
   // local channels are created for the eproc and are returned.
   //
-  // Eprocs are cached such that a sproc is only elaborated once.
+  // Eprocs are cached such that a sproc is only elaborated once. The eproc's
+  // body is not built here; it is queued in the pending bodies instead.
   EprocAndChannels createEproc(SprocOp sproc) {
     if (auto it = procCache.find(sproc); it != procCache.end()) {
       return it->second;
@@ -113,9 +144,7 @@ class ElaborationContext
                                             /*discardable=*/true,
                                             sproc.getMinPipelineStages());
     symbolTable.insert(eproc);
-    IRMapping mapping;
-    sproc.getNext().cloneInto(&eproc.getBody(), mapping);
-    llvm::DenseMap<Value, SymbolRefAttr> chanMap;
+    PendingEprocBody pending = {sproc, eproc, {}};
     std::vector<value_type> eprocChannels;
     for (auto [i, arg] : llvm::enumerate(sproc.getNextChannels())) {
       auto chan = builder.create<ChanOp>(
@@ -123,10 +152,9 @@ class ElaborationContext
           absl::StrFormat("%s_arg%d", sproc.getSymName().str(), i),
           cast<SchanType>(arg.getType()).getElementType());
       eprocChannels.push_back(chan);
-      chanMap[mapping.lookup(arg)] = SymbolRefAttr::get(chan.getSymNameAttr());
+      pending.channels.push_back(SymbolRefAttr::get(chan.getSymNameAttr()));
     }
-    replaceStructuredChannelOps(eproc.getBody(), chanMap);
-    eproc.getBody().front().eraseArguments(0, sproc.getNextChannels().size());
+    pendingBodies.push_back(std::move(pending));
 
     EprocAndChannels result = {eproc, std::move(eprocChannels)};
     procCache[sproc] = result;
@@ -170,6 +198,7 @@ class ElaborationContext
   SymbolTable symbolTable;
   StringSet<> addedSymbols;
   DenseMap<SprocOp, EprocAndChannels>& procCache;
+  std::vector<PendingEprocBody>& pendingBodies;
 };
 
 class ElaborationInterpreter
@@ -256,6 +285,7 @@ class ElaborationInterpreter
 void ProcElaborationPass::runOnOperation() {
   ModuleOp module = getOperation();
   DenseMap<SprocOp, EprocAndChannels> procCache;
+  std::vector<PendingEprocBody> pendingBodies;
   SymbolTable symbolTable(module);
   // Elaborate all sprocs marked "top". Elaboration traverses a potentially
   // cyclical graph of sprocs, so we delay removing the sprocs until the end.
@@ -284,11 +314,15 @@ void ProcElaborationPass::runOnOperation() {
 
     ElaborationInterpreter interpreter;
     auto result = interpreter.InterpretTop(sproc, boundaryChannels, builder,
-                                           symbolTable, procCache);
+                                           symbolTable, procCache,
+                                           pendingBodies);
     if (!result.ok()) {
       sproc.emitError() << "failed to elaborate: " << result.message();
     }
   }
+  // Elaboration only needs the symbols of the eprocs and their channels, so
+  // the bodies are built afterwards, in parallel when the context allows it.
+  mlir::parallelForEach(&getContext(), pendingBodies, buildEprocBody);
   module.walk([&](Operation* op) {
     if (isa<SprocOp, ExternSprocOp>(op)) {
       op->erase();
@@ -54,6 +54,7 @@
 #include "clang/include/clang/Basic/TokenKinds.h"
 #include "clang/include/clang/Frontend/CompilerInstance.h"
 #include "clang/include/clang/Frontend/FrontendAction.h"
+#include "clang/include/clang/Frontend/FrontendActions.h"
 #include "clang/include/clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/include/clang/Lex/PPCallbacks.h"
 #include "clang/include/clang/Lex/Pragma.h"
@@ -78,6 +79,116 @@
 namespace xlscc {
 namespace {
 
+// Contents of the header made available to every parsed file as
+// "/xls_builtin.h".
+constexpr std::string_view kXlsBuiltinHeader = R"(
+#ifndef __XLS_BUILTIN_H
+#define __XLS_BUILTIN_H
+template<int N>
+struct __xls_bits { };
+
+// Should match OpType
+enum __xls_channel_dir {
+  __xls_channel_dir_Unknown=0,    // OpType::kNull
+  __xls_channel_dir_Out=1,        // OpType::kSend
+  __xls_channel_dir_In=2,         // OpType::kRecv
+  __xls_channel_dir_InOut=3       // OpType::kSendRecv
+};
+
+template<typename T, __xls_channel_dir Dir=__xls_channel_dir_Unknown>
+class __xls_channel {
+ public:
+  T read()const {
+    return T();
+  }
+  T write(T val)const {
+    return val;
+  }
+  void read(T& out)const {
+    (void)out;
+  }
+  bool nb_read(T& out)const {
+    (void)out;
+    return true;
+  }
+};
+
+template<typename T, unsigned long long Size>
+class __xls_memory {
+ public:
+  using value_type = T;
+
+  unsigned long long size()const {
+    return Size;
+  };
+
+  T& operator[](long long int addr)const {
+    static T ret;
+    return ret;
+  }
+  void write(long long int addr, const T& value) const {
+    return;
+  }
+  T read(long long int addr) const {
+    return T();
+  }
+};
+
+
+// Bypass no outputs error
+int __xlscc_unimplemented() { return 0; }
+
+void __xlscc_assert(const char*message, bool condition, const char*label=nullptr) { }
+
+// See XLS IR trace op format
+void __xlscc_trace(const char*fmt, ...) { }
+
+bool __xlscc_on_reset = false;
+
+// Returns bits for 32.32 fixed point representation
+__xls_bits<64> __xlscc_fixed_32_32_bits_for_double(double input);
+__xls_bits<64> __xlscc_fixed_32_32_bits_for_float(float input);
+
+#endif//__XLS_BUILTIN_H
+          )";
+
+// Returns the Clang command line used both to parse `input_filename` and to
+// precompile headers for it. Precompiled headers are only accepted by
+// compilations with matching options, so the two must stay in sync.
+std::vector<std::string> ClangArgv(
+    std::string_view input_filename,
+    absl::Span<std::string_view> command_line_args) {
+  std::vector<std::string> argv;
+  argv.emplace_back("binary");
+  argv.emplace_back(input_filename);
+  for (const auto& view : command_line_args) {
+    argv.emplace_back(view);
+  }
+  // For xls_top.cc to include the source file
+  argv.emplace_back("-I.");
+  argv.emplace_back("-std=c++17");
+  argv.emplace_back("-nostdinc");
+  argv.emplace_back("-Wno-unused-label");
+  argv.emplace_back("-Wno-constant-logical-operand");
+  argv.emplace_back("-Wno-unused-but-set-variable");
+  argv.emplace_back("-Wno-c++11-narrowing");
+  argv.emplace_back("-Wno-conversion");
+  argv.emplace_back("-Wno-missing-template-arg-list-after-template-kw");
+  // Needed for ASM to work properly on ARM
+  argv.emplace_back("--target=x86_64-linux-android");
+  return argv;
+}
+
+// Returns an in-memory file system holding "/xls_builtin.h".
+llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> BuiltinFileSystem() {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
+      new llvm::vfs::InMemoryFileSystem);
+  mem_fs->addFile("/xls_builtin.h", 0,
+                  llvm::MemoryBuffer::getMemBuffer(kXlsBuiltinHeader));
+  return mem_fs;
+}
+
+
 void GenerateAnnotation(clang::Preprocessor& PP, std::string_view name,
                         const clang::Token& after,
                         const absl::Span<const clang::Token>& arguments) {
@@ -1256,105 +1367,17 @@ void LibToolThread::Start() {
 void LibToolThread::Join() { thread_->Join(); }
 
 void LibToolThread::Run() {
-  std::vector<std::string> argv;
-  argv.emplace_back("binary");
-  argv.emplace_back("/xls_top.cc");
-  for (const auto& view : command_line_args_) {
-    argv.emplace_back(view);
-  }
-  // For xls_top.cc to include the source file
-  argv.emplace_back("-I.");
+  std::vector<std::string> argv =
+      ClangArgv("/xls_top.cc", command_line_args_);
   argv.emplace_back("-fsyntax-only");
-  argv.emplace_back("-std=c++17");
-  argv.emplace_back("-nostdinc");
-  argv.emplace_back("-Wno-unused-label");
-  argv.emplace_back("-Wno-constant-logical-operand");
-  argv.emplace_back("-Wno-unused-but-set-variable");
-  argv.emplace_back("-Wno-c++11-narrowing");
-  argv.emplace_back("-Wno-conversion");
-  argv.emplace_back("-Wno-missing-template-arg-list-after-template-kw");
-  // Needed for ASM to work properly on ARM
-  argv.emplace_back("--target=x86_64-linux-android");
 
   llvm::IntrusiveRefCntPtr<clang::FileManager> libtool_files;
 
   std::unique_ptr<LibToolFrontendAction> libtool_action(
       new LibToolFrontendAction(parser_));
 
-  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs(
-      new llvm::vfs::InMemoryFileSystem);
-  mem_fs->addFile("/xls_builtin.h", 0,
-                  llvm::MemoryBuffer::getMemBuffer(
-                      R"(
-#ifndef __XLS_BUILTIN_H
-#define __XLS_BUILTIN_H
-template<int N>
-struct __xls_bits { };
-
-// Should match OpType
-enum __xls_channel_dir {
-  __xls_channel_dir_Unknown=0,    // OpType::kNull
-  __xls_channel_dir_Out=1,        // OpType::kSend
-  __xls_channel_dir_In=2,         // OpType::kRecv
-  __xls_channel_dir_InOut=3       // OpType::kSendRecv
-};
-
-template<typename T, __xls_channel_dir Dir=__xls_channel_dir_Unknown>
-class __xls_channel {
- public:
-  T read()const {
-    return T();
-  }
-  T write(T val)const {
-    return val;
-  }
-  void read(T& out)const {
-    (void)out;
-  }
-  bool nb_read(T& out)const {
-    (void)out;
-    return true;
-  }
-};
-
-template<typename T, unsigned long long Size>
-class __xls_memory {
- public:
-  using value_type = T;
-
-  unsigned long long size()const {
-    return Size;
-  };
-
-  T& operator[](long long int addr)const {
-    static T ret;
-    return ret;
-  }
-  void write(long long int addr, const T& value) const {
-    return;
-  }
-  T read(long long int addr) const {
-    return T();
-  }
-};
-
-
-// Bypass no outputs error
-int __xlscc_unimplemented() { return 0; }
-
-void __xlscc_assert(const char*message, bool condition, const char*label=nullptr) { }
-
-// See XLS IR trace op format
-void __xlscc_trace(const char*fmt, ...) { }
-
-bool __xlscc_on_reset = false;
-
-// Returns bits for 32.32 fixed point representation
-__xls_bits<64> __xlscc_fixed_32_32_bits_for_double(double input);
-__xls_bits<64> __xlscc_fixed_32_32_bits_for_float(float input);
-
-#endif//__XLS_BUILTIN_H
-          )"));
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs =
+      BuiltinFileSystem();
 
   // Inject an instantiation to make Clang parse the constructor bodies
   std::string top_class_inst_injection = top_class_name_.empty()
@@ -1413,6 +1436,45 @@ void LibToolFrontendAction::EndSourceFileAction() {
   parser_.libtool_wait_for_destruct_->Wait();
 }
 
+absl::Status GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view output_filename,
+    absl::Span<std::string_view> command_line_args) {
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> mem_fs =
+      BuiltinFileSystem();
+  const std::string pch_src = absl::StrFormat(R"(
+#include "/xls_builtin.h"
+#include "%s"
+          )",
+                                              header_filename);
+  mem_fs->addFile("/xls_pch.h", 0,
+                  llvm::MemoryBuffer::getMemBufferCopy(pch_src));
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::OverlayFileSystem> overlay_fs(
+      new llvm::vfs::OverlayFileSystem(llvm::vfs::getRealFileSystem()));
+  overlay_fs->pushOverlay(mem_fs);
+  llvm::IntrusiveRefCntPtr<clang::FileManager> files(
+      new clang::FileManager(clang::FileSystemOptions(), overlay_fs));
+
+  std::vector<std::string> argv = ClangArgv("/xls_pch.h", command_line_args);
+  // The language must be given before the input file it applies to.
+  argv.insert(argv.begin() + 1, "-xc++-header");
+  argv.emplace_back("-o");
+  argv.emplace_back(output_filename);
+
+  clang::tooling::ToolInvocation invocation(
+      argv, std::make_unique<clang::GeneratePCHAction>(), files.get());
+  llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diag_opts =
+      new clang::DiagnosticOptions();
+  clang::TextDiagnosticPrinter diag_print(llvm::errs(), &*diag_opts);
+  invocation.setDiagnosticConsumer(&diag_print);
+  if (!invocation.run()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unable to precompile header %s into %s", header_filename,
+        output_filename));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::string> CCParser::GetEntryFunctionName() const {
   if (top_function_ == nullptr) {
     return absl::NotFoundError("No top function found");
@@ -151,6 +151,19 @@ class CCParser {
   int next_file_number_ = 1;
 };
 
+// Precompiles `header_filename`, preceded by the XLS builtins, into the Clang
+// precompiled header `output_filename`, e.g. for the large HLS type libraries
+// nearly every source includes. Passing `-include-pch <output_filename>` along
+// with the same `command_line_args` to CCParser::ScanFile() then loads the
+// header's AST instead of reparsing it; sources still include the header as
+// usual, which its include guard makes a no-op.
+//
+// Pragmas in the precompiled header are not visible to the parser, so headers
+// containing HLS pragmas (e.g. #pragma hls_top) should not be precompiled.
+absl::Status GeneratePrecompiledHeader(
+    std::string_view header_filename, std::string_view output_filename,
+    absl::Span<std::string_view> command_line_args);
+
 }  // namespace xlscc
 
 #endif  // XLS_CONTRIB_XLSCC_PARSE_CPP_H_
@@ -39,6 +39,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/logging/log_flags.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/contrib/xlscc/cc_parser.h"
 #include "xls/contrib/xlscc/flags.h"
 #include "xls/contrib/xlscc/hls_block.pb.h"
 #include "xls/contrib/xlscc/metadata_output.pb.h"
@@ -84,6 +85,16 @@ ABSL_FLAG(std::vector<std::string>, defines, std::vector<std::string>(),
 ABSL_FLAG(std::vector<std::string>, include_dirs, std::vector<std::string>(),
           "Comma separated list of include directories to pass to clang");
 
+ABSL_FLAG(std::string, precompiled_header, "",
+          "Clang precompiled header, as generated by "
+          "--generate_precompiled_header with the same clang arguments, to "
+          "load instead of parsing the header it was generated from.");
+
+ABSL_FLAG(bool, generate_precompiled_header, false,
+          "Treat the input file as a header (or set of includes) to "
+          "precompile, writing the precompiled header to --out instead of "
+          "generating IR.");
+
 ABSL_FLAG(std::string, meta_out, "",
           "Path at which to output metadata protobuf");
 
@@ -252,12 +263,30 @@ static absl::Status Run(std::string_view cpp_path) {
     clang_argvs.push_back(absl::StrCat("-I", dir));
   }
 
+  if (std::string pch = absl::GetFlag(FLAGS_precompiled_header);
+      !pch.empty()) {
+    clang_argvs.push_back("-include-pch");
+    clang_argvs.push_back(std::move(pch));
+  }
+
   std::vector<std::string_view> clang_argv;
   clang_argv.reserve(clang_argvs.size());
   for (const auto& i : clang_argvs) {
     clang_argv.push_back(i);
   }
 
+  if (absl::GetFlag(FLAGS_generate_precompiled_header)) {
+    const std::string pch_path = absl::GetFlag(FLAGS_out);
+    if (pch_path.empty()) {
+      return absl::InvalidArgumentError(
+          "--generate_precompiled_header requires --out");
+    }
+    std::cerr << "Precompiling header '" << cpp_path << "' with clang..."
+              << '\n';
+    return GeneratePrecompiledHeader(cpp_path, pch_path,
+                                     absl::MakeSpan(clang_argv));
+  }
+
   std::cerr << "Parsing file '" << cpp_path << "' with clang..." << '\n';
   XLS_RETURN_IF_ERROR(translator.ScanFile(
       cpp_path, clang_argv.empty()
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <cstdint>
 #include <limits>
 #include <memory>
@@ -28,6 +29,7 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
@@ -35,9 +37,12 @@
 #include "clang/include/clang/AST/Attr.h"
 #include "clang/include/clang/AST/Decl.h"
 #include "clang/include/clang/AST/Expr.h"
+#include "clang/include/clang/AST/OperationKinds.h"
+#include "clang/include/clang/AST/RecursiveASTVisitor.h"
 #include "clang/include/clang/AST/Stmt.h"
 #include "clang/include/clang/Basic/LLVM.h"
 #include "clang/include/clang/Basic/SourceLocation.h"
+#include "llvm/include/llvm/ADT/APSInt.h"
 #include "llvm/include/llvm/Support/Casting.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/stopwatch.h"
@@ -61,6 +66,78 @@ using ::std::string;
 using ::std::vector;
 
 namespace xlscc {
+namespace {
+
+// Returns the variable `expr` refers to, ignoring parentheses and implicit
+// casts, or nullptr if it doesn't just refer to a variable.
+const clang::VarDecl* ReferencedVar(const clang::Expr* expr) {
+  const auto* ref =
+      llvm::dyn_cast<clang::DeclRefExpr>(expr->IgnoreParenImpCasts());
+  if (ref == nullptr) {
+    return nullptr;
+  }
+  return llvm::dyn_cast<clang::VarDecl>(ref->getDecl());
+}
+
+// Returns the value of `expr` if it's an integer constant representable in 64
+// bits.
+std::optional<int64_t> IntegerConstant(const clang::Expr* expr,
+                                       const clang::ASTContext& ctx) {
+  std::optional<llvm::APSInt> value = expr->getIntegerConstantExpr(ctx);
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+  if (value->isSigned() ? !value->isSignedIntN(64) : !value->isIntN(63)) {
+    return std::nullopt;
+  }
+  return value->getExtValue();
+}
+
+// Checks that a loop body can't exit early or change the induction variable,
+// which is only read (as an rvalue) everywhere it's referenced.
+class CountedLoopBodyChecker
+    : public clang::RecursiveASTVisitor<CountedLoopBodyChecker> {
+ public:
+  explicit CountedLoopBodyChecker(const clang::VarDecl* induction_var)
+      : induction_var_(induction_var) {}
+
+  bool ok() const { return ok_ && references_ == reads_; }
+
+  bool VisitDeclRefExpr(clang::DeclRefExpr* expr) {
+    if (expr->getDecl() == induction_var_) {
+      ++references_;
+    }
+    return true;
+  }
+  bool VisitImplicitCastExpr(clang::ImplicitCastExpr* expr) {
+    if (expr->getCastKind() != clang::CK_LValueToRValue) {
+      return true;
+    }
+    const auto* ref =
+        llvm::dyn_cast<clang::DeclRefExpr>(expr->getSubExpr()->IgnoreParens());
+    if (ref != nullptr && ref->getDecl() == induction_var_) {
+      ++reads_;
+    }
+    return true;
+  }
+  bool VisitBreakStmt(clang::BreakStmt*) { return Reject(); }
+  bool VisitContinueStmt(clang::ContinueStmt*) { return Reject(); }
+  bool VisitReturnStmt(clang::ReturnStmt*) { return Reject(); }
+  bool VisitGotoStmt(clang::GotoStmt*) { return Reject(); }
+
+ private:
+  bool Reject() {
+    ok_ = false;
+    return false;
+  }
+
+  const clang::VarDecl* induction_var_;
+  bool ok_ = true;
+  int64_t references_ = 0;
+  int64_t reads_ = 0;
+};
+
+}  // namespace
 
 absl::Status Translator::GenerateIR_Loop(
     bool always_first_iter, const clang::Stmt* loop_stmt,
@@ -128,6 +205,17 @@ absl::Status Translator::GenerateIR_Loop(
   }
 
   if (init_interval <= 0) {
+    // Loops which are neither unrolled nor pipelined can still be translated
+    // if their trip count is known.
+    if (!always_first_iter) {
+      XLS_ASSIGN_OR_RETURN(
+          bool translated,
+          GenerateIR_CountedForLoop(warn_inferred_loop_type, init, cond_expr,
+                                    inc, body, ctx, loc));
+      if (translated) {
+        return absl::OkStatus();
+      }
+    }
     return absl::UnimplementedError(
         ErrorMessage(loc, "Loop statement missing #pragma or attribute"));
   }
@@ -262,6 +350,371 @@ absl::Status Translator::GenerateIR_UnrolledLoop(
   return absl::OkStatus();
 }
 
+std::optional<Translator::CountedLoopBounds> Translator::AnalyzeCountedLoop(
+    const clang::Stmt* init, const clang::Expr* cond_expr,
+    const clang::Stmt* inc, const clang::Stmt* body, clang::ASTContext& ctx) {
+  if (init == nullptr || cond_expr == nullptr || inc == nullptr ||
+      body == nullptr) {
+    return std::nullopt;
+  }
+
+  // Induction variable declaration
+  const auto* init_decl = llvm::dyn_cast<clang::DeclStmt>(init);
+  if (init_decl == nullptr || !init_decl->isSingleDecl()) {
+    return std::nullopt;
+  }
+  const auto* induction_var =
+      llvm::dyn_cast<clang::VarDecl>(init_decl->getSingleDecl());
+  if (induction_var == nullptr ||
+      !induction_var->getType()->isIntegerType() ||
+      induction_var->getInit() == nullptr) {
+    return std::nullopt;
+  }
+  std::optional<int64_t> start =
+      IntegerConstant(induction_var->getInit(), ctx);
+  if (!start.has_value()) {
+    return std::nullopt;
+  }
+
+  // Condition, normalized to `induction_var <op> end`
+  const auto* cond =
+      llvm::dyn_cast<clang::BinaryOperator>(cond_expr->IgnoreParens());
+  if (cond == nullptr || !cond->isComparisonOp()) {
+    return std::nullopt;
+  }
+  clang::BinaryOperatorKind cond_op = cond->getOpcode();
+  const clang::Expr* bound_expr = cond->getRHS();
+  if (ReferencedVar(cond->getLHS()) != induction_var) {
+    if (ReferencedVar(cond->getRHS()) != induction_var) {
+      return std::nullopt;
+    }
+    bound_expr = cond->getLHS();
+    cond_op = clang::BinaryOperator::reverseComparisonOp(cond_op);
+  }
+  // The bound is evaluated including its conversion to the comparison type
+  std::optional<int64_t> end = IntegerConstant(bound_expr, ctx);
+  if (!end.has_value()) {
+    return std::nullopt;
+  }
+
+  // Increment
+  std::optional<int64_t> step;
+  if (const auto* unary = llvm::dyn_cast<clang::UnaryOperator>(inc)) {
+    if (ReferencedVar(unary->getSubExpr()) == induction_var) {
+      if (unary->isIncrementOp()) {
+        step = 1;
+      } else if (unary->isDecrementOp()) {
+        step = -1;
+      }
+    }
+  } else if (const auto* compound =
+                 llvm::dyn_cast<clang::CompoundAssignOperator>(inc)) {
+    if (ReferencedVar(compound->getLHS()) == induction_var) {
+      std::optional<int64_t> amount = IntegerConstant(compound->getRHS(), ctx);
+      if (amount.has_value() &&
+          *amount != std::numeric_limits<int64_t>::min()) {
+        if (compound->getOpcode() == clang::BO_AddAssign) {
+          step = *amount;
+        } else if (compound->getOpcode() == clang::BO_SubAssign) {
+          step = -*amount;
+        }
+      }
+    }
+  }
+  if (!step.has_value() || *step == 0) {
+    return std::nullopt;
+  }
+
+  // Trip count, computed without overflow
+  const absl::int128 distance = absl::int128(*end) - absl::int128(*start);
+  const absl::int128 abs_step = *step > 0 ? absl::int128(*step)
+                                          : -absl::int128(*step);
+  absl::int128 trip_count = 0;
+  switch (cond_op) {
+    case clang::BO_LT:
+    case clang::BO_GT:
+      if ((cond_op == clang::BO_LT) != (*step > 0)) {
+        return std::nullopt;
+      }
+      if ((*step > 0 && distance > 0) || (*step < 0 && distance < 0)) {
+        const absl::int128 abs_distance = distance > 0 ? distance : -distance;
+        trip_count = (abs_distance + abs_step - 1) / abs_step;
+      }
+      break;
+    case clang::BO_LE:
+    case clang::BO_GE:
+      if ((cond_op == clang::BO_LE) != (*step > 0)) {
+        return std::nullopt;
+      }
+      if ((*step > 0 && distance >= 0) || (*step < 0 && distance <= 0)) {
+        const absl::int128 abs_distance = distance > 0 ? distance : -distance;
+        trip_count = abs_distance / abs_step + 1;
+      }
+      break;
+    case clang::BO_NE:
+      if (distance % *step != 0 || distance / *step < 0) {
+        return std::nullopt;
+      }
+      trip_count = distance / *step;
+      break;
+    default:
+      return std::nullopt;
+  }
+  if (trip_count > std::numeric_limits<int64_t>::max()) {
+    return std::nullopt;
+  }
+
+  // Every value the induction variable takes, including the final one which
+  // fails the condition, must be representable without wrapping, also in the
+  // type it is compared in.
+  const int64_t width = ctx.getIntWidth(induction_var->getType());
+  if (width > 64) {
+    return std::nullopt;
+  }
+  const bool is_signed = induction_var->getType()->isSignedIntegerType();
+  const absl::int128 type_min =
+      is_signed ? -(absl::int128(1) << (width - 1)) : absl::int128(0);
+  const absl::int128 type_max = is_signed
+                                    ? (absl::int128(1) << (width - 1)) - 1
+                                    : (absl::int128(1) << width) - 1;
+  const absl::int128 last = absl::int128(*start) + trip_count * *step;
+  const absl::int128 lowest = std::min(absl::int128(*start), last);
+  const absl::int128 highest = std::max(absl::int128(*start), last);
+  if (lowest < type_min || highest > type_max) {
+    return std::nullopt;
+  }
+  if (cond->getLHS()->getType()->isUnsignedIntegerType() && lowest < 0) {
+    return std::nullopt;
+  }
+
+  CountedLoopBodyChecker checker(induction_var);
+  checker.TraverseStmt(const_cast<clang::Stmt*>(body));
+  if (!checker.ok()) {
+    return std::nullopt;
+  }
+
+  return CountedLoopBounds{.induction_var = induction_var,
+                           .start = *start,
+                           .step = *step,
+                           .trip_count = static_cast<int64_t>(trip_count)};
+}
+
+absl::StatusOr<bool> Translator::GenerateIR_CountedForLoop(
+    bool warn_inferred_loop_type, const clang::Stmt* init,
+    const clang::Expr* cond_expr, const clang::Stmt* inc,
+    const clang::Stmt* body, clang::ASTContext& ctx,
+    const xls::SourceInfo& loc) {
+  std::optional<CountedLoopBounds> bounds =
+      AnalyzeCountedLoop(init, cond_expr, inc, body, ctx);
+  if (!bounds.has_value()) {
+    return false;
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<CType> induction_ctype,
+      TranslateTypeFromClang(bounds->induction_var->getType(), loc));
+  if (!induction_ctype->Is<CIntType>()) {
+    return false;
+  }
+  const int64_t width = induction_ctype->As<CIntType>()->width();
+
+  XLS_ASSIGN_OR_RETURN(const clang::VarDecl* on_reset_var_decl,
+                       parser_->GetXlsccOnReset());
+
+  // All variables in scope are carried through the loop. Loops which could
+  // change state other than plain values (references, pointers, channels,
+  // this) are left to the other loop translations.
+  std::vector<const clang::NamedDecl*> variable_fields_order;
+  for (const auto& [decl, cvalue] : context().variables) {
+    // Don't pass __xlscc_on_reset in/out
+    if (decl == on_reset_var_decl) {
+      continue;
+    }
+    if (cvalue.lvalue() != nullptr) {
+      return false;
+    }
+    if (!cvalue.rvalue().valid()) {
+      continue;
+    }
+    CHECK(context().sf->declaration_order_by_name_.contains(decl));
+    variable_fields_order.push_back(decl);
+  }
+  context().sf->SortNamesDeterministically(variable_fields_order);
+
+  if (bounds->trip_count == 0) {
+    return true;
+  }
+
+  std::vector<std::shared_ptr<CField>> fields;
+  std::vector<xls::BValue> carry_init_values;
+  absl::flat_hash_map<const clang::NamedDecl*, uint64_t> field_indices;
+  for (const clang::NamedDecl* decl : variable_fields_order) {
+    // Don't mark access
+    // Accesses are propagated below based on what's really used in the body
+    XLS_ASSIGN_OR_RETURN(CValue cvalue,
+                         GetIdentifier(decl, loc, /*record_access=*/false));
+    const uint64_t field_idx = fields.size();
+    field_indices[decl] = field_idx;
+    fields.push_back(std::make_shared<CField>(decl, field_idx, cvalue.type()));
+    carry_init_values.push_back(cvalue.rvalue());
+  }
+  auto carry_ctype = std::make_shared<CStructType>(
+      fields, /*no_tuple=*/false, /*synthetic_int=*/false);
+  XLS_ASSIGN_OR_RETURN(xls::Type * carry_xls_type,
+                       TranslateTypeToXLS(carry_ctype, loc));
+
+  const std::string name_prefix =
+      absl::StrFormat("__for_%i", next_for_number_++);
+
+  auto generated_func = std::make_unique<GeneratedFunction>();
+  CHECK_NE(context().sf, nullptr);
+  generated_func->clang_decl = context().sf->clang_decl;
+
+  xls::Function* body_func = nullptr;
+  bool translatable = true;
+  std::vector<const clang::NamedDecl*> vars_changed_in_body;
+  std::vector<std::pair<const clang::NamedDecl*, int64_t>>
+      vars_accessed_in_body;
+  {
+    xls::FunctionBuilder body_builder(absl::StrFormat("%s_func", name_prefix),
+                                      package_);
+    xls::BValue index_val =
+        body_builder.Param(absl::StrFormat("%s_index", name_prefix),
+                           package_->GetBitsType(width), loc);
+    xls::BValue carry_val = body_builder.Param(
+        absl::StrFormat("%s_carry", name_prefix), carry_xls_type, loc);
+
+    TranslationContext& prev_context = context();
+    PushContextGuard context_guard(*this, loc);
+
+    context() = TranslationContext();
+    context().propagate_up = false;
+    context().fb = absl::implicit_cast<xls::BuilderBase*>(&body_builder);
+    context().sf = generated_func.get();
+    context().ast_context = prev_context.ast_context;
+    context().for_loops_default_unroll = prev_context.for_loops_default_unroll;
+    context().in_pipelined_for_body = prev_context.in_pipelined_for_body;
+    context().outer_pipelined_loop_init_interval =
+        prev_context.outer_pipelined_loop_init_interval;
+
+    XLS_RETURN_IF_ERROR(DeclareVariable(
+        on_reset_var_decl,
+        CValue(body_builder.Literal(xls::UBits(0, 1), loc),
+               std::make_shared<CBoolType>()),
+        loc, /*check_unique_ids=*/false));
+
+    // The induction value counts up or down from the start by the step
+    const uint64_t width_mask =
+        width == 64 ? std::numeric_limits<uint64_t>::max()
+                    : (uint64_t{1} << width) - 1;
+    xls::BValue start_val = body_builder.Literal(
+        xls::UBits(static_cast<uint64_t>(bounds->start) & width_mask, width),
+        loc);
+    xls::BValue induction_val =
+        bounds->step > 0
+            ? body_builder.Add(start_val, index_val, loc)
+            : body_builder.Subtract(start_val, index_val, loc);
+    XLS_RETURN_IF_ERROR(DeclareVariable(bounds->induction_var,
+                                        CValue(induction_val, induction_ctype),
+                                        loc, /*check_unique_ids=*/false));
+
+    absl::flat_hash_map<const clang::NamedDecl*, xls::BValue> prev_vals;
+    for (const clang::NamedDecl* decl : variable_fields_order) {
+      const uint64_t field_idx = field_indices.at(decl);
+      xls::BValue field_val =
+          GetStructFieldXLS(carry_val, static_cast<int>(field_idx),
+                            *carry_ctype, loc);
+      prev_vals[decl] = field_val;
+      XLS_RETURN_IF_ERROR(DeclareVariable(
+          decl, CValue(field_val, carry_ctype->fields().at(field_idx)->type()),
+          loc, /*check_unique_ids=*/false));
+    }
+
+    // Generate body
+    // This context pop will top generate selects
+    {
+      PushContextGuard body_guard(*this, loc);
+      context().propagate_break_up = false;
+      context().propagate_continue_up = false;
+      context().in_for_body = true;
+      XLS_RETURN_IF_ERROR(GenerateIR_Compound(body, ctx));
+    }
+
+    translatable = generated_func->io_ops.empty() &&
+                   generated_func->sub_procs.empty() &&
+                   generated_func->static_values.empty() &&
+                   !generated_func->uses_on_reset;
+
+    // Carry out
+    std::vector<xls::BValue> carry_out_values;
+    carry_out_values.reserve(variable_fields_order.size());
+    for (const clang::NamedDecl* decl : variable_fields_order) {
+      const CValue& curr_val = context().variables.at(decl);
+      if (curr_val.lvalue() != nullptr || !curr_val.rvalue().valid()) {
+        translatable = false;
+        break;
+      }
+      if (curr_val.rvalue().node() != prev_vals.at(decl).node()) {
+        vars_changed_in_body.push_back(decl);
+      }
+      carry_out_values.push_back(curr_val.rvalue());
+    }
+    // vars_changed_in_body is already sorted deterministically due to
+    // iterating over variable_fields_order
+
+    for (const clang::NamedDecl* decl : variable_fields_order) {
+      auto found = context().variables_accessed.find(decl);
+      if (found != context().variables_accessed.end()) {
+        vars_accessed_in_body.push_back(std::make_pair(decl, found->second));
+      }
+    }
+
+    if (translatable) {
+      XLS_ASSIGN_OR_RETURN(
+          body_func,
+          body_builder.BuildWithReturnValue(
+              MakeStructXLS(carry_out_values, *carry_ctype, loc)));
+    }
+  }
+
+  if (!translatable) {
+    return false;
+  }
+
+  if (warn_inferred_loop_type) {
+    LOG(WARNING) << WarningMessage(
+        loc, "Inferred counted_for for loop with %li iterations",
+        bounds->trip_count);
+  }
+
+  // Propagate variables accessed to the outer context
+  for (const auto& [decl, count] : vars_accessed_in_body) {
+    if (context().variables.contains(decl)) {
+      context().variables_accessed[decl] += count;
+    }
+  }
+
+  xls::BValue carry_init =
+      MakeStructXLS(carry_init_values, *carry_ctype, loc);
+  xls::BValue carry_out = context().fb->CountedFor(
+      carry_init, bounds->trip_count,
+      /*stride=*/bounds->step > 0 ? bounds->step : -bounds->step, body_func,
+      /*invariant_args=*/{}, loc, absl::StrFormat("%s_counted", name_prefix));
+
+  // Don't assign to variables that aren't changed in the loop body
+  for (const clang::NamedDecl* decl : vars_changed_in_body) {
+    const uint64_t field_idx = field_indices.at(decl);
+    XLS_RETURN_IF_ERROR(Assign(
+        decl,
+        CValue(GetStructFieldXLS(carry_out, static_cast<int>(field_idx),
+                                 *carry_ctype, loc),
+               carry_ctype->fields().at(field_idx)->type()),
+        loc));
+  }
+
+  return true;
+}
+
 bool Translator::LValueContainsOnlyChannels(
     const std::shared_ptr<LValue>& lvalue) {
   if (lvalue == nullptr) {
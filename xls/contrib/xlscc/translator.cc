@@ -3298,6 +3298,47 @@ absl::Status Translator::GetChannelsForLValue(
   return absl::OkStatus();
 }
 
+absl::StatusOr<Translator::CallSignature*> Translator::GetCallSignature(
+    const clang::FunctionDecl* funcdecl, const xls::SourceInfo& loc) {
+  auto found = call_signatures_.find(funcdecl);
+  if (found != call_signatures_.end()) {
+    return found->second.get();
+  }
+
+  auto signature = std::make_unique<CallSignature>();
+
+  if (auto method = clang::dyn_cast<const clang::CXXMethodDecl>(funcdecl);
+      method != nullptr && method->isInstance()) {
+    // "This" is a PointerType, ignore and treat as reference
+    clang::QualType thisQual = method->getThisType();
+    XLSCC_CHECK(thisQual->isPointerType(), loc);
+
+    signature->add_this_return =
+        !thisQual->getPointeeType().isConstQualified();
+  }
+
+  for (const clang::ParmVarDecl* p : funcdecl->parameters()) {
+    const xls::SourceInfo param_loc = GetLoc(*p);
+    CallParameter& param = signature->params.emplace_back();
+
+    XLS_ASSIGN_OR_RETURN(StrippedType stripped,
+                         StripTypeQualifiers(p->getType()));
+    param.will_assign = stripped.is_ref && (!stripped.base.isConstQualified());
+
+    XLS_ASSIGN_OR_RETURN(param.is_channel,
+                         TypeIsChannel(p->getType(), param_loc));
+    if (param.is_channel) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(param.base_ctype,
+                         TranslateTypeFromClang(stripped.base, param_loc));
+  }
+
+  CallSignature* ret = signature.get();
+  call_signatures_[funcdecl] = std::move(signature);
+  return ret;
+}
+
 // this_inout can be nullptr for non-members
 absl::StatusOr<CValue> Translator::GenerateIR_Call(
     const clang::FunctionDecl* funcdecl,
@@ -3348,18 +3389,16 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
   std::vector<xls::BValue> args;
   int expected_returns = 0;
 
+  XLS_ASSIGN_OR_RETURN(CallSignature * call_signature,
+                       GetCallSignature(funcdecl, loc));
+
   // Add this if needed
   bool add_this_return = false;
   if (this_inout != nullptr) {
     args.push_back(*this_inout);
     XLSCC_CHECK(this_inout->valid(), loc);
 
-    // "This" is a PointerType, ignore and treat as reference
-    auto method = clang::dyn_cast<const clang::CXXMethodDecl>(funcdecl);
-    clang::QualType thisQual = method->getThisType();
-    XLSCC_CHECK(thisQual->isPointerType(), loc);
-
-    add_this_return = !thisQual->getPointeeType().isConstQualified();
+    add_this_return = call_signature->add_this_return;
   }
 
   // Number of return values expected. If >1, the return will be a tuple.
@@ -3378,6 +3417,7 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
         "call",
         funcdecl->getNumParams(), static_cast<int>(expr_args.size())));
   }
+  XLSCC_CHECK_EQ(call_signature->params.size(), expr_args.size(), loc);
 
   absl::flat_hash_map<const clang::ParmVarDecl*, bool> will_assign_param;
 
@@ -3389,13 +3429,9 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
   for (int pi = 0; pi < funcdecl->getNumParams(); ++pi) {
     const clang::ParmVarDecl* p = funcdecl->getParamDecl(pi);
     const xls::SourceInfo arg_loc = GetLoc(*expr_args[pi]);
+    CallParameter& param = call_signature->params[pi];
 
-    XLS_ASSIGN_OR_RETURN(StrippedType stripped,
-                         StripTypeQualifiers(p->getType()));
-
-    const bool will_assign =
-        stripped.is_ref && (!stripped.base.isConstQualified());
-    will_assign_param[p] = will_assign;
+    will_assign_param[p] = param.will_assign;
 
     // Map callee IO channels
     CValue argv;
@@ -3404,9 +3440,7 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
       MaskMemoryWritesGuard guard_writes(*this, will_assign_param.at(p));
       XLS_ASSIGN_OR_RETURN(argv, GenerateIR_Expr(expr_args[pi], arg_loc));
     }
-    XLS_ASSIGN_OR_RETURN(bool is_channel, TypeIsChannel(p->getType(), arg_loc));
-
-    if (is_channel) {
+    if (param.is_channel) {
       // TODO(seanhaskell): This can be further generalized to allow
       // structs with channels inside
       std::shared_ptr<LValue> callee_lvalue = func->lvalues_by_param.at(p);
@@ -3422,7 +3456,7 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
           /*callee_lval=*/callee_lvalue, &caller_channels_by_callee_channel,
           arg_loc));
 
-      if (sub_block_call && is_channel) {
+      if (sub_block_call) {
         // TODO: File bug for moving external_channels_by_internal_channel_
         // into context to trace it down
         IOChannel* caller_channel = argv.lvalue()->channel_leaf();
@@ -3442,22 +3476,21 @@ absl::StatusOr<CValue> Translator::GenerateIR_Call(
     }
 
     // Const references don't need a return
-    if (stripped.is_ref && (!stripped.base.isConstQualified())) {
+    if (param.will_assign) {
       ++expected_returns;
     }
     if (argv.lvalue() != nullptr) {
-      XLS_ASSIGN_OR_RETURN(std::shared_ptr<CType> stripped_base_type,
-                           TranslateTypeFromClang(stripped.base, arg_loc));
-      XLS_ASSIGN_OR_RETURN(bool has_lvalues,
-                           stripped_base_type->ContainsLValues(*this));
-      if (has_lvalues) {
+      if (!param.base_contains_lvalues.has_value()) {
+        XLS_ASSIGN_OR_RETURN(param.base_contains_lvalues,
+                             param.base_ctype->ContainsLValues(*this));
+      }
+      if (*param.base_contains_lvalues) {
         return absl::UnimplementedError(
             ErrorMessage(arg_loc, "Passing parameters containing LValues"));
       }
     }
 
-    XLS_ASSIGN_OR_RETURN(std::shared_ptr<CType> argt,
-                         TranslateTypeFromClang(stripped.base, arg_loc));
+    const std::shared_ptr<CType>& argt = param.base_ctype;
 
     xls::BValue pass_bval = argv.rvalue();
     std::shared_ptr<CType> pass_type = argv.type();
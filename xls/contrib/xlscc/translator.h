@@ -1944,6 +1944,34 @@ class Translator {
       const clang::Stmt* init, const clang::Expr* cond_expr,
       const clang::Stmt* inc, const clang::Stmt* body, clang::ASTContext& ctx,
       const xls::SourceInfo& loc);
+  // A for loop whose trip count is known at translation time: the induction
+  // variable is declared by the loop, initialized and compared to constants,
+  // and only changed by a constant step in the increment.
+  struct CountedLoopBounds {
+    const clang::VarDecl* induction_var;
+    int64_t start;
+    int64_t step;
+    int64_t trip_count;
+  };
+
+  // Returns the bounds of the loop if it is a counted loop whose body can't
+  // exit early (break, continue, return, goto) or change the induction
+  // variable, nullopt otherwise.
+  std::optional<CountedLoopBounds> AnalyzeCountedLoop(
+      const clang::Stmt* init, const clang::Expr* cond_expr,
+      const clang::Stmt* inc, const clang::Stmt* body, clang::ASTContext& ctx);
+
+  // Translates a counted loop by translating its body once, as a function of
+  // the induction variable and the variables in scope, and invoking it with a
+  // counted_for. Returns false, generating nothing in the enclosing function,
+  // if the loop isn't a counted loop or its body has side effects which
+  // counted_for can't express (IO, statics, sub procs, references).
+  absl::StatusOr<bool> GenerateIR_CountedForLoop(
+      bool warn_inferred_loop_type, const clang::Stmt* init,
+      const clang::Expr* cond_expr, const clang::Stmt* inc,
+      const clang::Stmt* body, clang::ASTContext& ctx,
+      const xls::SourceInfo& loc);
+
   // init, cond, and inc can be nullptr
   absl::Status GenerateIR_PipelinedLoop(
       bool always_first_iter, bool warn_inferred_loop_type,
@@ -2108,6 +2136,35 @@ class Translator {
   };
 
   absl::StatusOr<StrippedType> StripTypeQualifiers(clang::QualType t);
+
+  // How arguments are passed to one parameter of a callee
+  struct CallParameter {
+    bool is_channel = false;
+    // Non-const references are returned from the call
+    bool will_assign = false;
+    // Type with references and qualifiers stripped, null for channels
+    std::shared_ptr<CType> base_ctype;
+    // Computed for the first argument passed by lvalue
+    std::optional<bool> base_contains_lvalues;
+  };
+
+  // Everything about the parameters of a function which doesn't depend on
+  // the call site. It is computed on the first call so that further calls,
+  // which invoke the already generated xls::Function, don't re-translate the
+  // parameter types.
+  struct CallSignature {
+    // Non-const methods return the new value of this
+    bool add_this_return = false;
+    std::vector<CallParameter> params;
+  };
+
+  absl::StatusOr<CallSignature*> GetCallSignature(
+      const clang::FunctionDecl* funcdecl, const xls::SourceInfo& loc);
+
+  // Pointers are stable, as arguments of a call may themselves be calls
+  absl::flat_hash_map<const clang::FunctionDecl*,
+                      std::unique_ptr<CallSignature>>
+      call_signatures_;
   absl::Status ScanStruct(const clang::RecordDecl* sd);
 
   absl::StatusOr<std::shared_ptr<CType>> InterceptBuiltInStruct(
@@ -1902,7 +1902,34 @@ TEST_F(TranslatorLogicTest, ForUnrollNoPragma) {
         }
         return a;
       })";
-  auto ret = SourceToIr(content);
+  Run({{"a", 11}, {"b", 20}}, 611, content);
+}
+
+TEST_F(TranslatorLogicTest, ForCountedNoPragmaUsesCountedFor) {
+  std::string_view content = R"(
+      long long my_package(long long a, long long b) {
+        for(int i=10;i>0;i-=3) {
+          a += i * b;
+        }
+        return a;
+      })";
+  Run({{"a", 11}, {"b", 2}}, 11 + (10 + 7 + 4 + 1) * 2, content);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, SourceToIr(content));
+  EXPECT_THAT(ir, testing::HasSubstr("counted_for("));
+}
+
+TEST_F(TranslatorLogicTest, ForCountedNoPragmaWithBreak) {
+  std::string_view content = R"(
+      long long my_package(long long a, long long b) {
+        for(int i=1;i<=10;++i) {
+          if (a > b) {
+            break;
+          }
+          a += b;
+        }
+        return a;
+      })";
 
   ASSERT_THAT(SourceToIr(content).status(),
               absl_testing::StatusIs(
@@ -3325,6 +3352,40 @@ TEST_F(TranslatorLogicTest, Function) {
   Run({{"a", 3}}, 3, content);
 }
 
+TEST_F(TranslatorLogicTest, FunctionCalledRepeatedly) {
+  std::string_view content = R"(
+      int saturate(int a, int& overflows) {
+        if (a > 100) {
+          ++overflows;
+          return 100;
+        }
+        return a;
+      }
+      int my_package(int a) {
+        int overflows = 0;
+        int x = saturate(a, overflows);
+        x += saturate(a * 2, overflows);
+        x += saturate(a * 3, overflows);
+        return x + overflows;
+      })";
+
+  Run({{"a", 3}}, 18, content);
+  Run({{"a", 40}}, 40 + 80 + 100 + 1, content);
+
+  // Every call invokes the same function
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, SourceToIr(content));
+  auto count = [&ir](std::string_view needle) {
+    int64_t n = 0;
+    for (size_t pos = ir.find(needle); pos != std::string::npos;
+         pos = ir.find(needle, pos + 1)) {
+      ++n;
+    }
+    return n;
+  };
+  EXPECT_EQ(count("invoke("), 3);
+  EXPECT_EQ(count("fn "), 2);
+}
+
 TEST_F(TranslatorLogicTest, FunctionNoOutputs) {
   std::string_view content = R"(
       void do_nothing(int a) {
@@ -4031,10 +4092,7 @@ TEST_F(TranslatorLogicTest, NonPragmaNestedLoop) {
       return a;
     })";
 
-  ASSERT_THAT(SourceToIr(content).status(),
-              absl_testing::StatusIs(
-                  absl::StatusCode::kUnimplemented,
-                  testing::HasSubstr("missing #pragma or attribute")));
+  Run({{"a", 1}}, 101, content);
 }
 
 TEST_F(TranslatorLogicTest, Label) {
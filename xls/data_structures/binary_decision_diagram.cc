@@ -18,10 +18,10 @@
 #include <cstdint>
 #include <limits>
 #include <string>
-#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -31,24 +31,87 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 
 namespace xls {
+namespace {
 
-BinaryDecisionDiagram::BinaryDecisionDiagram() {
-  // Leaf node 0.
-  nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
-                           /*p=*/1));
-  // Leaf node 1.
+// Bounds on the number of entries in the computed table. The table starts at
+// the minimum and is doubled whenever the number of nodes exceeds it.
+constexpr int64_t kMinComputedTableSize = int64_t{1} << 10;
+constexpr int64_t kMaxComputedTableSize = int64_t{1} << 22;
+
+int32_t SaturatingPathCount(int64_t paths) {
+  return std::min(paths,
+                  static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
+}
+
+}  // namespace
+
+BinaryDecisionDiagram::BinaryDecisionDiagram()
+    : computed_table_(kMinComputedTableSize) {
+  // The terminal node. The edge to it is one() and the complemented edge is
+  // zero().
   nodes_.push_back(BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1),
                            /*p=*/1));
 }
 
+int32_t BinaryDecisionDiagram::AllocateNode(const BddNode& node) {
+  int32_t index;
+  if (free_nodes_.empty()) {
+    index = nodes_.size();
+    nodes_.push_back(node);
+  } else {
+    index = free_nodes_.back();
+    free_nodes_.pop_back();
+    nodes_[index] = node;
+  }
+  if (!reference_counts_.empty()) {
+    if (index >= reference_counts_.size()) {
+      reference_counts_.resize(nodes_.size());
+    }
+    reference_counts_[index] = 0;
+    ++reference_counts_[NodeOf(node.high)];
+    ++reference_counts_[NodeOf(node.low)];
+  }
+  if (size() > computed_table_.size() &&
+      computed_table_.size() < kMaxComputedTableSize) {
+    computed_table_.assign(2 * computed_table_.size(), ComputedEntry());
+  }
+  return index;
+}
+
+void BinaryDecisionDiagram::FreeNode(int32_t node) {
+  const BddNode& dead = nodes_[node];
+  unique_tables_[dead.variable.value()].erase(NodeKey(dead.high, dead.low));
+  // Freed nodes are recognized by their zero path count.
+  nodes_[node] =
+      BddNode(BddVariable(-1), BddNodeIndex(-1), BddNodeIndex(-1), /*p=*/0);
+  free_nodes_.push_back(node);
+}
+
 BddNodeIndex BinaryDecisionDiagram::CreateVariableBaseNode(BddVariable var) {
+  // New variables go at the bottom of the order.
+  unique_tables_.emplace_back();
+  variable_levels_.push_back(level_variables_.size());
+  level_variables_.push_back(var);
+
   const BddNodeIndex high = one();
   const BddNodeIndex low = zero();
   const int32_t paths = 2;
-  nodes_.emplace_back(var, high, low, paths);
-  return BddNodeIndex(nodes_.size() - 1);
+  BddNodeIndex index = EdgeTo(AllocateNode(BddNode(var, high, low, paths)));
+  unique_tables_[var.value()].emplace(NodeKey(high, low), index);
+  return index;
+}
+
+BddNodeIndex BinaryDecisionDiagram::High(BddNodeIndex expr) const {
+  BddNodeIndex high = GetNode(expr).high;
+  return IsComplemented(expr) ? Not(high) : high;
+}
+
+BddNodeIndex BinaryDecisionDiagram::Low(BddNodeIndex expr) const {
+  BddNodeIndex low = GetNode(expr).low;
+  return IsComplemented(expr) ? Not(low) : low;
 }
 
 BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
@@ -58,97 +121,129 @@ BddNodeIndex BinaryDecisionDiagram::GetOrCreateNode(BddVariable var,
     return low;
   }
 
-  // If low == 0 and high == 1, then this is a variable base node and is kept
-  // in the variable_base_nodes_ vector.
-  if (low == zero() && high == one()) {
-    return variable_base_nodes_[var.value()];
+  // Keep the high edge uncomplemented by complementing the node instead.
+  if (IsComplemented(high)) {
+    return Not(GetOrCreateNode(var, Not(high), Not(low)));
   }
 
-  // Otherwise, this is a normal node and is kept in node_map_.
-  NodeKey key = std::make_tuple(var, high, low);
-  auto it = node_map_.lazy_emplace(key, [&](const auto& ctor) {
+  auto [it, inserted] =
+      unique_tables_[var.value()].try_emplace(NodeKey(high, low));
+  if (inserted) {
     // Compute the number of paths that the new node will have to the terminal
-    // nodes 0 and 1. Use int64s to avoid overflowing and saturate at INT32_MAX.
-    int32_t paths =
-        std::min(static_cast<int64_t>(GetNode(low).path_count) +
-                     GetNode(high).path_count,
-                 static_cast<int64_t>(std::numeric_limits<int32_t>::max()));
-    nodes_.emplace_back(var, high, low, paths);
-    BddNodeIndex node_index = BddNodeIndex(nodes_.size() - 1);
-    ctor(key, node_index);
-  });
+    // node. Use int64s to avoid overflowing and saturate at INT32_MAX.
+    int32_t paths = SaturatingPathCount(
+        static_cast<int64_t>(GetNode(low).path_count) +
+        GetNode(high).path_count);
+    it->second = EdgeTo(AllocateNode(BddNode(var, high, low, paths)));
+  }
   return it->second;
 }
 
 BddNodeIndex BinaryDecisionDiagram::Restrict(BddNodeIndex expr, BddVariable var,
                                              bool value) {
-  if (expr == zero() || expr == one()) {
+  if (NodeOf(expr) == 0) {
     return expr;
   }
 
-  const BddNode& node = GetNode(expr);
-  CHECK_LE(var, node.variable);
-  if (node.variable == var) {
-    return value ? node.high : node.low;
+  DCHECK_LE(GetVariableLevel(var), GetLevel(expr));
+  if (GetNode(expr).variable == var) {
+    return value ? High(expr) : Low(expr);
   }
   return expr;
 }
 
+BinaryDecisionDiagram::ComputedEntry& BinaryDecisionDiagram::GetComputedEntry(
+    BddNodeIndex cond, BddNodeIndex if_true, BddNodeIndex if_false) {
+  constexpr uint64_t kMultiplier = 0x9e3779b97f4a7c15ULL;
+  uint64_t hash = static_cast<uint32_t>(cond.value());
+  hash = hash * kMultiplier + static_cast<uint32_t>(if_true.value());
+  hash = hash * kMultiplier + static_cast<uint32_t>(if_false.value());
+  hash ^= hash >> 29;
+  return computed_table_[hash & (computed_table_.size() - 1)];
+}
+
 BddNodeIndex BinaryDecisionDiagram::IfThenElse(BddNodeIndex cond,
                                                BddNodeIndex if_true,
                                                BddNodeIndex if_false) {
+  // Replace branches which are (the inverse of) the condition by constants.
+  if (if_true == cond) {
+    if_true = one();
+  } else if (if_true == Not(cond)) {
+    if_true = zero();
+  }
+  if (if_false == cond) {
+    if_false = zero();
+  } else if (if_false == Not(cond)) {
+    if_false = one();
+  }
+
   if (cond == one()) {
     return if_true;
   }
   if (cond == zero()) {
     return if_false;
   }
-  if (if_true == one() && if_false == zero()) {
-    return cond;
-  }
   if (if_true == if_false) {
     return if_true;
   }
-  auto key = std::make_tuple(cond, if_true, if_false);
-  auto it = ite_map_.find(key);
-  if (it != ite_map_.end()) {
-    return it->second;
+  if (if_true == one() && if_false == zero()) {
+    return cond;
+  }
+  if (if_true == zero() && if_false == one()) {
+    return Not(cond);
   }
 
-  // The expression is non-trivial and has not been computed before. Recursively
-  // decompose the expression by peeling away the first variable and performing
-  // a Shannon decomposition.
-
-  // First, find the lowest-index variable amongst all expressions. In all paths
-  // through the BDD the variable indices are strictly increasing.
-  BddVariable min_var = GetNode(cond).variable;
-  // Only non-leaf nodes (not zero or one) have associated variables.
-  if (if_true != zero() && if_true != one()) {
-    min_var = std::min(min_var, GetNode(if_true).variable);
+  // Canonicalize the expression so that equivalent expressions share a
+  // computed table entry: the condition and the if-true branch are made
+  // uncomplemented, complementing the result if necessary.
+  if (IsComplemented(cond)) {
+    cond = Not(cond);
+    std::swap(if_true, if_false);
+  }
+  bool complement_result = false;
+  if (IsComplemented(if_true)) {
+    if_true = Not(if_true);
+    if_false = Not(if_false);
+    complement_result = true;
   }
-  if (if_false != zero() && if_false != one()) {
-    min_var = std::min(min_var, GetNode(if_false).variable);
+  auto complement = [&](BddNodeIndex expr) {
+    return complement_result ? Not(expr) : expr;
+  };
+
+  const ComputedEntry& entry = GetComputedEntry(cond, if_true, if_false);
+  if (entry.cond == cond && entry.if_true == if_true &&
+      entry.if_false == if_false) {
+    return complement(entry.result);
   }
 
+  // The expression is non-trivial and has not been computed recently.
+  // Recursively decompose the expression by peeling away the top variable and
+  // performing a Shannon decomposition.
+
+  // First, find the top variable amongst all expressions. In all paths through
+  // the BDD the variable levels are strictly increasing.
+  int64_t top_level =
+      std::min({GetLevel(cond), GetLevel(if_true), GetLevel(if_false)});
+  BddVariable top_var = level_variables_[top_level];
+
   // Perform a Shannon expansion about the variable where Shannon expansion is
   // the identity:
   //
   //   F(x0, x1, ..) = !x0 && F(0, x1, ...) + x0 && F(1, x1, ...)
   //
-  BddNodeIndex true_cofactor = IfThenElse(Restrict(cond, min_var, true),
-                                          Restrict(if_true, min_var, true),
-                                          Restrict(if_false, min_var, true));
-  BddNodeIndex false_cofactor = IfThenElse(Restrict(cond, min_var, false),
-                                           Restrict(if_true, min_var, false),
-                                           Restrict(if_false, min_var, false));
-
-  if (true_cofactor == false_cofactor) {
-    ite_map_[key] = true_cofactor;
-    return true_cofactor;
-  }
-  BddNodeIndex expr = GetOrCreateNode(min_var, true_cofactor, false_cofactor);
-  ite_map_[key] = expr;
-  return expr;
+  BddNodeIndex true_cofactor = IfThenElse(Restrict(cond, top_var, true),
+                                          Restrict(if_true, top_var, true),
+                                          Restrict(if_false, top_var, true));
+  BddNodeIndex false_cofactor = IfThenElse(Restrict(cond, top_var, false),
+                                           Restrict(if_true, top_var, false),
+                                           Restrict(if_false, top_var, false));
+  BddNodeIndex expr = GetOrCreateNode(top_var, true_cofactor, false_cofactor);
+
+  // The recursion may have overwritten the entry or resized the table, so look
+  // the entry up again.
+  GetComputedEntry(cond, if_true, if_false) = ComputedEntry{
+      .cond = cond, .if_true = if_true, .if_false = if_false, .result = expr};
+  return complement(expr);
 }
 
 template <typename T>
@@ -165,6 +260,9 @@ BddNodeIndex BinaryDecisionDiagram::NewVariable() {
   // Simply for consistency with NewVariables, we use ReserveVector here. See
   // comment in NewVariables for details.
   ReserveVector(variable_base_nodes_.size() + 1, variable_base_nodes_);
+  ReserveVector(variable_base_nodes_.size() + 1, unique_tables_);
+  ReserveVector(variable_base_nodes_.size() + 1, variable_levels_);
+  ReserveVector(variable_base_nodes_.size() + 1, level_variables_);
   variable_base_nodes_.push_back(index);
   return index;
 }
@@ -189,6 +287,9 @@ std::vector<BddNodeIndex> BinaryDecisionDiagram::NewVariables(int64_t count) {
   // [0] https://en.cppreference.com/w/cpp/container/vector/reserve
   ReserveVector(nodes_.size() + count, nodes_);
   ReserveVector(variable_base_nodes_.size() + count, variable_base_nodes_);
+  ReserveVector(variable_base_nodes_.size() + count, unique_tables_);
+  ReserveVector(variable_base_nodes_.size() + count, variable_levels_);
+  ReserveVector(variable_base_nodes_.size() + count, level_variables_);
 
   std::vector<BddNodeIndex> indexes;
   indexes.reserve(count);
@@ -201,10 +302,6 @@ std::vector<BddNodeIndex> BinaryDecisionDiagram::NewVariables(int64_t count) {
   return indexes;
 }
 
-BddNodeIndex BinaryDecisionDiagram::Not(BddNodeIndex expr) {
-  return IfThenElse(expr, zero(), one());
-}
-
 BddNodeIndex BinaryDecisionDiagram::Or(BddNodeIndex a, BddNodeIndex b) {
   return IfThenElse(a, one(), b);
 }
@@ -238,8 +335,7 @@ absl::StatusOr<bool> BinaryDecisionDiagram::Evaluate(
           absl::StrFormat("Missing value for BDD variable %d (node index %d)",
                           GetNode(result).variable.value(), var_node.value()));
     }
-    result = variable_values.at(var_node) ? GetNode(result).high
-                                          : GetNode(result).low;
+    result = variable_values.at(var_node) ? High(result) : Low(result);
   }
   VLOG(2) << "  result = " << (result == one() ? true : false);
   return result == one();
@@ -272,9 +368,9 @@ void BinaryDecisionDiagram::ToStringDnfHelper(BddNodeIndex expr,
 
   const BddNode& node = GetNode(expr);
   terms->push_back(absl::StrCat("x", node.variable.value()));
-  ToStringDnfHelper(node.high, minterms_to_emit, terms, str);
+  ToStringDnfHelper(High(expr), minterms_to_emit, terms, str);
   terms->back() = absl::StrCat("!x", node.variable.value());
-  ToStringDnfHelper(node.low, minterms_to_emit, terms, str);
+  ToStringDnfHelper(Low(expr), minterms_to_emit, terms, str);
   terms->pop_back();
 }
 
@@ -294,4 +390,195 @@ std::string BinaryDecisionDiagram::ToStringDnf(BddNodeIndex expr,
   return result;
 }
 
+int64_t BinaryDecisionDiagram::max_path_count() const {
+  int64_t max_paths = 0;
+  for (const BddNode& node : nodes_) {
+    max_paths = std::max(max_paths, static_cast<int64_t>(node.path_count));
+  }
+  return max_paths;
+}
+
+int64_t BinaryDecisionDiagram::GarbageCollect(
+    absl::Span<const BddNodeIndex> roots) {
+  std::vector<bool> live(nodes_.size(), false);
+  live[0] = true;
+  std::vector<int32_t> worklist;
+  auto mark = [&](BddNodeIndex expr) {
+    int32_t node = NodeOf(expr);
+    if (!live[node]) {
+      live[node] = true;
+      worklist.push_back(node);
+    }
+  };
+  for (BddNodeIndex root : roots) {
+    mark(root);
+  }
+  for (BddNodeIndex base_node : variable_base_nodes_) {
+    mark(base_node);
+  }
+  while (!worklist.empty()) {
+    const BddNode& node = nodes_[worklist.back()];
+    worklist.pop_back();
+    mark(node.high);
+    mark(node.low);
+  }
+
+  int64_t freed = 0;
+  for (int32_t node = 1; node < nodes_.size(); ++node) {
+    if (!live[node] && nodes_[node].path_count != 0) {
+      FreeNode(node);
+      ++freed;
+    }
+  }
+  if (freed > 0) {
+    // Entries may refer to freed nodes, which may be reused.
+    absl::c_fill(computed_table_, ComputedEntry());
+  }
+  VLOG(3) << absl::StreamFormat("BDD garbage collection freed %d of %d nodes",
+                                freed, freed + size());
+  return freed;
+}
+
+void BinaryDecisionDiagram::Dereference(int32_t node) {
+  std::vector<int32_t> worklist = {node};
+  while (!worklist.empty()) {
+    int32_t n = worklist.back();
+    worklist.pop_back();
+    if (n == 0 || --reference_counts_[n] > 0) {
+      continue;
+    }
+    worklist.push_back(NodeOf(nodes_[n].high));
+    worklist.push_back(NodeOf(nodes_[n].low));
+    FreeNode(n);
+  }
+}
+
+void BinaryDecisionDiagram::SwapLevels(int64_t level) {
+  const BddVariable upper = level_variables_[level];
+  const BddVariable lower = level_variables_[level + 1];
+  std::vector<int32_t> upper_nodes;
+  upper_nodes.reserve(unique_tables_[upper.value()].size());
+  for (const auto& [key, edge] : unique_tables_[upper.value()]) {
+    upper_nodes.push_back(NodeOf(edge));
+  }
+  auto has_lower_var = [&](BddNodeIndex expr) {
+    return NodeOf(expr) != 0 && GetNode(expr).variable == lower;
+  };
+  for (int32_t node : upper_nodes) {
+    const BddNodeIndex f1 = nodes_[node].high;
+    const BddNodeIndex f0 = nodes_[node].low;
+    if (!has_lower_var(f1) && !has_lower_var(f0)) {
+      // The node does not depend on `lower` and keeps its children.
+      continue;
+    }
+    const BddNodeIndex f11 = has_lower_var(f1) ? High(f1) : f1;
+    const BddNodeIndex f10 = has_lower_var(f1) ? Low(f1) : f1;
+    const BddNodeIndex f01 = has_lower_var(f0) ? High(f0) : f0;
+    const BddNodeIndex f00 = has_lower_var(f0) ? Low(f0) : f0;
+    // Rewrite the node in place as `lower ? (upper ? f11 : f01) : (upper ? f10
+    // : f00)`. The high edge stays uncomplemented as f11 is a high edge.
+    BddNodeIndex high = GetOrCreateNode(upper, f11, f01);
+    BddNodeIndex low = GetOrCreateNode(upper, f10, f00);
+    ++reference_counts_[NodeOf(high)];
+    ++reference_counts_[NodeOf(low)];
+    unique_tables_[upper.value()].erase(NodeKey(f1, f0));
+    nodes_[node].variable = lower;
+    nodes_[node].high = high;
+    nodes_[node].low = low;
+    unique_tables_[lower.value()].emplace(NodeKey(high, low), EdgeTo(node));
+    Dereference(NodeOf(f1));
+    Dereference(NodeOf(f0));
+  }
+  std::swap(level_variables_[level], level_variables_[level + 1]);
+  variable_levels_[upper.value()] = level + 1;
+  variable_levels_[lower.value()] = level;
+}
+
+void BinaryDecisionDiagram::Sift(BddVariable var, double max_growth) {
+  int64_t level = GetVariableLevel(var);
+  int64_t best_level = level;
+  int64_t best_size = size();
+  auto too_big = [&] {
+    if (size() < best_size) {
+      best_size = size();
+      best_level = level;
+    }
+    return static_cast<double>(size()) > max_growth * best_size;
+  };
+  while (level < variable_count() - 1) {
+    SwapLevels(level);
+    ++level;
+    if (too_big()) {
+      break;
+    }
+  }
+  while (level > 0) {
+    SwapLevels(level - 1);
+    --level;
+    if (too_big()) {
+      break;
+    }
+  }
+  while (level < best_level) {
+    SwapLevels(level);
+    ++level;
+  }
+  while (level > best_level) {
+    SwapLevels(level - 1);
+    --level;
+  }
+}
+
+void BinaryDecisionDiagram::RecomputePathCounts() {
+  for (int64_t level = variable_count() - 1; level >= 0; --level) {
+    for (const auto& [key, edge] :
+         unique_tables_[level_variables_[level].value()]) {
+      nodes_[NodeOf(edge)].path_count =
+          SaturatingPathCount(static_cast<int64_t>(path_count(key.first)) +
+                              path_count(key.second));
+    }
+  }
+}
+
+void BinaryDecisionDiagram::Reorder(absl::Span<const BddNodeIndex> roots,
+                                    double max_growth) {
+  GarbageCollect(roots);
+  int64_t initial_size = size();
+
+  reference_counts_.assign(nodes_.size(), 0);
+  for (const BddNode& node : nodes_) {
+    if (node.path_count != 0 && node.variable != BddVariable(-1)) {
+      ++reference_counts_[NodeOf(node.high)];
+      ++reference_counts_[NodeOf(node.low)];
+    }
+  }
+  for (BddNodeIndex root : roots) {
+    ++reference_counts_[NodeOf(root)];
+  }
+  for (BddNodeIndex base_node : variable_base_nodes_) {
+    ++reference_counts_[NodeOf(base_node)];
+  }
+
+  // Sift the variables with the most nodes first, as they have the most
+  // potential to shrink the graph.
+  std::vector<BddVariable> variables;
+  variables.reserve(variable_count());
+  for (int64_t i = 0; i < variable_count(); ++i) {
+    variables.push_back(BddVariable(i));
+  }
+  absl::c_stable_sort(variables, [&](BddVariable a, BddVariable b) {
+    return unique_tables_[a.value()].size() > unique_tables_[b.value()].size();
+  });
+  for (BddVariable var : variables) {
+    Sift(var, max_growth);
+  }
+
+  reference_counts_.clear();
+  RecomputePathCounts();
+  // Entries remain correct but may refer to freed nodes, which may be reused.
+  absl::c_fill(computed_table_, ComputedEntry());
+  VLOG(3) << absl::StreamFormat("BDD reordering changed size from %d to %d",
+                                initial_size, size());
+}
+
 }  // namespace xls
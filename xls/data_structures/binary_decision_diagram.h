@@ -17,11 +17,12 @@
 
 #include <cstdint>
 #include <string>
-#include <tuple>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/strong_int.h"
 
 namespace xls {
@@ -34,9 +35,27 @@ namespace xls {
 //   K.S. Brace, R.L. Rudell, and R.E. Bryant,
 //   "Efficient Implementation of a BDD package"
 //   https://ieeexplore.ieee.org/document/114826
+//
+// Expressions are referred to by edges which may be complemented, so an
+// expression and its inverse share the same nodes and Not is constant time.
+// The high (if-true) edge of a node is never complemented which keeps the
+// representation canonical. There is a single terminal node; zero is the
+// complemented edge to it.
+//
+// If-then-else results are memoized in a bounded, lossy computed table rather
+// than kept forever. Nodes which are no longer needed can be reclaimed with
+// GarbageCollect, and the variable order can be improved with Reorder. Both
+// take the set of expressions which are still in use as roots; edges not
+// reachable from the roots are invalidated.
+//
+// Reordering uses the sifting algorithm from:
+//   R. Rudell, "Dynamic variable ordering for ordered binary decision
+//   diagrams"
+//   https://ieeexplore.ieee.org/document/580029
 
 // For efficiency variables and nodes are referred to by indices into vector
-// data members in the BDD.
+// data members in the BDD. The low bit of a BddNodeIndex is the complement bit
+// of the edge and the remaining bits are the index of the node.
 XLS_DEFINE_STRONG_INT_TYPE(BddVariable, int32_t);
 XLS_DEFINE_STRONG_INT_TYPE(BddNodeIndex, int32_t);
 
@@ -52,20 +71,19 @@ struct BddNode {
   BddNodeIndex high;
   BddNodeIndex low;
 
-  // Number of paths from this node to the terminal nodes 0 and 1. Used to limit
-  // the growth of the BDD by halting evaluation if the number of paths gets too
+  // Number of paths from this node to the terminal node. Used to limit the
+  // growth of the BDD by halting evaluation if the number of paths gets too
   // large. Saturates at INT32_MAX.
   int32_t path_count;
 };
 
 class BinaryDecisionDiagram {
  public:
-  // Creates an empty BDD. Initialize the BDD contains only the nodes
-  // corresponding to zero and one.
+  // Creates an empty BDD which contains only the terminal node.
   BinaryDecisionDiagram();
 
   // Adds a new variable to the BDD and returns the node corresponding the
-  // variable's value.
+  // variable's value. The variable is placed last in the variable order.
   BddNodeIndex NewVariable();
 
   // Adds `count` new variables to the BDD and returns the nodes corresponding
@@ -75,15 +93,23 @@ class BinaryDecisionDiagram {
   std::vector<BddNodeIndex> NewVariables(int64_t count);
 
   // Returns the inverse of the given expression.
-  BddNodeIndex Not(BddNodeIndex expr);
+  BddNodeIndex Not(BddNodeIndex expr) const {
+    return BddNodeIndex(expr.value() ^ 1);
+  }
 
   // Returns the OR/AND of the given expressions.
   BddNodeIndex And(BddNodeIndex a, BddNodeIndex b);
   BddNodeIndex Or(BddNodeIndex a, BddNodeIndex b);
 
   // Returns the leaf node corresponding to zero or one.
-  BddNodeIndex zero() const { return BddNodeIndex(0); }
-  BddNodeIndex one() const { return BddNodeIndex(1); }
+  BddNodeIndex zero() const { return BddNodeIndex(1); }
+  BddNodeIndex one() const { return BddNodeIndex(0); }
+
+  // Returns true if the given edge is complemented, i.e., its expression is
+  // the inverse of the node it refers to.
+  static bool IsComplemented(BddNodeIndex expr) {
+    return (expr.value() & 1) != 0;
+  }
 
   // Evaluates the given expression with the given variable values. The keys in
   // the map are the *node* indices of the respective variable (value returned
@@ -93,13 +119,14 @@ class BinaryDecisionDiagram {
       BddNodeIndex expr,
       const absl::flat_hash_map<BddNodeIndex, bool>& variable_values) const;
 
-  // Returns the BDD node with the given index.
+  // Returns the BDD node the given edge refers to. The children of the node
+  // are those of the uncomplemented expression.
   const BddNode& GetNode(BddNodeIndex node_index) const {
-    return nodes_.at(node_index.value());
+    return nodes_.at(node_index.value() >> 1);
   }
 
-  // Returns the number of nodes in the graph.
-  int64_t size() const { return nodes_.size(); }
+  // Returns the number of (live) nodes in the graph.
+  int64_t size() const { return nodes_.size() - free_nodes_.size(); }
 
   // Returns the number of variables in the graph.
   int64_t variable_count() const { return variable_base_nodes_.size(); }
@@ -109,6 +136,9 @@ class BinaryDecisionDiagram {
     return GetNode(expr).path_count;
   }
 
+  // Returns the largest number of paths of any node in the graph.
+  int64_t max_path_count() const;
+
   // Returns the given expression in disjunctive normal form (sum of products).
   // The expression is not minimal. 'minterm_limit' is the maximum number of
   // minterms to emit before truncating the output.
@@ -118,14 +148,56 @@ class BinaryDecisionDiagram {
   // variable. The expression of a base node is exactly equal to the value of
   // the variable.
   bool IsVariableBaseNode(BddNodeIndex expr) const {
-    return GetNode(expr).high == one() && GetNode(expr).low == zero();
+    return !IsComplemented(expr) && expr != one() &&
+           GetNode(expr).high == one() && GetNode(expr).low == zero();
   }
 
   // Returns the node corresponding to the given if-then-else expression.
   BddNodeIndex IfThenElse(BddNodeIndex cond, BddNodeIndex if_true,
                           BddNodeIndex if_false);
 
+  // Returns the position of the given variable in the variable order. The
+  // variable at level zero is tested first on every path.
+  int64_t GetVariableLevel(BddVariable var) const {
+    return variable_levels_.at(var.value());
+  }
+
+  // Frees every node which is not reachable from `roots` (or the base node of
+  // a variable) for reuse. Returns the number of nodes freed.
+  int64_t GarbageCollect(absl::Span<const BddNodeIndex> roots);
+
+  // Improves the variable order by sifting: each variable in turn is moved
+  // through every level of the order and left where the graph is smallest.
+  // A variable stops moving in a direction once the graph grows by more than
+  // `max_growth` times the smallest size seen. Nodes are rewritten in place,
+  // so the edges reachable from `roots` keep their meaning; all other edges
+  // are invalidated as by GarbageCollect.
+  void Reorder(absl::Span<const BddNodeIndex> roots, double max_growth = 1.2);
+
  private:
+  // An if-then-else expression and its memoized result.
+  struct ComputedEntry {
+    BddNodeIndex cond = BddNodeIndex(-1);
+    BddNodeIndex if_true;
+    BddNodeIndex if_false;
+    BddNodeIndex result;
+  };
+
+  static int32_t NodeOf(BddNodeIndex expr) { return expr.value() >> 1; }
+  static BddNodeIndex EdgeTo(int32_t node) { return BddNodeIndex(node << 1); }
+
+  // Returns the level of the top variable of the given expression, or
+  // variable_count() for the constants.
+  int64_t GetLevel(BddNodeIndex expr) const {
+    return NodeOf(expr) == 0 ? variable_count()
+                             : GetVariableLevel(GetNode(expr).variable);
+  }
+
+  // Returns the children of the given expression, applying the complement of
+  // the edge.
+  BddNodeIndex High(BddNodeIndex expr) const;
+  BddNodeIndex Low(BddNodeIndex expr) const;
+
   // Helper for constructing a DNF string respresentation.
   void ToStringDnfHelper(BddNodeIndex expr, int64_t* minterms_to_emit,
                          std::vector<std::string>* terms,
@@ -137,7 +209,8 @@ class BinaryDecisionDiagram {
                                BddNodeIndex low);
 
   // Returns the node equal to given expression with the given variable
-  // set to the given value.
+  // set to the given value. The variable must be at or above the top variable
+  // of the expression.
   BddNodeIndex Restrict(BddNodeIndex expr, BddVariable var, bool value);
 
   // Returns the node corresponding to the value of the given variable.
@@ -148,24 +221,59 @@ class BinaryDecisionDiagram {
   // Creates the base BddNode corresponding to the given variable.
   BddNodeIndex CreateVariableBaseNode(BddVariable var);
 
+  // Stores the given node in a free or new slot of `nodes_` and returns its
+  // index.
+  int32_t AllocateNode(const BddNode& node);
+
+  // Returns the slot of the computed table for the given expression.
+  ComputedEntry& GetComputedEntry(BddNodeIndex cond, BddNodeIndex if_true,
+                                  BddNodeIndex if_false);
+
+  // Removes the given node from its unique table and adds it to the free list.
+  void FreeNode(int32_t node);
+
+  // Drops a reference to the given node during reordering, freeing it (and
+  // transitively its children) if it is no longer referenced.
+  void Dereference(int32_t node);
+
+  // Swaps the variables at the given level and the level below it.
+  void SwapLevels(int64_t level);
+
+  // Moves the given variable to the level at which the graph is smallest.
+  void Sift(BddVariable var, double max_growth);
+
+  // Recomputes the path count of every node, bottom-up.
+  void RecomputePathCounts();
+
   // NodeIndexes corresponding to the base nodes (var, one, zero) for each
   // variable.
   std::vector<BddNodeIndex> variable_base_nodes_;
 
-  // The vector of all the nodes in the BDD.
+  // The vector of all the nodes in the BDD, including freed ones.
   std::vector<BddNode> nodes_;
 
-  // A map from BDD node content (variable id, high child, low child) to the
-  // index of the respective node. This map is used to ensure that no duplicate
-  // nodes are created.
-  using NodeKey = std::tuple<BddVariable, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<NodeKey, BddNodeIndex> node_map_;
-
-  // A map from if-then-else expression to the node corresponding to that
-  // expression. The key elements are (condition, if-true, if-false). This map
-  // enables fast lookup for expressions.
-  using IteKey = std::tuple<BddNodeIndex, BddNodeIndex, BddNodeIndex>;
-  absl::flat_hash_map<IteKey, BddNodeIndex> ite_map_;
+  // Indices of the freed nodes in `nodes_`, which are reused before the
+  // vector is grown.
+  std::vector<int32_t> free_nodes_;
+
+  // For each variable, a map from the (high child, low child) of each node of
+  // the variable to the edge to that node. This map is used to ensure that no
+  // duplicate nodes are created.
+  using NodeKey = std::pair<BddNodeIndex, BddNodeIndex>;
+  std::vector<absl::flat_hash_map<NodeKey, BddNodeIndex>> unique_tables_;
+
+  // The level of each variable and the variable at each level.
+  std::vector<int32_t> variable_levels_;
+  std::vector<BddVariable> level_variables_;
+
+  // A direct-mapped cache of if-then-else results, grown along with the
+  // number of nodes up to a fixed bound. Entries are overwritten on
+  // collision, so the table bounds the memory used for memoization.
+  std::vector<ComputedEntry> computed_table_;
+
+  // The number of references to each node from roots and other nodes. Only
+  // maintained while reordering.
+  std::vector<int32_t> reference_counts_;
 };
 
 }  // namespace xls
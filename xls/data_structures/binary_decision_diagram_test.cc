@@ -15,6 +15,7 @@
 #include "xls/data_structures/binary_decision_diagram.h"
 
 #include <cstdint>
+#include <cstdlib>
 #include <limits>
 #include <string>
 #include <vector>
@@ -315,5 +316,95 @@ TEST(BinaryDecisionDiagramTest, ThreeVariableExhaustive) {
   }
 }
 
+TEST(BinaryDecisionDiagramTest, ComplementEdges) {
+  BinaryDecisionDiagram bdd;
+  BddNodeIndex x = bdd.NewVariable();
+  BddNodeIndex y = bdd.NewVariable();
+  BddNodeIndex x_and_y = bdd.And(x, y);
+
+  // Inverting an expression shares its nodes.
+  int64_t before_size = bdd.size();
+  BddNodeIndex nand = bdd.Not(x_and_y);
+  EXPECT_EQ(bdd.size(), before_size);
+  EXPECT_EQ(bdd.Not(nand), x_and_y);
+  EXPECT_EQ(bdd.Not(bdd.zero()), bdd.one());
+  EXPECT_EQ(bdd.Or(bdd.Not(x), bdd.Not(y)), nand);
+  EXPECT_EQ(bdd.path_count(nand), bdd.path_count(x_and_y));
+  EXPECT_FALSE(bdd.IsVariableBaseNode(bdd.Not(x)));
+  for (bool x_value : {false, true}) {
+    for (bool y_value : {false, true}) {
+      EXPECT_THAT(bdd.Evaluate(nand, {{x, x_value}, {y, y_value}}),
+                  IsOkAndHolds(!(x_value && y_value)));
+    }
+  }
+}
+
+TEST(BinaryDecisionDiagramTest, GarbageCollect) {
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> vars = bdd.NewVariables(8);
+  BddNodeIndex kept = bdd.And(vars[0], vars[1]);
+  int64_t kept_size = bdd.size();
+  BddNodeIndex dead = bdd.zero();
+  for (BddNodeIndex var : vars) {
+    dead = bdd.Or(bdd.And(dead, bdd.Not(var)), bdd.And(bdd.Not(dead), var));
+  }
+  EXPECT_GT(bdd.size(), kept_size);
+
+  EXPECT_GT(bdd.GarbageCollect({kept}), 0);
+  EXPECT_EQ(bdd.size(), kept_size);
+  EXPECT_EQ(bdd.ToStringDnf(kept), "x0.x1");
+  EXPECT_EQ(bdd.And(vars[1], vars[0]), kept);
+
+  // Freed nodes are reused.
+  int64_t nodes_before = bdd.size();
+  bdd.Or(vars[2], vars[3]);
+  EXPECT_EQ(bdd.size(), nodes_before + 1);
+}
+
+TEST(BinaryDecisionDiagramTest, Reorder) {
+  // x0.y0 + x1.y1 + ... has exponential size if all the x variables are
+  // ordered before the y variables and linear size if each x is next to its
+  // y.
+  constexpr int64_t kPairs = 4;
+  BinaryDecisionDiagram bdd;
+  std::vector<BddNodeIndex> xs = bdd.NewVariables(kPairs);
+  std::vector<BddNodeIndex> ys = bdd.NewVariables(kPairs);
+  BddNodeIndex expr = bdd.zero();
+  for (int64_t i = 0; i < kPairs; ++i) {
+    expr = bdd.Or(expr, bdd.And(xs[i], ys[i]));
+  }
+  bdd.GarbageCollect({expr});
+  int64_t before_size = bdd.size();
+  int64_t before_paths = bdd.path_count(expr);
+
+  bdd.Reorder({expr});
+  EXPECT_LT(bdd.size(), before_size);
+  EXPECT_LT(bdd.path_count(expr), before_paths);
+  for (int64_t i = 0; i < kPairs; ++i) {
+    EXPECT_EQ(std::abs(bdd.GetVariableLevel(bdd.GetNode(xs[i]).variable) -
+                       bdd.GetVariableLevel(bdd.GetNode(ys[i]).variable)),
+              1);
+  }
+
+  // The expression keeps its meaning and new expressions are still canonical.
+  for (int64_t value = 0; value < (1 << (2 * kPairs)); ++value) {
+    absl::flat_hash_map<BddNodeIndex, bool> values;
+    bool expected = false;
+    for (int64_t i = 0; i < kPairs; ++i) {
+      bool x = ((value >> i) & 1) != 0;
+      bool y = ((value >> (i + kPairs)) & 1) != 0;
+      values[xs[i]] = x;
+      values[ys[i]] = y;
+      expected = expected || (x && y);
+    }
+    EXPECT_THAT(bdd.Evaluate(expr, values), IsOkAndHolds(expected));
+  }
+  BddNodeIndex rebuilt = bdd.zero();
+  for (int64_t i = kPairs - 1; i >= 0; --i) {
+    rebuilt = bdd.Or(bdd.And(ys[i], xs[i]), rebuilt);
+  }
+  EXPECT_EQ(rebuilt, expr);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,55 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/csr_graph.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+DirectedCsrGraph DirectedCsrGraph::FromEdges(
+    int64_t vertex_count,
+    absl::Span<const std::pair<int64_t, int64_t>> edges) {
+  std::vector<int64_t> offsets(vertex_count + 1, 0);
+  for (auto [source, target] : edges) {
+    CHECK(source >= 0 && source < vertex_count) << source;
+    CHECK(target >= 0 && target < vertex_count) << target;
+    ++offsets[source + 1];
+  }
+  for (int64_t v = 0; v < vertex_count; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  // A counting sort by source, which keeps the edges of each source in order.
+  std::vector<int64_t> next(offsets.begin(), offsets.end() - 1);
+  std::vector<int64_t> targets(edges.size());
+  for (auto [source, target] : edges) {
+    targets[next[source]++] = target;
+  }
+  return DirectedCsrGraph(std::move(offsets), std::move(targets));
+}
+
+DirectedCsrGraph::DirectedCsrGraph(std::vector<int64_t> offsets,
+                                   std::vector<int64_t> targets)
+    : offsets_(std::move(offsets)), targets_(std::move(targets)) {
+  CHECK(!offsets_.empty());
+  CHECK_EQ(offsets_.front(), 0);
+  CHECK_EQ(offsets_.back(), targets_.size());
+}
+
+}  // namespace xls
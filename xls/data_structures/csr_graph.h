@@ -0,0 +1,64 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_CSR_GRAPH_H_
+#define XLS_DATA_STRUCTURES_CSR_GRAPH_H_
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A directed graph over the vertices 0..vertex_count()-1 stored in compressed
+// sparse row form: the successors of `v` are
+// `targets()[offsets()[v]]..targets()[offsets()[v + 1] - 1]`.
+class DirectedCsrGraph {
+ public:
+  // Builds the graph from a list of (source, target) edges. The successors of
+  // each vertex keep the order in which their edges were given; self-edges and
+  // duplicate edges are kept.
+  static DirectedCsrGraph FromEdges(
+      int64_t vertex_count,
+      absl::Span<const std::pair<int64_t, int64_t>> edges);
+
+  // `offsets` must have vertex_count + 1 nondecreasing entries, starting at 0
+  // and ending at `targets.size()`.
+  DirectedCsrGraph(std::vector<int64_t> offsets, std::vector<int64_t> targets);
+
+  int64_t vertex_count() const {
+    return static_cast<int64_t>(offsets_.size()) - 1;
+  }
+  int64_t edge_count() const { return static_cast<int64_t>(targets_.size()); }
+  int64_t out_degree(int64_t v) const {
+    return offsets_[v + 1] - offsets_[v];
+  }
+
+  absl::Span<const int64_t> successors(int64_t v) const {
+    return absl::MakeConstSpan(targets_).subspan(offsets_[v], out_degree(v));
+  }
+
+  absl::Span<const int64_t> offsets() const { return offsets_; }
+  absl::Span<const int64_t> targets() const { return targets_; }
+
+ private:
+  std::vector<int64_t> offsets_;
+  std::vector<int64_t> targets_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_CSR_GRAPH_H_
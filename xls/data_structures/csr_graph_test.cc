@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/csr_graph.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(DirectedCsrGraphTest, FromEdges) {
+  DirectedCsrGraph graph =
+      DirectedCsrGraph::FromEdges(4, {{2, 1}, {0, 3}, {2, 0}, {2, 2}, {0, 3}});
+  EXPECT_EQ(graph.vertex_count(), 4);
+  EXPECT_EQ(graph.edge_count(), 5);
+  EXPECT_THAT(graph.successors(0), ElementsAre(3, 3));
+  EXPECT_THAT(graph.successors(1), IsEmpty());
+  EXPECT_THAT(graph.successors(2), ElementsAre(1, 0, 2));
+  EXPECT_THAT(graph.successors(3), IsEmpty());
+  EXPECT_THAT(graph.offsets(), ElementsAre(0, 2, 2, 5, 5));
+}
+
+TEST(DirectedCsrGraphTest, Empty) {
+  DirectedCsrGraph graph = DirectedCsrGraph::FromEdges(0, {});
+  EXPECT_EQ(graph.vertex_count(), 0);
+  EXPECT_EQ(graph.edge_count(), 0);
+}
+
+}  // namespace
+}  // namespace xls
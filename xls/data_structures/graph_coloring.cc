@@ -0,0 +1,342 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/graph_coloring.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_set.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+
+CsrGraph CsrGraph::FromEdges(
+    int64_t vertex_count,
+    absl::Span<const std::pair<int64_t, int64_t>> edges) {
+  std::vector<std::pair<int64_t, int64_t>> arcs;
+  arcs.reserve(2 * edges.size());
+  for (auto [a, b] : edges) {
+    CHECK(a >= 0 && a < vertex_count) << a;
+    CHECK(b >= 0 && b < vertex_count) << b;
+    if (a != b) {
+      arcs.push_back({a, b});
+      arcs.push_back({b, a});
+    }
+  }
+  std::sort(arcs.begin(), arcs.end());
+  arcs.erase(std::unique(arcs.begin(), arcs.end()), arcs.end());
+
+  std::vector<int64_t> offsets(vertex_count + 1, 0);
+  std::vector<int64_t> targets;
+  targets.reserve(arcs.size());
+  for (auto [a, b] : arcs) {
+    ++offsets[a + 1];
+    targets.push_back(b);
+  }
+  for (int64_t v = 0; v < vertex_count; ++v) {
+    offsets[v + 1] += offsets[v];
+  }
+  return CsrGraph(std::move(offsets), std::move(targets));
+}
+
+std::vector<int64_t> DSaturColoring(const CsrGraph& graph) {
+  const int64_t n = graph.vertex_count();
+  std::vector<int64_t> colors(n, -1);
+  // The colors of each vertex's colored neighbors. A vertex's own color is
+  // at most its degree, so only the colors up to the degree are kept in a
+  // bitmap (whose first clear bit is then the vertex's color); any others
+  // only count towards the saturation.
+  std::vector<InlineBitmap> neighbor_colors;
+  neighbor_colors.reserve(n);
+  std::vector<absl::flat_hash_set<int64_t>> high_neighbor_colors(n);
+  std::vector<int64_t> saturation(n, 0);
+  std::vector<int64_t> uncolored_degree(n);
+
+  // Ordered by (saturation, uncolored degree, -vertex); the last element is
+  // the next vertex to color.
+  using Key = std::tuple<int64_t, int64_t, int64_t>;
+  absl::btree_set<Key> queue;
+  for (int64_t v = 0; v < n; ++v) {
+    neighbor_colors.push_back(InlineBitmap(graph.degree(v) + 1));
+    uncolored_degree[v] = graph.degree(v);
+    queue.insert(Key{0, uncolored_degree[v], -v});
+  }
+
+  while (!queue.empty()) {
+    auto last = std::prev(queue.end());
+    const int64_t v = -std::get<2>(*last);
+    queue.erase(last);
+    const int64_t color = neighbor_colors[v].CountTrailingOnes();
+    colors[v] = color;
+    for (int64_t u : graph.neighbors(v)) {
+      if (colors[u] >= 0) {
+        continue;
+      }
+      queue.erase(Key{saturation[u], uncolored_degree[u], -u});
+      --uncolored_degree[u];
+      bool new_color;
+      if (color < neighbor_colors[u].bit_count()) {
+        new_color = !neighbor_colors[u].Get(color);
+        neighbor_colors[u].Set(color);
+      } else {
+        new_color = high_neighbor_colors[u].insert(color).second;
+      }
+      if (new_color) {
+        ++saturation[u];
+      }
+      queue.insert(Key{saturation[u], uncolored_degree[u], -u});
+    }
+  }
+  return colors;
+}
+
+namespace {
+
+// State of the tabu search for a coloring with `color_count` colors.
+class TabuSearch {
+ public:
+  TabuSearch(const CsrGraph& graph, std::vector<int64_t> colors,
+             int64_t color_count, std::mt19937_64& rng)
+      : graph_(graph),
+        color_count_(color_count),
+        colors_(std::move(colors)),
+        neighbor_color_counts_(graph.vertex_count() * color_count, 0),
+        tabu_until_(graph.vertex_count() * color_count, 0),
+        conflicted_position_(graph.vertex_count(), -1),
+        rng_(rng) {
+    for (int64_t v = 0; v < graph_.vertex_count(); ++v) {
+      for (int64_t u : graph_.neighbors(v)) {
+        ++Count(v, colors_[u]);
+      }
+    }
+    for (int64_t v = 0; v < graph_.vertex_count(); ++v) {
+      conflicts_ += Count(v, colors_[v]);
+      UpdateConflicted(v);
+    }
+    conflicts_ /= 2;
+  }
+
+  int64_t conflicts() const { return conflicts_; }
+  std::vector<int64_t>& colors() { return colors_; }
+
+  // Makes the best non-tabu move from a conflicted vertex to another color.
+  void Step(int64_t iteration) {
+    int64_t best_delta = std::numeric_limits<int64_t>::max();
+    int64_t best_vertex = -1;
+    int64_t best_color = -1;
+    int64_t ties = 0;
+    for (int64_t v : conflicted_) {
+      const int64_t current = Count(v, colors_[v]);
+      for (int64_t c = 0; c < color_count_; ++c) {
+        if (c == colors_[v]) {
+          continue;
+        }
+        const int64_t delta = Count(v, c) - current;
+        // A tabu move is still allowed if it gives the fewest conflicts yet.
+        if (tabu_until_[v * color_count_ + c] > iteration &&
+            conflicts_ + delta >= best_conflicts_) {
+          continue;
+        }
+        if (delta < best_delta) {
+          best_delta = delta;
+          best_vertex = v;
+          best_color = c;
+          ties = 1;
+        } else if (delta == best_delta &&
+                   std::uniform_int_distribution<int64_t>(0, ties++)(rng_) ==
+                       0) {
+          best_vertex = v;
+          best_color = c;
+        }
+      }
+    }
+    if (best_vertex < 0) {
+      return;
+    }
+    const int64_t old_color = colors_[best_vertex];
+    colors_[best_vertex] = best_color;
+    for (int64_t u : graph_.neighbors(best_vertex)) {
+      --Count(u, old_color);
+      ++Count(u, best_color);
+      UpdateConflicted(u);
+    }
+    UpdateConflicted(best_vertex);
+    conflicts_ += best_delta;
+    best_conflicts_ = std::min(best_conflicts_, conflicts_);
+    // The usual tenure of TabuCol: proportional to the number of conflicted
+    // vertices plus a small random amount.
+    tabu_until_[best_vertex * color_count_ + old_color] =
+        iteration + 1 + (6 * static_cast<int64_t>(conflicted_.size())) / 10 +
+        std::uniform_int_distribution<int64_t>(0, 9)(rng_);
+  }
+
+ private:
+  int64_t& Count(int64_t v, int64_t c) {
+    return neighbor_color_counts_[v * color_count_ + c];
+  }
+
+  // Adds or removes `v` from the conflicted vertices as appropriate.
+  void UpdateConflicted(int64_t v) {
+    const bool conflicted = Count(v, colors_[v]) > 0;
+    if (conflicted && conflicted_position_[v] < 0) {
+      conflicted_position_[v] = conflicted_.size();
+      conflicted_.push_back(v);
+    } else if (!conflicted && conflicted_position_[v] >= 0) {
+      const int64_t last = conflicted_.back();
+      conflicted_[conflicted_position_[v]] = last;
+      conflicted_position_[last] = conflicted_position_[v];
+      conflicted_.pop_back();
+      conflicted_position_[v] = -1;
+    }
+  }
+
+  const CsrGraph& graph_;
+  const int64_t color_count_;
+  std::vector<int64_t> colors_;
+  // The number of neighbors of each vertex with each color.
+  std::vector<int64_t> neighbor_color_counts_;
+  // The iteration until which moving each vertex back to each color is tabu.
+  std::vector<int64_t> tabu_until_;
+  std::vector<int64_t> conflicted_;
+  std::vector<int64_t> conflicted_position_;
+  int64_t conflicts_ = 0;
+  int64_t best_conflicts_ = std::numeric_limits<int64_t>::max();
+  std::mt19937_64& rng_;
+};
+
+}  // namespace
+
+std::vector<int64_t> ImproveColoring(const CsrGraph& graph,
+                                     std::vector<int64_t> coloring,
+                                     const ColoringSearchOptions& options) {
+  const int64_t n = graph.vertex_count();
+  CHECK_EQ(coloring.size(), n);
+  const absl::Time deadline = options.time_limit == absl::InfiniteDuration()
+                                  ? absl::InfiniteFuture()
+                                  : absl::Now() + options.time_limit;
+  std::mt19937_64 rng(options.seed);
+  int64_t color_count =
+      n == 0 ? 0 : *std::max_element(coloring.begin(), coloring.end()) + 1;
+  while (color_count > 1) {
+    // Spread the vertices of the highest color over the other colors, each to
+    // the color fewest of its neighbors have.
+    const int64_t target = color_count - 1;
+    std::vector<int64_t> colors = coloring;
+    for (int64_t v = 0; v < n; ++v) {
+      if (colors[v] != target) {
+        continue;
+      }
+      std::vector<int64_t> counts(target, 0);
+      for (int64_t u : graph.neighbors(v)) {
+        if (colors[u] < target) {
+          ++counts[colors[u]];
+        }
+      }
+      colors[v] = std::min_element(counts.begin(), counts.end()) -
+                  counts.begin();
+    }
+
+    TabuSearch search(graph, std::move(colors), target, rng);
+    for (int64_t iteration = 0;
+         iteration < options.max_iterations && search.conflicts() > 0;
+         ++iteration) {
+      if (iteration % 1024 == 0 && absl::Now() >= deadline) {
+        break;
+      }
+      search.Step(iteration);
+    }
+    if (search.conflicts() > 0) {
+      break;
+    }
+    coloring = std::move(search.colors());
+    color_count = target;
+  }
+  return coloring;
+}
+
+std::vector<std::vector<int64_t>> ColorClasses(
+    absl::Span<const int64_t> coloring) {
+  std::vector<std::vector<int64_t>> classes;
+  for (int64_t v = 0; v < coloring.size(); ++v) {
+    if (coloring[v] >= classes.size()) {
+      classes.resize(coloring[v] + 1);
+    }
+    classes[coloring[v]].push_back(v);
+  }
+  std::erase_if(classes, [](const std::vector<int64_t>& c) {
+    return c.empty();
+  });
+  return classes;
+}
+
+IncrementalColoring::IncrementalColoring(const CsrGraph& graph)
+    : adjacency_(graph.vertex_count()), colors_(DSaturColoring(graph)) {
+  for (int64_t v = 0; v < graph.vertex_count(); ++v) {
+    absl::Span<const int64_t> neighbors = graph.neighbors(v);
+    adjacency_[v].insert(neighbors.begin(), neighbors.end());
+  }
+}
+
+int64_t IncrementalColoring::AddVertex() {
+  adjacency_.emplace_back();
+  colors_.push_back(0);
+  return static_cast<int64_t>(colors_.size()) - 1;
+}
+
+bool IncrementalColoring::AddEdge(int64_t a, int64_t b) {
+  CHECK(a >= 0 && a < colors_.size()) << a;
+  CHECK(b >= 0 && b < colors_.size()) << b;
+  if (a == b || !adjacency_[a].insert(b).second) {
+    return false;
+  }
+  adjacency_[b].insert(a);
+  if (colors_[a] != colors_[b]) {
+    return false;
+  }
+  // Recoloring the vertex with fewer neighbors is the more likely to get by
+  // without a new color.
+  const int64_t v = adjacency_[a].size() <= adjacency_[b].size() ? a : b;
+  colors_[v] = SmallestFreeColor(v);
+  return true;
+}
+
+int64_t IncrementalColoring::color_count() const {
+  return colors_.empty()
+             ? 0
+             : *std::max_element(colors_.begin(), colors_.end()) + 1;
+}
+
+int64_t IncrementalColoring::SmallestFreeColor(int64_t v) const {
+  InlineBitmap used(adjacency_[v].size() + 1);
+  for (int64_t u : adjacency_[v]) {
+    if (colors_[u] < used.bit_count()) {
+      used.Set(colors_[u]);
+    }
+  }
+  return used.CountTrailingOnes();
+}
+
+}  // namespace xls
@@ -29,6 +29,8 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "z3/src/api/c++/z3++.h"
 
 namespace xls {
@@ -227,6 +229,97 @@ std::vector<absl::flat_hash_set<V>> Z3Coloring(
   return result;
 }
 
+// An undirected graph over the vertices 0..vertex_count()-1 stored in
+// compressed sparse row form, for coloring graphs too large for the
+// hash-set based functions above.
+class CsrGraph {
+ public:
+  // Builds the graph from a list of edges. Self-edges and duplicate edges are
+  // dropped; each edge may be given in either or both directions.
+  static CsrGraph FromEdges(
+      int64_t vertex_count,
+      absl::Span<const std::pair<int64_t, int64_t>> edges);
+
+  int64_t vertex_count() const {
+    return static_cast<int64_t>(offsets_.size()) - 1;
+  }
+  int64_t degree(int64_t v) const { return offsets_[v + 1] - offsets_[v]; }
+
+  // The neighbors of `v`, in increasing order.
+  absl::Span<const int64_t> neighbors(int64_t v) const {
+    return absl::MakeConstSpan(targets_).subspan(offsets_[v], degree(v));
+  }
+
+ private:
+  CsrGraph(std::vector<int64_t> offsets, std::vector<int64_t> targets)
+      : offsets_(std::move(offsets)), targets_(std::move(targets)) {}
+
+  std::vector<int64_t> offsets_;
+  std::vector<int64_t> targets_;
+};
+
+// Colors the graph with the DSatur heuristic: repeatedly colors the uncolored
+// vertex with the most distinctly colored neighbors (ties broken by degree in
+// the uncolored subgraph, then by index) with the smallest color none of its
+// neighbors has. Returns the color of each vertex; colors are dense from 0.
+//
+// This is deterministic and takes O((V + E) log V) time.
+std::vector<int64_t> DSaturColoring(const CsrGraph& graph);
+
+struct ColoringSearchOptions {
+  // Number of local search moves made while trying to remove each color.
+  // The search is deterministic for a given seed if `time_limit` isn't hit.
+  int64_t max_iterations = 10000;
+  absl::Duration time_limit = absl::InfiniteDuration();
+  uint64_t seed = 0;
+};
+
+// Tries to reduce the number of colors of the valid `coloring` with a tabu
+// search (TabuCol): the vertices of the highest color are spread over the
+// others and conflicts are then repaired by recoloring one vertex at a time.
+// Whenever the conflicts are all repaired another color is removed. Returns
+// the best valid coloring found, which is never worse than `coloring`.
+//
+// This is a heuristic replacement for Z3Coloring on graphs too large to
+// solve exactly.
+std::vector<int64_t> ImproveColoring(const CsrGraph& graph,
+                                     std::vector<int64_t> coloring,
+                                     const ColoringSearchOptions& options = {});
+
+// Returns the vertices of each color used by `coloring`, in increasing order
+// of color and vertex. Unused colors are skipped.
+std::vector<std::vector<int64_t>> ColorClasses(
+    absl::Span<const int64_t> coloring);
+
+// A graph coloring which is kept valid as edges are added to the graph.
+// Adding an edge between two vertices of the same color recolors one of them
+// (the one of lower degree) with the smallest color its neighbors don't use,
+// so previously colored vertices keep their colors wherever possible.
+class IncrementalColoring {
+ public:
+  // Starts from the given graph, colored with DSaturColoring().
+  explicit IncrementalColoring(const CsrGraph& graph);
+
+  // Adds a new vertex without edges, colored 0, and returns its index.
+  int64_t AddVertex();
+
+  // Adds the undirected edge (a, b). Returns true if a vertex was recolored.
+  bool AddEdge(int64_t a, int64_t b);
+
+  int64_t color(int64_t v) const { return colors_[v]; }
+  absl::Span<const int64_t> colors() const { return colors_; }
+
+  // One more than the largest color in use.
+  int64_t color_count() const;
+
+ private:
+  // Returns the smallest color which no neighbor of `v` has.
+  int64_t SmallestFreeColor(int64_t v) const;
+
+  std::vector<absl::flat_hash_set<int64_t>> adjacency_;
+  std::vector<int64_t> colors_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_GRAPH_COLORING_H_
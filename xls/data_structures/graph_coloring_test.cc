@@ -14,12 +14,16 @@
 
 #include "xls/data_structures/graph_coloring.h"
 
+#include <cstdint>
+#include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/types/span.h"
 
 namespace xls {
 namespace {
@@ -143,5 +147,143 @@ TEST(GraphColoringTest, Wheel) {
   EXPECT_TRUE(IsValidColoring(graph, Z3FromMap(graph)));
 }
 
+bool IsValidCsrColoring(const CsrGraph& graph,
+                        absl::Span<const int64_t> coloring) {
+  for (int64_t v = 0; v < graph.vertex_count(); ++v) {
+    if (coloring[v] < 0) {
+      return false;
+    }
+    for (int64_t u : graph.neighbors(v)) {
+      if (coloring[u] == coloring[v]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int64_t ColorCount(absl::Span<const int64_t> coloring) {
+  return ColorClasses(coloring).size();
+}
+
+std::vector<std::pair<int64_t, int64_t>> CycleEdges(int64_t n) {
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i < n; ++i) {
+    edges.push_back({i, (i + 1) % n});
+  }
+  return edges;
+}
+
+std::vector<std::pair<int64_t, int64_t>> RandomEdges(int64_t n,
+                                                     double probability,
+                                                     uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::bernoulli_distribution edge(probability);
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t a = 0; a < n; ++a) {
+    for (int64_t b = a + 1; b < n; ++b) {
+      if (edge(rng)) {
+        edges.push_back({a, b});
+      }
+    }
+  }
+  return edges;
+}
+
+TEST(CsrGraphTest, FromEdges) {
+  CsrGraph graph =
+      CsrGraph::FromEdges(4, {{0, 1}, {1, 0}, {2, 2}, {3, 1}, {0, 1}});
+  EXPECT_EQ(graph.vertex_count(), 4);
+  EXPECT_EQ(graph.degree(0), 1);
+  EXPECT_EQ(graph.degree(1), 2);
+  EXPECT_EQ(graph.degree(2), 0);
+  EXPECT_EQ(graph.degree(3), 1);
+  EXPECT_EQ(std::vector<int64_t>(graph.neighbors(1).begin(),
+                                 graph.neighbors(1).end()),
+            (std::vector<int64_t>{0, 3}));
+}
+
+TEST(DSaturColoringTest, SmallGraphs) {
+  CsrGraph even_cycle = CsrGraph::FromEdges(6, CycleEdges(6));
+  EXPECT_TRUE(IsValidCsrColoring(even_cycle, DSaturColoring(even_cycle)));
+  EXPECT_EQ(ColorCount(DSaturColoring(even_cycle)), 2);
+
+  CsrGraph odd_cycle = CsrGraph::FromEdges(5, CycleEdges(5));
+  EXPECT_TRUE(IsValidCsrColoring(odd_cycle, DSaturColoring(odd_cycle)));
+  EXPECT_EQ(ColorCount(DSaturColoring(odd_cycle)), 3);
+
+  std::vector<std::pair<int64_t, int64_t>> wheel_edges = CycleEdges(5);
+  for (int64_t i = 0; i < 5; ++i) {
+    wheel_edges.push_back({5, i});
+  }
+  CsrGraph wheel = CsrGraph::FromEdges(6, wheel_edges);
+  EXPECT_TRUE(IsValidCsrColoring(wheel, DSaturColoring(wheel)));
+  EXPECT_EQ(ColorCount(DSaturColoring(wheel)), 4);
+
+  CsrGraph empty = CsrGraph::FromEdges(3, {});
+  EXPECT_EQ(DSaturColoring(empty), (std::vector<int64_t>{0, 0, 0}));
+}
+
+// Crown graphs (K_{n,n} minus a perfect matching) need n colors when greedily
+// colored in the order a0, b0, a1, b1, ... but are bipartite.
+TEST(ImproveColoringTest, CrownGraph) {
+  constexpr int64_t kHalf = 8;
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (int64_t i = 0; i < kHalf; ++i) {
+    for (int64_t j = 0; j < kHalf; ++j) {
+      if (i != j) {
+        edges.push_back({2 * i, 2 * j + 1});
+      }
+    }
+  }
+  CsrGraph graph = CsrGraph::FromEdges(2 * kHalf, edges);
+  std::vector<int64_t> greedy(2 * kHalf);
+  for (int64_t v = 0; v < 2 * kHalf; ++v) {
+    greedy[v] = v / 2;
+  }
+  ASSERT_TRUE(IsValidCsrColoring(graph, greedy));
+  std::vector<int64_t> improved = ImproveColoring(graph, greedy);
+  EXPECT_TRUE(IsValidCsrColoring(graph, improved));
+  EXPECT_EQ(ColorCount(improved), 2);
+}
+
+TEST(ImproveColoringTest, NeverWorseThanDSatur) {
+  for (uint64_t seed = 0; seed < 4; ++seed) {
+    CsrGraph graph = CsrGraph::FromEdges(200, RandomEdges(200, 0.1, seed));
+    std::vector<int64_t> dsatur = DSaturColoring(graph);
+    ASSERT_TRUE(IsValidCsrColoring(graph, dsatur));
+    std::vector<int64_t> improved = ImproveColoring(
+        graph, dsatur, ColoringSearchOptions{.max_iterations = 2000});
+    EXPECT_TRUE(IsValidCsrColoring(graph, improved));
+    EXPECT_LE(ColorCount(improved), ColorCount(dsatur));
+  }
+}
+
+TEST(IncrementalColoringTest, StaysValidAsEdgesAreAdded) {
+  std::vector<std::pair<int64_t, int64_t>> edges = RandomEdges(100, 0.2, 7);
+  IncrementalColoring coloring(CsrGraph::FromEdges(100, {}));
+  EXPECT_EQ(coloring.color_count(), 1);
+  for (int64_t i = 0; i < edges.size(); ++i) {
+    auto [a, b] = edges[i];
+    bool same_color = coloring.color(a) == coloring.color(b);
+    EXPECT_EQ(coloring.AddEdge(a, b), same_color);
+    if (i % 100 == 0) {
+      CsrGraph graph = CsrGraph::FromEdges(
+          100, absl::MakeConstSpan(edges).subspan(0, i + 1));
+      EXPECT_TRUE(IsValidCsrColoring(graph, coloring.colors()));
+    }
+  }
+  EXPECT_TRUE(
+      IsValidCsrColoring(CsrGraph::FromEdges(100, edges), coloring.colors()));
+  // Re-adding an edge changes nothing.
+  EXPECT_FALSE(coloring.AddEdge(edges[0].first, edges[0].second));
+
+  int64_t v = coloring.AddVertex();
+  EXPECT_EQ(v, 100);
+  EXPECT_EQ(coloring.color(v), 0);
+  coloring.AddEdge(v, 0);
+  EXPECT_NE(coloring.color(v), coloring.color(0));
+}
+
 }  // namespace
 }  // namespace xls
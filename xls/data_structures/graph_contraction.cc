@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/graph_contraction.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/csr_graph.h"
+
+namespace xls {
+
+DirectedCsrGraph ContractVertices(const DirectedCsrGraph& graph,
+                                  absl::Span<const int64_t> class_of,
+                                  int64_t class_count) {
+  CHECK_EQ(class_of.size(), graph.vertex_count());
+  // The members of each class, by a counting sort.
+  std::vector<int64_t> member_offsets(class_count + 1, 0);
+  for (int64_t c : class_of) {
+    CHECK(c >= 0 && c < class_count) << c;
+    ++member_offsets[c + 1];
+  }
+  for (int64_t c = 0; c < class_count; ++c) {
+    member_offsets[c + 1] += member_offsets[c];
+  }
+  std::vector<int64_t> members(class_of.size());
+  {
+    std::vector<int64_t> next(member_offsets.begin(), member_offsets.end() - 1);
+    for (int64_t v = 0; v < class_of.size(); ++v) {
+      members[next[class_of[v]]++] = v;
+    }
+  }
+
+  std::vector<int64_t> offsets;
+  offsets.reserve(class_count + 1);
+  offsets.push_back(0);
+  std::vector<int64_t> targets;
+  // The last class which got an edge to each class, to drop duplicate edges.
+  std::vector<int64_t> last_source(class_count, -1);
+  for (int64_t c = 0; c < class_count; ++c) {
+    const auto begin = static_cast<std::ptrdiff_t>(targets.size());
+    for (int64_t i = member_offsets[c]; i < member_offsets[c + 1]; ++i) {
+      for (int64_t w : graph.successors(members[i])) {
+        const int64_t target = class_of[w];
+        if (target != c && last_source[target] != c) {
+          last_source[target] = c;
+          targets.push_back(target);
+        }
+      }
+    }
+    std::sort(targets.begin() + begin, targets.end());
+    offsets.push_back(targets.size());
+  }
+  return DirectedCsrGraph(std::move(offsets), std::move(targets));
+}
+
+}  // namespace xls
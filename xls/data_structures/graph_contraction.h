@@ -22,6 +22,8 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/data_structures/csr_graph.h"
 #include "xls/data_structures/union_find_map.h"
 
 namespace xls {
@@ -297,6 +299,18 @@ class GraphContraction {
   UnionFindMap<V, absl::flat_hash_map<V, EW>> in_edges_;
 };
 
+// Identifies the vertices of `graph` in each class of the partition given by
+// `class_of`, whose entries must be in [0, class_count). Returns the graph over
+// the classes with an edge from one class to a different one iff `graph` has an
+// edge between some of their members; successors are sorted and without
+// duplicates. This takes O(V + E) time, plus sorting the successor lists.
+//
+// With the components of ComputeStronglyConnectedComponents() as the classes
+// this computes the condensation of `graph`, which is acyclic.
+DirectedCsrGraph ContractVertices(const DirectedCsrGraph& graph,
+                                  absl::Span<const int64_t> class_of,
+                                  int64_t class_count);
+
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_GRAPH_CONTRACTION_H_
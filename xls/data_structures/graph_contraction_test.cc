@@ -17,12 +17,15 @@
 #include <cstdint>
 #include <optional>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/variant.h"
+#include "xls/data_structures/csr_graph.h"
+#include "xls/data_structures/strongly_connected_components.h"
 
 namespace xls {
 namespace {
@@ -325,5 +328,34 @@ TEST(GraphContractionTest, LongestNodePathsSelfEdge) {
 // always result in a graph with a single vertex and possibly a self-edge
 // (and the vertex/edge weights should be the sum of all vertex/edge weights).
 
+TEST(ContractVerticesTest, Condensation) {
+  // Components {0, 1}, {2, 3} and {4}, with several edges between the first
+  // two.
+  DirectedCsrGraph graph = DirectedCsrGraph::FromEdges(
+      5, {{0, 1}, {1, 0}, {0, 2}, {1, 3}, {2, 3}, {3, 2}, {1, 4}, {3, 4}});
+  StronglyConnectedComponentMap components =
+      ComputeStronglyConnectedComponents(graph);
+  ASSERT_EQ(components.component_count, 3);
+  DirectedCsrGraph condensation = ContractVertices(
+      graph, components.component_of, components.component_count);
+  EXPECT_EQ(condensation.vertex_count(), 3);
+  int64_t a = components.component_of[0];
+  int64_t b = components.component_of[2];
+  int64_t c = components.component_of[4];
+  EXPECT_THAT(condensation.successors(a), UnorderedElementsAre(b, c));
+  EXPECT_THAT(condensation.successors(b), UnorderedElementsAre(c));
+  EXPECT_THAT(condensation.successors(c), ::testing::IsEmpty());
+  EXPECT_EQ(condensation.edge_count(), 3);
+}
+
+TEST(ContractVerticesTest, ArbitraryPartition) {
+  DirectedCsrGraph graph =
+      DirectedCsrGraph::FromEdges(4, {{0, 1}, {1, 2}, {2, 3}, {3, 0}});
+  std::vector<int64_t> class_of = {0, 1, 0, 1};
+  DirectedCsrGraph contracted = ContractVertices(graph, class_of, 2);
+  EXPECT_THAT(contracted.successors(0), ::testing::ElementsAre(1));
+  EXPECT_THAT(contracted.successors(1), ::testing::ElementsAre(0));
+}
+
 }  // namespace
 }  // namespace xls
@@ -23,6 +23,7 @@
 #include "absl/base/casts.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
+#include "absl/numeric/bits.h"
 #include "absl/types/span.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/endian.h"
@@ -155,12 +156,10 @@ class InlineBitmap {
     if (bit_count_ != other.bit_count_) {
       return false;
     }
-    for (int64_t wordno = 0; wordno < word_count(); ++wordno) {
-      if (data_[wordno] != other.data_[wordno]) {
-        return false;
-      }
-    }
-    return true;
+    // Bits past the end are always zero, so whole words can be compared.
+    return word_count() == 0 ||
+           std::memcmp(data_.data(), other.data_.data(),
+                       word_count() * kWordBytes) == 0;
   }
   bool operator!=(const InlineBitmap& other) const { return !(*this == other); }
 
@@ -305,16 +304,140 @@ class InlineBitmap {
   // Sets this bitmap to the union (bitwise 'or') of this bitmap and `other`.
   void Union(const InlineBitmap& other) {
     CHECK_EQ(bit_count(), other.bit_count());
-    for (int64_t i = 0; i < data_.size(); ++i) {
-      data_[i] |= other.data_[i];
-    }
+    ApplyWordwise(other, [](uint64_t a, uint64_t b) { return a | b; });
   }
 
   // Sets this bitmap to the bitwise 'and' of this bitmap and `other`.
   void Intersect(const InlineBitmap& other) {
     CHECK_EQ(bit_count(), other.bit_count());
-    for (int64_t i = 0; i < data_.size(); ++i) {
-      data_[i] &= other.data_[i];
+    ApplyWordwise(other, [](uint64_t a, uint64_t b) { return a & b; });
+  }
+
+  // Sets this bitmap to the bitwise 'xor' of this bitmap and `other`.
+  void SymmetricDifference(const InlineBitmap& other) {
+    CHECK_EQ(bit_count(), other.bit_count());
+    ApplyWordwise(other, [](uint64_t a, uint64_t b) { return a ^ b; });
+  }
+
+  // Flips every bit of this bitmap.
+  void Invert() {
+    uint64_t* data = data_.data();
+    const int64_t words = word_count();
+    for (int64_t i = 0; i < words; ++i) {
+      data[i] = ~data[i];
+    }
+    MaskLastWord();
+  }
+
+  // Returns the number of set bits.
+  int64_t PopCount() const {
+    const uint64_t* data = data_.data();
+    const int64_t words = word_count();
+    int64_t count = 0;
+    for (int64_t i = 0; i < words; ++i) {
+      count += absl::popcount(data[i]);
+    }
+    return count;
+  }
+
+  // Returns the index of the lowest set bit at or above `index`, or
+  // bit_count() if there is none.
+  int64_t FindNextSetBit(int64_t index = 0) const {
+    DCHECK_GE(index, 0);
+    if (index >= bit_count_) {
+      return bit_count_;
+    }
+    int64_t wordno = index / kWordBits;
+    uint64_t word = data_[wordno] & (~uint64_t{0} << (index % kWordBits));
+    while (word == 0) {
+      if (++wordno == word_count()) {
+        return bit_count_;
+      }
+      word = data_[wordno];
+    }
+    return wordno * kWordBits + absl::countr_zero(word);
+  }
+
+  // Returns the number of zero bits below the lowest set bit (or above the
+  // highest set bit), i.e. bit_count() if no bit is set.
+  int64_t CountTrailingZeros() const { return FindNextSetBit(0); }
+  int64_t CountLeadingZeros() const {
+    for (int64_t wordno = word_count() - 1; wordno >= 0; --wordno) {
+      if (data_[wordno] != 0) {
+        return bit_count_ - wordno * kWordBits - kWordBits +
+               absl::countl_zero(data_[wordno]);
+      }
+    }
+    return bit_count_;
+  }
+
+  // As above but counting one bits.
+  int64_t CountTrailingOnes() const {
+    for (int64_t wordno = 0; wordno < word_count(); ++wordno) {
+      uint64_t zeros = ~data_[wordno] & MaskForWord(wordno);
+      if (zeros != 0) {
+        return wordno * kWordBits + absl::countr_zero(zeros);
+      }
+    }
+    return bit_count_;
+  }
+  int64_t CountLeadingOnes() const {
+    for (int64_t wordno = word_count() - 1; wordno >= 0; --wordno) {
+      uint64_t zeros = ~data_[wordno] & MaskForWord(wordno);
+      if (zeros != 0) {
+        return bit_count_ - wordno * kWordBits - kWordBits +
+               absl::countl_zero(zeros);
+      }
+    }
+    return bit_count_;
+  }
+
+  // Returns a bitmap of the `width` bits starting at bit `start`, copied a
+  // word at a time.
+  InlineBitmap Slice(int64_t start, int64_t width) const {
+    DCHECK_GE(start, 0);
+    DCHECK_GE(width, 0);
+    DCHECK_LE(start + width, bit_count_);
+    InlineBitmap result(width);
+    const int64_t first_word = start / kWordBits;
+    const int64_t shift = start % kWordBits;
+    const uint64_t* src = data_.data() + first_word;
+    uint64_t* dst = result.data_.data();
+    const int64_t src_words = word_count() - first_word;
+    const int64_t dst_words = result.word_count();
+    if (shift == 0) {
+      for (int64_t i = 0; i < dst_words; ++i) {
+        dst[i] = src[i];
+      }
+    } else {
+      for (int64_t i = 0; i < dst_words; ++i) {
+        uint64_t word = src[i] >> shift;
+        if (i + 1 < src_words) {
+          word |= src[i + 1] << (kWordBits - shift);
+        }
+        dst[i] = word;
+      }
+    }
+    result.MaskLastWord();
+    return result;
+  }
+
+  // Sets the `other.bit_count()` bits starting at bit `start` to the bits of
+  // `other`, a word at a time.
+  void Overwrite(const InlineBitmap& other, int64_t start) {
+    DCHECK_GE(start, 0);
+    DCHECK_LE(start + other.bit_count_, bit_count_);
+    const int64_t shift = start % kWordBits;
+    uint64_t* dst = data_.data() + start / kWordBits;
+    const uint64_t* src = other.data_.data();
+    for (int64_t i = 0; i < other.word_count(); ++i) {
+      const uint64_t mask =
+          Mask(std::min(kWordBits, other.bit_count_ - i * kWordBits));
+      dst[i] = (dst[i] & ~(mask << shift)) | (src[i] << shift);
+      if (shift != 0 && (mask >> (kWordBits - shift)) != 0) {
+        dst[i + 1] = (dst[i + 1] & ~(mask >> (kWordBits - shift))) |
+                     (src[i] >> (kWordBits - shift));
+      }
     }
   }
 
@@ -332,6 +455,19 @@ class InlineBitmap {
   static constexpr int64_t kWordBits = 64;
   static constexpr int64_t kWordBytes = 8;
 
+  // Sets each word of this bitmap to `op(word, other's word)`. Loops over raw
+  // word pointers so the compiler can vectorize them; indexing the inlined
+  // vector instead re-checks its storage mode on every iteration.
+  template <typename Op>
+  void ApplyWordwise(const InlineBitmap& other, Op op) {
+    uint64_t* data = data_.data();
+    const uint64_t* other_data = other.data_.data();
+    const int64_t words = word_count();
+    for (int64_t i = 0; i < words; ++i) {
+      data[i] = op(data[i], other_data[i]);
+    }
+  }
+
   void MaskLastWord() {
     if (word_count() == 0) {
       return;
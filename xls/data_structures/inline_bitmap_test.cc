@@ -14,11 +14,14 @@
 
 #include "xls/data_structures/inline_bitmap.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ios>
 #include <limits>
+#include <random>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/types/span.h"
@@ -502,6 +505,31 @@ TEST(InlineBitmapTest, Intersect) {
   }
 }
 
+TEST(InlineBitmapTest, SymmetricDifferenceAndInvert) {
+  {
+    InlineBitmap b(0);
+    b.SymmetricDifference(InlineBitmap(0));
+    b.Invert();
+    EXPECT_EQ(b, InlineBitmap(0));
+  }
+
+  {
+    InlineBitmap b = InlineBitmap::FromWord(0b0110, 4);
+    b.SymmetricDifference(InlineBitmap::FromWord(0b0011, 4));
+    EXPECT_EQ(b, InlineBitmap::FromWord(0b0101, 4));
+    b.Invert();
+    EXPECT_EQ(b, InlineBitmap::FromWord(0b1010, 4));
+  }
+
+  {
+    InlineBitmap b(100);
+    b.Invert();
+    EXPECT_TRUE(b.IsAllOnes());
+    b.SymmetricDifference(InlineBitmap(100, /*fill=*/true));
+    EXPECT_TRUE(b.IsAllZeroes());
+  }
+}
+
 TEST(InlineBitmapTest, WithSize) {
   {
     InlineBitmap b1(80);
@@ -552,6 +580,166 @@ TEST(InlineBitmapTest, WithSize) {
   }
 }
 
+// Returns a bitmap with bits set at random with probability `density`.
+InlineBitmap RandomBitmap(int64_t bit_count, double density,
+                          std::mt19937_64& rng) {
+  std::bernoulli_distribution bit(density);
+  InlineBitmap result(bit_count);
+  for (int64_t i = 0; i < bit_count; ++i) {
+    result.Set(i, bit(rng));
+  }
+  return result;
+}
+
+TEST(InlineBitmapTest, WordwiseOperationsMatchBitwise) {
+  std::mt19937_64 rng(0);
+  for (int64_t bit_count : {0, 1, 7, 63, 64, 65, 130, 1031}) {
+    for (double density : {0.0, 0.01, 0.5, 0.99, 1.0}) {
+      InlineBitmap b = RandomBitmap(bit_count, density, rng);
+      int64_t pop_count = 0;
+      int64_t trailing_zeros = -1;
+      int64_t trailing_ones = -1;
+      int64_t leading_zeros = -1;
+      int64_t leading_ones = -1;
+      for (int64_t i = 0; i < bit_count; ++i) {
+        pop_count += b.Get(i) ? 1 : 0;
+        if (trailing_zeros < 0 && b.Get(i)) {
+          trailing_zeros = i;
+        }
+        if (trailing_ones < 0 && !b.Get(i)) {
+          trailing_ones = i;
+        }
+        if (leading_zeros < 0 && b.Get(bit_count - 1 - i)) {
+          leading_zeros = i;
+        }
+        if (leading_ones < 0 && !b.Get(bit_count - 1 - i)) {
+          leading_ones = i;
+        }
+      }
+      auto or_bit_count = [&](int64_t v) { return v < 0 ? bit_count : v; };
+      EXPECT_EQ(b.PopCount(), pop_count);
+      EXPECT_EQ(b.CountTrailingZeros(), or_bit_count(trailing_zeros));
+      EXPECT_EQ(b.CountTrailingOnes(), or_bit_count(trailing_ones));
+      EXPECT_EQ(b.CountLeadingZeros(), or_bit_count(leading_zeros));
+      EXPECT_EQ(b.CountLeadingOnes(), or_bit_count(leading_ones));
+
+      for (int64_t start : {int64_t{0}, int64_t{3}, bit_count / 2}) {
+        int64_t expected_next = std::min(start, bit_count);
+        while (expected_next < bit_count && !b.Get(expected_next)) {
+          ++expected_next;
+        }
+        EXPECT_EQ(b.FindNextSetBit(start), expected_next);
+
+        for (int64_t width : {int64_t{0}, int64_t{1}, int64_t{64},
+                              bit_count - start}) {
+          if (width < 0 || start + width > bit_count) {
+            continue;
+          }
+          InlineBitmap slice = b.Slice(start, width);
+          ASSERT_EQ(slice.bit_count(), width);
+          for (int64_t i = 0; i < width; ++i) {
+            EXPECT_EQ(slice.Get(i), b.Get(start + i))
+                << bit_count << " " << start << " " << width << " " << i;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(InlineBitmapTest, OverwriteMatchesBitwise) {
+  std::mt19937_64 rng(0);
+  for (int64_t bit_count : {1, 7, 63, 64, 65, 130, 1031}) {
+    for (int64_t width : {0, 1, 5, 63, 64, 65, 200}) {
+      for (int64_t start : {0, 1, 3, 60, 64, 100}) {
+        if (start + width > bit_count) {
+          continue;
+        }
+        InlineBitmap b = RandomBitmap(bit_count, /*density=*/0.5, rng);
+        InlineBitmap other = RandomBitmap(width, /*density=*/0.5, rng);
+        InlineBitmap expected = b;
+        for (int64_t i = 0; i < width; ++i) {
+          expected.Set(start + i, other.Get(i));
+        }
+        b.Overwrite(other, start);
+        EXPECT_EQ(b, expected) << bit_count << " " << width << " " << start;
+      }
+    }
+  }
+}
+
+InlineBitmap RandomBitmap(int64_t bit_count, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  InlineBitmap bitmap(bit_count);
+  for (int64_t wordno = 0; wordno < bitmap.word_count(); ++wordno) {
+    bitmap.SetWord(wordno, rng());
+  }
+  return bitmap;
+}
+
+void BM_Union(benchmark::State& state) {
+  InlineBitmap lhs = RandomBitmap(state.range(0), /*seed=*/0);
+  InlineBitmap rhs = RandomBitmap(state.range(0), /*seed=*/1);
+  for (auto _ : state) {
+    lhs.Union(rhs);
+    benchmark::DoNotOptimize(lhs);
+  }
+}
+BENCHMARK(BM_Union)->Range(1, 1 << 16);
+
+void BM_Intersect(benchmark::State& state) {
+  InlineBitmap lhs = RandomBitmap(state.range(0), /*seed=*/0);
+  InlineBitmap rhs = RandomBitmap(state.range(0), /*seed=*/1);
+  for (auto _ : state) {
+    lhs.Intersect(rhs);
+    benchmark::DoNotOptimize(lhs);
+  }
+}
+BENCHMARK(BM_Intersect)->Range(1, 1 << 16);
+
+// Compares two distinct but equal bitmaps, the worst case for equality.
+void BM_Equality(benchmark::State& state) {
+  InlineBitmap lhs = RandomBitmap(state.range(0), /*seed=*/0);
+  InlineBitmap rhs = RandomBitmap(state.range(0), /*seed=*/0);
+  for (auto _ : state) {
+    bool eq = lhs == rhs;
+    benchmark::DoNotOptimize(eq);
+  }
+}
+BENCHMARK(BM_Equality)->Range(1, 1 << 16);
+
+void BM_PopCount(benchmark::State& state) {
+  InlineBitmap bitmap = RandomBitmap(state.range(0), /*seed=*/0);
+  for (auto _ : state) {
+    int64_t count = bitmap.PopCount();
+    benchmark::DoNotOptimize(count);
+  }
+}
+BENCHMARK(BM_PopCount)->Range(1, 1 << 16);
+
+// Visits every set bit of a random bitmap.
+void BM_FindNextSetBit(benchmark::State& state) {
+  InlineBitmap bitmap = RandomBitmap(state.range(0), /*seed=*/0);
+  for (auto _ : state) {
+    for (int64_t i = bitmap.FindNextSetBit(0); i < bitmap.bit_count();
+         i = bitmap.FindNextSetBit(i + 1)) {
+      benchmark::DoNotOptimize(i);
+    }
+  }
+}
+BENCHMARK(BM_FindNextSetBit)->Range(1, 1 << 16);
+
+void BM_Slice(benchmark::State& state) {
+  InlineBitmap bitmap = RandomBitmap(state.range(0), /*seed=*/0);
+  int64_t start = state.range(0) / 3;
+  int64_t width = state.range(0) / 2;
+  for (auto _ : state) {
+    InlineBitmap slice = bitmap.Slice(start, width);
+    benchmark::DoNotOptimize(slice);
+  }
+}
+BENCHMARK(BM_Slice)->Range(1, 1 << 16);
+
 }  // namespace
 
 // Note: tests below this point are friended, so cannot live in the anonymous
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -46,6 +47,8 @@ inline bool IsLeafType(Type* t) { return t->IsBits() || t->IsToken(); }
 // forward decl
 template <typename T>
 class SharedLeafTypeTree;
+template <typename T>
+class CopyOnWriteLeafTypeTree;
 
 namespace leaf_type_tree_internal {
 
@@ -584,12 +587,124 @@ absl::Status ForEachSubArrayHelper(
 
 }  // namespace leaf_type_tree_internal
 
+// A LeafTypeTree with reference-counted storage. Copies of a tree, and subtrees
+// taken with Subtree, share their elements with the original; the elements are
+// only copied when a tree whose storage is shared is modified. This makes deriving one tree from (part of) another
+// cheap, for example when a query engine computes the value of an identity,
+// tuple_index or array_index node from its operand.
+template <typename T>
+class CopyOnWriteLeafTypeTree {
+ public:
+  using DataT = const T;
+  using DataContainerT = absl::Span<const T>;
+  using TypeContainerT = absl::Span<Type* const>;
+
+  CopyOnWriteLeafTypeTree() : view_(nullptr, {}, {}) {}
+  explicit CopyOnWriteLeafTypeTree(LeafTypeTree<T> tree)
+      : storage_(std::make_shared<LeafTypeTree<T>>(std::move(tree))),
+        view_(storage_->AsView()) {}
+
+  CopyOnWriteLeafTypeTree(const CopyOnWriteLeafTypeTree<T>& other) = default;
+  CopyOnWriteLeafTypeTree& operator=(const CopyOnWriteLeafTypeTree<T>& other) =
+      default;
+  CopyOnWriteLeafTypeTree(CopyOnWriteLeafTypeTree<T>&& other) = default;
+  CopyOnWriteLeafTypeTree& operator=(CopyOnWriteLeafTypeTree<T>&& other) =
+      default;
+
+  friend bool operator==(const CopyOnWriteLeafTypeTree<T>& lhs,
+                         const CopyOnWriteLeafTypeTree<T>& rhs) {
+    return lhs.AsView() == rhs.AsView();
+  }
+
+  // Returns a tree holding the subtree at `index` which shares storage with
+  // this one.
+  CopyOnWriteLeafTypeTree<T> Subtree(absl::Span<const int64_t> index) const {
+    CopyOnWriteLeafTypeTree<T> result = *this;
+    result.view_ = view_.AsView(index);
+    return result;
+  }
+
+  // Returns whether the elements of this tree are shared with another tree.
+  bool IsShared() const { return storage_.use_count() > 1 || !IsWholeTree(); }
+
+  // These methods are mirrors of those on LeafTypeTree. See LeafTypeTree for
+  // descriptions. The mutating methods first copy the elements if they are
+  // shared, which invalidates any views of this tree.
+  Type* type() const { return view_.type(); }
+  int64_t size() const { return view_.size(); }
+  const T& Get(absl::Span<int64_t const> index) const {
+    return view_.Get(index);
+  }
+  void Set(absl::Span<int64_t const> index, const T& value) {
+    MakeUnique();
+    storage_->Set(index, value);
+  }
+  absl::Span<T const> elements() const { return view_.elements(); }
+  absl::Span<Type* const> leaf_types() const { return view_.leaf_types(); }
+  LeafTypeTreeView<T> AsView(absl::Span<const int64_t> index = {}) const {
+    return view_.AsView(index);
+  }
+  MutableLeafTypeTreeView<T> AsMutableView(
+      absl::Span<const int64_t> index = {}) {
+    MakeUnique();
+    return storage_->AsMutableView(index);
+  }
+  SharedLeafTypeTree<T> AsShared() const;
+
+  // Make an owned LTT out of this tree. This copies the elements unless they
+  // are not shared.
+  LeafTypeTree<T> ToOwned() && {
+    if (!IsShared()) {
+      return std::move(*storage_);
+    }
+    return LeafTypeTree<T>(type(), elements());
+  }
+  LeafTypeTree<T> ToOwned() const& {
+    return LeafTypeTree<T>(type(), elements());
+  }
+
+  std::string ToString(const std::function<std::string(const T&)>& f) const {
+    return view_.ToString(f);
+  }
+  std::string ToString() const { return view_.ToString(); }
+  std::string ToMultilineString(
+      const std::function<std::string(const T&)>& f) const {
+    return view_.ToMultilineString(f);
+  }
+  std::string ToMultilineString() const { return view_.ToMultilineString(); }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const CopyOnWriteLeafTypeTree<T>& ltt) {
+    return AbslHashValue(std::move(h), ltt.AsView());
+  }
+
+ private:
+  bool IsWholeTree() const {
+    return storage_ != nullptr && view_.type() == storage_->type() &&
+           view_.elements().data() == storage_->elements().data();
+  }
+
+  // Gives this tree its own copy of its elements if they are shared.
+  void MakeUnique() {
+    if (!IsShared()) {
+      return;
+    }
+    storage_ = std::make_shared<LeafTypeTree<T>>(type(), elements());
+    view_ = storage_->AsView();
+  }
+
+  std::shared_ptr<LeafTypeTree<T>> storage_;
+  // View of the part of `storage_` which makes up this tree.
+  LeafTypeTreeView<T> view_;
+};
+
 // An immutable shared view of a LeafTypeTree. This might or might not own the
 // underlying data. This can be used for (eg) the QueryEngine functions which
 // might either return a pre-calculated LTT or generate one on the fly depending
 // on what sort of query-engine/node is being used. Using this a copy of
 // pre-existing ones is not needed and no significant work by the users is
-// needed to check for this situation.
+// needed to check for this situation. A SharedLeafTypeTree made from a
+// CopyOnWriteLeafTypeTree shares (and keeps alive) its elements.
 template <typename T>
 class SharedLeafTypeTree {
  public:
@@ -617,6 +732,9 @@ class SharedLeafTypeTree {
     if (std::holds_alternative<LeafTypeTree<T>>(inner_)) {
       return std::get<LeafTypeTree<T>>(std::move(inner_));
     }
+    if (std::holds_alternative<CopyOnWriteLeafTypeTree<T>>(inner_)) {
+      return std::get<CopyOnWriteLeafTypeTree<T>>(std::move(inner_)).ToOwned();
+    }
     return LeafTypeTree<T>(type(), elements());
   }
 
@@ -626,6 +744,9 @@ class SharedLeafTypeTree {
         Visitor{[](const LeafTypeTree<T>& t) -> LeafTypeTree<T> { return t; },
                 [](const LeafTypeTreeView<T>& t) -> LeafTypeTree<T> {
                   return LeafTypeTree<T>(t.type(), t.elements());
+                },
+                [](const CopyOnWriteLeafTypeTree<T>& t) -> LeafTypeTree<T> {
+                  return t.ToOwned();
                 }},
         inner_);
   }
@@ -646,7 +767,9 @@ class SharedLeafTypeTree {
                        },
                        [](const LeafTypeTree<T>& t) -> LeafTypeTreeView<T> {
                          return t.AsView();
-                       }},
+                       },
+                       [](const CopyOnWriteLeafTypeTree<T>& t)
+                           -> LeafTypeTreeView<T> { return t.AsView(); }},
                inner_)
         .AsView(index);
   }
@@ -675,13 +798,15 @@ class SharedLeafTypeTree {
   }
 
  private:
-  std::variant<LeafTypeTreeView<T>, LeafTypeTree<T>> inner_;
+  using Inner = std::variant<LeafTypeTreeView<T>, LeafTypeTree<T>,
+                             CopyOnWriteLeafTypeTree<T>>;
+  Inner inner_;
 
-  SharedLeafTypeTree(std::variant<LeafTypeTreeView<T>, LeafTypeTree<T>>&& inner)
-      : inner_(std::move(inner)) {}
+  SharedLeafTypeTree(Inner&& inner) : inner_(std::move(inner)) {}
 
   friend class LeafTypeTree<T>;
   friend class LeafTypeTreeView<T>;
+  friend class CopyOnWriteLeafTypeTree<T>;
 };
 
 namespace leaf_type_tree {
@@ -1066,6 +1191,10 @@ template <typename T>
 SharedLeafTypeTree<T> LeafTypeTreeView<T>::AsShared() const {
   return SharedLeafTypeTree<T>(*this);
 }
+template <typename T>
+SharedLeafTypeTree<T> CopyOnWriteLeafTypeTree<T>::AsShared() const {
+  return SharedLeafTypeTree<T>(*this);
+}
 }  // namespace xls
 
 #endif  // XLS_DATA_STRUCTURES_LEAF_TYPE_TREE_H_
@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -938,5 +939,56 @@ TEST_F(LeafTypeTreeTest, CreateFromFunctionSimple) {
   EXPECT_EQ(result.ToString(), "([bits[32], bits[32]], bits[2])");
 }
 
+TEST_F(LeafTypeTreeTest, CopyOnWriteSharesUntilModified) {
+  Type* type = AsType("(bits[32][2], bits[2])");
+  CopyOnWriteLeafTypeTree<int64_t> tree(
+      LeafTypeTree<int64_t>(type, absl::Span<const int64_t>({1, 2, 3})));
+  EXPECT_FALSE(tree.IsShared());
+
+  CopyOnWriteLeafTypeTree<int64_t> copy = tree;
+  CopyOnWriteLeafTypeTree<int64_t> subtree = tree.Subtree({0});
+  EXPECT_TRUE(tree.IsShared());
+  EXPECT_EQ(copy.elements().data(), tree.elements().data());
+  EXPECT_EQ(subtree.elements().data(), tree.elements().data());
+  EXPECT_EQ(subtree.type()->ToString(), "bits[32][2]");
+  EXPECT_EQ(subtree.ToString(), "[1, 2]");
+  EXPECT_EQ(subtree.Get({1}), 2);
+
+  // Modifying a tree copies its elements and leaves the others alone.
+  subtree.Set({0}, 10);
+  EXPECT_EQ(subtree.ToString(), "[10, 2]");
+  EXPECT_EQ(tree.ToString(), "([1, 2], 3)");
+  EXPECT_NE(subtree.elements().data(), tree.elements().data());
+  EXPECT_FALSE(subtree.IsShared());
+
+  copy.AsMutableView().Set({1}, 30);
+  EXPECT_EQ(copy.ToString(), "([1, 2], 30)");
+  EXPECT_EQ(tree.ToString(), "([1, 2], 3)");
+  EXPECT_FALSE(tree.IsShared());
+  EXPECT_NE(copy, tree);
+
+  // An unshared tree is modified in place.
+  const int64_t* data = tree.elements().data();
+  tree.Set({1}, 30);
+  EXPECT_EQ(tree.elements().data(), data);
+  EXPECT_EQ(copy, tree);
+}
+
+TEST_F(LeafTypeTreeTest, CopyOnWriteAsShared) {
+  Type* type = AsType("(bits[32], bits[2])");
+  std::optional<SharedLeafTypeTree<int64_t>> shared;
+  {
+    CopyOnWriteLeafTypeTree<int64_t> tree(
+        LeafTypeTree<int64_t>(type, absl::Span<const int64_t>({1, 2})));
+    shared = tree.Subtree({1}).AsShared();
+    EXPECT_EQ(shared->elements().data(), tree.elements().data() + 1);
+  }
+  // The shared tree keeps the elements alive.
+  EXPECT_EQ(shared->ToString(), "2");
+  LeafTypeTree<int64_t> owned = std::move(shared).value().ToOwned();
+  EXPECT_EQ(owned.type()->ToString(), "bits[2]");
+  EXPECT_THAT(owned.elements(), ElementsAre(2));
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,56 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/object_arena.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace xls {
+
+ObjectArena::~ObjectArena() {
+  for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+    it->destroy(it->object);
+  }
+}
+
+void* ObjectArena::Allocate(size_t size, size_t alignment) {
+  uintptr_t cursor = reinterpret_cast<uintptr_t>(cursor_);
+  uintptr_t aligned = (cursor + alignment - 1) & ~(alignment - 1);
+  if (cursor_ != nullptr &&
+      aligned + size <= reinterpret_cast<uintptr_t>(limit_)) {
+    cursor_ = reinterpret_cast<std::byte*>(aligned + size);
+    return reinterpret_cast<void*>(aligned);
+  }
+  // Objects too big to share a block get a block of their own, which leaves
+  // the current block available for subsequent small objects.
+  int64_t padded_size = size + alignment - 1;
+  if (padded_size > next_block_size_ / 4) {
+    blocks_.push_back(std::unique_ptr<std::byte[]>(new std::byte[padded_size]));
+    bytes_reserved_ += padded_size;
+    uintptr_t start = reinterpret_cast<uintptr_t>(blocks_.back().get());
+    return reinterpret_cast<void*>((start + alignment - 1) & ~(alignment - 1));
+  }
+  blocks_.push_back(
+      std::unique_ptr<std::byte[]>(new std::byte[next_block_size_]));
+  bytes_reserved_ += next_block_size_;
+  cursor_ = blocks_.back().get();
+  limit_ = cursor_ + next_block_size_;
+  next_block_size_ = std::min(next_block_size_ * 2, kMaxBlockSize);
+  return Allocate(size, alignment);
+}
+
+}  // namespace xls
@@ -0,0 +1,87 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_OBJECT_ARENA_H_
+#define XLS_DATA_STRUCTURES_OBJECT_ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xls {
+
+// A bump allocator for objects which all live until the arena is destroyed.
+// Objects are carved out of large blocks, so allocating many small objects
+// costs one heap allocation per block rather than one per object. On
+// destruction the arena runs the destructors of the objects it holds in
+// reverse order of construction and then frees its blocks; trivially
+// destructible objects are never visited at all.
+//
+// Not thread-safe.
+class ObjectArena {
+ public:
+  ObjectArena() = default;
+  ~ObjectArena();
+
+  ObjectArena(const ObjectArena&) = delete;
+  ObjectArena& operator=(const ObjectArena&) = delete;
+
+  // Constructs a T in the arena. The returned object is owned by the arena.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    void* storage = Allocate(sizeof(T), alignof(T));
+    T* object = new (storage) T(std::forward<Args>(args)...);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      destructors_.push_back(
+          Destructor{.object = object, .destroy = [](void* object) {
+                       static_cast<T*>(object)->~T();
+                     }});
+    }
+    return object;
+  }
+
+  // Returns the number of objects which need their destructor run.
+  int64_t destructor_count() const { return destructors_.size(); }
+
+  // Returns the total number of bytes reserved from the heap for blocks.
+  int64_t bytes_reserved() const { return bytes_reserved_; }
+
+ private:
+  static constexpr int64_t kMinBlockSize = 4 * 1024;
+  static constexpr int64_t kMaxBlockSize = 1024 * 1024;
+
+  struct Destructor {
+    void* object;
+    void (*destroy)(void*);
+  };
+
+  // Returns `size` bytes of storage aligned to `alignment`.
+  void* Allocate(size_t size, size_t alignment);
+
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  std::vector<Destructor> destructors_;
+  // Free space of the current block.
+  std::byte* cursor_ = nullptr;
+  std::byte* limit_ = nullptr;
+  int64_t next_block_size_ = kMinBlockSize;
+  int64_t bytes_reserved_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_OBJECT_ARENA_H_
@@ -0,0 +1,94 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/object_arena.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+// Appends its id to a log when destroyed.
+class Tracked {
+ public:
+  Tracked(int64_t id, std::vector<int64_t>* log) : id_(id), log_(log) {}
+  ~Tracked() { log_->push_back(id_); }
+
+ private:
+  int64_t id_;
+  std::vector<int64_t>* log_;
+};
+
+TEST(ObjectArenaTest, DestroysObjectsInReverseOrder) {
+  std::vector<int64_t> log;
+  {
+    ObjectArena arena;
+    for (int64_t i = 0; i < 3; ++i) {
+      arena.New<Tracked>(i, &log);
+    }
+    EXPECT_EQ(arena.destructor_count(), 3);
+    EXPECT_TRUE(log.empty());
+  }
+  EXPECT_THAT(log, ElementsAre(2, 1, 0));
+}
+
+TEST(ObjectArenaTest, TriviallyDestructibleObjectsNeedNoDestructor) {
+  ObjectArena arena;
+  int64_t* x = arena.New<int64_t>(42);
+  std::string* s = arena.New<std::string>("a string too long for SSO buffers");
+  EXPECT_EQ(*x, 42);
+  EXPECT_EQ(*s, "a string too long for SSO buffers");
+  EXPECT_EQ(arena.destructor_count(), 1);
+}
+
+TEST(ObjectArenaTest, ManyObjectsShareBlocks) {
+  ObjectArena arena;
+  std::vector<int64_t*> values;
+  for (int64_t i = 0; i < 10000; ++i) {
+    values.push_back(arena.New<int64_t>(i));
+  }
+  for (int64_t i = 0; i < 10000; ++i) {
+    EXPECT_EQ(*values[i], i);
+  }
+  // Far fewer bytes than one block per object, but at least enough storage.
+  EXPECT_GE(arena.bytes_reserved(), 10000 * sizeof(int64_t));
+  EXPECT_LT(arena.bytes_reserved(), 4 * 10000 * sizeof(int64_t));
+}
+
+TEST(ObjectArenaTest, RespectsAlignment) {
+  struct alignas(64) Aligned {
+    char c;
+  };
+  ObjectArena arena;
+  arena.New<char>('x');
+  for (int64_t i = 0; i < 100; ++i) {
+    Aligned* aligned = arena.New<Aligned>();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0);
+  }
+  // Objects too large to share a block are still usable.
+  auto* big = arena.New<std::array<int64_t, 100000>>();
+  (*big)[99999] = 1;
+  EXPECT_EQ(*arena.New<char>('y'), 'y');
+}
+
+}  // namespace
+}  // namespace xls
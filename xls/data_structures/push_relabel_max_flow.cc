@@ -0,0 +1,214 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/data_structures/push_relabel_max_flow.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/log/check.h"
+
+namespace xls {
+
+void PushRelabelMaxFlow::Reset(int64_t vertex_count) {
+  CHECK_GE(vertex_count, 0);
+  vertex_count_ = vertex_count;
+  arcs_.clear();
+}
+
+void PushRelabelMaxFlow::AddArc(int64_t tail, int64_t head, int64_t capacity) {
+  CHECK(tail >= 0 && tail < vertex_count_) << tail;
+  CHECK(head >= 0 && head < vertex_count_) << head;
+  CHECK_GE(capacity, 0);
+  arcs_.push_back(InputArc{.tail = tail, .head = head, .capacity = capacity});
+}
+
+void PushRelabelMaxFlow::BuildResidualNetwork(int64_t source, int64_t supply) {
+  const int64_t supply_vertex = vertex_count_;
+  const int64_t total_vertices = vertex_count_ + 1;
+  offsets_.assign(total_vertices + 1, 0);
+  for (const InputArc& arc : arcs_) {
+    ++offsets_[arc.tail + 1];
+    ++offsets_[arc.head + 1];
+  }
+  ++offsets_[supply_vertex + 1];
+  ++offsets_[source + 1];
+  for (int64_t v = 0; v < total_vertices; ++v) {
+    offsets_[v + 1] += offsets_[v];
+  }
+
+  // Each arc is stored along with its (initially saturated) reverse arc.
+  const int64_t residual_arc_count = offsets_.back();
+  heads_.resize(residual_arc_count);
+  residual_.resize(residual_arc_count);
+  paired_.resize(residual_arc_count);
+  current_arc_.assign(offsets_.begin(), offsets_.end() - 1);
+  auto add_arc = [&](int64_t tail, int64_t head, int64_t capacity) {
+    int64_t forward = current_arc_[tail]++;
+    int64_t reverse = current_arc_[head]++;
+    heads_[forward] = head;
+    residual_[forward] = capacity;
+    paired_[forward] = reverse;
+    heads_[reverse] = tail;
+    residual_[reverse] = 0;
+    paired_[reverse] = forward;
+  };
+  for (const InputArc& arc : arcs_) {
+    add_arc(arc.tail, arc.head, arc.capacity);
+  }
+  add_arc(supply_vertex, source, supply);
+  current_arc_.assign(offsets_.begin(), offsets_.end() - 1);
+}
+
+void PushRelabelMaxFlow::ComputeExactLabels(int64_t sink) {
+  const int64_t total_vertices = vertex_count_ + 1;
+  label_.assign(total_vertices, total_vertices);
+  label_[sink] = 0;
+  active_.clear();
+  active_.push_back(sink);
+  while (!active_.empty()) {
+    int64_t w = active_.front();
+    active_.pop_front();
+    for (int64_t a = offsets_[w]; a < offsets_[w + 1]; ++a) {
+      int64_t v = heads_[a];
+      if (v != vertex_count_ && label_[v] == total_vertices &&
+          residual_[paired_[a]] > 0) {
+        label_[v] = label_[w] + 1;
+        active_.push_back(v);
+      }
+    }
+  }
+  label_[sink] = 0;
+}
+
+void PushRelabelMaxFlow::Relabel(int64_t vertex) {
+  const int64_t total_vertices = vertex_count_ + 1;
+  const int64_t old_label = label_[vertex];
+  int64_t new_label = 2 * total_vertices;
+  for (int64_t a = offsets_[vertex]; a < offsets_[vertex + 1]; ++a) {
+    if (residual_[a] > 0) {
+      new_label = std::min(new_label, label_[heads_[a]] + 1);
+    }
+  }
+  label_[vertex] = new_label;
+  current_arc_[vertex] = offsets_[vertex];
+  if (new_label < total_vertices) {
+    ++label_count_[new_label];
+  }
+  if (old_label >= total_vertices || --label_count_[old_label] > 0) {
+    return;
+  }
+
+  // Gap heuristic: no vertex has `old_label`, so the vertices with higher
+  // labels can no longer reach the sink and may as well go straight to
+  // returning their excess to the source.
+  for (int64_t v = 0; v < vertex_count_; ++v) {
+    if (label_[v] > old_label && label_[v] < total_vertices) {
+      --label_count_[label_[v]];
+      label_[v] = total_vertices + 1;
+      current_arc_[v] = offsets_[v];
+    }
+  }
+}
+
+void PushRelabelMaxFlow::Discharge(int64_t vertex, int64_t sink) {
+  while (excess_[vertex] > 0) {
+    if (current_arc_[vertex] == offsets_[vertex + 1]) {
+      Relabel(vertex);
+      continue;
+    }
+    int64_t a = current_arc_[vertex];
+    int64_t head = heads_[a];
+    if (residual_[a] == 0 || label_[vertex] != label_[head] + 1) {
+      ++current_arc_[vertex];
+      continue;
+    }
+    int64_t amount = std::min(excess_[vertex], residual_[a]);
+    residual_[a] -= amount;
+    residual_[paired_[a]] += amount;
+    excess_[vertex] -= amount;
+    if (excess_[head] == 0 && head != sink && head != vertex_count_) {
+      active_.push_back(head);
+    }
+    excess_[head] += amount;
+  }
+}
+
+int64_t PushRelabelMaxFlow::Solve(int64_t source, int64_t sink) {
+  CHECK(source >= 0 && source < vertex_count_) << source;
+  CHECK(sink >= 0 && sink < vertex_count_) << sink;
+  CHECK_NE(source, sink);
+
+  // Flow enters the network through an extra supply vertex with a single arc
+  // to the source. Its capacity exceeds every cut of finite arcs, so it does
+  // not limit the flow, but it bounds every excess and so rules out overflow
+  // even with infinite capacities.
+  int64_t finite_capacity = 0;
+  for (const InputArc& arc : arcs_) {
+    if (arc.capacity != kInfiniteCapacity) {
+      finite_capacity = arc.capacity > kInfiniteCapacity - finite_capacity
+                            ? kInfiniteCapacity
+                            : finite_capacity + arc.capacity;
+    }
+  }
+  const int64_t supply = finite_capacity == kInfiniteCapacity
+                             ? kInfiniteCapacity
+                             : finite_capacity + 1;
+  BuildResidualNetwork(source, supply);
+
+  const int64_t total_vertices = vertex_count_ + 1;
+  const int64_t supply_vertex = vertex_count_;
+  excess_.assign(total_vertices, 0);
+  int64_t supply_arc = offsets_[supply_vertex];
+  residual_[supply_arc] = 0;
+  residual_[paired_[supply_arc]] = supply;
+  excess_[source] = supply;
+
+  ComputeExactLabels(sink);
+  label_count_.assign(total_vertices, 0);
+  for (int64_t v = 0; v < vertex_count_; ++v) {
+    if (label_[v] < total_vertices) {
+      ++label_count_[label_[v]];
+    }
+  }
+
+  active_.clear();
+  active_.push_back(source);
+  while (!active_.empty()) {
+    int64_t vertex = active_.front();
+    active_.pop_front();
+    Discharge(vertex, sink);
+  }
+
+  // The minimum cut is given by the vertices reachable from the source over
+  // arcs with residual capacity.
+  source_side_.assign(total_vertices, 0);
+  source_side_[source] = 1;
+  active_.push_back(source);
+  while (!active_.empty()) {
+    int64_t vertex = active_.front();
+    active_.pop_front();
+    for (int64_t a = offsets_[vertex]; a < offsets_[vertex + 1]; ++a) {
+      if (residual_[a] > 0 && source_side_[heads_[a]] == 0) {
+        source_side_[heads_[a]] = 1;
+        active_.push_back(heads_[a]);
+      }
+    }
+  }
+  return excess_[sink];
+}
+
+}  // namespace xls
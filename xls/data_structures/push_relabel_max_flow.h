@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_DATA_STRUCTURES_PUSH_RELABEL_MAX_FLOW_H_
+#define XLS_DATA_STRUCTURES_PUSH_RELABEL_MAX_FLOW_H_
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace xls {
+
+// Computes maximum flows and minimum cuts over a directed network with integer
+// arc capacities using the FIFO push-relabel algorithm with the gap heuristic.
+//
+// The residual network is stored in compressed sparse row form, with every arc
+// next to the other arcs of its tail, which keeps the inner loops of the
+// algorithm on contiguous memory. A network may be Reset() and rebuilt any
+// number of times; the storage of the previous network is reused, so computing
+// a sequence of flows over similarly sized networks does not allocate.
+//
+// Arcs may have kInfiniteCapacity, e.g., to forbid cutting them. The value of
+// the returned flow is saturated at one more than the sum of the finite arc
+// capacities, which is exact whenever some cut consists of finite arcs only.
+class PushRelabelMaxFlow {
+ public:
+  static constexpr int64_t kInfiniteCapacity =
+      std::numeric_limits<int64_t>::max();
+
+  // Discards the network and starts a new one with `vertex_count` vertices and
+  // no arcs.
+  void Reset(int64_t vertex_count);
+
+  // Adds a vertex and returns its index.
+  int64_t AddVertex() { return vertex_count_++; }
+
+  // Adds an arc with the given nonnegative capacity. Parallel and antiparallel
+  // arcs are allowed.
+  void AddArc(int64_t tail, int64_t head, int64_t capacity);
+
+  int64_t vertex_count() const { return vertex_count_; }
+  int64_t arc_count() const { return static_cast<int64_t>(arcs_.size()); }
+
+  // Computes a maximum flow from `source` to `sink`, which must be distinct,
+  // and returns its value.
+  int64_t Solve(int64_t source, int64_t sink);
+
+  // Returns whether `vertex` is on the source side of the minimum cut found by
+  // the last Solve(). This is the minimum cut with the fewest vertices on the
+  // source side: the vertices reachable from the source in the residual
+  // network of the maximum flow.
+  bool IsOnSourceSide(int64_t vertex) const {
+    return source_side_[vertex] != 0;
+  }
+
+ private:
+  struct InputArc {
+    int64_t tail;
+    int64_t head;
+    int64_t capacity;
+  };
+
+  // Builds the residual network of `arcs_` plus an arc of capacity `supply`
+  // from an extra vertex (the last one) to `source`.
+  void BuildResidualNetwork(int64_t source, int64_t supply);
+
+  // Sets `label_` to the distance of each vertex to `sink` in the residual
+  // network, or to the vertex count if the sink is unreachable.
+  void ComputeExactLabels(int64_t sink);
+
+  // Pushes the excess of `vertex` to its neighbors, relabeling it as needed,
+  // and queues the neighbors which become active.
+  void Discharge(int64_t vertex, int64_t sink);
+
+  // Sets `label_` of `vertex` to one more than the lowest label of a neighbor
+  // over a residual arc, then applies the gap heuristic if `vertex` was the
+  // last one with its old label.
+  void Relabel(int64_t vertex);
+
+  int64_t vertex_count_ = 0;
+  std::vector<InputArc> arcs_;
+
+  // The residual network over vertex_count_ + 1 vertices. Residual arc `a`
+  // leaves the vertex `v` with `offsets_[v] <= a < offsets_[v + 1]` and enters
+  // `heads_[a]`; `paired_[a]` is the arc in the opposite direction.
+  std::vector<int64_t> offsets_;
+  std::vector<int64_t> heads_;
+  std::vector<int64_t> residual_;
+  std::vector<int64_t> paired_;
+
+  std::vector<int64_t> excess_;
+  std::vector<int64_t> label_;
+  // The next arc of each vertex to try pushing along.
+  std::vector<int64_t> current_arc_;
+  // The number of vertices with each label below the vertex count, used for
+  // the gap heuristic.
+  std::vector<int64_t> label_count_;
+  std::deque<int64_t> active_;
+
+  std::vector<char> source_side_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_PUSH_RELABEL_MAX_FLOW_H_
@@ -0,0 +1,174 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/data_structures/push_relabel_max_flow.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace xls {
+namespace {
+
+constexpr int64_t kInf = PushRelabelMaxFlow::kInfiniteCapacity;
+
+struct Arc {
+  int64_t tail;
+  int64_t head;
+  int64_t capacity;
+};
+
+void Build(PushRelabelMaxFlow& max_flow, int64_t vertex_count,
+           const std::vector<Arc>& arcs) {
+  max_flow.Reset(vertex_count);
+  for (const Arc& arc : arcs) {
+    max_flow.AddArc(arc.tail, arc.head, arc.capacity);
+  }
+}
+
+std::vector<int64_t> SourceSide(const PushRelabelMaxFlow& max_flow) {
+  std::vector<int64_t> vertices;
+  for (int64_t v = 0; v < max_flow.vertex_count(); ++v) {
+    if (max_flow.IsOnSourceSide(v)) {
+      vertices.push_back(v);
+    }
+  }
+  return vertices;
+}
+
+// Edmonds-Karp over a capacity matrix. Returns the flow value and the vertices
+// reachable from the source in the final residual network.
+std::pair<int64_t, std::vector<int64_t>> ReferenceMaxFlow(
+    int64_t vertex_count, const std::vector<Arc>& arcs, int64_t source,
+    int64_t sink) {
+  std::vector<std::vector<int64_t>> residual(
+      vertex_count, std::vector<int64_t>(vertex_count, 0));
+  for (const Arc& arc : arcs) {
+    residual[arc.tail][arc.head] += arc.capacity;
+  }
+  int64_t flow = 0;
+  while (true) {
+    std::vector<int64_t> parent(vertex_count, -1);
+    parent[source] = source;
+    std::deque<int64_t> queue = {source};
+    while (!queue.empty()) {
+      int64_t v = queue.front();
+      queue.pop_front();
+      for (int64_t w = 0; w < vertex_count; ++w) {
+        if (parent[w] == -1 && residual[v][w] > 0) {
+          parent[w] = v;
+          queue.push_back(w);
+        }
+      }
+    }
+    if (parent[sink] == -1) {
+      std::vector<int64_t> source_side;
+      for (int64_t v = 0; v < vertex_count; ++v) {
+        if (parent[v] != -1) {
+          source_side.push_back(v);
+        }
+      }
+      return {flow, source_side};
+    }
+    int64_t amount = kInf;
+    for (int64_t v = sink; v != source; v = parent[v]) {
+      amount = std::min(amount, residual[parent[v]][v]);
+    }
+    for (int64_t v = sink; v != source; v = parent[v]) {
+      residual[parent[v]][v] -= amount;
+      residual[v][parent[v]] += amount;
+    }
+    flow += amount;
+  }
+}
+
+TEST(PushRelabelMaxFlowTest, TextbookNetwork) {
+  PushRelabelMaxFlow max_flow;
+  Build(max_flow, 6,
+        {{0, 1, 16},
+         {0, 2, 13},
+         {2, 1, 4},
+         {1, 3, 12},
+         {3, 2, 9},
+         {2, 4, 14},
+         {4, 3, 7},
+         {3, 5, 20},
+         {4, 5, 4}});
+  EXPECT_EQ(max_flow.Solve(0, 5), 23);
+  EXPECT_EQ(SourceSide(max_flow), std::vector<int64_t>({0, 1, 2, 4}));
+}
+
+TEST(PushRelabelMaxFlowTest, InfiniteCapacities) {
+  PushRelabelMaxFlow max_flow;
+  Build(max_flow, 4,
+        {{0, 1, kInf},
+         {1, 0, kInf},
+         {1, 2, kInf},
+         {2, 1, kInf},
+         {1, 3, 5},
+         {2, 3, 3},
+         {0, 3, kInf},
+         {3, 0, 7}});
+  // Every cut crosses the infinite arc from 0 to 3.
+  EXPECT_EQ(max_flow.Solve(0, 3), 5 + 3 + 7 + 1);
+
+  Build(max_flow, 4,
+        {{0, 1, kInf}, {0, 2, kInf}, {1, 3, 5}, {2, 3, 3}, {3, 0, kInf}});
+  EXPECT_EQ(max_flow.Solve(0, 3), 8);
+  EXPECT_EQ(SourceSide(max_flow), std::vector<int64_t>({0, 1, 2}));
+}
+
+TEST(PushRelabelMaxFlowTest, DisconnectedSink) {
+  PushRelabelMaxFlow max_flow;
+  Build(max_flow, 3, {{0, 1, 4}, {2, 1, 4}});
+  EXPECT_EQ(max_flow.Solve(0, 2), 0);
+  EXPECT_EQ(SourceSide(max_flow), std::vector<int64_t>({0, 1}));
+}
+
+TEST(PushRelabelMaxFlowTest, MatchesReferenceOnRandomNetworks) {
+  std::mt19937_64 rng(0);
+  PushRelabelMaxFlow max_flow;
+  for (int64_t trial = 0; trial < 200; ++trial) {
+    int64_t vertex_count = std::uniform_int_distribution<int64_t>(2, 12)(rng);
+    int64_t arc_count =
+        std::uniform_int_distribution<int64_t>(0, 4 * vertex_count)(rng);
+    std::uniform_int_distribution<int64_t> vertex(0, vertex_count - 1);
+    std::uniform_int_distribution<int64_t> capacity(0, 20);
+    std::vector<Arc> arcs;
+    for (int64_t i = 0; i < arc_count; ++i) {
+      arcs.push_back(Arc{.tail = vertex(rng),
+                         .head = vertex(rng),
+                         .capacity = capacity(rng)});
+    }
+    int64_t source = vertex(rng);
+    int64_t sink = (source + 1 + std::uniform_int_distribution<int64_t>(
+                                     0, vertex_count - 2)(rng)) %
+                   vertex_count;
+
+    // The network is rebuilt in the same object for every trial.
+    Build(max_flow, vertex_count, arcs);
+    auto [expected_flow, expected_source_side] =
+        ReferenceMaxFlow(vertex_count, arcs, source, sink);
+    EXPECT_EQ(max_flow.Solve(source, sink), expected_flow) << "trial " << trial;
+    EXPECT_EQ(SourceSide(max_flow), expected_source_side) << "trial " << trial;
+  }
+}
+
+}  // namespace
+}  // namespace xls
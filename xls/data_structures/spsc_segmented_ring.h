@@ -0,0 +1,214 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DATA_STRUCTURES_SPSC_SEGMENTED_RING_H_
+#define XLS_DATA_STRUCTURES_SPSC_SEGMENTED_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "absl/log/check.h"
+#include "xls/common/math_util.h"
+
+namespace xls {
+
+// A FIFO of fixed-size slots which is safe for one producer thread and one
+// consumer thread to access concurrently without locking. Storage is a linked
+// list of ring-buffer segments: the producer fills the current segment and,
+// only when it is full, links in a new segment of twice the capacity. The
+// consumer drains segments in order and frees each one once the producer has
+// moved past it. In steady state (when the ring does not outgrow its current
+// segment) no allocation is performed.
+//
+// Each slot is `slot_stride` consecutive objects of type `T`, e.g. one Value,
+// or an aligned run of bytes. The ring does not interpret slot contents:
+// writers fill a slot in place through a callback and readers consume it the
+// same way, which lets callers copy or move values without an intermediate
+// buffer.
+template <typename T>
+class SpscSegmentedRing {
+ public:
+  static constexpr int64_t kMinSegmentCapacity = 16;
+
+  // `min_capacity` is a lower bound on the number of slots the ring can hold
+  // before allocating an additional segment.
+  explicit SpscSegmentedRing(int64_t min_capacity, int64_t slot_stride = 1)
+      : slot_stride_(slot_stride) {
+    CHECK_GT(slot_stride, 0);
+    producer_segment_ = new Segment(
+        int64_t{1} << CeilOfLog2(std::max(min_capacity, kMinSegmentCapacity)),
+        slot_stride_);
+    consumer_segment_ = producer_segment_;
+  }
+  ~SpscSegmentedRing() {
+    Segment* segment = consumer_segment_;
+    while (segment != nullptr) {
+      Segment* next = segment->next.load(std::memory_order_relaxed);
+      delete segment;
+      segment = next;
+    }
+  }
+
+  SpscSegmentedRing(const SpscSegmentedRing&) = delete;
+  SpscSegmentedRing& operator=(const SpscSegmentedRing&) = delete;
+
+  // Appends a slot, calling `fill(T*)` to initialize it. Must only be called
+  // by the producer.
+  template <typename FillFn>
+  void Write(FillFn fill) {
+    if (TryWriteFast(fill)) {
+      return;
+    }
+    Segment* segment = producer_segment_;
+    int64_t write_index = segment->write_index.load(std::memory_order_relaxed);
+    producer_cached_read_index_ =
+        segment->read_index.load(std::memory_order_acquire);
+    if (write_index - producer_cached_read_index_ == segment->capacity) {
+      // The segment is full. Move on to a new, larger segment. The consumer
+      // frees the old segment once it has drained it.
+      Segment* next = new Segment(segment->capacity * 2, slot_stride_);
+      segment->next.store(next, std::memory_order_release);
+      producer_segment_ = next;
+      producer_cached_read_index_ = 0;
+      segment = next;
+      write_index = 0;
+    }
+    Publish(segment, write_index, fill);
+  }
+
+  // Removes the oldest slot, calling `drain(T*)` on it first. Returns false if
+  // the ring is empty. Must only be called by the consumer.
+  template <typename DrainFn>
+  bool Read(DrainFn drain) {
+    if (TryReadFast(drain)) {
+      return true;
+    }
+    Segment* segment = consumer_segment_;
+    int64_t read_index = segment->read_index.load(std::memory_order_relaxed);
+    Segment* next = segment->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+      return false;
+    }
+    // The producer links in the next segment only after its last write to
+    // this one, so reload the write index before abandoning the segment.
+    if (read_index == segment->write_index.load(std::memory_order_acquire)) {
+      consumer_segment_ = next;
+      delete segment;
+      segment = next;
+      read_index = 0;
+      if (segment->write_index.load(std::memory_order_acquire) == 0) {
+        return false;
+      }
+    }
+    Consume(segment, read_index, drain);
+    return true;
+  }
+
+  // Inline fast paths of `Write` and `Read` which only handle the common case
+  // of the slot fitting in (or being available in) the current segment.
+  // Return false without touching the ring otherwise.
+  template <typename FillFn>
+  bool TryWriteFast(FillFn&& fill) {
+    Segment* segment = producer_segment_;
+    int64_t write_index = segment->write_index.load(std::memory_order_relaxed);
+    if (write_index - producer_cached_read_index_ == segment->capacity) {
+      return false;
+    }
+    Publish(segment, write_index, fill);
+    return true;
+  }
+  template <typename DrainFn>
+  bool TryReadFast(DrainFn&& drain) {
+    Segment* segment = consumer_segment_;
+    int64_t read_index = segment->read_index.load(std::memory_order_relaxed);
+    if (read_index == segment->write_index.load(std::memory_order_acquire)) {
+      return false;
+    }
+    Consume(segment, read_index, drain);
+    return true;
+  }
+
+  // Returns the number of slots in the ring. The value is exact when called
+  // from either the producer or the consumer while the other side is
+  // quiescent, and otherwise a snapshot.
+  int64_t size() const {
+    return write_count_.load(std::memory_order_acquire) -
+           read_count_.load(std::memory_order_acquire);
+  }
+
+  // Returns the total number of slots written to and read from the ring.
+  int64_t write_count() const {
+    return write_count_.load(std::memory_order_relaxed);
+  }
+  int64_t read_count() const {
+    return read_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static constexpr int64_t kCacheLineSize = 64;
+
+  struct Segment {
+    Segment(int64_t capacity, int64_t slot_stride)
+        : capacity(capacity), slots(new T[capacity * slot_stride]) {}
+
+    // Number of slots; always a power of two.
+    const int64_t capacity;
+    const std::unique_ptr<T[]> slots;
+    // Set by the producer once it has stopped writing to this segment.
+    std::atomic<Segment*> next = nullptr;
+    // Monotonic indices of the next slot to write/read. Kept on separate cache
+    // lines so the producer and consumer do not contend.
+    alignas(kCacheLineSize) std::atomic<int64_t> write_index = 0;
+    alignas(kCacheLineSize) std::atomic<int64_t> read_index = 0;
+  };
+
+  T* Slot(Segment* segment, int64_t index) const {
+    return segment->slots.get() +
+           (index & (segment->capacity - 1)) * slot_stride_;
+  }
+
+  template <typename FillFn>
+  void Publish(Segment* segment, int64_t write_index, FillFn& fill) {
+    fill(Slot(segment, write_index));
+    segment->write_index.store(write_index + 1, std::memory_order_release);
+    write_count_.fetch_add(1, std::memory_order_release);
+  }
+  template <typename DrainFn>
+  void Consume(Segment* segment, int64_t read_index, DrainFn& drain) {
+    drain(Slot(segment, read_index));
+    segment->read_index.store(read_index + 1, std::memory_order_release);
+    read_count_.fetch_add(1, std::memory_order_release);
+  }
+
+  // Number of `T`s in each slot.
+  const int64_t slot_stride_;
+
+  // Producer-owned state.
+  alignas(kCacheLineSize) Segment* producer_segment_;
+  // Producer's cached copy of the consumer's read index in
+  // `producer_segment_`. Avoids touching the consumer's cache line on every
+  // write.
+  int64_t producer_cached_read_index_ = 0;
+  std::atomic<int64_t> write_count_ = 0;
+
+  // Consumer-owned state.
+  alignas(kCacheLineSize) Segment* consumer_segment_;
+  std::atomic<int64_t> read_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DATA_STRUCTURES_SPSC_SEGMENTED_RING_H_
@@ -0,0 +1,87 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/spsc_segmented_ring.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "xls/common/thread.h"
+
+namespace xls {
+namespace {
+
+TEST(SpscSegmentedRingTest, EmptyRingHasNothingToRead) {
+  SpscSegmentedRing<int64_t> ring(/*min_capacity=*/0);
+  EXPECT_FALSE(ring.Read([](int64_t*) { FAIL() << "Nothing to drain"; }));
+  EXPECT_EQ(ring.size(), 0);
+}
+
+TEST(SpscSegmentedRingTest, GrowsAcrossSegmentsInFifoOrder) {
+  constexpr int64_t kCount =
+      5 * SpscSegmentedRing<std::string>::kMinSegmentCapacity + 3;
+  SpscSegmentedRing<std::string> ring(/*min_capacity=*/0);
+  for (int64_t i = 0; i < kCount; ++i) {
+    ring.Write([&](std::string* slot) { *slot = std::to_string(i); });
+  }
+  EXPECT_EQ(ring.size(), kCount);
+  for (int64_t i = 0; i < kCount; ++i) {
+    std::string value;
+    ASSERT_TRUE(ring.Read([&](std::string* slot) { value = *slot; }));
+    EXPECT_EQ(value, std::to_string(i));
+  }
+  EXPECT_EQ(ring.size(), 0);
+  EXPECT_EQ(ring.write_count(), kCount);
+  EXPECT_EQ(ring.read_count(), kCount);
+}
+
+TEST(SpscSegmentedRingTest, MultiObjectSlots) {
+  constexpr int64_t kStride = 3;
+  SpscSegmentedRing<uint8_t> ring(/*min_capacity=*/0, kStride);
+  ring.Write([](uint8_t* slot) { std::memcpy(slot, "abc", kStride); });
+  ring.Write([](uint8_t* slot) { std::memcpy(slot, "def", kStride); });
+  char buffer[kStride];
+  ASSERT_TRUE(ring.Read(
+      [&](uint8_t* slot) { std::memcpy(buffer, slot, kStride); }));
+  EXPECT_EQ(std::string(buffer, kStride), "abc");
+  ASSERT_TRUE(ring.Read(
+      [&](uint8_t* slot) { std::memcpy(buffer, slot, kStride); }));
+  EXPECT_EQ(std::string(buffer, kStride), "def");
+}
+
+TEST(SpscSegmentedRingTest, ConcurrentProducerAndConsumer) {
+  constexpr int64_t kCount = 100000;
+  SpscSegmentedRing<int64_t> ring(/*min_capacity=*/0);
+  auto producer = std::make_unique<Thread>([&]() {
+    for (int64_t i = 0; i < kCount; ++i) {
+      ring.Write([&](int64_t* slot) { *slot = i; });
+    }
+  });
+  int64_t expected = 0;
+  while (expected < kCount) {
+    int64_t value;
+    if (ring.Read([&](int64_t* slot) { value = *slot; })) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer->Join();
+  EXPECT_EQ(ring.size(), 0);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,93 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/strongly_connected_components.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/data_structures/csr_graph.h"
+
+namespace xls {
+
+StronglyConnectedComponentMap ComputeStronglyConnectedComponents(
+    const DirectedCsrGraph& graph) {
+  const int64_t n = graph.vertex_count();
+  absl::Span<const int64_t> offsets = graph.offsets();
+  absl::Span<const int64_t> targets = graph.targets();
+
+  StronglyConnectedComponentMap result;
+  result.component_of.assign(n, -1);
+  // `component_of` doubles as the "on stack" marker: a vertex with an index is
+  // on the stack until its component is assigned.
+  std::vector<int64_t> indexes(n, -1);
+  std::vector<int64_t> low_links(n);
+  std::vector<int64_t> stack;
+
+  // The frames of the depth-first search: a vertex and the offset of its next
+  // successor to visit.
+  struct Frame {
+    int64_t vertex;
+    int64_t next_edge;
+  };
+  std::vector<Frame> frames;
+  int64_t index = 0;
+  auto visit = [&](int64_t v) {
+    indexes[v] = index;
+    low_links[v] = index;
+    ++index;
+    stack.push_back(v);
+    frames.push_back(Frame{.vertex = v, .next_edge = offsets[v]});
+  };
+
+  for (int64_t root = 0; root < n; ++root) {
+    if (indexes[root] >= 0) {
+      continue;
+    }
+    visit(root);
+    while (!frames.empty()) {
+      const int64_t v = frames.back().vertex;
+      if (frames.back().next_edge < offsets[v + 1]) {
+        const int64_t w = targets[frames.back().next_edge++];
+        if (indexes[w] < 0) {
+          visit(w);
+        } else if (result.component_of[w] < 0) {
+          low_links[v] = std::min(low_links[v], indexes[w]);
+        }
+        continue;
+      }
+
+      // All successors of `v` are done.
+      frames.pop_back();
+      if (low_links[v] == indexes[v]) {
+        int64_t w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          result.component_of[w] = result.component_count;
+        } while (w != v);
+        ++result.component_count;
+      }
+      if (!frames.empty()) {
+        const int64_t parent = frames.back().vertex;
+        low_links[parent] = std::min(low_links[parent], low_links[v]);
+      }
+    }
+  }
+  return result;
+}
+
+}  // namespace xls
@@ -16,83 +16,76 @@
 #define XLS_DATA_STRUCTURES_STRONGLY_CONNECTED_COMPONENTS_H_
 
 #include <cstdint>
-#include <functional>
-#include <stack>
+#include <utility>
 #include <vector>
 
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "xls/data_structures/csr_graph.h"
 
 namespace xls {
 
+// The strongly connected components of a DirectedCsrGraph.
+struct StronglyConnectedComponentMap {
+  // The component of each vertex. Components are numbered in the order in
+  // which Tarjan's algorithm completes them, which is a reverse topological
+  // order of the condensation: every edge between two different components
+  // goes from the higher-numbered one to the lower-numbered one.
+  std::vector<int64_t> component_of;
+  int64_t component_count = 0;
+};
+
+// Computes the strongly connected components of `graph` using Tarjan's
+// strongly connected components algorithm, with an explicit stack instead of
+// recursion so that arbitrarily long paths are fine. Roots are taken in
+// increasing order of vertex and successors in their stored order. Self-edges
+// are permitted.
+//
+// A description of the Tarjan SCC algorithm exists on Wikipedia:
+// https://w.wiki/5h9U
+StronglyConnectedComponentMap ComputeStronglyConnectedComponents(
+    const DirectedCsrGraph& graph);
+
 // Computes the strongly connected components of a graph using Tarjan's strongly
 // connected components algorithm.
 //
 // The parameter `graph` is an arbitrary adjacency matrix represented as a
 // map from nodes to the set of out-neighbors of that node. Self-edges are
-// permitted.
+// permitted. Only vertices with at least one edge are part of the graph.
 //
-// A description of the Tarjan SCC algorithm exists on Wikipedia:
-// https://w.wiki/5h9U
-// This implementation is directly based off of that pseudocode, so please read
-// that to make sense of this code.
+// The components are returned in the order they are completed, as for
+// ComputeStronglyConnectedComponents.
 template <typename V>
 std::vector<absl::btree_set<V>> StronglyConnectedComponents(
     const absl::btree_map<V, absl::btree_set<V>>& graph) {
-  absl::btree_set<V> vertices;
+  absl::btree_map<V, int64_t> ids;
   for (const auto& [source, targets] : graph) {
     for (const V& target : targets) {
-      vertices.insert(source);
-      vertices.insert(target);
+      ids.insert({source, 0});
+      ids.insert({target, 0});
     }
   }
+  std::vector<const V*> vertices;
+  vertices.reserve(ids.size());
+  for (auto& [vertex, id] : ids) {
+    id = vertices.size();
+    vertices.push_back(&vertex);
+  }
 
-  int64_t index = 0;
-  std::stack<V, std::vector<V>> stack;
-  std::vector<absl::btree_set<V>> result;
-  absl::btree_map<V, int64_t> indexes;
-  absl::btree_map<V, int64_t> low_links;
-  absl::btree_set<V> on_stack;
-
-  std::function<void(const V&)> strong_connect = [&](const V& vertex) {
-    indexes[vertex] = index;
-    low_links[vertex] = index;
-    ++index;
-    stack.push(vertex);
-    on_stack.insert(vertex);
-
-    if (graph.contains(vertex)) {
-      for (const V& neighbor : graph.at(vertex)) {
-        if (!indexes.contains(neighbor)) {
-          strong_connect(neighbor);
-          low_links.at(vertex) =
-              std::min(low_links.at(vertex), low_links.at(neighbor));
-        } else if (on_stack.contains(neighbor)) {
-          low_links.at(vertex) =
-              std::min(low_links.at(vertex), indexes.at(neighbor));
-        }
-      }
-    }
-
-    if (low_links.at(vertex) == indexes.at(vertex)) {
-      absl::btree_set<V> scc;
-      V v;
-      do {
-        v = stack.top();
-        stack.pop();
-        on_stack.erase(v);
-        scc.insert(v);
-      } while (v != vertex);
-      result.push_back(scc);
-    }
-  };
-
-  for (const V& vertex : vertices) {
-    if (!indexes.contains(vertex)) {
-      strong_connect(vertex);
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  for (const auto& [source, targets] : graph) {
+    for (const V& target : targets) {
+      edges.push_back({ids.at(source), ids.at(target)});
     }
   }
+  StronglyConnectedComponentMap components =
+      ComputeStronglyConnectedComponents(
+          DirectedCsrGraph::FromEdges(vertices.size(), edges));
 
+  std::vector<absl::btree_set<V>> result(components.component_count);
+  for (int64_t i = 0; i < vertices.size(); ++i) {
+    result[components.component_of[i]].insert(*vertices[i]);
+  }
   return result;
 }
 
@@ -16,11 +16,14 @@
 
 #include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
+#include "xls/data_structures/csr_graph.h"
 
 namespace xls {
 namespace {
@@ -145,5 +148,39 @@ TEST(StronglyConnectedComponentsTest, Tree) {
   EXPECT_EQ(FlattenSCCs(sccs).size(), GraphSize(graph));
 }
 
+TEST(ComputeStronglyConnectedComponentsTest, ComponentsAreReverseTopological) {
+  // Two cycles {0, 1, 2} and {3, 4} joined by the edge 2 -> 3, a self-loop on 5
+  // which is reached from 4, and the isolated vertex 6.
+  DirectedCsrGraph graph = DirectedCsrGraph::FromEdges(
+      7, {{0, 1}, {1, 2}, {2, 0}, {2, 3}, {3, 4}, {4, 3}, {4, 5}, {5, 5}});
+  StronglyConnectedComponentMap components =
+      ComputeStronglyConnectedComponents(graph);
+  EXPECT_EQ(components.component_count, 4);
+  EXPECT_THAT(components.component_of,
+              ::testing::ElementsAre(2, 2, 2, 1, 1, 0, 3));
+  for (int64_t v = 0; v < graph.vertex_count(); ++v) {
+    for (int64_t w : graph.successors(v)) {
+      EXPECT_GE(components.component_of[v], components.component_of[w]);
+    }
+  }
+}
+
+TEST(ComputeStronglyConnectedComponentsTest, LongCycleDoesNotRecurse) {
+  constexpr int64_t kVertexCount = 1'000'000;
+  std::vector<std::pair<int64_t, int64_t>> edges;
+  edges.reserve(kVertexCount + 1);
+  for (int64_t v = 0; v < kVertexCount; ++v) {
+    edges.push_back({v, (v + 1) % kVertexCount});
+  }
+  // A spike off the end of the path which is its own component.
+  edges.push_back({kVertexCount - 1, kVertexCount});
+  StronglyConnectedComponentMap components = ComputeStronglyConnectedComponents(
+      DirectedCsrGraph::FromEdges(kVertexCount + 1, edges));
+  EXPECT_EQ(components.component_count, 2);
+  EXPECT_EQ(components.component_of[kVertexCount], 0);
+  EXPECT_EQ(components.component_of[0], 1);
+  EXPECT_EQ(components.component_of[kVertexCount / 2], 1);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,156 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/data_structures/transitive_closure.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/numeric/bits.h"
+#include "absl/types/span.h"
+#include "xls/common/thread_pool.h"
+#include "xls/data_structures/inline_bitmap.h"
+
+namespace xls {
+namespace internal {
+namespace {
+
+constexpr int64_t kWordBits = 64;
+
+// Relations with fewer rows than this are always closed serially, since the
+// work per block is too small to be worth handing out.
+constexpr int64_t kMinParallelRows = 2048;
+
+}  // namespace
+
+bool TryTopologicalTransitiveClosure(absl::Span<InlineBitmap> relation) {
+  const int64_t n = relation.size();
+  // Depth-first search, recording nodes in post-order so that every node comes
+  // after all of its successors.
+  enum class Mark : uint8_t { kUnvisited, kOnStack, kDone };
+  std::vector<Mark> marks(n, Mark::kUnvisited);
+  std::vector<int64_t> post_order;
+  post_order.reserve(n);
+  struct Frame {
+    int64_t node;
+    int64_t next_successor;
+  };
+  std::vector<Frame> stack;
+  for (int64_t root = 0; root < n; ++root) {
+    if (marks[root] != Mark::kUnvisited) {
+      continue;
+    }
+    marks[root] = Mark::kOnStack;
+    stack.push_back(Frame{.node = root, .next_successor = 0});
+    while (!stack.empty()) {
+      Frame& frame = stack.back();
+      int64_t successor =
+          relation[frame.node].FindNextSetBit(frame.next_successor);
+      if (successor == n) {
+        marks[frame.node] = Mark::kDone;
+        post_order.push_back(frame.node);
+        stack.pop_back();
+        continue;
+      }
+      frame.next_successor = successor + 1;
+      if (successor == frame.node || marks[successor] == Mark::kDone) {
+        continue;
+      }
+      if (marks[successor] == Mark::kOnStack) {
+        return false;
+      }
+      marks[successor] = Mark::kOnStack;
+      stack.push_back(Frame{.node = successor, .next_successor = 0});
+    }
+  }
+
+  // Every successor of a node is closed before the node itself, so a node's
+  // closure is its own row merged with the closed rows of its direct
+  // successors. The direct successors are read from a copy of the row since
+  // the row grows as it is merged.
+  InlineBitmap successors(n);
+  for (int64_t node : post_order) {
+    InlineBitmap& row = relation[node];
+    successors = row;
+    for (int64_t successor = successors.FindNextSetBit(); successor < n;
+         successor = successors.FindNextSetBit(successor + 1)) {
+      if (successor != node) {
+        row.Union(relation[successor]);
+      }
+    }
+  }
+  return true;
+}
+
+void BlockedWarshallTransitiveClosure(absl::Span<InlineBitmap> relation,
+                                      ThreadPool* thread_pool) {
+  const int64_t n = relation.size();
+  for (int64_t block_start = 0; block_start < n; block_start += kWordBits) {
+    const int64_t block_end = std::min(n, block_start + kWordBits);
+    const int64_t wordno = block_start / kWordBits;
+
+    // Close the rows of the block over the block's pivots. Together with the
+    // earlier blocks, each row k of the block then holds everything k reaches
+    // via pivots < block_end.
+    for (int64_t k = block_start; k < block_end; ++k) {
+      for (int64_t i = block_start; i < block_end; ++i) {
+        if (i != k && relation[i].Get(k)) {
+          relation[i].Union(relation[k]);
+        }
+      }
+    }
+
+    // Any other row only needs merging with the block rows it relates to
+    // directly: a block row reached via another block pivot is already
+    // contained in that pivot's row.
+    auto update_row = [&](int64_t i) {
+      if (i >= block_start && i < block_end) {
+        return;
+      }
+      uint64_t pivots = relation[i].GetWord(wordno);
+      while (pivots != 0) {
+        relation[i].Union(relation[block_start + absl::countr_zero(pivots)]);
+        pivots &= pivots - 1;
+      }
+    };
+    if (thread_pool == nullptr || n < kMinParallelRows) {
+      for (int64_t i = 0; i < n; ++i) {
+        update_row(i);
+      }
+      continue;
+    }
+    const int64_t threads = thread_pool->num_threads();
+    thread_pool->ParallelFor(n, /*grain=*/(n + threads - 1) / threads,
+                             update_row);
+  }
+}
+
+}  // namespace internal
+
+DenseIdRelation TransitiveClosure(
+    DenseIdRelation v, const DenseTransitiveClosureOptions& options) {
+  for (const InlineBitmap& row : v) {
+    CHECK_EQ(row.bit_count(), v.size());
+  }
+  if (!internal::TryTopologicalTransitiveClosure(v)) {
+    // The relation may have been partially closed, which doesn't change its
+    // closure.
+    internal::BlockedWarshallTransitiveClosure(v, options.thread_pool);
+  }
+  return v;
+}
+
+}  // namespace xls
@@ -21,6 +21,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/types/span.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
@@ -78,24 +79,21 @@ class HashRelation {
   absl::flat_hash_map<V, absl::flat_hash_set<V>>& relation_;
 };
 
-class DenseIdRelation {
- public:
-  explicit DenseIdRelation(absl::Span<InlineBitmap> relation)
-      : relation_(relation) {}
-  template <typename F>
-  void ForEachKeyValue(F f) const {
-    for (int64_t i = 0; i < relation_.size(); ++i) {
-      f(i, relation_[i]);
-    }
-  }
-  bool Contains(const InlineBitmap& vs, int64_t v) const { return vs.Get(v); }
-  void UnionInPlace(InlineBitmap& i, const InlineBitmap& k) const {
-    i.Union(k);
-  }
-
- private:
-  absl::Span<InlineBitmap> relation_;
-};
+// Computes the transitive closure of an acyclic boolean adjacency matrix
+// (ignoring self-edges) by merging the rows in reverse topological order,
+// which takes time proportional to the number of edges rather than the
+// number of related pairs. Returns false, leaving the relation partially
+// closed, if the relation has a cycle.
+bool TryTopologicalTransitiveClosure(absl::Span<InlineBitmap> relation);
+
+// Computes the transitive closure of a boolean adjacency matrix with
+// Warshall's algorithm. Pivots are processed in blocks of 64 (one bitmap
+// word): the block's own rows are closed first, after which every other row
+// only needs to be merged with the block rows named by one word of its bitmap.
+// Those rows are independent so they're updated in parallel on `thread_pool`
+// if it is non-null.
+void BlockedWarshallTransitiveClosure(absl::Span<InlineBitmap> relation,
+                                      ThreadPool* thread_pool);
 
 }  // namespace internal
 
@@ -113,18 +111,26 @@ HashRelation<V> TransitiveClosure(HashRelation<V> v) {
 // TODO(allight): Using a more efficient bitmap format like croaring might give
 // a speedup here.
 using DenseIdRelation = absl::Span<InlineBitmap>;
+
+struct DenseTransitiveClosureOptions {
+  // If non-null, rows of relations with cycles are updated in parallel on this
+  // pool. Acyclic relations are always closed on the calling thread.
+  ThreadPool* thread_pool = nullptr;
+};
+
 // Compute the transitive closure of a relation represented as a boolean
-// adjacency matrix.
-inline DenseIdRelation TransitiveClosure(DenseIdRelation v) {
-  internal::TransitiveClosure(internal::DenseIdRelation(v));
-  return v;
-}
+// adjacency matrix, in place. Acyclic relations (the common case for
+// dependency graphs) are closed in topological order; otherwise a blocked
+// Warshall's algorithm is used.
+DenseIdRelation TransitiveClosure(
+    DenseIdRelation v, const DenseTransitiveClosureOptions& options = {});
 
 // Compute the transitive closure of a relation represented as a boolean
 // adjacency matrix.
 inline std::vector<InlineBitmap> TransitiveClosure(
-    std::vector<InlineBitmap> v) {
-  TransitiveClosure(absl::MakeSpan(v));
+    std::vector<InlineBitmap> v,
+    const DenseTransitiveClosureOptions& options = {}) {
+  TransitiveClosure(absl::MakeSpan(v), options);
   return v;
 }
 
@@ -30,6 +30,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
 #include "xls/common/math_util.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/inline_bitmap.h"
 
 namespace xls {
@@ -73,6 +74,68 @@ TEST(TransitiveClosureTest, SimpleDense) {
               InlineBitmap::FromBitsLsbIs0({false, true, false, false, true})));
 }
 
+TEST(TransitiveClosureTest, DenseCycle) {
+  std::vector<InlineBitmap> rel{
+      InlineBitmap::FromBitsLsbIs0({false, true, false, false}),
+      InlineBitmap::FromBitsLsbIs0({false, false, true, false}),
+      InlineBitmap::FromBitsLsbIs0({true, false, false, true}),
+      InlineBitmap::FromBitsLsbIs0({false, false, false, false}),
+  };
+  std::vector<InlineBitmap> tc = TransitiveClosure(rel);
+  EXPECT_THAT(
+      tc,
+      ElementsAre(InlineBitmap::FromBitsLsbIs0({true, true, true, true}),
+                  InlineBitmap::FromBitsLsbIs0({true, true, true, true}),
+                  InlineBitmap::FromBitsLsbIs0({true, true, true, true}),
+                  InlineBitmap::FromBitsLsbIs0({false, false, false, false})));
+}
+
+// Unblocked, serial Warshall's algorithm.
+std::vector<InlineBitmap> ReferenceClosure(std::vector<InlineBitmap> rel) {
+  for (int64_t k = 0; k < rel.size(); ++k) {
+    for (int64_t i = 0; i < rel.size(); ++i) {
+      if (rel[i].Get(k)) {
+        rel[i].Union(rel[k]);
+      }
+    }
+  }
+  return rel;
+}
+
+// A random relation with about `edges_per_node` edges from each node; if
+// `acyclic`, edges only go from lower to higher numbered nodes.
+std::vector<InlineBitmap> RandomSparseRelation(int64_t node_cnt,
+                                               double edges_per_node,
+                                               bool acyclic,
+                                               absl::BitGenRef rng) {
+  std::vector<InlineBitmap> res(node_cnt, InlineBitmap(node_cnt));
+  for (int64_t i = 0; i < node_cnt; ++i) {
+    for (int64_t e = 0; e < edges_per_node; ++e) {
+      int64_t lo = acyclic ? i : 0;
+      if (lo + 1 < node_cnt) {
+        res[i].Set(absl::Uniform<int64_t>(rng, lo + 1, node_cnt));
+      }
+    }
+  }
+  return res;
+}
+
+TEST(TransitiveClosureTest, DenseMatchesReference) {
+  std::mt19937_64 rng(42);
+  ThreadPool pool(4);
+  for (int64_t node_cnt : {1, 63, 64, 65, 200, 2500}) {
+    for (bool acyclic : {false, true}) {
+      std::vector<InlineBitmap> rel =
+          RandomSparseRelation(node_cnt, 2, acyclic, rng);
+      std::vector<InlineBitmap> expected = ReferenceClosure(rel);
+      EXPECT_EQ(TransitiveClosure(rel), expected)
+          << node_cnt << " nodes, acyclic: " << acyclic;
+      EXPECT_EQ(TransitiveClosure(rel, {.thread_pool = &pool}), expected)
+          << node_cnt << " nodes, acyclic: " << acyclic;
+    }
+  }
+}
+
 HashRelation<V> RandomRelation(std::vector<V> nodes, double p,
                                absl::BitGenRef rng) {
   HashRelation<V> rel;
@@ -134,5 +197,20 @@ void BM_RandomDenseRelation(benchmark::State& state) {
   }
 }
 BENCHMARK(BM_RandomDenseRelation)->Range(500, 10000);
+
+void BM_SparseDag(benchmark::State& state) {
+  std::mt19937_64 rng(1);
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<InlineBitmap> rel = RandomSparseRelation(
+        state.range(0), /*edges_per_node=*/2, /*acyclic=*/true, rng);
+    absl::Span<InlineBitmap> span = absl::MakeSpan(rel);
+    state.ResumeTiming();
+    span = TransitiveClosure(span);
+    benchmark::DoNotOptimize(span);
+    benchmark::DoNotOptimize(rel);
+  }
+}
+BENCHMARK(BM_SparseDag)->Range(500, 50000);
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,191 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/and_inverter_graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/varint.h"
+
+namespace xls {
+namespace {
+
+AigLiteral VariableOf(AigLiteral literal) { return literal >> 1; }
+
+}  // namespace
+
+AigLiteral AndInverterGraph::AddInput(std::string_view name) {
+  AigLiteral literal = 2 * variables_.size();
+  variables_.push_back(Variable{.input_number = input_count()});
+  inputs_.push_back({literal, std::string(name)});
+  return literal;
+}
+
+AigLiteral AndInverterGraph::And(AigLiteral a, AigLiteral b) {
+  if (a > b) {
+    std::swap(a, b);
+  }
+  if (a == kFalse || a == Not(b)) {
+    return kFalse;
+  }
+  if (a == kTrue || a == b) {
+    return b;
+  }
+  auto [it, inserted] = gates_.try_emplace({a, b}, 2 * variables_.size());
+  if (inserted) {
+    variables_.push_back(Variable{.fanin0 = a, .fanin1 = b});
+    ++and_count_;
+  }
+  return it->second;
+}
+
+void AndInverterGraph::AddOutput(AigLiteral literal, std::string_view name) {
+  outputs_.push_back({literal, std::string(name)});
+}
+
+int64_t AndInverterGraph::Depth() const {
+  // Variables are created after their fanins, so one pass in order suffices.
+  std::vector<int64_t> depth(variables_.size(), 0);
+  for (int64_t v = 1; v < variables_.size(); ++v) {
+    const Variable& variable = variables_[v];
+    if (variable.input_number < 0) {
+      depth[v] = 1 + std::max(depth[VariableOf(variable.fanin0)],
+                              depth[VariableOf(variable.fanin1)]);
+    }
+  }
+  int64_t result = 0;
+  for (const auto& [literal, name] : outputs_) {
+    result = std::max(result, depth[VariableOf(literal)]);
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<bool>> AndInverterGraph::Evaluate(
+    absl::Span<const bool> inputs) const {
+  if (inputs.size() != inputs_.size()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d input values, got %d", inputs_.size(),
+                        inputs.size()));
+  }
+  std::vector<bool> values(variables_.size(), false);
+  auto value_of = [&](AigLiteral literal) -> bool {
+    return values[VariableOf(literal)] != static_cast<bool>(literal & 1);
+  };
+  for (int64_t v = 1; v < variables_.size(); ++v) {
+    const Variable& variable = variables_[v];
+    values[v] = variable.input_number >= 0
+                    ? inputs[variable.input_number]
+                    : value_of(variable.fanin0) && value_of(variable.fanin1);
+  }
+  std::vector<bool> result;
+  result.reserve(outputs_.size());
+  for (const auto& [literal, name] : outputs_) {
+    result.push_back(value_of(literal));
+  }
+  return result;
+}
+
+std::vector<AigLiteral> AndInverterGraph::GetAigerVariableNumbers() const {
+  std::vector<AigLiteral> numbers(variables_.size(), 0);
+  AigLiteral next_gate = inputs_.size() + 1;
+  for (int64_t v = 1; v < variables_.size(); ++v) {
+    const Variable& variable = variables_[v];
+    numbers[v] =
+        variable.input_number >= 0 ? variable.input_number + 1 : next_gate++;
+  }
+  return numbers;
+}
+
+std::string AndInverterGraph::AigerHeader(std::string_view format) const {
+  return absl::StrFormat("%s %d %d 0 %d %d\n", format, variables_.size() - 1,
+                         inputs_.size(), outputs_.size(), and_count_);
+}
+
+std::string AndInverterGraph::AigerSymbolTable() const {
+  std::string result;
+  for (int64_t i = 0; i < inputs_.size(); ++i) {
+    absl::StrAppend(&result, "i", i, " ", inputs_[i].second, "\n");
+  }
+  for (int64_t i = 0; i < outputs_.size(); ++i) {
+    absl::StrAppend(&result, "o", i, " ", outputs_[i].second, "\n");
+  }
+  return result;
+}
+
+std::string AndInverterGraph::ToAigerAscii() const {
+  std::vector<AigLiteral> numbers = GetAigerVariableNumbers();
+  auto renumber = [&](AigLiteral literal) {
+    return 2 * numbers[VariableOf(literal)] + (literal & 1);
+  };
+  std::string result = AigerHeader("aag");
+  for (const auto& [literal, name] : inputs_) {
+    absl::StrAppend(&result, renumber(literal), "\n");
+  }
+  for (const auto& [literal, name] : outputs_) {
+    absl::StrAppend(&result, renumber(literal), "\n");
+  }
+  for (int64_t v = 1; v < variables_.size(); ++v) {
+    const Variable& variable = variables_[v];
+    if (variable.input_number >= 0) {
+      continue;
+    }
+    AigLiteral rhs0 = renumber(variable.fanin0);
+    AigLiteral rhs1 = renumber(variable.fanin1);
+    absl::StrAppend(&result, 2 * numbers[v], " ", std::max(rhs0, rhs1), " ",
+                    std::min(rhs0, rhs1), "\n");
+  }
+  absl::StrAppend(&result, AigerSymbolTable());
+  return result;
+}
+
+std::string AndInverterGraph::ToAigerBinary() const {
+  std::vector<AigLiteral> numbers = GetAigerVariableNumbers();
+  auto renumber = [&](AigLiteral literal) {
+    return 2 * numbers[VariableOf(literal)] + (literal & 1);
+  };
+  // Inputs are implicit in the binary format, and gates must appear in
+  // increasing order of their (renumbered) variables, which is creation order.
+  std::string result = AigerHeader("aig");
+  for (const auto& [literal, name] : outputs_) {
+    absl::StrAppend(&result, renumber(literal), "\n");
+  }
+  for (int64_t v = 1; v < variables_.size(); ++v) {
+    const Variable& variable = variables_[v];
+    if (variable.input_number >= 0) {
+      continue;
+    }
+    AigLiteral lhs = 2 * numbers[v];
+    AigLiteral rhs0 =
+        std::max(renumber(variable.fanin0), renumber(variable.fanin1));
+    AigLiteral rhs1 =
+        std::min(renumber(variable.fanin0), renumber(variable.fanin1));
+    // Each gate is stored as the two deltas between its literals.
+    AppendVarint(lhs - rhs0, result);
+    AppendVarint(rhs0 - rhs1, result);
+  }
+  absl::StrAppend(&result, AigerSymbolTable());
+  return result;
+}
+
+}  // namespace xls
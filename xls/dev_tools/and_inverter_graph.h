@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DEV_TOOLS_AND_INVERTER_GRAPH_H_
+#define XLS_DEV_TOOLS_AND_INVERTER_GRAPH_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// A literal of an AndInverterGraph, encoded as in the AIGER format: twice the
+// variable number, plus one if the literal is complemented. Variable 0 is the
+// constant false, so literal 0 is false and literal 1 is true.
+using AigLiteral = uint32_t;
+
+// A combinational And-Inverter Graph: every gate is a two-input AND whose
+// inputs may be complemented. Gates are structurally hashed and constant
+// propagated as they are created, so building the same function of the same
+// literals twice yields the same literal and no new gate.
+class AndInverterGraph {
+ public:
+  static constexpr AigLiteral kFalse = 0;
+  static constexpr AigLiteral kTrue = 1;
+
+  static AigLiteral Not(AigLiteral a) { return a ^ 1; }
+
+  // Adds a primary input and returns its (uncomplemented) literal.
+  AigLiteral AddInput(std::string_view name);
+
+  // Returns the conjunction of `a` and `b`, creating a gate only if the result
+  // is not a constant, one of the operands, or an existing gate.
+  AigLiteral And(AigLiteral a, AigLiteral b);
+  AigLiteral Or(AigLiteral a, AigLiteral b) {
+    return Not(And(Not(a), Not(b)));
+  }
+
+  // Marks `literal` as a primary output.
+  void AddOutput(AigLiteral literal, std::string_view name);
+
+  int64_t input_count() const { return inputs_.size(); }
+  int64_t output_count() const { return outputs_.size(); }
+  int64_t and_count() const { return and_count_; }
+
+  // Returns the number of AND gates on the longest path from an input or
+  // constant to an output.
+  int64_t Depth() const;
+
+  // Returns the values of the outputs given the values of the inputs, in the
+  // order they were added.
+  absl::StatusOr<std::vector<bool>> Evaluate(
+      absl::Span<const bool> inputs) const;
+
+  // Returns the graph in the ASCII ("aag") or binary ("aig") AIGER format,
+  // including a symbol table with the input and output names. Variables are
+  // renumbered so that inputs precede gates, as the format requires.
+  std::string ToAigerAscii() const;
+  std::string ToAigerBinary() const;
+
+ private:
+  // An input (`input_number` >= 0) or an AND gate of `fanin0` and `fanin1`,
+  // with fanin0 <= fanin1.
+  struct Variable {
+    int64_t input_number = -1;
+    AigLiteral fanin0 = kFalse;
+    AigLiteral fanin1 = kFalse;
+  };
+
+  // Returns, for each variable, its number in the AIGER output.
+  std::vector<AigLiteral> GetAigerVariableNumbers() const;
+
+  std::string AigerHeader(std::string_view format) const;
+  std::string AigerSymbolTable() const;
+
+  // Indexed by variable number; the entry for variable 0 is unused.
+  std::vector<Variable> variables_ = {Variable{}};
+  std::vector<std::pair<AigLiteral, std::string>> inputs_;
+  std::vector<std::pair<AigLiteral, std::string>> outputs_;
+  absl::flat_hash_map<std::pair<AigLiteral, AigLiteral>, AigLiteral> gates_;
+  int64_t and_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_DEV_TOOLS_AND_INVERTER_GRAPH_H_
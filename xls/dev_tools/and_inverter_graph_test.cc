@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/and_inverter_graph.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::ElementsAre;
+
+TEST(AndInverterGraphTest, ConstantPropagation) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  EXPECT_EQ(aig.And(a, AndInverterGraph::kFalse), AndInverterGraph::kFalse);
+  EXPECT_EQ(aig.And(AndInverterGraph::kTrue, a), a);
+  EXPECT_EQ(aig.And(a, a), a);
+  EXPECT_EQ(aig.And(a, AndInverterGraph::Not(a)), AndInverterGraph::kFalse);
+  EXPECT_EQ(aig.Or(a, AndInverterGraph::Not(a)), AndInverterGraph::kTrue);
+  EXPECT_EQ(aig.and_count(), 0);
+}
+
+TEST(AndInverterGraphTest, StructuralHashing) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  AigLiteral b = aig.AddInput("b");
+  AigLiteral ab = aig.And(a, b);
+  EXPECT_EQ(aig.And(b, a), ab);
+  EXPECT_NE(aig.And(a, AndInverterGraph::Not(b)), ab);
+  EXPECT_EQ(aig.and_count(), 2);
+}
+
+TEST(AndInverterGraphTest, EvaluateXor) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  AigLiteral b = aig.AddInput("b");
+  aig.AddOutput(aig.Or(aig.And(a, AndInverterGraph::Not(b)),
+                       aig.And(AndInverterGraph::Not(a), b)),
+                "xor");
+  EXPECT_EQ(aig.Depth(), 2);
+  EXPECT_THAT(aig.Evaluate({false, false}), IsOkAndHolds(ElementsAre(false)));
+  EXPECT_THAT(aig.Evaluate({true, false}), IsOkAndHolds(ElementsAre(true)));
+  EXPECT_THAT(aig.Evaluate({false, true}), IsOkAndHolds(ElementsAre(true)));
+  EXPECT_THAT(aig.Evaluate({true, true}), IsOkAndHolds(ElementsAre(false)));
+}
+
+TEST(AndInverterGraphTest, AigerRenumbersInputsFirst) {
+  AndInverterGraph aig;
+  AigLiteral a = aig.AddInput("a");
+  AigLiteral b = aig.AddInput("b");
+  AigLiteral ab = aig.And(a, b);
+  // Added after a gate, but must still be numbered before it.
+  AigLiteral c = aig.AddInput("c");
+  aig.AddOutput(AndInverterGraph::Not(aig.And(ab, c)), "o");
+  EXPECT_EQ(aig.ToAigerAscii(), R"(aag 5 3 0 1 2
+2
+4
+6
+11
+8 4 2
+10 8 6
+i0 a
+i1 b
+i2 c
+o0 o
+)");
+  EXPECT_EQ(aig.ToAigerBinary(),
+            "aig 5 3 0 1 2\n11\n\x04\x02\x02\x02i0 a\ni1 b\ni2 c\no0 o\n");
+}
+
+}  // namespace
+}  // namespace xls
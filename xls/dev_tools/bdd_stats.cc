@@ -12,7 +12,6 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <algorithm>
 #include <cstdint>
 #include <iostream>
 #include <limits>
@@ -37,6 +36,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/binary_decision_diagram.h"
+#include "xls/dev_tools/stats_writer.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node.h"
@@ -46,112 +46,170 @@
 static constexpr std::string_view kUsage = R"(
 Builds a BDD from XLS IR and prints various metrics about the BDD. Usage:
 
-To gather BDD stats of an IR file:
-   bdd_stats <ir_file>
+To gather BDD stats of IR files:
+   bdd_stats <ir_file>...
 
 To gather BDD stats of a set of benchmarks:
    bdd_stats --benchmarks=sha256,crc32
    bdd_stats --benchmarks=all
+
+With --output_format=jsonl or csv, the packages are processed concurrently and
+one record per package is streamed to stdout as each finishes.
 )";
 
 ABSL_FLAG(int64_t, bdd_path_limit, 0,
           "Maximum number of paths before truncating the BDD subgraph "
           "and declaring a new variable. If zero, then no limit.");
+ABSL_FLAG(bool, bdd_dynamic_reordering, false,
+          "Whether to improve the BDD variable order by sifting as the BDD "
+          "grows.");
+ABSL_FLAG(int64_t, bdd_node_limit, 0,
+          "Maximum number of live BDD nodes; once exceeded, the remaining IR "
+          "nodes are modeled as variables. If zero, then no limit.");
 ABSL_FLAG(std::vector<std::string>, benchmarks, {},
           "Comma-separated list of benchmarks gather BDD stats about.");
+ABSL_FLAG(std::string, output_format, "text",
+          "Either `text` for a human-readable summary, or `jsonl` or `csv` "
+          "for one record per package.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of packages processed concurrently with --output_format "
+          "jsonl or csv. If not positive, one per available CPU.");
 
 namespace xls {
 namespace {
 
-// Return list of pairs of {name, Package} for the specified bechmarks.
-absl::StatusOr<std::vector<std::pair<std::string, std::unique_ptr<Package>>>>
-GetBenchmarks(absl::Span<const std::string> benchmark_names) {
-  std::vector<std::pair<std::string, std::unique_ptr<Package>>> packages;
-  std::vector<std::string> names;
+// Returns the names of the benchmarks specified by --benchmarks.
+absl::StatusOr<std::vector<std::string>> GetBenchmarkNames(
+    absl::Span<const std::string> benchmark_names) {
   if (benchmark_names.size() == 1 && benchmark_names.front() == "all") {
-    XLS_ASSIGN_OR_RETURN(names, sample_packages::GetBenchmarkNames());
-  } else {
-    names = std::vector<std::string>(benchmark_names.begin(),
-                                     benchmark_names.end());
+    return sample_packages::GetBenchmarkNames();
   }
-  for (const std::string& name : names) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<Package> package,
-        sample_packages::GetBenchmark(name, /*optimized=*/true));
-    packages.push_back({name, std::move(package)});
+  return std::vector<std::string>(benchmark_names.begin(),
+                                  benchmark_names.end());
+}
+
+// Loads the named benchmark, or parses the IR file `path` ("-" for stdin).
+absl::StatusOr<std::unique_ptr<Package>> LoadPackage(std::string_view path,
+                                                     bool is_benchmark) {
+  if (is_benchmark) {
+    return sample_packages::GetBenchmark(std::string(path),
+                                         /*optimized=*/true);
   }
-  return packages;
+  std::string file = path == "-" ? "/dev/stdin" : std::string(path);
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(file));
+  return Parser::ParsePackage(contents, file);
 }
 
-absl::Status RealMain(std::string_view input_path) {
-  std::vector<std::pair<std::string, std::unique_ptr<Package>>> packages;
-  if (absl::GetFlag(FLAGS_benchmarks).empty()) {
-    QCHECK(!input_path.empty());
-    std::string path;
-    if (input_path == "-") {
-      path = "/dev/stdin";
-    } else {
-      path = std::string(input_path);
-    }
-    XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
-    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
-                         Parser::ParsePackage(contents, path));
-    packages.push_back({path, std::move(package)});
-  } else {
-    XLS_ASSIGN_OR_RETURN(packages,
-                         GetBenchmarks(absl::GetFlag(FLAGS_benchmarks)));
+struct BddStats {
+  absl::Duration construction_time;
+  int64_t node_count;
+  int64_t variable_count;
+  int64_t bits_in_graph;
+  int64_t max_paths;
+  bool exceeded_node_limit;
+};
+
+absl::StatusOr<BddStats> ComputeBddStats(Package* package) {
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (!top.has_value()) {
+    return absl::InternalError(absl::StrFormat(
+        "Top entity not set for package: %s.", package->name()));
   }
+  absl::Time start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BddFunction> bdd_function,
+      BddFunction::Run(top.value(), absl::GetFlag(FLAGS_bdd_path_limit),
+                       /*node_filter=*/std::nullopt,
+                       absl::GetFlag(FLAGS_bdd_dynamic_reordering),
+                       absl::GetFlag(FLAGS_bdd_node_limit)));
+  BddStats stats{
+      .construction_time = absl::Now() - start,
+      .node_count = bdd_function->bdd().size(),
+      .variable_count = bdd_function->bdd().variable_count(),
+      .bits_in_graph = 0,
+      .max_paths = bdd_function->bdd().max_path_count(),
+      .exceeded_node_limit = bdd_function->exceeded_node_limit(),
+  };
+  for (Node* node : top.value()->nodes()) {
+    stats.bits_in_graph += node->GetType()->GetFlatBitCount();
+  }
+  return stats;
+}
 
+absl::Status PrintStats(absl::Span<const std::string> names,
+                        bool is_benchmark) {
   absl::Duration total_time;
-  for (const auto& pair : packages) {
-    const std::string& name = pair.first;
-    const auto& package = pair.second;
-    if (packages.size() > 1) {
+  for (const std::string& name : names) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                         LoadPackage(name, is_benchmark));
+    if (names.size() > 1) {
       // Use endl to flush cout so the banner appears before starting work on
       // the BDD.
-      std::cout << "================== " << name << '\n';
-    }
-    std::optional<FunctionBase*> top = package->GetTop();
-    if (!top.has_value()) {
-      return absl::InternalError(absl::StrFormat(
-          "Top entity not set for package: %s.", package->name()));
-    }
-    absl::Time start = absl::Now();
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BddFunction> bdd_function,
-        BddFunction::Run(top.value(), absl::GetFlag(FLAGS_bdd_path_limit)));
-    absl::Duration bdd_time = absl::Now() - start;
-    total_time += bdd_time;
-    std::cout << "BDD construction time: " << bdd_time << "\n";
-    std::cout << "BDD node count: " << bdd_function->bdd().size() << "\n";
-    std::cout << "BDD variable count: " << bdd_function->bdd().variable_count()
-              << "\n";
-
-    int64_t number_bits = 0;
-    for (Node* node : top.value()->nodes()) {
-      number_bits += node->GetType()->GetFlatBitCount();
+      std::cout << "================== " << name << std::endl;
     }
-    std::cout << "Bits in graph: " << number_bits << "\n";
-
-    int64_t max_paths = 0;
-    for (int64_t i = 0; i < bdd_function->bdd().size(); ++i) {
-      max_paths =
-          std::max(max_paths, bdd_function->bdd().path_count(BddNodeIndex(i)));
+    XLS_ASSIGN_OR_RETURN(BddStats stats, ComputeBddStats(package.get()));
+    total_time += stats.construction_time;
+    std::cout << "BDD construction time: " << stats.construction_time << "\n";
+    std::cout << "BDD node count: " << stats.node_count << "\n";
+    std::cout << "BDD variable count: " << stats.variable_count << "\n";
+    if (stats.exceeded_node_limit) {
+      std::cout << "BDD node limit exceeded\n";
     }
-    if (max_paths == std::numeric_limits<int32_t>::max()) {
+    std::cout << "Bits in graph: " << stats.bits_in_graph << "\n";
+    if (stats.max_paths == std::numeric_limits<int32_t>::max()) {
       std::cout << "Maximum paths of any expression: INT32_MAX\n";
     } else {
-      std::cout << "Maximum paths of any expression: " << max_paths << "\n";
+      std::cout << "Maximum paths of any expression: " << stats.max_paths
+                << "\n";
     }
   }
 
-  if (packages.size() > 1) {
+  if (names.size() > 1) {
     std::cout << "\nTotal construction time: " << total_time << "\n";
   }
-
   return absl::OkStatus();
 }
 
+absl::Status RealMain(absl::Span<const std::string> input_paths) {
+  bool is_benchmark = !absl::GetFlag(FLAGS_benchmarks).empty();
+  std::vector<std::string> names;
+  if (is_benchmark) {
+    XLS_ASSIGN_OR_RETURN(names,
+                         GetBenchmarkNames(absl::GetFlag(FLAGS_benchmarks)));
+  } else {
+    QCHECK(!input_paths.empty());
+    names = std::vector<std::string>(input_paths.begin(), input_paths.end());
+  }
+
+  if (absl::GetFlag(FLAGS_output_format) == "text") {
+    return PrintStats(names, is_benchmark);
+  }
+  XLS_ASSIGN_OR_RETURN(
+      StatsFormat format,
+      StatsFormatFromString(absl::GetFlag(FLAGS_output_format)));
+  StatsWriter writer(std::cout, format);
+  return ComputeStatsInParallel(
+      names, absl::GetFlag(FLAGS_threads),
+      [&](const std::string& name)
+          -> absl::StatusOr<std::vector<StatsRecord>> {
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                             LoadPackage(name, is_benchmark));
+        XLS_ASSIGN_OR_RETURN(BddStats stats, ComputeBddStats(package.get()));
+        StatsRecord record;
+        record.AddString("name", name)
+            .AddString("package", package->name())
+            .AddDouble("construction_ms",
+                       absl::ToDoubleMilliseconds(stats.construction_time))
+            .AddInt("bdd_nodes", stats.node_count)
+            .AddInt("bdd_variables", stats.variable_count)
+            .AddBool("node_limit_exceeded", stats.exceeded_node_limit)
+            .AddInt("bits_in_graph", stats.bits_in_graph)
+            .AddInt("max_paths", stats.max_paths);
+        return std::vector<StatsRecord>{std::move(record)};
+      },
+      writer);
+}
+
 }  // namespace
 }  // namespace xls
 
@@ -161,10 +219,12 @@ int main(int argc, char** argv) {
 
   if (positional_arguments.empty() && absl::GetFlag(FLAGS_benchmarks).empty()) {
     LOG(QFATAL) << absl::StreamFormat(
-        "Expected invocation:\n  %s <path>\n  %s "
+        "Expected invocation:\n  %s <path>...\n  %s "
         "--benchmarks=<benchmark-names>",
         argv[0], argv[0]);
   }
 
-  return xls::ExitStatus(xls::RealMain(positional_arguments[0]));
+  std::vector<std::string> input_paths(positional_arguments.begin(),
+                                       positional_arguments.end());
+  return xls::ExitStatus(xls::RealMain(input_paths));
 }
@@ -48,6 +48,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/binary_decision_diagram.h"
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
@@ -139,6 +140,10 @@ ABSL_FLAG(std::string, synthesis_server, "ipv4:///0.0.0.0:10000",
           "The address, including port, of the gRPC server to use with "
           "--compare_delay_to_synthesis.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads with which to run the per-stage and "
+          "per-function delay analyses; zero or negative uses all available "
+          "CPUs. The output is the same for any number of threads.");
 
 namespace xls {
 namespace {
@@ -355,10 +360,12 @@ absl::StatusOr<std::vector<int64_t>> GetDelayPerStageInPs(
   return delay_per_stage;
 }
 
+// Prints the flops and delay of each stage of `schedule`; `delay_per_stage`
+// is as computed by GetDelayPerStageInPs.
 absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineSchedule& schedule,
                                const BddQueryEngine& bdd_query_engine,
-                               const DelayEstimator& delay_estimator,
+                               absl::Span<const int64_t> delay_per_stage,
                                std::optional<int64_t> clock_period_ps) {
   int64_t total_flops = 0;
   int64_t total_duplicates = 0;
@@ -409,9 +416,6 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
     total_flops += flops_per_stage[i];
   }
 
-  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delay_per_stage,
-                       GetDelayPerStageInPs(f, schedule, delay_estimator));
-
   // TODO(tedhong) 2023-03-06 - Add functionality to report I/O flop count.
   std::cout << "Pipeline:\n";
   for (int64_t i = 0; i < schedule.length(); ++i) {
@@ -450,6 +454,7 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
                                const PipelineScheduleOrGroup& schedules,
                                const BddQueryEngine& bdd_query_engine,
                                const DelayEstimator& delay_estimator,
+                               ThreadPool& thread_pool,
                                std::optional<int64_t> clock_period_ps) {
   if (std::holds_alternative<PipelineSchedule>(schedules)) {
     const PipelineSchedule& schedule = std::get<PipelineSchedule>(schedules);
@@ -457,16 +462,36 @@ absl::Status PrintScheduleInfo(FunctionBase* f,
       std::cout << absl::StreamFormat("Min clock period ps: %d\n",
                                       *schedule.min_clock_period_ps());
     }
-    return PrintScheduleInfo(f, schedule, bdd_query_engine, delay_estimator,
+    XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delay_per_stage,
+                         GetDelayPerStageInPs(f, schedule, delay_estimator));
+    return PrintScheduleInfo(f, schedule, bdd_query_engine, delay_per_stage,
                              clock_period_ps);
   }
 
   CHECK(std::holds_alternative<PackagePipelineSchedules>(schedules));
-  for (auto& [function_base, schedule] :
-       std::get<PackagePipelineSchedules>(schedules)) {
+  const PackagePipelineSchedules& package_schedules =
+      std::get<PackagePipelineSchedules>(schedules);
+  // The per-function delay analyses are independent, so run them concurrently
+  // and print the results in schedule order.
+  std::vector<absl::StatusOr<std::vector<int64_t>>> delays_per_stage(
+      package_schedules.size());
+  int64_t index = 0;
+  for (const auto& [function_base, schedule] : package_schedules) {
+    thread_pool.Schedule(
+        [&, i = index, f = function_base, schedule = &schedule]() {
+          delays_per_stage[i] = GetDelayPerStageInPs(f, *schedule,
+                                                     delay_estimator);
+        });
+    ++index;
+  }
+  thread_pool.WaitForIdle();
+  index = 0;
+  for (const auto& [function_base, schedule] : package_schedules) {
     std::cout << "\n\nFunction: " << function_base->name() << "\n";
+    XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delay_per_stage,
+                         std::move(delays_per_stage[index++]));
     XLS_RETURN_IF_ERROR(PrintScheduleInfo(function_base, schedule,
-                                          bdd_query_engine, delay_estimator,
+                                          bdd_query_engine, delay_per_stage,
                                           clock_period_ps));
   }
   return absl::OkStatus();
@@ -742,7 +767,8 @@ absl::Status RunInterpreterAndJit(FunctionBase* function_base,
 absl::Status AnalyzeAndPrintCriticalPath(
     FunctionBase* f, std::optional<int64_t> effective_clock_period_ps,
     const DelayEstimator& delay_estimator, const QueryEngine& query_engine,
-    PipelineScheduleOrGroup* schedules, synthesis::Synthesizer* synthesizer) {
+    PipelineScheduleOrGroup* schedules, synthesis::Synthesizer* synthesizer,
+    ThreadPool& thread_pool) {
   XLS_ASSIGN_OR_RETURN(
       std::vector<CriticalPathEntry> critical_path,
       AnalyzeCriticalPath(f, effective_clock_period_ps, delay_estimator));
@@ -752,7 +778,7 @@ absl::Status AnalyzeAndPrintCriticalPath(
       XLS_ASSIGN_OR_RETURN(
           delay_diff,
           CreateDelayDiffByStage(f, std::get<PipelineSchedule>(*schedules),
-                                 delay_estimator, synthesizer));
+                                 delay_estimator, synthesizer, &thread_pool));
       delay_diff.total_diff.critical_path = std::move(critical_path);
     } else {
       XLS_ASSIGN_OR_RETURN(
@@ -823,6 +849,11 @@ absl::Status RealMain(std::string_view path) {
         GetDelayEstimator(scheduling_options_flags_proto.delay_model()));
   }
   const auto& delay_estimator = *pdelay_estimator;
+  // The analyses below query the delays of the same nodes, so they share one
+  // cache which is safe to use from the thread pool. The scheduler may rewrite
+  // nodes, so it uses the underlying estimator directly.
+  CachingDelayEstimator caching_delay_estimator("caching", delay_estimator);
+  ThreadPool thread_pool(absl::GetFlag(FLAGS_threads));
   std::unique_ptr<synthesis::Synthesizer> synthesizer;
   if (absl::GetFlag(FLAGS_compare_delay_to_synthesis)) {
     synthesis::GrpcSynthesizerParameters parameters(
@@ -840,8 +871,8 @@ absl::Status RealMain(std::string_view path) {
       scheduling_options_flags_proto.pipeline_stages() > 0;
   if (!f->IsProc() && !benchmark_codegen) {
     XLS_RETURN_IF_ERROR(AnalyzeAndPrintCriticalPath(
-        f, effective_clock_period_ps, delay_estimator, query_engine,
-        /*schedules=*/nullptr, synthesizer.get()));
+        f, effective_clock_period_ps, caching_delay_estimator, query_engine,
+        /*schedules=*/nullptr, synthesizer.get(), thread_pool));
   } else if (benchmark_codegen) {
     PipelineScheduleOrGroup schedules = PackagePipelineSchedules();
     if (codegen_flags_proto.generator() == GENERATOR_KIND_PIPELINE) {
@@ -855,15 +886,15 @@ absl::Status RealMain(std::string_view path) {
       std::cout << absl::StreamFormat("Scheduling time: %dms\n",
                                       scheduling_time / absl::Milliseconds(1));
       XLS_RETURN_IF_ERROR(AnalyzeAndPrintCriticalPath(
-          f, effective_clock_period_ps, delay_estimator, query_engine,
-          &schedules, synthesizer.get()));
+          f, effective_clock_period_ps, caching_delay_estimator, query_engine,
+          &schedules, synthesizer.get(), thread_pool));
 
       // Scheduling can change the nodes in f slightly so we need to recompute
       // the bdd.
       BddQueryEngine sched_qe(BddFunction::kDefaultPathLimit);
       XLS_RETURN_IF_ERROR(sched_qe.Populate(f).status());
       XLS_RETURN_IF_ERROR(PrintScheduleInfo(
-          f, schedules, sched_qe, delay_estimator,
+          f, schedules, sched_qe, caching_delay_estimator, thread_pool,
           scheduling_options_flags_proto.has_clock_period_ps()
               ? std::make_optional(
                     scheduling_options_flags_proto.clock_period_ps())
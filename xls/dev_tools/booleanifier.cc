@@ -19,6 +19,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <optional>
@@ -37,6 +38,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
+#include "xls/dev_tools/and_inverter_graph.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
 #include "xls/ir/bits.h"
@@ -89,6 +91,35 @@ class BitEvaluator : public AbstractEvaluator<Node*, BitEvaluator> {
   BValue zero_;
 };
 
+// Evaluator for converting Nodes representing high-level Ops into gates of an
+// And-Inverter Graph.
+class AigEvaluator : public AbstractEvaluator<AigLiteral, AigEvaluator> {
+ public:
+  explicit AigEvaluator(AndInverterGraph* aig) : aig_(aig) {}
+
+  AigLiteral One() const { return AndInverterGraph::kTrue; }
+  AigLiteral Zero() const { return AndInverterGraph::kFalse; }
+  AigLiteral Not(const AigLiteral& input) const {
+    return AndInverterGraph::Not(input);
+  }
+  AigLiteral And(const AigLiteral& a, const AigLiteral& b) const {
+    return aig_->And(a, b);
+  }
+  AigLiteral Or(const AigLiteral& a, const AigLiteral& b) const {
+    return aig_->Or(a, b);
+  }
+  AigLiteral If(AigLiteral sel, AigLiteral consequent,
+                AigLiteral alternate) const {
+    if (consequent == alternate) {
+      return consequent;
+    }
+    return Or(And(sel, consequent), And(Not(sel), alternate));
+  }
+
+ private:
+  AndInverterGraph* aig_;
+};
+
 absl::StatusOr<Function*> Booleanifier::Booleanify(
     Function* f, std::string_view boolean_function_name) {
   Booleanifier b(f, boolean_function_name);
@@ -105,21 +136,24 @@ Booleanifier::Booleanifier(Function* f, std::string_view boolean_function_name)
 
 // A node evaluator providing a bit-based implementation of
 // array-index/update/slice.
-class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
+template <typename EvaluatorT>
+class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<EvaluatorT> {
  public:
-  BooleanifierNodeEvaluator(
-      BitEvaluator& eval, FunctionBuilder* fb,
-      const absl::flat_hash_map<std::string, BValue>& params)
-      : AbstractNodeEvaluator<BitEvaluator>(eval),
-        builder_(fb),
-        params_(params) {}
+  using LeafValueT = typename AbstractNodeEvaluator<EvaluatorT>::LeafValueT;
+  using Span = typename EvaluatorT::Span;
+  using ParamUnpacker =
+      std::function<absl::StatusOr<LeafTypeTree<LeafValueT>>(Param*)>;
+
+  BooleanifierNodeEvaluator(EvaluatorT& eval, ParamUnpacker unpack_param)
+      : AbstractNodeEvaluator<EvaluatorT>(eval),
+        unpack_param_(std::move(unpack_param)) {}
 
   // Select the appropriate elements.
   absl::Status HandleArrayIndex(ArrayIndex* index) override {
-    XLS_ASSIGN_OR_RETURN(std::vector<BitEvaluator::Span> indexes,
-                         GetValueList(index->indices()));
+    XLS_ASSIGN_OR_RETURN(std::vector<Span> indexes,
+                         this->GetValueList(index->indices()));
     XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<LeafValueT> array,
-                         GetCompoundValue(index->array()));
+                         this->GetCompoundValue(index->array()));
     LeafTypeTree<LeafValueT> result(array.type(), array.elements());
     for (int64_t i = 0; i < indexes.size(); ++i) {
       if (index->indices().at(i)->Is<Literal>()) {
@@ -133,24 +167,24 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
         XLS_ASSIGN_OR_RETURN(result, ReadOneIndex(result.AsView(), indexes[i]));
       }
     }
-    return SetValue(index, std::move(result));
+    return this->SetValue(index, std::move(result));
   }
 
   // select the appropriate slice.
   absl::Status HandleArraySlice(ArraySlice* slice) override {
     XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<LeafValueT> array,
-                         GetCompoundValue(slice->array()));
+                         this->GetCompoundValue(slice->array()));
     XLS_ASSIGN_OR_RETURN(ArrayType * array_type, slice->GetType()->AsArray());
     int64_t input_size = slice->array()->GetType()->AsArrayOrDie()->size();
     if (slice->start()->Is<Literal>()) {
       int64_t start_idx =
           RealIndexFromLiteral(slice->start()->As<Literal>(), input_size);
       XLS_ASSIGN_OR_RETURN(LeafTypeTree<LeafValueT> sliced,
-                           leaf_type_tree::SliceArray<BitEvaluator::Vector>(
+                           leaf_type_tree::SliceArray<LeafValueT>(
                                array_type, array, start_idx));
-      return SetValue(slice, std::move(sliced));
+      return this->SetValue(slice, std::move(sliced));
     }
-    XLS_ASSIGN_OR_RETURN(BitEvaluator::Span index, GetValue(slice->start()));
+    XLS_ASSIGN_OR_RETURN(Span index, this->GetValue(slice->start()));
     std::vector<LeafTypeTree<LeafValueT>> slices_mem;
     std::vector<LeafTypeTreeView<LeafValueT>> slices;
     slices_mem.reserve(slice->array()->GetType()->AsArrayOrDie()->size());
@@ -164,21 +198,19 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
       slices_mem.emplace_back(std::move(one_slice));
       slices.push_back(slices_mem.back().AsView());
     }
-    std::vector<BitEvaluator::Span> spans;
+    std::vector<Span> spans;
     spans.resize(slices.size());
     XLS_ASSIGN_OR_RETURN(
         LeafTypeTree<LeafValueT> result,
-        (leaf_type_tree::ZipIndex<BitEvaluator::Vector, BitEvaluator::Vector>(
+        (leaf_type_tree::ZipIndex<LeafValueT, LeafValueT>(
             slices,
-            [&](Type* et,
-                absl::Span<const BitEvaluator::Vector* const> elements,
+            [&](Type* et, absl::Span<const LeafValueT* const> elements,
                 absl::Span<int64_t const> _)
-                -> absl::StatusOr<BitEvaluator::Vector> {
+                -> absl::StatusOr<LeafValueT> {
               XLS_RET_CHECK_EQ(elements.size(), spans.size());
-              absl::c_transform(
-                  elements, spans.begin(),
-                  [](auto* v) -> BitEvaluator::Span { return *v; });
-              return evaluator().Select(
+              absl::c_transform(elements, spans.begin(),
+                                [](auto* v) -> Span { return *v; });
+              return this->evaluator().Select(
                   index,
                   absl::MakeSpan(spans).subspan(
                       0, std::min<int64_t>(input_size, addressable_values)),
@@ -186,16 +218,16 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
                       ? std::make_optional(spans.back())
                       : std::nullopt);
             })));
-    return SetValue(slice, std::move(result));
+    return this->SetValue(slice, std::move(result));
   }
 
   absl::Status HandleArrayUpdate(ArrayUpdate* update) override {
-    XLS_ASSIGN_OR_RETURN(std::vector<BitEvaluator::Span> indexes,
-                         GetValueList(update->indices()));
+    XLS_ASSIGN_OR_RETURN(std::vector<Span> indexes,
+                         this->GetValueList(update->indices()));
     XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<LeafValueT> array,
-                         GetCompoundValue(update->array_to_update()));
+                         this->GetCompoundValue(update->array_to_update()));
     XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<LeafValueT> update_val,
-                         GetCompoundValue(update->update_value()));
+                         this->GetCompoundValue(update->update_value()));
     // Check for out-of-bounds-write
     XLS_ASSIGN_OR_RETURN(ArrayType * arr, update->GetType()->AsArray());
     for (int64_t i = 0; i < update->indices().size(); ++i) {
@@ -205,7 +237,7 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
                                std::numeric_limits<int64_t>::max()) >=
               arr->size()) {
         // Write is known-out-of-bounds, no effect.
-        return SetValue(
+        return this->SetValue(
             update, LeafTypeTree<LeafValueT>(array.type(), array.elements()));
       }
       if (i + 1 < update->indices().size()) {
@@ -215,61 +247,15 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
     XLS_ASSIGN_OR_RETURN(
         LeafTypeTree<LeafValueT> result,
         PerformUpdateWith(array, indexes, update->indices(), update_val));
-    return SetValue(update, std::move(result));
+    return this->SetValue(update, std::move(result));
   }
 
   absl::Status HandleParam(Param* param) override {
-    XLS_ASSIGN_OR_RETURN(LeafTypeTree<LeafValueT> result,
-                         UnpackParam(params_.at(param->name())));
-    return SetValue(param, std::move(result));
+    XLS_ASSIGN_OR_RETURN(LeafTypeTree<LeafValueT> result, unpack_param_(param));
+    return this->SetValue(param, std::move(result));
   }
 
  private:
-  absl::StatusOr<LeafTypeTree<LeafValueT>> UnpackParam(BValue bv_node) {
-    if (bv_node.GetType()->IsBits()) {
-      BitEvaluator::Vector res;
-      int64_t bit_count = bv_node.GetType()->GetFlatBitCount();
-      res.reserve(bit_count);
-      for (int64_t i = 0; i < bit_count; ++i) {
-        res.push_back(builder_->BitSlice(bv_node, i, 1).node());
-      }
-      return LeafTypeTree<LeafValueT>(bv_node.GetType(), res);
-    }
-    if (bv_node.GetType()->IsArray()) {
-      ArrayType* arr_type = bv_node.GetType()->AsArrayOrDie();
-      std::vector<LeafTypeTree<LeafValueT>> elements_mem;
-      std::vector<LeafTypeTreeView<LeafValueT>> elements;
-      elements_mem.reserve(arr_type->size());
-      elements.reserve(arr_type->size());
-      for (int64_t i = 0; i < arr_type->size(); ++i) {
-        XLS_ASSIGN_OR_RETURN(LeafTypeTree<LeafValueT> element,
-                             UnpackParam(builder_->ArrayIndex(
-                                 bv_node, {builder_->Literal(UBits(i, 64))})));
-        elements_mem.emplace_back(std::move(element));
-        elements.push_back(elements_mem.back().AsView());
-      }
-      return leaf_type_tree::CreateArray<BitEvaluator::Vector>(arr_type,
-                                                               elements);
-    }
-    if (bv_node.GetType()->IsTuple()) {
-      TupleType* tup_type = bv_node.GetType()->AsTupleOrDie();
-      std::vector<LeafTypeTree<LeafValueT>> elements_mem;
-      std::vector<LeafTypeTreeView<LeafValueT>> elements;
-      elements_mem.reserve(tup_type->size());
-      elements.reserve(tup_type->size());
-      for (int64_t i = 0; i < tup_type->size(); ++i) {
-        XLS_ASSIGN_OR_RETURN(LeafTypeTree<LeafValueT> element,
-                             UnpackParam(builder_->TupleIndex(bv_node, i)));
-        elements_mem.emplace_back(std::move(element));
-        elements.push_back(elements_mem.back().AsView());
-      }
-      return leaf_type_tree::CreateTuple<BitEvaluator::Vector>(tup_type,
-                                                               elements);
-    }
-    XLS_RET_CHECK(bv_node.GetType()->IsToken())
-        << bv_node << " type not handled";
-    XLS_RET_CHECK_FAIL() << bv_node << " is a token!";
-  }
   int64_t RealIndexFromLiteral(Literal* l, int64_t limit) {
     int64_t start_idx = l->value().bits().FitsInUint64()
                             ? l->value().bits().ToUint64().value()
@@ -284,7 +270,7 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
   // indexes_nodes. Update the value to 'to_update'
   absl::StatusOr<LeafTypeTree<LeafValueT>> PerformUpdateWith(
       LeafTypeTreeView<LeafValueT> array,
-      absl::Span<BitEvaluator::Span const> indexes,
+      absl::Span<Span const> indexes,
       absl::Span<Node* const> indexes_nodes,
       LeafTypeTreeView<LeafValueT> to_update) {
     XLS_RET_CHECK_EQ(indexes.size(), indexes_nodes.size());
@@ -333,18 +319,18 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
     }
     // Push the 'unchanged' variant at the end in case its needed.
     cases.push_back(array);
-    std::vector<BitEvaluator::Span> spans;
+    std::vector<Span> spans;
     spans.resize(cases.size());
-    return leaf_type_tree::ZipIndex<BitEvaluator::Vector, BitEvaluator::Vector>(
+    return leaf_type_tree::ZipIndex<LeafValueT, LeafValueT>(
         cases,
-        [&](Type* et, absl::Span<const BitEvaluator::Vector* const> elements,
+        [&](Type* et, absl::Span<const LeafValueT* const> elements,
             absl::Span<int64_t const> ltt_location)
-            -> absl::StatusOr<BitEvaluator::Vector> {
+            -> absl::StatusOr<LeafValueT> {
           XLS_RET_CHECK_EQ(elements.size(), spans.size());
           absl::c_transform(elements, spans.begin(),
-                            [](auto* v) -> BitEvaluator::Span { return *v; });
+                            [](auto* v) -> Span { return *v; });
           // back is the unchanged element.
-          return evaluator().Select(
+          return this->evaluator().Select(
               indexes.front(),
               // Make sure that we have no more cases than we can address.
               absl::MakeSpan(spans).subspan(
@@ -358,7 +344,7 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
 
   // Perform an ArrayIndex with a single index element.
   absl::StatusOr<LeafTypeTree<LeafValueT>> ReadOneIndex(
-      LeafTypeTreeView<LeafValueT> source, BitEvaluator::Span index) {
+      LeafTypeTreeView<LeafValueT> source, Span index) {
     int64_t array_size = source.type()->AsArrayOrDie()->size();
     std::vector<LeafTypeTreeView<LeafValueT>> cases;
     cases.reserve(array_size);
@@ -368,17 +354,17 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
     for (int64_t i = 0; i < array_size && i < addressable_values; ++i) {
       cases.push_back(source.AsView({i}));
     }
-    std::vector<BitEvaluator::Span> spans;
+    std::vector<Span> spans;
     spans.resize(cases.size());
-    return leaf_type_tree::ZipIndex<BitEvaluator::Vector, BitEvaluator::Vector>(
+    return leaf_type_tree::ZipIndex<LeafValueT, LeafValueT>(
         cases,
-        [&](Type* et, absl::Span<const BitEvaluator::Vector* const> elements,
+        [&](Type* et, absl::Span<const LeafValueT* const> elements,
             absl::Span<int64_t const> _)
-            -> absl::StatusOr<BitEvaluator::Vector> {
+            -> absl::StatusOr<LeafValueT> {
           XLS_RET_CHECK_EQ(elements.size(), spans.size());
           absl::c_transform(elements, spans.begin(),
-                            [](auto* v) -> BitEvaluator::Span { return *v; });
-          return evaluator().Select(
+                            [](auto* v) -> Span { return *v; });
+          return this->evaluator().Select(
               index,
               absl::MakeSpan(spans).subspan(
                   0, std::min<int64_t>(spans.size(), addressable_values)),
@@ -386,8 +372,7 @@ class BooleanifierNodeEvaluator : public AbstractNodeEvaluator<BitEvaluator> {
                                               : std::nullopt);
         });
   }
-  FunctionBuilder* builder_;
-  const absl::flat_hash_map<std::string, BValue>& params_;
+  ParamUnpacker unpack_param_;
 };
 
 absl::StatusOr<Function*> Booleanifier::Run() {
@@ -395,20 +380,66 @@ absl::StatusOr<Function*> Booleanifier::Run() {
     params_[param->name()] = builder_.Param(param->name(), param->GetType());
   }
 
-  BooleanifierNodeEvaluator bne(*evaluator_, &builder_, params_);
+  BooleanifierNodeEvaluator<BitEvaluator> bne(
+      *evaluator_, [this](Param* param) {
+        return UnpackParam(params_.at(param->name()));
+      });
   XLS_RETURN_IF_ERROR(input_fn_->Accept(&bne));
 
   Node* return_node = input_fn_->return_value();
-  XLS_ASSIGN_OR_RETURN(
-      LeafTypeTreeView<BooleanifierNodeEvaluator::LeafValueT> return_val,
-      bne.GetCompoundValue(return_node));
+  XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<Vector> return_val,
+                       bne.GetCompoundValue(return_node));
   XLS_ASSIGN_OR_RETURN(BValue result, PackReturnValue(return_val));
   return builder_.BuildWithReturnValue(result);
 }
 
+absl::StatusOr<LeafTypeTree<Booleanifier::Vector>> Booleanifier::UnpackParam(
+    BValue bv_node) {
+  if (bv_node.GetType()->IsBits()) {
+    Vector res;
+    int64_t bit_count = bv_node.GetType()->GetFlatBitCount();
+    res.reserve(bit_count);
+    for (int64_t i = 0; i < bit_count; ++i) {
+      res.push_back(builder_.BitSlice(bv_node, i, 1).node());
+    }
+    return LeafTypeTree<Vector>(bv_node.GetType(), res);
+  }
+  if (bv_node.GetType()->IsArray()) {
+    ArrayType* arr_type = bv_node.GetType()->AsArrayOrDie();
+    std::vector<LeafTypeTree<Vector>> elements_mem;
+    std::vector<LeafTypeTreeView<Vector>> elements;
+    elements_mem.reserve(arr_type->size());
+    elements.reserve(arr_type->size());
+    for (int64_t i = 0; i < arr_type->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(LeafTypeTree<Vector> element,
+                           UnpackParam(builder_.ArrayIndex(
+                               bv_node, {builder_.Literal(UBits(i, 64))})));
+      elements_mem.emplace_back(std::move(element));
+      elements.push_back(elements_mem.back().AsView());
+    }
+    return leaf_type_tree::CreateArray<Vector>(arr_type, elements);
+  }
+  if (bv_node.GetType()->IsTuple()) {
+    TupleType* tup_type = bv_node.GetType()->AsTupleOrDie();
+    std::vector<LeafTypeTree<Vector>> elements_mem;
+    std::vector<LeafTypeTreeView<Vector>> elements;
+    elements_mem.reserve(tup_type->size());
+    elements.reserve(tup_type->size());
+    for (int64_t i = 0; i < tup_type->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(LeafTypeTree<Vector> element,
+                           UnpackParam(builder_.TupleIndex(bv_node, i)));
+      elements_mem.emplace_back(std::move(element));
+      elements.push_back(elements_mem.back().AsView());
+    }
+    return leaf_type_tree::CreateTuple<Vector>(tup_type, elements);
+  }
+  XLS_RET_CHECK(bv_node.GetType()->IsToken()) << bv_node << " type not handled";
+  XLS_RET_CHECK_FAIL() << bv_node << " is a token!";
+}
+
 // The inverse of UnpackParam - overlays structure on top of a flat bit array.
 absl::StatusOr<BValue> Booleanifier::PackReturnValue(
-    LeafTypeTreeView<BooleanifierNodeEvaluator::LeafValueT> result) {
+    LeafTypeTreeView<Vector> result) {
   if (result.type()->IsBits()) {
     std::vector<BValue> args;
     args.reserve(result.type()->GetFlatBitCount());
@@ -441,4 +472,47 @@ absl::StatusOr<BValue> Booleanifier::PackReturnValue(
   XLS_RET_CHECK_FAIL() << result.type() << " is unimplemented";
 }
 
+absl::StatusOr<AndInverterGraph> Booleanifier::BooleanifyToAig(Function* f) {
+  using AigVector = AigEvaluator::Vector;
+  AndInverterGraph aig;
+  AigEvaluator evaluator(&aig);
+
+  // Create all inputs up front so they are numbered in parameter order.
+  absl::flat_hash_map<Param*, LeafTypeTree<AigVector>> params;
+  for (Param* param : f->params()) {
+    int64_t bit_index = 0;
+    XLS_ASSIGN_OR_RETURN(
+        LeafTypeTree<AigVector> bits,
+        LeafTypeTree<AigVector>::CreateFromFunction(
+            param->GetType(),
+            [&](Type* leaf_type) -> absl::StatusOr<AigVector> {
+              AigVector leaf;
+              leaf.reserve(leaf_type->GetFlatBitCount());
+              for (int64_t i = 0; i < leaf_type->GetFlatBitCount(); ++i) {
+                leaf.push_back(aig.AddInput(
+                    absl::StrCat(param->name(), "[", bit_index++, "]")));
+              }
+              return leaf;
+            }));
+    params.emplace(param, std::move(bits));
+  }
+
+  BooleanifierNodeEvaluator<AigEvaluator> bne(
+      evaluator,
+      [&](Param* param) -> absl::StatusOr<LeafTypeTree<AigVector>> {
+        return params.at(param);
+      });
+  XLS_RETURN_IF_ERROR(f->Accept(&bne));
+
+  XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<AigVector> return_val,
+                       bne.GetCompoundValue(f->return_value()));
+  int64_t bit_index = 0;
+  for (const AigVector& leaf : return_val.elements()) {
+    for (AigLiteral bit : leaf) {
+      aig.AddOutput(bit, absl::StrCat("out[", bit_index++, "]"));
+    }
+  }
+  return aig;
+}
+
 }  // namespace xls
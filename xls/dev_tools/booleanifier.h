@@ -23,6 +23,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "xls/data_structures/leaf_type_tree.h"
+#include "xls/dev_tools/and_inverter_graph.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
@@ -46,15 +47,24 @@ class Booleanifier {
   static absl::StatusOr<Function*> Booleanify(
       Function* f, std::string_view boolean_function_name = "");
 
+  // Lowers the given function to an And-Inverter Graph. Gates are hashed and
+  // constant folded as they are built, so unlike Booleanify() no per-bit IR is
+  // materialized and repeated logic is shared. Parameter bits become inputs
+  // named `<param>[i]` and return value bits become outputs named `out[i]`,
+  // numbered from the least significant bit of the first leaf of the type.
+  static absl::StatusOr<AndInverterGraph> BooleanifyToAig(Function* f);
+
  private:
   Booleanifier(Function* f, std::string_view boolean_function_name);
 
   // Driver for doing the actual conversion.
   absl::StatusOr<Function*> Run();
 
+  // Splits a param of the boolean function into its individual bits.
+  absl::StatusOr<LeafTypeTree<Vector>> UnpackParam(BValue bv_node);
+
   // The inverse of UnpackParam - overlays structure on top of a flat bit array.
-  absl::StatusOr<BValue> PackReturnValue(
-      LeafTypeTreeView<std::vector<Node*>> result);
+  absl::StatusOr<BValue> PackReturnValue(LeafTypeTreeView<Vector> result);
 
   Function* input_fn_;
   FunctionBuilder builder_;
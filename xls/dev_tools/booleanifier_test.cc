@@ -29,6 +29,7 @@
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/and_inverter_graph.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/events.h"
@@ -801,5 +802,67 @@ fn main(a: bits[4][4][4]) -> bits[4][4] {
   ASSERT_EQ(fancy_value, basic_value);
 }
 
+TEST_F(BooleanifierTest, AigMatchesInterpreter) {
+  const std::string kIrText = R"(
+package p
+
+fn main(x: bits[4], y: bits[4]) -> (bits[4], bits[4]) {
+  umul.1: bits[4] = umul(x, y)
+  umul.2: bits[4] = umul(y, x)
+  add.3: bits[4] = add(umul.1, x)
+  ret tuple.4: (bits[4], bits[4]) = tuple(add.3, umul.2)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(AndInverterGraph aig,
+                           Booleanifier::BooleanifyToAig(f));
+  EXPECT_EQ(aig.input_count(), 8);
+  EXPECT_EQ(aig.output_count(), 8);
+
+  for (int64_t x = 0; x < 16; ++x) {
+    for (int64_t y = 0; y < 16; ++y) {
+      std::array<bool, 8> inputs;
+      for (int64_t i = 0; i < 4; ++i) {
+        inputs[i] = ((x >> i) & 1) != 0;
+        inputs[4 + i] = ((y >> i) & 1) != 0;
+      }
+      XLS_ASSERT_OK_AND_ASSIGN(std::vector<bool> outputs,
+                               aig.Evaluate(inputs));
+      int64_t expected_add = ((x * y) + x) & 0xf;
+      int64_t expected_mul = (x * y) & 0xf;
+      for (int64_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(outputs[i], ((expected_add >> i) & 1) != 0);
+        EXPECT_EQ(outputs[4 + i], ((expected_mul >> i) & 1) != 0);
+      }
+    }
+  }
+}
+
+TEST_F(BooleanifierTest, AigSharesIdenticalLogic) {
+  const std::string kIrText = R"(
+package p
+
+fn once(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+
+fn twice(x: bits[8], y: bits[8]) -> (bits[8], bits[8]) {
+  add.2: bits[8] = add(x, y)
+  add.3: bits[8] = add(x, y)
+  ret tuple.4: (bits[8], bits[8]) = tuple(add.2, add.3)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kIrText));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * once, package->GetFunction("once"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * twice, package->GetFunction("twice"));
+  XLS_ASSERT_OK_AND_ASSIGN(AndInverterGraph once_aig,
+                           Booleanifier::BooleanifyToAig(once));
+  XLS_ASSERT_OK_AND_ASSIGN(AndInverterGraph twice_aig,
+                           Booleanifier::BooleanifyToAig(twice));
+  EXPECT_GT(once_aig.and_count(), 0);
+  EXPECT_EQ(twice_aig.and_count(), once_aig.and_count());
+}
+
 }  // namespace
 }  // namespace xls
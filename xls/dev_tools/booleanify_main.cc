@@ -22,10 +22,13 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/and_inverter_graph.h"
 #include "xls/dev_tools/booleanifier.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
@@ -41,6 +44,11 @@ ABSL_FLAG(std::string, ir_path, "", "Path to the XLS IR to process.");
 ABSL_FLAG(std::string, output_function_name, "",
           "Name of the booleanified function. If empty, then the name is the "
           "same as the provided/inferred input name.");
+ABSL_FLAG(std::string, output_format, "ir",
+          "Format of the output: \"ir\" for an XLS function of and/or/not "
+          "ops, or \"aag\"/\"aig\" for an And-Inverter Graph in the ASCII "
+          "or binary AIGER format. For AIGER output, the graph's size and "
+          "depth are printed to stderr.");
 
 namespace xls {
 
@@ -55,6 +63,22 @@ static absl::Status RealMain(const std::filesystem::path& ir_path,
     XLS_ASSIGN_OR_RETURN(function, package->GetFunction(function_name.value()));
   }
 
+  std::string output_format = absl::GetFlag(FLAGS_output_format);
+  if (output_format == "aag" || output_format == "aig") {
+    XLS_ASSIGN_OR_RETURN(AndInverterGraph aig,
+                         Booleanifier::BooleanifyToAig(function));
+    std::cerr << absl::StreamFormat(
+        "inputs: %d outputs: %d ands: %d depth: %d\n", aig.input_count(),
+        aig.output_count(), aig.and_count(), aig.Depth());
+    std::cout << (output_format == "aag" ? aig.ToAigerAscii()
+                                         : aig.ToAigerBinary());
+    return absl::OkStatus();
+  }
+  if (output_format != "ir") {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown --output_format: ", output_format));
+  }
+
   std::string boolean_function_name = absl::GetFlag(FLAGS_output_function_name);
   if (boolean_function_name.empty()) {
     boolean_function_name = function->name();
@@ -32,11 +32,13 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/function.h"
@@ -67,6 +69,11 @@ prove that optimizations are safe - that they don't change program outputs.
 Example invocation:
   check_ir_equivalence_main <IR file> <IR file>
 
+More than two IR files may be given, e.g., the input and the output of each
+pass of a pipeline, in which case each is checked against the first one. These
+checks share a single incremental solver session in which the first function
+is translated once and each other file only translates the logic it changed.
+
 If there are multiple functions in the specified files, then it's _strongly_
 recommended that you specify --top to ensure that the right functions are
 compared. If the tool picks the wrong one, a crash may result.
@@ -90,17 +97,45 @@ ABSL_FLAG(int, match_exit_code, 0,
           "Value to exit with if equivalence is not proven.");
 ABSL_FLAG(absl::Duration, timeout, absl::InfiniteDuration(),
           "How long to wait for any proof to complete.");
+ABSL_FLAG(bool, portfolio, false,
+          "Race several solver strategies (bit-blasting plus SAT, the default "
+          "SMT solver, and a per-output-bit decomposition) in parallel "
+          "threads, take the first definitive answer, and print how each "
+          "strategy fared. Only supported when checking two IR files.");
+ABSL_FLAG(int64_t, partition_output_bits, 0,
+          "If positive, split the outputs into slices of at most this many "
+          "bits and prove each slice's cone of influence equivalent "
+          "separately, in parallel threads. --timeout applies to each slice. "
+          "Only supported when checking two IR files.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 
 namespace xls {
 namespace {
 
 absl::StatusOr<solvers::z3::ProverResult> CheckFunctionEquivalence(
-    Function* f1, Function* f2, absl::Duration timeout) {
-  return solvers::z3::TryProveEquivalence(f1, f2, timeout);
+    Function* f1, Function* f2, absl::Duration timeout, bool portfolio,
+    int64_t partition_output_bits) {
+  if (partition_output_bits > 0) {
+    ThreadPool thread_pool;
+    return solvers::z3::TryProveEquivalencePartitioned(
+        f1, f2, partition_output_bits, thread_pool, timeout);
+  }
+  if (!portfolio) {
+    return solvers::z3::TryProveEquivalence(f1, f2, timeout);
+  }
+  std::vector<solvers::z3::PortfolioStrategyResult> strategy_results;
+  absl::StatusOr<solvers::z3::ProverResult> result =
+      solvers::z3::TryProveEquivalencePortfolio(f1, f2, timeout,
+                                                &strategy_results);
+  for (const solvers::z3::PortfolioStrategyResult& strategy_result :
+       strategy_results) {
+    std::cout << "Portfolio strategy " << strategy_result.ToString() << "\n";
+  }
+  return result;
 }
 absl::StatusOr<solvers::z3::ProverResult> CheckProcEquivalence(
-    Proc* p1, Proc* p2, int64_t activation_count, absl::Duration timeout) {
+    Proc* p1, Proc* p2, int64_t activation_count, absl::Duration timeout,
+    bool portfolio, int64_t partition_output_bits) {
   XLS_ASSIGN_OR_RETURN(
       Function * f1,
       UnrollProcToFunction(p1, activation_count, /*include_state=*/false),
@@ -109,7 +144,30 @@ absl::StatusOr<solvers::z3::ProverResult> CheckProcEquivalence(
       Function * f2,
       UnrollProcToFunction(p2, activation_count, /*include_state=*/false),
       _ << "Unable to unroll: " << p2->DumpIr());
-  return CheckFunctionEquivalence(f1, f2, timeout);
+  return CheckFunctionEquivalence(f1, f2, timeout, portfolio,
+                                  partition_output_bits);
+}
+
+// Returns the function to check for `f`, unrolling it if it is a proc.
+absl::StatusOr<Function*> FunctionToCheck(
+    FunctionBase* f, std::optional<int64_t> activation_count) {
+  if (f->IsFunction()) {
+    return f->AsFunctionOrDie();
+  }
+  if (!f->IsProc()) {
+    return absl::InternalError(
+        "Block equivalence checking not supported currently.");
+  }
+  if (!activation_count || *activation_count <= 0) {
+    return absl::InvalidArgumentError(
+        "a positive activation is required for proc equivalence checking");
+  }
+  XLS_ASSIGN_OR_RETURN(
+      Function * unrolled,
+      UnrollProcToFunction(f->AsProcOrDie(), *activation_count,
+                           /*include_state=*/false),
+      _ << "Unable to unroll: " << f->DumpIr());
+  return unrolled;
 }
 
 absl::StatusOr<std::vector<std::string>> CounterexampleParams(
@@ -225,10 +283,55 @@ class AssertAndCoverRemovalPass : public OptimizationFunctionBasePass {
   }
 };
 
+// Checks each of `functions` after the first against the first, all within
+// one equivalence session.
+absl::StatusOr<bool> CheckAllAgainstFirst(
+    absl::Span<const std::string_view> ir_paths,
+    absl::Span<FunctionBase* const> functions,
+    std::optional<int64_t> activation_count, absl::Duration timeout) {
+  for (FunctionBase* f : functions.subspan(1)) {
+    if (f->IsFunction() != functions[0]->IsFunction() ||
+        f->IsProc() != functions[0]->IsProc()) {
+      return absl::InvalidArgumentError(
+          "All inputs must be functions or all inputs must be procs");
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(Function * base,
+                       FunctionToCheck(functions[0], activation_count));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<solvers::z3::EquivalenceSession> session,
+      solvers::z3::EquivalenceSession::Create(base, timeout));
+  bool all_equivalent = true;
+  for (int64_t i = 1; i < functions.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Function * version,
+                         FunctionToCheck(functions[i], activation_count));
+    XLS_ASSIGN_OR_RETURN(solvers::z3::ProverResult result,
+                         session->TryProveEquivalence(version));
+    if (std::holds_alternative<solvers::z3::ProvenTrue>(result)) {
+      std::cout << ir_paths[i] << ": Verified equivalent\n";
+      continue;
+    }
+    all_equivalent = false;
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<std::string> params,
+        CounterexampleParams(functions[0],
+                             std::get<solvers::z3::ProvenFalse>(result)));
+    std::cout << ir_paths[i]
+              << ": Verified NOT equivalent; results differ for input: "
+              << absl::StrJoin(params, ", ") << "\n";
+  }
+  return all_equivalent;
+}
+
 absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
                               const std::string& entry,
                               std::optional<int64_t> activation_count,
-                              absl::Duration timeout) {
+                              absl::Duration timeout, bool portfolio,
+                              int64_t partition_output_bits) {
+  if (portfolio && partition_output_bits > 0) {
+    return absl::InvalidArgumentError(
+        "--portfolio and --partition_output_bits are mutually exclusive");
+  }
   std::vector<std::unique_ptr<Package>> packages;
   for (const auto ir_path : ir_paths) {
     XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
@@ -278,14 +381,29 @@ absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
   for (const auto& package : packages) {
     functions.push_back(*package->GetTop());
   }
+  if (functions.size() > 2) {
+    if (portfolio) {
+      return absl::InvalidArgumentError(
+          "--portfolio is only supported when checking two IR files");
+    }
+    if (partition_output_bits > 0) {
+      return absl::InvalidArgumentError(
+          "--partition_output_bits is only supported when checking two IR "
+          "files");
+    }
+    return CheckAllAgainstFirst(ir_paths, functions, activation_count, timeout);
+  }
+
   solvers::z3::ProverResult result;
   if (functions[0]->IsFunction()) {
     if (!functions[1]->IsFunction()) {
       return absl::InvalidArgumentError("Both inputs must be functions");
     }
-    XLS_ASSIGN_OR_RETURN(result, CheckFunctionEquivalence(
-                                     functions[0]->AsFunctionOrDie(),
-                                     functions[1]->AsFunctionOrDie(), timeout));
+    XLS_ASSIGN_OR_RETURN(
+        result, CheckFunctionEquivalence(functions[0]->AsFunctionOrDie(),
+                                         functions[1]->AsFunctionOrDie(),
+                                         timeout, portfolio,
+                                         partition_output_bits));
   } else if (functions[0]->IsProc()) {
     if (!functions[1]->IsProc()) {
       return absl::InvalidArgumentError("Both inputs must be procs");
@@ -297,7 +415,9 @@ absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
     XLS_ASSIGN_OR_RETURN(result,
                          CheckProcEquivalence(functions[0]->AsProcOrDie(),
                                               functions[1]->AsProcOrDie(),
-                                              *activation_count, timeout));
+                                              *activation_count, timeout,
+                                              portfolio,
+                                              partition_output_bits));
   } else {
     return absl::InternalError(
         "Block equivalence checking not supported currently.");
@@ -325,10 +445,13 @@ absl::StatusOr<bool> RealMain(const std::vector<std::string_view>& ir_paths,
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(kUsage, argc, argv);
-  QCHECK_EQ(positional_args.size(), 2) << "Two IR files must be specified!";
+  QCHECK_GE(positional_args.size(), 2)
+      << "At least two IR files must be specified!";
   auto result = xls::RealMain(positional_args, absl::GetFlag(FLAGS_top),
                               absl::GetFlag(FLAGS_activation_count),
-                              absl::GetFlag(FLAGS_timeout));
+                              absl::GetFlag(FLAGS_timeout),
+                              absl::GetFlag(FLAGS_portfolio),
+                              absl::GetFlag(FLAGS_partition_output_bits));
   if (!result.ok()) {
     return xls::ExitStatus(result.status());
   }
@@ -163,6 +163,25 @@ class CheckIrEquivalenceMainTest(absltest.TestCase):
     self.assertTrue(res)
     self.assertIn("Verified equivalent", msg)
 
+  def test_checks_many_functions_against_first(self):
+    res = subprocess.run(
+        [
+            _CHECK_EQUIV,
+            self.create_tempfile(content=ADD_IR).full_path,
+            self.create_tempfile(content=NOT_NOT_ADD_IR).full_path,
+            self.create_tempfile(content=NOT_ADD_IR).full_path,
+            self.create_tempfile(content=ADD_IR).full_path,
+        ],
+        check=False,
+        stdout=subprocess.PIPE,
+    )
+    self.assertNotEqual(res.returncode, 0)
+    lines = res.stdout.decode("utf8").splitlines()
+    self.assertLen(lines, 3)
+    self.assertIn(": Verified equivalent", lines[0])
+    self.assertIn(": Verified NOT equivalent", lines[1])
+    self.assertIn(": Verified equivalent", lines[2])
+
 
 if __name__ == "__main__":
   absltest.main()
@@ -0,0 +1,298 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compile-time benchmarks of the XLS toolchain on a fixed set of designs.
+//
+// Each design is benchmarked at every stage of the flow: the optimization pass
+// pipeline, scheduling, codegen, JIT compilation and (for functions) JIT
+// execution. Run with, e.g.:
+//
+//   bazel run -c opt //xls/dev_tools:compiler_benchmarks_test -- \
+//     --benchmark_filter=all --benchmark_out=/tmp/compiler_benchmarks.json
+//
+// The JSON written to --benchmark_out can be compared across builds with
+// google/benchmark's tools/compare.py to catch compile-time regressions.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/random_value.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_pipeline.h"
+#include "xls/passes/pass_base.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+namespace xls {
+namespace {
+
+struct Design {
+  // Name under which the design's benchmarks are reported.
+  std::string_view name;
+  // Path of the unoptimized IR relative to the runfiles root.
+  std::string_view ir_path;
+  int64_t pipeline_stages;
+  // Top to use instead of the package's own top, if any.
+  std::optional<std::string_view> top = std::nullopt;
+  // Procs are JIT compiled but not run; running them needs a design-specific
+  // testbench to drive their channels.
+  bool is_proc = false;
+};
+
+// Representative designs from examples/, modules/ and the floating point
+// standard library. Keep the data dependencies of the test in sync with this.
+constexpr Design kDesigns[] = {
+    {.name = "sha256",
+     .ir_path = "xls/examples/sha256.ir",
+     .pipeline_stages = 4},
+    {.name = "crc32",
+     .ir_path = "xls/examples/crc32/crc32.ir",
+     .pipeline_stages = 2},
+    {.name = "sobel_filter",
+     .ir_path = "xls/examples/sobel_filter_ir.ir",
+     .pipeline_stages = 4},
+    {.name = "aes_encrypt",
+     .ir_path = "xls/modules/aes/aes_encrypt.ir",
+     .pipeline_stages = 4},
+    {.name = "aes_ghash",
+     .ir_path = "xls/modules/aes/aes_ghash.ir",
+     .pipeline_stages = 4},
+    {.name = "rle_enc",
+     .ir_path = "xls/modules/rle/rle_enc.ir",
+     .pipeline_stages = 2,
+     .top = "__rle_enc__RunLengthEncoder32__RunLengthEncoder_0__2_32_next",
+     .is_proc = true},
+    {.name = "zstd_frame_header",
+     .ir_path = "xls/modules/zstd/frame_header_verilog.ir",
+     .pipeline_stages = 9},
+    {.name = "float32_add",
+     .ir_path = "xls/dslx/stdlib/float32_add.ir",
+     .pipeline_stages = 3},
+    {.name = "float32_mul",
+     .ir_path = "xls/dslx/stdlib/float32_mul.ir",
+     .pipeline_stages = 3},
+    {.name = "float32_fma",
+     .ir_path = "xls/dslx/stdlib/float32_fma.ir",
+     .pipeline_stages = 4},
+};
+
+absl::StatusOr<std::unique_ptr<Package>> ParseDesign(const Design& design,
+                                                     std::string_view ir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir));
+  if (design.top.has_value()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(*design.top));
+  }
+  return package;
+}
+
+absl::StatusOr<std::string> GetUnoptimizedIr(const Design& design) {
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                       GetXlsRunfilePath(design.ir_path));
+  return GetFileContents(path);
+}
+
+absl::Status RunOptimizationPipeline(Package* package) {
+  std::unique_ptr<OptimizationCompoundPass> pipeline =
+      CreateOptimizationPassPipeline();
+  PassResults results;
+  return pipeline->Run(package, OptimizationPassOptions(), &results).status();
+}
+
+// The optimized IR of each design, computed once and shared by the benchmarks
+// of the later stages.
+absl::StatusOr<std::string> GetOptimizedIr(const Design& design) {
+  static auto* const cache =
+      new absl::flat_hash_map<std::string_view, std::string>();
+  if (auto it = cache->find(design.name); it != cache->end()) {
+    return it->second;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir, GetUnoptimizedIr(design));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParseDesign(design, ir));
+  XLS_RETURN_IF_ERROR(RunOptimizationPipeline(package.get()));
+  return cache->emplace(design.name, package->DumpIr()).first->second;
+}
+
+SchedulingOptionsFlagsProto GetSchedulingOptions(const Design& design) {
+  SchedulingOptionsFlagsProto proto;
+  proto.set_delay_model("asap7");
+  proto.set_pipeline_stages(design.pipeline_stages);
+  return proto;
+}
+
+CodegenFlagsProto GetCodegenOptions() {
+  CodegenFlagsProto proto;
+  proto.set_generator(GENERATOR_KIND_PIPELINE);
+  proto.set_reset("rst");
+  proto.set_register_merge_strategy(
+      RegisterMergeStrategyProto::STRATEGY_DONT_MERGE);
+  return proto;
+}
+
+void BM_OptPipeline(benchmark::State& state, const Design& design) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, GetUnoptimizedIr(design));
+  for (auto _ : state) {
+    state.PauseTiming();
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             ParseDesign(design, ir));
+    state.ResumeTiming();
+    XLS_ASSERT_OK(RunOptimizationPipeline(package.get()));
+  }
+}
+
+void BM_Schedule(benchmark::State& state, const Design& design) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, GetOptimizedIr(design));
+  SchedulingOptionsFlagsProto scheduling_options =
+      GetSchedulingOptions(design);
+  CodegenFlagsProto codegen_options = GetCodegenOptions();
+  for (auto _ : state) {
+    state.PauseTiming();
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             ParseDesign(design, ir));
+    state.ResumeTiming();
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineScheduleOrGroup schedules,
+        Schedule(package.get(), scheduling_options, codegen_options,
+                 /*scheduling_time=*/nullptr));
+    benchmark::DoNotOptimize(schedules);
+  }
+}
+
+void BM_Codegen(benchmark::State& state, const Design& design) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, GetOptimizedIr(design));
+  SchedulingOptionsFlagsProto scheduling_options =
+      GetSchedulingOptions(design);
+  CodegenFlagsProto codegen_options = GetCodegenOptions();
+  for (auto _ : state) {
+    state.PauseTiming();
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             ParseDesign(design, ir));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineScheduleOrGroup schedules,
+        Schedule(package.get(), scheduling_options, codegen_options,
+                 /*scheduling_time=*/nullptr));
+    state.ResumeTiming();
+    XLS_ASSERT_OK_AND_ASSIGN(
+        CodegenResult result,
+        Codegen(package.get(), scheduling_options, codegen_options,
+                /*with_delay_model=*/true, &schedules,
+                /*codegen_time=*/nullptr));
+    benchmark::DoNotOptimize(result);
+  }
+}
+
+void BM_JitCompile(benchmark::State& state, const Design& design) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, GetOptimizedIr(design));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParseDesign(design, ir));
+  for (auto _ : state) {
+    if (!design.is_proc) {
+      XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+      XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                               FunctionJit::Create(f));
+      benchmark::DoNotOptimize(jit);
+    } else {
+      XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                               CreateJitSerialProcRuntime(package.get()));
+      benchmark::DoNotOptimize(runtime);
+    }
+  }
+}
+
+void BM_JitRun(benchmark::State& state, const Design& design) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir, GetOptimizedIr(design));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           ParseDesign(design, ir));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f));
+  std::mt19937_64 rng(0);
+  constexpr int64_t kInputCount = 64;
+  std::vector<std::vector<Value>> arg_sets;
+  arg_sets.reserve(kInputCount);
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    arg_sets.push_back(RandomFunctionArguments(f, rng));
+  }
+  for (auto _ : state) {
+    for (const std::vector<Value>& args : arg_sets) {
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+      benchmark::DoNotOptimize(result);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kInputCount);
+}
+
+bool RegisterCompilerBenchmarks() {
+  for (const Design& design : kDesigns) {
+    auto name = [&](std::string_view stage) {
+      return absl::StrCat(stage, "/", design.name);
+    };
+    benchmark::RegisterBenchmark(name("BM_OptPipeline"), BM_OptPipeline, design)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(name("BM_Schedule"), BM_Schedule, design)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(name("BM_Codegen"), BM_Codegen, design)
+        ->Unit(benchmark::kMillisecond);
+    benchmark::RegisterBenchmark(name("BM_JitCompile"), BM_JitCompile, design)
+        ->Unit(benchmark::kMillisecond);
+    if (!design.is_proc) {
+      benchmark::RegisterBenchmark(name("BM_JitRun"), BM_JitRun, design);
+    }
+  }
+  return true;
+}
+
+[[maybe_unused]] const bool kCompilerBenchmarksRegistered =
+    RegisterCompilerBenchmarks();
+
+// Guards the design list itself so that a renamed or broken input is caught by
+// regular test runs rather than the first time someone runs the benchmarks.
+TEST(CompilerBenchmarksTest, DesignsParse) {
+  for (const Design& design : kDesigns) {
+    SCOPED_TRACE(design.name);
+    XLS_ASSERT_OK_AND_ASSIGN(std::string ir, GetUnoptimizedIr(design));
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                             ParseDesign(design, ir));
+    EXPECT_TRUE(package->GetTop().has_value());
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -51,6 +51,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/binary_search.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/dev_tools/extract_segment.h"
@@ -209,6 +210,13 @@ ABSL_FLAG(int64_t, simplifications_between_tests, 1,
           "Number of simplifications to do in-between tests. Increasing this "
           "value may speed minimization for large designs, especially when "
           "--test_executable is long-running.");
+ABSL_FLAG(int64_t, parallelism, 1,
+          "Number of candidate simplifications to test concurrently. If "
+          "greater than one, minimization starts by bisecting over sets of "
+          "nodes, replacing each set with literals and testing several sets at "
+          "once (after trying to extract each proc, if "
+          "--can_extract_single_proc), before continuing with the usual "
+          "one-at-a-time random simplifications.");
 ABSL_FLAG(int64_t, failed_attempts_between_tests_limit, 16,
           "Failed simplification attempts between tests before we conclude we "
           "need to check our changes so far.");
@@ -1221,10 +1229,217 @@ absl::Status CleanUp(FunctionBase* f, bool can_remove_params) {
   return absl::OkStatus();
 }
 
+// Identifies a node by the names of the node and its function base, which are
+// preserved when the package is dumped and reparsed.
+struct NodeRef {
+  std::string function_base;
+  std::string node;
+};
+
+// Returns the nodes of `package` which bisection may replace with literals.
+std::vector<NodeRef> ReplaceableNodes(Package* package) {
+  std::vector<NodeRef> nodes;
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    if (fb->IsBlock()) {
+      continue;
+    }
+    for (Node* node : fb->nodes()) {
+      if (node->Is<Param>() || node->Is<Literal>() || node->Is<StateRead>() ||
+          OpIsSideEffecting(node->op()) || TypeHasToken(node->GetType())) {
+        continue;
+      }
+      bool is_return_value =
+          fb->IsFunction() && fb->AsFunctionOrDie()->return_value() == node;
+      if (node->users().empty() && !is_return_value) {
+        continue;
+      }
+      nodes.push_back(NodeRef{.function_base = fb->name(),
+                              .node = node->GetName()});
+    }
+  }
+  return nodes;
+}
+
+// Returns `ir_text` with each of `nodes` replaced by a zero literal, cleaned
+// up.
+absl::StatusOr<std::string> ReplaceNodesWithLiterals(
+    std::string_view ir_text, absl::Span<const NodeRef> nodes,
+    bool can_remove_params) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackage(ir_text));
+  for (const NodeRef& ref : nodes) {
+    XLS_ASSIGN_OR_RETURN(FunctionBase * fb,
+                         package->GetFunctionBaseByName(ref.function_base));
+    XLS_ASSIGN_OR_RETURN(Node * node, fb->GetNode(ref.node));
+    XLS_RETURN_IF_ERROR(
+        SafeReplaceUsesWithNew<Literal>(node, ZeroOfType(node->GetType()))
+            .status());
+  }
+  XLS_RETURN_IF_ERROR(CleanUp(package->GetTop().value(), can_remove_params));
+  if (absl::GetFlag(FLAGS_verify_ir)) {
+    XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  }
+  return package->DumpIr();
+}
+
+// Tests all of the candidates concurrently, returning whether each of them
+// still fails. Results are memoized in `test_cache`.
+absl::StatusOr<std::vector<bool>> StillFailsConcurrently(
+    absl::Span<const std::string> candidates,
+    const std::optional<std::vector<Value>>& inputs, ThreadPool& thread_pool,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  std::vector<absl::StatusOr<bool>> results(candidates.size(), false);
+  std::vector<int64_t> untested;
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    if (auto it = test_cache->find(candidates[i]); it != test_cache->end()) {
+      results[i] = it->second;
+    } else {
+      untested.push_back(i);
+    }
+  }
+  thread_pool.ParallelFor(untested.size(), /*grain=*/1, [&](int64_t u) {
+    const int64_t i = untested[u];
+    results[i] = StillFailsHelper(candidates[i], inputs);
+  });
+
+  std::vector<bool> still_fails;
+  still_fails.reserve(candidates.size());
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(bool result, results[i]);
+    (*test_cache)[candidates[i]] = result;
+    still_fails.push_back(result);
+  }
+  return still_fails;
+}
+
+// Tries extracting each proc of the network into a singleton proc, testing the
+// extractions concurrently. Returns the first extraction which still fails,
+// if any.
+absl::StatusOr<std::optional<std::string>> ExtractProcsConcurrently(
+    std::string_view knownf_ir_text,
+    const std::optional<std::vector<Value>>& inputs, ThreadPool& thread_pool,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackage(knownf_ir_text));
+  if (package->procs().size() <= 1) {
+    return std::nullopt;
+  }
+  std::vector<std::string> candidates;
+  std::vector<std::string> transforms;
+  for (const std::unique_ptr<Proc>& proc : package->procs()) {
+    std::string which_transform;
+    XLS_ASSIGN_OR_RETURN(SimplifiedIr simplification,
+                         ExtractSingleProc(proc.get(), &which_transform));
+    if (simplification.result == SimplificationResult::kDidChange) {
+      candidates.push_back(simplification.ir());
+      transforms.push_back(std::move(which_transform));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<bool> still_fails,
+      StillFailsConcurrently(candidates, inputs, thread_pool, test_cache));
+  for (int64_t i = 0; i < candidates.size(); ++i) {
+    if (still_fails[i]) {
+      LOG(INFO) << "=== " << transforms[i];
+      return candidates[i];
+    }
+  }
+  return std::nullopt;
+}
+
+// Minimizes the IR by bisecting over sets of nodes: the replaceable nodes are
+// split into chunks which are each replaced with literals, and the candidates
+// for as many chunks as there are threads are tested concurrently. The first
+// candidate which still fails is kept, and those which fail alongside it are
+// rebased onto it by replacing all of their chunks at once. When no chunk of a
+// given size can be replaced, the chunks are halved, down to single nodes.
+absl::StatusOr<std::string> BisectNodeSets(
+    std::string knownf_ir_text, const std::optional<std::vector<Value>>& inputs,
+    ThreadPool& thread_pool, bool can_remove_params,
+    absl::flat_hash_map<std::string, bool>* test_cache) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       ParsePackage(knownf_ir_text));
+  std::vector<NodeRef> nodes = ReplaceableNodes(package.get());
+  int64_t chunk_size = (nodes.size() + 1) / 2;
+  while (chunk_size > 0 && !nodes.empty()) {
+    LOG(INFO) << absl::StreamFormat(
+        "=== Bisection: %d nodes left, %d replaceable; chunk size %d",
+        package->GetNodeCount(), nodes.size(), chunk_size);
+    std::vector<absl::Span<const NodeRef>> chunks;
+    for (int64_t i = 0; i < nodes.size(); i += chunk_size) {
+      chunks.push_back(absl::MakeConstSpan(nodes).subspan(i, chunk_size));
+    }
+
+    std::optional<std::string> accepted;
+    for (int64_t start = 0; start < chunks.size() && !accepted.has_value();
+         start += thread_pool.num_threads()) {
+      int64_t end = std::min<int64_t>(start + thread_pool.num_threads(),
+                                      chunks.size());
+      std::vector<std::string> candidates;
+      for (int64_t i = start; i < end; ++i) {
+        absl::StatusOr<std::string> candidate = ReplaceNodesWithLiterals(
+            knownf_ir_text, chunks[i], can_remove_params);
+        if (!candidate.ok()) {
+          // Keep the slot so indices line up; it is never accepted since it is
+          // unchanged.
+          VLOG(1) << "Unable to replace chunk " << i << ": "
+                  << candidate.status();
+          candidates.push_back(knownf_ir_text);
+          continue;
+        }
+        candidates.push_back(*std::move(candidate));
+      }
+      XLS_ASSIGN_OR_RETURN(
+          std::vector<bool> still_fails,
+          StillFailsConcurrently(candidates, inputs, thread_pool, test_cache));
+      std::vector<int64_t> failing;
+      for (int64_t i = 0; i < candidates.size(); ++i) {
+        if (still_fails[i] && candidates[i] != knownf_ir_text) {
+          failing.push_back(i);
+        }
+      }
+      if (failing.empty()) {
+        continue;
+      }
+      accepted = candidates[failing.front()];
+      if (failing.size() > 1) {
+        std::vector<NodeRef> combined;
+        for (int64_t i : failing) {
+          absl::c_copy(chunks[start + i], std::back_inserter(combined));
+        }
+        absl::StatusOr<std::string> rebased = ReplaceNodesWithLiterals(
+            knownf_ir_text, combined, can_remove_params);
+        if (rebased.ok()) {
+          XLS_ASSIGN_OR_RETURN(bool rebased_fails,
+                               StillFails(*rebased, inputs, test_cache));
+          if (rebased_fails) {
+            LOG(INFO) << "=== Rebased " << failing.size()
+                      << " failing candidates";
+            accepted = *std::move(rebased);
+          }
+        }
+      }
+    }
+
+    if (!accepted.has_value()) {
+      chunk_size /= 2;
+      continue;
+    }
+    knownf_ir_text = *std::move(accepted);
+    XLS_ASSIGN_OR_RETURN(package, ParsePackage(knownf_ir_text));
+    nodes = ReplaceableNodes(package.get());
+    chunk_size = std::min<int64_t>(chunk_size, (nodes.size() + 1) / 2);
+  }
+  LOG(INFO) << "=== Bisection done; " << package->GetNodeCount()
+            << " nodes left";
+  return knownf_ir_text;
+}
+
 absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
                       const int64_t total_attempt_limit,
                       const int64_t simplifications_between_tests,
-                      const int64_t failed_attempts_between_tests_limit) {
+                      const int64_t failed_attempts_between_tests_limit,
+                      const int64_t parallelism) {
   XLS_ASSIGN_OR_RETURN(std::string knownf_ir_text, GetFileContents(path));
   // Cache of test results to avoid duplicate invocations of the
   // test_executable.
@@ -1272,6 +1487,22 @@ absl::Status RealMain(std::string_view path, const int64_t failed_attempt_limit,
     LOG(INFO) << "=== Done cleaning up initial garbage";
   }
 
+  if (parallelism > 1) {
+    ThreadPool thread_pool(parallelism);
+    if (absl::GetFlag(FLAGS_can_extract_single_proc)) {
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> extracted,
+                           ExtractProcsConcurrently(knownf_ir_text, inputs,
+                                                    thread_pool, &test_cache));
+      if (extracted.has_value()) {
+        knownf_ir_text = *std::move(extracted);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(
+        knownf_ir_text,
+        BisectNodeSets(knownf_ir_text, inputs, thread_pool, can_remove_params,
+                       &test_cache));
+  }
+
   // If so, we start simplifying via this seeded RNG.
   std::mt19937 rng;  // Default constructor uses deterministic seed.
 
@@ -1532,5 +1763,6 @@ int main(int argc, char** argv) {
       positional_arguments[0], absl::GetFlag(FLAGS_failed_attempt_limit),
       absl::GetFlag(FLAGS_total_attempt_limit),
       absl::GetFlag(FLAGS_simplifications_between_tests),
-      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit)));
+      absl::GetFlag(FLAGS_failed_attempts_between_tests_limit),
+      absl::GetFlag(FLAGS_parallelism)));
 }
@@ -347,6 +347,28 @@ class IrMinimizerMainTest(absltest.TestCase):
     self.assertIn('y: bits', minimized_ir)
     self.assertIn('ret myadd', minimized_ir)
 
+  def test_minimize_add_parallel(self):
+    ir_file = self.create_tempfile(content=ADD_IR)
+    test_sh_file = self.create_tempfile()
+    self._write_sh_script(
+        test_sh_file.full_path, ['/usr/bin/env grep myadd $1']
+    )
+    minimized_ir = subprocess.check_output(
+        [
+            IR_MINIMIZER_MAIN_PATH,
+            '--test_executable=' + test_sh_file.full_path,
+            '--can_remove_params=false',
+            '--parallelism=4',
+            ir_file.full_path,
+        ],
+        encoding='utf-8',
+    )
+    self._maybe_record_property('output', minimized_ir)
+    self.assertEqual(function_count(minimized_ir), 1)
+    self.assertIn('myadd', minimized_ir)
+    self.assertNotIn('mynot', minimized_ir)
+    self.assertNotIn('not(', minimized_ir)
+
   def test_minimize_add_remove_params(self):
     ir_file = self.create_tempfile(content=ADD_IR)
     test_sh_file = self.create_tempfile()
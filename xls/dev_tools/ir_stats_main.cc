@@ -12,10 +12,16 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-// Prints summary information about an IR file to the terminal.
+// Prints summary information about IR files to the terminal.
 // Output will be added as needs warrant, so feel free to make additions!
+//
+// Any number of IR files may be given. With --output_format=jsonl or csv they
+// are processed concurrently and one record per function is streamed to
+// stdout as each package finishes.
 
+#include <cstdint>
 #include <iostream>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,22 +30,32 @@
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/stats_writer.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 
 ABSL_FLAG(
     std::string, top, "",
     "The name of the top entity. Currently, only functions are supported. "
     "If set, restrict dumping to the given function. "
     "The name should not be mangled with the Package name.");
+ABSL_FLAG(std::string, output_format, "text",
+          "Either `text` for a human-readable summary, or `jsonl` or `csv` "
+          "for one record per function.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of IR files processed concurrently with --output_format "
+          "jsonl or csv. If not positive, one per available CPU.");
 
 namespace xls {
 
-static absl::Status RealMain(std::string_view ir_path,
-                             std::optional<std::string> restrict_fn) {
+static absl::Status PrintSummary(std::string_view ir_path,
+                                 std::optional<std::string> restrict_fn) {
   XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(contents));
 
@@ -56,16 +72,58 @@ static absl::Status RealMain(std::string_view ir_path,
   return absl::OkStatus();
 }
 
+static absl::StatusOr<std::vector<StatsRecord>> FunctionStats(
+    const std::string& ir_path, const std::optional<std::string>& restrict_fn) {
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(contents, ir_path));
+  std::vector<StatsRecord> records;
+  for (const auto& f : package->functions()) {
+    if (restrict_fn && restrict_fn.value() != f->name()) {
+      continue;
+    }
+    StatsRecord& record = records.emplace_back();
+    record.AddString("path", ir_path)
+        .AddString("package", package->name())
+        .AddString("function", f->name())
+        .AddString("signature", f->GetType()->ToString())
+        .AddInt("nodes", f->node_count());
+  }
+  return records;
+}
+
+static absl::Status RealMain(absl::Span<const std::string> ir_paths,
+                             std::optional<std::string> restrict_fn) {
+  if (absl::GetFlag(FLAGS_output_format) == "text") {
+    for (const std::string& ir_path : ir_paths) {
+      XLS_RETURN_IF_ERROR(PrintSummary(ir_path, restrict_fn));
+    }
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(
+      StatsFormat format,
+      StatsFormatFromString(absl::GetFlag(FLAGS_output_format)));
+  StatsWriter writer(std::cout, format);
+  return ComputeStatsInParallel(
+      ir_paths, absl::GetFlag(FLAGS_threads),
+      [&](const std::string& ir_path) {
+        return FunctionStats(ir_path, restrict_fn);
+      },
+      writer);
+}
+
 }  // namespace xls
 
 int main(int argc, char** argv) {
   std::vector<std::string_view> positional_args =
       xls::InitXls(argv[0], argc, argv);
-  QCHECK_EQ(positional_args.size(), 1);
+  QCHECK(!positional_args.empty()) << "Expected at least one IR file";
 
   std::optional<std::string> restrict_fn;
   if (!absl::GetFlag(FLAGS_top).empty()) {
     restrict_fn = absl::GetFlag(FLAGS_top);
   }
-  return xls::ExitStatus(xls::RealMain(positional_args[0], restrict_fn));
+  std::vector<std::string> ir_paths(positional_args.begin(),
+                                    positional_args.end());
+  return xls::ExitStatus(xls::RealMain(ir_paths, restrict_fn));
 }
@@ -0,0 +1,78 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/pipeline_metrics_trace.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+const char kUsage[] = R"(
+Converts a PipelineMetricsProto (as written by opt_main with
+--pipeline_metrics_proto or --pipeline_metrics_textproto) into a JSON trace in
+the Chrome trace event format for chrome://tracing, Perfetto or speedscope.
+
+  pipeline_metrics_to_trace_main --textproto metrics.textproto > trace.json
+)";
+
+ABSL_FLAG(bool, textproto, false,
+          "Whether the input is a text proto rather than a binary proto.");
+ABSL_FLAG(std::string, output_path, "-",
+          "Output path for the trace; '-' writes to stdout.");
+
+namespace xls {
+namespace {
+
+absl::Status RealMain(const std::filesystem::path& input_path, bool textproto,
+                      const std::string& output_path) {
+  PipelineMetricsProto metrics;
+  if (textproto) {
+    XLS_RETURN_IF_ERROR(ParseTextProtoFile(input_path, &metrics));
+  } else {
+    XLS_RETURN_IF_ERROR(ParseProtobinFile(input_path, &metrics));
+  }
+  XLS_ASSIGN_OR_RETURN(std::string trace,
+                       PipelineMetricsToChromeTrace(metrics));
+  if (output_path == "-") {
+    std::cout << trace;
+    return absl::OkStatus();
+  }
+  return SetFileContents(output_path, trace);
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << "Expected invocation: " << argv[0] << " <metrics_file>";
+  }
+
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0],
+                                       absl::GetFlag(FLAGS_textproto),
+                                       absl::GetFlag(FLAGS_output_path)));
+}
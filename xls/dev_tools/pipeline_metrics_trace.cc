@@ -0,0 +1,138 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/pipeline_metrics_trace.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "google/protobuf/duration.pb.h"
+#include "absl/container/btree_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "nlohmann/json.hpp"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+namespace {
+
+// All events are in a single process.
+constexpr int64_t kPid = 0;
+// The thread which ran the pipeline.
+constexpr int64_t kPipelineThread = 0;
+
+double ToMicroseconds(const google::protobuf::Duration& duration) {
+  return static_cast<double>(duration.seconds()) * 1e6 +
+         static_cast<double>(duration.nanos()) / 1e3;
+}
+
+nlohmann::json CompleteEvent(std::string_view name, std::string_view category,
+                             const google::protobuf::Duration& start,
+                             const google::protobuf::Duration& duration,
+                             int64_t thread) {
+  return nlohmann::json{{"name", name},
+                        {"cat", category},
+                        {"ph", "X"},
+                        {"ts", ToMicroseconds(start)},
+                        {"dur", ToMicroseconds(duration)},
+                        {"pid", kPid},
+                        {"tid", thread}};
+}
+
+nlohmann::json RssEvent(double timestamp, int64_t rss_bytes) {
+  return nlohmann::json{{"name", "rss"},
+                        {"ph", "C"},
+                        {"ts", timestamp},
+                        {"pid", kPid},
+                        {"args", {{"rss_bytes", rss_bytes}}}};
+}
+
+nlohmann::json ThreadNameEvent(int64_t thread) {
+  std::string name = thread == kPipelineThread
+                         ? "pipeline"
+                         : absl::StrCat("function base worker ", thread);
+  return nlohmann::json{{"name", "thread_name"},
+                        {"ph", "M"},
+                        {"pid", kPid},
+                        {"tid", thread},
+                        {"args", {{"name", name}}}};
+}
+
+}  // namespace
+
+absl::StatusOr<std::string> PipelineMetricsToChromeTrace(
+    const PipelineMetricsProto& metrics) {
+  if (metrics.pass_runs().empty()) {
+    return absl::InvalidArgumentError(
+        "Pipeline metrics contain no pass runs; they must be recorded by a "
+        "pipeline with metrics enabled.");
+  }
+  nlohmann::json events = nlohmann::json::array();
+  absl::btree_set<int64_t> threads = {kPipelineThread};
+  for (const PassRunProto& run : metrics.pass_runs()) {
+    nlohmann::json event = CompleteEvent(
+        run.pass_name(), run.compound() ? "compound_pass" : "pass",
+        run.start_time(), run.duration(), kPipelineThread);
+    nlohmann::json args = {
+        {"changed", run.changed()},
+        {"analysis_us", ToMicroseconds(run.analysis_duration())},
+        {"nodes_added", run.metrics().nodes_added()},
+        {"nodes_removed", run.metrics().nodes_removed()},
+        {"nodes_replaced", run.metrics().nodes_replaced()},
+        {"operands_replaced", run.metrics().operands_replaced()}};
+    if (run.has_rss_before_bytes() && run.has_rss_after_bytes()) {
+      args["rss_delta_bytes"] = run.rss_after_bytes() - run.rss_before_bytes();
+    }
+    if (run.has_peak_rss_bytes()) {
+      args["peak_rss_bytes"] = run.peak_rss_bytes();
+    }
+    event["args"] = std::move(args);
+    events.push_back(std::move(event));
+
+    // Compound passes only repeat the samples of the passes they contain.
+    if (!run.compound()) {
+      double start = ToMicroseconds(run.start_time());
+      if (run.has_rss_before_bytes()) {
+        events.push_back(RssEvent(start, run.rss_before_bytes()));
+      }
+      if (run.has_rss_after_bytes()) {
+        events.push_back(RssEvent(start + ToMicroseconds(run.duration()),
+                                  run.rss_after_bytes()));
+      }
+    }
+
+    for (const FunctionBaseRunProto& fb_run : run.function_base_runs()) {
+      nlohmann::json fb_event = CompleteEvent(
+          fb_run.function_base(), "function_base", fb_run.start_time(),
+          fb_run.duration(), fb_run.thread());
+      fb_event["args"] = {
+          {"pass", run.pass_name()},
+          {"changed", fb_run.changed()},
+          {"analysis_us", ToMicroseconds(fb_run.analysis_duration())}};
+      events.push_back(std::move(fb_event));
+      threads.insert(fb_run.thread());
+    }
+  }
+  for (int64_t thread : threads) {
+    events.push_back(ThreadNameEvent(thread));
+  }
+  nlohmann::json trace = {{"traceEvents", std::move(events)},
+                          {"displayTimeUnit", "ms"}};
+  return trace.dump();
+}
+
+}  // namespace xls
@@ -0,0 +1,41 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DEV_TOOLS_PIPELINE_METRICS_TRACE_H_
+#define XLS_DEV_TOOLS_PIPELINE_METRICS_TRACE_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+
+// Converts the pass runs recorded in `metrics` into a JSON trace in the Chrome
+// trace event format, which can be loaded by chrome://tracing, Perfetto or
+// speedscope to get a flame graph of the pipeline.
+//
+// Each pass run becomes a complete event on the pipeline thread; events of
+// nested passes fall within the event of their compound pass. The runs of a
+// pass on individual FunctionBases become events on the thread which ran
+// them. The resident set size is emitted as a counter.
+//
+// Returns an error if `metrics` contains no pass runs, e.g., because it was
+// produced by an older version of the pipeline.
+absl::StatusOr<std::string> PipelineMetricsToChromeTrace(
+    const PipelineMetricsProto& metrics);
+
+}  // namespace xls
+
+#endif  // XLS_DEV_TOOLS_PIPELINE_METRICS_TRACE_H_
@@ -0,0 +1,119 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/pipeline_metrics_trace.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "google/protobuf/text_format.h"
+#include "nlohmann/json.hpp"
+#include "xls/common/status/matchers.h"
+#include "xls/passes/pass_metrics.pb.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(PipelineMetricsTraceTest, EmitsEventPerRun) {
+  PipelineMetricsProto metrics;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      R"pb(
+        pass_runs {
+          pass_name: "fixedpoint"
+          compound: true
+          start_time { seconds: 0 }
+          duration { nanos: 5000000 }
+          changed: true
+        }
+        pass_runs {
+          pass_name: "dce"
+          start_time { nanos: 1000000 }
+          duration { nanos: 2000000 }
+          changed: true
+          metrics { nodes_removed: 3 }
+          rss_before_bytes: 1000
+          rss_after_bytes: 1500
+          function_base_runs {
+            function_base: "f"
+            start_time { nanos: 1000000 }
+            duration { nanos: 1000000 }
+            changed: true
+            thread: 0
+          }
+          function_base_runs {
+            function_base: "g"
+            start_time { nanos: 1000000 }
+            duration { nanos: 1500000 }
+            thread: 2
+          }
+        }
+      )pb",
+      &metrics));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string trace_text,
+                           PipelineMetricsToChromeTrace(metrics));
+  nlohmann::json trace = nlohmann::json::parse(trace_text);
+  const nlohmann::json& events = trace["traceEvents"];
+
+  // Two passes, two function bases, two RSS samples and two thread names.
+  ASSERT_EQ(events.size(), 8);
+  EXPECT_EQ(events[0]["name"], "fixedpoint");
+  EXPECT_EQ(events[0]["cat"], "compound_pass");
+  EXPECT_EQ(events[0]["ph"], "X");
+  EXPECT_EQ(events[0]["dur"], 5000.0);
+
+  EXPECT_EQ(events[1]["name"], "dce");
+  EXPECT_EQ(events[1]["ts"], 1000.0);
+  EXPECT_EQ(events[1]["dur"], 2000.0);
+  EXPECT_EQ(events[1]["tid"], 0);
+  EXPECT_EQ(events[1]["args"]["nodes_removed"], 3);
+  EXPECT_EQ(events[1]["args"]["rss_delta_bytes"], 500);
+
+  EXPECT_EQ(events[2]["ph"], "C");
+  EXPECT_EQ(events[2]["args"]["rss_bytes"], 1000);
+  EXPECT_EQ(events[3]["ts"], 3000.0);
+  EXPECT_EQ(events[3]["args"]["rss_bytes"], 1500);
+
+  EXPECT_EQ(events[4]["name"], "f");
+  EXPECT_EQ(events[4]["args"]["pass"], "dce");
+  EXPECT_EQ(events[5]["name"], "g");
+  EXPECT_EQ(events[5]["tid"], 2);
+
+  EXPECT_EQ(events[6]["ph"], "M");
+  EXPECT_EQ(events[6]["args"]["name"], "pipeline");
+  EXPECT_EQ(events[7]["tid"], 2);
+}
+
+TEST(PipelineMetricsTraceTest, RequiresPassRuns) {
+  PipelineMetricsProto metrics;
+  ASSERT_TRUE(google::protobuf::TextFormat::ParseFromString(
+      R"pb(
+        pass_results {
+          key: "dce"
+          value { run_count: 1 }
+        }
+      )pb",
+      &metrics));
+  EXPECT_THAT(PipelineMetricsToChromeTrace(metrics),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("no pass runs")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,187 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/stats_writer.h"
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "nlohmann/json.hpp"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+
+namespace xls {
+namespace {
+
+nlohmann::ordered_json ToJson(const StatsRecord& record) {
+  nlohmann::ordered_json json = nlohmann::ordered_json::object();
+  for (const auto& [name, value] : record.fields()) {
+    std::visit([&, &name = name](const auto& v) { json[name] = v; }, value);
+  }
+  return json;
+}
+
+// Quotes `field` if it contains a character with a meaning in CSV.
+std::string CsvField(std::string_view field) {
+  if (field.find_first_of(",\"\n\r") == std::string_view::npos) {
+    return std::string(field);
+  }
+  return absl::StrCat("\"", absl::StrReplaceAll(field, {{"\"", "\"\""}}), "\"");
+}
+
+std::string CsvValue(const StatsRecord::Value& value) {
+  return std::visit(
+      [](const auto& v) -> std::string {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, std::string>) {
+          return CsvField(v);
+        } else if constexpr (std::is_same_v<T, bool>) {
+          return v ? "true" : "false";
+        } else {
+          return absl::StrCat(v);
+        }
+      },
+      value);
+}
+
+}  // namespace
+
+StatsRecord& StatsRecord::AddInt(std::string_view name, int64_t value) {
+  fields_.emplace_back(std::string(name), value);
+  return *this;
+}
+
+StatsRecord& StatsRecord::AddDouble(std::string_view name, double value) {
+  fields_.emplace_back(std::string(name), value);
+  return *this;
+}
+
+StatsRecord& StatsRecord::AddBool(std::string_view name, bool value) {
+  fields_.emplace_back(std::string(name), value);
+  return *this;
+}
+
+StatsRecord& StatsRecord::AddString(std::string_view name,
+                                    std::string_view value) {
+  fields_.emplace_back(std::string(name), std::string(value));
+  return *this;
+}
+
+absl::StatusOr<StatsFormat> StatsFormatFromString(std::string_view s) {
+  if (s == "jsonl") {
+    return StatsFormat::kJsonLines;
+  }
+  if (s == "csv") {
+    return StatsFormat::kCsv;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unknown stats format `%s`; expected jsonl or csv", s));
+}
+
+absl::Status StatsWriter::Write(const StatsRecord& record) {
+  std::string line;
+  if (format_ == StatsFormat::kJsonLines) {
+    line = ToJson(record).dump();
+  } else {
+    std::vector<std::string> values;
+    values.reserve(record.fields().size());
+    for (const auto& [_, value] : record.fields()) {
+      values.push_back(CsvValue(value));
+    }
+    line = absl::StrJoin(values, ",");
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (format_ == StatsFormat::kCsv) {
+    std::vector<std::string> columns;
+    columns.reserve(record.fields().size());
+    for (const auto& [name, _] : record.fields()) {
+      columns.push_back(name);
+    }
+    if (!columns_.has_value()) {
+      std::vector<std::string> header;
+      header.reserve(columns.size());
+      for (const std::string& column : columns) {
+        header.push_back(CsvField(column));
+      }
+      os_ << absl::StrJoin(header, ",") << '\n';
+      columns_ = std::move(columns);
+    } else if (columns != *columns_) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Record columns [%s] do not match the CSV header [%s]",
+          absl::StrJoin(columns, ", "), absl::StrJoin(*columns_, ", ")));
+    }
+  }
+  os_ << line << '\n';
+  os_.flush();
+  ++records_written_;
+  return absl::OkStatus();
+}
+
+int64_t StatsWriter::records_written() const {
+  absl::MutexLock lock(&mutex_);
+  return records_written_;
+}
+
+absl::Status ComputeStatsInParallel(
+    absl::Span<const std::string> paths, int64_t threads,
+    const std::function<absl::StatusOr<std::vector<StatsRecord>>(
+        const std::string& path)>& compute,
+    StatsWriter& writer) {
+  absl::Mutex mutex;
+  absl::Status first_error;
+  auto process = [&](const std::string& path) {
+    absl::Status status = [&]() -> absl::Status {
+      XLS_ASSIGN_OR_RETURN(std::vector<StatsRecord> records, compute(path));
+      for (const StatsRecord& record : records) {
+        XLS_RETURN_IF_ERROR(writer.Write(record));
+      }
+      return absl::OkStatus();
+    }();
+    if (!status.ok()) {
+      LOG(ERROR) << path << ": " << status;
+      absl::MutexLock lock(&mutex);
+      first_error.Update(status);
+    }
+  };
+  {
+    // Each task reads its file when it starts, so at most `threads` packages
+    // are in memory at once.
+    ThreadPool pool(threads);
+    for (const std::string& path : paths) {
+      pool.Schedule([&process, &path] { process(path); });
+    }
+    pool.WaitForIdle();
+  }
+  return first_error;
+}
+
+}  // namespace xls
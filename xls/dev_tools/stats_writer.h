@@ -0,0 +1,101 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DEV_TOOLS_STATS_WRITER_H_
+#define XLS_DEV_TOOLS_STATS_WRITER_H_
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+// One row of statistics: an ordered list of named values.
+class StatsRecord {
+ public:
+  using Value = std::variant<int64_t, double, bool, std::string>;
+
+  StatsRecord& AddInt(std::string_view name, int64_t value);
+  StatsRecord& AddDouble(std::string_view name, double value);
+  StatsRecord& AddBool(std::string_view name, bool value);
+  StatsRecord& AddString(std::string_view name, std::string_view value);
+
+  const std::vector<std::pair<std::string, Value>>& fields() const {
+    return fields_;
+  }
+
+ private:
+  std::vector<std::pair<std::string, Value>> fields_;
+};
+
+enum class StatsFormat {
+  // One JSON object per line.
+  kJsonLines,
+  // Comma-separated values with a header line naming the columns.
+  kCsv,
+};
+
+// Parses "jsonl" or "csv".
+absl::StatusOr<StatsFormat> StatsFormatFromString(std::string_view s);
+
+// Writes records to a stream as they are produced, flushing after each
+// record so partial results are usable if a long run is interrupted. Write
+// may be called concurrently from several threads.
+//
+// In CSV format the columns are those of the first record written; every
+// later record must have the same field names in the same order.
+class StatsWriter {
+ public:
+  StatsWriter(std::ostream& os, StatsFormat format)
+      : os_(os), format_(format) {}
+
+  absl::Status Write(const StatsRecord& record);
+
+  int64_t records_written() const;
+
+ private:
+  std::ostream& os_ ABSL_GUARDED_BY(mutex_);
+  const StatsFormat format_;
+  mutable absl::Mutex mutex_;
+  std::optional<std::vector<std::string>> columns_ ABSL_GUARDED_BY(mutex_);
+  int64_t records_written_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Calls `compute` on each of `paths` using at most `threads` concurrent
+// workers (AvailableCPUs() if `threads` is not positive) and writes the
+// records it returns to `writer` as they complete, so the order of the output
+// is the order in which files finish. A failure on one file does not stop the
+// others; it is logged and the first such error is returned once all files
+// have been processed.
+absl::Status ComputeStatsInParallel(
+    absl::Span<const std::string> paths, int64_t threads,
+    const std::function<absl::StatusOr<std::vector<StatsRecord>>(
+        const std::string& path)>& compute,
+    StatsWriter& writer);
+
+}  // namespace xls
+
+#endif  // XLS_DEV_TOOLS_STATS_WRITER_H_
@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dev_tools/stats_writer.h"
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAreArray;
+
+StatsRecord MakeRecord(std::string_view name, int64_t nodes) {
+  StatsRecord record;
+  record.AddString("name", name).AddInt("nodes", nodes);
+  return record;
+}
+
+TEST(StatsWriterTest, JsonLines) {
+  std::stringstream os;
+  StatsWriter writer(os, StatsFormat::kJsonLines);
+  StatsRecord record = MakeRecord("f", 3);
+  record.AddDouble("time_ms", 1.5).AddBool("truncated", false);
+  XLS_ASSERT_OK(writer.Write(record));
+  XLS_ASSERT_OK(writer.Write(MakeRecord("g \"quoted\"", 4)));
+  EXPECT_EQ(os.str(),
+            "{\"name\":\"f\",\"nodes\":3,\"time_ms\":1.5,\"truncated\":false}\n"
+            "{\"name\":\"g \\\"quoted\\\"\",\"nodes\":4}\n");
+  EXPECT_EQ(writer.records_written(), 2);
+}
+
+TEST(StatsWriterTest, Csv) {
+  std::stringstream os;
+  StatsWriter writer(os, StatsFormat::kCsv);
+  XLS_ASSERT_OK(writer.Write(MakeRecord("f", 3)));
+  XLS_ASSERT_OK(writer.Write(MakeRecord("a,b", 4)));
+  EXPECT_EQ(os.str(), "name,nodes\nf,3\n\"a,b\",4\n");
+
+  StatsRecord other;
+  other.AddString("name", "h");
+  EXPECT_THAT(writer.Write(other),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("do not match the CSV header")));
+}
+
+TEST(StatsWriterTest, FormatFromString) {
+  EXPECT_THAT(StatsFormatFromString("jsonl"),
+              IsOkAndHolds(StatsFormat::kJsonLines));
+  EXPECT_THAT(StatsFormatFromString("csv"), IsOkAndHolds(StatsFormat::kCsv));
+  EXPECT_THAT(StatsFormatFromString("xml"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(StatsWriterTest, ComputeStatsInParallel) {
+  std::vector<std::string> paths;
+  std::vector<std::string> expected;
+  for (int64_t i = 0; i < 32; ++i) {
+    paths.push_back(absl::StrCat("pkg", i));
+    if (i != 7) {
+      expected.push_back(absl::StrCat("{\"name\":\"pkg", i, "\",\"nodes\":", i,
+                                      "}"));
+    }
+  }
+  std::stringstream os;
+  StatsWriter writer(os, StatsFormat::kJsonLines);
+  absl::Status status = ComputeStatsInParallel(
+      paths, /*threads=*/4,
+      [](const std::string& path)
+          -> absl::StatusOr<std::vector<StatsRecord>> {
+        int64_t index = std::stoll(path.substr(3));
+        if (index == 7) {
+          return absl::NotFoundError("no such package");
+        }
+        return std::vector<StatsRecord>{MakeRecord(path, index)};
+      },
+      writer);
+  EXPECT_THAT(status, StatusIs(absl::StatusCode::kNotFound));
+  std::vector<std::string> lines =
+      absl::StrSplit(os.str(), '\n', absl::SkipEmpty());
+  EXPECT_THAT(lines, UnorderedElementsAreArray(expected));
+}
+
+}  // namespace
+}  // namespace xls
@@ -111,6 +111,9 @@ absl::StatusOr<Bytecode::Op> OpFromString(std::string_view s) {
   if (s == "tuple_index") {
     return Bytecode::Op::kTupleIndex;
   }
+  if (s == "tuple_index_chain") {
+    return Bytecode::Op::kTupleIndexChain;
+  }
   if (s == "invert") {
     return Bytecode::Op::kInvert;
   }
@@ -129,9 +132,15 @@ absl::StatusOr<Bytecode::Op> OpFromString(std::string_view s) {
   if (s == "load") {
     return Bytecode::Op::kLoad;
   }
+  if (s == "load_load_binop") {
+    return Bytecode::Op::kLoadLoadBinop;
+  }
   if (s == "literal") {
     return Bytecode::Op::kLiteral;
   }
+  if (s == "literal_compare_jump_rel_if") {
+    return Bytecode::Op::kLiteralCompareJumpRelIf;
+  }
   if (s == "logical_and") {
     return Bytecode::Op::kLogicalAnd;
   }
@@ -256,6 +265,8 @@ std::string OpToString(Bytecode::Op op) {
       return "index";
     case Bytecode::Op::kTupleIndex:
       return "tuple_index";
+    case Bytecode::Op::kTupleIndexChain:
+      return "tuple_index_chain";
     case Bytecode::Op::kInvert:
       return "invert";
     case Bytecode::Op::kJumpRel:
@@ -268,10 +279,14 @@ std::string OpToString(Bytecode::Op op) {
       return "le";
     case Bytecode::Op::kLoad:
       return "load";
+    case Bytecode::Op::kLoadLoadBinop:
+      return "load_load_binop";
     case Bytecode::Op::kLt:
       return "lt";
     case Bytecode::Op::kLiteral:
       return "literal";
+    case Bytecode::Op::kLiteralCompareJumpRelIf:
+      return "literal_compare_jump_rel_if";
     case Bytecode::Op::kLogicalAnd:
       return "logical_and";
     case Bytecode::Op::kLogicalOr:
@@ -553,6 +568,12 @@ absl::StatusOr<const Bytecode::ChannelData*> Bytecode::channel_data() const {
   return &std::get<ChannelData>(data_.value());
 }
 
+absl::StatusOr<const Bytecode::FusedData*> Bytecode::fused_data() const {
+  XLS_RET_CHECK(data_.has_value());
+  XLS_RET_CHECK(std::holds_alternative<FusedData>(data_.value()));
+  return &std::get<FusedData>(data_.value());
+}
+
 absl::StatusOr<Bytecode::SlotIndex> Bytecode::slot_index() const {
   XLS_RET_CHECK(data_.has_value());
   XLS_RET_CHECK(std::holds_alternative<SlotIndex>(data_.value()));
@@ -607,6 +628,27 @@ std::string Bytecode::ToString(const FileTable& file_table,
                            loc_string);
   }
 
+  if (op_ == Op::kLiteralCompareJumpRelIf) {
+    CHECK(std::holds_alternative<FusedData>(data_.value()));
+    const FusedData& fused_data = std::get<FusedData>(data_.value());
+    return absl::StrFormat("%s %s %s %+d%s", OpToString(op_),
+                           OpToString(fused_data.op),
+                           fused_data.literals.at(0).ToString(),
+                           fused_data.jump_target.value(), loc_string);
+  }
+
+  if (op_ == Op::kTupleIndexChain) {
+    CHECK(std::holds_alternative<FusedData>(data_.value()));
+    const FusedData& fused_data = std::get<FusedData>(data_.value());
+    return absl::StrFormat(
+        "%s %s%s", OpToString(op_),
+        absl::StrJoin(fused_data.literals, " ",
+                      [](std::string* out, const InterpValue& v) {
+                        absl::StrAppend(out, v.ToString());
+                      }),
+        loc_string);
+  }
+
   if (data_.has_value()) {
     struct DataVisitor {
       std::string operator()(const std::unique_ptr<Type>& v) {
@@ -664,6 +706,17 @@ std::string Bytecode::ToString(const FileTable& file_table,
 
       std::string operator()(const MatchArmItem& v) { return v.ToString(); }
 
+      std::string operator()(const FusedData& fused_data) {
+        std::vector<std::string> pieces = {OpToString(fused_data.op)};
+        for (const SlotIndex& slot : fused_data.slots) {
+          pieces.push_back(absl::StrCat(slot.value()));
+        }
+        for (const InterpValue& literal : fused_data.literals) {
+          pieces.push_back(literal.ToString());
+        }
+        return absl::StrJoin(pieces, " ");
+      }
+
       std::string operator()(const SpawnData& spawn_data) {
         // TODO: https://github.com/google/xls/issues/608 - source the rest
         // of the data needed to print SpawnData, including the callee
@@ -781,6 +834,11 @@ std::vector<Bytecode> BytecodeFunction::CloneBytecodes() const {
         bytecodes.emplace_back(
             Bytecode(bc.source_span(), bc.op(),
                      std::get<InterpValue>(bc.data().value())));
+      } else if (std::holds_alternative<Bytecode::FusedData>(
+                     bc.data().value())) {
+        bytecodes.emplace_back(
+            Bytecode(bc.source_span(), bc.op(),
+                     std::get<Bytecode::FusedData>(bc.data().value())));
       } else {
         const std::unique_ptr<Type>& type =
             std::get<std::unique_ptr<Type>>(bc.data().value());
@@ -96,6 +96,10 @@ class Bytecode {
     kIndex,
     // Same as kIndex but runtime checks that the value TOS1 is a tuple.
     kTupleIndex,
+    // Superinstruction for `literal i0; tuple_index; literal i1; tuple_index;
+    // ...`: successively indexes the tuple at TOS0 by the literals of the
+    // `FusedData` data member.
+    kTupleIndexChain,
     // Inverts the bits of TOS0.
     kInvert,
     // Indicates a jump destination PC for control flow integrity checking.
@@ -110,9 +114,17 @@ class Bytecode {
     kLe,
     // Pushes the literal in the data argument onto the stack.
     kLiteral,
+    // Superinstruction for `literal x; <cmp>; jump_rel_if`: pops TOS0, compares
+    // it to the literal of the `FusedData` data member with the comparison op
+    // given there and jumps (relative) if the result is true.
+    kLiteralCompareJumpRelIf,
     // Loads the value from the data-arg-specified slot and pushes it onto the
     // stack.
     kLoad,
+    // Superinstruction for `load a; load b; <binop>`: applies the binop of the
+    // `FusedData` data member to the values of its two slots, pushing the
+    // result.
+    kLoadLoadBinop,
     // Performs a logical AND of TOS1 and TOS0.
     kLogicalAnd,
     // Performs a logical OR of TOS1 and TOS0.
@@ -347,6 +359,17 @@ class Bytecode {
     std::vector<ValueFormatDescriptor> value_fmt_descs_;
   };
 
+  // Operands of a superinstruction, i.e. a single bytecode standing in for a
+  // common sequence of simpler ones (see bytecode_peephole.h). Which fields are
+  // used depends on the superinstruction's op.
+  struct FusedData {
+    // The op the sequence applies, e.g. the binop of a kLoadLoadBinop.
+    Op op;
+    std::vector<SlotIndex> slots;
+    std::vector<InterpValue> literals;
+    JumpTarget jump_target;
+  };
+
   // Information necessary for channel operations.
   class ChannelData {
    public:
@@ -375,7 +398,7 @@ class Bytecode {
 
   using Data = std::variant<InterpValue, JumpTarget, NumElements, SlotIndex,
                             std::unique_ptr<Type>, InvocationData, MatchArmItem,
-                            SpawnData, TraceData, ChannelData>;
+                            SpawnData, TraceData, ChannelData, FusedData>;
 
   static Bytecode MakeDup(Span span);
   static Bytecode MakeIndex(Span span);
@@ -434,6 +457,7 @@ class Bytecode {
   absl::StatusOr<const SpawnData*> spawn_data() const;
   absl::StatusOr<const TraceData*> trace_data() const;
   absl::StatusOr<const ChannelData*> channel_data() const;
+  absl::StatusOr<const FusedData*> fused_data() const;
   absl::StatusOr<const Type*> type_data() const;
   absl::StatusOr<InterpValue> value_data() const;
 
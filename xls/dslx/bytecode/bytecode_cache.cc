@@ -20,6 +20,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/bytecode/bytecode.h"
@@ -36,14 +37,22 @@ absl::StatusOr<BytecodeFunction*> BytecodeCache::GetOrCreateBytecodeFunction(
     const std::optional<ParametricEnv>& caller_bindings) {
   XLS_RET_CHECK(type_info != nullptr);
   Key key = std::make_tuple(&f, type_info, caller_bindings);
-  if (!cache_.contains(key)) {
-    XLS_ASSIGN_OR_RETURN(
-        std::unique_ptr<BytecodeFunction> bf,
-        BytecodeEmitter::Emit(&import_data, type_info, f, caller_bindings));
-    cache_.emplace(key, std::move(bf));
+  {
+    absl::MutexLock lock(&mutex_);
+    if (auto it = cache_.find(key); it != cache_.end()) {
+      return it->second.get();
+    }
   }
 
-  return cache_.at(key).get();
+  // Emit outside the lock so distinct functions can be emitted concurrently.
+  // If another thread emitted the same function meanwhile, its result is kept.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BytecodeFunction> bf,
+      BytecodeEmitter::Emit(&import_data, type_info, f, caller_bindings,
+                            emitter_options_));
+  absl::MutexLock lock(&mutex_);
+  auto [it, inserted] = cache_.try_emplace(key, std::move(bf));
+  return it->second.get();
 }
 
 }  // namespace xls::dslx
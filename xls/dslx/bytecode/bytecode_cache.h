@@ -18,10 +18,13 @@
 #include <optional>
 #include <tuple>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
+#include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/parametric_env.h"
@@ -29,9 +32,13 @@
 
 namespace xls::dslx {
 
+// Thread-safe, as constexpr evaluation may happen while typechecking several
+// modules concurrently.
 class BytecodeCache : public BytecodeCacheInterface {
  public:
-  BytecodeCache() = default;
+  // Functions are emitted with `emitter_options`.
+  explicit BytecodeCache(BytecodeEmitterOptions emitter_options = {})
+      : emitter_options_(emitter_options) {}
 
   absl::StatusOr<BytecodeFunction*> GetOrCreateBytecodeFunction(
       ImportData& import_data, const Function& f, const TypeInfo* type_info,
@@ -41,7 +48,10 @@ class BytecodeCache : public BytecodeCacheInterface {
   using Key = std::tuple<const Function*, const TypeInfo*,
                          std::optional<ParametricEnv>>;
 
-  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_;
+  const BytecodeEmitterOptions emitter_options_;
+  absl::Mutex mutex_;
+  absl::flat_hash_map<Key, std::unique_ptr<BytecodeFunction>> cache_
+      ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls::dslx
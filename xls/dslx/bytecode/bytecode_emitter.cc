@@ -42,6 +42,7 @@
 #include "xls/common/symbolized_stacktrace.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/bytecode/bytecode_peephole.h"
 #include "xls/dslx/dslx_builtins.h"
 #include "xls/dslx/errors.h"
 #include "xls/dslx/frontend/ast.h"
@@ -200,6 +201,7 @@ BytecodeEmitter::EmitInternal(
   }
   XLS_RETURN_IF_ERROR(emitter.Init(f));
   XLS_RETURN_IF_ERROR(f.body()->AcceptExpr(&emitter));
+  XLS_RETURN_IF_ERROR(emitter.Finish());
 
   return BytecodeFunction::Create(f.owner(), &f, type_info,
                                   std::move(emitter.bytecode_));
@@ -240,11 +242,20 @@ BytecodeEmitter::EmitExpression(
   }
 
   XLS_RETURN_IF_ERROR(expr->AcceptExpr(&emitter));
+  XLS_RETURN_IF_ERROR(emitter.Finish());
 
   return BytecodeFunction::Create(expr->owner(), /*source_fn=*/nullptr,
                                   type_info, std::move(emitter.bytecode_));
 }
 
+absl::Status BytecodeEmitter::Finish() {
+  if (options_.fuse_superinstructions) {
+    XLS_ASSIGN_OR_RETURN(bytecode_,
+                         FuseSuperinstructions(std::move(bytecode_)));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status BytecodeEmitter::HandleArray(const Array* node) {
   if (type_info_->IsKnownConstExpr(node)) {
     absl::StatusOr<InterpValue> const_expr = type_info_->GetConstExpr(node);
@@ -42,6 +42,10 @@ namespace xls::dslx {
 struct BytecodeEmitterOptions {
   // The format preference to use when one is not otherwise specified.
   FormatPreference format_preference;
+
+  // Whether to fuse common bytecode sequences into superinstructions (see
+  // bytecode_peephole.h), which are faster to interpret.
+  bool fuse_superinstructions = false;
 };
 
 // Translates a DSLX expression tree into a linear sequence of bytecodes.
@@ -95,6 +99,9 @@ class BytecodeEmitter : public ExprVisitor {
   // Initializes namedef-to-slot mapping.
   absl::Status Init(const Function& f);
 
+  // Applies the post-emission passes requested in the options.
+  absl::Status Finish();
+
   // Precondition: node must be Bits typed.
   absl::StatusOr<bool> IsBitsTypeNodeSigned(const AstNode* node) const;
 
@@ -350,6 +350,10 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       XLS_RETURN_IF_ERROR(EvalTupleIndex(bytecode));
       break;
     }
+    case Bytecode::Op::kTupleIndexChain: {
+      XLS_RETURN_IF_ERROR(EvalTupleIndexChain(bytecode));
+      break;
+    }
     case Bytecode::Op::kInvert: {
       XLS_RETURN_IF_ERROR(EvalInvert(bytecode));
       break;
@@ -378,10 +382,24 @@ absl::Status BytecodeInterpreter::EvalNextInstruction() {
       XLS_RETURN_IF_ERROR(EvalLoad(bytecode));
       break;
     }
+    case Bytecode::Op::kLoadLoadBinop: {
+      XLS_RETURN_IF_ERROR(EvalLoadLoadBinop(bytecode));
+      break;
+    }
     case Bytecode::Op::kLiteral: {
       XLS_RETURN_IF_ERROR(EvalLiteral(bytecode));
       break;
     }
+    case Bytecode::Op::kLiteralCompareJumpRelIf: {
+      XLS_ASSIGN_OR_RETURN(
+          std::optional<int64_t> new_pc,
+          EvalLiteralCompareJumpRelIf(frame->pc(), bytecode));
+      if (new_pc.has_value()) {
+        frame->set_pc(new_pc.value());
+        return absl::OkStatus();
+      }
+      break;
+    }
     case Bytecode::Op::kLogicalAnd: {
       XLS_RETURN_IF_ERROR(EvalLogicalAnd(bytecode));
       break;
@@ -659,7 +677,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
     XLS_RET_CHECK_EQ(converted.GetBitCount().value(),
                      to_bits_like->size.GetAsInt64().value());
 
-    stack_.Push(converted);
+    stack_.Push(std::move(converted));
     return absl::OkStatus();
   }
 
@@ -674,7 +692,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
         InterpValue result,
         ResizeBitsValue(from_value, to_bits_like.value(), to, is_checked,
                         bytecode.source_span(), file_table()));
-    stack_.Push(result);
+    stack_.Push(std::move(result));
     return absl::OkStatus();
   }
 
@@ -695,7 +713,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
         InterpValue result,
         ResizeBitsValue(from_value, to_bits_like.value(), to, is_checked,
                         bytecode.source_span(), file_table()));
-    stack_.Push(result);
+    stack_.Push(std::move(result));
     return absl::OkStatus();
   }
 
@@ -711,7 +729,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
     }
     XLS_ASSIGN_OR_RETURN(InterpValue casted,
                          CastBitsToArray(from_value, *to_array));
-    stack_.Push(casted);
+    stack_.Push(std::move(casted));
     return absl::OkStatus();
   }
 
@@ -720,7 +738,7 @@ absl::Status BytecodeInterpreter::EvalCast(const Bytecode& bytecode,
       to_enum != nullptr) {
     XLS_ASSIGN_OR_RETURN(InterpValue converted,
                          CastBitsToEnum(from_value, *to_enum));
-    stack_.Push(converted);
+    stack_.Push(std::move(converted));
     return absl::OkStatus();
   }
 
@@ -744,12 +762,13 @@ absl::Status BytecodeInterpreter::EvalCreateArray(const Bytecode& bytecode) {
   elements.reserve(array_size.value());
   for (int64_t i = 0; i < array_size.value(); i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-    elements.push_back(value);
+    elements.push_back(std::move(value));
   }
 
   std::reverse(elements.begin(), elements.end());
-  XLS_ASSIGN_OR_RETURN(InterpValue array, InterpValue::MakeArray(elements));
-  stack_.Push(array);
+  XLS_ASSIGN_OR_RETURN(InterpValue array,
+                       InterpValue::MakeArray(std::move(elements)));
+  stack_.Push(std::move(array));
   return absl::OkStatus();
 }
 
@@ -762,12 +781,12 @@ absl::Status BytecodeInterpreter::EvalCreateTuple(const Bytecode& bytecode) {
   elements.reserve(tuple_size.value());
   for (int64_t i = 0; i < tuple_size.value(); i++) {
     XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-    elements.push_back(value);
+    elements.push_back(std::move(value));
   }
 
   std::reverse(elements.begin(), elements.end());
 
-  stack_.Push(InterpValue::MakeTuple(elements));
+  stack_.Push(InterpValue::MakeTuple(std::move(elements)));
   return absl::OkStatus();
 }
 
@@ -837,11 +856,9 @@ absl::Status BytecodeInterpreter::EvalExpandTuple(const Bytecode& bytecode) {
 
   // Note that we destructure the tuple in "reverse" order, with the first
   // element on top of the stack.
-  XLS_ASSIGN_OR_RETURN(int64_t tuple_size, tuple.GetLength());
-  for (int64_t i = tuple_size - 1; i >= 0; i--) {
-    XLS_ASSIGN_OR_RETURN(InterpValue element,
-                         tuple.Index(InterpValue::MakeUBits(64, i)));
-    stack_.Push(element);
+  const std::vector<InterpValue>& elements = tuple.GetValuesOrDie();
+  for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+    stack_.Push(*it);
   }
 
   return absl::OkStatus();
@@ -881,7 +898,26 @@ absl::Status BytecodeInterpreter::EvalTupleIndex(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(
       InterpValue result, basis.Index(index),
       _ << " while processing " << bytecode.ToString(file_table()));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
+  return absl::OkStatus();
+}
+
+absl::Status BytecodeInterpreter::EvalTupleIndexChain(
+    const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::FusedData* data, bytecode.fused_data());
+  XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
+  for (const InterpValue& index : data->literals) {
+    if (!value.IsTuple()) {
+      return absl::InternalError(
+          "BytecodeInterpreter type error: tuple_index_chain bytecode can only "
+          "index on tuple values; got: " +
+          value.ToString());
+    }
+    XLS_ASSIGN_OR_RETURN(
+        value, value.Index(index),
+        _ << " while processing " << bytecode.ToString(file_table()));
+  }
+  stack_.Push(std::move(value));
   return absl::OkStatus();
 }
 
@@ -900,14 +936,14 @@ absl::Status BytecodeInterpreter::EvalIndex(const Bytecode& bytecode) {
       InterpValue result, basis.Index(index),
       _ << " while processing "
         << bytecode.ToString(file_table(), /*source_locs=*/true));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
 absl::Status BytecodeInterpreter::EvalInvert(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.BitwiseNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -936,6 +972,21 @@ absl::Status BytecodeInterpreter::EvalLoad(const Bytecode& bytecode) {
   return absl::OkStatus();
 }
 
+absl::Status BytecodeInterpreter::EvalLoadLoadBinop(const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::FusedData* data, bytecode.fused_data());
+  XLS_RET_CHECK_EQ(data->slots.size(), 2);
+  const std::vector<InterpValue>& slots = frames_.back().slots();
+  for (Bytecode::SlotIndex slot : data->slots) {
+    if (slots.size() <= slot.value()) {
+      return absl::InternalError(absl::StrFormat(
+          "Attempted to access local data in slot %d, which is out of range.",
+          slot.value()));
+    }
+    stack_.Push(slots[slot.value()]);
+  }
+  return EvalFusedBinop(data->op, bytecode);
+}
+
 absl::Status BytecodeInterpreter::EvalLogicalAnd(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue rhs, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue lhs, Pop());
@@ -953,7 +1004,7 @@ absl::Status BytecodeInterpreter::EvalLogicalAnd(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseAnd(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -974,7 +1025,7 @@ absl::Status BytecodeInterpreter::EvalLogicalOr(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue result, lhs.BitwiseOr(rhs));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1015,7 +1066,7 @@ absl::StatusOr<bool> BytecodeInterpreter::MatchArmEqualsInterpValue(
             "MatchArm load item index was OOB: ", slot_index.value(), " vs. ",
             frame->slots().size(), "."));
       }
-      InterpValue arm_value = frame->slots().at(slot_index.value());
+      const InterpValue& arm_value = frame->slots().at(slot_index.value());
       return arm_value.Eq(value);
     }
 
@@ -1102,7 +1153,7 @@ absl::Status BytecodeInterpreter::EvalNe(const Bytecode& bytecode) {
 absl::Status BytecodeInterpreter::EvalNegate(const Bytecode& bytecode) {
   XLS_ASSIGN_OR_RETURN(InterpValue operand, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue result, operand.ArithmeticNegate());
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1176,9 +1227,9 @@ absl::Status BytecodeInterpreter::EvalRecv(const Bytecode& bytecode) {
   if (condition.IsTrue()) {
     if (channel.IsEmpty()) {
       // Restore the stack!
-      stack_.Push(channel_value);
-      stack_.Push(condition);
-      stack_.Push(default_value);
+      stack_.Push(std::move(channel_value));
+      stack_.Push(std::move(condition));
+      stack_.Push(std::move(default_value));
       blocked_channel_info_ = BlockedChannelInfo{
           .name = FormatChannelNameForTracing(*channel_data),
           .span = bytecode.source_span(),
@@ -1237,7 +1288,7 @@ absl::Status BytecodeInterpreter::EvalSend(const Bytecode& bytecode) {
     }
     channel.Write(payload);
   }
-  stack_.Push(token);
+  stack_.Push(std::move(token));
   return absl::OkStatus();
 }
 
@@ -1267,7 +1318,7 @@ absl::Status BytecodeInterpreter::EvalSlice(const Bytecode& bytecode) {
   XLS_RET_CHECK(basis.IsUBits())
       << "Slice basis is not unsigned bits: " << basis.ToString();
   XLS_ASSIGN_OR_RETURN(InterpValue result, basis.Slice(start, length));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -1279,7 +1330,7 @@ absl::Status BytecodeInterpreter::EvalStore(const Bytecode& bytecode) {
   }
 
   XLS_ASSIGN_OR_RETURN(InterpValue value, Pop());
-  frames_.back().StoreSlot(slot, value);
+  frames_.back().StoreSlot(slot, std::move(value));
   return absl::OkStatus();
 }
 
@@ -1294,6 +1345,70 @@ absl::StatusOr<std::optional<int64_t>> BytecodeInterpreter::EvalJumpRelIf(
   return std::nullopt;
 }
 
+absl::StatusOr<std::optional<int64_t>>
+BytecodeInterpreter::EvalLiteralCompareJumpRelIf(int64_t pc,
+                                                 const Bytecode& bytecode) {
+  XLS_ASSIGN_OR_RETURN(const Bytecode::FusedData* data, bytecode.fused_data());
+  XLS_RET_CHECK_EQ(data->literals.size(), 1);
+  stack_.Push(data->literals.front());
+  XLS_RETURN_IF_ERROR(EvalFusedBinop(data->op, bytecode));
+  XLS_ASSIGN_OR_RETURN(InterpValue top, Pop());
+  if (top.IsTrue()) {
+    return pc + data->jump_target.value();
+  }
+  return std::nullopt;
+}
+
+absl::Status BytecodeInterpreter::EvalFusedBinop(Bytecode::Op op,
+                                                 const Bytecode& bytecode) {
+  switch (op) {
+    case Bytecode::Op::kUAdd:
+      return EvalAdd(bytecode, /*is_signed=*/false);
+    case Bytecode::Op::kSAdd:
+      return EvalAdd(bytecode, /*is_signed=*/true);
+    case Bytecode::Op::kUSub:
+      return EvalSub(bytecode, /*is_signed=*/false);
+    case Bytecode::Op::kSSub:
+      return EvalSub(bytecode, /*is_signed=*/true);
+    case Bytecode::Op::kUMul:
+      return EvalMul(bytecode, /*is_signed=*/false);
+    case Bytecode::Op::kSMul:
+      return EvalMul(bytecode, /*is_signed=*/true);
+    case Bytecode::Op::kDiv:
+      return EvalDiv(bytecode);
+    case Bytecode::Op::kMod:
+      return EvalMod(bytecode);
+    case Bytecode::Op::kAnd:
+      return EvalAnd(bytecode);
+    case Bytecode::Op::kOr:
+      return EvalOr(bytecode);
+    case Bytecode::Op::kXor:
+      return EvalXor(bytecode);
+    case Bytecode::Op::kShl:
+      return EvalShl(bytecode);
+    case Bytecode::Op::kShr:
+      return EvalShr(bytecode);
+    case Bytecode::Op::kConcat:
+      return EvalConcat(bytecode);
+    case Bytecode::Op::kEq:
+      return EvalEq(bytecode);
+    case Bytecode::Op::kNe:
+      return EvalNe(bytecode);
+    case Bytecode::Op::kLt:
+      return EvalLt(bytecode);
+    case Bytecode::Op::kLe:
+      return EvalLe(bytecode);
+    case Bytecode::Op::kGt:
+      return EvalGt(bytecode);
+    case Bytecode::Op::kGe:
+      return EvalGe(bytecode);
+    default:
+      return absl::InternalError(
+          absl::StrCat("Bytecode op cannot be fused with loads or literals: ",
+                       OpToString(op)));
+  }
+}
+
 absl::Status BytecodeInterpreter::EvalSub(const Bytecode& bytecode,
                                           bool is_signed) {
   return EvalBinop([&](const InterpValue& lhs,
@@ -1322,8 +1437,8 @@ absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
   XLS_RET_CHECK_GE(stack_.size(), 2);
   XLS_ASSIGN_OR_RETURN(InterpValue tos0, Pop());
   XLS_ASSIGN_OR_RETURN(InterpValue tos1, Pop());
-  stack_.Push(tos0);
-  stack_.Push(tos1);
+  stack_.Push(std::move(tos0));
+  stack_.Push(std::move(tos1));
   return absl::OkStatus();
 }
 
@@ -1342,7 +1457,7 @@ absl::Status BytecodeInterpreter::EvalSwap(const Bytecode& bytecode) {
   for (size_t i = 0; i < argc; ++i) {
     XLS_RET_CHECK(!stack.empty());
     XLS_ASSIGN_OR_RETURN(InterpValue value, stack.Pop());
-    args.push_back(value);
+    args.push_back(std::move(value));
   }
 
   std::reverse(args.begin(), args.end());
@@ -1398,7 +1513,7 @@ absl::Status BytecodeInterpreter::EvalTraceArg(const Bytecode& bytecode) {
   if (options_.trace_hook()) {
     options_.trace_hook()(bytecode.source_span(), message);
   }
-  stack_.Push(value);
+  stack_.Push(std::move(value));
   return absl::OkStatus();
 }
 
@@ -1441,7 +1556,7 @@ absl::Status BytecodeInterpreter::EvalWidthSlice(const Bytecode& bytecode) {
       is_signed ? InterpValueTag::kSBits : InterpValueTag::kUBits;
   XLS_ASSIGN_OR_RETURN(InterpValue result,
                        InterpValue::MakeBits(tag, result_bits));
-  stack_.Push(result);
+  stack_.Push(std::move(result));
   return absl::OkStatus();
 }
 
@@ -186,10 +186,12 @@ class BytecodeInterpreter {
   absl::Status EvalGt(const Bytecode& bytecode);
   absl::Status EvalIndex(const Bytecode& bytecode);
   absl::Status EvalTupleIndex(const Bytecode& bytecode);
+  absl::Status EvalTupleIndexChain(const Bytecode& bytecode);
   absl::Status EvalInvert(const Bytecode& bytecode);
   absl::Status EvalLe(const Bytecode& bytecode);
   absl::Status EvalLiteral(const Bytecode& bytecode);
   absl::Status EvalLoad(const Bytecode& bytecode);
+  absl::Status EvalLoadLoadBinop(const Bytecode& bytecode);
   absl::Status EvalLogicalAnd(const Bytecode& bytecode);
   absl::Status EvalLogicalOr(const Bytecode& bytecode);
   absl::Status EvalLt(const Bytecode& bytecode);
@@ -225,12 +227,18 @@ class BytecodeInterpreter {
       const std::function<absl::StatusOr<InterpValue>(
           const InterpValue& lhs, const InterpValue& rhs)>& op);
 
+  // Applies the binop `op` (see IsFusableBinop) to the top two stack values on
+  // behalf of the superinstruction `bytecode`.
+  absl::Status EvalFusedBinop(Bytecode::Op op, const Bytecode& bytecode);
+
   absl::StatusOr<BytecodeFunction*> GetBytecodeFn(
       Function& function, const Invocation* invocation,
       const ParametricEnv& caller_bindings);
 
   absl::StatusOr<std::optional<int64_t>> EvalJumpRelIf(
       int64_t pc, const Bytecode& bytecode);
+  absl::StatusOr<std::optional<int64_t>> EvalLiteralCompareJumpRelIf(
+      int64_t pc, const Bytecode& bytecode);
 
   // TODO(rspringer): 2022-02-14: Builtins should probably go in their own file,
   // likely after removing the old interpreter.
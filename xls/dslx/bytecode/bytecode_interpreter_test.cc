@@ -2016,6 +2016,55 @@ fn main() {
   EXPECT_TRUE(value.IsUnit());
 }
 
+// Superinstruction fusion must not change results; the program exercises all
+// of the fused patterns (see bytecode_peephole.h).
+TEST_F(BytecodeInterpreterTest, SuperinstructionsMatchUnfused) {
+  constexpr std::string_view kProgram = R"(
+struct Point { x: u32, y: u32 }
+struct Line { a: Point, b: Point }
+
+fn main(n: u32) -> u32 {
+  let l = Line {
+    a: Point { x: u32:1, y: u32:2 },
+    b: Point { x: u32:7, y: u32:9 },
+  };
+  let total = for (i, acc): (u32, u32) in u32:0..u32:4 {
+    let d = l.b.x - l.a.x;
+    acc + d + i
+  }(u32:0);
+  let t = (total, n);
+  if t.1 == u32:3 { t.0 } else { total + n }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheckOrPrintError(kProgram, &import_data_.value()));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> unfused,
+      BytecodeEmitter::Emit(&import_data_.value(), tm.type_info, *f,
+                            ParametricEnv()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BytecodeFunction> fused,
+      BytecodeEmitter::Emit(
+          &import_data_.value(), tm.type_info, *f, ParametricEnv(),
+          BytecodeEmitterOptions{.fuse_superinstructions = true}));
+  EXPECT_LT(fused->bytecodes().size(), unfused->bytecodes().size());
+
+  for (int64_t n : {3, 5}) {
+    std::vector<InterpValue> args = {InterpValue::MakeU32(n)};
+    XLS_ASSERT_OK_AND_ASSIGN(
+        InterpValue expected,
+        BytecodeInterpreter::Interpret(&import_data_.value(), unfused.get(),
+                                       args));
+    EXPECT_THAT(BytecodeInterpreter::Interpret(&import_data_.value(),
+                                               fused.get(), args),
+                IsOkAndHolds(expected));
+    EXPECT_EQ(expected, InterpValue::MakeU32(n == 3 ? 30 : 35));
+  }
+}
+
 TEST_F(BytecodeInterpreterTest, AssertEqStructs) {
   constexpr std::string_view kProgram = R"(
 struct InnerStruct {
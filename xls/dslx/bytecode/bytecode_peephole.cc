@@ -0,0 +1,179 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_peephole.h"
+
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+namespace {
+
+using Op = Bytecode::Op;
+
+bool IsLiteralValue(const Bytecode& bytecode) {
+  return bytecode.op() == Op::kLiteral && bytecode.has_data() &&
+         std::holds_alternative<InterpValue>(*bytecode.data());
+}
+
+bool IsJump(Op op) {
+  return op == Op::kJumpRel || op == Op::kJumpRelIf ||
+         op == Op::kLiteralCompareJumpRelIf;
+}
+
+// A jump in the fused program whose amount must be recomputed.
+struct PendingJump {
+  // PC of the jump in the fused program.
+  int64_t pc;
+  // PC of the jump's destination in the original program.
+  int64_t original_target;
+};
+
+}  // namespace
+
+bool IsComparison(Op op) {
+  switch (op) {
+    case Op::kEq:
+    case Op::kNe:
+    case Op::kLt:
+    case Op::kLe:
+    case Op::kGt:
+    case Op::kGe:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool IsFusableBinop(Op op) {
+  switch (op) {
+    case Op::kUAdd:
+    case Op::kSAdd:
+    case Op::kUSub:
+    case Op::kSSub:
+    case Op::kUMul:
+    case Op::kSMul:
+    case Op::kDiv:
+    case Op::kMod:
+    case Op::kAnd:
+    case Op::kOr:
+    case Op::kXor:
+    case Op::kShl:
+    case Op::kShr:
+    case Op::kConcat:
+      return true;
+    default:
+      return IsComparison(op);
+  }
+}
+
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes) {
+  const int64_t size = bytecodes.size();
+  std::vector<Bytecode> fused;
+  fused.reserve(size);
+  // Maps each original PC to the PC of the fused bytecode which covers it.
+  std::vector<int64_t> new_pc(size);
+  std::vector<PendingJump> jumps;
+
+  int64_t pc = 0;
+  while (pc < size) {
+    const Bytecode& bytecode = bytecodes[pc];
+    int64_t length = 1;
+    if (bytecode.op() == Op::kLoad && pc + 2 < size &&
+        bytecodes[pc + 1].op() == Op::kLoad &&
+        IsFusableBinop(bytecodes[pc + 2].op())) {
+      XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex lhs, bytecode.slot_index());
+      XLS_ASSIGN_OR_RETURN(Bytecode::SlotIndex rhs,
+                           bytecodes[pc + 1].slot_index());
+      const Bytecode& binop = bytecodes[pc + 2];
+      fused.push_back(Bytecode(binop.source_span(), Op::kLoadLoadBinop,
+                               Bytecode::FusedData{.op = binop.op(),
+                                                   .slots = {lhs, rhs}}));
+      length = 3;
+    } else if (IsLiteralValue(bytecode) && pc + 2 < size &&
+               IsComparison(bytecodes[pc + 1].op()) &&
+               bytecodes[pc + 2].op() == Op::kJumpRelIf) {
+      const Bytecode& comparison = bytecodes[pc + 1];
+      XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                           bytecodes[pc + 2].jump_target());
+      jumps.push_back(PendingJump{.pc = static_cast<int64_t>(fused.size()),
+                                  .original_target = pc + 2 + target.value()});
+      fused.push_back(Bytecode(
+          comparison.source_span(), Op::kLiteralCompareJumpRelIf,
+          Bytecode::FusedData{
+              .op = comparison.op(),
+              .literals = {std::get<InterpValue>(*bytecode.data())}}));
+      length = 3;
+    } else if (IsLiteralValue(bytecode) && pc + 1 < size &&
+               bytecodes[pc + 1].op() == Op::kTupleIndex) {
+      std::vector<InterpValue> indices;
+      length = 0;
+      while (pc + length + 1 < size && IsLiteralValue(bytecodes[pc + length]) &&
+             bytecodes[pc + length + 1].op() == Op::kTupleIndex) {
+        indices.push_back(
+            std::get<InterpValue>(*bytecodes[pc + length].data()));
+        length += 2;
+      }
+      fused.push_back(
+          Bytecode(bytecodes[pc + length - 1].source_span(),
+                   Op::kTupleIndexChain,
+                   Bytecode::FusedData{.op = Op::kTupleIndex,
+                                       .literals = std::move(indices)}));
+    } else {
+      if (bytecode.op() == Op::kJumpRel || bytecode.op() == Op::kJumpRelIf) {
+        XLS_ASSIGN_OR_RETURN(Bytecode::JumpTarget target,
+                             bytecode.jump_target());
+        jumps.push_back(PendingJump{.pc = static_cast<int64_t>(fused.size()),
+                                    .original_target = pc + target.value()});
+      }
+      fused.push_back(std::move(bytecodes[pc]));
+    }
+    for (int64_t i = pc; i < pc + length; ++i) {
+      new_pc[i] = fused.size() - 1;
+    }
+    pc += length;
+  }
+
+  for (const PendingJump& jump : jumps) {
+    XLS_RET_CHECK(jump.original_target >= 0 && jump.original_target < size)
+        << "Jump target out of range: " << jump.original_target;
+    // Jump destinations are never fused, so they keep their own bytecode.
+    XLS_RET_CHECK(fused[new_pc[jump.original_target]].op() == Op::kJumpDest);
+    Bytecode& bytecode = fused[jump.pc];
+    XLS_RET_CHECK(IsJump(bytecode.op()));
+    Bytecode::JumpTarget target(new_pc[jump.original_target] - jump.pc);
+    if (bytecode.op() == Op::kLiteralCompareJumpRelIf) {
+      XLS_ASSIGN_OR_RETURN(const Bytecode::FusedData* data,
+                           bytecode.fused_data());
+      Bytecode::FusedData patched = *data;
+      patched.jump_target = target;
+      bytecode = Bytecode(bytecode.source_span(), bytecode.op(),
+                          std::move(patched));
+    } else {
+      bytecode = Bytecode(bytecode.source_span(), bytecode.op(), target);
+    }
+  }
+  return fused;
+}
+
+}  // namespace xls::dslx
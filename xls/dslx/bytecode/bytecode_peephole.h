@@ -0,0 +1,48 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_BYTECODE_BYTECODE_PEEPHOLE_H_
+#define XLS_DSLX_BYTECODE_BYTECODE_PEEPHOLE_H_
+
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/bytecode/bytecode.h"
+
+namespace xls::dslx {
+
+// Returns whether `op` is a stack binop which may be the last bytecode of a
+// kLoadLoadBinop or the comparison of a kLiteralCompareJumpRelIf.
+bool IsFusableBinop(Bytecode::Op op);
+
+// Returns whether `op` is one of the comparison binops.
+bool IsComparison(Bytecode::Op op);
+
+// Rewrites common sequences of bytecodes into superinstructions, which the
+// interpreter dispatches once instead of once per replaced bytecode:
+//
+//  * `load a; load b; <binop>` becomes `load_load_binop`.
+//  * `literal x; <comparison>; jump_rel_if` becomes
+//    `literal_compare_jump_rel_if`.
+//  * `literal i; tuple_index` and chains thereof (as emitted for nested
+//    struct and tuple member accesses) become `tuple_index_chain`.
+//
+// Sequences are never fused across a jump_dest, so every jump still lands on
+// a jump_dest; relative jump amounts are recomputed for the shorter program.
+absl::StatusOr<std::vector<Bytecode>> FuseSuperinstructions(
+    std::vector<Bytecode> bytecodes);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_BYTECODE_BYTECODE_PEEPHOLE_H_
@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/bytecode/bytecode_peephole.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/bytecode/bytecode.h"
+#include "xls/dslx/frontend/pos.h"
+#include "xls/dslx/interp_value.h"
+
+namespace xls::dslx {
+namespace {
+
+using Op = Bytecode::Op;
+
+Bytecode Make(Op op) { return Bytecode(Span::Fake(), op); }
+Bytecode MakeLoad(int64_t slot) {
+  return Bytecode::MakeLoad(Span::Fake(), Bytecode::SlotIndex(slot));
+}
+Bytecode MakeLiteral(InterpValue value) {
+  return Bytecode::MakeLiteral(Span::Fake(), std::move(value));
+}
+Bytecode MakeJump(Op op, int64_t amount) {
+  return Bytecode(Span::Fake(), op, Bytecode::JumpTarget(amount));
+}
+
+std::string ToString(const std::vector<Bytecode>& bytecodes) {
+  FileTable file_table;
+  return BytecodesToString(bytecodes, /*source_locs=*/false, file_table);
+}
+
+TEST(BytecodePeepholeTest, FusesLoadLoadBinop) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(MakeLoad(0));
+  bytecodes.push_back(MakeLoad(1));
+  bytecodes.push_back(Make(Op::kUAdd));
+  bytecodes.push_back(MakeLoad(2));
+  bytecodes.push_back(Make(Op::kSwap));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> fused,
+                           FuseSuperinstructions(std::move(bytecodes)));
+  EXPECT_EQ(ToString(fused), R"(000 load_load_binop uadd 0 1
+001 load 2
+002 swap)");
+}
+
+TEST(BytecodePeepholeTest, FusesTupleIndexChain) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(MakeLoad(0));
+  bytecodes.push_back(MakeLiteral(InterpValue::MakeU64(1)));
+  bytecodes.push_back(Make(Op::kTupleIndex));
+  bytecodes.push_back(MakeLiteral(InterpValue::MakeU64(0)));
+  bytecodes.push_back(Make(Op::kTupleIndex));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> fused,
+                           FuseSuperinstructions(std::move(bytecodes)));
+  EXPECT_EQ(ToString(fused), R"(000 load 0
+001 tuple_index_chain u64:1 u64:0)");
+}
+
+// A counting loop, as emitted for `for` expressions.
+TEST(BytecodePeepholeTest, RecomputesJumpAmounts) {
+  std::vector<Bytecode> bytecodes;
+  bytecodes.push_back(Make(Op::kJumpDest));
+  bytecodes.push_back(MakeLoad(0));
+  bytecodes.push_back(MakeLiteral(InterpValue::MakeU32(4)));
+  bytecodes.push_back(Make(Op::kEq));
+  bytecodes.push_back(MakeJump(Op::kJumpRelIf, 6));
+  bytecodes.push_back(MakeLoad(0));
+  bytecodes.push_back(MakeLoad(1));
+  bytecodes.push_back(Make(Op::kUAdd));
+  bytecodes.push_back(
+      Bytecode::MakeStore(Span::Fake(), Bytecode::SlotIndex(0)));
+  bytecodes.push_back(MakeJump(Op::kJumpRel, -9));
+  bytecodes.push_back(Make(Op::kJumpDest));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<Bytecode> fused,
+                           FuseSuperinstructions(std::move(bytecodes)));
+  EXPECT_EQ(ToString(fused), R"(000 jump_dest
+001 load 0
+002 literal_compare_jump_rel_if eq u32:4 +4
+003 load_load_binop uadd 0 1
+004 store 0
+005 jump_rel -5
+006 jump_dest)");
+}
+
+}  // namespace
+}  // namespace xls::dslx
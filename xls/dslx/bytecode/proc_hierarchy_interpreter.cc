@@ -204,8 +204,9 @@ absl::Status ProcConfigBytecodeInterpreter::EvalSpawn(
       std::unique_ptr<BytecodeFunction> next_bf,
       BytecodeEmitter::EmitProcNext(
           import_data, type_info, proc->next(), callee_bindings, member_defs,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+          BytecodeEmitterOptions{
+              .format_preference = options.format_preference(),
+              .fuse_superinstructions = true}));
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeInterpreter> next_interpreter,
       CreateUnique(import_data, callee_proc_id, next_bf.get(), full_next_args,
@@ -34,6 +34,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -652,11 +653,68 @@ absl::Status ConstexprEvaluator::HandleXlsTuple(const XlsTuple* expr) {
   return absl::OkStatus();
 }
 
+// Returns whether `value` is fully described by its ToString() text.
+static bool IsIdentifiedByText(const InterpValue& value) {
+  if (value.IsFunction() || value.IsToken() || value.IsChannelReference()) {
+    return false;
+  }
+  if (value.HasValues()) {
+    return std::all_of(value.GetValuesOrDie().begin(),
+                       value.GetValuesOrDie().end(), IsIdentifiedByText);
+  }
+  return true;
+}
+
+// Returns a key uniquely describing the constexpr environment `env`, or nullopt
+// if it binds values (like functions or tokens) whose text does not identify
+// them.
+static std::optional<std::string> MakeConstexprEnvKey(
+    const absl::flat_hash_map<std::string, InterpValue>& env) {
+  std::vector<std::pair<std::string, const InterpValue*>> items;
+  items.reserve(env.size());
+  for (const auto& [name, value] : env) {
+    if (!IsIdentifiedByText(value)) {
+      return std::nullopt;
+    }
+    items.push_back({name, &value});
+  }
+  std::sort(items.begin(), items.end());
+  return absl::StrJoin(items, ";", [](std::string* out, const auto& item) {
+    absl::StrAppend(out, item.first, "=", item.second->ToString());
+  });
+}
+
+void ConstexprEvaluator::ReportRollovers(absl::Span<const Span> rollovers) {
+  if (warning_collector_ == nullptr) {
+    return;
+  }
+  for (const Span& s : rollovers) {
+    warning_collector_->Add(
+        s, WarningKind::kConstexprEvalRollover,
+        "constexpr evaluation detected rollover in operation");
+  }
+}
+
 absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
   XLS_ASSIGN_OR_RETURN(ConstexprEnvData constexpr_env_data,
                        MakeConstexprEnv(import_data_, type_info_,
                                         warning_collector_, expr, bindings_));
 
+  // The same expression is often evaluated with the same environment under
+  // many type infos, e.g. a constant referenced from every instantiation of
+  // a parametric function, so reuse the result of interpreting it.
+  std::optional<std::string> env_key =
+      MakeConstexprEnvKey(constexpr_env_data.env);
+  if (env_key.has_value()) {
+    std::optional<ImportData::ConstexprResult> cached =
+        import_data_->GetConstexprResult(expr, *env_key);
+    if (cached.has_value()) {
+      ReportRollovers(cached->rollovers);
+      type_info_->NoteConstExpr(expr, std::move(cached->value));
+      return absl::OkStatus();
+    }
+  }
+
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BytecodeFunction> bf,
       BytecodeEmitter::EmitExpression(import_data_, type_info_, expr,
@@ -668,12 +726,12 @@ absl::Status ConstexprEvaluator::InterpretExpr(const Expr* expr) {
   XLS_ASSIGN_OR_RETURN(InterpValue constexpr_value,
                        BytecodeInterpreter::Interpret(import_data_, bf.get(),
                                                       /*args=*/{}));
-  if (warning_collector_ != nullptr) {
-    for (const Span& s : rollovers) {
-      warning_collector_->Add(
-          s, WarningKind::kConstexprEvalRollover,
-          "constexpr evaluation detected rollover in operation");
-    }
+  ReportRollovers(rollovers);
+  if (env_key.has_value()) {
+    import_data_->NoteConstexprResult(
+        expr, *std::move(env_key),
+        ImportData::ConstexprResult{.value = constexpr_value,
+                                    .rollovers = std::move(rollovers)});
   }
   type_info_->NoteConstExpr(expr, constexpr_value);
 
@@ -20,7 +20,9 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/parametric_env.h"
@@ -118,6 +120,10 @@ class ConstexprEvaluator : public xls::dslx::ExprVisitor {
   // necessary to determine that all expression components are constexpr.
   absl::Status InterpretExpr(const Expr* expr);
 
+  // Adds a warning for each of the given spans at which constexpr evaluation
+  // detected rollover.
+  void ReportRollovers(absl::Span<const Span> rollovers);
+
   ImportData* const import_data_;
   TypeInfo* const type_info_;
   WarningCollector* const warning_collector_;
@@ -680,5 +680,33 @@ fn main() -> u32 {
   EXPECT_EQ(value.GetBitValueViaSign().value(), 8);
 }
 
+TEST(ConstexprEvaluatorTest, InterpretedResultIsNotedInImportData) {
+  constexpr std::string_view kProgram = R"(
+const TABLE = u8[4]:[1, 2, 3, 4];
+
+fn main() -> u8 {
+  TABLE[u32:2] + u8:1
+}
+)";
+
+  ImportData import_data(CreateImportDataForTest());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheck(kProgram, "test.x", "test", &import_data));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           tm.module->GetMemberOrError<Function>("main"));
+  WarningCollector warnings(kAllWarningsSet);
+  Expr* sum = std::get<Expr*>(f->body()->statements().at(0)->wrapped());
+  XLS_ASSERT_OK(ConstexprEvaluator::Evaluate(&import_data, tm.type_info,
+                                             &warnings, ParametricEnv(), sum,
+                                             nullptr));
+  std::optional<ImportData::ConstexprResult> result =
+      import_data.GetConstexprResult(sum, "TABLE=[u8:1, u8:2, u8:3, u8:4]");
+  ASSERT_TRUE(result.has_value());
+  EXPECT_EQ(result->value, InterpValue::MakeU8(4));
+  EXPECT_TRUE(result->rollovers.empty());
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -72,48 +72,6 @@ absl::StatusOr<int64_t> GetBitCountFromBitVectorMetadata(
                       import_data);
 }
 
-// Returns the C++ type for representing a DSLX bit vector type with the given
-// bit count and signedness.
-absl::StatusOr<std::string> GetBitVectorCppType(int64_t bit_count,
-                                                bool is_signed) {
-  std::string prefix;
-  if (bit_count == 1 && is_signed) {
-    // Signed one-bit numbers are represented with one-bit values in the JIT
-    // which treats all values as unsigned, so the c++ representation must be
-    // one-bit to conform with the JIT representation. However, there is no
-    // signed one-bit value in C++.
-    return absl::UnimplementedError("Signed one-bit numbers are not supported");
-  }
-  if (bit_count == 1) {
-    return "bool";
-  }
-  if (!is_signed) {
-    prefix = "u";
-  }
-  if (bit_count <= 8) {
-    return prefix + "int8_t";
-  }
-  if (bit_count <= 16) {
-    return prefix + "int16_t";
-  }
-  if (bit_count <= 32) {
-    return prefix + "int32_t";
-  }
-  if (bit_count <= 64) {
-    return prefix + "int64_t";
-  }
-
-  // Type is wider that 64-bits
-  //
-  // This is wrong! Bit-vectors wider than 64-bits are being represented using
-  // (u)int64_t. Fortunately this is no less wrong than the previous version of
-  // the cpp transpiler. However, bad implementation does enable conversion of
-  // files which contain (unused) >64-bit types though those types are
-  // non-functional.
-  // TODO(https://github.com/google/xls/issues/1135): Fix this.
-  return prefix + "int64_t";
-}
-
 // Returns the number of elements in the array defined by `type_annotation`.
 absl::StatusOr<int64_t> ArraySize(const ArrayTypeAnnotation* type_annotation,
                                   TypeInfo* type_info,
@@ -737,6 +695,46 @@ std::string DslxTypeNameToCpp(std::string_view dslx_type) {
   return SanitizeCppName(Camelize(dslx_type));
 }
 
+absl::StatusOr<std::string> GetBitVectorCppType(int64_t bit_count,
+                                                bool is_signed) {
+  std::string prefix;
+  if (bit_count == 1 && is_signed) {
+    // Signed one-bit numbers are represented with one-bit values in the JIT
+    // which treats all values as unsigned, so the c++ representation must be
+    // one-bit to conform with the JIT representation. However, there is no
+    // signed one-bit value in C++.
+    return absl::UnimplementedError("Signed one-bit numbers are not supported");
+  }
+  if (bit_count == 1) {
+    return "bool";
+  }
+  if (!is_signed) {
+    prefix = "u";
+  }
+  if (bit_count <= 8) {
+    return prefix + "int8_t";
+  }
+  if (bit_count <= 16) {
+    return prefix + "int16_t";
+  }
+  if (bit_count <= 32) {
+    return prefix + "int32_t";
+  }
+  if (bit_count <= 64) {
+    return prefix + "int64_t";
+  }
+
+  // Type is wider that 64-bits
+  //
+  // This is wrong! Bit-vectors wider than 64-bits are being represented using
+  // (u)int64_t. Fortunately this is no less wrong than the previous version of
+  // the cpp transpiler. However, bad implementation does enable conversion of
+  // files which contain (unused) >64-bit types though those types are
+  // non-functional.
+  // TODO(https://github.com/google/xls/issues/1135): Fix this.
+  return prefix + "int64_t";
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<CppEmitter>> CppEmitter::Create(
     const TypeAnnotation* type_annotation, std::string_view dslx_type,
     TypeInfo* type_info, ImportData* import_data) {
@@ -34,6 +34,11 @@ std::string SanitizeCppName(std::string_view name);
 // Returns the C++ type name used to represent the given DSLX type name.
 std::string DslxTypeNameToCpp(std::string_view dslx_type);
 
+// Returns the C++ type for representing a DSLX bit vector type with the given
+// bit count and signedness.
+absl::StatusOr<std::string> GetBitVectorCppType(int64_t bit_count,
+                                                bool is_signed);
+
 // A class which handles generation of snippets of C++ code for a particular
 // type which may be represented with a TypeAnnotation (e.g., array, tuple,
 // bit-vector).
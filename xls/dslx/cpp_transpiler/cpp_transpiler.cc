@@ -28,6 +28,7 @@
 #include "absl/strings/substitute.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/cpp_transpiler/cpp_type_generator.h"
+#include "xls/dslx/cpp_transpiler/native_layouts.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/type_info.h"
@@ -37,7 +38,8 @@ namespace xls::dslx {
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces) {
+                                         std::string_view namespaces,
+                                         bool native_views) {
   constexpr std::string_view kHeaderTemplate =
       R"(// AUTOMATICALLY GENERATED FILE FROM `xls/dslx/cpp_transpiler`. DO NOT EDIT!
 #ifndef $0
@@ -51,7 +53,7 @@ absl::StatusOr<CppSource> TranspileToCpp(Module* module,
 #include "absl/status/statusor.h"
 #include "xls/public/value.h"
 
-$2$1$3
+$4$2$1$3
 
 #endif  // $0
 )";
@@ -96,8 +98,52 @@ $2$1$3
 
 %s%s%s
 )";
+  // Helpers shared by the views of all generated structs. Bit-vector members
+  // are held in the fewest power-of-two bytes which fit them, little-endian and
+  // zero padded; the guard allows several generated headers in one namespace.
+  constexpr std::string_view kNativeViewHelpers =
+      R"(#include <cstring>
+#include <type_traits>
+
+#ifndef XLS_DSLX_CPP_TRANSPILER_NATIVE_VIEW_HELPERS_
+#define XLS_DSLX_CPP_TRANSPILER_NATIVE_VIEW_HELPERS_
+namespace xls_native_view {
+
+template <typename T, int64_t kBitCount, int64_t kDataSize>
+inline T Load(const uint8_t* buffer) {
+  uint64_t value = 0;
+  std::memcpy(&value, buffer, kDataSize);
+  if constexpr (kBitCount < 64) {
+    constexpr uint64_t kMask = (uint64_t{1} << kBitCount) - 1;
+    value &= kMask;
+    if constexpr (std::is_signed_v<T>) {
+      if ((value >> (kBitCount - 1)) & 1) {
+        value |= ~kMask;
+      }
+    }
+  }
+  return static_cast<T>(value);
+}
+
+template <int64_t kBitCount, int64_t kPaddedSize>
+inline void Store(uint8_t* buffer, uint64_t value) {
+  if constexpr (kBitCount < 64) {
+    value &= (uint64_t{1} << kBitCount) - 1;
+  }
+  std::memcpy(buffer, &value, kPaddedSize);
+}
+
+}  // namespace xls_native_view
+#endif  // XLS_DSLX_CPP_TRANSPILER_NATIVE_VIEW_HELPERS_
+
+)";
+
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info,
                        import_data->GetRootTypeInfo(module));
+  std::unique_ptr<NativeLayouts> native_layouts;
+  if (native_views) {
+    XLS_ASSIGN_OR_RETURN(native_layouts, NativeLayouts::Create());
+  }
   std::vector<std::string> header;
   std::vector<std::string> source;
 
@@ -105,7 +151,8 @@ $2$1$3
   // that types defined in imported files can be used.
   for (const TypeDefinition& def : module->GetTypeDefinitions()) {
     XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppTypeGenerator> generator,
-                         CppTypeGenerator::Create(def, type_info, import_data));
+                         CppTypeGenerator::Create(def, type_info, import_data,
+                                                  native_layouts.get()));
     XLS_ASSIGN_OR_RETURN(CppSource result, generator->GetCppSource());
     header.push_back(result.header);
     source.push_back(result.source);
@@ -131,7 +178,7 @@ $2$1$3
   return CppSource{
       absl::Substitute(kHeaderTemplate, header_guard,
                        absl::StrJoin(header, "\n\n"), namespace_begin,
-                       namespace_end),
+                       namespace_end, native_views ? kNativeViewHelpers : ""),
       absl::StrFormat(kSourceTemplate, output_header_path, namespace_begin,
                       absl::StrJoin(source, "\n\n"), namespace_end)};
 }
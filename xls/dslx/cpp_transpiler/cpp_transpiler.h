@@ -32,6 +32,11 @@ namespace xls::dslx {
 //
 // Note that the given Module must have been typechecked.
 //
+// If `native_views` is set, every struct `Foo` also gets a `FooView` class
+// which reads and writes values of the struct held in the native layout of the
+// JIT (e.g. argument and result buffers of `FunctionJit::RunWithViews`) in
+// place, so no `xls::Value` needs to be built to cross into JIT-compiled code.
+//
 // The APIs emitted here are not guaranteed to be stable over time. For example,
 // we may define a C++ type "xls::u7" to represent a seven-bit quantity. That
 // being said, no such changes are planned (as of this writing) and any changes
@@ -41,7 +46,8 @@ namespace xls::dslx {
 absl::StatusOr<CppSource> TranspileToCpp(Module* module,
                                          ImportData* import_data,
                                          std::string_view output_header_path,
-                                         std::string_view namespaces = "");
+                                         std::string_view namespaces = "",
+                                         bool native_views = false);
 
 }  // namespace xls::dslx
 
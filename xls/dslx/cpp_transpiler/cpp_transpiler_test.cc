@@ -358,5 +358,68 @@ struct MyUnsupportedWideStruct {
               HasSubstr("enum class MyUnsupportedWideEnum : uint64_t"));
 }
 
+TEST(CppTranspilerTest, NativeViews) {
+  constexpr std::string_view kModule = R"(
+enum MyEnum : u3 {
+  A = 0,
+  B = 5,
+}
+
+struct Point {
+  x: u32,
+  y: u8,
+  z: s16[2],
+  e: MyEnum,
+}
+
+struct Line {
+  a: Point,
+  b: Point,
+}
+)";
+
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule module,
+      ParseAndTypecheck(kModule, "fake_path", "MyModule", &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CppSource result,
+      TranspileToCpp(module.module, &import_data, "/tmp/fake_path.h",
+                     /*namespaces=*/"", /*native_views=*/true));
+  EXPECT_THAT(result.header, HasSubstr("namespace xls_native_view {"));
+  EXPECT_THAT(result.header, HasSubstr("class PointView {"));
+  EXPECT_THAT(result.header, HasSubstr("static constexpr int64_t kSize = 12;"));
+  EXPECT_THAT(result.header, HasSubstr("::xls_native_view::Load<uint32_t, 32, "
+                                       "4>(buffer_ + 0)"));
+  EXPECT_THAT(result.header, HasSubstr("static constexpr int64_t kZSize = 2;"));
+  EXPECT_THAT(result.header, HasSubstr("::xls_native_view::Load<int16_t, 16, "
+                                       "2>(buffer_ + 6 + i * 2)"));
+  EXPECT_THAT(result.header, HasSubstr("void set_e(MyEnum value) {"));
+  EXPECT_THAT(result.header,
+              HasSubstr("::xls_native_view::Store<3, 1>(buffer_ + 10,"));
+  EXPECT_THAT(result.header,
+              HasSubstr("PointView b() const { return PointView(buffer_ + 12); "
+                        "}"));
+  EXPECT_THAT(result.header, HasSubstr("result.a = a().ToStruct();"));
+  EXPECT_THAT(result.header, HasSubstr("b().CopyFrom(value.b);"));
+}
+
+TEST(CppTranspilerTest, NativeViewsOfUnsupportedMembers) {
+  constexpr std::string_view kModule = R"(
+struct Foo {
+    a: (u32, u32),
+}
+)";
+
+  auto import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule module,
+      ParseAndTypecheck(kModule, "fake_path", "MyModule", &import_data));
+  EXPECT_THAT(TranspileToCpp(module.module, &import_data, "/tmp/fake_path.h",
+                             /*namespaces=*/"", /*native_views=*/true),
+              StatusIs(absl::StatusCode::kUnimplemented,
+                       HasSubstr("Native views do not support members")));
+}
+
 }  // namespace
 }  // namespace xls::dslx
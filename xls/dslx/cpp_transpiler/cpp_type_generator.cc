@@ -28,18 +28,25 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/indent.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/visitor.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
 #include "xls/dslx/bytecode/bytecode_interpreter.h"
 #include "xls/dslx/cpp_transpiler/cpp_emitter.h"
+#include "xls/dslx/cpp_transpiler/native_layouts.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
+#include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
+#include "xls/dslx/type_system/unwrap_meta_type.h"
+#include "xls/ir/type.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls::dslx {
 namespace {
@@ -409,6 +416,147 @@ class TypeAliasCppTypeGenerator : public CppTypeGenerator {
   std::unique_ptr<CppEmitter> emitter_;
 };
 
+// Describes how a value of some DSLX type is accessed through a native-layout
+// view: either as a C++ scalar (enums and bit vectors of at most 64 bits) or as
+// the view of a struct.
+struct NativeViewElement {
+  // The C++ type returned by the accessor.
+  std::string cpp_type;
+  bool is_struct = false;
+  // For scalars, the C++ integral type the value is loaded as and its width.
+  std::string load_type;
+  int64_t bit_count = 0;
+};
+
+absl::StatusOr<NativeViewElement> GetNativeViewElement(const Type& type) {
+  if (const auto* struct_type = dynamic_cast<const StructType*>(&type)) {
+    return NativeViewElement{
+        .cpp_type = absl::StrCat(
+            DslxTypeNameToCpp(struct_type->nominal_type().identifier()),
+            "View"),
+        .is_struct = true};
+  }
+  const auto* enum_type = dynamic_cast<const EnumType*>(&type);
+  std::optional<BitsLikeProperties> bits_like = GetBitsLike(type);
+  if (enum_type == nullptr && !bits_like.has_value()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Native views do not support members of type %s", type.ToString()));
+  }
+  XLS_ASSIGN_OR_RETURN(TypeDim bit_count_dim, type.GetTotalBitCount());
+  XLS_ASSIGN_OR_RETURN(int64_t bit_count, bit_count_dim.GetAsInt64());
+  if (bit_count > 64) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Native views do not support bit vectors wider than 64 bits: %s",
+        type.ToString()));
+  }
+  bool is_signed;
+  if (enum_type != nullptr) {
+    is_signed = enum_type->is_signed();
+  } else {
+    XLS_ASSIGN_OR_RETURN(is_signed, bits_like->is_signed.GetAsBool());
+  }
+  XLS_ASSIGN_OR_RETURN(std::string load_type,
+                       GetBitVectorCppType(bit_count, is_signed));
+  std::string cpp_type =
+      enum_type == nullptr
+          ? load_type
+          : DslxTypeNameToCpp(enum_type->nominal_type().identifier());
+  return NativeViewElement{.cpp_type = std::move(cpp_type),
+                           .load_type = std::move(load_type),
+                           .bit_count = bit_count};
+}
+
+// The code emitted for one member of a native-layout view.
+struct NativeViewMember {
+  // Accessor methods of the view.
+  std::string accessors;
+  // Statements copying the member from the view into `result` and from `value`
+  // into the view respectively.
+  std::string to_struct;
+  std::string copy_from;
+};
+
+// Returns the code of the view member `name` of DSLX type `type`, whose leaf
+// elements have the layouts `leaves` within the layout of the struct.
+absl::StatusOr<NativeViewMember> MakeNativeViewMember(
+    std::string_view name, const Type& type,
+    absl::Span<const ElementLayout> leaves) {
+  const int64_t offset = leaves.empty() ? 0 : leaves.front().offset;
+
+  // Arrays are accessed element-wise, so the accessors take an index.
+  std::optional<int64_t> array_size;
+  int64_t stride = 0;
+  const Type* element_type = &type;
+  if (const auto* array_type = dynamic_cast<const ArrayType*>(&type);
+      array_type != nullptr && !GetBitsLike(type).has_value()) {
+    XLS_ASSIGN_OR_RETURN(array_size, array_type->size().GetAsInt64());
+    element_type = &array_type->element_type();
+    if (*array_size > 1 && !leaves.empty()) {
+      int64_t element_leaves = leaves.size() / *array_size;
+      stride = leaves[element_leaves].offset - offset;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(NativeViewElement element,
+                       GetNativeViewElement(*element_type));
+
+  std::string index_param = array_size.has_value() ? "int64_t i" : "";
+  std::string index_arg = array_size.has_value() ? "i" : "";
+  std::string address =
+      array_size.has_value()
+          ? absl::StrFormat("buffer_ + %d + i * %d", offset, stride)
+          : absl::StrFormat("buffer_ + %d", offset);
+  std::string field = array_size.has_value() ? absl::StrCat(name, "[i]")
+                                             : std::string{name};
+
+  NativeViewMember member;
+  std::vector<std::string> accessors;
+  if (array_size.has_value()) {
+    accessors.push_back(
+        absl::StrFormat("static constexpr int64_t k%sSize = %d;",
+                        DslxTypeNameToCpp(name), *array_size));
+  }
+  if (element.is_struct) {
+    accessors.push_back(absl::StrFormat("%s %s(%s) const { return %s(%s); }",
+                                        element.cpp_type, name, index_param,
+                                        element.cpp_type, address));
+    member.to_struct = absl::StrFormat("result.%s = %s(%s).ToStruct();", field,
+                                       name, index_arg);
+    member.copy_from =
+        absl::StrFormat("%s(%s).CopyFrom(value.%s);", name, index_arg, field);
+  } else {
+    const ElementLayout& leaf = leaves.front();
+    accessors.push_back(absl::StrFormat(
+        "%s %s(%s) const {\n"
+        "  return static_cast<%s>(\n"
+        "      ::xls_native_view::Load<%s, %d, %d>(%s));\n"
+        "}",
+        element.cpp_type, name, index_param, element.cpp_type,
+        element.load_type, element.bit_count, leaf.data_size, address));
+    accessors.push_back(absl::StrFormat(
+        "void set_%s(%s%s value) {\n"
+        "  ::xls_native_view::Store<%d, %d>(%s,\n"
+        "                                  static_cast<uint64_t>(value));\n"
+        "}",
+        name, array_size.has_value() ? "int64_t i, " : "", element.cpp_type,
+        element.bit_count, leaf.padded_size, address));
+    member.to_struct =
+        absl::StrFormat("result.%s = %s(%s);", field, name, index_arg);
+    member.copy_from = absl::StrFormat(
+        "set_%s(%svalue.%s);", name,
+        array_size.has_value() ? "i, " : "", field);
+  }
+  member.accessors = absl::StrJoin(accessors, "\n");
+  if (array_size.has_value()) {
+    auto loop = [&](std::string_view statement) {
+      return absl::StrFormat("for (int64_t i = 0; i < %d; ++i) {\n  %s\n}",
+                             *array_size, statement);
+    };
+    member.to_struct = loop(member.to_struct);
+    member.copy_from = loop(member.copy_from);
+  }
+  return member;
+}
+
 // A type generator for emitting a C++ struct for representing a DSLX struct.
 class StructCppTypeGenerator : public CppTypeGenerator {
  public:
@@ -430,8 +578,8 @@ class StructCppTypeGenerator : public CppTypeGenerator {
   ~StructCppTypeGenerator() override = default;
 
   static absl::StatusOr<std::unique_ptr<StructCppTypeGenerator>> Create(
-      const StructDef* struct_def, TypeInfo* type_info,
-      ImportData* import_data) {
+      const StructDef* struct_def, TypeInfo* type_info, ImportData* import_data,
+      NativeLayouts* native_layouts) {
     std::vector<std::unique_ptr<CppEmitter>> member_emitters;
     for (const auto* m : struct_def->members()) {
       XLS_ASSIGN_OR_RETURN(std::unique_ptr<CppEmitter> emitter,
@@ -439,9 +587,15 @@ class StructCppTypeGenerator : public CppTypeGenerator {
                                               type_info, import_data));
       member_emitters.push_back(std::move(emitter));
     }
-    return std::make_unique<StructCppTypeGenerator>(
+    auto generator = std::make_unique<StructCppTypeGenerator>(
         DslxTypeNameToCpp(struct_def->identifier()), struct_def->identifier(),
         struct_def, std::move(member_emitters));
+    if (native_layouts != nullptr) {
+      XLS_ASSIGN_OR_RETURN(generator->native_view_,
+                           generator->NativeViewClass(type_info,
+                                                      *native_layouts));
+    }
+    return std::move(generator);
   }
 
   absl::StatusOr<CppSource> GetCppSource() const override {
@@ -492,6 +646,9 @@ class StructCppTypeGenerator : public CppTypeGenerator {
 
     std::string header =
         absl::StrFormat("struct %s {\n%s\n};", cpp_type(), Indent(members, 2));
+    if (native_view_.has_value()) {
+      absl::StrAppend(&header, "\n\n", *native_view_);
+    }
     std::string source =
         absl::StrJoin({from_value_method.source, to_value_method.source,
                        to_string_method.source, to_dslx_string_method.source,
@@ -654,16 +811,85 @@ class StructCppTypeGenerator : public CppTypeGenerator {
     };
   }
 
+  // Returns the declaration of `<cpp_type>View`, which accesses a value of the
+  // struct held in the native layout of the JIT in place.
+  absl::StatusOr<std::string> NativeViewClass(
+      TypeInfo* type_info, NativeLayouts& native_layouts) const {
+    std::optional<Type*> meta_type =
+        type_info->GetItem(struct_def_->name_def());
+    if (!meta_type.has_value()) {
+      return absl::InternalError(
+          absl::StrFormat("No type found for struct %s", dslx_type()));
+    }
+    XLS_ASSIGN_OR_RETURN(const Type* type, UnwrapMetaType(**meta_type));
+    const auto* struct_type = dynamic_cast<const StructType*>(type);
+    XLS_RET_CHECK(struct_type != nullptr) << type->ToString();
+    XLS_ASSIGN_OR_RETURN(TypeLayout layout,
+                         native_layouts.GetLayout(*struct_type));
+
+    std::vector<std::string> accessors;
+    std::vector<std::string> to_struct = {
+        absl::StrFormat("%s result;", cpp_type())};
+    std::vector<std::string> copy_from;
+    int64_t leaf = 0;
+    for (int64_t i = 0; i < struct_def_->size(); ++i) {
+      int64_t leaf_count =
+          layout.type()->AsTupleOrDie()->element_type(i)->leaf_count();
+      XLS_ASSIGN_OR_RETURN(
+          NativeViewMember member,
+          MakeNativeViewMember(cpp_member_names_[i],
+                               struct_type->GetMemberType(i),
+                               layout.elements().subspan(leaf, leaf_count)));
+      leaf += leaf_count;
+      accessors.push_back(member.accessors);
+      to_struct.push_back(member.to_struct);
+      copy_from.push_back(member.copy_from);
+    }
+    to_struct.push_back("return result;");
+
+    std::vector<std::string> pieces;
+    pieces.push_back(absl::StrFormat("static constexpr int64_t kSize = %d;",
+                                     layout.size()));
+    pieces.push_back("");
+    pieces.push_back(absl::StrFormat(
+        "explicit %sView(uint8_t* buffer) : buffer_(buffer) {}", cpp_type()));
+    pieces.push_back("uint8_t* buffer() const { return buffer_; }");
+    pieces.push_back("");
+    if (!accessors.empty()) {
+      pieces.push_back(absl::StrJoin(accessors, "\n"));
+      pieces.push_back("");
+    }
+    pieces.push_back(
+        absl::StrFormat("%s ToStruct() const {\n%s\n}", cpp_type(),
+                        Indent(absl::StrJoin(to_struct, "\n"), 2)));
+    pieces.push_back(absl::StrFormat(
+        "void CopyFrom(const %s& value) {\n%s\n}", cpp_type(),
+        Indent(absl::StrJoin(copy_from, "\n"), 2)));
+    std::string body = absl::StrJoin(pieces, "\n");
+
+    return absl::StrFormat(
+        "// View of a `%s` held in the native layout of the JIT, e.g. in an\n"
+        "// argument or result buffer of `FunctionJit::RunWithViews`. Members "
+        "are\n"
+        "// read and written in place; setters truncate values to the width "
+        "of the\n"
+        "// member. The view does not own the buffer.\n"
+        "class %sView {\n public:\n%s\n\n private:\n  uint8_t* buffer_;\n};",
+        cpp_type(), cpp_type(), Indent(body, 2));
+  }
+
   const StructDef* struct_def_;
   std::vector<std::unique_ptr<CppEmitter>> member_emitters_;
   std::vector<std::string> cpp_member_names_;
+  std::optional<std::string> native_view_;
 };
 
 }  // namespace
 
 /* static */ absl::StatusOr<std::unique_ptr<CppTypeGenerator>>
 CppTypeGenerator::Create(const TypeDefinition& type_definition,
-                         TypeInfo* type_info, ImportData* import_data) {
+                         TypeInfo* type_info, ImportData* import_data,
+                         NativeLayouts* native_layouts) {
   return absl::visit(
       Visitor{[&](const TypeAlias* type_alias)
                   -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
@@ -673,7 +899,8 @@ CppTypeGenerator::Create(const TypeDefinition& type_definition,
               [&](const StructDef* struct_def)
                   -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
                 return StructCppTypeGenerator::Create(struct_def, type_info,
-                                                      import_data);
+                                                      import_data,
+                                                      native_layouts);
               },
               [&](const EnumDef* enum_def)
                   -> absl::StatusOr<std::unique_ptr<CppTypeGenerator>> {
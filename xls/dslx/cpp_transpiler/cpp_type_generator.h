@@ -26,6 +26,8 @@
 
 namespace xls::dslx {
 
+class NativeLayouts;
+
 struct CppSource {
   std::string header;
   std::string source;
@@ -52,10 +54,12 @@ class CppTypeGenerator {
   // not a tuple or array).
   std::string dslx_type() const { return dslx_type_; }
 
-  // Returns a type generator for the given TypeDefinition.
+  // Returns a type generator for the given TypeDefinition. If `native_layouts`
+  // is given, generators for structs also emit a view of the struct in the
+  // native layout of the JIT (see `TranspileToCpp`).
   static absl::StatusOr<std::unique_ptr<CppTypeGenerator>> Create(
       const TypeDefinition& type_definition, TypeInfo* type_info,
-      ImportData* import_data);
+      ImportData* import_data, NativeLayouts* native_layouts = nullptr);
 
  protected:
   std::string cpp_type_;
@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/cpp_transpiler/native_layouts.h"
+
+#include <memory>
+
+#include "absl/memory/memory.h"
+#include "absl/status/statusor.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/ir_convert/ir_conversion_utils.h"
+#include "xls/dslx/type_system/parametric_env.h"
+#include "xls/dslx/type_system/type.h"
+#include "xls/ir/type.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls::dslx {
+
+/* static */ absl::StatusOr<std::unique_ptr<NativeLayouts>>
+NativeLayouts::Create() {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> jit, OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout, jit->CreateDataLayout());
+  return absl::WrapUnique(
+      new NativeLayouts(std::make_unique<JitRuntime>(data_layout)));
+}
+
+absl::StatusOr<TypeLayout> NativeLayouts::GetLayout(const Type& type) {
+  XLS_ASSIGN_OR_RETURN(xls::Type * ir_type,
+                       TypeToIr(&package_, type, ParametricEnv()));
+  return runtime_->CreateTypeLayout(ir_type);
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,50 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_CPP_TRANSPILER_NATIVE_LAYOUTS_H_
+#define XLS_DSLX_CPP_TRANSPILER_NATIVE_LAYOUTS_H_
+
+#include <memory>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "xls/dslx/type_system/type.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls::dslx {
+
+// Computes the native layout the JIT uses to hold values of DSLX types (e.g.
+// in the argument and result buffers of `FunctionJit::RunWithViews`). The
+// transpiler uses these to emit views which access such buffers in place.
+class NativeLayouts {
+ public:
+  static absl::StatusOr<std::unique_ptr<NativeLayouts>> Create();
+
+  // Returns the layout of values of the concrete DSLX type `type`. The layout
+  // refers to IR types owned by this object.
+  absl::StatusOr<TypeLayout> GetLayout(const Type& type);
+
+ private:
+  explicit NativeLayouts(std::unique_ptr<JitRuntime> runtime)
+      : package_("native_layouts"), runtime_(std::move(runtime)) {}
+
+  Package package_;
+  std::unique_ptr<JitRuntime> runtime_;
+};
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_CPP_TRANSPILER_NATIVE_LAYOUTS_H_
@@ -28,6 +28,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -472,10 +473,17 @@ DocRef MakeArrayLeader(const Array& n, Comments& comments, DocArena& arena) {
   return ConcatN(arena, pieces);
 }
 
-DocRef FmtFlatBody(const Array& n, Comments& comments, DocArena& arena) {
+// Returns the already-formatted doc -- used to join member docs that are
+// shared between alternative layouts.
+DocRef FmtDocRef(const DocRef& n, Comments& comments, DocArena& arena) {
+  return n;
+}
+
+DocRef FmtFlatBody(const Array& n, absl::Span<const DocRef> members,
+                   Comments& comments, DocArena& arena) {
   std::vector<DocRef> flat_pieces;
-  flat_pieces.push_back(FmtJoin<const Expr*>(n.members(), Joiner::kCommaSpace,
-                                             FmtExprPtr, comments, arena));
+  flat_pieces.push_back(FmtJoin<DocRef>(members, Joiner::kCommaSpace,
+                                        FmtDocRef, comments, arena));
   if (n.has_ellipsis()) {
     // Note: while zero members with ellipsis is invalid at type checking, we
     // may choose not to flag it as a parse-time error, in which case we could
@@ -491,13 +499,14 @@ DocRef FmtFlatBody(const Array& n, Comments& comments, DocArena& arena) {
   return ConcatN(arena, flat_pieces);
 }
 
-DocRef FmtBreakBody(const Array& n, Comments& comments, DocArena& arena) {
+DocRef FmtBreakBody(const Array& n, absl::Span<const DocRef> members,
+                    Comments& comments, DocArena& arena) {
   std::vector<DocRef> rest;
   rest.push_back(arena.break0());
 
   std::vector<DocRef> member_pieces;
-  member_pieces.push_back(FmtJoin<const Expr*>(
-      n.members(), Joiner::kCommaBreak1AsGroupTrailingCommaAlways, FmtExprPtr,
+  member_pieces.push_back(FmtJoin<DocRef>(
+      members, Joiner::kCommaBreak1AsGroupTrailingCommaAlways, FmtDocRef,
       comments, arena));
 
   if (n.has_ellipsis()) {
@@ -514,12 +523,32 @@ DocRef FmtBreakBody(const Array& n, Comments& comments, DocArena& arena) {
 }
 
 DocRef Fmt(const Array& n, Comments& comments, DocArena& arena) {
-  DocRef on_break_body = FmtBreakBody(n, comments, arena);
-  DocRef on_flat_body = FmtFlatBody(n, comments, arena);
+  // Members are formatted once and their docs shared by both layouts below;
+  // formatting them per-layout would make nested array literals take time
+  // exponential in their depth.
+  std::vector<DocRef> members;
+  members.reserve(n.members().size());
+  for (const Expr* member : n.members()) {
+    members.push_back(FmtExprPtr(member, comments, arena));
+  }
+
+  DocRef on_break_body = FmtBreakBody(n, members, comments, arena);
+  DocRef leader = MakeArrayLeader(n, comments, arena);
+
+  // If some member can't be emitted flat (e.g. it carries a comment) the group
+  // below would always select the break layout, so we skip building the flat
+  // alternative.
+  auto cannot_be_flat = [&](DocRef member) {
+    return pprint_internal::IsInfinite(arena.Deref(member).flat_requirement);
+  };
+  if (absl::c_any_of(members, cannot_be_flat)) {
+    return arena.MakeConcat(leader, on_break_body);
+  }
 
+  DocRef on_flat_body = FmtFlatBody(n, members, comments, arena);
   DocRef body = arena.MakeGroup(arena.MakeFlatChoice(
       /*on_flat=*/on_flat_body, /*on_break=*/on_break_body));
-  return arena.MakeConcat(MakeArrayLeader(n, comments, arena), body);
+  return arena.MakeConcat(leader, body);
 }
 
 DocRef Fmt(const Attr& n, Comments& comments, DocArena& arena) {
@@ -21,6 +21,7 @@
 #include <string_view>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
@@ -29,6 +30,7 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -1385,6 +1387,14 @@ TEST_F(ModuleFmtTest, ConstantDefArrayEllipsis) {
   DoFmt("pub const VALS = u32[2]:[32, ...];\n");
 }
 
+// Array members are formatted once regardless of how many layouts are
+// considered for the enclosing array, so deep nesting stays cheap.
+TEST_F(ModuleFmtTest, ConstantDefDeeplyNestedArray) {
+  constexpr int64_t kDepth = 32;
+  DoFmt(absl::StrCat("const A = ", std::string(kDepth, '['), "u32:1",
+                     std::string(kDepth, ']'), ";\n"));
+}
+
 // We want these arrays to not have e.g. extra newlines introduced between them,
 // since they are abutted.
 TEST_F(ModuleFmtTest, ConstantDefMultipleArray) {
@@ -3486,5 +3496,53 @@ TEST_F(ModuleFmtTest, TupleWithMultipleComments_GH_1678) {
 )");
 }
 
+// Parses `text` once and then auto-formats it on every benchmark iteration.
+void BenchmarkAutoFmt(benchmark::State& state, const std::string& text) {
+  FileTable file_table;
+  std::vector<CommentData> comments_vec;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Module> m,
+      ParseModule(text, "fake.x", "fake", file_table, &comments_vec));
+  AllErrorsFilesystem vfs;
+  for (auto _ : state) {
+    Comments comments = Comments::Create(comments_vec);
+    absl::StatusOr<std::string> formatted = AutoFmt(vfs, *m, comments, text);
+    CHECK_OK(formatted.status());
+    benchmark::DoNotOptimize(formatted);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void BM_AutoFmtLargeArrayLiteral(benchmark::State& state) {
+  std::string text = absl::StrCat("const A = u32[", state.range(0), "]:[");
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    absl::StrAppend(&text, i == 0 ? "" : ", ", i);
+  }
+  absl::StrAppend(&text, "];\n");
+  BenchmarkAutoFmt(state, text);
+}
+
+void BM_AutoFmtNestedArrays(benchmark::State& state) {
+  BenchmarkAutoFmt(state, absl::StrCat("const A = ",
+                                       std::string(state.range(0), '['), "1",
+                                       std::string(state.range(0), ']'),
+                                       ";\n"));
+}
+
+// One small function per ~3 lines, to approximate large hand-written modules.
+void BM_AutoFmtManyFunctions(benchmark::State& state) {
+  std::string text;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    absl::StrAppend(&text, "fn f", i,
+                    "(x: u32, y: u32) -> u32 {\n    let z = x + y;\n    "
+                    "if z > u32:", i, " { z } else { [x, y, z][1] }\n}\n\n");
+  }
+  BenchmarkAutoFmt(state, text);
+}
+
+BENCHMARK(BM_AutoFmtLargeArrayLiteral)->Range(1024, 1 << 20);
+BENCHMARK(BM_AutoFmtNestedArrays)->DenseRange(4, 64, 12);
+BENCHMARK(BM_AutoFmtManyFunctions)->Range(64, 32768);
+
 }  // namespace
 }  // namespace xls::dslx
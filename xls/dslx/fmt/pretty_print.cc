@@ -30,7 +30,6 @@
 #include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
-#include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
@@ -126,8 +125,7 @@ bool operator<=(Requirement lhs, Requirement rhs) {
 }
 
 void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
-                         const int64_t default_text_width,
-                         std::vector<std::string>& pieces) {
+                         const int64_t default_text_width, std::string& out) {
   VLOG(1) << "PrettyPrintInternal; default text width: " << default_text_width;
 
   // We maintain a stack to keep track of doc emission we still need to perform.
@@ -145,17 +143,19 @@ void PrettyPrintInternal(const DocArena& arena, const Doc& doc,
   // avoid whitespace before newlines on newline-only lines.
   int64_t virtual_outcol = 0;
 
+  // Text is appended directly to `out` -- building it up as a sequence of
+  // separately allocated pieces dominated formatting time for large modules.
   auto emit = [&](std::string_view s) {
     if (real_outcol < virtual_outcol) {
-      pieces.push_back(std::string(virtual_outcol - real_outcol, ' '));
+      out.append(virtual_outcol - real_outcol, ' ');
       real_outcol = virtual_outcol;
     }
-    pieces.push_back(std::string{s});
+    out.append(s);
     real_outcol += s.size();
     virtual_outcol += s.size();
   };
   auto emit_cr = [&](int64_t indent) {
-    pieces.push_back("\n");
+    out.push_back('\n');
     real_outcol = 0;
     virtual_outcol = indent;
   };
@@ -593,9 +593,9 @@ DocRef DocArena::Make(Keyword kw) {
 }
 
 std::string PrettyPrint(const DocArena& arena, DocRef ref, int64_t text_width) {
-  std::vector<std::string> pieces;
-  PrettyPrintInternal(arena, arena.Deref(ref), text_width, pieces);
-  return absl::StrJoin(pieces, "");
+  std::string out;
+  PrettyPrintInternal(arena, arena.Deref(ref), text_width, out);
+  return out;
 }
 
 DocRef DocArena::MakeZeroIndent(DocRef arg_ref) {
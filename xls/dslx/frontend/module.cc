@@ -97,10 +97,10 @@ std::string Module::ToString() const {
 }
 
 const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes_) {
     if (node->kind() == kind && node->GetSpan().has_value() &&
         node->GetSpan().value() == target) {
-      return node.get();
+      return node;
     }
   }
   return nullptr;
@@ -108,9 +108,9 @@ const AstNode* Module::FindNode(AstNodeKind kind, const Span& target) const {
 
 std::vector<const AstNode*> Module::FindIntercepting(const Pos& target) const {
   std::vector<const AstNode*> found;
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes_) {
     if (node->GetSpan().has_value() && node->GetSpan()->Contains(target)) {
-      found.push_back(node.get());
+      found.push_back(node);
     }
   }
   return found;
@@ -118,10 +118,10 @@ std::vector<const AstNode*> Module::FindIntercepting(const Pos& target) const {
 
 std::vector<const AstNode*> Module::FindContained(const Span& target) const {
   std::vector<const AstNode*> found;
-  for (const auto& node : nodes_) {
+  for (const AstNode* node : nodes_) {
     if (std::optional<Span> node_span = node->GetSpan();
         node_span.has_value() && target.Contains(node_span.value())) {
-      found.push_back(node.get());
+      found.push_back(node);
     }
   }
   return found;
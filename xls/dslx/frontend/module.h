@@ -34,6 +34,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/data_structures/object_arena.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/proc.h"
@@ -277,12 +278,10 @@ class Module : public AstNode {
  private:
   template <typename T, typename... Args>
   T* MakeInternal(Args&&... args) {
-    std::unique_ptr<T> node =
-        std::make_unique<T>(this, std::forward<Args>(args)...);
-    T* ptr = node.get();
-    ptr->SetParentage();
-    nodes_.push_back(std::move(node));
-    return ptr;
+    T* node = arena_->New<T>(this, std::forward<Args>(args)...);
+    node->SetParentage();
+    nodes_.push_back(node);
+    return node;
   }
 
   // Returns all of the elements of top_ that have the given variant type T.
@@ -320,7 +319,11 @@ class Module : public AstNode {
   FileTable* file_table_;
 
   std::vector<ModuleMember> top_;  // Top-level members of this module.
-  std::vector<std::unique_ptr<AstNode>> nodes_;  // Lifetime-owned AST nodes.
+  // Lifetime owner of the AST nodes. Parsing creates a great many small nodes,
+  // so they are bump-allocated rather than allocated individually, which also
+  // makes destroying a module cheaper. Held by pointer to keep Module movable.
+  std::unique_ptr<ObjectArena> arena_ = std::make_unique<ObjectArena>();
+  std::vector<AstNode*> nodes_;  // All AST nodes, in creation order.
 
   // Map of top-level module member name to the member itself.
   absl::flat_hash_map<std::string, ModuleMember> top_by_name_;
@@ -536,7 +536,7 @@ Parser::ParseAttribute(absl::flat_hash_map<std::string, Function*>* name_to_fn,
       Token attribute_tok,
       PopTokenOrError(TokenKind::kIdentifier, /*start=*/nullptr,
                       "Expected attribute identifier"));
-  const std::string& attribute_name = attribute_tok.GetStringValue();
+  std::string_view attribute_name = attribute_tok.GetStringValue();
 
   if (attribute_name == "test") {
     XLS_ASSIGN_OR_RETURN(Token cbrack, PopTokenOrError(TokenKind::kCBrack));
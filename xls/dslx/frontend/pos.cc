@@ -24,6 +24,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "re2/re2.h"
 
 namespace xls::dslx {
@@ -32,6 +33,7 @@ Fileno FileTable::GetOrCreate(std::string_view path) {
   CHECK(!absl::StartsWith(path, "file://"))
       << "FileTable does not support URIs as paths: " << path;
   VLOG(5) << absl::StreamFormat("FileTable::GetOrCreate: %s", path);
+  absl::MutexLock lock(mutex_.get());
   auto it = path_to_number_.find(path);
   if (it == path_to_number_.end()) {
     Fileno this_fileno = next_fileno_++;
@@ -17,16 +17,20 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/strong_int.h"
 
 namespace xls::dslx {
@@ -38,9 +42,12 @@ XLS_DEFINE_STRONG_INT_TYPE(Fileno, uint32_t);
 // Holds file paths in an "interned" arena that can be indexed by a file
 // number. This prevents string copies for "flyweight" style objects like
 // `Pos`.
+//
+// Thread-safe, so modules may be parsed concurrently against the same table.
 class FileTable {
  public:
   FileTable() {
+    absl::MutexLock lock(mutex_.get());
     number_to_path_.emplace(Fileno(0), "<no-file>");
     path_to_number_.emplace("<no-file>", Fileno(0));
   }
@@ -58,12 +65,14 @@ class FileTable {
   Fileno GetOrCreate(std::string_view path);
 
   std::string_view Get(Fileno fileno) const {
+    absl::MutexLock lock(mutex_.get());
     DCHECK(number_to_path_.contains(fileno))
         << "fileno " << fileno.value() << " not found in FileTable";
     return number_to_path_.at(fileno);
   }
 
   std::string ToString() const {
+    absl::MutexLock lock(mutex_.get());
     std::string res = "FileTable:\n";
     std::vector<Fileno> filenos;
     for (const auto& [n, _] : number_to_path_) {
@@ -78,9 +87,14 @@ class FileTable {
   }
 
  private:
-  Fileno next_fileno_ = Fileno(1);
-  absl::flat_hash_map<Fileno, std::string> number_to_path_;
-  absl::flat_hash_map<std::string, Fileno> path_to_number_;
+  // Held by pointer to keep FileTable movable.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
+  Fileno next_fileno_ ABSL_GUARDED_BY(*mutex_) = Fileno(1);
+  // Node-based so the views returned by Get() stay valid as files are added.
+  absl::node_hash_map<Fileno, std::string> number_to_path_
+      ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<std::string, Fileno> path_to_number_
+      ABSL_GUARDED_BY(*mutex_);
 };
 
 // Represents a position in the text (file, line, column).
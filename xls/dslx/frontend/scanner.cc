@@ -102,11 +102,12 @@ Token Scanner::PopComment(const Pos& start_pos, bool allow_multiline) {
 
 absl::StatusOr<Token> Scanner::PopWhitespace(const Pos& start_pos) {
   CHECK(AtWhitespace());
-  std::string chars;
+  const int64_t start = index_;
   while (!AtCharEof() && AtWhitespace()) {
-    chars.append(1, PopChar());
+    DropChar();
   }
-  return Token(TokenKind::kWhitespace, Span(start_pos, GetPos()), chars);
+  return Token::MakeView(TokenKind::kWhitespace, Span(start_pos, GetPos()),
+                         TextFrom(start));
 }
 
 // This is too simple to need to return absl::Status. Just never call it
@@ -307,12 +308,12 @@ absl::StatusOr<Token> Scanner::ScanIdentifierOrKeyword(char startc,
     return std::isalpha(c) != 0 || std::isdigit(c) != 0 || c == '_' ||
            c == '!' || c == '\'';
   };
-  std::string s = ScanWhile(startc, is_trailing_identifier_char);
+  std::string_view s = ScanWhile(index_ - 1, is_trailing_identifier_char);
   Span span(start_pos, GetPos());
   if (std::optional<Keyword> keyword = GetKeyword(s)) {
     return Token(span, *keyword);
   }
-  return Token(TokenKind::kIdentifier, span, std::move(s));
+  return Token::MakeView(TokenKind::kIdentifier, span, s);
 }
 
 std::optional<CommentData> Scanner::TryPopComment(bool allow_multiline) {
@@ -351,18 +352,22 @@ absl::StatusOr<Token> Scanner::ScanString(const Pos& start_pos) {
         Span(start_pos, GetPos()),
         "Expected close quote character to terminate open quote character.");
   }
-  return Token(TokenKind::kString, Span(start_pos, GetPos()), value);
+  return Token::MakeView(TokenKind::kString, Span(start_pos, GetPos()),
+                         Intern(std::move(value)));
 }
 
 absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
-  bool negative = startc == '-';
-  if (negative) {
+  // `startc` has already been popped.
+  const int64_t start = index_ - 1;
+  if (startc == '-') {
     startc = PopChar();
   }
 
-  std::string s;
+  // The number without its sign.
+  const int64_t digits_start = index_ - 1;
+  std::string_view s;
   if (startc == '0' && TryDropChar('x')) {  // Hex radix.
-    s = ScanWhile("0x", [](char c) {
+    s = ScanWhile(digits_start, [](char c) {
       return ('0' <= c && c <= '9') || ('a' <= c && c <= 'f') ||
              ('A' <= c && c <= 'F') || c == '_';
     });
@@ -371,7 +376,7 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
                              "Expected hex characters following 0x prefix.");
     }
   } else if (startc == '0' && TryDropChar('b')) {  // Bin prefix.
-    s = ScanWhile("0b",
+    s = ScanWhile(digits_start,
                   [](char c) { return ('0' <= c && c <= '1') || c == '_'; });
     if (s == "0b") {
       return ScanErrorStatus(Span(GetPos(), GetPos()),
@@ -383,7 +388,7 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
           absl::StrFormat("Invalid digit for binary number: '%c'", PeekChar()));
     }
   } else {
-    s = ScanWhile(startc, [](char c) { return std::isdigit(c) != 0; });
+    s = ScanWhile(digits_start, [](char c) { return std::isdigit(c) != 0; });
     if (absl::StartsWith(s, "0") && s.size() != 1) {
       return ScanErrorStatus(
           Span(GetPos(), GetPos()),
@@ -392,10 +397,10 @@ absl::StatusOr<Token> Scanner::ScanNumber(char startc, const Pos& start_pos) {
     CHECK(!s.empty())
         << "Must have seen numerical digits to attempt to scan a number.";
   }
-  if (negative) {
-    s = "-" + s;
-  }
-  return Token(TokenKind::kNumber, Span(start_pos, GetPos()), s);
+  // The sign immediately precedes the digits, so the number is the text
+  // scanned since `start`.
+  return Token::MakeView(TokenKind::kNumber, Span(start_pos, GetPos()),
+                         TextFrom(start));
 }
 
 bool Scanner::AtWhitespace() const {
@@ -442,8 +447,8 @@ absl::StatusOr<Token> Scanner::ScanChar(const Pos& start_pos) {
         AtCharEof() ? std::string("end of file") : std::string(1, PeekChar()));
     return ScanErrorStatus(Span(GetPos(), GetPos()), msg);
   }
-  return Token(TokenKind::kCharacter, Span(start_pos, GetPos()),
-               std::string(1, c));
+  return Token::MakeView(TokenKind::kCharacter, Span(start_pos, GetPos()),
+                         Intern(std::string(1, c)));
 }
 
 absl::StatusOr<Token> Scanner::Pop() {
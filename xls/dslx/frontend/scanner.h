@@ -16,7 +16,6 @@
 #define XLS_DSLX_FRONTEND_SCANNER_H_
 
 #include <cstdint>
-#include <functional>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -24,6 +23,7 @@
 #include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/container/node_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -50,6 +50,11 @@ absl::Status ScanErrorStatus(const Span& span, std::string_view message,
 
 // Converts the conceptual character stream in a string of text into a stream of
 // tokens according to the DSLX syntax.
+//
+// Popped tokens don't copy their values out of the text: identifiers, numbers
+// and whitespace are views of the scanner's text, and the unescaped values of
+// string and character literals are interned by the scanner. Such tokens are
+// only valid while the scanner is alive (see Token::ToOwned()).
 class Scanner {
  public:
   Scanner(FileTable& file_table, Fileno fileno, std::string text,
@@ -59,6 +64,10 @@ class Scanner {
         text_(std::move(text)),
         include_whitespace_and_comments_(include_whitespace_and_comments) {}
 
+  // Tokens refer to the text, so the scanner stays put.
+  Scanner(const Scanner&) = delete;
+  Scanner& operator=(const Scanner&) = delete;
+
   // Gets the current position in the token stream. Note that the position in
   // the token stream can change on a Pop(), because whitespace and comments
   // may be discarded.
@@ -76,12 +85,13 @@ class Scanner {
   absl::StatusOr<Token> Pop();
 
   // Pops all tokens from the token stream until it is extinguished (as
-  // determined by `AtEof()`) and returns them as a sequence.
+  // determined by `AtEof()`) and returns them as a sequence. The tokens own
+  // their values, so they may outlive the scanner.
   absl::StatusOr<std::vector<Token>> PopAll() {
     std::vector<Token> tokens;
     while (!AtEof()) {
       XLS_ASSIGN_OR_RETURN(Token tok, Pop());
-      tokens.push_back(tok);
+      tokens.push_back(tok.ToOwned());
     }
     return tokens;
   }
@@ -147,19 +157,24 @@ class Scanner {
   absl::StatusOr<Token> ScanChar(const Pos& start_pos);
 
   // Scans from the current position until ftake returns false or EOF is
-  // reached.
-  std::string ScanWhile(std::string s, const std::function<bool(char)>& ftake) {
-    while (!AtCharEof()) {
-      char peek = PeekChar();
-      if (!ftake(peek)) {
-        break;
-      }
-      s.append(1, PopChar());
+  // reached. Returns the text from index `start` to the new position.
+  template <typename TakeFn>
+  std::string_view ScanWhile(int64_t start, TakeFn ftake) {
+    while (!AtCharEof() && ftake(PeekChar())) {
+      DropChar();
     }
-    return s;
+    return TextFrom(start);
   }
-  std::string ScanWhile(char c, const std::function<bool(char)>& ftake) {
-    return ScanWhile(std::string(1, c), ftake);
+
+  // Returns the text from index `start` to the current position.
+  std::string_view TextFrom(int64_t start) const {
+    return std::string_view(text_).substr(start, index_ - start);
+  }
+
+  // Returns a view of a copy of `s` owned by the scanner; equal strings share
+  // one copy.
+  std::string_view Intern(std::string s) {
+    return *interned_.insert(std::move(s)).first;
   }
 
   // Scans the identifier-looping entity beginning with startc.
@@ -273,6 +288,8 @@ class Scanner {
   int64_t colno_ = 0;
   bool double_c_angle_enabled_ = true;
   std::vector<CommentData> comments_;
+  // Node-based so that views of the strings stay valid as more are added.
+  absl::node_hash_set<std::string> interned_;
 };
 
 }  // namespace xls::dslx
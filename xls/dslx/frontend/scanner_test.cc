@@ -500,4 +500,23 @@ bar  // another thing
   }
 }
 
+// Popped tokens view the scanner's text rather than copying it, and equal
+// literal values share one interned copy.
+TEST(ScannerTest, TokensDoNotCopyValues) {
+  FileTable file_table;
+  Scanner s(file_table, Fileno(0), R"(foo -0x2a "a\tb" "a\tb" foo)");
+  XLS_ASSERT_OK_AND_ASSIGN(Token foo, s.Pop());
+  XLS_ASSERT_OK_AND_ASSIGN(Token number, s.Pop());
+  XLS_ASSERT_OK_AND_ASSIGN(Token string0, s.Pop());
+  XLS_ASSERT_OK_AND_ASSIGN(Token string1, s.Pop());
+  XLS_ASSERT_OK_AND_ASSIGN(Token foo_again, s.Pop());
+
+  EXPECT_TRUE(foo.IsIdentifier("foo"));
+  EXPECT_EQ(number.GetStringValue(), "-0x2a");
+  EXPECT_EQ(number.GetStringValue().data(), foo.GetStringValue().data() + 4);
+  EXPECT_EQ(string0.GetStringValue(), "a\tb");
+  EXPECT_EQ(string0.GetStringValue().data(), string1.GetStringValue().data());
+  EXPECT_EQ(foo_again.GetStringValue(), "foo");
+}
+
 }  // namespace xls::dslx
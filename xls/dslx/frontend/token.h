@@ -104,15 +104,35 @@ std::optional<Keyword> KeywordFromString(std::string_view s);
 const absl::flat_hash_set<Keyword>& GetTypeKeywords();
 
 // Token yielded by the Scanner below.
+//
+// The string value of a token is either owned by the token or, for tokens made
+// with MakeView (as the Scanner does), a view of characters owned by someone
+// else; copying such tokens doesn't copy their values.
 class Token {
  public:
   Token(TokenKind kind, Span span,
         std::optional<std::string> value = std::nullopt)
-      : kind_(kind), span_(std::move(span)), payload_(value) {}
+      : kind_(kind), span_(std::move(span)), payload_(std::move(value)) {}
 
   Token(Span span, Keyword keyword)
       : kind_(TokenKind::kKeyword), span_(std::move(span)), payload_(keyword) {}
 
+  // Returns a token whose value is a view of `value`, which must outlive the
+  // token and all of its copies.
+  static Token MakeView(TokenKind kind, Span span, std::string_view value) {
+    Token token(kind, std::move(span));
+    token.payload_ = value;
+    return token;
+  }
+
+  // Returns a copy of this token which owns its value.
+  Token ToOwned() const {
+    if (std::holds_alternative<Keyword>(payload_)) {
+      return *this;
+    }
+    return Token(kind_, span_, GetValue());
+  }
+
   TokenKind kind() const { return kind_; }
   const Span& span() const { return span_; }
 
@@ -120,11 +140,17 @@ class Token {
     if (std::holds_alternative<Keyword>(payload_)) {
       return KeywordToString(GetKeyword());
     }
+    if (const auto* view = std::get_if<std::string_view>(&payload_)) {
+      return std::string(*view);
+    }
     return std::get<std::optional<std::string>>(payload_);
   }
 
   // Note: assumes that the payload is not a keyword.
-  const std::string& GetStringValue() const {
+  std::string_view GetStringValue() const {
+    if (const auto* view = std::get_if<std::string_view>(&payload_)) {
+      return *view;
+    }
     return *std::get<std::optional<std::string>>(payload_);
   }
 
@@ -146,10 +172,10 @@ class Token {
     return kind_ == TokenKind::kKeyword && GetKeyword() == target;
   }
   bool IsIdentifier(std::string_view target) const {
-    return kind_ == TokenKind::kIdentifier && *GetValue() == target;
+    return kind_ == TokenKind::kIdentifier && GetStringValue() == target;
   }
   bool IsNumber(std::string_view target) const {
-    return kind_ == TokenKind::kNumber && *GetValue() == target;
+    return kind_ == TokenKind::kNumber && GetStringValue() == target;
   }
 
   bool IsKindIn(
@@ -168,9 +194,17 @@ class Token {
     return false;
   }
 
+  // Owned and viewed values compare by their contents.
   bool operator==(const Token& other) const {
-    return kind_ == other.kind_ && span_ == other.span_ &&
-           payload_ == other.payload_;
+    if (kind_ != other.kind_ || span_ != other.span_) {
+      return false;
+    }
+    if (std::holds_alternative<Keyword>(payload_) ||
+        std::holds_alternative<Keyword>(other.payload_)) {
+      return payload_ == other.payload_;
+    }
+    return HasValue() == other.HasValue() &&
+           (!HasValue() || GetStringValue() == other.GetStringValue());
   }
   bool operator!=(const Token& other) const { return !(*this == other); }
 
@@ -183,9 +217,14 @@ class Token {
   std::string ToRepr(const FileTable& file_table) const;
 
  private:
+  bool HasValue() const {
+    const auto* owned = std::get_if<std::optional<std::string>>(&payload_);
+    return owned == nullptr || owned->has_value();
+  }
+
   TokenKind kind_;
   Span span_;
-  std::variant<std::optional<std::string>, Keyword> payload_;
+  std::variant<std::optional<std::string>, Keyword, std::string_view> payload_;
 };
 
 }  // namespace xls::dslx
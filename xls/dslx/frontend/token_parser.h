@@ -16,12 +16,11 @@
 #define XLS_DSLX_FRONTEND_TOKEN_PARSER_H_
 
 #include <cstdint>
-#include <memory>
+#include <deque>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
-#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/log/die_if_null.h"
@@ -59,7 +58,7 @@ class TokenParser {
   // position the token stream.
   Pos GetPos() const {
     if (index_ < tokens_.size()) {
-      return tokens_[index_]->span().start();
+      return tokens_[index_].span().start();
     }
     return scanner_->GetPos();
   }
@@ -120,17 +119,20 @@ class TokenParser {
   absl::StatusOr<const Token*> PeekToken() {
     if (index_ >= tokens_.size()) {
       XLS_ASSIGN_OR_RETURN(Token token, scanner_->Pop());
-      tokens_.push_back(std::make_unique<Token>(std::move(token)));
+      tokens_.push_back(std::move(token));
     }
-    return tokens_[index_].get();
+    return &tokens_[index_];
   }
 
   // Returns a token that has been popped destructively from the token stream.
+  //
+  // Tokens view the scanner's text, so this is cheap, and so is popping the
+  // same tokens again after restoring a checkpoint.
   absl::StatusOr<Token> PopToken() {
     if (index_ >= tokens_.size()) {
       XLS_RETURN_IF_ERROR(PeekToken().status());
     }
-    Token token = *tokens_[index_];
+    Token token = tokens_[index_];
     index_ += 1;
     return token;
   }
@@ -192,9 +194,10 @@ class TokenParser {
  private:
   Scanner* scanner_;
   int64_t index_;
-  // A vector of std::unique_ptrs is used for pointer stability as pointers are
-  // handed out by PeekToken
-  std::vector<std::unique_ptr<Token>> tokens_;
+  // Every token scanned so far, so that restoring a checkpoint never re-scans.
+  // A deque is used for pointer stability as pointers are handed out by
+  // PeekToken.
+  std::deque<Token> tokens_;
 };
 
 }  // namespace xls::dslx
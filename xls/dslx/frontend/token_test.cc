@@ -14,6 +14,8 @@
 
 #include "xls/dslx/frontend/token.h"
 
+#include <string>
+
 #include "gtest/gtest.h"
 #include "xls/dslx/frontend/pos.h"
 
@@ -65,5 +67,20 @@ TEST(TokenTest, IdentifierTokenAccessors) {
   EXPECT_FALSE(token.IsKindIn({Keyword::kFn}));
 }
 
+TEST(TokenTest, ViewedValueComparesByContents) {
+  std::string text = "my_identifier";
+  Token view = Token::MakeView(TokenKind::kIdentifier, FakeSpan(), text);
+  Token owned(TokenKind::kIdentifier, FakeSpan(), "my_identifier");
+  EXPECT_EQ(view, owned);
+  EXPECT_EQ(view.GetStringValue().data(), text.data());
+  EXPECT_TRUE(view.IsIdentifier("my_identifier"));
+  EXPECT_NE(view, Token(TokenKind::kIdentifier, FakeSpan(), "other"));
+  EXPECT_NE(view, Token(TokenKind::kIdentifier, FakeSpan()));
+
+  Token copy = view.ToOwned();
+  text = "clobbered";
+  EXPECT_EQ(copy, owned);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -82,7 +82,7 @@ std::string ToHighlightStr(const Token& t) {
     case TokenKind::kComment:
       return HandleComment(t.ToString());
     case TokenKind::kIdentifier: {
-      const std::string& value = t.GetStringValue();
+      std::string_view value = t.GetStringValue();
       if (IsNameParametricBuiltin(value)) {
         return HandleBuiltin(value);
       }
@@ -19,10 +19,12 @@
 #include <memory>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/meta/type_traits.h"
@@ -33,6 +35,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
@@ -53,6 +56,7 @@ namespace xls::dslx {
 }
 
 absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) const {
+  absl::MutexLock lock(mutex_.get());
   auto it = modules_.find(subject);
   if (it == modules_.end()) {
     return absl::NotFoundError("Module information was not found for import " +
@@ -64,6 +68,7 @@ absl::StatusOr<ModuleInfo*> ImportData::Get(const ImportTokens& subject) const {
 absl::StatusOr<ModuleInfo*> ImportData::Put(
     const ImportTokens& subject, std::unique_ptr<ModuleInfo> module_info) {
   auto* pmodule_info = module_info.get();
+  absl::MutexLock lock(mutex_.get());
   auto [it, inserted] = modules_.emplace(subject, std::move(module_info));
   if (!inserted) {
     return absl::InvalidArgumentError(
@@ -73,6 +78,38 @@ absl::StatusOr<ModuleInfo*> ImportData::Put(
   return pmodule_info;
 }
 
+void ImportData::EvictModules(const absl::flat_hash_set<std::string>& paths) {
+  // Destroyed after the lock is released.
+  std::vector<std::unique_ptr<ModuleInfo>> evicted;
+  absl::MutexLock lock(mutex_.get());
+  absl::flat_hash_set<const Module*> loaded;
+  for (auto it = modules_.begin(); it != modules_.end();) {
+    std::string path = it->second->path().string();
+    if (paths.contains(path)) {
+      path_to_module_info_.erase(path);
+      evicted.push_back(std::move(it->second));
+      modules_.erase(it++);
+    } else {
+      loaded.insert(&it->second->module());
+      ++it;
+    }
+  }
+
+  auto not_loaded = [&](const Module* module) {
+    return !loaded.contains(module);
+  };
+  auto key_not_loaded = [&](const auto& item) {
+    return not_loaded(item.first);
+  };
+  absl::erase_if(top_level_bindings_, key_not_loaded);
+  absl::erase_if(top_level_bindings_done_, not_loaded);
+  absl::erase_if(typecheck_wip_, key_not_loaded);
+  absl::erase_if(instantiation_mutexes_, key_not_loaded);
+  absl::erase_if(reachable_members_, key_not_loaded);
+  absl::erase_if(constexpr_results_, key_not_loaded);
+  type_info_owner_.EraseIf(not_loaded);
+}
+
 absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfoForNode(
     const AstNode* node) {
   XLS_RET_CHECK(node != nullptr);
@@ -92,6 +129,7 @@ absl::StatusOr<TypeInfo*> ImportData::GetRootTypeInfo(const Module* module) {
 }
 
 InterpBindings& ImportData::GetOrCreateTopLevelBindings(Module* module) {
+  absl::MutexLock lock(mutex_.get());
   auto it = top_level_bindings_.find(module);
   if (it == top_level_bindings_.end()) {
     it = top_level_bindings_
@@ -104,6 +142,7 @@ InterpBindings& ImportData::GetOrCreateTopLevelBindings(Module* module) {
 
 void ImportData::SetTopLevelBindings(Module* module,
                                      std::unique_ptr<InterpBindings> tlb) {
+  absl::MutexLock lock(mutex_.get());
   auto it = top_level_bindings_.emplace(module, std::move(tlb));
   CHECK(it.second) << "Module already had top level bindings: "
                    << module->name();
@@ -152,7 +191,17 @@ absl::StatusOr<const ProcDef*> ImportData::FindProcDef(const Span& span) const {
   return proc_def;
 }
 
+absl::Mutex& ImportData::GetInstantiationMutex(const Module* module) {
+  absl::MutexLock lock(mutex_.get());
+  std::unique_ptr<absl::Mutex>& mutex = instantiation_mutexes_[module];
+  if (mutex == nullptr) {
+    mutex = std::make_unique<absl::Mutex>();
+  }
+  return *mutex;
+}
+
 absl::StatusOr<const Module*> ImportData::FindModule(const Span& span) const {
+  absl::MutexLock lock(mutex_.get());
   auto it = path_to_module_info_.find(span.GetFilename(file_table_));
   if (it == path_to_module_info_.end()) {
     std::vector<std::string> paths;
@@ -184,35 +233,48 @@ absl::Status ImportData::AddToImporterStack(
 
   ImportRecord new_import_record{imported, importer_span};
 
-  // Note: linear scan over importers for simplicity, this will likely need to
-  // improve as we scale.
-  for (size_t i = 0; i < importer_stack_.size(); ++i) {
-    const ImportRecord& existing = importer_stack_.at(i);
-    if (imported == existing.imported) {
-      std::vector<ImportRecord> cycle(importer_stack_.begin() + i,
-                                      importer_stack_.end());
-      cycle.push_back(new_import_record);
-      return RecursiveImportErrorStatus(importer_span, existing.imported_from,
-                                        cycle, file_table());
+  {
+    absl::MutexLock lock(mutex_.get());
+    const std::vector<ImportRecord>& importer_stack =
+        importer_stacks_[std::this_thread::get_id()];
+    // Note: linear scan over importers for simplicity, this will likely need
+    // to improve as we scale.
+    for (size_t i = 0; i < importer_stack.size(); ++i) {
+      const ImportRecord& existing = importer_stack.at(i);
+      if (imported == existing.imported) {
+        std::vector<ImportRecord> cycle(importer_stack.begin() + i,
+                                        importer_stack.end());
+        cycle.push_back(new_import_record);
+        return RecursiveImportErrorStatus(importer_span, existing.imported_from,
+                                          cycle, file_table());
+      }
     }
   }
 
   if (importer_stack_observer_ != nullptr) {
+    absl::MutexLock lock(observer_mutex_.get());
     importer_stack_observer_(importer_span, imported);
   }
 
   VLOG(3) << "Adding import span to stack: "
           << importer_span.ToString(file_table());
-  importer_stack_.push_back(new_import_record);
+  absl::MutexLock lock(mutex_.get());
+  importer_stacks_[std::this_thread::get_id()].push_back(new_import_record);
   return absl::OkStatus();
 }
 
 absl::Status ImportData::PopFromImporterStack(const Span& import_span) {
-  XLS_RET_CHECK(!importer_stack_.empty());
-  XLS_RET_CHECK(import_span == importer_stack_.back().imported_from);
+  absl::MutexLock lock(mutex_.get());
+  auto it = importer_stacks_.find(std::this_thread::get_id());
+  XLS_RET_CHECK(it != importer_stacks_.end() && !it->second.empty());
+  std::vector<ImportRecord>& importer_stack = it->second;
+  XLS_RET_CHECK(import_span == importer_stack.back().imported_from);
   VLOG(3) << "Popping import span from stack: "
-          << importer_stack_.back().imported_from.ToString(file_table());
-  importer_stack_.pop_back();
+          << importer_stack.back().imported_from.ToString(file_table());
+  importer_stack.pop_back();
+  if (importer_stack.empty()) {
+    importer_stacks_.erase(it);
+  }
   return absl::OkStatus();
 }
 
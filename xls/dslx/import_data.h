@@ -19,16 +19,20 @@
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/dslx/bytecode/bytecode_cache_interface.h"
 #include "xls/dslx/frontend/ast.h"
@@ -36,6 +40,7 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_record.h"
 #include "xls/dslx/interp_bindings.h"
+#include "xls/dslx/interp_value.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/virtualizable_file_system.h"
 #include "xls/dslx/warning_kind.h"
@@ -112,17 +117,21 @@ class ImportTokens {
 
 // Wrapper around a `{subject: module_info}` mapping that modules can be
 // imported into.
+// Modules may be imported, typechecked and inserted from several threads
+// concurrently (see ImportModulesConcurrently()), so the bookkeeping here is
+// guarded by a mutex.
 class ImportData {
  public:
   // Use the routines in `create_import_data.h` to instantiate an object.
   ImportData() = delete;
 
   bool Contains(const ImportTokens& target) const {
+    absl::MutexLock lock(mutex_.get());
     return modules_.find(target) != modules_.end();
   }
 
   // When we're actively importing modules, this stack is populated to ensure we
-  // don't have cycles between files.
+  // don't have cycles between files. Each thread has its own stack.
   //
   // If we try to add a span to the importer stack where the file is already
   // active, we've detected a cycle, and so we return an error.
@@ -134,7 +143,8 @@ class ImportData {
   // of dependencies.
   //
   // Recursion checks are performed before this callback is invoked, so the
-  // callback results should all be validated to be DAG compliant.
+  // callback results should all be validated to be DAG compliant. Calls are
+  // serialized even when modules are imported concurrently.
   void SetImporterStackObserver(
       std::function<void(const Span&, const std::filesystem::path&)> f) {
     importer_stack_observer_ = std::move(f);
@@ -149,6 +159,16 @@ class ImportData {
   absl::StatusOr<ModuleInfo*> Put(const ImportTokens& subject,
                                   std::unique_ptr<ModuleInfo> module_info);
 
+  // Drops the modules loaded from any of `paths` so that the next import of
+  // one of them parses and typechecks it again. Bookkeeping (type information,
+  // top level bindings, etc.) keyed on a module that is no longer loaded, e.g.
+  // one whose typecheck failed, is dropped as well.
+  //
+  // Loaded modules refer to the AST and type information of the modules they
+  // import, so callers must also evict every (transitive) importer of an
+  // evicted module. Must not be called while an import is in progress.
+  void EvictModules(const absl::flat_hash_set<std::string>& paths);
+
   TypeInfoOwner& type_info_owner() { return type_info_owner_; }
 
   // Helper that gets the "root" type information for the module of the given
@@ -174,12 +194,14 @@ class ImportData {
   // work-in-progress. "node" may be set as nullptr when done with the entire
   // module.
   void SetTypecheckWorkInProgress(Module* module, AstNode* node) {
+    absl::MutexLock lock(mutex_.get());
     typecheck_wip_[module] = node;
   }
 
   // Retrieves which node was noted as currently work-in-progress, getter for
   // SetTypecheckWorkInProgress() above.
   AstNode* GetTypecheckWorkInProgress(Module* module) {
+    absl::MutexLock lock(mutex_.get());
     return typecheck_wip_[module];
   }
 
@@ -189,12 +211,93 @@ class ImportData {
   // hitting a work-in-progress indicator) those completed bindings can be
   // re-used after that without any need for re-evaluation.
   bool IsTopLevelBindingsDone(Module* module) const {
+    absl::MutexLock lock(mutex_.get());
     return top_level_bindings_done_.contains(module);
   }
   void MarkTopLevelBindingsDone(Module* module) {
+    absl::MutexLock lock(mutex_.get());
     top_level_bindings_done_.insert(module);
   }
 
+  // Restricts typechecking of `module` to the given top-level members, which is
+  // how lazy typechecking skips code unreachable from the entry point (see
+  // FindReachableMembers()). Modules without such a restriction are
+  // typechecked entirely.
+  void SetReachableMembers(const Module* module,
+                           absl::flat_hash_set<const AstNode*> members) {
+    absl::MutexLock lock(mutex_.get());
+    reachable_members_[module] = std::move(members);
+  }
+
+  // Returns whether `member` was left out of the members `module` is
+  // restricted to by SetReachableMembers(), i.e. need not be typechecked.
+  bool IsUnreachableMember(const Module* module, const AstNode* member) const {
+    absl::MutexLock lock(mutex_.get());
+    auto it = reachable_members_.find(module);
+    return it != reachable_members_.end() && !it->second.contains(member);
+  }
+
+  // Notes a module that was parsed ahead of its import, which the import of
+  // `subject` then takes over instead of parsing the file again.
+  void AddParsedModule(const ImportTokens& subject,
+                       std::unique_ptr<Module> module) {
+    absl::MutexLock lock(mutex_.get());
+    parsed_modules_[subject] = std::move(module);
+  }
+
+  // Returns the module noted for `subject` by AddParsedModule(), if any, and
+  // forgets it.
+  std::unique_ptr<Module> TakeParsedModule(const ImportTokens& subject) {
+    absl::MutexLock lock(mutex_.get());
+    auto node = parsed_modules_.extract(subject);
+    return node.empty() ? nullptr : std::move(node.mapped());
+  }
+
+  // The memoized result of interpreting a constexpr expression.
+  struct ConstexprResult {
+    InterpValue value;
+    // Spans at which the evaluation detected rollover, so that warnings can be
+    // reported again for each use of the result.
+    std::vector<Span> rollovers;
+  };
+
+  // Returns the result noted by NoteConstexprResult() for interpreting `expr`
+  // in the constexpr environment described by `env_key`, if any.
+  std::optional<ConstexprResult> GetConstexprResult(
+      const Expr* expr, std::string_view env_key) const {
+    absl::MutexLock lock(mutex_.get());
+    auto module_it = constexpr_results_.find(expr->owner());
+    if (module_it == constexpr_results_.end()) {
+      return std::nullopt;
+    }
+    auto it =
+        module_it->second.find(std::make_pair(expr, std::string(env_key)));
+    if (it == module_it->second.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  // Notes the result of interpreting `expr` in the constexpr environment
+  // described by `env_key`, which is shared by every type info that evaluates
+  // the same expression with equal bindings (e.g. equivalent parametric
+  // instantiations).
+  void NoteConstexprResult(const Expr* expr, std::string env_key,
+                           ConstexprResult result) {
+    absl::MutexLock lock(mutex_.get());
+    constexpr_results_[expr->owner()].insert_or_assign(
+        std::make_pair(expr, std::move(env_key)), std::move(result));
+  }
+
+  // Returns the mutex serializing parametric instantiations within `module`.
+  //
+  // Once a module is typechecked, instantiating one of its parametric
+  // functions or procs from an importer still adds derived type information
+  // (and possibly AST nodes) to it, so importers typechecked concurrently hold
+  // this while doing so. Instantiations only reach into modules further down
+  // the import DAG, which keeps the locking order acyclic.
+  absl::Mutex& GetInstantiationMutex(const Module* module);
+
   const std::filesystem::path& stdlib_path() const { return stdlib_path_; }
   absl::Span<const std::filesystem::path> additional_search_paths() {
     return additional_search_paths_;
@@ -254,12 +357,29 @@ class ImportData {
   absl::StatusOr<const Module*> FindModule(const Span& span) const;
 
   FileTable file_table_;
-  absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_;
-  absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_;
+
+  // Held by pointer to keep ImportData movable.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
+  absl::flat_hash_map<ImportTokens, std::unique_ptr<ModuleInfo>> modules_
+      ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<std::string, ModuleInfo*> path_to_module_info_
+      ABSL_GUARDED_BY(*mutex_);
   absl::flat_hash_map<Module*, std::unique_ptr<InterpBindings>>
-      top_level_bindings_;
-  absl::flat_hash_set<Module*> top_level_bindings_done_;
-  absl::flat_hash_map<Module*, AstNode*> typecheck_wip_;
+      top_level_bindings_ ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_set<Module*> top_level_bindings_done_
+      ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<Module*, AstNode*> typecheck_wip_
+      ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<const Module*, std::unique_ptr<absl::Mutex>>
+      instantiation_mutexes_ ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<const Module*, absl::flat_hash_set<const AstNode*>>
+      reachable_members_ ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<ImportTokens, std::unique_ptr<Module>> parsed_modules_
+      ABSL_GUARDED_BY(*mutex_);
+  absl::flat_hash_map<
+      const Module*, absl::flat_hash_map<std::pair<const Expr*, std::string>,
+                                         ConstexprResult>>
+      constexpr_results_ ABSL_GUARDED_BY(*mutex_);
   TypeInfoOwner type_info_owner_;
   const std::filesystem::path stdlib_path_;
   std::vector<std::filesystem::path> additional_search_paths_;
@@ -268,9 +388,14 @@ class ImportData {
 
   std::function<void(const Span&, const std::filesystem::path&)>
       importer_stack_observer_;
+  // Serializes calls to `importer_stack_observer_`; separate from `mutex_` so
+  // the observer may query this object.
+  std::unique_ptr<absl::Mutex> observer_mutex_ =
+      std::make_unique<absl::Mutex>();
 
   // See comment on AddToImporterStack() above.
-  std::vector<ImportRecord> importer_stack_;
+  absl::flat_hash_map<std::thread::id, std::vector<ImportRecord>>
+      importer_stacks_ ABSL_GUARDED_BY(*mutex_);
 
   std::unique_ptr<VirtualizableFilesystem> vfs_;
 };
@@ -14,14 +14,19 @@
 
 #include "xls/dslx/import_routines.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -30,11 +35,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/config/xls_config.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
@@ -172,6 +179,26 @@ static absl::StatusOr<DslxPath> FindExistingPath(
       vfs.GetCurrentDirectory().value(), stdlib_path));
 }
 
+static absl::StatusOr<std::unique_ptr<Module>> ParseDslxPath(
+    const ImportTokens& subject, const DslxPath& dslx_path,
+    FileTable& file_table, VirtualizableFilesystem& vfs) {
+  // Use the "filesystem_path" for reading the contents but the "source_path"
+  // for other uses. This avoids decorated paths like
+  // "/build/work/.../runfiles/...a/b/c/foo.x" appearing in the file table and
+  // artifacts. Instead the original "a/b/c/foo.x" path is used.
+  XLS_ASSIGN_OR_RETURN(std::string contents,
+                       vfs.GetFileContents(dslx_path.filesystem_path));
+
+  VLOG(4) << "Subject = " << subject.ToString();
+  VLOG(4) << "Source path = " << dslx_path.source_path.c_str();
+  VLOG(4) << "Filesystem path = " << dslx_path.filesystem_path.c_str();
+
+  Fileno fileno = file_table.GetOrCreate(dslx_path.source_path.c_str());
+  Scanner scanner(file_table, fileno, contents);
+  Parser parser(/*module_name=*/subject.ToString(), &scanner);
+  return parser.ParseModule();
+}
+
 static absl::StatusOr<std::unique_ptr<ModuleInfo>> DslxPathToModuleInfo(
     const TypecheckModuleFn& ftypecheck, ImportData* import_data,
     const ImportTokens& subject, const DslxPath& dslx_path, const Span& span,
@@ -186,25 +213,14 @@ static absl::StatusOr<std::unique_ptr<ModuleInfo>> DslxPathToModuleInfo(
   absl::Cleanup cleanup = absl::MakeCleanup(
       [&] { CHECK_OK(import_data->PopFromImporterStack(span)); });
 
-  // Use the "filesystem_path" for reading the contents but the "source_path"
-  // for other uses. This avoids decorated paths like
-  // "/build/work/.../runfiles/...a/b/c/foo.x" appearing in the file table and
-  // artifacts. Instead the original "a/b/c/foo.x" path is used.
-  XLS_ASSIGN_OR_RETURN(std::string contents,
-                       vfs.GetFileContents(dslx_path.filesystem_path));
-
-  absl::Span<std::string const> pieces = subject.pieces();
-  std::string fully_qualified_name = absl::StrJoin(pieces, ".");
+  std::string fully_qualified_name = subject.ToString();
   VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": start";
 
-  VLOG(4) << "Subject = " << subject.ToString();
-  VLOG(4) << "Source path = " << dslx_path.source_path.c_str();
-  VLOG(4) << "Filesystem path = " << dslx_path.filesystem_path.c_str();
-
-  Fileno fileno = file_table.GetOrCreate(dslx_path.source_path.c_str());
-  Scanner scanner(file_table, fileno, contents);
-  Parser parser(/*module_name=*/fully_qualified_name, &scanner);
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module, parser.ParseModule());
+  std::unique_ptr<Module> module = import_data->TakeParsedModule(subject);
+  if (module == nullptr) {
+    XLS_ASSIGN_OR_RETURN(module,
+                         ParseDslxPath(subject, dslx_path, file_table, vfs));
+  }
   XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(module.get()));
 
   VLOG(3) << "Parsing and typechecking " << fully_qualified_name << ": done";
@@ -249,6 +265,220 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
   return import_data->Put(subject, std::move(module_info));
 }
 
+absl::StatusOr<std::filesystem::path> FindImportPath(
+    const ImportTokens& subject, ImportData* import_data,
+    const Span& import_span, VirtualizableFilesystem& vfs) {
+  XLS_RET_CHECK(import_data != nullptr);
+  XLS_ASSIGN_OR_RETURN(DslxPath dslx_path,
+                       FindExistingPath(subject, import_data->stdlib_path(),
+                                        import_data->additional_search_paths(),
+                                        import_span, import_data->file_table(),
+                                        vfs));
+  return dslx_path.filesystem_path;
+}
+
+namespace {
+
+// A module in the import graph explored by ImportModulesConcurrently().
+struct ImportNode {
+  ImportTokens subject;
+  // The first import statement found for the module.
+  Span import_span;
+  DslxPath dslx_path;
+  std::unique_ptr<Module> module;
+  // Indices of the nodes this module imports and of the nodes importing it.
+  std::vector<int64_t> imports;
+  std::vector<int64_t> importers;
+};
+
+// Appends the nodes reachable from `index` to `order` in the order a
+// depth-first import finishes them. Returns false if there is a cycle.
+bool OrderImports(absl::Span<const ImportNode> nodes, int64_t index,
+                  std::vector<uint8_t>& visiting, std::vector<uint8_t>& done,
+                  std::vector<int64_t>& order) {
+  if (done[index]) {
+    return true;
+  }
+  if (visiting[index]) {
+    return false;
+  }
+  visiting[index] = true;
+  for (int64_t import : nodes[index].imports) {
+    if (!OrderImports(nodes, import, visiting, done, order)) {
+      return false;
+    }
+  }
+  visiting[index] = false;
+  done[index] = true;
+  order.push_back(index);
+  return true;
+}
+
+absl::StatusOr<ModuleInfo*> TypecheckImportNode(
+    const TypecheckModuleFn& ftypecheck, ImportNode& node,
+    ImportData* import_data) {
+  XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(
+      node.import_span, node.dslx_path.source_path));
+  absl::Cleanup cleanup = absl::MakeCleanup(
+      [&] { CHECK_OK(import_data->PopFromImporterStack(node.import_span)); });
+  VLOG(3) << "Typechecking " << node.subject.ToString() << ": start";
+  XLS_ASSIGN_OR_RETURN(TypeInfo * type_info, ftypecheck(node.module.get()));
+  VLOG(3) << "Typechecking " << node.subject.ToString() << ": done";
+  return import_data->Put(
+      node.subject,
+      std::make_unique<ModuleInfo>(std::move(node.module), type_info,
+                                   node.dslx_path.source_path));
+}
+
+}  // namespace
+
+absl::StatusOr<std::optional<std::vector<ModuleInfo*>>>
+ImportModulesConcurrently(const TypecheckModuleFn& ftypecheck,
+                          const Module& importer, ImportData* import_data,
+                          ThreadPool& thread_pool) {
+  XLS_RET_CHECK(import_data != nullptr);
+  std::vector<ImportNode> nodes;
+  absl::flat_hash_map<ImportTokens, int64_t> node_indices;
+
+  // Returns the indices of the not yet imported modules that `module`
+  // imports, adding nodes for the ones not seen before.
+  auto add_imports = [&](const Module& module)
+      -> absl::StatusOr<std::optional<std::vector<int64_t>>> {
+    std::vector<int64_t> imports;
+    for (const ModuleMember& member : module.top()) {
+      if (std::holds_alternative<Use*>(member)) {
+        return std::nullopt;
+      }
+      if (!std::holds_alternative<Import*>(member)) {
+        continue;
+      }
+      const Import* import = std::get<Import*>(member);
+      ImportTokens subject = ImportTokens::FromSpan(import->subject());
+      if (import_data->Contains(subject)) {
+        continue;
+      }
+      auto [it, inserted] = node_indices.try_emplace(subject, nodes.size());
+      if (inserted) {
+        XLS_ASSIGN_OR_RETURN(
+            DslxPath dslx_path,
+            FindExistingPath(subject, import_data->stdlib_path(),
+                             import_data->additional_search_paths(),
+                             import->span(), import_data->file_table(),
+                             import_data->vfs()));
+        nodes.push_back(ImportNode{.subject = std::move(subject),
+                                   .import_span = import->span(),
+                                   .dslx_path = std::move(dslx_path)});
+      }
+      if (!absl::c_linear_search(imports, it->second)) {
+        imports.push_back(it->second);
+      }
+    }
+    return imports;
+  };
+
+  // Discover the import graph breadth-first, parsing each level of it
+  // concurrently.
+  XLS_ASSIGN_OR_RETURN(std::optional<std::vector<int64_t>> top_imports,
+                       add_imports(importer));
+  if (!top_imports.has_value()) {
+    return std::nullopt;
+  }
+  for (int64_t parsed = 0; parsed < nodes.size();) {
+    const int64_t level_end = nodes.size();
+    std::vector<absl::Status> statuses(level_end - parsed);
+    thread_pool.ParallelFor(level_end - parsed, /*grain=*/1, [&](int64_t i) {
+      ImportNode& node = nodes[parsed + i];
+      absl::StatusOr<std::unique_ptr<Module>> module =
+          ParseDslxPath(node.subject, node.dslx_path,
+                        import_data->file_table(), import_data->vfs());
+      if (module.ok()) {
+        node.module = *std::move(module);
+      } else {
+        statuses[i] = module.status();
+      }
+    });
+    for (int64_t i = parsed; i < level_end; ++i) {
+      XLS_RETURN_IF_ERROR(statuses[i - parsed]);
+      XLS_ASSIGN_OR_RETURN(std::optional<std::vector<int64_t>> imports,
+                           add_imports(*nodes[i].module));
+      if (!imports.has_value()) {
+        return std::nullopt;
+      }
+      nodes[i].imports = *std::move(imports);
+    }
+    parsed = level_end;
+  }
+
+  // Circular imports are left to the serial importer to report.
+  std::vector<uint8_t> visiting(nodes.size(), false);
+  std::vector<uint8_t> done(nodes.size(), false);
+  std::vector<int64_t> order;
+  for (int64_t import : *top_imports) {
+    if (!OrderImports(nodes, import, visiting, done, order)) {
+      return std::nullopt;
+    }
+  }
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    for (int64_t import : nodes[i].imports) {
+      nodes[import].importers.push_back(i);
+    }
+  }
+
+  // Typecheck each module as soon as all of its imports are typechecked.
+  absl::Mutex mutex;
+  std::vector<int64_t> pending_imports(nodes.size());
+  std::vector<absl::Status> statuses(nodes.size());
+  std::vector<ModuleInfo*> module_infos(nodes.size(), nullptr);
+  int64_t in_flight = 0;
+  bool failed = false;
+  std::function<void(int64_t)> typecheck = [&](int64_t index) {
+    absl::StatusOr<ModuleInfo*> result =
+        TypecheckImportNode(ftypecheck, nodes[index], import_data);
+    absl::MutexLock lock(&mutex);
+    if (result.ok()) {
+      module_infos[index] = *result;
+    } else {
+      statuses[index] = result.status();
+      failed = true;
+    }
+    if (!failed) {
+      for (int64_t importer : nodes[index].importers) {
+        if (--pending_imports[importer] == 0) {
+          ++in_flight;
+          thread_pool.Schedule([&typecheck, importer] { typecheck(importer); });
+        }
+      }
+    }
+    --in_flight;
+  };
+  {
+    absl::MutexLock lock(&mutex);
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      pending_imports[i] = nodes[i].imports.size();
+    }
+    for (int64_t i = 0; i < nodes.size(); ++i) {
+      if (pending_imports[i] == 0) {
+        ++in_flight;
+        thread_pool.Schedule([&typecheck, i] { typecheck(i); });
+      }
+    }
+    mutex.Await(absl::Condition(
+        +[](int64_t* in_flight) { return *in_flight == 0; }, &in_flight));
+  }
+
+  // Report the first failure in import order, which doesn't depend on the
+  // scheduling. A module that was never typechecked has an import before it
+  // in this order that failed.
+  std::vector<ModuleInfo*> imported;
+  imported.reserve(order.size());
+  for (int64_t index : order) {
+    XLS_RETURN_IF_ERROR(statuses[index]);
+    XLS_RET_CHECK(module_infos[index] != nullptr);
+    imported.push_back(module_infos[index]);
+  }
+  return imported;
+}
+
 absl::StatusOr<UseImportResult> DoImportViaUse(
     const TypecheckModuleFn& ftypecheck, const UseSubject& subject,
     ImportData* import_data, const Span& name_def_span, FileTable& file_table,
@@ -339,4 +569,172 @@ absl::StatusOr<UseImportResult> DoImportViaUse(
                     })));
 }
 
+namespace {
+
+// Computes the members reachable for RestrictToReachableMembers().
+class ReachableMemberFinder {
+ public:
+  explicit ReachableMemberFinder(ImportData* import_data)
+      : import_data_(import_data) {}
+
+  // Returns false if the members can't be tracked, e.g. due to `use`.
+  absl::StatusOr<bool> Run(Module& module, std::string_view top) {
+    std::optional<ModuleMember*> top_member = module.FindMemberWithName(top);
+    if (!top_member.has_value() || !AddModule(&module)) {
+      return false;
+    }
+    Add(&module, ToAstNode(**top_member));
+    while (!worklist_.empty()) {
+      auto [member_module, member] = worklist_.back();
+      worklist_.pop_back();
+      XLS_ASSIGN_OR_RETURN(bool ok, Visit(member_module, member));
+      if (!ok) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Hands the results over to `import_data_`.
+  void Commit() && {
+    for (auto& [module, members] : reachable_) {
+      import_data_->SetReachableMembers(module, std::move(members));
+    }
+    for (auto& [subject, module] : parsed_) {
+      import_data_->AddParsedModule(subject, std::move(module));
+    }
+  }
+
+ private:
+  // Notes the top-level members of `module`; returns false if it has a `use`.
+  bool AddModule(Module* module) {
+    auto [it, inserted] = reachable_.try_emplace(module);
+    if (!inserted) {
+      return true;
+    }
+    for (const ModuleMember& member : module->top()) {
+      if (std::holds_alternative<Use*>(member)) {
+        return false;
+      }
+      top_nodes_.insert(ToAstNode(member));
+    }
+    for (const ModuleMember& member : module->top()) {
+      if (std::holds_alternative<ConstAssert*>(member)) {
+        Add(module, ToAstNode(member));
+      }
+    }
+    return true;
+  }
+
+  void Add(Module* module, AstNode* member) {
+    if (!reachable_[module].insert(member).second) {
+      return;
+    }
+    worklist_.push_back({module, member});
+    // Members which are typechecked along with this one.
+    if (auto* struct_def = dynamic_cast<StructDefBase*>(member);
+        struct_def != nullptr && struct_def->impl().has_value()) {
+      Add(module, *struct_def->impl());
+    } else if (auto* proc = dynamic_cast<Proc*>(member); proc != nullptr) {
+      for (Function* f : {&proc->config(), &proc->next(), &proc->init()}) {
+        if (top_nodes_.contains(f)) {
+          Add(module, f);
+        }
+      }
+    }
+  }
+
+  // Returns the not yet imported module that `import` refers to, parsing it if
+  // need be, or nullptr if it was already imported (and so is typechecked in
+  // its entirety).
+  absl::StatusOr<Module*> GetImportedModule(const Import* import) {
+    ImportTokens subject = ImportTokens::FromSpan(import->subject());
+    if (import_data_->Contains(subject)) {
+      return nullptr;
+    }
+    std::unique_ptr<Module>& module = parsed_[subject];
+    if (module == nullptr) {
+      XLS_ASSIGN_OR_RETURN(
+          DslxPath dslx_path,
+          FindExistingPath(subject, import_data_->stdlib_path(),
+                           import_data_->additional_search_paths(),
+                           import->span(), import_data_->file_table(),
+                           import_data_->vfs()));
+      XLS_ASSIGN_OR_RETURN(module,
+                           ParseDslxPath(subject, dslx_path,
+                                         import_data_->file_table(),
+                                         import_data_->vfs()));
+    }
+    return module.get();
+  }
+
+  // Adds the members referenced from within `node`.
+  absl::StatusOr<bool> Visit(Module* module, const AstNode* node) {
+    if (const auto* name_ref = dynamic_cast<const NameRef*>(node);
+        name_ref != nullptr &&
+        std::holds_alternative<const NameDef*>(name_ref->name_def())) {
+      AstNode* definer =
+          std::get<const NameDef*>(name_ref->name_def())->definer();
+      if (top_nodes_.contains(definer)) {
+        Add(module, definer);
+      }
+    } else if (const auto* type_ref = dynamic_cast<const TypeRef*>(node);
+               type_ref != nullptr) {
+      AstNode* definition = ToAstNode(type_ref->type_definition());
+      if (top_nodes_.contains(definition)) {
+        Add(module, definition);
+      } else if (dynamic_cast<ColonRef*>(definition) != nullptr) {
+        return Visit(module, definition);
+      }
+    } else if (const auto* colon_ref = dynamic_cast<const ColonRef*>(node);
+               colon_ref != nullptr) {
+      if (std::optional<Import*> import = colon_ref->ResolveImportSubject();
+          import.has_value()) {
+        XLS_ASSIGN_OR_RETURN(Module * imported, GetImportedModule(*import));
+        if (imported != nullptr) {
+          if (!AddModule(imported)) {
+            return false;
+          }
+          if (std::optional<ModuleMember*> member =
+                  imported->FindMemberWithName(colon_ref->attr());
+              member.has_value()) {
+            Add(imported, ToAstNode(**member));
+          }
+        }
+      }
+    }
+    for (const AstNode* child : node->GetChildren(/*want_types=*/true)) {
+      XLS_ASSIGN_OR_RETURN(bool ok, Visit(module, child));
+      if (!ok) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  ImportData* import_data_;
+  absl::flat_hash_map<ImportTokens, std::unique_ptr<Module>> parsed_;
+  absl::flat_hash_map<const Module*, absl::flat_hash_set<const AstNode*>>
+      reachable_;
+  // Top-level members of every module in `reachable_`.
+  absl::flat_hash_set<const AstNode*> top_nodes_;
+  std::vector<std::pair<Module*, AstNode*>> worklist_;
+};
+
+}  // namespace
+
+absl::Status RestrictToReachableMembers(Module& module, std::string_view top,
+                                        ImportData* import_data) {
+  XLS_RET_CHECK(import_data != nullptr);
+  ReachableMemberFinder finder(import_data);
+  XLS_ASSIGN_OR_RETURN(bool ok, finder.Run(module, top));
+  if (!ok) {
+    VLOG(3) << "Not restricting typechecking of " << module.name()
+            << " to members reachable from " << top;
+    return absl::OkStatus();
+  }
+  std::move(finder).Commit();
+  return absl::OkStatus();
+}
+
 }  // namespace xls::dslx
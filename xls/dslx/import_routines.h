@@ -15,10 +15,17 @@
 #ifndef XLS_DSLX_IMPORT_ROUTINES_H_
 #define XLS_DSLX_IMPORT_ROUTINES_H_
 
+#include <filesystem>  // NOLINT
 #include <functional>
+#include <optional>
+#include <string_view>
+#include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/type_system/type_info.h"
@@ -54,6 +61,30 @@ absl::StatusOr<ModuleInfo*> DoImport(const TypecheckModuleFn& ftypecheck,
                                      const Span& import_span,
                                      VirtualizableFilesystem& vfs);
 
+// Returns the path of the file that DoImport reads for `subject`, without
+// parsing or typechecking it.
+absl::StatusOr<std::filesystem::path> FindImportPath(
+    const ImportTokens& subject, ImportData* import_data,
+    const Span& import_span, VirtualizableFilesystem& vfs);
+
+// Imports every module reachable through the `import` statements of
+// `importer`, typechecking independent parts of the import graph concurrently
+// on `thread_pool`: the graph is first discovered by parsing, then each module
+// is typechecked with `ftypecheck` as soon as all of its imports are.
+// `importer` itself is not typechecked; when it is, afterwards, its imports
+// are all found in `import_data`.
+//
+// `ftypecheck` is called from several threads at once.
+//
+// Returns the imported modules in the order a depth-first import of
+// `importer` would have completed them, or std::nullopt if the graph contains
+// `use` statements or a cycle, in which case nothing was typechecked and the
+// modules should be imported as usual.
+absl::StatusOr<std::optional<std::vector<ModuleInfo*>>>
+ImportModulesConcurrently(const TypecheckModuleFn& ftypecheck,
+                          const Module& importer, ImportData* import_data,
+                          ThreadPool& thread_pool);
+
 struct UseImportResult {
   // The `ModuleInfo`s that were imported as we traversed. Note that there can
   // be more that one if there is a chain of `pub use` statements.
@@ -75,6 +106,24 @@ absl::StatusOr<UseImportResult> DoImportViaUse(
     ImportData* import_data, const Span& name_def_span, FileTable& file_table,
     VirtualizableFilesystem& vfs);
 
+// Sets up lazy typechecking of `module` for the entry point `top`: finds the
+// top-level members reachable from `top`, through references to module-level
+// definitions and to members of imported modules, and restricts typechecking
+// of `module` and of the modules it (transitively) imports to those (see
+// ImportData::SetReachableMembers()). Imported modules are parsed to find out
+// what they reference and handed to the later import via
+// ImportData::AddParsedModule(), so they are parsed only once.
+//
+// `const_assert!`s of a module are considered reachable whenever the module
+// is, and imports which only unreachable members refer to are skipped
+// entirely. Constants are typechecked, and so evaluated, only when reachable.
+//
+// Nothing is restricted if `top` is not a member of `module` or if the graph
+// of modules involved contains `use` statements, i.e. everything is then
+// typechecked as usual.
+absl::Status RestrictToReachableMembers(Module& module, std::string_view top,
+                                        ImportData* import_data);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_IMPORT_ROUTINES_H_
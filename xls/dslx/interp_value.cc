@@ -642,8 +642,7 @@ absl::StatusOr<InterpValue> InterpValue::Update(
     const InterpValue& index, const InterpValue& value) const {
   absl::Span<const xls::dslx::InterpValue> indices;
   if (index.IsTuple()) {
-    indices =
-        absl::MakeConstSpan(std::get<std::vector<InterpValue>>(index.payload_));
+    indices = absl::MakeConstSpan(index.GetValuesOrDie());
   } else {
     indices = absl::MakeConstSpan(&index, 1);
   }
@@ -654,16 +653,18 @@ absl::StatusOr<InterpValue> InterpValue::Update(
       return absl::InvalidArgumentError(absl::StrFormat(
           "Update of non-array element: %s", element->ToString()));
     }
-    std::vector<InterpValue>& values =
-        std::get<std::vector<InterpValue>>(element->payload_);
+    // Element storage is shared, so copy each vector along the updated path.
+    auto values =
+        std::make_shared<std::vector<InterpValue>>(element->GetValuesOrDie());
+    element->payload_ = Elements(values);
     XLS_ASSIGN_OR_RETURN(Bits index_bits, i.GetBits());
     XLS_ASSIGN_OR_RETURN(uint64_t index_value, index_bits.ToUint64());
-    if (index_value >= values.size()) {
+    if (index_value >= values->size()) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Update index %d is out of bounds; subject size: %d",
-                          index_value, values.size()));
+                          index_value, values->size()));
     }
-    element = &values[index_value];
+    element = &(*values)[index_value];
   }
   *element = value;
   return copy;
@@ -322,13 +322,13 @@ class InterpValue {
   InterpValueTag tag() const { return tag_; }
 
   absl::StatusOr<const std::vector<InterpValue>*> GetValues() const {
-    if (!std::holds_alternative<std::vector<InterpValue>>(payload_)) {
+    if (!std::holds_alternative<Elements>(payload_)) {
       return absl::InvalidArgumentError("Value does not hold element values");
     }
-    return &std::get<std::vector<InterpValue>>(payload_);
+    return std::get<Elements>(payload_).get();
   }
   const std::vector<InterpValue>& GetValuesOrDie() const {
-    return std::get<std::vector<InterpValue>>(payload_);
+    return *std::get<Elements>(payload_);
   }
   absl::StatusOr<const FnData*> GetFunction() const {
     if (!std::holds_alternative<FnData>(payload_)) {
@@ -370,7 +370,7 @@ class InterpValue {
   }
 
   bool HasValues() const {
-    return std::holds_alternative<std::vector<InterpValue>>(payload_);
+    return std::holds_alternative<Elements>(payload_);
   }
 
   bool IsToken() const { return tag_ == InterpValueTag::kToken; }
@@ -419,11 +419,21 @@ class InterpValue {
   //
   // TODO(leary): 2020-02-10 When all Python bindings are eliminated we can more
   // easily make an interpreter scoped lifetime that InterpValues can live in.
-  using Payload = std::variant<Bits, EnumData, std::vector<InterpValue>, FnData,
+  //
+  // The elements of arrays and tuples are immutable once constructed, so they
+  // are shared between copies of a value; this keeps copying large constant
+  // arrays (e.g. lookup tables bound in a constexpr environment) cheap.
+  // Update() copies only the element vectors along the updated path.
+  using Elements = std::shared_ptr<const std::vector<InterpValue>>;
+  using Payload = std::variant<Bits, EnumData, Elements, FnData,
                                std::shared_ptr<TokenData>, ChannelReference>;
 
   InterpValue(InterpValueTag tag, Payload payload)
       : tag_(tag), payload_(std::move(payload)) {}
+  InterpValue(InterpValueTag tag, std::vector<InterpValue> elements)
+      : tag_(tag),
+        payload_(std::make_shared<const std::vector<InterpValue>>(
+            std::move(elements))) {}
 
   using CompareF = bool (*)(const Bits& lhs, const Bits& rhs);
 
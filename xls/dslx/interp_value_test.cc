@@ -201,6 +201,20 @@ TEST(InterpValueTest, Array2DUpdate) {
             "[[1, 2], [4, 4]]");
 }
 
+TEST(InterpValueTest, UpdateDoesNotAffectCopies) {
+  auto array = InterpValue::MakeArray(
+      {InterpValue::MakeU32(1), InterpValue::MakeU32(2)});
+  ASSERT_TRUE(array.ok());
+  InterpValue copy = *array;
+  // Copies share their elements until one of them is updated.
+  EXPECT_EQ(array->GetValues().value(), copy.GetValues().value());
+  auto updated = copy.Update(InterpValue::MakeU32(0), InterpValue::MakeU32(3));
+  ASSERT_TRUE(updated.ok());
+  EXPECT_EQ(updated->ToHumanString(), "[3, 2]");
+  EXPECT_EQ(array->ToHumanString(), "[1, 2]");
+  EXPECT_EQ(copy.ToHumanString(), "[1, 2]");
+}
+
 TEST(InterpValueTest, Array2DUpdateEmptyIndices) {
   auto array =
       InterpValue::MakeArray({InterpValue::MakeArray({InterpValue::MakeU32(1),
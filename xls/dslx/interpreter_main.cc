@@ -28,6 +28,7 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
@@ -63,6 +64,13 @@ ABSL_FLAG(bool, execute, true, "Execute tests within the entry module.");
 ABSL_FLAG(std::string, compare, "none",
           "Compare DSL-interpreted results with an IR execution for each"
           " function for consistency checking; options: none|jit|interpreter.");
+ABSL_FLAG(double, compare_sample_rate, 1.0,
+          "Fraction of each function's invocations to compare when --compare "
+          "is enabled, in [0, 1]. Invocations are sampled deterministically.");
+ABSL_FLAG(int64_t, compare_batch_size, 1,
+          "Number of sampled invocations of a function to collect before "
+          "comparing them; with --compare=jit a batch is evaluated by a single "
+          "JIT call. Pending comparisons are made at the end of each test.");
 ABSL_FLAG(
     int64_t, seed, 0,
     "Seed for quickcheck random stimulus; 0 for an nondetermistic value.");
@@ -89,6 +97,14 @@ ABSL_FLAG(std::string, evaluator, "dslx-interpreter",
           "What evaluator should be used to actually execute the dslx test. "
           "'dslx-interpreter' is the DSLX bytecode interpreter. 'ir-jit' is "
           "the XLS-IR JIT. ir-interpreter' is the XLS-IR interpreter.");
+ABSL_FLAG(int64_t, quickcheck_threads, 1,
+          "Number of threads to JIT-evaluate quickcheck samples on, in "
+          "batches. If zero, all CPUs are used; if one, samples are evaluated "
+          "one at a time.");
+ABSL_FLAG(int64_t, jobs, 1,
+          "Number of unit tests to run concurrently with the DSLX "
+          "interpreter. If zero, all CPUs are used. Results are reported in "
+          "the order the tests appear in the module.");
 // LINT.ThenChange(//xls/build_rules/xls_dslx_rules.bzl)
 
 namespace xls::dslx {
@@ -142,7 +158,8 @@ absl::StatusOr<TestResult> RealMain(
     FormatPreference format_preference, CompareFlag compare_flag, bool execute,
     bool warnings_as_errors, std::optional<int64_t> seed, bool trace_channels,
     std::optional<int64_t> max_ticks,
-    std::optional<std::string_view> xml_output_file, EvaluatorType evaluator) {
+    std::optional<std::string_view> xml_output_file, EvaluatorType evaluator,
+    TestShard shard) {
   XLS_ASSIGN_OR_RETURN(
       WarningKindSet warnings,
       WarningKindSetFromDisabledString(absl::GetFlag(FLAGS_disable_warnings)));
@@ -159,16 +176,31 @@ absl::StatusOr<TestResult> RealMain(
                        vfs.GetFileContents(entry_module_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(entry_module_path));
 
+  const RunComparatorOptions comparator_options{
+      .sample_rate = absl::GetFlag(FLAGS_compare_sample_rate),
+      .batch_size = absl::GetFlag(FLAGS_compare_batch_size)};
+  if (comparator_options.sample_rate < 0.0 ||
+      comparator_options.sample_rate > 1.0) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("--compare_sample_rate must be in [0, 1]; got %f",
+                        comparator_options.sample_rate));
+  }
+  if (comparator_options.batch_size < 1) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("--compare_batch_size must be positive; got %d",
+                        comparator_options.batch_size));
+  }
   std::unique_ptr<AbstractRunComparator> run_comparator;
   switch (compare_flag) {
     case CompareFlag::kNone:
       break;
     case CompareFlag::kJit:
-      run_comparator = std::make_unique<RunComparator>(CompareMode::kJit);
+      run_comparator = std::make_unique<RunComparator>(CompareMode::kJit,
+                                                       comparator_options);
       break;
     case CompareFlag::kInterpreter:
-      run_comparator =
-          std::make_unique<RunComparator>(CompareMode::kInterpreter);
+      run_comparator = std::make_unique<RunComparator>(
+          CompareMode::kInterpreter, comparator_options);
       break;
   }
 
@@ -195,7 +227,11 @@ absl::StatusOr<TestResult> RealMain(
                                  .warnings_as_errors = warnings_as_errors,
                                  .warnings = warnings,
                                  .trace_channels = trace_channels,
-                                 .max_ticks = max_ticks};
+                                 .max_ticks = max_ticks,
+                                 .quickcheck_threads =
+                                     absl::GetFlag(FLAGS_quickcheck_threads),
+                                 .test_jobs = absl::GetFlag(FLAGS_jobs),
+                                 .shard = shard};
 
   std::unique_ptr<AbstractTestRunner> test_runner = GetTestRunner(evaluator);
   XLS_ASSIGN_OR_RETURN(TestResultData test_result,
@@ -290,6 +326,25 @@ int main(int argc, char* argv[]) {
     xml_output_file = xml_output_file_env;
   }
 
+  // See https://bazel.build/reference/test-encyclopedia#test-sharding
+  xls::dslx::TestShard shard;
+  if (const char* total_shards_env = getenv("TEST_TOTAL_SHARDS");
+      total_shards_env != nullptr) {
+    const char* shard_index_env = getenv("TEST_SHARD_INDEX");
+    QCHECK(absl::SimpleAtoi(total_shards_env, &shard.count) &&
+           shard_index_env != nullptr &&
+           absl::SimpleAtoi(shard_index_env, &shard.index) &&
+           shard.count > 0 && shard.index >= 0 && shard.index < shard.count)
+        << "Invalid TEST_TOTAL_SHARDS/TEST_SHARD_INDEX: " << total_shards_env
+        << "/" << (shard_index_env == nullptr ? "<unset>" : shard_index_env);
+  }
+  // Tells the test runner that sharding is supported.
+  if (const char* shard_status_file = getenv("TEST_SHARD_STATUS_FILE");
+      shard_status_file != nullptr) {
+    absl::Status touched = xls::SetFileContents(shard_status_file, "");
+    QCHECK(touched.ok()) << touched;
+  }
+
   xls::FormatPreference preference = xls::FormatPreference::kDefault;
   if (!absl::GetFlag(FLAGS_format_preference).empty()) {
     absl::StatusOr<xls::FormatPreference> flag_preference =
@@ -317,7 +372,7 @@ int main(int argc, char* argv[]) {
   absl::StatusOr<xls::dslx::TestResult> test_result = xls::dslx::RealMain(
       args[0], dslx_paths, dslx_stdlib_path, test_filter, preference,
       compare_flag, execute, warnings_as_errors, seed, trace_channels,
-      max_ticks, xml_output_file, evaluator.value());
+      max_ticks, xml_output_file, evaluator.value(), shard);
   if (!test_result.ok()) {
     return xls::ExitStatus(test_result.status());
   }
@@ -15,6 +15,7 @@
 #ifndef XLS_DSLX_IR_CONVERT_CONVERT_OPTIONS_H_
 #define XLS_DSLX_IR_CONVERT_CONVERT_OPTIONS_H_
 
+#include <cstdint>
 #include <optional>
 
 #include "xls/dslx/warning_kind.h"
@@ -51,6 +52,21 @@ struct ConvertOptions {
   // If present, the default FIFO config to use for any FIFO that does not
   // specify a config.
   std::optional<FifoConfig> default_fifo_config;
+
+  // Whether to typecheck only what is reachable from the requested top, rather
+  // than every member of every (transitively) imported module. Ignored when
+  // no top is given.
+  bool lazy_typecheck = false;
+
+  // Number of threads used to convert independent functions concurrently. With
+  // the default of one, everything is converted serially; zero or negative
+  // means one thread per available CPU.
+  //
+  // Functions the conversion order puts before the first proc are grouped into
+  // call graphs that share no callees, and each group is converted into its
+  // own package before being merged into the output package. The result is
+  // the same IR, though functions appear grouped by call graph.
+  int64_t conversion_threads = 1;
 };
 
 }  // namespace xls::dslx
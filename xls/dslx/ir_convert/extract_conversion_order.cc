@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <optional>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -675,38 +676,51 @@ static absl::StatusOr<std::vector<Callee>> GetCallees(
   return std::move(visitor.callees());
 }
 
+namespace {
+
+// The conversion order under construction, along with an index of the
+// (function, module, parametric env) instantiations in it that are not proc
+// instance functions. Parametric-heavy designs reach the same instantiation
+// from many invocations, so readiness is checked without scanning the order.
+struct ReadyList {
+  void Add(ConversionRecord record) {
+    if (!record.proc_id().has_value()) {
+      functions.insert(
+          {record.f(), record.module(), record.parametric_env()});
+    }
+    records.push_back(std::move(record));
+  }
+
+  std::vector<ConversionRecord> records;
+  absl::flat_hash_set<
+      std::tuple<const Function*, const Module*, ParametricEnv>>
+      functions;
+};
+
+}  // namespace
+
 static bool IsReady(std::variant<Function*, TestFunction*> f, Module* m,
-                    const ParametricEnv& bindings,
-                    const std::vector<ConversionRecord>* ready) {
+                    const ParametricEnv& bindings, const ReadyList* ready) {
   // Test functions are always the root and non-parametric, so they're always
   // ready.
   if (std::holds_alternative<TestFunction*>(f)) {
     return true;
   }
 
-  auto matches_fn = [&](const ConversionRecord& cr, Function* f) {
-    return cr.f() == f && cr.module() == m && cr.parametric_env() == bindings &&
-           !cr.proc_id().has_value();
-  };
-
-  for (const ConversionRecord& cr : *ready) {
-    if (matches_fn(cr, std::get<Function*>(f))) {
-      return true;
-    }
-  }
-  return false;
+  return ready->functions.contains(
+      std::make_tuple(std::get<Function*>(f), m, bindings));
 }
 
 // Forward decl.
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready);
+                                   ReadyList* ready);
 
 // Adds (f, bindings) to conversion order after deps have been added.
 static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
                                const Invocation* invocation, Module* m,
                                TypeInfo* type_info,
                                const ParametricEnv& bindings,
-                               std::vector<ConversionRecord>* ready,
+                               ReadyList* ready,
                                const std::optional<ProcId>& proc_id,
                                bool is_top = false) {
   CHECK_EQ(type_info->module(), m);
@@ -735,12 +749,12 @@ static absl::Status AddToReady(std::variant<Function*, TestFunction*> f,
       ConversionRecord cr,
       ConversionRecord::Make(fn, invocation, m, type_info, bindings,
                              orig_callees, proc_id, is_top));
-  ready->push_back(std::move(cr));
+  ready->Add(std::move(cr));
   return absl::OkStatus();
 }
 
 static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
-                                   std::vector<ConversionRecord>* ready) {
+                                   ReadyList* ready) {
   // Knock out all callees that are already in the (ready) order.
   std::vector<Callee> non_ready;
   {
@@ -764,7 +778,7 @@ static absl::Status ProcessCallees(absl::Span<const Callee> orig_callees,
 
 static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
     std::variant<Proc*, TestProc*> entry, TypeInfo* type_info, bool is_top) {
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
   Proc* p;
   if (std::holds_alternative<TestProc*>(entry)) {
     p = std::get<TestProc*>(entry)->proc();
@@ -790,7 +804,7 @@ static absl::StatusOr<std::vector<ConversionRecord>> GetOrderForProc(
   std::vector<ConversionRecord> final_order;
   std::vector<ConversionRecord> config_fns;
   std::vector<ConversionRecord> next_fns;
-  for (const auto& record : ready) {
+  for (const auto& record : ready.records) {
     if (record.f()->tag() == FunctionTag::kProcConfig) {
       config_fns.push_back(record);
     } else if (record.f()->tag() == FunctionTag::kProcNext) {
@@ -811,7 +825,7 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
                                                        TypeInfo* type_info,
                                                        bool include_tests) {
   CHECK_EQ(type_info->module(), module);
-  std::vector<ConversionRecord> ready;
+  ReadyList ready;
 
   auto handle_function = [&](Function* f) -> absl::Status {
     // NOTE: Proc creation is driven by Spawn instantiations - the
@@ -881,24 +895,25 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrder(Module* module,
 
     XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> proc_ready,
                          GetOrderForProc(proc, proc_ti, /*is_top=*/false));
-    ready.insert(ready.end(), proc_ready.begin(), proc_ready.end());
+    ready.records.insert(ready.records.end(), proc_ready.begin(),
+                         proc_ready.end());
   }
 
   // Remove duplicated functions. When performing a complete module conversion,
   // the functions and the proc are converted in that order. However, procs may
   // call functions resulting in functions being accounted for twice. There must
   // be a single instance of the function to convert.
-  RemoveFunctionDuplicates(&ready);
+  RemoveFunctionDuplicates(&ready.records);
 
-  VLOG(5) << "Ready list: " << ConversionRecordsToString(ready);
+  VLOG(5) << "Ready list: " << ConversionRecordsToString(ready.records);
 
-  return ready;
+  return std::move(ready.records);
 }
 
 absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
     std::variant<Function*, Proc*> entry, TypeInfo* type_info) {
-  std::vector<ConversionRecord> ready;
   if (std::holds_alternative<Function*>(entry)) {
+    ReadyList ready;
     Function* f = std::get<Function*>(entry);
     if (f->proc().has_value()) {
       XLS_ASSIGN_OR_RETURN(
@@ -908,14 +923,15 @@ absl::StatusOr<std::vector<ConversionRecord>> GetOrderForEntry(
                                    /*invocation=*/nullptr, f->owner(),
                                    type_info, ParametricEnv(), &ready, {},
                                    /*is_top=*/true));
-    RemoveFunctionDuplicates(&ready);
-    return ready;
+    RemoveFunctionDuplicates(&ready.records);
+    return std::move(ready.records);
   }
 
   Proc* p = std::get<Proc*>(entry);
   XLS_ASSIGN_OR_RETURN(TypeInfo * new_ti,
                        type_info->GetTopLevelProcTypeInfo(p));
-  XLS_ASSIGN_OR_RETURN(ready, GetOrderForProc(p, new_ti, /*is_top=*/true));
+  XLS_ASSIGN_OR_RETURN(std::vector<ConversionRecord> ready,
+                       GetOrderForProc(p, new_ti, /*is_top=*/true));
   RemoveFunctionDuplicates(&ready);
   return ready;
 }
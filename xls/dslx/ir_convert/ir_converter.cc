@@ -24,11 +24,14 @@
 
 #include "xls/dslx/ir_convert/ir_converter.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
@@ -45,6 +48,8 @@
 #include "cppitertools/imap.hpp"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/constexpr_evaluator.h"
 #include "xls/dslx/create_import_data.h"
@@ -57,6 +62,7 @@
 #include "xls/dslx/frontend/proc_id.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/ir_convert/channel_scope.h"
 #include "xls/dslx/ir_convert/conversion_info.h"
@@ -72,8 +78,10 @@
 #include "xls/dslx/warning_collector.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_scanner.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/ir/verifier.h"
 #include "xls/ir/xls_ir_interface.pb.h"
@@ -241,6 +249,180 @@ absl::Status CreateBoundaryChannels(absl::Span<Param* const> params,
   return absl::OkStatus();
 }
 
+// The conversion of one group of records from ConvertFunctionsConcurrently()
+// into its own package.
+struct ConvertedGroup {
+  std::vector<const ConversionRecord*> records;
+  PackageConversionData conversion_info;
+  PackageData package_data;
+  absl::Status status;
+};
+
+// Partitions the leading records of `order` which are not part of a proc into
+// groups such that every callee of a record is in the record's group. Records
+// keep their relative (topological) order within a group, and groups are
+// ordered by their first record. Returns an empty vector if some callee isn't
+// among the leading records, in which case the records must be converted
+// serially.
+std::vector<std::vector<const ConversionRecord*>> GroupIndependentRecords(
+    absl::Span<const ConversionRecord> order) {
+  int64_t count = 0;
+  while (count < order.size() && !order[count].proc_id().has_value()) {
+    ++count;
+  }
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, int64_t>
+      index_of;
+  std::vector<int64_t> parent(count);
+  auto find = [&](int64_t i) {
+    while (parent[i] != i) {
+      i = parent[i] = parent[parent[i]];
+    }
+    return i;
+  };
+  auto unite = [&](int64_t a, int64_t b) { parent[find(a)] = find(b); };
+  for (int64_t i = 0; i < count; ++i) {
+    parent[i] = i;
+    auto [it, inserted] = index_of.emplace(
+        std::make_pair(order[i].f(), order[i].parametric_env()), i);
+    if (!inserted) {
+      unite(i, it->second);
+    }
+  }
+  for (int64_t i = 0; i < count; ++i) {
+    for (const Callee& callee : order[i].callees()) {
+      auto it = index_of.find(
+          std::make_pair(callee.f(), callee.parametric_env()));
+      if (it == index_of.end()) {
+        return {};
+      }
+      unite(i, it->second);
+    }
+  }
+
+  absl::flat_hash_map<int64_t, int64_t> group_of_root;
+  std::vector<std::vector<const ConversionRecord*>> groups;
+  for (int64_t i = 0; i < count; ++i) {
+    auto [it, inserted] = group_of_root.emplace(find(i), groups.size());
+    if (inserted) {
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(&order[i]);
+  }
+  return groups;
+}
+
+absl::Status ConvertGroup(const Package& package, ImportData* import_data,
+                          const ConvertOptions& options,
+                          ConvertedGroup& group) {
+  group.conversion_info.package = std::make_unique<Package>(package.name());
+  Package* group_package = group.conversion_info.package.get();
+  // Node locations are only meaningful in the merged package if both agree on
+  // the file numbers; every file involved was registered up front.
+  for (const auto& [fileno, filename] : package.fileno_to_name()) {
+    group_package->SetFileno(fileno, filename);
+  }
+  group.package_data.conversion_info = &group.conversion_info;
+  ProcConversionData proc_data;
+  ChannelScope channel_scope(&group.conversion_info, import_data,
+                             options.default_fifo_config);
+  for (const ConversionRecord* record : group.records) {
+    VLOG(3) << "Converting to IR: " << record->ToString();
+    channel_scope.EnterFunctionContext(record->type_info(),
+                                       record->parametric_env());
+    XLS_RETURN_IF_ERROR(ConvertOneFunctionInternal(group.package_data, *record,
+                                                   import_data, &proc_data,
+                                                   &channel_scope, options));
+  }
+  XLS_RET_CHECK_EQ(group_package->fileno_to_name().size(),
+                   package.fileno_to_name().size());
+  XLS_RET_CHECK(group.conversion_info.interface.procs().empty());
+  XLS_RET_CHECK(group.conversion_info.interface.channels().empty());
+  return absl::OkStatus();
+}
+
+// Moves the functions converted for `group` into `package_data`'s package,
+// carrying their bookkeeping and interface entries along.
+absl::Status MergeGroup(ConvertedGroup& group, PackageData& package_data) {
+  Package* package = package_data.conversion_info->package.get();
+  XLS_ASSIGN_OR_RETURN(
+      Package::PackageMergeResult merge,
+      package->ImportFromPackage(group.conversion_info.package.get()));
+  // Shared helpers (e.g. for `map` over builtins) may be emitted by several
+  // groups, in which case the later copies get fresh names.
+  auto merged_name = [&](const std::string& name) {
+    auto it = merge.name_updates.find(name);
+    return it == merge.name_updates.end() ? name : it->second;
+  };
+  for (const auto& [ir_fn, dslx_fn] : group.package_data.ir_to_dslx) {
+    XLS_ASSIGN_OR_RETURN(FunctionBase * merged,
+                         package->GetFunctionBaseByName(
+                             merged_name(ir_fn->name())));
+    package_data.ir_to_dslx[merged] = dslx_fn;
+  }
+  for (xls::Function* wrapper : group.package_data.wrappers) {
+    XLS_ASSIGN_OR_RETURN(xls::Function * merged,
+                         package->GetFunction(merged_name(wrapper->name())));
+    package_data.wrappers.insert(merged);
+  }
+  for (PackageInterfaceProto::Function& function :
+       *group.conversion_info.interface.mutable_functions()) {
+    *function.mutable_base()->mutable_name() =
+        merged_name(function.base().name());
+    *package_data.conversion_info->interface.add_functions() =
+        std::move(function);
+  }
+  return absl::OkStatus();
+}
+
+// Converts the leading non-proc records of `order` concurrently (see
+// `ConvertOptions::conversion_threads`) and returns how many records were
+// converted; the rest must be converted serially. Returns zero if there is
+// nothing to gain, e.g. when all the functions form a single call graph.
+absl::StatusOr<int64_t> ConvertFunctionsConcurrently(
+    absl::Span<const ConversionRecord> order, ImportData* import_data,
+    const ConvertOptions& options, PackageData& package_data) {
+  std::vector<std::vector<const ConversionRecord*>> record_groups =
+      GroupIndependentRecords(order);
+  if (record_groups.size() < 2) {
+    return 0;
+  }
+  Package* package = package_data.conversion_info->package.get();
+  std::vector<ConvertedGroup> groups(record_groups.size());
+  int64_t converted = 0;
+  for (int64_t i = 0; i < groups.size(); ++i) {
+    for (const ConversionRecord* record : record_groups[i]) {
+      if (record->module()->fs_path().has_value()) {
+        package->GetOrCreateFileno(
+            std::string{record->module()->fs_path().value()});
+      }
+    }
+    converted += record_groups[i].size();
+    groups[i].records = std::move(record_groups[i]);
+  }
+  VLOG(3) << "Converting " << converted << " functions in " << groups.size()
+          << " independent groups";
+
+  {
+    ThreadPool pool(std::min<int64_t>(
+        options.conversion_threads > 0 ? options.conversion_threads
+                                       : AvailableCPUs(),
+        groups.size()));
+    for (ConvertedGroup& group : groups) {
+      pool.Schedule([&package, import_data, &options, &group] {
+        group.status = ConvertGroup(*package, import_data, options, group);
+      });
+    }
+    pool.WaitForIdle();
+  }
+  for (ConvertedGroup& group : groups) {
+    XLS_RETURN_IF_ERROR(group.status);
+  }
+  for (ConvertedGroup& group : groups) {
+    XLS_RETURN_IF_ERROR(MergeGroup(group, package_data));
+  }
+  return converted;
+}
+
 // Converts the functions in the call graph in a specified order.
 //
 // Args:
@@ -325,7 +507,13 @@ absl::Status ConvertCallGraph(absl::Span<const ConversionRecord> order,
         first_proc_config->type_info(), &proc_data, &channel_scope));
   }
 
-  for (const ConversionRecord& record : order) {
+  int64_t converted = 0;
+  if (options.conversion_threads != 1) {
+    XLS_ASSIGN_OR_RETURN(converted,
+                         ConvertFunctionsConcurrently(order, import_data,
+                                                      options, package_data));
+  }
+  for (const ConversionRecord& record : order.subspan(converted)) {
     VLOG(3) << "Converting to IR: " << record.ToString();
     channel_scope.EnterFunctionContext(record.type_info(),
                                        record.parametric_env());
@@ -528,6 +716,10 @@ absl::Status AddContentsToPackage(
                 module_name,
                 /*print_on_error=*/true,
                 /*filename=*/path.value_or("<UNKNOWN>"), printed_error));
+  if (convert_options.lazy_typecheck && entry.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        RestrictToReachableMembers(*module, *entry, import_data));
+  }
   WarningCollector warnings(import_data->enabled_warnings());
   absl::StatusOr<TypeInfo*> type_info =
       TypecheckModule(module.get(), import_data, &warnings);
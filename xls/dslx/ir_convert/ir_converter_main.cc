@@ -110,6 +110,10 @@ absl::Status RealMain(absl::Span<const std::string_view> paths) {
       .enabled_warnings = enabled_warnings,
       .convert_tests = convert_tests,
       .default_fifo_config = default_fifo_config,
+      .lazy_typecheck = ir_converter_options.lazy_typecheck(),
+      .conversion_threads = ir_converter_options.has_conversion_threads()
+                                ? ir_converter_options.conversion_threads()
+                                : 1,
   };
 
   // The following checks are performed inside ConvertFilesToPackage(), but we
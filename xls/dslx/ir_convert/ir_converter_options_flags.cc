@@ -14,6 +14,7 @@
 
 #include "xls/dslx/ir_convert/ir_converter_options_flags.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <optional>
 #include <string>
@@ -68,6 +69,13 @@ ABSL_FLAG(std::optional<std::string>, ir_converter_options_proto, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, default_fifo_config, std::nullopt,
           "Textproto description of a default FifoConfigProto. If unspecified, "
           "no default FIFO config is specified and codegen may fail.");
+ABSL_FLAG(int64_t, conversion_threads, 1,
+          "Number of threads used to convert independent functions "
+          "concurrently; zero means one per available CPU.");
+ABSL_FLAG(bool, lazy_typecheck, false,
+          "If true (and a top is given), only typechecks the module members "
+          "reachable from the top, skipping unused parts of imported "
+          "modules.");
 // LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
 ABSL_FLAG(std::optional<std::string>, ir_converter_options_used_textproto_file,
           std::nullopt,
@@ -102,6 +110,8 @@ absl::StatusOr<bool> SetOptionsFromFlags(IrConverterOptionsFlagsProto& proto) {
   POPULATE_FLAG(convert_tests);
   POPULATE_OPTIONAL_FLAG(disable_warnings);
   POPULATE_FLAG(warnings_as_errors);
+  POPULATE_FLAG(conversion_threads);
+  POPULATE_FLAG(lazy_typecheck);
   POPULATE_OPTIONAL_FLAG(interface_proto_file);
   POPULATE_OPTIONAL_FLAG(interface_textproto_file);
 
@@ -20,12 +20,17 @@
 
 #include "xls/dslx/ir_convert/ir_converter.h"
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/algorithm/container.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
@@ -40,6 +45,9 @@
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/run_routines/run_comparator.h"
 #include "xls/dslx/run_routines/run_routines.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 
 namespace xls::dslx {
 namespace {
@@ -3243,5 +3251,42 @@ proc Generator {
                          "config arguments: 'val: u32', 'val2: u32'")));
 }
 
+// Returns the name and node count of each function in `ir`, sorted by name.
+absl::StatusOr<std::vector<std::pair<std::string, int64_t>>> FunctionSummaries(
+    std::string_view ir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir));
+  std::vector<std::pair<std::string, int64_t>> summaries;
+  for (const std::unique_ptr<xls::Function>& f : package->functions()) {
+    summaries.push_back({f->name(), f->node_count()});
+  }
+  absl::c_sort(summaries);
+  return summaries;
+}
+
+TEST(IrConverterTest, ConcurrentConversionMatchesSerial) {
+  constexpr std::string_view program = R"(
+fn double<N: u32>(x: uN[N]) -> uN[N] { x + x }
+fn left(x: u8) -> u8 { double(x) }
+fn right(x: u16) -> u16 { double(x) }
+fn square(x: u32) -> u32 { x * x }
+fn square_plus_one(x: u32) -> u32 { square(x) + u32:1 }
+pub fn checked(x: u32) -> u32 {
+  assert!(x != u32:0, "zero");
+  square_plus_one(x)
+}
+)";
+  ConvertOptions options = kFailNoPos;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string serial,
+                           ConvertModuleForTest(program, options));
+  options.conversion_threads = 4;
+  XLS_ASSERT_OK_AND_ASSIGN(std::string concurrent,
+                           ConvertModuleForTest(program, options));
+  XLS_ASSERT_OK_AND_ASSIGN(auto serial_summaries, FunctionSummaries(serial));
+  XLS_ASSERT_OK_AND_ASSIGN(auto concurrent_summaries,
+                           FunctionSummaries(concurrent));
+  EXPECT_EQ(serial_summaries, concurrent_summaries);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -15,13 +15,15 @@
 // Very simple language server for dslx that
 //  - keeps track of open files and updates them whenever they are
 //    changed in the editor (hidden under the hood).
-//  - On every change, attempts to parse and send back diagnostics
+//  - Once edits settle, attempts to parse and send back diagnostics
 //    on errors/warnings.
 //
 // Heavily commented below as this serves as a sample.
 
+#include <poll.h>
 #include <unistd.h>
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <iostream>
@@ -33,9 +35,11 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_map.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/time.h"
 #include "nlohmann/json.hpp"
 #include "verible/common/lsp/json-rpc-dispatcher.h"
 #include "verible/common/lsp/lsp-protocol.h"
@@ -54,6 +58,9 @@ static constexpr char kDslxPath[] = "DSLX_PATH";
 ABSL_FLAG(std::string, dslx_path,
           getenv(kDslxPath) != nullptr ? getenv(kDslxPath) : "",
           "Additional paths to search for modules (colon delimited).");
+ABSL_FLAG(int64_t, change_debounce_ms, 150,
+          "Milliseconds without further input from the editor to wait after a "
+          "buffer change before parsing and typechecking it.");
 
 namespace xls::dslx {
 namespace {
@@ -98,14 +105,11 @@ InitializeResult InitializeServer(const nlohmann::json& params) {
 }
 
 // On text change: attempt to parse the buffer and emit diagnostics if needed.
-void TextChangeHandler(const LspUri& file_uri,
-                       const EditTextBuffer& text_buffer,
+void TextChangeHandler(const LspUri& file_uri, std::string_view file_content,
                        verible::lsp::JsonRpcDispatcher& dispatcher,
                        LanguageServerAdapter& adapter) {
-  text_buffer.RequestContent([&](std::string_view file_content) {
-    // Note: this returns a status, but we don't need to surface it from here.
-    adapter.Update(file_uri, file_content).IgnoreError();
-  });
+  // Note: this returns a status, but we don't need to surface it from here.
+  adapter.Update(file_uri, file_content).IgnoreError();
 
   // For now we brute force evaluate all the files in the DAG that may be
   // sensitive to the update. We'll need to be smarter as we observe scaling
@@ -128,6 +132,12 @@ void TextChangeHandler(const LspUri& file_uri,
   }
 }
 
+// Returns whether input becomes available on `fd` within `timeout`.
+static bool InputArrivesWithin(int fd, absl::Duration timeout) {
+  pollfd poll_fd{.fd = fd, .events = POLLIN, .revents = 0};
+  return poll(&poll_fd, 1, absl::ToInt64Milliseconds(timeout)) != 0;
+}
+
 // Attempt to canonicalize path and return that if successful; else keep as-is.
 static std::filesystem::path FailSafeCanonicalize(
     const std::filesystem::path& original_path) {
@@ -211,18 +221,34 @@ absl::Status RealMain() {
   // The text buffer collection can call a callback whenever there is a change.
   // We're using this to hook up our parser that then can send diagnostic
   // messages back.
+  //
+  // Changes are not handled right away: while the user is typing every
+  // keystroke is a change, so the latest contents of each changed buffer are
+  // held until the editor goes quiet for the debounce interval (or a request
+  // needs up-to-date results), and only then parsed and typechecked.
+  absl::btree_map<std::string, std::string> pending_changes;
+  auto flush_pending_changes = [&] {
+    for (const auto& [uri, contents] : pending_changes) {
+      TextChangeHandler(LspUri(uri), contents, dispatcher,
+                        language_server_adapter);
+    }
+    pending_changes.clear();
+  };
   buffers.SetChangeListener(
       [&](const std::string& uri, const EditTextBuffer* buffer) {
         if (buffer == nullptr) {
+          pending_changes.erase(uri);
           return;  // buffer got deleted. No interest.
         }
-        TextChangeHandler(LspUri(uri), *buffer, dispatcher,
-                          language_server_adapter);
+        buffer->RequestContent([&](std::string_view file_content) {
+          pending_changes[uri] = std::string(file_content);
+        });
       });
 
   dispatcher.AddRequestHandler(
       "textDocument/documentSymbol",
       [&](const verible::lsp::DocumentSymbolParams& params) {
+        flush_pending_changes();
         return language_server_adapter.GenerateDocumentSymbols(
             LspUri(std::string{params.textDocument.uri}));
       });
@@ -230,6 +256,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/definition",
       [&](const verible::lsp::DefinitionParams& params) {
+        flush_pending_changes();
         auto values = language_server_adapter.FindDefinitions(
             LspUri(std::string{params.textDocument.uri}), params.position);
         if (values.ok()) {
@@ -243,6 +270,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/formatting",
       [&](const verible::lsp::DocumentFormattingParams& params) {
+        flush_pending_changes();
         auto values = language_server_adapter.FormatDocument(
             LspUri(std::string{params.textDocument.uri}));
         if (values.ok()) {
@@ -256,12 +284,14 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/documentLink",
       [&](const verible::lsp::DocumentLinkParams& params) {
+        flush_pending_changes();
         return language_server_adapter.ProvideImportLinks(
             LspUri(std::string{params.textDocument.uri}));
       });
 
   dispatcher.AddRequestHandler(
       "textDocument/rename", [&](const verible::lsp::RenameParams& params) {
+        flush_pending_changes();
         auto edit = language_server_adapter.Rename(
             LspUri(std::string{params.textDocument.uri}), params.position,
             params.newName);
@@ -281,6 +311,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/inlayHint",
       [&](const verible::lsp::InlayHintParams& params) {
+        flush_pending_changes();
         auto inlay_hints = language_server_adapter.InlayHint(
             LspUri(std::string{params.textDocument.uri}), params.range);
         if (inlay_hints.ok()) {
@@ -294,6 +325,7 @@ absl::Status RealMain() {
   dispatcher.AddRequestHandler(
       "textDocument/documentHighlight",
       [&](const verible::lsp::DocumentHighlightParams& params) {
+        flush_pending_changes();
         auto highlights = language_server_adapter.DocumentHighlight(
             LspUri(std::string{params.textDocument.uri}), params.position);
         if (highlights.ok()) {
@@ -306,7 +338,14 @@ absl::Status RealMain() {
 
   // Main loop. Feeding the stream-splitter that then calls the dispatcher.
   absl::Status status = absl::OkStatus();
+  const absl::Duration debounce =
+      absl::Milliseconds(absl::GetFlag(FLAGS_change_debounce_ms));
   while (status.ok() && !shutdown_requested) {
+    if (!pending_changes.empty() &&
+        !InputArrivesWithin(STDIN_FILENO, debounce)) {
+      flush_pending_changes();
+      continue;
+    }
     status = stream_splitter.PullFrom([](char* buf, int size) -> int {  //
       return static_cast<int>(read(STDIN_FILENO, buf, size));
     });
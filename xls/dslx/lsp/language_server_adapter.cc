@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -170,7 +171,12 @@ absl::Status LanguageServerAdapter::Update(
     LspUri file_uri, std::optional<std::string_view> dslx_code) {
   // Either update or get the last contents from the virtual filesystem map.
   if (dslx_code.has_value()) {
-    vfs_contents_[file_uri] = std::string{dslx_code.value()};
+    // Newly opened buffers may differ from what importers read from disk.
+    auto [it, inserted] = vfs_contents_.emplace(file_uri, *dslx_code);
+    if (inserted || it->second != *dslx_code) {
+      it->second = std::string{dslx_code.value()};
+      NoteContentsChanged(file_uri);
+    }
   } else {
     auto it = vfs_contents_.find(file_uri);
     if (it == vfs_contents_.end()) {
@@ -190,47 +196,65 @@ absl::Status LanguageServerAdapter::Update(
     return absl::OkStatus();
   }
 
-  auto inserted = uri_parse_data_.emplace(file_uri, nullptr);
-  std::unique_ptr<ParseData>& insert_value = inserted.first->second;
-
-  std::vector<std::filesystem::path> dslx_paths_as_filesystem_paths =
-      GetDslxPathsAsFilesystemPaths();
-
-  ImportData import_data = CreateImportData(
-      stdlib_.GetFilesystemPath(), dslx_paths_as_filesystem_paths,
-      kAllWarningsSet, std::make_unique<LanguageServerFilesystem>(*this));
-
-  import_data.SetImporterStackObserver(
-      [&](const Span& importer_span, const std::filesystem::path& imported) {
-        // Here we check that the filename as reported by the span is a valid
-        // URI. When we are using the LSP we expect /all/ files in the file
-        // table to be in URI form.
-        std::string_view importer_filename =
-            importer_span.GetFilename(import_data.file_table());
-        CHECK(!absl::StartsWith(importer_filename, "file://"))
-            << "importer_filename: " << importer_filename
-            << " imported: " << imported;
-        const auto importer_uri = LspUri::FromFilesystemPath(importer_filename);
+  auto [it, inserted] = uri_parse_data_.emplace(file_uri, nullptr);
+  if (inserted) {
+    std::vector<std::filesystem::path> dslx_paths_as_filesystem_paths =
+        GetDslxPathsAsFilesystemPaths();
+    it->second = std::make_unique<ParseData>(CreateImportData(
+        stdlib_.GetFilesystemPath(), dslx_paths_as_filesystem_paths,
+        kAllWarningsSet, std::make_unique<LanguageServerFilesystem>(*this)));
+
+    ImportData& import_data = it->second->import_data();
+    import_data.SetImporterStackObserver([this, &import_data](
+                                             const Span& importer_span,
+                                             const std::filesystem::path&
+                                                 imported) {
+      // Here we check that the filename as reported by the span is a valid
+      // URI. When we are using the LSP we expect /all/ files in the file
+      // table to be in URI form.
+      std::string_view importer_filename =
+          importer_span.GetFilename(import_data.file_table());
+      CHECK(!absl::StartsWith(importer_filename, "file://"))
+          << "importer_filename: " << importer_filename
+          << " imported: " << imported;
+      const auto importer_uri = LspUri::FromFilesystemPath(importer_filename);
+
+      const LspUri imported_uri(verible::lsp::PathToLSPUri(imported.c_str()));
+      import_sensitivity_.NoteImportAttempt(importer_uri, imported_uri);
+    });
+  }
+  ParseData& parse_data = *it->second;
+  if (parse_data.IsUpToDate(*dslx_code)) {
+    return parse_data.status();
+  }
 
-        const LspUri imported_uri(verible::lsp::PathToLSPUri(imported.c_str()));
-        import_sensitivity_.NoteImportAttempt(importer_uri, imported_uri);
-      });
+  // Everything that may have observed a changed file is parsed and
+  // typechecked again; unaffected imports stay loaded in the import data.
+  absl::flat_hash_set<std::string> evict = {
+      file_uri.GetFilesystemPath().string()};
+  for (const LspUri& stale : parse_data.TakeStaleUris()) {
+    for (const LspUri& sensitive :
+         import_sensitivity_.GatherAllSensitiveToChangeIn(stale)) {
+      evict.insert(sensitive.GetFilesystemPath().string());
+    }
+  }
+  parse_data.ClearResult();
+  parse_data.import_data().EvictModules(evict);
 
   std::vector<CommentData> comments;
   absl::StatusOr<TypecheckedModule> typechecked_module = ParseAndTypecheck(
       dslx_code.value(), /*path=*/file_uri.GetFilesystemPath().c_str(),
-      /*module_name=*/*module_name, &import_data, &comments);
+      /*module_name=*/*module_name, &parse_data.import_data(), &comments);
 
   if (typechecked_module.ok()) {
-    insert_value = std::make_unique<ParseData>(
-        std::move(import_data), TypecheckedModuleWithComments{
-                                    .tm = std::move(typechecked_module).value(),
-                                    .comments = Comments::Create(comments),
-                                    .contents = std::string(*dslx_code),
-                                });
+    parse_data.SetResult(*dslx_code,
+                         TypecheckedModuleWithComments{
+                             .tm = std::move(typechecked_module).value(),
+                             .comments = Comments::Create(comments),
+                             .contents = std::string(*dslx_code),
+                         });
   } else {
-    insert_value = std::make_unique<ParseData>(std::move(import_data),
-                                               typechecked_module.status());
+    parse_data.SetResult(*dslx_code, typechecked_module.status());
   }
 
   const absl::Duration duration = absl::Now() - start;
@@ -238,7 +262,13 @@ absl::Status LanguageServerAdapter::Update(
     LspLog() << "Parsing " << file_uri << " took " << duration << "\n";
   }
 
-  return insert_value->status();
+  return parse_data.status();
+}
+
+void LanguageServerAdapter::NoteContentsChanged(const LspUri& uri) {
+  for (auto& [_, parse_data] : uri_parse_data_) {
+    parse_data->NoteStale(uri);
+  }
 }
 
 std::vector<verible::lsp::Diagnostic>
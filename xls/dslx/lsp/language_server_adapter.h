@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -61,9 +62,12 @@ class LanguageServerAdapter {
   // `dslx_code` can be nullopt when we're re-evaluating the previous contents
   // again; i.e. because we think a dependency may have been corrected.
   //
-  // Note: this is parsing is triggered for every keystroke. Fine for now.
   // Successful and unsuccessful parses are memoized so that their status
-  // and can be queried.
+  // and can be queried. If neither the file nor any file it (transitively)
+  // imports has changed since the last parse, the memoized result is returned
+  // without parsing again. Otherwise each file keeps its `ImportData` across
+  // updates, and only the imported modules sensitive to a changed file are
+  // evicted from it and re-imported.
   //
   // Implementation note: since we currently do not react to buffer closed
   // events in the buffer change listener, we keep track of every file ever
@@ -132,14 +136,44 @@ class LanguageServerAdapter {
     std::string contents;
   };
 
+  // Notes that the contents of `uri` changed, so that every buffer importing it
+  // is parsed again on its next update.
+  void NoteContentsChanged(const LspUri& uri);
+
   // Everything relevant for a parsed editor buffer.
   // Note, each buffer independently currently keeps track of its import data.
   // This could maybe be considered to be put in a single place.
   class ParseData {
    public:
-    ParseData(ImportData&& import_data,
-              absl::StatusOr<TypecheckedModuleWithComments> tmc)
-        : import_data_(std::move(import_data)), tmc_(std::move(tmc)) {}
+    explicit ParseData(ImportData&& import_data)
+        : import_data_(std::move(import_data)),
+          tmc_(absl::UnavailableError("Buffer has not been parsed yet")) {}
+
+    // Returns whether the memoized result is for `dslx_code` and no file that
+    // may be imported has changed since.
+    bool IsUpToDate(std::string_view dslx_code) const {
+      return stale_uris_.empty() && parsed_code_.has_value() &&
+             *parsed_code_ == dslx_code;
+    }
+
+    // Records the result of parsing and typechecking `dslx_code`.
+    void SetResult(std::string_view dslx_code,
+                   absl::StatusOr<TypecheckedModuleWithComments> tmc) {
+      parsed_code_ = std::string(dslx_code);
+      tmc_ = std::move(tmc);
+    }
+
+    // Drops the memoized result, which refers to modules about to be evicted
+    // from the import data.
+    void ClearResult() {
+      parsed_code_ = std::nullopt;
+      tmc_ = absl::UnavailableError("Buffer is being parsed");
+    }
+
+    void NoteStale(const LspUri& uri) { stale_uris_.insert(uri); }
+    absl::flat_hash_set<LspUri> TakeStaleUris() {
+      return std::exchange(stale_uris_, {});
+    }
 
     bool ok() const { return tmc_.ok(); }
     absl::Status status() const { return tmc_.status(); }
@@ -170,6 +204,12 @@ class LanguageServerAdapter {
    private:
     ImportData import_data_;
     absl::StatusOr<TypecheckedModuleWithComments> tmc_;
+
+    // The contents `tmc_` was produced from, if any.
+    std::optional<std::string> parsed_code_;
+
+    // Files whose contents changed since the last parse.
+    absl::flat_hash_set<LspUri> stale_uris_;
   };
 
   const LspUri stdlib_;
@@ -523,6 +523,38 @@ const OUTER_FOO = inner::FOO;  // this is not public, at first
   ASSERT_TRUE(diags.empty());
 }
 
+// Tests that when a buffer is re-evaluated the modules it imports which have
+// changed since are imported again, while updates with unchanged contents are
+// answered from the memoized result.
+TEST(LanguageServerAdapterTest, ReevaluationSeesChangedImports) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory tempdir, TempDirectory::Create());
+  LanguageServerAdapter adapter(
+      GetDslxStdlibUri(),
+      /*dslx_paths=*/{LspUri::FromFilesystemPath(tempdir.path())});
+
+  XLS_ASSERT_OK(
+      SetFileContents(tempdir.path() / "a.x", "pub const A = u32:1;"));
+  XLS_ASSERT_OK(
+      SetFileContents(tempdir.path() / "b.x", "pub const B = u32:2;"));
+  const LspUri a_uri(absl::StrFormat("file://%s/a.x", tempdir.path()));
+  const LspUri main_uri(absl::StrFormat("file://%s/main.x", tempdir.path()));
+  const std::string kMainContents = R"(import a;
+import b;
+
+const_assert!(a::A + b::B == u32:3);
+)";
+  XLS_ASSERT_OK(adapter.Update(main_uri, kMainContents));
+  XLS_ASSERT_OK(adapter.Update(main_uri, kMainContents));
+
+  XLS_ASSERT_OK(adapter.Update(a_uri, "pub const A = u32:2;"));
+  EXPECT_FALSE(adapter.Update(main_uri, std::nullopt).ok());
+  EXPECT_EQ(adapter.GenerateParseDiagnostics(main_uri).size(), 1);
+
+  XLS_ASSERT_OK(adapter.Update(a_uri, "pub const A = u32:1;"));
+  XLS_ASSERT_OK(adapter.Update(main_uri, std::nullopt));
+  EXPECT_TRUE(adapter.GenerateParseDiagnostics(main_uri).empty());
+}
+
 // Tests that when DSLX path values are given we can resolve imports against
 // them.
 TEST(LanguageServerAdapterTest, NontrivialDslxPathResolution) {
@@ -16,23 +16,28 @@
 
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/frontend/comment_data.h"
 #include "xls/dslx/frontend/module.h"
 #include "xls/dslx/frontend/parser.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/frontend/scanner.h"
 #include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/type_system/typecheck_module.h"
 #include "xls/dslx/type_system_v2/typecheck_module_v2.h"
@@ -40,6 +45,30 @@
 
 namespace xls::dslx {
 
+static absl::StatusOr<TypecheckedModule> TypecheckModuleWithWarnings(
+    std::unique_ptr<Module> module, std::string_view path,
+    ImportData* import_data, WarningCollector warnings) {
+  XLS_RET_CHECK(module.get() != nullptr);
+  XLS_RET_CHECK(import_data != nullptr);
+
+  std::string_view module_name = module->name();
+
+  XLS_ASSIGN_OR_RETURN(
+      TypeInfo * type_info,
+      module->attributes().contains(ModuleAttribute::kTypeInferenceVersion2)
+          ? TypecheckModuleV2(module.get(), import_data, &warnings)
+          : TypecheckModule(module.get(), import_data, &warnings));
+  TypecheckedModule result{module.get(), type_info, std::move(warnings)};
+  XLS_ASSIGN_OR_RETURN(ImportTokens subject,
+                       ImportTokens::FromString(module_name));
+  XLS_RETURN_IF_ERROR(import_data
+                          ->Put(subject, std::make_unique<ModuleInfo>(
+                                             std::move(module), type_info,
+                                             std::filesystem::path(path)))
+                          .status());
+  return result;
+}
+
 absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
     std::string_view text, std::string_view path, std::string_view module_name,
     ImportData* import_data, std::vector<CommentData>* comments) {
@@ -62,6 +91,81 @@ absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
   return TypecheckModule(std::move(module), path, import_data);
 }
 
+absl::StatusOr<TypecheckedModule> ParseAndTypecheckReachable(
+    std::string_view text, std::string_view path, std::string_view module_name,
+    std::string_view top, ImportData* import_data) {
+  XLS_RET_CHECK(import_data != nullptr);
+
+  FileTable& file_table = import_data->file_table();
+  Fileno fileno = file_table.GetOrCreate(path);
+  const Span fake_import_span = Span(Pos(fileno, 0, 0), Pos(fileno, 0, 0));
+  XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(fake_import_span, path));
+  absl::Cleanup cleanup = [&] {
+    CHECK_OK(import_data->PopFromImporterStack(fake_import_span));
+  };
+
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Module> module,
+      ParseModule(text, path, module_name, import_data->file_table()));
+  XLS_RETURN_IF_ERROR(RestrictToReachableMembers(*module, top, import_data));
+  return TypecheckModule(std::move(module), path, import_data);
+}
+
+absl::StatusOr<TypecheckedModule> ParseAndTypecheckConcurrently(
+    std::string_view text, std::string_view path, std::string_view module_name,
+    ImportData* import_data, ThreadPool& thread_pool,
+    std::vector<CommentData>* comments) {
+  XLS_RET_CHECK(import_data != nullptr);
+
+  FileTable& file_table = import_data->file_table();
+  Fileno fileno = file_table.GetOrCreate(path);
+  const Span fake_import_span = Span(Pos(fileno, 0, 0), Pos(fileno, 0, 0));
+  XLS_RETURN_IF_ERROR(import_data->AddToImporterStack(fake_import_span, path));
+  absl::Cleanup cleanup = [&] {
+    CHECK_OK(import_data->PopFromImporterStack(fake_import_span));
+  };
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Module> module,
+                       ParseModule(text, path, module_name,
+                                   import_data->file_table(), comments));
+  WarningCollector warnings(import_data->enabled_warnings());
+  if (module->attributes().contains(ModuleAttribute::kTypeInferenceVersion2)) {
+    return TypecheckModuleWithWarnings(std::move(module), path, import_data,
+                                       std::move(warnings));
+  }
+
+  // Serially, imports add their warnings to the importer's collector as they
+  // are typechecked; here each import gets its own and they are concatenated
+  // in the order the serial import would have produced them.
+  absl::Mutex mutex;
+  absl::flat_hash_map<const Module*, std::unique_ptr<WarningCollector>>
+      import_warnings;
+  auto typecheck_import = [&](Module* import) -> absl::StatusOr<TypeInfo*> {
+    auto collector =
+        std::make_unique<WarningCollector>(import_data->enabled_warnings());
+    WarningCollector* import_collector = collector.get();
+    {
+      absl::MutexLock lock(&mutex);
+      import_warnings.emplace(import, std::move(collector));
+    }
+    return TypecheckModule(import, import_data, import_collector);
+  };
+  XLS_ASSIGN_OR_RETURN(
+      std::optional<std::vector<ModuleInfo*>> imported,
+      ImportModulesConcurrently(typecheck_import, *module, import_data,
+                                thread_pool));
+  if (imported.has_value()) {
+    for (ModuleInfo* module_info : *imported) {
+      for (const WarningCollector::Entry& entry :
+           import_warnings.at(&module_info->module())->warnings()) {
+        warnings.Add(entry.span, entry.kind, entry.message);
+      }
+    }
+  }
+  return TypecheckModuleWithWarnings(std::move(module), path, import_data,
+                                     std::move(warnings));
+}
+
 absl::StatusOr<std::unique_ptr<Module>> ParseModule(
     std::string_view text, std::string_view path, std::string_view module_name,
     FileTable& file_table, std::vector<CommentData>* comments) {
@@ -89,26 +193,10 @@ absl::StatusOr<std::unique_ptr<Module>> ParseModuleFromFileAtPath(
 absl::StatusOr<TypecheckedModule> TypecheckModule(
     std::unique_ptr<Module> module, std::string_view path,
     ImportData* import_data) {
-  XLS_RET_CHECK(module.get() != nullptr);
   XLS_RET_CHECK(import_data != nullptr);
-
-  std::string_view module_name = module->name();
-
-  WarningCollector warnings(import_data->enabled_warnings());
-  XLS_ASSIGN_OR_RETURN(
-      TypeInfo * type_info,
-      module->attributes().contains(ModuleAttribute::kTypeInferenceVersion2)
-          ? TypecheckModuleV2(module.get(), import_data, &warnings)
-          : TypecheckModule(module.get(), import_data, &warnings));
-  TypecheckedModule result{module.get(), type_info, std::move(warnings)};
-  XLS_ASSIGN_OR_RETURN(ImportTokens subject,
-                       ImportTokens::FromString(module_name));
-  XLS_RETURN_IF_ERROR(import_data
-                          ->Put(subject, std::make_unique<ModuleInfo>(
-                                             std::move(module), type_info,
-                                             std::filesystem::path(path)))
-                          .status());
-  return result;
+  return TypecheckModuleWithWarnings(
+      std::move(module), path, import_data,
+      WarningCollector(import_data->enabled_warnings()));
 }
 
 }  // namespace xls::dslx
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/comment_data.h"
 #include "xls/dslx/frontend/pos.h"
@@ -46,6 +47,27 @@ absl::StatusOr<TypecheckedModule> ParseAndTypecheck(
     std::string_view text, std::string_view path, std::string_view module_name,
     ImportData* import_data, std::vector<CommentData>* comments = nullptr);
 
+// As above, but first typechecks the modules imported (transitively) by "text"
+// concurrently on "thread_pool", each as soon as all of its own imports are
+// typechecked (see ImportModulesConcurrently()). Wall time then approaches the
+// longest chain of imports rather than the sum over all modules.
+//
+// Warnings are the same as ParseAndTypecheck() reports. Import graphs this
+// can't handle (e.g. with `use` statements) are typechecked serially.
+absl::StatusOr<TypecheckedModule> ParseAndTypecheckConcurrently(
+    std::string_view text, std::string_view path, std::string_view module_name,
+    ImportData* import_data, ThreadPool& thread_pool,
+    std::vector<CommentData>* comments = nullptr);
+
+// As above, but typechecks lazily: only the top-level members reachable from
+// the entry point `top`, in "text" and in the modules it imports, are
+// typechecked (see RestrictToReachableMembers()). Type information is then
+// missing for everything else, so this is only useful for processing `top`,
+// e.g. converting it to IR.
+absl::StatusOr<TypecheckedModule> ParseAndTypecheckReachable(
+    std::string_view text, std::string_view path, std::string_view module_name,
+    std::string_view top, ImportData* import_data);
+
 // Helper that parses and creates a new module from the given "text".
 //
 // "path" is used for error reporting (`Span`s) and module_name is the name
@@ -0,0 +1,170 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/parse_and_typecheck.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/virtualizable_file_system.h"
+#include "xls/dslx/warning_collector.h"
+
+namespace xls::dslx {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAreArray;
+using ::testing::HasSubstr;
+
+using Files = absl::flat_hash_map<std::filesystem::path, std::string>;
+
+// A diamond: `top` imports `left` and `right`, which both instantiate the same
+// parametric function of `leaf` (with different parameters).
+constexpr std::string_view kTop = R"(import left;
+import right;
+
+pub fn main(x: u8, y: u16) -> (u8, u16) { (left::f(x), right::g(y)) }
+)";
+
+Files DiamondFiles() {
+  return Files{
+      {"/fake/top.x", std::string(kTop)},
+      {"/fake/left.x", R"(import leaf;
+
+pub fn f(x: u8) -> u8 { let unused = x; leaf::inc(x) }
+)"},
+      {"/fake/right.x", R"(import leaf;
+
+pub fn g(x: u16) -> u16 { leaf::inc(x) }
+)"},
+      {"/fake/leaf.x", R"(
+pub fn inc<N: u32>(x: uN[N]) -> uN[N] { let unused = x; x + uN[N]:1 }
+)"},
+  };
+}
+
+ImportData MakeImportData(const Files& files) {
+  return CreateImportDataForTest(
+      std::make_unique<FakeFilesystem>(files, "/fake"));
+}
+
+std::vector<std::string> WarningMessages(const WarningCollector& warnings) {
+  std::vector<std::string> messages;
+  for (const WarningCollector::Entry& entry : warnings.warnings()) {
+    messages.push_back(entry.message);
+  }
+  return messages;
+}
+
+TEST(ParseAndTypecheckConcurrentlyTest, MatchesSerial) {
+  ImportData serial_import_data = MakeImportData(DiamondFiles());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule serial,
+      ParseAndTypecheck(kTop, "/fake/top.x", "top", &serial_import_data));
+
+  ThreadPool thread_pool(4);
+  ImportData import_data = MakeImportData(DiamondFiles());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule concurrent,
+      ParseAndTypecheckConcurrently(kTop, "/fake/top.x", "top", &import_data,
+                                    thread_pool));
+
+  for (std::string_view name : {"left", "right", "leaf"}) {
+    EXPECT_TRUE(import_data.Contains(ImportTokens({std::string(name)})))
+        << name;
+  }
+  EXPECT_FALSE(serial.warnings.warnings().empty());
+  EXPECT_THAT(WarningMessages(concurrent.warnings),
+              ElementsAreArray(WarningMessages(serial.warnings)));
+}
+
+TEST(ParseAndTypecheckConcurrentlyTest, ReportsTypeErrorInImport) {
+  Files files = DiamondFiles();
+  files["/fake/leaf.x"] = "pub fn inc<N: u32>(x: uN[N]) -> uN[N] { x + u1:1 }";
+  ThreadPool thread_pool(4);
+  ImportData import_data = MakeImportData(files);
+  EXPECT_THAT(ParseAndTypecheckConcurrently(kTop, "/fake/top.x", "top",
+                                            &import_data, thread_pool),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(ParseAndTypecheckConcurrentlyTest, ReportsCircularImport) {
+  Files files = DiamondFiles();
+  files["/fake/leaf.x"] = "import left;";
+  ThreadPool thread_pool(4);
+  ImportData import_data = MakeImportData(files);
+  EXPECT_THAT(ParseAndTypecheckConcurrently(kTop, "/fake/top.x", "top",
+                                            &import_data, thread_pool),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("RecursiveImportError")));
+}
+
+TEST(ParseAndTypecheckReachableTest, SkipsUnreachableMembers) {
+  constexpr std::string_view kProgram = R"(import lib;
+
+fn unused() -> u8 { lib::BAD }
+
+pub fn main(x: u8) -> u8 { lib::used(x) }
+)";
+  // Typechecking `BAD`, or importing the nonexistent `missing`, fails.
+  Files files{
+      {"/fake/top.x", std::string(kProgram)},
+      {"/fake/lib.x", R"(import missing;
+
+const BAD = u8:256;
+
+fn helper(x: u8) -> u8 { x + u8:1 }
+
+pub fn used(x: u8) -> u8 { helper(x) }
+
+pub fn unused() -> u8 { missing::f() }
+)"},
+  };
+  ImportData serial_import_data = MakeImportData(files);
+  EXPECT_THAT(
+      ParseAndTypecheck(kProgram, "/fake/top.x", "top", &serial_import_data),
+      StatusIs(absl::StatusCode::kNotFound));
+
+  ImportData import_data = MakeImportData(files);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TypecheckedModule tm,
+      ParseAndTypecheckReachable(kProgram, "/fake/top.x", "top", "main",
+                                 &import_data));
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleInfo * lib,
+                           import_data.Get(ImportTokens({"lib"})));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * used,
+                           lib->module().GetMemberOrError<Function>("used"));
+  EXPECT_TRUE(lib->type_info()->GetItem(used->body()).has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(Function * unused,
+                           lib->module().GetMemberOrError<Function>("unused"));
+  EXPECT_FALSE(lib->type_info()->GetItem(unused->body()).has_value());
+}
+
+}  // namespace
+}  // namespace xls::dslx
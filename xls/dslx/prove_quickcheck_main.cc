@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <memory>
@@ -52,6 +53,17 @@ ABSL_FLAG(std::string, disable_warnings, "",
           "recommended, but can be used in exceptional circumstances");
 ABSL_FLAG(bool, warnings_as_errors, true,
           "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(int64_t, partition_bits, 0,
+          "If positive, split the input space of each quickcheck on this many "
+          "of its most significant input bits and prove each of the resulting "
+          "2^partition_bits partitions as a separate query, reporting which "
+          "are proven, failing, or timed out.");
+ABSL_FLAG(int64_t, partition_threads, 0,
+          "Number of threads proving partitions concurrently; zero means one "
+          "per CPU. Only used with --partition_bits.");
+ABSL_FLAG(absl::Duration, partition_timeout, absl::InfiniteDuration(),
+          "Solver timeout for each partition. Only used with "
+          "--partition_bits.");
 
 static constexpr std::string_view kUsage = R"(
 Attempts to proves a single quickcheck property in a given module to be
@@ -91,6 +103,9 @@ absl::StatusOr<TestResultData> RealMain(
       .test_filter = test_filter_re_ptr,
       .warnings_as_errors = warnings_as_errors,
       .warnings = warnings,
+      .partition_bit_count = absl::GetFlag(FLAGS_partition_bits),
+      .partition_thread_count = absl::GetFlag(FLAGS_partition_threads),
+      .partition_timeout = absl::GetFlag(FLAGS_partition_timeout),
   };
 
   XLS_ASSIGN_OR_RETURN(
@@ -14,6 +14,7 @@
 
 #include "xls/dslx/run_routines/ir_test_runner.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -36,6 +37,8 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
 #include "xls/dslx/errors.h"
 #include "xls/dslx/frontend/ast.h"
@@ -46,6 +49,7 @@
 #include "xls/dslx/ir_convert/conversion_info.h"
 #include "xls/dslx/ir_convert/convert_options.h"
 #include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/run_routines/run_comparator.h"
 #include "xls/dslx/run_routines/run_routines.h"
 #include "xls/dslx/type_system/type_info.h"
 #include "xls/dslx/warning_kind.h"
@@ -67,22 +71,64 @@
 
 namespace xls::dslx {
 namespace {
+
+// Runs a prepared (e.g. JIT-compiled) test function on the given arguments.
+using FunctionRunner = std::function<absl::StatusOr<InterpreterResult<Value>>(
+    absl::Span<Value const>)>;
+
+// Prepares a test function to be run, e.g. by JIT-compiling it.
+using FunctionPreparer =
+    std::function<absl::StatusOr<FunctionRunner>(xls::Function*)>;
+
 class IrRunner : public AbstractParsedTestRunner {
  public:
+  // Prepares every function test up front, concurrently, so that the (mostly
+  // compile-bound) cost of JIT-ing a module's tests is paid in parallel rather
+  // than serially as each test is run.
   IrRunner(
       absl::flat_hash_map<std::string, std::unique_ptr<Package>>&& packages,
       absl::flat_hash_map<std::string, std::string>&& finish_chan_names,
       std::function<absl::StatusOr<std::unique_ptr<ProcRuntime>>(xls::Package*)>
           proc_runner,
-      std::function<absl::StatusOr<InterpreterResult<Value>>(
-          xls::Function* f, absl::Span<Value const>)>
-          func_runner,
-      ImportData* import_data)
+      const FunctionPreparer& func_preparer, ImportData* import_data,
+      TypeInfo* type_info, Module* module)
       : packages_(std::move(packages)),
         finish_chan_names_(std::move(finish_chan_names)),
         proc_runner_(std::move(proc_runner)),
-        func_runner_(std::move(func_runner)),
-        import_data_(import_data) {}
+        import_data_(import_data),
+        fallback_(import_data, type_info, module) {
+    std::vector<std::pair<std::string_view, xls::Function*>> functions;
+    for (const auto& [name, package] : packages_) {
+      if (finish_chan_names_.contains(name)) {
+        continue;
+      }
+      absl::StatusOr<xls::Function*> f = package->GetTopAsFunction();
+      if (!f.ok()) {
+        func_runners_.emplace(name, f.status());
+        continue;
+      }
+      func_runners_.emplace(name, absl::UnknownError("not prepared"));
+      functions.push_back({name, *f});
+    }
+    if (functions.size() <= 1) {
+      for (const auto& [name, f] : functions) {
+        func_runners_.at(name) = func_preparer(f);
+      }
+      return;
+    }
+    // Each test lives in its own package so the preparations are independent;
+    // the map entries are all inserted above so writes here don't rehash.
+    ThreadPool pool(std::min<int64_t>(functions.size(), AvailableCPUs()));
+    for (const auto& [name, f] : functions) {
+      absl::StatusOr<FunctionRunner>* slot = &func_runners_.at(name);
+      pool.Schedule([slot, f, &func_preparer] { *slot = func_preparer(f); });
+    }
+    pool.WaitForIdle();
+  }
+
+  // Every test has its own package, runtime and prepared function, so tests may
+  // be run concurrently.
+  bool SupportsConcurrentTests() const override { return true; }
 
   // TODO need to move to having each test proc have its own package from
   // ir_convert.
@@ -131,6 +177,9 @@ class IrRunner : public AbstractParsedTestRunner {
   absl::StatusOr<RunResult> RunTestProc(
       std::string_view name,
       const BytecodeInterpreterOptions& options) override {
+    if (!packages_.contains(name)) {
+      return fallback_.RunTestProc(name, options);
+    }
     if (options.trace_channels()) {
       LOG(WARNING) << "Unable to trace channels with IR testing";
     }
@@ -142,12 +191,6 @@ class IrRunner : public AbstractParsedTestRunner {
     XLS_RET_CHECK(finish_chan_names_.contains(name)) << name << " not found.";
     std::string_view finish_name = finish_chan_names_.at(name);
     auto package = packages_.at(name).get();
-    // TODO(https://github.com/google/xls/issues/1592) To avoid any issues with
-    // empty-procs or unrelated making deadlock detection not work due to
-    // entering livelock we run DFE on the package.
-    DeadFunctionEliminationPass dfe;
-    PassResults pr;
-    XLS_RETURN_IF_ERROR(dfe.Run(package, {}, &pr).status());
     // Get the corresponding entries.
     XLS_ASSIGN_OR_RETURN(auto* top, package->GetTopAsProc());
     XLS_ASSIGN_OR_RETURN(
@@ -162,12 +205,18 @@ class IrRunner : public AbstractParsedTestRunner {
   absl::StatusOr<RunResult> RunTestFunction(
       std::string_view name,
       const BytecodeInterpreterOptions& options) override {
+    if (!packages_.contains(name)) {
+      return fallback_.RunTestFunction(name, options);
+    }
     auto* func_package = packages_.at(name).get();
     XLS_ASSIGN_OR_RETURN(xls::Function * f, func_package->GetTopAsFunction());
     XLS_RET_CHECK(f->GetType()->return_type()->IsTuple()) << f->GetType();
     XLS_RET_CHECK_EQ(f->GetType()->return_type()->AsTupleOrDie()->size(), 0)
         << f->GetType();
-    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> v, this->func_runner_(f, {}));
+    XLS_RET_CHECK(func_runners_.contains(name)) << name << " not prepared.";
+    XLS_ASSIGN_OR_RETURN(const FunctionRunner& func_runner,
+                         func_runners_.at(name));
+    XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> v, func_runner({}));
     for (const TraceMessage& trace : v.events.trace_msgs) {
       options.trace_hook()(
           Span::FromString(trace.message, file_table()).value_or(Span{}),
@@ -187,17 +236,18 @@ class IrRunner : public AbstractParsedTestRunner {
   absl::flat_hash_map<std::string, std::string> finish_chan_names_;
   std::function<absl::StatusOr<std::unique_ptr<ProcRuntime>>(xls::Package*)>
       proc_runner_;
-  std::function<absl::StatusOr<InterpreterResult<Value>>(
-      xls::Function* f, absl::Span<Value const>)>
-      func_runner_;
+  // The prepared function for each function test, keyed by test name. Only
+  // written during construction.
+  absl::flat_hash_map<std::string, absl::StatusOr<FunctionRunner>>
+      func_runners_;
   ImportData* import_data_;
+  // Runs the tests which could not be converted to IR.
+  DslxInterpreterParsedTestRunner fallback_;
 };
 
 absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> MakeRunner(
     ImportData* import_data, TypeInfo* type_info, Module* module,
-    std::function<absl::StatusOr<InterpreterResult<Value>>(
-        xls::Function* f, absl::Span<Value const>)>
-        func,
+    const FunctionPreparer& func,
     std::function<absl::StatusOr<std::unique_ptr<ProcRuntime>>(xls::Package*)>
         proc) {
   ConvertOptions base_option{
@@ -217,8 +267,16 @@ absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> MakeRunner(
     PackageConversionData package_data{
         .package = std::make_unique<Package>(
             absl::StrFormat("%s_test_for_package_%s", name, module->name()))};
-    XLS_RETURN_IF_ERROR(ConvertOneFunctionIntoPackage(
-        module, name, import_data, nullptr, base_option, &package_data));
+    absl::Status converted = ConvertOneFunctionIntoPackage(
+        module, name, import_data, nullptr, base_option, &package_data);
+    if (!converted.ok()) {
+      // Some constructs (e.g. trace formatting the IR can't express) are only
+      // supported by the DSLX interpreter, which then runs the test instead.
+      LOG(WARNING) << "Unable to convert test " << name
+                   << " to IR; running it with the DSLX interpreter: "
+                   << converted;
+      continue;
+    }
     if (std::holds_alternative<TestProc*>(*member)) {
       TestProc* tp = std::get<TestProc*>(*member);
       std::string dslx_chan_name =
@@ -226,12 +284,22 @@ absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> MakeRunner(
       // TODO(allight): This duplicates code in the ir_convert/channel_scope.cc
       finish_chan_names[name] =
           absl::StrCat(package_data.package->name(), "__", dslx_chan_name);
+      // TODO(https://github.com/google/xls/issues/1592) To avoid any issues
+      // with empty-procs or unrelated making deadlock detection not work due
+      // to entering livelock we run DFE on the package. This is done here
+      // rather than when the test is run so that concurrently run tests never
+      // mutate IR.
+      DeadFunctionEliminationPass dfe;
+      PassResults pr;
+      XLS_RETURN_IF_ERROR(
+          dfe.Run(package_data.package.get(), {}, &pr).status());
     }
     packages[name] = std::move(package_data.package);
   }
-  return std::make_unique<IrRunner>(
-      std::move(packages), std::move(finish_chan_names), std::move(proc),
-      std::move(func), import_data);
+  return std::make_unique<IrRunner>(std::move(packages),
+                                    std::move(finish_chan_names),
+                                    std::move(proc), func, import_data,
+                                    type_info, module);
 }
 }  // namespace
 
@@ -240,24 +308,35 @@ IrJitTestRunner::CreateTestRunner(ImportData* import_data, TypeInfo* type_info,
                                   Module* module) const {
   return MakeRunner(
       import_data, type_info, module,
-      [](xls::Function* f,
-         auto args) -> absl::StatusOr<InterpreterResult<Value>> {
-        XLS_ASSIGN_OR_RETURN(auto jit, FunctionJit::Create(f));
-        return jit->Run(args);
+      // The compiled object code is looked up in (and added to) the default
+      // JIT object cache, so with XLS_JIT_OBJECT_CACHE_DIR set unchanged tests
+      // aren't recompiled when the test binary is rerun.
+      [](xls::Function* f) -> absl::StatusOr<FunctionRunner> {
+        XLS_ASSIGN_OR_RETURN(std::unique_ptr<FunctionJit> jit,
+                             FunctionJit::Create(f));
+        return [jit = std::shared_ptr<FunctionJit>(std::move(jit))](
+                   absl::Span<Value const> args) { return jit->Run(args); };
       },
       [](xls::Package* p) -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
         return CreateJitSerialProcRuntime(p, EvaluatorOptions());
       });
 }
 
+std::unique_ptr<AbstractRunComparator>
+IrJitTestRunner::CreateQuickCheckComparator() const {
+  return std::make_unique<RunComparator>(CompareMode::kJit);
+}
+
 absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>>
 IrInterpreterTestRunner::CreateTestRunner(ImportData* import_data,
                                           TypeInfo* type_info,
                                           Module* module) const {
   return MakeRunner(
       import_data, type_info, module,
-      [&](xls::Function* f, absl::Span<Value const> args) {
-        return InterpretFunction(f, args);
+      [](xls::Function* f) -> absl::StatusOr<FunctionRunner> {
+        return [f](absl::Span<Value const> args) {
+          return InterpretFunction(f, args);
+        };
       },
       [](xls::Package* p) -> absl::StatusOr<std::unique_ptr<ProcRuntime>> {
         return CreateInterpreterSerialProcRuntime(p, EvaluatorOptions());
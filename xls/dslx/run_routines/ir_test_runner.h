@@ -32,11 +32,17 @@ class IrInterpreterTestRunner : public AbstractTestRunner {
       Module* module) const override;
 };
 
+// Runs each test by converting it to IR and JIT-compiling it; tests which
+// can't be converted are run with the DSLX interpreter instead. Quickchecks are
+// JIT-compiled as well, so they run even without a comparison mode.
 class IrJitTestRunner : public AbstractTestRunner {
  protected:
   absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>> CreateTestRunner(
       ImportData* import_data, TypeInfo* type_info,
       Module* module) const override;
+
+  std::unique_ptr<AbstractRunComparator> CreateQuickCheckComparator()
+      const override;
 };
 
 }  // namespace xls::dslx
@@ -14,6 +14,8 @@
 
 #include "xls/dslx/run_routines/run_comparator.h"
 
+#include <cmath>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -36,8 +38,12 @@
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/package.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls::dslx {
 
@@ -54,6 +60,17 @@ absl::StatusOr<FunctionJit*> RunComparator::GetOrCompileJitFunction(
   return result;
 }
 
+bool RunComparator::SampleInvocation(FunctionComparisons& comparisons) const {
+  // Invocation n is sampled when it carries ceil(n * rate) over an integer, so
+  // that exactly ceil(count * rate) of the first count invocations are.
+  const int64_t n = comparisons.invocation_count++;
+  if (options_.sample_rate >= 1.0) {
+    return true;
+  }
+  return std::ceil(static_cast<double>(n + 1) * options_.sample_rate) >
+         std::ceil(static_cast<double>(n) * options_.sample_rate);
+}
+
 absl::Status RunComparator::RunComparison(Package* ir_package,
                                           bool requires_implicit_token,
                                           const dslx::Function* f,
@@ -81,7 +98,14 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
     return absl::OkStatus();
   }
 
-  xls::Function* ir_function = *get_result;
+  auto [it, inserted] = comparisons_.try_emplace(
+      ir_name, FunctionComparisons{
+                   .ir_function = *get_result,
+                   .requires_implicit_token = requires_implicit_token});
+  FunctionComparisons& comparisons = it->second;
+  if (!SampleInvocation(comparisons)) {
+    return absl::OkStatus();
+  }
 
   XLS_ASSIGN_OR_RETURN(std::vector<Value> ir_args,
                        InterpValue::ConvertValuesToIr(args));
@@ -93,51 +117,163 @@ absl::Status RunComparator::RunComparison(Package* ir_package,
     ir_args.insert(ir_args.begin(), Value::Token());
   }
 
+  // Convert the interpreter value to an IR value so we can compare it.
+  //
+  // Note this conversion is lossy, but that's ok because we're just looking for
+  // mismatches.
+  XLS_ASSIGN_OR_RETURN(Value interp_ir_value, got.ConvertToIr());
+
+  comparisons.pending.push_back(PendingComparison{
+      .ir_args = std::move(ir_args), .expected = std::move(interp_ir_value)});
+  if (comparisons.pending.size() < options_.batch_size) {
+    return absl::OkStatus();
+  }
+  return CompareBatch(ir_name, comparisons);
+}
+
+// Returns the error for an IR result which differs from the DSL interpreter's.
+static absl::Status ResultMismatchError(std::string_view mode_str,
+                                        const xls::Function* ir_function,
+                                        const Value& ir_result,
+                                        const Value& interp_ir_value) {
+  return absl::InternalError(absl::StrFormat(
+      "IR %s produced a different value from the DSL "
+      "interpreter for %s; IR %s: %s "
+      "DSL interpreter: %s",
+      mode_str, ir_function->name(), mode_str, ir_result.ToString(),
+      interp_ir_value.ToString()));
+}
+
+absl::Status RunComparator::CompareBatchOnJit(
+    FunctionJit* jit, FunctionComparisons& comparisons,
+    absl::Span<const PendingComparison> pending) {
+  xls::Function* ir_function = comparisons.ir_function;
+  if (!comparisons.jit_layouts.has_value()) {
+    std::vector<TypeLayout> params;
+    for (xls::Type* param_type : ir_function->GetType()->parameters()) {
+      params.push_back(jit->runtime()->CreateTypeLayout(param_type));
+    }
+    comparisons.jit_layouts.emplace(NativeLayouts{
+        .params = std::move(params),
+        .result = jit->runtime()->CreateTypeLayout(
+            ir_function->GetType()->return_type())});
+  }
+  const NativeLayouts& layouts = *comparisons.jit_layouts;
+
+  using BatchBuffer = std::unique_ptr<uint8_t[], DeleteAligned>;
+  const int64_t batch_size = pending.size();
+  std::vector<BatchBuffer> arg_storage;
+  std::vector<uint8_t*> arg_buffers;
+  for (int64_t i = 0; i < layouts.params.size(); ++i) {
+    const int64_t stride = jit->GetBatchedArgStride(i);
+    arg_storage.push_back(AllocateBatchBuffer(jit->GetBatchedArgAlignment(i),
+                                              stride, batch_size));
+    arg_buffers.push_back(arg_storage.back().get());
+    for (int64_t b = 0; b < batch_size; ++b) {
+      const Value& arg = pending[b].ir_args.at(i);
+      XLS_RET_CHECK(ValueConformsToType(arg, layouts.params[i].type()))
+          << "Argument " << arg.ToString() << " is not of type "
+          << layouts.params[i].type()->ToString();
+      layouts.params[i].ValueToNativeLayout(arg,
+                                            arg_buffers.back() + b * stride);
+    }
+  }
+  const int64_t result_stride = jit->GetBatchedReturnStride();
+  BatchBuffer results = AllocateBatchBuffer(jit->GetBatchedReturnAlignment(),
+                                            result_stride, batch_size);
+
+  // TODO(https://github.com/google/xls/issues/506): Also compare events
+  // once the DSLX interpreter supports them (and the JIT supports traces).
+  InterpreterEvents events;
+  XLS_RETURN_IF_ERROR(jit->RunBatchedWithViews(arg_buffers, results.get(),
+                                               batch_size, &events));
+  XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(events));
+
+  std::vector<uint8_t> expected(layouts.result.size());
+  for (int64_t b = 0; b < batch_size; ++b) {
+    const uint8_t* result = results.get() + b * result_stride;
+    // The implicit token carries no data, so the expected value can be laid
+    // out in the result's native layout with any token in its place.
+    Value interp_ir_value =
+        comparisons.requires_implicit_token
+            ? Value::Tuple({Value::Token(), pending[b].expected})
+            : pending[b].expected;
+    if (ValueConformsToType(interp_ir_value, layouts.result.type())) {
+      layouts.result.ValueToNativeLayout(interp_ir_value, expected.data());
+      if (layouts.result.NativeLayoutEquals(result, expected.data())) {
+        continue;
+      }
+    }
+    Value ir_result = layouts.result.NativeLayoutToValue(result);
+    if (comparisons.requires_implicit_token) {
+      Value real_ir_result = ir_result.element(1);
+      ir_result = std::move(real_ir_result);
+    }
+    return ResultMismatchError("JIT", ir_function, ir_result,
+                               pending[b].expected);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RunComparator::CompareBatch(std::string_view ir_name,
+                                         FunctionComparisons& comparisons) {
+  if (comparisons.pending.empty()) {
+    return absl::OkStatus();
+  }
+  std::vector<PendingComparison> pending = std::move(comparisons.pending);
+  comparisons.pending.clear();
+  xls::Function* ir_function = comparisons.ir_function;
+
   const char* mode_str = nullptr;
-  Value ir_result;
+  std::vector<Value> ir_results;
   switch (mode_) {
     case CompareMode::kJit: {  // Compare to IR JIT.
-      // TODO(https://github.com/google/xls/issues/506): Also compare events
-      // once the DSLX interpreter supports them (and the JIT supports traces).
       XLS_ASSIGN_OR_RETURN(FunctionJit * jit,
                            GetOrCompileJitFunction(ir_name, ir_function));
-      XLS_ASSIGN_OR_RETURN(ir_result, DropInterpreterEvents(jit->Run(ir_args)));
-      mode_str = "JIT";
-      break;
+      return CompareBatchOnJit(jit, comparisons, pending);
     }
     case CompareMode::kInterpreter: {  // Compare to IR interpreter.
-      XLS_ASSIGN_OR_RETURN(ir_result, DropInterpreterEvents(InterpretFunction(
-                                          ir_function, ir_args)));
+      for (const PendingComparison& comparison : pending) {
+        XLS_ASSIGN_OR_RETURN(Value ir_result,
+                             DropInterpreterEvents(InterpretFunction(
+                                 ir_function, comparison.ir_args)));
+        ir_results.push_back(std::move(ir_result));
+      }
       mode_str = "interpreter";
       break;
     }
   }
+  XLS_RET_CHECK_EQ(ir_results.size(), pending.size());
 
-  if (requires_implicit_token) {
-    // Slice off the first value.
-    XLS_RET_CHECK(ir_result.element(0).IsToken());
-    XLS_RET_CHECK_EQ(ir_result.size(), 2);
-    Value real_ir_result = ir_result.element(1);
-    ir_result = std::move(real_ir_result);
-  }
-
-  // Convert the interpreter value to an IR value so we can compare it.
-  //
-  // Note this conversion is lossy, but that's ok because we're just looking for
-  // mismatches.
-  XLS_ASSIGN_OR_RETURN(Value interp_ir_value, got.ConvertToIr());
+  for (int64_t i = 0; i < pending.size(); ++i) {
+    Value& ir_result = ir_results[i];
+    if (comparisons.requires_implicit_token) {
+      // Slice off the first value.
+      XLS_RET_CHECK(ir_result.element(0).IsToken());
+      XLS_RET_CHECK_EQ(ir_result.size(), 2);
+      Value real_ir_result = ir_result.element(1);
+      ir_result = std::move(real_ir_result);
+    }
 
-  if (interp_ir_value != ir_result) {
-    return absl::InternalError(
-        absl::StrFormat("IR %s produced a different value from the DSL "
-                        "interpreter for %s; IR %s: %s "
-                        "DSL interpreter: %s",
-                        mode_str, ir_function->name(), mode_str,
-                        ir_result.ToString(), interp_ir_value.ToString()));
+    const Value& interp_ir_value = pending[i].expected;
+    if (interp_ir_value != ir_result) {
+      return ResultMismatchError(mode_str, ir_function, ir_result,
+                                 interp_ir_value);
+    }
   }
   return absl::OkStatus();
 }
 
+absl::Status RunComparator::FlushComparisons() {
+  // Every function's batch is compared (and cleared) even if an earlier one
+  // mismatched; the first mismatch is returned.
+  absl::Status status;
+  for (auto& [ir_name, comparisons] : comparisons_) {
+    status.Update(CompareBatch(ir_name, comparisons));
+  }
+  return status;
+}
+
 absl::StatusOr<InterpreterResult<xls::Value>> RunComparator::RunIrFunction(
     std::string_view ir_name, xls::Function* ir_function,
     absl::Span<const xls::Value> ir_args) {
@@ -17,8 +17,10 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
@@ -33,6 +35,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
 #include "xls/jit/function_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls::dslx {
 
@@ -43,6 +46,22 @@ enum class CompareMode : uint8_t {
   kInterpreter,
 };
 
+// Controls how much of the DSLX interpreter's execution a RunComparator
+// cross-checks, and how.
+struct RunComparatorOptions {
+  // Fraction of each function's invocations which are compared, in [0, 1].
+  // Sampling is deterministic: with a rate of 1/N, every Nth invocation of a
+  // function (starting with the first) is compared.
+  double sample_rate = 1.0;
+
+  // Number of sampled invocations of a function which are collected before
+  // they're compared; in JIT mode the whole batch is evaluated by a single
+  // call into the jitted code. With a batch size of one every sampled
+  // invocation is compared as it happens. Pending comparisons are otherwise
+  // made when the batch is full or on FlushComparisons().
+  int64_t batch_size = 1;
+};
+
 // Helper object that is used as a post-execution hook in the interpreter,
 // comparing interpreter results to results computed by the JIT to check that
 // they're equivalent.
@@ -51,7 +70,9 @@ enum class CompareMode : uint8_t {
 // inspect cache state more easily than closing over it, e.g. for testing.
 class RunComparator : public AbstractRunComparator {
  public:
-  explicit RunComparator(CompareMode mode) : mode_(mode) {}
+  explicit RunComparator(CompareMode mode,
+                         RunComparatorOptions options = RunComparatorOptions())
+      : mode_(mode), options_(options) {}
 
   absl::Status RunComparison(Package* ir_package, bool requires_implicit_token,
                              const Function* f,
@@ -59,6 +80,8 @@ class RunComparator : public AbstractRunComparator {
                              const ParametricEnv* parametric_env,
                              const InterpValue& got) override;
 
+  absl::Status FlushComparisons() override;
+
   absl::StatusOr<InterpreterResult<xls::Value>> RunIrFunction(
       std::string_view ir_name, xls::Function* ir_function,
       absl::Span<const xls::Value> ir_args) override;
@@ -77,9 +100,50 @@ class RunComparator : public AbstractRunComparator {
   XLS_FRIEND_TEST(RunRoutinesTest, QuickcheckInvokedFunctionDoesJit);
   XLS_FRIEND_TEST(RunRoutinesTest, QuickcheckExhaustive);
   XLS_FRIEND_TEST(RunRoutinesTest, NoSeedStillQuickChecks);
+  XLS_FRIEND_TEST(RunRoutinesTest, SampledComparisonsAreBatched);
+  XLS_FRIEND_TEST(RunRoutinesTest, ZeroSampleRateComparesNothing);
+
+  // A sampled invocation whose comparison has been deferred to its batch.
+  struct PendingComparison {
+    std::vector<Value> ir_args;
+    Value expected;
+  };
+
+  // The JIT's native layouts of an IR function's parameters and result.
+  struct NativeLayouts {
+    std::vector<TypeLayout> params;
+    TypeLayout result;
+  };
+
+  // The comparison state for one IR function, keyed by its mangled name.
+  struct FunctionComparisons {
+    xls::Function* ir_function;
+    bool requires_implicit_token;
+    // Number of invocations seen so far, sampled or not.
+    int64_t invocation_count = 0;
+    std::vector<PendingComparison> pending;
+    // Created on the first comparison against the JIT.
+    std::optional<NativeLayouts> jit_layouts;
+  };
+
+  // Returns whether the next invocation of the function is to be compared.
+  bool SampleInvocation(FunctionComparisons& comparisons) const;
+
+  // Compares (and clears) all pending invocations of the given function.
+  absl::Status CompareBatch(std::string_view ir_name,
+                            FunctionComparisons& comparisons);
+
+  // Evaluates `pending` with a single batched call into `jit` and compares the
+  // results to the expected values in the JIT's native layout. Results are
+  // only converted to `Value`s to report a mismatch.
+  absl::Status CompareBatchOnJit(FunctionJit* jit,
+                                 FunctionComparisons& comparisons,
+                                 absl::Span<const PendingComparison> pending);
 
   absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> jit_cache_;
+  absl::flat_hash_map<std::string, FunctionComparisons> comparisons_;
   CompareMode mode_;
+  RunComparatorOptions options_;
 };
 
 }  // namespace xls::dslx
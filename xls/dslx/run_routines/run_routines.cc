@@ -19,6 +19,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <ctime>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -38,11 +39,13 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/bytecode/bytecode.h"
 #include "xls/dslx/bytecode/bytecode_cache.h"
 #include "xls/dslx/bytecode/bytecode_emitter.h"
@@ -76,6 +79,7 @@
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "re2/re2.h"
@@ -132,14 +136,15 @@ void HandleError(TestResultData& result, const absl::Status& status,
 absl::Status RunDslxTestFunction(ImportData* import_data, TypeInfo* type_info,
                                  Module* module, TestFunction* tf,
                                  const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>();
+  BytecodeEmitterOptions emitter_options{
+      .format_preference = options.format_preference(),
+      .fuse_superinstructions = true};
+  auto cache = std::make_unique<BytecodeCache>(
+      BytecodeEmitterOptions{.fuse_superinstructions = true});
   import_data->SetBytecodeCache(std::move(cache));
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<BytecodeFunction> bf,
-      BytecodeEmitter::Emit(
-          import_data, type_info, tf->fn(), std::nullopt,
-          BytecodeEmitterOptions{.format_preference =
-                                     options.format_preference()}));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BytecodeFunction> bf,
+                       BytecodeEmitter::Emit(import_data, type_info, tf->fn(),
+                                             std::nullopt, emitter_options));
   return BytecodeInterpreter::Interpret(import_data, bf.get(), /*args=*/{},
                                         /*hierarchy_interpreter=*/std::nullopt,
                                         options)
@@ -149,7 +154,8 @@ absl::Status RunDslxTestFunction(ImportData* import_data, TypeInfo* type_info,
 absl::Status RunDslxTestProc(ImportData* import_data, TypeInfo* type_info,
                              Module* module, TestProc* tp,
                              const BytecodeInterpreterOptions& options) {
-  auto cache = std::make_unique<BytecodeCache>();
+  auto cache = std::make_unique<BytecodeCache>(
+      BytecodeEmitterOptions{.fuse_superinstructions = true});
   import_data->SetBytecodeCache(std::move(cache));
 
   XLS_ASSIGN_OR_RETURN(TypeInfo * ti,
@@ -288,17 +294,19 @@ static std::vector<Value> MakeFromUint64(xls::TupleType* tuple_type,
   return value.GetElements().value();
 };
 
-absl::StatusOr<QuickCheckResults> DoQuickCheck(
-    xls::Function* xls_function, std::string_view ir_name,
-    AbstractRunComparator* run_comparator, int64_t seed,
-    QuickCheckTestCases test_cases) {
-  QuickCheckResults results;
-  std::minstd_rand rng_engine(seed);
+// The stimulus of a quickcheck: `count` argument sets, the i-th of which is
+// produced by `make(i)`. Argument sets must be made in order since counted
+// quickchecks draw them from a shared random engine.
+struct QuickCheckArgSets {
+  int64_t count;
+  std::function<std::vector<Value>(int64_t)> make;
+};
+
+static absl::StatusOr<QuickCheckArgSets> MakeQuickCheckArgSets(
+    xls::Function* xls_function, QuickCheckTestCases test_cases,
+    std::minstd_rand& rng_engine) {
   xls::TupleType* param_tuple = xls_function->package()->GetTupleType(
       xls_function->GetType()->parameters());
-
-  int64_t num_tests;
-  std::function<std::vector<Value>(int64_t)> make_arg_set;
   switch (test_cases.tag()) {
     case QuickCheckTestCasesTag::kExhaustive: {
       int64_t parameter_bit_count = param_tuple->GetFlatBitCount();
@@ -309,21 +317,45 @@ absl::StatusOr<QuickCheckResults> DoQuickCheck(
                             "got: %d",
                             xls_function->name(), parameter_bit_count));
       }
-      num_tests = int64_t{1} << parameter_bit_count;
-      make_arg_set = [&](int64_t i) { return MakeFromUint64(param_tuple, i); };
-      break;
+      return QuickCheckArgSets{
+          .count = int64_t{1} << parameter_bit_count,
+          .make = [param_tuple](int64_t i) {
+            return MakeFromUint64(param_tuple, i);
+          }};
     }
     case QuickCheckTestCasesTag::kCounted:
-      num_tests =
-          test_cases.count().value_or(QuickCheckTestCases::kDefaultTestCount);
-      make_arg_set = [&](int64_t) {
-        return RandomFunctionArguments(xls_function, rng_engine);
-      };
-      break;
+      return QuickCheckArgSets{
+          .count = test_cases.count().value_or(
+              QuickCheckTestCases::kDefaultTestCount),
+          .make = [xls_function, &rng_engine](int64_t) {
+            return RandomFunctionArguments(xls_function, rng_engine);
+          }};
   }
+  return absl::InternalError("Invalid quickcheck test cases tag");
+}
+
+// In the case of an implicit token signature we get (token, bool) as the
+// result of the quickcheck'd function, so we unbox the boolean here.
+static absl::StatusOr<Value> UnboxQuickCheckResult(Value result) {
+  if (result.IsTuple()) {
+    result = result.elements()[1];
+    XLS_RET_CHECK(result.IsBits());
+  }
+  return result;
+}
 
-  for (int i = 0; i < num_tests; i++) {
-    results.arg_sets.push_back(make_arg_set(i));
+absl::StatusOr<QuickCheckResults> DoQuickCheck(
+    xls::Function* xls_function, std::string_view ir_name,
+    AbstractRunComparator* run_comparator, int64_t seed,
+    QuickCheckTestCases test_cases) {
+  QuickCheckResults results;
+  std::minstd_rand rng_engine(seed);
+  XLS_ASSIGN_OR_RETURN(
+      QuickCheckArgSets arg_sets,
+      MakeQuickCheckArgSets(xls_function, test_cases, rng_engine));
+
+  for (int64_t i = 0; i < arg_sets.count; i++) {
+    results.arg_sets.push_back(arg_sets.make(i));
     // TODO(https://github.com/google/xls/issues/506): 2021-10-15
     // Assertion failures should work out, but we should consciously decide
     // if/how we want to dump traces when running QuickChecks (always, for
@@ -331,13 +363,7 @@ absl::StatusOr<QuickCheckResults> DoQuickCheck(
     XLS_ASSIGN_OR_RETURN(xls::Value result,
                          DropInterpreterEvents(run_comparator->RunIrFunction(
                              ir_name, xls_function, results.arg_sets.back())));
-
-    // In the case of an implicit token signature we get (token, bool) as the
-    // result of the quickcheck'd function, so we unbox the boolean here.
-    if (result.IsTuple()) {
-      result = result.elements()[1];
-      XLS_RET_CHECK(result.IsBits());
-    }
+    XLS_ASSIGN_OR_RETURN(result, UnboxQuickCheckResult(std::move(result)));
 
     results.results.push_back(result);
 
@@ -351,6 +377,69 @@ absl::StatusOr<QuickCheckResults> DoQuickCheck(
   return results;
 }
 
+absl::StatusOr<QuickCheckResults> DoQuickCheckConcurrently(
+    xls::Function* xls_function, int64_t seed, QuickCheckTestCases test_cases,
+    ThreadPool& thread_pool, int64_t batch_size) {
+  XLS_RET_CHECK_GT(batch_size, 0);
+  QuickCheckResults results;
+  std::minstd_rand rng_engine(seed);
+  XLS_ASSIGN_OR_RETURN(
+      QuickCheckArgSets arg_sets,
+      MakeQuickCheckArgSets(xls_function, test_cases, rng_engine));
+
+  // Samples are evaluated in rounds of one batch per worker; each batch slot
+  // keeps its own JIT since a FunctionJit may only be run by one thread at a
+  // time. The JITs are compiled lazily by the workers, so short quickchecks
+  // only pay for the compilations they need.
+  const int64_t slot_count = thread_pool.num_threads();
+  const int64_t round_size = slot_count * batch_size;
+  std::vector<std::unique_ptr<FunctionJit>> jits(slot_count);
+  int64_t next = 0;
+  while (next < arg_sets.count) {
+    // Argument sets are made on this thread, in order, so the samples don't
+    // depend on the number of threads.
+    std::vector<std::vector<Value>> round_args;
+    for (int64_t i = 0; i < round_size && next < arg_sets.count; ++i) {
+      round_args.push_back(arg_sets.make(next++));
+    }
+    const int64_t batch_count =
+        (static_cast<int64_t>(round_args.size()) + batch_size - 1) / batch_size;
+    std::vector<absl::StatusOr<std::vector<Value>>> batch_results(
+        batch_count, absl::InternalError("Quickcheck batch was not run"));
+    thread_pool.ParallelFor(batch_count, /*grain=*/1, [&](int64_t b) {
+      if (jits[b] == nullptr) {
+        absl::StatusOr<std::unique_ptr<FunctionJit>> jit =
+            FunctionJit::Create(xls_function);
+        if (!jit.ok()) {
+          batch_results[b] = jit.status();
+          return;
+        }
+        jits[b] = *std::move(jit);
+      }
+      batch_results[b] = DropInterpreterEvents(jits[b]->RunBatched(
+          absl::MakeConstSpan(round_args).subspan(b * batch_size, batch_size)));
+    });
+
+    // Scan the samples in order so the first falsifying example is reported,
+    // exactly as DoQuickCheck would.
+    for (int64_t b = 0; b < batch_count; ++b) {
+      XLS_RETURN_IF_ERROR(batch_results[b].status());
+      for (int64_t i = 0; i < batch_results[b]->size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            Value result,
+            UnboxQuickCheckResult(std::move(batch_results[b]->at(i))));
+        results.arg_sets.push_back(std::move(round_args[b * batch_size + i]));
+        results.results.push_back(result);
+        if (result.IsAllZeros()) {
+          return results;
+        }
+      }
+    }
+  }
+
+  return results;
+}
+
 struct QuickcheckIrFn {
   std::string ir_name;
   xls::Function* ir_function;
@@ -384,7 +473,10 @@ static absl::StatusOr<QuickcheckIrFn> FindQuickcheckIrFn(Function* fn,
                       absl::StrJoin(ir_package->GetFunctionNames(), ", ")));
 }
 
+// Runs the quickcheck with `run_comparator`, or concurrently on `thread_pool`
+// when one is given.
 static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
+                                  ThreadPool* thread_pool, int64_t batch_size,
                                   Package* ir_package, QuickCheck* quickcheck,
                                   TypeInfo* type_info, int64_t seed) {
   // Note: DSLX function.
@@ -393,10 +485,19 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
   XLS_ASSIGN_OR_RETURN(QuickcheckIrFn qc_fn,
                        FindQuickcheckIrFn(fn, ir_package));
 
-  XLS_ASSIGN_OR_RETURN(
-      QuickCheckResults qc_results,
-      DoQuickCheck(qc_fn.ir_function, qc_fn.ir_name, run_comparator, seed,
-                   quickcheck->test_cases()));
+  QuickCheckResults qc_results;
+  if (thread_pool != nullptr) {
+    XLS_ASSIGN_OR_RETURN(
+        qc_results,
+        DoQuickCheckConcurrently(qc_fn.ir_function, seed,
+                                 quickcheck->test_cases(), *thread_pool,
+                                 batch_size));
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        qc_results,
+        DoQuickCheck(qc_fn.ir_function, qc_fn.ir_name, run_comparator, seed,
+                     quickcheck->test_cases()));
+  }
   const auto& [arg_sets, results] = qc_results;
   XLS_ASSIGN_OR_RETURN(Bits last_result, results.back().GetBitsWithStatus());
   if (!last_result.IsZero()) {
@@ -428,10 +529,14 @@ static absl::Status RunQuickCheck(AbstractRunComparator* run_comparator,
       *fn->owner()->file_table());
 }
 
+// Quickchecks are numbered for sharding after the module's `test_count` unit
+// tests.
 static absl::Status RunQuickChecksIfJitEnabled(
-    const RE2* test_filter, Module* entry_module, TypeInfo* type_info,
+    const RE2* test_filter, const TestShard& shard, int64_t test_count,
+    Module* entry_module, TypeInfo* type_info,
     AbstractRunComparator* run_comparator, Package* ir_package,
-    std::optional<int64_t> seed, TestResultData& result,
+    std::optional<int64_t> seed, int64_t quickcheck_threads,
+    int64_t quickcheck_batch_size, TestResultData& result,
     VirtualizableFilesystem& vfs) {
   if (run_comparator == nullptr) {
     // TODO(leary): 2024-02-08 Note that this skips /all/ the quickchecks so we
@@ -445,9 +550,17 @@ static absl::Status RunQuickChecksIfJitEnabled(
     // for rationale.
     seed = static_cast<int64_t>(getpid()) * static_cast<int64_t>(time(nullptr));
   }
+  std::optional<ThreadPool> thread_pool;
+  if (quickcheck_threads != 1) {
+    thread_pool.emplace(quickcheck_threads);
+  }
   FileTable& file_table = *entry_module->file_table();
   bool any_quicktest_run = false;
+  int64_t quickcheck_index = test_count;
   for (QuickCheck* quickcheck : entry_module->GetQuickChecks()) {
+    if (!shard.Contains(quickcheck_index++)) {
+      continue;
+    }
     const std::string& quickcheck_name = quickcheck->identifier();
     const Pos& start_pos = quickcheck->span().start();
     const absl::Time test_case_start = absl::Now();
@@ -472,8 +585,9 @@ static absl::Status RunQuickChecksIfJitEnabled(
     }
     std::cerr << "[ RUN QUICKCHECK        ] " << quickcheck_name
               << " cases: " << quickcheck->test_cases().ToString() << "\n";
-    const absl::Status status =
-        RunQuickCheck(run_comparator, ir_package, quickcheck, type_info, *seed);
+    const absl::Status status = RunQuickCheck(
+        run_comparator, thread_pool.has_value() ? &*thread_pool : nullptr,
+        quickcheck_batch_size, ir_package, quickcheck, type_info, *seed);
     const absl::Duration duration = absl::Now() - test_case_start;
     if (!status.ok()) {
       HandleError(result, status, quickcheck_name, start_pos, test_case_start,
@@ -498,6 +612,55 @@ static absl::Status RunQuickChecksIfJitEnabled(
   return absl::OkStatus();
 }
 
+// Proves the quickcheck `ir_function` one input partition at a time, reporting
+// the outcome of each partition. The result is a counterexample from the first
+// failing partition if any, an error if any partition timed out, and otherwise
+// ProvenTrue.
+static absl::StatusOr<solvers::z3::ProverResult> ProvePartitioned(
+    xls::Function* ir_function, std::string_view quickcheck_name,
+    const ParseAndProveOptions& options) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<solvers::z3::PartitionProverResult> partitions,
+      solvers::z3::TryProvePartitioned(
+          ir_function, ir_function->return_value(),
+          solvers::z3::Predicate::NotEqualToZero(),
+          options.partition_bit_count, options.partition_thread_count,
+          options.partition_timeout));
+  std::optional<solvers::z3::ProverResult> failure;
+  int64_t timed_out_count = 0;
+  for (solvers::z3::PartitionProverResult& partition : partitions) {
+    std::string_view outcome;
+    if (!partition.result.ok()) {
+      if (!absl::IsDeadlineExceeded(partition.result.status())) {
+        return partition.result.status();
+      }
+      outcome = "TIMED OUT";
+      ++timed_out_count;
+    } else if (std::holds_alternative<solvers::z3::ProvenTrue>(
+                   *partition.result)) {
+      outcome = "PROVEN";
+    } else {
+      outcome = "FAILED";
+      if (!failure.has_value()) {
+        failure = *std::move(partition.result);
+      }
+    }
+    std::cerr << absl::StreamFormat("[ PARTITION %d/%d ] %s: %s (%s)\n",
+                                    partition.partition, partitions.size(),
+                                    quickcheck_name, outcome,
+                                    absl::FormatDuration(partition.duration));
+  }
+  if (failure.has_value()) {
+    return *std::move(failure);
+  }
+  if (timed_out_count > 0) {
+    return absl::DeadlineExceededError(
+        absl::StrFormat("%d of %d partitions of quickcheck `%s` timed out",
+                        timed_out_count, partitions.size(), quickcheck_name));
+  }
+  return solvers::z3::ProvenTrue();
+}
+
 absl::StatusOr<ParseAndProveResult> ParseAndProve(
     std::string_view program, std::string_view module_name,
     std::string_view filename, const ParseAndProveOptions& options) {
@@ -615,14 +778,18 @@ absl::StatusOr<ParseAndProveResult> ParseAndProve(
 
     VLOG(1) << "Found IR function: " << (*ir_function)->name();
 
-    absl::StatusOr<solvers::z3::ProverResult> proven = solvers::z3::TryProve(
-        *ir_function, (*ir_function)->return_value(),
-        solvers::z3::Predicate::NotEqualToZero(), absl::InfiniteDuration());
+    absl::StatusOr<solvers::z3::ProverResult> proven =
+        options.partition_bit_count > 0
+            ? ProvePartitioned(*ir_function, quickcheck_name, options)
+            : solvers::z3::TryProve(*ir_function,
+                                    (*ir_function)->return_value(),
+                                    solvers::z3::Predicate::NotEqualToZero(),
+                                    absl::InfiniteDuration());
 
     if (!proven.ok()) {
-      HandleError(result, status, quickcheck_name, start_pos, test_case_start,
-                  absl::Now() - start, /*is_quickcheck=*/true, file_table,
-                  import_data.vfs());
+      HandleError(result, proven.status(), quickcheck_name, start_pos,
+                  test_case_start, absl::Now() - start, /*is_quickcheck=*/true,
+                  file_table, import_data.vfs());
       continue;
     }
 
@@ -732,15 +899,30 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
 
   Module* entry_module = tm->module;
 
+  // Quickchecks are run with the given comparator or, failing that, with the
+  // one the test runner provides for them (if any).
+  std::unique_ptr<AbstractRunComparator> quickcheck_comparator;
+  AbstractRunComparator* run_comparator = options.run_comparator;
+  if (run_comparator == nullptr) {
+    quickcheck_comparator = CreateQuickCheckComparator();
+    run_comparator = quickcheck_comparator.get();
+  }
+
   // If JIT comparisons are "on", we register a post-evaluation hook to compare
   // with the interpreter.
   std::unique_ptr<Package> ir_package;
   PostFnEvalHook post_fn_eval_hook;
-  if (options.run_comparator != nullptr) {
+  if (run_comparator != nullptr) {
     absl::StatusOr<dslx::PackageConversionData> ir_package_conversion_data =
         ConvertModuleToPackage(entry_module, &import_data,
                                options.convert_options);
-    if (!ir_package_conversion_data.ok()) {
+    if (!ir_package_conversion_data.ok() && options.run_comparator == nullptr) {
+      // The IR is only needed for quickchecks, which are then skipped; the
+      // tests themselves can still run.
+      LOG(WARNING) << "Unable to convert module to IR for quickchecks: "
+                   << ir_package_conversion_data.status();
+      run_comparator = nullptr;
+    } else if (!ir_package_conversion_data.ok()) {
       if (TryPrintError(ir_package_conversion_data.status(),
                         import_data.file_table(), import_data.vfs())) {
         result.Finish(TestResult::kSomeFailed, absl::Now() - start);
@@ -749,8 +931,11 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
       return xabsl::StatusBuilder(ir_package_conversion_data.status())
              << "Failed to convert input to IR for comparison. Consider "
                 "turning off comparison with `--compare=none`: ";
+    } else {
+      ir_package = (*std::move(ir_package_conversion_data)).package;
     }
-    ir_package = (*std::move(ir_package_conversion_data)).package;
+  }
+  if (options.run_comparator != nullptr) {
     post_fn_eval_hook = [&ir_package, &import_data, &options](
                             const Function* f,
                             absl::Span<const InterpValue> args,
@@ -771,8 +956,85 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<AbstractParsedTestRunner> runner,
       CreateTestRunner(&import_data, tm->type_info, entry_module));
+
+  // The comparator is not thread-safe, so concurrently run tests take turns
+  // comparing their results.
+  std::optional<ThreadPool> test_pool;
+  if (options.test_jobs != 1 && runner->SupportsConcurrentTests()) {
+    test_pool.emplace(options.test_jobs);
+  }
+  absl::Mutex comparison_mutex;
+  if (test_pool.has_value() && post_fn_eval_hook != nullptr) {
+    post_fn_eval_hook = [&comparison_mutex,
+                         hook = std::move(post_fn_eval_hook)](
+                            const Function* f,
+                            absl::Span<const InterpValue> args,
+                            const ParametricEnv* parametric_env,
+                            const InterpValue& got) -> absl::Status {
+      absl::MutexLock lock(&comparison_mutex);
+      return hook(f, args, parametric_env, got);
+    };
+  }
+  BytecodeInterpreterOptions interpreter_options;
+  interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
+      .trace_hook(absl::bind_front(InfoLoggingTraceHook, file_table))
+      .trace_channels(options.trace_channels)
+      .max_ticks(options.max_ticks)
+      .format_preference(options.format_preference);
+  // Comparisons the comparator deferred are made once the test finishes and
+  // a mismatch fails the test. With concurrently run tests the deferred
+  // comparisons may also include those of tests still running.
+  auto run_test = [&](const std::string& test_name,
+                      ModuleMember* member) -> absl::StatusOr<RunResult> {
+    absl::StatusOr<RunResult> out;
+    if (std::holds_alternative<TestFunction*>(*member)) {
+      out = runner->RunTestFunction(test_name, interpreter_options);
+    } else {
+      out = runner->RunTestProc(test_name, interpreter_options);
+    }
+    if (out.ok() && options.run_comparator != nullptr) {
+      absl::MutexLock lock(&comparison_mutex);
+      absl::Status compared = options.run_comparator->FlushComparisons();
+      if (out->result.ok()) {
+        out->result = std::move(compared);
+      }
+    }
+    return out;
+  };
+
+  // When tests run concurrently, they are all run up front and then reported
+  // in module order, as if they had run one after the other.
+  struct ConcurrentRun {
+    absl::StatusOr<RunResult> out;
+    absl::Time start;
+    absl::Time end;
+  };
+  const std::vector<std::string> test_names = entry_module->GetTestNames();
+  std::vector<std::optional<ConcurrentRun>> concurrent_runs(test_names.size());
+  if (test_pool.has_value()) {
+    for (int64_t i = 0; i < test_names.size(); ++i) {
+      if (!options.shard.Contains(i) ||
+          !TestMatchesFilter(test_names[i], options.test_filter)) {
+        continue;
+      }
+      ModuleMember* member =
+          entry_module->FindMemberWithName(test_names[i]).value();
+      test_pool->Schedule([&, i, member] {
+        const absl::Time start = absl::Now();
+        absl::StatusOr<RunResult> out = run_test(test_names[i], member);
+        concurrent_runs[i] = ConcurrentRun{
+            .out = std::move(out), .start = start, .end = absl::Now()};
+      });
+    }
+    test_pool->WaitForIdle();
+  }
+
   // Run unit tests.
-  for (const std::string& test_name : entry_module->GetTestNames()) {
+  for (int64_t i = 0; i < test_names.size(); ++i) {
+    const std::string& test_name = test_names[i];
+    if (!options.shard.Contains(i)) {
+      continue;
+    }
     auto test_case_start = absl::Now();
     ModuleMember* member = entry_module->FindMemberWithName(test_name).value();
     const Pos start_pos = GetPos(*member);
@@ -792,20 +1054,16 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
 
     std::cerr << "[ RUN UNITTEST  ] " << test_name << '\n';
     RunResult out;
-    BytecodeInterpreterOptions interpreter_options;
-    interpreter_options.post_fn_eval_hook(post_fn_eval_hook)
-        .trace_hook(absl::bind_front(InfoLoggingTraceHook, file_table))
-        .trace_channels(options.trace_channels)
-        .max_ticks(options.max_ticks)
-        .format_preference(options.format_preference);
-    if (std::holds_alternative<TestFunction*>(*member)) {
-      XLS_ASSIGN_OR_RETURN(
-          out, runner->RunTestFunction(test_name, interpreter_options));
+    absl::Time test_case_end;
+    if (test_pool.has_value()) {
+      XLS_RET_CHECK(concurrent_runs[i].has_value());
+      XLS_ASSIGN_OR_RETURN(out, std::move(concurrent_runs[i]->out));
+      test_case_start = concurrent_runs[i]->start;
+      test_case_end = concurrent_runs[i]->end;
     } else {
-      XLS_ASSIGN_OR_RETURN(out,
-                           runner->RunTestProc(test_name, interpreter_options));
+      XLS_ASSIGN_OR_RETURN(out, run_test(test_name, member));
+      test_case_end = absl::Now();
     }
-    auto test_case_end = absl::Now();
 
     if (out.result.ok()) {
       // Add to the tracking data.
@@ -834,8 +1092,9 @@ absl::StatusOr<TestResultData> AbstractTestRunner::ParseAndTest(
   // Run quickchecks, but only if the JIT is enabled.
   if (!entry_module->GetQuickChecks().empty()) {
     XLS_RETURN_IF_ERROR(RunQuickChecksIfJitEnabled(
-        options.test_filter, entry_module, tm->type_info,
-        options.run_comparator, ir_package.get(), options.seed, result,
+        options.test_filter, options.shard, test_names.size(), entry_module,
+        tm->type_info, run_comparator, ir_package.get(), options.seed,
+        options.quickcheck_threads, options.quickcheck_batch_size, result,
         import_data.vfs()));
   }
 
@@ -33,6 +33,7 @@
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/bytecode/bytecode_interpreter_options.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/module.h"
@@ -69,6 +70,10 @@ class AbstractRunComparator {
                                      const ParametricEnv* parametric_env,
                                      const InterpValue& got) = 0;
 
+  // Performs any comparisons which RunComparison deferred (e.g. to batch them
+  // up), returning an error if any of them mismatched.
+  virtual absl::Status FlushComparisons() { return absl::OkStatus(); }
+
   // Helper for abstracting over the running of IR functions. i.e. we implement
   // this in subclasses to either execute JIT'd computations or interpreted
   // ones.
@@ -95,6 +100,22 @@ class AbstractRunComparator {
 //   warnings_as_errors: Whether warnings should be reported as errors (i.e.
 //    cause the run routine to report failure when a warning is encountered).
 //   warnings: Set of warnings to enable for reporting.
+//   quickcheck_threads: Number of threads quickcheck samples are JIT-evaluated
+//    on, in batches of `quickcheck_batch_size`; values <= 0 use all CPUs. With
+//    a single thread samples are evaluated one at a time by the run
+//    comparator.
+// Identifies the subset of a module's tests run by one shard of a sharded test
+// (see https://bazel.build/reference/test-encyclopedia#test-sharding). Tests
+// and quickchecks are numbered in module order and dealt out round-robin.
+struct TestShard {
+  int64_t index = 0;
+  int64_t count = 1;
+
+  bool Contains(int64_t test_index) const {
+    return test_index % count == index;
+  }
+};
+
 struct ParseAndTestOptions {
   std::filesystem::path dslx_stdlib_path;
   absl::Span<const std::filesystem::path> dslx_paths;
@@ -110,6 +131,13 @@ struct ParseAndTestOptions {
   std::optional<int64_t> max_ticks;
   std::function<std::unique_ptr<VirtualizableFilesystem>()> vfs_factory =
       nullptr;
+  int64_t quickcheck_threads = 1;
+  int64_t quickcheck_batch_size = 1024;
+  // Number of unit tests to run concurrently, each with its own interpreter,
+  // when the test runner supports it. Results are reported in module order
+  // regardless.
+  int64_t test_jobs = 1;
+  TestShard shard;
 };
 
 // As above, but a subset of the options required for the ParseAndProve()
@@ -122,6 +150,13 @@ struct ParseAndProveOptions {
   WarningKindSet warnings = kDefaultWarningsSet;
   std::function<std::unique_ptr<VirtualizableFilesystem>()> vfs_factory =
       nullptr;
+  // If positive, each quickcheck is proven as 2^partition_bit_count separate
+  // queries over the values of its most significant input bits (see
+  // TryProvePartitioned), solved on `partition_thread_count` threads (one per
+  // CPU if zero) with `partition_timeout` each.
+  int64_t partition_bit_count = 0;
+  int64_t partition_thread_count = 0;
+  absl::Duration partition_timeout = absl::InfiniteDuration();
 };
 
 enum class TestResult : uint8_t {
@@ -225,6 +260,13 @@ class AbstractTestRunner {
   virtual absl::StatusOr<std::unique_ptr<AbstractParsedTestRunner>>
   CreateTestRunner(ImportData* import_data, TypeInfo* type_info,
                    Module* module) const = 0;
+
+  // Returns the comparator quickchecks are run with when the options don't
+  // give one, or nullptr if quickchecks should then be skipped.
+  virtual std::unique_ptr<AbstractRunComparator> CreateQuickCheckComparator()
+      const {
+    return nullptr;
+  }
 };
 
 struct RunResult {
@@ -238,6 +280,9 @@ class AbstractParsedTestRunner {
       std::string_view name, const BytecodeInterpreterOptions& options) = 0;
   virtual absl::StatusOr<RunResult> RunTestFunction(
       std::string_view name, const BytecodeInterpreterOptions& options) = 0;
+
+  // Returns whether several tests may be run at once from different threads.
+  virtual bool SupportsConcurrentTests() const { return false; }
 };
 
 class DslxInterpreterTestRunner final : public AbstractTestRunner {
@@ -262,6 +307,10 @@ class DslxInterpreterParsedTestRunner : public AbstractParsedTestRunner {
       std::string_view name,
       const BytecodeInterpreterOptions& options) override;
 
+  // Each test gets its own interpreter; the typechecked modules and the
+  // (thread-safe) bytecode cache in `import_data_` are only read.
+  bool SupportsConcurrentTests() const override { return true; }
+
  private:
   ImportData* import_data_;
   TypeInfo* type_info_;
@@ -297,6 +346,14 @@ absl::StatusOr<QuickCheckResults> DoQuickCheck(
     AbstractRunComparator* run_comparator, int64_t seed,
     QuickCheckTestCases test_cases);
 
+// As above, but evaluates the samples `batch_size` at a time with the batched
+// JIT entry point, running batches concurrently on `thread_pool` (with one JIT
+// compilation of `xls_function` per concurrently running batch). The samples,
+// and hence the results, are the same as DoQuickCheck's for the same seed.
+absl::StatusOr<QuickCheckResults> DoQuickCheckConcurrently(
+    xls::Function* xls_function, int64_t seed, QuickCheckTestCases test_cases,
+    ThreadPool& thread_pool, int64_t batch_size);
+
 }  // namespace xls::dslx
 
 #endif  // XLS_DSLX_RUN_ROUTINES_RUN_ROUTINES_H_
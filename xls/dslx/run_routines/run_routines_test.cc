@@ -28,8 +28,10 @@
 #include "absl/strings/str_format.h"
 #include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/run_routines/ir_test_runner.h"
 #include "xls/dslx/run_routines/run_comparator.h"
+#include "xls/dslx/run_routines/test_xml.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
@@ -144,6 +146,68 @@ fn test_simple() { unit() }
   EXPECT_EQ(jit_comparator.jit_cache_.begin()->first, "__test__unit");
 }
 
+TEST_P(RunRoutinesTest, SampledComparisonsAreBatched) {
+  constexpr const char* kProgram = R"(
+fn twice(x: u32) -> u32 { x + x }
+
+#[test]
+fn test_twice() {
+  assert_eq(twice(u32:1), u32:2);
+  assert_eq(twice(u32:2), u32:4);
+  assert_eq(twice(u32:3), u32:6);
+  assert_eq(twice(u32:4), u32:8);
+  assert_eq(twice(u32:5), u32:10);
+}
+)";
+  if (GetParam() != RunnerType::kDslxInterpreter) {
+    GTEST_SKIP()
+        << "comparator only supported on dslx interpreter for non-quickchecks";
+  }
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  RunComparator jit_comparator(
+      CompareMode::kJit,
+      RunComparatorOptions{.sample_rate = 0.5, .batch_size = 2});
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 1, 0, 0));
+
+  // Invocations 0, 2 and 4 are sampled; the first two fill a batch and the
+  // last is compared when the test finishes.
+  ASSERT_TRUE(jit_comparator.comparisons_.contains("__test__twice"));
+  const auto& comparisons = jit_comparator.comparisons_.at("__test__twice");
+  EXPECT_EQ(comparisons.invocation_count, 5);
+  EXPECT_TRUE(comparisons.pending.empty());
+  EXPECT_TRUE(jit_comparator.jit_cache_.contains("__test__twice"));
+}
+
+TEST_P(RunRoutinesTest, ZeroSampleRateComparesNothing) {
+  constexpr const char* kProgram = R"(
+fn unit() -> () { () }
+
+#[test]
+fn test_simple() { unit() }
+)";
+  if (GetParam() != RunnerType::kDslxInterpreter) {
+    GTEST_SKIP()
+        << "comparator only supported on dslx interpreter for non-quickchecks";
+  }
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  RunComparator jit_comparator(CompareMode::kJit,
+                               RunComparatorOptions{.sample_rate = 0.0});
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 1, 0, 0));
+  EXPECT_TRUE(jit_comparator.jit_cache_.empty());
+}
+
 TEST_P(RunRoutinesTest, QuickcheckInvokedFunctionDoesJit) {
   constexpr const char* kProgram = R"(
 fn id(x: bool) -> bool { x }
@@ -292,6 +356,153 @@ fn trivial(x: u5) -> bool { false }
   EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 1, 0, 1));
 }
 
+// Only the IR JIT runner runs quickchecks without a comparator.
+TEST_P(RunRoutinesTest, QuickCheckWithoutComparator) {
+  constexpr std::string_view kProgram = R"(
+#[quickcheck(exhaustive)]
+fn trivial(x: u11) -> bool { x != u11::MAX }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  ParseAndTestOptions options;
+  options.vfs_factory = [kProgram] {
+    return std::make_unique<UniformContentFilesystem>(kProgram, "test.x");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  if (GetParam() == RunnerType::kIrJit) {
+    EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 1, 0, 1));
+  } else {
+    EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 0, 0, 0));
+  }
+}
+
+TEST_P(RunRoutinesTest, ConcurrentQuickCheck) {
+  constexpr std::string_view kProgram = R"(
+#[quickcheck(exhaustive)]
+fn trivial(x: u5, y: u6) -> bool { !(x == u5::MAX && y == u6::MAX) }
+
+#[quickcheck(test_count=5000)]
+fn passes(x: u32) -> bool { x == x }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  RunComparator jit_comparator(CompareMode::kJit);
+  ParseAndTestOptions options;
+  options.run_comparator = &jit_comparator;
+  options.quickcheck_threads = 4;
+  options.quickcheck_batch_size = 64;
+  options.vfs_factory = [kProgram] {
+    return std::make_unique<UniformContentFilesystem>(kProgram, "test.x");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 2, 0, 1));
+}
+
+TEST_P(RunRoutinesTest, ConcurrentTestsReportInModuleOrder) {
+  constexpr std::string_view kProgram = R"(
+fn square(x: u32) -> u32 { x * x }
+
+#[test]
+fn first() { assert_eq(square(u32:3), u32:9) }
+
+#[test]
+fn second() { assert_eq(square(u32:4), u32:15) }
+
+#[test]
+fn third() { assert_eq(square(u32:5), u32:25) }
+
+#[test]
+fn fourth() { assert_eq(square(u32:6), u32:36) }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  ParseAndTestOptions options;
+  options.test_jobs = 4;
+  options.vfs_factory = [kProgram] {
+    return std::make_unique<UniformContentFilesystem>(kProgram, "test.x");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 4, 0, 1));
+  test_xml::TestSuites suites = result.ToXmlSuites(kModuleName);
+  ASSERT_EQ(suites.test_suites.size(), 1);
+  std::vector<std::string> names;
+  for (const test_xml::TestCase& test_case :
+       suites.test_suites[0].test_cases) {
+    names.push_back(test_case.name);
+  }
+  EXPECT_THAT(names,
+              testing::ElementsAre("first", "second", "third", "fourth"));
+}
+
+TEST_P(RunRoutinesTest, ConcurrentFunctionAndProcTests) {
+  constexpr std::string_view kProgram = R"(
+fn square(x: u32) -> u32 { x * x }
+
+#[test]
+fn passes() { assert_eq(square(u32:3), u32:9) }
+
+#[test]
+fn fails() { assert_eq(square(u32:4), u32:15) }
+
+#[test_proc]
+proc finisher {
+    terminator: chan<bool> out;
+
+    config(terminator: chan<bool> out) {
+        (terminator,)
+    }
+
+    init { () }
+
+    next(state: ()) {
+      send(join(), terminator, true);
+    }
+}
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  ParseAndTestOptions options;
+  options.test_jobs = 3;
+  options.vfs_factory = [kProgram] {
+    return std::make_unique<UniformContentFilesystem>(kProgram, "test.x");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  EXPECT_THAT(result, IsTestResult(TestResult::kSomeFailed, 3, 0, 1));
+}
+
+TEST_P(RunRoutinesTest, ShardRunsEveryOtherTest) {
+  constexpr std::string_view kProgram = R"(
+#[test]
+fn first() { assert_eq(u32:1, u32:1) }
+
+#[test]
+fn second() { assert_eq(u32:1, u32:2) }
+
+#[test]
+fn third() { assert_eq(u32:1, u32:1) }
+)";
+  constexpr const char* kModuleName = "test";
+  constexpr const char* kFilename = "test.x";
+  ParseAndTestOptions options;
+  options.shard = TestShard{.index = 0, .count = 2};
+  options.vfs_factory = [kProgram] {
+    return std::make_unique<UniformContentFilesystem>(kProgram, "test.x");
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      TestResultData result,
+      ParseAndTest(kProgram, kModuleName, kFilename, options));
+  // Only `first` and `third` are in the shard; `second` would fail.
+  EXPECT_THAT(result, IsTestResult(TestResult::kAllPassed, 2, 0, 0));
+}
+
 TEST_P(RunRoutinesTest, TwoNonParametricProcs) {
   constexpr std::string_view kProgram = R"(
 proc FirstProc {
@@ -482,6 +693,54 @@ TEST(QuickcheckTest, Seeding) {
   EXPECT_EQ(results1, results2);
 }
 
+// Concurrent quickchecks see the same samples, and so the same first falsifying
+// example, as serial ones.
+TEST(QuickcheckTest, ConcurrentMatchesSerial) {
+  Package package("sometimes_false");
+  std::string ir_text = R"(
+  fn gt_one(x: bits[8]) -> bits[1] {
+    literal.2: bits[8] = literal(value=1)
+    ret ugt.3: bits[1] = ugt(x, literal.2)
+  }
+  )";
+  int64_t seed = 12345;
+  QuickCheckTestCases test_cases = QuickCheckTestCases::Counted(1000);
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  RunComparator jit_comparator(CompareMode::kJit);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults serial,
+      DoQuickCheck(function, kFakeIrName, &jit_comparator, seed, test_cases));
+  ThreadPool thread_pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults concurrent,
+      DoQuickCheckConcurrently(function, seed, test_cases, thread_pool,
+                               /*batch_size=*/3));
+
+  EXPECT_EQ(concurrent.arg_sets, serial.arg_sets);
+  EXPECT_EQ(concurrent.results, serial.results);
+  EXPECT_EQ(concurrent.results.back(), Value(UBits(0, 1)));
+}
+
+TEST(QuickcheckTest, ConcurrentNumTests) {
+  Package package("always_true");
+  std::string ir_text = R"(
+  fn ret_true(x: bits[32]) -> bits[1] {
+    ret eq_value: bits[1] = eq(x, x)
+  }
+  )";
+  QuickCheckTestCases test_cases = QuickCheckTestCases::Counted(5050);
+  XLS_ASSERT_OK_AND_ASSIGN(xls::Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+  ThreadPool thread_pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      QuickCheckResults quickcheck_info,
+      DoQuickCheckConcurrently(function, /*seed=*/0, test_cases, thread_pool,
+                               /*batch_size=*/64));
+  EXPECT_EQ(quickcheck_info.arg_sets.size(), 5050);
+  EXPECT_EQ(quickcheck_info.results.size(), 5050);
+}
+
 TEST_P(ParseAndTestTest, DeadlockedProc) {
   // Test proc never sends to the subproc, so network is deadlocked.
   constexpr std::string_view kProgram = R"(
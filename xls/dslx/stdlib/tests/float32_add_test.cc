@@ -14,15 +14,24 @@
 
 // Random-sampling test for the DSLX 2x32 floating-point adder.
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <tuple>
+#include <vector>
 
+#include "absl/base/casts.h"
 #include "absl/flags/flag.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/init_xls.h"
 #include "xls/dslx/stdlib/float32_add_jit_wrapper.h"
 #include "xls/dslx/stdlib/tests/float32_test_utils.h"
+#include "xls/ir/events.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 #include "xls/tests/testbench.h"
 #include "xls/tests/testbench_builder.h"
 
@@ -30,35 +39,139 @@ ABSL_FLAG(int, num_threads, 0,
           "Number of threads to use. Set to 0 to use all.");
 ABSL_FLAG(int64_t, num_samples, 1024 * 1024,
           "Number of random samples to test.");
+ABSL_FLAG(int64_t, batch_size, 256,
+          "Number of samples each thread evaluates per JIT invocation. Set to "
+          "1 to invoke the JIT once per sample.");
 
 namespace xls {
 
 using Float2x32 = std::tuple<float, float>;
 
+// Per-thread state: the JIT and the native-layout buffers used to evaluate a
+// batch of samples with a single call into the jitted code.
+struct Float32AddShard {
+  std::unique_ptr<fp::Float32Add> jit_wrapper;
+  // Native layout of an F32 tuple: (sign: u1, bexp: u8, fraction: u23).
+  TypeLayout layout;
+  int64_t arg_stride[2];
+  int64_t arg_alignment[2];
+  int64_t result_stride;
+  int64_t result_alignment;
+  std::vector<uint8_t> args[2];
+  std::vector<uint8_t> result;
+};
+
+// Returns a pointer into `storage`, aligned to `alignment`, with room for at
+// least `size` bytes.
+static uint8_t* AlignedBuffer(FunctionJit* jit, std::vector<uint8_t>& storage,
+                              int64_t size, int64_t alignment) {
+  size_t padded_size = jit->runtime()->ShouldAllocateForAlignment(size,
+                                                                  alignment);
+  if (storage.size() < padded_size) {
+    storage.resize(padded_size);
+  }
+  return jit->runtime()->AsAligned(absl::MakeSpan(storage), alignment).data();
+}
+
+// Writes the low bytes of `value` into leaf `leaf` of the F32 at `buffer`.
+static void WriteLeaf(const TypeLayout& layout, int64_t leaf, uint32_t value,
+                      uint8_t* buffer) {
+  const ElementLayout& element = layout.elements()[leaf];
+  memcpy(buffer + element.offset, &value, element.data_size);
+}
+
+static uint32_t ReadLeaf(const TypeLayout& layout, int64_t leaf,
+                         const uint8_t* buffer) {
+  const ElementLayout& element = layout.elements()[leaf];
+  uint32_t value = 0;
+  memcpy(&value, buffer + element.offset, element.data_size);
+  return value;
+}
+
+static void WriteFloat(const TypeLayout& layout, float f, uint8_t* buffer) {
+  uint32_t bits = absl::bit_cast<uint32_t>(f);
+  WriteLeaf(layout, 0, bits >> 31, buffer);
+  WriteLeaf(layout, 1, (bits >> 23) & 0xff, buffer);
+  WriteLeaf(layout, 2, bits & 0x7fffff, buffer);
+}
+
+static float ReadFloat(const TypeLayout& layout, const uint8_t* buffer) {
+  uint32_t sign = ReadLeaf(layout, 0, buffer) & 0x1;
+  uint32_t bexp = ReadLeaf(layout, 1, buffer) & 0xff;
+  uint32_t fraction = ReadLeaf(layout, 2, buffer) & 0x7fffff;
+  return absl::bit_cast<float>((sign << 31) | (bexp << 23) | fraction);
+}
+
 // The DSLX implementation uses the "round to nearest (half to even)"
 // rounding mode, which is the default on most systems, hence we don't need
 // to call fesetround().
 // The DSLX implementation also flushes input subnormals to 0, so we do that
 // here as well.
-static float ComputeExpected(fp::Float32Add* jit_wrapper, Float2x32 input) {
+static float ComputeExpected(Float32AddShard* shard, Float2x32 input) {
   float x = FlushSubnormal(std::get<0>(input));
   float y = FlushSubnormal(std::get<1>(input));
   return x + y;
 }
 
 // Computes FP addition via DSLX & the JIT.
-static float ComputeActual(fp::Float32Add* jit_wrapper, Float2x32 input) {
-  return jit_wrapper->Run(std::get<0>(input), std::get<1>(input)).value();
+static float ComputeActual(Float32AddShard* shard, Float2x32 input) {
+  return shard->jit_wrapper->Run(std::get<0>(input), std::get<1>(input))
+      .value();
 }
 
-static std::unique_ptr<fp::Float32Add> CreateJit() {
-  return fp::Float32Add::Create().value();
+// Computes FP addition of a whole batch of inputs with one JIT invocation.
+static void ComputeActualBatch(Float32AddShard* shard,
+                               absl::Span<const Float2x32> inputs,
+                               absl::Span<float> results) {
+  FunctionJit* jit = shard->jit_wrapper->jit();
+  uint8_t* args[2];
+  for (int64_t i = 0; i < 2; ++i) {
+    args[i] = AlignedBuffer(jit, shard->args[i],
+                            inputs.size() * shard->arg_stride[i],
+                            shard->arg_alignment[i]);
+  }
+  uint8_t* result =
+      AlignedBuffer(jit, shard->result, inputs.size() * shard->result_stride,
+                    shard->result_alignment);
+  for (int64_t k = 0; k < inputs.size(); ++k) {
+    WriteFloat(shard->layout, std::get<0>(inputs[k]),
+               args[0] + k * shard->arg_stride[0]);
+    WriteFloat(shard->layout, std::get<1>(inputs[k]),
+               args[1] + k * shard->arg_stride[1]);
+  }
+  InterpreterEvents events;
+  CHECK_OK(jit->RunBatchedWithViews(args, result, inputs.size(), &events));
+  for (int64_t k = 0; k < inputs.size(); ++k) {
+    results[k] = ReadFloat(shard->layout, result + k * shard->result_stride);
+  }
+}
+
+static std::unique_ptr<Float32AddShard> CreateShard() {
+  std::unique_ptr<fp::Float32Add> jit_wrapper =
+      fp::Float32Add::Create().value();
+  FunctionJit* jit = jit_wrapper->jit();
+  // Both operands and the result are F32 tuples, so they share a layout.
+  TypeLayout layout = jit->runtime()->CreateTypeLayout(jit->GetParamTypes()[0]);
+  return std::unique_ptr<Float32AddShard>(new Float32AddShard{
+      .jit_wrapper = std::move(jit_wrapper),
+      .layout = std::move(layout),
+      .arg_stride = {jit->GetBatchedArgStride(0), jit->GetBatchedArgStride(1)},
+      .arg_alignment = {jit->GetBatchedArgAlignment(0),
+                        jit->GetBatchedArgAlignment(1)},
+      .result_stride = jit->GetBatchedReturnStride(),
+      .result_alignment = jit->GetBatchedReturnAlignment(),
+  });
 }
 
-static absl::Status RealMain(uint64_t num_samples, int num_threads) {
-  TestbenchBuilder<Float2x32, float, fp::Float32Add> builder(
-      ComputeExpected, ComputeActual, CreateJit);
+static absl::Status RealMain(uint64_t num_samples, int num_threads,
+                             int64_t batch_size) {
+  TestbenchBuilder<Float2x32, float, Float32AddShard> builder(
+      ComputeExpected, ComputeActual, CreateShard);
   builder.SetCompareResultsFn(CompareResults).SetNumSamples(num_samples);
+  if (batch_size > 1) {
+    builder.SetBatchSize(batch_size).SetComputeActualBatchFn(
+        ComputeActualBatch);
+  }
   if (num_threads != 0) {
     builder.SetNumThreads(num_threads);
   }
@@ -70,5 +183,6 @@ static absl::Status RealMain(uint64_t num_samples, int num_threads) {
 int main(int argc, char** argv) {
   xls::InitXls(argv[0], argc, argv);
   return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_num_samples),
-                                       absl::GetFlag(FLAGS_num_threads)));
+                                       absl::GetFlag(FLAGS_num_threads),
+                                       absl::GetFlag(FLAGS_batch_size)));
 }
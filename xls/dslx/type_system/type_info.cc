@@ -21,15 +21,16 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
-#include "absl/memory/memory.h"
 #include "absl/meta/type_traits.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -126,9 +127,12 @@ absl::Status InvocationData::ValidateEnvForCaller(
 // -- class TypeInfoOwner
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
-  // Note: private constructor so not using make_unique.
-  type_infos_.push_back(absl::WrapUnique(new TypeInfo(module, parent)));
-  TypeInfo* result = type_infos_.back().get();
+  absl::MutexLock lock(mutex_.get());
+  std::unique_ptr<ObjectArena>& arena = type_info_arenas_[module];
+  if (arena == nullptr) {
+    arena = std::make_unique<ObjectArena>();
+  }
+  TypeInfo* result = arena->New<TypeInfo>(module, parent);
   if (parent == nullptr) {
     // Check we only have a single nullptr-parent TypeInfo for a given module.
     XLS_RET_CHECK(!module_to_root_.contains(module))
@@ -146,6 +150,7 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::New(Module* module, TypeInfo* parent) {
 }
 
 absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
+  absl::MutexLock lock(mutex_.get());
   auto it = module_to_root_.find(module);
   if (it == module_to_root_.end()) {
     std::string available = absl::StrJoin(
@@ -160,6 +165,21 @@ absl::StatusOr<TypeInfo*> TypeInfoOwner::GetRootTypeInfo(const Module* module) {
   return it->second;
 }
 
+void TypeInfoOwner::EraseIf(absl::FunctionRef<bool(const Module*)> predicate) {
+  // Destroyed after the lock is released.
+  std::vector<std::unique_ptr<ObjectArena>> erased;
+  absl::MutexLock lock(mutex_.get());
+  absl::erase_if(module_to_root_,
+                 [&](const auto& item) { return predicate(item.first); });
+  absl::erase_if(type_info_arenas_, [&](auto& item) {
+    if (!predicate(item.first)) {
+      return false;
+    }
+    erased.push_back(std::move(item.second));
+    return true;
+  });
+}
+
 // -- class TypeInfo
 
 void TypeInfo::NoteConstExpr(const AstNode* const_expr, InterpValue value) {
@@ -356,6 +376,7 @@ std::string TypeInfo::GetTypeInfoTreeString() const {
   const TypeInfo* top = GetRoot();
   CHECK(top != nullptr);
   std::vector<std::string> pieces = {absl::StrFormat("root %p:", top)};
+  absl::MutexLock lock(&top->root_mutex_);
   for (const auto& [invocation, invocation_data] : top->invocations_) {
     CHECK(invocation != nullptr);
     CHECK_EQ(invocation, invocation_data.node());
@@ -417,6 +438,7 @@ absl::Status TypeInfo::AddInvocationTypeInfo(const Invocation& invocation,
           << invocation.span().ToString(file_table())
           << " caller_env: " << caller_env.ToString()
           << " callee_env: " << callee_env.ToString();
+  absl::MutexLock lock(&top->root_mutex_);
   auto it = top->invocations_.find(&invocation);
   if (it == top->invocations_.end()) {
     // No data for this invocation yet.
@@ -440,6 +462,7 @@ std::optional<bool> TypeInfo::GetRequiresImplicitToken(
   CHECK_EQ(f.owner(), module_) << "function owner: " << f.owner()->name()
                                << " module: " << module_->name();
   const TypeInfo* root = GetRoot();
+  absl::MutexLock lock(&root->root_mutex_);
   const absl::flat_hash_map<const Function*, bool>& map =
       root->requires_implicit_token_;
   auto it = map.find(&f);
@@ -458,14 +481,36 @@ void TypeInfo::NoteRequiresImplicitToken(const Function& f, bool is_required) {
   VLOG(6) << absl::StreamFormat("NoteRequiresImplicitToken %p: %s::%s => %s",
                                 root, f.owner()->name(), f.identifier(),
                                 is_required ? "true" : "false");
+  absl::MutexLock lock(&root->root_mutex_);
   root->requires_implicit_token_.emplace(&f, is_required);
 }
 
+void TypeInfo::NoteInstantiation(const Function& f, const ParametricEnv& env,
+                                 TypeInfo* derived_type_info) {
+  CHECK_EQ(f.owner(), module_);
+  TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->root_mutex_);
+  top->instantiations_.emplace(std::make_pair(&f, env), derived_type_info);
+}
+
+std::optional<TypeInfo*> TypeInfo::GetInstantiation(
+    const Function& f, const ParametricEnv& env) const {
+  CHECK_EQ(f.owner(), module_);
+  const TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->root_mutex_);
+  auto it = top->instantiations_.find(std::make_pair(&f, env));
+  if (it == top->instantiations_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
 std::optional<TypeInfo*> TypeInfo::GetInvocationTypeInfo(
     const Invocation* invocation, const ParametricEnv& caller) const {
   CHECK_EQ(invocation->owner(), module_)
       << invocation->owner()->name() << " vs " << module_->name();
   const TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->root_mutex_);
 
   // Find the data for this invocation node.
   auto it = top->invocations_.find(invocation);
@@ -532,6 +577,7 @@ std::optional<const ParametricEnv*> TypeInfo::GetInvocationCalleeBindings(
       "TypeInfo %p getting instantiation symbolic bindings: %p %s @ %s %s", top,
       invocation, invocation->ToString(),
       invocation->span().ToString(file_table()), caller.ToString());
+  absl::MutexLock lock(&top->root_mutex_);
   auto it = top->invocations().find(invocation);
   if (it == top->invocations().end()) {
     VLOG(3) << "Could not find instantiation " << invocation
@@ -557,6 +603,7 @@ void TypeInfo::AddSliceStartAndWidth(Slice* node,
                                      StartAndWidth start_width) {
   CHECK_EQ(node->owner(), module_);
   TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->root_mutex_);
   auto it = top->slices_.find(node);
   if (it == top->slices_.end()) {
     top->slices_[node] = SliceData{node, {{parametric_env, start_width}}};
@@ -570,6 +617,7 @@ std::optional<StartAndWidth> TypeInfo::GetSliceStartAndWidth(
     Slice* node, const ParametricEnv& parametric_env) const {
   CHECK_EQ(node->owner(), module_);
   const TypeInfo* top = GetRoot();
+  absl::MutexLock lock(&top->root_mutex_);
   auto it = top->slices_.find(node);
   if (it == top->slices_.end()) {
     return std::nullopt;
@@ -654,6 +702,7 @@ TypeInfo::~TypeInfo() {
   if (!IsRoot()) {
     CHECK(imports_.empty());
     CHECK(invocations_.empty());
+    CHECK(instantiations_.empty());
     CHECK(slices_.empty());
     CHECK(imports_.empty());
     CHECK(requires_implicit_token_.empty());
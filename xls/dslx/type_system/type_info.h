@@ -21,16 +21,21 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
+#include "xls/data_structures/object_arena.h"
 #include "xls/dslx/frontend/ast.h"
 #include "xls/dslx/frontend/pos.h"
 #include "xls/dslx/interp_value.h"
@@ -127,6 +132,7 @@ struct InvocationData {
 // the program at type checking time, we place all type info objects into this
 // owned pool (arena style ownership to avoid circular references or leaks or
 // any other sort of lifetime issues).
+// Thread-safe, so that independent modules may be typechecked concurrently.
 class TypeInfoOwner {
  public:
   // Returns an error status iff parent is nullptr and "module" already has a
@@ -137,15 +143,27 @@ class TypeInfoOwner {
   // status error if it is not present.
   absl::StatusOr<TypeInfo*> GetRootTypeInfo(const Module* module);
 
+  // Destroys the type information (root and derived) of every module for which
+  // `predicate` returns true. The modules themselves may already be destroyed;
+  // `predicate` is only handed their addresses.
+  void EraseIf(absl::FunctionRef<bool(const Module*)> predicate);
+
  private:
+  // Held by pointer to keep TypeInfoOwner movable.
+  std::unique_ptr<absl::Mutex> mutex_ = std::make_unique<absl::Mutex>();
+
   // Mapping from module to the "root" (or "parentmost") type info -- these have
   // nullptr as their parent. There should only be one of these for any given
   // module.
-  absl::flat_hash_map<const Module*, TypeInfo*> module_to_root_;
+  absl::flat_hash_map<const Module*, TypeInfo*> module_to_root_
+      ABSL_GUARDED_BY(*mutex_);
 
   // Owned type information objects -- TypeInfoOwner is the lifetime owner for
-  // these.
-  std::vector<std::unique_ptr<TypeInfo>> type_infos_;
+  // these. Each module's tree of type information lives in its own arena, as
+  // the tree is always destroyed as a whole; the arena destroys objects in
+  // reverse creation order, so parents outlive their children.
+  absl::flat_hash_map<const Module*, std::unique_ptr<ObjectArena>>
+      type_info_arenas_ ABSL_GUARDED_BY(*mutex_);
 };
 
 class TypeInfo {
@@ -199,6 +217,18 @@ class TypeInfo {
   absl::StatusOr<TypeInfo*> GetInvocationTypeInfoOrError(
       const Invocation* invocation, const ParametricEnv& caller) const;
 
+  // Notes that typechecking the body of the (non-proc) function `f` with the
+  // parametric env `env` produced `derived_type_info`. Later invocations that
+  // instantiate `f` with the same env share it instead of typechecking the
+  // body again.
+  void NoteInstantiation(const Function& f, const ParametricEnv& env,
+                         TypeInfo* derived_type_info);
+
+  // Returns the type information noted by `NoteInstantiation()` for `f` and
+  // `env`, if any.
+  std::optional<TypeInfo*> GetInstantiation(const Function& f,
+                                            const ParametricEnv& env) const;
+
   // Sets the type info for the given proc when typechecked at top-level (i.e.,
   // not via an instantiation). Can only be called on the module root TypeInfo.
   absl::Status SetTopLevelProcTypeInfo(const Proc* p, TypeInfo* ti);
@@ -346,6 +376,7 @@ class TypeInfo {
   FileTable& file_table();
 
  private:
+  friend class ::xls::ObjectArena;
   friend class TypeInfoOwner;
 
   const absl::flat_hash_map<const Invocation*, InvocationData>& invocations()
@@ -406,7 +437,17 @@ class TypeInfo {
   // The following are only present on the root type info.
   absl::flat_hash_map<std::variant<UseTreeEntry*, Import*>, ImportedInfo>
       imports_;
+
+  // Guards `invocations_`, `instantiations_`, `slices_` and
+  // `requires_implicit_token_` of a root type info in the accessors above:
+  // these keep being updated after the module is typechecked, as importers
+  // instantiate its parametrics, and importers may be typechecked concurrently.
+  // The maps returned by `GetRootInvocations()` must only be used once
+  // typechecking is complete.
+  mutable absl::Mutex root_mutex_;
   absl::flat_hash_map<const Invocation*, InvocationData> invocations_;
+  absl::flat_hash_map<std::pair<const Function*, ParametricEnv>, TypeInfo*>
+      instantiations_;
   absl::flat_hash_map<Slice*, SliceData> slices_;
   absl::flat_hash_map<const Function*, bool> requires_implicit_token_;
 
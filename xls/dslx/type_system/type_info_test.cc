@@ -14,6 +14,7 @@
 
 #include "xls/dslx/type_system/type_info.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
 
@@ -89,5 +90,49 @@ fn main() -> u32 {
                                  "present in parametric keys: {}")));
 }
 
+// Tests that invocations instantiating a parametric function with the same
+// parametric env share the derived type information of its body.
+TEST(TypeInfoTest, InvocationsWithSameEnvShareInstantiation) {
+  ImportData import_data = CreateImportDataForTest();
+  XLS_ASSERT_OK_AND_ASSIGN(TypecheckedModule tm,
+                           ParseAndTypecheck(R"(
+fn p<N: u32>(x: bits[N]) -> bits[N] {
+  x + x
+}
+
+fn main() -> u8 {
+  let a = p(u8:1);
+  let b = p(u8:2);
+  let c = p(u16:3);
+  a + b + (c as u8)
+})",
+                                             "test.x", "test", &import_data));
+
+  Function* main = tm.module->GetFunctionByName().at("main");
+  auto get_invocation = [&](int64_t index) {
+    const Let* let = down_cast<const Let*>(
+        ToAstNode(main->body()->statements().at(index)->wrapped()));
+    return down_cast<const Invocation*>(let->rhs());
+  };
+
+  std::optional<TypeInfo*> a_ti =
+      tm.type_info->GetInvocationTypeInfo(get_invocation(0), ParametricEnv());
+  std::optional<TypeInfo*> b_ti =
+      tm.type_info->GetInvocationTypeInfo(get_invocation(1), ParametricEnv());
+  std::optional<TypeInfo*> c_ti =
+      tm.type_info->GetInvocationTypeInfo(get_invocation(2), ParametricEnv());
+  ASSERT_TRUE(a_ti.has_value());
+  ASSERT_TRUE(b_ti.has_value());
+  ASSERT_TRUE(c_ti.has_value());
+  EXPECT_EQ(*a_ti, *b_ti);
+  EXPECT_NE(*a_ti, *c_ti);
+
+  Function* p = tm.module->GetFunctionByName().at("p");
+  EXPECT_EQ(tm.type_info->GetInstantiation(
+                *p, ParametricEnv(absl::flat_hash_map<std::string, InterpValue>{
+                        {"N", InterpValue::MakeU32(8)}})),
+            a_ti);
+}
+
 }  // namespace
 }  // namespace xls::dslx
@@ -30,6 +30,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/casts.h"
@@ -397,6 +398,9 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   // record data in the original module/ctx, so we hold on to the parent.
   DeduceCtx* parent_ctx = ctx;
   std::unique_ptr<DeduceCtx> imported_ctx_holder;
+  // Instantiating the callee adds to the imported module's type information,
+  // which other importers typechecked concurrently may also be doing.
+  std::optional<absl::MutexLock> instantiation_lock;
   if (auto import_key = IsExternRef(*invocation->callee(), *ctx->module());
       import_key.has_value()) {
     XLS_ASSIGN_OR_RETURN(
@@ -404,6 +408,8 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
         GetImportedDeduceCtx(ctx, invocation, caller_parametric_env,
                              import_key.value()));
     ctx = imported_ctx_holder.get();
+    instantiation_lock.emplace(
+        &ctx->import_data()->GetInstantiationMutex(ctx->module()));
   }
 
   XLS_ASSIGN_OR_RETURN(std::vector<std::unique_ptr<Type>> param_types,
@@ -446,9 +452,30 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
   parent_ctx->type_info()->SetItem(invocation->callee(), instantiated_ft);
   ctx->type_info()->SetItem(callee_fn->name_def(), instantiated_ft);
 
+  TypeInfo* const original_ti = parent_ctx->type_info();
+
+  // The type information for a function body depends only on the callee's
+  // parametric env, so a function already instantiated with this env (e.g.
+  // apfloat routines invoked with the same sizes all over a design) shares the
+  // type information of that instantiation instead of deducing the body
+  // again. Procs are excluded since each of their instantiations needs its own
+  // constexpr data for members.
+  const bool shares_instantiations =
+      !callee_fn->proc().has_value() && constexpr_env.empty();
+  if (shares_instantiations) {
+    if (std::optional<TypeInfo*> instantiated =
+            ctx->type_info()->GetInstantiation(*callee_fn,
+                                               callee_tab.parametric_env);
+        instantiated.has_value()) {
+      XLS_RETURN_IF_ERROR(original_ti->AddInvocationTypeInfo(
+          *invocation, caller, caller_parametric_env,
+          callee_tab.parametric_env, *instantiated));
+      return callee_tab;
+    }
+  }
+
   // We need to deduce fn body, so we're going to call Deduce, which means we'll
   // need a new stack entry w/the new symbolic bindings.
-  TypeInfo* const original_ti = parent_ctx->type_info();
   ctx->AddFnStackEntry(FnStackEntry::Make(
       *callee_fn, callee_tab.parametric_env, invocation,
       callee_fn->proc().has_value() ? WithinProc::kYes : WithinProc::kNo));
@@ -542,6 +569,10 @@ absl::StatusOr<TypeAndParametricEnv> TypecheckInvocation(
 
   XLS_RETURN_IF_ERROR(ctx->PopDerivedTypeInfo(derived_type_info));
   ctx->PopFnStackEntry();
+  if (shares_instantiations) {
+    ctx->type_info()->NoteInstantiation(*callee_fn, callee_tab.parametric_env,
+                                        derived_type_info);
+  }
 
   // Implementation note: though we could have all functions have
   // NoteRequiresImplicitToken() be false unless otherwise noted, this helps
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <memory>
@@ -29,9 +30,11 @@
 #include "absl/strings/str_split.h"
 #include "absl/types/span.h"
 #include "xls/common/exit_status.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dslx/command_line_utils.h"
 #include "xls/dslx/create_import_data.h"
 #include "xls/dslx/default_dslx_stdlib_path.h"
@@ -40,6 +43,7 @@
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/type_system/type_info.pb.h"
 #include "xls/dslx/type_system/type_info_to_proto.h"
+#include "xls/dslx/typecheck_cache.h"
 #include "xls/dslx/virtualizable_file_system.h"
 #include "xls/dslx/warning_kind.h"
 
@@ -51,6 +55,10 @@ ABSL_FLAG(std::string, dslx_stdlib_path,
 ABSL_FLAG(std::string, output_path, "",
           "Path to dump the type information to as a protobin -- if not "
           "provided textual proto is given on stdout.");
+ABSL_FLAG(int64_t, typecheck_threads, 1,
+          "Number of threads used to typecheck the imported modules; modules "
+          "whose imports are all typechecked are typechecked concurrently. 1 "
+          "typechecks serially and 0 uses all available CPUs.");
 ABSL_FLAG(bool, fatal_on_internal_error, false,
           "If true, internal errors will be fatal; this is useful for fuzzing "
           "without using a wrapper to check reported error invariants.");
@@ -74,8 +82,41 @@ absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
   XLS_ASSIGN_OR_RETURN(std::string input_contents,
                        import_data.vfs().GetFileContents(input_path));
   XLS_ASSIGN_OR_RETURN(std::string module_name, PathToName(input_path.c_str()));
-  absl::StatusOr<TypecheckedModule> tm = ParseAndTypecheck(
-      input_contents, input_path.c_str(), module_name, &import_data);
+
+  // With a cache, a module whose text and imports are unchanged since a
+  // previous run is not typechecked again. Only the binary output can be
+  // produced from the cached proto; the textual one needs the typechecked
+  // modules.
+  ContentAddressedDirectoryCache* cache =
+      ContentAddressedDirectoryCache::GetDefault(kTypecheckCacheOptions);
+  std::optional<std::string> cache_key;
+  if (cache != nullptr && output_path.has_value()) {
+    absl::StatusOr<std::optional<std::string>> key =
+        ComputeTypecheckCacheKey(input_contents, input_path.c_str(),
+                                 module_name, &import_data);
+    // Errors are reported by the typechecker below.
+    if (key.ok()) {
+      cache_key = *key;
+    }
+  }
+  if (cache_key.has_value()) {
+    if (std::optional<std::string> cached = cache->Lookup(*cache_key)) {
+      return SetFileContents(output_path->c_str(), *cached);
+    }
+  }
+
+  auto parse_and_typecheck = [&]() -> absl::StatusOr<TypecheckedModule> {
+    int64_t threads = absl::GetFlag(FLAGS_typecheck_threads);
+    if (threads == 1) {
+      return ParseAndTypecheck(input_contents, input_path.c_str(), module_name,
+                               &import_data);
+    }
+    ThreadPool thread_pool(threads);
+    return ParseAndTypecheckConcurrently(input_contents, input_path.c_str(),
+                                         module_name, &import_data,
+                                         thread_pool);
+  };
+  absl::StatusOr<TypecheckedModule> tm = parse_and_typecheck();
   if (!tm.ok()) {
     if (absl::GetFlag(FLAGS_fatal_on_internal_error) &&
         !GetPositionalErrorData(tm.status(), std::nullopt,
@@ -94,6 +135,12 @@ absl::Status RealMain(absl::Span<const std::filesystem::path> dslx_paths,
   if (output_path.has_value()) {
     std::string output;
     QCHECK(tip.SerializeToString(&output));
+    if (cache_key.has_value()) {
+      if (absl::Status stored = cache->Store(*cache_key, output);
+          !stored.ok()) {
+        LOG(WARNING) << "Unable to cache type information: " << stored;
+      }
+    }
     return SetFileContents(output_path->c_str(), output);
   }
   XLS_ASSIGN_OR_RETURN(
@@ -423,6 +423,11 @@ absl::StatusOr<TypeInfo*> TypecheckModule(Module* module,
   XLS_RET_CHECK_EQ(ctx.fn_stack().back().f(), nullptr);
 
   for (const ModuleMember& member : module->top()) {
+    if (import_data->IsUnreachableMember(module, ToAstNode(member))) {
+      VLOG(5) << "Skipping member unreachable from the entry point: `"
+              << ToAstNode(member)->ToString() << "`";
+      continue;
+    }
     absl::Status status = typecheck_internal::TypecheckModuleMember(
         member, module, import_data, &ctx);
     if (!status.ok()) {
@@ -254,6 +254,9 @@ class ConversionOrderVisitor : public AstNodeVisitorWithDefault {
 // `TypeInfo`.
 class InferenceTableConverter {
  public:
+  using SolvedParametrics =
+      absl::flat_hash_map<const ParametricBinding*, InterpValue>;
+
   InferenceTableConverter(
       const InferenceTable& table, Module& module, ImportData& import_data,
       WarningCollector& warning_collector, TypeInfo* base_type_info,
@@ -624,19 +627,14 @@ class InferenceTableConverter {
       std::optional<const ParametricInvocation*> effective_invocation =
           GetEffectiveParametricInvocation(invocation->caller_invocation(),
                                            actual_arg_type);
-      absl::flat_hash_map<const ParametricBinding*, InterpValue> resolved;
       VLOG(5) << "Infer using actual type: " << actual_arg_type->ToString()
               << " with effective invocation: "
               << ToString(effective_invocation);
       XLS_ASSIGN_OR_RETURN(
-          resolved,
-          SolveForParametrics(
+          SolvedParametrics resolved,
+          SolveForParametricsCached(
               actual_arg_type, formal_args[i]->type_annotation(),
-              implicit_parametrics,
-              [&](const TypeAnnotation* expected_type, const Expr* expr) {
-                return Evaluate(InvocationScopedExpr(effective_invocation,
-                                                     expected_type, expr));
-              }));
+              implicit_parametrics, effective_invocation));
       for (auto& [binding, value] : resolved) {
         VLOG(5) << "Inferred implicit parametric value: " << value.ToString()
                 << " for binding: " << binding->identifier()
@@ -660,6 +658,44 @@ class InferenceTableConverter {
     return values;
   }
 
+  // Wrapper around `SolveForParametrics()` which reuses the solution found for
+  // an earlier invocation when the same formal type is solved against an
+  // actual type with the same text for the same parametrics, e.g. repeated
+  // calls of an apfloat function with the same `EXP_SZ` and `FRACTION_SZ`.
+  // Only solutions whose evaluated expressions were all number literals are
+  // reused, as anything else may depend on the invocation's context.
+  absl::StatusOr<SolvedParametrics> SolveForParametricsCached(
+      const TypeAnnotation* actual_type, const TypeAnnotation* formal_type,
+      const absl::flat_hash_set<const ParametricBinding*>& parametrics,
+      std::optional<const ParametricInvocation*> effective_invocation) {
+    std::vector<const ParametricBinding*> sorted_parametrics(
+        parametrics.begin(), parametrics.end());
+    absl::c_sort(sorted_parametrics);
+    SolvedParametricsKey key{formal_type, actual_type->ToString(),
+                             std::move(sorted_parametrics)};
+    if (const auto it = solved_parametrics_.find(key);
+        it != solved_parametrics_.end()) {
+      VLOG(5) << "Reusing solved parametrics for actual type: " << key.actual;
+      return it->second;
+    }
+    bool context_free = true;
+    XLS_ASSIGN_OR_RETURN(
+        SolvedParametrics resolved,
+        SolveForParametrics(
+            actual_type, formal_type, parametrics,
+            [&](const TypeAnnotation* expected_type, const Expr* expr) {
+              if (dynamic_cast<const Number*>(expr) == nullptr) {
+                context_free = false;
+              }
+              return Evaluate(InvocationScopedExpr(effective_invocation,
+                                                   expected_type, expr));
+            }));
+    if (context_free) {
+      solved_parametrics_.emplace(std::move(key), resolved);
+    }
+    return resolved;
+  }
+
   absl::StatusOr<bool> EvaluateBoolOrExpr(
       std::optional<const ParametricInvocation*> parametric_invocation,
       std::variant<bool, const Expr*> value_or_expr) {
@@ -1340,6 +1376,22 @@ class InferenceTableConverter {
   absl::flat_hash_map<const ParametricInvocation*, ParametricEnv>
       converted_parametric_envs_;
   absl::flat_hash_set<const TypeAnnotation*> auto_literal_annotations_;
+
+  // Identifies a `SolveForParametrics()` problem for `solved_parametrics_`.
+  struct SolvedParametricsKey {
+    const TypeAnnotation* formal;
+    std::string actual;
+    std::vector<const ParametricBinding*> parametrics;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const SolvedParametricsKey& key) {
+      return H::combine(std::move(h), key.formal, key.actual, key.parametrics);
+    }
+    bool operator==(const SolvedParametricsKey& other) const = default;
+  };
+  absl::flat_hash_map<SolvedParametricsKey, SolvedParametrics>
+      solved_parametrics_;
+
   // For annotations that are present in here, any `Expr` in the annotation must
   // be treated as an `InvocationScopedExpr` scoped to the invocation specified
   // here.
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Benchmarks typechecking with the original type system (v1) and the
+// `type_inference_v2` one side by side, over the standard library modules and
+// over a synthetic module with many parametric invocations.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <string>
+#include <string_view>
+
+#include "include/benchmark/benchmark.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/config/xls_config.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/parse_and_typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+constexpr std::string_view kV2Attribute = "#![feature(type_inference_v2)]\n\n";
+
+// Standard library modules to typecheck, indexed by the first benchmark arg.
+constexpr std::string_view kStdlibModules[] = {
+    "std", "acm_random", "apfloat", "float32", "bfloat16",
+};
+
+std::string WithTypeSystem(std::string_view program, bool v2) {
+  return v2 ? absl::StrCat(kV2Attribute, program) : std::string(program);
+}
+
+// Returns a module with one parametric function and `invocations` functions
+// calling it, cycling through a handful of distinct bit widths so that most
+// invocations share their parametric environment with an earlier one.
+std::string MakeSyntheticModule(int64_t invocations) {
+  std::string program = R"(fn scale<N: u32>(x: uN[N]) -> uN[N] {
+  let doubled = x + x;
+  doubled - x
+}
+)";
+  for (int64_t i = 0; i < invocations; ++i) {
+    int64_t width = 8 * (1 + i % 8);
+    absl::StrAppendFormat(&program,
+                          "fn f%d(x: u%d) -> u%d { scale(x) + scale(x) }\n", i,
+                          width, width);
+  }
+  return program;
+}
+
+void TypecheckOrSkip(benchmark::State& state, std::string_view program,
+                     std::string_view module_name) {
+  for (auto _ : state) {
+    ImportData import_data = CreateImportDataForTest();
+    absl::StatusOr<TypecheckedModule> tm =
+        ParseAndTypecheck(program, absl::StrCat(module_name, ".x"),
+                          module_name, &import_data);
+    if (!tm.ok()) {
+      state.SkipWithError(tm.status().ToString().c_str());
+      return;
+    }
+    benchmark::DoNotOptimize(tm->type_info);
+  }
+}
+
+// Args: index into `kStdlibModules`, and whether to use v2.
+void BM_TypecheckStdlib(benchmark::State& state) {
+  std::string_view module_name = kStdlibModules[state.range(0)];
+  std::filesystem::path path = std::filesystem::path(GetXLSRootDir()) /
+                               "xls/dslx/stdlib" /
+                               absl::StrCat(module_name, ".x");
+  absl::StatusOr<std::filesystem::path> runfile = GetXlsRunfilePath(path);
+  absl::StatusOr<std::string> text =
+      runfile.ok() ? GetFileContents(*runfile) : runfile.status();
+  if (!text.ok()) {
+    state.SkipWithError(text.status().ToString().c_str());
+    return;
+  }
+  state.SetLabel(std::string(module_name));
+  TypecheckOrSkip(state, WithTypeSystem(*text, state.range(1) != 0),
+                  module_name);
+}
+BENCHMARK(BM_TypecheckStdlib)
+    ->ArgsProduct({benchmark::CreateDenseRange(
+                       0, std::size(kStdlibModules) - 1, /*step=*/1),
+                   {0, 1}})
+    ->ArgNames({"module", "v2"});
+
+// Args: number of invocations in the synthetic module, and whether to use v2.
+void BM_TypecheckSyntheticModule(benchmark::State& state) {
+  std::string program = WithTypeSystem(MakeSyntheticModule(state.range(0)),
+                                       state.range(1) != 0);
+  TypecheckOrSkip(state, program, "synthetic");
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_TypecheckSyntheticModule)
+    ->ArgsProduct({{16, 128, 1024}, {0, 1}})
+    ->ArgNames({"invocations", "v2"});
+
+}  // namespace
+}  // namespace xls::dslx
+
+BENCHMARK_MAIN();
@@ -1223,6 +1223,24 @@ const Y = foo(u11:5);
                         HasNodeWithType("const Y = foo(u11:5);", "uN[11]"))));
 }
 
+// Repeated and forwarded inferences of the same parametric must each get the
+// right value, whether or not the solution is reused from an earlier one.
+TEST(TypecheckV2Test, ParametricFunctionRepeatedlyInferringSameParameter) {
+  EXPECT_THAT(R"(
+fn foo<N: u32>(a: uN[N]) -> uN[N] { a }
+fn bar<M: u32>(a: uN[M]) -> uN[M] { foo(a) }
+const X = foo(u10:5);
+const Y = foo(u10:6);
+const Z = bar(u11:5);
+const W = bar(u12:5);
+)",
+              TypecheckSucceeds(
+                  AllOf(HasNodeWithType("const X = foo(u10:5);", "uN[10]"),
+                        HasNodeWithType("const Y = foo(u10:6);", "uN[10]"),
+                        HasNodeWithType("const Z = bar(u11:5);", "uN[11]"),
+                        HasNodeWithType("const W = bar(u12:5);", "uN[12]"))));
+}
+
 TEST(TypecheckV2Test, ParametricFunctionWithNonInferrableParametric) {
   EXPECT_THAT(R"(
 fn foo<M: u32, N: u32>(a: uN[M]) -> uN[M] { a }
@@ -0,0 +1,121 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/typecheck_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dslx/frontend/ast.h"
+#include "xls/dslx/frontend/module.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/import_routines.h"
+#include "xls/dslx/parse_and_typecheck.h"
+
+namespace xls::dslx {
+namespace {
+
+// Part of every key, so that entries written before a change to the key
+// derivation or to TypeInfoProto are never read back.
+constexpr std::string_view kCacheFormat = "dslx-typecheck-cache-1";
+
+// Computes module keys, memoizing the keys of imported files so a file
+// imported along several paths of the import graph is parsed once.
+class ModuleKeyBuilder {
+ public:
+  explicit ModuleKeyBuilder(ImportData* import_data)
+      : import_data_(import_data) {}
+
+  absl::StatusOr<std::optional<std::string>> ModuleKey(
+      std::string_view text, std::string_view path,
+      std::string_view module_name) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<Module> module,
+        ParseModule(text, path, module_name, import_data_->file_table()));
+    std::vector<Import*> imports;
+    for (const ModuleMember& member : module->top()) {
+      if (std::holds_alternative<Use*>(member)) {
+        return std::nullopt;
+      }
+      if (std::holds_alternative<Import*>(member)) {
+        imports.push_back(std::get<Import*>(member));
+      }
+    }
+
+    std::vector<std::string> components = {
+        std::string(kCacheFormat), std::string(module_name), std::string(text)};
+    for (Import* import : imports) {
+      ImportTokens subject = ImportTokens::FromSpan(import->subject());
+      XLS_ASSIGN_OR_RETURN(
+          std::filesystem::path import_path,
+          FindImportPath(subject, import_data_, import->span(),
+                         import_data_->vfs()));
+      XLS_ASSIGN_OR_RETURN(std::optional<std::string> import_key,
+                           FileKey(import_path, subject));
+      if (!import_key.has_value()) {
+        return std::nullopt;
+      }
+      components.push_back(subject.ToString());
+      components.push_back(*std::move(import_key));
+    }
+    return ContentAddressedDirectoryCache::ComputeKey(
+        std::vector<std::string_view>(components.begin(), components.end()));
+  }
+
+ private:
+  absl::StatusOr<std::optional<std::string>> FileKey(
+      const std::filesystem::path& path, const ImportTokens& subject) {
+    if (auto it = file_keys_.find(path.string()); it != file_keys_.end()) {
+      return it->second;
+    }
+    // Circular imports are reported by the typechecker.
+    if (!in_progress_.insert(path.string()).second) {
+      return std::nullopt;
+    }
+    XLS_ASSIGN_OR_RETURN(std::string text,
+                         import_data_->vfs().GetFileContents(path));
+    XLS_ASSIGN_OR_RETURN(
+        std::optional<std::string> key,
+        ModuleKey(text, path.string(), absl::StrJoin(subject.pieces(), ".")));
+    in_progress_.erase(path.string());
+    file_keys_.emplace(path.string(), key);
+    return key;
+  }
+
+  ImportData* import_data_;
+  absl::flat_hash_map<std::string, std::optional<std::string>> file_keys_;
+  absl::flat_hash_set<std::string> in_progress_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::optional<std::string>> ComputeTypecheckCacheKey(
+    std::string_view text, std::string_view path, std::string_view module_name,
+    ImportData* import_data) {
+  return ModuleKeyBuilder(import_data).ModuleKey(text, path, module_name);
+}
+
+}  // namespace xls::dslx
@@ -0,0 +1,54 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_DSLX_TYPECHECK_CACHE_H_
+#define XLS_DSLX_TYPECHECK_CACHE_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/dslx/import_data.h"
+
+namespace xls::dslx {
+
+// Describes a persistent cache of the type information of DSLX modules
+// (serialized TypeInfoProtos, see type_info_to_proto.h), so tools can skip
+// typechecking modules which haven't changed since a previous invocation.
+//
+// Entries are keyed by ComputeTypecheckCacheKey, a digest of the module's text
+// and, transitively, the text of every module it imports. The key does not
+// capture the version of the typechecker, so a cache directory should not be
+// shared between different XLS builds.
+inline constexpr ContentAddressedDirectoryCache::Options
+    kTypecheckCacheOptions = {
+        .directory_env_var = "XLS_DSLX_TYPECHECK_CACHE_DIR",
+        .extension = ".tipb",
+        .description = "DSLX typecheck"};
+
+// Returns the key of the module named `module_name` with contents `text`.
+// Imports are located and parsed (to find their own imports) through
+// `import_data`, but nothing is typechecked or added to `import_data`.
+//
+// Returns std::nullopt if the key can't be determined without typechecking,
+// e.g. because a module in the import graph has `use` statements.
+absl::StatusOr<std::optional<std::string>> ComputeTypecheckCacheKey(
+    std::string_view text, std::string_view path, std::string_view module_name,
+    ImportData* import_data);
+
+}  // namespace xls::dslx
+
+#endif  // XLS_DSLX_TYPECHECK_CACHE_H_
@@ -0,0 +1,84 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/dslx/typecheck_cache.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/dslx/create_import_data.h"
+#include "xls/dslx/import_data.h"
+#include "xls/dslx/virtualizable_file_system.h"
+#include "xls/dslx/warning_kind.h"
+
+namespace xls::dslx {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::Eq;
+using ::testing::Not;
+
+constexpr std::string_view kTopText = R"(import leaf;
+
+pub fn top(x: u32) -> u32 { leaf::inc(x) }
+)";
+
+// Returns the key of `kTopText`, which imports a module "leaf" with contents
+// `leaf_text`.
+absl::StatusOr<std::optional<std::string>> TopKey(std::string_view leaf_text) {
+  absl::flat_hash_map<std::filesystem::path, std::string> files = {
+      {"/fake/top.x", std::string(kTopText)},
+      {"/fake/leaf.x", std::string(leaf_text)},
+  };
+  ImportData import_data = CreateImportData(
+      "/fake/stdlib", /*additional_search_paths=*/{}, kDefaultWarningsSet,
+      std::make_unique<FakeFilesystem>(files, "/fake"));
+  return ComputeTypecheckCacheKey(kTopText, "/fake/top.x", "top",
+                                  &import_data);
+}
+
+// Changing an imported module changes the key of the importer.
+TEST(TypecheckCacheTest, KeyDependsOnImports) {
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::optional<std::string> key,
+      TopKey("pub fn inc(x: u32) -> u32 { x + u32:1 }"));
+  ASSERT_TRUE(key.has_value());
+  EXPECT_THAT(TopKey("pub fn inc(x: u32) -> u32 { x + u32:1 }"),
+              IsOkAndHolds(key));
+  EXPECT_THAT(TopKey("pub fn inc(x: u32) -> u32 { x + u32:2 }"),
+              IsOkAndHolds(Not(Eq(key))));
+}
+
+TEST(TypecheckCacheTest, MissingImportIsAnError) {
+  ImportData import_data = CreateImportDataForTest(
+      std::make_unique<FakeFilesystem>(
+          absl::flat_hash_map<std::filesystem::path, std::string>{}, "/fake"));
+  EXPECT_THAT(ComputeTypecheckCacheKey(kTopText, "/fake/top.x", "top",
+                                       &import_data),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
+}  // namespace
+}  // namespace xls::dslx
@@ -25,6 +25,8 @@
 #include <vector>
 
 #include "absl/base/attributes.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -160,6 +162,7 @@ absl::Status PatchIr::ApplyDeletePath(
   dummy_nodes_map_[to_node].push_back(dummy_node);
   XLS_RETURN_IF_ERROR(to_node->ReplaceOperandNumber(edge_delete.edge().index(),
                                                     dummy_node, false));
+  rewired_node_names_.insert(to_node->GetName());
   return absl::OkStatus();
 }
 absl::Status PatchIr::ApplyInsertPath(
@@ -361,6 +364,7 @@ absl::Status PatchIr::ApplyInsertPath(
   Node* node_to_remove = to_node->operands()[position];
   XLS_RETURN_IF_ERROR(
       to_node->ReplaceOperandNumber(position, from_node, false));
+  rewired_node_names_.insert(to_node->GetName());
   XLS_RETURN_IF_ERROR(function_base_->RemoveNode(node_to_remove));
   auto it = std::remove(dummy_nodes_map_[to_node].begin(),
                         dummy_nodes_map_[to_node].end(), node_to_remove);
@@ -436,48 +440,41 @@ absl::Status PatchIr::PatchSchedule(const PipelineSchedule& schedule) {
   XLS_ASSIGN_OR_RETURN(
       SchedulingOptions scheduling_options,
       SetUpSchedulingOptions(scheduling_options_flags_proto, package_));
-  SchedulingOptions tmp_scheduling_options = scheduling_options;
   XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
                        SetUpDelayEstimator(scheduling_options_flags_proto));
-  decltype(package_->GetNodeCount()) constraint_count = 0;
+  absl::flat_hash_set<Node*> present_nodes(function_base_->nodes().begin(),
+                                           function_base_->nodes().end());
+  absl::flat_hash_map<std::string, int64_t> prior_stages;
   for (const auto& [node, cycle] : schedule.GetCycleMap()) {
-    if (inserted_node_names_.contains(node->GetName())) {
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to node being newly inserted.\n";
+    if (!present_nodes.contains(node)) {
+      std::cout << "Skipping constraint for node due to node not found in "
+                   "IR.\n";
       continue;
     }
-    if (std::find(function_base_->nodes().begin(),
-                  function_base_->nodes().end(),
-                  node) == function_base_->nodes().end()) {
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to node not found in IR.\n";
-      continue;
-    }
-    if (node->op() == Op::kLiteral) {
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to node being a literal.\n";
-      continue;
-    }
-    tmp_scheduling_options.add_constraint(NodeInCycleConstraint(node, cycle));
-    // check if schedule is feasible; if not, then we need remove the constraint
-    if (!RunPipelineSchedule(function_base_, *delay_estimator,
-                             tmp_scheduling_options)
-             .ok()) {
-      tmp_scheduling_options.clear_constraints();
-      std::cout << "Skipping constraint for node: " << node->GetName()
-                << " due to schedule infeasibility.\n";
-    } else {
-      scheduling_options = tmp_scheduling_options;
-      constraint_count++;
+    prior_stages[node->GetName()] = cycle;
+  }
+  absl::flat_hash_set<Node*> changed_nodes;
+  for (Node* node : function_base_->nodes()) {
+    if (inserted_node_names_.contains(node->GetName()) ||
+        rewired_node_names_.contains(node->GetName())) {
+      changed_nodes.insert(node);
     }
-    tmp_scheduling_options = scheduling_options;
-    XLS_ASSIGN_OR_RETURN(schedule_,
-                         RunPipelineSchedule(function_base_, *delay_estimator,
-                                             scheduling_options));
   }
+  XLS_ASSIGN_OR_RETURN(
+      schedule_, RunIncrementalPipelineSchedule(
+                     function_base_, *delay_estimator, scheduling_options,
+                     prior_stages, changed_nodes));
   XLS_RETURN_IF_ERROR(schedule_->Verify());
-  std::cout << "Total nodes: " << package_->GetNodeCount();
-  std::cout << "constrained nodes count: " << constraint_count;
+  int64_t kept_count = 0;
+  for (const auto& [node, cycle] : schedule_->GetCycleMap()) {
+    auto it = prior_stages.find(node->GetName());
+    if (it != prior_stages.end() && it->second == cycle) {
+      ++kept_count;
+    }
+  }
+  std::cout << "Total nodes: " << package_->GetNodeCount() << "\n";
+  std::cout << "Changed nodes: " << changed_nodes.size() << "\n";
+  std::cout << "Nodes kept in their prior stage: " << kept_count << "\n";
   return absl::OkStatus();
 }
 
@@ -112,6 +112,8 @@ class PatchIr {
   xls_eco::IrPatchProto patch_;
   std::vector<xls_eco::EditPathProto> sorted_edit_paths_;
   absl::flat_hash_set<std::string> inserted_node_names_;
+  // Names of pre-existing nodes whose operands were changed by the patch.
+  absl::flat_hash_set<std::string> rewired_node_names_;
   FunctionBase* function_base_;
   Package* package_;
   std::optional<PipelineSchedule> schedule_;
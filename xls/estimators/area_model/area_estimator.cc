@@ -17,16 +17,22 @@
 #include <algorithm>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "absl/base/no_destructor.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/estimators/node_signature.h"
+#include "xls/ir/node.h"
 
 namespace xls {
 
@@ -37,6 +43,48 @@ absl::StatusOr<double> AreaEstimator::GetRegisterAreaInSquareMicrons(
   return one_bit_register_area * static_cast<double>(register_width);
 }
 
+absl::StatusOr<std::vector<double>>
+AreaEstimator::GetOperationAreasInSquareMicrons(
+    absl::Span<Node* const> nodes) const {
+  std::vector<double> areas;
+  areas.reserve(nodes.size());
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(double area, GetOperationAreaInSquareMicrons(node));
+    areas.push_back(area);
+  }
+  return areas;
+}
+
+CachingAreaEstimator::CachingAreaEstimator(std::string_view name,
+                                           const AreaEstimator& cached)
+    : AreaEstimator(name), cached_(cached) {}
+
+absl::StatusOr<double> CachingAreaEstimator::GetOperationAreaInSquareMicrons(
+    Node* node) const {
+  std::optional<std::string> signature = GetEstimatorNodeSignature(node);
+  if (!signature.has_value()) {
+    return cached_.GetOperationAreaInSquareMicrons(node);
+  }
+  Shard& shard = GetShard(*signature);
+  {
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.areas.find(*signature);
+    if (it != shard.areas.end()) {
+      return it->second;
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(double area,
+                       cached_.GetOperationAreaInSquareMicrons(node));
+  absl::WriterMutexLock lock(&shard.mutex);
+  shard.areas.emplace(*std::move(signature), area);
+  return area;
+}
+
+absl::StatusOr<double>
+CachingAreaEstimator::GetOneBitRegisterAreaInSquareMicrons() const {
+  return cached_.GetRegisterAreaInSquareMicrons(1);
+}
+
 AreaEstimatorManager& GetAreaEstimatorManagerSingleton() {
   static absl::NoDestructor<AreaEstimatorManager> manager;
   return *manager;
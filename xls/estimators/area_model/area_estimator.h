@@ -15,15 +15,20 @@
 #ifndef XLS_ESTIMATORS_AREA_MODEL_AREA_ESTIMATOR_H_
 #define XLS_ESTIMATORS_AREA_MODEL_AREA_ESTIMATOR_H_
 
+#include <array>
 #include <cstdint>
 #include <memory>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/base/optimization.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/ir/node.h"
 
@@ -48,6 +53,12 @@ class AreaEstimator {
   virtual absl::StatusOr<double> GetOperationAreaInSquareMicrons(
       Node* node) const = 0;
 
+  // Returns the estimated areas of the given nodes in square micrometers, in
+  // the same order. Estimators which can amortize work across nodes override
+  // this; the default queries each node in turn.
+  virtual absl::StatusOr<std::vector<double>> GetOperationAreasInSquareMicrons(
+      absl::Span<Node* const> nodes) const;
+
   // Returns the estimated area of n-bit register
   absl::StatusOr<double> GetRegisterAreaInSquareMicrons(
       const uint64_t& register_width) const;
@@ -56,6 +67,39 @@ class AreaEstimator {
   std::string name_;
 };
 
+// Memoizes an underlying area estimator on the signature of each node (see
+// GetEstimatorNodeSignature), so a hit carries over to clones of a function
+// and to other packages. Nodes without a signature are passed through, which
+// keeps the cache free of node addresses and so safe to hold for the lifetime
+// of the process. The cache is striped over kShardCount independently locked
+// shards; this class is safe for concurrent access.
+class CachingAreaEstimator : public AreaEstimator {
+ public:
+  CachingAreaEstimator(std::string_view name, const AreaEstimator& cached);
+
+  ~CachingAreaEstimator() override = default;
+
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override;
+
+ private:
+  static constexpr int64_t kShardCount = 64;
+
+  struct alignas(ABSL_CACHELINE_SIZE) Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<std::string, double> areas ABSL_GUARDED_BY(mutex);
+  };
+
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override;
+
+  Shard& GetShard(const std::string& signature) const {
+    return shards_[absl::HashOf(signature) % kShardCount];
+  }
+
+  const AreaEstimator& cached_;
+  mutable std::array<Shard, kShardCount> shards_;
+};
+
 // A manager holding multiple Area Estimator singletons
 class AreaEstimatorManager {
  public:
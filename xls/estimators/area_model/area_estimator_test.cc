@@ -14,8 +14,11 @@
 
 #include "xls/estimators/area_model/area_estimator.h"
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -26,7 +29,9 @@
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
 
 namespace xls {
 namespace {
@@ -83,5 +88,50 @@ TEST_F(AreaEstimatorTest, AreaEstimatorManager) {
               absl_testing::IsOkAndHolds(420.0));
 }
 
+// An area estimator which counts its queries and returns the node's width.
+class CountingAreaEstimator : public AreaEstimator {
+ public:
+  CountingAreaEstimator() : AreaEstimator("counting") {}
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override {
+    ++query_count_;
+    return node->GetType()->GetFlatBitCount();
+  }
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override {
+    return 2.0;
+  }
+
+  int64_t query_count() const { return query_count_; }
+
+ private:
+  mutable std::atomic<int64_t> query_count_ = 0;
+};
+
+TEST_F(AreaEstimatorTest, CachingAreaEstimator) {
+  CountingAreaEstimator counting;
+  CachingAreaEstimator caching("caching", counting);
+  std::vector<std::unique_ptr<Package>> packages;
+  std::vector<Node*> nodes;
+  for (int64_t i = 0; i < 2; ++i) {
+    packages.push_back(CreatePackage());
+    Package* p = packages.back().get();
+    FunctionBuilder fb(TestName(), p);
+    BValue x = fb.Param("x", p->GetBitsType(8));
+    BValue y = fb.Param("y", p->GetBitsType(8));
+    BValue add = fb.Add(x, y);
+    BValue eq = fb.Eq(x, y);
+    XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple({add, eq})).status());
+    nodes.insert(nodes.end(), {x.node(), add.node(), eq.node()});
+  }
+  EXPECT_THAT(caching.GetOperationAreasInSquareMicrons(nodes),
+              absl_testing::IsOkAndHolds(testing::ElementsAre(8, 8, 1, 8, 8,
+                                                              1)));
+  // The add and eq are looked up once across both packages; params have no
+  // signature and are always passed through.
+  EXPECT_EQ(counting.query_count(), 4);
+  EXPECT_THAT(caching.GetRegisterAreaInSquareMicrons(3),
+              absl_testing::IsOkAndHolds(6.0));
+}
+
 }  // namespace
 }  // namespace xls
@@ -60,6 +60,7 @@ def delay_model(
         srcs = [":{}_source".format(name)],
         alwayslink = 1,
         deps = [
+            "@com_google_absl//absl/base:no_destructor",
             "@com_google_absl//absl/container:flat_hash_set",
             "@com_google_absl//absl/log:check",
             "@com_google_absl//absl/memory",
@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -30,10 +31,13 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
+#include "xls/ir/type.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/logical_effort.h"
 
@@ -219,6 +223,17 @@ namespace {
 
 }  // namespace
 
+absl::StatusOr<std::vector<int64_t>> DelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<int64_t> delays;
+  delays.reserve(nodes.size());
+  for (Node* node : nodes) {
+    XLS_ASSIGN_OR_RETURN(int64_t delay, GetOperationDelayInPs(node));
+    delays.push_back(delay);
+  }
+  return delays;
+}
+
 DecoratingDelayEstimator::DecoratingDelayEstimator(
     std::string_view name, const DelayEstimator& decorated,
     std::function<int64_t(Node*, int64_t)> modifier)
@@ -255,15 +270,38 @@ CachingDelayEstimator::CachingDelayEstimator(std::string_view name,
 
 absl::StatusOr<int64_t> CachingDelayEstimator::GetOperationDelayInPs(
     Node* node) const {
-  if (ContainsNodeDelay(node)) {
-    return GetNodeDelay(node);
+  Key key = GetKey(node);
+  if (std::optional<int64_t> delay = Lookup(key); delay.has_value()) {
+    return *delay;
   }
 
+  // Computed outside the lock; racing threads compute the same value and the
+  // first to insert wins.
   XLS_ASSIGN_OR_RETURN(int64_t delay, cached_.GetOperationDelayInPs(node));
-  AddNodeDelay(node, delay);
+  Insert(std::move(key), delay);
   return delay;
 }
 
+absl::StatusOr<std::vector<int64_t>>
+CachingDelayEstimator::GetOperationDelaysInPs(
+    absl::Span<Node* const> nodes) const {
+  std::vector<int64_t> delays(nodes.size());
+  std::vector<std::pair<int64_t, Key>> misses;
+  for (int64_t i = 0; i < nodes.size(); ++i) {
+    Key key = GetKey(nodes[i]);
+    if (std::optional<int64_t> delay = Lookup(key); delay.has_value()) {
+      delays[i] = *delay;
+    } else {
+      misses.push_back({i, std::move(key)});
+    }
+  }
+  for (auto& [i, key] : misses) {
+    XLS_ASSIGN_OR_RETURN(delays[i], cached_.GetOperationDelayInPs(nodes[i]));
+    Insert(std::move(key), delays[i]);
+  }
+  return delays;
+}
+
 /* static */ absl::StatusOr<int64_t> DelayEstimator::GetLogicalEffortDelayInPs(
     Node* node, int64_t tau_in_ps) {
   XLS_ASSIGN_OR_RETURN(int64_t delay_in_tau, GetLogicalEffortDelayInTau(node));
@@ -15,21 +15,27 @@
 #ifndef XLS_ESTIMATORS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 #define XLS_ESTIMATORS_DELAY_MODEL_DELAY_ESTIMATOR_H_
 
+#include <array>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <variant>
 #include <vector>
 
+#include "absl/base/optimization.h"
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/test_macros.h"
+#include "xls/estimators/node_signature.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -45,6 +51,12 @@ class DelayEstimator {
   // Returns the estimated delay of the given node in picoseconds.
   virtual absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const = 0;
 
+  // Returns the estimated delays of the given nodes in picoseconds, in the
+  // same order. Estimators which can amortize work across nodes (e.g. taking a
+  // lock once) override this; the default queries each node in turn.
+  virtual absl::StatusOr<std::vector<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const;
+
   // Compute the delay of the given node using logical effort estimation. Only
   // relatively simple operations (kAnd, kOr, etc) are supported using this
   // method.
@@ -89,7 +101,14 @@ class FirstMatchDelayEstimator : public DelayEstimator {
 };
 
 // Cache the delay of an underlying delay estimator. This class is safe for
-// concurrent access.
+// concurrent access; the cache is striped over kShardCount independently
+// locked shards so that analyses running on several threads rarely contend.
+//
+// Delays are keyed on the signature of each node (see
+// GetEstimatorNodeSignature), so a hit carries over to clones of a function and
+// to other packages. Nodes without a signature are keyed on their address.
+// This assumes the underlying estimator depends on nothing about a node other
+// than its signature, which holds for the delay models in this directory.
 class CachingDelayEstimator : public DelayEstimator {
  public:
   CachingDelayEstimator(std::string_view name, const DelayEstimator& cached);
@@ -97,29 +116,63 @@ class CachingDelayEstimator : public DelayEstimator {
   ~CachingDelayEstimator() override = default;
 
   absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override;
+  absl::StatusOr<std::vector<int64_t>> GetOperationDelaysInPs(
+      absl::Span<Node* const> nodes) const override;
 
  private:
-  bool ContainsNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.contains(node);
+  static constexpr int64_t kShardCount = 64;
+
+  using Key = std::variant<Node*, std::string>;
+
+  // Each shard sits on its own cache line so that the shards' mutexes don't
+  // falsely share.
+  struct alignas(ABSL_CACHELINE_SIZE) Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<Key, int64_t> delays ABSL_GUARDED_BY(mutex);
+  };
+
+  static Key GetKey(Node* node) {
+    std::optional<std::string> signature = GetEstimatorNodeSignature(node);
+    if (signature.has_value()) {
+      return *std::move(signature);
+    }
+    return node;
   }
 
-  int64_t GetNodeDelay(Node* node) const {
-    absl::ReaderMutexLock lock(&cache_mutex_);
-    return cache_.at(node);
+  Shard& GetShard(const Key& key) const {
+    return shards_[absl::HashOf(key) % kShardCount];
   }
 
+  std::optional<int64_t> Lookup(const Key& key) const {
+    Shard& shard = GetShard(key);
+    absl::ReaderMutexLock lock(&shard.mutex);
+    auto it = shard.delays.find(key);
+    if (it == shard.delays.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  void Insert(Key key, int64_t delay) const {
+    Shard& shard = GetShard(key);
+    absl::WriterMutexLock lock(&shard.mutex);
+    shard.delays.emplace(std::move(key), delay);
+  }
+
+  bool ContainsNodeDelay(Node* node) const {
+    return Lookup(GetKey(node)).has_value();
+  }
+
+  int64_t GetNodeDelay(Node* node) const { return *Lookup(GetKey(node)); }
+
   void AddNodeDelay(Node* node, int64_t delay) const {
-    absl::WriterMutexLock lock(&cache_mutex_);
-    cache_.emplace(node, delay);
+    Insert(GetKey(node), delay);
   }
 
   XLS_FRIEND_TEST(DelayEstimatorTest, CachingDelayEstimator);
 
   const DelayEstimator& cached_;
-  mutable absl::Mutex cache_mutex_;
-  mutable absl::flat_hash_map<Node*, int64_t> cache_
-      ABSL_GUARDED_BY(cache_mutex_);
+  mutable std::array<Shard, kShardCount> shards_;
 };
 
 enum class DelayEstimatorPrecedence {
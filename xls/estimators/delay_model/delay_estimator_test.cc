@@ -14,6 +14,7 @@
 
 #include "xls/estimators/delay_model/delay_estimator.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string_view>
@@ -24,11 +25,15 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
 
 namespace xls {
 
@@ -304,6 +309,107 @@ TEST_F(DelayEstimatorTest, CachingDelayEstimator) {
   EXPECT_THAT(caching.GetNodeDelay(f->return_value()), 1);
 }
 
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorBatched) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(1));
+  BValue y = fb.Not(x);
+  BValue z = fb.Xor({x, y});
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(z).status());
+  FakeDelayEstimator two(2, "two");
+  CachingDelayEstimator caching("caching", two);
+  EXPECT_THAT(caching.GetOperationDelayInPs(y.node()), IsOkAndHolds(2));
+  EXPECT_THAT(caching.GetOperationDelaysInPs({x.node(), y.node(), z.node()}),
+              IsOkAndHolds(ElementsAre(2, 2, 2)));
+}
+
+// A delay estimator which counts its queries and returns the node's width.
+class CountingDelayEstimator : public DelayEstimator {
+ public:
+  CountingDelayEstimator() : DelayEstimator("counting") {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node* node) const override {
+    ++query_count_;
+    return node->GetType()->GetFlatBitCount();
+  }
+
+  int64_t query_count() const { return query_count_; }
+
+ private:
+  mutable std::atomic<int64_t> query_count_ = 0;
+};
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorSharesStructuralHits) {
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  std::vector<std::unique_ptr<Package>> packages;
+  std::vector<std::vector<BValue>> nodes;
+  for (int64_t i = 0; i < 2; ++i) {
+    packages.push_back(CreatePackage());
+    Package* p = packages.back().get();
+    FunctionBuilder fb(TestName(), p);
+    BValue a = fb.Param("a", p->GetBitsType(8));
+    BValue b = fb.Param("b", p->GetBitsType(8));
+    nodes.push_back({fb.Add(a, b), fb.Add(a, a), fb.BitSlice(a, 0, 4),
+                     fb.BitSlice(a, 4, 4)});
+    XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple(nodes.back())).status());
+  }
+  for (const BValue& value : nodes[0]) {
+    XLS_ASSERT_OK(caching.GetOperationDelayInPs(value.node()).status());
+  }
+  // The repeated operand and the differing slice starts each make a distinct
+  // signature.
+  EXPECT_EQ(counting.query_count(), 4);
+  // The nodes of the second package are structurally the same as those of the
+  // first.
+  for (const BValue& value : nodes[1]) {
+    XLS_ASSERT_OK(caching.GetOperationDelayInPs(value.node()).status());
+  }
+  EXPECT_EQ(counting.query_count(), 4);
+}
+
+TEST_F(DelayEstimatorTest, CachingDelayEstimatorConcurrentAccess) {
+  constexpr int64_t kNodeCount = 256;
+  constexpr int64_t kThreadCount = 8;
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> values;
+  values.reserve(kNodeCount);
+  for (int64_t i = 0; i < kNodeCount; ++i) {
+    values.push_back(fb.Param(absl::StrCat("x", i), p->GetBitsType(i + 1)));
+  }
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Tuple(values)).status());
+
+  CountingDelayEstimator counting;
+  CachingDelayEstimator caching("caching", counting);
+  std::atomic<int64_t> mismatches = 0;
+  {
+    ThreadPool pool(kThreadCount);
+    for (int64_t t = 0; t < kThreadCount; ++t) {
+      pool.Schedule([&]() {
+        for (const BValue& value : values) {
+          absl::StatusOr<int64_t> delay =
+              caching.GetOperationDelayInPs(value.node());
+          if (!delay.ok() || *delay != value.node()->BitCountOrDie()) {
+            ++mismatches;
+          }
+        }
+      });
+    }
+  }
+  EXPECT_EQ(mismatches, 0);
+  // Racing misses may each query the underlying estimator, but every later
+  // query is served from the cache.
+  EXPECT_GE(counting.query_count(), kNodeCount);
+  EXPECT_LE(counting.query_count(), kNodeCount * kThreadCount);
+  int64_t queries = counting.query_count();
+  for (const BValue& value : values) {
+    EXPECT_THAT(caching.GetOperationDelayInPs(value.node()),
+                IsOkAndHolds(value.node()->BitCountOrDie()));
+  }
+  EXPECT_EQ(counting.query_count(), queries);
+}
+
 // A Delay Estimator that can only handle one kind of operation.
 class TestNodeMatchEstimator : public DelayEstimator {
  public:
@@ -0,0 +1,227 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/delay_model/timing_engine.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+
+bool TimingEngine::ArrivalEntry::operator<(const ArrivalEntry& other) const {
+  auto id = [](Node* node) { return node == nullptr ? -1 : node->id(); };
+  return std::make_tuple(key, arrival, id(node)) <
+         std::make_tuple(other.key, other.arrival, id(other.node));
+}
+
+TimingEngine::TimingEngine(FunctionBase* f,
+                           const DelayEstimator& delay_estimator)
+    : f_(f), delay_estimator_(delay_estimator) {}
+
+absl::StatusOr<int64_t> TimingEngine::GetDelay(Node* node) const {
+  auto it = delay_overrides_.find(node);
+  if (it != delay_overrides_.end()) {
+    return it->second;
+  }
+  return delay_estimator_.GetOperationDelayInPs(node);
+}
+
+int64_t TimingEngine::TopoIndex(Node* node) {
+  if (!topo_index_.contains(node)) {
+    topo_index_.clear();
+    int64_t index = 0;
+    for (Node* n : TopoSort(f_)) {
+      topo_index_[n] = index++;
+    }
+  }
+  return topo_index_.at(node);
+}
+
+void TimingEngine::Index(Node* node, const NodeTiming& timing) {
+  by_group_.insert(ArrivalEntry{timing.group, timing.arrival, node});
+  by_arrival_.insert(ArrivalEntry{0, timing.arrival, node});
+}
+
+void TimingEngine::Unindex(Node* node, const NodeTiming& timing) {
+  by_group_.erase(ArrivalEntry{timing.group, timing.arrival, node});
+  by_arrival_.erase(ArrivalEntry{0, timing.arrival, node});
+}
+
+void TimingEngine::Propagate(absl::Span<Node* const> seeds) {
+  using QueueEntry = std::pair<int64_t, Node*>;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>>
+      worklist;
+  absl::flat_hash_set<Node*> queued;
+  auto enqueue = [&](Node* node) {
+    if (contains(node) && queued.insert(node).second) {
+      worklist.push({TopoIndex(node), node});
+    }
+  };
+  for (Node* node : seeds) {
+    enqueue(node);
+  }
+  // Nodes are visited in topological order, so each is visited at most once
+  // and only after all of its operands are final.
+  while (!worklist.empty()) {
+    Node* node = worklist.top().second;
+    worklist.pop();
+    NodeTiming& timing = timings_.at(node);
+    int64_t start = 0;
+    Node* critical_operand = nullptr;
+    for (Node* operand : node->operands()) {
+      auto it = timings_.find(operand);
+      if (it == timings_.end() || it->second.group != timing.group) {
+        continue;
+      }
+      if (it->second.arrival > start) {
+        start = it->second.arrival;
+        critical_operand = operand;
+      }
+    }
+    timing.critical_operand = critical_operand;
+    const int64_t arrival = start + timing.delay;
+    if (arrival == timing.arrival) {
+      continue;
+    }
+    Unindex(node, timing);
+    timing.arrival = arrival;
+    Index(node, timing);
+    for (Node* user : node->users()) {
+      enqueue(user);
+    }
+  }
+}
+
+absl::Status TimingEngine::Add(Node* node, int64_t group) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_);
+  XLS_ASSIGN_OR_RETURN(int64_t delay, GetDelay(node));
+  auto [it, inserted] = timings_.try_emplace(
+      node, NodeTiming{.group = group,
+                       .delay = delay,
+                       .arrival = delay,
+                       .critical_operand = nullptr});
+  if (!inserted) {
+    Unindex(node, it->second);
+    it->second.group = group;
+    it->second.delay = delay;
+  }
+  Index(node, it->second);
+  // The users of the node may gain or lose it as a critical operand even if
+  // its own arrival time is unchanged.
+  std::vector<Node*> seeds = {node};
+  seeds.insert(seeds.end(), node->users().begin(), node->users().end());
+  Propagate(seeds);
+  return absl::OkStatus();
+}
+
+absl::Status TimingEngine::Remove(Node* node) {
+  auto it = timings_.find(node);
+  XLS_RET_CHECK(it != timings_.end())
+      << "Node " << node->GetName() << " is not in the timing engine";
+  Unindex(node, it->second);
+  timings_.erase(it);
+  std::vector<Node*> seeds(node->users().begin(), node->users().end());
+  Propagate(seeds);
+  return absl::OkStatus();
+}
+
+absl::Status TimingEngine::SetDelayOverride(Node* node, int64_t delay_ps) {
+  XLS_RET_CHECK_EQ(node->function_base(), f_);
+  delay_overrides_[node] = delay_ps;
+  auto it = timings_.find(node);
+  if (it != timings_.end() && it->second.delay != delay_ps) {
+    it->second.delay = delay_ps;
+    Propagate({node});
+  }
+  return absl::OkStatus();
+}
+
+absl::Status TimingEngine::ClearDelayOverride(Node* node) {
+  if (delay_overrides_.erase(node) == 0) {
+    return absl::OkStatus();
+  }
+  auto it = timings_.find(node);
+  if (it == timings_.end()) {
+    return absl::OkStatus();
+  }
+  XLS_ASSIGN_OR_RETURN(int64_t delay,
+                       delay_estimator_.GetOperationDelayInPs(node));
+  if (it->second.delay != delay) {
+    it->second.delay = delay;
+    Propagate({node});
+  }
+  return absl::OkStatus();
+}
+
+Node* TimingEngine::CriticalPathEnd(std::optional<int64_t> group) const {
+  if (!group.has_value()) {
+    return by_arrival_.empty() ? nullptr : by_arrival_.rbegin()->node;
+  }
+  // The last entry keyed on `group`.
+  auto it = by_group_.lower_bound(ArrivalEntry{
+      *group + 1, std::numeric_limits<int64_t>::min(), nullptr});
+  if (it == by_group_.begin()) {
+    return nullptr;
+  }
+  --it;
+  return it->key == *group ? it->node : nullptr;
+}
+
+int64_t TimingEngine::CriticalPathDelay() const {
+  Node* end = CriticalPathEnd(std::nullopt);
+  return end == nullptr ? 0 : ArrivalTime(end);
+}
+
+int64_t TimingEngine::CriticalPathDelay(int64_t group) const {
+  Node* end = CriticalPathEnd(group);
+  return end == nullptr ? 0 : ArrivalTime(end);
+}
+
+std::vector<Node*> TimingEngine::TracePath(Node* end) const {
+  std::vector<Node*> path;
+  for (Node* node = end; node != nullptr;
+       node = timings_.at(node).critical_operand) {
+    path.push_back(node);
+  }
+  std::reverse(path.begin(), path.end());
+  return path;
+}
+
+std::vector<Node*> TimingEngine::CriticalPath() const {
+  return TracePath(CriticalPathEnd(std::nullopt));
+}
+
+std::vector<Node*> TimingEngine::CriticalPath(int64_t group) const {
+  return TracePath(CriticalPathEnd(group));
+}
+
+}  // namespace xls
@@ -0,0 +1,134 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_ESTIMATORS_DELAY_MODEL_TIMING_ENGINE_H_
+#define XLS_ESTIMATORS_DELAY_MODEL_TIMING_ENGINE_H_
+
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Incrementally maintains the arrival time of each node in a set of nodes of a
+// function, i.e. the critical-path delay up to and including the node. The set
+// is partitioned into groups (for example the stages of a pipeline schedule)
+// and paths only extend from an operand to a user in the same group, so with a
+// single group this tracks the combinational critical path like a DelayHeap.
+//
+// Unlike a DelayHeap, nodes may be added, removed, moved between groups and
+// have their delay overridden in any order. Each edit only revisits the nodes
+// whose arrival time actually changes, in topological order, so small changes
+// to a large set (e.g. a few nodes moving between stages from one scheduling
+// iteration to the next) are cheap.
+class TimingEngine {
+ public:
+  TimingEngine(FunctionBase* f, const DelayEstimator& delay_estimator);
+
+  // Adds `node` to the given group, or moves it there if it is already in the
+  // set.
+  absl::Status Add(Node* node, int64_t group = 0);
+
+  // Removes `node` from the set.
+  absl::Status Remove(Node* node);
+
+  // Overrides the delay of `node`, e.g. with a delay measured by synthesis.
+  // The override is kept if the node is removed and later re-added.
+  absl::Status SetDelayOverride(Node* node, int64_t delay_ps);
+  absl::Status ClearDelayOverride(Node* node);
+
+  // Returns true if `node` is in the set.
+  bool contains(Node* node) const { return timings_.contains(node); }
+
+  // Returns the number of nodes in the set.
+  int64_t size() const { return timings_.size(); }
+
+  // Returns the group, delay and arrival time of `node`, which must be in the
+  // set.
+  int64_t group(Node* node) const { return timings_.at(node).group; }
+  int64_t NodeDelay(Node* node) const { return timings_.at(node).delay; }
+  int64_t ArrivalTime(Node* node) const { return timings_.at(node).arrival; }
+
+  // Returns the largest arrival time in the set, or in the given group. Empty
+  // sets have a critical-path delay of zero.
+  int64_t CriticalPathDelay() const;
+  int64_t CriticalPathDelay(int64_t group) const;
+
+  // Returns the critical path through the set, or through the given group,
+  // from its first node to its last. Zero-delay nodes at the start of the
+  // path (such as params) are not included.
+  std::vector<Node*> CriticalPath() const;
+  std::vector<Node*> CriticalPath(int64_t group) const;
+
+ private:
+  struct NodeTiming {
+    int64_t group;
+    int64_t delay;
+    int64_t arrival;
+    // The operand through which the critical path to this node extends, or
+    // nullptr if no operand in the group has a positive arrival time.
+    Node* critical_operand;
+  };
+
+  // An entry of an ordered index of arrival times. Ties are broken on node id
+  // for determinism.
+  struct ArrivalEntry {
+    int64_t key;
+    int64_t arrival;
+    Node* node;
+
+    bool operator<(const ArrivalEntry& other) const;
+  };
+
+  absl::StatusOr<int64_t> GetDelay(Node* node) const;
+  int64_t TopoIndex(Node* node);
+
+  // Recomputes the arrival times of `seeds` and of every node in the set whose
+  // arrival time depends on a changed one.
+  void Propagate(absl::Span<Node* const> seeds);
+
+  void Index(Node* node, const NodeTiming& timing);
+  void Unindex(Node* node, const NodeTiming& timing);
+
+  // Returns the last node of the critical path of `group`, or of the whole set
+  // if std::nullopt. Returns nullptr if there are no such nodes.
+  Node* CriticalPathEnd(std::optional<int64_t> group) const;
+  std::vector<Node*> TracePath(Node* end) const;
+
+  FunctionBase* f_;
+  const DelayEstimator& delay_estimator_;
+  absl::flat_hash_map<Node*, NodeTiming> timings_;
+  absl::flat_hash_map<Node*, int64_t> delay_overrides_;
+  // Position of each node of the function in a topological sort, recomputed
+  // when a node added to the function since is first seen. Edits which
+  // reorder the pre-existing nodes of the function require a new engine.
+  absl::flat_hash_map<Node*, int64_t> topo_index_;
+  // Every node of the set ordered by arrival time, keyed on its group.
+  std::set<ArrivalEntry> by_group_;
+  // Every node of the set ordered by arrival time, with a key of zero.
+  std::set<ArrivalEntry> by_arrival_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_ESTIMATORS_DELAY_MODEL_TIMING_ENGINE_H_
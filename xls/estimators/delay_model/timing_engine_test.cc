@@ -0,0 +1,159 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/delay_model/timing_engine.h"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class TimingEngineTest : public IrTestBase {
+ protected:
+  const DelayEstimator* delay_estimator_ = GetDelayEstimator("unit").value();
+};
+
+TEST_F(TimingEngineTest, ChainInOneGroup) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue a = fb.Not(x);
+  BValue b = fb.Negate(a);
+  BValue c = fb.Add(b, x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(c));
+
+  TimingEngine engine(f, *delay_estimator_);
+  EXPECT_EQ(engine.CriticalPathDelay(), 0);
+  EXPECT_THAT(engine.CriticalPath(), IsEmpty());
+
+  // Nodes may be added in any order.
+  XLS_ASSERT_OK(engine.Add(c.node()));
+  XLS_ASSERT_OK(engine.Add(a.node()));
+  EXPECT_EQ(engine.CriticalPathDelay(), 1);
+  XLS_ASSERT_OK(engine.Add(b.node()));
+  XLS_ASSERT_OK(engine.Add(x.node()));
+  EXPECT_EQ(engine.size(), 4);
+  EXPECT_EQ(engine.ArrivalTime(b.node()), 2);
+  EXPECT_EQ(engine.CriticalPathDelay(), 3);
+  EXPECT_THAT(engine.CriticalPath(),
+              ElementsAre(a.node(), b.node(), c.node()));
+
+  // Removing a node in the middle of the path splits it.
+  XLS_ASSERT_OK(engine.Remove(a.node()));
+  EXPECT_EQ(engine.ArrivalTime(b.node()), 1);
+  EXPECT_EQ(engine.CriticalPathDelay(), 2);
+  EXPECT_THAT(engine.CriticalPath(), ElementsAre(b.node(), c.node()));
+
+  XLS_ASSERT_OK(engine.SetDelayOverride(b.node(), 10));
+  EXPECT_EQ(engine.CriticalPathDelay(), 11);
+  XLS_ASSERT_OK(engine.ClearDelayOverride(b.node()));
+  EXPECT_EQ(engine.CriticalPathDelay(), 2);
+}
+
+TEST_F(TimingEngineTest, PathsStayWithinGroups) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue a = fb.Not(x);
+  BValue b = fb.Not(a);
+  BValue c = fb.Not(b);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(c));
+
+  TimingEngine engine(f, *delay_estimator_);
+  XLS_ASSERT_OK(engine.Add(x.node(), 0));
+  XLS_ASSERT_OK(engine.Add(a.node(), 0));
+  XLS_ASSERT_OK(engine.Add(b.node(), 1));
+  XLS_ASSERT_OK(engine.Add(c.node(), 1));
+  EXPECT_EQ(engine.CriticalPathDelay(0), 1);
+  EXPECT_EQ(engine.CriticalPathDelay(1), 2);
+  EXPECT_EQ(engine.CriticalPathDelay(2), 0);
+  EXPECT_THAT(engine.CriticalPath(1), ElementsAre(b.node(), c.node()));
+
+  // Moving `b` into the first group lengthens it and shortens the second.
+  XLS_ASSERT_OK(engine.Add(b.node(), 0));
+  EXPECT_EQ(engine.group(b.node()), 0);
+  EXPECT_EQ(engine.CriticalPathDelay(0), 2);
+  EXPECT_EQ(engine.CriticalPathDelay(1), 1);
+  EXPECT_EQ(engine.CriticalPathDelay(), 2);
+}
+
+TEST_F(TimingEngineTest, RandomEditsMatchFromScratch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  std::vector<BValue> values = {fb.Param("x", p->GetBitsType(8)),
+                                fb.Param("y", p->GetBitsType(8))};
+  std::mt19937_64 rng(42);
+  for (int64_t i = 0; i < 40; ++i) {
+    BValue lhs = values[rng() % values.size()];
+    BValue rhs = values[rng() % values.size()];
+    values.push_back(i % 3 == 0 ? fb.Not(lhs) : fb.Add(lhs, rhs));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(values.back()));
+
+  TimingEngine engine(f, *delay_estimator_);
+  for (int64_t i = 0; i < 200; ++i) {
+    Node* node = values[rng() % values.size()].node();
+    switch (rng() % 4) {
+      case 0:
+        if (engine.contains(node)) {
+          XLS_ASSERT_OK(engine.Remove(node));
+        }
+        break;
+      case 1:
+        XLS_ASSERT_OK(engine.SetDelayOverride(node, rng() % 5));
+        break;
+      default:
+        XLS_ASSERT_OK(engine.Add(node, rng() % 3));
+        break;
+    }
+
+    TimingEngine expected(f, *delay_estimator_);
+    for (Node* n : TopoSort(f)) {
+      if (engine.contains(n)) {
+        XLS_ASSERT_OK(expected.SetDelayOverride(n, engine.NodeDelay(n)));
+        XLS_ASSERT_OK(expected.Add(n, engine.group(n)));
+      }
+    }
+    for (Node* n : f->nodes()) {
+      if (engine.contains(n)) {
+        EXPECT_EQ(engine.ArrivalTime(n), expected.ArrivalTime(n))
+            << n->GetName() << " after edit " << i;
+      }
+    }
+    for (int64_t group = 0; group < 3; ++group) {
+      EXPECT_EQ(engine.CriticalPathDelay(group),
+                expected.CriticalPathDelay(group));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace xls
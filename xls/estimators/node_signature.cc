@@ -0,0 +1,157 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/node_signature.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+std::optional<std::string> GetEstimatorNodeSignature(Node* node) {
+  if (node->function_base()->ForeignFunctionData().has_value()) {
+    return std::nullopt;
+  }
+  std::string attributes;
+  switch (node->op()) {
+    case Op::kAfterAll:
+    case Op::kAssert:
+    case Op::kCountedFor:
+    case Op::kCover:
+    case Op::kDynamicCountedFor:
+    case Op::kInputPort:
+    case Op::kInstantiationInput:
+    case Op::kInstantiationOutput:
+    case Op::kInvoke:
+    case Op::kMap:
+    case Op::kNext:
+    case Op::kOutputPort:
+    case Op::kParam:
+    case Op::kReceive:
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite:
+    case Op::kSend:
+    case Op::kStateRead:
+    case Op::kTrace:
+      return std::nullopt;
+    case Op::kArrayIndex:
+      attributes = absl::StrCat(node->As<ArrayIndex>()->assumed_in_bounds());
+      break;
+    case Op::kArrayUpdate:
+      attributes = absl::StrCat(node->As<ArrayUpdate>()->assumed_in_bounds());
+      break;
+    case Op::kBitSlice:
+      attributes = absl::StrCat(node->As<BitSlice>()->start());
+      break;
+    case Op::kLiteral:
+      attributes = node->As<Literal>()->value().ToString();
+      break;
+    case Op::kMinDelay:
+      attributes = absl::StrCat(node->As<MinDelay>()->delay());
+      break;
+    case Op::kOneHot:
+      attributes = absl::StrCat(
+          static_cast<int>(node->As<OneHot>()->priority()));
+      break;
+    case Op::kTupleIndex:
+      attributes = absl::StrCat(node->As<TupleIndex>()->index());
+      break;
+    // The remaining ops are fully described by their types and operands; for
+    // example the widths of ext, decode and dynamic_bit_slice are those of
+    // their result and whether a sel has a default follows from its operand
+    // count and selector width.
+    case Op::kAdd:
+    case Op::kAnd:
+    case Op::kAndReduce:
+    case Op::kArray:
+    case Op::kArrayConcat:
+    case Op::kArraySlice:
+    case Op::kBitSliceUpdate:
+    case Op::kConcat:
+    case Op::kDecode:
+    case Op::kDynamicBitSlice:
+    case Op::kEncode:
+    case Op::kEq:
+    case Op::kGate:
+    case Op::kIdentity:
+    case Op::kNand:
+    case Op::kNe:
+    case Op::kNeg:
+    case Op::kNor:
+    case Op::kNot:
+    case Op::kOneHotSel:
+    case Op::kOr:
+    case Op::kOrReduce:
+    case Op::kPrioritySel:
+    case Op::kReverse:
+    case Op::kSDiv:
+    case Op::kSGe:
+    case Op::kSGt:
+    case Op::kSLe:
+    case Op::kSLt:
+    case Op::kSMod:
+    case Op::kSMul:
+    case Op::kSMulp:
+    case Op::kSel:
+    case Op::kShll:
+    case Op::kShra:
+    case Op::kShrl:
+    case Op::kSignExt:
+    case Op::kSub:
+    case Op::kTuple:
+    case Op::kUDiv:
+    case Op::kUGe:
+    case Op::kUGt:
+    case Op::kULe:
+    case Op::kULt:
+    case Op::kUMod:
+    case Op::kUMul:
+    case Op::kUMulp:
+    case Op::kXor:
+    case Op::kXorReduce:
+    case Op::kZeroExt:
+      break;
+  }
+  std::string signature =
+      absl::StrCat(OpToString(node->op()), "(", attributes,
+                   "):", node->GetType()->ToString());
+  for (int64_t i = 0; i < node->operand_count(); ++i) {
+    Node* operand = node->operand(i);
+    absl::StrAppend(&signature, ";", operand->GetType()->ToString());
+    if (operand->Is<Literal>()) {
+      absl::StrAppend(&signature, "=",
+                      operand->As<Literal>()->value().ToString());
+    }
+    // Identify operands which repeat an earlier operand by that operand's
+    // index.
+    for (int64_t j = 0; j < i; ++j) {
+      if (node->operand(j) == operand) {
+        absl::StrAppend(&signature, "@", j);
+        break;
+      }
+    }
+  }
+  return signature;
+}
+
+}  // namespace xls
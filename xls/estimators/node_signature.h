@@ -0,0 +1,39 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_ESTIMATORS_NODE_SIGNATURE_H_
+#define XLS_ESTIMATORS_NODE_SIGNATURE_H_
+
+#include <optional>
+#include <string>
+
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Returns a string identifying the op of `node`, its result and operand types,
+// which operands are literals (and their values), which operands are repeated
+// and its op-specific attributes (e.g. the start of a bit slice). Nodes with
+// equal signatures have the same delay and area under the models in
+// xls/estimators, wherever they are, so estimators may memoize on it across
+// functions and packages.
+//
+// Returns std::nullopt if the estimate of `node` may depend on its context,
+// e.g. for parameters, ports, channel operations, calls and nodes of foreign
+// functions.
+std::optional<std::string> GetEstimatorNodeSignature(Node* node);
+
+}  // namespace xls
+
+#endif  // XLS_ESTIMATORS_NODE_SIGNATURE_H_
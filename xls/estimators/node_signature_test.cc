@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/estimators/node_signature.h"
+
+#include <memory>
+#include <optional>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+class NodeSignatureTest : public IrTestBase {};
+
+TEST_F(NodeSignatureTest, EqualAcrossPackages) {
+  std::unique_ptr<Package> p0 = CreatePackage();
+  std::unique_ptr<Package> p1 = CreatePackage();
+  FunctionBuilder fb0("f", p0.get());
+  BValue add0 = fb0.Add(fb0.Param("x", p0->GetBitsType(8)),
+                        fb0.Param("y", p0->GetBitsType(8)));
+  XLS_ASSERT_OK(fb0.BuildWithReturnValue(add0).status());
+  FunctionBuilder fb1("g", p1.get());
+  BValue add1 = fb1.Add(fb1.Param("a", p1->GetBitsType(8)),
+                        fb1.Param("b", p1->GetBitsType(8)));
+  XLS_ASSERT_OK(fb1.BuildWithReturnValue(add1).status());
+
+  ASSERT_TRUE(GetEstimatorNodeSignature(add0.node()).has_value());
+  EXPECT_EQ(GetEstimatorNodeSignature(add0.node()),
+            GetEstimatorNodeSignature(add1.node()));
+}
+
+TEST_F(NodeSignatureTest, DistinguishesOperandsAndAttributes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue add = fb.Add(x, y);
+  BValue add_self = fb.Add(x, x);
+  BValue add_one = fb.Add(x, fb.Literal(UBits(1, 8)));
+  BValue add_two = fb.Add(x, fb.Literal(UBits(2, 8)));
+  BValue low = fb.BitSlice(x, 0, 4);
+  BValue high = fb.BitSlice(x, 4, 4);
+  XLS_ASSERT_OK(
+      fb.BuildWithReturnValue(
+            fb.Tuple({add, add_self, add_one, add_two, low, high}))
+          .status());
+
+  EXPECT_NE(GetEstimatorNodeSignature(add.node()),
+            GetEstimatorNodeSignature(add_self.node()));
+  EXPECT_NE(GetEstimatorNodeSignature(add_one.node()),
+            GetEstimatorNodeSignature(add_two.node()));
+  EXPECT_NE(GetEstimatorNodeSignature(low.node()),
+            GetEstimatorNodeSignature(high.node()));
+}
+
+TEST_F(NodeSignatureTest, ContextDependentNodesHaveNoSignature) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK(fb.BuildWithReturnValue(fb.Not(x)).status());
+  EXPECT_EQ(GetEstimatorNodeSignature(x.node()), std::nullopt);
+}
+
+}  // namespace
+}  // namespace xls
@@ -16,10 +16,12 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
 
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/casts.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
@@ -57,6 +59,11 @@ class GrpcSynthesizer : public Synthesizer {
     return response.slack_ps() == 0 ? 0 : clock_period_ps - response.slack_ps();
   }
 
+  std::string Fingerprint() const override {
+    return absl::StrFormat("%s\n%s\n%d", name(), params_.server_and_port(),
+                           params_.frequency_hz());
+  }
+
  private:
   const GrpcSynthesizerParameters params_;
 };
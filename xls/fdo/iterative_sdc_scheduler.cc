@@ -37,6 +37,8 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_engine.h"
 #include "xls/fdo/delay_manager.h"
 #include "xls/fdo/node_cut.h"
 #include "xls/fdo/synthesizer.h"
@@ -163,6 +165,20 @@ absl::Status GetMergedWindows(const std::vector<PathInfo> &paths,
   return absl::OkStatus();
 }
 
+// Reports the delay of each node recorded in a delay manager.
+class DelayManagerNodeDelays : public DelayEstimator {
+ public:
+  explicit DelayManagerNodeDelays(const DelayManager &delay_manager)
+      : DelayEstimator("delay_manager"), delay_manager_(delay_manager) {}
+
+  absl::StatusOr<int64_t> GetOperationDelayInPs(Node *node) const override {
+    return delay_manager_.GetNodeDelay(node);
+  }
+
+ private:
+  const DelayManager &delay_manager_;
+};
+
 // Refines the delay estimations recorded in the given delay manager with
 // low-level feedback from the given synthesizer.
 //
@@ -403,6 +419,8 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
   std::mt19937_64 bit_gen;
   absl::flat_hash_set<Node *> dead_after_synthesis =
       GetDeadAfterSynthesisNodes(f);
+  DelayManagerNodeDelays node_delays(delay_manager);
+  TimingEngine stage_timing(f, node_delays);
   for (int64_t i = 0; i < options.iteration_number; ++i) {
     IterativeSDCSchedulingModel model(f, dead_after_synthesis, delay_manager);
 
@@ -476,6 +494,28 @@ absl::StatusOr<ScheduleCycleMap> ScheduleByIterativeSDC(
     path_extract_options.cycle_map = &cycle_map;
     XLS_RET_CHECK_OK(UpdateStats(prev_cycle_map, cycle_map, f, i));
 
+    // Bring the stage timing up to date with the nodes which changed stage
+    // and the node delays refined by the previous iteration.
+    int64_t moved_count = 0;
+    for (Node *node : f->nodes()) {
+      if (dead_after_synthesis.contains(node)) {
+        continue;
+      }
+      const int64_t cycle = cycle_map.at(node);
+      if (!stage_timing.contains(node) || stage_timing.group(node) != cycle) {
+        XLS_RETURN_IF_ERROR(stage_timing.Add(node, cycle));
+        ++moved_count;
+      }
+      XLS_ASSIGN_OR_RETURN(int64_t node_delay,
+                           delay_manager.GetNodeDelay(node));
+      if (stage_timing.NodeDelay(node) != node_delay) {
+        XLS_RETURN_IF_ERROR(stage_timing.SetDelayOverride(node, node_delay));
+      }
+    }
+    VLOG(1) << "SDC iteration " << i << " moved " << moved_count
+            << " nodes; longest stage path by node delays is "
+            << stage_timing.CriticalPathDelay() << "ps";
+
     // Report the current estimated critical path delay.
     XLS_ASSIGN_OR_RETURN(PathInfo critical_path,
                          delay_manager.GetLongestPath(path_extract_options));
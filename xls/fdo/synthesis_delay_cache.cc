@@ -0,0 +1,65 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesis_delay_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/strip.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+// Changing this string retires every existing entry, e.g. if the delay is
+// ever stored in a different unit or format.
+constexpr std::string_view kCacheFormat = "synthesis-delay-cache-1";
+
+}  // namespace
+
+std::string ComputeSynthesisDelayCacheKey(
+    std::string_view synthesizer_fingerprint, std::string_view top_module_name,
+    std::string_view verilog_text) {
+  return ContentAddressedDirectoryCache::ComputeKey(
+      {kCacheFormat, synthesizer_fingerprint, top_module_name, verilog_text});
+}
+
+std::optional<int64_t> LookupSynthesizedDelay(
+    ContentAddressedDirectoryCache& cache, std::string_view key) {
+  std::optional<std::string> contents = cache.Lookup(key);
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  int64_t delay;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(*contents), &delay)) {
+    cache.RecordUnusableEntry();
+    return std::nullopt;
+  }
+  return delay;
+}
+
+absl::Status StoreSynthesizedDelay(ContentAddressedDirectoryCache& cache,
+                                   std::string_view key, int64_t delay) {
+  return cache.Store(key, absl::StrCat(delay, "\n"));
+}
+
+}  // namespace synthesis
+}  // namespace xls
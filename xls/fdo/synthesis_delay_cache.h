@@ -0,0 +1,62 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FDO_SYNTHESIS_DELAY_CACHE_H_
+#define XLS_FDO_SYNTHESIS_DELAY_CACHE_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+
+namespace xls {
+namespace synthesis {
+
+// Describes a persistent cache of synthesized delays, so FDO can skip
+// re-synthesizing a cut it (or a previous invocation) has already
+// synthesized. Entries are also kept in memory.
+//
+// The key does not capture the version of the synthesis tools beyond what the
+// synthesizer fingerprint describes, so a cache directory should not be shared
+// between different tool installations with the same paths.
+inline constexpr ContentAddressedDirectoryCache::Options
+    kSynthesisDelayCacheOptions = {
+        .directory_env_var = "XLS_SYNTHESIS_CACHE_DIR",
+        .extension = ".delay",
+        .description = "synthesized delay",
+        .keep_in_memory = true};
+
+// Returns the key of synthesizing `verilog_text` (whose top module is
+// `top_module_name`) with the synthesizer described by
+// `synthesizer_fingerprint`.
+std::string ComputeSynthesisDelayCacheKey(
+    std::string_view synthesizer_fingerprint, std::string_view top_module_name,
+    std::string_view verilog_text);
+
+// Returns the delay stored in `cache` under `key`, or std::nullopt if there is
+// none or it can't be parsed.
+std::optional<int64_t> LookupSynthesizedDelay(
+    ContentAddressedDirectoryCache& cache, std::string_view key);
+
+// Stores `delay` in `cache` under `key`.
+absl::Status StoreSynthesizedDelay(ContentAddressedDirectoryCache& cache,
+                                   std::string_view key, int64_t delay);
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_FDO_SYNTHESIS_DELAY_CACHE_H_
@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fdo/synthesis_delay_cache.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls::synthesis {
+namespace {
+
+TEST(SynthesisDelayCacheTest, KeyDependsOnAllComponents) {
+  std::string key =
+      ComputeSynthesisDelayCacheKey("yosys", "tmp_module", "module m;");
+  EXPECT_EQ(ComputeSynthesisDelayCacheKey("yosys", "tmp_module", "module m;"),
+            key);
+  EXPECT_NE(ComputeSynthesisDelayCacheKey("grpc", "tmp_module", "module m;"),
+            key);
+  EXPECT_NE(ComputeSynthesisDelayCacheKey("yosys", "other", "module m;"), key);
+  EXPECT_NE(ComputeSynthesisDelayCacheKey("yosys", "tmp_module", "module n;"),
+            key);
+}
+
+TEST(SynthesisDelayCacheTest, DelayRoundTrips) {
+  ContentAddressedDirectoryCache cache(kSynthesisDelayCacheOptions);
+  EXPECT_EQ(LookupSynthesizedDelay(cache, "abc"), std::nullopt);
+  XLS_ASSERT_OK(StoreSynthesizedDelay(cache, "abc", 1234));
+  EXPECT_EQ(LookupSynthesizedDelay(cache, "abc"),
+            std::optional<int64_t>(1234));
+  EXPECT_EQ(cache.Lookup("abc"), std::optional<std::string>("1234\n"));
+}
+
+TEST(SynthesisDelayCacheTest, UnparsableDelayIsAMiss) {
+  ContentAddressedDirectoryCache cache(kSynthesisDelayCacheOptions);
+  XLS_ASSERT_OK(cache.Store("abc", "fast"));
+  EXPECT_EQ(LookupSynthesizedDelay(cache, "abc"), std::nullopt);
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+}  // namespace
+}  // namespace xls::synthesis
@@ -22,12 +22,15 @@
 #include <utility>
 #include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/extract_stage.h"
@@ -93,12 +96,13 @@ absl::StatusOr<SynthesizedDelayDiff> SynthesizeAndGetDelayDiff(
   };
 }
 
-absl::StatusOr<SynthesizedDelayDiff> CreateDelayDiffForStage(
-    FunctionBase* f, const PipelineSchedule& schedule,
-    const DelayEstimator& delay_estimator, synthesis::Synthesizer* synthesizer,
-    int stage) {
-  XLS_ASSIGN_OR_RETURN(Function * stage_function,
-                       ExtractStage(f, schedule, stage));
+namespace {
+
+// Analyzes (and, with a `synthesizer`, synthesizes) one stage which has already
+// been extracted into `stage_function`.
+absl::StatusOr<SynthesizedDelayDiff> CreateDelayDiffForStageFunction(
+    Function* stage_function, const DelayEstimator& delay_estimator,
+    synthesis::Synthesizer* synthesizer) {
   XLS_ASSIGN_OR_RETURN(
       std::vector<CriticalPathEntry> critical_path,
       AnalyzeCriticalPath(stage_function, /*clock_period_ps=*/std::nullopt,
@@ -114,20 +118,58 @@ absl::StatusOr<SynthesizedDelayDiff> CreateDelayDiffForStage(
   return diff;
 }
 
+}  // namespace
+
+absl::StatusOr<SynthesizedDelayDiff> CreateDelayDiffForStage(
+    FunctionBase* f, const PipelineSchedule& schedule,
+    const DelayEstimator& delay_estimator, synthesis::Synthesizer* synthesizer,
+    int stage) {
+  XLS_ASSIGN_OR_RETURN(Function * stage_function,
+                       ExtractStage(f, schedule, stage));
+  return CreateDelayDiffForStageFunction(stage_function, delay_estimator,
+                                         synthesizer);
+}
+
 absl::StatusOr<SynthesizedDelayDiffByStage> CreateDelayDiffByStage(
     FunctionBase* f, const PipelineSchedule& schedule,
-    const DelayEstimator& delay_estimator,
-    synthesis::Synthesizer* synthesizer) {
+    const DelayEstimator& delay_estimator, synthesis::Synthesizer* synthesizer,
+    ThreadPool* thread_pool) {
   SynthesizedDelayDiffByStage result;
   result.stage_diffs.reserve(schedule.length());
   result.stage_percent_diffs.resize(schedule.length());
-  for (int i = 0; i < schedule.length(); ++i) {
-    XLS_ASSIGN_OR_RETURN(
-        SynthesizedDelayDiff stage_diff,
-        CreateDelayDiffForStage(f, schedule, delay_estimator, synthesizer, i));
+  if (thread_pool == nullptr) {
+    for (int i = 0; i < schedule.length(); ++i) {
+      XLS_ASSIGN_OR_RETURN(SynthesizedDelayDiff stage_diff,
+                           CreateDelayDiffForStage(f, schedule, delay_estimator,
+                                                   synthesizer, i));
+      result.stage_diffs.emplace_back(std::move(stage_diff));
+    }
+  } else {
+    // Extracting a stage adds a function to the package, so that part stays
+    // serial.
+    std::vector<Function*> stage_functions;
+    stage_functions.reserve(schedule.length());
+    for (int i = 0; i < schedule.length(); ++i) {
+      XLS_ASSIGN_OR_RETURN(stage_functions.emplace_back(),
+                           ExtractStage(f, schedule, i));
+    }
+    std::vector<absl::StatusOr<SynthesizedDelayDiff>> stage_diffs(
+        schedule.length());
+    for (int i = 0; i < schedule.length(); ++i) {
+      thread_pool->Schedule([&, i]() {
+        stage_diffs[i] = CreateDelayDiffForStageFunction(
+            stage_functions[i], delay_estimator, synthesizer);
+      });
+    }
+    thread_pool->WaitForIdle();
+    for (absl::StatusOr<SynthesizedDelayDiff>& stage_diff : stage_diffs) {
+      XLS_RETURN_IF_ERROR(stage_diff.status());
+      result.stage_diffs.emplace_back(*std::move(stage_diff));
+    }
+  }
+  for (const SynthesizedDelayDiff& stage_diff : result.stage_diffs) {
     result.total_diff.synthesized_delay_ps += stage_diff.synthesized_delay_ps;
     result.total_diff.xls_delay_ps += stage_diff.xls_delay_ps;
-    result.stage_diffs.emplace_back(std::move(stage_diff));
   }
   for (int i = 0; i < schedule.length(); ++i) {
     const SynthesizedDelayDiff& stage_diff = result.stage_diffs[i];
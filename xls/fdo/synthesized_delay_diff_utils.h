@@ -23,6 +23,7 @@
 #include <vector>
 
 #include "absl/status/statusor.h"
+#include "xls/common/thread_pool.h"
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
@@ -83,9 +84,15 @@ absl::StatusOr<SynthesizedDelayDiff> CreateDelayDiffForStage(
 // non-null, this function also synthesizes each stage and populates the
 // synthesized delays. This function does not currently populate the
 // `critical_path` of the `total_diff`.
+//
+// If `thread_pool` is non-null, the stages are extracted serially and then
+// analyzed (and synthesized) concurrently on the pool, in which case
+// `delay_estimator` and `synthesizer` must be safe for concurrent use (e.g. a
+// `CachingDelayEstimator`). The result does not depend on the pool.
 absl::StatusOr<SynthesizedDelayDiffByStage> CreateDelayDiffByStage(
     FunctionBase* f, const PipelineSchedule& schedule,
-    const DelayEstimator& delay_estimator, synthesis::Synthesizer* synthesizer);
+    const DelayEstimator& delay_estimator, synthesis::Synthesizer* synthesizer,
+    ThreadPool* thread_pool = nullptr);
 
 // Converts the given diff to a human-readable format that is an expanded form
 // of what `CriticalPathToString` would return.
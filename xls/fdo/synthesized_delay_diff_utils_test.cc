@@ -25,7 +25,9 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
 #include "xls/estimators/delay_model/analyze_critical_path.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_test_base.h"
@@ -173,6 +175,24 @@ TEST_F(SynthesizedDelayDiffUtilsTest, CreateDelayDiffByStageWithoutSynthesis) {
   EXPECT_EQ(diff.stage_percent_diffs[2].synthesized_percent, 0);
 }
 
+TEST_F(SynthesizedDelayDiffUtilsTest, CreateDelayDiffByStageOnThreadPool) {
+  CachingDelayEstimator caching_estimator("caching", delay_estimator_);
+  ThreadPool thread_pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      SynthesizedDelayDiffByStage diff,
+      CreateDelayDiffByStage(f_, *schedule_, caching_estimator,
+                             /*synthesizer=*/nullptr, &thread_pool));
+  EXPECT_EQ(diff.total_diff.xls_delay_ps, 5);
+  EXPECT_EQ(diff.max_stage_percent_diff_abs, 60.0);
+  ASSERT_EQ(diff.stage_diffs.size(), 3);
+  EXPECT_EQ(diff.stage_diffs[0].critical_path.size(), 4);
+  EXPECT_EQ(diff.stage_diffs[0].xls_delay_ps, 3);
+  EXPECT_EQ(diff.stage_diffs[1].critical_path.size(), 2);
+  EXPECT_EQ(diff.stage_diffs[1].xls_delay_ps, 1);
+  EXPECT_EQ(diff.stage_diffs[2].critical_path.size(), 2);
+  EXPECT_EQ(diff.stage_diffs[2].xls_delay_ps, 1);
+}
+
 TEST_F(SynthesizedDelayDiffUtilsTest, SynthesizedDelayDiffToString) {
   XLS_ASSERT_OK_AND_ASSIGN(
       std::vector<CriticalPathEntry> critical_path,
@@ -24,8 +24,10 @@
 
 #include "absl/base/no_destructor.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
@@ -34,13 +36,16 @@
 #include "xls/codegen/codegen_options.h"
 #include "xls/codegen/codegen_pass.h"
 #include "xls/common/casts.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/common/thread.h"
+#include "xls/common/thread_pool.h"
 #include "xls/fdo/extract_nodes.h"
+#include "xls/fdo/synthesis_delay_cache.h"
 #include "xls/ir/block.h"
 #include "xls/ir/function.h"
 #include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
 
@@ -50,24 +55,28 @@ namespace synthesis {
 absl::StatusOr<std::vector<int64_t>>
 Synthesizer::SynthesizeNodesConcurrentlyAndGetDelays(
     absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const {
+  std::vector<absl::StatusOr<int64_t>> results(nodes_list.size(), 0);
+  if (nodes_list.empty()) {
+    return std::vector<int64_t>();
+  }
+
   // Launches multi-threading delay estimation.
-  std::vector<absl::StatusOr<int64_t>> results;
-  std::vector<std::unique_ptr<Thread>> threads;
-  results.reserve(nodes_list.size());
-  absl::StatusOr<int64_t> init_val = 0;
-  for (const absl::flat_hash_set<Node *> &nodes : nodes_list) {
-    results.push_back(init_val);
-    absl::StatusOr<int64_t> &dest = results.back();
-    // TODO(hanchenye): 2023-08-14 Use a thread pool structure that we can
-    // schedule on.
-    threads.push_back(std::make_unique<Thread>(
-        [&]() { dest = SynthesizeNodesAndGetDelay(nodes); }));
+  const int64_t num_jobs = nodes_list.size();
+  int64_t num_threads = num_jobs;
+  if (max_concurrency_ > 0 && max_concurrency_ < num_threads) {
+    num_threads = max_concurrency_;
+  }
+  {
+    ThreadPool pool(num_threads);
+    for (int64_t i = 0; i < num_jobs; ++i) {
+      pool.Schedule([this, &results, &nodes_list, i]() {
+        results[i] = SynthesizeNodesAndGetDelay(nodes_list[i]);
+      });
+    }
+    pool.WaitForIdle();
   }
 
   // Records the estimated delays.
-  for (auto &t : threads) {
-    t->Join();
-  }
   std::vector<int64_t> delay_list;
   delay_list.reserve(results.size());
   for (absl::StatusOr<int64_t> result : results) {
@@ -83,12 +92,19 @@ absl::StatusOr<int64_t> Synthesizer::SynthesizeNodesAndGetDelay(
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> tmp_package,
                        ExtractNodes(nodes, top_name));
   XLS_ASSIGN_OR_RETURN(Function * f, tmp_package->GetFunction(top_name));
+  // The extracted nodes keep the names they have in the original function.
+  // Rename them by position so the generated Verilog (and hence the cache key)
+  // depends only on the structure of the nodes.
+  int64_t index = 0;
+  for (Node *node : TopoSort(f)) {
+    node->SetNameDirectly(absl::StrCat("n", index++));
+  }
   XLS_ASSIGN_OR_RETURN(std::string verilog_text,
                        FunctionBaseToVerilog(f, /*flop_inputs_outputs=*/true));
   if (verilog_text.empty()) {
     return 0;
   }
-  return SynthesizeVerilogAndGetDelay(verilog_text, top_name);
+  return SynthesizeVerilogWithCache(verilog_text, top_name);
 }
 
 absl::StatusOr<int64_t> Synthesizer::SynthesizeFunctionBaseAndGetDelay(
@@ -98,7 +114,28 @@ absl::StatusOr<int64_t> Synthesizer::SynthesizeFunctionBaseAndGetDelay(
   if (verilog_text.empty()) {
     return 0;
   }
-  return SynthesizeVerilogAndGetDelay(verilog_text, f->name());
+  return SynthesizeVerilogWithCache(verilog_text, f->name());
+}
+
+absl::StatusOr<int64_t> Synthesizer::SynthesizeVerilogWithCache(
+    std::string_view verilog_text, std::string_view top_module_name) const {
+  if (delay_cache_ == nullptr) {
+    return SynthesizeVerilogAndGetDelay(verilog_text, top_module_name);
+  }
+  std::string key = ComputeSynthesisDelayCacheKey(
+      Fingerprint(), top_module_name, verilog_text);
+  if (std::optional<int64_t> delay = LookupSynthesizedDelay(*delay_cache_, key);
+      delay.has_value()) {
+    return *delay;
+  }
+  XLS_ASSIGN_OR_RETURN(
+      int64_t delay,
+      SynthesizeVerilogAndGetDelay(verilog_text, top_module_name));
+  if (absl::Status status = StoreSynthesizedDelay(*delay_cache_, key, delay);
+      !status.ok()) {
+    LOG(WARNING) << "Unable to cache synthesized delay: " << status;
+  }
+  return delay;
 }
 
 absl::StatusOr<std::string> Synthesizer::FunctionBaseToVerilog(
@@ -208,6 +245,9 @@ absl::StatusOr<synthesis::Synthesizer *> SetUpSynthesizer(
       std::unique_ptr<synthesis::Synthesizer> synthesizer,
       synthesis::GetSynthesizerManagerSingleton().MakeSynthesizer(
           flags.fdo_synthesizer_name(), flags));
+  synthesizer->set_max_concurrency(flags.fdo_synthesis_workers());
+  synthesizer->set_delay_cache(ContentAddressedDirectoryCache::GetDefault(
+      synthesis::kSynthesisDelayCacheOptions));
   return synthesizer.release();
 }
 
@@ -28,6 +28,8 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/fdo/synthesis_delay_cache.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -43,6 +45,24 @@ class Synthesizer {
 
   const std::string &name() const { return name_; }
 
+  // Returns a string identifying the synthesis flow and its configuration,
+  // used to key cached delays. Two synthesizers with the same fingerprint must
+  // produce the same delay for the same Verilog.
+  virtual std::string Fingerprint() const { return name_; }
+
+  // Sets the maximum number of synthesis jobs that
+  // `SynthesizeNodesConcurrentlyAndGetDelays` runs at once. Values of 0 or
+  // less run every job at once.
+  void set_max_concurrency(int64_t value) { max_concurrency_ = value; }
+  int64_t max_concurrency() const { return max_concurrency_; }
+
+  // Sets the cache consulted before (and updated after) synthesizing a set of
+  // nodes or a function. Not owned; may be null to disable caching.
+  void set_delay_cache(ContentAddressedDirectoryCache *cache) {
+    delay_cache_ = cache;
+  }
+  ContentAddressedDirectoryCache *delay_cache() const { return delay_cache_; }
+
   // Synthesizes the given Verilog module with a synthesis tool and return its
   // overall delay.
   virtual absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
@@ -53,9 +73,11 @@ class Synthesizer {
   // synthesis tool, and return its overall delay. The nodes set can be an
   // arbitrary subgraph or multiple disjointed subgraphs from a function or
   // proc. This function generates intermediate Verilog using
-  // `FunctionToVerilog` and calls `SynthesizeVerilogAndGetDelay`. A subclass
-  // may customize the behavior by overriding those functions; overriding this
-  // entire function is generally only necessary in tests.
+  // `FunctionToVerilog` and calls `SynthesizeVerilogAndGetDelay`. The nodes
+  // of the extracted function are renamed by position first, so structurally
+  // identical sets of nodes share a delay cache entry. A subclass may customize
+  // the behavior by overriding those functions; overriding this entire
+  // function is generally only necessary in tests.
   virtual absl::StatusOr<int64_t> SynthesizeNodesAndGetDelay(
       const absl::flat_hash_set<Node *> &nodes) const;
 
@@ -70,15 +92,23 @@ class Synthesizer {
   virtual absl::StatusOr<std::string> FunctionBaseToVerilog(
       FunctionBase *f, bool flop_inputs_outputs) const;
 
-  // Launches `SynthesizeNodesAndGetDelay` concurrently for each set of nodes
-  // listed in `nodes_list` and get their delays.
+  // Launches `SynthesizeNodesAndGetDelay` concurrently, at most
+  // `max_concurrency()` at a time, for each set of nodes listed in
+  // `nodes_list` and get their delays.
   absl::StatusOr<std::vector<int64_t>> SynthesizeNodesConcurrentlyAndGetDelays(
       absl::Span<const absl::flat_hash_set<Node *>> nodes_list) const;
 
  private:
+  // Calls `SynthesizeVerilogAndGetDelay` unless the delay cache already holds
+  // the delay of `verilog_text`.
+  absl::StatusOr<int64_t> SynthesizeVerilogWithCache(
+      std::string_view verilog_text, std::string_view top_module_name) const;
+
   // Records the name of the concreate synthesizer, e.g., yosys, for management
   // and debugging purpose.
   std::string name_;
+  int64_t max_concurrency_ = 0;
+  ContentAddressedDirectoryCache *delay_cache_ = nullptr;
 };
 
 // An abstract class of a synthesis service.
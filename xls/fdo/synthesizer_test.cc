@@ -14,16 +14,25 @@
 
 #include "xls/fdo/synthesizer.h"
 
+#include <atomic>
 #include <cstdint>
 #include <filesystem>  // NOLINT
+#include <memory>
 #include <string>
 #include <string_view>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/file/temp_directory.h"
 #include "xls/common/golden_files.h"
 #include "xls/common/status/matchers.h"
+#include "xls/fdo/synthesis_delay_cache.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/ir_test_base.h"
@@ -32,6 +41,9 @@
 namespace xls {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+using ::testing::ElementsAreArray;
+
 constexpr std::string_view kTestdataPath = "xls/fdo/testdata";
 
 class FakeSynthesizer : public synthesis::Synthesizer {
@@ -45,6 +57,24 @@ class FakeSynthesizer : public synthesis::Synthesizer {
   }
 };
 
+// Returns the length of the Verilog as the delay and counts its invocations.
+class CountingSynthesizer : public synthesis::Synthesizer {
+ public:
+  CountingSynthesizer() : synthesis::Synthesizer("CountingSynthesizer") {}
+
+  absl::StatusOr<int64_t> SynthesizeVerilogAndGetDelay(
+      std::string_view verilog_text,
+      std::string_view top_module_name) const override {
+    calls_.fetch_add(1);
+    return verilog_text.size();
+  }
+
+  int64_t calls() const { return calls_.load(); }
+
+ private:
+  mutable std::atomic<int64_t> calls_ = 0;
+};
+
 class SynthesizerTest : public IrTestBase {
  public:
   std::filesystem::path GoldenFilePath(std::string_view file_ext) {
@@ -118,5 +148,66 @@ fn test(i0: bits[3], i1: bits[3]) -> (bits[3], bits[3]) {
   ExpectEqualToGoldenFile(GoldenFilePath("vtxt"), actual_verilog_text);
 }
 
+constexpr std::string_view kTwoAddsIr = R"(
+package p
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  add.3: bits[8] = add(x, y, id=3)
+  ret neg.4: bits[8] = neg(add.3, id=4)
+}
+
+fn g(a: bits[8], b: bits[8]) -> bits[8] {
+  ret sum.7: bits[8] = add(a, b, id=7)
+}
+)";
+
+TEST_F(SynthesizerTest, SynthesizeNodesConcurrentlyKeepsOrder) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kTwoAddsIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  Node* add = FindNode("add.3", f);
+  Node* neg = FindNode("neg.4", f);
+  std::vector<absl::flat_hash_set<Node*>> nodes_list = {
+      {add}, {add, neg}, {neg}, {add}};
+
+  CountingSynthesizer synthesizer;
+  std::vector<int64_t> expected;
+  for (const absl::flat_hash_set<Node*>& nodes : nodes_list) {
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t delay,
+                             synthesizer.SynthesizeNodesAndGetDelay(nodes));
+    expected.push_back(delay);
+  }
+  synthesizer.set_max_concurrency(2);
+  EXPECT_THAT(synthesizer.SynthesizeNodesConcurrentlyAndGetDelays(nodes_list),
+              IsOkAndHolds(ElementsAreArray(expected)));
+  EXPECT_EQ(synthesizer.calls(), 2 * static_cast<int64_t>(nodes_list.size()));
+}
+
+TEST_F(SynthesizerTest, StructurallyIdenticalNodesShareCacheEntry) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(kTwoAddsIr));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, package->GetFunction("g"));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ContentAddressedDirectoryCache> cache,
+      ContentAddressedDirectoryCache::Create(
+          temp_dir.path(), synthesis::kSynthesisDelayCacheOptions));
+
+  CountingSynthesizer synthesizer;
+  synthesizer.set_delay_cache(cache.get());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      int64_t f_delay,
+      synthesizer.SynthesizeNodesAndGetDelay({FindNode("add.3", f)}));
+  EXPECT_EQ(synthesizer.calls(), 1);
+  EXPECT_THAT(synthesizer.SynthesizeNodesAndGetDelay({FindNode("sum.7", g)}),
+              IsOkAndHolds(f_delay));
+  EXPECT_EQ(synthesizer.calls(), 1);
+  EXPECT_EQ(cache->hits(), 1);
+
+  // A different cut is synthesized.
+  XLS_ASSERT_OK(
+      synthesizer.SynthesizeNodesAndGetDelay({FindNode("neg.4", f)}).status());
+  EXPECT_EQ(synthesizer.calls(), 2);
+}
+
 }  // namespace
 }  // namespace xls
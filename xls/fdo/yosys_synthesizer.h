@@ -21,6 +21,8 @@
 #include <string_view>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/synthesis/yosys/yosys_synthesis_service.h"
@@ -41,6 +43,9 @@ class YosysSynthesizer : public Synthesizer {
                             std::string_view default_driver_cell,
                             std::string_view default_load)
       : Synthesizer("yosys"),
+        fingerprint_(absl::StrJoin({yosys_path, sta_path, synthesis_libraries,
+                                    default_driver_cell, default_load},
+                                   "\n")),
         service_(yosys_path, /*nextpnr_path=*/"", /*synthesis_target=*/"",
                  sta_path, synthesis_libraries, synthesis_libraries,
                  default_driver_cell, default_load,
@@ -51,7 +56,13 @@ class YosysSynthesizer : public Synthesizer {
       std::string_view verilog_text,
       std::string_view top_module_name) const override;
 
+  std::string Fingerprint() const override {
+    return absl::StrCat(name(), "\n", fingerprint_);
+  }
+
  private:
+  // The tool paths, libraries and cells the delays depend on.
+  std::string fingerprint_;
   YosysSynthesisServiceImpl service_;
 };
 
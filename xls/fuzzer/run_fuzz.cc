@@ -14,7 +14,11 @@
 
 #include "xls/fuzzer/run_fuzz.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <array>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
@@ -48,6 +52,8 @@
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/cpp_run_fuzz.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_coverage.h"
+#include "xls/fuzzer/sample_dedup.h"
 #include "xls/fuzzer/sample_generator.h"
 #include "xls/fuzzer/sample_runner.h"
 #include "xls/fuzzer/sample_summary.pb.h"
@@ -174,11 +180,53 @@ absl::StatusOr<std::filesystem::path> SaveCrasher(
   return sample_crasher_dir;
 }
 
+// Records that a crasher minimizing to `minimized_ir` has been saved in
+// `crasher_dir`. Returns false if such a crasher had already been recorded,
+// possibly by another fuzzer process sharing `crasher_dir`.
+absl::StatusOr<bool> RecordMinimizedCrasher(
+    const std::filesystem::path& crasher_dir, std::string_view minimized_ir) {
+  std::array<char, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(minimized_ir.data()),
+         minimized_ir.size(), reinterpret_cast<uint8_t*>(digest.data()));
+  std::filesystem::path known_dir = crasher_dir / "known_minimized_ir";
+  XLS_RETURN_IF_ERROR(RecursivelyCreateDir(known_dir));
+  std::filesystem::path marker =
+      known_dir / absl::BytesToHexString({digest.data(), digest.size()});
+  // Creating the marker exclusively makes the check atomic across processes.
+  int fd = open(marker.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+  if (fd < 0) {
+    if (errno == EEXIST) {
+      return false;
+    }
+    return absl::ErrnoToStatus(
+        errno, absl::StrCat("Unable to create ", marker.string()));
+  }
+  close(fd);
+  return true;
+}
+
 }  // namespace
 
+absl::StatusOr<Sample> GenerateOrMutateSample(
+    dslx::FileTable& file_table, absl::BitGenRef bit_gen,
+    const dslx::AstGeneratorOptions& ast_generator_options,
+    const SampleOptions& sample_options, CoverageFeedback* feedback) {
+  if (feedback != nullptr) {
+    if (std::optional<Sample> parent = feedback->ChooseParent(bit_gen)) {
+      absl::StatusOr<Sample> mutant = MutateSample(*parent, bit_gen);
+      if (!absl::IsNotFound(mutant.status())) {
+        return mutant;
+      }
+    }
+  }
+  return GenerateSample(ast_generator_options, sample_options, bit_gen,
+                        file_table);
+}
+
 absl::Status RunSample(const Sample& smp, const std::filesystem::path& run_dir,
                        const std::optional<std::filesystem::path>& summary_file,
-                       std::optional<absl::Duration> generate_sample_elapsed) {
+                       std::optional<absl::Duration> generate_sample_elapsed,
+                       SampleDeduplicator* deduplicator) {
   XLS_ASSIGN_OR_RETURN(std::filesystem::path sample_runner_main_path,
                        GetXlsRunfilePath(kSampleRunnerMainPath));
 
@@ -226,6 +274,7 @@ cd "$RUNDIR"
   VLOG(1) << "Starting to run sample";
   VLOG(2) << smp.input_text();
   SampleRunner runner(run_dir);
+  runner.set_deduplicator(deduplicator);
   XLS_RETURN_IF_ERROR(runner.RunFromFiles(sample_file_name, options_file_name,
                                           testvector_path));
 
@@ -256,20 +305,42 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
     const SampleOptions& sample_options, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_file,
-    bool force_failure) {
+    bool force_failure, bool dedup_crashers, CoverageFeedback* feedback,
+    SampleDeduplicator* deduplicator) {
   Stopwatch stopwatch;
   XLS_ASSIGN_OR_RETURN(
-      Sample smp, GenerateSample(ast_generator_options, sample_options, bit_gen,
-                                 file_table));
+      Sample smp, GenerateOrMutateSample(file_table, bit_gen,
+                                         ast_generator_options, sample_options,
+                                         feedback));
   absl::Duration generate_sample_elapsed = stopwatch.GetElapsedTime();
 
-  absl::Status status =
-      RunSample(smp, run_dir, summary_file, generate_sample_elapsed);
+  XLS_RETURN_IF_ERROR(RunGeneratedSample(
+      smp, generate_sample_elapsed, sample_options, run_dir, crasher_dir,
+      summary_file, force_failure, dedup_crashers, feedback, deduplicator));
+  return smp;
+}
+
+absl::Status RunGeneratedSample(
+    const Sample& smp, absl::Duration generate_sample_elapsed,
+    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir,
+    const std::optional<std::filesystem::path>& summary_file,
+    bool force_failure, bool dedup_crashers, CoverageFeedback* feedback,
+    SampleDeduplicator* deduplicator) {
+  absl::Status status = RunSample(smp, run_dir, summary_file,
+                                  generate_sample_elapsed, deduplicator);
   if (force_failure) {
     status = absl::InternalError("Forced sample failure.");
   }
   if (status.ok()) {
-    return smp;
+    if (feedback != nullptr) {
+      XLS_ASSIGN_OR_RETURN(int64_t new_points,
+                           feedback->RecordRunDir(smp, run_dir));
+      VLOG(1) << absl::StreamFormat(
+          "Sample covered %d new points (%d in total)", new_points,
+          feedback->covered_points());
+    }
+    return absl::OkStatus();
   }
 
   LOG(ERROR) << "Sample failed: " << status;
@@ -291,6 +362,17 @@ absl::StatusOr<Sample> GenerateSampleAndRun(
         LOG(INFO) << "...minimization successful; output at "
                   << *minimized_path;
         std::filesystem::copy(*minimized_path, sample_crasher_dir);
+        if (dedup_crashers) {
+          XLS_ASSIGN_OR_RETURN(std::string minimized_ir,
+                               GetFileContents(*minimized_path));
+          XLS_ASSIGN_OR_RETURN(
+              bool is_new, RecordMinimizedCrasher(*crasher_dir, minimized_ir));
+          if (!is_new) {
+            LOG(INFO) << "...minimized IR matches a known crasher; discarding "
+                      << sample_crasher_dir;
+            XLS_RETURN_IF_ERROR(RecursivelyDeletePath(sample_crasher_dir));
+          }
+        }
       } else {
         LOG(INFO) << "...minimization failed.";
       }
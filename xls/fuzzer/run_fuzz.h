@@ -25,6 +25,8 @@
 #include "xls/dslx/frontend/pos.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_coverage.h"
+#include "xls/fuzzer/sample_dedup.h"
 
 namespace xls {
 
@@ -32,19 +34,53 @@ namespace xls {
 // summary will be appended to this file; if `generate_sample_elapsed` is also
 // given, it will be recorded in the timings in the sample summary.
 //
+// If `deduplicator` is given, code generation and simulation are skipped for
+// a sample whose optimized IR duplicates that of a sample recorded in it.
+//
 // `run_dir` must be an empty directory.
 absl::Status RunSample(
     const Sample& smp, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt);
+    std::optional<absl::Duration> generate_sample_elapsed = std::nullopt,
+    SampleDeduplicator* deduplicator = nullptr);
 
+// Returns a mutation of a sample from the corpus of `feedback` if it chooses
+// one (and `feedback` is given), and otherwise a newly generated sample.
+absl::StatusOr<Sample> GenerateOrMutateSample(
+    dslx::FileTable& file_table, absl::BitGenRef bit_gen,
+    const dslx::AstGeneratorOptions& ast_generator_options,
+    const SampleOptions& sample_options, CoverageFeedback* feedback = nullptr);
+
+// Runs a sample returned by GenerateOrMutateSample in `run_dir`, handling its
+// failure or recording its coverage as GenerateSampleAndRun does. This lets
+// samples be generated ahead of, and on other threads than, running them.
+absl::Status RunGeneratedSample(
+    const Sample& smp, absl::Duration generate_sample_elapsed,
+    const SampleOptions& sample_options, const std::filesystem::path& run_dir,
+    const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
+    const std::optional<std::filesystem::path>& summary_file = std::nullopt,
+    bool force_failure = false, bool dedup_crashers = false,
+    CoverageFeedback* feedback = nullptr,
+    SampleDeduplicator* deduplicator = nullptr);
+
+// Generates a sample and runs it in `run_dir`. If the sample fails and
+// `crasher_dir` is given, the sample is saved there along with its minimized
+// IR (if minimization succeeds). If `dedup_crashers` is also true, a crasher
+// whose minimized IR matches that of a crasher previously saved in
+// `crasher_dir` is discarded; the sample's failure is still returned.
+//
+// If `feedback` is given, the sample may instead be a mutation of a sample
+// from its corpus, and the coverage of passing samples is recorded in it. If
+// `deduplicator` is given, it is used as in RunSample.
 absl::StatusOr<Sample> GenerateSampleAndRun(
     dslx::FileTable& file_table, absl::BitGenRef bit_gen,
     const dslx::AstGeneratorOptions& ast_generator_options,
     const SampleOptions& sample_options, const std::filesystem::path& run_dir,
     const std::optional<std::filesystem::path>& crasher_dir = std::nullopt,
     const std::optional<std::filesystem::path>& summary_file = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, bool dedup_crashers = false,
+    CoverageFeedback* feedback = nullptr,
+    SampleDeduplicator* deduplicator = nullptr);
 
 }  // namespace xls
 
@@ -14,24 +14,33 @@
 
 #include "xls/fuzzer/run_fuzz_multiprocess.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <random>
 #include <string>
 #include <string_view>
+#include <system_error>  // NOLINT
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
 #include "absl/random/random.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/status/status_macros.h"
@@ -41,6 +50,8 @@
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/run_fuzz.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_coverage.h"
+#include "xls/fuzzer/sample_dedup.h"
 
 namespace xls {
 namespace {
@@ -49,15 +60,267 @@ static constexpr std::string_view kBlueText = "\033[34m";
 static constexpr std::string_view kRedText = "\033[31m";
 static constexpr std::string_view kDefaultColor = "\033[0m";
 
+// Returns the path of the file recording the progress of worker
+// `worker_number` (of `worker_count`) on `shard`.
+std::filesystem::path CheckpointPath(const FuzzShardOptions& shard,
+                                     int64_t worker_count,
+                                     int64_t worker_number) {
+  return *shard.checkpoint_dir /
+         absl::StrFormat("shard%d-of-%d_worker%d-of-%d.checkpoint",
+                         shard.shard_index, shard.shard_count, worker_number,
+                         worker_count);
+}
+
+// Returns the number of samples the worker owning `checkpoint` has finished,
+// or zero if it has not recorded any.
+absl::StatusOr<int64_t> ReadCheckpoint(
+    const std::filesystem::path& checkpoint) {
+  if (!std::filesystem::exists(checkpoint)) {
+    return 0;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(checkpoint));
+  int64_t finished;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(contents), &finished) ||
+      finished < 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Malformed fuzzer checkpoint %s: `%s`", checkpoint.string(), contents));
+  }
+  return finished;
+}
+
+absl::Status WriteCheckpoint(const std::filesystem::path& checkpoint,
+                             int64_t finished) {
+  // Write to a temporary file and rename it into place so that a worker
+  // preempted mid-write never leaves a truncated checkpoint behind.
+  std::filesystem::path temp_path = checkpoint;
+  temp_path += ".tmp";
+  XLS_RETURN_IF_ERROR(SetFileContents(temp_path, absl::StrCat(finished, "\n")));
+  std::error_code ec;
+  std::filesystem::rename(temp_path, checkpoint, ec);
+  if (ec) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to write fuzzer checkpoint %s: %s",
+                        checkpoint.string(), ec.message()));
+  }
+  return absl::OkStatus();
+}
+
+// Returns the number of samples of a job with `sample_count` samples run by
+// worker `worker_number` (of `worker_count`) on `shard`. Worker `w` runs the
+// shard's samples `w`, `w + worker_count`, `w + 2 * worker_count`, ...
+int64_t ShardWorkerSampleCount(const FuzzShardOptions& shard,
+                               int64_t sample_count, int64_t worker_count,
+                               int64_t worker_number) {
+  int64_t shard_samples = std::max<int64_t>(
+      0, (sample_count - shard.shard_index + shard.shard_count - 1) /
+             shard.shard_count);
+  return std::max<int64_t>(
+      0, (shard_samples - worker_number + worker_count - 1) / worker_count);
+}
+
+// Returns the index within the whole sharded job of sample number `sample`
+// of worker `worker_number` (of `worker_count`) on `shard`.
+int64_t GlobalSampleIndex(const FuzzShardOptions& shard, int64_t worker_count,
+                          int64_t worker_number, int64_t sample) {
+  return shard.shard_index +
+         (worker_number + sample * worker_count) * shard.shard_count;
+}
+
+// A generated sample, or the error from generating it, along with how long
+// generating it took.
+struct GeneratedSample {
+  absl::StatusOr<Sample> sample;
+  absl::Duration elapsed;
+};
+
+// Generates the samples of one worker. Samples must be generated in order, as
+// an unsharded worker draws all of its samples from one RNG.
+class WorkerSampleGenerator {
+ public:
+  WorkerSampleGenerator(int64_t worker_number, int64_t worker_count,
+                        const dslx::AstGeneratorOptions& ast_generator_options,
+                        const SampleOptions& sample_options,
+                        const std::optional<uint64_t>& seed,
+                        CoverageFeedback* feedback,
+                        const std::optional<FuzzShardOptions>& shard)
+      : worker_number_(worker_number),
+        worker_count_(worker_count),
+        ast_generator_options_(ast_generator_options),
+        sample_options_(sample_options),
+        seed_(seed),
+        feedback_(feedback),
+        shard_(shard) {
+    uint64_t rng_seed;
+    if (seed.has_value()) {
+      // Set seed deterministically based on the worker number so different
+      // workers generate different samples.
+      rng_seed = *seed + worker_number;
+    } else {
+      // Choose a nondeterministic seed.
+      rng_seed = absl::Uniform<uint64_t>(absl::BitGen());
+      LOG(INFO) << kBlueText << "--- NOTE: Worker #" << worker_number
+                << " chose a nondeterministic seed for value generation: "
+                << absl::StreamFormat("0x%16X", rng_seed) << kDefaultColor;
+    }
+    rng_.seed(rng_seed);
+  }
+
+  GeneratedSample Generate(int64_t sample) {
+    if (shard_.has_value()) {
+      rng_.seed(*seed_ + GlobalSampleIndex(*shard_, worker_count_,
+                                           worker_number_, sample));
+    }
+    Stopwatch stopwatch;
+    absl::StatusOr<Sample> smp =
+        GenerateOrMutateSample(file_table_, rng_, ast_generator_options_,
+                               sample_options_, feedback_);
+    return GeneratedSample{.sample = std::move(smp),
+                           .elapsed = stopwatch.GetElapsedTime()};
+  }
+
+ private:
+  const int64_t worker_number_;
+  const int64_t worker_count_;
+  const dslx::AstGeneratorOptions& ast_generator_options_;
+  const SampleOptions& sample_options_;
+  const std::optional<uint64_t> seed_;
+  CoverageFeedback* const feedback_;
+  const std::optional<FuzzShardOptions>& shard_;
+  std::mt19937_64 rng_;
+  dslx::FileTable file_table_;
+};
+
+// Generates the samples of all workers ahead of time on separate generator
+// threads, so that workers only wait on generation when it falls behind.
+//
+// Each worker has a queue of at most `queue_depth` generated samples.
+// Generator `g` (of `generator_count`) keeps the queues of workers `g`,
+// `g + generator_count`, ... filled, generating each worker's samples in
+// order, so the samples each worker runs don't depend on the pipelining.
+class SamplePipeline {
+ public:
+  // Worker `w` runs its samples starting from `first_samples[w]`, and stops
+  // before `end_samples[w]` if given.
+  SamplePipeline(absl::Span<WorkerSampleGenerator* const> generators,
+                 absl::Span<const int64_t> first_samples,
+                 absl::Span<const std::optional<int64_t>> end_samples,
+                 int64_t generator_count, int64_t queue_depth)
+      : generator_count_(generator_count),
+        queue_depth_(queue_depth),
+        lanes_(generators.size()) {
+    for (int64_t w = 0; w < lanes_.size(); ++w) {
+      lanes_[w].generator = generators[w];
+      lanes_[w].next_sample = first_samples[w];
+      lanes_[w].end_sample = end_samples[w];
+    }
+  }
+
+  // Generates samples for this generator's workers until each of them has
+  // stopped or has had all of its samples generated.
+  void RunGenerator(int64_t generator_number) {
+    std::vector<Lane*> owned;
+    {
+      absl::MutexLock lock(&mu_);
+      for (int64_t w = generator_number; w < lanes_.size();
+           w += generator_count_) {
+        owned.push_back(&lanes_[w]);
+      }
+    }
+    int64_t turn = 0;
+    while (!owned.empty()) {
+      Lane* lane = nullptr;
+      int64_t sample;
+      {
+        absl::MutexLock lock(&mu_);
+        auto has_room_or_finished = [&]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+          bool finished = true;
+          for (const Lane* l : owned) {
+            if (!Finished(*l)) {
+              finished = false;
+              if (l->queue.size() < queue_depth_) {
+                return true;
+              }
+            }
+          }
+          return finished;
+        };
+        mu_.Await(absl::Condition(&has_room_or_finished));
+        // Fill the queues round-robin so no worker is starved.
+        for (int64_t i = 0; i < owned.size(); ++i) {
+          Lane* l = owned[(turn + i) % owned.size()];
+          if (!Finished(*l) && l->queue.size() < queue_depth_) {
+            lane = l;
+            turn = (turn + i + 1) % owned.size();
+            break;
+          }
+        }
+        if (lane == nullptr) {
+          return;
+        }
+        sample = lane->next_sample++;
+      }
+      // Only this thread generates the lane's samples, so this needs no lock.
+      GeneratedSample generated = lane->generator->Generate(sample);
+      absl::MutexLock lock(&mu_);
+      if (!lane->stopped) {
+        lane->queue.push_back(std::move(generated));
+      }
+    }
+  }
+
+  // Returns the next sample of worker `worker`, waiting for it to be
+  // generated. Must not be called for more samples than the worker runs.
+  GeneratedSample Pop(int64_t worker) {
+    absl::MutexLock lock(&mu_);
+    Lane& lane = lanes_[worker];
+    auto has_sample = [&lane]() { return !lane.queue.empty(); };
+    mu_.Await(absl::Condition(&has_sample));
+    GeneratedSample generated = std::move(lane.queue.front());
+    lane.queue.pop_front();
+    return generated;
+  }
+
+  // Records that worker `worker` won't run any more samples.
+  void Stop(int64_t worker) {
+    absl::MutexLock lock(&mu_);
+    lanes_[worker].stopped = true;
+    lanes_[worker].queue.clear();
+  }
+
+ private:
+  struct Lane {
+    WorkerSampleGenerator* generator = nullptr;
+    int64_t next_sample = 0;
+    std::optional<int64_t> end_sample;
+    std::deque<GeneratedSample> queue;
+    bool stopped = false;
+  };
+
+  static bool Finished(const Lane& lane) {
+    return lane.stopped || (lane.end_sample.has_value() &&
+                            lane.next_sample >= *lane.end_sample);
+  }
+
+  const int64_t generator_count_;
+  const int64_t queue_depth_;
+  absl::Mutex mu_;
+  std::vector<Lane> lanes_ ABSL_GUARDED_BY(mu_);
+};
+
+// Runs the samples of worker `worker_number`, starting from `first_sample`;
+// `next_sample` returns each of them in order.
 absl::Status GenerateAndRunSamples(
-    int64_t worker_number,
-    const dslx::AstGeneratorOptions& ast_generator_options,
-    const SampleOptions& sample_options, const std::optional<uint64_t>& seed,
+    int64_t worker_number, int64_t worker_count, int64_t first_sample,
+    absl::FunctionRef<GeneratedSample(int64_t)> next_sample,
+    const SampleOptions& sample_options,
     const std::optional<std::filesystem::path>& top_run_dir,
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count,
-    const std::optional<absl::Duration>& duration, bool force_failure) {
+    const std::optional<absl::Duration>& duration, bool force_failure,
+    bool dedup_crashers, CoverageFeedback* feedback,
+    SampleDeduplicator* deduplicator,
+    const std::optional<FuzzShardOptions>& shard) {
   int64_t crashers = 0;
   LOG(INFO) << "--- Started worker " << worker_number;
   Stopwatch stopwatch;
@@ -65,42 +328,63 @@ absl::Status GenerateAndRunSamples(
   std::optional<std::filesystem::path> summary_file;
   if (summary_dir.has_value()) {
     summary_file =
-        *summary_dir / absl::StrCat("summary_", worker_number, ".binarypb");
+        *summary_dir /
+        (shard.has_value()
+             ? absl::StrFormat("summary_shard%d_%d.binarypb",
+                               shard->shard_index, worker_number)
+             : absl::StrCat("summary_", worker_number, ".binarypb"));
   }
 
-  uint64_t rng_seed;
-  if (seed.has_value()) {
-    // Set seed deterministically based on the worker number so different
-    // workers generate different samples.
-    rng_seed = *seed + worker_number;
-  } else {
-    // Choose a nondeterministic seed.
-    rng_seed = absl::Uniform<uint64_t>(absl::BitGen());
-    LOG(INFO) << kBlueText << "--- NOTE: Worker #" << worker_number
-              << " chose a nondeterministic seed for value generation: "
-              << absl::StreamFormat("0x%16X", rng_seed) << kDefaultColor;
+  std::optional<std::filesystem::path> checkpoint;
+  if (shard.has_value() && shard->checkpoint_dir.has_value()) {
+    checkpoint = CheckpointPath(*shard, worker_count, worker_number);
+    if (first_sample > 0) {
+      LOG(INFO) << absl::StreamFormat(
+          "--- Worker #%d: Resuming after %d finished samples.", worker_number,
+          first_sample);
+    }
+  }
+  if (sample_count.has_value() && first_sample >= *sample_count) {
+    LOG(INFO) << absl::StreamFormat(
+        "--- Worker #%d: No samples left to run. Exiting.", worker_number);
+    return absl::OkStatus();
   }
-  std::mt19937_64 rng{rng_seed};
-  dslx::FileTable file_table;
 
-  int64_t sample = 0;
+  int64_t sample = first_sample;
   while (true) {
+    // The index of this sample within the whole sharded job.
+    int64_t global_sample = 0;
+    if (shard.has_value()) {
+      global_sample =
+          GlobalSampleIndex(*shard, worker_count, worker_number, sample);
+    }
+
     std::filesystem::path run_dir;
     std::optional<TempDirectory> temp_run_dir;
     if (top_run_dir.has_value()) {
       run_dir = *top_run_dir /
-                absl::StrFormat("worker%d-sample%d", worker_number, sample);
+                (shard.has_value()
+                     ? absl::StrFormat("sample%d", global_sample)
+                     : absl::StrFormat("worker%d-sample%d", worker_number,
+                                       sample));
+      if (shard.has_value()) {
+        // Discard anything left by a run of this sample that was preempted.
+        XLS_RETURN_IF_ERROR(RecursivelyDeletePath(run_dir));
+      }
       XLS_RETURN_IF_ERROR(RecursivelyCreateDir(run_dir));
     } else {
       XLS_ASSIGN_OR_RETURN(temp_run_dir, TempDirectory::Create());
       run_dir = temp_run_dir->path();
     }
 
-    absl::Status sample_status =
-        GenerateSampleAndRun(file_table, rng, ast_generator_options,
-                             sample_options, run_dir, crasher_dir, summary_file,
-                             force_failure)
-            .status();
+    GeneratedSample generated = next_sample(sample);
+    absl::Status sample_status = generated.sample.status();
+    if (sample_status.ok()) {
+      sample_status = RunGeneratedSample(
+          *generated.sample, generated.elapsed, sample_options, run_dir,
+          crasher_dir, summary_file, force_failure, dedup_crashers, feedback,
+          deduplicator);
+    }
     if (!sample_status.ok()) {
       LOG(INFO) << kRedText
                 << absl::StreamFormat(
@@ -109,9 +393,13 @@ absl::Status GenerateAndRunSamples(
                 << kDefaultColor;
       crashers++;
     }
+    if (checkpoint.has_value()) {
+      XLS_RETURN_IF_ERROR(WriteCheckpoint(*checkpoint, sample + 1));
+    }
 
     absl::Duration elapsed = stopwatch.GetElapsedTime();
-    if (sample > 0 && sample % 16 == 0) {
+    int64_t samples_run = sample - first_sample;
+    if (samples_run > 0 && samples_run % 16 == 0) {
       std::vector<std::string> metrics;
       metrics.reserve(3);
       if (sample_count.has_value()) {
@@ -122,7 +410,7 @@ absl::Status GenerateAndRunSamples(
       }
       metrics.push_back(absl::StrFormat(
           "%.2f samples/s",
-          static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed)));
+          static_cast<double>(samples_run) / absl::ToDoubleSeconds(elapsed)));
       if (duration.has_value()) {
         metrics.push_back(absl::StrFormat("running for %s (limit %s)",
                                           absl::FormatDuration(elapsed),
@@ -154,7 +442,8 @@ absl::Status GenerateAndRunSamples(
       "--- Worker #%d finished! %d samples; %d crashers; %.2f samples/s; ran "
       "for %s",
       worker_number, sample, crashers,
-      static_cast<double>(sample) / absl::ToDoubleSeconds(elapsed),
+      static_cast<double>(sample - first_sample) /
+          absl::ToDoubleSeconds(elapsed),
       absl::FormatDuration(elapsed));
   return absl::OkStatus();
 }
@@ -169,23 +458,95 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& crasher_dir,
     const std::optional<std::filesystem::path>& summary_dir,
     std::optional<int64_t> sample_count, std::optional<absl::Duration> duration,
-    bool force_failure) {
+    bool force_failure, bool dedup_crashers, bool coverage_feedback,
+    const std::optional<FuzzShardOptions>& shard,
+    const FuzzPipelineOptions& pipeline, bool dedup_samples) {
+  if (shard.has_value()) {
+    if (!seed.has_value()) {
+      return absl::InvalidArgumentError(
+          "A seed must be specified to run a fuzzing shard.");
+    }
+    if (shard->shard_count <= 0 || shard->shard_index < 0 ||
+        shard->shard_index >= shard->shard_count) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Invalid fuzzing shard %d of %d.",
+                          shard->shard_index, shard->shard_count));
+    }
+    if (shard->checkpoint_dir.has_value()) {
+      XLS_RETURN_IF_ERROR(RecursivelyCreateDir(*shard->checkpoint_dir));
+    }
+  }
+  if (pipeline.generator_count < 0 || pipeline.queue_depth < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid fuzzer pipeline: %d generators with queues of %d samples.",
+        pipeline.generator_count, pipeline.queue_depth));
+  }
+
+  std::optional<CoverageFeedback> feedback;
+  if (coverage_feedback) {
+    feedback.emplace();
+  }
+  std::optional<SampleDeduplicator> deduplicator;
+  if (dedup_samples) {
+    deduplicator.emplace();
+  }
+
+  std::vector<int64_t> first_samples(worker_count, 0);
+  std::vector<std::optional<int64_t>> worker_sample_counts(worker_count);
+  std::vector<std::unique_ptr<WorkerSampleGenerator>> generators;
+  std::vector<WorkerSampleGenerator*> generator_ptrs;
+  for (int64_t i = 0; i < worker_count; ++i) {
+    if (sample_count.has_value()) {
+      worker_sample_counts[i] =
+          shard.has_value()
+              ? ShardWorkerSampleCount(*shard, *sample_count, worker_count, i)
+              : (*sample_count + i) / worker_count;
+    }
+    if (shard.has_value() && shard->checkpoint_dir.has_value()) {
+      XLS_ASSIGN_OR_RETURN(
+          first_samples[i],
+          ReadCheckpoint(CheckpointPath(*shard, worker_count, i)));
+    }
+    generators.push_back(std::make_unique<WorkerSampleGenerator>(
+        i, worker_count, ast_generator_options, sample_options, seed,
+        feedback.has_value() ? &*feedback : nullptr, shard));
+    generator_ptrs.push_back(generators.back().get());
+  }
+
+  std::optional<SamplePipeline> sample_pipeline;
+  std::vector<std::unique_ptr<Thread>> generator_threads;
+  if (pipeline.generator_count > 0) {
+    sample_pipeline.emplace(generator_ptrs, first_samples,
+                            worker_sample_counts, pipeline.generator_count,
+                            pipeline.queue_depth);
+    const int64_t generator_thread_count =
+        std::min(pipeline.generator_count, worker_count);
+    for (int64_t g = 0; g < generator_thread_count; ++g) {
+      generator_threads.push_back(std::make_unique<Thread>(
+          [&, g] { sample_pipeline->RunGenerator(g); }));
+    }
+  }
+
   std::vector<std::unique_ptr<Thread>> workers;
   workers.resize(worker_count);
   std::vector<absl::Status> worker_status;
   worker_status.resize(workers.size(),
                        absl::InternalError("worker did not terminate."));
   for (int64_t i = 0; i < workers.size(); ++i) {
-    std::optional<int64_t> worker_sample_count =
-        sample_count.has_value()
-            ? std::make_optional((*sample_count + i) / worker_count)
-            : std::nullopt;
-    workers[i] = std::make_unique<Thread>([&, i, worker_sample_count,
-                                           status = &worker_status[i]] {
-      *status =
-          GenerateAndRunSamples(i, ast_generator_options, sample_options, seed,
-                                top_run_dir, crasher_dir, summary_dir,
-                                worker_sample_count, duration, force_failure);
+    workers[i] = std::make_unique<Thread>([&, i, status = &worker_status[i]] {
+      auto next_sample = [&](int64_t sample) {
+        return sample_pipeline.has_value() ? sample_pipeline->Pop(i)
+                                           : generators[i]->Generate(sample);
+      };
+      *status = GenerateAndRunSamples(
+          i, worker_count, first_samples[i], next_sample, sample_options,
+          top_run_dir, crasher_dir, summary_dir, worker_sample_counts[i],
+          duration, force_failure, dedup_crashers,
+          feedback.has_value() ? &*feedback : nullptr,
+          deduplicator.has_value() ? &*deduplicator : nullptr, shard);
+      if (sample_pipeline.has_value()) {
+        sample_pipeline->Stop(i);
+      }
     });
   }
   for (int64_t i = 0; i < workers.size(); ++i) {
@@ -196,6 +557,19 @@ absl::Status ParallelGenerateAndRunSamples(
                  << " failed: " << worker_status[i] << kDefaultColor;
     }
   }
+  for (std::unique_ptr<Thread>& generator_thread : generator_threads) {
+    generator_thread->Join();
+  }
+  if (feedback.has_value()) {
+    LOG(INFO) << absl::StreamFormat(
+        "-- Samples covered %d points; %d samples in the corpus",
+        feedback->covered_points(), feedback->corpus_size());
+  }
+  if (deduplicator.has_value()) {
+    LOG(INFO) << absl::StreamFormat(
+        "-- Skipped codegen and simulation of %d duplicate samples",
+        deduplicator->duplicates());
+  }
   return absl::OkStatus();
 }
 
@@ -26,6 +26,37 @@
 
 namespace xls {
 
+// Options for running one shard of a fuzzing job which is split across hosts.
+//
+// In a sharded job every sample has a global index `i`, and is generated from
+// its own RNG seeded with `seed + i`; shard `k` runs the samples with
+// `i % shard_count == k`, so the samples do not depend on how many hosts or
+// workers the job runs on. `sample_count` then bounds the global index.
+struct FuzzShardOptions {
+  int64_t shard_index = 0;
+  int64_t shard_count = 1;
+
+  // If set, each worker records the samples it has finished in this
+  // directory, and a restarted shard resumes after the last recorded sample
+  // rather than starting over. Resuming requires the same seed, shard count,
+  // and worker count.
+  std::optional<std::filesystem::path> checkpoint_dir;
+};
+
+// Options for generating samples on separate threads ahead of the workers
+// which run them.
+//
+// By default each worker generates each of its samples just before running it.
+// With `generator_count` > 0, that many threads generate the samples of all
+// workers instead, keeping up to `queue_depth` samples waiting for each
+// worker, so the workers (whose time is mostly spent in optimization, codegen,
+// and simulation) don't wait on generation. The workers run the same samples
+// either way.
+struct FuzzPipelineOptions {
+  int64_t generator_count = 0;
+  int64_t queue_depth = 2;
+};
+
 // Generate and run fuzzer samples on `worker_count` threads; runs up to
 // `sample_count` samples (unbounded if unspecified) for up to `duration` time.
 //
@@ -36,7 +67,29 @@ namespace xls {
 // written to `crasher_dir`, and summaries to `summary_dir`.
 //
 // If `force_failure` is true, every sample run will be considered a failure.
-// This is useful for testing failure paths.
+// This is useful for testing failure paths. If `dedup_crashers` is true, a
+// crasher whose minimized IR matches that of a crasher already saved in
+// `crasher_dir` (e.g., by another shard sharing the directory) is discarded
+// rather than reported again.
+//
+// If `coverage_feedback` is true, the workers share a map of the IR coverage
+// (op, IR stage, and bit-width bucket) of the samples run so far, and half of
+// the samples are mutations of earlier samples which covered new points,
+// rather than newly generated ones. Since which samples are mutated depends on
+// the order in which workers finish samples, runs are then not reproducible.
+//
+// If `shard` is given, runs only that shard's portion of the job; `seed` must
+// be specified. Summaries are then written to
+// `summary_dir/summary_shard<k>_<worker>.binarypb`, so the summaries of all
+// shards can share a directory and be read together by `read_summary_main`.
+//
+// `pipeline` configures how sample generation is overlapped with running; see
+// FuzzPipelineOptions.
+//
+// If `dedup_samples` is true, the workers share a set of the canonical hashes
+// of the optimized IR of the samples run so far (see CanonicalSampleHash), and
+// skip code generation and simulation of samples which duplicate an earlier
+// one.
 absl::Status ParallelGenerateAndRunSamples(
     int64_t worker_count,
     const dslx::AstGeneratorOptions& ast_generator_options,
@@ -47,7 +100,11 @@ absl::Status ParallelGenerateAndRunSamples(
     const std::optional<std::filesystem::path>& summary_dir = std::nullopt,
     std::optional<int64_t> sample_count = std::nullopt,
     std::optional<absl::Duration> duration = std::nullopt,
-    bool force_failure = false);
+    bool force_failure = false, bool dedup_crashers = false,
+    bool coverage_feedback = false,
+    const std::optional<FuzzShardOptions>& shard = std::nullopt,
+    const FuzzPipelineOptions& pipeline = FuzzPipelineOptions(),
+    bool dedup_samples = false);
 
 }  // namespace xls
 
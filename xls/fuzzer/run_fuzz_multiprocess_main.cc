@@ -39,14 +39,36 @@
 ABSL_FLAG(absl::Duration, duration, absl::InfiniteDuration(),
           "Duration to run the sample generator for.");
 ABSL_FLAG(int64_t, calls_per_sample, 128, "Arguments to generate per sample.");
+ABSL_FLAG(std::optional<std::string>, checkpoint_path, std::nullopt,
+          "Directory in which to record the progress of each worker. If a "
+          "checkpoint is present, the workers resume after the samples it "
+          "records, so a preempted job can be restarted where it stopped. "
+          "Requires --seed.");
 ABSL_FLAG(std::optional<std::string>, crash_path, std::nullopt,
           "Path at which to place crash data.");
 ABSL_FLAG(bool, codegen, false, "Run code generation.");
+ABSL_FLAG(bool, coverage_feedback, false,
+          "Bias sampling toward IR coverage: samples which cover new (op, IR "
+          "stage, bit-width bucket) points are kept, and mutations of them are "
+          "run in place of half of the newly generated samples. Runs are not "
+          "reproducible with this enabled.");
+ABSL_FLAG(bool, dedup_crashers, false,
+          "Discard crashers whose minimized IR matches that of a crasher "
+          "already saved in --crash_path, e.g. by another shard of the job.");
+ABSL_FLAG(bool, dedup_samples, false,
+          "Skip code generation and simulation of samples whose optimized IR, "
+          "with identifiers removed, and codegen options match those of a "
+          "sample already run.");
 ABSL_FLAG(bool, emit_loops, true, "Emit loops in generator.");
 ABSL_FLAG(
     bool, force_failure, false,
     "Forces the samples to fail. Can be used to test failure code paths.");
 ABSL_FLAG(bool, generate_proc, false, "Generate a proc sample.");
+ABSL_FLAG(int64_t, generator_count, 0,
+          "Number of threads generating samples ahead of the workers, which "
+          "then only run them. By default each worker generates its own "
+          "samples between running them. The samples run are the same "
+          "either way.");
 ABSL_FLAG(int64_t, max_width_aggregate_types, 1024,
           "The maximum width of aggregate types (tuples and arrays) in the "
           "generated samples.");
@@ -56,6 +78,9 @@ ABSL_FLAG(int64_t, proc_ticks, 100,
           "Number of ticks to execute the generated procs.");
 ABSL_FLAG(std::optional<int64_t>, sample_count, std::nullopt,
           "Number of samples to generate.");
+ABSL_FLAG(int64_t, sample_queue_depth, 2,
+          "With --generator_count, the number of generated samples kept "
+          "waiting for each worker.");
 ABSL_FLAG(std::optional<std::string>, save_temps_path, std::nullopt,
           "Path of directory in which to save temporary files. These temporary "
           "files include DSLX, IR, and arguments. A separate numerically-named "
@@ -63,6 +88,13 @@ ABSL_FLAG(std::optional<std::string>, save_temps_path, std::nullopt,
 ABSL_FLAG(std::optional<int64_t>, seed, std::nullopt,
           "Seed value for generation. By default, a nondetermistic seed is "
           "used; if a seed is provided, it is used for determinism");
+ABSL_FLAG(int64_t, shard_count, 1,
+          "Number of shards (typically hosts) the fuzzing job is split across. "
+          "Sample i of the job is seeded with --seed + i and run by shard "
+          "i % shard_count; --sample_count counts the samples of all shards. "
+          "Requires --seed if greater than one.");
+ABSL_FLAG(int64_t, shard_index, 0,
+          "Index of the shard to run, in the range [0, --shard_count).");
 ABSL_FLAG(bool, simulate, false, "Run Verilog simulation.");
 ABSL_FLAG(std::optional<std::string>, simulator, std::nullopt,
           "Verilog simulator to use.");
@@ -92,17 +124,25 @@ namespace {
 struct Options {
   absl::Duration duration;
   int64_t calls_per_sample;
+  std::optional<std::filesystem::path> checkpoint_path;
   std::optional<std::filesystem::path> crash_path;
   bool codegen;
+  bool coverage_feedback;
+  bool dedup_crashers;
+  bool dedup_samples;
   bool emit_loops;
   bool force_failure;
   bool generate_proc;
+  int64_t generator_count;
   int64_t max_width_aggregate_types;
   int64_t max_width_bits_types;
   int64_t proc_ticks;
   std::optional<int64_t> sample_count;
+  int64_t sample_queue_depth;
   std::optional<std::filesystem::path> save_temps_path;
   std::optional<int64_t> seed;
+  int64_t shard_count;
+  int64_t shard_index;
   bool simulate;
   std::optional<std::string> simulator;
   std::optional<std::filesystem::path> summary_path;
@@ -173,11 +213,23 @@ absl::Status RealMain(const Options& options) {
   sample_options.set_use_system_verilog(options.use_system_verilog);
   sample_options.set_with_valid_holdoff(options.with_valid_holdoff);
 
+  std::optional<FuzzShardOptions> shard;
+  if (options.shard_count != 1 || options.shard_index != 0 ||
+      options.checkpoint_path.has_value()) {
+    shard = FuzzShardOptions{.shard_index = options.shard_index,
+                             .shard_count = options.shard_count,
+                             .checkpoint_dir = options.checkpoint_path};
+  }
+
   return ParallelGenerateAndRunSamples(
       worker_count, ast_generator_options, sample_options, options.seed,
       /*top_run_dir=*/options.save_temps_path,
       /*crasher_dir=*/options.crash_path, /*summary_dir=*/options.summary_path,
-      options.sample_count, options.duration, options.force_failure);
+      options.sample_count, options.duration, options.force_failure,
+      options.dedup_crashers, options.coverage_feedback, shard,
+      FuzzPipelineOptions{.generator_count = options.generator_count,
+                          .queue_depth = options.sample_queue_depth},
+      options.dedup_samples);
 }
 
 }  // namespace
@@ -201,18 +253,26 @@ int main(int argc, char** argv) {
   return xls::ExitStatus(xls::RealMain({
       .duration = absl::GetFlag(FLAGS_duration),
       .calls_per_sample = absl::GetFlag(FLAGS_calls_per_sample),
+      .checkpoint_path = absl::GetFlag(FLAGS_checkpoint_path),
       .crash_path = absl::GetFlag(FLAGS_crash_path),
       .codegen = absl::GetFlag(FLAGS_codegen),
+      .coverage_feedback = absl::GetFlag(FLAGS_coverage_feedback),
+      .dedup_crashers = absl::GetFlag(FLAGS_dedup_crashers),
+      .dedup_samples = absl::GetFlag(FLAGS_dedup_samples),
       .emit_loops = absl::GetFlag(FLAGS_emit_loops),
       .force_failure = absl::GetFlag(FLAGS_force_failure),
       .generate_proc = absl::GetFlag(FLAGS_generate_proc),
+      .generator_count = absl::GetFlag(FLAGS_generator_count),
       .max_width_aggregate_types =
           absl::GetFlag(FLAGS_max_width_aggregate_types),
       .max_width_bits_types = absl::GetFlag(FLAGS_max_width_bits_types),
       .proc_ticks = absl::GetFlag(FLAGS_proc_ticks),
       .sample_count = absl::GetFlag(FLAGS_sample_count),
+      .sample_queue_depth = absl::GetFlag(FLAGS_sample_queue_depth),
       .save_temps_path = absl::GetFlag(FLAGS_save_temps_path),
       .seed = absl::GetFlag(FLAGS_seed),
+      .shard_count = absl::GetFlag(FLAGS_shard_count),
+      .shard_index = absl::GetFlag(FLAGS_shard_index),
       .simulate = absl::GetFlag(FLAGS_simulate),
       .simulator = absl::GetFlag(FLAGS_simulator),
       .summary_path = absl::GetFlag(FLAGS_summary_path),
@@ -90,6 +90,40 @@ class RunFuzzMultiprocessTest(test_base.TestCase):
     # Crasher path should contain a single file 'test'.
     self.assertSequenceEqual(os.listdir(crasher_path), ('test',))
 
+  def test_pipelined_generation_runs_same_samples(self):
+    crasher_path = self.create_tempdir().full_path
+    args = [
+        RUN_FUZZ_MULTIPROCESS_PATH,
+        '--seed=42',
+        '--crash_path=' + crasher_path,
+        '--sample_count=6',
+        '--calls_per_sample=3',
+        '--worker_count=3',
+    ]
+
+    def read_samples(samples_path):
+      samples = {}
+      for d in os.listdir(samples_path):
+        with open(os.path.join(samples_path, d, 'sample.x'), 'r') as f:
+          samples[d] = f.read()
+      return samples
+
+    inline_samples_path = self.create_tempdir().full_path
+    subprocess.check_call(args + ['--save_temps_path=' + inline_samples_path])
+    pipelined_samples_path = self.create_tempdir().full_path
+    subprocess.check_call(
+        args
+        + [
+            '--save_temps_path=' + pipelined_samples_path,
+            '--generator_count=2',
+            '--sample_queue_depth=1',
+        ]
+    )
+
+    inline_samples = read_samples(inline_samples_path)
+    self.assertLen(inline_samples, 6)
+    self.assertEqual(read_samples(pipelined_samples_path), inline_samples)
+
   def test_crashers_on_failure(self):
     crasher_path = self.create_tempdir().full_path
 
@@ -106,6 +140,68 @@ class RunFuzzMultiprocessTest(test_base.TestCase):
     # Crasher directory should have 5 samples in it plus the `test` file.
     self.assertEqual(len(os.listdir(crasher_path)), 6)
 
+  def test_shards_partition_samples(self):
+    crasher_path = self.create_tempdir().full_path
+    samples_path = self.create_tempdir().full_path
+    summaries_path = self.create_tempdir().full_path
+
+    for shard_index in range(2):
+      subprocess.check_call([
+          RUN_FUZZ_MULTIPROCESS_PATH,
+          '--seed=42',
+          '--crash_path=' + crasher_path,
+          '--save_temps_path=' + samples_path,
+          '--summary_path=' + summaries_path,
+          '--sample_count=5',
+          '--calls_per_sample=3',
+          '--worker_count=2',
+          '--shard_count=2',
+          '--shard_index={}'.format(shard_index),
+      ])
+
+    # Together the shards should have run each sample of the job once.
+    self.assertSequenceEqual(
+        sorted(os.listdir(samples_path)),
+        ['sample{}'.format(i) for i in range(5)],
+    )
+    self.assertSequenceEqual(
+        sorted(os.listdir(summaries_path)),
+        (
+            'summary_shard0_0.binarypb',
+            'summary_shard0_1.binarypb',
+            'summary_shard1_0.binarypb',
+            'summary_shard1_1.binarypb',
+            'test',
+        ),
+    )
+
+  def test_resume_from_checkpoint(self):
+    crasher_path = self.create_tempdir().full_path
+    checkpoint_path = self.create_tempdir().full_path
+    args = [
+        RUN_FUZZ_MULTIPROCESS_PATH,
+        '--seed=42',
+        '--crash_path=' + crasher_path,
+        '--checkpoint_path=' + checkpoint_path,
+        '--calls_per_sample=3',
+        '--worker_count=1',
+    ]
+
+    first_samples_path = self.create_tempdir().full_path
+    subprocess.check_call(
+        args + ['--save_temps_path=' + first_samples_path, '--sample_count=2']
+    )
+    self.assertSequenceEqual(
+        sorted(os.listdir(first_samples_path)), ('sample0', 'sample1')
+    )
+
+    # Restarting the job should only run the samples not yet finished.
+    second_samples_path = self.create_tempdir().full_path
+    subprocess.check_call(
+        args + ['--save_temps_path=' + second_samples_path, '--sample_count=3']
+    )
+    self.assertSequenceEqual(os.listdir(second_samples_path), ('sample2',))
+
   def test_duration(self):
     samples_path = self.create_tempdir().full_path
     crasher_path = self.create_tempdir().full_path
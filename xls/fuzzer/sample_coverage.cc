@@ -0,0 +1,143 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/fuzzer/sample_coverage.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/numeric/bits.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/random/distributions.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// Parses the IR at `path`, or returns nullptr if no such file was written.
+absl::StatusOr<std::unique_ptr<Package>> ParseIrIfPresent(
+    const std::filesystem::path& path) {
+  if (!FileExists(path).ok()) {
+    return nullptr;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return Parser::ParsePackage(contents, path.string());
+}
+
+}  // namespace
+
+absl::flat_hash_set<CoveragePoint> GetCoveragePoints(IrStage stage,
+                                                     Package* package) {
+  absl::flat_hash_set<CoveragePoint> points;
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      int64_t width = node->GetType()->GetFlatBitCount();
+      points.insert(CoveragePoint{
+          .stage = stage,
+          .op = node->op(),
+          .width_bucket = absl::bit_width(static_cast<uint64_t>(width))});
+    }
+  }
+  return points;
+}
+
+std::optional<Sample> CoverageFeedback::ChooseParent(absl::BitGenRef bit_gen) {
+  absl::MutexLock lock(&mutex_);
+  if (corpus_.empty() || !absl::Bernoulli(bit_gen, mutation_probability_)) {
+    return std::nullopt;
+  }
+  int64_t total_weight = 0;
+  for (const CorpusEntry& entry : corpus_) {
+    total_weight += entry.weight;
+  }
+  int64_t choice = absl::Uniform<int64_t>(bit_gen, 0, total_weight);
+  for (const CorpusEntry& entry : corpus_) {
+    if (choice < entry.weight) {
+      return entry.sample;
+    }
+    choice -= entry.weight;
+  }
+  return corpus_.back().sample;
+}
+
+int64_t CoverageFeedback::Record(const Sample& sample, Package* unoptimized,
+                                 Package* optimized) {
+  absl::flat_hash_set<CoveragePoint> points;
+  if (unoptimized != nullptr) {
+    points.merge(GetCoveragePoints(IrStage::kUnoptimized, unoptimized));
+  }
+  if (optimized != nullptr) {
+    points.merge(GetCoveragePoints(IrStage::kOptimized, optimized));
+  }
+
+  absl::MutexLock lock(&mutex_);
+  int64_t new_points = 0;
+  for (const CoveragePoint& point : points) {
+    if (covered_.insert(point).second) {
+      ++new_points;
+    }
+  }
+  if (new_points == 0 || max_corpus_size_ <= 0) {
+    return new_points;
+  }
+  if (corpus_.size() < max_corpus_size_) {
+    corpus_.push_back(CorpusEntry{.sample = sample, .weight = new_points});
+    return new_points;
+  }
+  // Make room by evicting the entry which contributed the least coverage.
+  auto least = std::min_element(corpus_.begin(), corpus_.end(),
+                                [](const CorpusEntry& a, const CorpusEntry& b) {
+                                  return a.weight < b.weight;
+                                });
+  if (least->weight < new_points) {
+    *least = CorpusEntry{.sample = sample, .weight = new_points};
+  }
+  return new_points;
+}
+
+absl::StatusOr<int64_t> CoverageFeedback::RecordRunDir(
+    const Sample& sample, const std::filesystem::path& run_dir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> unoptimized,
+                       ParseIrIfPresent(run_dir / "sample.ir"));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> optimized,
+                       ParseIrIfPresent(run_dir / "sample.opt.ir"));
+  return Record(sample, unoptimized.get(), optimized.get());
+}
+
+int64_t CoverageFeedback::covered_points() const {
+  absl::MutexLock lock(&mutex_);
+  return covered_.size();
+}
+
+int64_t CoverageFeedback::corpus_size() const {
+  absl::MutexLock lock(&mutex_);
+  return corpus_.size();
+}
+
+}  // namespace xls
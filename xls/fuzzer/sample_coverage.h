@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_FUZZER_SAMPLE_COVERAGE_H_
+#define XLS_FUZZER_SAMPLE_COVERAGE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/random/bit_gen_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// The points at which the IR of a sample is observed.
+enum class IrStage : uint8_t { kUnoptimized, kOptimized };
+
+// A point of the IR coverage of fuzzer samples: an op producing a result whose
+// flat bit count falls in a power-of-two bucket, at a stage of the IR.
+struct CoveragePoint {
+  IrStage stage;
+  Op op;
+  // Zero for zero-width results, and otherwise the bit width of the result's
+  // flat bit count; i.e., widths 2-3 share bucket 2, 4-7 bucket 3, etc.
+  int64_t width_bucket;
+
+  bool operator==(const CoveragePoint& other) const = default;
+
+  template <typename H>
+  friend H AbslHashValue(H h, const CoveragePoint& p) {
+    return H::combine(std::move(h), p.stage, p.op, p.width_bucket);
+  }
+};
+
+// Returns the coverage points of the nodes of `package` at `stage`.
+absl::flat_hash_set<CoveragePoint> GetCoveragePoints(IrStage stage,
+                                                     Package* package);
+
+// Steers sample generation toward samples that cover new IR. A sample which
+// covers points that no earlier sample covered is kept in a corpus, and
+// parents for mutation are drawn from the corpus with probability
+// proportional to the number of new points they covered.
+//
+// This class is thread-safe, so that all workers of a fuzzing run can share
+// one coverage map and corpus.
+class CoverageFeedback {
+ public:
+  // With probability `mutation_probability`, `ChooseParent` returns a member
+  // of the corpus; the corpus holds at most `max_corpus_size` samples.
+  explicit CoverageFeedback(double mutation_probability = 0.5,
+                            int64_t max_corpus_size = 256)
+      : mutation_probability_(mutation_probability),
+        max_corpus_size_(max_corpus_size) {}
+
+  // Returns a sample to mutate in place of generating a new one, if any.
+  std::optional<Sample> ChooseParent(absl::BitGenRef bit_gen);
+
+  // Records the coverage of `sample`, whose IR before and after optimization
+  // is `unoptimized` and `optimized` (either of which may be null). Returns
+  // the number of points it newly covers.
+  int64_t Record(const Sample& sample, Package* unoptimized,
+                 Package* optimized);
+
+  // As above, reading the IR written by running `sample` in `run_dir`.
+  absl::StatusOr<int64_t> RecordRunDir(const Sample& sample,
+                                       const std::filesystem::path& run_dir);
+
+  int64_t covered_points() const;
+  int64_t corpus_size() const;
+
+ private:
+  struct CorpusEntry {
+    Sample sample;
+    // The number of points this sample newly covered.
+    int64_t weight;
+  };
+
+  const double mutation_probability_;
+  const int64_t max_corpus_size_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_set<CoveragePoint> covered_ ABSL_GUARDED_BY(mutex_);
+  std::vector<CorpusEntry> corpus_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_COVERAGE_H_
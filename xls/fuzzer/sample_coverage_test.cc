@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/fuzzer/sample_coverage.h"
+
+#include <memory>
+#include <optional>
+#include <random>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/tests/testvector.pb.h"
+
+namespace xls {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+constexpr char kAddPackage[] = R"(package p
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.3: bits[8] = add(x, y)
+}
+)";
+
+constexpr char kWideAddPackage[] = R"(package p
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y)
+}
+)";
+
+Sample MakeSample(const char* text) {
+  return Sample(text, SampleOptions(), testvector::SampleInputsProto());
+}
+
+TEST(SampleCoverageTest, GetCoveragePoints) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kAddPackage));
+  EXPECT_THAT(
+      GetCoveragePoints(IrStage::kOptimized, package.get()),
+      UnorderedElementsAre(
+          CoveragePoint{.stage = IrStage::kOptimized,
+                        .op = Op::kParam,
+                        .width_bucket = 4},
+          CoveragePoint{
+              .stage = IrStage::kOptimized, .op = Op::kAdd, .width_bucket = 4}));
+}
+
+TEST(SampleCoverageTest, RecordCountsNewPoints) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> add,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> wide_add,
+                           Parser::ParsePackage(kWideAddPackage));
+  CoverageFeedback feedback;
+  EXPECT_EQ(feedback.Record(MakeSample("a"), add.get(), add.get()), 4);
+  // Nothing new; the sample is not added to the corpus.
+  EXPECT_EQ(feedback.Record(MakeSample("b"), add.get(), nullptr), 0);
+  // New widths.
+  EXPECT_EQ(feedback.Record(MakeSample("c"), wide_add.get(), nullptr), 2);
+  EXPECT_EQ(feedback.covered_points(), 6);
+  EXPECT_EQ(feedback.corpus_size(), 2);
+}
+
+TEST(SampleCoverageTest, ChooseParentFromCorpus) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> add,
+                           Parser::ParsePackage(kAddPackage));
+  std::mt19937_64 rng;
+  CoverageFeedback feedback(/*mutation_probability=*/1.0);
+  EXPECT_EQ(feedback.ChooseParent(rng), std::nullopt);
+  feedback.Record(MakeSample("a"), add.get(), nullptr);
+  std::optional<Sample> parent = feedback.ChooseParent(rng);
+  ASSERT_TRUE(parent.has_value());
+  EXPECT_EQ(parent->input_text(), "a");
+}
+
+TEST(SampleCoverageTest, CorpusEvictsLeastCoverage) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> add,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> wide_add,
+                           Parser::ParsePackage(kWideAddPackage));
+  std::mt19937_64 rng;
+  CoverageFeedback feedback(/*mutation_probability=*/1.0,
+                            /*max_corpus_size=*/1);
+  feedback.Record(MakeSample("a"), add.get(), nullptr);
+  feedback.Record(MakeSample("b"), wide_add.get(), wide_add.get());
+  EXPECT_EQ(feedback.corpus_size(), 1);
+  std::optional<Sample> parent = feedback.ChooseParent(rng);
+  ASSERT_TRUE(parent.has_value());
+  EXPECT_EQ(parent->input_text(), "b");
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_dedup.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/sha.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/dev_tools/remove_identifiers.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+absl::StatusOr<std::string> CanonicalSampleHash(Package* package,
+                                                const SampleOptions& options) {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> stripped,
+      StripPackage(package, StripOptions{.new_package_name = "sample"}));
+  std::string key = absl::StrCat(
+      stripped->DumpIr(), "\ncodegen: ", options.codegen(),
+      "\ncodegen_ng: ", options.codegen_ng(),
+      "\ncodegen_args: ", absl::StrJoin(options.codegen_args(), " "),
+      "\nsimulate: ", options.simulate(),
+      "\nsimulator: ", options.simulator(),
+      "\nuse_system_verilog: ", options.use_system_verilog());
+  std::array<uint8_t, SHA256_DIGEST_LENGTH> digest;
+  SHA256(reinterpret_cast<const uint8_t*>(key.data()), key.size(),
+         digest.data());
+  return std::string(digest.begin(), digest.end());
+}
+
+absl::StatusOr<bool> SampleDeduplicator::RecordIfNew(
+    Package* package, const SampleOptions& options) {
+  XLS_ASSIGN_OR_RETURN(std::string hash, CanonicalSampleHash(package, options));
+  absl::MutexLock lock(&mutex_);
+  if (seen_.insert(std::move(hash)).second) {
+    return true;
+  }
+  ++duplicates_;
+  return false;
+}
+
+int64_t SampleDeduplicator::duplicates() const {
+  absl::MutexLock lock(&mutex_);
+  return duplicates_;
+}
+
+}  // namespace xls
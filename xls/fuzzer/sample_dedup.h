@@ -0,0 +1,61 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_FUZZER_SAMPLE_DEDUP_H_
+#define XLS_FUZZER_SAMPLE_DEDUP_H_
+
+#include <cstdint>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Returns a hash identifying the optimized IR `package` of a sample up to
+// renaming: it is computed from the IR with all identifiers and source
+// locations removed (see StripPackage), along with the sample's code
+// generation and simulation options.
+absl::StatusOr<std::string> CanonicalSampleHash(Package* package,
+                                                const SampleOptions& options);
+
+// Recognizes samples whose optimized IR is the same, up to renaming, as that
+// of a sample seen before, so that code generation and simulation (the most
+// expensive stages of running a sample) can be skipped for them.
+//
+// This class is thread-safe, so that all workers of a fuzzing run can share
+// one set of seen samples.
+class SampleDeduplicator {
+ public:
+  // Records the sample with optimized IR `package`. Returns false if an
+  // equivalent sample was recorded before.
+  absl::StatusOr<bool> RecordIfNew(Package* package,
+                                   const SampleOptions& options);
+
+  // The number of samples for which RecordIfNew returned false.
+  int64_t duplicates() const;
+
+ private:
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_set<std::string> seen_ ABSL_GUARDED_BY(mutex_);
+  int64_t duplicates_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_FUZZER_SAMPLE_DEDUP_H_
@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/fuzzer/sample_dedup.h"
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/fuzzer/sample.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+constexpr char kAddPackage[] = R"(package p
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.3: bits[8] = add(x, y)
+}
+)";
+
+// The same function as kAddPackage, with different names.
+constexpr char kRenamedAddPackage[] = R"(package q
+
+top fn __sample__main(a: bits[8], b: bits[8]) -> bits[8] {
+  ret sum: bits[8] = add(a, b)
+}
+)";
+
+constexpr char kSubPackage[] = R"(package p
+
+top fn main(x: bits[8], y: bits[8]) -> bits[8] {
+  ret sub.3: bits[8] = sub(x, y)
+}
+)";
+
+SampleOptions CodegenOptions() {
+  SampleOptions options;
+  options.set_codegen(true);
+  options.set_codegen_args({"--generator=combinational"});
+  return options;
+}
+
+TEST(SampleDedupTest, HashIgnoresIdentifiers) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> add,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> renamed,
+                           Parser::ParsePackage(kRenamedAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> sub,
+                           Parser::ParsePackage(kSubPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string add_hash,
+                           CanonicalSampleHash(add.get(), CodegenOptions()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::string renamed_hash,
+      CanonicalSampleHash(renamed.get(), CodegenOptions()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string sub_hash,
+                           CanonicalSampleHash(sub.get(), CodegenOptions()));
+  EXPECT_EQ(add_hash, renamed_hash);
+  EXPECT_NE(add_hash, sub_hash);
+}
+
+TEST(SampleDedupTest, HashIncludesCodegenOptions) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> add,
+                           Parser::ParsePackage(kAddPackage));
+  SampleOptions pipelined = CodegenOptions();
+  pipelined.set_codegen_args({"--generator=pipeline", "--pipeline_stages=2"});
+  XLS_ASSERT_OK_AND_ASSIGN(std::string combinational_hash,
+                           CanonicalSampleHash(add.get(), CodegenOptions()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string pipelined_hash,
+                           CanonicalSampleHash(add.get(), pipelined));
+  EXPECT_NE(combinational_hash, pipelined_hash);
+}
+
+TEST(SampleDedupTest, RecordIfNew) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> add,
+                           Parser::ParsePackage(kAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> renamed,
+                           Parser::ParsePackage(kRenamedAddPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> sub,
+                           Parser::ParsePackage(kSubPackage));
+  SampleDeduplicator deduplicator;
+  EXPECT_THAT(deduplicator.RecordIfNew(add.get(), CodegenOptions()),
+              IsOkAndHolds(true));
+  EXPECT_THAT(deduplicator.RecordIfNew(renamed.get(), CodegenOptions()),
+              IsOkAndHolds(false));
+  EXPECT_THAT(deduplicator.RecordIfNew(sub.get(), CodegenOptions()),
+              IsOkAndHolds(true));
+  EXPECT_EQ(deduplicator.duplicates(), 1);
+}
+
+}  // namespace
+}  // namespace xls
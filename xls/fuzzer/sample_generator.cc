@@ -56,6 +56,7 @@
 #include "xls/dslx/virtualizable_file_system.h"
 #include "xls/dslx/warning_kind.h"
 #include "xls/fuzzer/ast_generator.h"
+#include "xls/fuzzer/dslx_mutator.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
 #include "xls/fuzzer/value_generator.h"
@@ -496,4 +497,49 @@ absl::StatusOr<Sample> GenerateSample(
                                 sample_options_copy, bit_gen, dslx_text);
 }
 
+absl::StatusOr<Sample> MutateSample(const Sample& parent,
+                                    absl::BitGenRef bit_gen,
+                                    int64_t max_attempts) {
+  constexpr std::string_view top_name = "main";
+  const SampleOptions& sample_options = parent.options();
+  XLS_RET_CHECK(sample_options.input_is_dslx())
+      << "Only DSLX samples can be mutated";
+  for (int64_t attempt = 0; attempt < max_attempts; ++attempt) {
+    XLS_ASSIGN_OR_RETURN(std::string dslx_text,
+                         dslx::RemoveDslxToken(parent.input_text(), bit_gen));
+    ImportData import_data(
+        dslx::CreateImportData(/*stdlib_path=*/"",
+                               /*additional_search_paths=*/{},
+                               /*enabled_warnings=*/dslx::kAllWarningsSet,
+                               std::make_unique<dslx::RealFilesystem>()));
+    absl::StatusOr<TypecheckedModule> tm =
+        ParseAndTypecheck(dslx_text, "sample.x", "sample", &import_data);
+    if (!tm.ok()) {
+      VLOG(2) << "Mutated sample failed to parse-and-typecheck: "
+              << tm.status();
+      continue;
+    }
+    std::optional<ModuleMember*> member =
+        tm->module->FindMemberWithName(top_name);
+    if (!member.has_value()) {
+      continue;
+    }
+    if (sample_options.sample_type() == fuzzer::SAMPLE_TYPE_PROC) {
+      if (!std::holds_alternative<dslx::Proc*>(**member)) {
+        continue;
+      }
+      return GenerateProcSample(std::get<dslx::Proc*>(**member), *tm,
+                                sample_options, bit_gen, dslx_text);
+    }
+    if (!std::holds_alternative<dslx::Function*>(**member)) {
+      continue;
+    }
+    return GenerateFunctionSample(std::get<dslx::Function*>(**member), *tm,
+                                  sample_options, bit_gen, dslx_text);
+  }
+  return absl::NotFoundError(
+      absl::StrFormat("No well-typed mutation found in %d attempts",
+                      max_attempts));
+}
+
 }  // namespace xls
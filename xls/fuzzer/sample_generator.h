@@ -15,6 +15,8 @@
 #ifndef XLS_FUZZER_SAMPLE_GENERATOR_H_
 #define XLS_FUZZER_SAMPLE_GENERATOR_H_
 
+#include <cstdint>
+
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/statusor.h"
 #include "xls/dslx/frontend/pos.h"
@@ -29,6 +31,15 @@ absl::StatusOr<Sample> GenerateSample(
     const SampleOptions& sample_options, absl::BitGenRef bit_gen,
     dslx::FileTable& file_table);
 
+// Returns a sample derived from `parent` by removing a random token from its
+// DSLX (see `dslx::RemoveDslxToken`), with the options of `parent` and freshly
+// generated arguments. Most such mutations do not typecheck, so up to
+// `max_attempts` are tried; returns a NotFound error if none of them yields a
+// well-typed top entity of the same kind as that of `parent`.
+absl::StatusOr<Sample> MutateSample(const Sample& parent,
+                                    absl::BitGenRef bit_gen,
+                                    int64_t max_attempts = 16);
+
 }  // namespace xls
 
 #endif  // XLS_FUZZER_SAMPLE_GENERATOR_H_
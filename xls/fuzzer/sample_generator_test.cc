@@ -22,6 +22,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "xls/common/status/matchers.h"
 #include "xls/dslx/channel_direction.h"
@@ -30,12 +31,15 @@
 #include "xls/dslx/type_system/type.h"
 #include "xls/fuzzer/ast_generator.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample.pb.h"
 #include "xls/fuzzer/value_generator.h"
+#include "xls/tests/testvector.pb.h"
 
 namespace xls {
 namespace {
 
 using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
 using ::testing::HasSubstr;
 
 TEST(SampleGeneratorTest, GenerateBasicFunctionSample) {
@@ -134,5 +138,36 @@ TEST(SampleGeneratorTest, GenerateBasicProcSample) {
   EXPECT_THAT(sample.input_text(), HasSubstr("proc main"));
 }
 
+TEST(SampleGeneratorTest, MutateFunctionSample) {
+  dslx::FileTable file_table;
+  std::mt19937_64 rng;
+  SampleOptions sample_options;
+  constexpr int64_t kCallsPerSample = 4;
+  sample_options.set_calls_per_sample(kCallsPerSample);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Sample parent, GenerateSample(dslx::AstGeneratorOptions{},
+                                    sample_options, rng, file_table));
+  XLS_ASSERT_OK_AND_ASSIGN(Sample mutant,
+                           MutateSample(parent, rng, /*max_attempts=*/256));
+  EXPECT_NE(mutant.input_text(), parent.input_text());
+  EXPECT_THAT(mutant.input_text(), HasSubstr("fn main"));
+  EXPECT_EQ(mutant.options().sample_type(), fuzzer::SAMPLE_TYPE_FUNCTION);
+
+  std::vector<std::vector<dslx::InterpValue>> args_batch;
+  XLS_EXPECT_OK(mutant.GetArgsAndChannels(args_batch));
+  EXPECT_EQ(args_batch.size(), kCallsPerSample);
+}
+
+TEST(SampleGeneratorTest, MutateFailsWithoutWellTypedMutation) {
+  std::mt19937_64 rng;
+  SampleOptions sample_options;
+  sample_options.set_input_is_dslx(true);
+  sample_options.set_sample_type(fuzzer::SAMPLE_TYPE_FUNCTION);
+  // Removing any single token leaves no `main` function.
+  Sample parent("fn main(){}", sample_options, testvector::SampleInputsProto());
+  EXPECT_THAT(MutateSample(parent, rng),
+              StatusIs(absl::StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace xls
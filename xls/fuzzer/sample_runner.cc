@@ -43,6 +43,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/file/filesystem.h"
@@ -64,6 +65,9 @@
 #include "xls/dslx/import_data.h"
 #include "xls/dslx/interp_value.h"
 #include "xls/dslx/interp_value_utils.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/type_system/type.h"
 #include "xls/dslx/type_system/type_info.h"
@@ -72,13 +76,19 @@
 #include "xls/fuzzer/cpp_sample_runner.h"
 #include "xls/fuzzer/sample.h"
 #include "xls/fuzzer/sample.pb.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
+#include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
 #include "xls/public/runtime_build_actions.h"
 #include "xls/simulation/check_simulator.h"
 #include "xls/tests/testvector.pb.h"
 #include "xls/tools/eval_utils.h"
+#include "xls/tools/opt.h"
 #include "re2/re2.h"
 
 // These are used to forward, but also see comment below.
@@ -135,17 +145,31 @@ absl::StatusOr<std::vector<dslx::InterpValue>> RunFunctionBatched(
   return results;
 }
 
-absl::StatusOr<std::vector<dslx::InterpValue>> InterpretDslxFunction(
-    std::string_view text, std::string_view top_name,
-    const ArgsBatch& args_batch, const std::filesystem::path& run_dir) {
-  dslx::ImportData import_data = dslx::CreateImportData(
-      GetDefaultDslxStdlibPath(),
-      /*additional_search_paths=*/{}, dslx::kDefaultWarningsSet,
-      std::make_unique<dslx::RealFilesystem>());
-  XLS_ASSIGN_OR_RETURN(
-      dslx::TypecheckedModule tm,
-      dslx::ParseAndTypecheck(text, "sample.x", "sample", &import_data));
+dslx::ImportData CreateSampleImportData() {
+  return dslx::CreateImportData(GetDefaultDslxStdlibPath(),
+                                /*additional_search_paths=*/{},
+                                dslx::kDefaultWarningsSet,
+                                std::make_unique<dslx::RealFilesystem>());
+}
 
+// Returns the text form of the results of a function sample, as written to the
+// `.results` files.
+std::string FunctionResultsToString(absl::Span<const Value> results) {
+  return absl::StrCat(
+      absl::StrJoin(results, "\n",
+                    [](std::string* out, const Value& value) {
+                      absl::StrAppend(out,
+                                      value.ToString(FormatPreference::kHex));
+                    }),
+      "\n");
+}
+
+// Interprets the function `top_name` of the typechecked DSLX module, returning
+// the results and their text form.
+absl::StatusOr<std::vector<dslx::InterpValue>> InterpretDslxFunctionInModule(
+    const dslx::TypecheckedModule& tm, dslx::ImportData& import_data,
+    std::string_view top_name, const ArgsBatch& args_batch,
+    std::string& results_text) {
   std::optional<dslx::ModuleMember*> module_member =
       tm.module->FindMemberWithName(top_name);
   CHECK(module_member.has_value());
@@ -161,15 +185,23 @@ absl::StatusOr<std::vector<dslx::InterpValue>> InterpretDslxFunction(
       RunFunctionBatched(*f, import_data, tm, converted_args_batch));
   XLS_ASSIGN_OR_RETURN(std::vector<Value> ir_results,
                        dslx::InterpValue::ConvertValuesToIr(results));
-  std::string serialized_results = absl::StrCat(
-      absl::StrJoin(ir_results, "\n",
-                    [](std::string* out, const Value& value) {
-                      absl::StrAppend(out,
-                                      value.ToString(FormatPreference::kHex));
-                    }),
-      "\n");
+  results_text = FunctionResultsToString(ir_results);
+  return results;
+}
+
+absl::StatusOr<std::vector<dslx::InterpValue>> InterpretDslxFunction(
+    std::string_view text, std::string_view top_name,
+    const ArgsBatch& args_batch, const std::filesystem::path& run_dir) {
+  dslx::ImportData import_data = CreateSampleImportData();
+  XLS_ASSIGN_OR_RETURN(
+      dslx::TypecheckedModule tm,
+      dslx::ParseAndTypecheck(text, "sample.x", "sample", &import_data));
+  std::string results_text;
+  XLS_ASSIGN_OR_RETURN(std::vector<dslx::InterpValue> results,
+                       InterpretDslxFunctionInModule(tm, import_data, top_name,
+                                                     args_batch, results_text));
   XLS_RETURN_IF_ERROR(
-      SetFileContents(run_dir / "sample.x.results", serialized_results));
+      SetFileContents(run_dir / "sample.x.results", results_text));
   return results;
 }
 
@@ -600,10 +632,7 @@ absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
 InterpretDslxProc(std::string_view text, std::string_view top_name,
                   const ArgsBatch& args_batch, int tick_count,
                   const std::filesystem::path& run_dir) {
-  dslx::ImportData import_data = dslx::CreateImportData(
-      GetDefaultDslxStdlibPath(),
-      /*additional_search_paths=*/{}, dslx::kDefaultWarningsSet,
-      std::make_unique<dslx::RealFilesystem>());
+  dslx::ImportData import_data = CreateSampleImportData();
   XLS_ASSIGN_OR_RETURN(
       dslx::TypecheckedModule tm,
       dslx::ParseAndTypecheck(text, "sample.x", "sample", &import_data));
@@ -768,24 +797,161 @@ SimulateProc(const std::filesystem::path& verilog_path,
   return unordered_channel_values;
 }
 
-}  // namespace
+// Returns the top function named by the IR converter arguments of a sample, or
+// nullopt if the arguments need ir_converter_main itself to be honored.
+std::optional<std::string> InProcessConversionTop(
+    const SampleOptions& options) {
+  std::optional<std::string> top;
+  for (std::string_view arg : options.ir_converter_args()) {
+    if (!absl::ConsumePrefix(&arg, "--top=")) {
+      return std::nullopt;
+    }
+    top = std::string(arg);
+  }
+  return top;
+}
 
-absl::Status SampleRunner::Run(const Sample& sample) {
-  std::filesystem::path input_path = run_dir_;
-  if (sample.options().input_is_dslx()) {
-    input_path /= "sample.x";
+// Applies the sample's known failures to the failure of a stage run in-process
+// in place of `tool`, matching the failure message as RunCommandFromExecutable
+// matches the tool's stderr.
+absl::Status InProcessStageError(std::string_view tool,
+                                 const absl::Status& status,
+                                 const SampleOptions& options) {
+  for (const KnownFailure& filter : options.known_failures()) {
+    if ((filter.tool == nullptr || RE2::FullMatch(tool, *filter.tool)) &&
+        RE2::PartialMatch(status.message(), *filter.stderr_regex)) {
+      return absl::FailedPreconditionError(
+          absl::StrFormat("%s failed but failure was suppressed due to stderr "
+                          "regexp: %s",
+                          tool, status.message()));
+    }
+  }
+  return status;
+}
+
+// Parses the function arguments of the testvector as eval_ir_main does.
+absl::StatusOr<std::vector<std::vector<Value>>> IrFunctionArgs(
+    const testvector::SampleInputsProto& testvector) {
+  std::vector<std::vector<Value>> args_batch;
+  for (std::string_view arg_line : testvector.function_args().args()) {
+    std::vector<Value>& args = args_batch.emplace_back();
+    for (std::string_view arg :
+         absl::StrSplit(arg_line, ';', absl::SkipWhitespace())) {
+      XLS_ASSIGN_OR_RETURN(Value value, Parser::ParseTypedValue(arg));
+      args.push_back(std::move(value));
+    }
+  }
+  return args_batch;
+}
+
+// Evaluates the function on each set of arguments, returning the results and
+// their text form.
+absl::StatusOr<std::vector<dslx::InterpValue>> EvaluateIrFunctionInProcess(
+    Function* f, absl::Span<const std::vector<Value>> args_batch, bool use_jit,
+    const SampleOptions& options, std::string& results_text) {
+  std::vector<Value> ir_results;
+  if (use_jit) {
+    absl::StatusOr<std::unique_ptr<FunctionJit>> jit = FunctionJit::Create(f);
+    if (!jit.ok()) {
+      return InProcessStageError("eval_ir_main", jit.status(), options);
+    }
+    absl::StatusOr<std::vector<Value>> results =
+        DropInterpreterEvents((*jit)->RunBatched(args_batch));
+    if (!results.ok()) {
+      return InProcessStageError("eval_ir_main", results.status(), options);
+    }
+    ir_results = *std::move(results);
   } else {
-    input_path /= "sample.ir";
+    ir_results.reserve(args_batch.size());
+    for (const std::vector<Value>& args : args_batch) {
+      absl::StatusOr<Value> result =
+          DropInterpreterEvents(InterpretFunction(f, args));
+      if (!result.ok()) {
+        return InProcessStageError("eval_ir_main", result.status(), options);
+      }
+      ir_results.push_back(*std::move(result));
+    }
+  }
+  results_text = FunctionResultsToString(ir_results);
+  std::vector<dslx::InterpValue> results;
+  results.reserve(ir_results.size());
+  for (const Value& value : ir_results) {
+    XLS_ASSIGN_OR_RETURN(dslx::InterpValue interp_value,
+                         dslx::ValueToInterpValue(value));
+    results.push_back(std::move(interp_value));
   }
-  XLS_RETURN_IF_ERROR(SetFileContents(input_path, sample.input_text()));
+  return results;
+}
 
-  std::filesystem::path options_path = run_dir_ / "options.pbtxt";
-  XLS_RETURN_IF_ERROR(SetTextProtoFile(options_path, sample.options().proto()));
+struct SampleFiles {
+  std::filesystem::path input_path;
+  std::filesystem::path options_path;
+  std::filesystem::path testvector_path;
+};
+
+// Writes the sample's input, options and testvector to the run directory.
+absl::StatusOr<SampleFiles> WriteSampleFiles(
+    const Sample& sample, const std::filesystem::path& run_dir) {
+  SampleFiles files{
+      .input_path = run_dir /
+                    (sample.options().input_is_dslx() ? "sample.x"
+                                                      : "sample.ir"),
+      .options_path = run_dir / "options.pbtxt",
+      .testvector_path = run_dir / "testvector.pbtxt",
+  };
+  XLS_RETURN_IF_ERROR(SetFileContents(files.input_path, sample.input_text()));
+  XLS_RETURN_IF_ERROR(
+      SetTextProtoFile(files.options_path, sample.options().proto()));
+  XLS_RETURN_IF_ERROR(
+      SetTextProtoFile(files.testvector_path, sample.testvector()));
+  return files;
+}
 
-  std::filesystem::path testvector_path = run_dir_ / "testvector.pbtxt";
-  XLS_RETURN_IF_ERROR(SetTextProtoFile(testvector_path, sample.testvector()));
+// Records a failed sample's status in the run directory. Failed preconditions
+// mean the sample is outside the fuzz domain, so they are not failures.
+absl::Status FinishSample(absl::Status status,
+                          const std::filesystem::path& run_dir) {
+  if (!status.ok()) {
+    LOG(ERROR) << "Exception when running sample: " << status.ToString();
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(run_dir / "exception.txt", status.ToString()));
+  }
+  if (status.code() == absl::StatusCode::kFailedPrecondition) {
+    LOG(ERROR)
+        << "Precondition failed, sample is not valid in the fuzz domain due to "
+        << status;
+    status = absl::OkStatus();
+  }
+  return status;
+}
+
+}  // namespace
 
-  return RunFromFiles(input_path, options_path, testvector_path);
+absl::Status SampleRunner::Run(const Sample& sample) {
+  const SampleOptions& options = sample.options();
+  std::optional<std::string> top = InProcessConversionTop(options);
+  if (mode_ == Mode::kInProcess &&
+      options.sample_type() == fuzzer::SampleType::SAMPLE_TYPE_FUNCTION &&
+      (top.has_value() || !options.input_is_dslx())) {
+    VLOG(1) << "Running sample in-process";
+    absl::btree_map<std::string, std::string> artifacts;
+    absl::Status status =
+        RunFunctionInProcess(sample, top.value_or(""), artifacts);
+    if (status.ok()) {
+      return status;
+    }
+    XLS_RETURN_IF_ERROR(WriteSampleFiles(sample, run_dir_).status());
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(run_dir_ / "revision.txt", GetRevision()));
+    for (const auto& [filename, contents] : artifacts) {
+      XLS_RETURN_IF_ERROR(SetFileContents(run_dir_ / filename, contents));
+    }
+    return FinishSample(std::move(status), run_dir_);
+  }
+
+  XLS_ASSIGN_OR_RETURN(SampleFiles files, WriteSampleFiles(sample, run_dir_));
+  return RunFromFiles(files.input_path, files.options_path,
+                      files.testvector_path);
 }
 
 absl::Status SampleRunner::RunFromFiles(
@@ -816,18 +982,34 @@ absl::Status SampleRunner::RunFromFiles(
           fuzzer::SampleType_Name(options.sample_type()));
       break;
   }
-  if (!status.ok()) {
-    LOG(ERROR) << "Exception when running sample: " << status.ToString();
-    XLS_RETURN_IF_ERROR(
-        SetFileContents(run_dir_ / "exception.txt", status.ToString()));
+  return FinishSample(std::move(status), run_dir_);
+}
+
+absl::StatusOr<bool> SampleRunner::SkipDuplicateCodegen(
+    Package* opt_package, const SampleOptions& options) {
+  if (deduplicator_ == nullptr ||
+      !(options.codegen() || options.codegen_ng())) {
+    return false;
   }
-  if (status.code() == absl::StatusCode::kFailedPrecondition) {
-    LOG(ERROR)
-        << "Precondition failed, sample is not valid in the fuzz domain due to "
-        << status;
-    status = absl::OkStatus();
+  XLS_ASSIGN_OR_RETURN(bool is_new,
+                       deduplicator_->RecordIfNew(opt_package, options));
+  if (!is_new) {
+    LOG(INFO) << "Optimized IR matches that of an earlier sample; skipping "
+                 "code generation and simulation.";
   }
-  return status;
+  return !is_new;
+}
+
+absl::StatusOr<bool> SampleRunner::SkipDuplicateCodegen(
+    const std::filesystem::path& opt_ir_path, const SampleOptions& options) {
+  if (deduplicator_ == nullptr ||
+      !(options.codegen() || options.codegen_ng())) {
+    return false;
+  }
+  XLS_ASSIGN_OR_RETURN(std::string opt_ir, GetFileContents(opt_ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(opt_ir, opt_ir_path.string()));
+  return SkipDuplicateCodegen(package.get(), options);
 }
 
 absl::Status SampleRunner::RunFunction(
@@ -920,7 +1102,10 @@ absl::Status SampleRunner::RunFunction(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
     }
 
-    if (options.codegen()) {
+    XLS_ASSIGN_OR_RETURN(bool skip_codegen,
+                         SkipDuplicateCodegen(opt_ir_path, options));
+
+    if (options.codegen() && !skip_codegen) {
       t.Reset();
       XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
                            Codegen(opt_ir_path, options.codegen_args(), options,
@@ -938,7 +1123,7 @@ absl::Status SampleRunner::RunFunction(
       }
     }
 
-    if (options.codegen_ng()) {
+    if (options.codegen_ng() && !skip_codegen) {
       t.Reset();
       XLS_ASSIGN_OR_RETURN(
           std::filesystem::path verilog_path,
@@ -965,6 +1150,168 @@ absl::Status SampleRunner::RunFunction(
       results_spans, args_batch.has_value() ? &*args_batch : nullptr);
 }
 
+absl::Status SampleRunner::RunFunctionInProcess(
+    const Sample& sample, std::string_view top,
+    absl::btree_map<std::string, std::string>& artifacts) {
+  const SampleOptions& options = sample.options();
+  ArgsBatch args_batch;
+  XLS_RETURN_IF_ERROR(
+      Sample::ExtractArgsBatch(options, sample.testvector(), args_batch));
+  XLS_ASSIGN_OR_RETURN(std::vector<std::vector<Value>> ir_args_batch,
+                       IrFunctionArgs(sample.testvector()));
+
+  // Results from various ways of interpretation.
+  absl::flat_hash_map<std::string, std::vector<dslx::InterpValue>> results;
+
+  std::unique_ptr<Package> package;
+  if (options.input_is_dslx()) {
+    VLOG(1) << "Interpreting DSLX file.";
+    Stopwatch t;
+    // The typechecked module is shared by the interpreter and IR conversion.
+    dslx::ImportData import_data = CreateSampleImportData();
+    XLS_ASSIGN_OR_RETURN(dslx::TypecheckedModule tm,
+                         dslx::ParseAndTypecheck(sample.input_text(),
+                                                 "sample.x", "sample",
+                                                 &import_data));
+    XLS_ASSIGN_OR_RETURN(
+        results["interpreted DSLX"],
+        InterpretDslxFunctionInModule(tm, import_data, "main", args_batch,
+                                      artifacts["sample.x.results"]));
+    absl::Duration elapsed = t.GetElapsedTime();
+    VLOG(1) << "Interpreting DSLX complete, elapsed: " << elapsed;
+    timing_.set_interpret_dslx_ns(absl::ToInt64Nanoseconds(elapsed));
+
+    if (!options.convert_to_ir()) {
+      return absl::OkStatus();
+    }
+
+    t.Reset();
+    dslx::PackageConversionData conversion_data{
+        .package = std::make_unique<Package>("sample")};
+    if (absl::Status status = dslx::ConvertOneFunctionIntoPackage(
+            tm.module, top, &import_data, /*parametric_env=*/nullptr,
+            dslx::ConvertOptions{.warnings_as_errors = false},
+            &conversion_data);
+        !status.ok()) {
+      return InProcessStageError("ir_converter_main", status, options);
+    }
+    package = std::move(conversion_data.package);
+    timing_.set_convert_ir_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+  } else {
+    XLS_ASSIGN_OR_RETURN(package, Parser::ParsePackage(sample.input_text()));
+  }
+  artifacts["sample.ir"] = package->DumpIr();
+  XLS_ASSIGN_OR_RETURN(Function * f, package->GetTopAsFunction());
+
+  {
+    Stopwatch t;
+
+    // Unconditionally evaluate with the interpreter even if using the JIT. This
+    // exercises the interpreter and serves as a reference.
+    XLS_ASSIGN_OR_RETURN(
+        results["evaluated unopt IR (interpreter)"],
+        EvaluateIrFunctionInProcess(f, ir_args_batch, /*use_jit=*/false,
+                                    options, artifacts["sample.ir.results"]));
+    timing_.set_unoptimized_interpret_ir_ns(
+        absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+
+    if (options.use_jit()) {
+      XLS_ASSIGN_OR_RETURN(
+          results["evaluated unopt IR (JIT)"],
+          EvaluateIrFunctionInProcess(f, ir_args_batch, /*use_jit=*/true,
+                                      options,
+                                      artifacts["sample.ir.results"]));
+      timing_.set_unoptimized_jit_ns(
+          absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+    }
+  }
+
+  if (options.optimize_ir()) {
+    Stopwatch t;
+    if (absl::Status status =
+            tools::OptimizeIrForTop(package.get(), tools::OptOptions{});
+        !status.ok()) {
+      return InProcessStageError("opt_main", status, options);
+    }
+    XLS_ASSIGN_OR_RETURN(f, package->GetTopAsFunction());
+    artifacts["sample.opt.ir"] = package->DumpIr();
+    timing_.set_optimize_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+
+    if (options.use_jit()) {
+      t.Reset();
+      XLS_ASSIGN_OR_RETURN(
+          results["evaluated opt IR (JIT)"],
+          EvaluateIrFunctionInProcess(f, ir_args_batch, /*use_jit=*/true,
+                                      options,
+                                      artifacts["sample.opt.ir.results"]));
+      timing_.set_optimized_jit_ns(
+          absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+    }
+    t.Reset();
+    XLS_ASSIGN_OR_RETURN(
+        results["evaluated opt IR (interpreter)"],
+        EvaluateIrFunctionInProcess(f, ir_args_batch, /*use_jit=*/false,
+                                    options,
+                                    artifacts["sample.opt.ir.results"]));
+    timing_.set_optimized_interpret_ir_ns(
+        absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+
+    XLS_ASSIGN_OR_RETURN(bool skip_codegen,
+                         SkipDuplicateCodegen(package.get(), options));
+
+    // The code generator and simulators only run as tools, which need their
+    // inputs on disk.
+    if ((options.codegen() || options.codegen_ng()) && !skip_codegen) {
+      std::filesystem::path opt_ir_path = run_dir_ / "sample.opt.ir";
+      XLS_RETURN_IF_ERROR(
+          SetFileContents(opt_ir_path, artifacts["sample.opt.ir"]));
+      std::filesystem::path testvector_path = run_dir_ / "testvector.pbtxt";
+      XLS_RETURN_IF_ERROR(
+          SetTextProtoFile(testvector_path, sample.testvector()));
+
+      if (options.codegen()) {
+        t.Reset();
+        XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
+                             Codegen(opt_ir_path, options.codegen_args(),
+                                     options, run_dir_, commands_));
+        timing_.set_codegen_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+
+        if (options.simulate()) {
+          t.Reset();
+          XLS_ASSIGN_OR_RETURN(
+              results["simulated"],
+              SimulateFunction(verilog_path, "module_sig.textproto",
+                               testvector_path, options, run_dir_, commands_));
+          timing_.set_simulate_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+        }
+      }
+
+      if (options.codegen_ng()) {
+        t.Reset();
+        XLS_ASSIGN_OR_RETURN(
+            std::filesystem::path verilog_path,
+            Codegen(opt_ir_path, options.codegen_args(), options, run_dir_,
+                    commands_, /*use_codegen_ng=*/true));
+        timing_.set_codegen_ng_ns(absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+
+        if (options.simulate()) {
+          t.Reset();
+          XLS_ASSIGN_OR_RETURN(
+              results["simulated_ng"],
+              SimulateFunction(verilog_path, "module_sig.ng.textproto",
+                               testvector_path, options, run_dir_, commands_));
+          timing_.set_simulate_ng_ns(
+              absl::ToInt64Nanoseconds(t.GetElapsedTime()));
+        }
+      }
+    }
+  }
+
+  absl::flat_hash_map<std::string, absl::Span<const dslx::InterpValue>>
+      results_spans(results.begin(), results.end());
+  return CompareResultsFunction(results_spans, &args_batch);
+}
+
 absl::Status SampleRunner::RunProc(
     const std::filesystem::path& input_path, const SampleOptions& options,
     const std::filesystem::path& testvector_path) {
@@ -1077,7 +1424,10 @@ absl::Status SampleRunner::RunProc(
       timing_.set_optimized_interpret_ir_ns(
           absl::ToInt64Nanoseconds(t.GetElapsedTime()));
 
-      if (options.codegen()) {
+      XLS_ASSIGN_OR_RETURN(bool skip_codegen,
+                           SkipDuplicateCodegen(*opt_ir_path, options));
+
+      if (options.codegen() && !skip_codegen) {
         t.Reset();
         XLS_ASSIGN_OR_RETURN(std::filesystem::path verilog_path,
                              Codegen(*opt_ir_path, options.codegen_args(),
@@ -1100,7 +1450,7 @@ absl::Status SampleRunner::RunProc(
         }
       }
 
-      if (options.codegen_ng()) {
+      if (options.codegen_ng() && !skip_codegen) {
         t.Reset();
         XLS_ASSIGN_OR_RETURN(
             std::filesystem::path verilog_path,
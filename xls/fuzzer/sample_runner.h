@@ -15,17 +15,22 @@
 #ifndef XLS_FUZZER_SAMPLE_RUNNER_H_
 #define XLS_FUZZER_SAMPLE_RUNNER_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/container/btree_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/fuzzer/sample.h"
+#include "xls/fuzzer/sample_dedup.h"
 #include "xls/fuzzer/sample_summary.pb.h"
+#include "xls/ir/package.h"
 
 namespace xls {
 
@@ -43,6 +48,19 @@ namespace xls {
 // enable easier debugging and replay.
 class SampleRunner {
  public:
+  // How the stages of a sample are run.
+  enum class Mode : uint8_t {
+    // Each stage is a subprocess of its tool, reading its inputs from and
+    // writing its outputs to the run directory. A crashing tool can't take the
+    // runner down with it.
+    kSubprocess,
+    // DSLX interpretation, IR conversion, optimization and IR evaluation of
+    // function samples run in this process, passing packages in memory; files
+    // are only written to the run directory if the sample fails. Code
+    // generation and simulation, and proc samples, still use subprocesses.
+    kInProcess,
+  };
+
   struct Commands {
     // Call the particular operation with given arguments and options. Return
     // their output or failure status.
@@ -64,6 +82,10 @@ class SampleRunner {
       : run_dir_(std::move(run_dir)) {}
   SampleRunner(std::filesystem::path run_dir, Commands commands)
       : run_dir_(std::move(run_dir)), commands_(std::move(commands)) {}
+  SampleRunner(std::filesystem::path run_dir, Commands commands, Mode mode)
+      : run_dir_(std::move(run_dir)),
+        commands_(std::move(commands)),
+        mode_(mode) {}
 
   // Runs the provided sample, writing out files under the SampleRunner's
   // `run_dir` as appropriate.
@@ -77,6 +99,13 @@ class SampleRunner {
 
   const fuzzer::SampleTimingProto& timing() const { return timing_; }
 
+  // If set, code generation and simulation are skipped for samples whose
+  // optimized IR (up to renaming) and codegen options were already recorded
+  // in `deduplicator`; the other stages still run and are compared.
+  void set_deduplicator(SampleDeduplicator* deduplicator) {
+    deduplicator_ = deduplicator;
+  }
+
  private:
   // Runs a sample with a function as the top which is read from files.
   absl::Status RunFunction(const std::filesystem::path& input_path,
@@ -87,9 +116,25 @@ class SampleRunner {
                        const SampleOptions& options,
                        const std::filesystem::path& testvector_path);
 
+  // Runs a sample with a function as the top in Mode::kInProcess. Files which
+  // should be written to `run_dir` if the sample fails are added to
+  // `artifacts`, keyed by filename.
+  absl::Status RunFunctionInProcess(
+      const Sample& sample, std::string_view top,
+      absl::btree_map<std::string, std::string>& artifacts);
+
+  // Returns whether code generation and simulation should be skipped as the
+  // sample with optimized IR `opt_package` duplicates an earlier one.
+  absl::StatusOr<bool> SkipDuplicateCodegen(Package* opt_package,
+                                            const SampleOptions& options);
+  absl::StatusOr<bool> SkipDuplicateCodegen(
+      const std::filesystem::path& opt_ir_path, const SampleOptions& options);
+
   const std::filesystem::path run_dir_;
   const Commands commands_;
+  const Mode mode_ = Mode::kSubprocess;
   fuzzer::SampleTimingProto timing_;
+  SampleDeduplicator* deduplicator_ = nullptr;
 };
 
 }  // namespace xls
@@ -738,6 +738,47 @@ TEST_F(SampleRunnerTest, BadIRInput) {
               IsOkAndHolds(HasSubstr("Expected 'package' keyword")));
 }
 
+TEST_F(SampleRunnerTest, InProcessWritesNothingOnSuccess) {
+  SampleRunner runner(GetTempPath(), {}, SampleRunner::Mode::kInProcess);
+  constexpr std::string_view dslx_text =
+      "fn main(x: u8, y: u8) -> u8 { x + y }";
+  SampleOptions options;
+  options.set_input_is_dslx(true);
+  options.set_ir_converter_args({"--top=main"});
+  options.set_codegen(false);
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"},
+                                        {"bits[8]:222", "bits[8]:240"}}));
+  XLS_ASSERT_OK(
+      runner.Run(Sample(std::string(dslx_text), options, args_batch)));
+  EXPECT_TRUE(std::filesystem::is_empty(GetTempPath()));
+  EXPECT_GT(runner.timing().optimize_ns(), 0);
+}
+
+TEST_F(SampleRunnerTest, InProcessWritesArtifactsOnFailure) {
+  SampleRunner runner(GetTempPath(), {}, SampleRunner::Mode::kInProcess);
+  constexpr std::string_view ir_text = R"(
+package foo
+
+top fn foo(x: bits[8]) -> bits[8] {
+  ret identity.1: bits[8] = identity(x)
+}
+)";
+  SampleOptions options;
+  options.set_input_is_dslx(false);
+  options.set_codegen(false);
+  // An argument count mismatch makes evaluation fail after the IR is parsed.
+  XLS_ASSERT_OK_AND_ASSIGN(ArgsBatch args_batch,
+                           ToArgsBatch({{"bits[8]:42", "bits[8]:100"}}));
+  EXPECT_FALSE(
+      runner.Run(Sample(std::string(ir_text), options, args_batch)).ok());
+  EXPECT_THAT(GetFileContents(GetTempPath() / "sample.ir"),
+              IsOkAndHolds(HasSubstr("package foo")));
+  XLS_EXPECT_OK(GetFileContents(GetTempPath() / "options.pbtxt"));
+  XLS_EXPECT_OK(GetFileContents(GetTempPath() / "testvector.pbtxt"));
+  XLS_EXPECT_OK(GetFileContents(GetTempPath() / "exception.txt"));
+}
+
 TEST_F(SampleRunnerTest, Timeout) {
   SampleRunner runner(GetTempPath());
   SampleOptions options;
@@ -0,0 +1,231 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/async_proc_runtime.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+
+namespace xls {
+
+AsyncProcRuntime::AsyncProcRuntime(ProcRuntime* runtime,
+                                   const AsyncProcRuntimeOptions& options)
+    : runtime_(runtime), options_(options) {}
+
+AsyncProcRuntime::~AsyncProcRuntime() { Stop().IgnoreError(); }
+
+absl::Status AsyncProcRuntime::CheckOutputRegistration(
+    ChannelInstance* channel_instance) {
+  if (thread_ != nullptr) {
+    return absl::FailedPreconditionError(
+        "Output callbacks must be registered before the runtime is started");
+  }
+  if (channel_instance->channel->supported_ops() != ChannelOps::kSendOnly) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Channel `%s` is not a send-only channel",
+                        channel_instance->channel->name()));
+  }
+  for (const OutputChannel& output : outputs_) {
+    if (output.channel_instance == channel_instance) {
+      return absl::AlreadyExistsError(
+          absl::StrFormat("Channel instance `%s` already has a callback",
+                          channel_instance->ToString()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AsyncProcRuntime::OnOutput(ChannelInstance* channel_instance,
+                                        OutputCallback callback) {
+  XLS_RETURN_IF_ERROR(CheckOutputRegistration(channel_instance));
+  outputs_.push_back(OutputChannel{.channel_instance = channel_instance,
+                                   .callback = std::move(callback)});
+  return absl::OkStatus();
+}
+
+absl::Status AsyncProcRuntime::OnOutput(Channel* channel,
+                                        OutputCallback callback) {
+  XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                       runtime_->elaboration().GetUniqueInstance(channel));
+  return OnOutput(channel_instance, std::move(callback));
+}
+
+absl::Status AsyncProcRuntime::OnOutputRaw(ChannelInstance* channel_instance,
+                                           RawOutputCallback callback) {
+  XLS_RETURN_IF_ERROR(CheckOutputRegistration(channel_instance));
+  XLS_ASSIGN_OR_RETURN(JitChannelQueueManager * queue_manager,
+                       runtime_->GetJitChannelQueueManager());
+  int64_t byte_size = queue_manager->runtime().GetTypeByteSize(
+      channel_instance->channel->type());
+  outputs_.push_back(OutputChannel{.channel_instance = channel_instance,
+                                   .raw_callback = std::move(callback),
+                                   .jit_queue = &queue_manager->GetJitQueue(
+                                       channel_instance),
+                                   .buffer = std::vector<uint8_t>(byte_size)});
+  return absl::OkStatus();
+}
+
+absl::Status AsyncProcRuntime::Start() {
+  XLS_RET_CHECK(thread_ == nullptr) << "Runtime already started";
+  {
+    absl::MutexLock lock(&mutex_);
+    stop_requested_ = false;
+    done_ = false;
+  }
+  thread_ = std::make_unique<Thread>([this]() { Run(); });
+  return absl::OkStatus();
+}
+
+absl::Status AsyncProcRuntime::CheckInput(ChannelInstance* channel_instance) {
+  if (channel_instance->channel->supported_ops() != ChannelOps::kReceiveOnly) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Channel `%s` is not a receive-only channel",
+                        channel_instance->channel->name()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status AsyncProcRuntime::Write(ChannelInstance* channel_instance,
+                                     const Value& value) {
+  XLS_RETURN_IF_ERROR(CheckInput(channel_instance));
+  XLS_RETURN_IF_ERROR(
+      runtime_->queue_manager().GetQueue(channel_instance).Write(value));
+  Notify();
+  return absl::OkStatus();
+}
+
+absl::Status AsyncProcRuntime::Write(Channel* channel, const Value& value) {
+  XLS_ASSIGN_OR_RETURN(ChannelInstance * channel_instance,
+                       runtime_->elaboration().GetUniqueInstance(channel));
+  return Write(channel_instance, value);
+}
+
+absl::Status AsyncProcRuntime::WriteRaw(ChannelInstance* channel_instance,
+                                        const uint8_t* data) {
+  XLS_RETURN_IF_ERROR(CheckInput(channel_instance));
+  XLS_ASSIGN_OR_RETURN(JitChannelQueueManager * queue_manager,
+                       runtime_->GetJitChannelQueueManager());
+  queue_manager->GetJitQueue(channel_instance).WriteRaw(data);
+  Notify();
+  return absl::OkStatus();
+}
+
+void AsyncProcRuntime::Notify() {
+  absl::MutexLock lock(&mutex_);
+  input_pending_ = true;
+}
+
+absl::Status AsyncProcRuntime::WaitUntilBlocked() {
+  absl::MutexLock lock(&mutex_);
+  if (thread_ == nullptr) {
+    return absl::FailedPreconditionError("Runtime has not been started");
+  }
+  auto settled = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return (blocked_ && !input_pending_) || done_;
+  };
+  mutex_.Await(absl::Condition(&settled));
+  return status_;
+}
+
+absl::Status AsyncProcRuntime::Stop() {
+  if (thread_ != nullptr) {
+    {
+      absl::MutexLock lock(&mutex_);
+      stop_requested_ = true;
+    }
+    thread_->Join();
+    thread_.reset();
+  }
+  absl::MutexLock lock(&mutex_);
+  return status_;
+}
+
+int64_t AsyncProcRuntime::tick_count() const {
+  absl::MutexLock lock(&mutex_);
+  return tick_count_;
+}
+
+void AsyncProcRuntime::DeliverOutputs() {
+  for (OutputChannel& output : outputs_) {
+    if (output.jit_queue != nullptr) {
+      while (output.jit_queue->ReadRaw(output.buffer.data())) {
+        output.raw_callback(output.buffer);
+      }
+      continue;
+    }
+    ChannelQueue& queue =
+        runtime_->queue_manager().GetQueue(output.channel_instance);
+    while (std::optional<Value> value = queue.Read()) {
+      output.callback(*value);
+    }
+  }
+}
+
+void AsyncProcRuntime::Run() {
+  auto woken = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return input_pending_ || stop_requested_;
+  };
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      // Inputs written before this point are visible to the ticks below.
+      input_pending_ = false;
+      blocked_ = false;
+    }
+    absl::StatusOr<int64_t> ticks =
+        runtime_->TickUntilBlocked(options_.max_ticks_per_slice);
+    // TickUntilBlocked reports a slice which ends before the network blocks
+    // as DeadlineExceeded; that is not an error here.
+    bool slice_ended = absl::IsDeadlineExceeded(ticks.status());
+    DeliverOutputs();
+
+    absl::MutexLock lock(&mutex_);
+    if (ticks.ok()) {
+      tick_count_ += *ticks;
+      blocked_ = true;
+      mutex_.Await(absl::Condition(&woken));
+    } else if (slice_ended) {
+      tick_count_ += options_.max_ticks_per_slice;
+    } else {
+      status_ = ticks.status();
+      done_ = true;
+      return;
+    }
+    if (stop_requested_) {
+      done_ = true;
+      return;
+    }
+  }
+}
+
+}  // namespace xls
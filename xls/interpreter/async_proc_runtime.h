@@ -0,0 +1,143 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_ASYNC_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_ASYNC_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/thread.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
+
+namespace xls {
+
+struct AsyncProcRuntimeOptions {
+  // Maximum number of network ticks between deliveries of output values to
+  // the registered callbacks. Networks which never block on input still have
+  // their outputs delivered at least this often.
+  int64_t max_ticks_per_slice = 64;
+};
+
+// Drives a ProcRuntime on a background thread for co-simulation with models
+// outside of XLS. The runtime ticks autonomously until every proc with IO is
+// blocked on a receive, delivers the values sent on output channels to the
+// registered callbacks, and then sleeps until external code writes more
+// input. This replaces polling loops around ProcRuntime::Tick.
+//
+// Callbacks run on the runtime thread. They may call Write/WriteRaw (e.g. to
+// feed a response from a reference model back into the network) but must not
+// call WaitUntilBlocked or Stop.
+class AsyncProcRuntime {
+ public:
+  // Callbacks receiving one value read from an output channel. The raw form
+  // receives the value in the JIT's native layout and is only available when
+  // the runtime's queues are JitChannelQueues; the span is valid only for the
+  // duration of the call.
+  using OutputCallback = std::function<void(const Value&)>;
+  using RawOutputCallback = std::function<void(absl::Span<const uint8_t>)>;
+
+  // `runtime` must outlive this object and must not be ticked by anyone else
+  // while the background thread is running.
+  explicit AsyncProcRuntime(ProcRuntime* runtime,
+                            const AsyncProcRuntimeOptions& options = {});
+  ~AsyncProcRuntime();
+
+  AsyncProcRuntime(const AsyncProcRuntime&) = delete;
+  AsyncProcRuntime& operator=(const AsyncProcRuntime&) = delete;
+
+  // Registers a callback for every value sent on the given send-only channel.
+  // Values are read out of the channel queue by the runtime thread, so
+  // external code must not read the queue itself. Must be called before
+  // Start.
+  absl::Status OnOutput(ChannelInstance* channel_instance,
+                        OutputCallback callback);
+  absl::Status OnOutput(Channel* channel, OutputCallback callback);
+  absl::Status OnOutputRaw(ChannelInstance* channel_instance,
+                           RawOutputCallback callback);
+
+  // Starts ticking the network on the background thread. The runtime may be
+  // restarted after Stop.
+  absl::Status Start();
+
+  // Writes a value to the given receive-only channel and wakes the runtime.
+  // May be called from any thread, but at most one thread may write to a
+  // given channel at a time.
+  absl::Status Write(ChannelInstance* channel_instance, const Value& value);
+  absl::Status Write(Channel* channel, const Value& value);
+
+  // Writes a value in the JIT's native layout directly into the channel's
+  // JitChannelQueue buffer, avoiding the construction of an xls::Value.
+  absl::Status WriteRaw(ChannelInstance* channel_instance,
+                        const uint8_t* data);
+
+  // Wakes the runtime after external code has written to a channel queue
+  // through some other means, e.g. the queue manager.
+  void Notify();
+
+  // Blocks until the network is blocked on external input and all outputs
+  // produced so far have been delivered to the callbacks, or until the runtime
+  // stops because of an error. Returns the runtime's status.
+  absl::Status WaitUntilBlocked();
+
+  // Stops the background thread and returns the runtime's status. Idempotent.
+  absl::Status Stop();
+
+  // Returns the number of network ticks executed so far.
+  int64_t tick_count() const;
+
+ private:
+  struct OutputChannel {
+    ChannelInstance* channel_instance;
+    OutputCallback callback;
+    RawOutputCallback raw_callback;
+    // The queue and staging buffer for raw reads; only set along with
+    // `raw_callback`.
+    JitChannelQueue* jit_queue = nullptr;
+    std::vector<uint8_t> buffer;
+  };
+
+  absl::Status CheckOutputRegistration(ChannelInstance* channel_instance);
+  absl::Status CheckInput(ChannelInstance* channel_instance);
+  void Run();
+  void DeliverOutputs();
+
+  ProcRuntime* runtime_;
+  AsyncProcRuntimeOptions options_;
+  std::vector<OutputChannel> outputs_;
+  std::unique_ptr<Thread> thread_;
+
+  mutable absl::Mutex mutex_;
+  // Set by writers and cleared by the runtime thread before it ticks.
+  bool input_pending_ ABSL_GUARDED_BY(mutex_) = false;
+  bool blocked_ ABSL_GUARDED_BY(mutex_) = false;
+  bool stop_requested_ ABSL_GUARDED_BY(mutex_) = false;
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  int64_t tick_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_ASYNC_PROC_RUNTIME_H_
@@ -0,0 +1,142 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/async_proc_runtime.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+// A proc which sends the running sum of the values it receives.
+constexpr char kAccumulatorIr[] = R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc accum(tkn: token, sum: bits[32], init={token, 0}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel=in)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  add.4: bits[32] = add(sum, tuple_index.3)
+  send.5: token = send(tuple_index.2, add.4, channel=out)
+  next (send.5, add.4)
+}
+)";
+
+TEST(AsyncProcRuntimeTest, DeliversOutputsAsInputsArrive) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kAccumulatorIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, p->GetChannel("in"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, p->GetChannel("out"));
+
+  AsyncProcRuntime async_runtime(runtime.get());
+  std::vector<Value> outputs;
+  XLS_ASSERT_OK(async_runtime.OnOutput(
+      out, [&](const Value& value) { outputs.push_back(value); }));
+  XLS_ASSERT_OK(async_runtime.Start());
+  XLS_ASSERT_OK(async_runtime.WaitUntilBlocked());
+  EXPECT_TRUE(outputs.empty());
+
+  XLS_ASSERT_OK(async_runtime.Write(in, Value(UBits(1, 32))));
+  XLS_ASSERT_OK(async_runtime.Write(in, Value(UBits(2, 32))));
+  XLS_ASSERT_OK(async_runtime.WaitUntilBlocked());
+  EXPECT_THAT(outputs, ElementsAre(Value(UBits(1, 32)), Value(UBits(3, 32))));
+
+  XLS_ASSERT_OK(async_runtime.Write(in, Value(UBits(10, 32))));
+  XLS_ASSERT_OK(async_runtime.WaitUntilBlocked());
+  EXPECT_THAT(outputs, ElementsAre(Value(UBits(1, 32)), Value(UBits(3, 32)),
+                                   Value(UBits(13, 32))));
+  XLS_EXPECT_OK(async_runtime.Stop());
+  EXPECT_GE(async_runtime.tick_count(), 3);
+  EXPECT_TRUE(runtime->queue_manager().GetQueue(out).IsEmpty());
+}
+
+TEST(AsyncProcRuntimeTest, RawInputsAndOutputs) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kAccumulatorIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateJitSerialProcRuntime(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, p->GetChannel("in"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, p->GetChannel("out"));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelInstance * in_instance,
+                           runtime->elaboration().GetUniqueInstance(in));
+  XLS_ASSERT_OK_AND_ASSIGN(ChannelInstance * out_instance,
+                           runtime->elaboration().GetUniqueInstance(out));
+
+  AsyncProcRuntime async_runtime(runtime.get());
+  std::vector<uint32_t> outputs;
+  XLS_ASSERT_OK(async_runtime.OnOutputRaw(
+      out_instance, [&](absl::Span<const uint8_t> data) {
+        ASSERT_EQ(data.size(), sizeof(uint32_t));
+        uint32_t value;
+        memcpy(&value, data.data(), sizeof(value));
+        outputs.push_back(value);
+      }));
+  XLS_ASSERT_OK(async_runtime.Start());
+  for (uint32_t i = 1; i <= 4; ++i) {
+    XLS_ASSERT_OK(async_runtime.WriteRaw(
+        in_instance, reinterpret_cast<const uint8_t*>(&i)));
+  }
+  XLS_ASSERT_OK(async_runtime.WaitUntilBlocked());
+  EXPECT_THAT(outputs, ElementsAre(1, 3, 6, 10));
+  XLS_EXPECT_OK(async_runtime.Stop());
+}
+
+TEST(AsyncProcRuntimeTest, RejectsMisdirectedChannels) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kAccumulatorIr));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<SerialProcRuntime> runtime,
+                           CreateInterpreterSerialProcRuntime(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * in, p->GetChannel("in"));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * out, p->GetChannel("out"));
+
+  AsyncProcRuntime async_runtime(runtime.get());
+  EXPECT_THAT(async_runtime.OnOutput(in, [](const Value&) {}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not a send-only channel")));
+  EXPECT_THAT(async_runtime.Write(out, Value(UBits(1, 32))),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not a receive-only channel")));
+  EXPECT_THAT(async_runtime.WaitUntilBlocked(),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+}
+
+}  // namespace
+}  // namespace xls
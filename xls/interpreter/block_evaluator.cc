@@ -38,6 +38,7 @@
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
@@ -48,6 +49,7 @@
 #include "xls/ir/register.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/ir/xls_value.pb.h"
 
 namespace xls {
 namespace {
@@ -449,6 +451,8 @@ BlockEvaluator::EvaluateChannelizedSequentialBlock(
     absl::c_copy(
         continuation->events().trace_msgs,
         std::back_inserter(block_io_results.interpreter_events.trace_msgs));
+    block_io_results.interpreter_events.compact_traces.Append(
+        continuation->events().compact_traces);
   }
 
   return block_io_results;
@@ -528,4 +532,23 @@ BlockEvaluator::NewContinuation(Block* block) const {
   return MakeNewContinuation(std::move(elaboration), regs);
 }
 
+absl::StatusOr<BlockSnapshotProto> BlockSnapshotFromRegisters(
+    const absl::flat_hash_map<std::string, Value>& registers) {
+  BlockSnapshotProto snapshot;
+  for (const auto& [name, value] : registers) {
+    XLS_ASSIGN_OR_RETURN((*snapshot.mutable_registers())[name],
+                         value.AsProto());
+  }
+  return snapshot;
+}
+
+absl::StatusOr<absl::flat_hash_map<std::string, Value>>
+RegistersFromBlockSnapshot(const BlockSnapshotProto& snapshot) {
+  absl::flat_hash_map<std::string, Value> registers;
+  for (const auto& [name, value] : snapshot.registers()) {
+    XLS_ASSIGN_OR_RETURN(registers[name], Value::FromProto(value));
+  }
+  return registers;
+}
+
 }  // namespace xls
@@ -28,7 +28,9 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.pb.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/interpreter/observer.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/events.h"
@@ -198,6 +200,13 @@ class ChannelSink {
       data_per_cycle_;  // Data received each cycle.
 };
 
+// Converts register values to and from a snapshot which can be restored in
+// another process running the same block.
+absl::StatusOr<BlockSnapshotProto> BlockSnapshotFromRegisters(
+    const absl::flat_hash_map<std::string, Value>& registers);
+absl::StatusOr<absl::flat_hash_map<std::string, Value>>
+RegistersFromBlockSnapshot(const BlockSnapshotProto& snapshot);
+
 struct BlockIOResults {
   std::vector<absl::flat_hash_map<std::string, Value>> inputs;
   std::vector<absl::flat_hash_map<std::string, Value>> outputs;
@@ -391,6 +400,16 @@ class BlockContinuation {
   virtual absl::Status SetRegisters(
       const absl::flat_hash_map<std::string, Value>& regs) = 0;
 
+  // Captures the current register values.
+  absl::StatusOr<BlockSnapshotProto> Snapshot() {
+    return BlockSnapshotFromRegisters(registers());
+  }
+  // Restores register values captured by `Snapshot`.
+  absl::Status RestoreSnapshot(const BlockSnapshotProto& snapshot) {
+    XLS_ASSIGN_OR_RETURN(auto regs, RegistersFromBlockSnapshot(snapshot));
+    return SetRegisters(regs);
+  }
+
   // Set an evaluation observer to get reports of the value of each node.
   virtual absl::Status SetObserver(EvaluationObserver* obs) = 0;
   // Clear any evaluation observer
@@ -36,6 +36,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/observer.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
@@ -1576,6 +1577,33 @@ TEST_P(BlockEvaluatorTest, SetRegistersContinuation) {
   }
 }
 
+TEST_P(BlockEvaluatorTest, SnapshotContinuation) {
+  auto package = CreatePackage();
+  BlockBuilder b(TestName(), package.get());
+  XLS_ASSERT_OK(b.block()->AddClockPort("clk"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      b.block()->AddRegister("accum", package->GetBitsType(32)));
+  BValue x = b.InputPort("x", package->GetBitsType(32));
+  BValue next_accum = b.Add(x, b.RegisterRead(reg));
+  b.RegisterWrite(reg, next_accum);
+  b.OutputPort("out", next_accum);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, b.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto warmed_up, evaluator().NewContinuation(block));
+  for (int64_t i = 1; i <= 3; ++i) {
+    XLS_ASSERT_OK(warmed_up->RunOneCycle({{"x", Value(UBits(i, 32))}}));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(BlockSnapshotProto snapshot,
+                           warmed_up->Snapshot());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto restored, evaluator().NewContinuation(block));
+  XLS_ASSERT_OK(restored->RestoreSnapshot(snapshot));
+  XLS_ASSERT_OK(restored->RunOneCycle({{"x", Value(UBits(4, 32))}}));
+  EXPECT_THAT(restored->output_ports(),
+              UnorderedElementsAre(Pair("out", Value(UBits(10, 32)))));
+}
+
 TEST_P(BlockEvaluatorTest, DelaysContinuation) {
   auto package = CreatePackage();
   BlockBuilder b(TestName(), package.get());
@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -25,6 +26,7 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -47,7 +49,9 @@
 #include "xls/ir/instantiation.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/register.h"
+#include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
@@ -336,6 +340,10 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
       std::optional<EvaluationObserver*> observer)
       : inputs_(inputs), reg_state_(reg_state) {
     next_reg_state_.reserve(reg_state_.size());
+    // Indexed by BlockInstance::index(); sized up front so pointers to the
+    // interpreters stay valid.
+    interpreters_.resize(elaboration.instances().size());
+    fifo_models_.resize(elaboration.instances().size());
 
     for (BlockInstance* instance : elaboration.instances()) {
       if (instance->instantiation().has_value() &&
@@ -343,17 +351,13 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
               InstantiationKind::kFifo) {
         auto* fifo_instantiation =
             down_cast<FifoInstantiation*>(instance->instantiation().value());
-        fifo_models_.insert(
-            {instance, FifoModel(fifo_instantiation->data_type(),
-                                 fifo_instantiation->fifo_config(),
-                                 instance->RegisterPrefix(), reg_state_,
-                                 next_reg_state_)});
+        fifo_models_[instance->index()].emplace(
+            fifo_instantiation->data_type(), fifo_instantiation->fifo_config(),
+            instance->RegisterPrefix(), reg_state_, next_reg_state_);
       } else if (instance->block().has_value()) {
-        interpreters_.insert(
-            {instance,
-             BlockInterpreter(*instance->block(), &interpreter_events_,
-                              instance->RegisterPrefix(), reg_state_,
-                              next_reg_state_, observer)});
+        interpreters_[instance->index()].emplace(
+            *instance->block(), &interpreter_events_,
+            instance->RegisterPrefix(), reg_state_, next_reg_state_, observer);
       }
     }
     CHECK_OK(SetInstance(elaboration.top()));
@@ -373,17 +377,15 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
       InstantiationInput* instantiation_input =
           predecessors.front().node->As<InstantiationInput>();
 
-      auto parent_interpreter_iter = interpreters_.find(parent_instance);
-      if (parent_interpreter_iter == interpreters_.end()) {
+      BlockInterpreter* parent_interpreter = FindInterpreter(parent_instance);
+      if (parent_interpreter == nullptr) {
         return absl::InvalidArgumentError(
             absl::StrFormat("Missing parent interpreter for instance '%s'",
                             parent_instance->ToString()));
       }
-      const BlockInterpreter& parent_interpreter =
-          parent_interpreter_iter->second;
       return current_interpreter_->SetValueResult(
           input_port,
-          parent_interpreter.ResolveAsValue(instantiation_input->data()));
+          parent_interpreter->ResolveAsValue(instantiation_input->data()));
     }
     auto port_iter = inputs_.find(input_port->GetName());
     if (port_iter == inputs_.end()) {
@@ -400,7 +402,7 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
       BlockInstance* fifo_instance = instance->instantiation_to_instance().at(
           instantiation_input->instantiation());
       XLS_RETURN_IF_ERROR(
-          fifo_models_.at(fifo_instance)
+          GetFifoModel(fifo_instance)
               .HandleInput(instantiation_input,
                            current_interpreter_->NodeValuesMap().at(
                                instantiation_input->data())));
@@ -419,7 +421,7 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
           instantiation_output->instantiation());
       XLS_ASSIGN_OR_RETURN(
           Value fifo_output,
-          fifo_models_.at(fifo_instance).HandleOutput(instantiation_output));
+          GetFifoModel(fifo_instance).HandleOutput(instantiation_output));
       return current_interpreter_->SetValueResult(instantiation_output,
                                                   fifo_output);
     }
@@ -433,14 +435,14 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
                   predecessors.front().node->Is<OutputPort>());
     Node* child_output_data =
         predecessors.front().node->As<OutputPort>()->operand(0);
-    auto child_interpreter_iter = interpreters_.find(child_instance);
-    if (child_interpreter_iter == interpreters_.end()) {
+    BlockInterpreter* child_interpreter = FindInterpreter(child_instance);
+    if (child_interpreter == nullptr) {
       return absl::InvalidArgumentError(
           absl::StrFormat("Missing child interpreter for instance '%s'",
                           child_instance->ToString()));
     }
     const Value& child_value =
-        child_interpreter_iter->second.ResolveAsValue(child_output_data);
+        child_interpreter->ResolveAsValue(child_output_data);
     return current_interpreter_->SetValueResult(instantiation_output,
                                                 child_value);
   }
@@ -772,23 +774,22 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
 
   absl::Status SetInstance(BlockInstance* instance) {
     if (current_instance_ == instance) {
-      XLS_RET_CHECK(interpreters_.contains(instance) &&
-                    current_interpreter_ == &interpreters_.at(instance));
+      XLS_RET_CHECK(current_interpreter_ != nullptr &&
+                    current_interpreter_ == FindInterpreter(instance));
       return absl::OkStatus();
     }
     current_instance_ = instance;
-    auto it = interpreters_.find(instance);
-    XLS_RET_CHECK(it != interpreters_.end());
-    current_interpreter_ = &it->second;
+    current_interpreter_ = FindInterpreter(instance);
+    XLS_RET_CHECK(current_interpreter_ != nullptr);
     return absl::OkStatus();
   }
 
   BlockInterpreter& GetInterpreter(BlockInstance* instance) {
-    return interpreters_.at(instance);
+    return interpreters_.at(instance->index()).value();
   }
 
   const BlockInterpreter& GetInterpreter(BlockInstance* instance) const {
-    return interpreters_.at(instance);
+    return interpreters_.at(instance->index()).value();
   }
 
   absl::flat_hash_map<std::string, Value>&& MoveRegState() {
@@ -804,8 +805,21 @@ class ElaboratedBlockInterpreter final : public ElaboratedBlockDfsVisitor {
   const absl::flat_hash_map<std::string, Value>& reg_state_;
   absl::flat_hash_map<std::string, Value> next_reg_state_;
   InterpreterEvents interpreter_events_;
-  absl::flat_hash_map<BlockInstance*, BlockInterpreter> interpreters_;
-  absl::flat_hash_map<BlockInstance*, FifoModel> fifo_models_;
+  // Returns the interpreter of `instance`, or nullptr if it has none (e.g. it
+  // is a fifo instance).
+  BlockInterpreter* FindInterpreter(BlockInstance* instance) {
+    std::optional<BlockInterpreter>& interpreter =
+        interpreters_.at(instance->index());
+    return interpreter.has_value() ? &*interpreter : nullptr;
+  }
+
+  FifoModel& GetFifoModel(BlockInstance* instance) {
+    return fifo_models_.at(instance->index()).value();
+  }
+
+  // Interpreters and fifo models indexed by BlockInstance::index().
+  std::vector<std::optional<BlockInterpreter>> interpreters_;
+  std::vector<std::optional<FifoModel>> fifo_models_;
 
   // SetInstance() compares current_instance_ to its argument, so initialize
   // first.
@@ -950,12 +964,279 @@ class StatelessBlockContinuation final : public BlockContinuation {
 template <typename Evaluate>
 StatelessBlockContinuation(BlockElaboration&&, BlockRunResult&&, Evaluate)
     -> StatelessBlockContinuation<Evaluate>;
+
+// Interpreter for a block without instantiations which is run for many
+// cycles. The topological order of the block, the operands of each node and
+// the registers are precomputed into dense slot indices once. Node values
+// persist across cycles and a node is only re-evaluated if the value of one of
+// its operands changed since the previous cycle; register writes, asserts,
+// traces and covers are evaluated every cycle.
+class IncrementalBlockInterpreter final : public IrInterpreter {
+ public:
+  IncrementalBlockInterpreter(
+      Block* block, std::string_view register_prefix,
+      absl::flat_hash_map<std::string, Value> initial_registers)
+      : IrInterpreter(nullptr, nullptr, std::nullopt), block_(block) {
+    absl::flat_hash_map<Node*, int64_t> node_slots;
+    node_slots.reserve(block->node_count());
+    for (Node* node : TopoSort(block)) {
+      node_slots[node] = nodes_.size();
+      NodeSlots& slots = nodes_.emplace_back(NodeSlots{.node = node});
+      for (Node* operand : node->operands()) {
+        slots.operands.push_back(node_slots.at(operand));
+      }
+    }
+    changed_.resize(nodes_.size());
+    NodeValuesMap().reserve(nodes_.size());
+
+    register_values_.resize(block->GetRegisters().size());
+    for (Register* reg : block->GetRegisters()) {
+      std::string name = absl::StrCat(register_prefix, reg->name());
+      auto it = initial_registers.find(name);
+      if (it != initial_registers.end()) {
+        register_values_[register_names_.size()] = std::move(it->second);
+        initial_registers.erase(it);
+      }
+      register_slots_[reg] = register_names_.size();
+      register_slots_by_name_[name] = register_names_.size();
+      register_names_.push_back(std::move(name));
+    }
+    unknown_registers_.reserve(initial_registers.size());
+    for (auto& [name, _] : initial_registers) {
+      unknown_registers_.push_back(name);
+    }
+  }
+
+  // Returns an error if the initial registers named a register which does not
+  // exist in the block.
+  absl::Status CheckInitialRegisters() const {
+    if (!unknown_registers_.empty()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Block has no register '%s'", unknown_registers_.front()));
+    }
+    return absl::OkStatus();
+  }
+
+  void SetObserver(std::optional<EvaluationObserver*> observer) {
+    observer_ = observer;
+  }
+
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) {
+    for (const auto& [name, value] : inputs) {
+      // Empty tuples don't have data
+      if (value.GetFlatBitCount() != 0 && !block_->HasInputPort(name)) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Block has no input port '%s'", name));
+      }
+    }
+
+    GetInterpreterEvents().Clear();
+    next_register_values_ = register_values_;
+    // Observers are told about every node, so evaluate everything.
+    const bool evaluate_all = !evaluated_ || observer_.has_value();
+    for (int64_t i = 0; i < nodes_.size(); ++i) {
+      Node* node = nodes_[i].node;
+      if (node->Is<InputPort>()) {
+        auto it = inputs.find(node->GetName());
+        if (it == inputs.end()) {
+          return absl::InvalidArgumentError(
+              absl::StrFormat("Missing input for port '%s'", node->GetName()));
+        }
+        XLS_ASSIGN_OR_RETURN(changed_[i],
+                             UpdateSource(node, it->second, evaluate_all));
+        continue;
+      }
+      if (node->Is<RegisterRead>()) {
+        Register* reg = node->As<RegisterRead>()->GetRegister();
+        int64_t slot = register_slots_.at(reg);
+        if (register_values_[slot].kind() == ValueKind::kInvalid) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Missing value for register '%s'", register_names_[slot]));
+        }
+        XLS_ASSIGN_OR_RETURN(
+            changed_[i],
+            UpdateSource(node, register_values_[slot], evaluate_all));
+        continue;
+      }
+      const bool always_evaluate =
+          node->OpIn({Op::kRegisterWrite, Op::kAssert, Op::kTrace, Op::kCover});
+      if (!evaluate_all && !always_evaluate &&
+          std::none_of(nodes_[i].operands.begin(), nodes_[i].operands.end(),
+                       [&](int64_t operand) { return changed_[operand]; })) {
+        changed_[i] = false;
+        continue;
+      }
+      auto previous = NodeValuesMap().extract(node);
+      XLS_RETURN_IF_ERROR(node->VisitSingleNode(this));
+      changed_[i] =
+          previous.empty() || previous.mapped() != ResolveAsValue(node);
+    }
+    evaluated_ = true;
+    std::swap(register_values_, next_register_values_);
+    registers_.clear();
+
+    output_ports_.clear();
+    for (OutputPort* port : block_->GetOutputPorts()) {
+      output_ports_[port->GetName()] = ResolveAsValue(port->operand(0));
+    }
+    return absl::OkStatus();
+  }
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() const {
+    return output_ports_;
+  }
+
+  const absl::flat_hash_map<std::string, Value>& registers() {
+    if (registers_.empty()) {
+      registers_.reserve(register_names_.size());
+      for (int64_t i = 0; i < register_names_.size(); ++i) {
+        if (register_values_[i].kind() != ValueKind::kInvalid) {
+          registers_[register_names_[i]] = register_values_[i];
+        }
+      }
+    }
+    return registers_;
+  }
+
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) {
+    XLS_RET_CHECK_EQ(regs.size(), register_names_.size());
+    for (const auto& [key, v] : regs) {
+      auto it = register_slots_by_name_.find(key);
+      XLS_RET_CHECK(it != register_slots_by_name_.end()) << key;
+      const Value& current = register_values_[it->second];
+      XLS_RET_CHECK(current.kind() == ValueKind::kInvalid ||
+                    current.SameTypeAs(v))
+          << "'" << key << "' is incorrect type. Expected shape to match "
+          << current << " but value " << v << " does not match.";
+    }
+    for (const auto& [key, v] : regs) {
+      register_values_[register_slots_by_name_.at(key)] = v;
+    }
+    registers_.clear();
+    return absl::OkStatus();
+  }
+
+  absl::Status HandleOutputPort(OutputPort* output_port) override {
+    // Output ports have empty tuple types.
+    return SetValueResult(output_port, Value::Tuple({}));
+  }
+
+  absl::Status HandleRegisterWrite(RegisterWrite* reg_write) override {
+    int64_t slot = register_slots_.at(reg_write->GetRegister());
+    Value& next = next_register_values_[slot];
+    if (reg_write->reset().has_value() &&
+        ResolveAsBool(reg_write->reset().value()) !=
+            reg_write->GetRegister()->reset()->active_low) {
+      // Reset is activated. Next register state is the reset value.
+      next = reg_write->GetRegister()->reset()->reset_value;
+    } else if (!reg_write->load_enable().has_value() ||
+               ResolveAsBool(reg_write->load_enable().value())) {
+      next = ResolveAsValue(reg_write->data());
+    }
+    // Otherwise load enable is not activated and the next register state is
+    // the previous register value.
+    VLOG(3) << absl::StreamFormat("Next register value for register %s: %s",
+                                  register_names_[slot], next.ToString());
+
+    // Register writes have empty tuple types.
+    return SetValueResult(reg_write, Value::Tuple({}));
+  }
+
+ private:
+  struct NodeSlots {
+    Node* node;
+    absl::InlinedVector<int64_t, 3> operands;
+  };
+
+  // Sets the value of an input port or register read. Returns whether the
+  // value changed since the previous cycle.
+  absl::StatusOr<bool> UpdateSource(Node* node, const Value& value,
+                                    bool evaluate_all) {
+    auto it = NodeValuesMap().find(node);
+    if (!evaluate_all && it != NodeValuesMap().end() && it->second == value) {
+      return false;
+    }
+    if (it != NodeValuesMap().end()) {
+      NodeValuesMap().erase(it);
+    }
+    XLS_RETURN_IF_ERROR(SetValueResult(node, value));
+    return true;
+  }
+
+  Block* block_;
+  std::vector<NodeSlots> nodes_;
+  // Whether the value of the node in each slot changed during this cycle.
+  std::vector<bool> changed_;
+  bool evaluated_ = false;
+
+  std::vector<std::string> register_names_;
+  absl::flat_hash_map<Register*, int64_t> register_slots_;
+  absl::flat_hash_map<std::string, int64_t> register_slots_by_name_;
+  std::vector<Value> register_values_;
+  std::vector<Value> next_register_values_;
+  std::vector<std::string> unknown_registers_;
+
+  absl::flat_hash_map<std::string, Value> output_ports_;
+  // Name-keyed view of `register_values_`, built on demand.
+  absl::flat_hash_map<std::string, Value> registers_;
+};
+
+class IncrementalBlockContinuation final : public BlockContinuation {
+ public:
+  IncrementalBlockContinuation(
+      BlockElaboration&& elaboration,
+      absl::flat_hash_map<std::string, Value> initial_registers)
+      : elaboration_(std::move(elaboration)),
+        interpreter_(*elaboration_.top()->block(),
+                     elaboration_.top()->RegisterPrefix(),
+                     std::move(initial_registers)) {}
+
+  absl::Status CheckInitialRegisters() const {
+    return interpreter_.CheckInitialRegisters();
+  }
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    return interpreter_.output_ports();
+  }
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    return interpreter_.registers();
+  }
+  const InterpreterEvents& events() final {
+    return interpreter_.GetInterpreterEvents();
+  }
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final {
+    return interpreter_.RunOneCycle(inputs);
+  }
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final {
+    return interpreter_.SetRegisters(regs);
+  }
+  absl::Status SetObserver(EvaluationObserver* obs) override {
+    interpreter_.SetObserver(obs);
+    return absl::OkStatus();
+  }
+  void ClearObserver() override { interpreter_.SetObserver(std::nullopt); }
+
+ private:
+  BlockElaboration elaboration_;
+  IncrementalBlockInterpreter interpreter_;
+};
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<BlockContinuation>>
 InterpreterBlockEvaluator::MakeNewContinuation(
     BlockElaboration&& elaboration,
     const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+  if (elaboration.instances().size() == 1) {
+    auto continuation = std::make_unique<IncrementalBlockContinuation>(
+        std::move(elaboration), initial_registers);
+    XLS_RETURN_IF_ERROR(continuation->CheckInitialRegisters());
+    return continuation;
+  }
+
   // We implement fifos using some extra registers stashed in the
   // register-state. We need to add these here.
   absl::flat_hash_map<std::string, Value> ext_regs = initial_registers;
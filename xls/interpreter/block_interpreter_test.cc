@@ -14,10 +14,20 @@
 
 #include "xls/interpreter/block_interpreter.h"
 
+#include <cstdint>
+#include <memory>
 #include <string>
 
 #include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/block_evaluator.h"
 #include "xls/interpreter/block_evaluator_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
@@ -38,5 +48,40 @@ INSTANTIATE_TEST_SUITE_P(
     testing::ValuesIn(GenerateFifoTestParams(kBlockInterpreterTestParam)),
     FifoTestName);
 
+class BlockInterpreterOnlyTest : public IrTestBase {};
+
+// Inputs which stay the same across cycles must not stop changed registers or
+// side-effecting ops from being evaluated.
+TEST_F(BlockInterpreterOnlyTest, UnchangedInputsAcrossCycles) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.AddClockPort("clk"));
+  BValue x = bb.InputPort("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Register * reg,
+                           bb.block()->AddRegister("acc", p->GetBitsType(8)));
+  BValue acc = bb.RegisterRead(reg);
+  bb.RegisterWrite(reg, bb.Add(acc, x));
+  bb.OutputPort("acc", acc);
+  bb.OutputPort("doubled", bb.Add(x, x));
+  bb.Trace(bb.AfterAll({}), bb.Literal(UBits(1, 1)), {x}, "x is {}");
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockContinuation> continuation,
+                           kInterpreterBlockEvaluator.NewContinuation(block));
+  int64_t expected_acc = 0;
+  for (int64_t cycle = 0; cycle < 4; ++cycle) {
+    int64_t input = cycle < 2 ? 3 : 5;
+    XLS_ASSERT_OK(continuation->RunOneCycle({{"x", Value(UBits(input, 8))}}));
+    EXPECT_EQ(continuation->output_ports().at("acc"),
+              Value(UBits(expected_acc, 8)));
+    EXPECT_EQ(continuation->output_ports().at("doubled"),
+              Value(UBits(2 * input, 8)));
+    EXPECT_EQ(continuation->events().trace_msgs.size(), 1);
+    expected_acc += input;
+    EXPECT_EQ(continuation->registers().at("acc"),
+              Value(UBits(expected_acc, 8)));
+  }
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,118 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/block_waveform_recorder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/interpreter/vcd_writer.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<BlockWaveformRecorder>>
+BlockWaveformRecorder::Create(Block* block, BlockContinuation& continuation,
+                              std::ostream* out) {
+  std::unique_ptr<BlockWaveformRecorder> recorder(
+      new BlockWaveformRecorder(out));
+  VcdWriter& writer = recorder->writer_;
+  XLS_ASSIGN_OR_RETURN(
+      recorder->clock_,
+      writer.AddSignal("",
+                       block->GetClockPort().has_value()
+                           ? block->GetClockPort()->name
+                           : "clk",
+                       /*width=*/1));
+  for (InputPort* port : block->GetInputPorts()) {
+    int64_t width = port->GetType()->GetFlatBitCount();
+    if (width == 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(VcdWriter::SignalId id,
+                         writer.AddSignal("", port->name(), width));
+    recorder->inputs_.emplace_back(port->name(), id);
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    int64_t width = port->operand(0)->GetType()->GetFlatBitCount();
+    if (width == 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(VcdWriter::SignalId id,
+                         writer.AddSignal("", port->name(), width));
+    recorder->outputs_.emplace_back(port->name(), id);
+  }
+  // Registers of instantiated blocks are included, so declare them from the
+  // continuation rather than the block.
+  const absl::flat_hash_map<std::string, Value>& registers =
+      continuation.registers();
+  std::vector<std::string> register_names;
+  register_names.reserve(registers.size());
+  for (const auto& [name, _] : registers) {
+    register_names.push_back(name);
+  }
+  std::sort(register_names.begin(), register_names.end());
+  for (const std::string& name : register_names) {
+    int64_t width = registers.at(name).GetFlatBitCount();
+    if (width == 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(VcdWriter::SignalId id,
+                         writer.AddSignal("registers", name, width));
+    recorder->registers_.emplace_back(name, id);
+  }
+  XLS_RETURN_IF_ERROR(writer.WriteHeader(block->name()));
+
+  writer.Change(recorder->clock_, "0");
+  recorder->RecordValues(recorder->registers_, registers);
+  return recorder;
+}
+
+void BlockWaveformRecorder::RecordValues(
+    const Signals& signals,
+    const absl::flat_hash_map<std::string, Value>& values) {
+  for (const auto& [name, id] : signals) {
+    auto it = values.find(name);
+    if (it != values.end()) {
+      writer_.Change(id, it->second);
+    }
+  }
+}
+
+absl::Status BlockWaveformRecorder::RecordCycle(
+    const absl::flat_hash_map<std::string, Value>& inputs,
+    BlockContinuation& continuation) {
+  XLS_RETURN_IF_ERROR(writer_.SetTime(2 * cycle_count_));
+  writer_.Change(clock_, "0");
+  RecordValues(inputs_, inputs);
+  RecordValues(outputs_, continuation.output_ports());
+  XLS_RETURN_IF_ERROR(writer_.SetTime(2 * cycle_count_ + 1));
+  writer_.Change(clock_, "1");
+  RecordValues(registers_, continuation.registers());
+  ++cycle_count_;
+  return absl::OkStatus();
+}
+
+}  // namespace xls
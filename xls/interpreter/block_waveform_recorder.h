@@ -0,0 +1,87 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_BLOCK_WAVEFORM_RECORDER_H_
+#define XLS_INTERPRETER_BLOCK_WAVEFORM_RECORDER_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/interpreter/vcd_writer.h"
+#include "xls/ir/block.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Records the ports and registers of a block simulated with a
+// `BlockContinuation` as a VCD waveform. Cycle `c` spans times [2c, 2c + 2):
+// the input and output ports of the cycle are set at time 2c while the clock
+// is low, and the clock rises at time 2c + 1, when the registers take their
+// next values. Only changed values are written.
+class BlockWaveformRecorder {
+ public:
+  // Creates a recorder writing to `out`, which must outlive the recorder.
+  // Records the current register values of `continuation` as the initial
+  // state.
+  static absl::StatusOr<std::unique_ptr<BlockWaveformRecorder>> Create(
+      Block* block, BlockContinuation& continuation, std::ostream* out);
+
+  // Records the cycle `continuation` just ran with the input port values
+  // `inputs`.
+  absl::Status RecordCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs,
+      BlockContinuation& continuation);
+
+  // Runs one cycle of `continuation` with `inputs` and records it.
+  absl::Status RunOneCycle(
+      BlockContinuation& continuation,
+      const absl::flat_hash_map<std::string, Value>& inputs) {
+    XLS_RETURN_IF_ERROR(continuation.RunOneCycle(inputs));
+    return RecordCycle(inputs, continuation);
+  }
+
+  // Writes all buffered output to the stream.
+  void Flush() { writer_.Flush(); }
+
+  // Number of cycles recorded so far.
+  int64_t cycle_count() const { return cycle_count_; }
+
+ private:
+  using Signals = std::vector<std::pair<std::string, VcdWriter::SignalId>>;
+
+  explicit BlockWaveformRecorder(std::ostream* out) : writer_(out) {}
+
+  void RecordValues(const Signals& signals,
+                    const absl::flat_hash_map<std::string, Value>& values);
+
+  VcdWriter writer_;
+  VcdWriter::SignalId clock_;
+  Signals inputs_;
+  Signals outputs_;
+  Signals registers_;
+  int64_t cycle_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_BLOCK_WAVEFORM_RECORDER_H_
@@ -30,15 +30,29 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/casts.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/channel.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 
 namespace xls {
 
+void ValueRingBuffer::Grow() {
+  std::vector<Value> slots(std::max(kMinCapacity, 2 * size_));
+  for (int64_t i = 0; i < size_; ++i) {
+    slots[i] = std::move(slots_[(head_ + i) & (slots_.size() - 1)]);
+  }
+  slots_ = std::move(slots);
+  head_ = 0;
+}
+
 absl::Status ChannelQueue::AttachGenerator(GeneratorFn generator) {
   absl::MutexLock lock(&mutex_);
   if (generator_.has_value()) {
@@ -70,12 +84,14 @@ absl::Status ChannelQueue::Write(const Value& value) {
   }
 
   WriteInternal(value);
-  VLOG(4) << absl::StreamFormat("Channel now has %d elements", queue_.size());
+  VLOG(4) << absl::StreamFormat("Channel now has %d elements",
+                                GetSizeInternal());
   return absl::OkStatus();
 }
 
 void ChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
+  ++push_count_;
   if (channel()->kind() == ChannelKind::kSingleValue) {
     if (queue_.empty()) {
       queue_.push_back(value);
@@ -104,24 +120,193 @@ std::optional<Value> ChannelQueue::Read() {
       "Reading data from channel instance %s: %s",
       channel_instance()->ToString(),
       value.has_value() ? value->ToString() : "(none)");
-  VLOG(4) << absl::StreamFormat("Channel now has %d elements", queue_.size());
+  VLOG(4) << absl::StreamFormat("Channel now has %d elements",
+                                GetSizeInternal());
   return value;
 }
 
+std::vector<Value> ChannelQueue::GetContents() {
+  absl::MutexLock lock(&mutex_);
+  // Values are read out and written back, so suspend the callbacks.
+  std::vector<std::unique_ptr<ChannelQueueCallback>> callbacks =
+      std::move(callbacks_);
+  callbacks_.clear();
+  int64_t pushes = GetPushCountInternal();
+  int64_t pops = GetPopCountInternal();
+  std::vector<Value> contents;
+  int64_t size = GetSizeInternal();
+  contents.reserve(size);
+  for (int64_t i = 0; i < size; ++i) {
+    std::optional<Value> value = ReadInternal();
+    CHECK(value.has_value());
+    contents.push_back(*std::move(value));
+  }
+  // Reads of single-value channels are non-destructive.
+  if (channel()->kind() != ChannelKind::kSingleValue) {
+    for (const Value& value : contents) {
+      WriteInternal(value);
+    }
+  }
+  uncounted_pushes_ += GetPushCountInternal() - pushes;
+  uncounted_pops_ += GetPopCountInternal() - pops;
+  callbacks_ = std::move(callbacks);
+  return contents;
+}
+
+absl::Status ChannelQueue::SetContents(absl::Span<const Value> values) {
+  if (channel()->kind() == ChannelKind::kSingleValue && values.size() > 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Single-value channel `%s` can hold at most one value, got %d",
+        channel()->name(), values.size()));
+  }
+  for (const Value& value : values) {
+    if (!ValueConformsToType(value, channel()->type())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel `%s` expects values to have type %s, got: %s",
+          channel()->name(), channel()->type()->ToString(), value.ToString()));
+    }
+  }
+  absl::MutexLock lock(&mutex_);
+  std::vector<std::unique_ptr<ChannelQueueCallback>> callbacks =
+      std::move(callbacks_);
+  callbacks_.clear();
+  int64_t pushes = GetPushCountInternal();
+  int64_t pops = GetPopCountInternal();
+  if (channel()->kind() != ChannelKind::kSingleValue) {
+    while (GetSizeInternal() > 0) {
+      ReadInternal();
+    }
+  }
+  for (const Value& value : values) {
+    WriteInternal(value);
+  }
+  uncounted_pushes_ += GetPushCountInternal() - pushes;
+  uncounted_pops_ += GetPopCountInternal() - pops;
+  callbacks_ = std::move(callbacks);
+  return absl::OkStatus();
+}
+
 int64_t ChannelQueue::GetSizeInternal() const { return queue_.size(); }
 
+int64_t ChannelQueue::GetPushCountInternal() const { return push_count_; }
+
+int64_t ChannelQueue::GetPopCountInternal() const { return pop_count_; }
+
 std::optional<Value> ChannelQueue::ReadInternal() {
   if (queue_.empty()) {
     return std::nullopt;
   }
-  Value value = queue_.front();
+  // Reads of single-value channels are non-destructive.
+  Value value = channel()->kind() == ChannelKind::kSingleValue
+                    ? queue_.front()
+                    : queue_.pop_front();
+  ++pop_count_;
   CallReadCallbacks(value);
-  if (channel()->kind() != ChannelKind::kSingleValue) {
-    queue_.pop_front();
-  }
   return std::move(value);
 }
 
+LockFreeChannelQueue::LockFreeChannelQueue(ChannelInstance* channel_instance)
+    : ChannelQueue(channel_instance),
+      values_(/*min_capacity=*/channel_instance->channel->kind() ==
+                      ChannelKind::kStreaming
+                  ? down_cast<StreamingChannel*>(channel_instance->channel)
+                        ->GetFifoDepth()
+                        .value_or(0)
+                  : 0) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming)
+      << "LockFreeChannelQueue only supports streaming channels";
+}
+
+absl::Status LockFreeChannelQueue::Write(const Value& value) {
+  VLOG(4) << absl::StreamFormat(
+      "Writing value to channel instance `%s`: { %s }",
+      channel_instance()->ToString(), value.ToString());
+  // Only the producer writes so checking for a generator is race-free.
+  if (generator_.has_value()) {
+    return absl::InternalError(
+        "Cannot write to ChannelQueue because it has a generator function.");
+  }
+  if (!ValueConformsToType(value, channel()->type())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Channel `%s` expects values to have type %s, got: %s",
+        channel()->name(), channel()->type()->ToString(), value.ToString()));
+  }
+  WriteInternal(value);
+  return absl::OkStatus();
+}
+
+std::optional<Value> LockFreeChannelQueue::Read() {
+  // Only the consumer reads so calling the generator is race-free.
+  if (generator_.has_value()) {
+    std::optional<Value> generated_value = (*generator_)();
+    if (generated_value.has_value()) {
+      WriteInternal(generated_value.value());
+    }
+  }
+  std::optional<Value> value = ReadInternal();
+  VLOG(4) << absl::StreamFormat(
+      "Reading data from channel instance %s: %s",
+      channel_instance()->ToString(),
+      value.has_value() ? value->ToString() : "(none)");
+  return value;
+}
+
+int64_t LockFreeChannelQueue::GetSizeInternal() const {
+  return values_.size();
+}
+
+int64_t LockFreeChannelQueue::GetPushCountInternal() const {
+  return values_.write_count();
+}
+
+int64_t LockFreeChannelQueue::GetPopCountInternal() const {
+  return values_.read_count();
+}
+
+void LockFreeChannelQueue::WriteInternal(const Value& value) {
+  if (!callbacks_.empty()) {
+    CallWriteCallbacks(value);
+  }
+  values_.Write(value);
+}
+
+std::optional<Value> LockFreeChannelQueue::ReadInternal() {
+  std::optional<Value> value = values_.Read();
+  if (value.has_value() && !callbacks_.empty()) {
+    CallReadCallbacks(value.value());
+  }
+  return value;
+}
+
+bool IsSingleProducerSingleConsumer(const ProcElaboration& elaboration,
+                                    ChannelInstance* channel_instance) {
+  if (channel_instance->channel->kind() != ChannelKind::kStreaming) {
+    return false;
+  }
+  absl::flat_hash_set<ProcInstance*> senders;
+  absl::flat_hash_set<ProcInstance*> receivers;
+  for (ProcInstance* proc_instance : elaboration.proc_instances()) {
+    for (Node* node : proc_instance->proc()->nodes()) {
+      if (!node->Is<ChannelNode>()) {
+        continue;
+      }
+      ChannelNode* channel_node = node->As<ChannelNode>();
+      absl::StatusOr<ChannelInstance*> bound =
+          proc_instance->GetChannelInstance(channel_node->channel_name());
+      if (!bound.ok() || *bound != channel_instance) {
+        continue;
+      }
+      if (channel_node->direction() == Direction::kSend) {
+        senders.insert(proc_instance);
+      } else {
+        receivers.insert(proc_instance);
+      }
+    }
+  }
+  return senders.size() <= 1 && receivers.size() <= 1;
+}
+
+
 /* static */ absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
 ChannelQueueManager::Create(Package* package) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
@@ -164,6 +349,27 @@ ChannelQueueManager::Create(std::vector<std::unique_ptr<ChannelQueue>>&& queues,
       new ChannelQueueManager(std::move(elaboration), std::move(queues)));
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
+ChannelQueueManager::CreateLockFree(ProcElaboration elaboration) {
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (channel_instance->channel->kind() != ChannelKind::kStreaming &&
+        channel_instance->channel->kind() != ChannelKind::kSingleValue) {
+      return absl::UnimplementedError(
+          "Only streaming and single-value channels are supported.");
+    }
+    if (IsSingleProducerSingleConsumer(elaboration, channel_instance)) {
+      queues.push_back(
+          std::make_unique<LockFreeChannelQueue>(channel_instance));
+    } else {
+      queues.push_back(std::make_unique<ChannelQueue>(channel_instance));
+    }
+  }
+
+  return absl::WrapUnique(
+      new ChannelQueueManager(std::move(elaboration), std::move(queues)));
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<ChannelQueueManager>>
 ChannelQueueManager::Create(ProcElaboration elaboration) {
   std::vector<std::unique_ptr<ChannelQueue>> queues;
@@ -30,6 +30,7 @@
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/data_structures/spsc_segmented_ring.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -52,6 +53,86 @@ class ChannelQueueCallback {
                           const Value& value) = 0;
 };
 
+// A growable FIFO ring buffer of Values. Unlike a std::deque it only allocates
+// when it outgrows its current capacity, and values are moved out on reads.
+class ValueRingBuffer {
+ public:
+  int64_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Returns the oldest value. The buffer must not be empty.
+  Value& front() { return slots_[head_]; }
+
+  void push_back(const Value& value) {
+    if (size_ == slots_.size()) {
+      Grow();
+    }
+    slots_[(head_ + size_) & (slots_.size() - 1)] = value;
+    ++size_;
+  }
+
+  // Removes and returns the oldest value. The buffer must not be empty.
+  Value pop_front() {
+    Value value = std::move(slots_[head_]);
+    head_ = (head_ + 1) & (slots_.size() - 1);
+    --size_;
+    return value;
+  }
+
+ private:
+  static constexpr int64_t kMinCapacity = 8;
+
+  void Grow();
+
+  // The capacity is zero or a power of two.
+  std::vector<Value> slots_;
+  // Index of the oldest value.
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+// A FIFO queue of Values which is safe for one producer thread and one
+// consumer thread to access concurrently without locking. Values are stored
+// in a SpscSegmentedRing, so no allocation is performed in steady state
+// beyond that of the values themselves.
+class SpscValueQueue {
+ public:
+  // `min_capacity` is a lower bound on the number of values the queue can
+  // hold before allocating an additional segment.
+  explicit SpscValueQueue(int64_t min_capacity = 0) : ring_(min_capacity) {}
+
+  SpscValueQueue(const SpscValueQueue&) = delete;
+  SpscValueQueue& operator=(const SpscValueQueue&) = delete;
+
+  // Writes a value. Must only be called by the producer.
+  void Write(const Value& value) {
+    ring_.Write([&](Value* slot) { *slot = value; });
+  }
+
+  // Reads the oldest value, or returns std::nullopt if the queue is empty.
+  // Must only be called by the consumer.
+  std::optional<Value> Read() {
+    std::optional<Value> value;
+    ring_.Read([&](Value* slot) { value = std::move(*slot); });
+    return value;
+  }
+
+  // Returns the number of values in the queue. The value is exact when
+  // called from either the producer or the consumer while the other side is
+  // quiescent, and otherwise a snapshot.
+  int64_t size() const { return ring_.size(); }
+
+  // Returns the total number of values written to and read from the queue.
+  int64_t write_count() const { return ring_.write_count(); }
+  int64_t read_count() const { return ring_.read_count(); }
+
+  static constexpr int64_t kMinSegmentCapacity =
+      SpscSegmentedRing<Value>::kMinSegmentCapacity;
+
+ private:
+  SpscSegmentedRing<Value> ring_;
+};
+
 // Abstract base class for queues which represent channels during IR
 // interpretation. During interpretation of a network of procs each channel
 // instance is backed by exactly one ChannelQueue. ChannelQueues are
@@ -84,12 +165,33 @@ class ChannelQueue {
   // Returns whether the channel queue is empty.
   bool IsEmpty() const { return GetSize() == 0; }
 
+  // Returns the total number of values written to (pushed) and read from
+  // (popped) the queue, including values produced by a generator. Accesses by
+  // GetContents and SetContents are not counted. Reads of single-value
+  // channels are counted even though they are non-destructive.
+  int64_t GetPushCount() const {
+    absl::MutexLock lock(&mutex_);
+    return GetPushCountInternal() - uncounted_pushes_;
+  }
+  int64_t GetPopCount() const {
+    absl::MutexLock lock(&mutex_);
+    return GetPopCountInternal() - uncounted_pops_;
+  }
+
   // Writes the given value on to the channel.
-  absl::Status Write(const Value& value);
+  virtual absl::Status Write(const Value& value);
 
   // Reads and returns a value from the channel. Returns an std::nullopt if
   // the channel is empty.
-  std::optional<Value> Read();
+  virtual std::optional<Value> Read();
+
+  // Returns the values in the queue, oldest first, without removing them.
+  // Neither callbacks nor the generator are invoked.
+  std::vector<Value> GetContents();
+
+  // Replaces the values in the queue with `values`, oldest first, without
+  // invoking callbacks. Used to restore a snapshot of the queue.
+  absl::Status SetContents(absl::Span<const Value> values);
 
   // Attaches a function which generates values for the channel. The generator
   // is called when a value is needed for reading. If a generator is attached
@@ -116,13 +218,23 @@ class ChannelQueue {
   mutable absl::Mutex mutex_;
 
   virtual int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  virtual int64_t GetPushCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
+  virtual int64_t GetPopCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   virtual void WriteInternal(const Value& value)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   virtual std::optional<Value> ReadInternal()
       ABSL_SHARED_LOCKS_REQUIRED(mutex_);
   ChannelInstance* channel_instance_;
 
-  std::deque<Value> queue_ ABSL_GUARDED_BY(mutex_);
+  ValueRingBuffer queue_ ABSL_GUARDED_BY(mutex_);
+  int64_t push_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t pop_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Pushes and pops performed by GetContents and SetContents, which are
+  // excluded from GetPushCount and GetPopCount.
+  int64_t uncounted_pushes_ ABSL_GUARDED_BY(mutex_) = 0;
+  int64_t uncounted_pops_ ABSL_GUARDED_BY(mutex_) = 0;
   // The ThreadUnsafeJitChannelQueue reads this value without a lock.
   // TODO(meheff): 2022/09/27 Fix this, potentially by obviating the need for
   // the thread-unsafe version of the queue.
@@ -131,6 +243,38 @@ class ChannelQueue {
   std::vector<std::unique_ptr<ChannelQueueCallback>> callbacks_;
 };
 
+// A channel queue for streaming channels with exactly one sending proc
+// instance and one receiving proc instance. Write and Read take no lock; the
+// sender and receiver may run on different threads. At most one thread may
+// write and at most one thread may read at any time. The remaining methods
+// must only be called while neither side is active.
+class LockFreeChannelQueue : public ChannelQueue {
+ public:
+  explicit LockFreeChannelQueue(ChannelInstance* channel_instance);
+  ~LockFreeChannelQueue() override = default;
+
+  absl::Status Write(const Value& value) override;
+  std::optional<Value> Read() override;
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPushCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPopCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+  SpscValueQueue values_;
+};
+
+// Returns whether the given channel instance can be backed by a lock-free
+// queue (LockFreeChannelQueue or LockFreeJitChannelQueue): it must be a
+// streaming channel and it must be sent on by at most one proc instance and
+// received on by at most one proc instance in the elaboration.
+bool IsSingleProducerSingleConsumer(const ProcElaboration& elaboration,
+                                    ChannelInstance* channel_instance);
+
 // A functor which returns a sequence of Values when called. Maybe be attached
 // to a ChannelQueue as a generator.
 class FixedValueGenerator {
@@ -173,6 +317,13 @@ class ChannelQueueManager {
       std::vector<std::unique_ptr<ChannelQueue>>&& queues,
       ProcElaboration elaboration);
 
+  // Creates and returns a queue manager from the given elaboration holding a
+  // LockFreeChannelQueue for each single-producer/single-consumer streaming
+  // channel and a ChannelQueue for all other channels. Suitable for runtimes
+  // which tick procs on multiple threads.
+  static absl::StatusOr<std::unique_ptr<ChannelQueueManager>> CreateLockFree(
+      ProcElaboration elaboration);
+
   // Get the channel queue associated with the channel with the given id/name.
   ChannelQueue& GetQueue(ChannelInstance* channel_instance) {
     return *queues_.at(channel_instance);
@@ -14,30 +14,38 @@
 
 #include "xls/interpreter/channel_queue.h"
 
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue_test_base.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
 
 using ::absl_testing::StatusIs;
 using ::testing::HasSubstr;
+using ::testing::Optional;
 
 // Instantiate and run all the tests in channel_queue_test_base.cc.
 INSTANTIATE_TEST_SUITE_P(ChannelQueueTest, ChannelQueueTestBase,
@@ -184,5 +192,130 @@ TEST_F(ChannelQueueManagerTest, ChannelQueueManagerErrorConditions) {
   }
 }
 
+TEST(ChannelQueueTest, InterleavedWritesAndReadsPreserveOrder) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  ChannelQueue queue(elaboration.GetUniqueInstance(channel).value());
+
+  // Bursts of writes with partial drains wrap around and grow the storage.
+  int64_t next_write = 0;
+  int64_t next_read = 0;
+  for (int64_t round = 0; round < 5; ++round) {
+    for (int64_t i = 0; i < 13; ++i) {
+      XLS_ASSERT_OK(queue.Write(Value(UBits(next_write++, 32))));
+    }
+    for (int64_t i = 0; i < 7; ++i) {
+      EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read++, 32))));
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+  }
+  EXPECT_EQ(queue.GetContents().size(), next_write - next_read);
+  while (next_read < next_write) {
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read++, 32))));
+  }
+  EXPECT_EQ(queue.Read(), std::nullopt);
+}
+
+TEST(LockFreeChannelQueueTest, GrowsBeyondInitialSegment) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  LockFreeChannelQueue queue(elaboration.GetUniqueInstance(channel).value());
+
+  constexpr int64_t kBurst = 5 * SpscValueQueue::kMinSegmentCapacity + 3;
+  int64_t next_write = 0;
+  int64_t next_read = 0;
+  for (int64_t round = 0; round < 4; ++round) {
+    for (int64_t i = 0; i < kBurst; ++i) {
+      XLS_ASSERT_OK(queue.Write(Value(UBits(next_write++, 32))));
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+    for (int64_t i = 0; i < kBurst / 2; ++i) {
+      EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read++, 32))));
+    }
+  }
+  EXPECT_THAT(queue.Write(Value(UBits(0, 8))),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("expects values to have type bits[32]")));
+  while (next_read < next_write) {
+    EXPECT_THAT(queue.Read(), Optional(Value(UBits(next_read++, 32))));
+  }
+  EXPECT_TRUE(queue.IsEmpty());
+
+  XLS_ASSERT_OK(queue.AttachGenerator(
+      []() -> std::optional<Value> { return Value(UBits(7, 32)); }));
+  EXPECT_THAT(queue.Read(), Optional(Value(UBits(7, 32))));
+}
+
+TEST(LockFreeChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  LockFreeChannelQueue queue(elaboration.GetUniqueInstance(channel).value());
+
+  constexpr uint64_t kCount = 20000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      CHECK_OK(queue.Write(Value(UBits(i, 64))));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    std::optional<Value> value = queue.Read();
+    if (value.has_value()) {
+      ASSERT_EQ(*value, Value(UBits(expected, 64)));
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(ChannelQueueManagerLockFreeTest, CreateLockFreeSelectsQueueKind) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      package.CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single_value,
+      package.CreateSingleValueChannel("single_value", ChannelOps::kReceiveOnly,
+                                       package.GetBitsType(32)));
+  {
+    ProcBuilder pb("producer", &package);
+    BValue v = pb.Receive(single_value, pb.Literal(Value::Token()));
+    pb.Send(internal, pb.TupleIndex(v, 0), pb.TupleIndex(v, 1));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+  {
+    ProcBuilder pb("consumer", &package);
+    pb.Receive(internal, pb.Literal(Value::Token()));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelQueueManager> manager,
+      ChannelQueueManager::CreateLockFree(std::move(elaboration)));
+  EXPECT_NE(dynamic_cast<LockFreeChannelQueue*>(&manager->GetQueue(internal)),
+            nullptr);
+  EXPECT_EQ(
+      dynamic_cast<LockFreeChannelQueue*>(&manager->GetQueue(single_value)),
+      nullptr);
+}
+
 }  // namespace
 }  // namespace xls
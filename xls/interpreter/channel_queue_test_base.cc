@@ -72,6 +72,36 @@ TEST_P(ChannelQueueTestBase, FifoChannelQueueTest) {
   EXPECT_EQ(queue->Read(), std::nullopt);
 }
 
+TEST_P(ChannelQueueTestBase, PushAndPopCounts) {
+  Package package(TestName());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  auto queue =
+      GetParam().CreateQueue(elaboration.GetUniqueInstance(channel).value());
+
+  XLS_ASSERT_OK(queue->Write(Value(UBits(1, 32))));
+  XLS_ASSERT_OK(queue->Write(Value(UBits(2, 32))));
+  EXPECT_THAT(queue->Read(), Optional(Value(UBits(1, 32))));
+  EXPECT_EQ(queue->GetPushCount(), 2);
+  EXPECT_EQ(queue->GetPopCount(), 1);
+
+  // Snapshot accesses are not counted.
+  EXPECT_EQ(queue->GetContents().size(), 1);
+  XLS_ASSERT_OK(queue->SetContents({Value(UBits(3, 32)), Value(UBits(4, 32))}));
+  EXPECT_EQ(queue->GetPushCount(), 2);
+  EXPECT_EQ(queue->GetPopCount(), 1);
+
+  EXPECT_THAT(queue->Read(), Optional(Value(UBits(3, 32))));
+  EXPECT_THAT(queue->Read(), Optional(Value(UBits(4, 32))));
+  EXPECT_EQ(queue->Read(), std::nullopt);
+  EXPECT_EQ(queue->GetPushCount(), 2);
+  EXPECT_EQ(queue->GetPopCount(), 3);
+}
+
 TEST_P(ChannelQueueTestBase, SingleValueChannelQueueTest) {
   Package package(TestName());
   XLS_ASSERT_OK_AND_ASSIGN(
@@ -0,0 +1,508 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+
+namespace xls {
+namespace {
+
+// Returns the given bits value as a uint64_t value. If the value is larger
+// than `upper_limit`, `upper_limit` is returned instead.
+uint64_t BitsToBoundedUint64(const Bits& bits, uint64_t upper_limit) {
+  if (Bits::MinBitCountUnsigned(upper_limit) <= bits.bit_count() &&
+      bits_ops::UGreaterThan(bits, UBits(upper_limit, bits.bit_count()))) {
+    return upper_limit;
+  }
+  return bits.ToUint64().value();
+}
+
+// Returns whether instructions of the given op are evaluated directly on the
+// value arena rather than by the IrInterpreter.
+bool IsCompiledOp(Op op) {
+  switch (op) {
+    case Op::kAdd:
+    case Op::kAfterAll:
+    case Op::kAnd:
+    case Op::kAndReduce:
+    case Op::kArray:
+    case Op::kArrayIndex:
+    case Op::kAssert:
+    case Op::kBitSlice:
+    case Op::kConcat:
+    case Op::kCountedFor:
+    case Op::kEq:
+    case Op::kIdentity:
+    case Op::kInvoke:
+    case Op::kLiteral:
+    case Op::kMap:
+    case Op::kNand:
+    case Op::kNe:
+    case Op::kNeg:
+    case Op::kNor:
+    case Op::kNot:
+    case Op::kOr:
+    case Op::kOrReduce:
+    case Op::kParam:
+    case Op::kSel:
+    case Op::kSGe:
+    case Op::kSGt:
+    case Op::kShll:
+    case Op::kShra:
+    case Op::kShrl:
+    case Op::kSignExt:
+    case Op::kSLe:
+    case Op::kSLt:
+    case Op::kSMul:
+    case Op::kSub:
+    case Op::kTuple:
+    case Op::kTupleIndex:
+    case Op::kUGe:
+    case Op::kUGt:
+    case Op::kULe:
+    case Op::kULt:
+    case Op::kUMul:
+    case Op::kXor:
+    case Op::kXorReduce:
+    case Op::kZeroExt:
+      return true;
+    default:
+      return false;
+  }
+}
+
+void AppendEvents(const InterpreterEvents& from, InterpreterEvents& to) {
+  to.trace_msgs.insert(to.trace_msgs.end(), from.trace_msgs.begin(),
+                       from.trace_msgs.end());
+  to.assert_msgs.insert(to.assert_msgs.end(), from.assert_msgs.begin(),
+                        from.assert_msgs.end());
+  to.compact_traces.Append(from.compact_traces);
+}
+
+// Returns the result of a multiply truncated or extended to `width` bits.
+Bits FitMultiplyResult(Bits result, int64_t width, bool is_signed) {
+  if (result.bit_count() > width) {
+    return result.Slice(0, width);
+  }
+  if (result.bit_count() < width) {
+    return is_signed ? bits_ops::SignExtend(result, width)
+                     : bits_ops::ZeroExtend(result, width);
+  }
+  return result;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>>
+CompiledFunctionInterpreter::Create(Function* function) {
+  auto interpreter =
+      absl::WrapUnique(new CompiledFunctionInterpreter(function));
+  XLS_RETURN_IF_ERROR(interpreter->Compile());
+  return interpreter;
+}
+
+absl::Status CompiledFunctionInterpreter::Compile() {
+  std::vector<Node*> topo_sort = TopoSort(function_);
+  absl::flat_hash_map<Node*, int64_t> node_index;
+  node_index.reserve(topo_sort.size());
+  instructions_.reserve(topo_sort.size());
+  values_.resize(topo_sort.size());
+  for (Node* node : topo_sort) {
+    const int64_t index = instructions_.size();
+    node_index[node] = index;
+    Instruction& instruction = instructions_.emplace_back(
+        Instruction{.node = node, .op = node->op(), .result = index});
+    for (Node* operand : node->operands()) {
+      instruction.operands.push_back(node_index.at(operand));
+    }
+    instruction.fallback = !IsCompiledOp(node->op());
+    switch (node->op()) {
+      case Op::kParam: {
+        XLS_ASSIGN_OR_RETURN(instruction.param_index,
+                             function_->GetParamIndex(node->As<Param>()));
+        break;
+      }
+      case Op::kLiteral:
+        values_[index] = node->As<Literal>()->value();
+        break;
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(instruction.callee,
+                             GetCallee(node->As<Invoke>()->to_apply()));
+        break;
+      }
+      case Op::kMap: {
+        XLS_ASSIGN_OR_RETURN(instruction.callee,
+                             GetCallee(node->As<Map>()->to_apply()));
+        break;
+      }
+      case Op::kCountedFor: {
+        XLS_ASSIGN_OR_RETURN(instruction.callee,
+                             GetCallee(node->As<CountedFor>()->body()));
+        break;
+      }
+      default:
+        break;
+    }
+  }
+  return_value_ = node_index.at(function_->return_value());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<CompiledFunctionInterpreter*>
+CompiledFunctionInterpreter::GetCallee(Function* callee) {
+  auto it = callees_.find(callee);
+  if (it == callees_.end()) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunctionInterpreter> compiled,
+                         Create(callee));
+    it = callees_.emplace(callee, std::move(compiled)).first;
+  }
+  return it->second.get();
+}
+
+absl::StatusOr<InterpreterResult<Value>> CompiledFunctionInterpreter::Run(
+    absl::Span<const Value> args, std::optional<EvaluationObserver*> observer) {
+  if (args.size() != function_->params().size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Function `%s` (type: `%s`) wants %d arguments, got %d.",
+        function_->name(), function_->GetType()->ToString(),
+        function_->params().size(), args.size()));
+  }
+  for (int64_t argno = 0; argno < args.size(); ++argno) {
+    Type* param_type = function_->param(argno)->GetType();
+    if (!ValueConformsToType(args[argno], param_type)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Got argument %s for parameter %d which is not of type %s",
+          args[argno].ToString(), argno, param_type->ToString()));
+    }
+  }
+
+  InterpreterEvents events;
+  for (const Instruction& instruction : instructions_) {
+    if (instruction.fallback) {
+      XLS_RETURN_IF_ERROR(ExecuteFallback(instruction, events, observer));
+      continue;
+    }
+    XLS_RETURN_IF_ERROR(Execute(instruction, args, events));
+    if (observer.has_value()) {
+      (*observer)->NodeEvaluated(instruction.node, values_[instruction.result]);
+    }
+  }
+  return InterpreterResult<Value>{values_[return_value_], std::move(events)};
+}
+
+absl::StatusOr<Value> CompiledFunctionInterpreter::RunCallee(
+    CompiledFunctionInterpreter* callee, absl::Span<const Value> args,
+    InterpreterEvents& events) {
+  XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> result, callee->Run(args));
+  AppendEvents(result.events, events);
+  return std::move(result.value);
+}
+
+absl::Status CompiledFunctionInterpreter::ExecuteFallback(
+    const Instruction& instruction, InterpreterEvents& events,
+    std::optional<EvaluationObserver*> observer) {
+  Node* node = instruction.node;
+  fallback_values_.clear();
+  for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+    // Operands may be duplicated, in which case the value is only set once.
+    fallback_values_.try_emplace(node->operand(i), operand(instruction, i));
+  }
+  IrInterpreter interpreter(&fallback_values_, &events, observer);
+  XLS_RETURN_IF_ERROR(node->VisitSingleNode(&interpreter));
+  values_[instruction.result] = std::move(fallback_values_.at(node));
+  return absl::OkStatus();
+}
+
+absl::Status CompiledFunctionInterpreter::Execute(
+    const Instruction& instruction, absl::Span<const Value> args,
+    InterpreterEvents& events) {
+  Node* node = instruction.node;
+  Value& result = values_[instruction.result];
+  auto bits_operand = [&](int64_t i) -> const Bits& {
+    return operand(instruction, i).bits();
+  };
+  // Folds the operands of a bitwise op with the given in-place operation.
+  auto fold_bitwise = [&](void (*op)(Bits*, const Bits&)) {
+    Bits accum = bits_operand(0);
+    for (int64_t i = 1; i < instruction.operands.size(); ++i) {
+      op(&accum, bits_operand(i));
+    }
+    return accum;
+  };
+  auto shift_amount = [&]() {
+    return BitsToBoundedUint64(bits_operand(1), bits_operand(0).bit_count());
+  };
+
+  switch (instruction.op) {
+    case Op::kParam:
+      result = args[instruction.param_index];
+      return absl::OkStatus();
+    case Op::kLiteral:
+      // Written at compile time.
+      return absl::OkStatus();
+    case Op::kAfterAll:
+      result = Value::Token();
+      return absl::OkStatus();
+    case Op::kAssert:
+      if (!bits_operand(1).Get(0)) {
+        events.assert_msgs.push_back(node->As<Assert>()->message());
+      }
+      result = Value::Token();
+      return absl::OkStatus();
+    case Op::kIdentity:
+      result = operand(instruction, 0);
+      return absl::OkStatus();
+    case Op::kAdd:
+      result = Value(bits_ops::Add(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kSub:
+      result = Value(bits_ops::Sub(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kUMul:
+      result = Value(FitMultiplyResult(
+          bits_ops::UMul(bits_operand(0), bits_operand(1)),
+          node->BitCountOrDie(), /*is_signed=*/false));
+      return absl::OkStatus();
+    case Op::kSMul:
+      result = Value(FitMultiplyResult(
+          bits_ops::SMul(bits_operand(0), bits_operand(1)),
+          node->BitCountOrDie(), /*is_signed=*/true));
+      return absl::OkStatus();
+    case Op::kNeg:
+      result = Value(bits_ops::Negate(bits_operand(0)));
+      return absl::OkStatus();
+    case Op::kNot:
+      result = Value(bits_ops::Not(bits_operand(0)));
+      return absl::OkStatus();
+    case Op::kAnd:
+      result = Value(fold_bitwise(bits_ops::AndInPlace));
+      return absl::OkStatus();
+    case Op::kOr:
+      result = Value(fold_bitwise(bits_ops::OrInPlace));
+      return absl::OkStatus();
+    case Op::kXor:
+      result = Value(fold_bitwise(bits_ops::XorInPlace));
+      return absl::OkStatus();
+    case Op::kNand: {
+      Bits accum = fold_bitwise(bits_ops::AndInPlace);
+      bits_ops::NotInPlace(&accum);
+      result = Value(std::move(accum));
+      return absl::OkStatus();
+    }
+    case Op::kNor: {
+      Bits accum = fold_bitwise(bits_ops::OrInPlace);
+      bits_ops::NotInPlace(&accum);
+      result = Value(std::move(accum));
+      return absl::OkStatus();
+    }
+    case Op::kAndReduce:
+      result = Value(bits_ops::AndReduce(bits_operand(0)));
+      return absl::OkStatus();
+    case Op::kOrReduce:
+      result = Value(bits_ops::OrReduce(bits_operand(0)));
+      return absl::OkStatus();
+    case Op::kXorReduce:
+      result = Value(bits_ops::XorReduce(bits_operand(0)));
+      return absl::OkStatus();
+    case Op::kEq:
+      result = Value::Bool(operand(instruction, 0) == operand(instruction, 1));
+      return absl::OkStatus();
+    case Op::kNe:
+      result = Value::Bool(operand(instruction, 0) != operand(instruction, 1));
+      return absl::OkStatus();
+    case Op::kULt:
+      result =
+          Value::Bool(bits_ops::ULessThan(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kULe:
+      result = Value::Bool(
+          bits_ops::ULessThanOrEqual(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kUGt:
+      result =
+          Value::Bool(bits_ops::UGreaterThan(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kUGe:
+      result = Value::Bool(
+          bits_ops::UGreaterThanOrEqual(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kSLt:
+      result =
+          Value::Bool(bits_ops::SLessThan(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kSLe:
+      result = Value::Bool(
+          bits_ops::SLessThanOrEqual(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kSGt:
+      result =
+          Value::Bool(bits_ops::SGreaterThan(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kSGe:
+      result = Value::Bool(
+          bits_ops::SGreaterThanOrEqual(bits_operand(0), bits_operand(1)));
+      return absl::OkStatus();
+    case Op::kShll:
+      result =
+          Value(bits_ops::ShiftLeftLogical(bits_operand(0), shift_amount()));
+      return absl::OkStatus();
+    case Op::kShrl:
+      result =
+          Value(bits_ops::ShiftRightLogical(bits_operand(0), shift_amount()));
+      return absl::OkStatus();
+    case Op::kShra:
+      result =
+          Value(bits_ops::ShiftRightArith(bits_operand(0), shift_amount()));
+      return absl::OkStatus();
+    case Op::kBitSlice: {
+      BitSlice* bit_slice = node->As<BitSlice>();
+      result = Value(bits_operand(0).Slice(bit_slice->start(),
+                                           bit_slice->width()));
+      return absl::OkStatus();
+    }
+    case Op::kConcat: {
+      std::vector<Bits> operands;
+      operands.reserve(instruction.operands.size());
+      for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+        operands.push_back(bits_operand(i));
+      }
+      result = Value(bits_ops::Concat(operands));
+      return absl::OkStatus();
+    }
+    case Op::kZeroExt:
+      result = Value(bits_ops::ZeroExtend(
+          bits_operand(0), node->As<ExtendOp>()->new_bit_count()));
+      return absl::OkStatus();
+    case Op::kSignExt:
+      result = Value(bits_ops::SignExtend(
+          bits_operand(0), node->As<ExtendOp>()->new_bit_count()));
+      return absl::OkStatus();
+    case Op::kSel: {
+      // Operands are the selector, the cases and then the optional default.
+      const int64_t case_count = node->As<Select>()->cases().size();
+      uint64_t selected = BitsToBoundedUint64(bits_operand(0), case_count);
+      XLS_RET_CHECK_LT(selected + 1, instruction.operands.size());
+      result = operand(instruction, 1 + selected);
+      return absl::OkStatus();
+    }
+    case Op::kTuple: {
+      std::vector<Value> elements;
+      elements.reserve(instruction.operands.size());
+      for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+        elements.push_back(operand(instruction, i));
+      }
+      result = Value::TupleOwned(std::move(elements));
+      return absl::OkStatus();
+    }
+    case Op::kTupleIndex:
+      result = operand(instruction, 0).element(node->As<TupleIndex>()->index());
+      return absl::OkStatus();
+    case Op::kArray: {
+      std::vector<Value> elements;
+      elements.reserve(instruction.operands.size());
+      for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+        elements.push_back(operand(instruction, i));
+      }
+      result = Value::ArrayOwned(std::move(elements));
+      return absl::OkStatus();
+    }
+    case Op::kArrayIndex: {
+      const Value* array = &operand(instruction, 0);
+      for (int64_t i = 1; i < instruction.operands.size(); ++i) {
+        array = &array->element(
+            BitsToBoundedUint64(bits_operand(i), array->size() - 1));
+      }
+      result = *array;
+      return absl::OkStatus();
+    }
+    case Op::kInvoke: {
+      std::vector<Value> call_args;
+      call_args.reserve(instruction.operands.size());
+      for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+        call_args.push_back(operand(instruction, i));
+      }
+      XLS_ASSIGN_OR_RETURN(result,
+                           RunCallee(instruction.callee, call_args, events));
+      return absl::OkStatus();
+    }
+    case Op::kMap: {
+      std::vector<Value> results;
+      results.reserve(operand(instruction, 0).size());
+      for (const Value& element : operand(instruction, 0).elements()) {
+        XLS_ASSIGN_OR_RETURN(
+            Value mapped,
+            RunCallee(instruction.callee, absl::MakeConstSpan(&element, 1),
+                      events));
+        results.push_back(std::move(mapped));
+      }
+      XLS_ASSIGN_OR_RETURN(result, Value::Array(results));
+      return absl::OkStatus();
+    }
+    case Op::kCountedFor: {
+      CountedFor* counted_for = node->As<CountedFor>();
+      const int64_t iv_width =
+          counted_for->body()->param(0)->GetType()->AsBitsOrDie()->bit_count();
+      // Arguments of the body are the induction variable, the loop state and
+      // then the invariant operands of the loop.
+      std::vector<Value> body_args;
+      body_args.reserve(instruction.operands.size() + 1);
+      body_args.push_back(Value());
+      for (int64_t i = 0; i < instruction.operands.size(); ++i) {
+        body_args.push_back(operand(instruction, i));
+      }
+      for (int64_t i = 0, iv = 0; i < counted_for->trip_count();
+           ++i, iv += counted_for->stride()) {
+        body_args[0] = Value(UBits(iv, iv_width));
+        XLS_ASSIGN_OR_RETURN(
+            body_args[1], RunCallee(instruction.callee, body_args, events));
+      }
+      result = std::move(body_args[1]);
+      return absl::OkStatus();
+    }
+    default:
+      return absl::InternalError(absl::StrFormat(
+          "Op %s of node %s is not compiled", OpToString(instruction.op),
+          node->ToString()));
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,116 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+#define XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Interpreter for a function which is evaluated many times, e.g. on platforms
+// without the JIT. Rather than visiting the function with an IrInterpreter on
+// every call, the function is linearized once into a topologically ordered
+// array of instructions whose operands and results are dense indices into a
+// value arena, which is reused across calls. Common bits operations, tuples,
+// selects and literals are evaluated directly on the arena; invoked, mapped
+// and counted-for bodies are themselves compiled; every other operation is
+// delegated to the IrInterpreter handler for that node.
+//
+// Results and events are identical to those of InterpretFunction. The
+// function must not be modified while the compiled interpreter is alive, and
+// a compiled interpreter may not be run concurrently from multiple threads.
+class CompiledFunctionInterpreter {
+ public:
+  static absl::StatusOr<std::unique_ptr<CompiledFunctionInterpreter>> Create(
+      Function* function);
+
+  Function* function() const { return function_; }
+
+  // Runs the function on the given positional arguments.
+  absl::StatusOr<InterpreterResult<Value>> Run(
+      absl::Span<const Value> args,
+      std::optional<EvaluationObserver*> observer = std::nullopt);
+
+ private:
+  struct Instruction {
+    Node* node;
+    Op op;
+    // Arena index of the result of the instruction.
+    int64_t result;
+    // Arena indices of the operands of the instruction.
+    absl::InlinedVector<int64_t, 3> operands;
+    // Parameter number of kParam instructions.
+    int64_t param_index = -1;
+    // Compiled body of kInvoke, kMap and kCountedFor instructions.
+    CompiledFunctionInterpreter* callee = nullptr;
+    // Whether the instruction is evaluated by the IrInterpreter.
+    bool fallback = false;
+  };
+
+  explicit CompiledFunctionInterpreter(Function* function)
+      : function_(function) {}
+
+  absl::Status Compile();
+  absl::StatusOr<CompiledFunctionInterpreter*> GetCallee(Function* callee);
+
+  // Evaluates `instruction`, writing its result into the arena.
+  absl::Status Execute(const Instruction& instruction,
+                       absl::Span<const Value> args,
+                       InterpreterEvents& events);
+  absl::Status ExecuteFallback(const Instruction& instruction,
+                               InterpreterEvents& events,
+                               std::optional<EvaluationObserver*> observer);
+  absl::StatusOr<Value> RunCallee(CompiledFunctionInterpreter* callee,
+                                  absl::Span<const Value> args,
+                                  InterpreterEvents& events);
+
+  const Value& operand(const Instruction& instruction, int64_t i) const {
+    return values_[instruction.operands[i]];
+  }
+
+  Function* function_;
+  std::vector<Instruction> instructions_;
+  int64_t return_value_ = -1;
+
+  // The value arena, indexed by position in `instructions_`. Literal results
+  // are written once at compile time.
+  std::vector<Value> values_;
+
+  // Node values handed to the IrInterpreter for fallback instructions.
+  absl::flat_hash_map<Node*, Value> fallback_values_;
+
+  absl::flat_hash_map<Function*, std::unique_ptr<CompiledFunctionInterpreter>>
+      callees_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_COMPILED_FUNCTION_INTERPRETER_H_
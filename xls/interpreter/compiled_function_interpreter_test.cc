@@ -0,0 +1,148 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/compiled_function_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/ir_evaluator_test_base.h"
+#include "xls/interpreter/observer.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/keyword_args.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+absl::StatusOr<InterpreterResult<Value>> CompileAndRun(
+    Function* function, absl::Span<const Value> args,
+    std::optional<EvaluationObserver*> observer) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<CompiledFunctionInterpreter> compiled,
+                       CompiledFunctionInterpreter::Create(function));
+  return compiled->Run(args, observer);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    CompiledFunctionInterpreterTest, IrEvaluatorTestBase,
+    testing::Values(IrEvaluatorTestParam(
+        CompileAndRun,
+        [](Function* function,
+           const absl::flat_hash_map<std::string, Value>& kwargs,
+           std::optional<EvaluationObserver*> observer)
+            -> absl::StatusOr<InterpreterResult<Value>> {
+          XLS_ASSIGN_OR_RETURN(std::vector<Value> args,
+                               KeywordArgsToPositional(*function, kwargs));
+          return CompileAndRun(function, args, observer);
+        },
+        true, "CompiledFunctionInterpreter")),
+    testing::PrintToStringParamName());
+
+class CompiledFunctionInterpreterOnlyTest : public IrTestBase {};
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, ReusedAcrossCalls) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package,
+                           ParsePackage(R"(
+package test
+
+fn body(i: bits[8], accum: bits[8], x: bits[8]) -> bits[8] {
+  add.1: bits[8] = add(accum, i)
+  ret add.2: bits[8] = add(add.1, x)
+}
+
+top fn f(x: bits[8], y: bits[8]) -> (bits[8], bits[1]) {
+  counted_for.3: bits[8] = counted_for(y, trip_count=4, stride=1, body=body,
+                                       invariant_args=[x])
+  ult.4: bits[1] = ult(x, y)
+  ret tuple.5: (bits[8], bits[1]) = tuple(counted_for.3, ult.4)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> compiled,
+      CompiledFunctionInterpreter::Create(f));
+  for (int64_t x = 0; x < 8; ++x) {
+    for (int64_t y = 0; y < 8; ++y) {
+      std::vector<Value> args = {Value(UBits(x, 8)), Value(UBits(y, 8))};
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                               InterpretFunction(f, args));
+      XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                               compiled->Run(args));
+      EXPECT_EQ(actual.value, expected.value);
+      EXPECT_EQ(actual.value,
+                Value::Tuple({Value(UBits(y + 6 + 4 * x, 8)),
+                              Value::Bool(x < y)}));
+    }
+  }
+}
+
+TEST_F(CompiledFunctionInterpreterOnlyTest, EventsOfCompiledAndFallbackNodes) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto package,
+                           ParsePackage(R"(
+package test
+
+fn callee(tkn: token, x: bits[8]) -> bits[8] {
+  umul.1: bits[8] = umul(x, x)
+  literal.2: bits[1] = literal(value=1)
+  trace.3: token = trace(tkn, literal.2, format="x is {}", data_operands=[x])
+  ret identity.4: bits[8] = identity(umul.1)
+}
+
+top fn f(tkn: token, x: bits[8]) -> bits[9] {
+  invoke.5: bits[8] = invoke(tkn, x, to_apply=callee)
+  literal.6: bits[8] = literal(value=9)
+  ult.7: bits[1] = ult(invoke.5, literal.6)
+  assert.8: token = assert(tkn, ult.7, message="too big")
+  ret one_hot.9: bits[9] = one_hot(invoke.5, lsb_prio=true)
+}
+)"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CompiledFunctionInterpreter> compiled,
+      CompiledFunctionInterpreter::Create(f));
+  for (int64_t x : {2, 5}) {
+    std::vector<Value> args = {Value::Token(), Value(UBits(x, 8))};
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected,
+                             InterpretFunction(f, args));
+    XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> actual,
+                             compiled->Run(args));
+    EXPECT_EQ(actual.value, expected.value);
+    EXPECT_EQ(actual.events, expected.events);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      InterpreterResult<Value> result,
+      compiled->Run({Value::Token(), Value(UBits(5, 8))}));
+  EXPECT_THAT(result.events.assert_msgs, ElementsAre("too big"));
+  EXPECT_EQ(result.events.trace_msgs.size(), 1);
+}
+
+}  // namespace
+}  // namespace xls
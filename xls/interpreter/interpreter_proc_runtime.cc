@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/interpreter_proc_runtime.h"
 
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/serial_proc_runtime.h"
@@ -32,12 +34,21 @@
 namespace xls {
 namespace {
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
-    ProcElaboration elaboration, const EvaluatorOptions& options) {
+// Creates the queue manager and a ProcInterpreter for each proc in the
+// elaboration, then builds the runtime with `create_runtime` and injects the
+// initial channel values. If `lock_free_queues` is true, single-producer/
+// single-consumer streaming channels are backed by lock-free queues.
+template <typename RuntimeT, typename CreateFn>
+absl::StatusOr<std::unique_ptr<RuntimeT>> CreateRuntime(
+    ProcElaboration elaboration, bool lock_free_queues,
+    CreateFn create_runtime) {
   // Create a queue manager for the queues. This factory verifies that there an
   // receive only queue for every receive only channel.
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ChannelQueueManager> queue_manager,
-                       ChannelQueueManager::Create(std::move(elaboration)));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<ChannelQueueManager> queue_manager,
+      lock_free_queues
+          ? ChannelQueueManager::CreateLockFree(std::move(elaboration))
+          : ChannelQueueManager::Create(std::move(elaboration)));
 
   // Create a ProcInterpreter for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_interpreters;
@@ -48,9 +59,8 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
 
   // Create a runtime.
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<SerialProcRuntime> proc_runtime,
-      SerialProcRuntime::Create(std::move(proc_interpreters),
-                                std::move(queue_manager), options));
+      std::unique_ptr<RuntimeT> proc_runtime,
+      create_runtime(std::move(proc_interpreters), std::move(queue_manager)));
 
   // Inject initial values into channel queues.
   for (ChannelInstance* channel_instance :
@@ -66,6 +76,30 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   return proc_runtime;
 }
 
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateSerialRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options) {
+  return CreateRuntime<SerialProcRuntime>(
+      std::move(elaboration), /*lock_free_queues=*/false,
+      [&](std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+          std::unique_ptr<ChannelQueueManager>&& queue_manager) {
+        return SerialProcRuntime::Create(std::move(evaluators),
+                                         std::move(queue_manager), options);
+      });
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    int64_t num_threads) {
+  return CreateRuntime<ParallelProcRuntime>(
+      std::move(elaboration), /*lock_free_queues=*/true,
+      [&](std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+          std::unique_ptr<ChannelQueueManager>&& queue_manager) {
+        return ParallelProcRuntime::Create(std::move(evaluators),
+                                           std::move(queue_manager), options,
+                                           num_threads);
+      });
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
@@ -73,14 +107,31 @@ CreateInterpreterSerialProcRuntime(Package* package,
                                    const EvaluatorOptions& options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateRuntime(std::move(elaboration), options);
+  return CreateSerialRuntime(std::move(elaboration), options);
 }
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
 CreateInterpreterSerialProcRuntime(Proc* top, const EvaluatorOptions& options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
-  return CreateRuntime(std::move(elaboration), options);
+  return CreateSerialRuntime(std::move(elaboration), options);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateInterpreterParallelProcRuntime(Package* package,
+                                     const EvaluatorOptions& options,
+                                     int64_t num_threads) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateParallelRuntime(std::move(elaboration), options, num_threads);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateInterpreterParallelProcRuntime(Proc* top, const EvaluatorOptions& options,
+                                     int64_t num_threads) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateParallelRuntime(std::move(elaboration), options, num_threads);
 }
 
 }  // namespace xls
@@ -15,10 +15,12 @@
 #ifndef XLS_INTERPRETER_INTERPRETER_PROC_RUNTIME_H_
 #define XLS_INTERPRETER_INTERPRETER_PROC_RUNTIME_H_
 
+#include <cstdint>
 #include <memory>
 
 #include "absl/status/statusor.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
 
@@ -36,6 +38,21 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>>
 CreateInterpreterSerialProcRuntime(
     Proc* top, const EvaluatorOptions& options = EvaluatorOptions());
 
+// Create a ParallelProcRuntime composed of ProcInterpreters. Supports
+// old-style procs. `num_threads` is the number of worker threads; if zero, one
+// worker per available CPU is used.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateInterpreterParallelProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions(),
+    int64_t num_threads = 0);
+
+// Create a ParallelProcRuntime composed of ProcInterpreters. Constructed from
+// the elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateInterpreterParallelProcRuntime(
+    Proc* top, const EvaluatorOptions& options = EvaluatorOptions(),
+    int64_t num_threads = 0);
+
 }  // namespace xls
 
 #endif  // XLS_INTERPRETER_INTERPRETER_PROC_RUNTIME_H_
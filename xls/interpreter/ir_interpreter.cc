@@ -35,6 +35,7 @@
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/compact_trace.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/format_strings.h"
@@ -99,6 +100,8 @@ absl::Status IrInterpreter::AddInterpreterEvents(
     GetInterpreterEvents().assert_msgs.push_back(assert_msg);
   }
 
+  GetInterpreterEvents().compact_traces.Append(events.compact_traces);
+
   return absl::OkStatus();
 }
 
@@ -336,7 +339,7 @@ absl::Status IrInterpreter::HandleDynamicCountedFor(
                          InterpretFunction(body, args_for_body));
     XLS_RETURN_IF_ERROR(AddInterpreterEvents(loop_result.events));
     loop_state = loop_result.value;
-    index = bits_ops::Add(index, extended_stride);
+    bits_ops::AddInPlace(&index, extended_stride);
   }
 
   return SetValueResult(dynamic_counted_for, loop_state);
@@ -347,7 +350,7 @@ absl::Status IrInterpreter::HandleEncode(Encode* encode) {
   Bits result(encode->BitCountOrDie());
   for (int64_t i = 0; i < input.bit_count(); ++i) {
     if (input.Get(i)) {
-      result = bits_ops::Or(result, UBits(i, encode->BitCountOrDie()));
+      bits_ops::OrInPlace(&result, UBits(i, encode->BitCountOrDie()));
     }
   }
   return SetBitsResult(encode, result);
@@ -441,12 +444,20 @@ static absl::Status SetArrayElement(absl::Span<const Bits> indices,
 
 absl::Status IrInterpreter::HandleArrayIndex(ArrayIndex* index) {
   const Value* array = &ResolveAsValue(index->array());
-  for (Node* index_operand : index->indices()) {
+  absl::Span<Node* const> indices = index->indices();
+  if (indices.empty()) {
+    return SetValueResult(index, *array);
+  }
+  for (Node* index_operand : indices.subspan(0, indices.size() - 1)) {
     uint64_t idx =
         BitsToBoundedUint64(ResolveAsBits(index_operand), array->size() - 1);
     array = &array->element(idx);
   }
-  return SetValueResult(index, *array);
+  // The innermost element is taken by value so indexing a packed bits array
+  // does not box its elements.
+  uint64_t idx =
+      BitsToBoundedUint64(ResolveAsBits(indices.back()), array->size() - 1);
+  return SetValueResult(index, array->GetElement(idx));
 }
 
 absl::Status IrInterpreter::HandleArraySlice(ArraySlice* slice) {
@@ -455,11 +466,7 @@ absl::Status IrInterpreter::HandleArraySlice(ArraySlice* slice) {
   std::vector<Value> sliced;
   sliced.reserve(slice->width());
   for (int64_t i = start; i < start + slice->width(); i++) {
-    if (i >= array.elements().size()) {
-      sliced.push_back(array.elements().back());
-    } else {
-      sliced.push_back(array.elements()[i]);
-    }
+    sliced.push_back(array.GetElement(std::min<int64_t>(i, array.size() - 1)));
   }
   XLS_ASSIGN_OR_RETURN(Value result, Value::Array(sliced));
   return SetValueResult(slice, result);
@@ -511,6 +518,17 @@ absl::Status IrInterpreter::HandleAssert(Assert* assert_op) {
 }
 
 absl::Status IrInterpreter::HandleTrace(Trace* trace_op) {
+  if (compact_traces_) {
+    if (ResolveAsBool(trace_op->condition())) {
+      std::string operand_bytes;
+      for (Node* arg : trace_op->args()) {
+        AppendCompactTraceOperand(ResolveAsValue(arg), operand_bytes);
+      }
+      GetInterpreterEvents().compact_traces.Append(trace_op->id(),
+                                                   operand_bytes);
+    }
+    return SetValueResult(trace_op, Value::Token());
+  }
   if (ResolveAsBool(trace_op->condition())) {
     absl::Span<Node* const> arg_nodes = trace_op->args();
     auto arg_node = arg_nodes.begin();
@@ -907,7 +925,7 @@ absl::StatusOr<Value> IrInterpreter::DeepOr(
   if (input_type->IsBits()) {
     Bits result(input_type->AsBitsOrDie()->bit_count());
     for (const Value* input : inputs) {
-      result = bits_ops::Or(result, input->bits());
+      bits_ops::OrInPlace(&result, input->bits());
     }
     return Value(result);
   }
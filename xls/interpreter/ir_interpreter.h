@@ -76,6 +76,11 @@ class IrInterpreter : public DfsVisitor {
 
   absl::Status AddInterpreterEvents(const InterpreterEvents& events);
 
+  // In compact trace mode traces are recorded unformatted in the events'
+  // `compact_traces` log instead of `trace_msgs`; see `TraceSiteTable`.
+  void set_compact_traces(bool value) { compact_traces_ = value; }
+  bool compact_traces() const { return compact_traces_; }
+
   // Returns true if a value has been set for the result of the given node.
   bool HasResult(Node* node) const { return NodeValuesMap().contains(node); }
 
@@ -217,6 +222,7 @@ class IrInterpreter : public DfsVisitor {
   InterpreterEvents* events_ptr_;
   InterpreterEvents events_;
   std::optional<EvaluationObserver*> observer_;
+  bool compact_traces_ = false;
 };
 
 }  // namespace xls
@@ -0,0 +1,192 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+/* static */ absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+ParallelProcRuntime::Create(
+    std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+    std::unique_ptr<ChannelQueueManager>&& queue_manager,
+    const EvaluatorOptions& options, int64_t num_threads) {
+  // Verify there exists exactly one evaluator per proc in the package.
+  absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluator_map;
+  for (std::unique_ptr<ProcEvaluator>& evaluator : evaluators) {
+    Proc* proc = evaluator->proc();
+    auto [it, inserted] = evaluator_map.insert({proc, std::move(evaluator)});
+    XLS_RET_CHECK(inserted) << absl::StreamFormat(
+        "More than one evaluator given for proc `%s`", proc->name());
+  }
+  for (Proc* proc : queue_manager->elaboration().procs()) {
+    XLS_RET_CHECK(evaluator_map.contains(proc))
+        << absl::StreamFormat("No evaluator given for proc `%s`", proc->name());
+  }
+  XLS_RET_CHECK_EQ(evaluator_map.size(),
+                   queue_manager->elaboration().procs().size())
+      << "More evaluators than procs given.";
+  XLS_RET_CHECK_GE(num_threads, 0);
+  return absl::WrapUnique(new ParallelProcRuntime(std::move(evaluator_map),
+                                                  std::move(queue_manager),
+                                                  options, num_threads));
+}
+
+absl::StatusOr<ParallelProcRuntime::NetworkTickResult>
+ParallelProcRuntime::TickInternal() {
+  VLOG(3) << absl::StreamFormat("TickInternal on package %s",
+                                package()->name());
+
+  // State shared by all of the tasks ticking proc instances during this
+  // network tick.
+  struct TickState {
+    absl::Mutex mutex;
+    // Map containing any blocked proc instances and the channels they are
+    // blocked on.
+    absl::flat_hash_map<ChannelInstance*, ProcInstance*> blocked_instances
+        ABSL_GUARDED_BY(mutex);
+    bool progress_made ABSL_GUARDED_BY(mutex) = false;
+    bool progress_made_on_io_procs ABSL_GUARDED_BY(mutex) = false;
+    // The first error encountered. Once set no further ticks are started.
+    absl::Status status ABSL_GUARDED_BY(mutex);
+  };
+  TickState state;
+
+  // Ticks the given proc instance once (until it completes, sends or blocks)
+  // and reschedules it (and any instance it unblocks) as appropriate. A proc
+  // instance is only ever scheduled, running, or parked at a time so its
+  // continuation is never touched by two threads at once.
+  std::function<void(ProcInstance*)> tick_instance;
+  tick_instance = [&](ProcInstance* instance) {
+    {
+      absl::MutexLock lock(&state.mutex);
+      if (!state.status.ok()) {
+        return;
+      }
+    }
+    ProcEvaluator* evaluator = evaluators_.at(instance->proc()).get();
+    ProcContinuation* continuation = continuations_.at(instance).get();
+
+    VLOG(3) << absl::StreamFormat("Ticking proc instance `%s`",
+                                  instance->GetName());
+    absl::StatusOr<TickResult> tick_result;
+    if (observer_.has_value()) {
+      absl::MutexLock lock(&observer_mutex_);
+      tick_result = evaluator->Tick(*continuation);
+    } else {
+      tick_result = evaluator->Tick(*continuation);
+    }
+    absl::Status status = tick_result.status();
+    if (status.ok()) {
+      status = InterpreterEventsToStatus(GetInterpreterEvents(instance));
+    }
+
+    absl::MutexLock lock(&state.mutex);
+    if (!status.ok()) {
+      if (state.status.ok()) {
+        state.status = std::move(status);
+      }
+      return;
+    }
+    VLOG(3) << "Tick result: " << *tick_result;
+
+    state.progress_made |= tick_result->progress_made;
+    state.progress_made_on_io_procs |=
+        (tick_result->progress_made && evaluator->ProcHasIoOperations());
+    if (tick_result->execution_state == TickExecutionState::kSentOnChannel) {
+      ChannelInstance* channel_instance = tick_result->channel_instance.value();
+      auto it = state.blocked_instances.find(channel_instance);
+      if (it != state.blocked_instances.end()) {
+        ProcInstance* unblocked = it->second;
+        VLOG(3) << absl::StreamFormat(
+            "Unblocking proc instance `%s` and adding to ready list",
+            unblocked->GetName());
+        state.blocked_instances.erase(it);
+        thread_pool_->Schedule(
+            [&tick_instance, unblocked]() { tick_instance(unblocked); });
+      }
+      // This proc instance can go back on the ready queue.
+      thread_pool_->Schedule(
+          [&tick_instance, instance]() { tick_instance(instance); });
+    } else if (tick_result->execution_state ==
+               TickExecutionState::kBlockedOnReceive) {
+      ChannelInstance* channel_instance = tick_result->channel_instance.value();
+      // A sender may have written to the channel after this instance found it
+      // empty but before we acquired the lock. Senders check for blocked
+      // instances while holding the lock, so checking the queue here (under
+      // the same lock) guarantees the wakeup is not lost.
+      if (!queue_manager().GetQueue(channel_instance).IsEmpty()) {
+        thread_pool_->Schedule(
+            [&tick_instance, instance]() { tick_instance(instance); });
+      } else {
+        VLOG(3) << absl::StreamFormat(
+            "Proc instance `%s` is now blocked on channel instance `%s`",
+            instance->GetName(), channel_instance->ToString());
+        state.blocked_instances[channel_instance] = instance;
+      }
+    }
+  };
+
+  // Put all proc instances on the ready list.
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    VLOG(3) << absl::StreamFormat("Proc instance `%s` added to ready list",
+                                  instance->GetName());
+    thread_pool_->Schedule(
+        [&tick_instance, instance]() { tick_instance(instance); });
+  }
+  thread_pool_->WaitForIdle();
+
+  absl::MutexLock lock(&state.mutex);
+  XLS_RETURN_IF_ERROR(state.status);
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  std::vector<ProcInstance*> blocked_proc_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    if (auto it = state.blocked_instances.find(instance);
+        it != state.blocked_instances.end()) {
+      blocked_channel_instances.push_back(instance);
+      blocked_proc_instances.push_back(it->second);
+    }
+  }
+  return NetworkTickResult{
+      .progress_made = state.progress_made,
+      .progress_made_on_io_procs = state.progress_made_on_io_procs,
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+      .blocked_proc_instances = std::move(blocked_proc_instances),
+  };
+}
+
+}  // namespace xls
@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+#define XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread_pool.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Class for interpreting a network of procs where independent proc instances
+// are ticked concurrently on a work-stealing thread pool. Proc instances
+// communicate only through channel queues so any instance which is not
+// blocked on a receive may be ticked at the same time as any other. A proc
+// instance which blocks on an empty channel is parked until a send on that
+// channel wakes it up. Deadlock detection and NetworkTickResult semantics are
+// identical to SerialProcRuntime.
+//
+// The channel queue manager must hold thread-safe queues (e.g., be created
+// with ChannelQueueManager::Create or CreateLockFree, or with the corresponding
+// JitChannelQueueManager factories).
+// If an observer is attached, evaluator ticks are serialized so the observer
+// need not be thread-safe. ParallelProcRuntimes are thread-compatible, but not
+// thread-safe.
+class ParallelProcRuntime : public ProcRuntime {
+ public:
+  // Creates and returns a parallel proc network runtime for the given
+  // evaluators. `num_threads` is the number of worker threads; if zero, one
+  // worker per available CPU is used.
+  static absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> Create(
+      std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options = EvaluatorOptions(),
+      int64_t num_threads = 0);
+
+  int64_t num_threads() const { return thread_pool_->num_threads(); }
+
+ private:
+  ParallelProcRuntime(
+      absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>>&& evaluators,
+      std::unique_ptr<ChannelQueueManager>&& queue_manager,
+      const EvaluatorOptions& options, int64_t num_threads)
+      : ProcRuntime(std::move(evaluators), std::move(queue_manager), options),
+        thread_pool_(std::make_unique<ThreadPool>(num_threads)) {}
+
+  absl::StatusOr<NetworkTickResult> TickInternal() override;
+
+  std::unique_ptr<ThreadPool> thread_pool_;
+
+  // Serializes evaluator ticks while an observer is attached.
+  absl::Mutex observer_mutex_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PARALLEL_PROC_RUNTIME_H_
@@ -0,0 +1,129 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/parallel_proc_runtime.h"
+
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+constexpr const char kIrAssertPath[] = "xls/interpreter/force_assert.ir";
+
+TEST(ParallelProcRuntimeTest, JitAsserts) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::filesystem::path ir_path,
+                           GetXlsRunfilePath(kIrAssertPath));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           CreateJitParallelProcRuntime(package.get()));
+
+  EXPECT_THAT(runtime->Tick(),
+              absl_testing::StatusIs(
+                  absl::StatusCode::kAborted,
+                  ::testing::HasSubstr("Assertion failure via fail!")));
+}
+
+TEST(ParallelProcRuntimeTest, InterpreterAsserts) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::filesystem::path ir_path,
+                           GetXlsRunfilePath(kIrAssertPath));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(auto runtime,
+                           CreateInterpreterParallelProcRuntime(package.get()));
+
+  EXPECT_THAT(runtime->Tick(),
+              absl_testing::StatusIs(
+                  absl::StatusCode::kAborted,
+                  ::testing::HasSubstr("Assertion failure via fail!")));
+}
+
+TEST(ParallelProcRuntimeTest, ExplicitThreadCount) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::filesystem::path ir_path,
+                           GetXlsRunfilePath(kIrAssertPath));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runtime, CreateInterpreterParallelProcRuntime(
+                        package.get(), EvaluatorOptions(), /*num_threads=*/3));
+  EXPECT_EQ(runtime->num_threads(), 3);
+}
+
+// Instantiate and run all the tests in proc_runtime_test_base.cc using a
+// parallel runtime. A single-threaded configuration is included as it
+// exercises the same scheduling logic with deterministic ordering.
+INSTANTIATE_TEST_SUITE_P(
+    ProcRuntimeTest, ProcRuntimeTestBase,
+    testing::Values(
+        ProcRuntimeTestParam(
+            "interpreter",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterParallelProcRuntime(package, options)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterParallelProcRuntime(top, options).value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "interpreter_single_thread",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterParallelProcRuntime(package, options,
+                                                          /*num_threads=*/1)
+                  .value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateInterpreterParallelProcRuntime(top, options,
+                                                          /*num_threads=*/1)
+                  .value();
+            },
+            /*supports_observers=*/true),
+        ProcRuntimeTestParam(
+            "jit",
+            [](Package* package, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(package, options).value();
+            },
+            [](Proc* top, const EvaluatorOptions& options)
+                -> std::unique_ptr<ProcRuntime> {
+              return CreateJitParallelProcRuntime(top, options).value();
+            },
+            /*supports_observers=*/true)),
+    [](const testing::TestParamInfo<ProcRuntimeTestBase::ParamType>& info) {
+      return info.param.name();
+    });
+
+}  // namespace
+}  // namespace xls
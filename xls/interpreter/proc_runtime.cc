@@ -36,6 +36,7 @@
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/events.h"
@@ -43,6 +44,7 @@
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
+#include "xls/ir/xls_value.pb.h"
 #include "xls/jit/jit_channel_queue.h"
 
 namespace xls {
@@ -124,9 +126,19 @@ ProcRuntime::ProcRuntime(
   }
 }
 
+absl::StatusOr<ProcRuntime::NetworkTickResult>
+ProcRuntime::TickAndRecordTelemetry() {
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  if (telemetry_ != nullptr) {
+    telemetry_->RecordTick(result.blocked_proc_instances,
+                           result.blocked_channel_instances);
+  }
+  return result;
+}
+
 absl::Status ProcRuntime::Tick() {
   std::vector<Channel*> blocked_channels;
-  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickAndRecordTelemetry());
   if (!result.progress_made) {
     // Not a single instruction executed on any proc. This is necessarily a
     // deadlock.
@@ -216,7 +228,7 @@ absl::StatusOr<int64_t> ProcRuntime::TickUntilBlocked(
                                 package()->name());
   int64_t ticks = 0;
   while (!max_ticks.has_value() || ticks < max_ticks.value()) {
-    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickAndRecordTelemetry());
     if (!result.progress_made_on_io_procs) {
       return ticks;
     }
@@ -238,6 +250,91 @@ void ProcRuntime::ResetState() {
   }
 }
 
+absl::StatusOr<ProcRuntimeSnapshotProto> ProcRuntime::Snapshot() {
+  ProcRuntimeSnapshotProto snapshot;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    const ProcContinuation& continuation = *continuations_.at(instance);
+    if (!continuation.AtStartOfTick()) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Cannot snapshot proc instance `%s` partway through a tick",
+          instance->GetName()));
+    }
+    ProcInstanceSnapshotProto* proc = snapshot.add_procs();
+    proc->set_instance(instance->GetName());
+    for (const Value& value : continuation.GetState()) {
+      XLS_ASSIGN_OR_RETURN(*proc->add_state(), value.AsProto());
+    }
+  }
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    std::vector<Value> contents = queue->GetContents();
+    if (contents.empty()) {
+      continue;
+    }
+    ChannelQueueSnapshotProto* channel_queue = snapshot.add_channel_queues();
+    channel_queue->set_channel_instance(queue->channel_instance()->ToString());
+    for (const Value& value : contents) {
+      XLS_ASSIGN_OR_RETURN(*channel_queue->add_values(), value.AsProto());
+    }
+  }
+  return snapshot;
+}
+
+absl::Status ProcRuntime::RestoreSnapshot(
+    const ProcRuntimeSnapshotProto& snapshot) {
+  absl::flat_hash_map<std::string, ProcInstance*> instances;
+  for (ProcInstance* instance : elaboration().proc_instances()) {
+    instances[instance->GetName()] = instance;
+  }
+  absl::flat_hash_map<std::string, ChannelQueue*> queues;
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    queues[queue->channel_instance()->ToString()] = queue;
+  }
+
+  // Decode everything before modifying the runtime so a bad snapshot leaves it
+  // untouched.
+  std::vector<std::pair<ProcInstance*, std::vector<Value>>> states;
+  for (const ProcInstanceSnapshotProto& proc : snapshot.procs()) {
+    auto it = instances.find(proc.instance());
+    if (it == instances.end()) {
+      return absl::NotFoundError(absl::StrFormat(
+          "Snapshot contains unknown proc instance `%s`", proc.instance()));
+    }
+    std::vector<Value> state;
+    state.reserve(proc.state_size());
+    for (const ValueProto& value : proc.state()) {
+      XLS_ASSIGN_OR_RETURN(Value element, Value::FromProto(value));
+      state.push_back(std::move(element));
+    }
+    states.emplace_back(it->second, std::move(state));
+  }
+  std::vector<std::pair<ChannelQueue*, std::vector<Value>>> contents;
+  for (const ChannelQueueSnapshotProto& channel_queue :
+       snapshot.channel_queues()) {
+    auto it = queues.find(channel_queue.channel_instance());
+    if (it == queues.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("Snapshot contains unknown channel instance `%s`",
+                          channel_queue.channel_instance()));
+    }
+    std::vector<Value> values;
+    values.reserve(channel_queue.values_size());
+    for (const ValueProto& value : channel_queue.values()) {
+      XLS_ASSIGN_OR_RETURN(Value element, Value::FromProto(value));
+      values.push_back(std::move(element));
+    }
+    contents.emplace_back(it->second, std::move(values));
+  }
+
+  ResetState();
+  for (auto& [instance, state] : states) {
+    XLS_RETURN_IF_ERROR(SetState(instance, std::move(state)));
+  }
+  for (const auto& [queue, values] : contents) {
+    XLS_RETURN_IF_ERROR(queue->SetContents(values));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<JitChannelQueueManager*>
 ProcRuntime::GetJitChannelQueueManager() {
   auto* jit_qm = dynamic_cast<JitChannelQueueManager*>(queue_manager_.get());
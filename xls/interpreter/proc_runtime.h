@@ -30,6 +30,8 @@
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_evaluator.h"
+#include "xls/interpreter/proc_runtime_telemetry.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/events.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -109,6 +111,16 @@ class ProcRuntime {
   // Reset the state of all of the procs to their initial state.
   void ResetState();
 
+  // Captures the state of every proc instance and the contents of every
+  // channel queue. Every proc must be at the start of a tick, i.e. not blocked
+  // partway through an activation. Events are not included.
+  absl::StatusOr<ProcRuntimeSnapshotProto> Snapshot();
+
+  // Restores a snapshot created by `Snapshot`, possibly in another process
+  // running the same IR. Procs restart at the beginning of a tick with the
+  // snapshot's state; channel queues not in the snapshot are left unchanged.
+  absl::Status RestoreSnapshot(const ProcRuntimeSnapshotProto& snapshot);
+
   // Returns the events for each proc in the network.
   const InterpreterEvents& GetInterpreterEvents(
       const ProcInstance* instance) const {
@@ -142,6 +154,17 @@ class ProcRuntime {
   // could cause crashes.
   bool SupportsObservers() const;
 
+  // Starts collecting channel occupancy and stall telemetry at the end of every
+  // subsequent network tick, discarding any previously collected telemetry.
+  // See ProcRuntimeTelemetry for `record_timeline`.
+  void EnableTelemetry(bool record_timeline = false) {
+    telemetry_ = std::make_unique<ProcRuntimeTelemetry>(queue_manager_.get(),
+                                                        record_timeline);
+  }
+
+  // Returns the collected telemetry, or nullptr if telemetry is not enabled.
+  const ProcRuntimeTelemetry* telemetry() const { return telemetry_.get(); }
+
  protected:
   friend class ChannelTraceRecorder;
   void AddTraceMessage(TraceMessage message);
@@ -155,9 +178,17 @@ class ProcRuntime {
     bool progress_made_on_io_procs;
 
     std::vector<ChannelInstance*> blocked_channel_instances;
+
+    // The proc instances blocked on a receive at the end of the tick, in the
+    // same order as the channel instances they are blocked on in
+    // `blocked_channel_instances`.
+    std::vector<ProcInstance*> blocked_proc_instances;
   };
   virtual absl::StatusOr<NetworkTickResult> TickInternal() = 0;
 
+  // Calls TickInternal and records the result in the telemetry, if enabled.
+  absl::StatusOr<NetworkTickResult> TickAndRecordTelemetry();
+
   std::unique_ptr<ChannelQueueManager> queue_manager_;
   absl::flat_hash_map<Proc*, std::unique_ptr<ProcEvaluator>> evaluators_;
   absl::flat_hash_map<ProcInstance*, std::unique_ptr<ProcContinuation>>
@@ -168,6 +199,7 @@ class ProcRuntime {
 
   EvaluatorOptions options_;
   std::optional<EvaluationObserver*> observer_ = std::nullopt;
+  std::unique_ptr<ProcRuntimeTelemetry> telemetry_;
 };
 
 }  // namespace xls
@@ -0,0 +1,230 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/interpreter/proc_runtime_telemetry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+namespace {
+
+// Returns `s` as a quoted JSON string.
+std::string JsonString(std::string_view s) {
+  std::string result = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') {
+      absl::StrAppend(&result, "\\", std::string(1, c));
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppendFormat(&result, "\\u%04x", static_cast<int>(c));
+    } else {
+      result.push_back(c);
+    }
+  }
+  result.push_back('"');
+  return result;
+}
+
+}  // namespace
+
+ProcRuntimeTelemetry::ProcRuntimeTelemetry(ChannelQueueManager* queue_manager,
+                                           bool record_timeline)
+    : queue_manager_(queue_manager), record_timeline_(record_timeline) {
+  absl::Span<ChannelQueue* const> queues = queue_manager_->queues();
+  max_occupancies_.resize(queues.size(), 0);
+  occupancy_sums_.resize(queues.size(), 0);
+  occupancy_histograms_.resize(queues.size());
+  for (int64_t i = 0; i < queues.size(); ++i) {
+    channel_indices_[queues[i]->channel_instance()] = i;
+  }
+  absl::Span<ProcInstance* const> procs =
+      queue_manager_->elaboration().proc_instances();
+  blocked_ticks_.resize(procs.size(), 0);
+  for (int64_t i = 0; i < procs.size(); ++i) {
+    proc_indices_[procs[i]] = i;
+  }
+}
+
+void ProcRuntimeTelemetry::RecordTick(
+    absl::Span<ProcInstance* const> blocked_proc_instances,
+    absl::Span<ChannelInstance* const> blocked_channel_instances) {
+  CHECK_EQ(blocked_proc_instances.size(), blocked_channel_instances.size());
+  ++tick_count_;
+  Sample* sample = nullptr;
+  if (record_timeline_) {
+    sample = &timeline_.emplace_back();
+  }
+  absl::Span<ChannelQueue* const> queues = queue_manager_->queues();
+  for (int64_t i = 0; i < queues.size(); ++i) {
+    int64_t occupancy = queues[i]->GetSize();
+    max_occupancies_[i] = std::max(max_occupancies_[i], occupancy);
+    occupancy_sums_[i] += occupancy;
+    std::vector<int64_t>& histogram = occupancy_histograms_[i];
+    if (histogram.size() <= occupancy) {
+      histogram.resize(occupancy + 1, 0);
+    }
+    ++histogram[occupancy];
+    if (sample != nullptr) {
+      sample->occupancies.push_back(occupancy);
+    }
+  }
+  for (int64_t i = 0; i < blocked_proc_instances.size(); ++i) {
+    int64_t proc_index = proc_indices_.at(blocked_proc_instances[i]);
+    ++blocked_ticks_[proc_index];
+    if (sample != nullptr) {
+      sample->blocked.push_back({proc_index, blocked_channel_instances[i]});
+    }
+  }
+}
+
+ProcRuntimeTelemetry::ChannelStats ProcRuntimeTelemetry::GetChannelStats(
+    ChannelInstance* channel_instance) const {
+  int64_t index = channel_indices_.at(channel_instance);
+  const ChannelQueue* queue = queue_manager_->queues()[index];
+  return ChannelStats{
+      .max_occupancy = max_occupancies_[index],
+      .average_occupancy =
+          tick_count_ == 0 ? 0.0
+                           : static_cast<double>(occupancy_sums_[index]) /
+                                 static_cast<double>(tick_count_),
+      .push_count = queue->GetPushCount(),
+      .pop_count = queue->GetPopCount(),
+      .occupancy_histogram = occupancy_histograms_[index],
+  };
+}
+
+int64_t ProcRuntimeTelemetry::GetBlockedOnReceiveTicks(
+    ProcInstance* proc_instance) const {
+  return blocked_ticks_[proc_indices_.at(proc_instance)];
+}
+
+std::string ProcRuntimeTelemetry::Summary() const {
+  std::vector<std::string> lines;
+  lines.push_back(absl::StrFormat("Proc runtime telemetry after %d ticks:",
+                                  tick_count_));
+  lines.push_back("  Channels:");
+  for (ChannelQueue* queue : queue_manager_->queues()) {
+    ChannelStats stats = GetChannelStats(queue->channel_instance());
+    lines.push_back(absl::StrFormat(
+        "    %s: max occupancy %d, average occupancy %.2f, pushes %d, pops %d",
+        queue->channel_instance()->ToString(), stats.max_occupancy,
+        stats.average_occupancy, stats.push_count, stats.pop_count));
+  }
+  lines.push_back("  Ticks blocked on receive:");
+  for (ProcInstance* instance :
+       queue_manager_->elaboration().proc_instances()) {
+    lines.push_back(absl::StrFormat("    %s: %d", instance->GetName(),
+                                    GetBlockedOnReceiveTicks(instance)));
+  }
+  return absl::StrJoin(lines, "\n");
+}
+
+std::string ProcRuntimeTelemetry::ToChromeTrace() const {
+  if (!record_timeline_) {
+    return "";
+  }
+  constexpr int64_t kChannelsPid = 0;
+  constexpr int64_t kProcsPid = 1;
+  std::vector<std::string> events;
+  events.push_back(absl::StrFormat(
+      R"({"name":"process_name","ph":"M","pid":%d,)"
+      R"("args":{"name":"Channel occupancy"}})",
+      kChannelsPid));
+  events.push_back(absl::StrFormat(
+      R"({"name":"process_name","ph":"M","pid":%d,)"
+      R"("args":{"name":"Blocked on receive"}})",
+      kProcsPid));
+  absl::Span<ProcInstance* const> procs =
+      queue_manager_->elaboration().proc_instances();
+  for (int64_t i = 0; i < procs.size(); ++i) {
+    events.push_back(absl::StrFormat(
+        R"({"name":"thread_name","ph":"M","pid":%d,"tid":%d,)"
+        R"("args":{"name":%s}})",
+        kProcsPid, i, JsonString(procs[i]->GetName())));
+  }
+
+  // Emit a counter event whenever the occupancy of a channel changes.
+  absl::Span<ChannelQueue* const> queues = queue_manager_->queues();
+  for (int64_t c = 0; c < queues.size(); ++c) {
+    std::string name = JsonString(queues[c]->channel_instance()->ToString());
+    std::optional<int64_t> last;
+    for (int64_t tick = 0; tick < timeline_.size(); ++tick) {
+      int64_t occupancy = timeline_[tick].occupancies[c];
+      if (last == occupancy) {
+        continue;
+      }
+      last = occupancy;
+      events.push_back(absl::StrFormat(
+          R"({"name":%s,"ph":"C","pid":%d,"ts":%d,"args":{"occupancy":%d}})",
+          name, kChannelsPid, tick, occupancy));
+    }
+  }
+
+  // Emit a slice for each run of consecutive ticks in which a proc instance
+  // was blocked on the same channel.
+  struct Stall {
+    ChannelInstance* channel_instance;
+    int64_t start;
+  };
+  std::vector<std::optional<Stall>> stalls(procs.size());
+  auto end_stall = [&](int64_t proc_index, int64_t tick) {
+    std::optional<Stall>& stall = stalls[proc_index];
+    if (!stall.has_value()) {
+      return;
+    }
+    events.push_back(absl::StrFormat(
+        R"({"name":%s,"ph":"X","pid":%d,"tid":%d,"ts":%d,"dur":%d})",
+        JsonString(stall->channel_instance->ToString()), kProcsPid,
+        proc_index, stall->start, tick - stall->start));
+    stall.reset();
+  };
+  for (int64_t tick = 0; tick < timeline_.size(); ++tick) {
+    std::vector<ChannelInstance*> blocked_on(procs.size(), nullptr);
+    for (const auto& [proc_index, channel_instance] : timeline_[tick].blocked) {
+      blocked_on[proc_index] = channel_instance;
+    }
+    for (int64_t p = 0; p < procs.size(); ++p) {
+      if (stalls[p].has_value() &&
+          stalls[p]->channel_instance == blocked_on[p]) {
+        continue;
+      }
+      end_stall(p, tick);
+      if (blocked_on[p] != nullptr) {
+        stalls[p] = Stall{.channel_instance = blocked_on[p], .start = tick};
+      }
+    }
+  }
+  for (int64_t p = 0; p < procs.size(); ++p) {
+    end_stall(p, timeline_.size());
+  }
+
+  return absl::StrCat("{\"traceEvents\":[\n", absl::StrJoin(events, ",\n"),
+                      "\n]}\n");
+}
+
+}  // namespace xls
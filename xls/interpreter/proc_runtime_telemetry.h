@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_INTERPRETER_PROC_RUNTIME_TELEMETRY_H_
+#define XLS_INTERPRETER_PROC_RUNTIME_TELEMETRY_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/ir/proc_elaboration.h"
+
+namespace xls {
+
+// Channel occupancy and stall statistics of a proc network, sampled by
+// ProcRuntime at the end of every network tick once enabled with
+// ProcRuntime::EnableTelemetry. This is the only per-tick sampler of the
+// queues; activity profiles (see ActivityProfileObserver) take their channel
+// occupancy histograms from it. Sampling only reads the size of each queue
+// and the blocked proc instances reported by the tick, so the overhead is a
+// few operations per channel per tick; nothing is added to the per-value
+// paths beyond the push/pop counters maintained by the queues themselves.
+class ProcRuntimeTelemetry {
+ public:
+  struct ChannelStats {
+    // Largest occupancy observed at the end of a tick.
+    int64_t max_occupancy = 0;
+    // Average occupancy at the end of each tick.
+    double average_occupancy = 0.0;
+    // Total number of values written to and read from the channel.
+    int64_t push_count = 0;
+    int64_t pop_count = 0;
+    // Element `i` is the number of ticks at the end of which the channel held
+    // `i` values.
+    std::vector<int64_t> occupancy_histogram;
+  };
+
+  // If `record_timeline` is true the occupancy of every channel and the
+  // blocked proc instances are recorded for every tick for ToChromeTrace.
+  ProcRuntimeTelemetry(ChannelQueueManager* queue_manager,
+                       bool record_timeline);
+
+  // Records the end of a network tick. `blocked_proc_instances[i]` is blocked
+  // on a receive on `blocked_channel_instances[i]`.
+  void RecordTick(absl::Span<ProcInstance* const> blocked_proc_instances,
+                  absl::Span<ChannelInstance* const> blocked_channel_instances);
+
+  int64_t tick_count() const { return tick_count_; }
+
+  // The sampled queues.
+  absl::Span<ChannelQueue* const> queues() const {
+    return queue_manager_->queues();
+  }
+
+  ChannelStats GetChannelStats(ChannelInstance* channel_instance) const;
+
+  // Returns the number of recorded ticks at the end of which `proc_instance`
+  // was blocked on a receive.
+  int64_t GetBlockedOnReceiveTicks(ProcInstance* proc_instance) const;
+
+  // Returns a human-readable summary of the statistics of every channel and
+  // proc instance.
+  std::string Summary() const;
+
+  // Returns the recorded timeline in the Chrome trace event format (viewable
+  // with chrome://tracing or Perfetto). Each tick is shown as one microsecond;
+  // channel occupancies are counter tracks and stalls are slices on a track
+  // per proc instance. Empty if the timeline was not recorded.
+  std::string ToChromeTrace() const;
+
+ private:
+  struct Sample {
+    std::vector<int64_t> occupancies;
+    // Index of the blocked proc instances and the channel instance each is
+    // blocked on.
+    std::vector<std::pair<int64_t, ChannelInstance*>> blocked;
+  };
+
+  ChannelQueueManager* queue_manager_;
+  bool record_timeline_;
+  int64_t tick_count_ = 0;
+  // Indexed as `queue_manager_->queues()`.
+  std::vector<int64_t> max_occupancies_;
+  std::vector<int64_t> occupancy_sums_;
+  std::vector<std::vector<int64_t>> occupancy_histograms_;
+  absl::flat_hash_map<ChannelInstance*, int64_t> channel_indices_;
+  absl::flat_hash_map<ProcInstance*, int64_t> proc_indices_;
+  std::vector<int64_t> blocked_ticks_;
+  std::vector<Sample> timeline_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_PROC_RUNTIME_TELEMETRY_H_
@@ -32,6 +32,8 @@
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/proc_runtime.h"
+#include "xls/interpreter/proc_runtime_telemetry.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
@@ -366,6 +368,68 @@ TEST_P(ProcRuntimeTestBase, IotaFeedingAccumulator) {
   EXPECT_THAT(queue.Read(), Optional(Value(UBits(6, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, Telemetry) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in_channel,
+      package->CreateStreamingChannel("in", ChannelOps::kReceiveOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * accum,
+      CreateAccumProc("accum", in_channel, out_channel, package.get()));
+
+  std::unique_ptr<ProcRuntime> runtime =
+      GetParam().CreateRuntime(package.get());
+  EXPECT_EQ(runtime->telemetry(), nullptr);
+  runtime->EnableTelemetry(/*record_timeline=*/true);
+
+  XLS_ASSERT_OK(runtime->queue_manager().GetQueue(in_channel).Write(
+      Value(UBits(5, 32))));
+  XLS_ASSERT_OK(runtime->Tick());
+  // The accumulator now blocks on the empty input channel.
+  XLS_ASSERT_OK(runtime->TickUntilBlocked(/*max_ticks=*/100).status());
+
+  const ProcRuntimeTelemetry* telemetry = runtime->telemetry();
+  ASSERT_NE(telemetry, nullptr);
+  EXPECT_GE(telemetry->tick_count(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(ProcInstance * accum_instance,
+                           runtime->elaboration().GetUniqueInstance(accum));
+  EXPECT_EQ(telemetry->GetBlockedOnReceiveTicks(accum_instance),
+            telemetry->tick_count() - 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelInstance * in_instance,
+      runtime->elaboration().GetUniqueInstance(in_channel));
+  ProcRuntimeTelemetry::ChannelStats in_stats =
+      telemetry->GetChannelStats(in_instance);
+  EXPECT_EQ(in_stats.push_count, 1);
+  EXPECT_EQ(in_stats.pop_count, 1);
+  EXPECT_EQ(in_stats.max_occupancy, 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelInstance * out_instance,
+      runtime->elaboration().GetUniqueInstance(out_channel));
+  ProcRuntimeTelemetry::ChannelStats out_stats =
+      telemetry->GetChannelStats(out_instance);
+  EXPECT_EQ(out_stats.push_count, 1);
+  EXPECT_EQ(out_stats.pop_count, 0);
+  EXPECT_EQ(out_stats.max_occupancy, 1);
+  EXPECT_DOUBLE_EQ(out_stats.average_occupancy, 1.0);
+
+  EXPECT_THAT(telemetry->Summary(),
+              HasSubstr("out: max occupancy 1, average occupancy 1.00, "
+                        "pushes 1, pops 0"));
+  std::string trace = telemetry->ToChromeTrace();
+  EXPECT_THAT(trace, HasSubstr(R"({"name":"out","ph":"C","pid":0,"ts":0,)"
+                               R"("args":{"occupancy":1}})"));
+  EXPECT_THAT(trace, HasSubstr(R"({"name":"in","ph":"X","pid":1,"tid":0,)"
+                               R"("ts":1,)"));
+}
+
 TEST_P(ProcRuntimeTestBase, DegenerateProc) {
   // Tests interpreting a proc with no send or receive nodes.
   auto package = CreatePackage();
@@ -826,6 +890,50 @@ TEST_P(ProcRuntimeTestBase, StateReset) {
   EXPECT_THAT(output_queue.Read(), Optional(Value(SBits(14, 32))));
 }
 
+TEST_P(ProcRuntimeTestBase, SnapshotAndRestore) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * iota_accum_channel,
+      package->CreateStreamingChannel("iota_accum", ChannelOps::kSendReceive,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out_channel,
+      package->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                      package->GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * iota, CreateIotaProc("iota", /*starting_value=*/0, /*step=*/1,
+                                  iota_accum_channel, package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * accum,
+                           CreateAccumProc("accum", iota_accum_channel,
+                                           out_channel, package.get()));
+
+  std::unique_ptr<ProcRuntime> warmed_up =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(warmed_up->TickUntilOutput({{out_channel, 3}}).status());
+  XLS_ASSERT_OK_AND_ASSIGN(ProcRuntimeSnapshotProto snapshot,
+                           warmed_up->Snapshot());
+
+  // Restore into a fresh runtime through the serialized form.
+  ProcRuntimeSnapshotProto parsed;
+  ASSERT_TRUE(parsed.ParseFromString(snapshot.SerializeAsString()));
+  std::unique_ptr<ProcRuntime> restored =
+      GetParam().CreateRuntime(package.get());
+  XLS_ASSERT_OK(restored->RestoreSnapshot(parsed));
+  EXPECT_EQ(restored->ResolveState(iota), warmed_up->ResolveState(iota));
+  EXPECT_EQ(restored->ResolveState(accum), warmed_up->ResolveState(accum));
+
+  XLS_ASSERT_OK(warmed_up->Tick());
+  XLS_ASSERT_OK(restored->Tick());
+  ChannelQueue& expected = warmed_up->queue_manager().GetQueue(out_channel);
+  ChannelQueue& actual = restored->queue_manager().GetQueue(out_channel);
+  EXPECT_EQ(actual.GetSize(), 4);
+  EXPECT_EQ(actual.GetContents(), expected.GetContents());
+  EXPECT_THAT(actual.Read(), Optional(Value(UBits(0, 32))));
+  EXPECT_THAT(actual.Read(), Optional(Value(UBits(1, 32))));
+  EXPECT_THAT(actual.Read(), Optional(Value(UBits(3, 32))));
+  EXPECT_THAT(actual.Read(), Optional(Value(UBits(6, 32))));
+}
+
 TEST_P(ProcRuntimeTestBase, NonBlockingReceivesProc) {
   auto package = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Channel * in0, package->CreateStreamingChannel(
@@ -127,19 +127,20 @@ SerialProcRuntime::TickInternal() {
       blocked_instances[channel_instance] = element.instance;
     }
   }
-  auto get_blocked_channel_instances = [&]() {
-    std::vector<ChannelInstance*> instances;
-    for (ChannelInstance* instance : elaboration().channel_instances()) {
-      if (blocked_instances.contains(instance)) {
-        instances.push_back(instance);
-      }
+  std::vector<ChannelInstance*> blocked_channel_instances;
+  std::vector<ProcInstance*> blocked_proc_instances;
+  for (ChannelInstance* instance : elaboration().channel_instances()) {
+    if (auto it = blocked_instances.find(instance);
+        it != blocked_instances.end()) {
+      blocked_channel_instances.push_back(instance);
+      blocked_proc_instances.push_back(it->second);
     }
-    return instances;
-  };
+  }
   return NetworkTickResult{
       .progress_made = progress_made,
       .progress_made_on_io_procs = progress_made_on_io_procs,
-      .blocked_channel_instances = get_blocked_channel_instances(),
+      .blocked_channel_instances = std::move(blocked_channel_instances),
+      .blocked_proc_instances = std::move(blocked_proc_instances),
   };
 }
 
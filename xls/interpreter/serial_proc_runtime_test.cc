@@ -14,6 +14,7 @@
 
 #include "xls/interpreter/serial_proc_runtime.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
@@ -36,6 +37,10 @@
 #include "xls/interpreter/proc_interpreter.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/interpreter/proc_runtime_test_base.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
@@ -149,6 +154,61 @@ TEST(SerialProcRuntimeTest, InterpreterAsserts) {
                   ::testing::HasSubstr("Assertion failure via fail!")));
 }
 
+TEST(SerialProcRuntimeTest, FusedJitRuntime) {
+  Package package("test");
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * in,
+      package.CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out,
+      package.CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * mid,
+      package.CreateStreamingChannel(
+          "mid", ChannelOps::kSendReceive, u32, /*initial_values=*/{},
+          FifoConfig(/*depth=*/0, /*bypass=*/true,
+                     /*register_push_outputs=*/false,
+                     /*register_pop_outputs=*/false)));
+  {
+    ProcBuilder pb("producer", &package);
+    BValue recv = pb.Receive(in, pb.Literal(Value::Token()));
+    pb.Send(mid, pb.TupleIndex(recv, 0),
+            pb.Add(pb.TupleIndex(recv, 1), pb.Literal(UBits(1, 32))));
+    XLS_ASSERT_OK_AND_ASSIGN(Proc * producer, pb.Build());
+    XLS_ASSERT_OK(package.SetTop(producer));
+  }
+  {
+    ProcBuilder pb("consumer", &package);
+    BValue recv = pb.Receive(mid, pb.Literal(Value::Token()));
+    BValue data = pb.TupleIndex(recv, 1);
+    pb.Send(out, pb.TupleIndex(recv, 0), pb.Add(data, data));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(FusedJitProcRuntime fused,
+                           CreateFusedJitSerialProcRuntime(&package));
+  // The original package is untouched.
+  EXPECT_EQ(package.procs().size(), 2);
+  EXPECT_EQ(fused.package->procs().size(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelQueue * input,
+      fused.runtime->queue_manager().GetQueueByName("in"));
+  for (int64_t i = 1; i <= 3; ++i) {
+    XLS_ASSERT_OK(input->Write(Value(UBits(i, 32))));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * fused_out,
+                           fused.package->GetChannel("out"));
+  XLS_ASSERT_OK(fused.runtime->TickUntilOutput({{fused_out, 3}}).status());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ChannelQueue * output,
+      fused.runtime->queue_manager().GetQueueByName("out"));
+  EXPECT_EQ(output->Read(), Value(UBits(4, 32)));
+  EXPECT_EQ(output->Read(), Value(UBits(6, 32)));
+  EXPECT_EQ(output->Read(), Value(UBits(8, 32)));
+}
+
 // Instantiate and run all the tests in proc_runtime_test_base.cc using
 // proc interpreters.
 INSTANTIATE_TEST_SUITE_P(
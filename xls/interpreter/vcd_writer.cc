@@ -0,0 +1,174 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/vcd_writer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Returns the VCD identifier code of the `index`-th signal, a base-94 number
+// written with the printable characters '!' through '~'.
+std::string IdentifierCode(int64_t index) {
+  std::string code;
+  do {
+    code.push_back(static_cast<char>('!' + index % 94));
+    index /= 94;
+  } while (index > 0);
+  return code;
+}
+
+// Appends the bits of `value` to `binary` most significant bit first, in the
+// order used by `Value::FlattenTo`.
+void AppendBinary(const Value& value, std::string& binary) {
+  switch (value.kind()) {
+    case ValueKind::kBits: {
+      const Bits& bits = value.bits();
+      for (int64_t i = bits.bit_count() - 1; i >= 0; --i) {
+        binary.push_back(bits.Get(i) ? '1' : '0');
+      }
+      return;
+    }
+    case ValueKind::kTuple:
+    case ValueKind::kArray:
+      for (const Value& element : value.elements()) {
+        AppendBinary(element, binary);
+      }
+      return;
+    default:
+      return;
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<VcdWriter::SignalId> VcdWriter::AddSignal(
+    std::string_view scope, std::string_view name, int64_t width) {
+  if (header_written_) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Cannot add signal `%s` after the VCD header is written", name));
+  }
+  if (width < 1) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Signal `%s` must have a positive width; got %d", name, width));
+  }
+  SignalId id = signals_.size();
+  signals_.push_back(Signal{.scope = std::string(scope),
+                            .name = std::string(name),
+                            .width = width,
+                            .code = IdentifierCode(id)});
+  return id;
+}
+
+absl::Status VcdWriter::WriteHeader(std::string_view top_scope) {
+  if (header_written_) {
+    return absl::FailedPreconditionError("VCD header already written");
+  }
+  header_written_ = true;
+  absl::StrAppend(&buffer_, "$timescale ", timescale_, " $end\n",
+                  "$scope module ", top_scope, " $end\n");
+  auto declare = [&](const Signal& signal) {
+    absl::StrAppend(&buffer_, "$var wire ", signal.width, " ", signal.code, " ",
+                    signal.name, " $end\n");
+  };
+  // Signals of the top scope, then each nested scope in order of first use.
+  std::vector<std::string_view> scopes;
+  for (const Signal& signal : signals_) {
+    if (signal.scope.empty()) {
+      declare(signal);
+    } else if (std::find(scopes.begin(), scopes.end(), signal.scope) ==
+               scopes.end()) {
+      scopes.push_back(signal.scope);
+    }
+  }
+  for (std::string_view scope : scopes) {
+    absl::StrAppend(&buffer_, "$scope module ", scope, " $end\n");
+    for (const Signal& signal : signals_) {
+      if (signal.scope == scope) {
+        declare(signal);
+      }
+    }
+    absl::StrAppend(&buffer_, "$upscope $end\n");
+  }
+  absl::StrAppend(&buffer_, "$upscope $end\n$enddefinitions $end\n");
+  return absl::OkStatus();
+}
+
+absl::Status VcdWriter::SetTime(int64_t time) {
+  if (time < time_) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "VCD time must not decrease; got %d after %d", time, time_));
+  }
+  time_ = time;
+  return absl::OkStatus();
+}
+
+void VcdWriter::WriteTimeIfNeeded() {
+  if (written_time_ != time_) {
+    absl::StrAppend(&buffer_, "#", time_, "\n");
+    written_time_ = time_;
+  }
+}
+
+void VcdWriter::Change(SignalId signal_id, std::string_view binary) {
+  Signal& signal = signals_[signal_id];
+  DCHECK_EQ(binary.size(), signal.width) << signal.name;
+  if (signal.value == binary) {
+    return;
+  }
+  signal.value = binary;
+  WriteTimeIfNeeded();
+  if (signal.width == 1) {
+    absl::StrAppend(&buffer_, binary, signal.code, "\n");
+  } else {
+    // Leading zeros are implied.
+    std::string_view::size_type first_one = binary.find('1');
+    std::string_view digits = first_one == std::string_view::npos
+                                  ? binary.substr(binary.size() - 1)
+                                  : binary.substr(first_one);
+    absl::StrAppend(&buffer_, "b", digits, " ", signal.code, "\n");
+  }
+  if (buffer_.size() > kFlushThreshold) {
+    Flush();
+  }
+}
+
+void VcdWriter::Change(SignalId signal, const Value& value) {
+  scratch_.clear();
+  AppendBinary(value, scratch_);
+  Change(signal, scratch_);
+}
+
+void VcdWriter::Flush() {
+  if (!buffer_.empty()) {
+    out_->write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+  out_->flush();
+}
+
+}  // namespace xls
@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_INTERPRETER_VCD_WRITER_H_
+#define XLS_INTERPRETER_VCD_WRITER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A streaming writer of value change dump (VCD) files. Signals are declared up
+// front, then values are set at non-decreasing times; only values which differ
+// from a signal's previous value are written, and timestamps are only written
+// for times at which some signal changed. Output is accumulated in an internal
+// buffer and written to the stream in large chunks.
+class VcdWriter {
+ public:
+  using SignalId = int64_t;
+
+  // Writes to `out`, which must outlive the writer. `timescale` is the VCD
+  // duration of one time unit.
+  explicit VcdWriter(std::ostream* out, std::string_view timescale = "1ns")
+      : out_(out), timescale_(timescale) {}
+  ~VcdWriter() { Flush(); }
+
+  VcdWriter(const VcdWriter&) = delete;
+  VcdWriter& operator=(const VcdWriter&) = delete;
+
+  // Declares a signal `name` of `width` bits in the scope `scope` (nested
+  // inside the top scope, or the top scope itself if empty). Must be called
+  // before `WriteHeader`.
+  absl::StatusOr<SignalId> AddSignal(std::string_view scope,
+                                     std::string_view name, int64_t width);
+
+  // Writes the declarations of the signals in a top-level scope named
+  // `top_scope`. Every signal starts with an unknown value.
+  absl::Status WriteHeader(std::string_view top_scope);
+
+  // Sets the time of subsequent changes. Times must not decrease.
+  absl::Status SetTime(int64_t time);
+
+  // Sets `signal` to the value given as a string of '0' and '1' characters,
+  // most significant bit first, with one character per bit of the signal.
+  void Change(SignalId signal, std::string_view binary);
+
+  // Sets `signal` to the flattened bits of `value`.
+  void Change(SignalId signal, const Value& value);
+
+  // Writes all buffered output to the stream.
+  void Flush();
+
+  int64_t signal_count() const { return signals_.size(); }
+
+ private:
+  struct Signal {
+    std::string scope;
+    std::string name;
+    int64_t width;
+    std::string code;
+    // The last value written; empty until the first change.
+    std::string value;
+  };
+
+  // Buffered output is written to the stream once it exceeds this size.
+  static constexpr int64_t kFlushThreshold = 1 << 16;
+
+  void WriteTimeIfNeeded();
+
+  std::ostream* out_;
+  std::string timescale_;
+  std::vector<Signal> signals_;
+  bool header_written_ = false;
+  int64_t time_ = 0;
+  // The last time written to the output, or -1 if none has been.
+  int64_t written_time_ = -1;
+  std::string buffer_;
+  // Scratch space used to flatten values.
+  std::string scratch_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_INTERPRETER_VCD_WRITER_H_
@@ -0,0 +1,101 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/interpreter/vcd_writer.h"
+
+#include <sstream>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(VcdWriterTest, WritesOnlyChanges) {
+  std::stringstream out;
+  {
+    VcdWriter writer(&out);
+    XLS_ASSERT_OK_AND_ASSIGN(VcdWriter::SignalId a,
+                             writer.AddSignal("", "a", 1));
+    XLS_ASSERT_OK_AND_ASSIGN(VcdWriter::SignalId b,
+                             writer.AddSignal("inner", "b", 4));
+    XLS_ASSERT_OK(writer.WriteHeader("top"));
+    writer.Change(a, "0");
+    writer.Change(b, Value(UBits(0, 4)));
+    XLS_ASSERT_OK(writer.SetTime(1));
+    writer.Change(a, "0");
+    writer.Change(b, Value(UBits(5, 4)));
+    // Nothing changes at time 2, so no timestamp is written for it.
+    XLS_ASSERT_OK(writer.SetTime(2));
+    writer.Change(a, "0");
+    writer.Change(b, "0101");
+    XLS_ASSERT_OK(writer.SetTime(3));
+    writer.Change(a, "1");
+  }
+  EXPECT_EQ(out.str(), R"($timescale 1ns $end
+$scope module top $end
+$var wire 1 ! a $end
+$scope module inner $end
+$var wire 4 " b $end
+$upscope $end
+$upscope $end
+$enddefinitions $end
+#0
+0!
+b0 "
+#1
+b101 "
+#3
+1!
+)");
+}
+
+TEST(VcdWriterTest, FlattensAggregates) {
+  std::stringstream out;
+  {
+    VcdWriter writer(&out);
+    XLS_ASSERT_OK_AND_ASSIGN(VcdWriter::SignalId t,
+                             writer.AddSignal("", "t", 6));
+    XLS_ASSERT_OK(writer.WriteHeader("top"));
+    writer.Change(
+        t, Value::Tuple({Value(UBits(1, 2)), Value(UBits(0b1010, 4))}));
+  }
+  EXPECT_THAT(out.str(), HasSubstr("#0\nb11010 !\n"));
+}
+
+TEST(VcdWriterTest, Errors) {
+  std::stringstream out;
+  VcdWriter writer(&out);
+  EXPECT_THAT(writer.AddSignal("", "empty", 0),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  XLS_ASSERT_OK(writer.WriteHeader("top"));
+  EXPECT_THAT(writer.WriteHeader("top"),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  EXPECT_THAT(writer.AddSignal("", "late", 1),
+              StatusIs(absl::StatusCode::kFailedPrecondition));
+  XLS_ASSERT_OK(writer.SetTime(4));
+  EXPECT_THAT(writer.SetTime(3),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls
@@ -212,14 +212,9 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   }
 
   absl::Status HandleIdentity(UnOp* identity) override {
-    XLS_ASSIGN_OR_RETURN(LeafTypeTreeView<LeafValueT> v,
-                         GetCompoundValue(identity->operand(0)));
-    auto elements = v.elements();
-    return SetValue(identity,
-                    LeafTypeTree<LeafValueT>::CreateFromVector(
-                        identity->GetType(),
-                        typename LeafTypeTree<LeafValueT>::DataContainerT(
-                            elements.begin(), elements.end())));
+    XLS_ASSIGN_OR_RETURN(CopyOnWriteLeafTypeTree<LeafValueT> v,
+                         GetSharedValue(identity->operand(0)));
+    return SetValue(identity, std::move(v));
   }
   absl::Status HandleLiteral(Literal* literal) override {
     XLS_ASSIGN_OR_RETURN(
@@ -465,10 +460,9 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   }
 
   absl::Status HandleTupleIndex(TupleIndex* index) override {
-    XLS_ASSIGN_OR_RETURN(auto tup, GetCompoundValue(index->operand(0)));
-    auto ltt = tup.AsView({index->index()});
-    return SetValue(index,
-                    LeafTypeTree<LeafValueT>(ltt.type(), ltt.elements()));
+    XLS_ASSIGN_OR_RETURN(CopyOnWriteLeafTypeTree<LeafValueT> tup,
+                         GetSharedValue(index->operand(0)));
+    return SetValue(index, tup.Subtree({index->index()}));
   }
 
   absl::Status HandleUDiv(BinOp* div) override {
@@ -558,12 +552,36 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
     return values_.at(n).AsView();
   }
 
-  const absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>>& values() const& {
-    return values_;
+  // Gets the compound-value of the node n as a tree sharing its storage.
+  absl::StatusOr<CopyOnWriteLeafTypeTree<LeafValueT>> GetSharedValue(
+      Node* n) const {
+    XLS_RET_CHECK(values_.contains(n)) << n;
+    return values_.at(n);
   }
 
-  absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>>&& values() && {
-    return std::move(values_);
+  // Values are stored copy-on-write so that nodes which forward (part of) an
+  // operand's value, like identity and tuple_index, share its storage.
+  using ValueMap =
+      absl::flat_hash_map<Node*, CopyOnWriteLeafTypeTree<LeafValueT>>;
+
+  const ValueMap& values() const& { return values_; }
+
+  ValueMap&& values() && { return std::move(values_); }
+
+  // Replaces all held values, e.g. to resume an earlier evaluation after part
+  // of the graph changed.
+  void SetValues(ValueMap&& values) { values_ = std::move(values); }
+
+  // Removes and returns the value of `n` (if any) so that it may be visited
+  // again.
+  std::optional<CopyOnWriteLeafTypeTree<LeafValueT>> ExtractValue(Node* n) {
+    auto it = values_.find(n);
+    if (it == values_.end()) {
+      return std::nullopt;
+    }
+    CopyOnWriteLeafTypeTree<LeafValueT> value = std::move(it->second);
+    values_.erase(it);
+    return value;
   }
 
  protected:
@@ -612,6 +630,13 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   //
   // This invalidates all Views returned by GetValue and GetCompoundValue.
   absl::Status SetValue(Node* n, LeafTypeTree<LeafValueT>&& value) {
+    return SetValue(n, CopyOnWriteLeafTypeTree<LeafValueT>(std::move(value)));
+  }
+
+  // Set 'n' to a value which may share storage with other nodes' values.
+  //
+  // This invalidates all Views returned by GetValue and GetCompoundValue.
+  absl::Status SetValue(Node* n, CopyOnWriteLeafTypeTree<LeafValueT> value) {
     XLS_RET_CHECK(!values_.contains(n)) << n << " visited multiple times";
     values_[n] = std::move(value);
     return absl::OkStatus();
@@ -651,7 +676,7 @@ class AbstractNodeEvaluator : public DfsVisitorWithDefault {
   // represent values which are considered unconstrained. This uses unique_ptr
   // to ensure that the internal pointers do not move since we may want to hold
   // views to them.
-  absl::flat_hash_map<Node*, LeafTypeTree<LeafValueT>> values_;
+  ValueMap values_;
 };
 
 // An abstract evaluator for XLS Nodes. The function takes an AbstractEvaluator
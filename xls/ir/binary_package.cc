@@ -0,0 +1,1281 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_package.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/ir/binary_package.pb.h"
+#include "xls/ir/block.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel.pb.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/instantiation.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/lsb_or_msb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/register.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/state_element.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/verifier.h"
+#include "xls/ir/xls_type.pb.h"
+#include "xls/ir/xls_value.pb.h"
+
+// Op-specific attributes are stored in BinaryNodeProto.int_attributes and
+// string_attributes. All operands are stored in operand order; optional
+// operands are flagged in the integer attributes. The layouts are:
+//
+//   bit_slice:              [start, width]
+//   dynamic_bit_slice, decode, array_slice, umul, smul, umulp, smulp:
+//                           [width]
+//   sign_ext, zero_ext:     [new_bit_count]
+//   tuple_index:            [index]
+//   one_hot:                [lsb_prio]
+//   min_delay:              [delay]
+//   sel:                    [has_default]
+//   array_index, array_update:
+//                           [assumed_in_bounds]
+//   invoke, map:            [to_apply]
+//   counted_for:            [trip_count, stride, body]
+//   dynamic_counted_for:    [body]
+//   state_read:             [state element index, has_predicate]
+//   next_value:             [has_predicate]
+//   send:                   [has_predicate]              channel
+//   receive:                [has_predicate, blocking]    channel
+//   assert:                 [has_label, has_original_label]
+//                           message, label?, original_label?
+//   cover:                  [has_original_label]         label, original_label?
+//   trace:                  [verbosity]                  format
+//   register_read:          [register]
+//   register_write:         [register, has_load_enable, has_reset]
+//   instantiation_input, instantiation_output:
+//                           [instantiation]              port_name
+//
+// where to_apply and body are indices into BinaryPackageProto.function_bases
+// and register and instantiation index the block's registers and
+// instantiations.
+
+namespace xls {
+namespace {
+
+using NodeProto = BinaryNodeProto;
+using FunctionBaseProto = BinaryFunctionBaseProto;
+
+class Serializer {
+ public:
+  explicit Serializer(Package* package) : package_(package) {}
+
+  absl::StatusOr<BinaryPackageProto> Run() {
+    proto_.set_format_version(kBinaryPackageFormatVersion);
+    proto_.set_name(package_->name());
+    for (const auto& [fileno, filename] : package_->fileno_to_name()) {
+      (*proto_.mutable_file_names())[fileno.value()] = filename;
+    }
+    for (Channel* channel : package_->channels()) {
+      XLS_RETURN_IF_ERROR(SerializeChannel(channel, proto_.add_channels()));
+    }
+    for (FunctionBase* fb : FunctionsInPostOrder(package_)) {
+      function_base_indices_[fb] = proto_.function_bases_size();
+      XLS_RETURN_IF_ERROR(
+          SerializeFunctionBase(fb, proto_.add_function_bases()));
+    }
+    std::optional<FunctionBase*> top = package_->GetTop();
+    if (top.has_value()) {
+      proto_.set_top(function_base_indices_.at(*top));
+    }
+    proto_.set_next_node_id(package_->next_node_id());
+    return std::move(proto_);
+  }
+
+ private:
+  int64_t TypeIndex(Type* type) {
+    auto [it, inserted] =
+        type_indices_.try_emplace(type, proto_.types_size());
+    if (inserted) {
+      *proto_.add_types() = type->ToProto();
+    }
+    return it->second;
+  }
+
+  absl::StatusOr<int64_t> FunctionBaseIndex(FunctionBase* fb) const {
+    auto it = function_base_indices_.find(fb);
+    XLS_RET_CHECK(it != function_base_indices_.end())
+        << fb->name() << " is referenced before it is serialized";
+    return it->second;
+  }
+
+  absl::Status SerializeChannel(Channel* channel, BinaryChannelProto* proto) {
+    proto->set_name(channel->name());
+    proto->set_id(channel->id());
+    proto->set_kind(static_cast<int64_t>(channel->kind()));
+    proto->set_supported_ops(static_cast<int64_t>(channel->supported_ops()));
+    proto->set_type(TypeIndex(channel->type()));
+    for (const Value& value : channel->initial_values()) {
+      XLS_ASSIGN_OR_RETURN(*proto->add_initial_values(), value.AsProto());
+    }
+    *proto->mutable_metadata() = channel->metadata();
+    if (StreamingChannel* streaming = dynamic_cast<StreamingChannel*>(channel);
+        streaming != nullptr) {
+      proto->set_flow_control(
+          static_cast<int64_t>(streaming->GetFlowControl()));
+      proto->set_strictness(static_cast<int64_t>(streaming->GetStrictness()));
+      *proto->mutable_channel_config() = streaming->channel_config().ToProto(
+          channel->type()->GetFlatBitCount());
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status SerializeFunctionBase(FunctionBase* fb,
+                                     FunctionBaseProto* proto) {
+    proto->set_name(fb->name());
+    if (fb->GetInitiationInterval().has_value()) {
+      proto->set_initiation_interval(*fb->GetInitiationInterval());
+    }
+    if (fb->ForeignFunctionData().has_value()) {
+      *proto->mutable_foreign_function_data() = *fb->ForeignFunctionData();
+    }
+
+    // Params (whose order is significant) and state reads (which are created
+    // along with their state elements) come first; all other nodes are in
+    // topological order.
+    std::vector<Node*> order;
+    order.reserve(fb->node_count());
+    for (Param* param : fb->params()) {
+      order.push_back(param);
+    }
+    if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      if (proc->is_new_style_proc()) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "Binary IR does not support new-style procs: %s", proc->name()));
+      }
+      for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+        order.push_back(proc->GetStateRead(i));
+      }
+    }
+    for (Node* node : TopoSort(fb)) {
+      if (!node->Is<Param>() && !node->Is<StateRead>()) {
+        order.push_back(node);
+      }
+    }
+    absl::flat_hash_map<Node*, int64_t> indices;
+    indices.reserve(order.size());
+    for (Node* node : order) {
+      indices.emplace(node, indices.size());
+    }
+
+    if (fb->IsFunction()) {
+      proto->set_kind(FunctionBaseProto::KIND_FUNCTION);
+      proto->set_return_value(
+          indices.at(fb->AsFunctionOrDie()->return_value()));
+    } else if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      proto->set_kind(FunctionBaseProto::KIND_PROC);
+      for (StateElement* state_element : proc->StateElements()) {
+        BinaryStateElementProto* element = proto->add_state_elements();
+        element->set_name(state_element->name());
+        element->set_type(TypeIndex(state_element->type()));
+        XLS_ASSIGN_OR_RETURN(*element->mutable_initial_value(),
+                             state_element->initial_value().AsProto());
+      }
+      // TODO: google/xls#1520 - remove this once fully transitioned over to
+      // `next_value` nodes.
+      for (Node* next : proc->NextState()) {
+        proto->add_next_state(indices.at(next));
+      }
+    } else {
+      Block* block = fb->AsBlockOrDie();
+      proto->set_kind(FunctionBaseProto::KIND_BLOCK);
+      if (block->GetClockPort().has_value()) {
+        proto->set_clock_port(block->GetClockPort()->name);
+      }
+      if (block->GetResetPort().has_value()) {
+        proto->set_reset_port((*block->GetResetPort())->GetName());
+      }
+      for (const Block::Port& port : block->GetPorts()) {
+        proto->add_port_order(Block::PortName(port));
+      }
+      for (Register* reg : block->GetRegisters()) {
+        register_indices_[reg] = proto->registers_size();
+        XLS_RETURN_IF_ERROR(SerializeRegister(reg, proto->add_registers()));
+      }
+      for (Instantiation* instantiation : block->GetInstantiations()) {
+        instantiation_indices_[instantiation] = proto->instantiations_size();
+        XLS_RETURN_IF_ERROR(SerializeInstantiation(
+            instantiation, proto->add_instantiations()));
+      }
+    }
+
+    for (Node* node : order) {
+      XLS_RETURN_IF_ERROR(SerializeNode(node, indices, proto->add_nodes()));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status SerializeRegister(Register* reg, BinaryRegisterProto* proto) {
+    proto->set_name(reg->name());
+    proto->set_type(TypeIndex(reg->type()));
+    if (reg->reset().has_value()) {
+      proto->set_has_reset(true);
+      XLS_ASSIGN_OR_RETURN(*proto->mutable_reset_value(),
+                           reg->reset()->reset_value.AsProto());
+      proto->set_asynchronous_reset(reg->reset()->asynchronous);
+      proto->set_active_low_reset(reg->reset()->active_low);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status SerializeInstantiation(Instantiation* instantiation,
+                                      BinaryInstantiationProto* proto) {
+    proto->set_name(instantiation->name());
+    switch (instantiation->kind()) {
+      case InstantiationKind::kBlock: {
+        XLS_ASSIGN_OR_RETURN(BlockInstantiation * block_instantiation,
+                             instantiation->AsBlockInstantiation());
+        proto->set_kind(BinaryInstantiationProto::KIND_BLOCK);
+        XLS_ASSIGN_OR_RETURN(
+            int64_t block,
+            FunctionBaseIndex(block_instantiation->instantiated_block()));
+        proto->set_block(block);
+        return absl::OkStatus();
+      }
+      case InstantiationKind::kFifo: {
+        XLS_ASSIGN_OR_RETURN(FifoInstantiation * fifo,
+                             instantiation->AsFifoInstantiation());
+        proto->set_kind(BinaryInstantiationProto::KIND_FIFO);
+        *proto->mutable_fifo_config() =
+            fifo->fifo_config().ToProto(fifo->data_type()->GetFlatBitCount());
+        proto->set_data_type(TypeIndex(fifo->data_type()));
+        if (fifo->channel_name().has_value()) {
+          proto->set_channel(std::string(*fifo->channel_name()));
+        }
+        return absl::OkStatus();
+      }
+      case InstantiationKind::kExtern:
+        break;
+    }
+    return absl::UnimplementedError(
+        absl::StrFormat("Binary IR does not support %s instantiations: %s",
+                        InstantiationKindToString(instantiation->kind()),
+                        instantiation->name()));
+  }
+
+  absl::Status SerializeNode(Node* node,
+                             const absl::flat_hash_map<Node*, int64_t>& indices,
+                             NodeProto* proto) {
+    proto->set_op(ToOpProto(node->op()));
+    proto->set_id(node->id());
+    proto->set_type(TypeIndex(node->GetType()));
+    for (Node* operand : node->operands()) {
+      proto->add_operands(indices.at(operand));
+    }
+    if (node->HasAssignedName()) {
+      proto->set_name(node->GetName());
+    }
+    for (const SourceLocation& location : node->loc().locations) {
+      proto->add_locations(location.fileno().value());
+      proto->add_locations(location.lineno().value());
+      proto->add_locations(location.colno().value());
+    }
+
+    auto add_int = [proto](int64_t value) { proto->add_int_attributes(value); };
+    auto add_string = [proto](std::string_view value) {
+      proto->add_string_attributes(std::string(value));
+    };
+    switch (node->op()) {
+      case Op::kLiteral: {
+        XLS_ASSIGN_OR_RETURN(*proto->mutable_value(),
+                             node->As<Literal>()->value().AsProto());
+        break;
+      }
+      case Op::kBitSlice:
+        add_int(node->As<BitSlice>()->start());
+        add_int(node->As<BitSlice>()->width());
+        break;
+      case Op::kDynamicBitSlice:
+        add_int(node->As<DynamicBitSlice>()->width());
+        break;
+      case Op::kDecode:
+        add_int(node->As<Decode>()->width());
+        break;
+      case Op::kArraySlice:
+        add_int(node->As<ArraySlice>()->width());
+        break;
+      case Op::kUMul:
+      case Op::kSMul:
+        add_int(node->As<ArithOp>()->width());
+        break;
+      case Op::kUMulp:
+      case Op::kSMulp:
+        add_int(node->As<PartialProductOp>()->width());
+        break;
+      case Op::kSignExt:
+      case Op::kZeroExt:
+        add_int(node->As<ExtendOp>()->new_bit_count());
+        break;
+      case Op::kTupleIndex:
+        add_int(node->As<TupleIndex>()->index());
+        break;
+      case Op::kOneHot:
+        add_int(node->As<OneHot>()->priority() == LsbOrMsb::kLsb);
+        break;
+      case Op::kMinDelay:
+        add_int(node->As<MinDelay>()->delay());
+        break;
+      case Op::kSel:
+        add_int(node->As<Select>()->default_value().has_value());
+        break;
+      case Op::kArrayIndex:
+        add_int(node->As<ArrayIndex>()->assumed_in_bounds());
+        break;
+      case Op::kArrayUpdate:
+        add_int(node->As<ArrayUpdate>()->assumed_in_bounds());
+        break;
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(int64_t to_apply,
+                             FunctionBaseIndex(node->As<Invoke>()->to_apply()));
+        add_int(to_apply);
+        break;
+      }
+      case Op::kMap: {
+        XLS_ASSIGN_OR_RETURN(int64_t to_apply,
+                             FunctionBaseIndex(node->As<Map>()->to_apply()));
+        add_int(to_apply);
+        break;
+      }
+      case Op::kCountedFor: {
+        CountedFor* loop = node->As<CountedFor>();
+        add_int(loop->trip_count());
+        add_int(loop->stride());
+        XLS_ASSIGN_OR_RETURN(int64_t body, FunctionBaseIndex(loop->body()));
+        add_int(body);
+        break;
+      }
+      case Op::kDynamicCountedFor: {
+        XLS_ASSIGN_OR_RETURN(
+            int64_t body,
+            FunctionBaseIndex(node->As<DynamicCountedFor>()->body()));
+        add_int(body);
+        break;
+      }
+      case Op::kStateRead: {
+        StateRead* state_read = node->As<StateRead>();
+        XLS_ASSIGN_OR_RETURN(
+            int64_t index,
+            node->function_base()->AsProcOrDie()->GetStateElementIndex(
+                state_read->state_element()));
+        add_int(index);
+        add_int(state_read->predicate().has_value());
+        break;
+      }
+      case Op::kNext:
+        add_int(node->As<Next>()->predicate().has_value());
+        break;
+      case Op::kSend:
+        add_int(node->As<Send>()->predicate().has_value());
+        add_string(node->As<Send>()->channel_name());
+        break;
+      case Op::kReceive:
+        add_int(node->As<Receive>()->predicate().has_value());
+        add_int(node->As<Receive>()->is_blocking());
+        add_string(node->As<Receive>()->channel_name());
+        break;
+      case Op::kAssert: {
+        Assert* assert = node->As<Assert>();
+        add_int(assert->label().has_value());
+        add_int(assert->original_label().has_value());
+        add_string(assert->message());
+        if (assert->label().has_value()) {
+          add_string(*assert->label());
+        }
+        if (assert->original_label().has_value()) {
+          add_string(*assert->original_label());
+        }
+        break;
+      }
+      case Op::kCover: {
+        Cover* cover = node->As<Cover>();
+        add_int(cover->original_label().has_value());
+        add_string(cover->label());
+        if (cover->original_label().has_value()) {
+          add_string(*cover->original_label());
+        }
+        break;
+      }
+      case Op::kTrace:
+        add_int(node->As<Trace>()->verbosity());
+        add_string(StepsToXlsFormatString(node->As<Trace>()->format()));
+        break;
+      case Op::kRegisterRead:
+        add_int(register_indices_.at(node->As<RegisterRead>()->GetRegister()));
+        break;
+      case Op::kRegisterWrite: {
+        RegisterWrite* write = node->As<RegisterWrite>();
+        add_int(register_indices_.at(write->GetRegister()));
+        add_int(write->load_enable().has_value());
+        add_int(write->reset().has_value());
+        break;
+      }
+      case Op::kInstantiationInput:
+        add_int(instantiation_indices_.at(
+            node->As<InstantiationInput>()->instantiation()));
+        add_string(node->As<InstantiationInput>()->port_name());
+        break;
+      case Op::kInstantiationOutput:
+        add_int(instantiation_indices_.at(
+            node->As<InstantiationOutput>()->instantiation()));
+        add_string(node->As<InstantiationOutput>()->port_name());
+        break;
+      default:
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  Package* package_;
+  BinaryPackageProto proto_;
+  absl::flat_hash_map<Type*, int64_t> type_indices_;
+  absl::flat_hash_map<FunctionBase*, int64_t> function_base_indices_;
+  absl::flat_hash_map<Register*, int64_t> register_indices_;
+  absl::flat_hash_map<Instantiation*, int64_t> instantiation_indices_;
+};
+
+// Accessors for the op-specific attributes of a node which return errors
+// rather than crashing on malformed input.
+class NodeAttributes {
+ public:
+  explicit NodeAttributes(const NodeProto& proto) : proto_(proto) {}
+
+  absl::StatusOr<int64_t> Int(int64_t index) const {
+    XLS_RET_CHECK_LT(index, proto_.int_attributes_size())
+        << "Missing attribute of node " << proto_.id();
+    return proto_.int_attributes(index);
+  }
+  absl::StatusOr<bool> Bool(int64_t index) const {
+    XLS_ASSIGN_OR_RETURN(int64_t value, Int(index));
+    return value != 0;
+  }
+  absl::StatusOr<std::string> String(int64_t index) const {
+    XLS_RET_CHECK_LT(index, proto_.string_attributes_size())
+        << "Missing attribute of node " << proto_.id();
+    return proto_.string_attributes(index);
+  }
+
+ private:
+  const NodeProto& proto_;
+};
+
+class Deserializer {
+ public:
+  Deserializer(const BinaryPackageProto& proto, Package* package)
+      : proto_(proto), package_(package) {}
+
+  absl::Status Run() {
+    for (const auto& [fileno, filename] : proto_.file_names()) {
+      package_->SetFileno(Fileno(fileno), filename);
+    }
+    types_.reserve(proto_.types_size());
+    for (const TypeProto& type : proto_.types()) {
+      XLS_ASSIGN_OR_RETURN(Type * t, package_->GetTypeFromProto(type));
+      types_.push_back(t);
+    }
+    for (const BinaryChannelProto& channel : proto_.channels()) {
+      XLS_RETURN_IF_ERROR(DeserializeChannel(channel));
+    }
+    function_bases_.reserve(proto_.function_bases_size());
+    for (const FunctionBaseProto& fb : proto_.function_bases()) {
+      XLS_ASSIGN_OR_RETURN(FunctionBase * result, DeserializeFunctionBase(fb));
+      function_bases_.push_back(result);
+    }
+    if (proto_.has_top()) {
+      XLS_ASSIGN_OR_RETURN(FunctionBase * top, GetFunctionBase(proto_.top()));
+      XLS_RETURN_IF_ERROR(package_->SetTop(top));
+    }
+    package_->set_next_node_id(
+        std::max(package_->next_node_id(), proto_.next_node_id()));
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::StatusOr<Type*> GetType(int64_t index) const {
+    XLS_RET_CHECK(index >= 0 && index < types_.size())
+        << "Invalid type index " << index;
+    return types_[index];
+  }
+
+  absl::StatusOr<FunctionBase*> GetFunctionBase(int64_t index) const {
+    XLS_RET_CHECK(index >= 0 && index < function_bases_.size())
+        << "Invalid function base index " << index;
+    return function_bases_[index];
+  }
+
+  absl::StatusOr<Function*> GetFunction(int64_t index) const {
+    XLS_ASSIGN_OR_RETURN(FunctionBase * fb, GetFunctionBase(index));
+    XLS_RET_CHECK(fb->IsFunction()) << fb->name() << " is not a function";
+    return fb->AsFunctionOrDie();
+  }
+
+  absl::Status DeserializeChannel(const BinaryChannelProto& proto) {
+    XLS_ASSIGN_OR_RETURN(Type * type, GetType(proto.type()));
+    ChannelOps supported_ops = static_cast<ChannelOps>(proto.supported_ops());
+    switch (static_cast<ChannelKind>(proto.kind())) {
+      case ChannelKind::kStreaming: {
+        std::vector<Value> initial_values;
+        initial_values.reserve(proto.initial_values_size());
+        for (const ValueProto& value : proto.initial_values()) {
+          XLS_ASSIGN_OR_RETURN(initial_values.emplace_back(),
+                               Value::FromProto(value));
+        }
+        XLS_ASSIGN_OR_RETURN(ChannelConfig channel_config,
+                             ChannelConfig::FromProto(proto.channel_config()));
+        return package_
+            ->CreateStreamingChannel(
+                proto.name(), supported_ops, type, initial_values,
+                channel_config, static_cast<FlowControl>(proto.flow_control()),
+                static_cast<ChannelStrictness>(proto.strictness()),
+                proto.metadata(), proto.id())
+            .status();
+      }
+      case ChannelKind::kSingleValue:
+        return package_
+            ->CreateSingleValueChannel(proto.name(), supported_ops, type,
+                                       proto.metadata(), proto.id())
+            .status();
+    }
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Invalid kind %d of channel %s", proto.kind(), proto.name()));
+  }
+
+  absl::StatusOr<FunctionBase*> DeserializeFunctionBase(
+      const FunctionBaseProto& proto) {
+    FunctionBase* fb;
+    switch (proto.kind()) {
+      case FunctionBaseProto::KIND_FUNCTION:
+        fb = package_->AddFunction(
+            std::make_unique<Function>(proto.name(), package_));
+        break;
+      case FunctionBaseProto::KIND_PROC:
+        fb = package_->AddProc(std::make_unique<Proc>(proto.name(), package_));
+        break;
+      case FunctionBaseProto::KIND_BLOCK:
+        fb = package_->AddBlock(
+            std::make_unique<Block>(proto.name(), package_));
+        XLS_RETURN_IF_ERROR(DeclareBlockElements(proto, fb->AsBlockOrDie()));
+        break;
+      default:
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Invalid kind of function base %s", proto.name()));
+    }
+    if (proto.has_initiation_interval()) {
+      fb->SetInitiationInterval(proto.initiation_interval());
+    }
+    if (proto.has_foreign_function_data()) {
+      fb->SetForeignFunctionData(proto.foreign_function_data());
+    }
+
+    std::vector<Node*> nodes;
+    nodes.reserve(proto.nodes_size());
+    // State read predicates may be defined after the state read.
+    std::vector<std::pair<StateRead*, int64_t>> state_read_predicates;
+    for (const NodeProto& node_proto : proto.nodes()) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * node, DeserializeNode(node_proto, proto, fb, nodes,
+                                       state_read_predicates));
+      nodes.push_back(node);
+    }
+    auto get_node = [&nodes](int64_t index) -> absl::StatusOr<Node*> {
+      XLS_RET_CHECK(index >= 0 && index < nodes.size())
+          << "Invalid node index " << index;
+      return nodes[index];
+    };
+    for (const auto& [state_read, predicate_index] : state_read_predicates) {
+      XLS_ASSIGN_OR_RETURN(Node * predicate, get_node(predicate_index));
+      XLS_RETURN_IF_ERROR(state_read->SetPredicate(predicate));
+    }
+
+    if (fb->IsFunction()) {
+      XLS_ASSIGN_OR_RETURN(Node * return_value,
+                           get_node(proto.return_value()));
+      XLS_RETURN_IF_ERROR(
+          fb->AsFunctionOrDie()->set_return_value(return_value));
+    } else if (fb->IsProc()) {
+      Proc* proc = fb->AsProcOrDie();
+      for (int64_t i = 0; i < proto.next_state_size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Node * next, get_node(proto.next_state(i)));
+        if (next != proc->GetStateRead(i)) {
+          XLS_RETURN_IF_ERROR(proc->SetNextStateElement(i, next));
+        }
+      }
+    } else {
+      Block* block = fb->AsBlockOrDie();
+      if (proto.has_clock_port()) {
+        XLS_RETURN_IF_ERROR(block->AddClockPort(proto.clock_port()));
+      }
+      std::vector<std::string> port_order(proto.port_order().begin(),
+                                          proto.port_order().end());
+      XLS_RETURN_IF_ERROR(block->ReorderPorts(port_order));
+    }
+    return fb;
+  }
+
+  absl::Status DeclareBlockElements(const FunctionBaseProto& proto,
+                                    Block* block) {
+    for (const BinaryRegisterProto& reg : proto.registers()) {
+      XLS_ASSIGN_OR_RETURN(Type * type, GetType(reg.type()));
+      std::optional<Reset> reset;
+      if (reg.has_reset()) {
+        XLS_ASSIGN_OR_RETURN(Value reset_value,
+                             Value::FromProto(reg.reset_value()));
+        reset = Reset{.reset_value = std::move(reset_value),
+                      .asynchronous = reg.asynchronous_reset(),
+                      .active_low = reg.active_low_reset()};
+      }
+      XLS_ASSIGN_OR_RETURN(Register * result,
+                           block->AddRegister(reg.name(), type, reset));
+      XLS_RET_CHECK_EQ(result->name(), reg.name());
+    }
+    for (const BinaryInstantiationProto& instantiation :
+         proto.instantiations()) {
+      switch (instantiation.kind()) {
+        case BinaryInstantiationProto::KIND_BLOCK: {
+          XLS_ASSIGN_OR_RETURN(FunctionBase * instantiated,
+                               GetFunctionBase(instantiation.block()));
+          XLS_RET_CHECK(instantiated->IsBlock());
+          XLS_RETURN_IF_ERROR(
+              block
+                  ->AddBlockInstantiation(instantiation.name(),
+                                          instantiated->AsBlockOrDie())
+                  .status());
+          break;
+        }
+        case BinaryInstantiationProto::KIND_FIFO: {
+          XLS_ASSIGN_OR_RETURN(Type * data_type,
+                               GetType(instantiation.data_type()));
+          XLS_ASSIGN_OR_RETURN(
+              FifoConfig fifo_config,
+              FifoConfig::FromProto(instantiation.fifo_config()));
+          std::optional<std::string_view> channel;
+          if (instantiation.has_channel()) {
+            channel = instantiation.channel();
+          }
+          XLS_RETURN_IF_ERROR(block
+                                  ->AddFifoInstantiation(instantiation.name(),
+                                                         fifo_config,
+                                                         data_type, channel)
+                                  .status());
+          break;
+        }
+        default:
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Invalid kind of instantiation %s", instantiation.name()));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<Node*> DeserializeNode(
+      const NodeProto& proto, const FunctionBaseProto& fb_proto,
+      FunctionBase* fb, absl::Span<Node* const> nodes,
+      std::vector<std::pair<StateRead*, int64_t>>& state_read_predicates) {
+    XLS_ASSIGN_OR_RETURN(Type * type, GetType(proto.type()));
+    XLS_RET_CHECK_EQ(proto.locations_size() % 3, 0);
+    SourceInfo loc;
+    loc.locations.reserve(proto.locations_size() / 3);
+    for (int64_t i = 0; i < proto.locations_size(); i += 3) {
+      loc.locations.push_back(SourceLocation(Fileno(proto.locations(i)),
+                                             Lineno(proto.locations(i + 1)),
+                                             Colno(proto.locations(i + 2))));
+    }
+    std::vector<Node*> operands;
+    operands.reserve(proto.operands_size());
+    for (int64_t index : proto.operands()) {
+      // Only state read predicates may refer forward, and those are handled
+      // separately.
+      if (index >= 0 && index < nodes.size()) {
+        operands.push_back(nodes[index]);
+      } else if (proto.op() != OP_STATE_READ) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Invalid operand index %d of node %d", index, proto.id()));
+      }
+    }
+    auto operand = [&](int64_t i) -> absl::StatusOr<Node*> {
+      XLS_RET_CHECK_LT(i, operands.size())
+          << "Missing operand of node " << proto.id();
+      return operands[i];
+    };
+    auto operand_span = [&](int64_t begin, int64_t end) {
+      return absl::MakeConstSpan(operands).subspan(begin, end - begin);
+    };
+    NodeAttributes attributes(proto);
+    const std::string& name = proto.name();
+    Op op = FromOpProto(proto.op());
+
+    // Nodes take the next id when they are created.
+    package_->set_next_node_id(proto.id());
+    Node* node = nullptr;
+    auto add = [&](auto new_node) -> Node* {
+      node = fb->AddNode(std::move(new_node));
+      return node;
+    };
+    switch (op) {
+      case Op::kParam:
+        add(std::make_unique<Param>(loc, type, name, fb));
+        break;
+      case Op::kLiteral: {
+        XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(proto.value()));
+        add(std::make_unique<Literal>(loc, std::move(value), name, fb));
+        break;
+      }
+      case Op::kAdd:
+      case Op::kSub:
+      case Op::kShll:
+      case Op::kShra:
+      case Op::kShrl:
+      case Op::kSDiv:
+      case Op::kUDiv:
+      case Op::kSMod:
+      case Op::kUMod: {
+        XLS_ASSIGN_OR_RETURN(Node * lhs, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * rhs, operand(1));
+        add(std::make_unique<BinOp>(loc, lhs, rhs, op, name, fb));
+        break;
+      }
+      case Op::kUMul:
+      case Op::kSMul:
+      case Op::kUMulp:
+      case Op::kSMulp: {
+        XLS_ASSIGN_OR_RETURN(Node * lhs, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * rhs, operand(1));
+        XLS_ASSIGN_OR_RETURN(int64_t width, attributes.Int(0));
+        if (op == Op::kUMul || op == Op::kSMul) {
+          add(std::make_unique<ArithOp>(loc, lhs, rhs, width, op, name, fb));
+        } else {
+          add(std::make_unique<PartialProductOp>(loc, lhs, rhs, width, op,
+                                                 name, fb));
+        }
+        break;
+      }
+      case Op::kEq:
+      case Op::kNe:
+      case Op::kSGe:
+      case Op::kSGt:
+      case Op::kSLe:
+      case Op::kSLt:
+      case Op::kUGe:
+      case Op::kUGt:
+      case Op::kULe:
+      case Op::kULt: {
+        XLS_ASSIGN_OR_RETURN(Node * lhs, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * rhs, operand(1));
+        add(std::make_unique<CompareOp>(loc, lhs, rhs, op, name, fb));
+        break;
+      }
+      case Op::kAnd:
+      case Op::kOr:
+      case Op::kXor:
+      case Op::kNand:
+      case Op::kNor:
+        add(std::make_unique<NaryOp>(loc, operands, op, name, fb));
+        break;
+      case Op::kIdentity:
+      case Op::kNeg:
+      case Op::kNot:
+      case Op::kReverse: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        add(std::make_unique<UnOp>(loc, arg, op, name, fb));
+        break;
+      }
+      case Op::kAndReduce:
+      case Op::kOrReduce:
+      case Op::kXorReduce: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        add(std::make_unique<BitwiseReductionOp>(loc, arg, op, name, fb));
+        break;
+      }
+      case Op::kBitSlice: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t start, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(int64_t width, attributes.Int(1));
+        add(std::make_unique<BitSlice>(loc, arg, start, width, name, fb));
+        break;
+      }
+      case Op::kDynamicBitSlice: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * start, operand(1));
+        XLS_ASSIGN_OR_RETURN(int64_t width, attributes.Int(0));
+        add(std::make_unique<DynamicBitSlice>(loc, arg, start, width, name,
+                                              fb));
+        break;
+      }
+      case Op::kBitSliceUpdate: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * start, operand(1));
+        XLS_ASSIGN_OR_RETURN(Node * value, operand(2));
+        add(std::make_unique<BitSliceUpdate>(loc, arg, start, value, name,
+                                             fb));
+        break;
+      }
+      case Op::kConcat:
+        add(std::make_unique<Concat>(loc, operands, name, fb));
+        break;
+      case Op::kDecode: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t width, attributes.Int(0));
+        add(std::make_unique<Decode>(loc, arg, width, name, fb));
+        break;
+      }
+      case Op::kEncode: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        add(std::make_unique<Encode>(loc, arg, name, fb));
+        break;
+      }
+      case Op::kSignExt:
+      case Op::kZeroExt: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t new_bit_count, attributes.Int(0));
+        add(std::make_unique<ExtendOp>(loc, arg, new_bit_count, op, name, fb));
+        break;
+      }
+      case Op::kGate: {
+        XLS_ASSIGN_OR_RETURN(Node * condition, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * data, operand(1));
+        add(std::make_unique<Gate>(loc, condition, data, name, fb));
+        break;
+      }
+      case Op::kOneHot: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(bool lsb_prio, attributes.Bool(0));
+        add(std::make_unique<OneHot>(
+            loc, arg, lsb_prio ? LsbOrMsb::kLsb : LsbOrMsb::kMsb, name, fb));
+        break;
+      }
+      case Op::kSel: {
+        XLS_ASSIGN_OR_RETURN(Node * selector, operand(0));
+        XLS_ASSIGN_OR_RETURN(bool has_default, attributes.Bool(0));
+        XLS_RET_CHECK_GE(operands.size(), has_default ? 2 : 1);
+        int64_t case_end = operands.size() - (has_default ? 1 : 0);
+        std::optional<Node*> default_value;
+        if (has_default) {
+          default_value = operands.back();
+        }
+        add(std::make_unique<Select>(loc, selector, operand_span(1, case_end),
+                                     default_value, name, fb));
+        break;
+      }
+      case Op::kOneHotSel: {
+        XLS_ASSIGN_OR_RETURN(Node * selector, operand(0));
+        add(std::make_unique<OneHotSelect>(
+            loc, selector, operand_span(1, operands.size()), name, fb));
+        break;
+      }
+      case Op::kPrioritySel: {
+        XLS_ASSIGN_OR_RETURN(Node * selector, operand(0));
+        XLS_RET_CHECK_GE(operands.size(), 2);
+        add(std::make_unique<PrioritySelect>(
+            loc, selector, operand_span(1, operands.size() - 1),
+            operands.back(), name, fb));
+        break;
+      }
+      case Op::kTuple:
+        add(std::make_unique<Tuple>(loc, operands, name, fb));
+        break;
+      case Op::kTupleIndex: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+        add(std::make_unique<TupleIndex>(loc, arg, index, name, fb));
+        break;
+      }
+      case Op::kArray: {
+        XLS_RET_CHECK(type->IsArray());
+        add(std::make_unique<Array>(loc, operands,
+                                    type->AsArrayOrDie()->element_type(), name,
+                                    fb));
+        break;
+      }
+      case Op::kArrayIndex: {
+        XLS_ASSIGN_OR_RETURN(Node * array, operand(0));
+        XLS_ASSIGN_OR_RETURN(bool assumed_in_bounds, attributes.Bool(0));
+        add(std::make_unique<ArrayIndex>(loc, array,
+                                         operand_span(1, operands.size()),
+                                         assumed_in_bounds, name, fb));
+        break;
+      }
+      case Op::kArrayUpdate: {
+        XLS_ASSIGN_OR_RETURN(Node * array, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * value, operand(1));
+        XLS_ASSIGN_OR_RETURN(bool assumed_in_bounds, attributes.Bool(0));
+        add(std::make_unique<ArrayUpdate>(loc, array, value,
+                                          operand_span(2, operands.size()),
+                                          assumed_in_bounds, name, fb));
+        break;
+      }
+      case Op::kArrayConcat:
+        add(std::make_unique<ArrayConcat>(loc, operands, name, fb));
+        break;
+      case Op::kArraySlice: {
+        XLS_ASSIGN_OR_RETURN(Node * array, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * start, operand(1));
+        XLS_ASSIGN_OR_RETURN(int64_t width, attributes.Int(0));
+        add(std::make_unique<ArraySlice>(loc, array, start, width, name, fb));
+        break;
+      }
+      case Op::kInvoke: {
+        XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, GetFunction(index));
+        add(std::make_unique<Invoke>(loc, operands, to_apply, name, fb));
+        break;
+      }
+      case Op::kMap: {
+        XLS_ASSIGN_OR_RETURN(Node * arg, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(Function * to_apply, GetFunction(index));
+        add(std::make_unique<Map>(loc, arg, to_apply, name, fb));
+        break;
+      }
+      case Op::kCountedFor: {
+        XLS_ASSIGN_OR_RETURN(Node * initial_value, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t trip_count, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(int64_t stride, attributes.Int(1));
+        XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(2));
+        XLS_ASSIGN_OR_RETURN(Function * body, GetFunction(index));
+        add(std::make_unique<CountedFor>(
+            loc, initial_value, operand_span(1, operands.size()), trip_count,
+            stride, body, name, fb));
+        break;
+      }
+      case Op::kDynamicCountedFor: {
+        XLS_ASSIGN_OR_RETURN(Node * initial_value, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * trip_count, operand(1));
+        XLS_ASSIGN_OR_RETURN(Node * stride, operand(2));
+        XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(Function * body, GetFunction(index));
+        add(std::make_unique<DynamicCountedFor>(
+            loc, initial_value, trip_count, stride,
+            operand_span(3, operands.size()), body, name, fb));
+        break;
+      }
+      case Op::kAfterAll:
+        add(std::make_unique<AfterAll>(loc, operands, name, fb));
+        break;
+      case Op::kMinDelay: {
+        XLS_ASSIGN_OR_RETURN(Node * token, operand(0));
+        XLS_ASSIGN_OR_RETURN(int64_t delay, attributes.Int(0));
+        add(std::make_unique<MinDelay>(loc, token, delay, name, fb));
+        break;
+      }
+      case Op::kAssert: {
+        XLS_ASSIGN_OR_RETURN(Node * token, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * condition, operand(1));
+        XLS_ASSIGN_OR_RETURN(bool has_label, attributes.Bool(0));
+        XLS_ASSIGN_OR_RETURN(bool has_original_label, attributes.Bool(1));
+        XLS_ASSIGN_OR_RETURN(std::string message, attributes.String(0));
+        int64_t next_string = 1;
+        std::optional<std::string> label;
+        std::optional<std::string> original_label;
+        if (has_label) {
+          XLS_ASSIGN_OR_RETURN(label, attributes.String(next_string++));
+        }
+        if (has_original_label) {
+          XLS_ASSIGN_OR_RETURN(original_label,
+                               attributes.String(next_string++));
+        }
+        add(std::make_unique<Assert>(loc, token, condition, message, label,
+                                     original_label, name, fb));
+        break;
+      }
+      case Op::kCover: {
+        XLS_ASSIGN_OR_RETURN(Node * condition, operand(0));
+        XLS_ASSIGN_OR_RETURN(bool has_original_label, attributes.Bool(0));
+        XLS_ASSIGN_OR_RETURN(std::string label, attributes.String(0));
+        std::optional<std::string> original_label;
+        if (has_original_label) {
+          XLS_ASSIGN_OR_RETURN(original_label, attributes.String(1));
+        }
+        add(std::make_unique<Cover>(loc, condition, label, original_label,
+                                    name, fb));
+        break;
+      }
+      case Op::kTrace: {
+        XLS_ASSIGN_OR_RETURN(Node * token, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * condition, operand(1));
+        XLS_ASSIGN_OR_RETURN(int64_t verbosity, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(std::string format_string, attributes.String(0));
+        XLS_ASSIGN_OR_RETURN(std::vector<FormatStep> format,
+                             ParseFormatString(format_string));
+        add(std::make_unique<Trace>(loc, token, condition,
+                                    operand_span(2, operands.size()), format,
+                                    verbosity, name, fb));
+        break;
+      }
+      case Op::kStateRead: {
+        XLS_RET_CHECK(fb->IsProc());
+        Proc* proc = fb->AsProcOrDie();
+        XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+        XLS_ASSIGN_OR_RETURN(bool has_predicate, attributes.Bool(1));
+        XLS_RET_CHECK_EQ(index, proc->GetStateElementCount())
+            << "State reads must be in state element order";
+        XLS_RET_CHECK_LT(index, fb_proto.state_elements_size());
+        const BinaryStateElementProto& element =
+            fb_proto.state_elements(index);
+        XLS_ASSIGN_OR_RETURN(Value initial_value,
+                             Value::FromProto(element.initial_value()));
+        XLS_ASSIGN_OR_RETURN(
+            StateRead * state_read,
+            proc->AppendStateElement(element.name(), initial_value));
+        node = state_read;
+        node->SetLoc(loc);
+        if (!name.empty() && node->GetName() != name) {
+          node->SetName(name);
+        }
+        if (has_predicate) {
+          XLS_RET_CHECK_EQ(proto.operands_size(), 1);
+          state_read_predicates.push_back({state_read, proto.operands(0)});
+        }
+        break;
+      }
+      case Op::kNext: {
+        XLS_ASSIGN_OR_RETURN(Node * state_read, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * value, operand(1));
+        XLS_ASSIGN_OR_RETURN(bool has_predicate, attributes.Bool(0));
+        std::optional<Node*> predicate;
+        if (has_predicate) {
+          XLS_ASSIGN_OR_RETURN(predicate, operand(2));
+        }
+        add(std::make_unique<Next>(loc, state_read, value, predicate, name,
+                                   fb));
+        break;
+      }
+      case Op::kSend: {
+        XLS_ASSIGN_OR_RETURN(Node * token, operand(0));
+        XLS_ASSIGN_OR_RETURN(Node * data, operand(1));
+        XLS_ASSIGN_OR_RETURN(bool has_predicate, attributes.Bool(0));
+        XLS_ASSIGN_OR_RETURN(std::string channel, attributes.String(0));
+        std::optional<Node*> predicate;
+        if (has_predicate) {
+          XLS_ASSIGN_OR_RETURN(predicate, operand(2));
+        }
+        add(std::make_unique<Send>(loc, token, data, predicate, channel, name,
+                                   fb));
+        break;
+      }
+      case Op::kReceive: {
+        XLS_ASSIGN_OR_RETURN(Node * token, operand(0));
+        XLS_ASSIGN_OR_RETURN(bool has_predicate, attributes.Bool(0));
+        XLS_ASSIGN_OR_RETURN(bool is_blocking, attributes.Bool(1));
+        XLS_ASSIGN_OR_RETURN(std::string channel, attributes.String(0));
+        std::optional<Node*> predicate;
+        if (has_predicate) {
+          XLS_ASSIGN_OR_RETURN(predicate, operand(1));
+        }
+        add(std::make_unique<Receive>(loc, token, predicate, channel,
+                                      is_blocking, name, fb));
+        break;
+      }
+      case Op::kInputPort: {
+        XLS_RET_CHECK(fb->IsBlock());
+        Block* block = fb->AsBlockOrDie();
+        if (fb_proto.has_reset_port() && fb_proto.reset_port() == name) {
+          XLS_ASSIGN_OR_RETURN(node, block->AddResetPort(name));
+          node->SetLoc(loc);
+        } else {
+          XLS_ASSIGN_OR_RETURN(node, block->AddInputPort(name, type, loc));
+        }
+        break;
+      }
+      case Op::kOutputPort: {
+        XLS_RET_CHECK(fb->IsBlock());
+        XLS_ASSIGN_OR_RETURN(Node * source, operand(0));
+        XLS_ASSIGN_OR_RETURN(
+            node, fb->AsBlockOrDie()->AddOutputPort(name, source, loc));
+        break;
+      }
+      case Op::kRegisterRead: {
+        XLS_ASSIGN_OR_RETURN(Register * reg, GetRegister(fb, attributes));
+        add(std::make_unique<RegisterRead>(loc, reg, name, fb));
+        break;
+      }
+      case Op::kRegisterWrite: {
+        XLS_ASSIGN_OR_RETURN(Register * reg, GetRegister(fb, attributes));
+        XLS_ASSIGN_OR_RETURN(Node * data, operand(0));
+        XLS_ASSIGN_OR_RETURN(bool has_load_enable, attributes.Bool(1));
+        XLS_ASSIGN_OR_RETURN(bool has_reset, attributes.Bool(2));
+        int64_t next_operand = 1;
+        std::optional<Node*> load_enable;
+        std::optional<Node*> reset;
+        if (has_load_enable) {
+          XLS_ASSIGN_OR_RETURN(load_enable, operand(next_operand++));
+        }
+        if (has_reset) {
+          XLS_ASSIGN_OR_RETURN(reset, operand(next_operand++));
+        }
+        add(std::make_unique<RegisterWrite>(loc, data, load_enable, reset, reg,
+                                            name, fb));
+        break;
+      }
+      case Op::kInstantiationInput: {
+        XLS_ASSIGN_OR_RETURN(Instantiation * instantiation,
+                             GetInstantiation(fb, attributes));
+        XLS_ASSIGN_OR_RETURN(Node * data, operand(0));
+        XLS_ASSIGN_OR_RETURN(std::string port_name, attributes.String(0));
+        add(std::make_unique<InstantiationInput>(loc, data, instantiation,
+                                                 port_name, name, fb));
+        break;
+      }
+      case Op::kInstantiationOutput: {
+        XLS_ASSIGN_OR_RETURN(Instantiation * instantiation,
+                             GetInstantiation(fb, attributes));
+        XLS_ASSIGN_OR_RETURN(std::string port_name, attributes.String(0));
+        add(std::make_unique<InstantiationOutput>(loc, instantiation,
+                                                  port_name, name, fb));
+        break;
+      }
+    }
+    XLS_RET_CHECK(node != nullptr) << "Unsupported op " << OpToString(op);
+    XLS_RET_CHECK_EQ(node->id(), proto.id());
+    XLS_RET_CHECK_EQ(node->GetType(), type)
+        << "Type of node " << node->GetName() << " does not match";
+    return node;
+  }
+
+  absl::StatusOr<Register*> GetRegister(FunctionBase* fb,
+                                        const NodeAttributes& attributes) {
+    XLS_RET_CHECK(fb->IsBlock());
+    XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+    absl::Span<Register* const> registers = fb->AsBlockOrDie()->GetRegisters();
+    XLS_RET_CHECK(index >= 0 && index < registers.size())
+        << "Invalid register index " << index;
+    return registers[index];
+  }
+
+  absl::StatusOr<Instantiation*> GetInstantiation(
+      FunctionBase* fb, const NodeAttributes& attributes) {
+    XLS_RET_CHECK(fb->IsBlock());
+    XLS_ASSIGN_OR_RETURN(int64_t index, attributes.Int(0));
+    absl::Span<Instantiation* const> instantiations =
+        fb->AsBlockOrDie()->GetInstantiations();
+    XLS_RET_CHECK(index >= 0 && index < instantiations.size())
+        << "Invalid instantiation index " << index;
+    return instantiations[index];
+  }
+
+  const BinaryPackageProto& proto_;
+  Package* package_;
+  std::vector<Type*> types_;
+  std::vector<FunctionBase*> function_bases_;
+};
+
+absl::StatusOr<std::unique_ptr<Package>> ParsePackageContents(
+    std::string_view contents, const std::filesystem::path& path,
+    ThreadPool* thread_pool) {
+  if (IsBinaryPackage(contents)) {
+    return ParseBinaryPackage(contents);
+  }
+  if (thread_pool != nullptr) {
+    return Parser::ParsePackageConcurrently(contents, *thread_pool,
+                                            path.string());
+  }
+  return Parser::ParsePackage(contents, path.string());
+}
+
+}  // namespace
+
+bool IsBinaryPackage(std::string_view data) {
+  return data.starts_with(kBinaryPackageMagic);
+}
+
+absl::StatusOr<std::string> SerializePackageToBinary(Package* package) {
+  XLS_ASSIGN_OR_RETURN(BinaryPackageProto proto, Serializer(package).Run());
+  std::string result(kBinaryPackageMagic);
+  XLS_RET_CHECK(proto.AppendToString(&result));
+  return result;
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryPackage(
+    std::string_view data) {
+  if (!IsBinaryPackage(data)) {
+    return absl::InvalidArgumentError("Data is not a binary IR package");
+  }
+  data.remove_prefix(kBinaryPackageMagic.size());
+  BinaryPackageProto proto;
+  if (!proto.ParseFromArray(data.data(), data.size())) {
+    return absl::InvalidArgumentError("Malformed binary IR package");
+  }
+  if (proto.format_version() != kBinaryPackageFormatVersion) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unsupported binary IR format version %d (expected %d)",
+        proto.format_version(), kBinaryPackageFormatVersion));
+  }
+  auto package = std::make_unique<Package>(proto.name());
+  XLS_RETURN_IF_ERROR(Deserializer(proto, package.get()).Run());
+  XLS_RETURN_IF_ERROR(VerifyPackage(package.get()));
+  return package;
+}
+
+absl::Status WriteBinaryPackageFile(Package* package,
+                                    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(std::string data, SerializePackageToBinary(package));
+  return SetFileContents(path, data);
+}
+
+absl::StatusOr<std::unique_ptr<Package>> ReadPackageFile(
+    const std::filesystem::path& path, ThreadPool* thread_pool) {
+  absl::StatusOr<MappedFile> mapped = MappedFile::Open(path);
+  if (mapped.ok()) {
+    return ParsePackageContents(mapped->contents(), path, thread_pool);
+  }
+  // Files which can't be mapped (e.g. pipes) are read instead.
+  if (!absl::IsFailedPrecondition(mapped.status())) {
+    return mapped.status();
+  }
+  XLS_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+  return ParsePackageContents(contents, path, thread_pool);
+}
+
+absl::StatusOr<std::string> DumpPackage(Package* package, bool binary) {
+  if (binary) {
+    return SerializePackageToBinary(package);
+  }
+  return package->DumpIr();
+}
+
+}  // namespace xls
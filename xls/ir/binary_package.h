@@ -0,0 +1,71 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_BINARY_PACKAGE_H_
+#define XLS_IR_BINARY_PACKAGE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/thread_pool.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Binary IR package format. Loading a binary package avoids scanning and
+// parsing textual IR and resolving node names, which dominates tool start-up
+// time for large packages.
+//
+// The format is the magic string followed by a serialized BinaryPackageProto
+// (see binary_package.proto). Files are memory-mapped when read so the
+// package is built directly from the mapped buffer.
+//
+// New-style procs (with proc-scoped channels) and extern instantiations are
+// not yet supported and result in an UnimplementedError when serializing.
+inline constexpr std::string_view kBinaryPackageMagic = "XLSIRBIN";
+inline constexpr int64_t kBinaryPackageFormatVersion = 1;
+
+// Returns whether `data` starts with the binary package magic string.
+bool IsBinaryPackage(std::string_view data);
+
+// Serializes `package` into the binary format.
+absl::StatusOr<std::string> SerializePackageToBinary(Package* package);
+
+// Builds a package from binary data produced by SerializePackageToBinary. The
+// package is verified before it is returned.
+absl::StatusOr<std::unique_ptr<Package>> ParseBinaryPackage(
+    std::string_view data);
+
+// Writes `package` to `path` in the binary format.
+absl::Status WriteBinaryPackageFile(Package* package,
+                                    const std::filesystem::path& path);
+
+// Reads a package from `path`, which may contain either binary or textual IR.
+// Regular files are memory-mapped rather than read into memory; anything else
+// (eg, /dev/stdin) is read in full. If `thread_pool` is given, textual IR is
+// parsed concurrently on it (see Parser::ParsePackageConcurrently).
+absl::StatusOr<std::unique_ptr<Package>> ReadPackageFile(
+    const std::filesystem::path& path, ThreadPool* thread_pool = nullptr);
+
+// Returns `package` as binary or textual IR.
+absl::StatusOr<std::string> DumpPackage(Package* package, bool binary);
+
+}  // namespace xls
+
+#endif  // XLS_IR_BINARY_PACKAGE_H_
@@ -0,0 +1,169 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/binary_package.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/file/temp_file.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/binary_package.pb.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+constexpr std::string_view kFunctionPackage = R"(package test
+
+file_number 0 "fake/file.x"
+
+fn body(i: bits[11] id=1, x: bits[11] id=2, y: bits[11] id=3) -> bits[11] {
+  ret add.4: bits[11] = add(x, y, id=4, pos=[(0,1,2)])
+}
+
+fn callee(a: bits[8] id=5) -> bits[8] {
+  ret neg.6: bits[8] = neg(a, id=6)
+}
+
+top fn main(tkn: token id=7, p: bits[8] id=8, s: bits[2] id=9) -> (token, bits[11], bits[8]) {
+  literal.10: bits[11] = literal(value=0, id=10)
+  literal.11: bits[11] = literal(value=1, id=11)
+  counted_for.12: bits[11] = counted_for(literal.10, trip_count=7, stride=1, body=body, invariant_args=[literal.11], id=12)
+  invoke.13: bits[8] = invoke(p, to_apply=callee, id=13)
+  sel.14: bits[8] = sel(s, cases=[p, invoke.13], default=p, id=14)
+  bit_slice.15: bits[1] = bit_slice(p, start=3, width=1, id=15)
+  assert.16: token = assert(tkn, bit_slice.15, message="bad p", label="p_label", id=16)
+  trace.17: token = trace(assert.16, bit_slice.15, format="p is {}", data_operands=[p], verbosity=2, id=17)
+  cover.18: () = cover(bit_slice.15, label="p_cover", id=18)
+  named: bits[16] = zero_ext(sel.14, new_bit_count=16, id=19)
+  one_hot.20: bits[17] = one_hot(named, lsb_prio=false, id=20)
+  ret tuple.21: (token, bits[11], bits[8]) = tuple(trace.17, counted_for.12, sel.14, id=21)
+}
+)";
+
+constexpr std::string_view kProcPackage = R"(package test
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, strictness=proven_mutually_exclusive, metadata="""""")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, strictness=proven_mutually_exclusive, metadata="""""")
+
+#[initiation_interval(2)]
+top proc my_proc(my_token: token, my_state: bits[32], init={token, 42}) {
+  my_token: token = state_read(state_element=my_token, id=1)
+  my_state: bits[32] = state_read(state_element=my_state, id=2)
+  literal.3: bits[1] = literal(value=1, id=3)
+  receive.4: (token, bits[32]) = receive(my_token, predicate=literal.3, channel=in, id=4)
+  tuple_index.5: token = tuple_index(receive.4, index=0, id=5)
+  tuple_index.6: bits[32] = tuple_index(receive.4, index=1, id=6)
+  add.7: bits[32] = add(my_state, tuple_index.6, id=7)
+  send.8: token = send(tuple_index.5, add.7, channel=out, id=8)
+  next_value.9: () = next_value(param=my_token, value=send.8, id=9)
+  next_value.10: () = next_value(param=my_state, value=add.7, predicate=literal.3, id=10)
+}
+)";
+
+constexpr std::string_view kBlockPackage = R"(package test
+
+block sub_block(in: bits[32], out: bits[32]) {
+  in: bits[32] = input_port(name=in, id=1)
+  out: () = output_port(in, name=out, id=2)
+}
+
+top block my_block(clk: clock, rst: bits[1], x: bits[32], le: bits[1], y: bits[32]) {
+  reg foo(bits[32], reset_value=42, asynchronous=false, active_low=false)
+  instantiation inst(block=sub_block, kind=block)
+  rst: bits[1] = input_port(name=rst, id=3)
+  x: bits[32] = input_port(name=x, id=4)
+  le: bits[1] = input_port(name=le, id=5)
+  foo_q: bits[32] = register_read(register=foo, id=6)
+  inst_in: () = instantiation_input(foo_q, instantiation=inst, port_name=in, id=7)
+  inst_out: bits[32] = instantiation_output(instantiation=inst, port_name=out, id=8)
+  foo_d: () = register_write(x, register=foo, load_enable=le, reset=rst, id=9)
+  y: () = output_port(inst_out, name=y, id=10)
+}
+)";
+
+void ExpectRoundTrip(std::string_view ir) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string binary,
+                           SerializePackageToBinary(package.get()));
+  EXPECT_TRUE(IsBinaryPackage(binary));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> result,
+                           ParseBinaryPackage(binary));
+  EXPECT_EQ(result->DumpIr(), package->DumpIr());
+  EXPECT_EQ(result->next_node_id(), package->next_node_id());
+}
+
+TEST(BinaryPackageTest, RoundTripFunctions) {
+  ExpectRoundTrip(kFunctionPackage);
+}
+
+TEST(BinaryPackageTest, RoundTripProc) { ExpectRoundTrip(kProcPackage); }
+
+TEST(BinaryPackageTest, RoundTripBlocks) { ExpectRoundTrip(kBlockPackage); }
+
+TEST(BinaryPackageTest, ReadPackageFileDetectsFormat) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kFunctionPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile text_file,
+                           TempFile::CreateWithContent(package->DumpIr()));
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile binary_file, TempFile::Create(".irb"));
+  XLS_ASSERT_OK(WriteBinaryPackageFile(package.get(), binary_file.path()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_text,
+                           ReadPackageFile(text_file.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> from_binary,
+                           ReadPackageFile(binary_file.path()));
+  EXPECT_EQ(from_text->DumpIr(), package->DumpIr());
+  EXPECT_EQ(from_binary->DumpIr(), package->DumpIr());
+}
+
+TEST(BinaryPackageTest, RejectsOtherFormatVersions) {
+  BinaryPackageProto proto;
+  proto.set_format_version(kBinaryPackageFormatVersion + 1);
+  proto.set_name("test");
+  std::string binary(kBinaryPackageMagic);
+  proto.AppendToString(&binary);
+  EXPECT_THAT(ParseBinaryPackage(binary),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unsupported binary IR format version")));
+  EXPECT_THAT(ParseBinaryPackage("package test"),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+TEST(BinaryPackageTest, NewStyleProcsAreUnimplemented) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(R"(package test
+
+proc my_proc<>(my_state: bits[32], init={42}) {
+  my_state: bits[32] = state_read(state_element=my_state, id=1)
+  next_value.2: () = next_value(param=my_state, value=my_state, id=2)
+}
+)"));
+  EXPECT_THAT(SerializePackageToBinary(package.get()),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace xls
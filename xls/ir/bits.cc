@@ -112,51 +112,17 @@ absl::InlinedVector<bool, 1> Bits::ToBitVector() const {
 
 bool Bits::IsOne() const { return PopCount() == 1 && Get(0); }
 
-int64_t Bits::PopCount() const {
-  int64_t count = 0;
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      ++count;
-    }
-  }
-  return count;
-}
+int64_t Bits::PopCount() const { return bitmap_.PopCount(); }
 
-int64_t Bits::CountLeadingZeros() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(bit_count() - 1 - i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountLeadingZeros() const { return bitmap_.CountLeadingZeros(); }
 
-int64_t Bits::CountLeadingOnes() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (!Get(bit_count() - 1 - i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountLeadingOnes() const { return bitmap_.CountLeadingOnes(); }
 
 int64_t Bits::CountTrailingZeros() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (Get(i)) {
-      return i;
-    }
-  }
-  return bit_count();
+  return bitmap_.CountTrailingZeros();
 }
 
-int64_t Bits::CountTrailingOnes() const {
-  for (int64_t i = 0; i < bit_count(); ++i) {
-    if (!Get(i)) {
-      return i;
-    }
-  }
-  return bit_count();
-}
+int64_t Bits::CountTrailingOnes() const { return bitmap_.CountTrailingOnes(); }
 
 bool Bits::HasSingleRunOfSetBits(int64_t* leading_zero_count,
                                  int64_t* set_bit_count,
@@ -256,13 +222,7 @@ Bits Bits::Slice(int64_t start, int64_t width) && {
     // This is the most common slice so make it fast.
     return Bits::FromBitmap(std::move(bitmap_).WithSize(width));
   }
-  Bits result(width);
-  for (int64_t i = 0; i < width; ++i) {
-    if (Get(start + i)) {
-      result.bitmap_.Set(i, true);
-    }
-  }
-  return result;
+  return Bits::FromBitmap(bitmap_.Slice(start, width));
 }
 
 Bits Bits::Slice(int64_t start, int64_t width) const& {
@@ -275,13 +235,7 @@ Bits Bits::Slice(int64_t start, int64_t width) const& {
     // This is the most common slice so make it fast.
     return Bits::FromBitmap(bitmap_.WithSize(width));
   }
-  Bits result(width);
-  for (int64_t i = 0; i < width; ++i) {
-    if (Get(start + i)) {
-      result.bitmap_.Set(i, true);
-    }
-  }
-  return result;
+  return Bits::FromBitmap(bitmap_.Slice(start, width));
 }
 
 }  // namespace xls
@@ -236,6 +236,11 @@ class Bits {
   const InlineBitmap& bitmap() const& { return bitmap_; }
   InlineBitmap&& bitmap() && { return std::move(bitmap_); }
 
+  // Mutable access to the underlying bitmap, for operations which update a
+  // value in place (see e.g. bits_ops::AndInPlace). The bit count must not be
+  // changed through this reference.
+  InlineBitmap& mutable_bitmap() { return bitmap_; }
+
   template <typename H>
   friend H AbslHashValue(H h, const Bits& bits) {
     return H::combine(std::move(h), bits.bitmap_);
@@ -246,7 +251,7 @@ class Bits {
   friend absl::StatusOr<Bits> UBitsWithStatus(uint64_t, int64_t);
   friend absl::StatusOr<Bits> SBitsWithStatus(int64_t, int64_t);
 
-  explicit Bits(InlineBitmap&& bitmap) : bitmap_(bitmap) {}
+  explicit Bits(InlineBitmap&& bitmap) : bitmap_(std::move(bitmap)) {}
 
   InlineBitmap bitmap_;
 };
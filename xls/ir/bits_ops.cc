@@ -53,133 +53,93 @@ Bits TruncateOrSignExtend(Bits bits, int64_t bit_count) {
 }  // namespace
 
 Bits And(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(lhs.ToUint64().value() & rhs.ToUint64().value(),
-                 lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] & rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  Bits result = lhs;
+  AndInPlace(&result, rhs);
+  return result;
 }
 
 Bits NaryAnd(absl::Span<const Bits> operands) {
   Bits accum = operands.at(0);
   for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = And(accum, operands[i]);
+    AndInPlace(&accum, operands[i]);
   }
   return accum;
 }
 
 Bits Or(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int | rhs_int);
-    return UBits(result, lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] | rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  Bits result = lhs;
+  OrInPlace(&result, rhs);
+  return result;
 }
 
 Bits NaryOr(absl::Span<const Bits> operands) {
   Bits accum = operands.at(0);
   for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = Or(accum, operands[i]);
+    OrInPlace(&accum, operands[i]);
   }
   return accum;
 }
 
 Bits Xor(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int ^ rhs_int);
-    return UBits(result, lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = bytes[i] ^ rhs_bytes[i];
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  Bits result = lhs;
+  XorInPlace(&result, rhs);
+  return result;
 }
 
 Bits NaryXor(absl::Span<const Bits> operands) {
   Bits accum = operands.at(0);
   for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = Xor(accum, operands[i]);
+    XorInPlace(&accum, operands[i]);
   }
   return accum;
 }
 
 Bits Nand(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() & rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] & rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  Bits result = lhs;
+  AndInPlace(&result, rhs);
+  NotInPlace(&result);
+  return result;
 }
 
 Bits NaryNand(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = And(accum, operands[i]);
-  }
-  return Not(accum);
+  Bits accum = NaryAnd(operands);
+  NotInPlace(&accum);
+  return accum;
 }
 
 Bits Nor(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    return UBits(~(lhs.ToUint64().value() | rhs.ToUint64().value()) &
-                     Mask(lhs.bit_count()),
-                 lhs.bit_count());
-  }
-  std::vector<uint8_t> bytes = lhs.ToBytes();
-  std::vector<uint8_t> rhs_bytes = rhs.ToBytes();
-  for (int64_t i = 0; i < bytes.size(); ++i) {
-    bytes[i] = ~(bytes[i] | rhs_bytes[i]);
-  }
-  return Bits::FromBytes(bytes, lhs.bit_count());
+  Bits result = lhs;
+  OrInPlace(&result, rhs);
+  NotInPlace(&result);
+  return result;
 }
 
 Bits NaryNor(absl::Span<const Bits> operands) {
-  Bits accum = operands.at(0);
-  for (int64_t i = 1; i < operands.size(); ++i) {
-    accum = Or(accum, operands[i]);
-  }
-  return Not(accum);
+  Bits accum = NaryOr(operands);
+  NotInPlace(&accum);
+  return accum;
 }
 
 Bits Not(const Bits& bits) {
-  if (bits.bit_count() <= 64) {
-    return UBits((~bits.ToUint64().value()) & Mask(bits.bit_count()),
-                 bits.bit_count());
-  }
-  std::vector<uint8_t> bytes = bits.ToBytes();
-  for (uint8_t& byte : bytes) {
-    byte = ~byte;
-  }
-  return Bits::FromBytes(bytes, bits.bit_count());
+  Bits result = bits;
+  NotInPlace(&result);
+  return result;
 }
 
+void AndInPlace(Bits* lhs, const Bits& rhs) {
+  lhs->mutable_bitmap().Intersect(rhs.bitmap());
+}
+
+void OrInPlace(Bits* lhs, const Bits& rhs) {
+  lhs->mutable_bitmap().Union(rhs.bitmap());
+}
+
+void XorInPlace(Bits* lhs, const Bits& rhs) {
+  lhs->mutable_bitmap().SymmetricDifference(rhs.bitmap());
+}
+
+void NotInPlace(Bits* bits) { bits->mutable_bitmap().Invert(); }
+
 Bits AndReduce(const Bits& operand) {
   // Is every bit set?
   return operand.IsAllOnes() ? UBits(1, 1) : UBits(0, 1);
@@ -196,30 +156,50 @@ Bits XorReduce(const Bits& operand) {
 }
 
 Bits Add(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int + rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
-  }
-
-  Bits sum = BigInt::Add(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                 .ToSignedBits();
-  return TruncateOrSignExtend(std::move(sum), lhs.bit_count());
+  Bits result = lhs;
+  AddInPlace(&result, rhs);
+  return result;
 }
 
 Bits Sub(const Bits& lhs, const Bits& rhs) {
-  CHECK_EQ(lhs.bit_count(), rhs.bit_count());
-  if (lhs.bit_count() <= 64) {
-    uint64_t lhs_int = lhs.ToUint64().value();
-    uint64_t rhs_int = rhs.ToUint64().value();
-    uint64_t result = (lhs_int - rhs_int) & Mask(lhs.bit_count());
-    return UBits(result, lhs.bit_count());
+  Bits result = lhs;
+  SubInPlace(&result, rhs);
+  return result;
+}
+
+void AddInPlace(Bits* lhs, const Bits& rhs) {
+  CHECK_EQ(lhs->bit_count(), rhs.bit_count());
+  InlineBitmap& result = lhs->mutable_bitmap();
+  const InlineBitmap& addend = rhs.bitmap();
+  // Ripple the carry through the words; SetWord masks off any carry out of the
+  // most significant word, which truncates the sum to the operand width.
+  uint64_t carry = 0;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    uint64_t lhs_word = result.GetWord(i);
+    uint64_t sum = lhs_word + addend.GetWord(i);
+    uint64_t carry_out = sum < lhs_word ? 1 : 0;
+    sum += carry;
+    carry_out |= (sum < carry) ? 1 : 0;
+    result.SetWord(i, sum);
+    carry = carry_out;
+  }
+}
+
+void SubInPlace(Bits* lhs, const Bits& rhs) {
+  CHECK_EQ(lhs->bit_count(), rhs.bit_count());
+  InlineBitmap& result = lhs->mutable_bitmap();
+  const InlineBitmap& subtrahend = rhs.bitmap();
+  uint64_t borrow = 0;
+  for (int64_t i = 0; i < result.word_count(); ++i) {
+    uint64_t lhs_word = result.GetWord(i);
+    uint64_t rhs_word = subtrahend.GetWord(i);
+    uint64_t diff = lhs_word - rhs_word;
+    uint64_t borrow_out = lhs_word < rhs_word ? 1 : 0;
+    borrow_out |= (diff < borrow) ? 1 : 0;
+    diff -= borrow;
+    result.SetWord(i, diff);
+    borrow = borrow_out;
   }
-  Bits diff = BigInt::Sub(BigInt::MakeSigned(lhs), BigInt::MakeSigned(rhs))
-                  .ToSignedBits();
-  return TruncateOrSignExtend(std::move(diff), lhs.bit_count());
 }
 
 Bits Increment(const Bits& x) {
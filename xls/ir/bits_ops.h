@@ -53,6 +53,16 @@ Bits Decrement(const Bits& x);
 Bits Add(const Bits& lhs, const Bits& rhs);
 Bits Sub(const Bits& lhs, const Bits& rhs);
 
+// In-place variants of the operations above which overwrite `lhs` with the
+// result rather than allocating a new value. The width of the lhs and rhs must
+// be equal.
+void AndInPlace(Bits* lhs, const Bits& rhs);
+void OrInPlace(Bits* lhs, const Bits& rhs);
+void XorInPlace(Bits* lhs, const Bits& rhs);
+void NotInPlace(Bits* bits);
+void AddInPlace(Bits* lhs, const Bits& rhs);
+void SubInPlace(Bits* lhs, const Bits& rhs);
+
 // Signed/unsigned multiplication. The rhs and lhs can be different widths.
 // The width of the result of the operation is the sum of the widths of the
 // operands.
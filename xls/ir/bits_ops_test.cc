@@ -155,6 +155,42 @@ TEST(BitsOpsTest, Sub) {
   }
 }
 
+TEST(BitsOpsTest, InPlaceOps) {
+  Bits narrow = UBits(0b1100, 4);
+  bits_ops::AndInPlace(&narrow, UBits(0b1010, 4));
+  EXPECT_EQ(narrow, UBits(0b1000, 4));
+  bits_ops::OrInPlace(&narrow, UBits(0b0001, 4));
+  EXPECT_EQ(narrow, UBits(0b1001, 4));
+  bits_ops::XorInPlace(&narrow, UBits(0b1111, 4));
+  EXPECT_EQ(narrow, UBits(0b0110, 4));
+  bits_ops::NotInPlace(&narrow);
+  EXPECT_EQ(narrow, UBits(0b1001, 4));
+  bits_ops::AddInPlace(&narrow, UBits(9, 4));
+  EXPECT_EQ(narrow, UBits(2, 4));
+  bits_ops::SubInPlace(&narrow, UBits(3, 4));
+  EXPECT_EQ(narrow, UBits(15, 4));
+
+  Bits empty;
+  bits_ops::NotInPlace(&empty);
+  bits_ops::AddInPlace(&empty, Bits());
+  EXPECT_EQ(empty, Bits());
+
+  // Carries and borrows ripple across words of wide values.
+  Bits wide = Bits::AllOnes(130);
+  bits_ops::AddInPlace(&wide, UBits(1, 130));
+  EXPECT_EQ(wide, Bits(130));
+  bits_ops::SubInPlace(&wide, UBits(1, 130));
+  EXPECT_EQ(wide, Bits::AllOnes(130));
+  bits_ops::NotInPlace(&wide);
+  EXPECT_EQ(wide, Bits(130));
+  bits_ops::OrInPlace(&wide, Bits::PowerOfTwo(129, 130));
+  bits_ops::XorInPlace(&wide, Bits::PowerOfTwo(64, 130));
+  EXPECT_EQ(wide, bits_ops::Or(Bits::PowerOfTwo(129, 130),
+                               Bits::PowerOfTwo(64, 130)));
+  bits_ops::AndInPlace(&wide, Bits::PowerOfTwo(64, 130));
+  EXPECT_EQ(wide, Bits::PowerOfTwo(64, 130));
+}
+
 TEST(BitsOpsTest, Increment) {
   EXPECT_EQ(bits_ops::Increment(Bits()), Bits());
   EXPECT_EQ(bits_ops::Increment(UBits(23, 64)), UBits(24, 64));
@@ -1228,5 +1264,90 @@ void BM_ZeroExtendMove(benchmark::State& state) {
 }
 BENCHMARK(BM_ZeroExtendMove)->Range(33, 1 << 20);
 
+// The benchmarks below start at a single bit so that the cost of the common
+// narrow widths is tracked alongside the wide ones.
+
+void BM_Add(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::Add(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Add)->Range(1, 1 << 16);
+
+void BM_And(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::And(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_And)->Range(1, 1 << 16);
+
+void BM_UMul(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::UMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_UMul)->Range(1, 1 << 12);
+
+void BM_SMul(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    auto v = bits_ops::SMul(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_SMul)->Range(1, 1 << 12);
+
+void BM_ULessThan(benchmark::State& state) {
+  Bits lhs = PrimeBits(state.range(0));
+  Bits rhs = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    bool v = bits_ops::ULessThan(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_ULessThan)->Range(1, 1 << 16);
+
+void BM_ShiftLeftLogical(benchmark::State& state) {
+  Bits f = PrimeBits(state.range(0));
+  int64_t shift_amount = state.range(0) / 3;
+  for (auto _ : state) {
+    auto v = bits_ops::ShiftLeftLogical(f, shift_amount);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_ShiftLeftLogical)->Range(1, 1 << 16);
+
+void BM_ShiftRightArith(benchmark::State& state) {
+  Bits f = bits_ops::Not(PrimeBits(state.range(0)));
+  int64_t shift_amount = state.range(0) / 3;
+  for (auto _ : state) {
+    auto v = bits_ops::ShiftRightArith(f, shift_amount);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_ShiftRightArith)->Range(1, 1 << 16);
+
+// Concatenates four operands of the given width.
+void BM_Concat(benchmark::State& state) {
+  std::vector<Bits> operands = {
+      PrimeBits(state.range(0)), Bits::AllOnes(state.range(0)),
+      Bits(state.range(0)), PrimeBits(state.range(0))};
+  for (auto _ : state) {
+    auto v = bits_ops::Concat(operands);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_Concat)->Range(1, 1 << 16);
+
 }  // namespace
 }  // namespace xls
@@ -45,6 +45,7 @@
 #include "xls/common/visitor.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/instantiation.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/register.h"
@@ -219,7 +220,7 @@ std::vector<Node*> Block::DumpOrder() const {
   return order;
 }
 
-std::string Block::DumpIr() const {
+void Block::DumpIrTo(IrSink& sink) const {
   std::vector<std::string> port_strings;
   for (const Port& port : GetPorts()) {
     if (std::holds_alternative<ClockPort*>(port)) {
@@ -235,22 +236,21 @@ std::string Block::DumpIr() const {
           std::get<OutputPort*>(port)->operand(0)->GetType()->ToString()));
     }
   }
-  std::string res = absl::StrFormat("block %s(%s) {\n", name(),
-                                    absl::StrJoin(port_strings, ", "));
+  sink.Append("block ", name(), "(", absl::StrJoin(port_strings, ", "),
+              ") {\n");
 
   for (Instantiation* instantiation : GetInstantiations()) {
-    absl::StrAppendFormat(&res, "  %s\n", instantiation->ToString());
+    sink.Append("  ", instantiation->ToString(), "\n");
   }
 
   for (Register* reg : GetRegisters()) {
-    absl::StrAppendFormat(&res, "  %s\n", reg->ToString());
+    sink.Append("  ", reg->ToString(), "\n");
   }
 
   for (Node* node : DumpOrder()) {
-    absl::StrAppend(&res, "  ", node->ToString(), "\n");
+    sink.Append("  ", node->ToString(), "\n");
   }
-  absl::StrAppend(&res, "}\n");
-  return res;
+  sink.Append("}\n");
 }
 
 absl::Status Block::SetPortNameExactly(std::string_view name, Node* node) {
@@ -29,6 +29,7 @@
 #include "xls/ir/channel.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -209,7 +210,7 @@ class Block : public FunctionBase {
       const absl::flat_hash_map<const Block*, Block*>& block_instantiation_map =
           {}) const;
 
-  std::string DumpIr() const override;
+  void DumpIrTo(IrSink& sink) const override;
 
  private:
   // Sets the name of the given port node (InputPort or OutputPort) to the given
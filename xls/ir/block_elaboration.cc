@@ -17,6 +17,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <deque>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -754,6 +755,43 @@ static absl::StatusOr<std::unique_ptr<BlockInstance>> ElaborateBlock(
       }
     }
   }
+
+  // Flatten the elaboration into a dense numbering of its nodes.
+  absl::flat_hash_map<Block*, absl::Span<const int64_t>> local_node_indices;
+  elaboration.local_node_indices_.reserve(elaboration.blocks_.size());
+  for (Block* block : elaboration.blocks_) {
+    int64_t max_id = 0;
+    for (Node* node : block->nodes()) {
+      max_id = std::max(max_id, node->id());
+    }
+    std::vector<int64_t>& indices =
+        elaboration.local_node_indices_.emplace_back(max_id + 1, -1);
+    int64_t local_index = 0;
+    for (Node* node : block->nodes()) {
+      indices[node->id()] = local_index++;
+    }
+    local_node_indices[block] = indices;
+  }
+  int64_t node_count = 0;
+  for (int64_t i = 0; i < elaboration.instance_ptrs_.size(); ++i) {
+    BlockInstance* instance = elaboration.instance_ptrs_[i];
+    instance->index_ = i;
+    instance->node_offset_ = node_count;
+    if (instance->block().has_value()) {
+      instance->local_node_indices_ = local_node_indices.at(*instance->block());
+      node_count += (*instance->block())->node_count();
+    }
+  }
+  elaboration.nodes_.reserve(node_count);
+  for (BlockInstance* instance : elaboration.instance_ptrs_) {
+    if (!instance->block().has_value()) {
+      continue;
+    }
+    for (Node* node : (*instance->block())->nodes()) {
+      elaboration.nodes_.push_back(
+          ElaboratedNode{.node = node, .instance = instance});
+    }
+  }
   return elaboration;
 }
 
@@ -920,32 +958,33 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
   //
   // NOTE: sorts reverse-topologically.  To sort topologically, reverse the
   // result.
-  absl::flat_hash_map<ElaboratedNode, int64_t> pending_to_remaining_successors;
+  //
+  // The remaining successor counts are kept in an array indexed by the
+  // elaboration's dense node numbering; kUnseen marks nodes not yet pending.
+  static constexpr int64_t kUnseen = std::numeric_limits<int64_t>::min();
+  std::vector<int64_t> pending_to_remaining_successors(
+      elaboration.node_count(), kUnseen);
   std::vector<ElaboratedNode> ordered;
   std::deque<ElaboratedNode> ready;
 
   auto seed_ready = [&](ElaboratedNode n) {
     ready.push_front(n);
-    CHECK(pending_to_remaining_successors.insert({n, -1}).second);
+    int64_t& remaining_successors =
+        pending_to_remaining_successors[elaboration.NodeIndex(n)];
+    CHECK_EQ(remaining_successors, kUnseen);
+    remaining_successors = -1;
   };
 
-  int64_t node_count = 0;
-  for (BlockInstance* inst : elaboration.instances()) {
-    if (!inst->block().has_value()) {
-      continue;
-    }
-    Block* block = *inst->block();
-    for (Node* node : block->nodes()) {
-      ++node_count;
-      ElaboratedNode elaborated_node{.node = node, .instance = inst};
-      absl::StatusOr<std::vector<ElaboratedNode>> inter_instance_users =
-          InterInstanceSuccessors(elaborated_node);
-      CHECK_OK(inter_instance_users);
-
-      if (inter_instance_users->empty() && node->users().empty()) {
-        VLOG(5) << "At start node was ready: " << node;
-        seed_ready(elaborated_node);
-      }
+  const int64_t node_count = elaboration.node_count();
+  for (const ElaboratedNode& elaborated_node : elaboration.nodes()) {
+    absl::StatusOr<std::vector<ElaboratedNode>> inter_instance_users =
+        InterInstanceSuccessors(elaborated_node);
+    CHECK_OK(inter_instance_users);
+
+    if (inter_instance_users->empty() &&
+        elaborated_node.node->users().empty()) {
+      VLOG(5) << "At start node was ready: " << elaborated_node.node;
+      seed_ready(elaborated_node);
     }
   }
 
@@ -956,18 +995,17 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
         InterInstanceSuccessors(n);
     CHECK_OK(inter_instance_users);
     for (const ElaboratedNode& inter_instance_user : *inter_instance_users) {
-      auto it = pending_to_remaining_successors.find(inter_instance_user);
-      if (it == pending_to_remaining_successors.end() || it->second >= 0) {
+      int64_t remaining_successors =
+          pending_to_remaining_successors[elaboration.NodeIndex(
+              inter_instance_user)];
+      if (remaining_successors == kUnseen || remaining_successors >= 0) {
         return false;
       }
     }
     return absl::c_all_of(n.node->users(), [&](Node* user) {
-      auto it = pending_to_remaining_successors.find(
-          ElaboratedNode{.node = user, .instance = n.instance});
-      if (it == pending_to_remaining_successors.end()) {
-        return false;
-      }
-      return it->second < 0;
+      int64_t remaining_successors =
+          pending_to_remaining_successors[n.instance->NodeIndex(user)];
+      return remaining_successors != kUnseen && remaining_successors < 0;
     });
   };
   auto bump_down_remaining_successors = [&](const ElaboratedNode& n) {
@@ -975,19 +1013,20 @@ std::vector<ElaboratedNode> ElaboratedReverseTopoSort(
         InterInstanceSuccessors(n);
     CHECK_OK(inter_instance_users);
     CHECK(!n.node->users().empty() || !inter_instance_users->empty());
-    auto [it, inserted] =
-        pending_to_remaining_successors.insert({n, n.node->users().size()});
-    int64_t& remaining_successors = it->second;
-    // If we inserted, add inter-instance users.
-    if (inserted) {
-      remaining_successors += inter_instance_users->size();
+    int64_t& remaining_successors =
+        pending_to_remaining_successors[elaboration.NodeIndex(n)];
+    // If this is the first time the node is seen, count all of its users,
+    // including inter-instance users.
+    if (remaining_successors == kUnseen) {
+      remaining_successors =
+          n.node->users().size() + inter_instance_users->size();
     }
     CHECK_GT(remaining_successors, 0);
     remaining_successors -= 1;
     VLOG(5) << "Bumped down remaining successors for: " << n
             << "; now: " << remaining_successors;
     if (remaining_successors == 0) {
-      ready.push_back(it->first);
+      ready.push_back(n);
       remaining_successors -= 1;
     }
   };
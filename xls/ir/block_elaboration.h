@@ -15,6 +15,7 @@
 #ifndef XLS_IR_BLOCK_ELABORATION_H_
 #define XLS_IR_BLOCK_ELABORATION_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <ostream>
@@ -125,7 +126,18 @@ class BlockInstance {
     return parent_instance_;
   }
 
+  // Position of this instance in BlockElaboration::instances().
+  int64_t index() const { return index_; }
+
+  // Returns the dense index of `node` (a node of block()) among all nodes of
+  // the elaboration. See BlockElaboration::NodeIndex.
+  int64_t NodeIndex(const Node* node) const {
+    return node_offset_ + local_node_indices_[node->id()];
+  }
+
  private:
+  friend class BlockElaboration;
+
   std::optional<Block*> block_;
   std::optional<Instantiation*> instantiation_;
   BlockInstantiationPath path_;
@@ -141,6 +153,14 @@ class BlockInstance {
   // Each pointer (keys and values!) must be non-null.
   absl::flat_hash_map<Instantiation*, BlockInstance*>
       instantiation_to_instance_;
+
+  // Set by BlockElaboration::Elaborate.
+  int64_t index_ = 0;
+  // Index in the elaboration of this instance's first node.
+  int64_t node_offset_ = 0;
+  // Position of each node of block() within the block, indexed by node id.
+  // Shared by all instances of the block; owned by the elaboration.
+  absl::Span<const int64_t> local_node_indices_;
 };
 
 // Data structure representing the elaboration tree starting from a root block.
@@ -182,6 +202,21 @@ class BlockElaboration {
 
   absl::Status Accept(ElaboratedBlockDfsVisitor& visitor) const;
 
+  // The elaboration is flattened into a dense numbering of every (node,
+  // instance) pair: the nodes of `instances()[i]` occupy a contiguous range
+  // of indices following those of `instances()[i - 1]`. Analyses and
+  // evaluators can index arrays of size `node_count()` instead of hashing
+  // ElaboratedNodes. The numbering is computed once by Elaborate, so nodes must
+  // not be added to or removed from the elaborated blocks while it is in use.
+  int64_t node_count() const { return nodes_.size(); }
+  int64_t NodeIndex(const ElaboratedNode& node) const {
+    return node.instance->NodeIndex(node.node);
+  }
+  const ElaboratedNode& NodeAtIndex(int64_t index) const {
+    return nodes_[index];
+  }
+  absl::Span<const ElaboratedNode> nodes() const { return nodes_; }
+
  private:
   BlockElaboration() = default;
 
@@ -199,6 +234,12 @@ class BlockElaboration {
 
   absl::flat_hash_map<Block*, std::vector<BlockInstance*>>
       instances_of_function_;
+
+  // Every elaborated node, in NodeIndex order.
+  std::vector<ElaboratedNode> nodes_;
+  // Position of each node within its block, indexed by node id, for each
+  // block in `blocks_`. Referenced by the instances of the block.
+  std::vector<std::vector<int64_t>> local_node_indices_;
 };
 
 // Returns a list of every (Node, BlockInstance) in the elaboration in topo
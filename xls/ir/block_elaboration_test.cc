@@ -15,6 +15,7 @@
 #include "xls/ir/block_elaboration.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <string_view>
 #include <vector>
@@ -56,6 +57,7 @@ using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 using ::testing::Pair;
 using ::testing::UnorderedElementsAre;
+using ::testing::UnorderedElementsAreArray;
 
 namespace m = xls::op_matchers;
 
@@ -476,6 +478,34 @@ TEST_F(ElaborationTest, TopoSortMultipleInstantiations) {
           NodeAndInst(m::OutputPort("out"), HasSubstr("multi_adder "))));
 }
 
+TEST_F(ElaborationTest, DenseNodeIndices) {
+  auto p = CreatePackage();
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MultipleAddInstantiations(*p));
+
+  XLS_ASSERT_OK_AND_ASSIGN(BlockElaboration elab,
+                           BlockElaboration::Elaborate(block));
+
+  int64_t expected_node_count = 0;
+  for (BlockInstance* instance : elab.instances()) {
+    EXPECT_EQ(elab.instances()[instance->index()], instance);
+    if (instance->block().has_value()) {
+      expected_node_count += (*instance->block())->node_count();
+    }
+  }
+  EXPECT_EQ(elab.node_count(), expected_node_count);
+  ASSERT_EQ(elab.nodes().size(), elab.node_count());
+
+  // Every elaborated node has a distinct index which maps back to it.
+  for (int64_t i = 0; i < elab.node_count(); ++i) {
+    const ElaboratedNode& node = elab.NodeAtIndex(i);
+    EXPECT_EQ(elab.NodeIndex(node), i);
+    EXPECT_EQ(node.instance->NodeIndex(node.node), i);
+  }
+  EXPECT_THAT(ElaboratedTopoSort(elab),
+              UnorderedElementsAreArray(elab.nodes()));
+}
+
 // Note that the topo sort on FunctionBase is intended to have the same order
 // (modulo instantiations) as this topo sort. Tests should be duplicated here
 // and there to the extend that it is possible.
@@ -0,0 +1,66 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_CHANGE_LISTENER_H_
+#define XLS_IR_CHANGE_LISTENER_H_
+
+#include <cstdint>
+
+#include "absl/types/span.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// Interface for objects which want to be notified of changes to the nodes of a
+// FunctionBase, e.g. analyses which are kept up to date incrementally rather
+// than recomputed from scratch. Listeners are registered with
+// FunctionBase::RegisterChangeListener.
+//
+// Notifications are delivered synchronously on the thread making the change.
+// Listeners must not register or unregister listeners on the FunctionBase from
+// within a node notification.
+class ChangeListener {
+ public:
+  virtual ~ChangeListener() = default;
+
+  // Called after `node` has been added to its FunctionBase.
+  virtual void NodeAdded(Node* node) {}
+
+  // Called immediately before `node` is removed from its FunctionBase. `node`
+  // is still valid (and has its operands) during the call.
+  virtual void NodeDeleted(Node* node) {}
+
+  // Called after the operands of `node` at `operand_nos` were changed from
+  // `old_operand` to something else.
+  virtual void OperandChanged(Node* node, Node* old_operand,
+                              absl::Span<const int64_t> operand_nos) {}
+
+  // Called after the operand `old_operand` was removed from the end of the
+  // operand list of `node`.
+  virtual void OperandRemoved(Node* node, Node* old_operand) {}
+
+  // Called after an operand was appended to the operand list of `node`, which
+  // was already part of a FunctionBase.
+  virtual void OperandAdded(Node* node) {}
+
+  // Called when `function_base` is being destroyed. The listener is
+  // unregistered implicitly; no nodes may be accessed.
+  virtual void FunctionBaseDeleted(FunctionBase* function_base) {}
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_CHANGE_LISTENER_H_
@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/compact_graph.h"
+
+#include <cstdint>
+#include <limits>
+
+#include "absl/log/check.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+CompactGraph::CompactGraph(const FunctionBase* f) {
+  int64_t node_count = f->node_count();
+  CHECK_LT(node_count, std::numeric_limits<int32_t>::max());
+  nodes_.reserve(node_count);
+  index_.reserve(node_count);
+  int64_t operand_count = 0;
+  int64_t user_count = 0;
+  for (Node* node : f->nodes()) {
+    index_.emplace(node, nodes_.size());
+    nodes_.push_back(node);
+    operand_count += node->operand_count();
+    user_count += node->users().size();
+  }
+
+  operand_offsets_.reserve(node_count + 1);
+  operand_edges_.reserve(operand_count);
+  user_offsets_.reserve(node_count + 1);
+  user_edges_.reserve(user_count);
+  for (Node* node : nodes_) {
+    operand_offsets_.push_back(operand_edges_.size());
+    for (Node* operand : node->operands()) {
+      operand_edges_.push_back(index_.at(operand));
+    }
+    user_offsets_.push_back(user_edges_.size());
+    for (Node* user : node->users()) {
+      user_edges_.push_back(index_.at(user));
+    }
+  }
+  operand_offsets_.push_back(operand_edges_.size());
+  user_offsets_.push_back(user_edges_.size());
+}
+
+}  // namespace xls
@@ -0,0 +1,90 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_COMPACT_GRAPH_H_
+#define XLS_IR_COMPACT_GRAPH_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+
+namespace xls {
+
+class FunctionBase;
+class Node;
+
+// An immutable, index-based snapshot of the dataflow graph of a FunctionBase.
+// Nodes are numbered densely from 0 in the order of FunctionBase::nodes(), and
+// operand and user edges are stored as indices in compressed sparse row (CSR)
+// form: one contiguous array of edges plus one offset per node. Traversals
+// over this representation touch a few flat arrays instead of chasing pointers
+// through individually allocated nodes.
+//
+// Operands are listed in operand order (including duplicates); users are
+// listed in the order of Node::users() (unique, sorted by id) at the time the
+// snapshot was taken.
+//
+// Obtain one with FunctionBase::compact_graph(), which caches the snapshot and
+// rebuilds it lazily after the graph changes.
+class CompactGraph {
+ public:
+  explicit CompactGraph(const FunctionBase* f);
+
+  int64_t node_count() const { return static_cast<int64_t>(nodes_.size()); }
+
+  Node* node(int64_t index) const { return nodes_[index]; }
+  absl::Span<Node* const> nodes() const { return nodes_; }
+
+  // Returns the index of `node`, which must belong to the snapshot's
+  // FunctionBase.
+  int64_t index(const Node* node) const {
+    auto it = index_.find(node);
+    CHECK(it != index_.end());
+    return it->second;
+  }
+  std::optional<int64_t> MaybeIndex(const Node* node) const {
+    auto it = index_.find(node);
+    if (it == index_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  absl::Span<const int32_t> operands(int64_t index) const {
+    return absl::MakeConstSpan(operand_edges_)
+        .subspan(operand_offsets_[index],
+                 operand_offsets_[index + 1] - operand_offsets_[index]);
+  }
+  absl::Span<const int32_t> users(int64_t index) const {
+    return absl::MakeConstSpan(user_edges_)
+        .subspan(user_offsets_[index],
+                 user_offsets_[index + 1] - user_offsets_[index]);
+  }
+
+ private:
+  std::vector<Node*> nodes_;
+  absl::flat_hash_map<const Node*, int32_t> index_;
+  std::vector<int32_t> operand_offsets_;
+  std::vector<int32_t> operand_edges_;
+  std::vector<int32_t> user_offsets_;
+  std::vector<int32_t> user_edges_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_COMPACT_GRAPH_H_
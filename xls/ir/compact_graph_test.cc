@@ -0,0 +1,99 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/compact_graph.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class CompactGraphTest : public IrTestBase {};
+
+TEST_F(CompactGraphTest, MatchesNodeEdges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, x);
+  BValue diff = fb.Subtract(sum, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  const CompactGraph& graph = f->compact_graph();
+  ASSERT_EQ(graph.node_count(), f->node_count());
+  for (int64_t i = 0; i < graph.node_count(); ++i) {
+    Node* node = graph.node(i);
+    EXPECT_EQ(graph.index(node), i);
+    ASSERT_EQ(graph.operands(i).size(), node->operand_count());
+    for (int64_t j = 0; j < node->operand_count(); ++j) {
+      EXPECT_EQ(graph.node(graph.operands(i)[j]), node->operand(j));
+    }
+    ASSERT_EQ(graph.users(i).size(), node->users().size());
+    for (int64_t j = 0; j < node->users().size(); ++j) {
+      EXPECT_EQ(graph.node(graph.users(i)[j]), node->users()[j]);
+    }
+  }
+
+  int64_t xi = graph.index(x.node());
+  int64_t sumi = graph.index(sum.node());
+  EXPECT_THAT(graph.operands(sumi), ElementsAre(xi, xi));
+  EXPECT_THAT(graph.users(xi), ElementsAre(sumi));
+  EXPECT_THAT(graph.users(graph.index(diff.node())), IsEmpty());
+}
+
+TEST_F(CompactGraphTest, RebuiltAfterChange) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  {
+    const CompactGraph& graph = f->compact_graph();
+    EXPECT_THAT(graph.operands(graph.index(neg.node())),
+                ElementsAre(graph.index(x.node())));
+  }
+
+  XLS_ASSERT_OK(neg.node()->ReplaceOperandNumber(0, y.node()));
+  {
+    const CompactGraph& graph = f->compact_graph();
+    EXPECT_THAT(graph.operands(graph.index(neg.node())),
+                ElementsAre(graph.index(y.node())));
+    EXPECT_THAT(graph.users(graph.index(x.node())), IsEmpty());
+  }
+
+  XLS_ASSERT_OK(f->RemoveNode(x.node()));
+  {
+    const CompactGraph& graph = f->compact_graph();
+    EXPECT_EQ(graph.node_count(), 2);
+    EXPECT_FALSE(graph.MaybeIndex(x.node()).has_value());
+  }
+}
+
+}  // namespace
+}  // namespace xls
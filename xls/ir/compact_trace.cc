@@ -0,0 +1,171 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/compact_trace.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/format_strings.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Decodes a value of type `type` from the front of `bytes`, advancing it past
+// the value's encoding.
+absl::StatusOr<Value> DecodeOperand(Type* type, std::string_view& bytes) {
+  switch (type->kind()) {
+    case TypeKind::kBits: {
+      const int64_t bit_count = type->AsBitsOrDie()->bit_count();
+      const int64_t byte_count = (bit_count + 7) / 8;
+      if (static_cast<int64_t>(bytes.size()) < byte_count) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Compact trace operand too short for %s", type->ToString()));
+      }
+      Bits bits = Bits::FromBytes(
+          absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(bytes.data()),
+                              byte_count),
+          bit_count);
+      bytes.remove_prefix(byte_count);
+      return Value(std::move(bits));
+    }
+    case TypeKind::kTuple: {
+      std::vector<Value> elements;
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        XLS_ASSIGN_OR_RETURN(Value element, DecodeOperand(element_type, bytes));
+        elements.push_back(std::move(element));
+      }
+      return Value::Tuple(elements);
+    }
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      std::vector<Value> elements;
+      elements.reserve(array_type->size());
+      for (int64_t i = 0; i < array_type->size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(Value element,
+                             DecodeOperand(array_type->element_type(), bytes));
+        elements.push_back(std::move(element));
+      }
+      return Value::ArrayOrDie(elements);
+    }
+    case TypeKind::kToken:
+      return Value::Token();
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Unsupported trace operand type %s", type->ToString()));
+}
+
+}  // namespace
+
+void AppendCompactTraceOperand(const Value& value, std::string& buffer) {
+  switch (value.kind()) {
+    case ValueKind::kBits: {
+      std::vector<uint8_t> bytes = value.bits().ToBytes();
+      buffer.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+      return;
+    }
+    case ValueKind::kTuple:
+    case ValueKind::kArray:
+      for (const Value& element : value.elements()) {
+        AppendCompactTraceOperand(element, buffer);
+      }
+      return;
+    default:
+      return;
+  }
+}
+
+std::string EncodeCompactTraceOperands(absl::Span<const Value> values) {
+  std::string buffer;
+  for (const Value& value : values) {
+    AppendCompactTraceOperand(value, buffer);
+  }
+  return buffer;
+}
+
+TraceSiteTable::TraceSiteTable(Package* package) {
+  for (FunctionBase* f : package->GetFunctionBases()) {
+    for (Node* node : f->nodes()) {
+      if (node->Is<Trace>()) {
+        sites_.emplace(node->id(), node->As<Trace>());
+      }
+    }
+  }
+}
+
+absl::StatusOr<TraceMessage> TraceSiteTable::Format(
+    const CompactTraceLog::Record& record) const {
+  auto it = sites_.find(record.site_id);
+  if (it == sites_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No trace node with id %d", record.site_id));
+  }
+  Trace* trace = it->second;
+  std::string_view bytes = record.operand_bytes;
+  absl::Span<Node* const> args = trace->args();
+  auto arg = args.begin();
+  std::string message;
+  for (const FormatStep& step : trace->format()) {
+    if (std::holds_alternative<std::string>(step)) {
+      absl::StrAppend(&message, std::get<std::string>(step));
+      continue;
+    }
+    XLS_RET_CHECK(arg != args.end())
+        << "Not enough operands in trace node " << trace->ToString();
+    XLS_ASSIGN_OR_RETURN(Value value, DecodeOperand((*arg)->GetType(), bytes));
+    absl::StrAppend(&message,
+                    value.ToHumanString(std::get<FormatPreference>(step)));
+    ++arg;
+  }
+  XLS_RET_CHECK(bytes.empty())
+      << "Extra operand bytes in compact trace record for "
+      << trace->ToString();
+  return TraceMessage{.message = std::move(message),
+                      .verbosity = trace->verbosity()};
+}
+
+absl::StatusOr<std::vector<TraceMessage>> TraceSiteTable::Format(
+    const CompactTraceLog& log) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<CompactTraceLog::Record> records,
+                       log.Records());
+  std::vector<TraceMessage> messages;
+  messages.reserve(records.size());
+  for (const CompactTraceLog::Record& record : records) {
+    XLS_ASSIGN_OR_RETURN(TraceMessage message, Format(record));
+    messages.push_back(std::move(message));
+  }
+  return messages;
+}
+
+}  // namespace xls
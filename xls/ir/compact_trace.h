@@ -0,0 +1,63 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_COMPACT_TRACE_H_
+#define XLS_IR_COMPACT_TRACE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Appends the encoding of a trace operand used by `CompactTraceLog` records to
+// `buffer`: each leaf of `value` in order, as the little-endian bytes of its
+// bits (see `Bits::ToBytes`). Tokens have no bits. The encoding carries no type
+// information; it is decoded against the type of the trace's operand.
+void AppendCompactTraceOperand(const Value& value, std::string& buffer);
+
+// Returns the compact trace operand encoding of `values`.
+std::string EncodeCompactTraceOperands(absl::Span<const Value> values);
+
+// The trace nodes of a package, indexed by node id, used to format the records
+// of a `CompactTraceLog` produced by running that package.
+class TraceSiteTable {
+ public:
+  explicit TraceSiteTable(Package* package);
+
+  // Returns the message the trace node named by `record` would have produced.
+  absl::StatusOr<TraceMessage> Format(
+      const CompactTraceLog::Record& record) const;
+
+  // Formats every record of `log`, in order.
+  absl::StatusOr<std::vector<TraceMessage>> Format(
+      const CompactTraceLog& log) const;
+
+  int64_t size() const { return sites_.size(); }
+
+ private:
+  absl::flat_hash_map<int64_t, Trace*> sites_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_COMPACT_TRACE_H_
@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/compact_trace.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::HasSubstr;
+
+class CompactTraceTest : public IrTestBase {};
+
+constexpr char kIr[] = R"(
+package p
+
+fn f(tkn: token, x: bits[12], y: (bits[3], bits[8][2])) -> token {
+  literal.1: bits[1] = literal(value=1, id=1)
+  trace.2: token = trace(tkn, literal.1, format="x={:x} y={}", data_operands=[x, y], id=2)
+  ret trace.3: token = trace(trace.2, literal.1, format="done", data_operands=[], verbosity=2, id=3)
+}
+)";
+
+TEST_F(CompactTraceTest, FormatsRecords) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kIr));
+  TraceSiteTable sites(p.get());
+  EXPECT_EQ(sites.size(), 2);
+
+  Value y = Value::Tuple(
+      {Value(UBits(5, 3)),
+       Value::ArrayOrDie({Value(UBits(1, 8)), Value(UBits(255, 8))})});
+  CompactTraceLog log;
+  log.Append(/*site_id=*/2,
+             EncodeCompactTraceOperands({Value(UBits(0xabc, 12)), y}));
+  log.Append(/*site_id=*/3, "");
+  EXPECT_EQ(log.size(), 2);
+
+  EXPECT_THAT(
+      sites.Format(log),
+      IsOkAndHolds(ElementsAre(
+          TraceMessage{.message = "x=abc y=(5, [1, 255])", .verbosity = 0},
+          TraceMessage{.message = "done", .verbosity = 2})));
+
+  // The packed form can be saved and decoded later.
+  CompactTraceLog reloaded(log.data());
+  EXPECT_THAT(sites.Format(reloaded),
+              IsOkAndHolds(ElementsAre(Field(&TraceMessage::message,
+                                             "x=abc y=(5, [1, 255])"),
+                                       Field(&TraceMessage::message, "done"))));
+}
+
+TEST_F(CompactTraceTest, MalformedRecords) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kIr));
+  TraceSiteTable sites(p.get());
+
+  CompactTraceLog unknown_site;
+  unknown_site.Append(/*site_id=*/42, "");
+  EXPECT_THAT(sites.Format(unknown_site),
+              StatusIs(absl::StatusCode::kNotFound, HasSubstr("id 42")));
+
+  CompactTraceLog short_operands;
+  short_operands.Append(/*site_id=*/2, "\x01");
+  EXPECT_THAT(sites.Format(short_operands),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("too short")));
+
+  CompactTraceLog log;
+  log.Append(/*site_id=*/3, "");
+  std::string data = log.data();
+  data.pop_back();
+  EXPECT_THAT(CompactTraceLog(data).Records(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Truncated")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,148 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/concurrent_function_base_transform.h"
+
+#include <cctype>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+// Returns `name` with each embedded decimal number which is a key of
+// `id_map` replaced by the corresponding value. Scope-private ids are at least
+// 15 digits long, so shorter digit runs are never rewritten.
+std::string RewriteEmbeddedIds(
+    std::string_view name, const absl::flat_hash_map<int64_t, int64_t>& id_map) {
+  constexpr int64_t kMinIdDigits = 15;
+  std::string result;
+  int64_t i = 0;
+  while (i < name.size()) {
+    if (!std::isdigit(static_cast<unsigned char>(name[i]))) {
+      result.push_back(name[i++]);
+      continue;
+    }
+    int64_t end = i;
+    while (end < name.size() &&
+           std::isdigit(static_cast<unsigned char>(name[end]))) {
+      ++end;
+    }
+    std::string_view digits = name.substr(i, end - i);
+    int64_t id;
+    if (digits.size() >= kMinIdDigits && absl::SimpleAtoi(digits, &id) &&
+        id_map.contains(id)) {
+      absl::StrAppend(&result, id_map.at(id));
+    } else {
+      absl::StrAppend(&result, digits);
+    }
+    i = end;
+  }
+  return result;
+}
+
+}  // namespace
+
+ConcurrentFunctionBaseTransform::ConcurrentFunctionBaseTransform(
+    Package* package, absl::Span<FunctionBase* const> function_bases)
+    : package_(package),
+      function_bases_(function_bases.begin(), function_bases.end()) {
+  CHECK_LT(package->next_node_id(), kLocalNodeIdBase);
+  states_.reserve(function_bases_.size());
+  for (int64_t i = 0; i < function_bases_.size(); ++i) {
+    CHECK_EQ(function_bases_[i]->package(), package);
+    states_.push_back(internal::PackageThreadState{
+        .package = package,
+        .next_node_id = kLocalNodeIdBase + i * kLocalNodeIdStride,
+        .transform_metrics = TransformMetrics()});
+  }
+}
+
+void ConcurrentFunctionBaseTransform::SetThreadState(
+    internal::PackageThreadState* state) {
+  Package::thread_state_ = state;
+}
+
+ConcurrentFunctionBaseTransform::Scope::Scope(
+    ConcurrentFunctionBaseTransform& transform, int64_t index) {
+  CHECK(Package::thread_state_ == nullptr)
+      << "ConcurrentFunctionBaseTransform scopes may not be nested";
+  SetThreadState(&transform.states_.at(index));
+}
+
+ConcurrentFunctionBaseTransform::Scope::~Scope() { SetThreadState(nullptr); }
+
+void ConcurrentFunctionBaseTransform::Finish() {
+  for (int64_t i = 0; i < function_bases_.size(); ++i) {
+    FunctionBase* function_base = function_bases_[i];
+    int64_t range_start = kLocalNodeIdBase + i * kLocalNodeIdStride;
+    CHECK_LT(states_[i].next_node_id, range_start + kLocalNodeIdStride);
+
+    // Nodes created within the scope, in creation order.
+    std::vector<Node*> new_nodes;
+    for (Node* node : function_base->nodes()) {
+      if (node->id() >= range_start) {
+        new_nodes.push_back(node);
+      }
+    }
+    absl::c_sort(new_nodes,
+                 [](Node* a, Node* b) { return a->id() < b->id(); });
+
+    // Shift the whole scope-private range onto the package's counter, ids of
+    // nodes created and then removed within the scope included, so the
+    // result is identical to running the transform serially. The shift keeps
+    // every new node's id above all pre-existing ids and preserves their
+    // relative order, which user lists rely on.
+    int64_t base = package_->next_node_id();
+    absl::flat_hash_map<int64_t, int64_t> id_map;
+    for (Node* node : new_nodes) {
+      int64_t new_id = base + (node->id() - range_start);
+      id_map[node->id()] = new_id;
+      node->SetId(new_id);
+    }
+    package_->set_next_node_id(base + (states_[i].next_node_id - range_start));
+
+    // Names derived from the generated name of a new node (e.g. "add.<id>")
+    // embed the scope-private id.
+    if (!id_map.empty()) {
+      for (Node* node : function_base->nodes()) {
+        if (!node->HasAssignedName()) {
+          continue;
+        }
+        std::string name = node->GetName();
+        std::string rewritten = RewriteEmbeddedIds(name, id_map);
+        if (rewritten != name) {
+          node->SetName(rewritten);
+        }
+      }
+    }
+
+    package_->transform_metrics_ =
+        package_->transform_metrics_ + states_[i].transform_metrics;
+  }
+}
+
+}  // namespace xls
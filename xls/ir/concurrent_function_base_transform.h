@@ -0,0 +1,100 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_CONCURRENT_FUNCTION_BASE_TRANSFORM_H_
+#define XLS_IR_CONCURRENT_FUNCTION_BASE_TRANSFORM_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+
+// Coordinates transforming several FunctionBases of a package concurrently,
+// each on its own thread, such that the resulting IR is identical to
+// transforming them one after another in a given order.
+//
+// The only package-wide state mutated when transforming a FunctionBase is the
+// node id counter and the transform metrics (type creation is internally
+// synchronized). While a Scope is live on a thread, nodes created in the
+// package on that thread draw ids from a range private to the scope's
+// FunctionBase. Finish() then renumbers the new nodes of each FunctionBase in
+// the serial order, so node ids (and generated node names) match a serial
+// run.
+//
+// Transforms using this must not create or remove FunctionBases or channels,
+// and a FunctionBase must not be inspected while another thread transforms
+// it.
+//
+// Example:
+//
+//   ConcurrentFunctionBaseTransform transform(package, package->
+//       GetFunctionBases());
+//   ... for each index `i`, on some thread:
+//         ConcurrentFunctionBaseTransform::Scope scope(transform, i);
+//         ... transform transform.function_bases()[i] ...
+//   ... wait for all threads ...
+//   transform.Finish();
+class ConcurrentFunctionBaseTransform {
+ public:
+  ConcurrentFunctionBaseTransform(
+      Package* package, absl::Span<FunctionBase* const> function_bases);
+
+  ConcurrentFunctionBaseTransform(const ConcurrentFunctionBaseTransform&) =
+      delete;
+  ConcurrentFunctionBaseTransform& operator=(
+      const ConcurrentFunctionBaseTransform&) = delete;
+
+  // While alive, the calling thread may transform `function_bases()[index]`.
+  // Scopes may not be nested.
+  class Scope {
+   public:
+    Scope(ConcurrentFunctionBaseTransform& transform, int64_t index);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+  // Assigns final ids to the nodes created within each scope, in the order of
+  // `function_bases()`, rewrites node names which embed a scope-private id,
+  // and adds the accumulated transform metrics to the package. Must be called
+  // once, after all scopes have been destroyed.
+  void Finish();
+
+  absl::Span<FunctionBase* const> function_bases() const {
+    return function_bases_;
+  }
+
+ private:
+  // Installs `state` as the calling thread's package state.
+  static void SetThreadState(internal::PackageThreadState* state);
+
+  // Node ids handed out within the scope of function base `i` lie in
+  // [kLocalNodeIdBase + i * kLocalNodeIdStride, ...), far above any id a
+  // package would otherwise reach.
+  static constexpr int64_t kLocalNodeIdBase = int64_t{1} << 48;
+  static constexpr int64_t kLocalNodeIdStride = int64_t{1} << 32;
+
+  Package* package_;
+  std::vector<FunctionBase*> function_bases_;
+  std::vector<internal::PackageThreadState> states_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_CONCURRENT_FUNCTION_BASE_TRANSFORM_H_
@@ -0,0 +1,155 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/concurrent_function_base_transform.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+constexpr char kIr[] = R"(
+package test
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.3: bits[8] = add(x, y, id=3)
+}
+
+fn g(a: bits[8]) -> bits[8] {
+  ret neg.5: bits[8] = neg(a, id=5)
+}
+
+fn h(b: bits[4]) -> bits[4] {
+  ret not.7: bits[4] = not(b, id=7)
+}
+)";
+
+// Wraps the return value of `f` in two nots, naming the outer one after the
+// generated name of the inner one.
+absl::Status Transform(Function* f) {
+  Node* ret = f->return_value();
+  XLS_ASSIGN_OR_RETURN(Node * inner,
+                       f->MakeNode<UnOp>(ret->loc(), ret, Op::kNot));
+  XLS_ASSIGN_OR_RETURN(
+      Node * outer,
+      f->MakeNodeWithName<UnOp>(ret->loc(), inner, Op::kNot,
+                                absl::StrCat(inner->GetName(), "_outer")));
+  return f->set_return_value(outer);
+}
+
+TEST(ConcurrentFunctionBaseTransformTest, MatchesSerialTransform) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial,
+                           Parser::ParsePackage(kIr));
+  for (FunctionBase* fb : serial->GetFunctionBases()) {
+    XLS_ASSERT_OK(Transform(fb->AsFunctionOrDie()));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> concurrent,
+                           Parser::ParsePackage(kIr));
+  std::vector<FunctionBase*> function_bases = concurrent->GetFunctionBases();
+  ConcurrentFunctionBaseTransform transform(concurrent.get(), function_bases);
+  std::vector<std::unique_ptr<Thread>> threads;
+  // Transform in reverse order to make sure the order of execution doesn't
+  // matter.
+  for (int64_t i = function_bases.size() - 1; i >= 0; --i) {
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      ConcurrentFunctionBaseTransform::Scope scope(transform, i);
+      CHECK_OK(Transform(function_bases[i]->AsFunctionOrDie()));
+    }));
+    threads.back()->Join();
+  }
+  transform.Finish();
+
+  EXPECT_EQ(concurrent->DumpIr(), serial->DumpIr());
+  EXPECT_EQ(concurrent->next_node_id(), serial->next_node_id());
+  EXPECT_EQ(concurrent->transform_metrics().nodes_added,
+            serial->transform_metrics().nodes_added);
+}
+
+// Creates a node which is immediately removed before applying `Transform`, so
+// the removed node's id must still be accounted for.
+absl::Status TransformWithRemovedNode(Function* f) {
+  Node* ret = f->return_value();
+  XLS_ASSIGN_OR_RETURN(Node * dead,
+                       f->MakeNode<UnOp>(ret->loc(), ret, Op::kNeg));
+  XLS_RETURN_IF_ERROR(f->RemoveNode(dead));
+  return Transform(f);
+}
+
+TEST(ConcurrentFunctionBaseTransformTest, RemovedNodesMatchSerialTransform) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial,
+                           Parser::ParsePackage(kIr));
+  for (FunctionBase* fb : serial->GetFunctionBases()) {
+    XLS_ASSERT_OK(TransformWithRemovedNode(fb->AsFunctionOrDie()));
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> concurrent,
+                           Parser::ParsePackage(kIr));
+  std::vector<FunctionBase*> function_bases = concurrent->GetFunctionBases();
+  ConcurrentFunctionBaseTransform transform(concurrent.get(), function_bases);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      ConcurrentFunctionBaseTransform::Scope scope(transform, i);
+      CHECK_OK(TransformWithRemovedNode(function_bases[i]->AsFunctionOrDie()));
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  transform.Finish();
+
+  EXPECT_EQ(concurrent->DumpIr(), serial->DumpIr());
+  EXPECT_EQ(concurrent->next_node_id(), serial->next_node_id());
+}
+
+TEST(ConcurrentFunctionBaseTransformTest, ConcurrentTypeCreation) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> p,
+                           Parser::ParsePackage(kIr));
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  ConcurrentFunctionBaseTransform transform(p.get(), function_bases);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      ConcurrentFunctionBaseTransform::Scope scope(transform, i);
+      for (int64_t width = 1; width < 256; ++width) {
+        p->GetTupleType({p->GetBitsType(width), p->GetBitsType(width + i)});
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  transform.Finish();
+  EXPECT_EQ(p->GetBitsType(17), p->GetBitsType(17));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,9 +14,64 @@
 
 #include "xls/ir/events.h"
 
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
 
 namespace xls {
+namespace {
+
+void AppendInt64(int64_t value, std::string& data) {
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+int64_t ReadInt64(std::string_view data, int64_t offset) {
+  int64_t value;
+  std::memcpy(&value, data.data() + offset, sizeof(value));
+  return value;
+}
+
+}  // namespace
+
+void CompactTraceLog::Append(int64_t site_id, std::string_view operand_bytes) {
+  AppendInt64(site_id, data_);
+  AppendInt64(operand_bytes.size(), data_);
+  data_.append(operand_bytes);
+  ++size_;
+}
+
+absl::StatusOr<std::vector<CompactTraceLog::Record>> CompactTraceLog::Records()
+    const {
+  constexpr int64_t kHeaderSize = 2 * sizeof(int64_t);
+  std::vector<Record> records;
+  records.reserve(size_);
+  std::string_view data = data_;
+  const int64_t total_size = data.size();
+  int64_t offset = 0;
+  while (offset < total_size) {
+    if (total_size - offset < kHeaderSize) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Truncated compact trace record header at offset %d", offset));
+    }
+    int64_t site_id = ReadInt64(data, offset);
+    int64_t size = ReadInt64(data, offset + sizeof(int64_t));
+    offset += kHeaderSize;
+    if (size < 0 || size > total_size - offset) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Truncated compact trace record for site %d at offset %d", site_id,
+          offset));
+    }
+    records.push_back(
+        Record{.site_id = site_id, .operand_bytes = data.substr(offset, size)});
+    offset += size;
+  }
+  return records;
+}
 
 absl::Status InterpreterEventsToStatus(const InterpreterEvents& events) {
   if (events.assert_msgs.empty()) {
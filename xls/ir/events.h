@@ -18,6 +18,8 @@
 #include <compare>
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -49,19 +51,81 @@ struct TraceMessage {
   }
 };
 
+// Traces recorded without formatting their messages. Each record holds the id
+// of the trace node which fired (its "site") and the raw bits of its data
+// operands, packed back to back in a single byte string, so recording a trace
+// costs a copy of its operands rather than a formatted std::string. Messages
+// are produced on request by `TraceSiteTable` (xls/ir/compact_trace.h), which
+// also defines the operand encoding.
+//
+// The packed form is returned by `data()` and can be saved and decoded later
+// against the same IR.
+class CompactTraceLog {
+ public:
+  struct Record {
+    int64_t site_id;
+    std::string_view operand_bytes;
+  };
+
+  CompactTraceLog() = default;
+  explicit CompactTraceLog(std::string data) : data_(std::move(data)) {}
+
+  // Appends a record of trace node `site_id` firing with the encoded operands
+  // `operand_bytes`.
+  void Append(int64_t site_id, std::string_view operand_bytes);
+
+  // Appends all records of `other`.
+  void Append(const CompactTraceLog& other) {
+    data_.append(other.data_);
+    size_ += other.size_;
+  }
+
+  // Returns the records in the order they were appended. The views are valid
+  // until the log is next modified. Fails if the log was constructed from
+  // malformed data.
+  absl::StatusOr<std::vector<Record>> Records() const;
+
+  // Number of records appended to this log (not counting records of data the
+  // log was constructed from).
+  int64_t size() const { return size_; }
+  bool empty() const { return data_.empty(); }
+  const std::string& data() const { return data_; }
+
+  void Clear() {
+    data_.clear();
+    size_ = 0;
+  }
+
+  bool operator==(const CompactTraceLog& other) const {
+    return data_ == other.data_;
+  }
+  bool operator!=(const CompactTraceLog& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  std::string data_;
+  int64_t size_ = 0;
+};
+
 // Common structure capturing events that can be produced by any XLS interpreter
 // (DSLX, IR, JIT, etc.)
 struct InterpreterEvents {
   std::vector<TraceMessage> trace_msgs;
   std::vector<std::string> assert_msgs;
+  // Traces recorded by interpreters running in compact trace mode instead of
+  // `trace_msgs`.
+  CompactTraceLog compact_traces;
 
   void Clear() {
     trace_msgs.clear();
     assert_msgs.clear();
+    compact_traces.Clear();
   }
 
   bool operator==(const InterpreterEvents& other) const {
-    return trace_msgs == other.trace_msgs && assert_msgs == other.assert_msgs;
+    return trace_msgs == other.trace_msgs && assert_msgs == other.assert_msgs &&
+           compact_traces == other.compact_traces;
   }
   bool operator!=(const InterpreterEvents& other) const {
     return !(*this == other);
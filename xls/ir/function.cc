@@ -14,14 +14,17 @@
 
 #include "xls/ir/function.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -31,6 +34,7 @@
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
@@ -48,18 +52,23 @@ FunctionType* Function::GetType() {
   CHECK(return_value() != nullptr);
   return package_->GetFunctionType(arg_types, return_value()->GetType());
 }
-std::string Function::DumpIr() const {
-  return DumpIrWithAnnotations(
-      [](Node* n) -> std::optional<std::string> { return std::nullopt; });
+void Function::DumpIrTo(IrSink& sink) const {
+  DumpIrWithAnnotationsTo(
+      sink, [](Node* n) -> std::optional<std::string> { return std::nullopt; });
 }
 
 std::string Function::DumpIrWithAnnotations(
     const std::function<std::optional<std::string>(Node*)>& annotate) const {
-  std::string res;
+  StringIrSink sink;
+  DumpIrWithAnnotationsTo(sink, annotate);
+  return sink.Release();
+}
 
-  absl::StrAppend(&res, "fn " + name() + "(");
-  absl::StrAppend(
-      &res,
+void Function::DumpIrWithAnnotationsTo(
+    IrSink& sink,
+    const std::function<std::optional<std::string>(Node*)>& annotate) const {
+  sink.Append("fn ", name(), "(");
+  sink.Append(
       absl::StrJoin(params_, ", ", [&](std::string* s, Param* const param) {
         std::optional<std::string> annotation = annotate(param);
         absl::StrAppendFormat(
@@ -67,57 +76,120 @@ std::string Function::DumpIrWithAnnotations(
             param->id(),
             annotation ? absl::StrCat(" (", *annotation, ")") : "");
       }));
-  absl::StrAppend(&res, ") -> ");
+  sink.Append(") -> ");
 
   if (return_value() != nullptr) {
-    absl::StrAppend(&res, return_value()->GetType()->ToString());
+    sink.Append(return_value()->GetType()->ToString());
   }
-  absl::StrAppend(&res, " {\n");
+  sink.Append(" {\n");
 
   for (Node* node : TopoSort(const_cast<Function*>(this))) {
     if (node->op() == Op::kParam && node == return_value()) {
-      absl::StrAppendFormat(&res, "  ret %s\n", node->ToString());
+      sink.Append("  ret ", node->ToString(), "\n");
       continue;
     }
     if (node->op() == Op::kParam) {
       continue;  // Already accounted for in the signature.
     }
     std::optional<std::string> annotation = annotate(node);
-    absl::StrAppend(
-        &res, "  ", node == return_value() ? "ret " : "", node->ToString(),
-        annotation ? absl::StrCat(" (", *annotation, ")") : "", "\n");
+    sink.Append("  ", node == return_value() ? "ret " : "", node->ToString(),
+                annotation ? absl::StrCat(" (", *annotation, ")") : "", "\n");
   }
 
-  absl::StrAppend(&res, "}\n");
-  return res;
+  sink.Append("}\n");
 }
 
+namespace {
+
+// Maps the nodes of a function to their clones. Node ids are allocated by the
+// package, so the ids of a function's nodes are usually close together; in
+// that case clones are kept in an array indexed by id rather than in a hash
+// map.
+class CloneMap {
+ public:
+  explicit CloneMap(const FunctionBase* f) {
+    if (f->node_count() == 0) {
+      return;
+    }
+    int64_t min_id = std::numeric_limits<int64_t>::max();
+    int64_t max_id = std::numeric_limits<int64_t>::min();
+    for (const Node* node : f->nodes()) {
+      min_id = std::min(min_id, node->id());
+      max_id = std::max(max_id, node->id());
+    }
+    if (max_id - min_id < kMaxDensityFactor * f->node_count()) {
+      min_id_ = min_id;
+      dense_.resize(max_id - min_id + 1, nullptr);
+    } else {
+      sparse_.reserve(f->node_count());
+    }
+  }
+
+  void Set(const Node* original, Node* clone) {
+    if (dense_.empty()) {
+      sparse_[original] = clone;
+    } else {
+      dense_[original->id() - min_id_] = clone;
+    }
+  }
+
+  Node* at(const Node* original) const {
+    if (dense_.empty()) {
+      return sparse_.at(original);
+    }
+    Node* clone = dense_[original->id() - min_id_];
+    CHECK(clone != nullptr) << "No clone of " << original->GetName();
+    return clone;
+  }
+
+ private:
+  // The id range may be at most this many times the node count for the array
+  // representation to be used.
+  static constexpr int64_t kMaxDensityFactor = 4;
+
+  int64_t min_id_ = 0;
+  std::vector<Node*> dense_;
+  absl::flat_hash_map<const Node*, Node*> sparse_;
+};
+
+}  // namespace
+
 absl::StatusOr<Function*> Function::Clone(
     std::string_view new_name, Package* target_package,
     const absl::flat_hash_map<const Function*, Function*>& call_remapping)
     const {
-  absl::flat_hash_map<Node*, Node*> original_to_clone;
+  CloneMap original_to_clone(this);
   if (target_package == nullptr) {
     target_package = package();
   }
   Function* cloned_function = target_package->AddFunction(
       std::make_unique<Function>(new_name, target_package));
   cloned_function->SetForeignFunctionData(foreign_function_);
+  cloned_function->ReserveNodes(node_count());
+  // The nodes being copied were verified when they were added to this
+  // function, so the copies are not verified one by one.
+  bool verify_new_nodes = cloned_function->SetVerifyNewNodes(false);
+  absl::Cleanup restore_verification = [&] {
+    cloned_function->SetVerifyNewNodes(verify_new_nodes);
+  };
 
   // Clone parameters over first to maintain order.
   for (Param* param : (const_cast<Function*>(this))->params()) {
-    XLS_ASSIGN_OR_RETURN(original_to_clone[param],
+    XLS_ASSIGN_OR_RETURN(Node * cloned_param,
                          param->CloneInNewFunction({}, cloned_function));
+    original_to_clone.Set(param, cloned_param);
   }
+  std::vector<Node*> cloned_operands;
   for (Node* node : TopoSort(const_cast<Function*>(this))) {
     if (node->Is<Param>()) {  // Params were already copied.
       continue;
     }
-    std::vector<Node*> cloned_operands;
+    cloned_operands.clear();
     for (Node* operand : node->operands()) {
       cloned_operands.push_back(original_to_clone.at(operand));
     }
 
+    Node* cloned_node;
     switch (node->op()) {
       // Remap CountedFor body.
       case Op::kCountedFor: {
@@ -126,7 +198,7 @@ absl::StatusOr<Function*> Function::Clone(
                              ? call_remapping.at(src->body())
                              : src->body();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            cloned_node,
             cloned_function->MakeNodeWithName<CountedFor>(
                 src->loc(), cloned_operands[0],
                 absl::Span<Node*>(cloned_operands).subspan(1),
@@ -140,7 +212,7 @@ absl::StatusOr<Function*> Function::Clone(
                                  ? call_remapping.at(src->to_apply())
                                  : src->to_apply();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            cloned_node,
             cloned_function->MakeNodeWithName<Map>(
                 src->loc(), cloned_operands[0], to_apply, src->GetName()));
         break;
@@ -152,7 +224,7 @@ absl::StatusOr<Function*> Function::Clone(
                                  ? call_remapping.at(src->to_apply())
                                  : src->to_apply();
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            cloned_node,
             cloned_function->MakeNodeWithName<Invoke>(
                 src->loc(), cloned_operands, to_apply, src->GetName()));
         break;
@@ -160,11 +232,12 @@ absl::StatusOr<Function*> Function::Clone(
       // Default clone.
       default: {
         XLS_ASSIGN_OR_RETURN(
-            original_to_clone[node],
+            cloned_node,
             node->CloneInNewFunction(cloned_operands, cloned_function));
         break;
       }
     }
+    original_to_clone.Set(node, cloned_node);
   }
   XLS_RETURN_IF_ERROR(
       cloned_function->set_return_value(original_to_clone.at(return_value())));
@@ -28,6 +28,7 @@
 #include "absl/strings/str_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
@@ -58,16 +59,15 @@ class Function : public FunctionBase {
 
   FunctionType* GetType();
 
-  // DumpIr emits the IR in a parsable, hierarchical text format.
-  // Parameter:
-  //   'recursive' if true, will dump counted-for body functions as well.
-  //   This is only useful when dumping individual functions, and not packages.
-  std::string DumpIr() const override;
+  void DumpIrTo(IrSink& sink) const override;
 
   // DumpIr emits the IR in a hierarchical text format with the returned
   // annotations after each node definition.
   std::string DumpIrWithAnnotations(
       const std::function<std::optional<std::string>(Node*)>& annotate) const;
+  void DumpIrWithAnnotationsTo(
+      IrSink& sink,
+      const std::function<std::optional<std::string>(Node*)>& annotate) const;
 
   // Creates a clone of the function with the new name 'new_name'. Function is
   // owned by target_package.  call_remapping specifies any function
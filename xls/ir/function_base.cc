@@ -32,14 +32,18 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/block.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/compact_graph.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_scanner.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
@@ -48,6 +52,29 @@
 
 namespace xls {
 
+FunctionBase::~FunctionBase() {
+  // Listeners may unregister themselves (or others) in response.
+  std::vector<ChangeListener*> listeners = std::move(change_listeners_);
+  change_listeners_.clear();
+  for (ChangeListener* listener : listeners) {
+    listener->FunctionBaseDeleted(this);
+  }
+}
+
+const CompactGraph& FunctionBase::compact_graph() const {
+  absl::MutexLock lock(&compact_graph_mutex_);
+  if (compact_graph_ == nullptr) {
+    compact_graph_ = std::make_unique<CompactGraph>(this);
+  }
+  return *compact_graph_;
+}
+
+std::string FunctionBase::DumpIr() const {
+  StringIrSink sink;
+  DumpIrTo(sink);
+  return sink.Release();
+}
+
 std::vector<std::string> FunctionBase::AttributeIrStrings() const {
   std::vector<std::string> attribute_strings;
   if (ForeignFunctionData().has_value()) {
@@ -139,6 +166,10 @@ absl::Status FunctionBase::RemoveNode(Node* node) {
   VLOG(4) << absl::StrFormat("Removing node from FunctionBase %s: %s", name(),
                              node->ToString());
   ++package()->transform_metrics().nodes_removed;
+  InvalidateCompactGraph();
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeDeleted(node);
+  }
   std::vector<Node*> unique_operands;
   for (Node* operand : node->operands()) {
     if (!absl::c_linear_search(unique_operands, operand)) {
@@ -255,6 +286,10 @@ Node* FunctionBase::AddNodeInternal(std::unique_ptr<Node> node) {
   }
   Node* ptr = node.get();
   node_iterators_[ptr] = nodes_.insert(nodes_.end(), std::move(node));
+  InvalidateCompactGraph();
+  for (ChangeListener* listener : change_listeners_) {
+    listener->NodeAdded(ptr);
+  }
   return ptr;
 }
 
@@ -22,18 +22,24 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/iterator_range.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/compact_graph.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/foreign_function_data.pb.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -57,7 +63,7 @@ class FunctionBase {
   FunctionBase(const FunctionBase& other) = delete;
   void operator=(const FunctionBase& other) = delete;
 
-  virtual ~FunctionBase() = default;
+  virtual ~FunctionBase();
 
   Package* package() const { return package_; }
   const std::string& name() const { return name_; }
@@ -75,7 +81,10 @@ class FunctionBase {
   void ClearInitiationInterval() { initiation_interval_ = std::nullopt; }
 
   // DumpIr emits the IR in a parsable, hierarchical text format.
-  virtual std::string DumpIr() const = 0;
+  std::string DumpIr() const;
+
+  // Emits the same text as DumpIr into `sink`.
+  virtual void DumpIrTo(IrSink& sink) const = 0;
 
   // Get FunctionBase attributes suitable for putting in #[...] in the IR.
   std::vector<std::string> AttributeIrStrings() const;
@@ -134,7 +143,9 @@ class FunctionBase {
   absl::StatusOr<NodeT*> MakeNode(Args&&... args) {
     NodeT* new_node = AddNode(std::make_unique<NodeT>(
         std::forward<Args>(args)..., /*name=*/"", this));
-    XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    if (verify_new_nodes_) {
+      XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    }
     return new_node;
   }
 
@@ -143,10 +154,25 @@ class FunctionBase {
   absl::StatusOr<NodeT*> MakeNodeWithName(Args&&... args) {
     NodeT* new_node =
         AddNode(std::make_unique<NodeT>(std::forward<Args>(args)..., this));
-    XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    if (verify_new_nodes_) {
+      XLS_RETURN_IF_ERROR(VerifyNode(new_node));
+    }
     return new_node;
   }
 
+  // Reserves room for `count` more nodes so that adding many nodes at once
+  // (e.g., when cloning) does not repeatedly grow the node index.
+  void ReserveNodes(int64_t count) {
+    node_iterators_.reserve(node_iterators_.size() + count);
+  }
+
+  // Sets whether MakeNode and MakeNodeWithName verify each new node. Only
+  // disable this while copying nodes which were already verified elsewhere,
+  // as Function::Clone does; returns the previous setting.
+  bool SetVerifyNewNodes(bool verify) {
+    return std::exchange(verify_new_nodes_, verify);
+  }
+
   // Find a node by its name, as generated by DumpIr.
   std::optional<Node*> MaybeGetNode(std::string_view standard_node_name) const;
   absl::StatusOr<Node*> GetNode(std::string_view standard_node_name) const;
@@ -201,6 +227,29 @@ class FunctionBase {
     return foreign_function_;
   }
 
+  // Registers `listener` to be notified of node additions, removals and
+  // operand changes in this FunctionBase. The listener is not owned and must
+  // be unregistered before it is destroyed (or outlive this FunctionBase).
+  void RegisterChangeListener(ChangeListener* listener) {
+    change_listeners_.push_back(listener);
+  }
+  void UnregisterChangeListener(ChangeListener* listener) {
+    std::erase(change_listeners_, listener);
+  }
+  absl::Span<ChangeListener* const> change_listeners() const {
+    return change_listeners_;
+  }
+
+  // Returns true if `node` is owned by this FunctionBase.
+  bool HasNode(const Node* node) const { return node_iterators_.contains(node); }
+
+  // Returns an index-based (CSR) snapshot of the nodes and edges of this
+  // FunctionBase for traversal-heavy code. The snapshot is cached and rebuilt
+  // on demand after nodes or edges change; the returned reference is
+  // invalidated by any such change. Safe to call concurrently from multiple
+  // threads as long as the FunctionBase is not being modified.
+  const CompactGraph& compact_graph() const;
+
   template <typename Sink>
   friend void AbslStringify(Sink& sink, const FunctionBase& fb) {
     absl::Format(&sink, "%s", fb.name());
@@ -245,6 +294,24 @@ class FunctionBase {
       NameUniquer(/*separator=*/"__", GetIrReservedWords());
 
   std::optional<xls::ForeignFunctionData> foreign_function_;
+
+  std::vector<ChangeListener*> change_listeners_;
+
+  bool verify_new_nodes_ = true;
+
+ private:
+  friend class Node;
+
+  // Drops the cached compact graph. Called whenever nodes or edges change.
+  void InvalidateCompactGraph() {
+    absl::MutexLock lock(&compact_graph_mutex_);
+    compact_graph_.reset();
+  }
+
+  // Guards lazily building `compact_graph_` from const accessors.
+  mutable absl::Mutex compact_graph_mutex_;
+  mutable std::unique_ptr<CompactGraph> compact_graph_
+      ABSL_GUARDED_BY(compact_graph_mutex_);
 };
 
 std::ostream& operator<<(std::ostream& os, const FunctionBase& function);
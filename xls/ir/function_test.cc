@@ -36,6 +36,7 @@
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 
 namespace xls {
 namespace {
@@ -124,6 +125,39 @@ fn add(x: bits[32], y: bits[32]) -> bits[32] {
   EXPECT_EQ(func_clone->node_count(), 7);
 }
 
+TEST_F(FunctionTest, CloneFunctionWithSparseNodeIds) {
+  auto p = CreatePackage();
+  FunctionBuilder b("f", p.get());
+  BValue x = b.Param("x", p->GetBitsType(32));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, b.BuildWithReturnValue(x));
+  // Interleave the creation of the nodes of `func` with many nodes of another
+  // function so the ids of `func` are spread out.
+  FunctionBuilder other("other", p.get());
+  BValue y = other.Param("y", p->GetBitsType(32));
+  Node* sum = x.node();
+  for (int64_t i = 0; i < 8; ++i) {
+    for (int64_t j = 0; j < 100; ++j) {
+      y = other.Not(y);
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(
+        sum, func->MakeNode<BinOp>(SourceInfo(), sum, x.node(), Op::kAdd));
+  }
+  XLS_ASSERT_OK(other.BuildWithReturnValue(y).status());
+  XLS_ASSERT_OK(func->set_return_value(sum));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func_clone, func->Clone("clone"));
+  EXPECT_TRUE(func->IsDefinitelyEqualTo(func_clone));
+
+  // Nodes added to the clone after cloning are verified as usual.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Literal * narrow,
+      func_clone->MakeNode<Literal>(SourceInfo(), Value(UBits(0, 8))));
+  EXPECT_FALSE(func_clone
+                   ->MakeNode<BinOp>(SourceInfo(), func_clone->return_value(),
+                                     narrow, Op::kAdd)
+                   .ok());
+}
+
 TEST_F(FunctionTest, IsDefinitelyEqualTo) {
   XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(R"(
 package function_is_equal
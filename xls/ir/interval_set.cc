@@ -17,11 +17,14 @@
 #include <algorithm>
 #include <cstdint>
 #include <functional>
+#include <iterator>
+#include <limits>
 #include <list>
 #include <optional>
 #include <string>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
@@ -32,6 +35,64 @@
 #include "xls/ir/interval.h"
 
 namespace xls {
+namespace {
+
+// Interval sets of at most this many bits are normalized, combined and
+// intersected on packed `uint64_t` bounds, which are much cheaper to sort and
+// compare than `Bits`.
+constexpr int64_t kMaxPackedBitCount = 64;
+
+// A proper interval with its inclusive bounds packed into integers.
+struct PackedInterval {
+  uint64_t lower;
+  uint64_t upper;
+
+  friend bool operator<(const PackedInterval& a, const PackedInterval& b) {
+    return a.lower < b.lower || (a.lower == b.lower && a.upper < b.upper);
+  }
+};
+
+uint64_t Pack(const Bits& bits) { return bits.bitmap().GetWord(0); }
+
+uint64_t MaxPacked(int64_t bit_count) {
+  return bit_count == 64 ? std::numeric_limits<uint64_t>::max()
+                         : (uint64_t{1} << bit_count) - 1;
+}
+
+// Appends the packed form of `interval` to `packed`, splitting an improper
+// interval into its two proper pieces.
+void AppendPacked(const Interval& interval, int64_t bit_count,
+                  std::vector<PackedInterval>& packed) {
+  uint64_t lower = Pack(interval.LowerBound());
+  uint64_t upper = Pack(interval.UpperBound());
+  if (lower <= upper) {
+    packed.push_back({.lower = lower, .upper = upper});
+  } else {
+    packed.push_back({.lower = 0, .upper = upper});
+    packed.push_back({.lower = lower, .upper = MaxPacked(bit_count)});
+  }
+}
+
+// Merges the overlapping and abutting intervals of `sorted`, which must be
+// sorted, into `intervals`.
+void MergeSortedPacked(absl::Span<const PackedInterval> sorted,
+                       int64_t bit_count, std::vector<Interval>& intervals) {
+  intervals.clear();
+  for (int64_t i = 0; i < sorted.size();) {
+    PackedInterval merged = sorted[i++];
+    // `merged.upper + 1` can't overflow while the loop continues since
+    // nothing can start after the maximal value.
+    while (i < sorted.size() && merged.upper != MaxPacked(bit_count) &&
+           sorted[i].lower <= merged.upper + 1) {
+      merged.upper = std::max(merged.upper, sorted[i].upper);
+      ++i;
+    }
+    intervals.push_back(Interval(UBits(merged.lower, bit_count),
+                                 UBits(merged.upper, bit_count)));
+  }
+}
+
+}  // namespace
 
 IntervalSet IntervalSet::Maximal(int64_t bit_count) {
   IntervalSet result(bit_count);
@@ -81,6 +142,18 @@ void IntervalSet::Normalize() {
     return;
   }
 
+  if (BitCount() <= kMaxPackedBitCount) {
+    std::vector<PackedInterval> packed;
+    packed.reserve(intervals_.size() + 1);
+    for (const Interval& interval : intervals_) {
+      AppendPacked(interval, BitCount(), packed);
+    }
+    absl::c_sort(packed);
+    MergeSortedPacked(packed, BitCount(), intervals_);
+    is_normalized_ = true;
+    return;
+  }
+
   Bits zero(BitCount());
   Bits max = Bits::AllOnes(BitCount());
   std::vector<Interval> expand_improper;
@@ -222,6 +295,25 @@ IntervalSet IntervalSet::Combine(const IntervalSet& lhs,
                                  const IntervalSet& rhs) {
   CHECK_EQ(lhs.BitCount(), rhs.BitCount());
   IntervalSet combined(lhs.BitCount());
+  if (lhs.BitCount() <= kMaxPackedBitCount && lhs.is_normalized_ &&
+      rhs.is_normalized_) {
+    // Both sides are already sorted so a linear merge replaces the sort.
+    std::vector<PackedInterval> lhs_packed;
+    std::vector<PackedInterval> rhs_packed;
+    lhs_packed.reserve(lhs.intervals_.size());
+    rhs_packed.reserve(rhs.intervals_.size());
+    for (const Interval& interval : lhs.intervals_) {
+      AppendPacked(interval, lhs.BitCount(), lhs_packed);
+    }
+    for (const Interval& interval : rhs.intervals_) {
+      AppendPacked(interval, rhs.BitCount(), rhs_packed);
+    }
+    std::vector<PackedInterval> merged;
+    merged.reserve(lhs_packed.size() + rhs_packed.size());
+    absl::c_merge(lhs_packed, rhs_packed, std::back_inserter(merged));
+    MergeSortedPacked(merged, lhs.BitCount(), combined.intervals_);
+    return combined;
+  }
   for (const Interval& interval : lhs.intervals_) {
     combined.AddInterval(interval);
   }
@@ -238,6 +330,30 @@ IntervalSet IntervalSet::Intersect(const IntervalSet& lhs,
   CHECK(lhs.is_normalized_);
   CHECK(rhs.is_normalized_);
   IntervalSet result(lhs.BitCount());
+  if (lhs.BitCount() <= kMaxPackedBitCount) {
+    // The intersection of two normalized sets is normalized: two points which
+    // are adjacent in both sets are in the same interval of each.
+    auto left = lhs.intervals_.begin();
+    auto right = rhs.intervals_.begin();
+    while (left != lhs.intervals_.end() && right != rhs.intervals_.end()) {
+      uint64_t left_upper = Pack(left->UpperBound());
+      uint64_t right_upper = Pack(right->UpperBound());
+      uint64_t lower =
+          std::max(Pack(left->LowerBound()), Pack(right->LowerBound()));
+      uint64_t upper = std::min(left_upper, right_upper);
+      if (lower <= upper) {
+        result.intervals_.push_back(Interval(UBits(lower, lhs.BitCount()),
+                                             UBits(upper, lhs.BitCount())));
+      }
+      if (left_upper <= right_upper) {
+        ++left;
+      }
+      if (right_upper <= left_upper) {
+        ++right;
+      }
+    }
+    return result;
+  }
   std::list<Interval> lhs_intervals(lhs.Intervals().begin(),
                                     lhs.Intervals().end());
   std::list<Interval> rhs_intervals(rhs.Intervals().begin(),
@@ -18,9 +18,11 @@
 #include <functional>
 #include <limits>
 #include <optional>
+#include <random>
 #include <utility>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
@@ -264,6 +266,49 @@ TEST(IntervalTest, Intersect) {
   }
 }
 
+// Sets of at most 64 bits are operated on in a packed form; check that it
+// agrees with the general implementation used for wider sets.
+void PackedMatchesWide(const IntervalSet& lhs, const IntervalSet& rhs) {
+  constexpr int64_t kWide = 80;
+  IntervalSet wide_lhs = lhs.ZeroExtend(kWide);
+  IntervalSet wide_rhs = rhs.ZeroExtend(kWide);
+  EXPECT_EQ(IntervalSet::Combine(lhs, rhs).ZeroExtend(kWide).Intervals(),
+            IntervalSet::Combine(wide_lhs, wide_rhs).Intervals());
+  EXPECT_EQ(IntervalSet::Intersect(lhs, rhs).ZeroExtend(kWide).Intervals(),
+            IntervalSet::Intersect(wide_lhs, wide_rhs).Intervals());
+}
+FUZZ_TEST(IntervalFuzzTest, PackedMatchesWide)
+    .WithDomains(ArbitraryNormalizedIntervalSet(12),
+                 ArbitraryNormalizedIntervalSet(12));
+
+TEST(IntervalTest, PackedBoundaries) {
+  constexpr uint64_t kMax = std::numeric_limits<uint64_t>::max();
+  IntervalSet x(64);
+  x.AddInterval(MakeInterval(kMax - 1, 1, 64));
+  x.AddInterval(MakeInterval(3, 4, 64));
+  x.AddInterval(MakeInterval(2, 2, 64));
+  x.Normalize();
+  EXPECT_EQ(x.Intervals(),
+            (std::vector<Interval>{MakeInterval(0, 4, 64),
+                                   MakeInterval(kMax - 1, kMax, 64)}));
+
+  IntervalSet y(64);
+  y.AddInterval(MakeInterval(4, kMax - 1, 64));
+  y.Normalize();
+  EXPECT_EQ(IntervalSet::Combine(x, y).Intervals(),
+            (std::vector<Interval>{MakeInterval(0, kMax, 64)}));
+  EXPECT_EQ(IntervalSet::Intersect(x, y).Intervals(),
+            (std::vector<Interval>{MakeInterval(4, 4, 64),
+                                   MakeInterval(kMax - 1, kMax - 1, 64)}));
+
+  IntervalSet zero_width(0);
+  zero_width.AddInterval(MakeInterval(0, 0, 0));
+  zero_width.AddInterval(MakeInterval(0, 0, 0));
+  zero_width.Normalize();
+  EXPECT_EQ(zero_width.Intervals(),
+            (std::vector<Interval>{MakeInterval(0, 0, 0)}));
+}
+
 TEST(IntervalTest, Size) {
   IntervalSet example(32);
   example.AddInterval(MakeInterval(5, 10, 32));
@@ -597,5 +642,54 @@ FUZZ_TEST(IntervalFuzzTest, DisjointEquivalentToEmptyIntersection)
     .WithDomains(ArbitraryNormalizedIntervalSet(32),
                  ArbitraryNormalizedIntervalSet(32));
 
+// Builds a set of `count` overlapping, unsorted 32-bit intervals.
+IntervalSet MakeUnnormalizedIntervalSet(int64_t count, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::uniform_int_distribution<uint64_t> start(0, uint64_t{1} << 31);
+  std::uniform_int_distribution<uint64_t> length(0, uint64_t{1} << 24);
+  IntervalSet set(32);
+  for (int64_t i = 0; i < count; ++i) {
+    uint64_t lo = start(rng);
+    set.AddInterval(MakeInterval(lo, lo + length(rng), 32));
+  }
+  return set;
+}
+
+// Includes the cost of copying the unnormalized set.
+void BM_Normalize(benchmark::State& state) {
+  IntervalSet unnormalized =
+      MakeUnnormalizedIntervalSet(state.range(0), /*seed=*/0);
+  for (auto _ : state) {
+    IntervalSet set = unnormalized;
+    set.Normalize();
+    benchmark::DoNotOptimize(set);
+  }
+}
+BENCHMARK(BM_Normalize)->Range(1, 1 << 12);
+
+void BM_Combine(benchmark::State& state) {
+  IntervalSet lhs = MakeUnnormalizedIntervalSet(state.range(0), /*seed=*/0);
+  IntervalSet rhs = MakeUnnormalizedIntervalSet(state.range(0), /*seed=*/1);
+  lhs.Normalize();
+  rhs.Normalize();
+  for (auto _ : state) {
+    IntervalSet set = IntervalSet::Combine(lhs, rhs);
+    benchmark::DoNotOptimize(set);
+  }
+}
+BENCHMARK(BM_Combine)->Range(1, 1 << 12);
+
+void BM_Intersect(benchmark::State& state) {
+  IntervalSet lhs = MakeUnnormalizedIntervalSet(state.range(0), /*seed=*/0);
+  IntervalSet rhs = MakeUnnormalizedIntervalSet(state.range(0), /*seed=*/1);
+  lhs.Normalize();
+  rhs.Normalize();
+  for (auto _ : state) {
+    IntervalSet set = IntervalSet::Intersect(lhs, rhs);
+    benchmark::DoNotOptimize(set);
+  }
+}
+BENCHMARK(BM_Intersect)->Range(1, 1 << 12);
+
 }  // namespace
 }  // namespace xls
@@ -14,6 +14,7 @@
 
 #include "xls/ir/ir_parser.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <initializer_list>
@@ -42,6 +43,7 @@
 #include "google/protobuf/text_format.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/common/visitor.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -2178,8 +2180,8 @@ absl::Status Parser::ParseFileNumber(Package* package,
   return absl::OkStatus();
 }
 
-absl::StatusOr<Function*> Parser::ParseFunction(
-    Package* package, const DeclAttributes& attributes) {
+absl::StatusOr<Parser::ParsedFunction> Parser::ParseFunctionDefinition(
+    Package* package) {
   if (AtEof()) {
     return absl::InvalidArgumentError("Could not parse function; at EOF.");
   }
@@ -2205,12 +2207,18 @@ absl::StatusOr<Function*> Parser::ParseFunction(
         return_value.node()->GetType()->ToString(),
         function_data.second->ToString()));
   }
+  return ParsedFunction{.builder = std::move(function_data.first),
+                        .return_value = return_value};
+}
 
+/* static */ absl::StatusOr<Function*> Parser::BuildFunction(
+    ParsedFunction parsed, const DeclAttributes& attributes) {
   // TODO(leary): 2019-02-19 Could be an empty function body, need to decide
   // what to do for those. Accept that the return value can be null and handle
   // everywhere?
-  XLS_ASSIGN_OR_RETURN(Function * result,
-                       fb->BuildWithReturnValue(return_value));
+  XLS_ASSIGN_OR_RETURN(
+      Function * result,
+      parsed.builder->BuildWithReturnValue(parsed.return_value));
 
   for (const auto& [attribute, literal] : attributes) {
     if (attribute == "initiation_interval") {
@@ -2233,8 +2241,14 @@ absl::StatusOr<Function*> Parser::ParseFunction(
   return result;
 }
 
-absl::StatusOr<Proc*> Parser::ParseProc(Package* package,
-                                        const DeclAttributes& attributes) {
+absl::StatusOr<Function*> Parser::ParseFunction(
+    Package* package, const DeclAttributes& attributes) {
+  XLS_ASSIGN_OR_RETURN(ParsedFunction parsed, ParseFunctionDefinition(package));
+  return BuildFunction(std::move(parsed), attributes);
+}
+
+absl::StatusOr<Parser::ParsedProc> Parser::ParseProcDefinition(
+    Package* package) {
   if (AtEof()) {
     return absl::InvalidArgumentError("Could not parse proc; at EOF.");
   }
@@ -2248,9 +2262,14 @@ absl::StatusOr<Proc*> Parser::ParseProc(Package* package,
                        ParseBody(pb.get(), &name_to_value, package));
 
   XLS_RET_CHECK(std::holds_alternative<ProcNext>(body_result));
-  ProcNext proc_next = std::get<ProcNext>(body_result);
+  return ParsedProc{
+      .builder = std::move(pb),
+      .next_state = std::move(std::get<ProcNext>(body_result).next_state)};
+}
 
-  XLS_ASSIGN_OR_RETURN(Proc * result, pb->Build(proc_next.next_state));
+/* static */ absl::StatusOr<Proc*> Parser::BuildProc(
+    ParsedProc parsed, const DeclAttributes& attributes) {
+  XLS_ASSIGN_OR_RETURN(Proc * result, parsed.builder->Build(parsed.next_state));
 
   for (const auto& [attribute, literal] : attributes) {
     if (attribute == "initiation_interval") {
@@ -2265,16 +2284,14 @@ absl::StatusOr<Proc*> Parser::ParseProc(Package* package,
   return result;
 }
 
-absl::StatusOr<Block*> Parser::ParseBlock(Package* package,
-                                          const DeclAttributes& attributes) {
-  for (const auto& [attribute, token] : attributes) {
-    if (attribute == "initiation_interval") {
-      continue;
-    }
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Attribute %s is not supported on blocks.", attribute));
-  }
+absl::StatusOr<Proc*> Parser::ParseProc(Package* package,
+                                        const DeclAttributes& attributes) {
+  XLS_ASSIGN_OR_RETURN(ParsedProc parsed, ParseProcDefinition(package));
+  return BuildProc(std::move(parsed), attributes);
+}
 
+absl::StatusOr<Parser::ParsedBlock> Parser::ParseBlockDefinition(
+    Package* package) {
   if (AtEof()) {
     return absl::InvalidArgumentError("Could not parse block; at EOF.");
   }
@@ -2290,8 +2307,22 @@ absl::StatusOr<Block*> Parser::ParseBlock(Package* package,
   XLS_ASSIGN_OR_RETURN(BodyResult body_result,
                        ParseBody(bb.get(), &name_to_value, package));
   XLS_RET_CHECK(std::holds_alternative<BValue>(body_result));
+  return ParsedBlock{.builder = std::move(bb),
+                     .signature = std::move(signature)};
+}
+
+/* static */ absl::StatusOr<Block*> Parser::BuildBlock(
+    ParsedBlock parsed, const DeclAttributes& attributes) {
+  for (const auto& [attribute, token] : attributes) {
+    if (attribute == "initiation_interval") {
+      continue;
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Attribute %s is not supported on blocks.", attribute));
+  }
 
-  XLS_ASSIGN_OR_RETURN(Block * block, bb->Build());
+  XLS_ASSIGN_OR_RETURN(Block * block, parsed.builder->Build());
+  const BlockSignature& signature = parsed.signature;
 
   // Verify the ports in the signature match one-to-one to input_ports and
   // output_ports.
@@ -2353,6 +2384,114 @@ absl::StatusOr<Block*> Parser::ParseBlock(Package* package,
   return block;
 }
 
+absl::StatusOr<Block*> Parser::ParseBlock(Package* package,
+                                          const DeclAttributes& attributes) {
+  XLS_ASSIGN_OR_RETURN(ParsedBlock parsed, ParseBlockDefinition(package));
+  return BuildBlock(std::move(parsed), attributes);
+}
+
+absl::StatusOr<Parser::ParsedFunctionBase> Parser::ParseFunctionBaseDefinition(
+    Package* package) {
+  XLS_ASSIGN_OR_RETURN(Token peek, scanner_.PeekToken());
+  if (peek.type() == LexicalTokenType::kKeyword) {
+    if (peek.value() == "fn") {
+      return ParseFunctionDefinition(package);
+    }
+    if (peek.value() == "proc") {
+      return ParseProcDefinition(package);
+    }
+    if (peek.value() == "block") {
+      return ParseBlockDefinition(package);
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
+                      peek.value(), peek.pos().ToHumanString()));
+}
+
+/* static */ absl::StatusOr<FunctionBase*> Parser::BuildFunctionBase(
+    ParsedFunctionBase parsed, const DeclAttributes& attributes) {
+  return absl::visit(
+      Visitor{[&](ParsedFunction& f) -> absl::StatusOr<FunctionBase*> {
+                return BuildFunction(std::move(f), attributes);
+              },
+              [&](ParsedProc& p) -> absl::StatusOr<FunctionBase*> {
+                return BuildProc(std::move(p), attributes);
+              },
+              [&](ParsedBlock& b) -> absl::StatusOr<FunctionBase*> {
+                return BuildBlock(std::move(b), attributes);
+              }},
+      parsed);
+}
+
+absl::StatusOr<std::optional<Token>> Parser::MaybeParseTop() {
+  if (!scanner_.TryDropKeyword("top")) {
+    return std::nullopt;
+  }
+  return scanner_.PeekToken();
+}
+
+/* static */ absl::Status Parser::CheckTopDeclaration(
+    Package* package, const Token& top_token,
+    std::optional<Token>& previous_top_token) {
+  if (package->HasTop() && previous_top_token.has_value()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Top declared more than once, previous declaration @ %s",
+        previous_top_token.value().pos().ToHumanString()));
+  }
+  previous_top_token = top_token;
+  return absl::OkStatus();
+}
+
+absl::Status Parser::ParseDeclaration(
+    Package* package, std::string_view filename,
+    std::optional<Token>& previous_top_token) {
+  XLS_ASSIGN_OR_RETURN(DeclAttributes attributes, MaybeParseAttributes());
+
+  // The fn, proc or block is a top entity.
+  XLS_ASSIGN_OR_RETURN(std::optional<Token> top_token, MaybeParseTop());
+  if (top_token.has_value()) {
+    XLS_RETURN_IF_ERROR(
+        CheckTopDeclaration(package, *top_token, previous_top_token));
+  }
+  XLS_ASSIGN_OR_RETURN(Token peek, scanner_.PeekToken());
+  if (peek.type() == LexicalTokenType::kKeyword &&
+      (peek.value() == "fn" || peek.value() == "proc" ||
+       peek.value() == "block")) {
+    XLS_ASSIGN_OR_RETURN(ParsedFunctionBase parsed,
+                         ParseFunctionBaseDefinition(package),
+                         _ << "@ " << filename);
+    XLS_ASSIGN_OR_RETURN(FunctionBase * function_base,
+                         BuildFunctionBase(std::move(parsed), attributes),
+                         _ << "@ " << filename);
+    if (top_token.has_value()) {
+      XLS_RETURN_IF_ERROR(package->SetTop(function_base));
+    }
+    return absl::OkStatus();
+  }
+  if (top_token.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
+                        peek.value(), peek.pos().ToHumanString()));
+  }
+  if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
+    XLS_RETURN_IF_ERROR(ParseChannel(package, attributes).status())
+        << "@ " << filename;
+    return absl::OkStatus();
+  }
+  if (peek.type() == LexicalTokenType::kKeyword &&
+      peek.value() == "file_number") {
+    XLS_RETURN_IF_ERROR(ParseFileNumber(package, attributes))
+        << "@ " << filename;
+    return absl::OkStatus();
+  }
+  return absl::InvalidArgumentError(
+      absl::StrFormat("Expected attribute or declaration "
+                      "(`fn`, `proc`, `block`, `chan`, `file_number`), "
+                      "got %s @ %s",
+                      peek.value(), peek.pos().ToHumanString()));
+}
+
 absl::StatusOr<Channel*> Parser::ParseChannel(Package* package,
                                               const DeclAttributes& attributes,
                                               Proc* proc) {
@@ -2731,6 +2870,264 @@ static absl::Status VerifyAndSwapError(Package* package) {
   return package;
 }
 
+namespace {
+
+// A top-level declaration of a package as found by ScanDeclarations.
+struct Declaration {
+  // The tokens of the declaration, including any leading attributes, are
+  // [begin, end).
+  int64_t begin;
+  int64_t end;
+  // Whether this is a function, block or proc without proc-scoped channels.
+  // Parsing these only reads the package, so they are parsed concurrently.
+  bool concurrent = false;
+  // Index of the last earlier declaration whose name appears among the tokens
+  // of this one, or -1. The declaration is parsed only after that one has been
+  // added to the package.
+  int64_t dependency = -1;
+};
+
+bool IsKeyword(const Token& token, std::string_view keyword) {
+  return token.type() == LexicalTokenType::kKeyword && token.value() == keyword;
+}
+
+// Splits tokens[begin:] into top-level declarations without parsing them. A
+// declaration extends up to the next attribute or `top`, `fn`, `proc`,
+// `block`, `chan` or `file_number` keyword outside of any brackets which
+// follows its own declaration keyword.
+std::vector<Declaration> ScanDeclarations(absl::Span<const Token> tokens,
+                                          int64_t begin) {
+  std::vector<Declaration> declarations;
+  // The index of the last declaration with each name, excluding the current
+  // declaration.
+  absl::flat_hash_map<std::string_view, int64_t> declaration_index;
+  std::optional<std::string_view> name;
+  bool seen_keyword = false;
+  int64_t depth = 0;
+  for (int64_t i = begin; i < tokens.size(); ++i) {
+    const Token& token = tokens[i];
+    bool is_declaration_keyword =
+        depth == 0 &&
+        (IsKeyword(token, "fn") || IsKeyword(token, "proc") ||
+         IsKeyword(token, "block") || IsKeyword(token, "chan") ||
+         IsKeyword(token, "file_number"));
+    bool starts_declaration =
+        is_declaration_keyword ||
+        (depth == 0 && (IsKeyword(token, "top") ||
+                        token.type() == LexicalTokenType::kHash));
+    if (declarations.empty() || (seen_keyword && starts_declaration)) {
+      if (!declarations.empty()) {
+        declarations.back().end = i;
+      }
+      if (name.has_value()) {
+        declaration_index[*name] = declarations.size() - 1;
+      }
+      declarations.push_back(Declaration{
+          .begin = i, .end = static_cast<int64_t>(tokens.size())});
+      name = std::nullopt;
+      seen_keyword = false;
+    }
+    Declaration& declaration = declarations.back();
+    switch (token.type()) {
+      case LexicalTokenType::kParenOpen:
+      case LexicalTokenType::kBracketOpen:
+      case LexicalTokenType::kCurlOpen:
+        ++depth;
+        break;
+      case LexicalTokenType::kParenClose:
+      case LexicalTokenType::kBracketClose:
+      case LexicalTokenType::kCurlClose:
+        --depth;
+        break;
+      case LexicalTokenType::kIdent: {
+        auto it = declaration_index.find(token.value());
+        if (it != declaration_index.end()) {
+          declaration.dependency = std::max(declaration.dependency, it->second);
+        }
+        break;
+      }
+      default:
+        if (is_declaration_keyword && !seen_keyword) {
+          seen_keyword = true;
+          bool has_name = i + 1 < tokens.size() &&
+                          tokens[i + 1].type() == LexicalTokenType::kIdent;
+          if (has_name) {
+            name = tokens[i + 1].value();
+          }
+          bool new_style_proc = i + 2 < tokens.size() &&
+                                tokens[i + 2].type() == LexicalTokenType::kLt;
+          declaration.concurrent =
+              has_name &&
+              (IsKeyword(token, "fn") || IsKeyword(token, "block") ||
+               (IsKeyword(token, "proc") && !new_style_proc));
+        }
+        break;
+    }
+  }
+  return declarations;
+}
+
+// Node ids handed out while parsing declaration `i` concurrently lie in
+// [ConcurrentNodeIdBase(i), ConcurrentNodeIdBase(i + 1)), far above any id a
+// package would otherwise reach.
+int64_t ConcurrentNodeIdBase(int64_t i) {
+  return (int64_t{1} << 48) + i * (int64_t{1} << 32);
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<Package>>
+Parser::ParsePackageConcurrentlyNoVerify(std::string_view input_string,
+                                         ThreadPool& thread_pool,
+                                         std::string_view filename) {
+  XLS_ASSIGN_OR_RETURN(std::vector<Token> tokens, TokenizeString(input_string));
+  // The package name declaration is the first two tokens.
+  int64_t header_size = std::min<int64_t>(tokens.size(), 2);
+  Parser header(Scanner(
+      std::vector<Token>(tokens.begin(), tokens.begin() + header_size)));
+  XLS_ASSIGN_OR_RETURN(std::string package_name, header.ParsePackageName());
+  auto package = std::make_unique<Package>(package_name);
+  std::vector<Declaration> declarations = ScanDeclarations(tokens, header_size);
+  auto declaration_parser = [&](const Declaration& declaration) {
+    return Parser(Scanner(std::vector<Token>(
+        tokens.begin() + declaration.begin, tokens.begin() + declaration.end)));
+  };
+
+  // A declaration parsed on the thread pool. Each is only accessed by the
+  // thread parsing it until the thread pool is idle.
+  struct ConcurrentParse {
+    DeclAttributes attributes;
+    std::optional<Token> top_token;
+    absl::StatusOr<ParsedFunctionBase> parsed;
+    std::vector<internal::PackageThreadState::NodeIdEvent> node_id_log;
+    TransformMetrics transform_metrics;
+  };
+  std::vector<std::optional<ConcurrentParse>> parses(declarations.size());
+  auto parse_concurrently = [&](int64_t i) {
+    ConcurrentParse& parse = *parses[i];
+    internal::PackageThreadState state{
+        .package = package.get(),
+        .next_node_id = ConcurrentNodeIdBase(i),
+        .transform_metrics = TransformMetrics(),
+        .node_id_log = &parse.node_id_log};
+    Package::thread_state_ = &state;
+    parse.parsed = [&]() -> absl::StatusOr<ParsedFunctionBase> {
+      Parser parser = declaration_parser(declarations[i]);
+      XLS_ASSIGN_OR_RETURN(parse.attributes, parser.MaybeParseAttributes());
+      XLS_ASSIGN_OR_RETURN(parse.top_token, parser.MaybeParseTop());
+      XLS_ASSIGN_OR_RETURN(ParsedFunctionBase parsed,
+                           parser.ParseFunctionBaseDefinition(package.get()));
+      if (!parser.AtEof()) {
+        return absl::InvalidArgumentError(
+            "Unexpected tokens after function base definition");
+      }
+      return parsed;
+    }();
+    Package::thread_state_ = nullptr;
+    parse.transform_metrics = state.transform_metrics;
+  };
+
+  // Adds concurrently parsed declaration `i` to the package, first renumbering
+  // its nodes and advancing the node id counter exactly as a serial parse
+  // would have.
+  auto build = [&](int64_t i,
+                   std::optional<Token>& previous_top_token) -> absl::Status {
+    ConcurrentParse& parse = *parses[i];
+    XLS_RETURN_IF_ERROR(parse.parsed.status());
+    int64_t base = ConcurrentNodeIdBase(i);
+    std::vector<int64_t> allocated_ids;
+    auto serial_id = [&](int64_t id) {
+      return (id >= base && id - base < allocated_ids.size())
+                 ? allocated_ids[id - base]
+                 : id;
+    };
+    for (const internal::PackageThreadState::NodeIdEvent& event :
+         parse.node_id_log) {
+      if (event.allocated) {
+        allocated_ids.push_back(package->GetNextNodeIdAndIncrement());
+      } else {
+        package->ReserveNodeId(serial_id(event.id));
+      }
+    }
+    FunctionBase* function_base =
+        absl::visit([](auto& parsed) -> FunctionBase* {
+          return parsed.builder->function();
+        }, *parse.parsed);
+    for (Node* node : function_base->nodes()) {
+      int64_t id = serial_id(node->id());
+      if (id != node->id()) {
+        node->SetId(id);
+      }
+    }
+    package->transform_metrics_ =
+        package->transform_metrics_ + parse.transform_metrics;
+
+    if (parse.top_token.has_value()) {
+      XLS_RETURN_IF_ERROR(CheckTopDeclaration(
+          package.get(), *parse.top_token, previous_top_token));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        function_base,
+        BuildFunctionBase(*std::move(parse.parsed), parse.attributes));
+    if (parse.top_token.has_value()) {
+      XLS_RETURN_IF_ERROR(package->SetTop(function_base));
+    }
+    return absl::OkStatus();
+  };
+
+  // Declarations before `built` have been added to the package. Each round
+  // parses every declaration whose dependency has been built on the thread
+  // pool, then builds declarations in order for as long as they are parsed;
+  // declarations which are not parsed concurrently are parsed in place.
+  std::optional<Token> previous_top_token;
+  int64_t built = 0;
+  while (built < declarations.size()) {
+    for (int64_t i = built; i < declarations.size(); ++i) {
+      if (declarations[i].concurrent && !parses[i].has_value() &&
+          declarations[i].dependency < built) {
+        parses[i].emplace();
+        thread_pool.Schedule(
+            [&parse_concurrently, i] { parse_concurrently(i); });
+      }
+    }
+    thread_pool.WaitForIdle();
+    for (; built < declarations.size(); ++built) {
+      if (declarations[built].concurrent) {
+        if (!parses[built].has_value()) {
+          break;
+        }
+        XLS_RETURN_IF_ERROR(build(built, previous_top_token));
+        continue;
+      }
+      Parser parser = declaration_parser(declarations[built]);
+      XLS_RETURN_IF_ERROR(parser.ParseDeclaration(package.get(), filename,
+                                                  previous_top_token));
+      if (!parser.AtEof()) {
+        return absl::InvalidArgumentError(
+            "Unexpected tokens after declaration");
+      }
+    }
+  }
+  SetUnassignedNodeIds(package.get());
+  return package;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<Package>>
+Parser::ParsePackageConcurrently(std::string_view input_string,
+                                 ThreadPool& thread_pool,
+                                 std::optional<std::string_view> filename) {
+  absl::StatusOr<std::unique_ptr<Package>> package =
+      ParsePackageConcurrentlyNoVerify(input_string, thread_pool,
+                                       filename.value_or("<unknown file>"));
+  if (!package.ok()) {
+    // Errors are reported exactly as by the serial parser, which also covers
+    // malformed input which the declaration pre-scan splits differently.
+    return ParsePackage(input_string, filename);
+  }
+  XLS_RETURN_IF_ERROR(VerifyAndSwapError(package->get()));
+  return package;
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<Package>>
 Parser::ParsePackageWithEntry(std::string_view input_string,
                               std::string_view entry,
@@ -38,6 +38,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function.h"
@@ -68,6 +69,14 @@ class Parser {
       std::string_view input_string,
       std::optional<std::string_view> filename = std::nullopt);
 
+  // As above, but the functions, procs and blocks of the package are parsed
+  // concurrently on `thread_pool` where their dependencies allow. The returned
+  // package, including its node ids, is the same as ParsePackage returns, as
+  // are any errors.
+  static absl::StatusOr<std::unique_ptr<Package>> ParsePackageConcurrently(
+      std::string_view input_string, ThreadPool& thread_pool,
+      std::optional<std::string_view> filename = std::nullopt);
+
   // As above, but sets the entry function to be the given name in the returned
   // package.
   static absl::StatusOr<std::unique_ptr<Package>> ParsePackageWithEntry(
@@ -150,6 +159,28 @@ class Parser {
   absl::StatusOr<Block*> ParseBlock(Package* package,
                                     const DeclAttributes& attributes = {});
 
+  // Parses one top-level declaration of a package (a function, proc, block,
+  // channel or file number along with any attributes) into `package`.
+  // `previous_top_token` holds the declaration (if any) previously marked
+  // `top`.
+  absl::Status ParseDeclaration(Package* package, std::string_view filename,
+                                std::optional<Token>& previous_top_token);
+
+  // Pops a `top` keyword if present, returning the token which follows it.
+  absl::StatusOr<std::optional<Token>> MaybeParseTop();
+
+  // Returns an error if `package` already has a top which was declared in the
+  // IR text, otherwise records `top_token` as the top declaration.
+  static absl::Status CheckTopDeclaration(
+      Package* package, const Token& top_token,
+      std::optional<Token>& previous_top_token);
+
+  // Implements ParsePackageConcurrently, before verification.
+  static absl::StatusOr<std::unique_ptr<Package>>
+  ParsePackageConcurrentlyNoVerify(std::string_view input_string,
+                                   ThreadPool& thread_pool,
+                                   std::string_view filename);
+
   // Parse a channel starting at the current scanner position. If `proc` is not
   // null then this is a proc-scoped channel.
   absl::StatusOr<Channel*> ParseChannel(Package* package,
@@ -314,6 +345,43 @@ class Parser {
   };
   absl::StatusOr<BlockSignature> ParseBlockSignature(Package* package);
 
+  // A function, proc or block which has been parsed but not yet built, ie,
+  // not yet added to the package. Parsing only reads the package (apart from
+  // node ids and type creation) so definitions may be parsed concurrently,
+  // while building must happen in declaration order.
+  struct ParsedFunction {
+    std::unique_ptr<FunctionBuilder> builder;
+    BValue return_value;
+  };
+  struct ParsedProc {
+    std::unique_ptr<ProcBuilder> builder;
+    std::vector<BValue> next_state;
+  };
+  struct ParsedBlock {
+    std::unique_ptr<BlockBuilder> builder;
+    BlockSignature signature;
+  };
+  using ParsedFunctionBase =
+      std::variant<ParsedFunction, ParsedProc, ParsedBlock>;
+
+  // Parses a function, proc or block definition starting at its `fn`, `proc`
+  // or `block` keyword.
+  absl::StatusOr<ParsedFunctionBase> ParseFunctionBaseDefinition(
+      Package* package);
+  absl::StatusOr<ParsedFunction> ParseFunctionDefinition(Package* package);
+  absl::StatusOr<ParsedProc> ParseProcDefinition(Package* package);
+  absl::StatusOr<ParsedBlock> ParseBlockDefinition(Package* package);
+
+  // Adds the parsed definition to the package and applies `attributes`.
+  static absl::StatusOr<FunctionBase*> BuildFunctionBase(
+      ParsedFunctionBase parsed, const DeclAttributes& attributes);
+  static absl::StatusOr<Function*> BuildFunction(
+      ParsedFunction parsed, const DeclAttributes& attributes);
+  static absl::StatusOr<Proc*> BuildProc(ParsedProc parsed,
+                                         const DeclAttributes& attributes);
+  static absl::StatusOr<Block*> BuildBlock(ParsedBlock parsed,
+                                           const DeclAttributes& attributes);
+
   // Pops the package name out of the scanner, of the form:
   //
   //  "package" <name>
@@ -353,73 +421,8 @@ absl::StatusOr<std::unique_ptr<PackageT>> Parser::ParseDerivedPackageNoVerify(
   std::string filename_str =
       (filename.has_value() ? std::string(filename.value()) : "<unknown file>");
   while (!parser.AtEof()) {
-    XLS_ASSIGN_OR_RETURN(DeclAttributes attributes,
-                         parser.MaybeParseAttributes());
-
-    XLS_ASSIGN_OR_RETURN(Token peek, parser.scanner_.PeekToken());
-
-    bool is_top = false;
-    // The fn, proc or block is a top entity.
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "top") {
-      is_top = true;
-      XLS_RETURN_IF_ERROR(parser.scanner_.DropKeywordOrError("top"));
-      XLS_ASSIGN_OR_RETURN(peek, parser.scanner_.PeekToken());
-      if (package.get()->HasTop() && previous_top_token.has_value()) {
-        return absl::InvalidArgumentError(absl::StrFormat(
-            "Top declared more than once, previous declaration @ %s",
-            previous_top_token.value().pos().ToHumanString()));
-      }
-      previous_top_token = peek;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "fn") {
-      XLS_ASSIGN_OR_RETURN(Function * fn,
-                           parser.ParseFunction(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(fn));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "proc") {
-      XLS_ASSIGN_OR_RETURN(Proc * proc,
-                           parser.ParseProc(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(proc));
-      }
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "block") {
-      XLS_ASSIGN_OR_RETURN(Block * block,
-                           parser.ParseBlock(package.get(), attributes),
-                           _ << "@ " << filename_str);
-      if (is_top) {
-        XLS_RETURN_IF_ERROR(package->SetTop(block));
-      }
-      continue;
-    }
-    if (is_top) {
-      return absl::InvalidArgumentError(
-          absl::StrFormat("Expected fn, proc or block definition, got %s @ %s",
-                          peek.value(), peek.pos().ToHumanString()));
-    }
-    if (peek.type() == LexicalTokenType::kKeyword && peek.value() == "chan") {
-      XLS_RETURN_IF_ERROR(
-          parser.ParseChannel(package.get(), attributes).status())
-          << "@ " << filename_str;
-      continue;
-    }
-    if (peek.type() == LexicalTokenType::kKeyword &&
-        peek.value() == "file_number") {
-      XLS_RETURN_IF_ERROR(parser.ParseFileNumber(package.get(), attributes))
-          << "@ " << filename_str;
-      continue;
-    }
-    return absl::InvalidArgumentError(
-        absl::StrFormat("Expected attribute or declaration "
-                        "(`fn`, `proc`, `block`, `chan`, `file_number`), "
-                        "got %s @ %s",
-                        peek.value(), peek.pos().ToHumanString()));
+    XLS_RETURN_IF_ERROR(parser.ParseDeclaration(package.get(), filename_str,
+                                                previous_top_token));
   }
 
   // Verify the given entry function exists in the package.
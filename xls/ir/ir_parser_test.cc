@@ -24,10 +24,12 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/str_replace.h"
 #include "absl/strings/substitute.h"
 #include "xls/common/casts.h"
 #include "xls/common/source_location.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
@@ -1051,4 +1053,73 @@ top proc my_proc<>() {
   EXPECT_TRUE(pkg->ChannelsAreProcScoped());
 }
 
+constexpr std::string_view kConcurrentParseInput = R"(package test
+
+file_number 0 "fake.x"
+
+chan hbo(bits[32], id=0, kind=streaming, flow_control=none, ops=receive_only,
+            metadata="")
+chan mtv(bits[32], id=1, kind=streaming, flow_control=none, ops=send_only,
+            metadata="")
+
+fn add_one(x: bits[32] id=7) -> bits[32] {
+  one: bits[32] = literal(value=1, id=8)
+  ret add.9: bits[32] = add(x, one, pos=[(0, 1, 2)])
+}
+
+fn unnumbered(a: bits[32], b: bits[32]) -> bits[32] {
+  sum: bits[32] = add(a, b)
+  ret result: bits[32] = invoke(sum, to_apply=add_one)
+}
+
+#[initiation_interval(2)]
+proc my_proc(my_token: token, my_state: bits[32], init={token, 42}) {
+  receive.1: (token, bits[32]) = receive(my_token, channel=hbo)
+  tuple_index.2: token = tuple_index(receive.1, index=0, id=2)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1, id=3)
+  add.4: bits[32] = invoke(tuple_index.3, to_apply=unnumbered2)
+  send.5: token = send(tuple_index.2, add.4, channel=mtv)
+  next (send.5, add.4)
+}
+
+fn unnumbered2(a: bits[32]) -> bits[32] {
+  ret neg: bits[32] = neg(a)
+}
+
+proc new_style<>() {
+}
+
+top block my_block(in: bits[32], out: bits[32]) {
+  in: bits[32] = input_port(name=in)
+  out: () = output_port(in, name=out)
+}
+)";
+
+TEST(IrParserTest, ParsePackageConcurrentlyMatchesSerialParse) {
+  // `my_proc` invokes a function declared after it, which the serial parser
+  // rejects.
+  std::string input(kConcurrentParseInput);
+  absl::StrReplaceAll({{"to_apply=unnumbered2", "to_apply=unnumbered"}},
+                      &input);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> serial,
+                           Parser::ParsePackage(input));
+  ThreadPool thread_pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Package> concurrent,
+      Parser::ParsePackageConcurrently(input, thread_pool));
+  EXPECT_EQ(concurrent->DumpIr(), serial->DumpIr());
+  EXPECT_EQ(concurrent->next_node_id(), serial->next_node_id());
+}
+
+TEST(IrParserTest, ParsePackageConcurrentlyReportsSerialErrors) {
+  ThreadPool thread_pool(4);
+  absl::Status serial = Parser::ParsePackage(kConcurrentParseInput).status();
+  EXPECT_THAT(serial, StatusIs(absl::StatusCode::kNotFound,
+                               HasSubstr("unnumbered2")));
+  EXPECT_EQ(
+      Parser::ParsePackageConcurrently(kConcurrentParseInput, thread_pool)
+          .status(),
+      serial);
+}
+
 }  // namespace xls
@@ -19,6 +19,7 @@
 #include <ostream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/base/no_destructor.h"
@@ -140,6 +141,9 @@ class Scanner {
  public:
   static absl::StatusOr<Scanner> Create(std::string_view text);
 
+  // Creates a scanner over already tokenized text.
+  explicit Scanner(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
   // Peeks at the next token in the token stream, or returns an error if we're
   // at EOF and no more tokens are available.
   absl::StatusOr<Token> PeekToken() const;
@@ -220,8 +224,6 @@ class Scanner {
   bool AtEof() const { return token_idx_ >= tokens_.size(); }
 
  private:
-  explicit Scanner(std::vector<Token> tokens) : tokens_(tokens) {}
-
   int64_t token_idx_ = 0;
   std::vector<Token> tokens_;
 };
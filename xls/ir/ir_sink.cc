@@ -0,0 +1,92 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/ir_sink.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string_view>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+
+namespace xls {
+
+void IrSink::Flush() {
+  if (status_.ok()) {
+    status_ = Write(buffer_);
+  }
+  // Keep the allocation for the next chunk.
+  buffer_.clear();
+}
+
+absl::Status IrSink::Finish() {
+  if (!buffer_.empty()) {
+    Flush();
+  }
+  return status_;
+}
+
+absl::Status CordIrSink::Write(std::string_view text) {
+  cord_->Append(text);
+  return absl::OkStatus();
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<FileIrSink>> FileIrSink::Open(
+    const std::filesystem::path& path, int64_t buffer_size) {
+  std::FILE* file = std::fopen(path.c_str(), "w");
+  if (file == nullptr) {
+    return absl::ErrnoToStatus(
+        errno, absl::StrCat("Failed to open file ", path.string()));
+  }
+  return absl::WrapUnique(new FileIrSink(path, file, buffer_size));
+}
+
+FileIrSink::~FileIrSink() {
+  if (file_ != nullptr) {
+    std::fclose(file_);
+  }
+}
+
+absl::Status FileIrSink::Write(std::string_view text) {
+  if (file_ == nullptr) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("File ", path_.string(), " is already closed"));
+  }
+  if (std::fwrite(text.data(), 1, text.size(), file_) != text.size()) {
+    return absl::ErrnoToStatus(
+        errno, absl::StrCat("Failed to write to file ", path_.string()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status FileIrSink::Finish() {
+  absl::Status status = IrSink::Finish();
+  if (file_ != nullptr) {
+    if (std::fclose(file_) != 0 && status.ok()) {
+      status = absl::ErrnoToStatus(
+          errno, absl::StrCat("Failed to close file ", path_.string()));
+    }
+    file_ = nullptr;
+  }
+  return status;
+}
+
+}  // namespace xls
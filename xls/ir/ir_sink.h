@@ -0,0 +1,143 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_IR_SINK_H_
+#define XLS_IR_IR_SINK_H_
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>  // NOLINT
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/cord.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace xls {
+
+// Destination for emitted IR text (see Package::DumpIrTo and
+// FunctionBase::DumpIrTo). Text is accumulated in a reusable buffer which is
+// handed to the destination whenever it fills, so emitting a large package
+// never materializes the whole text unless the destination itself keeps it.
+//
+// Appending never fails; the first error reported by the destination is
+// returned by Finish, after which further text is dropped.
+class IrSink {
+ public:
+  static constexpr int64_t kDefaultBufferSize = int64_t{64} * 1024;
+
+  explicit IrSink(int64_t buffer_size = kDefaultBufferSize)
+      : buffer_size_(buffer_size) {}
+  virtual ~IrSink() = default;
+
+  IrSink(const IrSink&) = delete;
+  IrSink& operator=(const IrSink&) = delete;
+
+  template <typename... AV>
+  void Append(const absl::AlphaNum& a, const AV&... args) {
+    absl::StrAppend(&buffer_, a, args...);
+    MaybeFlush();
+  }
+
+  template <typename... Args>
+  void AppendFormat(const absl::FormatSpec<Args...>& format,
+                    const Args&... args) {
+    absl::StrAppendFormat(&buffer_, format, args...);
+    MaybeFlush();
+  }
+
+  // Writes any buffered text to the destination and returns the first error
+  // encountered while writing.
+  virtual absl::Status Finish();
+
+ protected:
+  // Writes `text` to the destination.
+  virtual absl::Status Write(std::string_view text) = 0;
+
+  std::string& buffer() { return buffer_; }
+
+ private:
+  void MaybeFlush() {
+    if (static_cast<int64_t>(buffer_.size()) >= buffer_size_) {
+      Flush();
+    }
+  }
+  void Flush();
+
+  std::string buffer_;
+  int64_t buffer_size_;
+  absl::Status status_;
+};
+
+// Sink which collects the text in a string.
+class StringIrSink final : public IrSink {
+ public:
+  StringIrSink() : IrSink(std::numeric_limits<int64_t>::max()) {}
+
+  // The text is kept in the buffer, so there is nothing to write.
+  absl::Status Finish() override { return absl::OkStatus(); }
+
+  // Returns the text emitted so far and clears the sink.
+  std::string Release() { return std::move(buffer()); }
+
+ protected:
+  absl::Status Write(std::string_view text) override {
+    return absl::OkStatus();
+  }
+};
+
+// Sink which appends the text to a cord in buffer-sized chunks.
+class CordIrSink final : public IrSink {
+ public:
+  explicit CordIrSink(absl::Cord* cord,
+                      int64_t buffer_size = kDefaultBufferSize)
+      : IrSink(buffer_size), cord_(cord) {}
+
+ protected:
+  absl::Status Write(std::string_view text) override;
+
+ private:
+  absl::Cord* cord_;
+};
+
+// Sink which writes the text to a file. The file is closed by Finish.
+class FileIrSink final : public IrSink {
+ public:
+  static absl::StatusOr<std::unique_ptr<FileIrSink>> Open(
+      const std::filesystem::path& path,
+      int64_t buffer_size = kDefaultBufferSize);
+  ~FileIrSink() override;
+
+  absl::Status Finish() override;
+
+ protected:
+  absl::Status Write(std::string_view text) override;
+
+ private:
+  FileIrSink(std::filesystem::path path, std::FILE* file, int64_t buffer_size)
+      : IrSink(buffer_size), path_(std::move(path)), file_(file) {}
+
+  std::filesystem::path path_;
+  std::FILE* file_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_IR_SINK_H_
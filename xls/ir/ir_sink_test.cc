@@ -0,0 +1,115 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/ir_sink.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/strings/cord.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+constexpr std::string_view kPackage = R"(package test
+
+file_number 0 "fake/file.x"
+
+chan ch(bits[32], id=0, kind=streaming, ops=send_receive, flow_control=none, strictness=proven_mutually_exclusive, metadata="""""")
+
+fn f(x: bits[32] id=1) -> bits[32] {
+  ret neg.2: bits[32] = neg(x, id=2)
+}
+
+top proc my_proc(my_state: bits[32], init={42}) {
+  my_state: bits[32] = state_read(state_element=my_state, id=3)
+  after_all.4: token = after_all(id=4)
+  invoke.5: bits[32] = invoke(my_state, to_apply=f, id=5)
+  send.6: token = send(after_all.4, invoke.5, channel=ch, id=6)
+  next_value.7: () = next_value(param=my_state, value=invoke.5, id=7)
+}
+)";
+
+TEST(IrSinkTest, StringSink) {
+  StringIrSink sink;
+  sink.Append("a", 1, "b");
+  sink.AppendFormat("<%d>", 42);
+  XLS_EXPECT_OK(sink.Finish());
+  EXPECT_EQ(sink.Release(), "a1b<42>");
+}
+
+TEST(IrSinkTest, CordSinkWithSmallBuffer) {
+  absl::Cord cord;
+  CordIrSink sink(&cord, /*buffer_size=*/4);
+  for (int64_t i = 0; i < 10; ++i) {
+    sink.Append("xyz", i);
+  }
+  // Full buffers have already been handed to the cord.
+  EXPECT_FALSE(cord.empty());
+  XLS_EXPECT_OK(sink.Finish());
+  EXPECT_EQ(std::string(cord), "xyz0xyz1xyz2xyz3xyz4xyz5xyz6xyz7xyz8xyz9");
+}
+
+TEST(IrSinkTest, PackageDumpIrToMatchesDumpIr) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kPackage));
+  std::string expected = package->DumpIr();
+
+  absl::Cord cord;
+  CordIrSink sink(&cord, /*buffer_size=*/16);
+  package->DumpIrTo(sink);
+  XLS_ASSERT_OK(sink.Finish());
+  EXPECT_EQ(std::string(cord), expected);
+}
+
+TEST(IrSinkTest, EmptyPackage) {
+  Package package("empty");
+  StringIrSink sink;
+  package.DumpIrTo(sink);
+  EXPECT_EQ(sink.Release(), "package empty\n");
+}
+
+TEST(IrSinkTest, FileSink) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(kPackage));
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "test.ir";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FileIrSink> sink,
+                           FileIrSink::Open(path, /*buffer_size=*/16));
+  package->DumpIrTo(*sink);
+  XLS_ASSERT_OK(sink->Finish());
+  EXPECT_THAT(GetFileContents(path),
+              IsOkAndHolds(package->DumpIr()));
+}
+
+TEST(IrSinkTest, FileSinkOpenError) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  EXPECT_FALSE(FileIrSink::Open(temp_dir.path() / "missing" / "test.ir").ok());
+}
+
+}  // namespace
+}  // namespace xls
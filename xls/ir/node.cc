@@ -14,7 +14,6 @@
 
 #include "xls/ir/node.h"
 
-#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -38,9 +37,11 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/format_strings.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/instantiation.h"
 #include "xls/ir/lsb_or_msb.h"
 #include "xls/ir/nodes.h"
@@ -70,6 +71,15 @@ void Node::AddOperand(Node* operand) {
           << operands_.size() << " operand of " << GetName();
   operands_.push_back(operand);
   operand->AddUser(this);
+  function_base()->InvalidateCompactGraph();
+  // Nodes add their operands during construction, before being added to the
+  // function; listeners only hear about changes to nodes already in it.
+  if (!function_base()->change_listeners().empty() &&
+      function_base()->HasNode(this)) {
+    for (ChangeListener* listener : function_base()->change_listeners()) {
+      listener->OperandAdded(this);
+    }
+  }
   VLOG(3) << " " << operand->GetName()
           << " user now: " << operand->GetUsersString();
 }
@@ -802,7 +812,9 @@ void Node::SetId(int64_t id) {
   for (Node* operand : operands()) {
     operand->AddUser(this);
   }
-  package()->set_next_node_id(std::max(id + 1, package()->next_node_id()));
+  // The order of users changed.
+  function_base()->InvalidateCompactGraph();
+  package()->ReserveNodeId(id);
 }
 
 bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
@@ -819,7 +831,9 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
     return true;
   }
   ++package()->transform_metrics().operands_replaced;
+  function_base()->InvalidateCompactGraph();
   bool did_replace = false;
+  absl::InlinedVector<int64_t, 2> replaced_operand_nos;
   for (int64_t i = 0; i < operand_count(); ++i) {
     if (operands_[i] == old_operand) {
       if (!did_replace && new_operand != nullptr) {
@@ -828,9 +842,15 @@ bool Node::ReplaceOperand(Node* old_operand, Node* new_operand) {
       }
       did_replace = true;
       operands_[i] = new_operand;
+      replaced_operand_nos.push_back(i);
     }
   }
   old_operand->RemoveUser(this);
+  if (did_replace) {
+    for (ChangeListener* listener : function_base()->change_listeners()) {
+      listener->OperandChanged(this, old_operand, replaced_operand_nos);
+    }
+  }
   return did_replace;
 }
 
@@ -848,6 +868,10 @@ absl::Status Node::ReplaceOperandNumber(int64_t operand_no, Node* new_operand,
   // node in another operand slot, it is safe to call.
   new_operand->AddUser(this);
   operands_[operand_no] = new_operand;
+  function_base()->InvalidateCompactGraph();
+  for (ChangeListener* listener : function_base()->change_listeners()) {
+    listener->OperandChanged(this, old_operand, {operand_no});
+  }
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -865,6 +889,10 @@ absl::Status Node::RemoveOptionalOperand(int64_t operand_no) {
   ++package()->transform_metrics().operands_removed;
 
   operands_.pop_back();
+  function_base()->InvalidateCompactGraph();
+  for (ChangeListener* listener : function_base()->change_listeners()) {
+    listener->OperandRemoved(this, old_operand);
+  }
 
   for (Node* operand : operands()) {
     if (operand == old_operand) {
@@ -14,6 +14,8 @@
 
 #include "xls/ir/node.h"
 
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <type_traits>
 #include <vector>
@@ -22,8 +24,12 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
@@ -43,6 +49,7 @@ namespace {
 
 using ::absl_testing::IsOkAndHolds;
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 using ::testing::UnorderedElementsAre;
 
@@ -630,5 +637,54 @@ TEST_F(NodeTest, MakeNodeForType) {
   static_assert(!MakeNodeWillSubstituteWith<Block::Port>::value);
 }
 
+// Records the notifications it receives as strings.
+class RecordingChangeListener : public ChangeListener {
+ public:
+  void NodeAdded(Node* node) override {
+    events_.push_back(absl::StrCat("added ", node->GetName()));
+  }
+  void NodeDeleted(Node* node) override {
+    events_.push_back(absl::StrCat("deleted ", node->GetName()));
+  }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    events_.push_back(absl::StrCat("changed ", node->GetName(), " from ",
+                                   old_operand->GetName(), " at ",
+                                   absl::StrJoin(operand_nos, ",")));
+  }
+
+  const std::vector<std::string>& events() const { return events_; }
+
+ private:
+  std::vector<std::string> events_;
+};
+
+TEST_F(NodeTest, ChangeListenerNotifications) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, x)
+}
+)",
+                                                       p.get()));
+  RecordingChangeListener listener;
+  f->RegisterChangeListener(&listener);
+  XLS_ASSERT_OK_AND_ASSIGN(Node * x, f->GetNode("x"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * y, f->GetNode("y"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * neg, f->MakeNodeWithName<UnOp>(SourceInfo(), y, Op::kNeg, "neg"));
+  EXPECT_TRUE(f->return_value()->ReplaceOperand(x, neg));
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(1, y));
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(0, y));
+  XLS_ASSERT_OK(f->RemoveNode(neg));
+  f->UnregisterChangeListener(&listener);
+  XLS_ASSERT_OK(f->MakeNode<UnOp>(SourceInfo(), y, Op::kNot).status());
+
+  EXPECT_THAT(listener.events(),
+              ElementsAre("added neg", "changed add.3 from x at 0,1",
+                          "changed add.3 from neg at 1",
+                          "changed add.3 from neg at 0", "deleted neg"));
+}
+
 }  // namespace
 }  // namespace xls
@@ -779,7 +779,7 @@ Literal::Literal(const SourceInfo& loc, Value value, std::string_view name,
                  FunctionBase* function)
     : Node(Op::kLiteral, function->package()->GetTypeForValue(value), loc, name,
            function),
-      value_(std::move(value)) {
+      value_(function->package()->value_pool().Intern(std::move(value))) {
   CHECK(IsOpClass<Literal>(op_))
       << "Op `" << op_ << "` is not a valid op for Node class `Literal`.";
 }
@@ -798,7 +798,18 @@ bool Literal::IsDefinitelyEqualTo(const Node* other) const {
     return false;
   }
 
-  return value_ == other->As<Literal>()->value_;
+  return HasSameValueAs(other->As<Literal>());
+}
+
+bool Literal::HasSameValueAs(const Literal* other) const {
+  if (value_ == other->value_) {
+    return true;
+  }
+  // Distinct values interned in the same pool are never equal.
+  if (package() == other->package()) {
+    return false;
+  }
+  return *value_ == *other->value_;
 }
 
 Map::Map(const SourceInfo& loc, Node* arg, Function* to_apply,
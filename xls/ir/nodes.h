@@ -18,6 +18,7 @@
 #include <array>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -613,14 +614,19 @@ class Literal final : public Node {
   absl::StatusOr<Node*> CloneInNewFunction(
       absl::Span<Node* const> new_operands,
       FunctionBase* new_function) const final;
-  const Value& value() const { return value_; }
+  const Value& value() const { return *value_; }
+
+  // Returns whether `other` holds a value equal to this literal's. Values are
+  // interned in the package's value pool, so for literals of the same package
+  // this is a pointer comparison.
+  bool HasSameValueAs(const Literal* other) const;
 
   bool IsZero() const { return value().IsBits() && value().bits().IsZero(); }
 
   bool IsDefinitelyEqualTo(const Node* other) const final;
 
  private:
-  Value value_;
+  std::shared_ptr<const Value> value_;
 };
 
 class Map final : public Node {
@@ -45,6 +45,7 @@
 #include "xls/ir/fileno.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -57,6 +58,8 @@
 
 namespace xls {
 
+thread_local internal::PackageThreadState* Package::thread_state_ = nullptr;
+
 Package::Package(std::string_view name) : name_(name) {}
 
 Package::~Package() = default;
@@ -561,10 +564,17 @@ bool Package::IsDefinitelyEqualTo(const Package* other) const {
 }
 
 std::string Package::DumpIr() const {
-  std::string out;
-  absl::StrAppend(&out, "package ", name(), "\n\n");
+  StringIrSink sink;
+  DumpIrTo(sink);
+  return sink.Release();
+}
+
+void Package::DumpIrTo(IrSink& sink) const {
+  // Sections are separated by blank lines and the text doesn't end with one.
+  sink.Append("package ", name(), "\n");
 
   if (!fileno_to_filename_.empty()) {
+    sink.Append("\n");
     std::list<xls::Fileno> filenos;
     for (const auto& [fileno, filename] : fileno_to_filename_) {
       filenos.push_back(fileno);
@@ -573,20 +583,19 @@ std::string Package::DumpIr() const {
     // output in sorted order to be deterministic
     for (const auto& fileno : filenos) {
       std::string_view filename = fileno_to_filename_.at(fileno);
-      absl::StrAppend(&out, "file_number ", static_cast<int32_t>(fileno), " ",
-                      "\"", filename, "\"\n");
+      sink.Append("file_number ", static_cast<int32_t>(fileno), " ", "\"",
+                  filename, "\"\n");
     }
-    absl::StrAppend(&out, "\n");
   }
 
   if (!channels().empty()) {
+    sink.Append("\n");
     for (Channel* channel : channels()) {
-      absl::StrAppend(&out, channel->ToString(), "\n");
+      sink.Append(channel->ToString(), "\n");
     }
-    absl::StrAppend(&out, "\n");
   }
   std::optional<FunctionBase*> top = GetTop();
-  auto append_ir_with_attributes = [&top, &out](FunctionBase* fb) {
+  auto append_ir_with_attributes = [&top, &sink](FunctionBase* fb) {
     std::string_view attribute_prefix;
     std::string_view attribute_suffix;
     std::vector<std::string> attribute_strings = fb->AttributeIrStrings();
@@ -599,18 +608,14 @@ std::string Package::DumpIr() const {
       top_prefix = "top ";
     }
 
-    absl::StrAppend(&out, attribute_prefix,
-                    absl::StrJoin(attribute_strings, ", "), attribute_suffix,
-                    top_prefix, fb->DumpIr(), "\n");
+    sink.Append("\n", attribute_prefix, absl::StrJoin(attribute_strings, ", "),
+                attribute_suffix, top_prefix);
+    fb->DumpIrTo(sink);
   };
   // Our parser relies on everything being in post-order. Ensure that here.
   for (FunctionBase* fb : FunctionsInPostOrder(this)) {
     append_ir_with_attributes(fb);
   }
-  // We don't include the trailing newline, drop it here.
-  CHECK_EQ(out.back(), '\n');
-  out.pop_back();
-  return out;
 }
 
 std::ostream& operator<<(std::ostream& os, const Package& package) {
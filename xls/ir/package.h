@@ -15,6 +15,7 @@
 #ifndef XLS_IR_PACKAGE_H_
 #define XLS_IR_PACKAGE_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -33,11 +34,13 @@
 #include "xls/ir/channel.pb.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/fileno.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/transform_metrics.pb.h"
 #include "xls/ir/type.h"
 #include "xls/ir/type_manager.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_pool.h"
 #include "xls/ir/xls_type.pb.h"
 
 namespace xls {
@@ -78,6 +81,31 @@ struct TransformMetrics {
   TransformMetricsProto ToProto() const;
 };
 
+class Package;
+
+namespace internal {
+
+// Per-thread state which redirects node id allocation and transform metric
+// accounting while FunctionBases of `package` are transformed concurrently.
+// See ConcurrentFunctionBaseTransform.
+struct PackageThreadState {
+  const Package* package;
+  int64_t next_node_id;
+  TransformMetrics transform_metrics;
+
+  // A node id which was either handed out (`allocated`) or set explicitly.
+  struct NodeIdEvent {
+    bool allocated;
+    int64_t id;
+  };
+  // If non-null, node id events are recorded here in order so the package's id
+  // counter can later be advanced exactly as if the nodes had been created
+  // without this state. Used by the concurrent IR parser.
+  std::vector<NodeIdEvent>* node_id_log = nullptr;
+};
+
+}  // namespace internal
+
 class Package {
  public:
   explicit Package(std::string_view name);
@@ -154,6 +182,11 @@ class Package {
     return type_manager_.GetTypeForValue(value);
   }
 
+  // Pool of the values held by the literals of this package. Literals with
+  // structurally equal values share a single interned value.
+  ValuePool& value_pool() { return value_pool_; }
+  const ValuePool& value_pool() const { return value_pool_; }
+
   // Add a function, proc, or block to the package. Ownership is transferred to
   // the package.
   Function* AddFunction(std::unique_ptr<Function> f);
@@ -220,7 +253,29 @@ class Package {
 
   // Retrieves the next node ID to assign to a node in the package and
   // increments the next node counter. For use in node construction.
-  int64_t GetNextNodeIdAndIncrement() { return next_node_id_++; }
+  int64_t GetNextNodeIdAndIncrement() {
+    if (internal::PackageThreadState* state = ThreadState()) {
+      if (state->node_id_log != nullptr) {
+        state->node_id_log->push_back(
+            {.allocated = true, .id = state->next_node_id});
+      }
+      return state->next_node_id++;
+    }
+    return next_node_id_++;
+  }
+
+  // Ensures that node ids handed out later are greater than `id`. For use when
+  // a node id is set explicitly.
+  void ReserveNodeId(int64_t id) {
+    if (internal::PackageThreadState* state = ThreadState()) {
+      if (state->node_id_log != nullptr) {
+        state->node_id_log->push_back({.allocated = false, .id = id});
+      }
+      state->next_node_id = std::max(state->next_node_id, id + 1);
+      return;
+    }
+    next_node_id_ = std::max(next_node_id_, id + 1);
+  }
 
   // Adds a file to the file-number table and returns its corresponding number.
   // If it already exists, returns the existing file-number entry.
@@ -283,12 +338,27 @@ class Package {
   // Dumps the IR in a parsable text format.
   std::string DumpIr() const;
 
+  // Emits the same text as DumpIr into `sink`, without building the whole
+  // text in memory.
+  void DumpIrTo(IrSink& sink) const;
+
   std::vector<std::string> GetFunctionNames() const;
 
-  int64_t next_node_id() const { return next_node_id_; }
+  int64_t next_node_id() const {
+    if (internal::PackageThreadState* state = ThreadState()) {
+      return state->next_node_id;
+    }
+    return next_node_id_;
+  }
 
   // Intended for use by the parser when node ids are suggested by the IR text.
-  void set_next_node_id(int64_t value) { next_node_id_ = value; }
+  void set_next_node_id(int64_t value) {
+    if (internal::PackageThreadState* state = ThreadState()) {
+      state->next_node_id = value;
+      return;
+    }
+    next_node_id_ = value;
+  }
 
   // Create a channel. Channels are used with send/receive nodes in communicate
   // between procs or between procs and external (to XLS) components. If no
@@ -446,9 +516,17 @@ class Package {
 
   // Returns the transform metrics aggregated across all FunctionBases.
   const TransformMetrics& transform_metrics() const {
+    if (internal::PackageThreadState* state = ThreadState()) {
+      return state->transform_metrics;
+    }
+    return transform_metrics_;
+  }
+  TransformMetrics& transform_metrics() {
+    if (internal::PackageThreadState* state = ThreadState()) {
+      return state->transform_metrics;
+    }
     return transform_metrics_;
   }
-  TransformMetrics& transform_metrics() { return transform_metrics_; }
 
  private:
   std::vector<std::string> GetChannelNames() const;
@@ -457,6 +535,18 @@ class Package {
   absl::Status AddChannel(std::unique_ptr<Channel> channel, Proc* proc);
 
   friend class FunctionBuilder;
+  friend class ConcurrentFunctionBaseTransform;
+  friend class Parser;
+
+  // Returns the state installed by a ConcurrentFunctionBaseTransform (or the
+  // concurrent IR parser) on the calling thread if it belongs to this package,
+  // or nullptr otherwise.
+  internal::PackageThreadState* ThreadState() const {
+    return (thread_state_ != nullptr && thread_state_->package == this)
+               ? thread_state_
+               : nullptr;
+  }
+  static thread_local internal::PackageThreadState* thread_state_;
 
   std::optional<FunctionBase*> top_;
 
@@ -477,6 +567,9 @@ class Package {
   // Underlying manager for types used in this package.
   TypeManager type_manager_;
 
+  // Interned literal values of this package.
+  ValuePool value_pool_;
+
   // The largest `Fileno` used in this `Package`.
   std::optional<Fileno> maximum_fileno_;
 
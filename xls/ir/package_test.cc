@@ -305,6 +305,39 @@ top fn main(a: bits[32]) -> bits[32] {
   EXPECT_FALSE(p1->IsDefinitelyEqualTo(p2.get()));
 }
 
+TEST_F(PackageTest, LiteralsShareInternedValues) {
+  const char text[] = R"(
+package p
+
+fn f(x: bits[8][4]) -> (bits[8][4], bits[8][4]) {
+  rom.1: bits[8][4] = literal(value=[1, 2, 3, 4])
+  rom.2: bits[8][4] = literal(value=[1, 2, 3, 4])
+  other.3: bits[8][4] = literal(value=[4, 3, 2, 1])
+  ret tuple.4: (bits[8][4], bits[8][4]) = tuple(rom.1, rom.2)
+}
+
+fn g() -> bits[8][4] {
+  ret rom.5: bits[8][4] = literal(value=[1, 2, 3, 4])
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto p, ParsePackage(text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, p->GetFunction("f"));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * g, p->GetFunction("g"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * rom1, f->GetNode("rom.1"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * rom2, f->GetNode("rom.2"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * other, f->GetNode("other.3"));
+  EXPECT_EQ(&rom1->As<Literal>()->value(), &rom2->As<Literal>()->value());
+  EXPECT_EQ(&rom1->As<Literal>()->value(),
+            &g->return_value()->As<Literal>()->value());
+  EXPECT_NE(&rom1->As<Literal>()->value(), &other->As<Literal>()->value());
+  EXPECT_TRUE(rom1->IsDefinitelyEqualTo(rom2));
+  EXPECT_FALSE(rom1->IsDefinitelyEqualTo(other));
+  EXPECT_EQ(p->value_pool().size(), 2);
+
+  XLS_ASSERT_OK(f->RemoveNode(other));
+  EXPECT_EQ(p->value_pool().size(), 1);
+}
+
 TEST_F(PackageTest, CreateStreamingChannel) {
   Package p(TestName());
 
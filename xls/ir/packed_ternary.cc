@@ -0,0 +1,232 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/packed_ternary.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+
+PackedTernary::PackedTernary(Bits known, Bits value)
+    : known_(std::move(known)), value_(std::move(value)) {
+  CHECK_EQ(known_.bit_count(), value_.bit_count());
+  value_ = bits_ops::And(value_, known_);
+}
+
+PackedTernary PackedTernary::FromTernary(TernarySpan ternary) {
+  return PackedTernary(ternary_ops::ToKnownBits(ternary),
+                       ternary_ops::ToKnownBitsValues(ternary));
+}
+
+PackedTernary PackedTernary::FromBits(const Bits& bits) {
+  return PackedTernary(Bits::AllOnes(bits.bit_count()), bits);
+}
+
+TernaryVector PackedTernary::ToTernary() const {
+  return ternary_ops::FromKnownBits(known_, value_);
+}
+
+Bits PackedTernary::known_zeros() const {
+  return bits_ops::And(known_, bits_ops::Not(value_));
+}
+
+Bits PackedTernary::UnsignedMax() const {
+  return bits_ops::Or(value_, bits_ops::Not(known_));
+}
+
+std::string PackedTernary::ToString() const {
+  return xls::ToString(ToTernary());
+}
+
+namespace packed_ternary_ops {
+namespace {
+
+// Returns the carry into each bit position of `x + y + carry_in`.
+Bits CarriesInto(const Bits& x, const Bits& y, bool carry_in) {
+  Bits sum = bits_ops::Add(x, y);
+  if (carry_in) {
+    sum = bits_ops::Increment(sum);
+  }
+  return bits_ops::Xor(bits_ops::Xor(sum, x), y);
+}
+
+PackedTernary AddWithCarry(const PackedTernary& a, const PackedTernary& b,
+                           TernaryValue carry_in) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  // A carry out of a position is known to be one (zero) exactly when at least
+  // two of the operand bits and the carry in are known to be one (zero). That
+  // is the carry chain of an ordinary addition of the known-one (known-zero)
+  // planes, so both chains can be computed with word-parallel adds.
+  Bits carry_ones = CarriesInto(a.value(), b.value(),
+                                carry_in == TernaryValue::kKnownOne);
+  Bits carry_zeros = CarriesInto(a.known_zeros(), b.known_zeros(),
+                                 carry_in == TernaryValue::kKnownZero);
+  Bits known = bits_ops::And(bits_ops::And(a.known(), b.known()),
+                             bits_ops::Or(carry_ones, carry_zeros));
+  Bits value =
+      bits_ops::Xor(bits_ops::Xor(a.value(), b.value()), carry_ones);
+  return PackedTernary(std::move(known), std::move(value));
+}
+
+// Zero-extends or truncates `a` to `width` bits.
+PackedTernary Resize(const PackedTernary& a, int64_t width) {
+  if (a.bit_count() >= width) {
+    return BitSlice(a, 0, width);
+  }
+  return ZeroExtend(a, width);
+}
+
+// Returns `a` with its most significant bit inverted.
+PackedTernary FlipSignBit(const PackedTernary& a) {
+  Bits sign_bit = Bits::PowerOfTwo(a.bit_count() - 1, a.bit_count());
+  return PackedTernary(a.known(),
+                       bits_ops::Xor(a.value(), bits_ops::And(sign_bit,
+                                                              a.known())));
+}
+
+}  // namespace
+
+PackedTernary Not(const PackedTernary& a) {
+  return PackedTernary(a.known(), bits_ops::Not(a.value()));
+}
+
+PackedTernary And(const PackedTernary& a, const PackedTernary& b) {
+  // Known wherever either side is known zero or both sides are known one.
+  Bits zeros = bits_ops::Or(a.known_zeros(), b.known_zeros());
+  Bits ones = bits_ops::And(a.value(), b.value());
+  return PackedTernary(bits_ops::Or(zeros, ones), ones);
+}
+
+PackedTernary Or(const PackedTernary& a, const PackedTernary& b) {
+  // Known wherever either side is known one or both sides are known zero.
+  Bits ones = bits_ops::Or(a.value(), b.value());
+  Bits zeros = bits_ops::And(a.known_zeros(), b.known_zeros());
+  return PackedTernary(bits_ops::Or(zeros, ones), ones);
+}
+
+PackedTernary Xor(const PackedTernary& a, const PackedTernary& b) {
+  return PackedTernary(bits_ops::And(a.known(), b.known()),
+                       bits_ops::Xor(a.value(), b.value()));
+}
+
+PackedTernary ZeroExtend(const PackedTernary& a, int64_t new_bit_count) {
+  return PackedTernary(
+      bits_ops::Not(
+          bits_ops::ZeroExtend(bits_ops::Not(a.known()), new_bit_count)),
+      bits_ops::ZeroExtend(a.value(), new_bit_count));
+}
+
+PackedTernary SignExtend(const PackedTernary& a, int64_t new_bit_count) {
+  // The new bits are known exactly when the sign bit is, and unknown bits are
+  // zero in the value plane, so extending each plane separately is exact.
+  return PackedTernary(bits_ops::SignExtend(a.known(), new_bit_count),
+                       bits_ops::SignExtend(a.value(), new_bit_count));
+}
+
+PackedTernary BitSlice(const PackedTernary& a, int64_t start, int64_t width) {
+  return PackedTernary(a.known().Slice(start, width),
+                       a.value().Slice(start, width));
+}
+
+PackedTernary ShiftLeftLogical(const PackedTernary& a, int64_t amount) {
+  return PackedTernary(
+      bits_ops::Not(bits_ops::ShiftLeftLogical(bits_ops::Not(a.known()),
+                                               amount)),
+      bits_ops::ShiftLeftLogical(a.value(), amount));
+}
+
+PackedTernary Add(const PackedTernary& a, const PackedTernary& b) {
+  return AddWithCarry(a, b, TernaryValue::kKnownZero);
+}
+
+PackedTernary Sub(const PackedTernary& a, const PackedTernary& b) {
+  return AddWithCarry(a, Not(b), TernaryValue::kKnownOne);
+}
+
+PackedTernary Neg(const PackedTernary& a) {
+  return AddWithCarry(PackedTernary::FromBits(Bits(a.bit_count())), Not(a),
+                      TernaryValue::kKnownOne);
+}
+
+PackedTernary UMul(const PackedTernary& a, const PackedTernary& b,
+                   int64_t result_width) {
+  PackedTernary lhs = Resize(a, result_width);
+  // The partial product for a bit of `b` which is unknown: bits known to be
+  // zero in `a` stay zero, everything else is unknown.
+  PackedTernary unknown_partial(lhs.known_zeros(), Bits(result_width));
+  PackedTernary result = PackedTernary::FromBits(Bits(result_width));
+  int64_t limit = std::min(b.bit_count(), result_width);
+  for (int64_t i = 0; i < limit; ++i) {
+    if (!b.known().Get(i)) {
+      result = Add(result, ShiftLeftLogical(unknown_partial, i));
+    } else if (b.value().Get(i)) {
+      result = Add(result, ShiftLeftLogical(lhs, i));
+    }
+  }
+  return result;
+}
+
+PackedTernary SMul(const PackedTernary& a, const PackedTernary& b,
+                   int64_t result_width) {
+  // The low `result_width` bits of a signed product are the low bits of the
+  // unsigned product of the operands sign-extended to that width.
+  auto extend = [&](const PackedTernary& x) {
+    return x.bit_count() >= result_width ? x : SignExtend(x, result_width);
+  };
+  return UMul(extend(a), extend(b), result_width);
+}
+
+TernaryValue Equals(const PackedTernary& a, const PackedTernary& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  Bits both_known = bits_ops::And(a.known(), b.known());
+  if (!bits_ops::And(both_known, bits_ops::Xor(a.value(), b.value()))
+           .IsZero()) {
+    return TernaryValue::kKnownZero;
+  }
+  if (both_known.IsAllOnes()) {
+    return TernaryValue::kKnownOne;
+  }
+  return TernaryValue::kUnknown;
+}
+
+TernaryValue ULessThan(const PackedTernary& a, const PackedTernary& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  if (bits_ops::ULessThan(a.UnsignedMax(), b.UnsignedMin())) {
+    return TernaryValue::kKnownOne;
+  }
+  if (bits_ops::UGreaterThanOrEqual(a.UnsignedMin(), b.UnsignedMax())) {
+    return TernaryValue::kKnownZero;
+  }
+  return TernaryValue::kUnknown;
+}
+
+TernaryValue SLessThan(const PackedTernary& a, const PackedTernary& b) {
+  CHECK_EQ(a.bit_count(), b.bit_count());
+  if (a.bit_count() == 0) {
+    return TernaryValue::kKnownZero;
+  }
+  // Inverting the sign bit maps signed order onto unsigned order.
+  return ULessThan(FlipSignBit(a), FlipSignBit(b));
+}
+
+}  // namespace packed_ternary_ops
+}  // namespace xls
@@ -0,0 +1,111 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_PACKED_TERNARY_H_
+#define XLS_IR_PACKED_TERNARY_H_
+
+#include <cstdint>
+#include <string>
+
+#include "xls/ir/bits.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+
+// A ternary vector stored as two bit planes: `known` has a one for each bit
+// whose value is known, and `value` holds the value of each known bit (bits
+// which are not known are always zero in `value`). Both planes are backed by
+// InlineBitmaps, so the operations in packed_ternary_ops work a machine word at
+// a time rather than a bit at a time as the TernaryVector operations do.
+class PackedTernary {
+ public:
+  // Creates a fully unknown ternary of the given width.
+  explicit PackedTernary(int64_t bit_count)
+      : known_(bit_count), value_(bit_count) {}
+  // Creates a ternary from its two planes. Bits of `value` which are not set in
+  // `known` are ignored.
+  PackedTernary(Bits known, Bits value);
+
+  static PackedTernary FromTernary(TernarySpan ternary);
+  static PackedTernary FromBits(const Bits& bits);
+
+  TernaryVector ToTernary() const;
+
+  int64_t bit_count() const { return known_.bit_count(); }
+  const Bits& known() const { return known_; }
+  const Bits& value() const { return value_; }
+
+  // Returns the bits known to be zero.
+  Bits known_zeros() const;
+
+  bool IsFullyKnown() const { return known_.IsAllOnes(); }
+
+  // Returns the smallest and largest unsigned values compatible with this
+  // ternary.
+  const Bits& UnsignedMin() const { return value_; }
+  Bits UnsignedMax() const;
+
+  bool operator==(const PackedTernary& other) const {
+    return known_ == other.known_ && value_ == other.value_;
+  }
+  bool operator!=(const PackedTernary& other) const {
+    return !(*this == other);
+  }
+
+  // Format is the same as for TernaryVectors, for example: 0b10XX1
+  std::string ToString() const;
+
+ private:
+  Bits known_;
+  Bits value_;
+};
+
+namespace packed_ternary_ops {
+
+PackedTernary Not(const PackedTernary& a);
+PackedTernary And(const PackedTernary& a, const PackedTernary& b);
+PackedTernary Or(const PackedTernary& a, const PackedTernary& b);
+PackedTernary Xor(const PackedTernary& a, const PackedTernary& b);
+
+PackedTernary ZeroExtend(const PackedTernary& a, int64_t new_bit_count);
+PackedTernary SignExtend(const PackedTernary& a, int64_t new_bit_count);
+PackedTernary BitSlice(const PackedTernary& a, int64_t start, int64_t width);
+PackedTernary ShiftLeftLogical(const PackedTernary& a, int64_t amount);
+
+// Arithmetic operations which truncate their result to the operand width (the
+// operands must have the same width). The carry into every bit position is
+// tracked for the "known one" and "known zero" cases as two ordinary carry
+// chains, so each addition costs two word-parallel adds.
+PackedTernary Add(const PackedTernary& a, const PackedTernary& b);
+PackedTernary Sub(const PackedTernary& a, const PackedTernary& b);
+PackedTernary Neg(const PackedTernary& a);
+
+// Multiplications producing a result of `result_width` bits, computed by
+// shifting and adding the partial products of `a` with each bit of `b` which
+// is not known to be zero.
+PackedTernary UMul(const PackedTernary& a, const PackedTernary& b,
+                   int64_t result_width);
+PackedTernary SMul(const PackedTernary& a, const PackedTernary& b,
+                   int64_t result_width);
+
+// Comparisons. The result is known whenever every value compatible with `a`
+// and every value compatible with `b` give the same answer.
+TernaryValue Equals(const PackedTernary& a, const PackedTernary& b);
+TernaryValue ULessThan(const PackedTernary& a, const PackedTernary& b);
+TernaryValue SLessThan(const PackedTernary& a, const PackedTernary& b);
+
+}  // namespace packed_ternary_ops
+}  // namespace xls
+
+#endif  // XLS_IR_PACKED_TERNARY_H_
@@ -0,0 +1,242 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/packed_ternary.h"
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/ternary.h"
+
+namespace xls {
+namespace {
+
+PackedTernary FromString(std::string_view s) {
+  absl::StatusOr<TernaryVector> vec = StringToTernaryVector(s);
+  CHECK_OK(vec.status());
+  return PackedTernary::FromTernary(*vec);
+}
+
+// Returns every ternary vector of the given width.
+std::vector<PackedTernary> AllTernaries(int64_t width) {
+  std::vector<PackedTernary> result;
+  TernaryVector vec(width, TernaryValue::kKnownZero);
+  while (true) {
+    result.push_back(PackedTernary::FromTernary(vec));
+    int64_t i = 0;
+    while (i < width && vec[i] == TernaryValue::kUnknown) {
+      vec[i++] = TernaryValue::kKnownZero;
+    }
+    if (i == width) {
+      return result;
+    }
+    vec[i] = vec[i] == TernaryValue::kKnownZero ? TernaryValue::kKnownOne
+                                                : TernaryValue::kUnknown;
+  }
+}
+
+// Checks that every value `f` produces for values compatible with `a` and `b`
+// is compatible with `result`.
+void ExpectSound(const PackedTernary& a, const PackedTernary& b,
+                 const PackedTernary& result,
+                 const std::function<Bits(const Bits&, const Bits&)>& f) {
+  TernaryVector result_vec = result.ToTernary();
+  for (const Bits& x : ternary_ops::AllBitsValues(a.ToTernary())) {
+    for (const Bits& y : ternary_ops::AllBitsValues(b.ToTernary())) {
+      EXPECT_TRUE(ternary_ops::IsCompatible(result_vec, f(x, y)))
+          << a.ToString() << ", " << b.ToString() << " -> "
+          << result.ToString() << " but " << x << ", " << y << " -> "
+          << f(x, y);
+    }
+  }
+}
+
+// Checks that the comparison `result` is known exactly when every value
+// compatible with `a` and `b` gives the same answer.
+void ExpectExact(const PackedTernary& a, const PackedTernary& b,
+                 TernaryValue result,
+                 const std::function<bool(const Bits&, const Bits&)>& f) {
+  bool seen_true = false;
+  bool seen_false = false;
+  for (const Bits& x : ternary_ops::AllBitsValues(a.ToTernary())) {
+    for (const Bits& y : ternary_ops::AllBitsValues(b.ToTernary())) {
+      (f(x, y) ? seen_true : seen_false) = true;
+    }
+  }
+  TernaryValue expected = seen_true && seen_false ? TernaryValue::kUnknown
+                          : seen_true             ? TernaryValue::kKnownOne
+                                                  : TernaryValue::kKnownZero;
+  EXPECT_EQ(result, expected) << a.ToString() << ", " << b.ToString();
+}
+
+TEST(PackedTernaryTest, RoundTrip) {
+  PackedTernary t = FromString("0b1X0_X1");
+  EXPECT_EQ(t.bit_count(), 5);
+  EXPECT_EQ(t.known(), UBits(0b10101, 5));
+  EXPECT_EQ(t.value(), UBits(0b10001, 5));
+  EXPECT_EQ(t.known_zeros(), UBits(0b00100, 5));
+  EXPECT_EQ(t.UnsignedMax(), UBits(0b11011, 5));
+  EXPECT_EQ(t.ToString(), "0b1X0X1");
+  EXPECT_FALSE(t.IsFullyKnown());
+  EXPECT_TRUE(PackedTernary::FromBits(UBits(5, 3)).IsFullyKnown());
+  EXPECT_EQ(PackedTernary(4).ToString(), "0bXXXX");
+  EXPECT_EQ(PackedTernary(UBits(0b0011, 4), UBits(0b1111, 4)),
+            FromString("0bXX11"));
+}
+
+TEST(PackedTernaryTest, BitwiseOps) {
+  PackedTernary a = FromString("0b01X01X");
+  PackedTernary b = FromString("0b0011XX");
+  EXPECT_EQ(packed_ternary_ops::Not(a).ToString(), "0b10X10X");
+  EXPECT_EQ(packed_ternary_ops::And(a, b).ToString(), "0b00X0XX");
+  EXPECT_EQ(packed_ternary_ops::Or(a, b).ToString(), "0b01111X");
+  EXPECT_EQ(packed_ternary_ops::Xor(a, b).ToString(), "0b01X1XX");
+  EXPECT_EQ(packed_ternary_ops::ZeroExtend(a, 8).ToString(), "0b0001X01X");
+  EXPECT_EQ(packed_ternary_ops::SignExtend(FromString("0bX01"), 5).ToString(),
+            "0bXXX01");
+  EXPECT_EQ(packed_ternary_ops::BitSlice(a, 1, 3).ToString(), "0bX01");
+  EXPECT_EQ(packed_ternary_ops::ShiftLeftLogical(a, 2).ToString(),
+            "0bX01X00");
+}
+
+TEST(PackedTernaryTest, AddTracksCarries) {
+  // The low bits produce a known carry which propagates through the known
+  // ones above them.
+  EXPECT_EQ(packed_ternary_ops::Add(FromString("0bX0111"),
+                                    FromString("0b00001"))
+                .ToString(),
+            "0bX1000");
+  // Two known ones in the carry in and one operand give a known carry out
+  // even though the other operand is unknown.
+  EXPECT_EQ(packed_ternary_ops::Add(FromString("0b0011"),
+                                    FromString("0b00X1"))
+                .ToString(),
+            "0b01X0");
+  EXPECT_EQ(packed_ternary_ops::Sub(FromString("0b1000"),
+                                    FromString("0b0001"))
+                .ToString(),
+            "0b0111");
+  EXPECT_EQ(packed_ternary_ops::Neg(FromString("0bXX00")).ToString(),
+            "0bXX00");
+}
+
+TEST(PackedTernaryTest, MulKeepsTrailingZeros) {
+  EXPECT_EQ(packed_ternary_ops::UMul(FromString("0bXX0"),
+                                     FromString("0bX00"), 6)
+                .ToString(),
+            "0b0XX000");
+  EXPECT_EQ(packed_ternary_ops::UMul(FromString("0b0X1"),
+                                     PackedTernary::FromBits(UBits(4, 3)), 4)
+                .ToString(),
+            "0bX100");
+}
+
+TEST(PackedTernaryTest, ExhaustiveArithmeticIsSound) {
+  for (int64_t width = 1; width <= 3; ++width) {
+    std::vector<PackedTernary> all = AllTernaries(width);
+    for (const PackedTernary& a : all) {
+      for (const PackedTernary& b : all) {
+        ExpectSound(a, b, packed_ternary_ops::Add(a, b), bits_ops::Add);
+        ExpectSound(a, b, packed_ternary_ops::Sub(a, b), bits_ops::Sub);
+        ExpectSound(a, b, packed_ternary_ops::Neg(a),
+                    [](const Bits& x, const Bits&) {
+                      return bits_ops::Negate(x);
+                    });
+        for (int64_t result_width : {width, 2 * width, 2 * width + 1}) {
+          ExpectSound(a, b, packed_ternary_ops::UMul(a, b, result_width),
+                      [&](const Bits& x, const Bits& y) {
+                        return bits_ops::ZeroExtend(bits_ops::UMul(x, y),
+                                                    2 * width + 1)
+                            .Slice(0, result_width);
+                      });
+          ExpectSound(a, b, packed_ternary_ops::SMul(a, b, result_width),
+                      [&](const Bits& x, const Bits& y) {
+                        return bits_ops::SignExtend(bits_ops::SMul(x, y),
+                                                    2 * width + 1)
+                            .Slice(0, result_width);
+                      });
+        }
+      }
+    }
+  }
+}
+
+TEST(PackedTernaryTest, ExhaustiveComparisonsAreExact) {
+  for (int64_t width = 0; width <= 3; ++width) {
+    std::vector<PackedTernary> all = AllTernaries(width);
+    for (const PackedTernary& a : all) {
+      for (const PackedTernary& b : all) {
+        ExpectExact(a, b, packed_ternary_ops::Equals(a, b),
+                    [](const Bits& x, const Bits& y) { return x == y; });
+        ExpectExact(a, b, packed_ternary_ops::ULessThan(a, b),
+                    [](const Bits& x, const Bits& y) {
+                      return bits_ops::ULessThan(x, y);
+                    });
+        ExpectExact(a, b, packed_ternary_ops::SLessThan(a, b),
+                    [](const Bits& x, const Bits& y) {
+                      return x.bit_count() > 0 && bits_ops::SLessThan(x, y);
+                    });
+      }
+    }
+  }
+}
+
+PackedTernary MakePackedTernary(int64_t width, int64_t unknown_stride) {
+  InlineBitmap known(width, /*fill=*/true);
+  InlineBitmap value(width);
+  for (int64_t i = 0; i < width; ++i) {
+    if (i % unknown_stride == 0) {
+      known.Set(i, false);
+    } else if (i % 3 == 0) {
+      value.Set(i, true);
+    }
+  }
+  return PackedTernary(Bits::FromBitmap(std::move(known)),
+                       Bits::FromBitmap(std::move(value)));
+}
+
+void BM_PackedTernaryAdd(benchmark::State& state) {
+  PackedTernary lhs = MakePackedTernary(state.range(0), /*unknown_stride=*/5);
+  PackedTernary rhs = MakePackedTernary(state.range(0), /*unknown_stride=*/7);
+  for (auto _ : state) {
+    PackedTernary v = packed_ternary_ops::Add(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_PackedTernaryAdd)->Range(1, 1 << 16);
+
+void BM_PackedTernaryUMul(benchmark::State& state) {
+  PackedTernary lhs = MakePackedTernary(state.range(0), /*unknown_stride=*/5);
+  PackedTernary rhs = MakePackedTernary(state.range(0), /*unknown_stride=*/7);
+  for (auto _ : state) {
+    PackedTernary v =
+        packed_ternary_ops::UMul(lhs, rhs, /*result_width=*/state.range(0));
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_PackedTernaryUMul)->Range(1, 1 << 10);
+
+}  // namespace
+}  // namespace xls
@@ -39,6 +39,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -54,11 +55,11 @@
 
 namespace xls {
 
-std::string Proc::DumpIr() const {
-  std::string res = absl::StrFormat("proc %s", name());
+void Proc::DumpIrTo(IrSink& sink) const {
+  sink.Append("proc ", name());
   if (is_new_style_proc()) {
-    absl::StrAppendFormat(
-        &res, "<%s>",
+    sink.AppendFormat(
+        "<%s>",
         absl::StrJoin(interface_, ", ",
                       [](std::string* s, const ChannelReference* channel_ref) {
                         absl::StrAppend(s, channel_ref->ToString());
@@ -67,32 +68,31 @@ std::string Proc::DumpIr() const {
   auto state_formatter = [](std::string* s, StateElement* state) {
     absl::StrAppend(s, state->name(), ": ", state->type()->ToString());
   };
-  absl::StrAppend(&res, "(",
-                  absl::StrJoin(StateElements(), ", ", state_formatter));
+  sink.Append("(", absl::StrJoin(StateElements(), ", ", state_formatter));
   auto initial_value_formatter = [](std::string* s, StateElement* state) {
     UntypedValueFormatter(s, state->initial_value());
   };
   if (!StateElements().empty()) {
-    absl::StrAppendFormat(
-        &res, ", init={%s}",
+    sink.AppendFormat(
+        ", init={%s}",
         absl::StrJoin(StateElements(), ", ", initial_value_formatter));
   }
-  absl::StrAppend(&res, ") {\n");
+  sink.Append(") {\n");
 
   if (is_new_style_proc()) {
     for (Channel* channel : channels()) {
-      absl::StrAppendFormat(&res, "  %s\n", channel->ToString());
+      sink.Append("  ", channel->ToString(), "\n");
     }
     for (const std::unique_ptr<ProcInstantiation>& instantiation :
          proc_instantiations()) {
-      absl::StrAppendFormat(&res, "  %s\n", instantiation->ToString());
+      sink.Append("  ", instantiation->ToString(), "\n");
     }
   }
   for (Node* node : TopoSort(const_cast<Proc*>(this))) {
     if (node->op() == Op::kParam) {
       continue;
     }
-    absl::StrAppend(&res, "  ", node->ToString(), "\n");
+    sink.Append("  ", node->ToString(), "\n");
   }
 
   // TODO: google/xls#1520 - remove this once fully transitioned over to
@@ -101,11 +101,10 @@ std::string Proc::DumpIr() const {
     auto node_formatter = [](std::string* s, Node* node) {
       absl::StrAppend(s, node->GetName());
     };
-    absl::StrAppend(&res, "  next (",
-                    absl::StrJoin(next_state_, ", ", node_formatter), ")\n");
+    sink.Append("  next (", absl::StrJoin(next_state_, ", ", node_formatter),
+                ")\n");
   }
-  absl::StrAppend(&res, "}\n");
-  return res;
+  sink.Append("}\n");
 }
 
 int64_t Proc::GetStateFlatBitCount() const {
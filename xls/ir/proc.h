@@ -32,6 +32,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/name_uniquer.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -279,7 +280,7 @@ class Proc : public FunctionBase {
       const absl::flat_hash_map<std::string, std::string>&
           state_name_remapping = {}) const;
 
-  std::string DumpIr() const override;
+  void DumpIrTo(IrSink& sink) const override;
 
   // Returns true if this is a new-style proc which has proc-scoped channels.
   bool is_new_style_proc() const { return is_new_style_proc_; }
@@ -19,6 +19,7 @@
 #include <string_view>
 #include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status_matchers.h"
@@ -294,5 +295,63 @@ TEST_F(AllValuesTest, AllValuesEmptyTypes) {
                                        complex_empty_type))));
 }
 
+// Returns a vector cycling through known zero, known one and unknown, with
+// every `unknown_stride`-th element additionally unknown.
+TernaryVector MakeTernaryVector(int64_t bit_count, int64_t unknown_stride) {
+  TernaryVector result;
+  result.reserve(bit_count);
+  for (int64_t i = 0; i < bit_count; ++i) {
+    if (i % unknown_stride == 0 || i % 3 == 2) {
+      result.push_back(TernaryValue::kUnknown);
+    } else {
+      result.push_back(i % 3 == 0 ? TernaryValue::kKnownZero
+                                  : TernaryValue::kKnownOne);
+    }
+  }
+  return result;
+}
+
+void BM_TernaryUnion(benchmark::State& state) {
+  TernaryVector lhs = MakeTernaryVector(state.range(0), /*unknown_stride=*/5);
+  TernaryVector rhs = MakeTernaryVector(state.range(0), /*unknown_stride=*/7);
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(TernaryVector v, ternary_ops::Union(lhs, rhs));
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_TernaryUnion)->Range(1, 1 << 16);
+
+void BM_TernaryIntersection(benchmark::State& state) {
+  TernaryVector lhs = MakeTernaryVector(state.range(0), /*unknown_stride=*/5);
+  TernaryVector rhs = MakeTernaryVector(state.range(0), /*unknown_stride=*/7);
+  for (auto _ : state) {
+    TernaryVector v = ternary_ops::Intersection(lhs, rhs);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_TernaryIntersection)->Range(1, 1 << 16);
+
+void BM_TernaryToKnownBits(benchmark::State& state) {
+  TernaryVector vec = MakeTernaryVector(state.range(0), /*unknown_stride=*/5);
+  for (auto _ : state) {
+    Bits known = ternary_ops::ToKnownBits(vec);
+    Bits values = ternary_ops::ToKnownBitsValues(vec);
+    benchmark::DoNotOptimize(known);
+    benchmark::DoNotOptimize(values);
+  }
+}
+BENCHMARK(BM_TernaryToKnownBits)->Range(1, 1 << 16);
+
+void BM_TernaryFromKnownBits(benchmark::State& state) {
+  TernaryVector vec = MakeTernaryVector(state.range(0), /*unknown_stride=*/5);
+  Bits known = ternary_ops::ToKnownBits(vec);
+  Bits values = ternary_ops::ToKnownBitsValues(vec);
+  for (auto _ : state) {
+    TernaryVector v = ternary_ops::FromKnownBits(known, values);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_TernaryFromKnownBits)->Range(1, 1 << 16);
+
 }  // namespace
 }  // namespace xls
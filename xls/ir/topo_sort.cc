@@ -27,6 +27,8 @@
 #include "absl/log/log.h"
 #include "absl/random/bit_gen_ref.h"
 #include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/ir/compact_graph.h"
 #include "xls/ir/dfs_visitor.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
@@ -44,68 +46,69 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
   //     v v v
   //     o o o  (users, all present in order)
   //
-  // When a node is placed into the ordering, we place all of its operands into
-  // the "pending_to_remaining_users" mapping if it is not yet present -- this
-  // keeps track of how many more users must be seen (before that node is ready
+  // When a node is placed into the ordering, we start tracking how many more
+  // users of each of its operands must be seen (before that operand is ready
   // to place into the ordering).
   //
+  // The traversal works on node indices of the compact graph so that the
+  // bookkeeping lives in flat vectors rather than hash maps.
+  //
   // NOTE: sorts reverse-topologically.  To sort topologically, reverse the
   // result.
-  absl::flat_hash_map<Node*, int64_t> pending_to_remaining_users;
-  pending_to_remaining_users.reserve(f->node_count());
-  std::deque<Node*> ready;
-
-  std::vector<Node*> ordered;
-  ordered.reserve(f->node_count());
-
-  auto is_scheduled = [&](Node* n) {
-    auto it = pending_to_remaining_users.find(n);
-    if (it == pending_to_remaining_users.end()) {
-      return false;
-    }
-    return it->second < 0;
-  };
-  auto all_users_scheduled = [&](Node* n) {
-    return absl::c_all_of(n->users(), is_scheduled);
+  const CompactGraph& graph = f->compact_graph();
+  const int64_t node_count = graph.node_count();
+
+  // Per node: the number of users which still have to be scheduled, or one of
+  // the sentinels below.
+  static constexpr int64_t kUnseen = -2;
+  static constexpr int64_t kScheduled = -1;
+  std::vector<int64_t> remaining_users(node_count, kUnseen);
+  std::deque<int64_t> ready;
+
+  std::vector<int64_t> ordered;
+  ordered.reserve(node_count);
+
+  auto all_users_scheduled = [&](int64_t n) {
+    return absl::c_all_of(graph.users(n), [&](int32_t user) {
+      return remaining_users[user] == kScheduled;
+    });
   };
 
-  auto seed_ready = [&](Node* n) {
+  auto seed_ready = [&](int64_t n) {
     ready.push_front(n);
-    CHECK(pending_to_remaining_users.insert({n, -1}).second);
-  };
-
-  auto is_return_value = [&](Node* n) {
-    return n->function_base()->IsFunction() &&
-           (n == n->function_base()->AsFunctionOrDie()->return_value());
+    CHECK_EQ(remaining_users[n], kUnseen);
+    remaining_users[n] = kScheduled;
   };
 
-  Node* return_value = nullptr;
-  for (Node* node : f->nodes()) {
-    if (node->users().empty()) {
-      if (is_return_value(node)) {
-        // Note: we special case the return value so it always comes at the
-        // front.
-        return_value = node;
-      } else {
-        DCHECK(all_users_scheduled(node));
-        VLOG(5) << "At start node was ready: " << node;
-        seed_ready(node);
+  std::optional<int64_t> return_value;
+  if (f->IsFunction() && f->AsFunctionOrDie()->return_value() != nullptr) {
+    return_value = graph.index(f->AsFunctionOrDie()->return_value());
+  }
+  for (int64_t n = 0; n < node_count; ++n) {
+    if (graph.users(n).empty()) {
+      // Note: we special case the return value so it always comes at the
+      // front.
+      if (n != return_value) {
+        DCHECK(all_users_scheduled(n));
+        VLOG(5) << "At start node was ready: " << graph.node(n);
+        seed_ready(n);
       }
     }
   }
 
-  if (return_value != nullptr) {
-    VLOG(5) << "Maybe marking return value as ready: " << return_value;
-    seed_ready(return_value);
+  if (return_value.has_value() && graph.users(*return_value).empty()) {
+    VLOG(5) << "Maybe marking return value as ready: "
+            << graph.node(*return_value);
+    seed_ready(*return_value);
   }
 
-  std::optional<absl::flat_hash_map<Node*, int64_t>> random_priority;
-  auto random_comparator = [&](Node* a, Node* b) {
-    CHECK(random_priority.has_value());
-    return random_priority->at(a) < random_priority->at(b);
+  std::vector<int64_t> random_priority;
+  auto random_comparator = [&](int64_t a, int64_t b) {
+    return random_priority[a] < random_priority[b];
   };
   if (randomizer.has_value()) {
-    std::vector<Node*> random_order(f->nodes().begin(), f->nodes().end());
+    std::vector<int64_t> random_order(node_count);
+    absl::c_iota(random_order, 0);
     absl::c_shuffle(random_order, *randomizer);
     for (int64_t i = 0; i < random_order.size(); ++i) {
       if (random_order[i] == return_value) {
@@ -115,58 +118,58 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
       }
     }
 
-    random_priority.emplace();
-    random_priority->reserve(random_order.size());
+    random_priority.resize(node_count);
     for (int64_t i = 0; i < random_order.size(); ++i) {
-      CHECK(random_priority->emplace(random_order[i], i).second);
+      random_priority[random_order[i]] = i;
     }
 
     absl::c_make_heap(ready, random_comparator);
   }
 
-  auto bump_down_remaining_users = [&](Node* n) {
-    CHECK(!n->users().empty());
-    auto result = pending_to_remaining_users.insert({n, n->users().size()});
-    auto it = result.first;
-    int64_t& remaining_users = it->second;
-    CHECK_GT(remaining_users, 0);
-    remaining_users -= 1;
-    VLOG(5) << "Bumped down remaining users for: " << n
-            << "; now: " << remaining_users;
-    if (remaining_users == 0) {
-      ready.push_back(result.first->first);
-      if (random_priority.has_value()) {
+  auto bump_down_remaining_users = [&](int64_t n) {
+    CHECK(!graph.users(n).empty());
+    int64_t& remaining = remaining_users[n];
+    if (remaining == kUnseen) {
+      remaining = graph.users(n).size();
+    }
+    CHECK_GT(remaining, 0);
+    remaining -= 1;
+    VLOG(5) << "Bumped down remaining users for: " << graph.node(n)
+            << "; now: " << remaining;
+    if (remaining == 0) {
+      ready.push_back(n);
+      if (!random_priority.empty()) {
         absl::c_push_heap(ready, random_comparator);
       }
-      remaining_users -= 1;
+      remaining = kScheduled;
     }
   };
 
-  absl::flat_hash_set<Node*> seen_operands;
-  auto add_to_order = [&](Node* r) {
-    VLOG(5) << "Adding node to order: " << r;
-    DCHECK(all_users_scheduled(r)) << r << " users size: " << r->users().size();
+  // The node which last bumped down each node; used to only bump down each
+  // operand once per user.
+  std::vector<int64_t> last_bumped_by(node_count, -1);
+  auto add_to_order = [&](int64_t r) {
+    VLOG(5) << "Adding node to order: " << graph.node(r);
+    DCHECK(all_users_scheduled(r))
+        << graph.node(r) << " users size: " << graph.users(r).size();
     ordered.push_back(r);
 
-    // We share seen_operands across invocations of add_to_order to reduce
-    // overhead of constructing/allocating a set each time. Clear it before
-    // using it.
-    seen_operands.clear();
-
     // We want to be careful to only bump down our operands once, since we're a
     // single user, even though we may refer to them multiple times in our
     // operands sequence.
-    for (auto it = r->operands().rbegin(); it != r->operands().rend(); ++it) {
-      Node* operand = *it;
-      if (auto [_, inserted] = seen_operands.insert(operand); inserted) {
+    absl::Span<const int32_t> operands = graph.operands(r);
+    for (auto it = operands.rbegin(); it != operands.rend(); ++it) {
+      int64_t operand = *it;
+      if (last_bumped_by[operand] != r) {
+        last_bumped_by[operand] = r;
         bump_down_remaining_users(operand);
       }
     }
   };
 
   while (!ready.empty()) {
-    Node* r;
-    if (random_priority.has_value()) {
+    int64_t r;
+    if (!random_priority.empty()) {
       absl::c_pop_heap(ready, random_comparator);
       r = ready.back();
       ready.pop_back();
@@ -191,7 +194,12 @@ std::vector<Node*> ReverseTopoSort(FunctionBase* f,
     LOG(FATAL) << "Expected to find cycle in function base.";
   }
 
-  return ordered;
+  std::vector<Node*> result;
+  result.reserve(ordered.size());
+  for (int64_t n : ordered) {
+    result.push_back(graph.node(n));
+  }
+  return result;
 }
 
 std::vector<Node*> TopoSort(FunctionBase* f,
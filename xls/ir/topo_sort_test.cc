@@ -23,6 +23,7 @@
 #include "benchmark/benchmark.h"
 #include "gtest/gtest.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/ir/benchmark_support.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
@@ -288,6 +289,38 @@ TEST(NodeIteratorTest, RpoVsTopo) {
 
 // LINT.ThenChange(//xls/ir/block_elaboration_test.cc)
 
+TEST(NodeIteratorTest, ConcurrentTopoSortsOfOneFunction) {
+  std::string program = R"(
+  fn computation(a: bits[32], b: bits[32]) -> bits[32] {
+    x: bits[32] = add(a, b)
+    y: bits[32] = neg(x)
+    z: bits[32] = umul(x, y)
+    ret r: bits[32] = sub(z, a)
+  })";
+
+  Package p("p");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, Parser::ParseFunction(program, &p));
+
+  constexpr int64_t kThreadCount = 8;
+  std::vector<std::vector<Node*>> orders(kThreadCount);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t i = 0; i < kThreadCount; ++i) {
+    threads.push_back(std::make_unique<Thread>([&, i]() {
+      for (int64_t iteration = 0; iteration < 100; ++iteration) {
+        orders[i] = TopoSort(f);
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  std::vector<Node*> expected = TopoSort(f);
+  for (const std::vector<Node*>& order : orders) {
+    EXPECT_EQ(order, expected);
+  }
+}
+
 void BM_TopoSortBinaryTree(benchmark::State& state) {
   std::unique_ptr<VerifiedPackage> p =
       std::make_unique<VerifiedPackage>("balanced_tree_pkg");
@@ -16,12 +16,16 @@
 
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/base/call_once.h"
+#include "absl/functional/function_ref.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -40,6 +44,91 @@
 #include "xls/ir/xls_value.pb.h"
 
 namespace xls {
+namespace {
+
+// Joins with ", " the strings `to_string` returns for the elements of `value`.
+// Elements are taken one at a time, so a packed bits array is not boxed.
+std::string JoinElements(
+    const Value& value,
+    absl::FunctionRef<std::string(const Value&)> to_string) {
+  std::string result;
+  for (int64_t i = 0; i < value.size(); ++i) {
+    if (i != 0) {
+      absl::StrAppend(&result, ", ");
+    }
+    absl::StrAppend(&result, to_string(value.GetElement(i)));
+  }
+  return result;
+}
+
+}  // namespace
+
+Value::Value(ValueKind kind, absl::Span<const Value> elements) : kind_(kind) {
+  if (kind == ValueKind::kArray) {
+    if (std::shared_ptr<const PackedBitsArray> packed =
+            PackBitsArray(elements)) {
+      payload_ = std::move(packed);
+      return;
+    }
+  }
+  payload_ = std::vector<Value>(elements.begin(), elements.end());
+}
+
+Value::Value(ValueKind kind, std::vector<Value>&& elements) : kind_(kind) {
+  if (kind == ValueKind::kArray) {
+    if (std::shared_ptr<const PackedBitsArray> packed =
+            PackBitsArray(elements)) {
+      payload_ = std::move(packed);
+      return;
+    }
+  }
+  payload_ = std::move(elements);
+}
+
+/* static */ std::shared_ptr<const Value::PackedBitsArray> Value::PackBitsArray(
+    absl::Span<const Value> elements) {
+  if (elements.empty() || !elements.front().IsBits()) {
+    return nullptr;
+  }
+  const int64_t element_bit_count = elements.front().bits().bit_count();
+  for (const Value& element : elements) {
+    if (!element.IsBits() || element.bits().bit_count() != element_bit_count) {
+      return nullptr;
+    }
+  }
+  auto packed =
+      std::make_shared<PackedBitsArray>(element_bit_count, elements.size());
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    packed->bitmap.Overwrite(elements[i].bits().bitmap(),
+                             i * element_bit_count);
+  }
+  return packed;
+}
+
+/* static */ absl::Span<const Value> Value::BoxedElements(
+    const PackedBitsArray& packed) {
+  absl::call_once(packed.boxed_once, [&packed]() {
+    packed.boxed_elements.reserve(packed.size);
+    const int64_t element_bit_count = packed.element_bit_count;
+    for (int64_t i = 0; i < packed.size; ++i) {
+      packed.boxed_elements.push_back(Value(Bits::FromBitmap(
+          packed.bitmap.Slice(i * element_bit_count, element_bit_count))));
+    }
+  });
+  return packed.boxed_elements;
+}
+
+Value Value::GetElement(int64_t i) const {
+  if (const auto* packed =
+          std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+    CHECK_GE(i, 0);
+    CHECK_LT(i, (*packed)->size);
+    const int64_t element_bit_count = (*packed)->element_bit_count;
+    return Value(Bits::FromBitmap(
+        (*packed)->bitmap.Slice(i * element_bit_count, element_bit_count)));
+  }
+  return element(i);
+}
 
 /* static */ absl::StatusOr<Value> Value::Array(
     absl::Span<const Value> elements) {
@@ -60,13 +149,12 @@ namespace xls {
     return absl::UnimplementedError("Empty array Values are not supported.");
   }
 
-  std::vector<Value> elements_as_values;
-  for (auto x : elements) {
-    XLS_ASSIGN_OR_RETURN(Bits bits, UBitsWithStatus(x, bit_count));
-    elements_as_values.push_back(Value(bits));
+  auto packed = std::make_shared<PackedBitsArray>(bit_count, elements.size());
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Bits bits, UBitsWithStatus(elements[i], bit_count));
+    packed->bitmap.Overwrite(bits.bitmap(), i * bit_count);
   }
-
-  return Value::Array(elements_as_values);
+  return Value(std::shared_ptr<const PackedBitsArray>(std::move(packed)));
 }
 
 /* static */ absl::StatusOr<Value> Value::UBits2DArray(
@@ -99,13 +187,12 @@ namespace xls {
     return absl::UnimplementedError("Empty array Values are not supported.");
   }
 
-  std::vector<Value> elements_as_values;
-  for (auto x : elements) {
-    XLS_ASSIGN_OR_RETURN(Bits bits, SBitsWithStatus(x, bit_count));
-    elements_as_values.push_back(Value(bits));
+  auto packed = std::make_shared<PackedBitsArray>(bit_count, elements.size());
+  for (int64_t i = 0; i < elements.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(Bits bits, SBitsWithStatus(elements[i], bit_count));
+    packed->bitmap.Overwrite(bits.bitmap(), i * bit_count);
   }
-
-  return Value::Array(elements_as_values);
+  return Value(std::shared_ptr<const PackedBitsArray>(std::move(packed)));
 }
 
 /* static */ absl::StatusOr<Value> Value::SBits2DArray(
@@ -168,6 +255,10 @@ int64_t Value::GetFlatBitCount() const {
     if (empty()) {
       return 0;
     }
+    if (const auto* packed =
+            std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+      return (*packed)->bitmap.bit_count();
+    }
     return size() * element(0).GetFlatBitCount();
   }
   LOG(FATAL) << "Invalid value kind: " << kind();
@@ -177,6 +268,10 @@ bool Value::IsAllZeros() const {
   if (kind() == ValueKind::kBits) {
     return bits().IsZero();
   }
+  if (const auto* packed =
+          std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+    return (*packed)->bitmap.IsAllZeroes();
+  }
   if (kind() == ValueKind::kTuple || kind() == ValueKind::kArray) {
     for (const Value& e : elements()) {
       if (!e.IsAllZeros()) {
@@ -193,6 +288,10 @@ bool Value::IsAllOnes() const {
   if (kind() == ValueKind::kBits) {
     return bits().IsAllOnes();
   }
+  if (const auto* packed =
+          std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+    return (*packed)->bitmap.IsAllOnes();
+  }
   if (kind() == ValueKind::kTuple || kind() == ValueKind::kArray) {
     for (const Value& e : elements()) {
       if (!e.IsAllOnes()) {
@@ -221,13 +320,12 @@ std::string Value::ToString(FormatPreference preference) const {
                         }),
           ")");
     case ValueKind::kArray:
-      return absl::StrCat(
-          "[",
-          absl::StrJoin(elements(), ", ",
-                        [&](std::string* out, const Value& element) {
-                          absl::StrAppend(out, element.ToString(preference));
-                        }),
-          "]");
+      return absl::StrCat("[",
+                          JoinElements(*this,
+                                       [&](const Value& element) {
+                                         return element.ToString(preference);
+                                       }),
+                          "]");
     case ValueKind::kToken:
       return "token";
   }
@@ -241,8 +339,8 @@ void Value::FlattenTo(BitPushBuffer* buffer) const {
       return;
     case ValueKind::kTuple:
     case ValueKind::kArray:
-      for (const Value& element : elements()) {
-        element.FlattenTo(buffer);
+      for (int64_t i = 0; i < size(); ++i) {
+        GetElement(i).FlattenTo(buffer);
       }
       return;
     case ValueKind::kToken:
@@ -259,6 +357,24 @@ absl::Status Value::PopulateFrom(BitmapView bitmap) {
       return absl::OkStatus();
     case ValueKind::kTuple:
     case ValueKind::kArray: {
+      if (const auto* packed =
+              std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+        // Element 0 is in the most significant bits of `bitmap`, as below.
+        const int64_t element_bit_count = (*packed)->element_bit_count;
+        const int64_t count = (*packed)->size;
+        XLS_RET_CHECK_EQ(bitmap.bit_count(), element_bit_count * count);
+        auto populated =
+            std::make_shared<PackedBitsArray>(element_bit_count, count);
+        for (int64_t i = 0; i < count; ++i) {
+          populated->bitmap.Overwrite(
+              bitmap.Slice((count - 1 - i) * element_bit_count,
+                           element_bit_count)
+                  .ToBitmap(),
+              i * element_bit_count);
+        }
+        payload_ = std::shared_ptr<const PackedBitsArray>(std::move(populated));
+        return absl::OkStatus();
+      }
       // Note: when we were pushing bits into the BitPushBuffer in FlattenTo()
       // we were making the 0th element the most significant bits. That means
       // that here we have to slice from the most significant bits for element 0
@@ -285,6 +401,14 @@ absl::Status Value::PopulateFrom(BitmapView bitmap) {
 }
 
 absl::StatusOr<std::vector<Value>> Value::GetElements() const {
+  if (IsPackedBitsArray()) {
+    std::vector<Value> result;
+    result.reserve(size());
+    for (int64_t i = 0; i < size(); ++i) {
+      result.push_back(GetElement(i));
+    }
+    return result;
+  }
   if (!std::holds_alternative<std::vector<Value>>(payload_)) {
     return absl::InvalidArgumentError("Value does not hold elements.");
   }
@@ -307,11 +431,10 @@ std::string Value::ToHumanString(FormatPreference preference) const {
       return BitsToString(bits(), preference);
     case ValueKind::kArray:
       return absl::StrCat("[",
-                          absl::StrJoin(elements(), ", ",
-                                        [&](std::string* out, const Value& v) {
-                                          absl::StrAppend(
-                                              out, v.ToHumanString(preference));
-                                        }),
+                          JoinElements(*this,
+                                       [&](const Value& v) {
+                                         return v.ToHumanString(preference);
+                                       }),
                           "]");
     case ValueKind::kTuple:
       return absl::StrCat("(",
@@ -345,7 +468,8 @@ bool Value::SameTypeAs(const Value& other) const {
       }
       return true;
     case ValueKind::kArray: {
-      return size() == other.size() && element(0).SameTypeAs(other.element(0));
+      return size() == other.size() &&
+             GetElement(0).SameTypeAs(other.GetElement(0));
     }
     case ValueKind::kToken:
       return true;
@@ -375,8 +499,8 @@ absl::StatusOr<ValueProto> Value::AsProto() const {
     }
     case ValueKind::kArray: {
       ValueProto::Array* array = v.mutable_array();
-      for (const Value& e : elements()) {
-        XLS_ASSIGN_OR_RETURN(*array->add_elements(), e.AsProto());
+      for (int64_t i = 0; i < size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(*array->add_elements(), GetElement(i).AsProto());
       }
       break;
     }
@@ -471,14 +595,14 @@ absl::StatusOr<TypeProto> Value::TypeAsProto() const {
       }
       break;
     case ValueKind::kArray: {
-      if (elements().empty()) {
+      if (empty()) {
         return absl::InternalError(
             "Cannot determine type of empty array value");
       }
       proto.set_type_enum(TypeProto::ARRAY);
       proto.set_array_size(size());
       XLS_ASSIGN_OR_RETURN(*proto.mutable_array_element(),
-                           elements().front().TypeAsProto());
+                           GetElement(0).TypeAsProto());
       break;
     }
     case ValueKind::kToken:
@@ -504,6 +628,15 @@ bool Value::operator==(const Value& other) const {
     return false;
   }
 
+  if (IsPackedBitsArray() && other.IsPackedBitsArray()) {
+    const PackedBitsArray& packed =
+        *std::get<std::shared_ptr<const PackedBitsArray>>(payload_);
+    const PackedBitsArray& other_packed =
+        *std::get<std::shared_ptr<const PackedBitsArray>>(other.payload_);
+    return packed.element_bit_count == other_packed.element_bit_count &&
+           packed.bitmap == other_packed.bitmap;
+  }
+
   return absl::c_equal(elements(), other.elements());
 }
 
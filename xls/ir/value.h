@@ -17,15 +17,18 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/call_once.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bit_push_buffer.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/format_preference.h"
@@ -42,8 +45,8 @@ enum class ValueKind {
   kTuple,
 
   // Arrays must be homogeneous in their elements, and may choose to use a
-  // more efficient storage mechanism as a result. For now we always used the
-  // boxed Value type, though.
+  // more efficient storage mechanism as a result: arrays of bits are packed
+  // into a single bitmap, other arrays use the boxed Value type.
   kArray,
 
   kToken
@@ -60,6 +63,11 @@ inline std::ostream& operator<<(std::ostream& os, ValueKind kind) {
 // values, or arrays or values. Arrays are represented similarly to tuples, but
 // are monomorphic and potentially multi-dimensional.
 //
+// Arrays of bits are stored packed into a single bitmap shared between copies
+// of the Value, so large bits arrays are cheap to build, copy and index with
+// GetElement(). Accessors which return references to elements (elements(),
+// element()) box the elements of such an array the first time they are called.
+//
 // TODO(leary): 2019-04-04 Arrays are not currently multi-dimensional, we had
 // some discussion around this, maybe they should be?
 class Value {
@@ -147,11 +155,31 @@ class Value {
   absl::StatusOr<std::vector<Value>> GetElements() const;
 
   absl::Span<const Value> elements() const {
+    if (const auto* packed =
+            std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+      return BoxedElements(**packed);
+    }
     return std::get<std::vector<Value>>(payload_);
   }
   const Value& element(int64_t i) const { return elements().at(i); }
-  int64_t size() const { return elements().size(); }
-  bool empty() const { return elements().empty(); }
+  int64_t size() const {
+    if (const auto* packed =
+            std::get_if<std::shared_ptr<const PackedBitsArray>>(&payload_)) {
+      return (*packed)->size;
+    }
+    return elements().size();
+  }
+  bool empty() const { return size() == 0; }
+
+  // Returns the `i`-th element of this tuple or array. Unlike element() this
+  // does not box the elements of a packed bits array.
+  Value GetElement(int64_t i) const;
+
+  // Returns whether this is an array of bits stored packed into one bitmap.
+  bool IsPackedBitsArray() const {
+    return std::holds_alternative<std::shared_ptr<const PackedBitsArray>>(
+        payload_);
+  }
 
   // Returns the total number of bits in this value.
   int64_t GetFlatBitCount() const;
@@ -194,19 +222,49 @@ class Value {
 
   template <typename H>
   friend H AbslHashValue(H h, const Value& v) {
+    if (const auto* packed =
+            std::get_if<std::shared_ptr<const PackedBitsArray>>(&v.payload_)) {
+      return H::combine(std::move(h), v.kind_, (*packed)->element_bit_count,
+                        (*packed)->size, (*packed)->bitmap);
+    }
     return H::combine(std::move(h), v.kind_, v.payload_);
   }
 
  private:
-  Value(ValueKind kind, absl::Span<const Value> elements)
-      : kind_(kind),
-        payload_(std::vector<Value>(elements.begin(), elements.end())) {}
-
-  Value(ValueKind kind, std::vector<Value>&& elements)
-      : kind_(kind), payload_(std::move(elements)) {}
+  // The storage of an array of `size` bits values of `element_bit_count` bits
+  // each: element `i` is held in bits [i * element_bit_count, (i + 1) *
+  // element_bit_count) of `bitmap`. `boxed_elements` is only populated if a
+  // caller asks for references to the elements.
+  struct PackedBitsArray {
+    PackedBitsArray(int64_t element_bit_count, int64_t size)
+        : element_bit_count(element_bit_count),
+          size(size),
+          bitmap(element_bit_count * size) {}
+
+    int64_t element_bit_count;
+    int64_t size;
+    InlineBitmap bitmap;
+    mutable absl::once_flag boxed_once;
+    mutable std::vector<Value> boxed_elements;
+  };
+
+  Value(ValueKind kind, absl::Span<const Value> elements);
+  Value(ValueKind kind, std::vector<Value>&& elements);
+  explicit Value(std::shared_ptr<const PackedBitsArray> packed)
+      : kind_(ValueKind::kArray), payload_(std::move(packed)) {}
+
+  // Returns the elements of a bits array packed as `elements`, or nullptr if
+  // they are not all bits values.
+  static std::shared_ptr<const PackedBitsArray> PackBitsArray(
+      absl::Span<const Value> elements);
+
+  // Returns the elements of `packed`, boxing them on first use.
+  static absl::Span<const Value> BoxedElements(const PackedBitsArray& packed);
 
   ValueKind kind_;
-  std::variant<std::nullptr_t, std::vector<Value>, Bits> payload_;
+  std::variant<std::nullptr_t, std::vector<Value>, Bits,
+               std::shared_ptr<const PackedBitsArray>>
+      payload_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, const Value& value) {
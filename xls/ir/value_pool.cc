@@ -0,0 +1,60 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_pool.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+std::shared_ptr<const Value> ValuePool::Intern(Value value) {
+  absl::MutexLock lock(&state_->mutex);
+  auto it = state_->values.find(&value);
+  if (it != state_->values.end()) {
+    if (std::shared_ptr<const Value> interned = it->second.lock()) {
+      return interned;
+    }
+    // The last reference was dropped but the value has not been released
+    // yet. Replace it; the pending release leaves the new entry alone.
+    state_->values.erase(it);
+  }
+  std::shared_ptr<const Value> interned(
+      new Value(std::move(value)),
+      [state = state_](const Value* released) {
+        state->Release(released);
+        delete released;
+      });
+  state_->values.emplace(interned.get(), interned);
+  return interned;
+}
+
+int64_t ValuePool::size() const {
+  absl::MutexLock lock(&state_->mutex);
+  return state_->values.size();
+}
+
+void ValuePool::State::Release(const Value* value) {
+  absl::MutexLock lock(&mutex);
+  auto it = values.find(value);
+  if (it != values.end() && it->first == value) {
+    values.erase(it);
+  }
+}
+
+}  // namespace xls
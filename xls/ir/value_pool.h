@@ -0,0 +1,82 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_IR_VALUE_POOL_H_
+#define XLS_IR_VALUE_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// A hash-consed store of immutable Values. Interning structurally equal values
+// returns the same storage, so holders of interned values can compare them by
+// pointer and large values (e.g. ROM initializers) are stored once no matter
+// how many nodes refer to them.
+//
+// Interned values are reference counted: a value is removed from the pool
+// when the last reference to it is dropped. References may outlive the pool.
+// ValuePool is thread-safe.
+class ValuePool {
+ public:
+  ValuePool() : state_(std::make_shared<State>()) {}
+
+  ValuePool(ValuePool&&) = default;
+  ValuePool& operator=(ValuePool&&) = default;
+  ValuePool(const ValuePool&) = delete;
+  ValuePool& operator=(const ValuePool&) = delete;
+
+  // Returns the interned value structurally equal to `value`, adding it to
+  // the pool if there is none.
+  std::shared_ptr<const Value> Intern(Value value);
+
+  // Returns the number of distinct values currently in the pool.
+  int64_t size() const;
+
+ private:
+  struct PointeeHash {
+    size_t operator()(const Value* value) const {
+      return absl::HashOf(*value);
+    }
+  };
+  struct PointeeEq {
+    bool operator()(const Value* a, const Value* b) const { return *a == *b; }
+  };
+
+  // Held by the deleter of every interned value so that values may be
+  // released after the pool itself is gone.
+  struct State {
+    // Removes `value` from the pool unless it has already been replaced by
+    // an equal value interned after its last reference was dropped.
+    void Release(const Value* value);
+
+    absl::Mutex mutex;
+    absl::flat_hash_map<const Value*, std::weak_ptr<const Value>, PointeeHash,
+                        PointeeEq>
+        values ABSL_GUARDED_BY(mutex);
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_IR_VALUE_POOL_H_
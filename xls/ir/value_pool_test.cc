@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/ir/value_pool.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+TEST(ValuePoolTest, EqualValuesShareStorage) {
+  ValuePool pool;
+  std::shared_ptr<const Value> a = pool.Intern(Value(UBits(42, 32)));
+  std::shared_ptr<const Value> b = pool.Intern(Value(UBits(42, 32)));
+  std::shared_ptr<const Value> c = pool.Intern(Value(UBits(42, 33)));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, c);
+  EXPECT_EQ(*a, Value(UBits(42, 32)));
+  EXPECT_EQ(pool.size(), 2);
+}
+
+TEST(ValuePoolTest, AggregateValues) {
+  ValuePool pool;
+  Value array = Value::UBitsArray({1, 2, 3}, 8).value();
+  std::shared_ptr<const Value> a = pool.Intern(array);
+  std::shared_ptr<const Value> b =
+      pool.Intern(Value::UBitsArray({1, 2, 3}, 8).value());
+  std::shared_ptr<const Value> tuple =
+      pool.Intern(Value::Tuple({Value(UBits(1, 8)), Value(UBits(2, 8)),
+                                Value(UBits(3, 8))}));
+  EXPECT_EQ(a, b);
+  EXPECT_NE(a, tuple);
+}
+
+TEST(ValuePoolTest, ValuesAreReleasedWithTheirLastReference) {
+  ValuePool pool;
+  std::shared_ptr<const Value> a = pool.Intern(Value(UBits(1, 8)));
+  {
+    std::shared_ptr<const Value> b = pool.Intern(Value(UBits(2, 8)));
+    EXPECT_EQ(pool.size(), 2);
+  }
+  EXPECT_EQ(pool.size(), 1);
+  a.reset();
+  EXPECT_EQ(pool.size(), 0);
+  EXPECT_EQ(*pool.Intern(Value(UBits(1, 8))), Value(UBits(1, 8)));
+}
+
+TEST(ValuePoolTest, ValuesMayOutliveThePool) {
+  std::shared_ptr<const Value> value;
+  {
+    ValuePool pool;
+    value = pool.Intern(Value(UBits(7, 3)));
+  }
+  EXPECT_EQ(*value, Value(UBits(7, 3)));
+}
+
+}  // namespace
+}  // namespace xls
@@ -14,12 +14,16 @@
 
 #include "xls/ir/value.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <string_view>
+#include <vector>
 
+#include "benchmark/benchmark.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "xls/common/fuzzing/fuzztest.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/types/span.h"
@@ -778,6 +782,140 @@ TEST(ValueProto, RoundTripFlattenToPopulateFromRegression) {
   RoundTripFlattenToPopulateFrom(proto);
 }
 
+std::vector<Value> MakeBitsElements(int64_t count) {
+  std::vector<Value> elements;
+  elements.reserve(count);
+  for (int64_t i = 0; i < count; ++i) {
+    elements.push_back(Value(UBits(i, 32)));
+  }
+  return elements;
+}
+
+TEST(ValueTest, BitsArraysArePacked) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::UBitsArray({1, 2, 3}, 8));
+  EXPECT_TRUE(array.IsPackedBitsArray());
+  EXPECT_TRUE(Value::ArrayOrDie(MakeBitsElements(4)).IsPackedBitsArray());
+  EXPECT_FALSE(Value::Tuple(MakeBitsElements(4)).IsPackedBitsArray());
+  EXPECT_FALSE(Value::ArrayOrDie({Value::Tuple({Value(UBits(0, 1))})})
+                   .IsPackedBitsArray());
+  EXPECT_FALSE(Value::ArrayOrDie({array, array}).IsPackedBitsArray());
+}
+
+TEST(ValueTest, PackedBitsArrayElements) {
+  std::vector<Value> elements = MakeBitsElements(100);
+  Value array = Value::ArrayOrDie(elements);
+  ASSERT_TRUE(array.IsPackedBitsArray());
+  EXPECT_EQ(array.size(), 100);
+  EXPECT_EQ(array.GetFlatBitCount(), 3200);
+  for (int64_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(array.GetElement(i), elements[i]);
+  }
+  EXPECT_THAT(array.elements(), testing::ElementsAreArray(elements));
+  EXPECT_THAT(array.GetElements(), IsOkAndHolds(elements));
+  EXPECT_EQ(array.element(42), Value(UBits(42, 32)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(Value other, Value::UBitsArray({0, 1, 2, 3}, 32));
+  EXPECT_EQ(Value::ArrayOrDie(MakeBitsElements(4)), other);
+  EXPECT_EQ(absl::HashOf(Value::ArrayOrDie(MakeBitsElements(4))),
+            absl::HashOf(other));
+  XLS_ASSERT_OK_AND_ASSIGN(Value narrower, Value::UBitsArray({0, 1, 2, 3}, 16));
+  EXPECT_NE(narrower, other);
+  EXPECT_FALSE(narrower.SameTypeAs(other));
+  EXPECT_EQ(other.ToString(),
+            "[bits[32]:0, bits[32]:1, bits[32]:2, bits[32]:3]");
+}
+
+TEST(ValueTest, PackedBitsArrayFlattenAndPopulate) {
+  XLS_ASSERT_OK_AND_ASSIGN(Value array,
+                           Value::UBitsArray({0x12, 0x345, 0x6, 0x7ff}, 11));
+  ASSERT_TRUE(array.IsPackedBitsArray());
+  BitPushBuffer buffer;
+  array.FlattenTo(&buffer);
+  InlineBitmap bitmap = buffer.ToBitmap();
+
+  TypeManager type_manager;
+  Type* type = type_manager.GetTypeForValue(array);
+  Value round_trip = ZeroOfType(type);
+  ASSERT_TRUE(round_trip.IsPackedBitsArray());
+  XLS_ASSERT_OK(round_trip.PopulateFrom(BitmapView(bitmap)));
+  EXPECT_EQ(round_trip, array);
+  EXPECT_TRUE(round_trip.IsPackedBitsArray());
+  EXPECT_TRUE(ZeroOfType(type).IsAllZeros());
+  EXPECT_FALSE(array.IsAllZeros());
+}
+
+TEST(ValueTest, LargePackedBitsArray) {
+  constexpr int64_t kSize = 1 << 16;
+  std::vector<uint64_t> values(kSize);
+  for (int64_t i = 0; i < kSize; ++i) {
+    values[i] = i % 8;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Value array, Value::UBitsArray(values, 3));
+  EXPECT_EQ(array.GetFlatBitCount(), 3 * kSize);
+  EXPECT_EQ(array.GetElement(kSize - 1), Value(UBits(7, 3)));
+  EXPECT_EQ(array.GetElement(12345), Value(UBits(12345 % 8, 3)));
+  Value copy = array;
+  EXPECT_EQ(copy, array);
+}
+
+void BM_MakeBitsValue(benchmark::State& state) {
+  Bits bits = Bits::AllOnes(state.range(0));
+  for (auto _ : state) {
+    Value v(bits);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_MakeBitsValue)->Range(1, 1 << 12);
+
+void BM_MakeTuple(benchmark::State& state) {
+  std::vector<Value> elements = MakeBitsElements(state.range(0));
+  for (auto _ : state) {
+    Value v = Value::Tuple(elements);
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_MakeTuple)->Range(1, 1 << 10);
+
+void BM_MakeArray(benchmark::State& state) {
+  std::vector<Value> elements = MakeBitsElements(state.range(0));
+  for (auto _ : state) {
+    XLS_ASSERT_OK_AND_ASSIGN(Value v, Value::Array(elements));
+    benchmark::DoNotOptimize(v);
+  }
+}
+BENCHMARK(BM_MakeArray)->Range(1, 1 << 10);
+
+// Compares two distinct but equal arrays, the worst case for equality.
+void BM_ArrayEquality(benchmark::State& state) {
+  Value lhs = Value::ArrayOrDie(MakeBitsElements(state.range(0)));
+  Value rhs = Value::ArrayOrDie(MakeBitsElements(state.range(0)));
+  for (auto _ : state) {
+    bool eq = lhs == rhs;
+    benchmark::DoNotOptimize(eq);
+  }
+}
+BENCHMARK(BM_ArrayEquality)->Range(1, 1 << 10);
+
+void BM_ArrayGetElement(benchmark::State& state) {
+  Value array = Value::ArrayOrDie(MakeBitsElements(state.range(0)));
+  for (auto _ : state) {
+    for (int64_t i = 0; i < array.size(); ++i) {
+      Value element = array.GetElement(i);
+      benchmark::DoNotOptimize(element);
+    }
+  }
+}
+BENCHMARK(BM_ArrayGetElement)->Range(1, 1 << 10);
+
+void BM_ArrayHash(benchmark::State& state) {
+  Value value = Value::ArrayOrDie(MakeBitsElements(state.range(0)));
+  for (auto _ : state) {
+    size_t hash = absl::HashOf(value);
+    benchmark::DoNotOptimize(hash);
+  }
+}
+BENCHMARK(BM_ArrayHash)->Range(1, 1 << 10);
+
 }  // namespace
 
 }  // namespace xls
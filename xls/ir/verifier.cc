@@ -24,6 +24,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
@@ -40,6 +41,7 @@
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/caret.h"
+#include "xls/ir/change_listener.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/code_template.h"
 #include "xls/ir/dfs_visitor.h"
@@ -1068,4 +1070,312 @@ absl::Status VerifyBlock(Block* block, bool codegen) {
   return absl::OkStatus();
 }
 
+namespace {
+
+// Returns whether adding or removing `node` changes the interface or state of
+// its FunctionBase, which is verified as a whole.
+bool IsInterfaceNode(Node* node) {
+  switch (node->op()) {
+    case Op::kParam:
+    case Op::kStateRead:
+    case Op::kNext:
+    case Op::kInputPort:
+    case Op::kOutputPort:
+    case Op::kRegisterRead:
+    case Op::kRegisterWrite:
+    case Op::kInstantiationInput:
+    case Op::kInstantiationOutput:
+    case Op::kSend:
+    case Op::kReceive:
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Counts of the parts of a FunctionBase which are not nodes, to detect changes
+// to them which are not reported to change listeners.
+struct FunctionBaseShape {
+  Node* return_value = nullptr;
+  int64_t state_elements = 0;
+  int64_t channels = 0;
+  int64_t instantiations = 0;
+  int64_t ports = 0;
+  int64_t registers = 0;
+
+  bool operator==(const FunctionBaseShape& other) const = default;
+};
+
+FunctionBaseShape GetShape(FunctionBase* f) {
+  FunctionBaseShape shape;
+  if (f->IsFunction()) {
+    shape.return_value = f->AsFunctionOrDie()->return_value();
+  } else if (f->IsProc()) {
+    Proc* proc = f->AsProcOrDie();
+    shape.state_elements = proc->GetStateElementCount();
+    if (proc->is_new_style_proc()) {
+      shape.channels = proc->channels().size() + proc->interface().size();
+      shape.instantiations = proc->proc_instantiations().size();
+    }
+  } else {
+    Block* block = f->AsBlockOrDie();
+    shape.ports = block->GetPorts().size();
+    shape.registers = block->GetRegisters().size();
+    shape.instantiations = block->GetInstantiations().size();
+  }
+  return shape;
+}
+
+absl::Status VerifyFunctionBaseOfAnyKind(FunctionBase* f, bool codegen) {
+  if (f->IsFunction()) {
+    return VerifyFunction(f->AsFunctionOrDie(), codegen);
+  }
+  if (f->IsProc()) {
+    return VerifyProc(f->AsProcOrDie(), codegen);
+  }
+  return VerifyBlock(f->AsBlockOrDie(), codegen);
+}
+
+// Verifies there are no cycles through any of `roots`. Every new cycle passes
+// through a node whose operands changed, so only the operands of those nodes
+// (transitively) are searched.
+absl::Status VerifyNoCyclesThrough(absl::Span<Node* const> roots) {
+  enum class State : uint8_t { kOnStack, kDone };
+  absl::flat_hash_map<Node*, State> states;
+  // Nodes being visited, and the index of their next operand to visit.
+  std::vector<std::pair<Node*, int64_t>> stack;
+  for (Node* root : roots) {
+    if (!states.try_emplace(root, State::kOnStack).second) {
+      continue;
+    }
+    stack.push_back({root, 0});
+    while (!stack.empty()) {
+      auto [node, operand_no] = stack.back();
+      if (operand_no == node->operand_count()) {
+        states[node] = State::kDone;
+        stack.pop_back();
+        continue;
+      }
+      ++stack.back().second;
+      Node* operand = node->operand(operand_no);
+      auto [it, inserted] = states.try_emplace(operand, State::kOnStack);
+      if (inserted) {
+        stack.push_back({operand, 0});
+      } else if (it->second == State::kOnStack) {
+        return absl::InternalError(
+            StrFormat("Cycle detected in %s through node %s",
+                      node->function_base()->name(), operand->GetName()));
+      }
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Records the changes to one FunctionBase since the last verification.
+class IncrementalVerifier::Tracker : public ChangeListener {
+ public:
+  Tracker(IncrementalVerifier* verifier, FunctionBase* f)
+      : verifier_(verifier), f_(f), shape_(GetShape(f)) {
+    f_->RegisterChangeListener(this);
+  }
+  ~Tracker() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  void NodeAdded(Node* node) override {
+    added_.insert(node);
+    MarkChanged(node);
+    for (Node* operand : node->operands()) {
+      MarkChanged(operand);
+    }
+  }
+  void NodeDeleted(Node* node) override {
+    changed_.erase(node);
+    added_.erase(node);
+    rewired_.erase(node);
+    interface_changed_ = interface_changed_ || IsInterfaceNode(node);
+    channels_changed_ =
+        channels_changed_ || node->Is<Send>() || node->Is<Receive>();
+    for (Node* operand : node->operands()) {
+      MarkChanged(operand);
+    }
+    auto it = verifier_->nodes_by_id_.find(node->id());
+    if (it != verifier_->nodes_by_id_.end() && it->second == node) {
+      verifier_->nodes_by_id_.erase(it);
+    }
+  }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    MarkRewired(node);
+    MarkChanged(old_operand);
+    MarkChanged(node->operand(operand_nos.front()));
+  }
+  void OperandRemoved(Node* node, Node* old_operand) override {
+    MarkRewired(node);
+    MarkChanged(old_operand);
+  }
+  void OperandAdded(Node* node) override {
+    MarkRewired(node);
+    MarkChanged(node->operands().back());
+  }
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    f_ = nullptr;
+  }
+
+  bool deleted() const { return f_ == nullptr; }
+  bool has_changes() const {
+    return !changed_.empty() || interface_changed_ || channels_changed_ ||
+           GetShape(f_) != shape_;
+  }
+  bool channels_changed() const { return channels_changed_; }
+
+  // Verifies the FunctionBase, in full if its interface or state changed.
+  absl::Status Verify(bool codegen) {
+    Package* package = f_->package();
+    // Verify in id order so errors do not depend on pointer values.
+    std::vector<Node*> added(added_.begin(), added_.end());
+    absl::c_sort(added, Node::NodeIdLessThan());
+    for (Node* node : added) {
+      if (node->id() >= package->next_node_id()) {
+        return absl::InternalError(absl::StrFormat(
+            "ID %d larger than expected max id in package", node->id()));
+      }
+      auto [it, inserted] =
+          verifier_->nodes_by_id_.try_emplace(node->id(), node);
+      if (!inserted && it->second != node) {
+        return absl::InternalError(absl::StrFormat(
+            "ID %d is not unique; source locations of nodes with same "
+            "id:\n%s, %s",
+            node->id(), it->second->loc().ToString(), node->loc().ToString()));
+      }
+    }
+    if (interface_changed_ || GetShape(f_) != shape_) {
+      return VerifyFunctionBaseOfAnyKind(f_, codegen);
+    }
+    std::vector<Node*> changed(changed_.begin(), changed_.end());
+    absl::c_sort(changed, Node::NodeIdLessThan());
+    for (Node* node : changed) {
+      XLS_RET_CHECK(package->IsOwnedType(node->GetType())) << node->GetName();
+      XLS_RET_CHECK(node->package() == package) << node->GetName();
+      XLS_RETURN_IF_ERROR(VerifyNode(node));
+      if (f_->IsFunction() && (node->Is<Send>() || node->Is<Receive>())) {
+        return absl::InternalError(absl::StrFormat(
+            "Send and receive nodes can only be in procs, not functions (%s)",
+            node->GetName()));
+      }
+    }
+    std::vector<Node*> rewired(rewired_.begin(), rewired_.end());
+    absl::c_sort(rewired, Node::NodeIdLessThan());
+    return VerifyNoCyclesThrough(rewired);
+  }
+
+  void Reset() {
+    changed_.clear();
+    added_.clear();
+    rewired_.clear();
+    interface_changed_ = false;
+    channels_changed_ = false;
+    shape_ = GetShape(f_);
+  }
+
+ private:
+  void MarkChanged(Node* node) {
+    changed_.insert(node);
+    channels_changed_ =
+        channels_changed_ || node->Is<Send>() || node->Is<Receive>();
+  }
+  void MarkRewired(Node* node) {
+    MarkChanged(node);
+    rewired_.insert(node);
+  }
+
+  IncrementalVerifier* verifier_;
+  FunctionBase* f_;
+  FunctionBaseShape shape_;
+  // Nodes which were added, had their operands changed or gained or lost
+  // users, and the subsets of them which were added and whose operands
+  // changed.
+  absl::flat_hash_set<Node*> changed_;
+  absl::flat_hash_set<Node*> added_;
+  absl::flat_hash_set<Node*> rewired_;
+  bool interface_changed_ = false;
+  bool channels_changed_ = false;
+};
+
+IncrementalVerifier::IncrementalVerifier(Package* package, bool codegen)
+    : package_(package), codegen_(codegen) {}
+
+IncrementalVerifier::~IncrementalVerifier() { StopTracking(); }
+
+bool IncrementalVerifier::NeedsFullVerification() const {
+  if (!verified_ || package_->channels().size() != channel_count_) {
+    return true;
+  }
+  std::vector<FunctionBase*> function_bases = package_->GetFunctionBases();
+  if (function_bases.size() != trackers_.size()) {
+    return true;
+  }
+  for (FunctionBase* f : function_bases) {
+    auto it = trackers_.find(f);
+    if (it == trackers_.end() || it->second->deleted()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+absl::Status IncrementalVerifier::Verify() {
+  if (NeedsFullVerification()) {
+    return VerifyAll();
+  }
+  ++incremental_verifications_;
+  bool channels_changed = false;
+  for (FunctionBase* f : package_->GetFunctionBases()) {
+    Tracker& tracker = *trackers_.at(f);
+    if (!tracker.has_changes()) {
+      continue;
+    }
+    VLOG(4) << "Incrementally verifying " << f->name();
+    // Keep the changes of a FunctionBase which fails to verify, so they are
+    // checked again next time.
+    XLS_RETURN_IF_ERROR(tracker.Verify(codegen_));
+    channels_changed = channels_changed || tracker.channels_changed();
+    tracker.Reset();
+  }
+  if (channels_changed) {
+    XLS_RETURN_IF_ERROR(VerifyChannels(package_, codegen_));
+    XLS_RETURN_IF_ERROR(VerifyElaboration(package_));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status IncrementalVerifier::VerifyAll() {
+  ++full_verifications_;
+  StopTracking();
+  XLS_RETURN_IF_ERROR(VerifyPackage(package_, codegen_));
+  StartTracking();
+  return absl::OkStatus();
+}
+
+void IncrementalVerifier::StartTracking() {
+  for (FunctionBase* f : package_->GetFunctionBases()) {
+    trackers_[f] = std::make_unique<Tracker>(this, f);
+    for (Node* node : f->nodes()) {
+      nodes_by_id_[node->id()] = node;
+    }
+  }
+  channel_count_ = package_->channels().size();
+  verified_ = true;
+}
+
+void IncrementalVerifier::StopTracking() {
+  trackers_.clear();
+  nodes_by_id_.clear();
+  verified_ = false;
+}
+
 }  // namespace xls
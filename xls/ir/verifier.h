@@ -15,12 +15,17 @@
 #ifndef XLS_IR_VERIFIER_H_
 #define XLS_IR_VERIFIER_H_
 
+#include <cstdint>
+#include <memory>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 
 namespace xls {
 
 class Node;
 class Function;
+class FunctionBase;
 class Proc;
 class Block;
 class Package;
@@ -32,6 +37,65 @@ absl::Status VerifyFunction(Function* function, bool codegen = false);
 absl::Status VerifyProc(Proc* Proc, bool codegen = false);
 absl::Status VerifyBlock(Block* Block, bool codegen = false);
 
+// Verifies a package repeatedly while it is being transformed, re-checking
+// only what changed since the previous verification. Changes are tracked with
+// a ChangeListener on each FunctionBase of the package:
+//
+//  * nodes which were added, had their operands changed, or gained or lost
+//    users are verified with VerifyNode, and have their type, package and id
+//    checked,
+//  * cycles are searched for only among the operands of rewired nodes,
+//  * a FunctionBase is verified in full if a node was added to or removed
+//    from its interface or state (params, state reads and next values, ports,
+//    registers, instantiation inputs and outputs, sends and receives), or if
+//    its return value, state elements, ports, registers or instantiations
+//    changed by other means,
+//  * the package is verified in full the first time and whenever its set of
+//    FunctionBases or channels changed.
+//
+// Changes which neither touch nodes nor show in the counts above (e.g.,
+// renaming a FunctionBase) are only caught by the next full verification; use
+// VerifyAll at the boundaries of a pipeline. The package must outlive the
+// verifier.
+class IncrementalVerifier {
+ public:
+  explicit IncrementalVerifier(Package* package, bool codegen = false);
+  ~IncrementalVerifier();
+
+  IncrementalVerifier(const IncrementalVerifier&) = delete;
+  IncrementalVerifier& operator=(const IncrementalVerifier&) = delete;
+
+  // Verifies the changes since the previous verification, or the whole
+  // package if they could not be tracked.
+  absl::Status Verify();
+
+  // Verifies the whole package like VerifyPackage and restarts tracking.
+  absl::Status VerifyAll();
+
+  // Number of verifications of the whole package, and of only the changes.
+  int64_t full_verifications() const { return full_verifications_; }
+  int64_t incremental_verifications() const {
+    return incremental_verifications_;
+  }
+
+ private:
+  class Tracker;
+
+  bool NeedsFullVerification() const;
+  void StartTracking();
+  void StopTracking();
+
+  Package* package_;
+  bool codegen_;
+  bool verified_ = false;
+  int64_t channel_count_ = 0;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<Tracker>> trackers_;
+  // Nodes of the package by id, to check the ids of added nodes.
+  absl::flat_hash_map<int64_t, Node*> nodes_by_id_;
+  int64_t full_verifications_ = 0;
+  int64_t incremental_verifications_ = 0;
+};
+
 }  // namespace xls
 
 #endif  // XLS_IR_VERIFIER_H_
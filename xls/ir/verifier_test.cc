@@ -30,6 +30,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/value.h"
@@ -690,5 +691,56 @@ proc my_new_proc<>() {}
                                  "proc-scoped channels")));
 }
 
+TEST_F(VerifierTest, IncrementalVerifierChecksChangedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue not_neg = fb.Not(neg);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  IncrementalVerifier verifier(p.get());
+  XLS_ASSERT_OK(verifier.Verify());
+  XLS_ASSERT_OK(verifier.Verify());
+  EXPECT_EQ(verifier.full_verifications(), 1);
+  EXPECT_EQ(verifier.incremental_verifications(), 1);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * add, f->MakeNode<BinOp>(SourceInfo(), x.node(), neg.node(),
+                                     Op::kAdd));
+  XLS_ASSERT_OK(not_neg.node()->ReplaceOperandNumber(0, add));
+  XLS_ASSERT_OK(verifier.Verify());
+  EXPECT_EQ(verifier.full_verifications(), 1);
+  EXPECT_EQ(verifier.incremental_verifications(), 2);
+
+  // neg -> add -> neg.
+  ASSERT_TRUE(neg.node()->ReplaceOperand(x.node(), add));
+  EXPECT_THAT(verifier.Verify(),
+              StatusIs(absl::StatusCode::kInternal, HasSubstr("Cycle")));
+  EXPECT_EQ(verifier.full_verifications(), 1);
+  EXPECT_FALSE(VerifyPackage(p.get()).ok());
+}
+
+TEST_F(VerifierTest, IncrementalVerifierVerifiesNewFunctionsInFull) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Not(fb.Param("x", p->GetBitsType(8)));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  IncrementalVerifier verifier(p.get());
+  XLS_ASSERT_OK(verifier.Verify());
+  EXPECT_EQ(verifier.full_verifications(), 1);
+
+  FunctionBuilder other_fb("other", p.get());
+  other_fb.Negate(other_fb.Param("y", p->GetBitsType(4)));
+  XLS_ASSERT_OK(other_fb.Build().status());
+  XLS_ASSERT_OK(verifier.Verify());
+  EXPECT_EQ(verifier.full_verifications(), 2);
+  EXPECT_EQ(verifier.incremental_verifications(), 0);
+
+  XLS_ASSERT_OK(verifier.VerifyAll());
+  EXPECT_EQ(verifier.full_verifications(), 3);
+}
+
 }  // namespace
 }  // namespace xls
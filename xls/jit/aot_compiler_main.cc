@@ -41,12 +41,16 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/extract_interface.h"
 #include "xls/ir/block_elaboration.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/state_element.h"
 #include "xls/ir/type.h"
+#include "xls/ir/value.h"
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/block_jit.h"
 #include "xls/jit/function_base_jit.h"
@@ -55,6 +59,7 @@
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/llvm_type_converter.h"
 #include "xls/jit/observer.h"
+#include "xls/jit/type_layout.h"
 #include "xls/jit/type_layout.pb.h"
 
 ABSL_FLAG(std::string, input, "", "Path to the IR to compile.");
@@ -124,6 +129,15 @@ class IntermediatesObserver final : public JitObserver {
   std::string asm_;
 };
 
+// Returns the bytes of `value` in the native layout of `type`.
+std::string ToNativeLayout(const Value& value, Type* type,
+                           LlvmTypeConverter& type_converter) {
+  TypeLayout layout = type_converter.CreateTypeLayout(type);
+  std::string bytes(layout.size(), '\0');
+  layout.ValueToNativeLayout(value, reinterpret_cast<uint8_t*>(bytes.data()));
+  return bytes;
+}
+
 absl::StatusOr<AotEntrypointProto> GenerateEntrypointProto(
     Package* package, const FunctionEntrypoint& entrypoint, bool include_msan,
     LlvmTypeConverter& type_converter) {
@@ -166,6 +180,21 @@ absl::StatusOr<AotEntrypointProto> GenerateEntrypointProto(
         object_code.queue_indices().begin(), object_code.queue_indices().end());
     *proc_metadata_proto->mutable_proc_interface() =
         ExtractProcInterface(func->AsProcOrDie());
+    for (StateElement* state_element : func->AsProcOrDie()->StateElements()) {
+      proc_metadata_proto->add_initial_state(
+          ToNativeLayout(state_element->initial_value(), state_element->type(),
+                         type_converter));
+    }
+    for (Node* node : func->nodes()) {
+      if (!node->Is<Trace>()) {
+        continue;
+      }
+      for (Node* arg : node->As<Trace>()->args()) {
+        (*proc_metadata_proto
+              ->mutable_trace_operand_layouts())[arg->GetType()->ToString()] =
+            type_converter.CreateTypeLayout(arg->GetType()).ToProto();
+      }
+    }
   } else {
     XLS_RET_CHECK(func->IsBlock());
     proto.set_type(AotEntrypointProto::BLOCK);
@@ -302,6 +331,22 @@ absl::Status RealMain(const std::string& input_ir_path,
             object_code->package ? object_code->package.get() : package.get(),
             oc, include_msan, type_converter));
   }
+  if (f->IsProc() && !f->AsProcOrDie()->is_new_style_proc()) {
+    // All procs of the package were compiled so record the channels as well,
+    // which is enough to run the network without the JIT.
+    for (Channel* channel : package->channels()) {
+      AotChannelProto* channel_proto = all_entrypoints.add_channels();
+      channel_proto->set_name(channel->name());
+      *channel_proto->mutable_layout() =
+          type_converter.CreateTypeLayout(channel->type()).ToProto();
+      channel_proto->set_single_value(channel->kind() ==
+                                      ChannelKind::kSingleValue);
+      for (const Value& value : channel->initial_values()) {
+        channel_proto->add_initial_values(
+            ToNativeLayout(value, channel->type(), type_converter));
+      }
+    }
+  }
   if (output_textproto_path) {
     std::string text;
     XLS_RET_CHECK(google::protobuf::TextFormat::PrintToString(all_entrypoints, &text));
@@ -0,0 +1,477 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/aot_proc_network.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/ir/xls_type.pb.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls::aot_compile {
+namespace {
+
+void PerformStringStep(AotProcInstanceContext* thiz, char* step_string,
+                       std::string* buffer) {
+  buffer->append(step_string);
+}
+
+void PerformFormatStep(AotProcInstanceContext* thiz, JitRuntime* runtime,
+                       const uint8_t* proto_data, int64_t proto_data_size,
+                       const uint8_t* value, uint64_t format_u64,
+                       std::string* buffer) {
+  auto [it, inserted] = thiz->parsed_types.try_emplace(proto_data, nullptr);
+  if (inserted) {
+    absl::StatusOr<Type*> type = thiz->network->ParseType(
+        absl::MakeConstSpan(proto_data, proto_data_size));
+    CHECK_OK(type);
+    it->second = *type;
+  }
+  const TypeLayout* layout =
+      thiz->network->GetTraceOperandLayout(it->second->ToString());
+  if (layout == nullptr) {
+    absl::StrAppend(buffer, "<", it->second->ToString(), ">");
+    return;
+  }
+  FormatPreference format = static_cast<FormatPreference>(format_u64);
+  absl::StrAppend(buffer,
+                  layout->NativeLayoutToValue(value).ToHumanString(format));
+}
+
+void RecordTrace(AotProcInstanceContext* thiz, std::string* buffer,
+                 int64_t verbosity, InterpreterEvents* events) {
+  events->trace_msgs.push_back(
+      TraceMessage{.message = *buffer, .verbosity = verbosity});
+  delete buffer;
+}
+
+std::string* CreateTraceBuffer(AotProcInstanceContext* thiz, int64_t site_id) {
+  return new std::string();
+}
+
+void RecordAssertion(AotProcInstanceContext* thiz, const char* msg,
+                     InterpreterEvents* events) {
+  events->assert_msgs.push_back(msg);
+}
+
+bool QueueReceiveWrapper(AotProcInstanceContext* thiz, int64_t queue_index,
+                         uint8_t* buffer) {
+  return thiz->queues[queue_index]->Read(buffer);
+}
+
+void QueueSendWrapper(AotProcInstanceContext* thiz, int64_t queue_index,
+                      const uint8_t* data) {
+  thiz->queues[queue_index]->Write(data);
+}
+
+void RecordActiveNextValue(AotProcInstanceContext* thiz,
+                           int64_t state_element_idx, int64_t next_id) {
+  thiz->active_next_values[state_element_idx].insert(next_id);
+}
+
+// Node results are only recorded for an observer, which requires the JIT.
+void RecordNodeResult(AotProcInstanceContext* thiz, int64_t node_ptr,
+                      const uint8_t* data) {}
+
+constexpr AotProcVTable kVTable = {
+    .perform_string_step = &PerformStringStep,
+    .perform_format_step = &PerformFormatStep,
+    .record_trace = &RecordTrace,
+    .create_trace_buffer = &CreateTraceBuffer,
+    .record_assertion = &RecordAssertion,
+    .queue_receive_wrapper = &QueueReceiveWrapper,
+    .queue_send_wrapper = &QueueSendWrapper,
+    .record_active_next_value = &RecordActiveNextValue,
+    .record_node_result = &RecordNodeResult,
+};
+
+}  // namespace
+
+void AotChannelQueue::Write(const uint8_t* data) {
+  const int64_t element_size = this->element_size();
+  if (single_value_) {
+    buffer_.assign(data, data + element_size);
+    size_ = 1;
+    return;
+  }
+  if (element_size == 0) {
+    ++size_;
+    return;
+  }
+  int64_t capacity = buffer_.size() / element_size;
+  if (size_ == capacity) {
+    // Grow the buffer, moving the elements to the start of the new buffer.
+    std::vector<uint8_t> grown(std::max<int64_t>(2 * capacity, 4) *
+                               element_size);
+    for (int64_t i = 0; i < size_; ++i) {
+      std::memcpy(grown.data() + i * element_size,
+                  buffer_.data() + ((head_ + i) % capacity) * element_size,
+                  element_size);
+    }
+    buffer_ = std::move(grown);
+    head_ = 0;
+    capacity = buffer_.size() / element_size;
+  }
+  std::memcpy(buffer_.data() + ((head_ + size_) % capacity) * element_size,
+              data, element_size);
+  ++size_;
+}
+
+bool AotChannelQueue::Read(uint8_t* buffer) {
+  if (size_ == 0) {
+    return false;
+  }
+  const int64_t element_size = this->element_size();
+  if (element_size > 0) {
+    std::memcpy(buffer, buffer_.data() + head_ * element_size, element_size);
+  }
+  if (single_value_) {
+    return true;
+  }
+  if (element_size > 0) {
+    head_ = (head_ + 1) % (buffer_.size() / element_size);
+  }
+  --size_;
+  return true;
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<AotProcNetwork>>
+AotProcNetwork::Create(const AotPackageEntrypointsProto& proto,
+                       absl::Span<const AotProcEntrypoint> entrypoints) {
+  auto network = absl::WrapUnique(
+      new AotProcNetwork(std::make_unique<Package>("__aot_proc_network")));
+  for (const AotChannelProto& channel : proto.channels()) {
+    XLS_ASSIGN_OR_RETURN(
+        TypeLayout layout,
+        TypeLayout::FromProto(channel.layout(), network->package_.get()));
+    auto queue = std::make_unique<AotChannelQueue>(
+        channel.name(), std::move(layout), channel.single_value());
+    for (const std::string& initial_value : channel.initial_values()) {
+      XLS_RET_CHECK_EQ(initial_value.size(), queue->element_size());
+      queue->Write(reinterpret_cast<const uint8_t*>(initial_value.data()));
+    }
+    network->queues_by_name_[channel.name()] = queue.get();
+    network->queues_.push_back(std::move(queue));
+  }
+
+  absl::flat_hash_map<std::string_view, AotProcFunction> functions;
+  for (const AotProcEntrypoint& entrypoint : entrypoints) {
+    functions[entrypoint.function_symbol] = entrypoint.function;
+  }
+  for (const AotEntrypointProto& entrypoint : proto.entrypoint()) {
+    XLS_RET_CHECK_EQ(entrypoint.type(), AotEntrypointProto::PROC)
+        << "Entrypoint `" << entrypoint.xls_function_identifier()
+        << "` is not a proc";
+    auto function = functions.find(entrypoint.function_symbol());
+    if (function == functions.end()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "No function given for proc `%s` (symbol `%s`)",
+          entrypoint.xls_function_identifier(), entrypoint.function_symbol()));
+    }
+    const AotEntrypointProto::ProcMetadataProto& metadata =
+        entrypoint.proc_metadata();
+    auto proc = std::make_unique<AotProcInstanceContext>(
+        AotProcInstanceContext{.vtable = kVTable,
+                               .network = network.get(),
+                               .name = entrypoint.xls_function_identifier(),
+                               .function = function->second});
+
+    int64_t queue_count = 0;
+    for (const auto& [channel_name, queue_index] :
+         metadata.channel_queue_indices()) {
+      queue_count = std::max(queue_count, queue_index + 1);
+    }
+    proc->queues.resize(queue_count, nullptr);
+    for (const auto& [channel_name, queue_index] :
+         metadata.channel_queue_indices()) {
+      XLS_ASSIGN_OR_RETURN(proc->queues[queue_index],
+                           network->GetQueue(channel_name));
+    }
+    proc->has_io_operations = queue_count > 0;
+
+    // Lay out the input, output and temp buffers in a single allocation.
+    XLS_RET_CHECK_EQ(entrypoint.input_buffer_sizes_size(),
+                     entrypoint.output_buffer_sizes_size());
+    XLS_RET_CHECK_EQ(entrypoint.input_buffer_sizes_size(),
+                     metadata.initial_state_size());
+    int64_t arena_size = 0;
+    int64_t max_alignment = 1;
+    auto allocate = [&](int64_t size, int64_t alignment) {
+      alignment = std::max<int64_t>(alignment, 1);
+      max_alignment = std::max(max_alignment, alignment);
+      int64_t offset = RoundUpToNearest(arena_size, alignment);
+      arena_size = offset + size;
+      return offset;
+    };
+    std::vector<int64_t> input_offsets;
+    std::vector<int64_t> output_offsets;
+    for (int64_t i = 0; i < entrypoint.input_buffer_sizes_size(); ++i) {
+      input_offsets.push_back(allocate(entrypoint.input_buffer_sizes(i),
+                                       entrypoint.input_buffer_alignments(i)));
+      output_offsets.push_back(
+          allocate(entrypoint.output_buffer_sizes(i),
+                   entrypoint.output_buffer_alignments(i)));
+    }
+    int64_t temp_offset = allocate(entrypoint.temp_buffer_size(),
+                                   entrypoint.temp_buffer_alignment());
+    proc->arena = std::make_unique<uint8_t[]>(arena_size + max_alignment);
+    uint8_t* base = reinterpret_cast<uint8_t*>(RoundUpToNearest(
+        reinterpret_cast<uintptr_t>(proc->arena.get()),
+        static_cast<uintptr_t>(max_alignment)));
+    for (int64_t i = 0; i < input_offsets.size(); ++i) {
+      proc->input.push_back(base + input_offsets[i]);
+      proc->output.push_back(base + output_offsets[i]);
+      const std::string& initial_state = metadata.initial_state(i);
+      XLS_RET_CHECK_LE(initial_state.size(), entrypoint.input_buffer_sizes(i));
+      std::memcpy(proc->input.back(), initial_state.data(),
+                  initial_state.size());
+    }
+    proc->temp_buffer = base + temp_offset;
+
+    for (const TypeLayoutProto& layout_proto :
+         entrypoint.inputs_layout().layouts()) {
+      XLS_ASSIGN_OR_RETURN(
+          TypeLayout layout,
+          TypeLayout::FromProto(layout_proto, network->package_.get()));
+      proc->state_layouts.push_back(std::move(layout));
+    }
+    for (const auto& [type_string, layout_proto] :
+         metadata.trace_operand_layouts()) {
+      if (network->trace_operand_layouts_.contains(type_string)) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          TypeLayout layout,
+          TypeLayout::FromProto(layout_proto, network->package_.get()));
+      network->trace_operand_layouts_.emplace(type_string, std::move(layout));
+    }
+    network->procs_.push_back(std::move(proc));
+  }
+  return network;
+}
+
+absl::StatusOr<AotProcNetwork::NetworkTickResult>
+AotProcNetwork::TickInternal() {
+  NetworkTickResult result{.progress_made = false,
+                           .progress_made_on_io_procs = false};
+  std::vector<AotProcInstanceContext*> pending;
+  pending.reserve(procs_.size());
+  for (const std::unique_ptr<AotProcInstanceContext>& proc : procs_) {
+    pending.push_back(proc.get());
+  }
+  // Run every proc which has not completed its tick until none of them makes
+  // progress. Procs blocked on a receive are retried in the next round as an
+  // earlier proc may have sent the data they are waiting for.
+  bool progress_made_in_round = true;
+  while (!pending.empty() && progress_made_in_round) {
+    progress_made_in_round = false;
+    std::vector<AotProcInstanceContext*> still_pending;
+    for (AotProcInstanceContext* proc : pending) {
+      int64_t start_continuation_point = proc->continuation_point;
+      int64_t next_continuation_point = proc->function(
+          proc->input.data(), proc->output.data(), proc->temp_buffer,
+          &proc->events, reinterpret_cast<InstanceContext*>(proc),
+          /*jit_runtime=*/nullptr, start_continuation_point);
+      XLS_RETURN_IF_ERROR(InterpreterEventsToStatus(proc->events));
+      bool progress_made = true;
+      if (next_continuation_point == 0) {
+        for (const auto& [state_index, next_values] :
+             proc->active_next_values) {
+          if (next_values.size() > 1) {
+            return absl::AlreadyExistsError(absl::StrFormat(
+                "Multiple active next values for state element %d of proc "
+                "`%s` in a single activation: %s",
+                state_index, proc->name, absl::StrJoin(next_values, ", ")));
+          }
+        }
+        proc->active_next_values.clear();
+        proc->continuation_point = 0;
+        std::swap(proc->input, proc->output);
+      } else {
+        progress_made = next_continuation_point != start_continuation_point;
+        proc->continuation_point = next_continuation_point;
+        still_pending.push_back(proc);
+      }
+      progress_made_in_round |= progress_made;
+      result.progress_made |= progress_made;
+      result.progress_made_on_io_procs |=
+          progress_made && proc->has_io_operations;
+    }
+    pending = std::move(still_pending);
+  }
+  return result;
+}
+
+absl::Status AotProcNetwork::Tick() {
+  XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+  if (!result.progress_made) {
+    return absl::InternalError(absl::StrFormat(
+        "Proc network is deadlocked. Blocked procs: %s",
+        absl::StrJoin(procs_, ", ",
+                      [](std::string* out,
+                         const std::unique_ptr<AotProcInstanceContext>& proc) {
+                        absl::StrAppend(out, proc->name);
+                      })));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t> AotProcNetwork::TickUntilBlocked(
+    std::optional<int64_t> max_ticks) {
+  int64_t ticks = 0;
+  while (!max_ticks.has_value() || ticks < max_ticks.value()) {
+    XLS_ASSIGN_OR_RETURN(NetworkTickResult result, TickInternal());
+    if (!result.progress_made_on_io_procs) {
+      return ticks;
+    }
+    ticks++;
+  }
+  return absl::DeadlineExceededError(absl::StrFormat(
+      "Exceeded limit of %d ticks of the proc network before blocking",
+      max_ticks.value()));
+}
+
+absl::StatusOr<AotChannelQueue*> AotProcNetwork::GetQueue(
+    std::string_view channel_name) {
+  auto it = queues_by_name_.find(channel_name);
+  if (it == queues_by_name_.end()) {
+    return absl::NotFoundError(
+        absl::StrFormat("No channel named `%s` in the proc network. Were all "
+                        "procs of the package compiled together?",
+                        channel_name));
+  }
+  return it->second;
+}
+
+absl::Status AotProcNetwork::SendRaw(std::string_view channel_name,
+                                     absl::Span<const uint8_t> data) {
+  XLS_ASSIGN_OR_RETURN(AotChannelQueue * queue, GetQueue(channel_name));
+  XLS_RET_CHECK_EQ(data.size(), queue->element_size());
+  queue->Write(data.data());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<bool> AotProcNetwork::ReceiveRaw(std::string_view channel_name,
+                                                absl::Span<uint8_t> buffer) {
+  XLS_ASSIGN_OR_RETURN(AotChannelQueue * queue, GetQueue(channel_name));
+  XLS_RET_CHECK_GE(buffer.size(), queue->element_size());
+  return queue->Read(buffer.data());
+}
+
+absl::Status AotProcNetwork::SendValue(std::string_view channel_name,
+                                       const Value& value) {
+  XLS_ASSIGN_OR_RETURN(AotChannelQueue * queue, GetQueue(channel_name));
+  if (!ValueConformsToType(value, queue->layout().type())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Value `%s` does not match type %s of channel `%s`", value.ToString(),
+        queue->layout().type()->ToString(), channel_name));
+  }
+  std::vector<uint8_t> buffer(queue->element_size());
+  queue->layout().ValueToNativeLayout(value, buffer.data());
+  queue->Write(buffer.data());
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::optional<Value>> AotProcNetwork::ReceiveValue(
+    std::string_view channel_name) {
+  XLS_ASSIGN_OR_RETURN(AotChannelQueue * queue, GetQueue(channel_name));
+  std::vector<uint8_t> buffer(queue->element_size());
+  if (!queue->Read(buffer.data())) {
+    return std::nullopt;
+  }
+  return queue->layout().NativeLayoutToValue(buffer.data());
+}
+
+absl::StatusOr<const AotProcInstanceContext*> AotProcNetwork::GetProc(
+    std::string_view proc_name) const {
+  for (const std::unique_ptr<AotProcInstanceContext>& proc : procs_) {
+    if (proc->name == proc_name) {
+      return proc.get();
+    }
+  }
+  return absl::NotFoundError(
+      absl::StrFormat("No proc named `%s` in the proc network", proc_name));
+}
+
+absl::StatusOr<std::vector<Value>> AotProcNetwork::GetState(
+    std::string_view proc_name) const {
+  XLS_ASSIGN_OR_RETURN(const AotProcInstanceContext* proc, GetProc(proc_name));
+  if (proc->continuation_point != 0) {
+    return absl::FailedPreconditionError(absl::StrFormat(
+        "Proc `%s` is partway through a tick", proc_name));
+  }
+  XLS_RET_CHECK_EQ(proc->state_layouts.size(), proc->input.size());
+  std::vector<Value> state;
+  state.reserve(proc->input.size());
+  for (int64_t i = 0; i < proc->input.size(); ++i) {
+    state.push_back(proc->state_layouts[i].NativeLayoutToValue(proc->input[i]));
+  }
+  return state;
+}
+
+absl::StatusOr<const InterpreterEvents*> AotProcNetwork::GetEvents(
+    std::string_view proc_name) const {
+  XLS_ASSIGN_OR_RETURN(const AotProcInstanceContext* proc, GetProc(proc_name));
+  return &proc->events;
+}
+
+void AotProcNetwork::ClearEvents() {
+  for (const std::unique_ptr<AotProcInstanceContext>& proc : procs_) {
+    proc->events = InterpreterEvents();
+  }
+}
+
+const TypeLayout* AotProcNetwork::GetTraceOperandLayout(
+    std::string_view type_string) const {
+  auto it = trace_operand_layouts_.find(type_string);
+  return it == trace_operand_layouts_.end() ? nullptr : &it->second;
+}
+
+absl::StatusOr<Type*> AotProcNetwork::ParseType(
+    absl::Span<const uint8_t> type_proto_data) {
+  TypeProto proto;
+  if (!proto.ParseFromArray(type_proto_data.data(), type_proto_data.size())) {
+    return absl::InvalidArgumentError("Unable to parse TypeProto");
+  }
+  return package_->GetTypeFromProto(proto);
+}
+
+}  // namespace xls::aot_compile
@@ -0,0 +1,249 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Runtime for executing a network of procs which was compiled ahead of time
+// without linking in the JIT (or LLVM). All procs of the network and the
+// channels connecting them are described by the AotPackageEntrypointsProto
+// emitted alongside the object code.
+
+#ifndef XLS_JIT_AOT_PROC_NETWORK_H_
+#define XLS_JIT_AOT_PROC_NETWORK_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/events.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+// Only passed through to the compiled code as opaque pointers.
+struct InstanceContext;
+class JitRuntime;
+}  // namespace xls
+
+namespace xls::aot_compile {
+
+// Signature of an ahead-of-time compiled proc. Identical to `JitFunctionType`.
+using AotProcFunction = int64_t (*)(const uint8_t* const* inputs,
+                                    uint8_t* const* outputs, void* temp_buffer,
+                                    InterpreterEvents* events,
+                                    InstanceContext* instance_context,
+                                    JitRuntime* jit_runtime,
+                                    int64_t continuation_point);
+
+// A compiled proc and the symbol it was emitted as (the `function_symbol` of
+// its AotEntrypointProto).
+struct AotProcEntrypoint {
+  std::string_view function_symbol;
+  AotProcFunction function;
+};
+
+struct AotProcInstanceContext;
+
+// Callbacks invoked by the compiled code. The compiled code loads these by
+// offset so the layout must match `InstanceContextVTable` exactly.
+struct AotProcVTable {
+  void (*perform_string_step)(AotProcInstanceContext* thiz, char* step_string,
+                              std::string* buffer);
+  void (*perform_format_step)(AotProcInstanceContext* thiz,
+                              JitRuntime* runtime,
+                              const uint8_t* type_proto_data,
+                              int64_t type_proto_data_size,
+                              const uint8_t* value, uint64_t format_u64,
+                              std::string* buffer);
+  void (*record_trace)(AotProcInstanceContext* thiz, std::string* buffer,
+                       int64_t verbosity, InterpreterEvents* events);
+  std::string* (*create_trace_buffer)(AotProcInstanceContext* thiz,
+                                      int64_t site_id);
+  void (*record_assertion)(AotProcInstanceContext* thiz, const char* msg,
+                           InterpreterEvents* events);
+  bool (*queue_receive_wrapper)(AotProcInstanceContext* thiz,
+                                int64_t queue_index, uint8_t* buffer);
+  void (*queue_send_wrapper)(AotProcInstanceContext* thiz, int64_t queue_index,
+                             const uint8_t* data);
+  void (*record_active_next_value)(AotProcInstanceContext* thiz,
+                                   int64_t param_id, int64_t next_id);
+  void (*record_node_result)(AotProcInstanceContext* thiz, int64_t node_ptr,
+                             const uint8_t* data);
+};
+
+class AotProcNetwork;
+
+// A queue of values in the native layout of the channel's type.
+class AotChannelQueue {
+ public:
+  AotChannelQueue(std::string name, TypeLayout layout, bool single_value)
+      : name_(std::move(name)),
+        layout_(std::move(layout)),
+        single_value_(single_value) {}
+
+  const std::string& name() const { return name_; }
+  const TypeLayout& layout() const { return layout_; }
+  int64_t element_size() const { return layout_.size(); }
+  bool single_value() const { return single_value_; }
+  int64_t size() const { return size_; }
+
+  // Writes `element_size()` bytes from `data` onto the queue. Single-value
+  // channels replace their current value.
+  void Write(const uint8_t* data);
+
+  // Reads the next `element_size()` bytes into `buffer` returning false if the
+  // queue is empty. Single-value channels are not consumed by reads.
+  bool Read(uint8_t* buffer);
+
+ private:
+  std::string name_;
+  TypeLayout layout_;
+  bool single_value_;
+
+  // Ring buffer holding `size_` elements starting at element index `head_`.
+  std::vector<uint8_t> buffer_;
+  int64_t head_ = 0;
+  int64_t size_ = 0;
+};
+
+// The state of one proc of the network across (and partway through) ticks.
+struct AotProcInstanceContext {
+  // Must be first, see `AotProcVTable`.
+  AotProcVTable vtable;
+
+  AotProcNetwork* network;
+  std::string name;
+  AotProcFunction function;
+
+  // Queues indexed by the queue index used in the compiled code.
+  std::vector<AotChannelQueue*> queues;
+  bool has_io_operations;
+
+  // Storage for the state and temporary buffers.
+  std::unique_ptr<uint8_t[]> arena;
+  std::vector<uint8_t*> input;
+  std::vector<uint8_t*> output;
+  void* temp_buffer;
+  std::vector<TypeLayout> state_layouts;
+
+  int64_t continuation_point = 0;
+  absl::flat_hash_map<int64_t, absl::flat_hash_set<int64_t>>
+      active_next_values;
+  InterpreterEvents events;
+
+  // Trace operand types, keyed by the address of their serialized TypeProto
+  // embedded in the object code.
+  absl::flat_hash_map<const uint8_t*, Type*> parsed_types;
+};
+
+// A network of ahead-of-time compiled procs connected by in-memory channel
+// queues. Ticks the procs serially in the manner of the SerialProcRuntime.
+//
+// Example:
+//
+//   XLS_ASSIGN_OR_RETURN(
+//       std::unique_ptr<AotProcNetwork> network,
+//       AotProcNetwork::Create(
+//           entrypoints_proto, {{"__pkg__proc_0_next", &__pkg__proc_0_next},
+//                               {"__pkg__proc_1_next", &__pkg__proc_1_next}}));
+//   XLS_RETURN_IF_ERROR(network->SendValue("in", Value(UBits(42, 32))));
+//   XLS_RETURN_IF_ERROR(network->TickUntilBlocked().status());
+//   XLS_ASSIGN_OR_RETURN(std::optional<Value> out,
+//                        network->ReceiveValue("out"));
+class AotProcNetwork {
+ public:
+  // Creates the network described by `proto`, which must contain the channels
+  // of the network (i.e., all procs were compiled together). Each entrypoint of
+  // `proto` must have a corresponding function in `entrypoints`.
+  static absl::StatusOr<std::unique_ptr<AotProcNetwork>> Create(
+      const AotPackageEntrypointsProto& proto,
+      absl::Span<const AotProcEntrypoint> entrypoints);
+
+  // Executes a single tick of the network. Returns an error if no progress
+  // can be made due to a deadlock.
+  absl::Status Tick();
+
+  // Ticks the network until no progress is made on procs with channel
+  // operations, returning the number of ticks executed.
+  absl::StatusOr<int64_t> TickUntilBlocked(
+      std::optional<int64_t> max_ticks = std::nullopt);
+
+  // Writes/reads a value of the channel `channel_name` in the native layout of
+  // its type. `ReceiveRaw` returns false if the channel is empty.
+  absl::Status SendRaw(std::string_view channel_name,
+                       absl::Span<const uint8_t> data);
+  absl::StatusOr<bool> ReceiveRaw(std::string_view channel_name,
+                                  absl::Span<uint8_t> buffer);
+
+  // As above but converting to and from Values.
+  absl::Status SendValue(std::string_view channel_name, const Value& value);
+  absl::StatusOr<std::optional<Value>> ReceiveValue(
+      std::string_view channel_name);
+
+  // Returns the state of the given proc, which must be at the start of a tick.
+  absl::StatusOr<std::vector<Value>> GetState(std::string_view proc_name) const;
+
+  // Returns the events recorded by the given proc since the last call to
+  // `ClearEvents`.
+  absl::StatusOr<const InterpreterEvents*> GetEvents(
+      std::string_view proc_name) const;
+  void ClearEvents();
+
+  absl::Span<const std::unique_ptr<AotProcInstanceContext>> procs() const {
+    return procs_;
+  }
+
+  // Returns the layout with which trace operands of the type with the given
+  // string representation are formatted, if any.
+  const TypeLayout* GetTraceOperandLayout(std::string_view type_string) const;
+
+  // Returns the type described by the given serialized TypeProto. The types are
+  // owned by the network.
+  absl::StatusOr<Type*> ParseType(absl::Span<const uint8_t> type_proto_data);
+
+ private:
+  struct NetworkTickResult {
+    bool progress_made;
+    bool progress_made_on_io_procs;
+  };
+
+  explicit AotProcNetwork(std::unique_ptr<Package> package)
+      : package_(std::move(package)) {}
+
+  absl::StatusOr<NetworkTickResult> TickInternal();
+  absl::StatusOr<AotChannelQueue*> GetQueue(std::string_view channel_name);
+  absl::StatusOr<const AotProcInstanceContext*> GetProc(
+      std::string_view proc_name) const;
+
+  // Dummy package used for owning the Types required by the TypeLayouts.
+  std::unique_ptr<Package> package_;
+  std::vector<std::unique_ptr<AotChannelQueue>> queues_;
+  absl::flat_hash_map<std::string, AotChannelQueue*> queues_by_name_;
+  std::vector<std::unique_ptr<AotProcInstanceContext>> procs_;
+  absl::flat_hash_map<std::string, TypeLayout> trace_operand_layouts_;
+};
+
+}  // namespace xls::aot_compile
+
+#endif  // XLS_JIT_AOT_PROC_NETWORK_H_
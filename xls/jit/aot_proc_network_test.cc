@@ -0,0 +1,182 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/aot_proc_network.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/get_runfile_path.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/value.h"
+#include "xls/jit/aot_entrypoint.pb.h"
+#include "xls/jit/jit_callbacks.h"
+
+extern "C" {
+int64_t __multi_proc__proc_ten__proc_quad_0_next(  // NOLINT
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    xls::InterpreterEvents* events, xls::InstanceContext* instance_context,
+    xls::JitRuntime* jit_runtime, int64_t continuation_point);
+int64_t __multi_proc__proc_ten__proc_double_0_next(  // NOLINT
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    xls::InterpreterEvents* events, xls::InstanceContext* instance_context,
+    xls::JitRuntime* jit_runtime, int64_t continuation_point);
+int64_t __multi_proc__proc_ten_0_next(  // NOLINT
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    xls::InterpreterEvents* events, xls::InstanceContext* instance_context,
+    xls::JitRuntime* jit_runtime, int64_t continuation_point);
+}
+
+namespace xls::aot_compile {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Optional;
+
+// The compiled code calls the callbacks by their offset in the vtable.
+static_assert(offsetof(AotProcInstanceContext, vtable) == 0);
+static_assert(sizeof(AotProcVTable) == sizeof(InstanceContextVTable));
+static_assert(offsetof(AotProcVTable, perform_string_step) ==
+              InstanceContext::kPerformStringStepOffset);
+static_assert(offsetof(AotProcVTable, perform_format_step) ==
+              InstanceContext::kPerformFormatStepOffset);
+static_assert(offsetof(AotProcVTable, record_trace) ==
+              InstanceContext::kRecordTraceOffset);
+static_assert(offsetof(AotProcVTable, create_trace_buffer) ==
+              InstanceContext::kCreateTraceBufferOffset);
+static_assert(offsetof(AotProcVTable, record_assertion) ==
+              InstanceContext::kRecordAssertionOffset);
+static_assert(offsetof(AotProcVTable, queue_receive_wrapper) ==
+              InstanceContext::kQueueReceiveWrapperOffset);
+static_assert(offsetof(AotProcVTable, queue_send_wrapper) ==
+              InstanceContext::kQueueSendWrapperOffset);
+static_assert(offsetof(AotProcVTable, record_active_next_value) ==
+              InstanceContext::kRecordActiveNextValueOffset);
+static_assert(offsetof(AotProcVTable, record_node_result) ==
+              InstanceContext::kRecordNodeResultOffset);
+
+static constexpr std::string_view kMultiAotEntrypointsProto =
+    "xls/jit/multi_proc_aot.pb";
+
+absl::StatusOr<AotPackageEntrypointsProto> GetMultiEntrypointsProto() {
+  AotPackageEntrypointsProto proto;
+  XLS_ASSIGN_OR_RETURN(std::filesystem::path path,
+                       GetXlsRunfilePath(kMultiAotEntrypointsProto));
+  XLS_ASSIGN_OR_RETURN(std::string bin, GetFileContents(path));
+  XLS_RET_CHECK(proto.ParseFromString(bin));
+  return proto;
+}
+
+absl::StatusOr<std::unique_ptr<AotProcNetwork>> CreateMultiProcNetwork() {
+  XLS_ASSIGN_OR_RETURN(AotPackageEntrypointsProto proto,
+                       GetMultiEntrypointsProto());
+  return AotProcNetwork::Create(
+      proto, {{"__multi_proc__proc_ten__proc_quad_0_next",
+               &__multi_proc__proc_ten__proc_quad_0_next},
+              {"__multi_proc__proc_ten__proc_double_0_next",
+               &__multi_proc__proc_ten__proc_double_0_next},
+              {"__multi_proc__proc_ten_0_next",
+               &__multi_proc__proc_ten_0_next}});
+}
+
+TEST(AotProcNetworkTest, TickUntilBlocked) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotProcNetwork> network,
+                           CreateMultiProcNetwork());
+  EXPECT_EQ(network->procs().size(), 3);
+  XLS_ASSERT_OK(
+      network->SendValue("multi_proc__bytes_src", Value(UBits(4, 32))));
+  XLS_ASSERT_OK(
+      network->SendValue("multi_proc__bytes_src", Value(UBits(8, 32))));
+  XLS_ASSERT_OK(
+      network->SendValue("multi_proc__bytes_src", Value(UBits(16, 32))));
+  XLS_ASSERT_OK_AND_ASSIGN(int64_t count, network->TickUntilBlocked());
+  // 1 for each of the inputs and then another tick succeeds by making progress
+  // until it tries to recv from the empty channel so 4 count.
+  EXPECT_EQ(count, 4);
+  EXPECT_THAT(network->ReceiveValue("multi_proc__bytes_result"),
+              IsOkAndHolds(Optional(Value(UBits(40, 32)))));
+  EXPECT_THAT(network->ReceiveValue("multi_proc__bytes_result"),
+              IsOkAndHolds(Optional(Value(UBits(80, 32)))));
+  EXPECT_THAT(network->ReceiveValue("multi_proc__bytes_result"),
+              IsOkAndHolds(Optional(Value(UBits(160, 32)))));
+  EXPECT_THAT(network->ReceiveValue("multi_proc__bytes_result"),
+              IsOkAndHolds(std::nullopt));
+}
+
+TEST(AotProcNetworkTest, RawChannelAccess) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotProcNetwork> network,
+                           CreateMultiProcNetwork());
+  uint32_t input = 3;
+  XLS_ASSERT_OK(network->SendRaw(
+      "multi_proc__bytes_src",
+      absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(&input),
+                          sizeof(input))));
+  XLS_ASSERT_OK(network->Tick());
+  uint32_t output = 0;
+  EXPECT_THAT(network->ReceiveRaw(
+                  "multi_proc__bytes_result",
+                  absl::MakeSpan(reinterpret_cast<uint8_t*>(&output),
+                                 sizeof(output))),
+              IsOkAndHolds(true));
+  EXPECT_EQ(output, 30);
+}
+
+TEST(AotProcNetworkTest, Deadlock) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotProcNetwork> network,
+                           CreateMultiProcNetwork());
+  XLS_ASSERT_OK(
+      network->SendValue("multi_proc__bytes_src", Value(UBits(1, 32))));
+  XLS_ASSERT_OK(network->Tick());
+  EXPECT_THAT(network->Tick(), StatusIs(absl::StatusCode::kInternal,
+                                        HasSubstr("deadlocked")));
+}
+
+TEST(AotProcNetworkTest, MissingEntrypoint) {
+  XLS_ASSERT_OK_AND_ASSIGN(AotPackageEntrypointsProto proto,
+                           GetMultiEntrypointsProto());
+  EXPECT_THAT(AotProcNetwork::Create(
+                  proto, {{"__multi_proc__proc_ten_0_next",
+                           &__multi_proc__proc_ten_0_next}}),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("No function given for proc")));
+}
+
+TEST(AotProcNetworkTest, UnknownChannel) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<AotProcNetwork> network,
+                           CreateMultiProcNetwork());
+  EXPECT_THAT(network->SendValue("not_a_channel", Value(UBits(1, 32))),
+              StatusIs(absl::StatusCode::kNotFound));
+  EXPECT_THAT(network->SendValue("multi_proc__bytes_src", Value(UBits(1, 8))),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace xls::aot_compile
@@ -78,6 +78,14 @@ class BaseBlockJitWrapperContinuation {
     return inner_->SetRegisters(regs);
   }
 
+  // Overwrite all input-ports with buffers already in the native layout of
+  // the jit, e.g. the members of a generated native struct.
+  absl::Status SetInputPortsNative(absl::Span<const uint8_t* const> inputs) {
+    XLS_RET_CHECK(to_set_inputs_.empty())
+        << "Cannot use both 'set...' and all-inputs set in a single cycle.";
+    return inner_->SetInputPorts(inputs);
+  }
+
   std::vector<Value> GetOutputPorts() const { return inner_->GetOutputPorts(); }
   const absl::flat_hash_map<std::string, Value>& GetOutputPortsMap() const;
   std::vector<Value> GetRegisters() const { return inner_->GetRegisters(); }
@@ -86,6 +94,12 @@ class BaseBlockJitWrapperContinuation {
  protected:
   Value GetOutputByName(std::string_view name) const;
 
+  // Returns the buffer holding the `index`-th output port in the native layout
+  // of the jit.
+  const uint8_t* GetOutputPortNative(int64_t index) const {
+    return inner_->output_port_pointers()[index];
+  }
+
  private:
   explicit BaseBlockJitWrapperContinuation(
       std::unique_ptr<BlockJitContinuation> cont)
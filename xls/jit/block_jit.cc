@@ -14,8 +14,11 @@
 
 #include "xls/jit/block_jit.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <sstream>
@@ -28,6 +31,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
@@ -192,6 +196,14 @@ class ElaboratedBlockJit : public BlockJit {
   friend class BlockJit;
 };
 
+// Options for the codegen passes run to prepare an elaboration for the jit.
+verilog::CodegenPassOptions JitPreparationOptions() {
+  return verilog::CodegenPassOptions{
+      .codegen_options = verilog::CodegenOptions().reset(
+          FifoInstantiation::kResetPortName, /*asynchronous=*/false,
+          /*active_low=*/false, /*reset_data_path=*/false)};
+}
+
 struct ElaborationJitData {
   std::unique_ptr<Package> cloned_package;
   Block* inlined_block;
@@ -221,12 +233,9 @@ absl::StatusOr<ElaborationJitData> CloneElaborationPackage(
   XLS_ASSIGN_OR_RETURN(Block * cloned_top, jit_package->GetBlock(top_name));
   verilog::CodegenPassUnit pass_unit(jit_package.get(), cloned_top);
   verilog::CodegenPassResults results;
-  verilog::CodegenPassOptions opts{
-      .codegen_options = verilog::CodegenOptions().reset(
-          FifoInstantiation::kResetPortName, /*asynchronous=*/false,
-          /*active_low=*/false, /*reset_data_path=*/false)};
-  XLS_RETURN_IF_ERROR(
-      PrepareForJitPassPipeline()->Run(&pass_unit, opts, &results).status());
+  XLS_RETURN_IF_ERROR(PrepareForJitPassPipeline()
+                          ->Run(&pass_unit, JitPreparationOptions(), &results)
+                          .status());
   return ElaborationJitData{
       .cloned_package = std::move(jit_package),
       .inlined_block = pass_unit.top_block,
@@ -446,16 +455,102 @@ std::unique_ptr<BlockJitContinuation> BlockJit::NewContinuation() {
 }
 
 absl::Status BlockJit::RunOneCycle(BlockJitContinuation& continuation) {
+  XLS_RETURN_IF_ERROR(EvaluateCombinational(continuation));
+  AdvanceCycle(continuation);
+  return absl::OkStatus();
+}
+
+absl::Status BlockJit::EvaluateCombinational(
+    BlockJitContinuation& continuation) {
   function_.RunJittedFunction(
       continuation.input_buffers_.current(),
       continuation.output_buffers_.current(), continuation.temp_buffer_,
       &continuation.GetEvents(), /*instance_context=*/&continuation.callbacks_,
       runtime_.get(),
       /*continuation_point=*/0);
-  continuation.SwapRegisters();
   return absl::OkStatus();
 }
 
+void BlockJit::AdvanceCycle(BlockJitContinuation& continuation) {
+  continuation.SwapRegisters();
+}
+
+absl::Status BlockJit::RunCycles(BlockJitContinuation& continuation,
+                                 int64_t cycle_count,
+                                 InputProvider input_provider,
+                                 OutputSink output_sink) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  // The input and output port buffers are shared by both register banks so
+  // these pointers stay valid for the whole run.
+  absl::Span<uint8_t* const> input_ports = continuation.input_port_pointers();
+  absl::Span<uint8_t const* const> output_ports =
+      continuation.output_port_pointers();
+  // Cycle `i` runs on bank `i % 2`.
+  std::array<const JitArgumentSet*, 2> inputs;
+  std::array<JitArgumentSet*, 2> outputs;
+  for (int64_t bank = 0; bank < 2; ++bank) {
+    inputs[bank] = &continuation.input_buffers_.current();
+    outputs[bank] = &continuation.output_buffers_.current();
+    continuation.SwapRegisters();
+  }
+
+  int64_t cycle = 0;
+  // Leaves the continuation as if `RunOneCycle` had been called `cycle` times.
+  auto finish = [&](absl::Status status) {
+    if (cycle % 2 == 1) {
+      continuation.SwapRegisters();
+    }
+    return status;
+  };
+  auto check_interval = [](int64_t interval, std::string_view callback) {
+    if (interval < 1) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "%s requested an interval of %d cycles; must be at least 1",
+          callback, interval));
+    }
+    return absl::OkStatus();
+  };
+
+  int64_t next_input = 0;
+  int64_t next_output = 0;
+  while (cycle < cycle_count) {
+    if (cycle == next_input) {
+      absl::StatusOr<int64_t> interval = input_provider(cycle, input_ports);
+      if (!interval.ok()) {
+        return finish(interval.status());
+      }
+      if (absl::Status status = check_interval(*interval, "Input provider");
+          !status.ok()) {
+        return finish(status);
+      }
+      next_input = cycle + *interval;
+    }
+    // Run without returning to the callbacks until one of them is due.
+    const int64_t stop = std::min({cycle_count, next_input, next_output + 1});
+    for (; cycle < stop; ++cycle) {
+      const int64_t bank = cycle % 2;
+      function_.RunJittedFunction(*inputs[bank], *outputs[bank],
+                                  continuation.temp_buffer_,
+                                  &continuation.GetEvents(),
+                                  /*instance_context=*/&continuation.callbacks_,
+                                  runtime_.get(),
+                                  /*continuation_point=*/0);
+    }
+    if (cycle == next_output + 1) {
+      absl::StatusOr<int64_t> interval = output_sink(cycle - 1, output_ports);
+      if (!interval.ok()) {
+        return finish(interval.status());
+      }
+      if (absl::Status status = check_interval(*interval, "Output sink");
+          !status.ok()) {
+        return finish(status);
+      }
+      next_output = cycle - 1 + *interval;
+    }
+  }
+  return finish(absl::OkStatus());
+}
+
 absl::StatusOr<JitArgumentSet> BlockJitContinuation::CombineBuffers(
     const JittedFunctionBase& jit_func, const JitArgumentSet& left,
     int64_t left_count, const JitArgumentSet& rest, int64_t rest_start,
@@ -788,6 +883,399 @@ class BlockContinuationJitWrapper final : public BlockContinuation {
   // Node value observer adapter from jit api to Value.
   std::optional<RuntimeEvaluationObserverAdapter> eval_observer_;
 };
+
+// Name of the port which replaces port `port_name` of `instantiation` when
+// preparing a block for ElaboratedJitContinuation.
+std::string InstantiationPortName(Instantiation* instantiation,
+                                  std::string_view port_name) {
+  return absl::StrFormat("__%s__%s", instantiation->name(), port_name);
+}
+
+// Replaces the instantiations of `block` with ports so that it can be
+// jitted on its own. Each instantiation output becomes an input port and each
+// instantiation input becomes an output port, named by InstantiationPortName.
+absl::Status ReplaceInstantiationsWithPorts(Block* block) {
+  std::vector<Instantiation*> instantiations(
+      block->GetInstantiations().begin(), block->GetInstantiations().end());
+  for (Instantiation* instantiation : instantiations) {
+    std::vector<InstantiationOutput*> outputs(
+        block->GetInstantiationOutputs(instantiation).begin(),
+        block->GetInstantiationOutputs(instantiation).end());
+    for (InstantiationOutput* output : outputs) {
+      XLS_ASSIGN_OR_RETURN(
+          InputPort * port,
+          block->AddInputPort(
+              InstantiationPortName(instantiation, output->port_name()),
+              output->GetType(), output->loc()));
+      XLS_RETURN_IF_ERROR(output->ReplaceUsesWith(port));
+      XLS_RETURN_IF_ERROR(block->RemoveNode(output));
+    }
+    std::vector<InstantiationInput*> inputs(
+        block->GetInstantiationInputs(instantiation).begin(),
+        block->GetInstantiationInputs(instantiation).end());
+    for (InstantiationInput* input : inputs) {
+      XLS_RETURN_IF_ERROR(
+          block
+              ->AddOutputPort(
+                  InstantiationPortName(instantiation, input->port_name()),
+                  input->data(), input->loc())
+              .status());
+      XLS_RETURN_IF_ERROR(block->RemoveNode(input));
+    }
+    XLS_RETURN_IF_ERROR(block->RemoveInstantiation(instantiation));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int64_t> PortIndex(absl::Span<const std::string> port_names,
+                                  std::string_view name) {
+  auto it = absl::c_find(port_names, name);
+  XLS_RET_CHECK(it != port_names.end()) << "No port named " << name;
+  return std::distance(port_names.begin(), it);
+}
+
+// Continuation which runs each instance of an elaboration on its own block-jit
+// continuation. Each distinct block is compiled once. The values crossing
+// instance boundaries are copied between the continuations' port buffers
+// until no instance sees a changed input, after which all instances advance to
+// the next cycle together.
+class ElaboratedJitContinuation final : public BlockContinuation {
+ public:
+  static absl::StatusOr<std::unique_ptr<ElaboratedJitContinuation>> Create(
+      const BlockElaboration& elab);
+
+  const absl::flat_hash_map<std::string, Value>& output_ports() final {
+    if (!temporary_outputs_) {
+      const Instance& top = instances_.front();
+      absl::flat_hash_map<std::string, Value> outputs;
+      outputs.reserve(top_output_ports_.size());
+      for (int64_t index : top_output_ports_) {
+        outputs[top.jit->metadata().output_port_names[index]] =
+            top.jit->runtime()->UnpackBuffer(
+                top.continuation->output_port_pointers()[index],
+                top.jit->metadata().output_port_types[index]);
+      }
+      temporary_outputs_.emplace(std::move(outputs));
+    }
+    return *temporary_outputs_;
+  }
+  const absl::flat_hash_map<std::string, Value>& registers() final {
+    if (!temporary_regs_) {
+      absl::flat_hash_map<std::string, Value> regs;
+      regs.reserve(register_owners_.size());
+      for (const Instance& instance : instances_) {
+        for (auto& [name, value] : instance.continuation->GetRegistersMap()) {
+          regs[absl::StrCat(instance.register_prefix, name)] = std::move(value);
+        }
+      }
+      temporary_regs_.emplace(std::move(regs));
+    }
+    return *temporary_regs_;
+  }
+  const InterpreterEvents& events() final { return events_; }
+
+  absl::Status RunOneCycle(
+      const absl::flat_hash_map<std::string, Value>& inputs) final;
+  absl::Status SetRegisters(
+      const absl::flat_hash_map<std::string, Value>& regs) final;
+
+  void ClearObserver() override {}
+  absl::Status SetObserver(EvaluationObserver* obs) override {
+    return absl::UnimplementedError(
+        "runtime observer not supported by the elaborated jit");
+  }
+
+ private:
+  struct Instance {
+    BlockJit* jit;
+    std::unique_ptr<BlockJitContinuation> continuation;
+    std::string register_prefix;
+  };
+  // Connection from an output port of one instance to an input port of
+  // another.
+  struct Wire {
+    int64_t source_port;
+    int64_t dest_instance;
+    int64_t dest_port;
+    int64_t size;
+  };
+
+  explicit ElaboratedJitContinuation(std::unique_ptr<Package> package)
+      : package_(std::move(package)) {}
+
+  absl::Status SetTopInputPorts(
+      const absl::flat_hash_map<std::string, Value>& inputs);
+
+  // Package holding the blocks the jits were compiled from.
+  std::unique_ptr<Package> package_;
+  std::vector<std::unique_ptr<BlockJit>> jits_;
+  // Indexed by BlockInstance::index; the top instance is first.
+  std::vector<Instance> instances_;
+  // The wires driven by each instance, indexed like `instances_`.
+  std::vector<std::vector<Wire>> wires_;
+  int64_t wire_count_ = 0;
+  // Indices of the ports of the top block which are not stand-ins for
+  // instantiation ports.
+  absl::flat_hash_map<std::string, int64_t> top_input_ports_;
+  std::vector<int64_t> top_output_ports_;
+  // Map from hierarchical register name to owning instance and the name of the
+  // register in its block.
+  absl::flat_hash_map<std::string, std::pair<int64_t, std::string>>
+      register_owners_;
+  // Registers added to implement fifos, which are zeroed unless set.
+  absl::flat_hash_map<std::string, Type*> inserted_registers_;
+
+  InterpreterEvents events_;
+  std::optional<absl::flat_hash_map<std::string, Value>> temporary_outputs_;
+  std::optional<absl::flat_hash_map<std::string, Value>> temporary_regs_;
+};
+
+/* static */ absl::StatusOr<std::unique_ptr<ElaboratedJitContinuation>>
+ElaboratedJitContinuation::Create(const BlockElaboration& elab) {
+  XLS_RET_CHECK(elab.top()->block())
+      << "Top block of elaboration must be an XLS 'block' in order to use JIT";
+  std::string_view top_name = elab.top()->block().value()->name();
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> jit_package,
+      ClonePackage(elab.package(),
+                   absl::StrFormat("jit_clone_of_%s", elab.package()->name())));
+  XLS_ASSIGN_OR_RETURN(Block * cloned_top, jit_package->GetBlock(top_name));
+  verilog::CodegenPassUnit pass_unit(jit_package.get(), cloned_top);
+  verilog::CodegenPassResults results;
+  XLS_RETURN_IF_ERROR(verilog::MaterializeFifosPass()
+                          .Run(&pass_unit, JitPreparationOptions(), &results)
+                          .status());
+  XLS_ASSIGN_OR_RETURN(BlockElaboration jit_elab,
+                       BlockElaboration::Elaborate(pass_unit.top_block));
+
+  std::unique_ptr<ElaboratedJitContinuation> result(
+      new ElaboratedJitContinuation(std::move(jit_package)));
+  result->inserted_registers_ = std::move(results.inserted_registers);
+
+  // Record the connections between instances by port name before the
+  // instantiations are replaced.
+  struct NamedWire {
+    int64_t source_instance;
+    std::string source_port;
+    int64_t dest_instance;
+    std::string dest_port;
+  };
+  std::vector<NamedWire> named_wires;
+  std::vector<std::pair<Block*, std::string>> instance_blocks;
+  for (BlockInstance* inst : jit_elab.instances()) {
+    XLS_RET_CHECK(inst->block().has_value())
+        << "Instance " << inst->ToString() << " has no block";
+    Block* block = *inst->block();
+    instance_blocks.push_back({block, std::string(inst->RegisterPrefix())});
+    for (Instantiation* instantiation : block->GetInstantiations()) {
+      int64_t child =
+          inst->instantiation_to_instance().at(instantiation)->index();
+      for (InstantiationInput* input :
+           block->GetInstantiationInputs(instantiation)) {
+        named_wires.push_back(NamedWire{
+            .source_instance = inst->index(),
+            .source_port =
+                InstantiationPortName(instantiation, input->port_name()),
+            .dest_instance = child,
+            .dest_port = input->port_name()});
+      }
+      for (InstantiationOutput* output :
+           block->GetInstantiationOutputs(instantiation)) {
+        named_wires.push_back(NamedWire{
+            .source_instance = child,
+            .source_port = output->port_name(),
+            .dest_instance = inst->index(),
+            .dest_port =
+                InstantiationPortName(instantiation, output->port_name())});
+      }
+    }
+  }
+  std::vector<std::string> top_input_names;
+  for (InputPort* port : pass_unit.top_block->GetInputPorts()) {
+    top_input_names.push_back(std::string(port->name()));
+  }
+  std::vector<std::string> top_output_names;
+  for (OutputPort* port : pass_unit.top_block->GetOutputPorts()) {
+    top_output_names.push_back(std::string(port->name()));
+  }
+
+  // Compile each distinct block once.
+  absl::flat_hash_map<Block*, BlockJit*> block_jits;
+  for (Block* block : jit_elab.blocks()) {
+    XLS_RETURN_IF_ERROR(ReplaceInstantiationsWithPorts(block));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockJit> jit,
+                         BlockJit::Create(block));
+    block_jits[block] = jit.get();
+    result->jits_.push_back(std::move(jit));
+  }
+
+  for (auto& [block, prefix] : instance_blocks) {
+    BlockJit* jit = block_jits.at(block);
+    int64_t index = result->instances_.size();
+    for (const std::string& reg_name : jit->metadata().register_names) {
+      result->register_owners_[absl::StrCat(prefix, reg_name)] = {index,
+                                                                  reg_name};
+    }
+    result->instances_.push_back(
+        Instance{.jit = jit,
+                 .continuation = jit->NewContinuation(),
+                 .register_prefix = std::move(prefix)});
+  }
+
+  const BlockJit::InterfaceMetadata& top_metadata =
+      result->instances_.front().jit->metadata();
+  for (const std::string& name : top_input_names) {
+    XLS_ASSIGN_OR_RETURN(result->top_input_ports_[name],
+                         PortIndex(top_metadata.input_port_names, name));
+  }
+  for (const std::string& name : top_output_names) {
+    XLS_ASSIGN_OR_RETURN(int64_t port,
+                         PortIndex(top_metadata.output_port_names, name));
+    result->top_output_ports_.push_back(port);
+  }
+
+  result->wires_.resize(result->instances_.size());
+  for (const NamedWire& wire : named_wires) {
+    const BlockJit* source = result->instances_[wire.source_instance].jit;
+    const BlockJit* dest = result->instances_[wire.dest_instance].jit;
+    XLS_ASSIGN_OR_RETURN(
+        int64_t source_port,
+        PortIndex(source->metadata().output_port_names, wire.source_port));
+    XLS_ASSIGN_OR_RETURN(
+        int64_t dest_port,
+        PortIndex(dest->metadata().input_port_names, wire.dest_port));
+    result->wires_[wire.source_instance].push_back(
+        Wire{.source_port = source_port,
+             .dest_instance = wire.dest_instance,
+             .dest_port = dest_port,
+             .size = dest->input_port_sizes()[dest_port]});
+  }
+  result->wire_count_ = named_wires.size();
+  return result;
+}
+
+absl::Status ElaboratedJitContinuation::SetTopInputPorts(
+    const absl::flat_hash_map<std::string, Value>& inputs) {
+  const Instance& top = instances_.front();
+  const BlockJit::InterfaceMetadata& metadata = top.jit->metadata();
+  for (const auto& [name, value] : inputs) {
+    auto it = top_input_ports_.find(name);
+    if (it == top_input_ports_.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Block has no input port '%s'", name));
+    }
+    int64_t index = it->second;
+    Type* type = metadata.input_port_types[index];
+    XLS_RET_CHECK(ValueConformsToType(value, type))
+        << "input port " << name << " cannot be set to value of " << value
+        << " due to type mismatch with input port type of "
+        << type->ToString();
+    top.jit->runtime()->BlitValueToBuffer(
+        value, type,
+        absl::MakeSpan(top.continuation->input_port_pointers()[index],
+                       top.jit->input_port_sizes()[index]));
+  }
+  if (inputs.size() != top_input_ports_.size()) {
+    std::ostringstream oss;
+    for (const auto& [name, _] : top_input_ports_) {
+      if (!inputs.contains(name)) {
+        oss << "\n\tMissing input for port '" << name << "'";
+      }
+    }
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Expected %d input port values but only got %d:%s",
+                        top_input_ports_.size(), inputs.size(), oss.str()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElaboratedJitContinuation::RunOneCycle(
+    const absl::flat_hash_map<std::string, Value>& inputs) {
+  temporary_outputs_.reset();
+  temporary_regs_.reset();
+  events_.Clear();
+  XLS_RETURN_IF_ERROR(SetTopInputPorts(inputs));
+
+  // Evaluate instances in elaboration order (parents before children) until
+  // no instance has a changed input. Without combinational loops every sweep
+  // settles at least one more wire.
+  std::vector<bool> dirty(instances_.size(), true);
+  bool any_dirty = true;
+  for (int64_t sweep = 0; any_dirty; ++sweep) {
+    if (sweep > wire_count_) {
+      return absl::InternalError(
+          "Instance ports did not settle; the elaboration may contain a "
+          "combinational loop");
+    }
+    any_dirty = false;
+    for (int64_t i = 0; i < instances_.size(); ++i) {
+      if (!dirty[i]) {
+        continue;
+      }
+      dirty[i] = false;
+      Instance& instance = instances_[i];
+      // Only the events of the final evaluation are reported.
+      instance.continuation->ClearEvents();
+      XLS_RETURN_IF_ERROR(
+          instance.jit->EvaluateCombinational(*instance.continuation));
+      absl::Span<uint8_t const* const> outputs =
+          instance.continuation->output_port_pointers();
+      for (const Wire& wire : wires_[i]) {
+        BlockJitContinuation& dest_continuation =
+            *instances_[wire.dest_instance].continuation;
+        uint8_t* dest = dest_continuation.input_port_pointers()[wire.dest_port];
+        if (memcmp(dest, outputs[wire.source_port], wire.size) == 0) {
+          continue;
+        }
+        memcpy(dest, outputs[wire.source_port], wire.size);
+        dirty[wire.dest_instance] = true;
+        if (wire.dest_instance < i) {
+          any_dirty = true;
+        }
+      }
+    }
+  }
+
+  for (Instance& instance : instances_) {
+    InterpreterEvents& events = instance.continuation->GetEvents();
+    absl::c_move(events.trace_msgs, std::back_inserter(events_.trace_msgs));
+    absl::c_move(events.assert_msgs, std::back_inserter(events_.assert_msgs));
+    events_.compact_traces.Append(events.compact_traces);
+    instance.continuation->ClearEvents();
+    instance.jit->AdvanceCycle(*instance.continuation);
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ElaboratedJitContinuation::SetRegisters(
+    const absl::flat_hash_map<std::string, Value>& regs) {
+  temporary_regs_.reset();
+  std::vector<absl::flat_hash_map<std::string, Value>> instance_regs(
+      instances_.size());
+  for (const auto& [name, value] : regs) {
+    auto it = register_owners_.find(name);
+    if (it == register_owners_.end()) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Block has no register '%s'", name));
+    }
+    const auto& [instance, reg_name] = it->second;
+    instance_regs[instance][reg_name] = value;
+  }
+  // Registers inserted to implement fifos have no analogue in the original
+  // elaboration so they might not be in the register set.
+  for (const auto& [name, type] : inserted_registers_) {
+    if (!regs.contains(name)) {
+      XLS_RET_CHECK(register_owners_.contains(name)) << name;
+      const auto& [instance, reg_name] = register_owners_.at(name);
+      instance_regs[instance][reg_name] = ZeroOfType(type);
+    }
+  }
+  for (int64_t i = 0; i < instances_.size(); ++i) {
+    XLS_RETURN_IF_ERROR(
+        instances_[i].continuation->SetRegisters(instance_regs[i]));
+  }
+  return absl::OkStatus();
+}
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<BlockContinuation>>
@@ -814,4 +1302,14 @@ absl::StatusOr<JitRuntime*> JitBlockEvaluator::GetRuntime(
   return cont_wrap->runtime();
 }
 
+absl::StatusOr<std::unique_ptr<BlockContinuation>>
+ElaboratedJitBlockEvaluator::MakeNewContinuation(
+    BlockElaboration&& elaboration,
+    const absl::flat_hash_map<std::string, Value>& initial_registers) const {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ElaboratedJitContinuation> cont,
+                       ElaboratedJitContinuation::Create(elaboration));
+  XLS_RETURN_IF_ERROR(cont->SetRegisters(initial_registers));
+  return cont;
+}
+
 }  // namespace xls
@@ -26,10 +26,13 @@
 
 #include "absl/base/attributes.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/interpreter/block_evaluator.h"
+#include "xls/interpreter/simulation_snapshot.pb.h"
 #include "xls/ir/block.h"
 #include "xls/ir/block_elaboration.h"
 #include "xls/ir/elaboration.h"
@@ -95,6 +98,36 @@ class BlockJit {
   // Runs a single cycle of a block with the given continuation.
   virtual absl::Status RunOneCycle(BlockJitContinuation& continuation);
 
+  // Evaluates the output ports and next register values of the block for the
+  // current input ports and registers of `continuation` without moving it to
+  // the next cycle. May be called repeatedly as the input ports change.
+  absl::Status EvaluateCombinational(BlockJitContinuation& continuation);
+  // Moves `continuation` to the next cycle, making the register values
+  // computed by the last `EvaluateCombinational` current.
+  void AdvanceCycle(BlockJitContinuation& continuation);
+
+  // Called by `RunCycles` before cycle `cycle` (counted from the start of the
+  // run) with the JIT ABI pointers of the input ports. The provider may write
+  // new input values through them; values not written are held. Returns the
+  // number of cycles (at least 1) until the provider must be called again.
+  using InputProvider = absl::FunctionRef<absl::StatusOr<int64_t>(
+      int64_t cycle, absl::Span<uint8_t* const> input_ports)>;
+  // Called by `RunCycles` after cycle `cycle` with the JIT ABI pointers of the
+  // output ports, which hold the outputs of that cycle. Returns the number of
+  // cycles (at least 1) until the outputs must be sampled again.
+  using OutputSink = absl::FunctionRef<absl::StatusOr<int64_t>(
+      int64_t cycle, absl::Span<uint8_t const* const> output_ports)>;
+
+  // Runs `cycle_count` cycles of a block with the given continuation,
+  // equivalent to calling `RunOneCycle` that many times. Unlike a sequence of
+  // `RunOneCycle` calls, values are not marshalled between cycles: the
+  // register banks are alternated in place and the callbacks are only invoked
+  // on the cycles they request. On error the continuation reflects the cycles
+  // which completed.
+  absl::Status RunCycles(BlockJitContinuation& continuation,
+                         int64_t cycle_count, InputProvider input_provider,
+                         OutputSink output_sink);
+
   OrcJit& orc_jit() const { return *jit_; }
 
   JitRuntime* runtime() const { return runtime_.get(); }
@@ -113,6 +146,8 @@ class BlockJit {
 
   bool supports_observer() const { return supports_observer_; }
 
+  const InterfaceMetadata& metadata() const { return metadata_; }
+
  protected:
   BlockJit(InterfaceMetadata&& metadata, std::unique_ptr<JitRuntime>&& runtime,
            std::unique_ptr<OrcJit>&& jit, JittedFunctionBase&& function,
@@ -205,6 +240,16 @@ class BlockJitContinuation {
   std::vector<Value> GetRegisters() const;
   virtual absl::flat_hash_map<std::string, Value> GetRegistersMap() const;
 
+  // Captures the current register values.
+  absl::StatusOr<BlockSnapshotProto> Snapshot() const {
+    return BlockSnapshotFromRegisters(GetRegistersMap());
+  }
+  // Restores register values captured by `Snapshot`.
+  absl::Status RestoreSnapshot(const BlockSnapshotProto& snapshot) {
+    XLS_ASSIGN_OR_RETURN(auto regs, RegistersFromBlockSnapshot(snapshot));
+    return SetRegisters(regs);
+  }
+
   absl::flat_hash_map<std::string, int64_t> GetInputPortIndices() const;
   absl::flat_hash_map<std::string, int64_t> GetOutputPortIndices() const;
   virtual absl::flat_hash_map<std::string, int64_t> GetRegisterIndices() const;
@@ -246,6 +291,10 @@ class BlockJitContinuation {
   void ClearObserver() { callbacks_.observer = nullptr; }
   RuntimeObserver* observer() const { return callbacks_.observer; }
 
+  // In compact trace mode traces are recorded unformatted in the events'
+  // `compact_traces` log instead of `trace_msgs`; see `TraceSiteTable`.
+  void SetCompactTraces(bool value) { callbacks_.compact_traces = value; }
+
  protected:
   BlockJitContinuation(const BlockJit::InterfaceMetadata& metadata,
                        BlockJit* jit, const JittedFunctionBase& jit_func);
@@ -335,6 +384,26 @@ class JitBlockEvaluator : public BlockEvaluator {
 inline constexpr JitBlockEvaluator kJitBlockEvaluator(false);
 inline constexpr JitBlockEvaluator kObservableJitBlockEvaluator(true);
 
+// A jit block evaluator for hierarchical designs. Rather than inlining the
+// instantiated blocks into the top (as JitBlockEvaluator does) each distinct
+// block is compiled once, with its instantiations replaced by ports, and every
+// instance of the elaboration runs on its own continuation. Each cycle the
+// values on the instance boundaries are exchanged until they settle. Designs
+// which instantiate the same block many times compile much faster this way.
+// Runtime observers are not supported.
+class ElaboratedJitBlockEvaluator : public BlockEvaluator {
+ public:
+  constexpr ElaboratedJitBlockEvaluator() : BlockEvaluator("ElaboratedJit") {}
+
+ protected:
+  absl::StatusOr<std::unique_ptr<BlockContinuation>> MakeNewContinuation(
+      BlockElaboration&& elaboration,
+      const absl::flat_hash_map<std::string, Value>& initial_registers)
+      const override;
+};
+
+inline constexpr ElaboratedJitBlockEvaluator kElaboratedJitBlockEvaluator;
+
 }  // namespace xls
 
 #endif  // XLS_JIT_BLOCK_JIT_H_
@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -24,6 +25,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
@@ -124,6 +126,65 @@ TEST_F(BlockJitTest, DelaySlot) {
   EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(42, 8))));
 }
 
+TEST_F(BlockJitTest, RunCycles) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK_AND_ASSIGN(auto r,
+                           bb.block()->AddRegister("acc", p->GetBitsType(8)));
+  XLS_ASSERT_OK(bb.block()->AddClockPort("clk"));
+  auto inc = bb.InputPort("inc", p->GetBitsType(8));
+  auto read = bb.RegisterRead(r);
+  bb.RegisterWrite(r, bb.Add(read, inc));
+  bb.OutputPort("output", read);
+
+  XLS_ASSERT_OK_AND_ASSIGN(Block * b, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, BlockJit::Create(b));
+  auto cont = jit->NewContinuation();
+  XLS_ASSERT_OK(cont->SetRegisters({Value(UBits(0, 8))}));
+
+  // Add 1 for the first 4 cycles and 2 afterwards; sample every 3 cycles.
+  std::vector<int64_t> input_cycles;
+  std::vector<uint8_t> samples;
+  XLS_ASSERT_OK(jit->RunCycles(
+      *cont, /*cycle_count=*/10,
+      [&](int64_t cycle,
+          absl::Span<uint8_t* const> inputs) -> absl::StatusOr<int64_t> {
+        input_cycles.push_back(cycle);
+        *inputs[0] = cycle == 0 ? 1 : 2;
+        return cycle == 0 ? 4 : 100;
+      },
+      [&](int64_t cycle, absl::Span<uint8_t const* const> outputs)
+          -> absl::StatusOr<int64_t> {
+        samples.push_back(*outputs[0]);
+        return 3;
+      }));
+  EXPECT_THAT(input_cycles, ElementsAre(0, 4));
+  EXPECT_THAT(samples, ElementsAre(0, 3, 8, 14));
+  EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(16, 8))));
+
+  // The continuation can be cycled as usual afterwards, with the input held.
+  XLS_ASSERT_OK(jit->RunOneCycle(*cont));
+  EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(18, 8))));
+  EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(16, 8))));
+
+  // An odd number of cycles leaves the register banks consistent too.
+  auto every_cycle = [](int64_t, auto) -> absl::StatusOr<int64_t> {
+    return 1;
+  };
+  XLS_ASSERT_OK(jit->RunCycles(*cont, /*cycle_count=*/3, every_cycle,
+                               every_cycle));
+  EXPECT_THAT(cont->GetRegisters(), ElementsAre(Value(UBits(24, 8))));
+  EXPECT_THAT(cont->GetOutputPorts(), ElementsAre(Value(UBits(22, 8))));
+
+  auto never_again = [](int64_t, auto) -> absl::StatusOr<int64_t> {
+    return 0;
+  };
+  EXPECT_THAT(jit->RunCycles(*cont, /*cycle_count=*/3, never_again,
+                             every_cycle),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       ContainsRegex("at least 1")));
+}
+
 TEST_F(BlockJitTest, SetInputsWithViews) {
   auto p = CreatePackage();
   BlockBuilder bb(TestName(), p.get());
@@ -337,9 +398,14 @@ inline constexpr BlockEvaluatorTestParam kJitTestNoObserverParam = {
     .supports_fifos = true,
     .supports_observer = false};
 
+inline constexpr BlockEvaluatorTestParam kElaboratedJitTestParam = {
+    .evaluator = &kElaboratedJitBlockEvaluator,
+    .supports_fifos = true,
+    .supports_observer = false};
+
 INSTANTIATE_TEST_SUITE_P(JitBlockCommonTest, BlockEvaluatorTest,
-                         testing::Values(kJitTestParam,
-                                         kJitTestNoObserverParam),
+                         testing::Values(kJitTestParam, kJitTestNoObserverParam,
+                                         kElaboratedJitTestParam),
                          [](const auto& v) {
                            return std::string(v.param.evaluator->name());
                          });
@@ -348,5 +414,10 @@ INSTANTIATE_TEST_SUITE_P(
     BlockJitFifoTest, FifoTest,
     testing::ValuesIn(GenerateFifoTestParams(kJitTestParam)), FifoTestName);
 
+INSTANTIATE_TEST_SUITE_P(
+    ElaboratedBlockJitFifoTest, FifoTest,
+    testing::ValuesIn(GenerateFifoTestParams(kElaboratedJitTestParam)),
+    FifoTestName);
+
 }  // namespace
 }  // namespace xls
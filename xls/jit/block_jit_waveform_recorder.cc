@@ -0,0 +1,122 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit_waveform_recorder.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/vcd_writer.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+
+namespace xls {
+namespace {
+
+absl::Span<const uint8_t* const> AsConst(absl::Span<uint8_t* const> pointers) {
+  return absl::Span<const uint8_t* const>(pointers.data(), pointers.size());
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<BlockJitWaveformRecorder>>
+BlockJitWaveformRecorder::Create(BlockJit* jit,
+                                 BlockJitContinuation& continuation,
+                                 std::ostream* out) {
+  std::unique_ptr<BlockJitWaveformRecorder> recorder(
+      new BlockJitWaveformRecorder(jit, out));
+  const BlockJit::InterfaceMetadata& metadata = jit->metadata();
+  XLS_ASSIGN_OR_RETURN(recorder->clock_,
+                       recorder->writer_.AddSignal("", "clk", /*width=*/1));
+  XLS_RETURN_IF_ERROR(recorder->AddSignals("", metadata.input_port_names,
+                                           metadata.input_port_types,
+                                           recorder->inputs_));
+  XLS_RETURN_IF_ERROR(recorder->AddSignals("", metadata.output_port_names,
+                                           metadata.output_port_types,
+                                           recorder->outputs_));
+  XLS_RETURN_IF_ERROR(recorder->AddSignals("registers", metadata.register_names,
+                                           metadata.register_types,
+                                           recorder->registers_));
+  recorder->recorded_.resize(recorder->writer_.signal_count(), false);
+  XLS_RETURN_IF_ERROR(recorder->writer_.WriteHeader(metadata.block_name));
+
+  recorder->writer_.Change(recorder->clock_, "0");
+  recorder->RecordSignals(recorder->registers_,
+                          AsConst(continuation.register_pointers()));
+  return recorder;
+}
+
+absl::Status BlockJitWaveformRecorder::AddSignals(
+    std::string_view scope, absl::Span<const std::string> names,
+    absl::Span<Type* const> types, std::vector<Signal>& signals) {
+  XLS_RET_CHECK_EQ(names.size(), types.size());
+  for (int64_t i = 0; i < names.size(); ++i) {
+    int64_t width = types[i]->GetFlatBitCount();
+    if (width == 0) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(VcdWriter::SignalId id,
+                         writer_.AddSignal(scope, names[i], width));
+    int64_t size = jit_->runtime()->GetTypeByteSize(types[i]);
+    signals.push_back(Signal{.id = id,
+                             .index = i,
+                             .type = types[i],
+                             .offset = static_cast<int64_t>(snapshot_.size()),
+                             .size = size});
+    snapshot_.resize(snapshot_.size() + size);
+  }
+  return absl::OkStatus();
+}
+
+void BlockJitWaveformRecorder::RecordSignals(
+    absl::Span<const Signal> signals,
+    absl::Span<const uint8_t* const> pointers) {
+  for (const Signal& signal : signals) {
+    const uint8_t* data = pointers[signal.index];
+    uint8_t* previous = snapshot_.data() + signal.offset;
+    if (recorded_[signal.id] &&
+        std::memcmp(previous, data, signal.size) == 0) {
+      continue;
+    }
+    recorded_[signal.id] = true;
+    std::memcpy(previous, data, signal.size);
+    writer_.Change(signal.id, jit_->runtime()->UnpackBuffer(data, signal.type));
+  }
+}
+
+absl::Status BlockJitWaveformRecorder::RecordCycle(
+    const BlockJitContinuation& continuation) {
+  XLS_RETURN_IF_ERROR(writer_.SetTime(2 * cycle_count_));
+  writer_.Change(clock_, "0");
+  RecordSignals(inputs_, AsConst(continuation.input_port_pointers()));
+  RecordSignals(outputs_, continuation.output_port_pointers());
+  XLS_RETURN_IF_ERROR(writer_.SetTime(2 * cycle_count_ + 1));
+  writer_.Change(clock_, "1");
+  RecordSignals(registers_, AsConst(continuation.register_pointers()));
+  ++cycle_count_;
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,99 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_BLOCK_JIT_WAVEFORM_RECORDER_H_
+#define XLS_JIT_BLOCK_JIT_WAVEFORM_RECORDER_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/vcd_writer.h"
+#include "xls/ir/type.h"
+#include "xls/jit/block_jit.h"
+
+namespace xls {
+
+// Records the ports and registers of a block simulated with a `BlockJit` as a
+// VCD waveform, with the same timing as `BlockWaveformRecorder`. Values are
+// compared to the previous cycle in their JIT representation and only
+// converted when they change, so recording costs little more than a copy of
+// the block's state per cycle.
+class BlockJitWaveformRecorder {
+ public:
+  // Creates a recorder writing to `out`, which must outlive the recorder.
+  // Records the current register values of `continuation` as the initial
+  // state.
+  static absl::StatusOr<std::unique_ptr<BlockJitWaveformRecorder>> Create(
+      BlockJit* jit, BlockJitContinuation& continuation, std::ostream* out);
+
+  // Records the cycle `continuation` just ran.
+  absl::Status RecordCycle(const BlockJitContinuation& continuation);
+
+  // Runs one cycle of `continuation` and records it.
+  absl::Status RunOneCycle(BlockJitContinuation& continuation) {
+    XLS_RETURN_IF_ERROR(jit_->RunOneCycle(continuation));
+    return RecordCycle(continuation);
+  }
+
+  // Writes all buffered output to the stream.
+  void Flush() { writer_.Flush(); }
+
+  // Number of cycles recorded so far.
+  int64_t cycle_count() const { return cycle_count_; }
+
+ private:
+  struct Signal {
+    VcdWriter::SignalId id;
+    // Index of the value in the continuation's port or register pointers.
+    int64_t index;
+    Type* type;
+    // Location of the previously recorded JIT representation in `snapshot_`.
+    int64_t offset;
+    int64_t size;
+  };
+
+  BlockJitWaveformRecorder(BlockJit* jit, std::ostream* out)
+      : jit_(jit), writer_(out) {}
+
+  absl::Status AddSignals(std::string_view scope,
+                          absl::Span<const std::string> names,
+                          absl::Span<Type* const> types,
+                          std::vector<Signal>& signals);
+  void RecordSignals(absl::Span<const Signal> signals,
+                     absl::Span<const uint8_t* const> pointers);
+
+  BlockJit* jit_;
+  VcdWriter writer_;
+  VcdWriter::SignalId clock_;
+  std::vector<Signal> inputs_;
+  std::vector<Signal> outputs_;
+  std::vector<Signal> registers_;
+  // The JIT representation of every signal as of its last recording.
+  std::vector<uint8_t> snapshot_;
+  // Whether each signal (by id) has been recorded yet.
+  std::vector<bool> recorded_;
+  int64_t cycle_count_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_BLOCK_JIT_WAVEFORM_RECORDER_H_
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/block_jit_waveform_recorder.h"
+
+#include <memory>
+#include <sstream>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+
+namespace xls {
+namespace {
+
+TEST(BlockJitWaveformRecorderTest, RecordsPortsAndRegisters) {
+  Package package("test");
+  BlockBuilder bb("my_block", &package);
+  XLS_ASSERT_OK(bb.AddClockPort("clk"));
+  BValue x = bb.InputPort("x", package.GetBitsType(8));
+  bb.OutputPort("out", bb.InsertRegister("r", x));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BlockJit> jit,
+                           BlockJit::Create(block));
+  std::unique_ptr<BlockJitContinuation> continuation = jit->NewContinuation();
+  std::stringstream out;
+  {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        std::unique_ptr<BlockJitWaveformRecorder> recorder,
+        BlockJitWaveformRecorder::Create(jit.get(), *continuation, &out));
+    XLS_ASSERT_OK(continuation->SetInputPorts({Value(UBits(5, 8))}));
+    XLS_ASSERT_OK(recorder->RunOneCycle(*continuation));
+    XLS_ASSERT_OK(recorder->RunOneCycle(*continuation));
+    XLS_ASSERT_OK(continuation->SetInputPorts({Value(UBits(3, 8))}));
+    XLS_ASSERT_OK(recorder->RunOneCycle(*continuation));
+    EXPECT_EQ(recorder->cycle_count(), 3);
+  }
+  EXPECT_EQ(out.str(), R"($timescale 1ns $end
+$scope module my_block $end
+$var wire 1 ! clk $end
+$var wire 8 " x $end
+$var wire 8 # out $end
+$scope module registers $end
+$var wire 8 $ r $end
+$upscope $end
+$upscope $end
+$enddefinitions $end
+#0
+0!
+b0 $
+b101 "
+b0 #
+#1
+1!
+b101 $
+#2
+0!
+b101 #
+#3
+1!
+#4
+0!
+b11 "
+#5
+1!
+b11 $
+)");
+}
+
+}  // namespace
+}  // namespace xls
@@ -1258,6 +1258,111 @@ absl::StatusOr<llvm::Function*> BuildPackedWrapper(
   return wrapper.function();
 }
 
+// Returns the distance in bytes between consecutive elements of a batched
+// (struct-of-arrays) buffer holding values of the given size and alignment.
+int64_t BatchedElementStride(int64_t size, int64_t alignment) {
+  return RoundUpToNearest(size, std::max(alignment, int64_t{1}));
+}
+
+// Builds a wrapper around `callee` which invokes it once for each element of
+// a batch. The wrapper has the same signature as JitFunctionType except the
+// final argument is the number of elements in the batch. Each pointer in the
+// `inputs` and `outputs` arrays refers to a struct-of-arrays buffer holding
+// consecutive native-layout values of the corresponding input/output with a
+// stride of `input_strides[i]`/`output_strides[i]` bytes. The temp buffer is
+// reused across iterations. `callee` must not have any continuation points.
+absl::StatusOr<llvm::Function*> BuildBatchedWrapper(
+    FunctionBase* xls_function, llvm::Function* callee,
+    absl::Span<const int64_t> input_strides,
+    absl::Span<const int64_t> output_strides, JitBuilderContext& jit_context) {
+  llvm::LLVMContext* context = &jit_context.context();
+  llvm::Type* i64 = llvm::Type::getInt64Ty(*context);
+  llvm::Type* i8 = llvm::Type::getInt8Ty(*context);
+  llvm::Type* ptr_type = llvm::PointerType::get(*context, 0);
+  std::vector<Node*> inputs = GetJittedFunctionInputs(xls_function);
+  std::vector<Node*> outputs = GetJittedFunctionOutputs(xls_function);
+  XLS_RET_CHECK_EQ(inputs.size(), input_strides.size());
+  XLS_RET_CHECK_EQ(outputs.size(), output_strides.size());
+  LlvmFunctionWrapper wrapper = LlvmFunctionWrapper::Create(
+      absl::StrFormat("%s_batched", xls_function->name()), inputs, outputs, i64,
+      jit_context,
+      LlvmFunctionWrapper::FunctionArg{.name = "batch_size", .type = i64});
+  llvm::Function* fn = wrapper.function();
+  llvm::IRBuilder<>& entry = wrapper.entry_builder();
+
+  // Arrays of pointers to the current element of each input/output, passed on
+  // to the wrapped function.
+  llvm::Value* input_arg_array =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, inputs.size()));
+  llvm::Value* output_arg_array =
+      entry.CreateAlloca(llvm::ArrayType::get(ptr_type, outputs.size()));
+  llvm::Type* pointer_array_type = llvm::ArrayType::get(ptr_type, 0);
+  auto array_slot = [&](llvm::IRBuilder<>& builder, llvm::Value* array,
+                        int64_t i) {
+    return builder.CreateGEP(
+        pointer_array_type, array,
+        {
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+            llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), i),
+        });
+  };
+
+  // Load the base pointers of the batched buffers once, outside the loop.
+  std::vector<llvm::Value*> input_bases;
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    input_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetInputsArg(), &entry));
+  }
+  std::vector<llvm::Value*> output_bases;
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    output_bases.push_back(
+        LoadPointerFromPointerArray(i, wrapper.GetOutputsArg(), &entry));
+  }
+
+  llvm::BasicBlock* entry_block = entry.GetInsertBlock();
+  llvm::BasicBlock* header = llvm::BasicBlock::Create(*context, "header", fn);
+  llvm::BasicBlock* body = llvm::BasicBlock::Create(*context, "body", fn);
+  llvm::BasicBlock* exit = llvm::BasicBlock::Create(*context, "exit", fn);
+  entry.CreateBr(header);
+
+  llvm::IRBuilder<> header_builder(header);
+  llvm::PHINode* index = header_builder.CreatePHI(i64, 2, "index");
+  index->addIncoming(llvm::ConstantInt::get(i64, 0), entry_block);
+  header_builder.CreateCondBr(
+      header_builder.CreateICmpSLT(index, *wrapper.GetExtraArg()), body, exit);
+
+  llvm::IRBuilder<> body_builder(body);
+  for (int64_t i = 0; i < inputs.size(); ++i) {
+    llvm::Value* offset = body_builder.CreateMul(
+        index, llvm::ConstantInt::get(i64, input_strides[i]));
+    body_builder.CreateStore(
+        body_builder.CreateGEP(i8, input_bases[i], offset),
+        array_slot(body_builder, input_arg_array, i));
+  }
+  for (int64_t i = 0; i < outputs.size(); ++i) {
+    llvm::Value* offset = body_builder.CreateMul(
+        index, llvm::ConstantInt::get(i64, output_strides[i]));
+    body_builder.CreateStore(
+        body_builder.CreateGEP(i8, output_bases[i], offset),
+        array_slot(body_builder, output_arg_array, i));
+  }
+  body_builder.CreateCall(
+      callee, {input_arg_array, output_arg_array, wrapper.GetTempBufferArg(),
+               wrapper.GetInterpreterEventsArg(),
+               wrapper.GetInstanceContextArg(), wrapper.GetJitRuntimeArg(),
+               /*continuation_point=*/llvm::ConstantInt::get(i64, 0)});
+  llvm::Value* next_index =
+      body_builder.CreateAdd(index, llvm::ConstantInt::get(i64, 1));
+  index->addIncoming(next_index, body);
+  body_builder.CreateBr(header);
+
+  llvm::IRBuilder<> exit_builder(exit);
+  // Return value of zero means that the FunctionBase completed execution.
+  exit_builder.CreateRet(llvm::ConstantInt::get(i64, 0));
+
+  return fn;
+}
+
 }  // namespace
 
 JitArgumentSet JittedFunctionBase::CreateInputBuffer() const {
@@ -1324,6 +1429,28 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
         BuildPackedWrapper(xls_function, top_function, jit_context));
     packed_wrapper_name = packed_wrapper_function->getName().str();
   }
+  std::string batched_wrapper_name;
+  std::vector<int64_t> batched_input_strides;
+  std::vector<int64_t> batched_output_strides;
+  if (build_packed_wrapper) {
+    for (const Node* input : GetJittedFunctionInputs(xls_function)) {
+      Type* input_type = InputType(input);
+      batched_input_strides.push_back(BatchedElementStride(
+          jit_context.type_converter().GetTypeByteSize(input_type),
+          jit_context.type_converter().GetTypePreferredAlignment(input_type)));
+    }
+    for (const Node* output : GetJittedFunctionOutputs(xls_function)) {
+      Type* output_type = OutputType(output);
+      batched_output_strides.push_back(BatchedElementStride(
+          jit_context.type_converter().GetTypeByteSize(output_type),
+          jit_context.type_converter().GetTypePreferredAlignment(output_type)));
+    }
+    XLS_ASSIGN_OR_RETURN(
+        llvm::Function * batched_wrapper_function,
+        BuildBatchedWrapper(xls_function, top_function, batched_input_strides,
+                            batched_output_strides, jit_context));
+    batched_wrapper_name = batched_wrapper_function->getName().str();
+  }
 
   XLS_RETURN_IF_ERROR(
       jit_context.llvm_compiler().CompileModule(jit_context.ConsumeModule()));
@@ -1355,6 +1482,20 @@ absl::StatusOr<JittedFunctionBase> JittedFunctionBase::BuildInternal(
       // actually try to invoke it.
       jitted_function.packed_function_ = InvalidJitFunctionUse;
     }
+
+    jitted_function.batched_function_name_ = batched_wrapper_name;
+    jitted_function.batched_input_strides_ = std::move(batched_input_strides);
+    jitted_function.batched_output_strides_ = std::move(batched_output_strides);
+    if (jit_context.llvm_compiler().IsOrcJit()) {
+      XLS_ASSIGN_OR_RETURN(auto* orc_jit,
+                           jit_context.llvm_compiler().AsOrcJit());
+      XLS_ASSIGN_OR_RETURN(auto batched_fn_address,
+                           orc_jit->LoadSymbol(batched_wrapper_name));
+      jitted_function.batched_function_ =
+          absl::bit_cast<JitFunctionType>(batched_fn_address);
+    } else {
+      jitted_function.batched_function_ = InvalidJitFunctionUse;
+    }
   }
 
   for (const Node* input : GetJittedFunctionInputs(xls_function)) {
@@ -1560,4 +1701,15 @@ std::optional<int64_t> JittedFunctionBase::RunPackedJittedFunction(
   }
   return std::nullopt;
 }
+
+std::optional<int64_t> JittedFunctionBase::RunBatchedJittedFunction(
+    const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+    InterpreterEvents* events, InstanceContext* instance_context,
+    JitRuntime* jit_runtime, int64_t batch_size) const {
+  if (batched_function_) {
+    return (*batched_function_)(inputs, outputs, temp_buffer, events,
+                                instance_context, jit_runtime, batch_size);
+  }
+  return std::nullopt;
+}
 }  // namespace xls
@@ -159,6 +159,35 @@ class JittedFunctionBase {
                : std::nullopt;
   }
 
+  // Execute the batched version of the function which evaluates the function
+  // `batch_size` times. Each entry of `inputs` and `outputs` points to a
+  // struct-of-arrays buffer holding `batch_size` consecutive native-layout
+  // values with a stride given by `batched_input_strides()` and
+  // `batched_output_strides()` respectively. Each buffer must be aligned to
+  // the corresponding preferred alignment. Returns std::nullopt if there is no
+  // batched version of the function.
+  std::optional<int64_t> RunBatchedJittedFunction(
+      const uint8_t* const* inputs, uint8_t* const* outputs, void* temp_buffer,
+      InterpreterEvents* events, InstanceContext* instance_context,
+      JitRuntime* jit_runtime, int64_t batch_size) const;
+
+  // Checks if we have a batched version of the function.
+  bool HasBatchedFunction() const { return batched_function_.has_value(); }
+  std::optional<std::string_view> batched_function_name() const {
+    return HasBatchedFunction()
+               ? std::make_optional<std::string_view>(*batched_function_name_)
+               : std::nullopt;
+  }
+
+  // Distance in bytes between consecutive elements of the batched input and
+  // output buffers. Empty if there is no batched version of the function.
+  absl::Span<int64_t const> batched_input_strides() const {
+    return batched_input_strides_;
+  }
+  absl::Span<int64_t const> batched_output_strides() const {
+    return batched_output_strides_;
+  }
+
   std::string_view function_name() const { return function_name_; }
 
   absl::Span<int64_t const> input_buffer_sizes() const {
@@ -265,6 +294,14 @@ class JittedFunctionBase {
   std::optional<std::string> packed_function_name_;
   std::optional<JitFunctionType> packed_function_;
 
+  // Name and function pointer for the jitted function which evaluates a batch
+  // of arguments held in struct-of-arrays buffers. Only exists for JITted
+  // xls::Functions, and not for AOT compiled code.
+  std::optional<std::string> batched_function_name_;
+  std::optional<JitFunctionType> batched_function_;
+  std::vector<int64_t> batched_input_strides_;
+  std::vector<int64_t> batched_output_strides_;
+
   // Sizes of the inputs/outputs in native LLVM format for `function_base`.
   std::vector<int64_t> input_buffer_sizes_;
   std::vector<int64_t> output_buffer_sizes_;
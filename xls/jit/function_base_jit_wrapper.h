@@ -135,6 +135,18 @@ class BaseFunctionJitWrapper {
     return jit_->RunWithUnpackedViews(args...);
   }
 
+  // Run the jitted function with arguments and result already in the native
+  // layout of the jit, e.g. the native structs of a generated wrapper. No
+  // conversion is performed.
+  absl::Status RunInternalNative(absl::Span<uint8_t* const> args,
+                                 absl::Span<uint8_t> result) {
+    XLS_RET_CHECK(!needs_fake_token_)
+        << "Native layouts are not supported for implicit-token functions.";
+    InterpreterEvents events;
+    XLS_RETURN_IF_ERROR(jit_->RunWithViews(args, result, &events));
+    return InterpreterEventsToStatus(events);
+  }
+
   std::unique_ptr<FunctionJit> jit_;
   const bool needs_fake_token_;
 };
@@ -15,6 +15,8 @@
 #include "xls/jit/function_jit.h"
 
 #include <cstdint>
+#include <cstring>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -22,6 +24,7 @@
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -30,6 +33,7 @@
 #include "absl/types/span.h"
 #include "llvm/include/llvm/IR/DataLayout.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/events.h"
@@ -44,6 +48,7 @@
 #include "xls/jit/aot_compiler.h"
 #include "xls/jit/aot_entrypoint.pb.h"
 #include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
@@ -167,8 +172,7 @@ absl::StatusOr<std::unique_ptr<FunctionJit>> FunctionJit::CreateInternal(
       include_observer_callbacks, std::make_unique<JitRuntime>(data_layout)));
 }
 
-absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
-    absl::Span<const Value> args) {
+absl::Status FunctionJit::CheckArgs(absl::Span<const Value> args) const {
   if (args.size() != metadata_.ParamCount()) {
     return absl::InvalidArgumentError(absl::StrFormat(
         "Arg list to '%s' has the wrong size: %d vs expected %d.",
@@ -182,6 +186,12 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
           args[i].ToString(), i, metadata_.param_types[i]->ToString()));
     }
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
+    absl::Span<const Value> args) {
+  XLS_RETURN_IF_ERROR(CheckArgs(args));
 
   // Allocate argument buffers and copy in arg Values.
   XLS_RETURN_IF_ERROR(jit_runtime_->PackArgs(args, metadata_.param_types,
@@ -198,6 +208,157 @@ absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
   return InterpreterResult<Value>{std::move(result), std::move(events)};
 }
 
+absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
+    absl::Span<const Value> args, InvocationState& state) const {
+  XLS_RETURN_IF_ERROR(CheckArgs(args));
+
+  for (int64_t i = 0; i < args.size(); ++i) {
+    // The layout only writes the bytes holding data so clear the padding.
+    uint8_t* buffer = state.args_.pointers()[i];
+    memset(buffer, 0, param_layouts_[i].size());
+    param_layouts_[i].ValueToNativeLayout(args[i], buffer);
+  }
+
+  InterpreterEvents events;
+  jitted_function_base_.RunJittedFunction(
+      state.args_, state.results_, state.temp_, &events,
+      /*instance_context=*/&state.context_, /*jit_runtime=*/runtime(),
+      /*continuation_point=*/0);
+  Value result =
+      return_layout_.NativeLayoutToValue(state.results_.pointers()[0]);
+
+  return InterpreterResult<Value>{std::move(result), std::move(events)};
+}
+
+absl::StatusOr<InterpreterResult<std::vector<Value>>> FunctionJit::RunBatched(
+    absl::Span<const std::vector<Value>> args) {
+  for (int64_t b = 0; b < args.size(); ++b) {
+    if (args[b].size() != metadata_.ParamCount()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Arg list %d to '%s' has the wrong size: %d vs expected %d.", b,
+          metadata_.name, args[b].size(), metadata_.ParamCount()));
+    }
+    for (int64_t i = 0; i < metadata_.ParamCount(); ++i) {
+      if (!ValueConformsToType(args[b][i], metadata_.param_types[i])) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Got argument %s for parameter %d of arg list %d which is not of "
+            "type %s",
+            args[b][i].ToString(), i, b, metadata_.param_types[i]->ToString()));
+      }
+    }
+  }
+  if (args.empty()) {
+    return InterpreterResult<std::vector<Value>>{};
+  }
+  if (!jitted_function_base_.HasBatchedFunction()) {
+    // AOT compiled functions have no batched entry point. Fall back to
+    // evaluating the batch one element at a time.
+    InterpreterResult<std::vector<Value>> result;
+    for (const std::vector<Value>& arg_set : args) {
+      XLS_ASSIGN_OR_RETURN(InterpreterResult<Value> element, Run(arg_set));
+      result.value.push_back(std::move(element.value));
+      absl::c_move(element.events.trace_msgs,
+                   std::back_inserter(result.events.trace_msgs));
+      absl::c_move(element.events.assert_msgs,
+                   std::back_inserter(result.events.assert_msgs));
+      result.events.compact_traces.Append(element.events.compact_traces);
+    }
+    return result;
+  }
+
+  using BatchBuffer = std::unique_ptr<uint8_t[], DeleteAligned>;
+
+  // Lay out the arguments in struct-of-arrays form: one buffer per parameter
+  // holding that parameter's value for every element of the batch.
+  absl::Span<int64_t const> input_strides =
+      jitted_function_base_.batched_input_strides();
+  std::vector<BatchBuffer> input_storage;
+  std::vector<uint8_t*> input_buffers;
+  for (int64_t i = 0; i < metadata_.ParamCount(); ++i) {
+    int64_t size = jitted_function_base_.input_buffer_sizes()[i];
+    input_storage.push_back(AllocateBatchBuffer(
+        jitted_function_base_.input_buffer_preferred_alignments()[i],
+        input_strides[i], args.size()));
+    input_buffers.push_back(input_storage.back().get());
+    for (int64_t b = 0; b < args.size(); ++b) {
+      jit_runtime_->BlitValueToBuffer(
+          args[b][i], metadata_.param_types[i],
+          absl::MakeSpan(input_buffers.back() + b * input_strides[i], size));
+    }
+  }
+
+  int64_t output_stride = jitted_function_base_.batched_output_strides()[0];
+  BatchBuffer output_storage = AllocateBatchBuffer(
+      jitted_function_base_.output_buffer_preferred_alignments()[0],
+      output_stride, args.size());
+  uint8_t* output_buffers[1] = {output_storage.get()};
+
+  InterpreterEvents events;
+  jitted_function_base_.RunBatchedJittedFunction(
+      input_buffers.data(), output_buffers, temp_buffer_.get(), &events,
+      /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(),
+      /*batch_size=*/args.size());
+
+  std::vector<Value> results;
+  results.reserve(args.size());
+  for (int64_t b = 0; b < args.size(); ++b) {
+    results.push_back(jit_runtime_->UnpackBuffer(
+        output_storage.get() + b * output_stride, metadata_.return_type));
+  }
+  return InterpreterResult<std::vector<Value>>{std::move(results),
+                                               std::move(events)};
+}
+
+int64_t FunctionJit::GetBatchedArgStride(int arg_index) const {
+  if (jitted_function_base_.HasBatchedFunction()) {
+    return jitted_function_base_.batched_input_strides()[arg_index];
+  }
+  return RoundUpToNearest(GetArgTypeSize(arg_index),
+                          GetBatchedArgAlignment(arg_index));
+}
+
+int64_t FunctionJit::GetBatchedReturnStride() const {
+  if (jitted_function_base_.HasBatchedFunction()) {
+    return jitted_function_base_.batched_output_strides()[0];
+  }
+  return RoundUpToNearest(GetReturnTypeSize(), GetBatchedReturnAlignment());
+}
+
+absl::Status FunctionJit::RunBatchedWithViews(absl::Span<uint8_t* const> args,
+                                              uint8_t* result_buffer,
+                                              int64_t batch_size,
+                                              InterpreterEvents* events) {
+  if (args.size() != metadata_.ParamCount()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), metadata_.ParamCount()));
+  }
+  XLS_RET_CHECK_GE(batch_size, 0);
+  if (batch_size == 0) {
+    return absl::OkStatus();
+  }
+  if (!jitted_function_base_.HasBatchedFunction()) {
+    // As in RunBatched(), evaluate the batch one element at a time.
+    std::vector<uint8_t*> element_args(args.size());
+    for (int64_t b = 0; b < batch_size; ++b) {
+      for (int64_t i = 0; i < args.size(); ++i) {
+        element_args[i] = args[i] + b * GetBatchedArgStride(i);
+      }
+      XLS_RETURN_IF_ERROR(RunWithViews(
+          element_args,
+          absl::MakeSpan(result_buffer + b * GetBatchedReturnStride(),
+                         GetReturnTypeSize()),
+          events));
+    }
+    return absl::OkStatus();
+  }
+  uint8_t* output_buffers[1] = {result_buffer};
+  jitted_function_base_.RunBatchedJittedFunction(
+      args.data(), output_buffers, temp_buffer_.get(), events,
+      /*instance_context=*/&callbacks_, /*jit_runtime=*/runtime(), batch_size);
+  return absl::OkStatus();
+}
+
 absl::StatusOr<InterpreterResult<Value>> FunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
   XLS_ASSIGN_OR_RETURN(std::vector<Value> positional_args,
@@ -226,6 +387,28 @@ absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
   return absl::OkStatus();
 }
 
+absl::Status FunctionJit::RunWithViews(absl::Span<uint8_t* const> args,
+                                       absl::Span<uint8_t> result_buffer,
+                                       InvocationState& state,
+                                       InterpreterEvents* events) const {
+  if (args.size() != metadata_.ParamCount()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Arg list has the wrong size: %d vs expected %d.",
+                        args.size(), metadata_.ParamCount()));
+  }
+  if (result_buffer.size() < GetReturnTypeSize()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Result buffer too small - must be at least %d bytes!",
+                        GetReturnTypeSize()));
+  }
+
+  uint8_t* output_buffers[1] = {result_buffer.data()};
+  jitted_function_base_.RunUnalignedJittedFunction</*kForceZeroCopy=*/false>(
+      args.data(), output_buffers, state.temp_.get(), events,
+      /*instance_context=*/&state.context_, runtime(), /*continuation=*/0);
+  return absl::OkStatus();
+}
+
 template absl::Status FunctionJit::RunWithViews</*kForceZeroCopy=*/true>(
     absl::Span<uint8_t* const> args, absl::Span<uint8_t> result_buffer,
     InterpreterEvents* events);
@@ -41,15 +41,46 @@
 #include "xls/jit/jit_runtime.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
 // This class provides a facility to execute XLS functions (on the host) by
-// converting it to LLVM IR, compiling it, and finally executing it. Not
-// thread-safe due to sharing of result and temporary buffers between
-// invocations of Run.
+// converting it to LLVM IR, compiling it, and finally executing it.
+//
+// The methods which do not take an InvocationState are not thread-safe as they
+// share the result and temporary buffers held by this object between
+// invocations. The compiled code itself is reentrant though: any number of
+// threads may concurrently call the const methods which take an
+// InvocationState, each passing its own state.
 class FunctionJit {
  public:
+  // The buffers and callback context used by a single invocation of the
+  // compiled function. Create one per thread with CreateInvocationState() and
+  // reuse it across that thread's invocations.
+  class InvocationState {
+   public:
+    InvocationState(InvocationState&&) = default;
+
+   private:
+    friend class FunctionJit;
+
+    InvocationState(const JittedFunctionBase& jitted_function_base,
+                    const InstanceContext& callbacks)
+        : args_(jitted_function_base.CreateInputBuffer()),
+          results_(jitted_function_base.CreateOutputBuffer()),
+          temp_(jitted_function_base.CreateTempBuffer()),
+          context_(InstanceContext::CreateForFunc()) {
+      context_.observer = callbacks.observer;
+      context_.compact_traces = callbacks.compact_traces;
+    }
+
+    JitArgumentSet args_;
+    JitArgumentSet results_;
+    JitTempBuffer temp_;
+    InstanceContext context_;
+  };
+
   // Returns an object containing a host-compiled version of the specified XLS
   // function.
   static absl::StatusOr<std::unique_ptr<FunctionJit>> Create(
@@ -72,10 +103,43 @@ class FunctionJit {
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
 
+  // Returns a fresh set of buffers for use with the thread-safe Run() and
+  // RunWithViews() overloads. The runtime observer and compact trace setting
+  // of this object at the time of the call are carried over to the state.
+  InvocationState CreateInvocationState() const {
+    return InvocationState(jitted_function_base_, callbacks_);
+  }
+
+  // As above, but using the buffers of `state` instead of those of this
+  // object. Arguments are converted to and from the native layout with
+  // precomputed type layouts so no lock on the JitRuntime is taken, and
+  // concurrent calls with distinct states do not contend.
+  absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args,
+                                               InvocationState& state) const;
+
   // As above, buth with arguments as key-value pairs.
   absl::StatusOr<InterpreterResult<Value>> Run(
       const absl::flat_hash_map<std::string, Value>& kwargs);
 
+  // Executes the compiled function once for each set of arguments in `args`
+  // and returns the results in the same order. The arguments are laid out in
+  // struct-of-arrays form and evaluated by a single call into the jitted code,
+  // amortizing the per-invocation overhead of Run(). Events from all
+  // invocations are accumulated into the returned result.
+  absl::StatusOr<InterpreterResult<std::vector<Value>>> RunBatched(
+      absl::Span<const std::vector<Value>> args);
+
+  // As RunBatched() but with the arguments and results held in native-layout
+  // struct-of-arrays buffers, so no `Value`s are built on either side.
+  // `args[i]` holds `batch_size` values of parameter i spaced
+  // GetBatchedArgStride(i) bytes apart and `result_buffer` receives the results spaced
+  // GetBatchedReturnStride() bytes apart. Buffers should be aligned to
+  // GetBatchedArgAlignment(i) and GetBatchedReturnAlignment() respectively.
+  // Events from all invocations are appended to `events`.
+  absl::Status RunBatchedWithViews(absl::Span<uint8_t* const> args,
+                                   uint8_t* result_buffer, int64_t batch_size,
+                                   InterpreterEvents* events);
+
   // Executes the compiled function with the arguments and results specified as
   // "views" - flat buffers onto which structures layouts can be applied (see
   // value_view.h).
@@ -93,6 +157,13 @@ class FunctionJit {
                             absl::Span<uint8_t> result_buffer,
                             InterpreterEvents* events);
 
+  // As RunWithViews() but using the temporary buffer and callback context of
+  // `state`, so concurrent calls with distinct states are safe.
+  absl::Status RunWithViews(absl::Span<uint8_t* const> args,
+                            absl::Span<uint8_t> result_buffer,
+                            InvocationState& state,
+                            InterpreterEvents* events) const;
+
   // Similar to RunWithViews(), except the arguments here are _packed_views_ -
   // views whose data elements are tightly packed, with no padding bits or bytes
   // between them. The function return value is specified as the last arg - its
@@ -146,6 +217,11 @@ class FunctionJit {
         args...);
   }
 
+  // Returns the types of the compiled function's parameters.
+  absl::Span<Type* const> GetParamTypes() const {
+    return metadata_.param_types;
+  }
+
   const JittedFunctionBase& jitted_function_base() const {
     return jitted_function_base_;
   }
@@ -165,6 +241,17 @@ class FunctionJit {
     return jitted_function_base_.output_buffer_abi_alignments()[0];
   }
 
+  // Gets the distance in bytes between consecutive batch elements of an
+  // argument (or the return value) in the buffers of RunBatchedWithViews().
+  int64_t GetBatchedArgStride(int arg_index) const;
+  int64_t GetBatchedReturnStride() const;
+  int64_t GetBatchedArgAlignment(int arg_index) const {
+    return jitted_function_base_.input_buffer_preferred_alignments()[arg_index];
+  }
+  int64_t GetBatchedReturnAlignment() const {
+    return jitted_function_base_.output_buffer_preferred_alignments()[0];
+  }
+
   // Gets the size of the compiled function's arguments (or return value) in the
   // packed layout.
   int64_t GetPackedArgTypeSize(int arg_index) const {
@@ -207,6 +294,11 @@ class FunctionJit {
   }
   bool SupportsObservers() const { return has_observer_callbacks_; }
 
+  // In compact trace mode traces are recorded unformatted in the events'
+  // `compact_traces` log instead of `trace_msgs`; see `TraceSiteTable`.
+  void set_compact_traces(bool value) { callbacks_.compact_traces = value; }
+  bool compact_traces() const { return callbacks_.compact_traces; }
+
  private:
   struct InterfaceMetadata {
     std::string name;
@@ -236,12 +328,21 @@ class FunctionJit {
         result_buffers_(jitted_function_base_.CreateOutputBuffer()),
         temp_buffer_(jitted_function_base_.CreateTempBuffer()),
         jit_runtime_(std::move(runtime)),
-        has_observer_callbacks_(has_observer_callbacks) {}
+        has_observer_callbacks_(has_observer_callbacks),
+        return_layout_(jit_runtime_->CreateTypeLayout(metadata_.return_type)) {
+    param_layouts_.reserve(metadata_.param_types.size());
+    for (Type* type : metadata_.param_types) {
+      param_layouts_.push_back(jit_runtime_->CreateTypeLayout(type));
+    }
+  }
 
   static absl::StatusOr<std::unique_ptr<FunctionJit>> CreateInternal(
       Function* xls_function, int64_t opt_level,
       bool include_observer_callbacks, JitObserver* jit_observer);
 
+  // Returns an error if `args` does not match the parameters of the function.
+  absl::Status CheckArgs(absl::Span<const Value> args) const;
+
   template <bool kForceZeroCopy, typename... ArgsT>
   absl::Status RunWithUnpackedViewsCommon(ArgsT... args) {
     const uint8_t* arg_buffers[sizeof...(ArgsT)];
@@ -320,6 +421,11 @@ class FunctionJit {
 
   // Are callbacks for node-values compiled in.
   bool has_observer_callbacks_;
+
+  // Native layouts of the parameters and return value, used to convert values
+  // without going through (and locking) the JitRuntime.
+  std::vector<TypeLayout> param_layouts_;
+  TypeLayout return_layout_;
 };
 
 }  // namespace xls
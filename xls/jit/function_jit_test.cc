@@ -50,11 +50,13 @@
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_evaluator_test_base.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
+#include "xls/ir/compact_trace.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/fuzz_type_domain.h"
@@ -277,6 +279,38 @@ TEST(FunctionJitTest, TraceFmtTwoArgTest) {
   EXPECT_EQ(result.events.trace_msgs.at(0).message, "hi I traced: 1 also: 2a");
 }
 
+TEST(FunctionJitTest, CompactTraces) {
+  Package package("my_package");
+  std::string ir_text = R"(
+  fn traces(tkn: token, pred: bits[1], x: bits[8]) -> token {
+    t: (bits[8], bits[1]) = tuple(x, pred)
+    trace.1: token = trace(tkn, pred, format="x: {:d} t: {}", data_operands=[x, t], id=1)
+    ret trace.2: token = trace(trace.1, pred, format="hi", data_operands=[], id=2)
+  }
+  )";
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function,
+                           Parser::ParseFunction(ir_text, &package));
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(function));
+  std::vector<Value> args = {Value::Token(), Value(UBits(1, 1)),
+                             Value(UBits(0xfe, 8))};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> expected, jit->Run(args));
+  ASSERT_EQ(expected.events.trace_msgs.size(), 2);
+
+  jit->set_compact_traces(true);
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<Value> result, jit->Run(args));
+  EXPECT_TRUE(result.events.trace_msgs.empty());
+  EXPECT_EQ(result.events.compact_traces.size(), 2);
+  TraceSiteTable sites(&package);
+  EXPECT_THAT(sites.Format(result.events.compact_traces),
+              IsOkAndHolds(expected.events.trace_msgs));
+
+  // Traces whose condition is false are not recorded.
+  args[1] = Value(UBits(0, 1));
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->Run(args));
+  EXPECT_TRUE(result.events.compact_traces.empty());
+}
+
 TEST(FunctionJitTest, TraceFmtBigArgTest) {
   Package package("my_package");
   std::string ir_text = R"(
@@ -892,6 +926,145 @@ TEST(FunctionJitTest, TwoAssert) {
                        HasSubstr("first assertion error message")));
 }
 
+TEST(FunctionJitTest, RunBatched) {
+  Package p("batched_test");
+  FunctionBuilder b("fun", &p);
+  BValue x = b.Param("x", p.GetBitsType(32));
+  BValue y = b.Param("y", p.GetTupleType({p.GetBitsType(8), p.GetBitsType(8)}));
+  b.Tuple({b.Add(x, b.ZeroExtend(b.TupleIndex(y, 0), 32)),
+           b.UMul(b.TupleIndex(y, 0), b.TupleIndex(y, 1))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+  ASSERT_TRUE(jit->jitted_function_base().HasBatchedFunction());
+
+  std::vector<std::vector<Value>> args;
+  std::vector<Value> expected;
+  for (int64_t i = 0; i < 100; ++i) {
+    args.push_back({Value(UBits(1000 * i, 32)),
+                    Value::Tuple({Value(UBits(i, 8)), Value(UBits(3, 8))})});
+    XLS_ASSERT_OK_AND_ASSIGN(Value result, RunJitNoEvents(jit.get(), args[i]));
+    expected.push_back(result);
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> result,
+                           jit->RunBatched(args));
+  EXPECT_THAT(result.value, ElementsAreArray(expected));
+  XLS_EXPECT_OK(InterpreterEventsToStatus(result.events));
+
+  XLS_ASSERT_OK_AND_ASSIGN(result, jit->RunBatched({}));
+  EXPECT_TRUE(result.value.empty());
+}
+
+TEST(FunctionJitTest, RunBatchedAccumulatesEvents) {
+  Package p("batched_assert_test");
+  FunctionBuilder b("fun", &p);
+  BValue x = b.Param("x", p.GetBitsType(8));
+  b.Assert(b.Literal(Value::Token()), b.ULt(x, b.Literal(UBits(2, 8))),
+           "x is too big");
+  b.Add(x, b.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  std::vector<std::vector<Value>> args = {
+      {Value(UBits(0, 8))}, {Value(UBits(5, 8))}, {Value(UBits(7, 8))}};
+  XLS_ASSERT_OK_AND_ASSIGN(InterpreterResult<std::vector<Value>> result,
+                           jit->RunBatched(args));
+  EXPECT_THAT(result.value,
+              ElementsAre(Value(UBits(1, 8)), Value(UBits(6, 8)),
+                          Value(UBits(8, 8))));
+  EXPECT_THAT(result.events.assert_msgs,
+              ElementsAre("x is too big", "x is too big"));
+}
+
+TEST(FunctionJitTest, RunBatchedRejectsBadArgs) {
+  Package p("batched_bad_args_test");
+  FunctionBuilder b("fun", &p);
+  b.Not(b.Param("x", p.GetBitsType(8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  std::vector<std::vector<Value>> wrong_count = {{Value(UBits(0, 8))}, {}};
+  EXPECT_THAT(jit->RunBatched(wrong_count),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wrong size")));
+  std::vector<std::vector<Value>> wrong_type = {{Value(UBits(0, 4))}};
+  EXPECT_THAT(jit->RunBatched(wrong_type),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("not of type")));
+}
+
+TEST(FunctionJitTest, RunConcurrentlyWithInvocationStates) {
+  Package p("concurrent_test");
+  FunctionBuilder b("fun", &p);
+  BValue x = b.Param("x", p.GetBitsType(32));
+  BValue y = b.Param("y", p.GetTupleType({p.GetBitsType(8), p.GetBitsType(8)}));
+  b.Tuple({b.Add(x, b.ZeroExtend(b.TupleIndex(y, 0), 32)),
+           b.UMul(b.TupleIndex(y, 0), b.TupleIndex(y, 1))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  constexpr int64_t kThreadCount = 8;
+  constexpr int64_t kIterations = 1000;
+  std::vector<absl::Status> statuses(kThreadCount);
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int64_t t = 0; t < kThreadCount; ++t) {
+    threads.push_back(std::make_unique<Thread>([&, t]() {
+      FunctionJit::InvocationState state = jit->CreateInvocationState();
+      for (int64_t i = 0; i < kIterations; ++i) {
+        uint8_t y0 = (t * 31 + i) & 0xff;
+        std::vector<Value> args = {
+            Value(UBits(t * kIterations + i, 32)),
+            Value::Tuple({Value(UBits(y0, 8)), Value(UBits(t, 8))})};
+        absl::StatusOr<InterpreterResult<Value>> result = jit->Run(args, state);
+        if (!result.ok()) {
+          statuses[t] = result.status();
+          return;
+        }
+        Value expected =
+            Value::Tuple({Value(UBits(t * kIterations + i + y0, 32)),
+                          Value(UBits((y0 * t) & 0xff, 8))});
+        if (result->value != expected) {
+          statuses[t] = absl::InternalError(absl::StrFormat(
+              "Thread %d iteration %d: got %s, expected %s", t, i,
+              result->value.ToString(), expected.ToString()));
+          return;
+        }
+      }
+    }));
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_EXPECT_OK(status);
+  }
+}
+
+TEST(FunctionJitTest, RunWithViewsAndInvocationState) {
+  Package p("views_state_test");
+  FunctionBuilder b("fun", &p);
+  b.Add(b.Param("x", p.GetBitsType(32)), b.Param("y", p.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, b.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, FunctionJit::Create(f));
+
+  FunctionJit::InvocationState state = jit->CreateInvocationState();
+  alignas(8) uint32_t x = 40;
+  alignas(8) uint32_t y = 2;
+  alignas(8) uint32_t sum = 0;
+  std::array<uint8_t*, 2> args = {reinterpret_cast<uint8_t*>(&x),
+                                  reinterpret_cast<uint8_t*>(&y)};
+  InterpreterEvents events;
+  XLS_ASSERT_OK(jit->RunWithViews(
+      args, absl::MakeSpan(reinterpret_cast<uint8_t*>(&sum), sizeof(sum)),
+      state, &events));
+  EXPECT_EQ(sum, 42);
+  EXPECT_THAT(jit->RunWithViews(absl::MakeSpan(args).subspan(1),
+                                absl::MakeSpan(reinterpret_cast<uint8_t*>(&sum),
+                                               sizeof(sum)),
+                                state, &events),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("wrong size")));
+}
+
 TEST(FunctionJitTest, TokenCompareError) {
   Package p("token_eq");
   FunctionBuilder b("fun", &p);
@@ -1123,6 +1296,54 @@ TEST(FunctionJitDeathTest, MisalignedPointerCaught) {
 #endif
 }
 
+TEST(FunctionJitTest, PipelineProfileNames) {
+  for (LlvmPipelineProfile profile :
+       {LlvmPipelineProfile::kFastCompile, LlvmPipelineProfile::kBalanced,
+        LlvmPipelineProfile::kMaxThroughput}) {
+    EXPECT_THAT(
+        LlvmPipelineProfileFromString(LlvmPipelineProfileToString(profile)),
+        IsOkAndHolds(profile));
+  }
+  EXPECT_THAT(LlvmPipelineProfileFromString("O2"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Unknown LLVM pipeline profile")));
+}
+
+TEST(FunctionJitTest, PipelineProfiles) {
+  Package package("my_package");
+  FunctionBuilder fb("test", &package);
+  fb.UMul(fb.Add(fb.Param("x", package.GetBitsType(32)),
+                 fb.Param("y", package.GetBitsType(32))),
+          fb.Literal(UBits(3, 32)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * function, fb.Build());
+  for (LlvmPipelineProfile profile :
+       {LlvmPipelineProfile::kFastCompile, LlvmPipelineProfile::kBalanced,
+        LlvmPipelineProfile::kMaxThroughput}) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<OrcJit> orc_jit, OrcJit::Create());
+    orc_jit->SetObjectCache(nullptr);
+    orc_jit->SetPipelineProfile(profile);
+    XLS_ASSERT_OK_AND_ASSIGN(llvm::DataLayout data_layout,
+                             orc_jit->CreateDataLayout());
+    XLS_ASSERT_OK_AND_ASSIGN(JittedFunctionBase jit,
+                             JittedFunctionBase::Build(function, *orc_jit));
+    uint32_t x = 5;
+    uint32_t y = 9;
+    uint32_t result = 0;
+    std::array<uint8_t*, 2> inputs = {reinterpret_cast<uint8_t*>(&x),
+                                      reinterpret_cast<uint8_t*>(&y)};
+    std::array<uint8_t*, 1> outputs = {reinterpret_cast<uint8_t*>(&result)};
+    InterpreterEvents events;
+    JitRuntime runtime(data_layout);
+    JitTempBuffer temp_buffer = jit.CreateTempBuffer();
+    std::optional<int64_t> ret = jit.RunPackedJittedFunction(
+        inputs.data(), outputs.data(), &temp_buffer, &events,
+        /*instance_context=*/nullptr, /*jit_runtime=*/&runtime,
+        /*continuation_point=*/0);
+    ASSERT_TRUE(ret.has_value()) << LlvmPipelineProfileToString(profile);
+    EXPECT_EQ(result, 42) << LlvmPipelineProfileToString(profile);
+  }
+}
+
 // Check that expected_data matched output_data.
 // Log values of expected_data, output_data, and whatever entries are in
 // extra_data.
@@ -640,12 +640,13 @@ absl::Status InvokeRecordTraceCallback(llvm::IRBuilder<>* builder,
   return absl::OkStatus();
 }
 
-// Build the LLVM IR to invoke the callback that creates a trace buffer.
+// Build the LLVM IR to invoke the callback that creates a trace buffer for the
+// trace node with id `site_id`.
 absl::StatusOr<llvm::Value*> InvokeCreateBufferCallback(
-    llvm::IRBuilder<>* builder, llvm::Value* instance_ctx) {
+    llvm::IRBuilder<>* builder, int64_t site_id, llvm::Value* instance_ctx) {
   llvm::Type* ptr_type = llvm::PointerType::get(builder->getContext(), 0);
   return InvokeCallback<InstanceContext::kCreateTraceBufferOffset>(
-      builder, ptr_type, instance_ctx, {});
+      builder, ptr_type, instance_ctx, {builder->getInt64(site_id)});
 }
 
 // Build the LLVM IR to invoke the callback that records assertions.
@@ -1643,7 +1644,7 @@ absl::Status IrBuilderVisitor::HandleTrace(Trace* trace_op) {
 
   XLS_ASSIGN_OR_RETURN(
       llvm::Value * buffer_ptr,
-      InvokeCreateBufferCallback(&print_builder,
+      InvokeCreateBufferCallback(&print_builder, trace_op->id(),
                                  node_context.GetInstanceContextArg()));
 
   // Operands are: (tok, pred, ..data_operands..)
@@ -14,10 +14,12 @@
 
 #include "xls/jit/jit_buffer.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <iterator>
 #include <memory>
 #include <type_traits>
@@ -121,4 +123,14 @@ void* AllocateAligned(int64_t alignment, int64_t size) {
 }
 
 void DeallocateAligned(void* ptr) { std::free(ptr); }
+
+std::unique_ptr<uint8_t[], DeleteAligned> AllocateBatchBuffer(
+    int64_t alignment, int64_t stride, int64_t batch_size) {
+  int64_t size = std::max<int64_t>(stride * batch_size, 1);
+  std::unique_ptr<uint8_t[], DeleteAligned> result(
+      static_cast<uint8_t*>(AllocateAligned(alignment, size)));
+  CHECK(result != nullptr) << "size: " << size << " align: " << alignment;
+  std::memset(result.get(), 0, size);
+  return result;
+}
 }  // namespace xls
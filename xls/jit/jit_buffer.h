@@ -47,6 +47,13 @@ class DeleteAligned {
   }
 };
 
+// Allocates a zero-initialized buffer holding `batch_size` values laid out
+// `stride` bytes apart, as taken by the batched entry points of the jit. At
+// least one byte is always allocated so every buffer has a unique address,
+// even for zero-width types or an empty batch.
+std::unique_ptr<uint8_t[], DeleteAligned> AllocateBatchBuffer(
+    int64_t alignment, int64_t stride, int64_t batch_size);
+
 class JittedFunctionBase;
 // class BlockJitContinuation;
 // A buffer & pointers capable of being used as the inputs and/or outputs for
@@ -20,6 +20,7 @@
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/span.h"
+#include "xls/ir/compact_trace.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/type.h"
@@ -32,6 +33,10 @@ namespace xls {
 namespace {
 void PerformStringStep(InstanceContext* thiz, char* step_string,
                        std::string* buffer) {
+  // Compact traces are formatted later from the trace node's format string.
+  if (thiz->compact_traces) {
+    return;
+  }
   buffer->append(step_string);
 }
 
@@ -44,18 +49,31 @@ void PerformFormatStep(InstanceContext* thiz, JitRuntime* runtime,
 #ifdef ABSL_HAVE_MEMORY_SANITIZER
   __msan_unpoison(value, runtime->GetTypeByteSize(type));
 #endif
-  FormatPreference format = static_cast<FormatPreference>(format_u64);
   Value ir_value = runtime->UnpackBuffer(value, type);
+  if (thiz->compact_traces) {
+    AppendCompactTraceOperand(ir_value, *buffer);
+    return;
+  }
+  FormatPreference format = static_cast<FormatPreference>(format_u64);
   absl::StrAppend(buffer, ir_value.ToHumanString(format));
 }
 
 void RecordTrace(InstanceContext* thiz, std::string* buffer, int64_t verbosity,
                  InterpreterEvents* events) {
+  if (thiz->compact_traces) {
+    events->compact_traces.Append(thiz->compact_trace_site, *buffer);
+    return;
+  }
   events->trace_msgs.push_back(
       TraceMessage{.message = *buffer, .verbosity = verbosity});
   delete buffer;
 }
-std::string* CreateTraceBuffer(InstanceContext* thiz) {
+std::string* CreateTraceBuffer(InstanceContext* thiz, int64_t site_id) {
+  if (thiz->compact_traces) {
+    thiz->compact_trace_site = site_id;
+    thiz->compact_trace_operands.clear();
+    return &thiz->compact_trace_operands;
+  }
   return new std::string();
 }
 void RecordAssertion(InstanceContext* thiz, const char* msg,
@@ -65,11 +83,20 @@ void RecordAssertion(InstanceContext* thiz, const char* msg,
 
 bool QueueReceiveWrapper(InstanceContext* thiz, int64_t queue_index,
                          uint8_t* buffer) {
+  if (LockFreeJitChannelQueue* queue = thiz->lock_free_queues[queue_index];
+      queue != nullptr) {
+    return queue->ReadRawDirect(buffer);
+  }
   return thiz->channel_queues[queue_index]->ReadRaw(buffer);
 }
 
 void QueueSendWrapper(InstanceContext* thiz, int64_t queue_index,
                       const uint8_t* data) {
+  if (LockFreeJitChannelQueue* queue = thiz->lock_free_queues[queue_index];
+      queue != nullptr) {
+    queue->WriteRawDirect(data);
+    return;
+  }
   thiz->channel_queues[queue_index]->WriteRaw(data);
 }
 
@@ -98,10 +125,15 @@ InstanceContextVTable::InstanceContextVTable()
       record_node_result(&RecordNodeResult) {}
 
 Type* InstanceContext::ParseTypeFromProto(absl::Span<uint8_t const> data) {
+  auto [it, inserted] = parsed_types.try_emplace(data.data(), nullptr);
+  if (!inserted) {
+    return it->second;
+  }
   TypeProto proto;
   CHECK(proto.ParseFromArray(data.data(), data.size()));
   auto type_or = type_manager->GetTypeFromProto(proto);
   CHECK_OK(type_or);
+  it->second = *type_or;
   return *type_or;
 }
 }  // namespace xls
@@ -65,9 +65,10 @@ struct InstanceContextVTable {
   // event.
   const RecordTraceFn record_trace;
 
-  using CreateTraceBufferFn = std::string* (*)(InstanceContext* thiz);
+  using CreateTraceBufferFn = std::string* (*)(InstanceContext* thiz,
+                                                int64_t site_id);
   // This is a shim to let JIT code create a buffer for accumulating trace
-  // fragments.
+  // fragments of the trace node with id `site_id`.
   const CreateTraceBufferFn create_trace_buffer;
 
   using RecordAssertionFn = void (*)(InstanceContext* thiz, const char* msg,
@@ -113,6 +114,11 @@ struct InstanceContext {
     InstanceContext ret;
     ret.instance = inst;
     ret.channel_queues = std::move(queues);
+    ret.lock_free_queues.reserve(ret.channel_queues.size());
+    for (JitChannelQueue* queue : ret.channel_queues) {
+      ret.lock_free_queues.push_back(
+          dynamic_cast<LockFreeJitChannelQueue*>(queue));
+    }
     return ret;
   }
 
@@ -162,10 +168,27 @@ struct InstanceContext {
   // into the JITted code for sends and receives.
   std::vector<JitChannelQueue*> channel_queues;
 
+  // For each entry of `channel_queues`, the queue itself if it is a
+  // LockFreeJitChannelQueue and nullptr otherwise. Sends and receives on
+  // these queues skip the virtual dispatch and take the inline fast path.
+  std::vector<LockFreeJitChannelQueue*> lock_free_queues;
+
   // Arena used to materialize types that are passed to callbacks.
   std::unique_ptr<TypeManager> type_manager = std::make_unique<TypeManager>();
 
   RuntimeObserver* observer = nullptr;
+
+  // Whether traces are recorded unformatted in the events' `compact_traces`
+  // log instead of `trace_msgs`. In that mode the trace buffer is
+  // `compact_trace_operands`, which accumulates the encoded operands of the
+  // trace of node `compact_trace_site` being recorded.
+  bool compact_traces = false;
+  int64_t compact_trace_site = 0;
+  std::string compact_trace_operands;
+
+  // Types parsed by `ParseTypeFromProto`, keyed by the address of the proto
+  // data (which is a constant of the jitted code).
+  absl::flat_hash_map<const uint8_t*, Type*> parsed_types;
 };
 
 static_assert(offsetof(InstanceContext, vtable) == 0);
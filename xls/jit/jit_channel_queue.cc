@@ -22,14 +22,17 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/memory/memory.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
+#include "xls/common/casts.h"
 #include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
+#include "xls/ir/channel.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/type.h"
@@ -56,6 +59,23 @@ std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
   return runtime.UnpackBuffer(buffer.data(), type);
 }
 
+void WriteValueOnQueue(const Value& value, Type* type, JitRuntime& runtime,
+                       SpscByteQueue& queue) {
+  absl::InlinedVector<uint8_t, ByteQueue::kInitBufferSize> buffer(
+      queue.element_size());
+  runtime.BlitValueToBuffer(value, type, absl::MakeSpan(buffer));
+  queue.Write(buffer.data());
+}
+
+std::optional<Value> ReadValueFromQueue(Type* type, JitRuntime& runtime,
+                                        SpscByteQueue& queue) {
+  std::vector<uint8_t> buffer(queue.element_size());
+  if (!queue.Read(buffer.data())) {
+    return std::nullopt;
+  }
+  return runtime.UnpackBuffer(buffer.data(), type);
+}
+
 }  // namespace
 
 ByteQueue::ByteQueue(int64_t channel_element_size, bool is_single_value)
@@ -102,10 +122,43 @@ void ByteQueue::Resize() {
   }
 }
 
+SpscByteQueue::SpscByteQueue(int64_t channel_element_size,
+                             int64_t min_capacity)
+    : channel_element_size_(channel_element_size),
+      // Zero-width elements (empty tuples) still need a distinct slot so the
+      // element count is tracked.
+      ring_(min_capacity,
+            std::max<int64_t>(
+                RoundUpToNearest(
+                    channel_element_size,
+                    static_cast<int64_t>(alignof(std::max_align_t))),
+                1)) {}
+
+void SpscByteQueue::Write(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+  __msan_unpoison(data, channel_element_size_);
+#endif
+  ring_.Write(
+      [&](uint8_t* slot) { memcpy(slot, data, channel_element_size_); });
+}
+
+bool SpscByteQueue::Read(uint8_t* buffer) {
+  return ring_.Read(
+      [&](uint8_t* slot) { memcpy(buffer, slot, channel_element_size_); });
+}
+
 int64_t ThreadSafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
+int64_t ThreadSafeJitChannelQueue::GetPushCountInternal() const {
+  return byte_queue_.write_count();
+}
+
+int64_t ThreadSafeJitChannelQueue::GetPopCountInternal() const {
+  return byte_queue_.read_count();
+}
+
 void ThreadSafeJitChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
   WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
@@ -124,6 +177,14 @@ int64_t ThreadUnsafeJitChannelQueue::GetSizeInternal() const {
   return byte_queue_.size();
 }
 
+int64_t ThreadUnsafeJitChannelQueue::GetPushCountInternal() const {
+  return byte_queue_.write_count();
+}
+
+int64_t ThreadUnsafeJitChannelQueue::GetPopCountInternal() const {
+  return byte_queue_.read_count();
+}
+
 void ThreadUnsafeJitChannelQueue::WriteInternal(const Value& value) {
   CallWriteCallbacks(value);
   WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
@@ -138,6 +199,47 @@ std::optional<Value> ThreadUnsafeJitChannelQueue::ReadInternal() {
   return value;
 }
 
+LockFreeJitChannelQueue::LockFreeJitChannelQueue(
+    ChannelInstance* channel_instance, JitRuntime* jit_runtime)
+    : JitChannelQueue(channel_instance, jit_runtime),
+      byte_queue_(
+          jit_runtime->GetTypeByteSize(channel_instance->channel->type()),
+          /*min_capacity=*/channel_instance->channel->kind() ==
+                  ChannelKind::kStreaming
+              ? down_cast<StreamingChannel*>(channel_instance->channel)
+                    ->GetFifoDepth()
+                    .value_or(0)
+              : 0) {
+  CHECK_EQ(channel_instance->channel->kind(), ChannelKind::kStreaming)
+      << "LockFreeJitChannelQueue only supports streaming channels";
+}
+
+int64_t LockFreeJitChannelQueue::GetSizeInternal() const {
+  return byte_queue_.size();
+}
+
+int64_t LockFreeJitChannelQueue::GetPushCountInternal() const {
+  return byte_queue_.write_count();
+}
+
+int64_t LockFreeJitChannelQueue::GetPopCountInternal() const {
+  return byte_queue_.read_count();
+}
+
+void LockFreeJitChannelQueue::WriteInternal(const Value& value) {
+  CallWriteCallbacks(value);
+  WriteValueOnQueue(value, channel()->type(), *jit_runtime_, byte_queue_);
+}
+
+std::optional<Value> LockFreeJitChannelQueue::ReadInternal() {
+  std::optional<Value> value =
+      ReadValueFromQueue(channel()->type(), *jit_runtime_, byte_queue_);
+  if (value.has_value()) {
+    CallReadCallbacks(value.value());
+  }
+  return value;
+}
+
 /* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
 JitChannelQueueManager::CreateThreadSafe(Package* package,
                                          std::unique_ptr<JitRuntime> runtime) {
@@ -178,6 +280,31 @@ JitChannelQueueManager::CreateThreadUnsafe(
       std::move(elaboration), std::move(queues), std::move(runtime)));
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateLockFree(Package* package,
+                                       std::unique_ptr<JitRuntime> runtime) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateLockFree(std::move(elaboration), std::move(runtime));
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+JitChannelQueueManager::CreateLockFree(ProcElaboration&& elaboration,
+                                       std::unique_ptr<JitRuntime> runtime) {
+  std::vector<std::unique_ptr<ChannelQueue>> queues;
+  for (ChannelInstance* channel_instance : elaboration.channel_instances()) {
+    if (IsSingleProducerSingleConsumer(elaboration, channel_instance)) {
+      queues.push_back(std::make_unique<LockFreeJitChannelQueue>(
+          channel_instance, runtime.get()));
+    } else {
+      queues.push_back(std::make_unique<ThreadSafeJitChannelQueue>(
+          channel_instance, runtime.get()));
+    }
+  }
+  return absl::WrapUnique(new JitChannelQueueManager(
+      std::move(elaboration), std::move(queues), std::move(runtime)));
+}
+
 JitChannelQueue& JitChannelQueueManager::GetJitQueue(Channel* channel) {
   JitChannelQueue* queue = dynamic_cast<JitChannelQueue*>(&GetQueue(channel));
   CHECK_NE(queue, nullptr);
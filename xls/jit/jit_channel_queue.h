@@ -25,6 +25,7 @@
 #include "absl/container/inlined_vector.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "xls/data_structures/spsc_segmented_ring.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/package.h"
@@ -58,6 +59,7 @@ class ByteQueue {
       Resize();
     }
     memcpy(circular_buffer_.data() + write_index_, data, channel_element_size_);
+    ++write_count_;
     if (is_single_value_) {
       bytes_used_ = allocated_element_size_;
     } else {
@@ -75,6 +77,7 @@ class ByteQueue {
     }
     memcpy(buffer, circular_buffer_.data() + read_index_,
            channel_element_size_);
+    ++read_count_;
     if (!is_single_value_) {
       // Reads are destructive for non single-value channels.
       bytes_used_ -= allocated_element_size_;
@@ -88,6 +91,11 @@ class ByteQueue {
 
   int64_t size() const { return bytes_used_ / allocated_element_size_; }
 
+  // Returns the total number of elements written to and read from the queue.
+  // Non-destructive reads of single-value queues are counted.
+  int64_t write_count() const { return write_count_; }
+  int64_t read_count() const { return read_count_; }
+
   static constexpr int64_t kInitBufferSize = 128;
 
  private:
@@ -106,12 +114,76 @@ class ByteQueue {
   int64_t read_index_ = 0;
   // Index in the circular buffer to read values from.
   int64_t write_index_ = 0;
+  int64_t write_count_ = 0;
+  int64_t read_count_ = 0;
   // A circular buffer to store the elements. It is preallocated with storage.
   absl::InlinedVector<uint8_t, kInitBufferSize> circular_buffer_;
   // Whether this queue follows single-value channel semantics.
   bool is_single_value_;
 };
 
+// A queue of raw bytes which is safe for one producer thread and one consumer
+// thread to access concurrently without locking. Elements are stored in a
+// SpscSegmentedRing, so in steady state (when the queue does not outgrow its
+// current segment) no allocation is performed. Only streaming (FIFO)
+// semantics are supported.
+class SpscByteQueue {
+ public:
+  // `channel_element_size` is the number of bytes in each element.
+  // `min_capacity` is a lower bound on the number of elements the queue can
+  // hold before allocating an additional segment.
+  SpscByteQueue(int64_t channel_element_size, int64_t min_capacity);
+
+  SpscByteQueue(const SpscByteQueue&) = delete;
+  SpscByteQueue& operator=(const SpscByteQueue&) = delete;
+
+  int64_t element_size() const { return channel_element_size_; }
+
+  // Writes an element. Must only be called by the producer.
+  void Write(const uint8_t* data);
+
+  // Reads an element into `buffer`. Returns false if the queue is empty. Must
+  // only be called by the consumer.
+  bool Read(uint8_t* buffer);
+
+  // Inline fast paths of `Write` and `Read` which only handle the common case
+  // of the element fitting in (or being available in) the current segment.
+  // Return false without touching the queue otherwise, in which case the
+  // caller should fall back to `Write` or `Read`.
+  bool TryWriteFast(const uint8_t* data) {
+#ifdef ABSL_HAVE_MEMORY_SANITIZER
+    __msan_unpoison(data, channel_element_size_);
+#endif
+    return ring_.TryWriteFast([&](uint8_t* slot) {
+      memcpy(slot, data, channel_element_size_);
+    });
+  }
+  bool TryReadFast(uint8_t* buffer) {
+    return ring_.TryReadFast([&](uint8_t* slot) {
+      memcpy(buffer, slot, channel_element_size_);
+    });
+  }
+
+  // Returns the number of elements in the queue. The value is exact when
+  // called from either the producer or the consumer while the other side is
+  // quiescent, and otherwise a snapshot.
+  int64_t size() const { return ring_.size(); }
+
+  // Returns the total number of elements written to and read from the queue.
+  int64_t write_count() const { return ring_.write_count(); }
+  int64_t read_count() const { return ring_.read_count(); }
+
+  static constexpr int64_t kMinSegmentCapacity =
+      SpscSegmentedRing<uint8_t>::kMinSegmentCapacity;
+
+ private:
+  // Size of an element in the channel in units of bytes.
+  int64_t channel_element_size_;
+  // Each slot of the ring is an element rounded up to the alignment of the
+  // largest scalar type.
+  SpscSegmentedRing<uint8_t> ring_;
+};
+
 // Abstract base class for channel queues which may be used by the JIT. These
 // queues support reading and writing raw bytes to the queue rather the just
 // xls::Values.
@@ -168,6 +240,10 @@ class ThreadSafeJitChannelQueue : public JitChannelQueue {
 
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPushCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPopCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value)
       ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   std::optional<Value> ReadInternal()
@@ -209,12 +285,78 @@ class ThreadUnsafeJitChannelQueue : public JitChannelQueue {
 
  protected:
   int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPushCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPopCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
   void WriteInternal(const Value& value) override;
   std::optional<Value> ReadInternal() override;
 
   ByteQueue byte_queue_;
 };
 
+// A JIT channel queue for streaming channels with exactly one sending proc
+// instance and one receiving proc instance. The raw read/write paths take no
+// lock; the sender and receiver may run on different threads. At most one
+// thread may write and at most one thread may read at any time.
+class LockFreeJitChannelQueue : public JitChannelQueue {
+ public:
+  LockFreeJitChannelQueue(ChannelInstance* channel_instance,
+                          JitRuntime* jit_runtime);
+  ~LockFreeJitChannelQueue() override = default;
+
+  void WriteRaw(const uint8_t* data) override {
+    byte_queue_.Write(data);
+    if (!callbacks_.empty()) {
+      CallWriteCallbacks(jit_runtime_->UnpackBuffer(data, channel()->type()));
+    }
+  }
+
+  // Non-virtual equivalents of `WriteRaw` and `ReadRaw` for callers which
+  // have bound the concrete queue, such as JITted procs. Elements which fit
+  // in the current segment of a queue without callbacks or a generator are
+  // transferred entirely inline.
+  void WriteRawDirect(const uint8_t* data) {
+    if (callbacks_.empty() && byte_queue_.TryWriteFast(data)) {
+      return;
+    }
+    LockFreeJitChannelQueue::WriteRaw(data);
+  }
+  bool ReadRawDirect(uint8_t* buffer) {
+    if (!generator_.has_value() && callbacks_.empty() &&
+        byte_queue_.TryReadFast(buffer)) {
+      return true;
+    }
+    return LockFreeJitChannelQueue::ReadRaw(buffer);
+  }
+
+  bool ReadRaw(uint8_t* buffer) override {
+    // Only the consumer reads so calling the generator is race-free.
+    if (generator_.has_value()) {
+      std::optional<Value> generated_value = (*generator_)();
+      if (generated_value.has_value()) {
+        WriteInternal(generated_value.value());
+      }
+    }
+    bool value_read = byte_queue_.Read(buffer);
+    if (value_read && !callbacks_.empty()) {
+      CallReadCallbacks(jit_runtime_->UnpackBuffer(buffer, channel()->type()));
+    }
+    return value_read;
+  }
+
+ protected:
+  int64_t GetSizeInternal() const ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPushCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  int64_t GetPopCountInternal() const
+      ABSL_SHARED_LOCKS_REQUIRED(mutex_) override;
+  void WriteInternal(const Value& value) override;
+  std::optional<Value> ReadInternal() override;
+
+  SpscByteQueue byte_queue_;
+};
+
 // A Channel manager which holds exclusively JitChannelQueues.
 class JitChannelQueueManager : public ChannelQueueManager {
  public:
@@ -233,6 +375,16 @@ class JitChannelQueueManager : public ChannelQueueManager {
   CreateThreadUnsafe(ProcElaboration&& elaboration,
                      std::unique_ptr<JitRuntime> runtime);
 
+  // Factories which create a queue manager holding a LockFreeJitChannelQueue
+  // for each single-producer/single-consumer streaming channel and a
+  // ThreadSafeJitChannelQueue for all other channels. Suitable for runtimes
+  // which tick procs on multiple threads.
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+  CreateLockFree(Package* package, std::unique_ptr<JitRuntime> runtime);
+  static absl::StatusOr<std::unique_ptr<JitChannelQueueManager>>
+  CreateLockFree(ProcElaboration&& elaboration,
+                 std::unique_ptr<JitRuntime> runtime);
+
   JitChannelQueue& GetJitQueue(Channel* channel);
   JitChannelQueue& GetJitQueue(ChannelInstance* channel_instance);
 
@@ -25,10 +25,12 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/channel_queue_test_base.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/value.h"
@@ -68,7 +70,8 @@ template <typename QueueT>
 class JitChannelQueueTest : public ::testing::Test {};
 
 using QueueTypes =
-    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue>;
+    ::testing::Types<ThreadSafeJitChannelQueue, ThreadUnsafeJitChannelQueue,
+                     LockFreeJitChannelQueue>;
 TYPED_TEST_SUITE(JitChannelQueueTest, QueueTypes);
 
 // An empty tuple represents a zero width.
@@ -181,5 +184,137 @@ TYPED_TEST(JitChannelQueueTest, IotaGeneratorWithRawApi) {
                                  "a generator function")));
 }
 
+TEST(LockFreeJitChannelQueueTest, GrowsBeyondInitialSegment) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  LockFreeJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                                GetJitRuntime());
+
+  // Interleave bursts of writes larger than the initial segment with partial
+  // drains so reads cross several segment boundaries.
+  constexpr int64_t kBurst = 5 * SpscByteQueue::kMinSegmentCapacity + 3;
+  uint32_t next_write = 0;
+  uint32_t next_read = 0;
+  for (int64_t round = 0; round < 4; ++round) {
+    for (int64_t i = 0; i < kBurst; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&next_write));
+      ++next_write;
+    }
+    EXPECT_EQ(queue.GetSize(), next_write - next_read);
+    for (int64_t i = 0; i < kBurst / 2; ++i) {
+      uint32_t value;
+      ASSERT_TRUE(queue.ReadRaw(reinterpret_cast<uint8_t*>(&value)));
+      EXPECT_EQ(value, next_read);
+      ++next_read;
+    }
+  }
+  uint32_t value;
+  while (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+    EXPECT_EQ(value, next_read);
+    ++next_read;
+  }
+  EXPECT_EQ(next_read, next_write);
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(LockFreeJitChannelQueueTest, DirectAccessCrossesSegments) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  LockFreeJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                                GetJitRuntime());
+
+  constexpr uint32_t kCount = 3 * SpscByteQueue::kMinSegmentCapacity + 1;
+  for (uint32_t i = 0; i < kCount; ++i) {
+    queue.WriteRawDirect(reinterpret_cast<const uint8_t*>(&i));
+  }
+  EXPECT_EQ(queue.GetSize(), kCount);
+  for (uint32_t i = 0; i < kCount; ++i) {
+    uint32_t value;
+    ASSERT_TRUE(queue.ReadRawDirect(reinterpret_cast<uint8_t*>(&value)));
+    EXPECT_EQ(value, i);
+  }
+  uint32_t value;
+  EXPECT_FALSE(queue.ReadRawDirect(reinterpret_cast<uint8_t*>(&value)));
+
+  // A generator still supplies values through the direct path.
+  XLS_ASSERT_OK(queue.AttachGenerator(
+      []() -> std::optional<Value> { return Value(UBits(7, 32)); }));
+  ASSERT_TRUE(queue.ReadRawDirect(reinterpret_cast<uint8_t*>(&value)));
+  EXPECT_EQ(value, 7);
+}
+
+TEST(LockFreeJitChannelQueueTest, ConcurrentProducerAndConsumer) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * channel,
+      package.CreateStreamingChannel("my_channel", ChannelOps::kSendReceive,
+                                     package.GetBitsType(64)));
+  XLS_ASSERT_OK_AND_ASSIGN(ProcElaboration elaboration,
+                           ProcElaboration::ElaborateOldStylePackage(&package));
+  LockFreeJitChannelQueue queue(elaboration.GetUniqueInstance(channel).value(),
+                                GetJitRuntime());
+
+  constexpr uint64_t kCount = 100000;
+  Thread producer([&]() {
+    for (uint64_t i = 0; i < kCount; ++i) {
+      queue.WriteRaw(reinterpret_cast<const uint8_t*>(&i));
+    }
+  });
+  uint64_t expected = 0;
+  while (expected < kCount) {
+    uint64_t value;
+    if (queue.ReadRaw(reinterpret_cast<uint8_t*>(&value))) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    }
+  }
+  producer.Join();
+  EXPECT_TRUE(queue.IsEmpty());
+}
+
+TEST(JitChannelQueueManagerTest, CreateLockFreeSelectsQueueKind) {
+  Package package("test");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * internal,
+      package.CreateStreamingChannel("internal", ChannelOps::kSendReceive,
+                                     package.GetBitsType(32)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * single_value,
+      package.CreateSingleValueChannel("single_value", ChannelOps::kReceiveOnly,
+                                       package.GetBitsType(32)));
+  {
+    ProcBuilder pb("producer", &package);
+    BValue v = pb.Receive(single_value, pb.Literal(Value::Token()));
+    pb.Send(internal, pb.TupleIndex(v, 0), pb.TupleIndex(v, 1));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+  {
+    ProcBuilder pb("consumer", &package);
+    pb.Receive(internal, pb.Literal(Value::Token()));
+    XLS_ASSERT_OK(pb.Build().status());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<JitChannelQueueManager> manager,
+      JitChannelQueueManager::CreateLockFree(
+          &package, std::make_unique<JitRuntime>(
+                        OrcJit::Create().value()->CreateDataLayout().value())));
+  EXPECT_NE(dynamic_cast<LockFreeJitChannelQueue*>(
+                &manager->GetJitQueue(internal)),
+            nullptr);
+  EXPECT_NE(dynamic_cast<ThreadSafeJitChannelQueue*>(
+                &manager->GetJitQueue(single_value)),
+            nullptr);
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,31 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <string>
+#include <string_view>
+
+#include "llvm/include/llvm/Config/llvm-config.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+
+namespace xls {
+
+std::string ComputeJitObjectCacheKey(std::string_view llvm_ir,
+                                     std::string_view options) {
+  return ContentAddressedDirectoryCache::ComputeKey(
+      {std::string_view(LLVM_VERSION_STRING), options, llvm_ir});
+}
+
+}  // namespace xls
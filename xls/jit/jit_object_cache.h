@@ -0,0 +1,43 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_JIT_OBJECT_CACHE_H_
+#define XLS_JIT_JIT_OBJECT_CACHE_H_
+
+#include <string>
+#include <string_view>
+
+#include "xls/common/file/content_addressed_directory_cache.h"
+
+namespace xls {
+
+// Describes the persistent cache of compiled relocatable objects consulted by
+// OrcJit. Objects are keyed by ComputeJitObjectCacheKey, which captures
+// everything affecting code generation, so a cache directory may be safely
+// shared between processes, tools and LLVM versions.
+inline constexpr ContentAddressedDirectoryCache::Options
+    kJitObjectCacheOptions = {.directory_env_var = "XLS_JIT_OBJECT_CACHE_DIR",
+                              .extension = ".o",
+                              .description = "JIT object"};
+
+// Returns the key under which the object code for `llvm_ir` compiled with the
+// compiler configuration described by `options` is stored. `options` should
+// describe the optimization level, instrumentation and target; the LLVM
+// version is folded in automatically.
+std::string ComputeJitObjectCacheKey(std::string_view llvm_ir,
+                                     std::string_view options);
+
+}  // namespace xls
+
+#endif  // XLS_JIT_JIT_OBJECT_CACHE_H_
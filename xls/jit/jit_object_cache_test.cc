@@ -0,0 +1,109 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/jit_object_cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/package.h"
+#include "xls/jit/function_base_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/orc_jit.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::Eq;
+using ::testing::Not;
+
+TEST(JitObjectCacheTest, KeyDependsOnIrAndOptions) {
+  std::string key = ComputeJitObjectCacheKey("ir", "options");
+  EXPECT_EQ(key, ComputeJitObjectCacheKey("ir", "options"));
+  EXPECT_THAT(key, Not(Eq(ComputeJitObjectCacheKey("ir2", "options"))));
+  EXPECT_THAT(key, Not(Eq(ComputeJitObjectCacheKey("ir", "options2"))));
+}
+
+// Jits `a + b` using `cache` and returns the result of evaluating it on
+// 40 and 2.
+absl::StatusOr<uint32_t> JitAndRunAdd(ContentAddressedDirectoryCache* cache,
+                                      int64_t opt_level) {
+  Package package("cache_test");
+  FunctionBuilder fb("add", &package);
+  fb.Add(fb.Param("a", package.GetBitsType(32)),
+         fb.Param("b", package.GetBitsType(32)));
+  XLS_ASSIGN_OR_RETURN(Function * f, fb.Build());
+
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> orc_jit,
+                       OrcJit::Create(opt_level));
+  orc_jit->SetObjectCache(cache);
+  XLS_ASSIGN_OR_RETURN(JittedFunctionBase jitted,
+                       JittedFunctionBase::Build(f, *orc_jit));
+
+  JitArgumentSet inputs = jitted.CreateInputBuffer();
+  JitArgumentSet outputs = jitted.CreateOutputBuffer();
+  JitTempBuffer temp = jitted.CreateTempBuffer();
+  uint32_t a = 40;
+  uint32_t b = 2;
+  std::memcpy(inputs.pointers()[0], &a, sizeof(a));
+  std::memcpy(inputs.pointers()[1], &b, sizeof(b));
+  InterpreterEvents events;
+  jitted.RunJittedFunction(inputs, outputs, temp, &events,
+                           /*instance_context=*/nullptr,
+                           /*jit_runtime=*/nullptr, /*continuation_point=*/0);
+  uint32_t result;
+  std::memcpy(&result, outputs.pointers()[0], sizeof(result));
+  return result;
+}
+
+TEST(JitObjectCacheTest, OrcJitUsesCachedObject) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ContentAddressedDirectoryCache> cache,
+      ContentAddressedDirectoryCache::Create(temp_dir.path(),
+                                             kJitObjectCacheOptions));
+
+  EXPECT_THAT(JitAndRunAdd(cache.get(), /*opt_level=*/3),
+              IsOkAndHolds(42));
+  EXPECT_EQ(cache->hits(), 0);
+  EXPECT_EQ(cache->misses(), 1);
+
+  EXPECT_THAT(JitAndRunAdd(cache.get(), /*opt_level=*/3),
+              IsOkAndHolds(42));
+  EXPECT_EQ(cache->hits(), 1);
+  EXPECT_EQ(cache->misses(), 1);
+
+  // A different optimization level produces a different object.
+  EXPECT_THAT(JitAndRunAdd(cache.get(), /*opt_level=*/1),
+              IsOkAndHolds(42));
+  EXPECT_EQ(cache->hits(), 1);
+  EXPECT_EQ(cache->misses(), 2);
+}
+
+}  // namespace
+}  // namespace xls
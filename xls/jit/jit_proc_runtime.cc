@@ -38,8 +38,11 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/proc_evaluator.h"
 #include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/clone_package.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
@@ -52,6 +55,10 @@
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 #include "xls/jit/proc_jit.h"
+#include "xls/passes/dce_pass.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/proc_inlining_pass.h"
 
 namespace xls {
 namespace {
@@ -232,8 +239,15 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateAotRuntime(
   return std::move(proc_runtime);
 }
 
-absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
-    ProcElaboration elaboration, const EvaluatorOptions& options) {
+// Creates the queue manager and a ProcJit for each proc in the elaboration,
+// then builds the runtime with `create_runtime` and injects the initial channel
+// values.
+// If `lock_free_queues` is true, single-producer/single-consumer channels are
+// backed by LockFreeJitChannelQueues.
+template <typename RuntimeT, typename CreateFn>
+absl::StatusOr<std::unique_ptr<RuntimeT>> CreateRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    bool lock_free_queues, CreateFn create_runtime) {
   // We use the compiler to know the data layout.
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OrcJit> comp,
@@ -245,8 +259,11 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
   // receive only queue for every receive only channel.
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<JitChannelQueueManager> queue_manager,
-      JitChannelQueueManager::CreateThreadSafe(
-          std::move(elaboration), std::make_unique<JitRuntime>(layout)));
+      lock_free_queues
+          ? JitChannelQueueManager::CreateLockFree(
+                std::move(elaboration), std::make_unique<JitRuntime>(layout))
+          : JitChannelQueueManager::CreateThreadSafe(
+                std::move(elaboration), std::make_unique<JitRuntime>(layout)));
 
   // Create a ProcJit for each Proc.
   std::vector<std::unique_ptr<ProcEvaluator>> proc_jits;
@@ -261,29 +278,100 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateRuntime(
 
   // Create a runtime.
   XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<SerialProcRuntime> proc_runtime,
-      SerialProcRuntime::Create(std::move(proc_jits), std::move(queue_manager),
-                                options));
+      std::unique_ptr<RuntimeT> proc_runtime,
+      create_runtime(std::move(proc_jits), std::move(queue_manager)));
 
   XLS_RETURN_IF_ERROR(InsertInitialChannelValues(
       proc_runtime->elaboration(), proc_runtime->queue_manager()));
   return std::move(proc_runtime);
 }
 
+absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateSerialRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options) {
+  return CreateRuntime<SerialProcRuntime>(
+      std::move(elaboration), options, /*lock_free_queues=*/false,
+      [&](std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+          std::unique_ptr<ChannelQueueManager>&& queue_manager) {
+        return SerialProcRuntime::Create(std::move(evaluators),
+                                         std::move(queue_manager), options);
+      });
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>> CreateParallelRuntime(
+    ProcElaboration elaboration, const EvaluatorOptions& options,
+    int64_t num_threads) {
+  return CreateRuntime<ParallelProcRuntime>(
+      std::move(elaboration), options, /*lock_free_queues=*/true,
+      [&](std::vector<std::unique_ptr<ProcEvaluator>>&& evaluators,
+          std::unique_ptr<ChannelQueueManager>&& queue_manager) {
+        return ParallelProcRuntime::Create(std::move(evaluators),
+                                           std::move(queue_manager), options,
+                                           num_threads);
+      });
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Package* package, const EvaluatorOptions& options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::ElaborateOldStylePackage(package));
-  return CreateRuntime(std::move(elaboration), options);
+  return CreateSerialRuntime(std::move(elaboration), options);
 }
 
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top, const EvaluatorOptions& options) {
   XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
                        ProcElaboration::Elaborate(top));
-  return CreateRuntime(std::move(elaboration), options);
+  return CreateSerialRuntime(std::move(elaboration), options);
+}
+
+absl::StatusOr<FusedJitProcRuntime> CreateFusedJitSerialProcRuntime(
+    Package* package, const EvaluatorOptions& options) {
+  if (package->ChannelsAreProcScoped()) {
+    return absl::UnimplementedError(
+        "Fused proc runtimes do not support proc-scoped channels");
+  }
+  std::optional<FunctionBase*> top = package->GetTop();
+  if (!top.has_value() || !(*top)->IsProc()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Package `%s` must have a top proc to fuse", package->name()));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> fused, ClonePackage(package));
+  XLS_RETURN_IF_ERROR(fused->SetTopByName((*top)->name()));
+
+  OptimizationPassOptions pass_options;
+  pass_options.inline_procs = true;
+  PassResults results;
+  XLS_RETURN_IF_ERROR(
+      ProcInliningPass().Run(fused.get(), pass_options, &results).status());
+  XLS_RETURN_IF_ERROR(DeadCodeEliminationPass()
+                          .Run(fused.get(), OptimizationPassOptions(), &results)
+                          .status());
+  XLS_RET_CHECK_EQ(fused->procs().size(), 1);
+
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(fused.get()));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<SerialProcRuntime> runtime,
+                       CreateSerialRuntime(std::move(elaboration), options));
+  return FusedJitProcRuntime{.package = std::move(fused),
+                             .runtime = std::move(runtime)};
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Package* package, const EvaluatorOptions& options,
+                             int64_t num_threads) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::ElaborateOldStylePackage(package));
+  return CreateParallelRuntime(std::move(elaboration), options, num_threads);
+}
+
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(Proc* top, const EvaluatorOptions& options,
+                             int64_t num_threads) {
+  XLS_ASSIGN_OR_RETURN(ProcElaboration elaboration,
+                       ProcElaboration::Elaborate(top));
+  return CreateParallelRuntime(std::move(elaboration), options, num_threads);
 }
 
 absl::StatusOr<JitObjectCode> CreateProcAotObjectCode(Package* package,
@@ -22,6 +22,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/parallel_proc_runtime.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/package.h"
 #include "xls/ir/xls_ir_interface.pb.h"
@@ -41,6 +42,41 @@ absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
 absl::StatusOr<std::unique_ptr<SerialProcRuntime>> CreateJitSerialProcRuntime(
     Proc* top, const EvaluatorOptions& options = EvaluatorOptions());
 
+// Create a ParallelProcRuntime composed of ProcJits. Supports old-style procs.
+// `num_threads` is the number of worker threads; if zero, one worker per
+// available CPU is used.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions(),
+    int64_t num_threads = 0);
+
+// Create a ParallelProcRuntime composed of ProcJits. Constructed from the
+// elaboration of the given proc. Supports new-style procs.
+absl::StatusOr<std::unique_ptr<ParallelProcRuntime>>
+CreateJitParallelProcRuntime(
+    Proc* top, const EvaluatorOptions& options = EvaluatorOptions(),
+    int64_t num_threads = 0);
+
+// A runtime for a proc network fused into a single proc, along with the
+// package holding the fused proc.
+struct FusedJitProcRuntime {
+  // Owns the IR the runtime executes. Declared first so it outlives `runtime`.
+  std::unique_ptr<Package> package;
+  std::unique_ptr<SerialProcRuntime> runtime;
+};
+
+// Create a SerialProcRuntime which runs all procs of `package` as a single
+// ProcJit. A copy of the package has every proc inlined into its top proc
+// with ProcInliningPass, so LLVM compiles and optimizes the whole network as
+// one function and internal channels become proc state (or plain values)
+// instead of queues. Only external channels remain visible through the
+// runtime's queue manager, and only the top proc's events and state can be
+// queried. Supports old-style procs; `package` must have a top proc and its
+// internal channels must be single-value channels or have a FIFO depth of at
+// most one. `package` is not modified.
+absl::StatusOr<FusedJitProcRuntime> CreateFusedJitSerialProcRuntime(
+    Package* package, const EvaluatorOptions& options = EvaluatorOptions());
+
 struct ProcAotEntrypoints {
   // What proc these entrypoints are associated with.
   PackageInterfaceProto::Proc proc_interface_proto;
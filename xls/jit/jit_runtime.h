@@ -27,6 +27,7 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -108,6 +109,12 @@ class JitRuntime {
     return type_converter_->GetTypePreferredAlignment(xls_type);
   }
 
+  // Returns the native layout of `xls_type` as used by the jitted code.
+  TypeLayout CreateTypeLayout(Type* xls_type) {
+    absl::MutexLock lock(&mutex_);
+    return type_converter_->CreateTypeLayout(xls_type);
+  }
+
   const llvm::DataLayout& data_layout() const { return data_layout_; }
 
  private:
@@ -109,6 +109,19 @@ _AOT_INFO = flags.DEFINE_string(
 )
 
 
+@dataclasses.dataclass(frozen=True)
+class NativeType:
+  """A C++ type laid out identically to the jit's native layout of a type."""
+
+  cpp_type: str
+  size: int
+  alignment: int
+  # Byte offset of each leaf element of the type.
+  leaf_offsets: Sequence[int]
+  # Definitions of the structs the type uses, innermost first.
+  definitions: Sequence[str] = ()
+
+
 @dataclasses.dataclass(frozen=True)
 class XlsNamedValue:
   """A Named & typed value for the wrapped function/proc."""
@@ -117,6 +130,7 @@ class XlsNamedValue:
   packed_type: str
   unpacked_type: str
   specialized_type: Optional[str]
+  native_type: Optional[NativeType] = None
 
   @property
   def value_arg(self):
@@ -134,6 +148,10 @@ class XlsNamedValue:
   def specialized_arg(self):
     return f"{self.specialized_type} {self.name}"
 
+  @property
+  def native_arg(self):
+    return f"const {self.native_type.cpp_type}& {self.name}"
+
 
 class JitType(enum.Enum):
   FUNCTION = 1
@@ -148,6 +166,7 @@ class XlsChannel:
   packed_type: str
   unpacked_type: str
   specialized_type: Optional[str]
+  native_type: Optional[NativeType] = None
 
 
 @dataclasses.dataclass(frozen=True)
@@ -157,6 +176,7 @@ class XlsPort:
   snake_name: str
   bit_count: Optional[int]
   specialized_type: Optional[str]
+  native_type: Optional[NativeType] = None
 
 
 @dataclasses.dataclass(frozen=True)
@@ -194,6 +214,36 @@ class WrappedIr:
   def params_and_result(self):
     return list(self.params) + [self.result]
 
+  @property
+  def can_use_native(self) -> bool:
+    """Whether every param and the result have a native struct."""
+    return all(p.native_type is not None for p in self.params_and_result)
+
+  @property
+  def native_definitions(self) -> Sequence[str]:
+    return [
+        d for p in self.params_and_result for d in p.native_type.definitions
+    ]
+
+  @property
+  def channel_native_definitions(self) -> Sequence[str]:
+    channels = itertools.chain(self.incoming_channels, self.outgoing_channels)
+    definitions = [
+        d
+        for c in channels
+        if c.native_type is not None
+        for d in c.native_type.definitions
+    ]
+    return list(dict.fromkeys(definitions))
+
+  @property
+  def can_use_native_ports(self) -> bool:
+    """Whether every block port has a native type."""
+    return all(
+        p.native_type is not None
+        for p in itertools.chain(self.input_ports, self.output_ports)
+    )
+
 
 def to_packed(t: type_pb2.TypeProto) -> str:
   the_type = t.type_enum
@@ -242,6 +292,93 @@ def to_unpacked(t: type_pb2.TypeProto, mutable: bool = False) -> str:
   )
 
 
+def round_up(value: int, alignment: int) -> int:
+  return -(-value // alignment) * alignment
+
+
+def to_native(t: type_pb2.TypeProto, name: str) -> Optional[NativeType]:
+  """Get a C++ type laid out like the jit's native layout of a type.
+
+  Bits types are represented by the smallest unsigned integer holding them and
+  aggregates by structs and std::arrays of their elements, so the C++ layout
+  rules reproduce the LLVM layout used by the jit. Empty types, tokens and bits
+  wider than 64 have no native type.
+
+  Args:
+    t: The xls type
+    name: The name of the struct to generate if `t` is a tuple.
+
+  Returns:
+    the native type or None if the type has no native representation.
+  """
+  the_type = t.type_enum
+  if the_type == type_pb2.TypeProto.BITS:
+    for size, cpp_type in ((1, "uint8_t"), (2, "uint16_t"), (4, "uint32_t"),
+                           (8, "uint64_t")):
+      if 0 < t.bit_count <= size * 8:
+        return NativeType(
+            cpp_type=cpp_type, size=size, alignment=size, leaf_offsets=[0]
+        )
+    return None
+  elif the_type == type_pb2.TypeProto.ARRAY:
+    element = to_native(t.array_element, f"{name}Element")
+    if element is None or t.array_size == 0:
+      return None
+    return NativeType(
+        cpp_type=f"std::array<{element.cpp_type}, {t.array_size}>",
+        size=element.size * t.array_size,
+        alignment=element.alignment,
+        leaf_offsets=[
+            i * element.size + o
+            for i in range(t.array_size)
+            for o in element.leaf_offsets
+        ],
+        definitions=element.definitions,
+    )
+  elif the_type == type_pb2.TypeProto.TUPLE:
+    definitions = []
+    members = []
+    leaf_offsets = []
+    offset = 0
+    alignment = 1
+    for i, e in enumerate(t.tuple_elements):
+      element = to_native(e, f"{name}Element{i}")
+      if element is None:
+        return None
+      definitions.extend(element.definitions)
+      offset = round_up(offset, element.alignment)
+      leaf_offsets.extend(offset + o for o in element.leaf_offsets)
+      members.append(f"    {element.cpp_type} element{i};")
+      offset += element.size
+      alignment = max(alignment, element.alignment)
+    if not members:
+      return None
+    size = round_up(offset, alignment)
+    definitions.append(
+        "\n".join(
+            [f"  struct {name} {{", *members, "  };"]
+            + [f"  static_assert(sizeof({name}) == {size});"]
+        )
+    )
+    return NativeType(
+        cpp_type=name,
+        size=size,
+        alignment=alignment,
+        leaf_offsets=leaf_offsets,
+        definitions=definitions,
+    )
+  return None
+
+
+def native_matches_layout(native: Optional[NativeType], layout) -> bool:
+  """Checks a native type against the jit's TypeLayoutProto of the type."""
+  return (
+      native is not None
+      and native.size == layout.size
+      and list(native.leaf_offsets) == [e.offset for e in layout.elements]
+  )
+
+
 def is_floating_point(
     t: type_pb2.TypeProto, exponent_bits: int, mantissa_bits: int
 ) -> bool:
@@ -309,37 +446,88 @@ def to_specialized(
 def to_chan(
     c: ir_interface_pb2.PackageInterfaceProto.Channel, package_name: str
 ) -> XlsChannel:
+  camel_name = camelize(c.name.removeprefix(f"{package_name}__"))
   return XlsChannel(
       xls_name=c.name,
-      camel_name=camelize(c.name.removeprefix(f"{package_name}__")),
+      camel_name=camel_name,
       packed_type=to_packed(c.type),
       unpacked_type=to_unpacked(c.type),
       specialized_type=to_specialized(c.type),
+      native_type=to_native(c.type, f"{camel_name}Native"),
   )
 
 
 def to_param(
     p: ir_interface_pb2.PackageInterfaceProto.NamedValue,
+    layout=None,
 ) -> XlsNamedValue:
+  """Get the wrapper value for a param.
+
+  Args:
+    p: The param.
+    layout: The jit's TypeLayoutProto of the param. If given and matched by
+      the native struct of the param's type, the struct is used for native
+      calls.
+
+  Returns:
+    the wrapper value.
+  """
+  native = None
+  if layout is not None:
+    native = to_native(p.type, f"{camelize(p.name)}Native")
+    if not native_matches_layout(native, layout):
+      native = None
   return XlsNamedValue(
       name=p.name,
       packed_type=to_packed(p.type),
       unpacked_type=to_unpacked(p.type),
       specialized_type=to_specialized(p.type),
+      native_type=native,
   )
 
 
 def to_port(
-    p: ir_interface_pb2.PackageInterfaceProto.NamedValue, package_name: str
+    p: ir_interface_pb2.PackageInterfaceProto.NamedValue,
+    package_name: str,
+    buffer_size: Optional[int] = None,
 ) -> XlsPort:
+  """Get the wrapper port for a block port.
+
+  Args:
+    p: The port.
+    package_name: The name of the package.
+    buffer_size: The size of the jit's buffer for the port. If given and equal
+      to the size of the native type of the port, the type is used for native
+      accesses.
+
+  Returns:
+    the wrapper port.
+  """
+  camel_name = camelize(p.name.removeprefix(f"{package_name}__"))
+  native = to_native(p.type, f"{camel_name}Native")
+  if native is not None and native.size != buffer_size:
+    native = None
   return XlsPort(
       xls_name=p.name,
-      camel_name=camelize(p.name.removeprefix(f"{package_name}__")),
+      camel_name=camel_name,
       snake_name=p.name.removeprefix(f"{package_name}__"),
       bit_count=p.type.bit_count
       if p.type.type_enum == type_pb2.TypeProto.BITS
       else None,
       specialized_type=to_specialized(p.type, int_only=True),
+      native_type=native,
+  )
+
+
+def matches_implicit_token(
+    params: Sequence[ir_interface_pb2.PackageInterfaceProto.NamedValue],
+) -> bool:
+  """Matches the parameter signature of an implicit-token function."""
+  return (
+      len(params) >= 2
+      and params[0].type.type_enum == type_pb2.TypeProto.TOKEN
+      and params[1].type.type_enum == type_pb2.TypeProto.BITS
+      and params[1].type.bit_count == 1
   )
 
 
@@ -369,12 +557,33 @@ def interpret_function_interface(
   """
   if func_ir.base.name != aot_info.entrypoint[0].xls_function_identifier:
     raise app.UsageError("Aot info is for a different function.")
-  params = [to_param(p) for p in func_ir.parameters]
+  entrypoint = aot_info.entrypoint[0]
+  # Native structs are checked against the layouts the jit actually uses.
+  # Implicit-token functions take extra arguments so they have none.
+  input_layouts = [None] * len(func_ir.parameters)
+  result_layout = None
+  if (
+      not matches_implicit_token(func_ir.parameters)
+      and len(entrypoint.inputs_layout.layouts) == len(func_ir.parameters)
+      and len(entrypoint.outputs_layout.layouts) == 1
+  ):
+    input_layouts = list(entrypoint.inputs_layout.layouts)
+    result_layout = entrypoint.outputs_layout.layouts[0]
+  params = [
+      to_param(p, layout)
+      for p, layout in zip(func_ir.parameters, input_layouts)
+  ]
+  result_native = None
+  if result_layout is not None:
+    result_native = to_native(func_ir.result_type, "ResultNative")
+    if not native_matches_layout(result_native, result_layout):
+      result_native = None
   result = XlsNamedValue(
       name="result",
       packed_type=to_packed(func_ir.result_type),
       unpacked_type=to_unpacked(func_ir.result_type, mutable=True),
       specialized_type=to_specialized(func_ir.result_type),
+      native_type=result_native,
   )
   namespace = _WRAPPER_NAMESPACE.value
   return WrappedIr(
@@ -464,8 +673,22 @@ def interpret_block_interface(
   Returns:
     A wrapped ir for the block.
   """
-  input_ports = [to_port(p, package.name) for p in block_ir.input_ports]
-  output_ports = [to_port(p, package.name) for p in block_ir.output_ports]
+  # The jit's buffers hold the ports followed by the registers.
+  entrypoint = aot_info.entrypoint[0]
+  input_sizes = itertools.chain(
+      entrypoint.input_buffer_sizes, itertools.repeat(None)
+  )
+  output_sizes = itertools.chain(
+      entrypoint.output_buffer_sizes, itertools.repeat(None)
+  )
+  input_ports = [
+      to_port(p, package.name, s)
+      for p, s in zip(block_ir.input_ports, input_sizes)
+  ]
+  output_ports = [
+      to_port(p, package.name, s)
+      for p, s in zip(block_ir.output_ports, output_sizes)
+  ]
   namespace = _WRAPPER_NAMESPACE.value
   return WrappedIr(
       jit_type=JitType.BLOCK,
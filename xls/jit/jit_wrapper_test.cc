@@ -108,6 +108,19 @@ TEST(JitWrapperTest, PackedFunctionCall2) {
   EXPECT_EQ(rv, 1.2345f);
 }
 
+TEST(JitWrapperTest, NativeFunctionCall) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto jit, fp::Float32Mul::Create());
+  // 1.5 * 2.0
+  fp::Float32Mul::XNative x{.element0 = 0, .element1 = 127,
+                            .element2 = 0x400000};
+  fp::Float32Mul::YNative y{.element0 = 0, .element1 = 128, .element2 = 0};
+  XLS_ASSERT_OK_AND_ASSIGN(fp::Float32Mul::ResultNative result,
+                           jit->RunNative(x, y));
+  EXPECT_EQ(result.element0, 0);
+  EXPECT_EQ(result.element1, 128);
+  EXPECT_EQ(result.element2, 0x400000);
+}
+
 std::array<uint8_t, 8> StrArray(std::string_view sv) {
   EXPECT_EQ(sv.size(), 8);
   std::array<uint8_t, 8> ret;
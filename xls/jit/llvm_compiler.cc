@@ -16,7 +16,9 @@
 
 #include <cerrno>
 #include <cstdint>
+#include <cstdlib>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <system_error>  // NOLINT
@@ -26,6 +28,7 @@
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "llvm/include/llvm-c/Target.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
@@ -40,6 +43,7 @@
 #include "llvm/include/llvm/Passes/OptimizationLevel.h"
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/Casting.h"
+#include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
@@ -66,6 +70,53 @@ std::string LlvmCompiler::target_triple() const {
 
 void LlvmCompiler::InitializeLlvm() { absl::call_once(once, OnceInit); }
 
+std::string_view LlvmPipelineProfileToString(LlvmPipelineProfile profile) {
+  switch (profile) {
+    case LlvmPipelineProfile::kFastCompile:
+      return "fast-compile";
+    case LlvmPipelineProfile::kBalanced:
+      return "balanced";
+    case LlvmPipelineProfile::kMaxThroughput:
+      return "max-throughput";
+  }
+  LOG(FATAL) << "Unknown pipeline profile: " << static_cast<int>(profile);
+}
+
+absl::StatusOr<LlvmPipelineProfile> LlvmPipelineProfileFromString(
+    std::string_view name) {
+  for (LlvmPipelineProfile profile :
+       {LlvmPipelineProfile::kFastCompile, LlvmPipelineProfile::kBalanced,
+        LlvmPipelineProfile::kMaxThroughput}) {
+    if (name == LlvmPipelineProfileToString(profile)) {
+      return profile;
+    }
+  }
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Unknown LLVM pipeline profile `%s`; expected one of fast-compile, "
+      "balanced or max-throughput",
+      name));
+}
+
+/* static */ std::optional<LlvmPipelineProfile>
+LlvmCompiler::GetDefaultPipelineProfile() {
+  static const std::optional<LlvmPipelineProfile> kDefault =
+      []() -> std::optional<LlvmPipelineProfile> {
+    const char* name = std::getenv(std::string(kPipelineProfileEnvVar).c_str());
+    if (name == nullptr || *name == '\0') {
+      return std::nullopt;
+    }
+    absl::StatusOr<LlvmPipelineProfile> profile =
+        LlvmPipelineProfileFromString(name);
+    if (!profile.ok()) {
+      LOG(WARNING) << "Ignoring " << kPipelineProfileEnvVar << ": "
+                   << profile.status();
+      return std::nullopt;
+    }
+    return *profile;
+  }();
+  return kDefault;
+}
+
 absl::StatusOr<llvm::DataLayout> LlvmCompiler::CreateDataLayout() {
   LlvmCompiler::InitializeLlvm();
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<llvm::TargetMachine> target_machine,
@@ -132,6 +183,23 @@ class BadOptLevelError : public llvm::ErrorInfo<BadOptLevelError> {
 
 char BadOptLevelError::ID;
 
+// Returns the opt level of the pipeline used by `profile` for `module`.
+int64_t ProfileOptLevel(LlvmPipelineProfile profile,
+                        const llvm::Module& module) {
+  switch (profile) {
+    case LlvmPipelineProfile::kFastCompile:
+      return 1;
+    case LlvmPipelineProfile::kBalanced:
+      return module.getInstructionCount() >
+                     LlvmCompiler::kBalancedProfileMaxInstructions
+                 ? 1
+                 : 2;
+    case LlvmPipelineProfile::kMaxThroughput:
+      return 3;
+  }
+  LOG(FATAL) << "Unknown pipeline profile: " << static_cast<int>(profile);
+}
+
 }  // namespace
 
 llvm::Error LlvmCompiler::PerformStandardOptimization(
@@ -160,8 +228,24 @@ llvm::Error LlvmCompiler::PerformStandardOptimization(
   pass_builder.registerLoopAnalyses(lam);
   pass_builder.crossRegisterProxies(lam, fam, cgam, mam);
 
+  int64_t opt_level = opt_level_;
+  if (pipeline_profile_.has_value()) {
+    opt_level = ProfileOptLevel(*pipeline_profile_, *bare_module);
+    VLOG(2) << absl::StreamFormat(
+        "Using opt level %d for pipeline profile %s", opt_level,
+        LlvmPipelineProfileToString(*pipeline_profile_));
+    // Most of the compile time of the cheaper pipelines is spent in code
+    // generation so scale it down as well.
+    llvm::CodeGenOptLevel codegen_opt_level = llvm::CodeGenOptLevel::Default;
+    if (opt_level == 1) {
+      codegen_opt_level = llvm::CodeGenOptLevel::Less;
+    } else if (opt_level == 3) {
+      codegen_opt_level = llvm::CodeGenOptLevel::Aggressive;
+    }
+    target_machine_->setOptLevel(codegen_opt_level);
+  }
   llvm::OptimizationLevel llvm_opt_level;
-  switch (opt_level_) {
+  switch (opt_level) {
     case 0:
       llvm_opt_level = llvm::OptimizationLevel::O0;
       break;
@@ -175,7 +259,7 @@ llvm::Error LlvmCompiler::PerformStandardOptimization(
       llvm_opt_level = llvm::OptimizationLevel::O3;
       break;
     default:
-      return llvm::Error(std::make_unique<BadOptLevelError>(opt_level_));
+      return llvm::Error(std::make_unique<BadOptLevelError>(opt_level));
   }
   llvm::ModulePassManager mpm;
   if (llvm_opt_level == llvm::OptimizationLevel::O0) {
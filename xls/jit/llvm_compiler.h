@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -39,11 +40,41 @@ namespace xls {
 class AotCompiler;
 class OrcJit;
 
+// Named LLVM pipelines which trade compile time against the speed of the
+// generated code. When set on an LlvmCompiler a profile overrides its opt
+// level.
+enum class LlvmPipelineProfile : int8_t {
+  // The O1 pipeline and cheaper code generation. Suited to very large designs
+  // where the latency of the JIT dominates.
+  kFastCompile,
+  // The O2 pipeline, except that modules with more than
+  // `LlvmCompiler::kBalancedProfileMaxInstructions` instructions use the
+  // fast-compile pipeline as the cost of O2 grows superlinearly with the size
+  // of the generated functions.
+  kBalanced,
+  // The O3 pipeline and aggressive code generation regardless of module size.
+  kMaxThroughput,
+};
+
+// Converts between profiles and their names ("fast-compile", "balanced" and
+// "max-throughput").
+std::string_view LlvmPipelineProfileToString(LlvmPipelineProfile profile);
+absl::StatusOr<LlvmPipelineProfile> LlvmPipelineProfileFromString(
+    std::string_view name);
+
 class LlvmCompiler {
  public:
   static constexpr int64_t kDefaultOptLevel = 3;
+  // Name of the environment variable which, if set, names the pipeline profile
+  // used by default by all compilers.
+  static constexpr std::string_view kPipelineProfileEnvVar =
+      "XLS_JIT_PIPELINE_PROFILE";
+  static constexpr int64_t kBalancedProfileMaxInstructions = 100'000;
   static void InitializeLlvm();
 
+  // Returns the profile named by `kPipelineProfileEnvVar`, if any.
+  static std::optional<LlvmPipelineProfile> GetDefaultPipelineProfile();
+
   virtual ~LlvmCompiler() = default;
 
   virtual absl::StatusOr<OrcJit*> AsOrcJit() {
@@ -87,6 +118,16 @@ class LlvmCompiler {
   CreateTargetMachine() = 0;
 
   int64_t opt_level() const { return opt_level_; }
+
+  // Sets the pipeline profile used in place of the opt level. Must be called
+  // before the module is compiled. Passing nullopt optimizes according to the
+  // opt level.
+  void SetPipelineProfile(std::optional<LlvmPipelineProfile> profile) {
+    pipeline_profile_ = profile;
+  }
+  std::optional<LlvmPipelineProfile> pipeline_profile() const {
+    return pipeline_profile_;
+  }
   bool include_msan() const { return include_msan_; }
   bool include_observer_callbacks() const {
     return include_observer_callbacks_;
@@ -124,6 +165,8 @@ class LlvmCompiler {
   llvm::DataLayout data_layout_;
 
   int64_t opt_level_;
+  std::optional<LlvmPipelineProfile> pipeline_profile_ =
+      GetDefaultPipelineProfile();
   // If the jitted code should include msan calls. Defaults to whatever 'this'
   // process is doing and should only be overridden for AOT generators.
   const bool include_msan_;
@@ -30,6 +30,7 @@
 #include "absl/strings/str_format.h"
 #include "llvm/include/llvm/ADT/SmallVector.h"
 #include "llvm/include/llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/AbsoluteSymbols.h"  // IWYU pragma: keep
 #include "llvm/include/llvm/ExecutionEngine/Orc/CompileUtils.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
@@ -52,12 +53,15 @@
 #include "llvm/include/llvm/Passes/PassBuilder.h"
 #include "llvm/include/llvm/Support/CodeGen.h"
 #include "llvm/include/llvm/Support/Error.h"
+#include "llvm/include/llvm/Support/MemoryBuffer.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Transforms/Instrumentation/MemorySanitizer.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/jit/jit_clang_builtins.h"
 #include "xls/jit/jit_emulated_tls.h"  // NOLINT: Used with MSAN
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
@@ -143,6 +147,8 @@ absl::StatusOr<std::unique_ptr<OrcJit>> OrcJit::Create(
   std::unique_ptr<OrcJit> jit = absl::WrapUnique(
       new OrcJit(opt_level, kHasMsan, include_observer_callbacks));
   jit->SetJitObserver(observer);
+  jit->SetObjectCache(
+      ContentAddressedDirectoryCache::GetDefault(kJitObjectCacheOptions));
   XLS_RETURN_IF_ERROR(jit->Init());
   return std::move(jit);
 }
@@ -207,8 +213,54 @@ class MsanHostEmuTls : public llvm::orc::DefinitionGenerator {
   }
 };
 
+// Stores objects produced by the compile layer in the OrcJit's object cache.
+// The cache key is computed before optimization and carried to this point as
+// the module identifier. Lookups happen in OrcJit::CompileModule, before the
+// module reaches the optimizer, so getObject never finds anything.
+class ObjectCacheWriter final : public llvm::ObjectCache {
+ public:
+  explicit ObjectCacheWriter(const OrcJit* jit) : jit_(jit) {}
+
+  void notifyObjectCompiled(const llvm::Module* module,
+                            llvm::MemoryBufferRef object) final {
+    ContentAddressedDirectoryCache* cache = jit_->object_cache();
+    const std::string& key = module->getModuleIdentifier();
+    if (cache == nullptr || key.empty()) {
+      return;
+    }
+    absl::Status status =
+        cache->Store(key, std::string_view(object.getBufferStart(),
+                                           object.getBufferSize()));
+    if (!status.ok()) {
+      LOG(WARNING) << "Unable to store JIT object: " << status;
+    }
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(
+      const llvm::Module* module) final {
+    return nullptr;
+  }
+
+ private:
+  const OrcJit* jit_;
+};
+
 }  // namespace
 
+std::string OrcJit::ObjectCacheOptions() const {
+  return absl::StrFormat(
+      "opt_level=%d;profile=%s;msan=%d;observer_callbacks=%d;triple=%s;cpu=%s;"
+      "features=%s",
+      opt_level(),
+      pipeline_profile().has_value()
+          ? LlvmPipelineProfileToString(*pipeline_profile())
+          : "none",
+      include_msan(), include_observer_callbacks(),
+      target_machine_->getTargetTriple().str(),
+      target_machine_->getTargetCPU().str(),
+      target_machine_->getTargetFeatureString().str());
+}
+
 absl::Status OrcJit::InitInternal() {
   // Add emutls and linked symbols.
   execution_session_.runSessionLocked([this]() {
@@ -221,7 +273,9 @@ absl::Status OrcJit::InitInternal() {
   // Add some selected compiler-rt symbols.
   XLS_RETURN_IF_ERROR(AddCompilerRtSymbols(dylib_, data_layout_));
 
-  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(*target_machine_);
+  object_cache_writer_ = std::make_unique<ObjectCacheWriter>(this);
+  auto compiler = std::make_unique<llvm::orc::SimpleCompiler>(
+      *target_machine_, object_cache_writer_.get());
   compile_layer_ = std::make_unique<llvm::orc::IRCompileLayer>(
       execution_session_, object_layer_, std::move(compiler));
 
@@ -239,6 +293,31 @@ absl::Status OrcJit::InitInternal() {
 
 absl::Status OrcJit::CompileModule(std::unique_ptr<llvm::Module>&& module) {
   XLS_RETURN_IF_ERROR(VerifyModule(*module));
+  if (object_cache_ != nullptr) {
+    std::string key = ComputeJitObjectCacheKey(
+        DumpLlvmModuleToString(module.get()), ObjectCacheOptions());
+    // Observers which want to see the modules or generated code need the full
+    // compilation pipeline to run, so only use cached objects without them.
+    bool observer_needs_compile =
+        jit_observer_ != nullptr &&
+        (jit_observer_->GetNotificationOptions().unoptimized_module ||
+         jit_observer_->GetNotificationOptions().optimized_module ||
+         jit_observer_->GetNotificationOptions().assembly_code_str);
+    if (!observer_needs_compile) {
+      if (std::optional<std::string> object = object_cache_->Lookup(key)) {
+        llvm::Error error = object_layer_.add(
+            dylib_, llvm::MemoryBuffer::getMemBufferCopy(*object, key));
+        if (error) {
+          return absl::UnknownError(
+              absl::StrFormat("Error loading cached object: %s",
+                              llvm::toString(std::move(error))));
+        }
+        return absl::OkStatus();
+      }
+    }
+    // Carry the key through the optimizer to the ObjectCacheWriter.
+    module->setModuleIdentifier(key);
+  }
   llvm::Error error = transform_layer_->add(
       dylib_, llvm::orc::ThreadSafeModule(std::move(module), context_));
   if (error) {
@@ -17,10 +17,12 @@
 
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <string_view>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "llvm/include/llvm/ExecutionEngine/ObjectCache.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRCompileLayer.h"
 #include "llvm/include/llvm/ExecutionEngine/Orc/IRTransformLayer.h"
@@ -31,6 +33,8 @@
 #include "llvm/include/llvm/Support/Error.h"
 #include "llvm/include/llvm/Support/raw_ostream.h"
 #include "llvm/include/llvm/Target/TargetMachine.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/jit/jit_object_cache.h"
 #include "xls/jit/llvm_compiler.h"
 #include "xls/jit/observer.h"
 
@@ -59,6 +63,17 @@ class OrcJit : public LlvmCompiler {
 
   JitObserver* jit_observer() const { return jit_observer_; }
 
+  // Sets the persistent object cache consulted by CompileModule. A module
+  // whose object code is found in the cache is loaded directly, skipping
+  // optimization and code generation; otherwise the newly compiled object is
+  // added to the cache. Defaults to the default cache described by
+  // kJitObjectCacheOptions. May be nullptr to disable caching.
+  void SetObjectCache(ContentAddressedDirectoryCache* cache) {
+    object_cache_ = cache;
+  }
+
+  ContentAddressedDirectoryCache* object_cache() const { return object_cache_; }
+
   // Compiles the given LLVM module into the JIT's execution session.
   absl::Status CompileModule(std::unique_ptr<llvm::Module>&& module) override;
 
@@ -84,6 +99,10 @@ class OrcJit : public LlvmCompiler {
       llvm::orc::ThreadSafeModule module,
       const llvm::orc::MaterializationResponsibility& responsibility);
 
+  // Returns the string describing the compiler configuration which is folded
+  // into object cache keys.
+  std::string ObjectCacheOptions() const;
+
   llvm::orc::ThreadSafeContext context_;
   llvm::orc::ExecutionSession execution_session_;
   llvm::orc::RTDyldObjectLinkingLayer object_layer_;
@@ -93,6 +112,11 @@ class OrcJit : public LlvmCompiler {
   std::unique_ptr<llvm::orc::IRTransformLayer> transform_layer_;
 
   JitObserver* jit_observer_ = nullptr;
+
+  ContentAddressedDirectoryCache* object_cache_ = nullptr;
+  // Adapter through which the compile layer reports newly compiled objects so
+  // they can be added to `object_cache_`.
+  std::unique_ptr<llvm::ObjectCache> object_cache_writer_;
 };
 
 }  // namespace xls
@@ -32,6 +32,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/proc_runtime.h"
 #include "xls/ir/package.h"
@@ -192,12 +193,41 @@ class BaseProcJitWrapper {
     return true;
   }
 
+  // Send the `size` bytes at `data`, which hold a value in the native layout
+  // of the jit (e.g. a generated native struct), on the given channel without
+  // converting it.
+  absl::Status SendToChannelNative(std::string_view chan_name,
+                                   const uint8_t* data, int64_t size) {
+    XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue, GetJitQueueByName(chan_name));
+    XLS_RET_CHECK_EQ(size,
+                     jit_runtime_.GetTypeByteSize(queue->channel()->type()));
+    queue->WriteRaw(data);
+    return absl::OkStatus();
+  }
+
+  // Remove the oldest element in the channels queue and write it to `buffer`
+  // in the native layout of the jit. Returns false if the queue is empty.
+  absl::StatusOr<bool> ReceiveFromChannelNative(std::string_view chan_name,
+                                                uint8_t* buffer, int64_t size) {
+    XLS_ASSIGN_OR_RETURN(JitChannelQueue * queue, GetJitQueueByName(chan_name));
+    XLS_RET_CHECK_EQ(size,
+                     jit_runtime_.GetTypeByteSize(queue->channel()->type()));
+    return queue->ReadRaw(buffer);
+  }
+
   std::unique_ptr<Package> package_;
   Proc* proc_;
   std::unique_ptr<ProcRuntime> runtime_;
   JitRuntime& jit_runtime_;
 
  private:
+  absl::StatusOr<JitChannelQueue*> GetJitQueueByName(
+      std::string_view chan_name) {
+    XLS_ASSIGN_OR_RETURN(auto* man, runtime_->GetJitChannelQueueManager());
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue, man->GetQueueByName(chan_name));
+    return &man->GetJitQueue(queue->channel_instance());
+  }
+
   std::tuple<std::unique_ptr<Package>, std::unique_ptr<ProcRuntime>>
   DoTakeRuntime() {
     return {std::move(package_), std::move(runtime_)};
@@ -0,0 +1,119 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/random_native_value.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+#include "xls/common/math_util.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+NativeBitGen::NativeBitGen(uint64_t seed) {
+  // Expand the seed with splitmix64 so that similar seeds still give
+  // unrelated (and never all-zero) states.
+  for (result_type& word : state_) {
+    seed += 0x9e3779b97f4a7c15;
+    result_type z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    word = z ^ (z >> 31);
+  }
+}
+
+RandomNativeValueGenerator::RandomNativeValueGenerator(
+    const TypeLayout& layout)
+    : size_(layout.size()),
+      mask_words_(CeilOfRatio(layout.size(), int64_t{8}), 0) {
+  std::vector<uint8_t> mask = layout.mask();
+  std::memcpy(mask_words_.data(), mask.data(), mask.size());
+}
+
+void RandomNativeValueGenerator::Fill(uint8_t* buffer,
+                                      NativeBitGen& rng) const {
+  int64_t full_words = size_ / 8;
+  for (int64_t i = 0; i < full_words; ++i) {
+    uint64_t word = mask_words_[i] == 0 ? 0 : rng() & mask_words_[i];
+    std::memcpy(buffer + 8 * i, &word, 8);
+  }
+  if (int64_t tail = size_ % 8; tail != 0) {
+    uint64_t word = rng() & mask_words_[full_words];
+    std::memcpy(buffer + 8 * full_words, &word, tail);
+  }
+}
+
+void RandomNativeValueGenerator::FillStrided(uint8_t* buffer, int64_t stride,
+                                             int64_t count,
+                                             NativeBitGen& rng) const {
+  DCHECK_GE(stride, size_);
+  for (int64_t i = 0; i < count; ++i) {
+    Fill(buffer + i * stride, rng);
+  }
+}
+
+RandomArgumentBatch::RandomArgumentBatch(FunctionJit* jit, int64_t batch_size,
+                                         NativeBitGen& rng)
+    : batch_size_(batch_size) {
+  absl::Span<Type* const> param_types = jit->GetParamTypes();
+  params_.reserve(param_types.size());
+  for (int64_t i = 0; i < param_types.size(); ++i) {
+    TypeLayout layout = jit->runtime()->CreateTypeLayout(param_types[i]);
+    RandomNativeValueGenerator generator(layout);
+    int64_t stride = jit->GetBatchedArgStride(i);
+    // Stride padding is never written by the generator, so it stays zero.
+    std::unique_ptr<uint8_t[], DeleteAligned> buffer = AllocateBatchBuffer(
+        jit->GetBatchedArgAlignment(i), stride, batch_size);
+    params_.push_back(Param{.layout = std::move(layout),
+                            .generator = std::move(generator),
+                            .stride = stride,
+                            .buffer = std::move(buffer)});
+    arg_pointers_.push_back(params_.back().buffer.get());
+  }
+  Randomize(rng);
+}
+
+void RandomArgumentBatch::Randomize(NativeBitGen& rng) {
+  for (const Param& param : params_) {
+    param.generator.FillStrided(param.buffer.get(), param.stride, batch_size_,
+                                rng);
+  }
+}
+
+Value RandomArgumentBatch::GetArgument(int64_t index, int64_t param) const {
+  CHECK_LT(index, batch_size_);
+  const Param& p = params_.at(param);
+  return p.layout.NativeLayoutToValue(p.buffer.get() + index * p.stride);
+}
+
+std::vector<Value> RandomArgumentBatch::GetArguments(int64_t index) const {
+  std::vector<Value> args;
+  args.reserve(params_.size());
+  for (int64_t i = 0; i < params_.size(); ++i) {
+    args.push_back(GetArgument(index, i));
+  }
+  return args;
+}
+
+}  // namespace xls
@@ -0,0 +1,133 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_JIT_RANDOM_NATIVE_VALUE_H_
+#define XLS_JIT_RANDOM_NATIVE_VALUE_H_
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+
+// A small and fast pseudo-random bit generator (xoshiro256++) used to fill
+// large amounts of native-layout data. Meets the requirements of
+// UniformRandomBitGenerator so it may also be used with absl distributions.
+class NativeBitGen {
+ public:
+  using result_type = uint64_t;
+
+  explicit NativeBitGen(uint64_t seed);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    result_type result = RotateLeft(state_[0] + state_[3], 23) + state_[0];
+    result_type t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = RotateLeft(state_[3], 45);
+    return result;
+  }
+
+ private:
+  static result_type RotateLeft(result_type x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  std::array<result_type, 4> state_;
+};
+
+// Writes uniformly distributed random values of a type directly into buffers
+// laid out as described by the type's TypeLayout, i.e. in the form the jitted
+// code consumes. Random words are masked down to the bits which hold data so
+// padding bits and bytes are always zero; no `Value` is ever built.
+class RandomNativeValueGenerator {
+ public:
+  explicit RandomNativeValueGenerator(const TypeLayout& layout);
+
+  // Number of bytes written for each value.
+  int64_t size() const { return size_; }
+
+  // Writes a random value to `buffer` which must hold at least size() bytes.
+  void Fill(uint8_t* buffer, NativeBitGen& rng) const;
+
+  // Writes `count` random values to `buffer`, spaced `stride` bytes apart.
+  void FillStrided(uint8_t* buffer, int64_t stride, int64_t count,
+                   NativeBitGen& rng) const;
+
+ private:
+  int64_t size_;
+  // The layout's mask() packed into 64-bit words; the last word is padded
+  // with zeros.
+  std::vector<uint64_t> mask_words_;
+};
+
+// A batch of random argument sets for a jitted function, held in the
+// struct-of-arrays native buffers taken by FunctionJit::RunBatchedWithViews().
+// Arguments are only converted to `Value`s on request, e.g. to report the
+// inputs of a failing element.
+class RandomArgumentBatch {
+ public:
+  // Allocates and fills a batch of `batch_size` argument sets for `jit`.
+  RandomArgumentBatch(FunctionJit* jit, int64_t batch_size, NativeBitGen& rng);
+
+  RandomArgumentBatch(RandomArgumentBatch&&) = default;
+  RandomArgumentBatch& operator=(RandomArgumentBatch&&) = default;
+
+  // Overwrites the batch with new random argument sets.
+  void Randomize(NativeBitGen& rng);
+
+  // The per-parameter buffers to pass to RunBatchedWithViews().
+  absl::Span<uint8_t* const> args() const { return arg_pointers_; }
+
+  int64_t batch_size() const { return batch_size_; }
+
+  // Returns the value of parameter `param` in argument set `index`.
+  Value GetArgument(int64_t index, int64_t param) const;
+
+  // Returns argument set `index`.
+  std::vector<Value> GetArguments(int64_t index) const;
+
+ private:
+  struct Param {
+    TypeLayout layout;
+    RandomNativeValueGenerator generator;
+    int64_t stride;
+    std::unique_ptr<uint8_t[], DeleteAligned> buffer;
+  };
+
+  int64_t batch_size_;
+  std::vector<Param> params_;
+  std::vector<uint8_t*> arg_pointers_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_JIT_RANDOM_NATIVE_VALUE_H_
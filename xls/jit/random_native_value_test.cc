@@ -0,0 +1,127 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/jit/random_native_value.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/function_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_buffer.h"
+#include "xls/jit/type_layout.h"
+
+namespace xls {
+namespace {
+
+class RandomNativeValueTest : public IrTestBase {};
+
+TEST_F(RandomNativeValueTest, BitGenIsDeterministic) {
+  NativeBitGen a(42);
+  NativeBitGen b(42);
+  NativeBitGen c(43);
+  bool differs = false;
+  for (int64_t i = 0; i < 16; ++i) {
+    uint64_t value = a();
+    EXPECT_EQ(value, b());
+    differs |= value != c();
+  }
+  EXPECT_TRUE(differs);
+}
+
+TEST_F(RandomNativeValueTest, FillsOnlyDataBits) {
+  auto p = CreatePackage();
+  Type* type = p->GetTupleType(
+      {p->GetBitsType(3), p->GetBitsType(17),
+       p->GetArrayType(3, p->GetBitsType(65)), p->GetTokenType()});
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Param("x", type);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f));
+  TypeLayout layout = jit->runtime()->CreateTypeLayout(type);
+  RandomNativeValueGenerator generator(layout);
+  ASSERT_EQ(generator.size(), layout.size());
+
+  NativeBitGen rng(0);
+  uint64_t seen_narrow_bits = 0;
+  std::vector<uint8_t> buffer(layout.size());
+  std::vector<uint8_t> roundtrip(layout.size());
+  for (int64_t i = 0; i < 64; ++i) {
+    generator.Fill(buffer.data(), rng);
+    Value value = layout.NativeLayoutToValue(buffer.data());
+    ASSERT_TRUE(ValueConformsToType(value, type));
+    seen_narrow_bits |= value.element(0).bits().ToUint64().value();
+    // Padding must be zero, so writing the value back out gives the same
+    // bytes.
+    layout.ValueToNativeLayout(value, roundtrip.data());
+    EXPECT_EQ(buffer, roundtrip);
+  }
+  EXPECT_EQ(seen_narrow_bits, 0b111);
+}
+
+TEST_F(RandomNativeValueTest, RunBatchedWithViews) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+    fn f(x: bits[8], y: bits[24]) -> (bits[24], bits[8]) {
+      zero_ext.1: bits[24] = zero_ext(x, new_bit_count=24)
+      add.2: bits[24] = add(zero_ext.1, y)
+      bit_slice.3: bits[8] = bit_slice(y, start=16, width=8)
+      ret tuple.4: (bits[24], bits[8]) = tuple(add.2, bit_slice.3)
+    }
+  )",
+                                                       p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<FunctionJit> jit,
+                           FunctionJit::Create(f));
+  constexpr int64_t kBatchSize = 37;
+  NativeBitGen rng(1234);
+  RandomArgumentBatch batch(jit.get(), kBatchSize, rng);
+  ASSERT_EQ(batch.args().size(), 2);
+
+  TypeLayout result_layout =
+      jit->runtime()->CreateTypeLayout(f->GetType()->return_type());
+  int64_t result_stride = jit->GetBatchedReturnStride();
+  std::unique_ptr<uint8_t[], DeleteAligned> results(
+      static_cast<uint8_t*>(AllocateAligned(jit->GetBatchedReturnAlignment(),
+                                            result_stride * kBatchSize)));
+  for (int64_t round = 0; round < 2; ++round) {
+    InterpreterEvents events;
+    XLS_ASSERT_OK(jit->RunBatchedWithViews(batch.args(), results.get(),
+                                           kBatchSize, &events));
+    for (int64_t b = 0; b < kBatchSize; ++b) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          Value expected,
+          DropInterpreterEvents(InterpretFunction(f, batch.GetArguments(b))));
+      EXPECT_EQ(result_layout.NativeLayoutToValue(results.get() +
+                                                  b * result_stride),
+                expected);
+    }
+    batch.Randomize(rng);
+  }
+}
+
+}  // namespace
+}  // namespace xls
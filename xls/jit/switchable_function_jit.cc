@@ -14,6 +14,7 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -23,9 +24,11 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
@@ -55,14 +58,59 @@ SwitchableFunctionJit::CreateJit(Function* xls_function, int64_t opt_level,
       auto jit,
       FunctionJit::Create(xls_function, opt_level,
                           /*include_observer_callbacks=*/false, observer));
-  return std::unique_ptr<SwitchableFunctionJit>(new SwitchableFunctionJit(
-      xls_function, /*use_jit=*/true, std::move(jit)));
+  return std::unique_ptr<SwitchableFunctionJit>(
+      new SwitchableFunctionJit(xls_function, std::move(jit)));
 }
 
 absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
 SwitchableFunctionJit::CreateInterpreter(Function* xls_function) {
   return std::unique_ptr<SwitchableFunctionJit>(
-      new SwitchableFunctionJit(xls_function, /*use_jit=*/false, nullptr));
+      new SwitchableFunctionJit(xls_function, nullptr));
+}
+
+absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
+SwitchableFunctionJit::CreateTiered(Function* xls_function,
+                                    int64_t jit_threshold, int64_t opt_level,
+                                    JitObserver* observer) {
+  XLS_RET_CHECK_GE(jit_threshold, 0);
+  auto tiered = std::unique_ptr<SwitchableFunctionJit>(new SwitchableFunctionJit(
+      xls_function, jit_threshold, opt_level, observer));
+  if (jit_threshold == 0) {
+    tiered->StartCompilation();
+  }
+  return tiered;
+}
+
+SwitchableFunctionJit::~SwitchableFunctionJit() { WaitForCompilation(); }
+
+void SwitchableFunctionJit::WaitForCompilation() {
+  absl::MutexLock lock(&compile_mutex_);
+  if (compile_thread_ != nullptr) {
+    compile_thread_->Join();
+    compile_thread_ = nullptr;
+  }
+}
+
+void SwitchableFunctionJit::RecordInterpretedRun() {
+  if (tiered_ && ++interpreted_runs_ == jit_threshold_) {
+    StartCompilation();
+  }
+}
+
+void SwitchableFunctionJit::StartCompilation() {
+  absl::MutexLock lock(&compile_mutex_);
+  compile_thread_ = std::make_unique<Thread>([this]() {
+    absl::StatusOr<std::unique_ptr<FunctionJit>> jit = FunctionJit::Create(
+        xls_function_, opt_level_,
+        /*include_observer_callbacks=*/false, observer_);
+    if (!jit.ok()) {
+      LOG(WARNING) << "Background JIT compilation of " << xls_function_->name()
+                   << " failed; continuing to interpret: " << jit.status();
+      return;
+    }
+    function_jit_ = *std::move(jit);
+    active_jit_.store(function_jit_.get(), std::memory_order_release);
+  });
 }
 
 absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
@@ -79,6 +127,9 @@ SwitchableFunctionJit::Create(Function* xls_function, ExecutionType execution,
     case ExecutionType::kJit:
       return SwitchableFunctionJit::CreateJit(xls_function, opt_level,
                                               observer);
+    case ExecutionType::kTiered:
+      return SwitchableFunctionJit::CreateTiered(
+          xls_function, kDefaultJitThreshold, opt_level, observer);
     case ExecutionType::kDefault:
       LOG(FATAL) << "Unreachable";
   }
@@ -131,18 +182,20 @@ absl::StatusOr<InterpreterResult<Value>> Interpret(
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     absl::Span<const Value> args) {
-  if (use_jit_) {
-    return function_jit_->Run(args);
+  if (FunctionJit* jit = active_jit_.load(std::memory_order_acquire)) {
+    return jit->Run(args);
   }
+  RecordInterpretedRun();
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(args, function()));
   return Interpret(std::move(node_args), function());
 }
 
 absl::StatusOr<InterpreterResult<Value>> SwitchableFunctionJit::Run(
     const absl::flat_hash_map<std::string, Value>& kwargs) {
-  if (use_jit_) {
-    return function_jit_->Run(kwargs);
+  if (FunctionJit* jit = active_jit_.load(std::memory_order_acquire)) {
+    return jit->Run(kwargs);
   }
+  RecordInterpretedRun();
   XLS_ASSIGN_OR_RETURN(auto node_args, ToValueMap(kwargs, function()));
   return Interpret(std::move(node_args), function());
 }
@@ -15,15 +15,19 @@
 #ifndef XLS_JIT_SWITCHABLE_FUNCTION_JIT_H_
 #define XLS_JIT_SWITCHABLE_FUNCTION_JIT_H_
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
+#include "xls/common/thread.h"
 #include "xls/ir/events.h"
 #include "xls/ir/function.h"
 #include "xls/ir/value.h"
@@ -36,6 +40,9 @@ enum class ExecutionType {
   kDefault,
   kJit,
   kInterpreter,
+  // Start out interpreting and compile in the background once the function
+  // has been run a set number of times, switching to the JIT when ready.
+  kTiered,
 };
 
 // A wrapper for the jit structures that can be turned off at build time if
@@ -51,10 +58,22 @@ class SwitchableFunctionJit {
       JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>>
   CreateInterpreter(Function* xls_function);
+  // Returns an object which interprets the function until it has been run
+  // `jit_threshold` times, at which point the function is compiled on a helper
+  // thread. Once compilation finishes all subsequent runs use the JIT. If
+  // compilation fails the interpreter continues to be used.
+  static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> CreateTiered(
+      Function* xls_function, int64_t jit_threshold = kDefaultJitThreshold,
+      int64_t opt_level = 3, JitObserver* observer = nullptr);
   static absl::StatusOr<std::unique_ptr<SwitchableFunctionJit>> Create(
       Function* xls_function, ExecutionType execution = ExecutionType::kDefault,
       int64_t opt_level = 3, JitObserver* observer = nullptr);
 
+  // Number of interpreted runs after which a tiered object starts compiling.
+  static constexpr int64_t kDefaultJitThreshold = 64;
+
+  ~SwitchableFunctionJit();
+
   // Executes the compiled function with the specified arguments.
   absl::StatusOr<InterpreterResult<Value>> Run(absl::Span<const Value> args);
 
@@ -67,23 +86,56 @@ class SwitchableFunctionJit {
   // Returns the function that the JIT executes.
   Function* function() { return xls_function_; }
 
+  // Returns the JIT used to execute the function, or std::nullopt if the
+  // function is being interpreted. For tiered objects this becomes available
+  // once background compilation finishes.
   std::optional<FunctionJit*> function_jit() {
-    if (use_jit_) {
-      return function_jit_.get();
+    if (FunctionJit* jit = active_jit_.load(std::memory_order_acquire)) {
+      return jit;
     }
     return std::nullopt;
   }
 
+  // Blocks until any in-progress background compilation has finished. Does
+  // nothing if compilation has not been started.
+  void WaitForCompilation();
+
  private:
-  explicit SwitchableFunctionJit(Function* xls_function, bool use_jit,
+  explicit SwitchableFunctionJit(Function* xls_function,
                                  std::unique_ptr<FunctionJit>&& jit)
       : xls_function_(xls_function),
-        use_jit_(use_jit),
-        function_jit_(std::move(jit)) {}
+        function_jit_(std::move(jit)),
+        active_jit_(function_jit_.get()) {}
+
+  SwitchableFunctionJit(Function* xls_function, int64_t jit_threshold,
+                        int64_t opt_level, JitObserver* observer)
+      : xls_function_(xls_function),
+        tiered_(true),
+        jit_threshold_(jit_threshold),
+        opt_level_(opt_level),
+        observer_(observer) {}
+
+  // Counts a run of a tiered object and starts background compilation when
+  // the threshold is reached.
+  void RecordInterpretedRun();
+
+  // Compiles the function on `compile_thread_`.
+  void StartCompilation();
 
   Function* xls_function_;
-  bool use_jit_;
   std::unique_ptr<FunctionJit> function_jit_;
+  // The JIT which Run() should use, or nullptr to interpret. Set once
+  // `function_jit_` is fully constructed.
+  std::atomic<FunctionJit*> active_jit_ = nullptr;
+
+  // Tiered compilation state.
+  bool tiered_ = false;
+  int64_t jit_threshold_ = 0;
+  int64_t opt_level_ = 3;
+  JitObserver* observer_ = nullptr;
+  int64_t interpreted_runs_ = 0;
+  absl::Mutex compile_mutex_;
+  std::unique_ptr<Thread> compile_thread_ ABSL_GUARDED_BY(compile_mutex_);
 };
 }  // namespace xls
 
@@ -14,6 +14,7 @@
 
 #include "xls/jit/switchable_function_jit.h"
 
+#include <cstdint>
 #include <vector>
 
 #include "gtest/gtest.h"
@@ -79,5 +80,45 @@ TEST_F(SwitchableFunctionJitTest, CanExecuteDefault) {
             Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
 }
 
+TEST_F(SwitchableFunctionJitTest, TieredSwitchesToJit) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::CreateTiered(f, /*jit_threshold=*/3));
+  std::vector<Value> args = {Value(UBits(8, 8)), Value(UBits(4, 8))};
+  Value expected = Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))});
+  for (int64_t i = 0; i < 2; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(args));
+    EXPECT_EQ(result.value, expected);
+  }
+  // The threshold has not been reached so nothing is compiling yet.
+  runner->WaitForCompilation();
+  EXPECT_FALSE(runner->function_jit().has_value());
+
+  XLS_ASSERT_OK_AND_ASSIGN(auto result, runner->Run(args));
+  EXPECT_EQ(result.value, expected);
+  runner->WaitForCompilation();
+  EXPECT_TRUE(runner->function_jit().has_value());
+  XLS_ASSERT_OK_AND_ASSIGN(result, runner->Run(args));
+  EXPECT_EQ(result.value, expected);
+}
+
+TEST_F(SwitchableFunctionJitTest, TieredWithZeroThresholdCompilesImmediately) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(auto f, TestFunction(p.get()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto runner, SwitchableFunctionJit::CreateTiered(f, /*jit_threshold=*/0));
+  // Runs are correct whichever tier services them.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto result,
+      runner->Run(std::vector<Value>{Value(UBits(8, 8)), Value(UBits(4, 8))}));
+  EXPECT_EQ(result.value,
+            Value::Tuple({Value(UBits(12, 8)), Value(UBits(32, 8))}));
+  runner->WaitForCompilation();
+  EXPECT_TRUE(runner->function_jit().has_value());
+}
+
 }  // namespace
 }  // namespace xls
@@ -23,6 +23,7 @@
 
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
@@ -56,7 +57,106 @@ static void LeafValueToNativeLayout(const Value& value,
     return;
   }
   CHECK(value.IsToken());
-  std::memset(buffer, 0, element_layout.padded_size);
+  std::memset(element_buffer, 0, element_layout.padded_size);
+}
+
+static Value LeafNativeLayoutToValue(const ElementLayout& element_layout,
+                                     int64_t bit_count,
+                                     const uint8_t* buffer) {
+  return Value(
+      Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
+                                     CeilOfRatio(bit_count, int64_t{8})),
+                      bit_count));
+}
+
+void TypeLayout::InitializeConverters() {
+  if (!type_->IsArray() || !type_->AsArrayOrDie()->element_type()->IsBits() ||
+      elements_.empty()) {
+    return;
+  }
+  const ElementLayout& first = elements_.front();
+  int64_t stride = elements_.size() > 1 ? elements_[1].offset - first.offset
+                                        : first.padded_size;
+  for (int64_t i = 0; i < elements_.size(); ++i) {
+    const ElementLayout& element = elements_[i];
+    if (element.offset != first.offset + i * stride ||
+        element.data_size != first.data_size ||
+        element.padded_size != first.padded_size) {
+      return;
+    }
+  }
+  bits_array_stride_ = stride;
+}
+
+// Appends the bit counts of the leaves of `type`, in leaf order.
+static void CollectLeafBitCounts(Type* type, std::vector<int64_t>& bit_counts) {
+  switch (type->kind()) {
+    case TypeKind::kBits:
+      bit_counts.push_back(type->AsBitsOrDie()->bit_count());
+      return;
+    case TypeKind::kToken:
+      bit_counts.push_back(0);
+      return;
+    case TypeKind::kTuple:
+      for (Type* element_type : type->AsTupleOrDie()->element_types()) {
+        CollectLeafBitCounts(element_type, bit_counts);
+      }
+      return;
+    case TypeKind::kArray: {
+      ArrayType* array_type = type->AsArrayOrDie();
+      int64_t first = bit_counts.size();
+      CollectLeafBitCounts(array_type->element_type(), bit_counts);
+      int64_t element_leaves = bit_counts.size() - first;
+      for (int64_t i = 1; i < array_type->size(); ++i) {
+        for (int64_t j = 0; j < element_leaves; ++j) {
+          bit_counts.push_back(bit_counts[first + j]);
+        }
+      }
+      return;
+    }
+  }
+  LOG(FATAL) << "Unexpected type kind: " << type->ToString();
+}
+
+void TypeLayout::InitializeComparison() {
+  std::vector<int64_t> bit_counts;
+  bit_counts.reserve(elements_.size());
+  CollectLeafBitCounts(type_, bit_counts);
+  CHECK_EQ(bit_counts.size(), elements_.size());
+  for (int64_t i = 0; i < elements_.size(); ++i) {
+    int64_t offset = elements_[i].offset;
+    int64_t full_bytes = bit_counts[i] / 8;
+    if (full_bytes > 0) {
+      if (!full_byte_runs_.empty() &&
+          full_byte_runs_.back().offset + full_byte_runs_.back().size ==
+              offset) {
+        full_byte_runs_.back().size += full_bytes;
+      } else {
+        full_byte_runs_.push_back(
+            ByteRun{.offset = offset, .size = full_bytes});
+      }
+    }
+    if (int64_t remainder = bit_counts[i] % 8; remainder != 0) {
+      partial_bytes_.push_back(
+          PartialByte{.offset = offset + full_bytes,
+                      .mask = static_cast<uint8_t>((1 << remainder) - 1)});
+    }
+  }
+}
+
+bool TypeLayout::NativeLayoutEquals(const uint8_t* lhs,
+                                    const uint8_t* rhs) const {
+  for (const ByteRun& run : full_byte_runs_) {
+    if (std::memcmp(lhs + run.offset, rhs + run.offset, run.size) != 0) {
+      return false;
+    }
+  }
+  for (const PartialByte& byte : partial_bytes_) {
+    if (((lhs[byte.offset] ^ rhs[byte.offset]) & byte.mask) != 0) {
+      return false;
+    }
+  }
+  return true;
 }
 
 void TypeLayout::ValueToNativeLayout(const Value& value,
@@ -68,6 +168,15 @@ void TypeLayout::ValueToNativeLayout(const Value& value,
     return LeafValueToNativeLayout(value, elements_.front(), buffer);
   }
 
+  if (bits_array_stride_.has_value()) {
+    ElementLayout element_layout = elements_.front();
+    for (const Value& element : value.elements()) {
+      LeafValueToNativeLayout(element, element_layout, buffer);
+      element_layout.offset += *bits_array_stride_;
+    }
+    return;
+  }
+
   // At this point, `value` is a compound type. To avoid the expense of
   // recursive calls enumerating the type elements, manually keep a stack to
   // perform the enumeration.
@@ -115,10 +224,7 @@ Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
     int64_t bit_count = element_type->AsBitsOrDie()->bit_count();
     const ElementLayout& element_layout = elements_.at(*leaf_index);
     ++(*leaf_index);
-    return Value(
-        Bits::FromBytes(absl::MakeSpan(buffer + element_layout.offset,
-                                       CeilOfRatio(bit_count, int64_t{8})),
-                        bit_count));
+    return LeafNativeLayoutToValue(element_layout, bit_count, buffer);
   }
   if (element_type->IsToken()) {
     ++(*leaf_index);
@@ -147,10 +253,78 @@ Value TypeLayout::NativeLayoutToValueInternal(Type* element_type,
 }
 
 Value TypeLayout::NativeLayoutToValue(const uint8_t* buffer) const {
+  if (bits_array_stride_.has_value()) {
+    ArrayType* array_type = type_->AsArrayOrDie();
+    int64_t bit_count = array_type->element_type()->AsBitsOrDie()->bit_count();
+    std::vector<Value> elements;
+    elements.reserve(array_type->size());
+    ElementLayout element_layout = elements_.front();
+    for (int64_t i = 0; i < array_type->size(); ++i) {
+      elements.push_back(
+          LeafNativeLayoutToValue(element_layout, bit_count, buffer));
+      element_layout.offset += *bits_array_stride_;
+    }
+    return Value::ArrayOwned(std::move(elements));
+  }
   int64_t leaf_index = 0;
   return NativeLayoutToValueInternal(type_, buffer, &leaf_index);
 }
 
+void TypeLayout::ViewToNativeLayout(const NativeLayoutValueView& view,
+                                    uint8_t* buffer) const {
+  const TypeLayout& view_layout = view.layout();
+  if (view.type() == view_layout.type() && view_layout.size() == size() &&
+      view_layout.type()->IsEqualTo(type()) &&
+      view_layout.elements() == elements()) {
+    std::memcpy(buffer, view.buffer(), size());
+    return;
+  }
+  ValueToNativeLayout(view.ToValue(), buffer);
+}
+
+int64_t NativeLayoutValueView::size() const {
+  if (type_->IsTuple()) {
+    return type_->AsTupleOrDie()->size();
+  }
+  CHECK(type_->IsArray()) << type_->ToString();
+  return type_->AsArrayOrDie()->size();
+}
+
+NativeLayoutValueView NativeLayoutValueView::element(int64_t i) const {
+  if (type_->IsTuple()) {
+    TupleType* tuple_type = type_->AsTupleOrDie();
+    CHECK_LT(i, tuple_type->size());
+    int64_t leaf_index = leaf_index_;
+    for (int64_t j = 0; j < i; ++j) {
+      leaf_index += tuple_type->element_type(j)->leaf_count();
+    }
+    return NativeLayoutValueView(layout_, tuple_type->element_type(i),
+                                 leaf_index, buffer_);
+  }
+  CHECK(type_->IsArray()) << type_->ToString();
+  ArrayType* array_type = type_->AsArrayOrDie();
+  CHECK_LT(i, array_type->size());
+  Type* element_type = array_type->element_type();
+  return NativeLayoutValueView(layout_, element_type,
+                               leaf_index_ + i * element_type->leaf_count(),
+                               buffer_);
+}
+
+Bits NativeLayoutValueView::bits() const {
+  CHECK(type_->IsBits()) << type_->ToString();
+  return LeafNativeLayoutToValue(layout_->elements_.at(leaf_index_),
+                                 type_->AsBitsOrDie()->bit_count(), buffer_)
+      .bits();
+}
+
+Value NativeLayoutValueView::ToValue() const {
+  if (type_ == layout_->type()) {
+    return layout_->NativeLayoutToValue(buffer_);
+  }
+  int64_t leaf_index = leaf_index_;
+  return layout_->NativeLayoutToValueInternal(type_, buffer_, &leaf_index);
+}
+
 std::string TypeLayout::ToString() const {
   std::vector<std::string> lines;
   lines.push_back(absl::StrFormat("TypeLayout {"));
@@ -16,6 +16,7 @@
 #define XLS_JIT_TYPE_LAYOUT_H_
 
 #include <cstdint>
+#include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -23,6 +24,7 @@
 #include "absl/log/check.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/package.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
@@ -61,6 +63,49 @@ struct ElementLayout {
   }
 };
 
+class TypeLayout;
+
+// A view of a value stored in the native layout of a `TypeLayout` which
+// converts elements to `Value`s only when they are accessed. Extracting a few
+// leaves of a large aggregate through a view avoids materializing the whole
+// `Value` tree. The view does not own the buffer, which must outlive it.
+class NativeLayoutValueView {
+ public:
+  Type* type() const { return type_; }
+
+  // Returns the number of elements of the tuple or array viewed.
+  int64_t size() const;
+
+  // Returns a view of the `i`-th element of the tuple or array viewed.
+  NativeLayoutValueView element(int64_t i) const;
+
+  // Returns the value of the bits-typed leaf viewed.
+  Bits bits() const;
+
+  // Materializes the `Value` viewed.
+  Value ToValue() const;
+
+  const TypeLayout& layout() const { return *layout_; }
+  const uint8_t* buffer() const { return buffer_; }
+
+ private:
+  friend class TypeLayout;
+
+  NativeLayoutValueView(const TypeLayout* layout, Type* type,
+                        int64_t leaf_index, const uint8_t* buffer)
+      : layout_(layout),
+        type_(type),
+        leaf_index_(leaf_index),
+        buffer_(buffer) {}
+
+  const TypeLayout* layout_;
+  Type* type_;
+  // Index in `layout_->elements()` of the first leaf of the value viewed.
+  int64_t leaf_index_;
+  // The buffer holding the top-level value of `layout_`.
+  const uint8_t* buffer_;
+};
+
 // Abstraction describing the native data layout used by the JIT of a specific
 // XLS type. The layout is encapsulated in the `ElementLayout` values, one for
 // each leaf element of the type, which includes the offset and size of each
@@ -90,6 +135,8 @@ class TypeLayout {
                       absl::Span<const ElementLayout> elements)
       : type_(type), size_(size), elements_(elements.begin(), elements.end()) {
     CHECK_EQ(elements.size(), type->leaf_count());
+    InitializeConverters();
+    InitializeComparison();
   }
 
   // Converts TypeLayout objects to/from TypeLayoutProtos.
@@ -105,6 +152,24 @@ class TypeLayout {
   // `buffer`.
   Value NativeLayoutToValue(const uint8_t* buffer) const;
 
+  // Returns a view of the value of XLS type `type()` stored in `buffer` which
+  // converts elements to `Value`s lazily. `buffer` must outlive the view.
+  NativeLayoutValueView NativeLayoutToView(const uint8_t* buffer) const {
+    return NativeLayoutValueView(this, type_, /*leaf_index=*/0, buffer);
+  }
+
+  // Writes the value viewed by `view` out to `buffer` in the native layout of
+  // the type. If `view` covers a whole value of an identical layout the bytes
+  // are copied directly without materializing a `Value`.
+  void ViewToNativeLayout(const NativeLayoutValueView& view,
+                          uint8_t* buffer) const;
+
+  // Returns whether the values of type `type()` stored in native layout in
+  // `lhs` and `rhs` are equal. Only the bits which hold data are compared
+  // (padding need not be zero), mostly with memcmp over runs of whole bytes, so
+  // no `Value` is built.
+  bool NativeLayoutEquals(const uint8_t* lhs, const uint8_t* rhs) const;
+
   // Get a string which is a bitmask of which bits contribute to the native
   // representations value.
   std::vector<uint8_t> mask() const;
@@ -119,12 +184,38 @@ class TypeLayout {
   std::string ToString() const;
 
  private:
+  friend class NativeLayoutValueView;
+
+  // Precomputes the specialized conversion used for `type_`, if any.
+  void InitializeConverters();
+
+  // Precomputes the byte ranges compared by NativeLayoutEquals().
+  void InitializeComparison();
+
   Value NativeLayoutToValueInternal(Type* element_type, const uint8_t* buffer,
                                     int64_t* leaf_index) const;
 
   Type* type_;
   int64_t size_;
   std::vector<ElementLayout> elements_;
+
+  // If `type_` is an array of bits whose elements are laid out identically at
+  // a fixed stride, the stride in bytes. Such arrays are converted with a
+  // single loop over the elements instead of the generic walk of the type.
+  std::optional<int64_t> bits_array_stride_;
+
+  // Ranges of bytes all of whose bits hold data, merged across adjacent leaves.
+  struct ByteRun {
+    int64_t offset;
+    int64_t size;
+  };
+  std::vector<ByteRun> full_byte_runs_;
+  // Bytes which hold data only in the bits set in `mask`.
+  struct PartialByte {
+    int64_t offset;
+    uint8_t mask;
+  };
+  std::vector<PartialByte> partial_bytes_;
 };
 
 std::ostream& operator<<(std::ostream& os, ElementLayout layout);
@@ -312,6 +312,77 @@ TEST_F(TypeLayoutTest, SimpleArray) {
           ElementLayout{.offset = 4, .data_size = 2, .padded_size = 2}));
 }
 
+TEST_F(TypeLayoutTest, NativeLayoutEquals) {
+  auto package = CreatePackage();
+  Type* type = package->GetTupleType(
+      {package->GetBitsType(12),
+       package->GetArrayType(2, package->GetBitsType(16)),
+       package->GetTokenType()});
+  TypeLayout layout(
+      type, 12,
+      {ElementLayout{.offset = 0, .data_size = 2, .padded_size = 4},
+       ElementLayout{.offset = 4, .data_size = 2, .padded_size = 2},
+       ElementLayout{.offset = 6, .data_size = 2, .padded_size = 2},
+       ElementLayout{.offset = 8, .data_size = 0, .padded_size = 4}});
+  Value value = Parser::ParseValue("(0xabc, [0x1234, 0x5678], token)", type)
+                    .value();
+  std::vector<uint8_t> lhs(layout.size());
+  layout.ValueToNativeLayout(value, lhs.data());
+
+  // Garbage in padding bits and bytes doesn't matter.
+  std::vector<uint8_t> rhs = lhs;
+  rhs[1] |= 0xf0;
+  rhs[2] = 0x55;
+  rhs[11] = 0xaa;
+  EXPECT_TRUE(layout.NativeLayoutEquals(lhs.data(), rhs.data()));
+
+  // But any data bit does.
+  for (int64_t byte : {0, 1, 4, 7}) {
+    std::vector<uint8_t> other = lhs;
+    other[byte] ^= 0x01;
+    EXPECT_FALSE(layout.NativeLayoutEquals(lhs.data(), other.data())) << byte;
+  }
+}
+
+TEST_F(TypeLayoutTest, NativeLayoutView) {
+  auto package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Type * type,
+      Parser::ParseType("(bits[3], (bits[16], bits[9])[2], bits[7][3])",
+                        package.get()));
+  TypeLayout layout = CreateTypeLayout(type);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Value value,
+      Parser::ParseTypedValue("(bits[3]:5, [(bits[16]:1000, bits[9]:300), "
+                              "(bits[16]:2000, bits[9]:400)], "
+                              "[bits[7]:1, bits[7]:2, bits[7]:3])"));
+  std::vector<uint8_t> buffer(layout.size(), 0);
+  layout.ValueToNativeLayout(value, buffer.data());
+
+  NativeLayoutValueView view = layout.NativeLayoutToView(buffer.data());
+  EXPECT_EQ(view.size(), 3);
+  EXPECT_EQ(view.element(0).bits(), UBits(5, 3));
+  EXPECT_EQ(view.element(1).size(), 2);
+  EXPECT_EQ(view.element(1).element(1).element(0).bits(), UBits(2000, 16));
+  EXPECT_EQ(view.element(1).element(1).element(1).bits(), UBits(400, 9));
+  EXPECT_EQ(view.element(1).element(0).ToValue(), value.element(1).element(0));
+  EXPECT_EQ(view.element(2).ToValue(), value.element(2));
+  EXPECT_EQ(view.ToValue(), value);
+
+  // A view of an identical layout is copied without conversion.
+  std::vector<uint8_t> copy(layout.size(), 0xff);
+  layout.ViewToNativeLayout(view, copy.data());
+  EXPECT_EQ(copy, buffer);
+
+  // A view of an element is converted into the layout of the element type.
+  Type* array_type = type->AsTupleOrDie()->element_type(2);
+  TypeLayout array_layout = CreateTypeLayout(array_type);
+  std::vector<uint8_t> array_buffer(array_layout.size(), 0xff);
+  array_layout.ViewToNativeLayout(view.element(2), array_buffer.data());
+  EXPECT_EQ(array_layout.NativeLayoutToValue(array_buffer.data()),
+            value.element(2));
+}
+
 TEST_F(TypeLayoutTest, JitTypes) {
   // Randomly test the layout of a bunch of types. TypeLayouts are generated by
   // the JIT and random xls::Values are round-tripped through the native layout.
@@ -341,6 +412,14 @@ TEST_F(TypeLayoutTest, JitTypes) {
       XLS_VLOG_LINES(1, BytesToString(buffer));
 
       EXPECT_EQ(layout.NativeLayoutToValue(buffer.data()), value);
+      EXPECT_EQ(layout.NativeLayoutToView(buffer.data()).ToValue(), value);
+
+      Value other = RandomValue(type, bitgen);
+      std::vector<uint8_t> other_buffer(layout.size());
+      layout.ValueToNativeLayout(other, other_buffer.data());
+      EXPECT_TRUE(layout.NativeLayoutEquals(buffer.data(), buffer.data()));
+      EXPECT_EQ(layout.NativeLayoutEquals(buffer.data(), other_buffer.data()),
+                value == other);
 
       // Verify padding bits and bytes are zero in the buffer for each element.
       for (int64_t leaf_index = 0; leaf_index < leaf_types.size();
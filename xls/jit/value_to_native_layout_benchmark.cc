@@ -75,8 +75,21 @@ static void BM_NativeLayoutToValue(benchmark::State& state) {
   }
 }
 
+static void BM_ViewToNativeLayout(benchmark::State& state) {
+  Package package("BM");
+  Type* type = Parser::ParseType(kValueTypes[state.range(0)], &package).value();
+  TypeLayout type_layout = CreateTypeLayout(type);
+  std::vector<uint8_t> source(type_layout.size(), 0);
+  std::vector<uint8_t> buffer(type_layout.size());
+  NativeLayoutValueView view = type_layout.NativeLayoutToView(source.data());
+  for (auto _ : state) {
+    type_layout.ViewToNativeLayout(view, buffer.data());
+  }
+}
+
 BENCHMARK(BM_ValueToNativeLayout)->DenseRange(0, kNumTypes - 1);
 BENCHMARK(BM_NativeLayoutToValue)->DenseRange(0, kNumTypes - 1);
+BENCHMARK(BM_ViewToNativeLayout)->DenseRange(0, kNumTypes - 1);
 
 }  // namespace
 }  // namespace xls
@@ -16,11 +16,13 @@
 #define XLS_NETLIST_CELL_LIBRARY_H_
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -28,9 +30,11 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/netlist/compiled_cell_function.h"
 #include "xls/netlist/netlist.pb.h"
 
 namespace xls {
@@ -190,7 +194,17 @@ class AbstractCellLibraryEntry {
         input_names_(input_names.begin(), input_names.end()),
         output_pin_to_function_(output_pin_to_function),
         state_table_(state_table),
-        clock_name_(clock_name) {}
+        clock_name_(clock_name) {
+    // Pin functions which can't be compiled (e.g., because they read state
+    // table signals) are left to be interpreted from their ASTs.
+    for (const auto& [pin, function] : output_pin_to_function_) {
+      absl::StatusOr<CompiledCellFunction> compiled =
+          CompiledCellFunction::Compile(function, input_names_);
+      if (compiled.ok()) {
+        compiled_functions_.emplace(pin, *std::move(compiled));
+      }
+    }
+  }
 
   CellKind kind() const { return kind_; }
   const std::string& name() const { return name_; }
@@ -203,6 +217,15 @@ class AbstractCellLibraryEntry {
   }
   std::optional<std::string> clock_name() const { return clock_name_; }
 
+  // Returns the function of the given output pin compiled against
+  // input_names(), or nullptr if the function could not be compiled. Compiled
+  // once per entry and shared by all instances of the cell.
+  const CompiledCellFunction* GetCompiledFunction(
+      std::string_view output_pin) const {
+    auto it = compiled_functions_.find(output_pin);
+    return it == compiled_functions_.end() ? nullptr : &it->second;
+  }
+
   absl::StatusOr<CellLibraryEntryProto> ToProto() const;
 
  private:
@@ -212,6 +235,7 @@ class AbstractCellLibraryEntry {
   OutputPinToFunction output_pin_to_function_;
   std::optional<AbstractStateTable<EvalT>> state_table_;
   std::optional<std::string> clock_name_;
+  absl::flat_hash_map<std::string, CompiledCellFunction> compiled_functions_;
 };
 
 using CellLibraryEntry = AbstractCellLibraryEntry<>;
@@ -232,6 +256,22 @@ class AbstractCellLibrary {
     return FromProto(proto, EvalT{false}, EvalT{true});
   }
 
+  // Produces the proto of the named entry, or a NOT_FOUND error.
+  using EntryLoader = std::function<absl::StatusOr<CellLibraryEntryProto>(
+      std::string_view name)>;
+
+  // Returns a library whose entries are produced by `loader` the first time
+  // GetEntry is asked for them, so that only the cells which are actually
+  // used get extracted from their source. ToProto() only includes the entries
+  // loaded so far.
+  static AbstractCellLibrary<EvalT> FromLoader(EntryLoader loader, EvalT zero,
+                                               EvalT one);
+
+  template <typename = std::is_constructible<EvalT, bool>>
+  static AbstractCellLibrary<EvalT> FromLoader(EntryLoader loader) {
+    return FromLoader(std::move(loader), EvalT{false}, EvalT{true});
+  }
+
   // Returns a NOT_FOUND status if there is not entry with the given name.
   absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*> GetEntry(
       std::string_view name) const;
@@ -241,9 +281,23 @@ class AbstractCellLibrary {
   absl::StatusOr<CellLibraryProto> ToProto() const;
 
  private:
-  absl::flat_hash_map<std::string,
-                      std::unique_ptr<AbstractCellLibraryEntry<EvalT>>>
+  struct Loader {
+    Loader(EntryLoader load, EvalT zero, EvalT one)
+        : load(std::move(load)), zero(zero), one(one) {}
+
+    EntryLoader load;
+    EvalT zero;
+    EvalT one;
+    // Guards `entries_` when entries are loaded on demand.
+    absl::Mutex mutex;
+  };
+
+  // Entries are only inserted through a const method by lazy loading, which
+  // happens under `loader_->mutex`.
+  mutable absl::flat_hash_map<std::string,
+                              std::unique_ptr<AbstractCellLibraryEntry<EvalT>>>
       entries_;
+  std::shared_ptr<Loader> loader_;
 };
 
 using CellLibrary = AbstractCellLibrary<>;
@@ -565,8 +619,20 @@ AbstractCellLibrary<EvalT>::FromProto(const CellLibraryProto& proto, EvalT zero,
   return cell_library;
 }
 
+template <typename EvalT>
+/* static */ AbstractCellLibrary<EvalT> AbstractCellLibrary<EvalT>::FromLoader(
+    EntryLoader loader, EvalT zero, EvalT one) {
+  AbstractCellLibrary cell_library;
+  cell_library.loader_ = std::make_shared<Loader>(std::move(loader), zero, one);
+  return cell_library;
+}
+
 template <typename EvalT>
 absl::StatusOr<CellLibraryProto> AbstractCellLibrary<EvalT>::ToProto() const {
+  std::optional<absl::MutexLock> lock;
+  if (loader_ != nullptr) {
+    lock.emplace(&loader_->mutex);
+  }
   CellLibraryProto proto;
   for (const auto& entry : entries_) {
     XLS_ASSIGN_OR_RETURN(*proto.add_entries(), entry.second->ToProto());
@@ -590,11 +656,29 @@ absl::Status AbstractCellLibrary<EvalT>::AddEntry(
 template <typename EvalT>
 absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
 AbstractCellLibrary<EvalT>::GetEntry(std::string_view name) const {
+  if (loader_ == nullptr) {
+    auto it = entries_.find(name);
+    if (it == entries_.end()) {
+      return absl::NotFoundError(
+          absl::StrCat("Cell not found in library: ", name));
+    }
+    return it->second.get();
+  }
+
+  absl::MutexLock lock(&loader_->mutex);
   auto it = entries_.find(name);
-  if (it == entries_.end()) {
-    return absl::NotFoundError(
-        absl::StrCat("Cell not found in library: ", name));
+  if (it != entries_.end()) {
+    return it->second.get();
   }
+  XLS_ASSIGN_OR_RETURN(CellLibraryEntryProto entry_proto, loader_->load(name));
+  XLS_ASSIGN_OR_RETURN(auto entry, AbstractCellLibraryEntry<EvalT>::FromProto(
+                                       entry_proto, loader_->zero,
+                                       loader_->one));
+  it = entries_
+           .emplace(std::string(name),
+                    std::make_unique<AbstractCellLibraryEntry<EvalT>>(
+                        std::move(entry)))
+           .first;
   return it->second.get();
 }
 
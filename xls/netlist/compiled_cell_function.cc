@@ -0,0 +1,192 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_cell_function.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Word `i` has bit `m` set iff bit `i` of `m` is set, so evaluating a function
+// on these words computes its value for every input vector `m` at once.
+constexpr std::array<uint64_t, CompiledCellFunction::kMaxTruthTableInputs>
+    kMintermPatterns = {
+        0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+        0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull,
+};
+
+}  // namespace
+
+absl::Status CompiledCellFunction::CompileAst(
+    const function::Ast& ast, absl::Span<const std::string> input_names,
+    CompiledCellFunction& function) {
+  using Kind = Instruction::Kind;
+  switch (ast.kind()) {
+    case function::Ast::Kind::kIdentifier: {
+      for (int64_t i = 0; i < input_names.size(); ++i) {
+        if (input_names[i] == ast.name()) {
+          function.program_.push_back(
+              {.kind = Kind::kInput, .input = static_cast<uint8_t>(i)});
+          function.used_inputs_ |= uint64_t{1} << i;
+          return absl::OkStatus();
+        }
+      }
+      return absl::UnimplementedError(absl::StrFormat(
+          "Identifier \"%s\" is not an input pin; internal signals cannot be "
+          "compiled.",
+          ast.name()));
+    }
+    case function::Ast::Kind::kLiteralZero:
+      function.program_.push_back({.kind = Kind::kZero});
+      return absl::OkStatus();
+    case function::Ast::Kind::kLiteralOne:
+      function.program_.push_back({.kind = Kind::kOne});
+      return absl::OkStatus();
+    case function::Ast::Kind::kNot:
+      XLS_RETURN_IF_ERROR(
+          CompileAst(ast.children()[0], input_names, function));
+      function.program_.push_back({.kind = Kind::kNot});
+      return absl::OkStatus();
+    case function::Ast::Kind::kAnd:
+    case function::Ast::Kind::kOr:
+    case function::Ast::Kind::kXor: {
+      XLS_RETURN_IF_ERROR(
+          CompileAst(ast.children()[0], input_names, function));
+      XLS_RETURN_IF_ERROR(
+          CompileAst(ast.children()[1], input_names, function));
+      Kind kind = ast.kind() == function::Ast::Kind::kAnd  ? Kind::kAnd
+                  : ast.kind() == function::Ast::Kind::kOr ? Kind::kOr
+                                                           : Kind::kXor;
+      function.program_.push_back({.kind = kind});
+      return absl::OkStatus();
+    }
+  }
+  return absl::InvalidArgumentError("Unknown AST element type");
+}
+
+absl::StatusOr<CompiledCellFunction> CompiledCellFunction::Compile(
+    const function::Ast& ast, absl::Span<const std::string> input_names) {
+  if (input_names.size() > kMaxInputs) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "Cell functions of more than %d inputs cannot be compiled.",
+        kMaxInputs));
+  }
+  CompiledCellFunction function;
+  function.input_count_ = input_names.size();
+  XLS_RETURN_IF_ERROR(CompileAst(ast, input_names, function));
+  if (function.input_count_ <= kMaxTruthTableInputs) {
+    uint64_t minterm_count = uint64_t{1} << function.input_count_;
+    uint64_t mask =
+        minterm_count == 64 ? ~uint64_t{0} : (uint64_t{1} << minterm_count) - 1;
+    function.truth_table_ =
+        function.RunProgram(absl::MakeConstSpan(kMintermPatterns).subspan(
+            0, function.input_count_)) &
+        mask;
+    function.lanes_use_truth_table_ =
+        minterm_count - 1 <= function.program_.size();
+  }
+  return function;
+}
+
+absl::StatusOr<CompiledCellFunction> CompiledCellFunction::Compile(
+    const std::string& function, absl::Span<const std::string> input_names) {
+  XLS_ASSIGN_OR_RETURN(function::Ast ast,
+                       function::Parser::ParseFunction(function));
+  return Compile(ast, input_names);
+}
+
+bool CompiledCellFunction::Evaluate(uint64_t inputs) const {
+  if (input_count_ <= kMaxTruthTableInputs) {
+    return (truth_table_ >> inputs) & 1;
+  }
+  absl::InlinedVector<uint64_t, kMaxInputs> lanes(input_count_);
+  for (int64_t i = 0; i < input_count_; ++i) {
+    lanes[i] = ((inputs >> i) & 1) ? ~uint64_t{0} : 0;
+  }
+  return RunProgram(lanes) & 1;
+}
+
+uint64_t CompiledCellFunction::EvaluateLanes(
+    absl::Span<const uint64_t> inputs) const {
+  return lanes_use_truth_table_ ? LookUpTruthTable(inputs)
+                                : RunProgram(inputs);
+}
+
+uint64_t CompiledCellFunction::LookUpTruthTable(
+    absl::Span<const uint64_t> inputs) const {
+  // Reduce the table one input at a time: entries 2j and 2j + 1 differ only
+  // in the lowest remaining input, so selecting between them by that input
+  // leaves a table over the remaining inputs.
+  std::array<uint64_t, uint64_t{1} << kMaxTruthTableInputs> table;
+  int64_t size = int64_t{1} << input_count_;
+  for (int64_t m = 0; m < size; ++m) {
+    table[m] = ((truth_table_ >> m) & 1) ? ~uint64_t{0} : 0;
+  }
+  for (int64_t i = 0; i < input_count_; ++i) {
+    size /= 2;
+    for (int64_t j = 0; j < size; ++j) {
+      table[j] = (inputs[i] & table[2 * j + 1]) | (~inputs[i] & table[2 * j]);
+    }
+  }
+  return table[0];
+}
+
+uint64_t CompiledCellFunction::RunProgram(
+    absl::Span<const uint64_t> inputs) const {
+  using Kind = Instruction::Kind;
+  absl::InlinedVector<uint64_t, 16> stack;
+  for (const Instruction& instruction : program_) {
+    switch (instruction.kind) {
+      case Kind::kInput:
+        stack.push_back(inputs[instruction.input]);
+        break;
+      case Kind::kZero:
+        stack.push_back(0);
+        break;
+      case Kind::kOne:
+        stack.push_back(~uint64_t{0});
+        break;
+      case Kind::kNot:
+        stack.back() = ~stack.back();
+        break;
+      case Kind::kAnd:
+      case Kind::kOr:
+      case Kind::kXor: {
+        uint64_t rhs = stack.back();
+        stack.pop_back();
+        uint64_t& lhs = stack.back();
+        lhs = instruction.kind == Kind::kAnd  ? (lhs & rhs)
+              : instruction.kind == Kind::kOr ? (lhs | rhs)
+                                              : (lhs ^ rhs);
+        break;
+      }
+    }
+  }
+  return stack.back();
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,131 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_COMPILED_CELL_FUNCTION_H_
+#define XLS_NETLIST_COMPILED_CELL_FUNCTION_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/netlist/function_parser.h"
+
+namespace xls {
+namespace netlist {
+
+// A cell library "function" attribute (see function_parser.h) compiled once
+// for fast repeated evaluation. Functions of at most kMaxTruthTableInputs
+// inputs are reduced to a truth table; every function is also kept as a flat
+// postfix program over its inputs. Both forms evaluate 64 independent input
+// vectors at a time on 64-bit words.
+//
+// Inputs are identified by their index in the list of input pin names the
+// function was compiled against (the cell library entry's input_names()), so
+// one compiled function serves every instance of the cell.
+class CompiledCellFunction {
+ public:
+  static constexpr int64_t kMaxTruthTableInputs = 6;
+  static constexpr int64_t kMaxInputs = 64;
+
+  // Compiles `ast`, whose identifiers must all be in `input_names`. Returns an
+  // error if the function refers to any other signal (such as an internal
+  // state table pin).
+  static absl::StatusOr<CompiledCellFunction> Compile(
+      const function::Ast& ast, absl::Span<const std::string> input_names);
+  static absl::StatusOr<CompiledCellFunction> Compile(
+      const std::string& function, absl::Span<const std::string> input_names);
+
+  int64_t input_count() const { return input_count_; }
+
+  // Bit `i` is set iff the function reads input `i`.
+  uint64_t used_inputs() const { return used_inputs_; }
+
+  // Evaluates the function for a single input vector whose bit `i` holds the
+  // value of input `i`.
+  bool Evaluate(uint64_t inputs) const;
+
+  // Evaluates the function for 64 input vectors: bit `l` of `inputs[i]` is the
+  // value of input `i` in vector `l`. Returns the 64 results.
+  uint64_t EvaluateLanes(absl::Span<const uint64_t> inputs) const;
+
+  // Replays the postfix program over values of type T, e.g. to generate code
+  // for the function. `ops` must provide `T Zero()`, `T One()`, `T Not(T)`,
+  // and `T And(T, T)`, `T Or(T, T)` and `T Xor(T, T)`.
+  template <typename T, typename Ops>
+  T Build(absl::Span<const T> inputs, Ops& ops) const {
+    using Kind = Instruction::Kind;
+    std::vector<T> stack;
+    for (const Instruction& instruction : program_) {
+      switch (instruction.kind) {
+        case Kind::kInput:
+          stack.push_back(inputs[instruction.input]);
+          break;
+        case Kind::kZero:
+          stack.push_back(ops.Zero());
+          break;
+        case Kind::kOne:
+          stack.push_back(ops.One());
+          break;
+        case Kind::kNot:
+          stack.back() = ops.Not(stack.back());
+          break;
+        case Kind::kAnd:
+        case Kind::kOr:
+        case Kind::kXor: {
+          T rhs = stack.back();
+          stack.pop_back();
+          T& lhs = stack.back();
+          lhs = instruction.kind == Kind::kAnd  ? ops.And(lhs, rhs)
+                : instruction.kind == Kind::kOr ? ops.Or(lhs, rhs)
+                                                : ops.Xor(lhs, rhs);
+          break;
+        }
+      }
+    }
+    return stack.back();
+  }
+
+ private:
+  // One step of the postfix program.
+  struct Instruction {
+    enum class Kind : uint8_t { kInput, kZero, kOne, kAnd, kOr, kXor, kNot };
+    Kind kind;
+    // For kInput, the index of the input to read.
+    uint8_t input = 0;
+  };
+
+  static absl::Status CompileAst(const function::Ast& ast,
+                                 absl::Span<const std::string> input_names,
+                                 CompiledCellFunction& function);
+
+  uint64_t RunProgram(absl::Span<const uint64_t> inputs) const;
+  uint64_t LookUpTruthTable(absl::Span<const uint64_t> inputs) const;
+
+  int64_t input_count_ = 0;
+  uint64_t used_inputs_ = 0;
+  std::vector<Instruction> program_;
+  // Bit `m` is the value of the function for the input vector `m`; only valid
+  // if `input_count_ <= kMaxTruthTableInputs`.
+  uint64_t truth_table_ = 0;
+  // Whether EvaluateLanes should use the truth table, which takes
+  // 2^input_count - 1 word selects, rather than the program.
+  bool lanes_use_truth_table_ = false;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_COMPILED_CELL_FUNCTION_H_
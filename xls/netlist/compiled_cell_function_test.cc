@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/compiled_cell_function.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/status/matchers.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using ::absl_testing::StatusIs;
+
+// Arbitrary lane patterns for up to seven inputs.
+constexpr uint64_t kLanes[] = {
+    0x0123456789ABCDEFull, 0xFEDCBA9876543210ull, 0xDEADBEEFCAFEF00Dull,
+    0x5555AAAA3333CCCCull, 0x0F0F00FFF0F0FF00ull, 0x8000000000000001ull,
+    0x7FFFFFFFFFFFFFFEull,
+};
+
+TEST(CompiledCellFunctionTest, TruthTable) {
+  std::vector<std::string> inputs = {"A", "B"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledCellFunction nand,
+                           CompiledCellFunction::Compile("!(A*B)", inputs));
+  EXPECT_EQ(nand.input_count(), 2);
+  EXPECT_EQ(nand.used_inputs(), 0b11);
+  EXPECT_TRUE(nand.Evaluate(0b00));
+  EXPECT_TRUE(nand.Evaluate(0b01));
+  EXPECT_TRUE(nand.Evaluate(0b10));
+  EXPECT_FALSE(nand.Evaluate(0b11));
+  EXPECT_EQ(nand.EvaluateLanes({kLanes[0], kLanes[1]}),
+            ~(kLanes[0] & kLanes[1]));
+}
+
+TEST(CompiledCellFunctionTest, SixInputs) {
+  std::vector<std::string> inputs = {"A", "B", "C", "D", "E", "F"};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CompiledCellFunction function,
+      CompiledCellFunction::Compile("(A+B)*(C+D)*(E^F)", inputs));
+  for (uint64_t m = 0; m < 64; ++m) {
+    auto bit = [&](int64_t i) { return ((m >> i) & 1) != 0; };
+    EXPECT_EQ(function.Evaluate(m),
+              (bit(0) || bit(1)) && (bit(2) || bit(3)) && (bit(4) != bit(5)))
+        << m;
+  }
+  EXPECT_EQ(function.EvaluateLanes(
+                {kLanes[0], kLanes[1], kLanes[2], kLanes[3], kLanes[4],
+                 kLanes[5]}),
+            (kLanes[0] | kLanes[1]) & (kLanes[2] | kLanes[3]) &
+                (kLanes[4] ^ kLanes[5]));
+}
+
+TEST(CompiledCellFunctionTest, WideFunctionUsesProgram) {
+  std::vector<std::string> inputs = {"A", "B", "C", "D", "E", "F", "G"};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CompiledCellFunction function,
+      CompiledCellFunction::Compile("A*B*C*D*E*F*!G", inputs));
+  EXPECT_TRUE(function.Evaluate(0b0111111));
+  EXPECT_FALSE(function.Evaluate(0b1111111));
+  EXPECT_FALSE(function.Evaluate(0b0111110));
+  uint64_t expected = ~kLanes[6];
+  for (int64_t i = 0; i < 6; ++i) {
+    expected &= kLanes[i];
+  }
+  EXPECT_EQ(function.EvaluateLanes(kLanes), expected);
+}
+
+TEST(CompiledCellFunctionTest, UnusedInputsAndConstants) {
+  std::vector<std::string> inputs = {"A", "B", "C"};
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledCellFunction function,
+                           CompiledCellFunction::Compile("C+0", inputs));
+  EXPECT_EQ(function.used_inputs(), 0b100);
+  EXPECT_EQ(function.EvaluateLanes({kLanes[0], kLanes[1], kLanes[2]}),
+            kLanes[2]);
+  XLS_ASSERT_OK_AND_ASSIGN(CompiledCellFunction one,
+                           CompiledCellFunction::Compile("1", {}));
+  EXPECT_TRUE(one.Evaluate(0));
+  EXPECT_EQ(one.EvaluateLanes({}), ~uint64_t{0});
+}
+
+TEST(CompiledCellFunctionTest, InternalSignalsAreNotCompiled) {
+  std::vector<std::string> inputs = {"D", "CLK"};
+  EXPECT_THAT(CompiledCellFunction::Compile("IQ", inputs),
+              StatusIs(absl::StatusCode::kUnimplemented));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
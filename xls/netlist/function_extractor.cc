@@ -18,6 +18,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -31,6 +32,7 @@
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -279,9 +281,6 @@ absl::Status ExtractFromCell(const cell_lib::Block& cell,
 absl::StatusOr<CellLibraryProto> ExtractFunctions(
     cell_lib::CharStream* stream) {
   cell_lib::Scanner scanner(stream);
-  absl::flat_hash_set<std::string> kind_allowlist(
-      {"library", "cell", "pin", "direction", "function", "ff", "next_state",
-       "statetable"});
   cell_lib::Parser parser(&scanner);
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<cell_lib::Block> block,
@@ -300,6 +299,32 @@ absl::StatusOr<CellLibraryProto> ExtractFunctions(
   return proto;
 }
 
+absl::StatusOr<CellLibraryEntryProto> ExtractFunction(
+    const cell_lib::CellIndex& index, std::string_view cell_name) {
+  // Sub-blocks of the cell other than these (e.g. timing tables, which make up
+  // most of a typical library) are dropped as soon as they're parsed.
+  absl::flat_hash_set<std::string> kind_allowlist(
+      {"cell", kPinKind, kFfKind, kStateTableKind});
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<cell_lib::Block> cell,
+                       index.ParseCell(cell_name, std::move(kind_allowlist)));
+  CellLibraryEntryProto entry_proto;
+  XLS_RETURN_IF_ERROR(ExtractFromCell(*cell, &entry_proto));
+  return entry_proto;
+}
+
+absl::StatusOr<CellLibrary> MakeLazyCellLibrary(std::string_view path) {
+  XLS_ASSIGN_OR_RETURN(cell_lib::CharStream stream,
+                       cell_lib::CharStream::FromMappedFile(path));
+  XLS_ASSIGN_OR_RETURN(cell_lib::CellIndex index,
+                       cell_lib::CellIndex::Create(std::move(stream)));
+  auto shared_index = std::make_shared<const cell_lib::CellIndex>(
+      std::move(index));
+  return CellLibrary::FromLoader(
+      [shared_index](std::string_view name) {
+        return ExtractFunction(*shared_index, name);
+      });
+}
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -15,8 +15,10 @@
 #ifndef XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 #define XLS_NETLIST_FUNCTION_EXTRACTOR_H_
 
+#include <string_view>
 
 #include "absl/status/statusor.h"
+#include "xls/netlist/cell_library.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -30,6 +32,18 @@ namespace function {
 // logical operation of the cell or pin (in the case of multiple output pins).
 absl::StatusOr<CellLibraryProto> ExtractFunctions(cell_lib::CharStream* stream);
 
+// As above, but for the single cell `cell_name`; only that cell's group is
+// parsed.
+absl::StatusOr<CellLibraryEntryProto> ExtractFunction(
+    const cell_lib::CellIndex& index, std::string_view cell_name);
+
+// Memory-maps the Liberty file at `path`, indexes its cells and returns a cell
+// library which extracts each entry the first time it is looked up. The
+// library's ToProto() then holds just the cells used so far, which can be
+// saved and loaded with CellLibrary::FromProto to skip the Liberty file
+// entirely on later runs.
+absl::StatusOr<CellLibrary> MakeLazyCellLibrary(std::string_view path);
+
 }  // namespace function
 }  // namespace netlist
 }  // namespace xls
@@ -16,9 +16,13 @@
 
 #include <string>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.pb.h"
 
@@ -27,6 +31,8 @@ namespace netlist {
 namespace function {
 namespace {
 
+using ::absl_testing::StatusIs;
+
 TEST(FunctionExtractorTest, BasicFunctionality) {
   std::string lib = R"(
 library (blah) {
@@ -217,6 +223,64 @@ library (simple_statetable_cells) {
   EXPECT_EQ(row.next_internal_signals().at("X"), STATE_TABLE_SIGNAL_HIGH);
 }
 
+TEST(FunctionExtractorTest, LazyLibraryExtractsUsedCells) {
+  std::string lib = R"(
+library (blah) {
+  cell (cell_1) {
+    pin (i0) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "!i0";
+    }
+  }
+  cell (cell_2) {
+    pin (i0) {
+      direction: input;
+    }
+    pin (i1) {
+      direction: input;
+    }
+    pin (o) {
+      direction: output;
+      function: "i0&i1";
+      timing () {
+        related_pin: "i0";
+      }
+    }
+  }
+})";
+
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::CreateWithContent(lib));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary library,
+                           MakeLazyCellLibrary(file.path().string()));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto proto, library.ToProto());
+  EXPECT_EQ(proto.entries_size(), 0);
+
+  XLS_ASSERT_OK_AND_ASSIGN(const CellLibraryEntry* entry,
+                           library.GetEntry("cell_2"));
+  EXPECT_EQ(entry->name(), "cell_2");
+  EXPECT_EQ(entry->input_names().size(), 2);
+  EXPECT_THAT(library.GetEntry("cell_3"),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  // Only the cell that was looked up is serialized, and it matches what the
+  // eager extractor produces.
+  XLS_ASSERT_OK_AND_ASSIGN(proto, library.ToProto());
+  ASSERT_EQ(proto.entries_size(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(auto stream, cell_lib::CharStream::FromText(lib));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryProto eager, ExtractFunctions(&stream));
+  ASSERT_EQ(eager.entries_size(), 2);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      CellLibraryEntry eager_entry,
+      CellLibraryEntry::FromProto(eager.entries(1), false, true));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibraryEntryProto eager_proto,
+                           eager_entry.ToProto());
+  EXPECT_EQ(proto.entries(0).SerializeAsString(),
+            eager_proto.SerializeAsString());
+}
+
 }  // namespace
 }  // namespace function
 }  // namespace netlist
@@ -16,6 +16,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <memory>
 #include <optional>
@@ -39,6 +40,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_cell_function.h"
 #include "xls/netlist/function_parser.h"
 #include "xls/netlist/netlist.h"
 
@@ -131,6 +133,13 @@ class AbstractInterpreter {
       const rtl::AbstractCell<EvalT>& cell, const function::Ast& ast,
       const AbstractNetRef2Value<EvalT>& inputs);
 
+  // Evaluates the given output pin of `cell` with the compiled function of its
+  // cell library entry. Returns nullopt if the function isn't compiled or reads
+  // an input pin the cell doesn't connect. Only for EvalT = bool.
+  std::optional<EvalT> EvaluateCompiledFunction(
+      const rtl::AbstractCell<EvalT>& cell, const std::string& pin_name,
+      const AbstractNetRef2Value<EvalT>& inputs);
+
   // Returns the value of the internal/output pin from the cell (defined by a
   // "statetable" attribute under the conditions defined in "inputs".
   absl::StatusOr<EvalT> InterpretStateTable(
@@ -480,6 +489,14 @@ AbstractInterpreter<EvalT>::InterpretCell(
       XLS_ASSIGN_OR_RETURN(EvalT value, cell->outputs()[i].eval(args));
       results.insert({cell->outputs()[i].netref, value});
     } else {
+      if constexpr (std::is_same_v<EvalT, bool>) {
+        std::optional<EvalT> value =
+            EvaluateCompiledFunction(*cell, cell->outputs()[i].name, inputs);
+        if (value.has_value()) {
+          results.insert({cell->outputs()[i].netref, *value});
+          continue;
+        }
+      }
       XLS_ASSIGN_OR_RETURN(
           function::Ast ast,
           function::Parser::ParseFunction(pins.at(cell->outputs()[i].name)));
@@ -585,6 +602,36 @@ absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretFunction(
   }
 }
 
+template <typename EvalT>
+std::optional<EvalT> AbstractInterpreter<EvalT>::EvaluateCompiledFunction(
+    const rtl::AbstractCell<EvalT>& cell, const std::string& pin_name,
+    const AbstractNetRef2Value<EvalT>& inputs) {
+  const CompiledCellFunction* function =
+      cell.cell_library_entry()->GetCompiledFunction(pin_name);
+  if (function == nullptr) {
+    return std::nullopt;
+  }
+  absl::Span<const std::string> input_names =
+      cell.cell_library_entry()->input_names();
+  uint64_t connected = 0;
+  uint64_t values = 0;
+  for (const auto& input : cell.inputs()) {
+    for (int64_t i = 0; i < input_names.size(); ++i) {
+      if (input_names[i] == input.name) {
+        connected |= uint64_t{1} << i;
+        if (inputs.at(input.netref)) {
+          values |= uint64_t{1} << i;
+        }
+        break;
+      }
+    }
+  }
+  if ((function->used_inputs() & ~connected) != 0) {
+    return std::nullopt;
+  }
+  return function->Evaluate(values);
+}
+
 template <typename EvalT>
 absl::StatusOr<EvalT> AbstractInterpreter<EvalT>::InterpretStateTable(
     const rtl::AbstractCell<EvalT>& cell, const std::string& pin_name,
@@ -0,0 +1,159 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/levelize.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+absl::StatusOr<Levelization> Levelize(const rtl::Module& module,
+                                      bool flops_are_registers) {
+  Levelization result;
+  absl::flat_hash_map<rtl::NetRef, int64_t>& net_index = result.net_index;
+  for (const auto& net : module.nets()) {
+    net_index.emplace(net.get(), net_index.size());
+  }
+
+  auto is_register = [&](const rtl::Cell& cell) {
+    return flops_are_registers && cell.kind() == CellKind::kFlop &&
+           cell.internal_pins().empty();
+  };
+
+  // Record which cell drives each net.
+  absl::Span<const std::unique_ptr<rtl::Cell>> cells = module.cells();
+  const int64_t cell_count = cells.size();
+  absl::flat_hash_map<int64_t, int64_t> driver;
+  for (int64_t c = 0; c < cell_count; ++c) {
+    for (const rtl::Cell::OutputPin& output : cells[c]->outputs()) {
+      if (output.netref == nullptr || output.netref == module.GetDummyRef()) {
+        continue;
+      }
+      bool inserted = driver.emplace(net_index.at(output.netref), c).second;
+      if (!inserted) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Net %s has multiple drivers, including cell %s.",
+                            output.netref->name(), cells[c]->name()));
+      }
+    }
+  }
+
+  // Nets whose values are known before any cell is evaluated: constants,
+  // module inputs and register outputs.
+  std::vector<bool> known(net_index.size(), false);
+  known[net_index.at(module.zero())] = true;
+  known[net_index.at(module.one())] = true;
+  for (const rtl::NetRef input : module.inputs()) {
+    known[net_index.at(input)] = true;
+  }
+  for (const auto& [net, c] : driver) {
+    if (is_register(*cells[c])) {
+      known[net] = true;
+    }
+  }
+
+  // A cell becomes ready once all of the nets it reads which are driven by
+  // other levelized cells have been computed.
+  std::vector<int64_t> pending(cell_count, 0);
+  absl::flat_hash_map<int64_t, std::vector<int64_t>> readers;
+  std::vector<int64_t> ready;
+  for (int64_t c = 0; c < cell_count; ++c) {
+    const rtl::Cell& cell = *cells[c];
+    for (const rtl::Cell::Pin& input : cell.inputs()) {
+      int64_t net = net_index.at(input.netref);
+      if (known[net]) {
+        continue;
+      }
+      if (!driver.contains(net)) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Netlist contains unconnected subgraphs and cannot be "
+            "levelized. Example: cell %s",
+            cell.name()));
+      }
+      if (!is_register(cell)) {
+        ++pending[c];
+        readers[net].push_back(c);
+      }
+    }
+    if (!is_register(cell) && pending[c] == 0) {
+      ready.push_back(c);
+    }
+  }
+  const int64_t register_count = absl::c_count_if(
+      cells, [&](const auto& cell) { return is_register(*cell); });
+  int64_t levelized = 0;
+  while (!ready.empty()) {
+    std::vector<int64_t> next;
+    for (int64_t c : ready) {
+      for (const rtl::Cell::OutputPin& output : cells[c]->outputs()) {
+        if (output.netref == nullptr ||
+            output.netref == module.GetDummyRef()) {
+          continue;
+        }
+        auto it = readers.find(net_index.at(output.netref));
+        if (it == readers.end()) {
+          continue;
+        }
+        for (int64_t reader : it->second) {
+          if (--pending[reader] == 0) {
+            next.push_back(reader);
+          }
+        }
+      }
+    }
+    levelized += ready.size();
+    result.levels.push_back(std::move(ready));
+    ready = std::move(next);
+  }
+  if (levelized + register_count != cell_count) {
+    auto it = absl::c_find_if(pending, [](int64_t p) { return p > 0; });
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Netlist contains a combinational cycle through cell %s.",
+        cells[it - pending.begin()]->name()));
+  }
+
+  for (const rtl::NetRef output : module.outputs()) {
+    rtl::NetRef net = output;
+    if (!driver.contains(net_index.at(net))) {
+      // If the check below fails, the output wire is undefined; see
+      // Interpreter::InterpretModule.
+      XLS_RET_CHECK(module.assigns().contains(net)) << output->name();
+      while (module.assigns().contains(net)) {
+        net = module.assigns().at(net);
+      }
+      XLS_RET_CHECK(known[net_index.at(net)] ||
+                    driver.contains(net_index.at(net)))
+          << output->name();
+    }
+    result.output_sources.push_back(net_index.at(net));
+  }
+  return result;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,57 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_LEVELIZE_H_
+#define XLS_NETLIST_LEVELIZE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// The evaluation order of the cells of a flat netlist module, shared by the
+// evaluators which compute whole levels at a time (LevelizedInterpreter,
+// NetlistJit).
+struct Levelization {
+  // Index of each net of the module, in the order of nets().
+  absl::flat_hash_map<rtl::NetRef, int64_t> net_index;
+  // Indices into cells() of the cells of each level. A cell's level is one
+  // more than the highest level of the cells driving its inputs, so cells of
+  // the same level don't depend on each other. Registers are in no level.
+  std::vector<std::vector<int64_t>> levels;
+  // For each module output, in the order of outputs(), the index of the net
+  // it takes its value from. Outputs which aren't driven by a cell follow the
+  // chain of assignments to a constant, an input or a cell-driven net.
+  std::vector<int64_t> output_sources;
+};
+
+// Levelizes the cells of `module` with Kahn's algorithm. The constants and
+// the module inputs are known before any cell is evaluated. If
+// `flops_are_registers`, so are the outputs of flops without state tables:
+// such flops hold their values across cycles and are left out of the levels.
+//
+// Returns an error if a net has multiple drivers, a cell reads a net which is
+// neither known nor driven, or the cells form a combinational cycle.
+absl::StatusOr<Levelization> Levelize(const rtl::Module& module,
+                                      bool flops_are_registers = false);
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_LEVELIZE_H_
@@ -0,0 +1,143 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/levelize.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::UnorderedElementsAre;
+
+class LevelizeTest : public ::testing::Test {
+ protected:
+  absl::StatusOr<const rtl::Module*> Parse(const std::string& module_text) {
+    XLS_ASSIGN_OR_RETURN(cell_library_, MakeFakeCellLibrary());
+    rtl::Scanner scanner(module_text);
+    XLS_ASSIGN_OR_RETURN(netlist_,
+                         rtl::Parser::ParseNetlist(&cell_library_, &scanner));
+    return netlist_->GetModule("main");
+  }
+
+  CellLibrary cell_library_;
+  std::unique_ptr<rtl::Netlist> netlist_;
+};
+
+TEST_F(LevelizeTest, CellsFollowTheirDrivers) {
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module, Parse(R"(
+module main(i0, i1, o0, o1);
+  input i0, i1;
+  output o0, o1;
+  wire a, b;
+
+  INV inv1 ( .A(a), .ZN(b) );
+  AND and0 ( .A(i0), .B(i1), .Z(a) );
+  OR or0 ( .A(a), .B(b), .Z(o0) );
+  INV inv0 ( .A(i0), .ZN(o1) );
+endmodule
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Levelization levelization, Levelize(*module));
+  EXPECT_EQ(levelization.net_index.size(), module->nets().size());
+  EXPECT_THAT(levelization.levels,
+              ElementsAre(UnorderedElementsAre(1, 3), ElementsAre(0),
+                          ElementsAre(2)));
+  EXPECT_THAT(levelization.output_sources,
+              ElementsAre(levelization.net_index.at(module->outputs()[0]),
+                          levelization.net_index.at(module->outputs()[1])));
+}
+
+TEST_F(LevelizeTest, OutputsFollowAssignments) {
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module, Parse(R"(
+module main(i0, o0);
+  input i0;
+  output o0;
+
+  assign o0 = i0;
+endmodule
+  )"));
+  XLS_ASSERT_OK_AND_ASSIGN(Levelization levelization, Levelize(*module));
+  EXPECT_TRUE(levelization.levels.empty());
+  EXPECT_THAT(levelization.output_sources,
+              ElementsAre(levelization.net_index.at(module->inputs()[0])));
+}
+
+// A flop fed back through an inverter is a combinational cycle unless the
+// flop is a register.
+TEST_F(LevelizeTest, FlopsAsRegisters) {
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module, Parse(R"(
+module main(q);
+  output q;
+  wire nq;
+
+  DFF dff0 ( .D(nq), .Q(q) );
+  INV inv0 ( .A(q), .ZN(nq) );
+endmodule
+  )"));
+  EXPECT_THAT(Levelize(*module), StatusIs(absl::StatusCode::kInvalidArgument,
+                                          HasSubstr("combinational cycle")));
+  XLS_ASSERT_OK_AND_ASSIGN(Levelization levelization,
+                           Levelize(*module, /*flops_are_registers=*/true));
+  EXPECT_THAT(levelization.levels, ElementsAre(ElementsAre(1)));
+}
+
+TEST_F(LevelizeTest, RejectsMultipleDrivers) {
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module, Parse(R"(
+module main(i0, o0);
+  input i0;
+  output o0;
+
+  INV inv0 ( .A(i0), .ZN(o0) );
+  INV inv1 ( .A(i0), .ZN(o0) );
+endmodule
+  )"));
+  EXPECT_THAT(Levelize(*module), StatusIs(absl::StatusCode::kInvalidArgument,
+                                          HasSubstr("multiple drivers")));
+}
+
+TEST_F(LevelizeTest, RejectsUndrivenNets) {
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module, Parse(R"(
+module main(i0, o0);
+  input i0;
+  output o0;
+  wire a;
+
+  AND and0 ( .A(i0), .B(a), .Z(o0) );
+endmodule
+  )"));
+  EXPECT_THAT(Levelize(*module), StatusIs(absl::StatusCode::kInvalidArgument,
+                                          HasSubstr("unconnected subgraphs")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,226 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/levelized_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/netlist/compiled_cell_function.h"
+#include "xls/netlist/levelize.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+// Levels with fewer cells than this are evaluated on the calling thread; the
+// cost of dispatching outweighs the parallelism.
+constexpr int64_t kMinCellsPerTask = 256;
+
+}  // namespace
+
+struct LevelizedInterpreter::CompiledCell {
+  struct Output {
+    // Index of the net written by this output pin.
+    int64_t net;
+    // The pin function, shared by all instances of the cell, unless the pin
+    // has a custom evaluation function.
+    const CompiledCellFunction* function = nullptr;
+    const rtl::CellOutputEvalFn<bool>* eval = nullptr;
+  };
+
+  const rtl::Cell* cell;
+  // Net indices of the input pins, in pin order.
+  std::vector<int64_t> inputs;
+  // Net indices of the inputs of the cell library entry, in the order of its
+  // input_names(); unconnected inputs which the functions don't read are tied
+  // to zero.
+  std::vector<int64_t> function_inputs;
+  std::vector<Output> outputs;
+};
+
+LevelizedInterpreter::LevelizedInterpreter(const rtl::Module* module)
+    : module_(module) {}
+
+LevelizedInterpreter::~LevelizedInterpreter() = default;
+
+int64_t LevelizedInterpreter::cell_count() const { return cells_.size(); }
+
+absl::StatusOr<std::unique_ptr<LevelizedInterpreter>>
+LevelizedInterpreter::Create(const rtl::Netlist* netlist,
+                             const rtl::Module* module) {
+  std::unique_ptr<LevelizedInterpreter> interpreter(
+      new LevelizedInterpreter(module));
+  XLS_ASSIGN_OR_RETURN(Levelization levelization, Levelize(*module));
+  interpreter->net_index_ = std::move(levelization.net_index);
+  interpreter->levels_ = std::move(levelization.levels);
+  for (int64_t i = 0; i < module->outputs().size(); ++i) {
+    interpreter->outputs_.push_back(
+        {module->outputs()[i], levelization.output_sources[i]});
+  }
+  const absl::flat_hash_map<rtl::NetRef, int64_t>& net_index =
+      interpreter->net_index_;
+
+  // Compile each cell; `cells_` follows the order of module->cells(), which
+  // the levels index.
+  for (const auto& cell : module->cells()) {
+    const CellLibraryEntry* entry = cell->cell_library_entry();
+    if (netlist->MaybeGetModule(entry->name()).has_value()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cell %s instantiates module %s; the levelized interpreter only "
+          "supports flat netlists.",
+          cell->name(), entry->name()));
+    }
+    if (!cell->internal_pins().empty()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cell %s has internal (state table) pins, which the levelized "
+          "interpreter does not support.",
+          cell->name()));
+    }
+
+    CompiledCell compiled{.cell = cell.get()};
+    for (const rtl::Cell::Pin& input : cell->inputs()) {
+      compiled.inputs.push_back(net_index.at(input.netref));
+    }
+    absl::Span<const std::string> input_names = entry->input_names();
+    uint64_t connected = 0;
+    compiled.function_inputs.assign(input_names.size(),
+                                    net_index.at(module->zero()));
+    for (const rtl::Cell::Pin& input : cell->inputs()) {
+      auto it = absl::c_find(input_names, input.name);
+      if (it != input_names.end()) {
+        int64_t i = it - input_names.begin();
+        compiled.function_inputs[i] = net_index.at(input.netref);
+        connected |= uint64_t{1} << i;
+      }
+    }
+    for (const rtl::Cell::OutputPin& output : cell->outputs()) {
+      if (output.netref == nullptr || output.netref == module->GetDummyRef()) {
+        continue;
+      }
+      CompiledCell::Output& compiled_output = compiled.outputs.emplace_back();
+      compiled_output.net = net_index.at(output.netref);
+      if (output.eval != nullptr) {
+        compiled_output.eval = &output.eval;
+      } else {
+        compiled_output.function = entry->GetCompiledFunction(output.name);
+        if (compiled_output.function == nullptr) {
+          // Recompile to report why the function couldn't be compiled.
+          absl::Status status =
+              CompiledCellFunction::Compile(
+                  entry->output_pin_to_function().at(output.name), input_names)
+                  .status();
+          return absl::UnimplementedError(absl::StrFormat(
+              "Function of pin %s of cell %s isn't supported by the levelized "
+              "interpreter: %s",
+              output.name, cell->name(), status.message()));
+        }
+        if ((compiled_output.function->used_inputs() & ~connected) != 0) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Function of pin %s of cell %s reads an unconnected input.",
+              output.name, cell->name()));
+        }
+      }
+    }
+    interpreter->cells_.push_back(std::move(compiled));
+  }
+  return std::move(interpreter);
+}
+
+absl::Status LevelizedInterpreter::EvaluateCell(
+    const CompiledCell& cell, std::vector<uint64_t>& values) const {
+  for (const CompiledCell::Output& output : cell.outputs) {
+    if (output.eval == nullptr) {
+      absl::InlinedVector<uint64_t, 8> args;
+      args.reserve(cell.function_inputs.size());
+      for (int64_t net : cell.function_inputs) {
+        args.push_back(values[net]);
+      }
+      values[output.net] = output.function->EvaluateLanes(args);
+      continue;
+    }
+    // Custom evaluation functions work on single bits; evaluate them once per
+    // lane.
+    uint64_t result = 0;
+    std::vector<bool> args(cell.inputs.size());
+    for (int64_t lane = 0; lane < kLanes; ++lane) {
+      for (int64_t i = 0; i < cell.inputs.size(); ++i) {
+        args[i] = (values[cell.inputs[i]] >> lane) & 1;
+      }
+      XLS_ASSIGN_OR_RETURN(bool bit, (*output.eval)(args));
+      result |= static_cast<uint64_t>(bit) << lane;
+    }
+    values[output.net] = result;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<NetRef2Lanes> LevelizedInterpreter::InterpretModule(
+    const NetRef2Lanes& inputs, ThreadPool* thread_pool) const {
+  std::vector<uint64_t> values(net_index_.size(), 0);
+  values[net_index_.at(module_->one())] = ~uint64_t{0};
+  for (const rtl::NetRef input : module_->inputs()) {
+    auto it = inputs.find(input);
+    XLS_RET_CHECK(it != inputs.end())
+        << "No value given for module input " << input->name();
+    values[net_index_.at(input)] = it->second;
+  }
+
+  for (const std::vector<int64_t>& level : levels_) {
+    if (thread_pool == nullptr || level.size() < 2 * kMinCellsPerTask) {
+      for (int64_t c : level) {
+        XLS_RETURN_IF_ERROR(EvaluateCell(cells_[c], values));
+      }
+      continue;
+    }
+
+    // Cells of the same level only read nets computed by earlier levels and
+    // each writes its own output nets, so the level can be split freely.
+    absl::Mutex mutex;
+    absl::Status status;
+    thread_pool->ParallelFor(level.size(), kMinCellsPerTask, [&](int64_t i) {
+      absl::Status cell_status = EvaluateCell(cells_[level[i]], values);
+      if (!cell_status.ok()) {
+        absl::MutexLock lock(&mutex);
+        status.Update(cell_status);
+      }
+    });
+    XLS_RETURN_IF_ERROR(status);
+  }
+
+  NetRef2Lanes outputs;
+  outputs.reserve(outputs_.size());
+  for (const auto& [output, source] : outputs_) {
+    outputs.emplace(output, values[source]);
+  }
+  return outputs;
+}
+
+}  // namespace netlist
+}  // namespace xls
@@ -0,0 +1,89 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NETLIST_LEVELIZED_INTERPRETER_H_
+#define XLS_NETLIST_LEVELIZED_INTERPRETER_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/common/thread_pool.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Values of nets in bit-parallel form: bit `i` of each word is the value of the
+// net for the `i`-th of up to 64 independent input vectors.
+using NetRef2Lanes = absl::flat_hash_map<rtl::NetRef, uint64_t>;
+
+// Interprets a flat (non-hierarchical, combinational) netlist module for 64
+// input vectors at a time.
+//
+// Unlike Interpreter, which discovers the evaluation order through a work
+// queue on every call, the cells are ranked topologically once at
+// construction: a cell's level is one more than the highest level of the
+// cells driving its inputs. Cells of the same level don't depend on each other
+// and are evaluated in parallel when a thread pool is given. Cell functions
+// are compiled once per cell library entry (see compiled_cell_function.h) and
+// evaluated on whole words, so each cell evaluation computes its outputs for
+// all 64 vectors.
+//
+// Cells which are themselves modules of the netlist and cells with state
+// tables are not supported; flatten the netlist first.
+class LevelizedInterpreter {
+ public:
+  static constexpr int64_t kLanes = 64;
+
+  // Levelizes `module`, which must belong to `netlist` and outlive the
+  // interpreter.
+  static absl::StatusOr<std::unique_ptr<LevelizedInterpreter>> Create(
+      const rtl::Netlist* netlist, const rtl::Module* module);
+
+  ~LevelizedInterpreter();
+
+  // Evaluates the module. `inputs` must contain a value for every module
+  // input. Returns the values of the module outputs. If `thread_pool` is
+  // non-null, wide levels are split across its workers.
+  absl::StatusOr<NetRef2Lanes> InterpretModule(
+      const NetRef2Lanes& inputs, ThreadPool* thread_pool = nullptr) const;
+
+  int64_t level_count() const { return levels_.size(); }
+  int64_t cell_count() const;
+
+ private:
+  struct CompiledCell;
+
+  explicit LevelizedInterpreter(const rtl::Module* module);
+
+  absl::Status EvaluateCell(const CompiledCell& cell,
+                            std::vector<uint64_t>& values) const;
+
+  const rtl::Module* module_;
+  absl::flat_hash_map<rtl::NetRef, int64_t> net_index_;
+  std::vector<CompiledCell> cells_;
+  // Indices into `cells_` of the cells of each level.
+  std::vector<std::vector<int64_t>> levels_;
+  // Each module output and the index of the net it takes its value from.
+  std::vector<std::pair<rtl::NetRef, int64_t>> outputs_;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_LEVELIZED_INTERPRETER_H_
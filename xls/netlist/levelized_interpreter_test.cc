@@ -0,0 +1,178 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/netlist/levelized_interpreter.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+// Every lane of the levelized interpreter matches a run of the reference
+// interpreter on that lane's inputs.
+TEST(LevelizedInterpreterTest, MatchesInterpreterOnEachLane) {
+  std::string module_text = R"(
+module main(i0, i1, i2, i3, o0, o1);
+  input i0, i1, i2, i3;
+  output o0, o1;
+  wire and_o, or_o, inv_o;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and_o) );
+  OR or0 ( .A(i2), .B(i3), .Z(or_o) );
+  INV inv0 ( .A(and_o), .ZN(inv_o) );
+  AOI21 aoi0 ( .A(inv_o), .B(or_o), .C(i0), .ZN(o0) );
+  XOR xor0 ( .A(and_o), .B(or_o), .Z(o1) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<LevelizedInterpreter> levelized,
+      LevelizedInterpreter::Create(netlist.get(), module));
+  EXPECT_EQ(levelized->cell_count(), 5);
+  EXPECT_EQ(levelized->level_count(), 3);
+
+  // Lane `l` gets the input bits of `l`, so the four inputs cycle through all
+  // combinations.
+  NetRef2Lanes inputs;
+  for (int64_t i = 0; i < 4; ++i) {
+    uint64_t word = 0;
+    for (int64_t lane = 0; lane < LevelizedInterpreter::kLanes; ++lane) {
+      word |= static_cast<uint64_t>((lane >> i) & 1) << lane;
+    }
+    inputs[module->inputs()[i]] = word;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes outputs,
+                           levelized->InterpretModule(inputs));
+  ASSERT_EQ(outputs.size(), 2);
+
+  Interpreter interpreter(netlist.get());
+  for (int64_t lane = 0; lane < LevelizedInterpreter::kLanes; ++lane) {
+    NetRef2Value lane_inputs;
+    for (const auto& [net, word] : inputs) {
+      lane_inputs[net] = (word >> lane) & 1;
+    }
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Value expected,
+                             interpreter.InterpretModule(module, lane_inputs));
+    for (const rtl::NetRef output : module->outputs()) {
+      EXPECT_EQ((outputs.at(output) >> lane) & 1, expected.at(output))
+          << output->name() << " lane " << lane;
+    }
+  }
+}
+
+// A level wide enough to be split across the thread pool gives the same
+// results as serial evaluation.
+TEST(LevelizedInterpreterTest, WideLevelOnThreadPool) {
+  constexpr int64_t kWidth = 1024;
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::string cells;
+  for (int64_t i = 0; i <= kWidth; ++i) {
+    inputs.push_back(absl::StrCat("i", i));
+  }
+  for (int64_t i = 0; i < kWidth; ++i) {
+    outputs.push_back(absl::StrCat("o", i));
+    absl::StrAppendFormat(&cells,
+                          "  XOR xor%d ( .A(i%d), .B(i%d), .Z(o%d) );\n", i, i,
+                          i + 1, i);
+  }
+  std::string module_text = absl::StrFormat(
+      "module main(%s, %s);\n  input %s;\n  output %s;\n%sendmodule\n",
+      absl::StrJoin(inputs, ", "), absl::StrJoin(outputs, ", "),
+      absl::StrJoin(inputs, ", "), absl::StrJoin(outputs, ", "), cells);
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<LevelizedInterpreter> levelized,
+      LevelizedInterpreter::Create(netlist.get(), module));
+  EXPECT_EQ(levelized->level_count(), 1);
+
+  NetRef2Lanes input_values;
+  uint64_t state = 0x9e3779b97f4a7c15;
+  for (const rtl::NetRef input : module->inputs()) {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    input_values[input] = state;
+  }
+  ThreadPool pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes serial,
+                           levelized->InterpretModule(input_values));
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes parallel,
+                           levelized->InterpretModule(input_values, &pool));
+  EXPECT_EQ(serial, parallel);
+  for (int64_t i = 0; i < kWidth; ++i) {
+    EXPECT_EQ(serial.at(module->outputs()[i]),
+              input_values.at(module->inputs()[i]) ^
+                  input_values.at(module->inputs()[i + 1]));
+  }
+}
+
+TEST(LevelizedInterpreterTest, RejectsCycles) {
+  std::string module_text = R"(
+module main(i0, o0);
+  input i0;
+  output o0;
+  wire a, b;
+
+  AND and0 ( .A(i0), .B(b), .Z(a) );
+  INV inv0 ( .A(a), .ZN(b) );
+  INV inv1 ( .A(b), .ZN(o0) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(LevelizedInterpreter::Create(netlist.get(), module),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("combinational cycle")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
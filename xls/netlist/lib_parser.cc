@@ -33,6 +33,8 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/variant.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 
 namespace xls {
@@ -50,7 +52,31 @@ namespace cell_lib {
 }
 
 /* static */ absl::StatusOr<CharStream> CharStream::FromText(std::string text) {
-  return CharStream(std::move(text));
+  auto buffer = std::make_shared<const std::string>(std::move(text));
+  std::string_view view = *buffer;
+  return CharStream(std::move(buffer), view);
+}
+
+/* static */ absl::StatusOr<CharStream> CharStream::FromMappedFile(
+    std::string_view path) {
+  XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(path));
+  auto buffer = std::make_shared<const MappedFile>(std::move(file));
+  std::string_view view = buffer->contents();
+  return CharStream(std::move(buffer), view);
+}
+
+absl::StatusOr<CharStream> CharStream::Substream(Pos begin,
+                                                 int64_t end_offset) const {
+  if (if_.has_value()) {
+    return absl::FailedPreconditionError(
+        "Substreams are not supported for streams read from a file stream.");
+  }
+  XLS_RET_CHECK_LE(begin.offset, end_offset);
+  XLS_RET_CHECK_LE(end_offset, text_.size());
+  CharStream result(buffer_, text_.substr(0, end_offset));
+  result.cursor_ = begin.offset;
+  result.pos_ = Pos{begin.lineno, begin.colno, begin.offset};
+  return result;
 }
 
 std::string TokenKindToString(TokenKind kind) {
@@ -309,34 +335,101 @@ absl::StatusOr<std::vector<BlockEntry>> Parser::ParseEntries() {
       break;
     }
     XLS_ASSIGN_OR_RETURN(std::string identifier, PopIdentifierOrError());
-    XLS_ASSIGN_OR_RETURN(bool dropped_colon, TryDropToken(TokenKind::kColon));
-    if (dropped_colon) {
-      Pos last_pos;
-      XLS_ASSIGN_OR_RETURN(std::string value, PopValueOrError(&last_pos));
-
-      // Could be a colon-ref-type value, e.g., Foo:Bar.
-      XLS_ASSIGN_OR_RETURN(bool dropped_another_colon,
-                           TryDropToken(TokenKind::kColon));
-      if (dropped_another_colon) {
-        XLS_ASSIGN_OR_RETURN(std::string sub_value, PopValueOrError());
-        absl::StrAppend(&value, ":", sub_value);
-      }
-      result.push_back(KVEntry{identifier, value});
-      XLS_ASSIGN_OR_RETURN(bool dropped_semi, TryDropToken(TokenKind::kSemi));
+    XLS_ASSIGN_OR_RETURN(BlockEntry entry, ParseEntry(std::move(identifier)));
+    result.push_back(std::move(entry));
+  }
+  return result;
+}
+
+absl::StatusOr<BlockEntry> Parser::ParseEntry(std::string identifier) {
+  XLS_ASSIGN_OR_RETURN(bool dropped_colon, TryDropToken(TokenKind::kColon));
+  if (!dropped_colon) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<Block> block,
+                         ParseBlock(std::move(identifier)));
+    return block;
+  }
+  Pos last_pos;
+  XLS_ASSIGN_OR_RETURN(std::string value, PopValueOrError(&last_pos));
+
+  // Could be a colon-ref-type value, e.g., Foo:Bar.
+  XLS_ASSIGN_OR_RETURN(bool dropped_another_colon,
+                       TryDropToken(TokenKind::kColon));
+  if (dropped_another_colon) {
+    XLS_ASSIGN_OR_RETURN(std::string sub_value, PopValueOrError());
+    absl::StrAppend(&value, ":", sub_value);
+  }
+  XLS_ASSIGN_OR_RETURN(bool dropped_semi, TryDropToken(TokenKind::kSemi));
+  if (!dropped_semi) {
+    if (scanner_->GetPos().lineno == last_pos.lineno) {
+      return absl::InvalidArgumentError(
+          "Expected semicolon or newline after entry @ " +
+          last_pos.ToHumanString());
+    }
+  }
+  return KVEntry{std::move(identifier), std::move(value)};
+}
+
+absl::Status Parser::SkipEntries(Pos* close_pos) {
+  const Pos start_pos = scanner_->GetPos();
+  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenCurl));
+  int64_t depth = 1;
+  while (depth > 0) {
+    if (scanner_->AtEof()) {
+      return absl::InvalidArgumentError(
+          "Unexpected end-of-file in block starting @ " +
+          start_pos.ToHumanString());
+    }
+    XLS_ASSIGN_OR_RETURN(Token t, scanner_->Pop());
+    if (t.kind() == TokenKind::kOpenCurl) {
+      ++depth;
+    } else if (t.kind() == TokenKind::kCloseCurl) {
+      --depth;
+      *close_pos = t.pos();
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::vector<Parser::CellExtent>> Parser::IndexLibrary() {
+  XLS_RETURN_IF_ERROR(DropIdentifierOrError("library"));
+  XLS_RETURN_IF_ERROR(ParseValues().status());
+  XLS_RETURN_IF_ERROR(DropTokenOrError(TokenKind::kOpenCurl));
+  std::vector<CellExtent> cells;
+  while (true) {
+    XLS_ASSIGN_OR_RETURN(bool dropped_curl,
+                         TryDropToken(TokenKind::kCloseCurl));
+    if (dropped_curl) {
+      break;
+    }
+    const Pos begin = scanner_->GetPos();
+    XLS_ASSIGN_OR_RETURN(std::string identifier, PopIdentifierOrError());
+    XLS_ASSIGN_OR_RETURN(const Token* peek, scanner_->Peek());
+    if (identifier != "cell" || peek->kind() != TokenKind::kOpenParen) {
+      // Library-level attributes and groups other than cells are small, so
+      // they're just parsed and dropped.
+      XLS_RETURN_IF_ERROR(ParseEntry(std::move(identifier)).status());
+      continue;
+    }
+
+    Pos last_pos;
+    XLS_ASSIGN_OR_RETURN(auto args, ParseValues(&last_pos));
+    CellExtent extent{.name = args.empty() ? "" : args[0], .begin = begin};
+    Pos end_pos;
+    XLS_ASSIGN_OR_RETURN(peek, scanner_->Peek());
+    if (peek->kind() == TokenKind::kOpenCurl) {
+      XLS_RETURN_IF_ERROR(SkipEntries(&end_pos));
+    } else {
+      // A cell without a body; see ParseBlock.
+      XLS_ASSIGN_OR_RETURN(bool dropped_semi,
+                           TryDropToken(TokenKind::kSemi, &end_pos));
       if (!dropped_semi) {
-        if (scanner_->GetPos().lineno == last_pos.lineno) {
-          return absl::InvalidArgumentError(
-              "Expected semicolon or newline after entry @ " +
-              last_pos.ToHumanString());
-        }
+        end_pos = last_pos;
       }
-    } else {
-      XLS_ASSIGN_OR_RETURN(std::unique_ptr<Block> block,
-                           ParseBlock(identifier));
-      result.push_back(std::move(block));
     }
+    extent.end_offset = end_pos.offset + 1;
+    cells.push_back(std::move(extent));
   }
-  return result;
+  return cells;
 }
 
 absl::StatusOr<absl::InlinedVector<std::string, 4>> Parser::ParseValues(
@@ -384,6 +477,9 @@ absl::StatusOr<std::unique_ptr<Block>> Parser::ParseBlock(
   // Normally an identifier following the parens would be a syntax error, but
   // we allow it to terminate the block because it happens at least once we've
   // seen.
+  if (scanner_->AtEof()) {
+    return block;
+  }
   XLS_ASSIGN_OR_RETURN(const Token* peek_next, scanner_->Peek());
   if (peek_next->kind() == TokenKind::kIdentifier) {
     if (peek_next->pos().lineno > last_pos.lineno) {
@@ -399,6 +495,41 @@ absl::StatusOr<std::unique_ptr<Block>> Parser::ParseBlock(
   return block;
 }
 
+/* static */ absl::StatusOr<CellIndex> CellIndex::Create(CharStream stream) {
+  CellIndex index(std::move(stream));
+  Scanner scanner(&index.stream_);
+  Parser parser(&scanner);
+  XLS_ASSIGN_OR_RETURN(std::vector<Parser::CellExtent> cells,
+                       parser.IndexLibrary());
+  for (Parser::CellExtent& cell : cells) {
+    std::string name = cell.name;
+    auto [it, inserted] = index.extents_.emplace(name, std::move(cell));
+    if (!inserted) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Duplicate cell %s; first defined @ %s", name,
+          it->second.begin.ToHumanString()));
+    }
+    index.cell_names_.push_back(std::move(name));
+  }
+  return index;
+}
+
+absl::StatusOr<std::unique_ptr<Block>> CellIndex::ParseCell(
+    std::string_view name,
+    std::optional<absl::flat_hash_set<std::string>> kind_allowlist) const {
+  auto it = extents_.find(name);
+  if (it == extents_.end()) {
+    return absl::NotFoundError(
+        absl::StrCat("Cell not found in library: ", name));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      CharStream cs,
+      stream_.Substream(it->second.begin, it->second.end_offset));
+  Scanner scanner(&cs);
+  Parser parser(&scanner, std::move(kind_allowlist));
+  return parser.ParseCell();
+}
+
 }  // namespace cell_lib
 }  // namespace netlist
 }  // namespace xls
@@ -31,12 +31,14 @@
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 
 namespace xls {
@@ -47,6 +49,8 @@ namespace cell_lib {
 struct Pos {
   int64_t lineno;
   int64_t colno;
+  // Byte offset from the start of the text.
+  int64_t offset = 0;
 
   std::string ToHumanString() const {
     return absl::StrFormat("%d:%d", lineno + 1, colno + 1);
@@ -60,6 +64,17 @@ class CharStream {
   static absl::StatusOr<CharStream> FromPath(std::string_view path);
   static absl::StatusOr<CharStream> FromText(std::string text);
 
+  // Maps the file at `path` into memory read-only. Unlike FromPath this
+  // doesn't go through an ifstream for every character, and unlike FromText
+  // the file isn't copied onto the heap; pages are only brought in as they're
+  // scanned.
+  static absl::StatusOr<CharStream> FromMappedFile(std::string_view path);
+
+  // Returns a stream over the text from `begin` up to `end_offset` which
+  // shares this stream's buffer; positions are reported relative to the whole
+  // text. Not available for streams created with FromPath.
+  absl::StatusOr<CharStream> Substream(Pos begin, int64_t end_offset) const;
+
   ~CharStream() {
     if (if_.has_value()) {
       if_->close();
@@ -68,7 +83,7 @@ class CharStream {
 
   CharStream(CharStream&& other) = default;
 
-  Pos GetPos() const { return pos_; }
+  Pos GetPos() const { return Pos{pos_.lineno, pos_.colno, cursor_}; }
   bool AtEof() const {
     if (if_.has_value()) {
       return if_->eof();
@@ -119,7 +134,8 @@ class CharStream {
  private:
   explicit CharStream(std::ifstream file_stream)
       : if_(std::move(file_stream)) {}
-  explicit CharStream(std::string text) : text_(std::move(text)) {}
+  CharStream(std::shared_ptr<const void> buffer, std::string_view text)
+      : buffer_(std::move(buffer)), text_(text) {}
 
   void Unget(char c) {
     cursor_--;
@@ -152,8 +168,10 @@ class CharStream {
   // ifstream mode
   std::optional<std::ifstream> if_;
 
-  // text mode
-  std::string text_;
+  // text mode (also used for memory-mapped files): `text_` views the storage
+  // kept alive by `buffer_`, which substreams share.
+  std::shared_ptr<const void> buffer_;
+  std::string_view text_;
   int64_t cursor_ = 0;
   int64_t last_colno_ = 0;
 };
@@ -367,6 +385,27 @@ class Parser {
     return ParseBlock("library");
   }
 
+  // Parses a single `cell (...) { ... }` group, e.g. from a substream given by
+  // a CellExtent.
+  absl::StatusOr<std::unique_ptr<Block>> ParseCell() {
+    XLS_RETURN_IF_ERROR(DropIdentifierOrError("cell"));
+    return ParseBlock("cell");
+  }
+
+  // Where a cell group starts and ends in the library text.
+  struct CellExtent {
+    std::string name;
+    // Position of the leading "cell" identifier.
+    Pos begin;
+    // Offset one past the end of the group.
+    int64_t end_offset;
+  };
+
+  // Scans a library, returning the extent of each of its cell groups in order
+  // of appearance. The contents of the cells are skipped at the token level
+  // without building any blocks.
+  absl::StatusOr<std::vector<CellExtent>> IndexLibrary();
+
  private:
   absl::StatusOr<bool> TryDropToken(TokenKind target, Pos* pos = nullptr);
   absl::Status DropTokenOrError(TokenKind kind);
@@ -386,6 +425,14 @@ class Parser {
   // entries as well as sub-blocks.
   absl::StatusOr<std::vector<BlockEntry>> ParseEntries();
 
+  // Parses the remainder of an entry whose leading identifier has already been
+  // scanned.
+  absl::StatusOr<BlockEntry> ParseEntry(std::string identifier);
+
+  // Drops the tokens of a curly-brace-delimited group of entries, populating
+  // `close_pos` with the position of the closing brace.
+  absl::Status SkipEntries(Pos* close_pos);
+
   // Parses a comma-delimited sequence of values and returns their payloads.
   absl::StatusOr<absl::InlinedVector<std::string, 4>> ParseValues(
       Pos* end_pos = nullptr);
@@ -408,6 +455,36 @@ class Parser {
   std::optional<absl::flat_hash_set<std::string>> kind_allowlist_;
 };
 
+// Index of the cell groups of a library. Building the index scans the text
+// once without keeping the contents of any cell; a cell's group is only parsed
+// when it is requested. Together with CharStream::FromMappedFile this makes
+// pulling a few cells out of a very large library cheap in both time and
+// memory.
+class CellIndex {
+ public:
+  // Indexes the library in `stream`, which must not have been created with
+  // CharStream::FromPath.
+  static absl::StatusOr<CellIndex> Create(CharStream stream);
+
+  // Names of the cells, in order of appearance.
+  absl::Span<const std::string> cell_names() const { return cell_names_; }
+  bool HasCell(std::string_view name) const { return extents_.contains(name); }
+
+  // Parses the group of the cell `name`; see Parser for `kind_allowlist`.
+  // Returns a NOT_FOUND error if there is no such cell.
+  absl::StatusOr<std::unique_ptr<Block>> ParseCell(
+      std::string_view name,
+      std::optional<absl::flat_hash_set<std::string>> kind_allowlist =
+          std::nullopt) const;
+
+ private:
+  explicit CellIndex(CharStream stream) : stream_(std::move(stream)) {}
+
+  CharStream stream_;
+  std::vector<std::string> cell_names_;
+  absl::flat_hash_map<std::string, Parser::CellExtent> extents_;
+};
+
 }  // namespace cell_lib
 }  // namespace netlist
 }  // namespace xls
@@ -18,10 +18,14 @@
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/file/temp_file.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
 
@@ -30,6 +34,9 @@ namespace netlist {
 namespace cell_lib {
 namespace {
 
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+
 TEST(LibParserTest, ScanSimple) {
   std::string text = "{}()";
   XLS_ASSERT_OK_AND_ASSIGN(auto cs, CharStream::FromText(text));
@@ -162,6 +169,69 @@ library (foo) {
             "))");
 }
 
+TEST(LibParserTest, CellIndexParsesCellsOnDemand) {
+  std::string text = R"(
+library (foo) {
+  some_attribute: "value";
+  lu_table_template (t) {
+    variable_1: input_net_transition;
+  }
+  cell (AND2) {
+    pin (A) {
+      direction: input;
+    }
+    pin (Y) {
+      direction: output;
+      function: "A&B";
+      timing () { values ("{0}, {1}"); }
+    }
+  }
+  cell (EMPTY);
+  cell (INV) {
+    pin (Y) {
+      direction: output;
+      function: "!A";
+    }
+  }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Block> library, Parse(text));
+  XLS_ASSERT_OK_AND_ASSIGN(auto cs, CharStream::FromText(text));
+  XLS_ASSERT_OK_AND_ASSIGN(CellIndex index, CellIndex::Create(std::move(cs)));
+  EXPECT_THAT(index.cell_names(), ElementsAre("AND2", "EMPTY", "INV"));
+  EXPECT_FALSE(index.HasCell("OR2"));
+  EXPECT_THAT(index.ParseCell("OR2"),
+              StatusIs(absl::StatusCode::kNotFound));
+
+  // Each lazily-parsed cell matches its block from a full parse.
+  std::vector<const Block*> cells = library->GetSubBlocks("cell");
+  ASSERT_EQ(cells.size(), 3);
+  for (const Block* cell : cells) {
+    XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Block> parsed,
+                             index.ParseCell(cell->args[0]));
+    EXPECT_EQ(parsed->ToString(), cell->ToString());
+  }
+}
+
+TEST(LibParserTest, MappedFileMatchesText) {
+  std::string text = R"(
+library (foo) {
+  cell (INV) {
+    pin (Y) { direction: output; function: "!A"; }
+  }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(TempFile file, TempFile::CreateWithContent(text));
+  XLS_ASSERT_OK_AND_ASSIGN(CharStream cs,
+                           CharStream::FromMappedFile(file.path().string()));
+  Scanner scanner(&cs);
+  Parser parser(&scanner);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Block> library,
+                           parser.ParseLibrary());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string expected, ParseToString(text));
+  EXPECT_EQ(library->ToString(), expected);
+}
+
 }  // namespace
 }  // namespace cell_lib
 }  // namespace netlist
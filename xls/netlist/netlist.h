@@ -28,7 +28,9 @@
 #include <string_view>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -39,6 +41,7 @@
 #include "absl/strings/str_split.h"
 #include "absl/strings/strip.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/types/span.h"
 #include "xls/common/bits_util.h"
 #include "xls/common/status/status_macros.h"
@@ -515,8 +518,11 @@ class AbstractNetlist {
  private:
   // The AbstractNetlist itself manages the CellLibraryEntries corresponding to
   // the LUT4 cells that are used, which are identified by their LUT mask (i.e.
-  // the 16 bit LUT_INIT parameter).
-  absl::flat_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_;
+  // the 16 bit LUT_INIT parameter). Cells point at these entries, so they need
+  // pointer stability; the lock allows modules to be parsed concurrently.
+  absl::Mutex lut_cells_mutex_;
+  absl::node_hash_map<uint16_t, AbstractCellLibraryEntry<EvalT>> lut_cells_
+      ABSL_GUARDED_BY(lut_cells_mutex_);
   std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules_;
 };
 
@@ -853,6 +859,7 @@ AbstractNetlist<EvalT>::GetOrCreateLut4CellEntry(int64_t lut_mask, EvalT zero,
     return absl::InvalidArgumentError("Mask for LUT4 must be 16 bits");
   }
   uint16_t mask = static_cast<uint16_t>(lut_mask);
+  absl::MutexLock lock(&lut_cells_mutex_);
   auto it = lut_cells_.find(mask);
   if (it == lut_cells_.end()) {
     AbstractCellLibraryEntry<EvalT> entry(
@@ -14,9 +14,21 @@
 
 // Driver for NetlistInterpreter: loads a netlist from disk, feeds Value input
 // (taken from the command line) into it, and prints the result.
+//
+// With --input_file, each line of the file is a separate input with the same
+// format as --input; the inputs are evaluated 64 at a time by the levelized,
+// bit-parallel interpreter and one result is printed per line. With --jit, the
+// module is compiled to native code instead and simulated for --cycles clock
+// cycles per batch.
 
+#include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -31,6 +43,7 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -41,15 +54,24 @@
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/function_extractor.h"
 #include "xls/netlist/interpreter.h"
+#include "xls/netlist/levelized_interpreter.h"
 #include "xls/netlist/lib_parser.h"
 #include "xls/netlist/netlist.h"
 #include "xls/netlist/netlist.pb.h"
+#include "xls/netlist/netlist_jit.h"
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(std::string, cell_library, "",
           "Cell library to use for interpretation.");
 ABSL_FLAG(std::string, cell_library_proto, "",
           "Preprocessed cell library proto to use for interpretation.");
+ABSL_FLAG(bool, lazy_cell_library, true,
+          "Memory-map --cell_library and only extract the cells the netlist "
+          "uses, instead of parsing the whole library up front.");
+ABSL_FLAG(std::string, cell_library_proto_out, "",
+          "If set, writes the cell library entries used by the netlist to this "
+          "path in the format of --cell_library_proto, so that later runs can "
+          "skip parsing --cell_library.");
 // TODO(rspringer): Eliminate the need for this flag.
 // This one is a hidden temporary flag until we can properly handle cells
 // with state_function attributes (e.g., some latches).
@@ -60,6 +82,21 @@ ABSL_FLAG(std::string, input, "",
           "The input to the function as a semicolon-separated list of typed "
           "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\". "
           "Values must be listed in the same order as the module inputs.");
+ABSL_FLAG(std::string, input_file, "",
+          "Path to a file with one input per line, each in the format of "
+          "--input. Inputs are evaluated in batches of 64 by the levelized "
+          "interpreter, which only supports flat netlists.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads the levelized interpreter uses to evaluate the "
+          "cells of a level in parallel. Only used with --input_file.");
+ABSL_FLAG(bool, jit, false,
+          "Compile the netlist to native code with the LLVM JIT instead of "
+          "using the levelized interpreter. Flops and state tables are "
+          "simulated as registers. Only used with --input_file.");
+ABSL_FLAG(int64_t, cycles, 1,
+          "With --jit, the number of clock cycles each batch of inputs is "
+          "applied for, starting from all-zero registers; the outputs of the "
+          "last cycle are printed.");
 ABSL_FLAG(std::string, output_type, "",
           "Type of the value as an XLS-formatted string. If un-set, then the "
           "output will be printed as flat uninterpreted bits.");
@@ -78,6 +115,9 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
     XLS_RET_CHECK(lib_proto.ParseFromString(proto_text));
     return netlist::CellLibrary::FromProto(lib_proto);
   }
+  if (absl::GetFlag(FLAGS_lazy_cell_library)) {
+    return netlist::function::MakeLazyCellLibrary(cell_library_path);
+  }
   XLS_ASSIGN_OR_RETURN(std::string cell_library_text,
                        GetFileContents(cell_library_path));
   XLS_ASSIGN_OR_RETURN(
@@ -88,36 +128,20 @@ static absl::StatusOr<netlist::CellLibrary> GetCellLibrary(
   return netlist::CellLibrary::FromProto(lib_proto);
 }
 
-static absl::Status RealMain(const std::string& netlist_path,
-                             const std::string& cell_library_path,
-                             const std::string& cell_library_proto_path,
-                             const std::string& module_name,
-                             absl::Span<const std::string> inputs,
-                             const std::string& output_type_string,
-                             absl::Span<const std::string> dump_cells) {
-  XLS_ASSIGN_OR_RETURN(
-      netlist::CellLibrary cell_library,
-      GetCellLibrary(cell_library_path, cell_library_proto_path));
-
-  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
-                                         &cell_library, &scanner));
-  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
-
-  // Input values are listed in the same order as inputs are declared by
-  // the netlist module declaration, which may be different from the order of
-  // Module::inputs().  For example:
-  //
-  //  module ifte(i, t, e, out);
-  //    input [7:0] e;
-  //    input i;
-  //    output [7:0] out;
-  //    input [7:0] t;
-  //
-  // The values of --inputs should follow the module declaration, which would
-  // also follow the declaration of the source language (e.g. C++ or XLS).
-
+// Input values are listed in the same order as inputs are declared by the
+// netlist module declaration, which may be different from the order of
+// Module::inputs().  For example:
+//
+//  module ifte(i, t, e, out);
+//    input [7:0] e;
+//    input i;
+//    output [7:0] out;
+//    input [7:0] t;
+//
+// The values of --inputs should follow the module declaration, which would
+// also follow the declaration of the source language (e.g. C++ or XLS).
+static absl::StatusOr<netlist::NetRef2Value> GetInputNets(
+    const netlist::rtl::Module* module, absl::Span<const std::string> inputs) {
   Bits input_bits;
   for (const auto& input_string : inputs) {
     XLS_ASSIGN_OR_RETURN(Value input, Parser::ParseTypedValue(input_string));
@@ -134,14 +158,16 @@ static absl::Status RealMain(const std::string& netlist_path,
     const netlist::rtl::NetRef in = module_inputs[i];
     input_nets[in] = input_bits.Get(module->GetInputPortOffset(in->name()));
   }
+  return input_nets;
+}
 
-  netlist::Interpreter interpreter(netlist.get());
-  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
-                                             module, input_nets, dump_cells));
-
+static absl::StatusOr<std::string> FormatOutput(
+    const netlist::rtl::Module* module,
+    const netlist::NetRef2Value& output_nets,
+    const std::string& output_type_string) {
   BitsRope rope(output_nets.size());
   for (const netlist::rtl::NetRef ref : module->outputs()) {
-    rope.push_back(output_nets[ref]);
+    rope.push_back(output_nets.at(ref));
   }
   Bits output_bits = rope.Build();
 
@@ -156,8 +182,128 @@ static absl::Status RealMain(const std::string& netlist_path,
   } else {
     output = Value(output_bits);
   }
+  return output.ToString(FormatPreference::kHex);
+}
+
+// Evaluates each line of `input_file_path` and prints the results in order.
+static absl::Status InterpretInputFile(const netlist::rtl::Netlist* netlist,
+                                       const netlist::rtl::Module* module,
+                                       const std::string& input_file_path,
+                                       const std::string& output_type_string,
+                                       int64_t threads, bool jit,
+                                       int64_t cycles) {
+  using netlist::LevelizedInterpreter;
+  std::unique_ptr<LevelizedInterpreter> interpreter;
+  std::unique_ptr<netlist::NetlistJit> netlist_jit;
+  std::optional<ThreadPool> thread_pool;
+  std::function<absl::StatusOr<netlist::NetRef2Lanes>(
+      const netlist::NetRef2Lanes&)>
+      evaluate;
+  if (jit) {
+    XLS_RET_CHECK_GE(cycles, 1);
+    XLS_ASSIGN_OR_RETURN(netlist_jit,
+                         netlist::NetlistJit::Create(netlist, module));
+    evaluate = [&](const netlist::NetRef2Lanes& inputs)
+        -> absl::StatusOr<netlist::NetRef2Lanes> {
+      netlist_jit->Reset();
+      netlist::NetRef2Lanes outputs;
+      for (int64_t cycle = 0; cycle < cycles; ++cycle) {
+        XLS_ASSIGN_OR_RETURN(outputs, netlist_jit->RunCycle(inputs));
+      }
+      return outputs;
+    };
+  } else {
+    XLS_ASSIGN_OR_RETURN(interpreter,
+                         LevelizedInterpreter::Create(netlist, module));
+    if (threads > 1) {
+      thread_pool.emplace(threads);
+    }
+    evaluate = [&](const netlist::NetRef2Lanes& inputs) {
+      return interpreter->InterpretModule(
+          inputs, thread_pool.has_value() ? &*thread_pool : nullptr);
+    };
+  }
+
+  XLS_ASSIGN_OR_RETURN(std::string input_text,
+                       GetFileContents(input_file_path));
+  std::vector<std::string_view> lines =
+      absl::StrSplit(input_text, '\n', absl::SkipWhitespace());
+  for (int64_t begin = 0; begin < lines.size();
+       begin += LevelizedInterpreter::kLanes) {
+    const int64_t end = std::min<int64_t>(
+        begin + LevelizedInterpreter::kLanes, lines.size());
 
-  std::cout << output.ToString(FormatPreference::kHex) << '\n';
+    // Pack the inputs of each line into its own lane.
+    netlist::NetRef2Lanes input_lanes;
+    for (const netlist::rtl::NetRef in : module->inputs()) {
+      input_lanes[in] = 0;
+    }
+    for (int64_t lane = 0; lane < end - begin; ++lane) {
+      std::vector<std::string> inputs =
+          absl::StrSplit(lines[begin + lane], ';');
+      XLS_ASSIGN_OR_RETURN(netlist::NetRef2Value input_nets,
+                           GetInputNets(module, inputs));
+      for (const auto& [net, value] : input_nets) {
+        input_lanes[net] |= static_cast<uint64_t>(value) << lane;
+      }
+    }
+
+    XLS_ASSIGN_OR_RETURN(netlist::NetRef2Lanes output_lanes,
+                         evaluate(input_lanes));
+    for (int64_t lane = 0; lane < end - begin; ++lane) {
+      netlist::NetRef2Value output_nets;
+      for (const auto& [net, value] : output_lanes) {
+        output_nets[net] = (value >> lane) & 1;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          std::string output,
+          FormatOutput(module, output_nets, output_type_string));
+      std::cout << output << '\n';
+    }
+  }
+  return absl::OkStatus();
+}
+
+static absl::Status RealMain(const std::string& netlist_path,
+                             const std::string& cell_library_path,
+                             const std::string& cell_library_proto_path,
+                             const std::string& module_name,
+                             absl::Span<const std::string> inputs,
+                             const std::string& input_file_path,
+                             const std::string& output_type_string,
+                             absl::Span<const std::string> dump_cells,
+                             int64_t threads, bool jit, int64_t cycles) {
+  XLS_ASSIGN_OR_RETURN(
+      netlist::CellLibrary cell_library,
+      GetCellLibrary(cell_library_path, cell_library_proto_path));
+
+  XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSIGN_OR_RETURN(auto netlist, netlist::rtl::Parser::ParseNetlist(
+                                         &cell_library, &scanner));
+  XLS_ASSIGN_OR_RETURN(const auto* module, netlist->GetModule(module_name));
+
+  if (std::string proto_out = absl::GetFlag(FLAGS_cell_library_proto_out);
+      !proto_out.empty()) {
+    XLS_ASSIGN_OR_RETURN(netlist::CellLibraryProto lib_proto,
+                         cell_library.ToProto());
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(proto_out, lib_proto.SerializeAsString()));
+  }
+
+  if (!input_file_path.empty()) {
+    return InterpretInputFile(netlist.get(), module, input_file_path,
+                              output_type_string, threads, jit, cycles);
+  }
+
+  XLS_ASSIGN_OR_RETURN(netlist::NetRef2Value input_nets,
+                       GetInputNets(module, inputs));
+  netlist::Interpreter interpreter(netlist.get());
+  XLS_ASSIGN_OR_RETURN(auto output_nets, interpreter.InterpretModule(
+                                             module, input_nets, dump_cells));
+  XLS_ASSIGN_OR_RETURN(std::string output,
+                       FormatOutput(module, output_nets, output_type_string));
+  std::cout << output << '\n';
   return absl::OkStatus();
 }
 
@@ -179,15 +325,26 @@ int main(int argc, char* argv[]) {
   QCHECK(!module_name.empty()) << "--module_name must be specified.";
 
   std::string input = absl::GetFlag(FLAGS_input);
-  QCHECK(!input.empty()) << "--input must be specified.";
-  std::vector<std::string> inputs = absl::StrSplit(input, ';');
+  std::string input_file = absl::GetFlag(FLAGS_input_file);
+  QCHECK(!input.empty() ^ !input_file.empty())
+      << "One (and only one) of --input or --input_file must be specified.";
+  std::vector<std::string> inputs;
+  if (!input.empty()) {
+    inputs = absl::StrSplit(input, ';');
+  }
 
   std::string dump_cells_str = absl::GetFlag(FLAGS_dump_cells);
+  QCHECK(input_file.empty() || dump_cells_str.empty())
+      << "--dump_cells is not supported with --input_file.";
   std::vector<std::string> dump_cells = absl::StrSplit(dump_cells_str, ',');
 
   std::string output_type = absl::GetFlag(FLAGS_output_type);
 
-  return xls::ExitStatus(xls::RealMain(netlist_path, cell_library_path,
-                                       cell_library_proto_path, module_name,
-                                       inputs, output_type, dump_cells));
+  bool jit = absl::GetFlag(FLAGS_jit);
+  QCHECK(!jit || !input_file.empty()) << "--jit requires --input_file.";
+
+  return xls::ExitStatus(xls::RealMain(
+      netlist_path, cell_library_path, cell_library_proto_path, module_name,
+      inputs, input_file, output_type, dump_cells,
+      absl::GetFlag(FLAGS_threads), jit, absl::GetFlag(FLAGS_cycles)));
 }
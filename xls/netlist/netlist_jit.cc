@@ -0,0 +1,393 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/netlist/netlist_jit.h"
+
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/BasicBlock.h"
+#include "llvm/include/llvm/IR/DerivedTypes.h"
+#include "llvm/include/llvm/IR/Function.h"
+#include "llvm/include/llvm/IR/IRBuilder.h"
+#include "llvm/include/llvm/IR/LLVMContext.h"
+#include "llvm/include/llvm/IR/Module.h"
+#include "llvm/include/llvm/IR/Type.h"
+#include "llvm/include/llvm/IR/Value.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/compiled_cell_function.h"
+#include "xls/netlist/levelize.h"
+#include "xls/netlist/levelized_interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+constexpr std::string_view kFunctionName = "netlist_cycle";
+
+// A cell prepared for code generation.
+struct JitCell {
+  struct Output {
+    // Index of the net written by this output pin.
+    int64_t net;
+    // Index of the register holding the pin value, for flops.
+    int64_t reg = -1;
+    CompiledCellFunction function;
+  };
+
+  const rtl::Cell* cell;
+  // Whether the outputs are registers updated at the end of the cycle.
+  bool is_flop = false;
+  // Net indices of the inputs of the cell library entry, in the order of its
+  // input_names().
+  std::vector<int64_t> inputs;
+  // Index of the register holding each internal pin, in the order of
+  // cell->internal_pins().
+  std::vector<int64_t> internal_regs;
+  std::vector<Output> outputs;
+};
+
+// Builds word operations for CompiledCellFunction::Build.
+struct WordOps {
+  llvm::IRBuilder<>& builder;
+
+  llvm::Value* Zero() { return builder.getInt64(0); }
+  llvm::Value* One() { return builder.getInt64(~uint64_t{0}); }
+  llvm::Value* Not(llvm::Value* a) { return builder.CreateNot(a); }
+  llvm::Value* And(llvm::Value* a, llvm::Value* b) {
+    return builder.CreateAnd(a, b);
+  }
+  llvm::Value* Or(llvm::Value* a, llvm::Value* b) {
+    return builder.CreateOr(a, b);
+  }
+  llvm::Value* Xor(llvm::Value* a, llvm::Value* b) {
+    return builder.CreateXor(a, b);
+  }
+  // Selects `on_true` in the lanes where `selector` is set.
+  llvm::Value* Select(llvm::Value* selector, llvm::Value* on_true,
+                      llvm::Value* on_false) {
+    return Or(And(selector, on_true), And(Not(selector), on_false));
+  }
+};
+
+llvm::Value* WordPointer(llvm::IRBuilder<>& builder, llvm::Value* array,
+                         int64_t index) {
+  return builder.CreateConstGEP1_64(builder.getInt64Ty(), array, index);
+}
+
+llvm::Value* LoadWord(llvm::IRBuilder<>& builder, llvm::Value* array,
+                      int64_t index) {
+  return builder.CreateLoad(builder.getInt64Ty(),
+                            WordPointer(builder, array, index));
+}
+
+void StoreWord(llvm::IRBuilder<>& builder, llvm::Value* value,
+               llvm::Value* array, int64_t index) {
+  builder.CreateStore(value, WordPointer(builder, array, index));
+}
+
+// Returns the next value of the internal signal `signal` of a state table
+// cell. `signals` holds the values of the cell inputs and the current values
+// of its internal signals.
+absl::StatusOr<llvm::Value*> BuildStateTableSignal(
+    const rtl::Cell& cell, const StateTable& table, const std::string& signal,
+    const absl::flat_hash_map<std::string, llvm::Value*>& signals,
+    WordOps& ops) {
+  llvm::Value* current = signals.at(signal);
+  // Lanes matching no row keep their value. Earlier rows take precedence, so
+  // fold the rows from last to first.
+  llvm::Value* next = current;
+  for (auto row = table.rows().rbegin(); row != table.rows().rend(); ++row) {
+    auto response = row->response.find(signal);
+    if (response == row->response.end()) {
+      continue;
+    }
+    llvm::Value* match = ops.One();
+    for (const auto& [name, stimulus] : row->stimulus) {
+      auto it = signals.find(name);
+      if (it == signals.end()) {
+        if (stimulus == StateTableSignal::kDontCare) {
+          continue;
+        }
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "State table of cell %s reads signal %s, which is neither an input "
+            "nor an internal signal of the cell.",
+            cell.name(), name));
+      }
+      switch (stimulus) {
+        case StateTableSignal::kLow:
+          match = ops.And(match, ops.Not(it->second));
+          break;
+        case StateTableSignal::kHigh:
+          match = ops.And(match, it->second);
+          break;
+        case StateTableSignal::kDontCare:
+        case StateTableSignal::kHighOrLow:
+        case StateTableSignal::kLowOrHigh:
+          break;
+        default:
+          return absl::UnimplementedError(absl::StrFormat(
+              "State table of cell %s has a transition or undefined signal, "
+              "which the netlist JIT does not support.",
+              cell.name()));
+      }
+    }
+
+    // As in AbstractStateTable::GetSignalValue, a "switched" stimulus keeps
+    // the value if the response is the same and inverts it otherwise.
+    llvm::Value* value;
+    auto stimulus = row->stimulus.find(signal);
+    if (stimulus != row->stimulus.end() &&
+        (stimulus->second == StateTableSignal::kLowOrHigh ||
+         stimulus->second == StateTableSignal::kHighOrLow)) {
+      value = stimulus->second == response->second ? current
+                                                   : ops.Not(current);
+    } else if (response->second == StateTableSignal::kNoChange) {
+      value = current;
+    } else {
+      value = response->second == StateTableSignal::kHigh ? ops.One()
+                                                          : ops.Zero();
+    }
+    next = ops.Select(match, value, next);
+  }
+  return next;
+}
+
+}  // namespace
+
+NetlistJit::~NetlistJit() = default;
+
+absl::StatusOr<std::unique_ptr<NetlistJit>> NetlistJit::Create(
+    const rtl::Netlist* netlist, const rtl::Module* module,
+    int64_t opt_level) {
+  XLS_ASSIGN_OR_RETURN(Levelization levelization,
+                       Levelize(*module, /*flops_are_registers=*/true));
+  const absl::flat_hash_map<rtl::NetRef, int64_t>& net_index =
+      levelization.net_index;
+
+  // Prepare each cell, in the order of module->cells(), allocating the
+  // registers.
+  std::vector<JitCell> cells;
+  int64_t register_count = 0;
+  for (const auto& cell : module->cells()) {
+    const CellLibraryEntry* entry = cell->cell_library_entry();
+    if (netlist->MaybeGetModule(entry->name()).has_value()) {
+      return absl::UnimplementedError(absl::StrFormat(
+          "Cell %s instantiates module %s; the netlist JIT only supports flat "
+          "netlists.",
+          cell->name(), entry->name()));
+    }
+
+    JitCell jit_cell{.cell = cell.get()};
+    // Flops with state tables are modeled by their tables.
+    jit_cell.is_flop =
+        cell->kind() == CellKind::kFlop && cell->internal_pins().empty();
+    for (const rtl::Cell::Pin& input : cell->inputs()) {
+      jit_cell.inputs.push_back(net_index.at(input.netref));
+    }
+    // Functions of state table cells may read the internal signals, which
+    // follow the inputs.
+    std::vector<std::string> signal_names(entry->input_names().begin(),
+                                          entry->input_names().end());
+    for (const rtl::Cell::Pin& internal : cell->internal_pins()) {
+      signal_names.push_back(internal.name);
+      jit_cell.internal_regs.push_back(register_count++);
+    }
+
+    for (const rtl::Cell::OutputPin& output : cell->outputs()) {
+      if (output.netref == nullptr || output.netref == module->GetDummyRef()) {
+        continue;
+      }
+      if (output.eval != nullptr) {
+        return absl::UnimplementedError(absl::StrFormat(
+            "Pin %s of cell %s has a custom evaluation function, which the "
+            "netlist JIT does not support.",
+            output.name, cell->name()));
+      }
+      const CompiledCellFunction* shared =
+          cell->internal_pins().empty()
+              ? entry->GetCompiledFunction(output.name)
+              : nullptr;
+      std::optional<CompiledCellFunction> function;
+      if (shared != nullptr) {
+        function = *shared;
+      } else {
+        absl::StatusOr<CompiledCellFunction> compiled =
+            CompiledCellFunction::Compile(
+                entry->output_pin_to_function().at(output.name), signal_names);
+        if (!compiled.ok()) {
+          return absl::UnimplementedError(absl::StrFormat(
+              "Function of pin %s of cell %s isn't supported by the netlist "
+              "JIT: %s",
+              output.name, cell->name(), compiled.status().message()));
+        }
+        function = *std::move(compiled);
+      }
+      JitCell::Output& jit_output = jit_cell.outputs.emplace_back(
+          JitCell::Output{.net = net_index.at(output.netref),
+                          .function = *std::move(function)});
+      if (jit_cell.is_flop) {
+        jit_output.reg = register_count++;
+      }
+    }
+    cells.push_back(std::move(jit_cell));
+  }
+
+  // Generate the function.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<OrcJit> jit, OrcJit::Create(opt_level));
+  llvm::LLVMContext& context = *jit->GetContext();
+  std::unique_ptr<llvm::Module> llvm_module =
+      jit->NewModule(absl::StrFormat("netlist_%s", module->name()));
+  llvm::Type* ptr_type = llvm::PointerType::get(context, 0);
+  llvm::FunctionType* function_type = llvm::FunctionType::get(
+      llvm::Type::getVoidTy(context), {ptr_type, ptr_type, ptr_type},
+      /*isVarArg=*/false);
+  llvm::Function* fn = llvm::Function::Create(
+      function_type, llvm::Function::ExternalLinkage, kFunctionName,
+      llvm_module.get());
+  llvm::Value* inputs_arg = fn->getArg(0);
+  llvm::Value* outputs_arg = fn->getArg(1);
+  llvm::Value* state_arg = fn->getArg(2);
+  inputs_arg->setName("inputs");
+  outputs_arg->setName("outputs");
+  state_arg->setName("state");
+  llvm::IRBuilder<> builder(llvm::BasicBlock::Create(context, "entry", fn));
+  WordOps ops{.builder = builder};
+
+  std::vector<llvm::Value*> values(net_index.size(), nullptr);
+  values[net_index.at(module->zero())] = ops.Zero();
+  values[net_index.at(module->one())] = ops.One();
+  for (int64_t i = 0; i < module->inputs().size(); ++i) {
+    values[net_index.at(module->inputs()[i])] =
+        LoadWord(builder, inputs_arg, i);
+  }
+  for (const JitCell& cell : cells) {
+    if (cell.is_flop) {
+      for (const JitCell::Output& output : cell.outputs) {
+        values[output.net] = LoadWord(builder, state_arg, output.reg);
+      }
+    }
+  }
+
+  // Each level only reads nets computed by the levels before it, so the
+  // levels in turn are a topological order of the combinational cells.
+  std::vector<int64_t> order;
+  for (const std::vector<int64_t>& level : levelization.levels) {
+    absl::c_copy(level, std::back_inserter(order));
+  }
+  std::vector<llvm::Value*> args;
+  for (int64_t c : order) {
+    const JitCell& cell = cells[c];
+    args.clear();
+    for (int64_t net : cell.inputs) {
+      args.push_back(values[net]);
+    }
+    if (!cell.internal_regs.empty()) {
+      const StateTable& table = *cell.cell->cell_library_entry()->state_table();
+      absl::Span<const std::string> input_names =
+          cell.cell->cell_library_entry()->input_names();
+      absl::flat_hash_map<std::string, llvm::Value*> signals;
+      for (int64_t i = 0; i < input_names.size(); ++i) {
+        signals[input_names[i]] = args[i];
+      }
+      absl::Span<const rtl::Cell::Pin> internal_pins =
+          cell.cell->internal_pins();
+      for (int64_t i = 0; i < internal_pins.size(); ++i) {
+        signals[internal_pins[i].name] =
+            LoadWord(builder, state_arg, cell.internal_regs[i]);
+      }
+      for (int64_t i = 0; i < internal_pins.size(); ++i) {
+        XLS_ASSIGN_OR_RETURN(
+            llvm::Value * next,
+            BuildStateTableSignal(*cell.cell, table, internal_pins[i].name,
+                                  signals, ops));
+        StoreWord(builder, next, state_arg, cell.internal_regs[i]);
+        args.push_back(next);
+      }
+    }
+    for (const JitCell::Output& output : cell.outputs) {
+      values[output.net] = output.function.Build<llvm::Value*>(args, ops);
+    }
+  }
+
+  for (int64_t i = 0; i < levelization.output_sources.size(); ++i) {
+    StoreWord(builder, values[levelization.output_sources[i]], outputs_arg, i);
+  }
+  // The flops capture their next values after every read of the current ones.
+  for (const JitCell& cell : cells) {
+    if (!cell.is_flop) {
+      continue;
+    }
+    args.clear();
+    for (int64_t net : cell.inputs) {
+      args.push_back(values[net]);
+    }
+    for (const JitCell::Output& output : cell.outputs) {
+      StoreWord(builder, output.function.Build<llvm::Value*>(args, ops),
+                state_arg, output.reg);
+    }
+  }
+  builder.CreateRetVoid();
+
+  XLS_RETURN_IF_ERROR(jit->CompileModule(std::move(llvm_module)));
+  XLS_ASSIGN_OR_RETURN(llvm::orc::ExecutorAddr address,
+                       jit->LoadSymbol(kFunctionName));
+  std::unique_ptr<NetlistJit> netlist_jit(
+      new NetlistJit(module, std::move(jit)));
+  netlist_jit->function_ = address.toPtr<JitFunction>();
+  netlist_jit->state_.assign(register_count, 0);
+  return std::move(netlist_jit);
+}
+
+absl::StatusOr<NetRef2Lanes> NetlistJit::RunCycle(const NetRef2Lanes& inputs) {
+  std::vector<uint64_t> input_words;
+  input_words.reserve(module_->inputs().size());
+  for (const rtl::NetRef input : module_->inputs()) {
+    auto it = inputs.find(input);
+    XLS_RET_CHECK(it != inputs.end())
+        << "No value given for module input " << input->name();
+    input_words.push_back(it->second);
+  }
+  std::vector<uint64_t> output_words(module_->outputs().size());
+  function_(input_words.data(), output_words.data(), state_.data());
+
+  NetRef2Lanes outputs;
+  outputs.reserve(output_words.size());
+  for (int64_t i = 0; i < output_words.size(); ++i) {
+    outputs.emplace(module_->outputs()[i], output_words[i]);
+  }
+  return outputs;
+}
+
+void NetlistJit::Reset() { absl::c_fill(state_, 0); }
+
+}  // namespace netlist
+}  // namespace xls
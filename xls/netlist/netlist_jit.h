@@ -0,0 +1,94 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_NETLIST_NETLIST_JIT_H_
+#define XLS_NETLIST_NETLIST_JIT_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/netlist/levelized_interpreter.h"
+#include "xls/netlist/netlist.h"
+
+namespace xls {
+namespace netlist {
+
+// Compiles a flat netlist module to native code with the LLVM JIT.
+//
+// The combinational logic between the module inputs, the registers and the
+// module outputs is emitted as a single function of 64-bit word operations, so
+// that, like LevelizedInterpreter, each call evaluates 64 independent input
+// vectors (see NetRef2Lanes). Cell logic is generated from the same compiled
+// cell functions (compiled_cell_function.h) the interpreters evaluate.
+//
+// Unlike the interpreters, which treat every cell as combinational, the
+// module is simulated cycle by cycle:
+//
+//  * Flops (cells of CellKind::kFlop) are registers: during a cycle their
+//    outputs hold the values their functions computed at the end of the
+//    previous cycle.
+//  * State table internal signals are registers too: each cycle they take the
+//    response of the first table row matching the cell inputs and their
+//    current values, and keep their values when that response is "no change"
+//    or no row matches. Output pins read the updated values.
+//
+// Cells which are themselves modules of the netlist and cells with custom
+// output evaluation functions are not supported; flatten the netlist first.
+class NetlistJit {
+ public:
+  static constexpr int64_t kLanes = LevelizedInterpreter::kLanes;
+
+  // Compiles `module`, which must belong to `netlist` and outlive the JIT. All
+  // registers start out zero.
+  static absl::StatusOr<std::unique_ptr<NetlistJit>> Create(
+      const rtl::Netlist* netlist, const rtl::Module* module,
+      int64_t opt_level = OrcJit::kDefaultOptLevel);
+
+  ~NetlistJit();
+
+  // Evaluates one clock cycle. `inputs` must contain a value for every module
+  // input. Returns the values of the module outputs during the cycle; the
+  // registers are then updated for the next one.
+  absl::StatusOr<NetRef2Lanes> RunCycle(const NetRef2Lanes& inputs);
+
+  // Clears every register in every lane.
+  void Reset();
+
+  // The number of flop outputs and state table signals kept across cycles.
+  int64_t register_count() const { return state_.size(); }
+
+ private:
+  // Signature of the generated function. `inputs` and `outputs` are in the
+  // order of the module's inputs() and outputs().
+  using JitFunction = void (*)(const uint64_t* inputs, uint64_t* outputs,
+                               uint64_t* state);
+
+  NetlistJit(const rtl::Module* module, std::unique_ptr<OrcJit> jit)
+      : module_(module), jit_(std::move(jit)) {}
+
+  const rtl::Module* module_;
+  std::unique_ptr<OrcJit> jit_;
+  JitFunction function_ = nullptr;
+  std::vector<uint64_t> state_;
+};
+
+}  // namespace netlist
+}  // namespace xls
+
+#endif  // XLS_NETLIST_NETLIST_JIT_H_
@@ -0,0 +1,221 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/netlist/netlist_jit.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "google/protobuf/text_format.h"
+#include "xls/common/status/matchers.h"
+#include "xls/netlist/cell_library.h"
+#include "xls/netlist/fake_cell_library.h"
+#include "xls/netlist/levelized_interpreter.h"
+#include "xls/netlist/netlist.h"
+#include "xls/netlist/netlist.pb.h"
+#include "xls/netlist/netlist_parser.h"
+
+namespace xls {
+namespace netlist {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+TEST(NetlistJitTest, MatchesLevelizedInterpreter) {
+  std::string module_text = R"(
+module main(i0, i1, i2, i3, o0, o1, o2);
+  input i0, i1, i2, i3;
+  output o0, o1, o2;
+  wire and_o, or_o, inv_o;
+
+  AND and0 ( .A(i0), .B(i1), .Z(and_o) );
+  OR or0 ( .A(i2), .B(i3), .Z(or_o) );
+  INV inv0 ( .A(and_o), .ZN(inv_o) );
+  AOI21 aoi0 ( .A(inv_o), .B(or_o), .C(i0), .ZN(o0) );
+  XOR xor0 ( .A(and_o), .B(or_o), .Z(o1) );
+  assign o2 = i3;
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlistJit> jit,
+                           NetlistJit::Create(netlist.get(), module));
+  EXPECT_EQ(jit->register_count(), 0);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<LevelizedInterpreter> levelized,
+      LevelizedInterpreter::Create(netlist.get(), module));
+
+  NetRef2Lanes inputs;
+  uint64_t state = 0x9e3779b97f4a7c15;
+  for (const rtl::NetRef input : module->inputs()) {
+    state = state * 6364136223846793005 + 1442695040888963407;
+    inputs[input] = state;
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes expected,
+                           levelized->InterpretModule(inputs));
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes actual, jit->RunCycle(inputs));
+  EXPECT_EQ(actual, expected);
+}
+
+// A flop fed back through an inverter toggles every cycle; the flop breaks
+// what would otherwise be a combinational cycle.
+TEST(NetlistJitTest, FlopsHoldValuesAcrossCycles) {
+  std::string module_text = R"(
+module main(i0, q, d);
+  input i0;
+  output q, d;
+  wire nq;
+
+  DFF dff0 ( .D(nq), .Q(q) );
+  INV inv0 ( .A(q), .ZN(nq) );
+  DFF dff1 ( .D(i0), .Q(d) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlistJit> jit,
+                           NetlistJit::Create(netlist.get(), module));
+  EXPECT_EQ(jit->register_count(), 2);
+
+  const rtl::NetRef i0 = module->inputs()[0];
+  const rtl::NetRef q = module->outputs()[0];
+  const rtl::NetRef d = module->outputs()[1];
+  const uint64_t kValues[] = {0x0123456789abcdef, 0xfedcba9876543210, 0};
+  uint64_t previous = 0;
+  for (int64_t cycle = 0; cycle < 3; ++cycle) {
+    XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes outputs,
+                             jit->RunCycle({{i0, kValues[cycle]}}));
+    EXPECT_EQ(outputs.at(q), cycle % 2 == 0 ? 0 : ~uint64_t{0});
+    EXPECT_EQ(outputs.at(d), previous);
+    previous = kValues[cycle];
+  }
+
+  jit->Reset();
+  XLS_ASSERT_OK_AND_ASSIGN(NetRef2Lanes outputs, jit->RunCycle({{i0, 0}}));
+  EXPECT_EQ(outputs.at(q), 0);
+  EXPECT_EQ(outputs.at(d), 0);
+}
+
+// A level-sensitive latch, modeled by a state table: transparent while G is
+// high, holding its value while G is low.
+TEST(NetlistJitTest, StateTableLatch) {
+  std::string table_text = R"(
+  input_names: "D"
+  input_names: "G"
+  internal_names: "IQ"
+  rows {
+    input_signals { key: "D" value: STATE_TABLE_SIGNAL_LOW }
+    input_signals { key: "G" value: STATE_TABLE_SIGNAL_HIGH }
+    internal_signals { key: "IQ" value: STATE_TABLE_SIGNAL_DONTCARE }
+    next_internal_signals { key: "IQ" value: STATE_TABLE_SIGNAL_LOW }
+  }
+  rows {
+    input_signals { key: "D" value: STATE_TABLE_SIGNAL_HIGH }
+    input_signals { key: "G" value: STATE_TABLE_SIGNAL_HIGH }
+    internal_signals { key: "IQ" value: STATE_TABLE_SIGNAL_DONTCARE }
+    next_internal_signals { key: "IQ" value: STATE_TABLE_SIGNAL_HIGH }
+  }
+  rows {
+    input_signals { key: "D" value: STATE_TABLE_SIGNAL_DONTCARE }
+    input_signals { key: "G" value: STATE_TABLE_SIGNAL_LOW }
+    internal_signals { key: "IQ" value: STATE_TABLE_SIGNAL_DONTCARE }
+    next_internal_signals { key: "IQ" value: STATE_TABLE_SIGNAL_NOCHANGE }
+  }
+  )";
+  StateTableProto table_proto;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString(table_text, &table_proto));
+  XLS_ASSERT_OK_AND_ASSIGN(StateTable table,
+                           StateTable::FromProto(table_proto));
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  XLS_ASSERT_OK(cell_library.AddEntry(CellLibraryEntry(
+      CellKind::kOther, "LATCH", std::vector<std::string>{"D", "G"},
+      {{"Q", "IQ"}, {"QN", "!IQ"}}, table)));
+
+  std::string module_text = R"(
+module main(d, g, q, qn);
+  input d, g;
+  output q, qn;
+
+  LATCH latch0 ( .D(d), .G(g), .Q(q), .QN(qn) );
+endmodule
+  )";
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<NetlistJit> jit,
+                           NetlistJit::Create(netlist.get(), module));
+  EXPECT_EQ(jit->register_count(), 1);
+
+  const rtl::NetRef d = module->inputs()[0];
+  const rtl::NetRef g = module->inputs()[1];
+  const rtl::NetRef q = module->outputs()[0];
+  const rtl::NetRef qn = module->outputs()[1];
+  // Open the latch in the low half of the lanes, then close it everywhere.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      NetRef2Lanes outputs,
+      jit->RunCycle({{d, 0xff00ff00ff00ff00}, {g, 0x00000000ffffffff}}));
+  EXPECT_EQ(outputs.at(q), 0x00000000ff00ff00);
+  EXPECT_EQ(outputs.at(qn), ~uint64_t{0x00000000ff00ff00});
+  XLS_ASSERT_OK_AND_ASSIGN(outputs,
+                           jit->RunCycle({{d, ~uint64_t{0}}, {g, 0}}));
+  EXPECT_EQ(outputs.at(q), 0x00000000ff00ff00);
+}
+
+TEST(NetlistJitTest, RejectsCombinationalCycles) {
+  std::string module_text = R"(
+module main(i0, o0);
+  input i0;
+  output o0;
+  wire a, b;
+
+  AND and0 ( .A(i0), .B(b), .Z(a) );
+  INV inv0 ( .A(a), .ZN(b) );
+  INV inv1 ( .A(b), .ZN(o0) );
+endmodule
+  )";
+
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  rtl::Scanner scanner(module_text);
+  XLS_ASSERT_OK_AND_ASSIGN(auto netlist,
+                           rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  XLS_ASSERT_OK_AND_ASSIGN(const rtl::Module* module,
+                           netlist->GetModule("main"));
+  EXPECT_THAT(NetlistJit::Create(netlist.get(), module),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("combinational cycle")));
+}
+
+}  // namespace
+}  // namespace netlist
+}  // namespace xls
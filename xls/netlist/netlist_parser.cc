@@ -14,9 +14,16 @@
 
 #include "xls/netlist/netlist_parser.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
@@ -293,6 +300,117 @@ absl::StatusOr<Token> Scanner::PeekInternal() {
   }
 }
 
+absl::StatusOr<std::vector<ModuleSpan>> SplitModules(std::string_view text) {
+  int64_t index = 0;
+  Pos pos{0, 0};
+  auto at = [&](int64_t offset) -> char {
+    return index + offset < text.size() ? text[index + offset] : '\0';
+  };
+  auto advance = [&] {
+    if (text[index++] == '\n') {
+      pos.lineno++;
+      pos.colno = 0;
+    } else {
+      pos.colno++;
+    }
+  };
+  // Skips past the terminator `end` (e.g. "*/"), or to EOF.
+  auto skip_past = [&](std::string_view end) {
+    while (index < text.size() && text.substr(index, end.size()) != end) {
+      advance();
+    }
+    for (int64_t i = 0; i < end.size() && index < text.size(); ++i) {
+      advance();
+    }
+  };
+  auto is_name_char = [](char c) { return isalnum(c) || c == '_'; };
+
+  std::vector<ModuleSpan> spans;
+  absl::flat_hash_map<std::string_view, int64_t> module_indices;
+  absl::flat_hash_set<int64_t> dependencies;
+  std::optional<int64_t> module_start;
+  bool expect_module_name = false;
+  while (index < text.size()) {
+    char c = text[index];
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      advance();
+      continue;
+    }
+    if (c == '/' && at(1) == '/') {
+      skip_past("\n");
+      continue;
+    }
+    if (c == '/' && at(1) == '*') {
+      skip_past("*/");
+      continue;
+    }
+    if (c == '(' && at(1) == '*') {
+      skip_past("*)");
+      continue;
+    }
+
+    const Pos token_pos = pos;
+    const int64_t token_start = index;
+    if (c == '\\' || isalpha(c) || c == '_') {
+      advance();
+      while (index < text.size() &&
+             (c == '\\' ? !absl::ascii_isspace(text[index])
+                        : is_name_char(text[index]))) {
+        advance();
+      }
+    } else if (isdigit(c)) {
+      // Consume the whole number so that e.g. the "hff" of "8'hff" isn't taken
+      // for a name.
+      while (index < text.size() &&
+             (is_name_char(text[index]) || text[index] == '\'')) {
+        advance();
+      }
+      continue;
+    } else {
+      if (!module_start.has_value()) {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Expected \"module\" @ %s, saw '%c'",
+                            token_pos.ToHumanString(), c));
+      }
+      advance();
+      continue;
+    }
+
+    std::string_view name = text.substr(token_start, index - token_start);
+    if (!module_start.has_value()) {
+      if (name != "module") {
+        return absl::InvalidArgumentError(
+            absl::StrFormat("Expected \"module\" @ %s, saw \"%s\"",
+                            token_pos.ToHumanString(), name));
+      }
+      module_start = token_start;
+      spans.push_back(ModuleSpan{.pos = token_pos});
+      expect_module_name = true;
+    } else if (expect_module_name) {
+      spans.back().name = name;
+      expect_module_name = false;
+    } else if (name == "endmodule") {
+      ModuleSpan& span = spans.back();
+      span.text = text.substr(*module_start, index - *module_start);
+      span.dependencies.assign(dependencies.begin(), dependencies.end());
+      std::sort(span.dependencies.begin(), span.dependencies.end());
+      // As in the serial parser, the first definition of a name wins.
+      module_indices.try_emplace(span.name, spans.size() - 1);
+      dependencies.clear();
+      module_start.reset();
+    } else if (auto it = module_indices.find(name);
+               it != module_indices.end()) {
+      dependencies.insert(it->second);
+    }
+  }
+  if (module_start.has_value()) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Module \"%s\" @ %s has no \"endmodule\"",
+                        spans.back().name, spans.back().pos.ToHumanString()));
+  }
+  return spans;
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
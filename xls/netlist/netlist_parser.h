@@ -16,6 +16,7 @@
 #define XLS_NETLIST_NETLIST_PARSER_H_
 
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -23,6 +24,7 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -36,9 +38,11 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/substitute.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/string_to_int.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/inline_bitmap.h"
 #include "xls/ir/bits.h"
 #include "xls/netlist/cell_library.h"
@@ -92,6 +96,10 @@ struct Token {
 class Scanner {
  public:
   explicit Scanner(std::string_view text) : text_(text) {}
+  // Scans `text`, which starts at `start` in some larger text, so that token
+  // positions are reported relative to the larger text.
+  Scanner(std::string_view text, Pos start)
+      : text_(text), lineno_(start.lineno), colno_(start.colno) {}
 
   absl::StatusOr<Token> Peek();
 
@@ -133,6 +141,22 @@ class Scanner {
   std::optional<Token> lookahead_;
 };
 
+// A module definition within the text of a netlist.
+struct ModuleSpan {
+  std::string_view name;
+  // The text from the "module" keyword through "endmodule".
+  std::string_view text;
+  // Position of the "module" keyword.
+  Pos pos;
+  // Indices of the earlier modules whose names occur in `text`, i.e. the
+  // modules this one may instantiate.
+  std::vector<int64_t> dependencies;
+};
+
+// Splits the text of a netlist at module boundaries with a light character
+// scan, skipping comments and attributes the same way Scanner does.
+absl::StatusOr<std::vector<ModuleSpan>> SplitModules(std::string_view text);
+
 template <typename EvalT = bool>
 class AbstractParser {
  public:
@@ -147,7 +171,29 @@ class AbstractParser {
     return ParseNetlist(cell_library, scanner, EvalT{false}, EvalT{true});
   }
 
+  // Like ParseNetlist, but parses the modules of `text` concurrently on
+  // `thread_pool` (or serially if it is null). As with ParseNetlist, a module
+  // can only instantiate modules defined before it; modules are parsed in
+  // waves such that the modules any module may instantiate are complete
+  // before its wave starts. The result is the same as ParseNetlist's.
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       std::string_view text, ThreadPool* thread_pool,
+                       EvalT zero, EvalT one);
+  template <typename = std::is_constructible<EvalT, bool>>
+  static absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+  ParseNetlistParallel(AbstractCellLibrary<EvalT>* cell_library,
+                       std::string_view text, ThreadPool* thread_pool) {
+    return ParseNetlistParallel(cell_library, text, thread_pool, EvalT{false},
+                                EvalT{true});
+  }
+
  private:
+  // Modules by name, along with the index of their definition in the text.
+  using ParsedModules =
+      absl::flat_hash_map<std::string,
+                          std::pair<int64_t, const AbstractModule<EvalT>*>>;
+
   explicit AbstractParser(AbstractCellLibrary<EvalT>* cell_library,
                           Scanner* scanner, EvalT zero, EvalT one)
       : cell_library_(cell_library),
@@ -292,6 +338,12 @@ class AbstractParser {
   // Scanner used for scanning out tokens (in a stream sequence).
   Scanner* scanner_;
 
+  // For ParseNetlistParallel: the modules which have already been parsed,
+  // which are consulted instead of the netlist's, and the index of the module
+  // being parsed. Only modules defined before it can be instantiated.
+  const ParsedModules* parsed_modules_ = nullptr;
+  int64_t module_index_ = 0;
+
   // Values representing zero/false and one/true in the EvalT type.
   EvalT zero_;
   EvalT one_;
@@ -438,7 +490,13 @@ template <typename EvalT>
 absl::StatusOr<const AbstractCellLibraryEntry<EvalT>*>
 AbstractParser<EvalT>::ParseCellModule(AbstractNetlist<EvalT>& netlist) {
   XLS_ASSIGN_OR_RETURN(std::string name, PopNameOrError());
-  auto maybe_module = netlist.MaybeGetModule(name);
+  std::optional<const AbstractModule<EvalT>*> maybe_module;
+  if (parsed_modules_ == nullptr) {
+    maybe_module = netlist.MaybeGetModule(name);
+  } else if (auto it = parsed_modules_->find(name);
+             it != parsed_modules_->end() && it->second.first < module_index_) {
+    maybe_module = it->second.second;
+  }
   if (maybe_module.has_value()) {
     return maybe_module.value()->AsCellLibraryEntry();
   }
@@ -797,6 +855,73 @@ AbstractParser<EvalT>::ParseNetlist(AbstractCellLibrary<EvalT>* cell_library,
   return std::move(netlist);
 }
 
+template <typename EvalT>
+absl::StatusOr<std::unique_ptr<AbstractNetlist<EvalT>>>
+AbstractParser<EvalT>::ParseNetlistParallel(
+    AbstractCellLibrary<EvalT>* cell_library, std::string_view text,
+    ThreadPool* thread_pool, EvalT zero, EvalT one) {
+  XLS_ASSIGN_OR_RETURN(std::vector<ModuleSpan> spans, SplitModules(text));
+
+  // A module's wave is one past the latest wave of any module it depends on.
+  std::vector<int64_t> wave_of(spans.size(), 0);
+  std::vector<std::vector<int64_t>> waves;
+  for (int64_t i = 0; i < spans.size(); ++i) {
+    for (int64_t dependency : spans[i].dependencies) {
+      wave_of[i] = std::max(wave_of[i], wave_of[dependency] + 1);
+    }
+    if (waves.size() <= wave_of[i]) {
+      waves.resize(wave_of[i] + 1);
+    }
+    waves[wave_of[i]].push_back(i);
+  }
+
+  auto netlist = std::make_unique<AbstractNetlist<EvalT>>();
+  std::vector<std::unique_ptr<AbstractModule<EvalT>>> modules(spans.size());
+  std::vector<absl::Status> statuses(spans.size());
+  ParsedModules parsed_modules;
+  auto parse_module = [&](int64_t i) {
+    Scanner scanner(spans[i].text, spans[i].pos);
+    AbstractParser<EvalT> p(cell_library, &scanner, zero, one);
+    p.parsed_modules_ = &parsed_modules;
+    p.module_index_ = i;
+    absl::StatusOr<std::unique_ptr<AbstractModule<EvalT>>> module =
+        p.ParseModule(*netlist);
+    if (module.ok()) {
+      modules[i] = *std::move(module);
+    } else {
+      statuses[i] = module.status();
+    }
+  };
+  for (const std::vector<int64_t>& wave : waves) {
+    if (thread_pool == nullptr || wave.size() == 1) {
+      for (int64_t i : wave) {
+        parse_module(i);
+      }
+    } else {
+      absl::BlockingCounter counter(wave.size());
+      for (int64_t i : wave) {
+        thread_pool->Schedule([&, i]() {
+          parse_module(i);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+    }
+    for (int64_t i : wave) {
+      XLS_RETURN_IF_ERROR(statuses[i]);
+      // The cell library entry of a module is built on first use; build it now
+      // since later waves may use it concurrently.
+      modules[i]->AsCellLibraryEntry();
+      parsed_modules.try_emplace(modules[i]->name(), i, modules[i].get());
+    }
+  }
+
+  for (std::unique_ptr<AbstractModule<EvalT>>& module : modules) {
+    netlist->AddModule(std::move(module));
+  }
+  return std::move(netlist);
+}
+
 }  // namespace rtl
 }  // namespace netlist
 }  // namespace xls
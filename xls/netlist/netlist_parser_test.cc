@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -27,8 +28,10 @@
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
+#include "absl/strings/match.h"
 #include "absl/strings/substitute.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/thread_pool.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/fake_cell_library.h"
 #include "xls/netlist/netlist.h"
@@ -39,6 +42,7 @@ namespace rtl {
 namespace {
 
 using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
 
 TEST(NetlistParserTest, EmptyModule) {
@@ -448,6 +452,121 @@ endmodule)";
   TestAssignHelper(m);
 }
 
+constexpr std::string_view kHierarchicalNetlist = R"(
+// The leaves.
+module leaf_and (a, b, z);
+  input a, b;
+  output z;
+  AND and0 ( .A(a), .B(b), .Z(z) );
+endmodule
+(* keep *)
+module leaf_or (a, b, z);
+  input a, b;
+  output z;
+  /* endmodule */
+  OR or0 ( .A(a), .B(b), .Z(z) );
+endmodule
+module mid (a, b, c, z);
+  input a, b, c;
+  output z;
+  wire t;
+  leaf_and l0 ( .a(a), .b(b), .z(t) );
+  leaf_or l1 ( .a(t), .b(c), .z(z) );
+endmodule
+module other (a, z);
+  input a;
+  output z;
+  wire [7:0] w;
+  assign w = 8'hff;
+  INV inv0 ( .A(a), .ZN(z) );
+endmodule
+module top (a, b, c, z);
+  input a, b, c;
+  output z;
+  mid m0 ( .a(a), .b(b), .c(c), .z(z) );
+endmodule
+)";
+
+TEST(NetlistParserTest, SplitModules) {
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ModuleSpan> spans,
+                           SplitModules(kHierarchicalNetlist));
+  ASSERT_EQ(spans.size(), 5);
+  EXPECT_EQ(spans[0].name, "leaf_and");
+  EXPECT_EQ(spans[0].pos.lineno, 2);
+  EXPECT_TRUE(absl::StartsWith(spans[0].text, "module leaf_and"));
+  EXPECT_TRUE(absl::EndsWith(spans[0].text, "endmodule"));
+  EXPECT_EQ(spans[1].name, "leaf_or");
+  EXPECT_TRUE(absl::EndsWith(spans[1].text, "Z(z) );\nendmodule"));
+  EXPECT_THAT(spans[0].dependencies, ElementsAre());
+  EXPECT_THAT(spans[1].dependencies, ElementsAre());
+  EXPECT_EQ(spans[2].name, "mid");
+  EXPECT_THAT(spans[2].dependencies, ElementsAre(0, 1));
+  EXPECT_EQ(spans[3].name, "other");
+  EXPECT_THAT(spans[3].dependencies, ElementsAre());
+  EXPECT_EQ(spans[4].name, "top");
+  EXPECT_THAT(spans[4].dependencies, ElementsAre(2));
+
+  EXPECT_THAT(SplitModules("module m(a);\n  input a;\n"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("has no \"endmodule\"")));
+  EXPECT_THAT(SplitModules("wire a;"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Expected \"module\"")));
+}
+
+TEST(NetlistParserTest, ParallelMatchesSerial) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  Scanner scanner(kHierarchicalNetlist);
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Netlist> serial,
+                           Parser::ParseNetlist(&cell_library, &scanner));
+  ThreadPool thread_pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Netlist> parallel,
+      Parser::ParseNetlistParallel(&cell_library, kHierarchicalNetlist,
+                                   &thread_pool));
+
+  ASSERT_EQ(serial->modules().size(), parallel->modules().size());
+  for (int64_t i = 0; i < serial->modules().size(); ++i) {
+    const Module& s = *serial->modules()[i];
+    const Module& p = *parallel->modules()[i];
+    EXPECT_EQ(s.name(), p.name());
+    ASSERT_EQ(s.cells().size(), p.cells().size());
+    for (int64_t j = 0; j < s.cells().size(); ++j) {
+      EXPECT_EQ(s.cells()[j]->name(), p.cells()[j]->name());
+      EXPECT_EQ(s.cells()[j]->cell_library_entry()->name(),
+                p.cells()[j]->cell_library_entry()->name());
+    }
+    EXPECT_EQ(s.nets().size(), p.nets().size());
+  }
+
+  // Instances of modules resolve to the modules of the new netlist.
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* mid, parallel->GetModule("mid"));
+  XLS_ASSERT_OK_AND_ASSIGN(const Module* top, parallel->GetModule("top"));
+  XLS_ASSERT_OK_AND_ASSIGN(Cell * m0, top->ResolveCell("m0"));
+  EXPECT_EQ(m0->cell_library_entry(), mid->AsCellLibraryEntry());
+}
+
+TEST(NetlistParserTest, ParallelReportsErrorPosition) {
+  XLS_ASSERT_OK_AND_ASSIGN(CellLibrary cell_library, MakeFakeCellLibrary());
+  ThreadPool thread_pool(2);
+  constexpr std::string_view kNetlist = R"(module a(x);
+  input x;
+endmodule
+module b(x);
+  input x;
+  BOGUS bogus0 ( .A(x) );
+endmodule
+)";
+  Scanner scanner(kNetlist);
+  absl::Status serial =
+      Parser::ParseNetlist(&cell_library, &scanner).status();
+  EXPECT_FALSE(serial.ok());
+  EXPECT_EQ(
+      Parser::ParseNetlistParallel(&cell_library, kNetlist, &thread_pool)
+          .status(),
+      serial);
+}
+
 }  // namespace
 }  // namespace rtl
 }  // namespace netlist
@@ -29,6 +29,7 @@
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/netlist/cell_library.h"
 #include "xls/netlist/find_logic_clouds.h"
 #include "xls/netlist/netlist.h"
@@ -36,6 +37,8 @@
 #include "xls/netlist/netlist_parser.h"
 
 ABSL_FLAG(bool, show_clusters, false, "Show the logic clusters found.");
+ABSL_FLAG(int64_t, threads, 1,
+          "Number of threads with which to parse the modules of the netlist.");
 
 namespace xls {
 namespace {
@@ -52,10 +55,17 @@ absl::Status RealMain(std::string_view netlist_path,
   }
 
   XLS_ASSIGN_OR_RETURN(std::string netlist_text, GetFileContents(netlist_path));
-  netlist::rtl::Scanner scanner(netlist_text);
-  XLS_ASSIGN_OR_RETURN(
-      std::unique_ptr<netlist::rtl::Netlist> netlist,
-      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  std::unique_ptr<netlist::rtl::Netlist> netlist;
+  if (int64_t threads = absl::GetFlag(FLAGS_threads); threads > 1) {
+    ThreadPool thread_pool(threads);
+    XLS_ASSIGN_OR_RETURN(netlist,
+                         netlist::rtl::Parser::ParseNetlistParallel(
+                             &cell_library, netlist_text, &thread_pool));
+  } else {
+    netlist::rtl::Scanner scanner(netlist_text);
+    XLS_ASSIGN_OR_RETURN(
+        netlist, netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+  }
   netlist::rtl::Module* module = netlist->modules()[0].get();
   std::cout << "nets:  " << module->nets().size() << '\n';
   std::cout << "cells: " << module->cells().size() << '\n';
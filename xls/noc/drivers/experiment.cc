@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -23,12 +24,15 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -141,29 +145,48 @@ absl::Status ExperimentMetrics::DebugDump() const {
   return absl::OkStatus();
 }
 
-absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
-    const ExperimentConfig& experiment_config,
-    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
-    const {
-  // Build and assign simulation objects.
-  NetworkManager graph;
-  NocParameters params;
+absl::StatusOr<std::unique_ptr<ExperimentNetwork>> ExperimentNetwork::Build(
+    const NetworkConfigProto& network_config,
+    DistributedRoutingTableBuilderBase& distributed_routing_table_builder) {
+  auto network = absl::WrapUnique(new ExperimentNetwork());
+  network->network_config_ = network_config;
 
   XLS_RETURN_IF_ERROR(BuildNetworkGraphFromProto(
-      experiment_config.GetNetworkConfig(), &graph, &params));
+      network->network_config_, &network->graph_, &network->params_));
 
   // Create global routing table.
   XLS_ASSIGN_OR_RETURN(
-      DistributedRoutingTable routing_table,
+      network->routing_table_,
       distributed_routing_table_builder.BuildNetworkRoutingTables(
-          graph.GetNetworkIds()[0], graph, params));
+          network->GetNetworkId(), network->graph_, network->params_));
+
+  return network;
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
+    const ExperimentConfig& experiment_config,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  // Build and assign simulation objects.
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<ExperimentNetwork> network,
+                       ExperimentNetwork::Build(
+                           experiment_config.GetNetworkConfig(),
+                           distributed_routing_table_builder));
+  return RunExperimentOnNetwork(experiment_config.GetTrafficConfig(),
+                                *network);
+}
+
+absl::StatusOr<ExperimentData> ExperimentRunner::RunExperimentOnNetwork(
+    const NocTrafficManager& traffic_manager,
+    ExperimentNetwork& network) const {
+  NetworkManager& graph = network.GetNetworkManager();
+  NocParameters& params = network.GetNocParameters();
+  DistributedRoutingTable& routing_table = network.GetRoutingTable();
 
   // Build traffic model.
   RandomNumberInterface rnd;
   rnd.SetSeed(seed_);
 
-  const NocTrafficManager& traffic_manager =
-      experiment_config.GetTrafficConfig();
   XLS_ASSIGN_OR_RETURN(TrafficModeId mode_id,
                        traffic_manager.GetTrafficModeIdByName(mode_name_));
   XLS_ASSIGN_OR_RETURN(
@@ -182,6 +205,12 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
                                         graph.GetNetworkIds()[0]));
   simulator.Dump();
 
+  std::unique_ptr<ThreadPool> thread_pool;
+  if (simulation_thread_count_ > 1) {
+    thread_pool = std::make_unique<ThreadPool>(simulation_thread_count_);
+    simulator.SetThreadPool(thread_pool.get());
+  }
+
   // Hook traffic injector and simulator together.
   NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
                                                      traffic_injector);
@@ -332,4 +361,56 @@ absl::StatusOr<ExperimentData> ExperimentRunner::RunExperiment(
   return experiment_data;
 }
 
+absl::StatusOr<std::vector<ExperimentData>> Experiment::RunAllSteps(
+    int64_t thread_count,
+    DistributedRoutingTableBuilderBase&& distributed_routing_table_builder)
+    const {
+  const int64_t step_count = GetStepCount();
+  std::vector<ExperimentConfig> configs;
+  configs.reserve(step_count);
+  for (int64_t step = 0; step < step_count; ++step) {
+    XLS_ASSIGN_OR_RETURN(ExperimentConfig config, GetConfigForStep(step));
+    configs.push_back(std::move(config));
+  }
+
+  // Build each distinct network once, keyed by its serialized config.
+  absl::flat_hash_map<std::string, ExperimentNetwork*> network_by_config;
+  std::vector<std::unique_ptr<ExperimentNetwork>> networks;
+  std::vector<ExperimentNetwork*> step_networks(step_count);
+  for (int64_t step = 0; step < step_count; ++step) {
+    auto [it, inserted] = network_by_config.try_emplace(
+        configs[step].GetNetworkConfig().SerializeAsString(), nullptr);
+    if (inserted) {
+      XLS_ASSIGN_OR_RETURN(
+          std::unique_ptr<ExperimentNetwork> network,
+          ExperimentNetwork::Build(configs[step].GetNetworkConfig(),
+                                   distributed_routing_table_builder));
+      it->second = network.get();
+      networks.push_back(std::move(network));
+    }
+    step_networks[step] = it->second;
+  }
+
+  std::vector<absl::StatusOr<ExperimentData>> results(
+      step_count, absl::UnknownError("Experiment step did not run"));
+  {
+    ThreadPool thread_pool(thread_count);
+    for (int64_t step = 0; step < step_count; ++step) {
+      thread_pool.Schedule([&, step]() {
+        results[step] = runner_.RunExperimentOnNetwork(
+            configs[step].GetTrafficConfig(), *step_networks[step]);
+      });
+    }
+    thread_pool.WaitForIdle();
+  }
+
+  std::vector<ExperimentData> experiment_data;
+  experiment_data.reserve(step_count);
+  for (absl::StatusOr<ExperimentData>& result : results) {
+    XLS_ASSIGN_OR_RETURN(ExperimentData data, std::move(result));
+    experiment_data.push_back(std::move(data));
+  }
+  return experiment_data;
+}
+
 }  // namespace xls::noc
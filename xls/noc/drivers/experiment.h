@@ -18,6 +18,7 @@
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -33,8 +34,11 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/noc/config/network_config.pb.h"
+#include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
+#include "xls/noc/simulation/network_graph.h"
+#include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/traffic_description.h"
 
 // This file contains classes used to construct different
@@ -215,18 +219,56 @@ struct ExperimentData {
   ExperimentInfo info;
 };
 
+// The network graph, parameters and routing tables built from a network
+// config.
+//
+// Running a simulation only reads these, so experiments which differ only in
+// their traffic can share one ExperimentNetwork, also concurrently.
+class ExperimentNetwork {
+ public:
+  static absl::StatusOr<std::unique_ptr<ExperimentNetwork>> Build(
+      const NetworkConfigProto& network_config,
+      DistributedRoutingTableBuilderBase& distributed_routing_table_builder);
+
+  const NetworkConfigProto& GetNetworkConfig() const { return network_config_; }
+  NetworkId GetNetworkId() const { return graph_.GetNetworkIds()[0]; }
+
+  NetworkManager& GetNetworkManager() { return graph_; }
+  NocParameters& GetNocParameters() { return params_; }
+  DistributedRoutingTable& GetRoutingTable() { return routing_table_; }
+
+ private:
+  ExperimentNetwork() = default;
+
+  // The parameters in params_ point into this copy of the config.
+  NetworkConfigProto network_config_;
+  NetworkManager graph_;
+  NocParameters params_;
+  DistributedRoutingTable routing_table_;
+};
+
 // Class to setup and run a single step of the experiment,
 // including the setup and initialization of the traffic model.
 class ExperimentRunner {
  public:
   ExperimentRunner()
-      : total_simulation_cycle_count_(0), cycle_time_in_ps_(0), seed_(0) {}
+      : total_simulation_cycle_count_(0),
+        cycle_time_in_ps_(0),
+        seed_(0),
+        simulation_thread_count_(1) {}
 
   absl::StatusOr<ExperimentData> RunExperiment(
       const ExperimentConfig& experiment_config,
       DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
           DistributedRoutingTableBuilderForTrees()) const;
 
+  // Runs the traffic of `traffic_manager` on a network built beforehand.
+  // `network` is only read, so several experiments may run on it at the same
+  // time.
+  absl::StatusOr<ExperimentData> RunExperimentOnNetwork(
+      const NocTrafficManager& traffic_manager,
+      ExperimentNetwork& network) const;
+
   ExperimentRunner& SetSimulationCycleCount(int64_t count) {
     CHECK_GE(count, 0);
     total_simulation_cycle_count_ = count;
@@ -249,18 +291,29 @@ class ExperimentRunner {
     return *this;
   }
 
+  // Number of threads the simulator ticks the network components on. With
+  // more than one, large networks are split across a thread pool (see
+  // NocSimulator::SetThreadPool); the results are unchanged.
+  ExperimentRunner& SetSimulationThreadCount(int64_t count) {
+    CHECK_GE(count, 1);
+    simulation_thread_count_ = count;
+    return *this;
+  }
+
   int64_t GetSimulationCycleCount() const {
     return total_simulation_cycle_count_;
   }
   int64_t GetCycleTimeInPs() const { return cycle_time_in_ps_; }
 
   int16_t GetSeed() const { return seed_; }
+  int64_t GetSimulationThreadCount() const { return simulation_thread_count_; }
   std::string_view GetTrafficMode() const { return mode_name_; }
 
  private:
   int64_t total_simulation_cycle_count_;
   int64_t cycle_time_in_ps_;
   int16_t seed_;
+  int64_t simulation_thread_count_;
 
   std::string mode_name_;
 };
@@ -293,6 +346,17 @@ class Experiment {
                                 std::move(distributed_routing_table_builder));
   }
 
+  // Runs all steps of the experiment on `thread_count` threads (all available
+  // CPUs if zero) and returns the data of each step in step order.
+  //
+  // Steps with the same network config share a single network graph and
+  // routing table, built once up front, so sweeps which only change the
+  // traffic don't rebuild the topology.
+  absl::StatusOr<std::vector<ExperimentData>> RunAllSteps(
+      int64_t thread_count,
+      DistributedRoutingTableBuilderBase&& distributed_routing_table_builder =
+          DistributedRoutingTableBuilderForTrees()) const;
+
   // Get the configuration for step N.
   absl::StatusOr<ExperimentConfig> GetConfigForStep(int64_t step) const {
     XLS_RET_CHECK(step >= 0 && step < GetStepCount());
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "gmock/gmock.h"
@@ -32,6 +33,8 @@
 namespace xls::noc {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
+
 TEST(SampleExperimentsTest, SimpleVCExperiment) {
   ExperimentFactory experiment_factory;
   XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
@@ -220,5 +223,37 @@ TEST(SampleExperimentsTest, AggregateTreeTest) {
   }
 }
 
+// Running the steps concurrently on shared networks gives the same results as
+// running them one at a time.
+TEST(SampleExperimentsTest, RunAllStepsMatchesRunStep) {
+  ExperimentFactory experiment_factory;
+  XLS_ASSERT_OK(RegisterSampleExperiments(experiment_factory));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Experiment experiment,
+      experiment_factory.BuildExperiment("SimpleVCExperiment"));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<ExperimentData> all_steps,
+                           experiment.RunAllSteps(/*thread_count=*/4));
+  ASSERT_EQ(all_steps.size(), 4);
+
+  for (int64_t i = 0; i < experiment.GetStepCount(); ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(ExperimentData expected, experiment.RunStep(i));
+    for (std::string_view metric :
+         {"Flow:flow_0:TrafficRateInMiBps", "Flow:flow_1:TrafficRateInMiBps",
+          "Sink:RecvPort0:VC:0:TrafficRateInMiBps",
+          "Sink:RecvPort0:VC:1:TrafficRateInMiBps"}) {
+      EXPECT_THAT(all_steps[i].metrics.GetFloatMetric(metric),
+                  IsOkAndHolds(expected.metrics.GetFloatMetric(metric).value()))
+          << "step " << i << " " << metric;
+    }
+    EXPECT_THAT(
+        all_steps[i].metrics.GetIntegerMetric("Sink:RecvPort0:FlitCount"),
+        IsOkAndHolds(expected.metrics
+                         .GetIntegerMetric("Sink:RecvPort0:FlitCount")
+                         .value()))
+        << "step " << i;
+  }
+}
+
 }  // namespace
 }  // namespace xls::noc
@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <ostream>
 #include <queue>
@@ -279,6 +280,87 @@ void DistributedRoutingTable::AllocateTableForNetwork(NetworkId network_id,
   routing_tables_[network_index].resize(component_count);
 }
 
+const DistributedRoutingTable::DenseRouterRoutingTable*
+DistributedRoutingTable::GetDenseRouterRoutingTable(
+    NetworkComponentId router) const {
+  if (router.network() >= dense_routing_tables_.size() ||
+      router.id() >= dense_routing_tables_[router.network()].size()) {
+    return nullptr;
+  }
+  const DenseRouterRoutingTable& table =
+      dense_routing_tables_[router.network()][router.id()];
+  return table.hops.empty() ? nullptr : &table;
+}
+
+absl::Status DistributedRoutingTable::CompileDenseRoutingTables(
+    NetworkId network_id) {
+  int64_t network_index = network_id.id();
+  XLS_RET_CHECK_LT(network_index, routing_tables_.size());
+  const std::vector<RouterRoutingTable>& tables =
+      routing_tables_[network_index];
+
+  if (dense_routing_tables_.size() <= network_index) {
+    dense_routing_tables_.resize(network_index + 1);
+  }
+  std::vector<DenseRouterRoutingTable>& dense_tables =
+      dense_routing_tables_[network_index];
+  dense_tables.clear();
+  dense_tables.resize(tables.size());
+
+  int64_t destination_count = sink_indices_.NetworkComponentCount();
+  for (NetworkComponent& nc :
+       network_manager_->GetNetwork(network_id).GetNetworkComponents()) {
+    if (nc.kind() != NetworkComponentKind::kRouter ||
+        tables.at(nc.id().id()).routes.empty()) {
+      continue;
+    }
+    const RouterRoutingTable& table = tables.at(nc.id().id());
+    XLS_ASSIGN_OR_RETURN(int64_t input_port_count,
+                         port_indices_.InputPortCount(nc.id()));
+
+    // Ports without virtual channels are routed as vc 0.
+    int64_t vc_count = 1;
+    std::vector<PortId> input_ports(input_port_count);
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSIGN_OR_RETURN(input_ports[i], port_indices_.GetPortByIndex(
+                                               nc.id(), PortDirection::kInput,
+                                               i));
+      vc_count = std::max<int64_t>(
+          vc_count, table.routes.at(input_ports[i].id()).size());
+    }
+
+    DenseRouterRoutingTable& dense = dense_tables[nc.id().id()];
+    dense.input_port_count = input_port_count;
+    dense.vc_count = vc_count;
+    dense.destination_count = destination_count;
+    dense.hops.assign(input_port_count * vc_count * destination_count,
+                      PortIndexAndVCIndex{-1, -1});
+
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      const std::vector<PortRoutingList>& port_routes =
+          table.routes.at(input_ports[i].id());
+      for (int64_t vc = 0; vc < port_routes.size(); ++vc) {
+        for (const auto& [destination_index, hop] : port_routes[vc]) {
+          XLS_RET_CHECK_LT(destination_index, destination_count);
+          PortIndexAndVCIndex& entry =
+              dense.hops[(i * vc_count + vc) * destination_count +
+                         destination_index];
+          // GetRouterOutputPortByIndex() takes the first matching route.
+          if (entry.port_index_ >= 0) {
+            continue;
+          }
+          XLS_ASSIGN_OR_RETURN(
+              int64_t output_port_index,
+              port_indices_.GetPortIndex(hop.port_id_, PortDirection::kOutput));
+          entry = PortIndexAndVCIndex{output_port_index, hop.vc_index_};
+        }
+      }
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 absl::Status DistributedRoutingTableBuilderBase::BuildNetworkInterfaceIndices(
     NetworkId network_id, DistributedRoutingTable* routing_table) {
   NetworkComponentIndexMapBuilder source_index_builder;
@@ -372,6 +454,7 @@ DistributedRoutingTableBuilderForTrees::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(routing_table.CompileDenseRoutingTables(network_id));
 
   return routing_table;
 }
@@ -501,6 +584,7 @@ DistributedRoutingTableBuilderForMultiplePaths::BuildNetworkRoutingTables(
   XLS_RET_CHECK_OK(
       BuildPortAndVirtualChannelIndices(network_id, &routing_table));
   XLS_RET_CHECK_OK(BuildRoutingTable(network_id, &routing_table));
+  XLS_RET_CHECK_OK(routing_table.CompileDenseRoutingTables(network_id));
 
   return routing_table;
 }
@@ -74,6 +74,38 @@ class DistributedRoutingTable {
     std::vector<std::vector<PortRoutingList>> routes;
   };
 
+  // The routing table of a single router compiled into one flat array so that
+  // routing a flit costs a single load instead of looking up ports and
+  // scanning a PortRoutingList.
+  //
+  // hops[(input_port_index * vc_count + vc_index) * destination_count +
+  //      destination_index]
+  //   is the output port index and vc a flit arriving at the router's
+  //   input_port_index and vc_index goes out on, where port indices are those
+  //   of GetPortIndices() and destination indices those of GetSinkIndices().
+  //   Entries without a route have a port_index_ of -1.
+  struct DenseRouterRoutingTable {
+    int64_t input_port_count = 0;
+    int64_t vc_count = 0;
+    int64_t destination_count = 0;
+    std::vector<PortIndexAndVCIndex> hops;
+
+    // Returns the output port index and vc, or a port_index_ of -1 if
+    // there is no route.
+    PortIndexAndVCIndex GetOutputPortIndex(int64_t input_port_index,
+                                           int64_t vc_index,
+                                           int64_t destination_index) const {
+      if (input_port_index < 0 || input_port_index >= input_port_count ||
+          vc_index < 0 || vc_index >= vc_count || destination_index < 0 ||
+          destination_index >= destination_count) {
+        return PortIndexAndVCIndex{-1, -1};
+      }
+      return hops[(input_port_index * vc_count + vc_index) *
+                      destination_count +
+                  destination_index];
+    }
+  };
+
   // Returns route to destination from a particular source network interface
   // to a sink network interface.
   //
@@ -107,8 +139,13 @@ class DistributedRoutingTable {
   absl::StatusOr<PortAndVCIndex> GetRouterOutputPortByIndex(
       PortAndVCIndex from, int64_t destination_index);
 
-  // TODO(tedhong): 2020-01-25 Add indexer for input/output ports of a router
-  //                          and support routing directly via indices.
+  // Returns the compiled routing table of a router, or nullptr if `router`
+  // has no routes.
+  //
+  // Compiled tables are built once all routes of the network are known (see
+  // CompileDenseRoutingTables()) and are what the simulator routes flits with.
+  const DenseRouterRoutingTable* GetDenseRouterRoutingTable(
+      NetworkComponentId router) const;
 
   // Returns mapping of vc params to local indicies.
   const VirtualChannelIndexMap& GetVirtualChannelIndices() {
@@ -136,6 +173,10 @@ class DistributedRoutingTable {
   // number of components in a network.
   void AllocateTableForNetwork(NetworkId network_id, int64_t component_count);
 
+  // Compiles the routing tables of all routers of a network into
+  // dense_routing_tables_.  Must be called after all routes are added.
+  absl::Status CompileDenseRoutingTables(NetworkId network_id);
+
   // Get (and create if necessary) routing table associated for a component.
   RouterRoutingTable& GetRoutingTable(NetworkComponentId nc_id) {
     return routing_tables_[nc_id.network()][nc_id.id()];
@@ -164,6 +205,9 @@ class DistributedRoutingTable {
   // ie. routing table for ComponentId id is
   //  routing_tables_[id.network()][id.id()]
   std::vector<std::vector<RouterRoutingTable>> routing_tables_;
+
+  // Compiled routing tables, indexed like routing_tables_.
+  std::vector<std::vector<DenseRouterRoutingTable>> dense_routing_tables_;
 };
 
 // Abstract base class for distributed routing table builder.
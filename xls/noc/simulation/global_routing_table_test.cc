@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/global_routing_table.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <string_view>
 #include <vector>
@@ -30,6 +31,8 @@
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/config/network_config_proto_builder.h"
 #include "xls/noc/simulation/common.h"
+#include "xls/noc/simulation/indexer.h"
+#include "xls/noc/simulation/network_graph.h"
 #include "xls/noc/simulation/network_graph_builder.h"
 #include "xls/noc/simulation/parameters.h"
 #include "xls/noc/simulation/sample_network_graphs.h"
@@ -632,6 +635,65 @@ TEST(GlobalRoutingTableTest, MultiplePathsBetweenRoutersWithLoop1) {
                                               linkbo1_id, recvport3));
 }
 
+TEST(GlobalRoutingTableTest, DenseRouterRoutingTableMatchesRoutes) {
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_ASSERT_OK(BuildNetworkGraphLinear001(&proto, &graph, &params));
+  NetworkId network_id = graph.GetNetworkIds()[0];
+
+  DistributedRoutingTableBuilderForMultiplePaths route_builder;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      DistributedRoutingTable routing_table,
+      route_builder.BuildNetworkRoutingTables(network_id, graph, params));
+  const PortIndexMap& port_indices = routing_table.GetPortIndices();
+  int64_t destination_count =
+      routing_table.GetSinkIndices().NetworkComponentCount();
+
+  int64_t router_count = 0;
+  for (NetworkComponent& nc :
+       graph.GetNetwork(network_id).GetNetworkComponents()) {
+    if (nc.kind() != NetworkComponentKind::kRouter) {
+      EXPECT_EQ(routing_table.GetDenseRouterRoutingTable(nc.id()), nullptr);
+      continue;
+    }
+    ++router_count;
+    const DistributedRoutingTable::DenseRouterRoutingTable* dense =
+        routing_table.GetDenseRouterRoutingTable(nc.id());
+    ASSERT_NE(dense, nullptr);
+    XLS_ASSERT_OK_AND_ASSIGN(int64_t input_port_count,
+                             port_indices.InputPortCount(nc.id()));
+    EXPECT_EQ(dense->input_port_count, input_port_count);
+
+    for (int64_t i = 0; i < input_port_count; ++i) {
+      XLS_ASSERT_OK_AND_ASSIGN(
+          PortId port_id,
+          port_indices.GetPortByIndex(nc.id(), PortDirection::kInput, i));
+      XLS_ASSERT_OK_AND_ASSIGN(
+          int64_t vc_count,
+          routing_table.GetVirtualChannelIndices().VirtualChannelCount(
+              port_id));
+      for (int64_t vc = 0; vc < std::max<int64_t>(vc_count, 1); ++vc) {
+        for (int64_t dest = 0; dest < destination_count; ++dest) {
+          PortIndexAndVCIndex hop = dense->GetOutputPortIndex(i, vc, dest);
+          XLS_ASSERT_OK_AND_ASSIGN(PortAndVCIndex expected,
+                                   routing_table.GetRouterOutputPortByIndex(
+                                       PortAndVCIndex{port_id, vc}, dest));
+          XLS_ASSERT_OK_AND_ASSIGN(
+              int64_t expected_port_index,
+              port_indices.GetPortIndex(expected.port_id_,
+                                        PortDirection::kOutput));
+          EXPECT_EQ(hop.port_index_, expected_port_index);
+          EXPECT_EQ(hop.vc_index_, expected.vc_index_);
+        }
+      }
+    }
+    EXPECT_EQ(dense->GetOutputPortIndex(0, 0, destination_count).port_index_,
+              -1);
+  }
+  EXPECT_EQ(router_count, 2);
+}
+
 }  // namespace
 }  // namespace noc
 }  // namespace xls
@@ -38,6 +38,7 @@
 #include "xls/noc/simulation/random_number_interface.h"
 #include "xls/noc/simulation/traffic_description.h"
 #include "xls/noc/simulation/traffic_models.h"
+#include "xls/noc/simulation/traffic_trace.h"
 
 namespace xls::noc {
 
@@ -277,6 +278,12 @@ absl::Status NocTrafficInjectorBuilder::BuildPerFlowTrafficModels(
     const NocTrafficManager& traffic_manager,
     RandomNumberInterface& random_number_interface,
     NocTrafficInjector& injector) {
+  if (trace_ != nullptr && trace_->flow_count() != traffic_flows.size()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Traffic trace has %d flows but the traffic mode has %d flows.",
+        trace_->flow_count(), traffic_flows.size()));
+  }
+
   for (int64_t i = 0; i < traffic_flows.size(); ++i) {
     TrafficFlowId flow_id = traffic_flows[i];
     const TrafficFlow& flow = traffic_manager.GetTrafficFlow(flow_id);
@@ -286,7 +293,14 @@ absl::Status NocTrafficInjectorBuilder::BuildPerFlowTrafficModels(
     int64_t sink_index = injector.flows_index_to_sinks_index_map_.at(i);
     int64_t vc_index = injector.flows_index_to_vc_index_map_.at(i);
 
-    if (flow.IsReplay()) {
+    if (trace_ != nullptr) {
+      auto model = std::make_unique<TraceTrafficModel>(trace_, i,
+                                                       bits_per_packet);
+      model->SetVCIndex(vc_index);
+      model->SetSourceIndex(source_index);
+      model->SetDestinationIndex(sink_index);
+      injector.traffic_models_.push_back(std::move(model));
+    } else if (flow.IsReplay()) {
       XLS_ASSIGN_OR_RETURN(
           std::unique_ptr<ReplayTrafficModel> model,
           ReplayTrafficModelBuilder(bits_per_packet, flow.GetClockCycleTimes())
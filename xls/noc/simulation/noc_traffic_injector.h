@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -33,6 +34,7 @@
 #include "xls/noc/simulation/simulator_shims.h"
 #include "xls/noc/simulation/traffic_description.h"
 #include "xls/noc/simulation/traffic_models.h"
+#include "xls/noc/simulation/traffic_trace.h"
 
 // This file contains classes used to model traffic of a NOC.
 
@@ -150,6 +152,16 @@ class NocTrafficInjector {
 // Builder for constructing a NocTrafficInjector.
 class NocTrafficInjectorBuilder {
  public:
+  // Replays the packets of every flow from a pre-generated trace (see
+  // WriteTrafficTrace) instead of drawing them from the flows' traffic models
+  // during simulation.  Flow i of the trace supplies the packets of the i-th
+  // flow of the simulated traffic mode.
+  NocTrafficInjectorBuilder& SetTrafficTrace(
+      std::shared_ptr<const TrafficTrace> trace) {
+    trace_ = std::move(trace);
+    return *this;
+  }
+
   // Analyzes the network, parameters, and traffic specification of the NOC to
   // build a NocTrafficInjector.
   absl::StatusOr<NocTrafficInjector> Build(
@@ -245,6 +257,8 @@ class NocTrafficInjectorBuilder {
       absl::Span<int64_t> max_packet_size_per_source,
       const NetworkManager& network_manager,
       const NocParameters& noc_parameters, NocTrafficInjector& injector);
+
+  std::shared_ptr<const TrafficTrace> trace_;
 };
 
 // Shim to call the NocTrafficInjector from a simulator.
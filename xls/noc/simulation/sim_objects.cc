@@ -14,6 +14,7 @@
 
 #include "xls/noc/simulation/sim_objects.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <queue>
 #include <utility>
@@ -28,6 +29,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
@@ -147,6 +149,41 @@ absl::Status NocSimulator::CreateSimulationObjects(NetworkId network) {
     XLS_RETURN_IF_ERROR(CreateNetworkComponent(id));
   }
 
+  // Objects of the same kind sharing a connection read each other's state
+  // within a tick, so such a kind can't be split across workers.
+  for (int64_t i = 0; i < network_obj.GetConnectionCount(); ++i) {
+    Connection& connection_obj =
+        mgr_->GetConnection(network_obj.GetConnectionIdByIndex(i));
+    if (!connection_obj.src().IsValid() || !connection_obj.sink().IsValid()) {
+      continue;
+    }
+    NetworkComponentKind src_kind =
+        mgr_->GetNetworkComponent(connection_obj.src().GetNetworkComponentId())
+            .kind();
+    NetworkComponentKind sink_kind =
+        mgr_->GetNetworkComponent(connection_obj.sink().GetNetworkComponentId())
+            .kind();
+    if (src_kind != sink_kind) {
+      continue;
+    }
+    switch (src_kind) {
+      case NetworkComponentKind::kNISrc:
+        source_schedule_.independent = false;
+        break;
+      case NetworkComponentKind::kNISink:
+        sink_schedule_.independent = false;
+        break;
+      case NetworkComponentKind::kLink:
+        link_schedule_.independent = false;
+        break;
+      case NetworkComponentKind::kRouter:
+        router_schedule_.independent = false;
+        break;
+      case NetworkComponentKind::kNone:
+        break;
+    }
+  }
+
   return absl::OkStatus();
 }
 
@@ -267,6 +304,7 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
     XLS_RET_CHECK_OK(svc->RunCycle());
   }
 
+  ScheduleAllComponents();
   bool converged = false;
   int64_t nticks = 0;
   while (!converged) {
@@ -300,47 +338,74 @@ absl::Status NocSimulator::RunCycle(int64_t max_ticks) {
   return absl::OkStatus();
 }
 
+void NocSimulator::ScheduleAllComponents() {
+  auto schedule_all = [](int64_t count, ComponentSchedule& schedule) {
+    schedule.pending.resize(count);
+    for (int64_t i = 0; i < count; ++i) {
+      schedule.pending[i] = i;
+    }
+  };
+  schedule_all(network_interface_sources_.size(), source_schedule_);
+  schedule_all(links_.size(), link_schedule_);
+  schedule_all(routers_.size(), router_schedule_);
+  schedule_all(network_interface_sinks_.size(), sink_schedule_);
+}
+
+template <typename SimObjectT>
+bool NocSimulator::TickPending(std::vector<SimObjectT>& objects,
+                               ComponentSchedule& schedule) {
+  std::vector<int64_t>& pending = schedule.pending;
+  const int64_t pending_count = pending.size();
+
+  // Not a vector<bool> as the entries are written concurrently.
+  std::vector<uint8_t> converged(pending_count, 0);
+  auto tick = [&](int64_t i) {
+    SimObjectT& nc = objects[pending[i]];
+    converged[i] = nc.Tick(*this);
+    VLOG(2) << absl::StreamFormat(" NC %x Converged %d",
+                                  nc.GetId().AsUInt64(), converged[i]);
+  };
+
+  const int64_t grain = std::max<int64_t>(min_components_per_task_, 1);
+  if (thread_pool_ != nullptr && schedule.independent &&
+      pending_count >= 2 * grain) {
+    thread_pool_->ParallelFor(pending_count, grain, tick);
+  } else {
+    for (int64_t i = 0; i < pending_count; ++i) {
+      tick(i);
+    }
+  }
+
+  // Drop the objects which converged; they have nothing left to do this
+  // cycle.
+  int64_t still_pending = 0;
+  for (int64_t i = 0; i < pending_count; ++i) {
+    if (!converged[i]) {
+      pending[still_pending++] = pending[i];
+    }
+  }
+  pending.resize(still_pending);
+
+  return pending.empty();
+}
+
 bool NocSimulator::Tick() {
-  // Goes through each simulator object and run atick.
+  // Goes through each pending simulator object and run atick.
   // Converges when everyone returns True -- that determines new cycle
 
   bool converged = true;
 
   VLOG(2) << " Network Interfaces";
-  for (SimNetworkInterfaceSrc& nc : network_interface_sources_) {
-    NetworkComponentId id = nc.GetId();
-    bool this_converged = nc.Tick(*this);
-    converged &= this_converged;
-    VLOG(2) << absl::StreamFormat(" NC %x Converged %d", id.AsUInt64(),
-                                  this_converged);
-  }
+  converged &= TickPending(network_interface_sources_, source_schedule_);
 
   VLOG(2) << " Links";
-  for (SimLink& nc : links_) {
-    NetworkComponentId id = nc.GetId();
-    bool this_converged = nc.Tick(*this);
-    converged &= this_converged;
-    VLOG(2) << absl::StreamFormat(" NC %x Converged %d", id.AsUInt64(),
-                                  this_converged);
-  }
+  converged &= TickPending(links_, link_schedule_);
 
   VLOG(2) << " Routers";
-  for (SimInputBufferedVCRouter& nc : routers_) {
-    NetworkComponentId id = nc.GetId();
-    bool this_converged = nc.Tick(*this);
-    converged &= this_converged;
-    VLOG(2) << absl::StreamFormat(" NC %x Converged %d", id.AsUInt64(),
-                                  this_converged);
-  }
+  converged &= TickPending(routers_, router_schedule_);
 
   VLOG(2) << " Sinks";
-  for (SimNetworkInterfaceSink& nc : network_interface_sinks_) {
-    NetworkComponentId id = nc.GetId();
-    bool this_converged = nc.Tick(*this);
-    converged &= this_converged;
-    VLOG(2) << absl::StreamFormat(" NC %x Converged %d", id.AsUInt64(),
-                                  this_converged);
-  }
+  converged &= TickPending(network_interface_sinks_, sink_schedule_);
 
   return converged;
 }
@@ -485,6 +550,7 @@ absl::Status SimInputBufferedVCRouter::InitializeImpl(NocSimulator& simulator) {
   NetworkComponent& nc = network_manager->GetNetworkComponent(id_);
   const PortIndexMap& port_indexer =
       simulator.GetRoutingTable()->GetPortIndices();
+  dense_routes_ = simulator.GetRoutingTable()->GetDenseRouterRoutingTable(id_);
 
   // Setup structures associated with the inputs.
   //  - input to SimConnectionState (input_connection_index_start_ and count_)
@@ -708,6 +774,15 @@ absl::StatusOr<SimInputBufferedVCRouter::PortIndexAndVCIndex>
 SimInputBufferedVCRouter::GetDestinationPortIndexAndVcIndex(
     NocSimulator& simulator, PortIndexAndVCIndex input,
     int64_t destination_index) {
+  if (dense_routes_ != nullptr) {
+    xls::noc::PortIndexAndVCIndex hop = dense_routes_->GetOutputPortIndex(
+        input.port_index, input.vc_index, destination_index);
+    if (hop.port_index_ >= 0) {
+      return PortIndexAndVCIndex{hop.port_index_, hop.vc_index_};
+    }
+  }
+
+  // Falls back to the port-based lookup, which also reports missing routes.
   DistributedRoutingTable* routes = simulator.GetRoutingTable();
 
   XLS_ASSIGN_OR_RETURN(PortId input_port,
@@ -816,9 +891,8 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
         continue;
       }
 
-      DataFlit flit = input_buffers_[i][vc].queue.front().flit;
-      TimedDataFlitInfo metadata = input_buffers_[i][vc].queue.front().metadata;
-      int64_t destination_index = flit.destination_index;
+      DataFlitQueueElement& head = input_buffers_[i][vc].queue.front();
+      int64_t destination_index = head.flit.destination_index;
 
       PortIndexAndVCIndex input{i, vc};
       absl::StatusOr<PortIndexAndVCIndex> output_status =
@@ -832,7 +906,8 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
         VLOG(2) << absl::StreamFormat(
             "... router unable to send data %s vc %d credit now %d"
             " from port index %d to port index %d.",
-            flit, flit.vc, credit_.at(output.port_index).at(output.vc_index), i,
+            head.flit, head.flit.vc,
+            credit_.at(output.port_index).at(output.vc_index), i,
             output.port_index);
         continue;
       }
@@ -845,11 +920,12 @@ bool SimInputBufferedVCRouter::TryForwardPropagation(NocSimulator& simulator) {
         continue;
       }
 
-      // Now send the flit along.
-      output_state.forward_channels.flit = flit;
+      // Now send the flit along, moving it out of the input buffer to avoid
+      // copying its data and route history.
+      output_state.forward_channels.flit = std::move(head.flit);
       output_state.forward_channels.flit.vc = output.vc_index;
       output_state.forward_channels.cycle = current_cycle;
-      output_state.forward_channels.metadata = metadata;
+      output_state.forward_channels.metadata = std::move(head.metadata);
       output_state.forward_channels.metadata.timed_route_info.route.push_back(
           TimedRouteItem{id_, current_cycle});
 
@@ -24,6 +24,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/flit.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -360,6 +361,11 @@ class SimInputBufferedVCRouter : public SimNetworkComponentBase {
 
   // The number of cycles that a transfer from input to output occurred.
   int64_t utilization_cycle_count_;
+
+  // Compiled routing table of this router, owned by the simulator's
+  // DistributedRoutingTable.  If null, routes are looked up by port id.
+  const DistributedRoutingTable::DenseRouterRoutingTable* dense_routes_ =
+      nullptr;
 };
 
 // Main simulator class that drives the simulation and stores simulation
@@ -437,8 +443,28 @@ class NocSimulator {
   absl::Status RunCycle(int64_t max_ticks = 9999);
 
   // Runs a single tick of the simulator.
+  //
+  // Only the components which have not yet converged in the current cycle
+  // are visited; once a component has converged its Tick() is a no-op for
+  // the rest of the cycle, so later ticks of a cycle skip it.
   bool Tick();
 
+  // Ticks the components across the workers of `thread_pool`, which must
+  // outlive the simulator. Passing nullptr (the default) ticks serially.
+  //
+  // Each tick visits the sources, links, routers and sinks in turn with a
+  // barrier in between. Components of one kind are normally only connected
+  // to components of other kinds, so splitting a kind across workers gives
+  // the same result as the serial order; a kind with two components
+  // connected to each other is always ticked serially. A kind is split into
+  // chunks of `min_components_per_task` components, and only once at least
+  // two chunks are pending.
+  void SetThreadPool(ThreadPool* thread_pool,
+                     int64_t min_components_per_task = 64) {
+    thread_pool_ = thread_pool;
+    min_components_per_task_ = min_components_per_task;
+  }
+
   // Register a service to run once at the beginning of each cycle.
   // TODO(tedhong): 2021-07-27 Add a scheme to provide a total order
   //                of services.
@@ -474,6 +500,22 @@ class NocSimulator {
   absl::Status CreateLink(NetworkComponentId nc_id);
   absl::Status CreateRouter(NetworkComponentId nc_id);
 
+  // Scheduling state of the simulation objects of one kind.
+  struct ComponentSchedule {
+    // Indices of the objects which have not converged in the current cycle.
+    std::vector<int64_t> pending;
+
+    // False if two objects of this kind share a connection.
+    bool independent = true;
+  };
+
+  // Marks every simulation object as pending for the current cycle.
+  void ScheduleAllComponents();
+
+  template <typename SimObjectT>
+  bool TickPending(std::vector<SimObjectT>& objects,
+                   ComponentSchedule& schedule);
+
   NetworkManager* mgr_;
   NocParameters* params_;
   DistributedRoutingTable* routing_;
@@ -510,6 +552,14 @@ class NocSimulator {
   std::vector<SimNetworkInterfaceSink> network_interface_sinks_;
   std::vector<SimInputBufferedVCRouter> routers_;
 
+  ComponentSchedule source_schedule_;
+  ComponentSchedule link_schedule_;
+  ComponentSchedule router_schedule_;
+  ComponentSchedule sink_schedule_;
+
+  ThreadPool* thread_pool_ = nullptr;
+  int64_t min_components_per_task_ = 64;
+
   // Shims to services to run at the beginning of each cycle.
   std::vector<NocSimulatorServiceShim*> pre_cycle_services_;
 
@@ -13,11 +13,16 @@
 // limitations under the License.
 
 #include <cstdint>
+#include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/noc/config/network_config.pb.h"
 #include "xls/noc/simulation/common.h"
 #include "xls/noc/simulation/global_routing_table.h"
@@ -387,5 +392,113 @@ TEST(SimTrafficTest, NetworkWithMultiplePathsAndReplay) {
   EXPECT_EQ(simulator.GetRouters()[1].GetUtilizationCycleCount(), 10);
 }
 
+// Cycle of arrival and number of hops of each flit received by each sink,
+// followed by the utilization of each router.
+struct SimulationTrace {
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> received;
+  std::vector<int64_t> router_utilization;
+
+  bool operator==(const SimulationTrace& other) const = default;
+};
+
+absl::StatusOr<SimulationTrace> SimulateLoopWithRandomTraffic(
+    ThreadPool* thread_pool) {
+  NocTrafficManager traffic_mgr;
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow0_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow0_id)
+      .SetName("flow0")
+      .SetSource("SendPort0")
+      .SetDestination("RecvPort1")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(2 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficFlowId flow1_id,
+                       traffic_mgr.CreateTrafficFlow());
+  traffic_mgr.GetTrafficFlow(flow1_id)
+      .SetName("flow1")
+      .SetSource("SendPort1")
+      .SetDestination("RecvPort0")
+      .SetVC("VC0")
+      .SetTrafficRateInMiBps(3 * 1024)
+      .SetPacketSizeInBits(128)
+      .SetBurstProbInMils(7);
+  XLS_ASSIGN_OR_RETURN(TrafficModeId mode0_id,
+                       traffic_mgr.CreateTrafficMode());
+  traffic_mgr.GetTrafficMode(mode0_id)
+      .SetName("Mode 0")
+      .RegisterTrafficFlow(flow0_id)
+      .RegisterTrafficFlow(flow1_id);
+
+  NetworkConfigProto proto;
+  NetworkManager graph;
+  NocParameters params;
+  XLS_RETURN_IF_ERROR(BuildNetworkGraphLoop000(&proto, &graph, &params));
+
+  DistributedRoutingTableBuilderForTrees route_builder;
+  XLS_ASSIGN_OR_RETURN(DistributedRoutingTable routing_table,
+                       route_builder.BuildNetworkRoutingTables(
+                           graph.GetNetworkIds()[0], graph, params));
+
+  RandomNumberInterface rnd;
+  rnd.SetSeed(1000);
+  XLS_ASSIGN_OR_RETURN(
+      NocTrafficInjector traffic_injector,
+      NocTrafficInjectorBuilder().Build(
+          /*cycle_time_in_ps=*/400, mode0_id,
+          routing_table.GetSourceIndices().GetNetworkComponents(),
+          routing_table.GetSinkIndices().GetNetworkComponents(),
+          params.GetNetworkParam(graph.GetNetworkIds()[0])
+              ->GetVirtualChannels(),
+          traffic_mgr, graph, params, rnd));
+
+  NocSimulator simulator;
+  XLS_RETURN_IF_ERROR(simulator.Initialize(graph, params, routing_table,
+                                           graph.GetNetworkIds()[0]));
+  simulator.SetThreadPool(thread_pool, /*min_components_per_task=*/1);
+
+  NocSimulatorToNocTrafficInjectorShim injector_shim(simulator,
+                                                     traffic_injector);
+  traffic_injector.SetSimulatorShim(injector_shim);
+  simulator.RegisterPreCycleService(injector_shim);
+
+  for (int64_t i = 0; i < 2'000; ++i) {
+    XLS_RETURN_IF_ERROR(simulator.RunCycle());
+  }
+
+  SimulationTrace trace;
+  for (const char* sink_name : {"RecvPort0", "RecvPort1"}) {
+    XLS_ASSIGN_OR_RETURN(NetworkComponentId sink_id,
+                         FindNetworkComponentByName(sink_name, graph, params));
+    XLS_ASSIGN_OR_RETURN(SimNetworkInterfaceSink * sink,
+                         simulator.GetSimNetworkInterfaceSink(sink_id));
+    std::vector<std::pair<int64_t, int64_t>>& received =
+        trace.received.emplace_back();
+    for (const TimedDataFlit& flit : sink->GetReceivedTraffic()) {
+      received.push_back(
+          {flit.cycle, flit.metadata.timed_route_info.route.size()});
+    }
+  }
+  for (const SimInputBufferedVCRouter& router : simulator.GetRouters()) {
+    trace.router_utilization.push_back(router.GetUtilizationCycleCount());
+  }
+  return trace;
+}
+
+// Splitting the components across a thread pool doesn't change the results
+// of the simulation.
+TEST(SimTrafficTest, ThreadPoolMatchesSerial) {
+  XLS_ASSERT_OK_AND_ASSIGN(SimulationTrace serial,
+                           SimulateLoopWithRandomTraffic(nullptr));
+  ThreadPool pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(SimulationTrace parallel,
+                           SimulateLoopWithRandomTraffic(&pool));
+
+  EXPECT_FALSE(serial.received[0].empty());
+  EXPECT_FALSE(serial.received[1].empty());
+  EXPECT_EQ(serial, parallel);
+}
+
 }  // namespace
 }  // namespace xls::noc
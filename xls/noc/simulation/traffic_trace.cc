@@ -0,0 +1,205 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/traffic_trace.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>  // NOLINT
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/noc/simulation/packetizer.h"
+#include "xls/noc/simulation/traffic_models.h"
+
+namespace xls::noc {
+namespace {
+
+constexpr std::string_view kTraceMagic = "XLSNOCTR";
+constexpr uint32_t kTraceFormatVersion = 1;
+
+struct TraceHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t flow_count;
+  int64_t cycle_count;
+  int64_t reserved;
+};
+static_assert(sizeof(TraceHeader) == 32);
+
+struct TraceFlow {
+  uint64_t first_entry;
+  uint64_t entry_count;
+};
+static_assert(sizeof(TraceFlow) == 16);
+
+template <typename T>
+void AppendRaw(const T& value, std::string& out) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+}  // namespace
+
+absl::Status WriteTrafficTrace(
+    absl::Span<const std::unique_ptr<TrafficModel>> models,
+    int64_t cycle_count, const std::filesystem::path& path) {
+  XLS_RET_CHECK_GE(cycle_count, 0);
+  XLS_RET_CHECK_LE(models.size(), std::numeric_limits<uint32_t>::max());
+
+  std::vector<std::vector<TrafficTraceEntry>> flows(models.size());
+  for (int64_t i = 0; i < models.size(); ++i) {
+    for (int64_t cycle = 0; cycle < cycle_count; ++cycle) {
+      for (const DataPacket& packet : models[i]->GetNewCyclePackets(cycle)) {
+        XLS_RET_CHECK_LE(packet.data.bit_count(),
+                         std::numeric_limits<int32_t>::max());
+        flows[i].push_back(TrafficTraceEntry{
+            .cycle = cycle,
+            .packet_size_bits = static_cast<int32_t>(packet.data.bit_count()),
+            .destination_index = packet.destination_index,
+            .vc = packet.vc});
+      }
+    }
+  }
+
+  TraceHeader header{};
+  std::memcpy(header.magic, kTraceMagic.data(), sizeof(header.magic));
+  header.version = kTraceFormatVersion;
+  header.flow_count = static_cast<uint32_t>(flows.size());
+  header.cycle_count = cycle_count;
+
+  std::string contents;
+  AppendRaw(header, contents);
+  uint64_t first_entry = 0;
+  for (const std::vector<TrafficTraceEntry>& flow : flows) {
+    AppendRaw(TraceFlow{.first_entry = first_entry,
+                        .entry_count = flow.size()},
+              contents);
+    first_entry += flow.size();
+  }
+  for (const std::vector<TrafficTraceEntry>& flow : flows) {
+    contents.append(reinterpret_cast<const char*>(flow.data()),
+                    flow.size() * sizeof(TrafficTraceEntry));
+  }
+  return SetFileContents(path, contents);
+}
+
+absl::StatusOr<std::shared_ptr<const TrafficTrace>> TrafficTrace::Open(
+    const std::filesystem::path& path) {
+  XLS_ASSIGN_OR_RETURN(MappedFile file, MappedFile::Open(path));
+  size_t size = file.size();
+  if (size < sizeof(TraceHeader)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(path.string(), " is not a traffic trace"));
+  }
+  const char* bytes = static_cast<const char*>(file.data());
+  std::unique_ptr<TrafficTrace> trace =
+      absl::WrapUnique(new TrafficTrace(std::move(file)));
+
+  TraceHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::string_view(header.magic, sizeof(header.magic)) != kTraceMagic) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(path.string(), " is not a traffic trace"));
+  }
+  if (header.version != kTraceFormatVersion) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unsupported traffic trace version %d (expected %d)",
+                        header.version, kTraceFormatVersion));
+  }
+  size_t entries_offset =
+      sizeof(TraceHeader) + header.flow_count * sizeof(TraceFlow);
+  if (header.cycle_count < 0 || entries_offset > size ||
+      (size - entries_offset) % sizeof(TrafficTraceEntry) != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed traffic trace ", path.string()));
+  }
+  uint64_t entry_count = (size - entries_offset) / sizeof(TrafficTraceEntry);
+  // mmap returns page-aligned memory and the header and flow table are a
+  // multiple of 16 bytes long, so the entries are suitably aligned.
+  const TrafficTraceEntry* entries =
+      reinterpret_cast<const TrafficTraceEntry*>(bytes + entries_offset);
+
+  trace->cycle_count_ = header.cycle_count;
+  trace->flows_.reserve(header.flow_count);
+  for (int64_t i = 0; i < header.flow_count; ++i) {
+    TraceFlow flow;
+    std::memcpy(&flow, bytes + sizeof(TraceHeader) + i * sizeof(TraceFlow),
+                sizeof(flow));
+    if (flow.first_entry > entry_count ||
+        flow.entry_count > entry_count - flow.first_entry) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Malformed traffic trace %s: flow %d is out of bounds",
+          path.string(), i));
+    }
+    trace->flows_.push_back(
+        absl::MakeConstSpan(entries + flow.first_entry, flow.entry_count));
+  }
+  return trace;
+}
+
+TraceTrafficModel::TraceTrafficModel(std::shared_ptr<const TrafficTrace> trace,
+                                     int64_t flow, int64_t packet_size_bits)
+    : TrafficModel(packet_size_bits),
+      trace_(std::move(trace)),
+      packets_(trace_->FlowPackets(flow)) {}
+
+std::vector<DataPacket> TraceTrafficModel::GetNewCyclePackets(int64_t cycle) {
+  std::vector<DataPacket> packets;
+  while (next_packet_ < packets_.size() &&
+         packets_[next_packet_].cycle <= cycle) {
+    const TrafficTraceEntry& entry = packets_[next_packet_++];
+    CHECK_EQ(entry.cycle, cycle) << "Trace cycles must be replayed in order.";
+    absl::StatusOr<DataPacket> packet =
+        DataPacketBuilder()
+            .Valid(true)
+            .ZeroedData(entry.packet_size_bits)
+            .VirtualChannel(entry.vc)
+            .SourceIndex(source_index_)
+            .DestinationIndex(entry.destination_index)
+            .Build();
+    CHECK(packet.ok());
+    packets.push_back(*std::move(packet));
+  }
+  return packets;
+}
+
+double TraceTrafficModel::ExpectedTrafficRateInMiBps(
+    int64_t cycle_time_ps) const {
+  double total_sec = static_cast<double>(trace_->cycle_count()) *
+                     static_cast<double>(cycle_time_ps) * 1.0e-12;
+  double bits = 0.0;
+  for (const TrafficTraceEntry& entry : packets_) {
+    bits += entry.packet_size_bits;
+  }
+  double mib = bits / 1024.0 / 1024.0 / 8.0;
+  return mib / total_sec;
+}
+
+}  // namespace xls::noc
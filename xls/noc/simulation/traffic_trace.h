@@ -0,0 +1,114 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_NOC_SIMULATION_TRAFFIC_TRACE_H_
+#define XLS_NOC_SIMULATION_TRAFFIC_TRACE_H_
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/file/mapped_file.h"
+#include "xls/noc/simulation/packetizer.h"
+#include "xls/noc/simulation/traffic_models.h"
+
+// This file contains a compact binary format for pre-generated NOC traffic,
+// so that sweeps over many networks or parameters can share the exact same
+// traffic without drawing random numbers during simulation.
+//
+// A trace file consists of
+//   * a 32-byte header: the magic "XLSNOCTR", a uint32_t format version,
+//     a uint32_t flow count, and an int64_t cycle count followed by 8
+//     reserved bytes,
+//   * one {uint64_t first entry, uint64_t entry count} pair per flow,
+//   * the TrafficTraceEntry array of every flow, in flow order, each sorted
+//     by cycle.
+// All fields are stored in host byte order.
+
+namespace xls::noc {
+
+// A single packet of a trace.
+struct TrafficTraceEntry {
+  int64_t cycle;
+  int32_t packet_size_bits;
+  int16_t destination_index;
+  int16_t vc;
+};
+static_assert(sizeof(TrafficTraceEntry) == 16);
+
+// Runs each of `models` for cycles [0, cycle_count) and writes the packets
+// they generate to `path`, one trace flow per model.
+absl::Status WriteTrafficTrace(
+    absl::Span<const std::unique_ptr<TrafficModel>> models,
+    int64_t cycle_count, const std::filesystem::path& path);
+
+// A read-only, memory-mapped trace file.
+//
+// A trace is immutable once opened, so it may be shared (see
+// NocTrafficInjectorBuilder::SetTrafficTrace) by any number of concurrent
+// simulations.
+class TrafficTrace {
+ public:
+  // Maps the trace at `path` and validates its header and flow table.
+  static absl::StatusOr<std::shared_ptr<const TrafficTrace>> Open(
+      const std::filesystem::path& path);
+
+  TrafficTrace(const TrafficTrace&) = delete;
+  TrafficTrace& operator=(const TrafficTrace&) = delete;
+
+  int64_t flow_count() const { return flows_.size(); }
+
+  // Number of cycles the trace was generated for.
+  int64_t cycle_count() const { return cycle_count_; }
+
+  // Packets of flow `flow`, sorted by cycle.
+  absl::Span<const TrafficTraceEntry> FlowPackets(int64_t flow) const {
+    return flows_.at(flow);
+  }
+
+ private:
+  explicit TrafficTrace(MappedFile file) : file_(std::move(file)) {}
+
+  MappedFile file_;
+  int64_t cycle_count_ = 0;
+  std::vector<absl::Span<const TrafficTraceEntry>> flows_;
+};
+
+// Replays the packets of a single flow of a trace.
+//
+// Packets are sent from the model's source index with the destination and vc
+// recorded in the trace; after the end of the trace no packets are sent.
+class TraceTrafficModel : public TrafficModel {
+ public:
+  TraceTrafficModel(std::shared_ptr<const TrafficTrace> trace, int64_t flow,
+                    int64_t packet_size_bits);
+
+  std::vector<DataPacket> GetNewCyclePackets(int64_t cycle) override;
+
+  double ExpectedTrafficRateInMiBps(int64_t cycle_time_ps) const override;
+
+ private:
+  std::shared_ptr<const TrafficTrace> trace_;
+  absl::Span<const TrafficTraceEntry> packets_;
+  int64_t next_packet_ = 0;
+};
+
+}  // namespace xls::noc
+
+#endif  // XLS_NOC_SIMULATION_TRAFFIC_TRACE_H_
@@ -0,0 +1,156 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/noc/simulation/traffic_trace.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/noc/simulation/packetizer.h"
+#include "xls/noc/simulation/random_number_interface.h"
+#include "xls/noc/simulation/traffic_models.h"
+
+namespace xls::noc {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+std::vector<std::unique_ptr<TrafficModel>> MakeGeometricModels(
+    RandomNumberInterface& rnd) {
+  std::vector<std::unique_ptr<TrafficModel>> models;
+  auto first = std::make_unique<GeneralizedGeometricTrafficModel>(
+      0.2, 0.1, 128, rnd);
+  first->SetVCIndex(1);
+  first->SetSourceIndex(0);
+  first->SetDestinationIndex(3);
+  models.push_back(std::move(first));
+  auto second =
+      std::make_unique<GeneralizedGeometricTrafficModel>(0.05, 0.0, 64, rnd);
+  second->SetVCIndex(0);
+  second->SetSourceIndex(1);
+  second->SetDestinationIndex(2);
+  models.push_back(std::move(second));
+  return models;
+}
+
+TEST(TrafficTraceTest, ReplaysGeneratedTraffic) {
+  constexpr int64_t kCycles = 10'000;
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "traffic.trace";
+
+  RandomNumberInterface generate_rnd;
+  generate_rnd.SetSeed(100);
+  XLS_ASSERT_OK(
+      WriteTrafficTrace(MakeGeometricModels(generate_rnd), kCycles, path));
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TrafficTrace> trace,
+                           TrafficTrace::Open(path));
+  EXPECT_EQ(trace->flow_count(), 2);
+  EXPECT_EQ(trace->cycle_count(), kCycles);
+  EXPECT_FALSE(trace->FlowPackets(0).empty());
+  EXPECT_FALSE(trace->FlowPackets(1).empty());
+
+  // The same seed regenerates the traffic which was traced.
+  RandomNumberInterface expected_rnd;
+  expected_rnd.SetSeed(100);
+  std::vector<std::unique_ptr<TrafficModel>> expected_models =
+      MakeGeometricModels(expected_rnd);
+
+  for (int64_t flow = 0; flow < 2; ++flow) {
+    TrafficModel& expected = *expected_models[flow];
+    TraceTrafficModel model(trace, flow, expected.GetPacketSizeInBits());
+    model.SetSourceIndex(expected.GetSourceIndex());
+    int64_t packet_count = 0;
+    for (int64_t cycle = 0; cycle < kCycles; ++cycle) {
+      std::vector<DataPacket> expected_packets =
+          expected.GetNewCyclePackets(cycle);
+      std::vector<DataPacket> packets = model.GetNewCyclePackets(cycle);
+      ASSERT_EQ(packets.size(), expected_packets.size()) << cycle;
+      for (int64_t i = 0; i < packets.size(); ++i) {
+        EXPECT_EQ(packets[i].ToString(), expected_packets[i].ToString());
+      }
+      packet_count += packets.size();
+    }
+    EXPECT_EQ(packet_count, trace->FlowPackets(flow).size());
+    EXPECT_TRUE(model.GetNewCyclePackets(kCycles).empty());
+  }
+}
+
+TEST(TrafficTraceTest, RecordsReplayCycles) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "traffic.trace";
+
+  std::vector<int64_t> cycles = {2, 3, 7, 20};
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ReplayTrafficModel> replay,
+                           ReplayTrafficModelBuilder(32, cycles)
+                               .SetVCIndex(0)
+                               .SetSourceIndex(0)
+                               .SetDestinationIndex(1)
+                               .Build());
+  std::vector<std::unique_ptr<TrafficModel>> models;
+  models.push_back(std::move(replay));
+  // Packets after the end of the trace are dropped.
+  XLS_ASSERT_OK(WriteTrafficTrace(models, /*cycle_count=*/10, path));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::shared_ptr<const TrafficTrace> trace,
+                           TrafficTrace::Open(path));
+  ASSERT_EQ(trace->flow_count(), 1);
+  std::vector<int64_t> traced_cycles;
+  for (const TrafficTraceEntry& entry : trace->FlowPackets(0)) {
+    EXPECT_EQ(entry.packet_size_bits, 32);
+    EXPECT_EQ(entry.destination_index, 1);
+    traced_cycles.push_back(entry.cycle);
+  }
+  EXPECT_THAT(traced_cycles, ElementsAre(2, 3, 7));
+
+  TraceTrafficModel model(trace, 0, 32);
+  // 3 packets of 32 bits over 10 cycles of 1ns.
+  EXPECT_DOUBLE_EQ(model.ExpectedTrafficRateInMiBps(1000),
+                   96.0 / 8.0 / 1024.0 / 1024.0 / 10.0e-9);
+}
+
+TEST(TrafficTraceTest, RejectsMalformedTraces) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "traffic.trace";
+
+  XLS_ASSERT_OK(
+      SetFileContents(path, "not a trace, but long enough to be one"));
+  EXPECT_THAT(TrafficTrace::Open(path),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("is not a traffic trace")));
+
+  std::vector<std::unique_ptr<TrafficModel>> models;
+  XLS_ASSERT_OK(WriteTrafficTrace(models, /*cycle_count=*/10, path));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(path));
+  // Claim a flow whose table entry is missing.
+  contents[12] = 1;
+  XLS_ASSERT_OK(SetFileContents(path, contents));
+  EXPECT_THAT(TrafficTrace::Open(path),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Malformed traffic trace")));
+}
+
+}  // namespace
+}  // namespace xls::noc
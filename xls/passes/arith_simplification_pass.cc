@@ -1529,24 +1529,16 @@ absl::StatusOr<bool> MatchArithPatterns(int64_t opt_level, Node* n,
 absl::StatusOr<bool> ArithSimplificationPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  bool changed = false;
-  bool pass_changed = false;
-  do {
-    pass_changed = false;
-    for (Node* n : ReverseTopoSort(f)) {
-      if (n->IsDead()) {
-        continue;
-      }
-      XLS_ASSIGN_OR_RETURN(
-          bool node_changed,
-          MatchArithPatterns(options.opt_level, n, StatelessQueryEngine()));
-      if (node_changed) {
-        pass_changed = true;
-      }
-    }
-    changed |= pass_changed;
-  } while (pass_changed);
-  return changed;
+  StatelessQueryEngine query_engine;
+  return TransformNodesToFixedPoint(
+      f,
+      [&](Node* n) -> absl::StatusOr<bool> {
+        if (n->IsDead()) {
+          return false;
+        }
+        return MatchArithPatterns(options.opt_level, n, query_engine);
+      },
+      ReverseTopoSort(f));
 }
 
 REGISTER_OPT_PASS(ArithSimplificationPass);
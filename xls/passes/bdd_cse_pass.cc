@@ -16,14 +16,19 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/module_initializer.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
@@ -35,6 +40,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/simulation_signatures.h"
 
 namespace xls {
 
@@ -96,21 +102,99 @@ absl::StatusOr<std::vector<Node*>> GetNodeOrder(FunctionBase* f) {
   return nodes;
 }
 
+// Returns the nodes which are worth confirming in sweep mode: bits-typed
+// non-literal nodes whose simulation signature is shared with an earlier node
+// in `node_order`. Only these nodes can be replaced.
+absl::flat_hash_set<Node*> GetSweepCandidates(
+    absl::Span<Node* const> node_order,
+    const absl::flat_hash_map<Node*, uint64_t>& signatures) {
+  absl::flat_hash_map<std::pair<int64_t, uint64_t>, Node*> first_with_signature;
+  absl::flat_hash_set<Node*> candidates;
+  for (Node* node : node_order) {
+    if (!node->GetType()->IsBits() || node->Is<Literal>()) {
+      continue;
+    }
+    auto [it, inserted] = first_with_signature.insert(
+        {{node->BitCountOrDie(), signatures.at(node)}, node});
+    if (!inserted) {
+      candidates.insert(it->second);
+      candidates.insert(node);
+    }
+  }
+  return candidates;
+}
+
+// Returns the candidates and their transitive operands up to `depth` levels
+// up. The BDD is only built over this window; other nodes are treated as
+// variables, which bounds the size of the BDD independently of the size of
+// the function.
+absl::flat_hash_set<Node*> GetSweepWindow(
+    const absl::flat_hash_set<Node*>& candidates, int64_t depth) {
+  absl::flat_hash_map<Node*, int64_t> remaining_depth;
+  std::vector<std::pair<Node*, int64_t>> worklist;
+  for (Node* candidate : candidates) {
+    remaining_depth[candidate] = depth;
+    worklist.push_back({candidate, depth});
+  }
+  while (!worklist.empty()) {
+    auto [node, node_depth] = worklist.back();
+    worklist.pop_back();
+    if (node_depth == 0) {
+      continue;
+    }
+    for (Node* operand : node->operands()) {
+      auto [it, inserted] =
+          remaining_depth.insert({operand, node_depth - 1});
+      if (inserted || it->second < node_depth - 1) {
+        it->second = node_depth - 1;
+        worklist.push_back({operand, node_depth - 1});
+      }
+    }
+  }
+  absl::flat_hash_set<Node*> window;
+  window.reserve(remaining_depth.size());
+  for (const auto& [node, _] : remaining_depth) {
+    window.insert(node);
+  }
+  return window;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> BddCsePass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
+  XLS_ASSIGN_OR_RETURN(std::vector<Node*> node_order, GetNodeOrder(f));
+
+  std::function<bool(const Node*)> node_filter = IsCheapForBdds;
+  absl::flat_hash_map<Node*, uint64_t> signatures;
+  absl::flat_hash_set<Node*> candidates;
+  absl::flat_hash_set<Node*> window;
+  if (mode_ == Mode::kSweep) {
+    XLS_ASSIGN_OR_RETURN(signatures, ComputeSimulationSignatures(f));
+    candidates = GetSweepCandidates(node_order, signatures);
+    if (candidates.empty()) {
+      return false;
+    }
+    window = GetSweepWindow(candidates, kSweepWindowDepth);
+    node_filter = [&window](const Node* node) {
+      return window.contains(node) && IsCheapForBdds(node);
+    };
+  }
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<BddFunction> bdd_function,
-      BddFunction::Run(f, BddFunction::kDefaultPathLimit, IsCheapForBdds));
+      BddFunction::Run(f, BddFunction::kDefaultPathLimit, node_filter));
 
   // To improve efficiency, bucket potentially common nodes together. The
   // bucketing is done via a int64_t hash value of the BDD node indices of each
-  // bit of the node.
+  // bit of the node. In sweep mode the simulation signature is used instead,
+  // which is cheaper and only places candidates in non-singleton buckets.
   auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
+  auto node_hash = [&](Node* n) -> int64_t {
     CHECK(n->GetType()->IsBits());
+    if (mode_ == Mode::kSweep) {
+      return absl::HashOf(n->BitCountOrDie(), signatures.at(n));
+    }
     std::vector<int64_t> values_to_hash;
     values_to_hash.reserve(n->BitCountOrDie());
     for (int64_t i = 0; i < n->BitCountOrDie(); ++i) {
@@ -133,12 +217,15 @@ absl::StatusOr<bool> BddCsePass::RunOnFunctionBaseInternal(
 
   bool changed = false;
   absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
-  node_buckets.reserve(f->node_count());
-  XLS_ASSIGN_OR_RETURN(std::vector<Node*> node_order, GetNodeOrder(f));
+  node_buckets.reserve(mode_ == Mode::kSweep ? candidates.size()
+                                             : f->node_count());
   for (Node* node : node_order) {
     if (!node->GetType()->IsBits() || node->Is<Literal>()) {
       continue;
     }
+    if (mode_ == Mode::kSweep && !candidates.contains(node)) {
+      continue;
+    }
 
     int64_t hash = node_hash(node);
     if (!node_buckets.contains(hash)) {
@@ -167,4 +254,9 @@ absl::StatusOr<bool> BddCsePass::RunOnFunctionBaseInternal(
 
 REGISTER_OPT_PASS(BddCsePass);
 
+XLS_REGISTER_MODULE_INITIALIZER(bdd_cse_sweep_pass, {
+  CHECK_OK(RegisterOptimizationPass<BddCsePass>(BddCsePass::kSweepName,
+                                                BddCsePass::Mode::kSweep));
+});
+
 }  // namespace xls
@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_BDD_CSE_PASS_H_
 #define XLS_PASSES_BDD_CSE_PASS_H_
 
+#include <cstdint>
 #include <string_view>
 
 #include "absl/status/statusor.h"
@@ -28,16 +29,39 @@ namespace xls {
 // diagrams.
 class BddCsePass : public OptimizationFunctionBasePass {
  public:
+  enum class Mode {
+    // Builds a BDD over the whole function and commons every pair of nodes
+    // whose BDDs are identical.
+    kFullBdd,
+    // Sweeps for equivalences in the style of FRAIGs: nodes are first bucketed
+    // by random simulation signatures (see simulation_signatures.h) and only
+    // nodes sharing a bucket are confirmed with a BDD. The BDD is built over
+    // the fan-in of those nodes up to kSweepWindowDepth levels, treating nodes
+    // beyond it as variables, so memory is bounded on large functions at the
+    // cost of missing equivalences which need a deeper window.
+    kSweep,
+  };
+
   static constexpr std::string_view kName = "bdd_cse";
-  explicit BddCsePass()
+  static constexpr std::string_view kSweepName = "bdd_cse_sweep";
+  static constexpr int64_t kSweepWindowDepth = 16;
+
+  explicit BddCsePass(Mode mode = Mode::kFullBdd)
       : OptimizationFunctionBasePass(
-            kName, "BDD-based Common Subexpression Elimination") {}
+            mode == Mode::kSweep ? kSweepName : kName,
+            mode == Mode::kSweep
+                ? "BDD-based Common Subexpression Elimination (sweep)"
+                : "BDD-based Common Subexpression Elimination"),
+        mode_(mode) {}
   ~BddCsePass() override = default;
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+ private:
+  Mode mode_;
 };
 
 }  // namespace xls
@@ -42,6 +42,12 @@ class BddCsePassTest : public IrTestBase {
     return BddCsePass().RunOnFunctionBase(f, OptimizationPassOptions(),
                                           &results);
   }
+
+  absl::StatusOr<bool> RunSweep(Function* f) {
+    PassResults results;
+    return BddCsePass(BddCsePass::Mode::kSweep)
+        .RunOnFunctionBase(f, OptimizationPassOptions(), &results);
+  }
 };
 
 TEST_F(BddCsePassTest, EqEquivalentToNotNe) {
@@ -89,5 +95,50 @@ TEST_F(BddCsePassTest, DecodeEquivalentToDeconstructedDecode) {
   EXPECT_THAT(f->return_value(), m::Tuple(m::Decode(), m::Decode()));
 }
 
+TEST_F(BddCsePassTest, SweepEqEquivalentToNotNe) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue forty_two = fb.Literal(UBits(42, 16));
+  BValue x_eq_42 = fb.Eq(x, forty_two);
+  BValue forty_two_not_ne_x = fb.Not(fb.Ne(forty_two, x));
+  fb.Tuple({x_eq_42, forty_two_not_ne_x});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(RunSweep(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Eq(m::Param("x"), m::Literal(42)),
+                       m::Eq(m::Param("x"), m::Literal(42))));
+}
+
+TEST_F(BddCsePassTest, SweepDifferentExpressions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  fb.Tuple({fb.Add(x, y), fb.Subtract(x, y), fb.And(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(RunSweep(f), IsOkAndHolds(false));
+}
+
+// The operands of the adds are equivalent but not identical, so the sweep
+// must confirm the operands before the adds can be commoned.
+TEST_F(BddCsePassTest, SweepCommonsThroughEquivalentOperands) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue x_and_y = fb.And(x, y);
+  BValue not_nx_or_ny = fb.Not(fb.Or(fb.Not(x), fb.Not(y)));
+  BValue sum_a = fb.Add(x_and_y, y);
+  BValue sum_b = fb.Add(not_nx_or_ny, y);
+  fb.Tuple({sum_a, sum_b});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(RunSweep(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+}
+
 }  // namespace
 }  // namespace xls
@@ -235,7 +235,8 @@ class BddStatistics {
 
 /* static */ absl::StatusOr<std::unique_ptr<BddFunction>> BddFunction::Run(
     FunctionBase* f, int64_t path_limit,
-    std::optional<std::function<bool(const Node*)>> node_filter) {
+    std::optional<std::function<bool(const Node*)>> node_filter,
+    bool dynamic_reordering, int64_t node_limit) {
   VLOG(1) << absl::StreamFormat("BddFunction::Run(%s), %d nodes:", f->name(),
                                 f->node_count());
   XLS_VLOG_LINES(5, f->DumpIr());
@@ -255,6 +256,7 @@ class BddStatistics {
   VLOG(3) << "BDD expressions:";
   absl::flat_hash_map<Node*, SaturatingBddNodeVector> values;
   BddStatistics bdd_stats;
+  int64_t collection_size = kMinGarbageCollectionSize;
   for (Node* node : TopoSort(f)) {
     VLOG(3) << "node: " << node->ToString();
     if (!node->GetType()->IsBits()) {
@@ -271,7 +273,7 @@ class BddStatistics {
     // If we shouldn't evaluate this node, the node is to be modeled as
     // variables, or the node includes some non-bits-typed operands, then just
     // create a vector of new BDD variables for this node.
-    if (!ShouldEvaluate(node) ||
+    if (!ShouldEvaluate(node) || bdd_function->exceeded_node_limit_ ||
         (node_filter.has_value() && !node_filter.value()(node)) ||
         std::any_of(node->operands().begin(), node->operands().end(),
                     [](Node* o) { return !o->GetType()->IsBits(); })) {
@@ -311,6 +313,35 @@ class BddStatistics {
     if (stop_watch.has_value()) {
       bdd_stats.AddOp(node->op(), stop_watch->GetElapsedTime());
     }
+
+    // Only the expressions of the nodes evaluated so far are live; free the
+    // intermediate expressions computed along the way.
+    BinaryDecisionDiagram& bdd = bdd_function->bdd();
+    bool over_node_limit = node_limit > 0 && bdd.size() > node_limit &&
+                           !bdd_function->exceeded_node_limit_;
+    if (bdd.size() > collection_size || over_node_limit) {
+      std::vector<BddNodeIndex> roots;
+      for (const auto& [_, value] : values) {
+        for (const SaturatingBddNodeIndex& bit : value) {
+          roots.push_back(std::get<BddNodeIndex>(bit));
+        }
+      }
+      if (dynamic_reordering) {
+        bdd.Reorder(roots);
+      } else {
+        bdd.GarbageCollect(roots);
+      }
+      collection_size = std::max(kMinGarbageCollectionSize, 2 * bdd.size());
+      VLOG(2) << absl::StreamFormat("BDD has %d nodes after collection",
+                                    bdd.size());
+    }
+    if (over_node_limit && bdd.size() > node_limit) {
+      VLOG(1) << absl::StreamFormat(
+          "BDD exceeded the limit of %d nodes at %s; modeling the remaining "
+          "nodes as variables",
+          node_limit, node->GetName());
+      bdd_function->exceeded_node_limit_ = true;
+    }
   }
   XLS_VLOG_LINES(2, bdd_stats.ToString());
 
@@ -57,6 +57,11 @@ class BddFunction {
   // variable. This provides a mechanism for limiting the growth of the BDD.
   static constexpr int64_t kDefaultPathLimit = 1024;
 
+  // The number of BDD nodes below which the BDD is never garbage collected
+  // (or reordered) during construction. Above it, the BDD is collected each
+  // time it doubles in size.
+  static constexpr int64_t kMinGarbageCollectionSize = int64_t{1} << 16;
+
   // Construct a BDD representing the given function/proc.
   // `node_filter` is an optional function which filters the nodes to be
   // evaluated. If this function returns false for a node then the node will not
@@ -64,10 +69,19 @@ class BddFunction {
   // for which no information is known. If `node_filter` returns true, the node
   // still might *not* be evaluated because some kinds of nodes are never
   // evaluated for various reasons including computation expense.
+  //
+  // The BDD nodes of intermediate expressions are garbage collected as the BDD
+  // grows. If `dynamic_reordering` is true, the variable order is also
+  // improved by sifting at each collection.
+  //
+  // If `node_limit` is positive, then once the BDD holds more than that many
+  // live nodes every remaining node is modeled as new variables, as if it had
+  // been filtered out, bounding the memory used on large functions.
   static absl::StatusOr<std::unique_ptr<BddFunction>> Run(
       FunctionBase* f, int64_t path_limit = 0,
       std::optional<std::function<bool(const Node*)>> node_filter =
-          std::nullopt);
+          std::nullopt,
+      bool dynamic_reordering = false, int64_t node_limit = 0);
 
   // Returns the underlying BDD.
   const BinaryDecisionDiagram& bdd() const { return bdd_; }
@@ -76,6 +90,10 @@ class BddFunction {
   FunctionBase* function_base() const { return func_base_; }
 
   // Returns the node associated with the given bit.
+  // Returns whether construction stopped evaluating nodes because the BDD
+  // exceeded the `node_limit` given to Run.
+  bool exceeded_node_limit() const { return exceeded_node_limit_; }
+
   BddNodeIndex GetBddNode(Node* node, int64_t bit_index) const {
     std::optional<BddNodeIndex> bdd_node = TryGetBddNode(node, bit_index);
     CHECK(bdd_node.has_value());
@@ -113,6 +131,8 @@ class BddFunction {
   // BDD. These are the XLS Nodes for which it was determined the precisely
   // computing the expression for the node using the BDD was too expensive.
   absl::flat_hash_set<Node*> saturated_expressions_;
+
+  bool exceeded_node_limit_ = false;
 };
 
 // Returns true if the given node is very cheap to evaluate using a
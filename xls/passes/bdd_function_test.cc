@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <random>
 #include <string>
 #include <vector>
@@ -116,6 +117,35 @@ TEST_F(BddFunctionTest, Parity) {
   }
 }
 
+TEST_F(BddFunctionTest, NodeLimit) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue parity = fb.Literal(UBits(0, 1));
+  for (int64_t i = 0; i < 32; ++i) {
+    parity = fb.Xor(parity, fb.BitSlice(x, i, 1));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<BddFunction> unlimited,
+                           BddFunction::Run(f));
+  EXPECT_FALSE(unlimited->exceeded_node_limit());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<BddFunction> limited,
+      BddFunction::Run(f, /*path_limit=*/0, /*node_filter=*/std::nullopt,
+                       /*dynamic_reordering=*/false, /*node_limit=*/40));
+  EXPECT_TRUE(limited->exceeded_node_limit());
+  // Nodes past the limit are variables, so evaluation is still correct.
+  std::minstd_rand engine;
+  for (int64_t i = 0; i < 100; ++i) {
+    std::vector<Value> inputs = RandomFunctionArguments(f, engine);
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Value expected, DropInterpreterEvents(InterpretFunction(f, inputs)));
+    EXPECT_THAT(limited->Evaluate(inputs), IsOkAndHolds(expected));
+  }
+}
+
 TEST_F(BddFunctionTest, BenchmarkTest) {
   // Run samples through various benchmarks and verify against the interpreter.
   //
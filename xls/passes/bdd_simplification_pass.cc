@@ -43,11 +43,11 @@
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/passes/bdd_function.h"
-#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
@@ -443,14 +443,17 @@ absl::StatusOr<bool> BddSimplificationPass::RunOnFunctionBaseInternal(
     PassResults* results) const {
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<BddQueryEngine>(
-      BddFunction::kDefaultPathLimit, IsCheapForBdds));
+  query_engines.push_back(MakeBddQueryEngine(
+      f, BddFunction::kDefaultPathLimit, options.query_engine_cache));
 
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
 
   bool modified = false;
   for (Node* node : TopoSort(f)) {
+    if (PassBudgetExhausted(options, results)) {
+      return modified;
+    }
     XLS_ASSIGN_OR_RETURN(bool node_modified,
                          SimplifyNode(node, query_engine, options.opt_level));
     modified |= node_modified;
@@ -0,0 +1,289 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/carry_save_adder_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+namespace {
+
+// Returns the estimated delay of `node`. As in BddCsePass, operations the delay
+// model does not know (which would be eliminated before codegen) are assumed
+// to be free.
+int64_t NodeDelay(Node* node) {
+  absl::StatusOr<int64_t> delay =
+      GetStandardDelayEstimator().GetOperationDelayInPs(node);
+  return delay.ok() ? *delay : 0;
+}
+
+bool IsAddOrSub(Node* node) {
+  return node->op() == Op::kAdd || node->op() == Op::kSub;
+}
+
+// Returns true if `node` is an addition or subtraction which only feeds `user`,
+// so that it can be merged into the same sum as `user`.
+bool IsInteriorOf(Node* node, Node* user) {
+  return IsAddOrSub(node) && node->GetType() == user->GetType() &&
+         node->users().size() == 1 && *node->users().begin() == user &&
+         user->OperandInstanceCount(node) == 1 &&
+         !node->function_base()->HasImplicitUse(node);
+}
+
+// Returns true if `node` is the root of a tree of additions and subtractions,
+// i.e., it is not merged into the sum of its user.
+bool IsSumRoot(Node* node) {
+  if (!IsAddOrSub(node) || !node->GetType()->IsBits() ||
+      node->BitCountOrDie() < 2) {
+    return false;
+  }
+  return node->users().size() != 1 ||
+         !IsInteriorOf(node, *node->users().begin());
+}
+
+// The terms of a tree of additions and subtractions. A subtracted leaf `x` is
+// added as `~x + 1`, the one being folded into `constant`.
+struct Sum {
+  std::vector<Node*> added;
+  std::vector<Node*> subtracted;
+  // The signed sum of the literal leaves and of the ones from the subtracted
+  // leaves, modulo 2^width.
+  Bits constant;
+  // Estimated delay from the leaves of the tree to its root.
+  int64_t delay = 0;
+
+  int64_t term_count() const {
+    return added.size() + subtracted.size() + (constant.IsZero() ? 0 : 1);
+  }
+};
+
+Sum GatherSum(Node* root) {
+  Sum sum{.constant = Bits(root->BitCountOrDie())};
+  // Interior nodes in an order in which every node precedes its operands.
+  std::vector<Node*> interior;
+  std::vector<std::pair<Node*, bool>> worklist = {{root, false}};
+  while (!worklist.empty()) {
+    auto [node, negated] = worklist.back();
+    worklist.pop_back();
+    interior.push_back(node);
+    for (int64_t i = 0; i < 2; ++i) {
+      Node* operand = node->operand(i);
+      bool operand_negated = negated != (node->op() == Op::kSub && i == 1);
+      if (IsInteriorOf(operand, node)) {
+        worklist.push_back({operand, operand_negated});
+      } else if (operand->Is<Literal>()) {
+        const Bits& value = operand->As<Literal>()->value().bits();
+        sum.constant = operand_negated ? bits_ops::Sub(sum.constant, value)
+                                       : bits_ops::Add(sum.constant, value);
+      } else if (operand_negated) {
+        sum.subtracted.push_back(operand);
+        sum.constant = bits_ops::Increment(sum.constant);
+      } else {
+        sum.added.push_back(operand);
+      }
+    }
+  }
+  absl::flat_hash_map<Node*, int64_t> arrival;
+  for (auto it = interior.rbegin(); it != interior.rend(); ++it) {
+    int64_t start = 0;
+    for (Node* operand : (*it)->operands()) {
+      auto found = arrival.find(operand);
+      if (found != arrival.end()) {
+        start = std::max(start, found->second);
+      }
+    }
+    arrival[*it] = start + NodeDelay(*it);
+  }
+  sum.delay = arrival.at(root);
+  return sum;
+}
+
+// A term of the carry-save tree and the estimated time it becomes available,
+// relative to the leaves of the original tree.
+struct Term {
+  Node* node;
+  int64_t arrival;
+};
+
+// Builds the carry-save form of a sum next to the original tree, remembering
+// the nodes it creates so they can be discarded if the tree is not used.
+class CarrySaveTreeBuilder {
+ public:
+  explicit CarrySaveTreeBuilder(Node* root)
+      : root_(root), width_(root->BitCountOrDie()) {}
+
+  // Returns the final carry-propagate add of the carry-save form of `sum`.
+  absl::StatusOr<Term> Build(const Sum& sum) {
+    std::vector<Term> terms;
+    for (Node* node : sum.added) {
+      terms.push_back(Term{.node = node, .arrival = 0});
+    }
+    for (Node* node : sum.subtracted) {
+      XLS_ASSIGN_OR_RETURN(Node * inverted, Make<UnOp>(node, Op::kNot));
+      terms.push_back(Term{.node = inverted, .arrival = NodeDelay(inverted)});
+    }
+    if (!sum.constant.IsZero()) {
+      XLS_ASSIGN_OR_RETURN(Node * literal, Make<Literal>(Value(sum.constant)));
+      terms.push_back(Term{.node = literal, .arrival = 0});
+    }
+
+    // Sorting latest first keeps the earliest terms at the back. Ties are
+    // broken by node id to keep the result deterministic.
+    auto latest_first = [](const Term& a, const Term& b) {
+      return a.arrival != b.arrival ? a.arrival > b.arrival
+                                    : a.node->id() > b.node->id();
+    };
+    while (terms.size() > 2) {
+      std::sort(terms.begin(), terms.end(), latest_first);
+      std::vector<Term> inputs(terms.end() - 3, terms.end());
+      terms.resize(terms.size() - 3);
+      XLS_ASSIGN_OR_RETURN((auto [sum_term, carry_term]), Compress(inputs));
+      terms.push_back(sum_term);
+      terms.push_back(carry_term);
+    }
+
+    XLS_ASSIGN_OR_RETURN(Node * add,
+                         Make<BinOp>(terms[0].node, terms[1].node, Op::kAdd));
+    return Term{.node = add,
+                .arrival = std::max(terms[0].arrival, terms[1].arrival) +
+                           NodeDelay(add)};
+  }
+
+  // Removes every node created by Build.
+  absl::Status Discard() {
+    for (auto it = created_.rbegin(); it != created_.rend(); ++it) {
+      XLS_RETURN_IF_ERROR(root_->function_base()->RemoveNode(*it));
+    }
+    created_.clear();
+    return absl::OkStatus();
+  }
+
+ private:
+  template <typename NodeT, typename... Args>
+  absl::StatusOr<Node*> Make(Args&&... args) {
+    XLS_ASSIGN_OR_RETURN(Node * node,
+                         root_->function_base()->MakeNode<NodeT>(
+                             root_->loc(), std::forward<Args>(args)...));
+    created_.push_back(node);
+    return node;
+  }
+
+  // Returns the sum and carry terms of a 3:2 compressor of `inputs`:
+  // `a ^ b ^ c` and `((a & b) | (a & c) | (b & c)) << 1`.
+  absl::StatusOr<std::pair<Term, Term>> Compress(
+      absl::Span<const Term> inputs) {
+    std::vector<Node*> nodes;
+    int64_t start = 0;
+    for (const Term& input : inputs) {
+      nodes.push_back(input.node);
+      start = std::max(start, input.arrival);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * sum_bits, Make<NaryOp>(nodes, Op::kXor));
+
+    std::vector<Node*> pairs;
+    int64_t pair_delay = 0;
+    for (auto [a, b] : {std::pair{0, 1}, std::pair{0, 2}, std::pair{1, 2}}) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * pair,
+          Make<NaryOp>(std::vector<Node*>{nodes[a], nodes[b]}, Op::kAnd));
+      pair_delay = std::max(pair_delay, NodeDelay(pair));
+      pairs.push_back(pair);
+    }
+    XLS_ASSIGN_OR_RETURN(Node * majority, Make<NaryOp>(pairs, Op::kOr));
+    XLS_ASSIGN_OR_RETURN(Node * shifted, Make<BitSlice>(majority, /*start=*/0,
+                                                        /*width=*/width_ - 1));
+    XLS_ASSIGN_OR_RETURN(Node * zero, Make<Literal>(Value(UBits(0, 1))));
+    XLS_ASSIGN_OR_RETURN(Node * carry,
+                         Make<Concat>(std::vector<Node*>{shifted, zero}));
+    return std::pair{
+        Term{.node = sum_bits, .arrival = start + NodeDelay(sum_bits)},
+        Term{.node = carry,
+             .arrival = start + pair_delay + NodeDelay(majority) +
+                        NodeDelay(shifted) + NodeDelay(carry)}};
+  }
+
+  Node* root_;
+  int64_t width_;
+  std::vector<Node*> created_;
+};
+
+// Replaces the sum rooted at `root` with a carry-save tree if it has at least
+// three terms and the tree is estimated to be faster. Returns true if `root`
+// was replaced.
+absl::StatusOr<bool> MaybeReplaceWithCarrySaveTree(Node* root) {
+  Sum sum = GatherSum(root);
+  if (sum.term_count() < 3) {
+    return false;
+  }
+
+  CarrySaveTreeBuilder builder(root);
+  XLS_ASSIGN_OR_RETURN(Term result, builder.Build(sum));
+  if (result.arrival >= sum.delay) {
+    VLOG(3) << "Not replacing " << root->GetName() << " with "
+            << sum.term_count() << " terms: carry-save delay "
+            << result.arrival << "ps, original delay " << sum.delay << "ps";
+    XLS_RETURN_IF_ERROR(builder.Discard());
+    return false;
+  }
+  VLOG(3) << "Replacing " << root->GetName() << " with " << sum.term_count()
+          << " terms by a carry-save tree: delay " << result.arrival
+          << "ps, original delay " << sum.delay << "ps";
+  XLS_RETURN_IF_ERROR(root->ReplaceUsesWith(result.node));
+  return true;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> CarrySaveAdderPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  bool changed = false;
+  for (Node* node : TopoSort(f)) {
+    if (!IsSumRoot(node)) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(bool replaced, MaybeReplaceWithCarrySaveTree(node));
+    changed = changed || replaced;
+  }
+  return changed;
+}
+
+REGISTER_OPT_PASS(CarrySaveAdderPass);
+
+}  // namespace xls
@@ -0,0 +1,58 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_CARRY_SAVE_ADDER_PASS_H_
+#define XLS_PASSES_CARRY_SAVE_ADDER_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Replaces trees of additions and subtractions of three or more terms with a
+// carry-save (Wallace) tree of 3:2 compressors followed by a single
+// carry-propagate add. Each compressor turns three terms `a`, `b` and `c` into
+// the two terms `a ^ b ^ c` and `maj(a, b, c) << 1`, whose delay does not
+// depend on the bit width, so only the final add pays for carry propagation.
+// Subtracted terms are added as `~x` plus one, and literal terms are folded
+// into a single constant. The partial products of umulp/smulp operations are
+// ordinary terms, so they are compressed together with the rest of the sum.
+//
+// Terms are compressed earliest-arrival first. A tree is only replaced if the
+// standard delay model estimates that the carry-save form has a shorter
+// critical path than the original tree.
+//
+// The pass is registered but not part of the default pipeline since it turns
+// arithmetic into bitwise operations which later arithmetic simplifications
+// can no longer see; it is intended to run late, just before scheduling.
+class CarrySaveAdderPass : public OptimizationFunctionBasePass {
+ public:
+  static constexpr std::string_view kName = "carry_save_adder";
+  CarrySaveAdderPass()
+      : OptimizationFunctionBasePass(kName, "Carry-save adder trees") {}
+  ~CarrySaveAdderPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_CARRY_SAVE_ADDER_PASS_H_
@@ -0,0 +1,155 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/carry_save_adder_pass.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/solvers/z3_ir_equivalence_testutils.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::_;
+using ::testing::Not;
+using ::xls::solvers::z3::ScopedVerifyEquivalence;
+
+class CarrySaveAdderPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    return CarrySaveAdderPass().Run(p, OptimizationPassOptions(), &results);
+  }
+};
+
+// Returns the number of add operations the return value depends on.
+int64_t LiveAddCount(Function* f) {
+  absl::flat_hash_set<Node*> visited;
+  std::vector<Node*> worklist = {f->return_value()};
+  int64_t count = 0;
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    if (!visited.insert(node).second) {
+      continue;
+    }
+    if (node->op() == Op::kAdd) {
+      ++count;
+    }
+    worklist.insert(worklist.end(), node->operands().begin(),
+                    node->operands().end());
+  }
+  return count;
+}
+
+TEST_F(CarrySaveAdderPassTest, TwoTermsUnchanged) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  fb.Add(fb.Param("a", u32), fb.Param("b", u32));
+  XLS_ASSERT_OK(fb.Build().status());
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(CarrySaveAdderPassTest, WideSum) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue sum = fb.Param("x0", u32);
+  for (int64_t i = 1; i < 8; ++i) {
+    sum = fb.Add(sum, fb.Param(absl::StrCat("x", i), u32));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ScopedVerifyEquivalence stays_equivalent(f);
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  // Only the final carry-propagate add remains.
+  EXPECT_THAT(f->return_value(), m::Add(Not(m::Add()), Not(m::Add())));
+  EXPECT_EQ(LiveAddCount(f), 1);
+  // The result has only two terms so running again changes nothing.
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(CarrySaveAdderPassTest, SubtractionsAndLiterals) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u16 = p->GetBitsType(16);
+  BValue a = fb.Param("a", u16);
+  BValue b = fb.Param("b", u16);
+  BValue c = fb.Param("c", u16);
+  BValue d = fb.Param("d", u16);
+  fb.Subtract(fb.Add(fb.Add(fb.Subtract(a, b), c), fb.Literal(UBits(5, 16))),
+              fb.Subtract(d, fb.Literal(UBits(7, 16))));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ScopedVerifyEquivalence stays_equivalent(f);
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(LiveAddCount(f), 1);
+}
+
+TEST_F(CarrySaveAdderPassTest, PartialProductsAreCompressed) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue mulp = fb.UMulp(fb.Param("a", u32), fb.Param("b", u32));
+  BValue other_mulp = fb.SMulp(fb.Param("c", u32), fb.Param("d", u32));
+  fb.Add(fb.Add(fb.TupleIndex(mulp, 0), fb.TupleIndex(mulp, 1)),
+         fb.Add(fb.TupleIndex(other_mulp, 0), fb.TupleIndex(other_mulp, 1)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  ScopedVerifyEquivalence stays_equivalent(f);
+  ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_EQ(LiveAddCount(f), 1);
+}
+
+TEST_F(CarrySaveAdderPassTest, SharedPartialSumsAreLeaves) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  BValue shared = fb.Add(fb.Param("a", u32), fb.Param("b", u32));
+  fb.Tuple({fb.Add(shared, fb.Param("c", u32)),
+            fb.Add(shared, fb.Param("d", u32))});
+  XLS_ASSERT_OK(fb.Build().status());
+  // Every sum has two terms.
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(CarrySaveAdderPassTest, SingleBitSumUnchanged) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u1 = p->GetBitsType(1);
+  fb.Add(fb.Add(fb.Param("a", u1), fb.Param("b", u1)), fb.Param("c", u1));
+  XLS_ASSERT_OK(fb.Build().status());
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+}  // namespace
+}  // namespace xls
@@ -60,11 +60,11 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/passes/bdd_function.h"
-#include "xls/passes/bdd_query_engine.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/union_query_engine.h"
 
@@ -780,8 +780,8 @@ absl::StatusOr<bool> ConditionalSpecializationPass::RunOnFunctionBaseInternal(
   std::vector<std::unique_ptr<QueryEngine>> query_engines;
   query_engines.push_back(std::make_unique<StatelessQueryEngine>());
   if (use_bdd_) {
-    query_engines.push_back(std::make_unique<BddQueryEngine>(
-        BddFunction::kDefaultPathLimit, IsCheapForBdds));
+    query_engines.push_back(MakeBddQueryEngine(
+        f, BddFunction::kDefaultPathLimit, options.query_engine_cache));
   }
 
   UnionQueryEngine query_engine(std::move(query_engines));
@@ -14,12 +14,22 @@
 
 #include "xls/passes/constant_folding_pass.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
@@ -37,8 +47,9 @@
 namespace xls {
 
 namespace {
-// Check if we can do constant folding on this node.
-bool NodeIsConstantFoldable(Node* node, QueryEngine& query_engine) {
+// Check if the operation of this node can be constant folded, regardless of
+// its operands.
+bool NodeOpIsFoldable(Node* node) {
   if (node->Is<Literal>()) {
     // Already a constant, nothing to do.
     return false;
@@ -51,16 +62,139 @@ bool NodeIsConstantFoldable(Node* node, QueryEngine& query_engine) {
     // Side effecting ops other than 'gate' can't be folded through.
     return false;
   }
+  return true;
+}
+
+// Check if we can do constant folding on this node.
+bool NodeIsConstantFoldable(Node* node, QueryEngine& query_engine) {
+  if (!NodeOpIsFoldable(node)) {
+    return false;
+  }
   // Only ops with all literal operands can be folded.
   return absl::c_all_of(node->operands(), [&](Node* operand) {
     return query_engine.IsFullyKnown(operand);
   });
 }
+
+// Number of nodes evaluated by a single task in the parallel mode.
+constexpr int64_t kParallelChunkSize = 64;
+
 }  // namespace
 
+absl::StatusOr<bool> ConstantFoldingPass::RunParallel(
+    FunctionBase* f, const OptimizationPassOptions& options) const {
+  StatelessQueryEngine query_engine;
+
+  // Gather every node which folds to a constant once its foldable operands
+  // have been folded. The level of a node is one more than the highest level
+  // of its foldable operands, so the nodes of a level only depend on values
+  // from lower levels and known operands.
+  std::vector<Node*> folded;
+  absl::flat_hash_map<Node*, int64_t> folded_index;
+  std::vector<int64_t> node_levels;
+  std::vector<std::vector<int64_t>> levels;
+  for (Node* node : TopoSort(f)) {
+    if (!NodeOpIsFoldable(node)) {
+      continue;
+    }
+    int64_t level = 0;
+    bool foldable = true;
+    for (Node* operand : node->operands()) {
+      auto it = folded_index.find(operand);
+      if (it != folded_index.end()) {
+        level = std::max(level, node_levels[it->second] + 1);
+      } else if (!query_engine.IsFullyKnown(operand)) {
+        foldable = false;
+        break;
+      }
+    }
+    if (!foldable) {
+      continue;
+    }
+    if (level == levels.size()) {
+      levels.emplace_back();
+    }
+    levels[level].push_back(folded.size());
+    folded_index[node] = folded.size();
+    node_levels.push_back(level);
+    folded.push_back(node);
+  }
+  if (folded.empty()) {
+    return false;
+  }
+
+  ThreadPool* pool = options.function_base_thread_pool;
+  std::optional<ThreadPool> owned_pool;
+  if (pool == nullptr &&
+      absl::c_any_of(levels, [](const std::vector<int64_t>& level) {
+        return level.size() >= kMinParallelLevelSize;
+      })) {
+    pool = &owned_pool.emplace();
+  }
+
+  // The IR is not modified until every value has been computed, so the
+  // evaluations only read the IR and each writes its own slot.
+  std::vector<Value> values(folded.size());
+  std::vector<absl::Status> statuses(folded.size());
+  for (const std::vector<int64_t>& level : levels) {
+    auto evaluate = [&](int64_t i) {
+      const int64_t index = level[i];
+      Node* node = folded[index];
+      std::vector<Value> operand_values;
+      operand_values.reserve(node->operand_count());
+      for (Node* operand : node->operands()) {
+        auto it = folded_index.find(operand);
+        operand_values.push_back(it != folded_index.end()
+                                     ? values[it->second]
+                                     : *query_engine.KnownValue(operand));
+      }
+      absl::StatusOr<Value> result = InterpretNode(node, operand_values);
+      if (result.ok()) {
+        values[index] = *std::move(result);
+      } else {
+        statuses[index] = result.status();
+      }
+    };
+    if (level.size() >= kMinParallelLevelSize) {
+      pool->ParallelFor(level.size(), kParallelChunkSize, evaluate);
+    } else {
+      for (int64_t i = 0; i < level.size(); ++i) {
+        evaluate(i);
+      }
+    }
+    for (int64_t index : level) {
+      XLS_RETURN_IF_ERROR(statuses[index]);
+    }
+  }
+
+  // Intern the folded values so nodes with equal values share one literal.
+  absl::flat_hash_map<Value, Literal*> literals;
+  for (Node* node : f->nodes()) {
+    if (node->Is<Literal>()) {
+      literals.emplace(node->As<Literal>()->value(), node->As<Literal>());
+    }
+  }
+  for (int64_t index = 0; index < folded.size(); ++index) {
+    Node* node = folded[index];
+    VLOG(2) << "Folding: " << *node;
+    auto it = literals.find(values[index]);
+    if (it != literals.end() && it->second->GetType() == node->GetType()) {
+      XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(it->second));
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(Literal * literal,
+                         node->ReplaceUsesWithNew<Literal>(values[index]));
+    literals.insert_or_assign(std::move(values[index]), literal);
+  }
+  return true;
+}
+
 absl::StatusOr<bool> ConstantFoldingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
+  if (mode_ == Mode::kParallel) {
+    return RunParallel(f, options);
+  }
   StatelessQueryEngine query_engine;
 
   bool changed = false;
@@ -86,4 +220,10 @@ absl::StatusOr<bool> ConstantFoldingPass::RunOnFunctionBaseInternal(
 
 REGISTER_OPT_PASS(ConstantFoldingPass);
 
+XLS_REGISTER_MODULE_INITIALIZER(const_fold_parallel_pass, {
+  CHECK_OK(RegisterOptimizationPass<ConstantFoldingPass>(
+      ConstantFoldingPass::kParallelName,
+      ConstantFoldingPass::Mode::kParallel));
+});
+
 }  // namespace xls
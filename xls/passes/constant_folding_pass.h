@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONSTANT_FOLDING_PASS_H_
 #define XLS_PASSES_CONSTANT_FOLDING_PASS_H_
 
+#include <cstdint>
 #include <string_view>
 
 #include "absl/status/statusor.h"
@@ -28,15 +29,41 @@ namespace xls {
 // replaced by a equivalent literal. Runs DCE after constant folding.
 class ConstantFoldingPass : public OptimizationFunctionBasePass {
  public:
+  enum class Mode {
+    // Folds nodes one at a time in topological order.
+    kSerial,
+    // Evaluates every foldable node before replacing any of them. Nodes are
+    // grouped into levels by their depth in the constant subgraph and the
+    // nodes of a level, which are independent of one another, are evaluated
+    // concurrently. Folded nodes with equal values share a single literal.
+    // Intended for large constant constructions such as unrolled lookup
+    // table initializers.
+    kParallel,
+  };
+
   static constexpr std::string_view kName = "const_fold";
-  ConstantFoldingPass()
-      : OptimizationFunctionBasePass(kName, "Constant folding") {}
+  static constexpr std::string_view kParallelName = "const_fold_parallel";
+  // Levels with fewer nodes than this are evaluated on the calling thread.
+  static constexpr int64_t kMinParallelLevelSize = 256;
+
+  explicit ConstantFoldingPass(Mode mode = Mode::kSerial)
+      : OptimizationFunctionBasePass(
+            mode == Mode::kParallel ? kParallelName : kName,
+            mode == Mode::kParallel ? "Constant folding (parallel)"
+                                    : "Constant folding"),
+        mode_(mode) {}
   ~ConstantFoldingPass() override = default;
 
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const override;
+
+ private:
+  absl::StatusOr<bool> RunParallel(
+      FunctionBase* f, const OptimizationPassOptions& options) const;
+
+  Mode mode_;
 };
 
 }  // namespace xls
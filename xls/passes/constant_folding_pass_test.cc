@@ -14,6 +14,9 @@
 
 #include "xls/passes/constant_folding_pass.h"
 
+#include <cstdint>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
@@ -21,6 +24,7 @@
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
@@ -41,10 +45,12 @@ class ConstantFoldingPassTest : public IrTestBase {
  protected:
   ConstantFoldingPassTest() = default;
 
-  absl::StatusOr<bool> Run(Function* f) {
+  absl::StatusOr<bool> Run(
+      Function* f,
+      ConstantFoldingPass::Mode mode = ConstantFoldingPass::Mode::kSerial) {
     PassResults results;
     XLS_ASSIGN_OR_RETURN(bool changed,
-                         ConstantFoldingPass().RunOnFunctionBase(
+                         ConstantFoldingPass(mode).RunOnFunctionBase(
                              f, OptimizationPassOptions(), &results));
     // Run dce to clean things up.
     XLS_RETURN_IF_ERROR(
@@ -166,5 +172,57 @@ TEST_F(ConstantFoldingPassTest, GateOpTrue) {
   EXPECT_THAT(f->return_value(), m::Literal(UBits(42, 32)));
 }
 
+TEST_F(ConstantFoldingPassTest, ParallelSharesLiteralsWithEqualValues) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn shared(x: bits[8]) -> (bits[8], bits[8], bits[8]) {
+        literal.1: bits[8] = literal(value=1)
+        literal.2: bits[8] = literal(value=2)
+        literal.3: bits[8] = literal(value=3)
+        add.4: bits[8] = add(literal.1, literal.2)
+        add.5: bits[8] = add(literal.2, literal.1)
+        sub.6: bits[8] = sub(add.4, add.5)
+        add.7: bits[8] = add(sub.6, x)
+        ret tuple.8: (bits[8], bits[8], bits[8]) = tuple(add.4, add.5, add.7)
+     }
+  )",
+                                                       p.get()));
+  EXPECT_THAT(Run(f, ConstantFoldingPass::Mode::kParallel),
+              IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Literal(3), m::Literal(3),
+                       m::Add(m::Literal(0), m::Param("x"))));
+  // Both folded adds share the pre-existing literal with the same value.
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+  EXPECT_EQ(f->return_value()->operand(0)->GetName(), "literal.3");
+}
+
+TEST_F(ConstantFoldingPassTest, ParallelMatchesSerialOnWideTable) {
+  // A table wide enough that its levels are evaluated concurrently.
+  auto build = [](Package* p) -> absl::StatusOr<Function*> {
+    FunctionBuilder fb("table", p);
+    std::vector<BValue> entries;
+    for (int64_t i = 0;
+         i < 4 * ConstantFoldingPass::kMinParallelLevelSize; ++i) {
+      BValue x = fb.Literal(UBits(i, 16));
+      BValue y = fb.Add(fb.UMul(x, x), fb.Literal(UBits(7, 16)));
+      entries.push_back(fb.Xor(y, fb.Shrl(y, fb.Literal(UBits(3, 16)))));
+    }
+    return fb.BuildWithReturnValue(fb.Array(entries, p->GetBitsType(16)));
+  };
+  auto serial_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * serial, build(serial_package.get()));
+  auto parallel_package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * parallel, build(parallel_package.get()));
+
+  EXPECT_THAT(Run(serial), IsOkAndHolds(true));
+  EXPECT_THAT(Run(parallel, ConstantFoldingPass::Mode::kParallel),
+              IsOkAndHolds(true));
+  ASSERT_TRUE(serial->return_value()->Is<Literal>());
+  ASSERT_TRUE(parallel->return_value()->Is<Literal>());
+  EXPECT_EQ(parallel->return_value()->As<Literal>()->value(),
+            serial->return_value()->As<Literal>()->value());
+}
+
 }  // namespace
 }  // namespace xls
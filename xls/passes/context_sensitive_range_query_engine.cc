@@ -28,8 +28,12 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "cppitertools/zip.hpp"
 #include "xls/common/status/ret_check.h"
@@ -181,6 +185,23 @@ struct EquivalenceSet {
   InlineBitmap interesting_nodes;
 };
 
+// The givens a predicate state implies, as (node id, intervals) pairs sorted
+// by node id. Predicate states with equal givens get identical ranges so they
+// share a single propagation.
+using GivensKey = std::vector<std::pair<int64_t, IntervalSetTree>>;
+
+// A set of predicate states which share a single range propagation.
+struct SharedContext {
+  std::vector<PredicateState> states;
+  absl::flat_hash_map<Node*, RangeData> known_data;
+  // Union of the nodes affected by the givens of all states.
+  InlineBitmap interesting_nodes;
+  // The state whose select is last in topological order. Propagating up to it
+  // covers every other state.
+  PredicateState last_state;
+  int64_t last_topo_index;
+};
+
 // Helper to perform the actual analysis and hold together all data needed.
 // This is used to fill in the fields of the actual query engine and therefore
 // does not own the arena/map that it fills in.
@@ -193,12 +214,25 @@ class Analysis {
   Analysis(
       RangeQueryEngine& base_range,
       std::vector<std::unique_ptr<const RangeQueryEngine>>& arena,
-      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines)
-      : base_range_(base_range), arena_(arena), engines_(engines) {}
+      absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines,
+      int64_t max_specializations, absl::Duration time_budget,
+      ContextSensitiveRangeQueryEngine::Statistics& statistics)
+      : base_range_(base_range),
+        arena_(arena),
+        engines_(engines),
+        max_specializations_(max_specializations),
+        time_budget_(time_budget),
+        statistics_(statistics) {}
 
   absl::StatusOr<ReachedFixpoint> Execute(FunctionBase* f) {
+    absl::Time start = absl::Now();
     // Get the topological sort once so we don't recalculate it each time.
     topo_sort_ = TopoSort(f);
+    absl::flat_hash_map<Node*, int64_t> topo_index;
+    topo_index.reserve(topo_sort_.size());
+    for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+      topo_index[topo_sort_[i]] = i;
+    }
     // Get the base case.
     absl::flat_hash_map<Node*, RangeData> empty;
     ContextGivens base_givens(
@@ -226,43 +260,112 @@ class Analysis {
     XLS_ASSIGN_OR_RETURN(auto interesting,
                          FilterUninterestingStates(f, all_states));
     // Bucket states into equivalence classes. Any predicate-states where the
-    // arm and selector are identical
+    // arm and selector are identical. The order of `equivalence_order` follows
+    // the topological order so the results don't depend on hash iteration
+    // order.
     absl::flat_hash_map<SelectorAndArm, EquivalenceSet> equivalences;
+    std::vector<SelectorAndArm> equivalence_order;
     equivalences.reserve(interesting.state_and_nodes.size());
     for (const auto& [state, interesting_nodes] : interesting.state_and_nodes) {
-      EquivalenceSet& cur =
-          equivalences
-              .try_emplace(
-                  SelectorAndArm{
-                      .selector = state.node()->As<Select>()->selector(),
-                      .arm = state.arm()},
-                  EquivalenceSet{
-                      .equivalent_states = {},
-                      .interesting_nodes = InlineBitmap(f->node_count())})
-              .first->second;
-      cur.equivalent_states.push_back(state);
-      cur.interesting_nodes.Union(interesting_nodes);
+      SelectorAndArm key{.selector = state.node()->As<Select>()->selector(),
+                         .arm = state.arm()};
+      auto [it, inserted] = equivalences.try_emplace(
+          key, EquivalenceSet{
+                   .equivalent_states = {},
+                   .interesting_nodes = InlineBitmap(f->node_count())});
+      if (inserted) {
+        equivalence_order.push_back(key);
+      }
+      it->second.equivalent_states.push_back(state);
+      it->second.interesting_nodes.Union(interesting_nodes);
     }
-    // NB We don't care what order we examine each equivalence (since all are
-    // disjoint).
-    for (const auto& [_, states] : equivalences) {
+
+    // Different selectors and arms frequently imply exactly the same givens
+    // (eg `x == 3` and `x != 3` with the arms swapped, or the same comparison
+    // recomputed), so memoize on the givens themselves and run the propagation
+    // once per distinct set of givens.
+    absl::flat_hash_map<GivensKey, int64_t> context_indices;
+    std::vector<SharedContext> contexts;
+    for (const SelectorAndArm& key : equivalence_order) {
+      EquivalenceSet& states = equivalences.at(key);
+      statistics_.predicate_states += states.equivalent_states.size();
       // Since the all_states_ is in topo the last equiv state is usable for
       // everything.
-      // We don't care what order we calculate the equivalences because each is
-      // fully disjoint from one another as we consider only a single condition
-      // to be true at a time.
-      XLS_ASSIGN_OR_RETURN(auto tmp,
-                           CalculateRangeGiven(states.equivalent_states.back(),
-                                               states.interesting_nodes,
-                                               interesting.node_indices));
+      XLS_ASSIGN_OR_RETURN(
+          (absl::flat_hash_map<Node*, RangeData> known_data),
+          ExtractKnownData(states.equivalent_states.back()));
+      if (absl::c_all_of(known_data, [&](const auto& entry) {
+            return entry.second.interval_set ==
+                   base_range_.GetIntervals(entry.first);
+          })) {
+        // Nothing is learned beyond the base case so the specialized ranges
+        // would be identical to it.
+        statistics_.uninformative_states += states.equivalent_states.size();
+        continue;
+      }
+      GivensKey givens_key;
+      givens_key.reserve(known_data.size());
+      for (const auto& [node, data] : known_data) {
+        givens_key.push_back({node->id(), data.interval_set});
+      }
+      absl::c_sort(givens_key, [](const auto& a, const auto& b) {
+        return a.first < b.first;
+      });
+      const PredicateState& last = states.equivalent_states.back();
+      int64_t last_index = topo_index.at(last.node());
+      auto [it, inserted] =
+          context_indices.try_emplace(std::move(givens_key), contexts.size());
+      if (inserted) {
+        contexts.push_back(SharedContext{
+            .states = std::move(states.equivalent_states),
+            .known_data = std::move(known_data),
+            .interesting_nodes = std::move(states.interesting_nodes),
+            .last_state = last,
+            .last_topo_index = last_index});
+        continue;
+      }
+      SharedContext& context = contexts[it->second];
+      absl::c_move(states.equivalent_states,
+                   std::back_inserter(context.states));
+      context.interesting_nodes.Union(states.interesting_nodes);
+      if (last_index > context.last_topo_index) {
+        context.last_state = last;
+        context.last_topo_index = last_index;
+      }
+    }
+
+    // We don't care what order we calculate the contexts because each is fully
+    // disjoint from one another as we consider only a single condition to be
+    // true at a time. Walking them in topological order makes the budget
+    // cut-off deterministic.
+    for (SharedContext& context : contexts) {
+      if ((max_specializations_ > 0 &&
+           statistics_.specializations >= max_specializations_) ||
+          absl::Now() - start >= time_budget_) {
+        statistics_.budget_exhausted = true;
+        statistics_.unspecialized_states += context.states.size();
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(
+          auto tmp, CalculateRangeGiven(context.last_state,
+                                        std::move(context.known_data),
+                                        context.interesting_nodes,
+                                        interesting.node_indices));
+      ++statistics_.specializations;
       auto result =
           arena_
               .emplace_back(std::make_unique<RangeQueryEngine>(std::move(tmp)))
               .get();
-      for (const PredicateState& ps : states.equivalent_states) {
+      for (const PredicateState& ps : context.states) {
         engines_[ps] = result;
       }
     }
+    if (statistics_.budget_exhausted) {
+      VLOG(1) << absl::StreamFormat(
+          "Context sensitive range analysis of %s exceeded its budget; %d "
+          "predicate states fall back to context-free ranges",
+          f->name(), statistics_.unspecialized_states);
+    }
     return ReachedFixpoint::Changed;
   }
 
@@ -322,13 +425,37 @@ class Analysis {
         .state_and_nodes = interesting_states};
   }
   absl::StatusOr<RangeQueryEngine> CalculateRangeGiven(
-      PredicateState s, const InlineBitmap& interesting_nodes,
+      PredicateState s, absl::flat_hash_map<Node*, RangeData> known_data,
+      const InlineBitmap& interesting_nodes,
       const absl::flat_hash_map<Node*, int64_t>& node_ids) const {
     RangeQueryEngine result;
-    absl::flat_hash_map<Node*, RangeData> known_data;
-    XLS_ASSIGN_OR_RETURN(known_data, ExtractKnownData(s));
+    // Only the nodes affected by the known data need to be recomputed; those
+    // are visited along with their operands (which supply the memoized base
+    // ranges the recomputation starts from). Everything else keeps its base
+    // range, which the specialized engine falls back to anyway, so there's no
+    // need to copy it in for every context.
+    absl::flat_hash_set<Node*> needed;
+    for (Node* n : topo_sort_) {
+      if (n == s.node()) {
+        break;
+      }
+      if (interesting_nodes.Get(node_ids.at(n)) || known_data.contains(n)) {
+        needed.insert(n);
+        needed.insert(n->operands().begin(), n->operands().end());
+      }
+    }
+    std::vector<Node*> to_visit;
+    to_visit.reserve(needed.size());
+    for (Node* n : topo_sort_) {
+      if (n == s.node()) {
+        break;
+      }
+      if (needed.contains(n)) {
+        to_visit.push_back(n);
+      }
+    }
     ContextGivens givens(
-        topo_sort_, s.node(), known_data,
+        to_visit, /*finish=*/nullptr, known_data,
         [&](Node* n) -> std::optional<RangeData> {
           if (interesting_nodes.Get(node_ids.at(n))) {
             // Affected by known data.
@@ -396,6 +523,9 @@ class Analysis {
   RangeQueryEngine& base_range_;
   std::vector<std::unique_ptr<const RangeQueryEngine>>& arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*>& engines_;
+  int64_t max_specializations_;
+  absl::Duration time_budget_;
+  ContextSensitiveRangeQueryEngine::Statistics& statistics_;
 };
 
 // A proxy query engine which specializes using select context.
@@ -550,7 +680,9 @@ std::vector<Interval> GetBranchIntervals(Select* n) {
 
 absl::StatusOr<ReachedFixpoint> ContextSensitiveRangeQueryEngine::Populate(
     FunctionBase* f) {
-  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_);
+  statistics_ = Statistics();
+  Analysis analysis(base_case_ranges_, arena_, one_hot_ranges_,
+                    max_specializations_, time_budget_, statistics_);
   XLS_ASSIGN_OR_RETURN(ReachedFixpoint fixpoint, analysis.Execute(f));
   // Fill in select ranges before any changes occur to the function.
   for (Node* n : TopoSort(f)) {
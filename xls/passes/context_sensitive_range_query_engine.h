@@ -15,6 +15,7 @@
 #ifndef XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 #define XLS_PASSES_CONTEXT_SENSITIVE_RANGE_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -23,6 +24,7 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
@@ -46,9 +48,34 @@ namespace xls {
 // given their selector is at the appropriate value and propagating that down
 // for each single case. This means the engine is only able to provide
 // information for a single case at a time.
+//
+// Cases which imply identical givens share a single propagation, and cases
+// which imply nothing beyond the context-free ranges are not propagated at
+// all.
 class ContextSensitiveRangeQueryEngine final : public QueryEngine {
  public:
-  ContextSensitiveRangeQueryEngine() = default;
+  struct Statistics {
+    // Number of interesting predicate states considered.
+    int64_t predicate_states = 0;
+    // Number of range propagations performed. Each is shared by every
+    // predicate state implying the same givens.
+    int64_t specializations = 0;
+    // Number of predicate states whose givens add nothing to the base case.
+    int64_t uninformative_states = 0;
+    // Number of predicate states left unspecialized because the budget was
+    // exhausted.
+    int64_t unspecialized_states = 0;
+    bool budget_exhausted = false;
+  };
+
+  // `max_specializations` is the maximum number of range propagations to
+  // perform (0 means unlimited) and `time_budget` the maximum time to spend
+  // on them. Once either is exhausted the remaining predicate states are left
+  // unspecialized and get the plain RangeQueryEngine results.
+  explicit ContextSensitiveRangeQueryEngine(
+      int64_t max_specializations = 0,
+      absl::Duration time_budget = absl::InfiniteDuration())
+      : max_specializations_(max_specializations), time_budget_(time_budget) {}
 
   absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override;
 
@@ -118,7 +145,12 @@ class ContextSensitiveRangeQueryEngine final : public QueryEngine {
   Bits MaxUnsignedValue(Node* node) const override;
   Bits MinUnsignedValue(Node* node) const override;
 
+  const Statistics& statistics() const { return statistics_; }
+
  private:
+  int64_t max_specializations_;
+  absl::Duration time_budget_;
+  Statistics statistics_;
   RangeQueryEngine base_case_ranges_;
   std::vector<std::unique_ptr<const RangeQueryEngine>> arena_;
   absl::flat_hash_map<PredicateState, const RangeQueryEngine*> one_hot_ranges_;
@@ -17,14 +17,18 @@
 #include <cstdint>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/log/check.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/data_structures/leaf_type_tree.h"
@@ -37,6 +41,8 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value_builder.h"
 #include "xls/passes/predicate_state.h"
@@ -1782,6 +1788,84 @@ TEST_F(ContextSensitiveRangeQueryEngineTest,
             BitsLTT(sel.node(), {Interval(UBits(0, 16), UBits(1, 16))}));
 }
 
+// Two selects on the same selector where the default arm of one and the last
+// case of the other imply the same selector value.
+absl::StatusOr<Function*> SharedSelectorFunction(Package* p,
+                                                 std::string_view name) {
+  FunctionBuilder fb(name, p);
+  BValue s = fb.Param("s", p->GetBitsType(2));
+  BValue v = fb.Add(fb.ZeroExtend(s, 8), fb.Literal(UBits(1, 8)));
+  fb.Select(s, {v, v, v}, v, SourceInfo(), "with_default");
+  fb.Select(s, {v, v, v, v}, std::nullopt, SourceInfo(), "without_default");
+  return fb.Build();
+}
+
+TEST_F(ContextSensitiveRangeQueryEngineTest, SharesIdenticalGivens) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           SharedSelectorFunction(p.get(), TestName()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * with_default, f->GetNode("with_default"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * without_default,
+                           f->GetNode("without_default"));
+  Node* v = without_default->operand(1);
+  ContextSensitiveRangeQueryEngine engine;
+
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  EXPECT_EQ(engine.statistics().predicate_states, 8);
+  // Only four distinct selector values are possible.
+  EXPECT_EQ(engine.statistics().specializations, 4);
+  EXPECT_FALSE(engine.statistics().budget_exhausted);
+  EXPECT_EQ(engine
+                .SpecializeGivenPredicate({PredicateState(
+                    with_default->As<Select>(), PredicateState::kDefaultArm)})
+                ->GetIntervals(v),
+            BitsLTT(v, {Interval::Precise(UBits(4, 8))}));
+  EXPECT_EQ(engine
+                .SpecializeGivenPredicate(
+                    {PredicateState(without_default->As<Select>(), 3)})
+                ->GetIntervals(v),
+            BitsLTT(v, {Interval::Precise(UBits(4, 8))}));
+}
+
+TEST_F(ContextSensitiveRangeQueryEngineTest, FallsBackWhenOverBudget) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           SharedSelectorFunction(p.get(), TestName()));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * with_default, f->GetNode("with_default"));
+  XLS_ASSERT_OK_AND_ASSIGN(Node * without_default,
+                           f->GetNode("without_default"));
+  Node* v = without_default->operand(1);
+  ContextSensitiveRangeQueryEngine engine(/*max_specializations=*/1);
+
+  XLS_ASSERT_OK(engine.Populate(f));
+
+  EXPECT_EQ(engine.statistics().specializations, 1);
+  EXPECT_TRUE(engine.statistics().budget_exhausted);
+  EXPECT_EQ(engine.statistics().unspecialized_states, 6);
+  // The first context in topological order is still specialized.
+  EXPECT_EQ(engine
+                .SpecializeGivenPredicate(
+                    {PredicateState(with_default->As<Select>(), 0)})
+                ->GetIntervals(v),
+            BitsLTT(v, {Interval::Precise(UBits(1, 8))}));
+  // The rest get the context-free ranges.
+  EXPECT_EQ(engine
+                .SpecializeGivenPredicate(
+                    {PredicateState(without_default->As<Select>(), 3)})
+                ->GetIntervals(v),
+            BitsLTT(v, {Interval(UBits(1, 8), UBits(4, 8))}));
+  EXPECT_EQ(engine.GetIntervals(with_default),
+            BitsLTT(v, {Interval(UBits(1, 8), UBits(4, 8))}));
+
+  ContextSensitiveRangeQueryEngine no_time(
+      /*max_specializations=*/0, /*time_budget=*/absl::ZeroDuration());
+  XLS_ASSERT_OK(no_time.Populate(f));
+  EXPECT_EQ(no_time.statistics().specializations, 0);
+  EXPECT_EQ(no_time.GetIntervals(without_default),
+            BitsLTT(v, {Interval(UBits(1, 8), UBits(4, 8))}));
+}
+
 INSTANTIATE_TEST_SUITE_P(Signed, SignedContextSensitiveRangeQueryEngineTest,
                          testing::Values(Signedness::kSigned,
                                          Signedness::kUnsigned),
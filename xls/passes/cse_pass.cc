@@ -14,19 +14,20 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <cstddef>
 #include <cstdint>
-#include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/hash/hash.h"
-#include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
-#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function_base.h"
-#include "xls/ir/node_util.h"
+#include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/topo_sort.h"
@@ -38,52 +39,80 @@ namespace xls {
 
 namespace {
 
-// Returns the operands of the given node for the purposes of the CSE
-// optimization. The order of the nodes may not match the order of the node's
-// actual operands. Motivation: generally for nodes to be considered equivalent
-// the operands must be in the same order. However, commutative operations are
-// agnostic to operand order. So to expand the CSE optimization, compare
-// operands as an unordered set for commutative operands. This is done be
-// ordered commutative operation operands by id prior to comparison. To avoid
-// having to construct a vector every time, a span is returned by this
-// function. If the operation is not commutative, the node's own operand span is
-// simply returned. For the commutative case, a vector of sorted operands is
-// constructed in span_backing_store from which a span is constructed.
-absl::Span<Node* const> GetOperandsForCse(
-    Node* node, std::vector<Node*>* span_backing_store) {
-  CHECK(span_backing_store->empty());
-  if (!OpIsCommutative(node->op())) {
-    return node->operands();
+// Operands of a node as compared by CSE. Generally for nodes to be considered
+// equivalent the operands must be in the same order. However, commutative
+// operations are agnostic to operand order, so to expand the CSE optimization
+// the operands of commutative operations are compared as an unordered set by
+// sorting them by id.
+using CseOperands = absl::InlinedVector<Node*, 4>;
+
+CseOperands GetOperandsForCse(Node* node) {
+  CseOperands operands(node->operands().begin(), node->operands().end());
+  if (OpIsCommutative(node->op())) {
+    absl::c_sort(operands, [](Node* a, Node* b) { return a->id() < b->id(); });
+  }
+  return operands;
+}
+
+// Returns a structural hash of the node for CSE. The hash combines the op,
+// the (interned) type, the ids of the operands as compared by CSE, and the
+// attributes of the most common parameterized ops, so that nodes which only
+// differ in those attributes rarely collide. Since nodes are visited in
+// topological order and their operands are already in canonical form, each
+// node is hashed exactly once per sweep.
+uint64_t CseHash(Node* node) {
+  int64_t attribute = 0;
+  switch (node->op()) {
+    case Op::kLiteral:
+      // Literal values are interned in the package's value pool, so equal
+      // literals share the address of their value.
+      attribute = reinterpret_cast<intptr_t>(&node->As<Literal>()->value());
+      break;
+    case Op::kBitSlice:
+      attribute = node->As<BitSlice>()->start();
+      break;
+    case Op::kTupleIndex:
+      attribute = node->As<TupleIndex>()->index();
+      break;
+    default:
+      break;
+  }
+  // Types are interned in the package so equal nodes share a type pointer.
+  uint64_t hash = absl::HashOf(node->op(), node->GetType(), attribute);
+  for (Node* operand : GetOperandsForCse(node)) {
+    hash = absl::HashOf(hash, operand->id());
   }
-  span_backing_store->insert(span_backing_store->begin(),
-                             node->operands().begin(), node->operands().end());
-  SortByNodeId(span_backing_store);
-  return *span_backing_store;
+  return hash;
 }
 
+// A node along with its CSE hash so the hash is only computed once.
+struct CseEntry {
+  uint64_t hash;
+  Node* node;
+};
+
+struct CseEntryHash {
+  size_t operator()(const CseEntry& entry) const { return entry.hash; }
+};
+
+struct CseEntryEq {
+  bool operator()(const CseEntry& a, const CseEntry& b) const {
+    return a.hash == b.hash &&
+           GetOperandsForCse(a.node) == GetOperandsForCse(b.node) &&
+           a.node->IsDefinitelyEqualTo(b.node);
+  }
+};
+
 }  // namespace
 
 absl::StatusOr<bool> RunCse(FunctionBase* f,
                             absl::flat_hash_map<Node*, Node*>* replacements,
                             bool common_literals) {
-  // To improve efficiency, bucket potentially common nodes together. The
-  // bucketing is done via an int64_t hash value which is constructed from the
-  // op() of the node and the uid's of the node's operands.
-  auto hasher = absl::Hash<std::vector<int64_t>>();
-  auto node_hash = [&](Node* n) {
-    std::vector<int64_t> values_to_hash = {static_cast<int64_t>(n->op())};
-    std::vector<Node*> span_backing_store;
-    for (Node* operand : GetOperandsForCse(n, &span_backing_store)) {
-      values_to_hash.push_back(operand->id());
-    }
-    // If this is slow because of many literals, the Literal values could be
-    // combined into the hash. As is, all literals get the same hash value.
-    return hasher(values_to_hash);
-  };
-
+  // A single sweep in topological order. Each node is either replaced by an
+  // equivalent node seen earlier or becomes the representative of its class.
   bool changed = false;
-  absl::flat_hash_map<int64_t, std::vector<Node*>> node_buckets;
-  node_buckets.reserve(f->node_count());
+  absl::flat_hash_set<CseEntry, CseEntryHash, CseEntryEq> representatives;
+  representatives.reserve(f->node_count());
   for (Node* node : TopoSort(f)) {
     if (OpIsSideEffecting(node->op())) {
       continue;
@@ -93,34 +122,19 @@ absl::StatusOr<bool> RunCse(FunctionBase* f,
       continue;
     }
 
-    int64_t hash = node_hash(node);
-    if (!node_buckets.contains(hash)) {
-      node_buckets[hash].push_back(node);
+    auto [it, inserted] =
+        representatives.insert(CseEntry{.hash = CseHash(node), .node = node});
+    if (inserted) {
       continue;
     }
-    bool replaced = false;
-    std::vector<Node*> node_span_backing_store;
-    absl::Span<Node* const> node_operands_for_cse =
-        GetOperandsForCse(node, &node_span_backing_store);
-    for (Node* candidate : node_buckets.at(hash)) {
-      std::vector<Node*> candidate_span_backing_store;
-      if (node_operands_for_cse ==
-              GetOperandsForCse(candidate, &candidate_span_backing_store) &&
-          node->IsDefinitelyEqualTo(candidate)) {
-        VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
-                                      node->GetName(), candidate->GetName());
-        XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
-        if (replacements != nullptr) {
-          (*replacements)[node] = candidate;
-        }
-        changed = true;
-        replaced = true;
-        break;
-      }
-    }
-    if (!replaced) {
-      node_buckets[hash].push_back(node);
+    Node* candidate = it->node;
+    VLOG(3) << absl::StreamFormat("Replacing %s with equivalent node %s",
+                                  node->GetName(), candidate->GetName());
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(candidate));
+    if (replacements != nullptr) {
+      (*replacements)[node] = candidate;
     }
+    changed = true;
   }
 
   return changed;
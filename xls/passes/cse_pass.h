@@ -23,6 +23,7 @@
 #include "xls/ir/node.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/preserved_analyses.h"
 
 namespace xls {
 
@@ -69,6 +70,15 @@ class CsePass : public OptimizationFunctionBasePass {
         common_literals_(common_literals) {}
   ~CsePass() override = default;
 
+  // Uses are only replaced by equivalent nodes, so the values of all nodes are
+  // unchanged. The bit provenance of users may refer to the replaced nodes
+  // though.
+  PreservedAnalyses GetPreservedAnalyses() const override {
+    return PreservedAnalyses::None()
+        .Preserve(AnalysisKind::kRange)
+        .Preserve(AnalysisKind::kBdd);
+  }
+
  protected:
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
       FunctionBase* f, const OptimizationPassOptions& options,
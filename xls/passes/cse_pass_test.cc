@@ -14,7 +14,9 @@
 
 #include "xls/passes/cse_pass.h"
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -253,5 +255,31 @@ TEST_F(CsePassTest, NonCommutativeOperands) {
   EXPECT_NE(f->return_value()->operand(0), f->return_value()->operand(1));
 }
 
+TEST_F(CsePassTest, ParameterizedOpsWithDifferentAttributes) {
+  // Bit slices with the same operand but different starts are distinct, while
+  // chains of identical slices collapse to a single one.
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  std::vector<BValue> slices;
+  for (int64_t i = 0; i < 16; ++i) {
+    slices.push_back(fb.BitSlice(x, /*start=*/i, /*width=*/8));
+    slices.push_back(fb.BitSlice(x, /*start=*/i, /*width=*/8));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f,
+                           fb.BuildWithReturnValue(fb.Concat(slices)));
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  Node* concat = f->return_value();
+  ASSERT_EQ(concat->operand_count(), 32);
+  for (int64_t i = 0; i < 16; ++i) {
+    EXPECT_EQ(concat->operand(2 * i), concat->operand(2 * i + 1));
+    EXPECT_THAT(concat->operand(2 * i), m::BitSlice(m::Param("x"), i, 8));
+    if (i > 0) {
+      EXPECT_NE(concat->operand(2 * i), concat->operand(2 * i - 2));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
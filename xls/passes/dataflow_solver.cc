@@ -0,0 +1,80 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/dataflow_solver.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/ir/dfs_visitor.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+// Visits every node of `topo_order` with each of `visitors`, skipping nodes a
+// visitor has already visited.
+absl::Status Sweep(absl::Span<Node* const> topo_order,
+                   absl::Span<DfsVisitor* const> visitors) {
+  for (Node* node : topo_order) {
+    for (DfsVisitor* visitor : visitors) {
+      if (visitor->IsVisited(node)) {
+        continue;
+      }
+      XLS_RETURN_IF_ERROR(node->VisitSingleNode(visitor)) << node;
+      visitor->MarkVisited(node);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status RunDataflowAnalyses(FunctionBase* f,
+                                 absl::Span<DfsVisitor* const> visitors,
+                                 int64_t threads) {
+  const std::vector<Node*> topo_order = TopoSort(f);
+  const int64_t workers =
+      std::min(threads, static_cast<int64_t>(visitors.size()));
+  if (workers <= 1) {
+    return Sweep(topo_order, visitors);
+  }
+
+  // Worker `w` runs visitors w, w + workers, w + 2 * workers, ...
+  std::vector<absl::Status> statuses(workers);
+  ThreadPool pool(workers);
+  for (int64_t w = 0; w < workers; ++w) {
+    pool.Schedule([&, w]() {
+      for (int64_t i = w; i < visitors.size() && statuses[w].ok();
+           i += workers) {
+        statuses[w] = Sweep(topo_order, visitors.subspan(i, 1));
+      }
+    });
+  }
+  pool.WaitForIdle();
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
@@ -0,0 +1,45 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_PASSES_DATAFLOW_SOLVER_H_
+#define XLS_PASSES_DATAFLOW_SOLVER_H_
+
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/types/span.h"
+#include "xls/ir/dfs_visitor.h"
+#include "xls/ir/function_base.h"
+
+namespace xls {
+
+// Runs several dataflow analyses (typically DataflowVisitor subclasses) over
+// `f` in one sweep. A single topological order is computed up front and each
+// node is passed to every visitor in turn before moving on to the next node, so
+// the node and its operands' values are still in cache when the next analysis
+// looks at them; running each analysis with FunctionBase::Accept instead
+// traverses the graph once per analysis. Every node is marked visited in every
+// visitor, exactly as Accept would leave it.
+//
+// If `threads` is greater than one the analyses are instead split across up to
+// that many threads, each of which sweeps the shared topological order with its
+// own analyses. Visitors must not share mutable state in that case.
+absl::Status RunDataflowAnalyses(FunctionBase* f,
+                                 absl::Span<DfsVisitor* const> visitors,
+                                 int64_t threads = 1);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_DATAFLOW_SOLVER_H_
@@ -0,0 +1,147 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/dataflow_solver.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/dfs_visitor.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/type.h"
+#include "xls/passes/dataflow_visitor.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class DataflowSolverTest : public IrTestBase {};
+
+// Test visitor which gives every leaf of a non-dataflow node the node's id and
+// joins leaves with max (or min if `use_min` is set).
+class NodeIdVisitor : public DataflowVisitor<int64_t> {
+ public:
+  explicit NodeIdVisitor(bool use_min = false) : use_min_(use_min) {}
+
+ protected:
+  absl::Status DefaultHandler(Node* node) override {
+    return SetValue(node, LeafTypeTree<int64_t>(node->GetType(), node->id()));
+  }
+
+  absl::StatusOr<int64_t> JoinElements(
+      Type* element_type, absl::Span<const int64_t* const> data_sources,
+      absl::Span<const LeafTypeTreeView<int64_t>> control_sources, Node* node,
+      absl::Span<const int64_t> index) const override {
+    XLS_RET_CHECK(!data_sources.empty());
+    int64_t result = *data_sources.front();
+    for (const int64_t* other : data_sources.subspan(1)) {
+      result = use_min_ ? std::min(result, *other) : std::max(result, *other);
+    }
+    return result;
+  }
+
+ private:
+  bool use_min_;
+};
+
+// Test visitor which fails on any negation.
+class FailOnNegVisitor : public DfsVisitorWithDefault {
+ public:
+  absl::Status DefaultHandler(Node* node) override {
+    return absl::OkStatus();
+  }
+  absl::Status HandleNeg(UnOp* neg) override {
+    return absl::InvalidArgumentError("negation found");
+  }
+};
+
+Function* BuildTestFunction(Package* package) {
+  FunctionBuilder fb("f", package);
+  BValue a = fb.Param("a", package->GetBitsType(8));
+  BValue b = fb.Param("b", package->GetBitsType(8));
+  BValue s = fb.Param("s", package->GetBitsType(1));
+  BValue tuple = fb.Tuple({a, fb.Add(a, b)});
+  BValue other = fb.Tuple({b, fb.Negate(a)});
+  BValue sel = fb.Select(s, {tuple, other});
+  fb.Tuple({fb.TupleIndex(sel, 0), fb.TupleIndex(sel, 1), sel});
+  return fb.Build().value();
+}
+
+void ExpectSameValues(Function* f, const NodeIdVisitor& expected,
+                      const NodeIdVisitor& actual) {
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(expected.GetValue(node).elements(),
+              actual.GetValue(node).elements())
+        << node;
+  }
+}
+
+TEST_F(DataflowSolverTest, MatchesSeparateTraversals) {
+  auto p = CreatePackage();
+  Function* f = BuildTestFunction(p.get());
+
+  NodeIdVisitor max_expected;
+  NodeIdVisitor min_expected(/*use_min=*/true);
+  XLS_ASSERT_OK(f->Accept(&max_expected));
+  XLS_ASSERT_OK(f->Accept(&min_expected));
+
+  for (int64_t threads : {1, 2, 8}) {
+    NodeIdVisitor max_actual;
+    NodeIdVisitor min_actual(/*use_min=*/true);
+    std::vector<DfsVisitor*> visitors = {&max_actual, &min_actual};
+    XLS_ASSERT_OK(RunDataflowAnalyses(f, visitors, threads));
+    ExpectSameValues(f, max_expected, max_actual);
+    ExpectSameValues(f, min_expected, min_actual);
+    EXPECT_EQ(max_actual.GetVisitedCount(), f->node_count());
+    EXPECT_EQ(min_actual.GetVisitedCount(), f->node_count());
+
+    // Every node was marked visited so a later traversal does nothing.
+    XLS_ASSERT_OK(f->Accept(&max_actual));
+    ExpectSameValues(f, max_expected, max_actual);
+  }
+}
+
+TEST_F(DataflowSolverTest, PropagatesErrors) {
+  auto p = CreatePackage();
+  Function* f = BuildTestFunction(p.get());
+  for (int64_t threads : {1, 3}) {
+    NodeIdVisitor first;
+    FailOnNegVisitor failing;
+    NodeIdVisitor last;
+    std::vector<DfsVisitor*> visitors = {&first, &failing, &last};
+    EXPECT_THAT(RunDataflowAnalyses(f, visitors, threads),
+                StatusIs(absl::StatusCode::kInvalidArgument,
+                         HasSubstr("negation found")));
+  }
+}
+
+}  // namespace
+}  // namespace xls
@@ -23,6 +23,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/preserved_analyses.h"
 
 namespace xls {
 
@@ -36,6 +37,17 @@ class DeadCodeEliminationPass : public OptimizationFunctionBasePass {
       : OptimizationFunctionBasePass(kName, "Dead Code Elimination") {}
   ~DeadCodeEliminationPass() override = default;
 
+  // Operands of live nodes are live, so removing dead nodes does not change
+  // any value computed by the remaining nodes. Post-dominators are not
+  // preserved: dead users are exits which limit the post-dominators of their
+  // operands.
+  PreservedAnalyses GetPreservedAnalyses() const override {
+    return PreservedAnalyses::None()
+        .Preserve(AnalysisKind::kRange)
+        .Preserve(AnalysisKind::kBdd)
+        .Preserve(AnalysisKind::kBitProvenance);
+  }
+
  protected:
   // Iterate all nodes, mark and eliminate the unvisited nodes.
   absl::StatusOr<bool> RunOnFunctionBaseInternal(
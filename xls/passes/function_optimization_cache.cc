@@ -0,0 +1,151 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/function_optimization_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+namespace {
+
+// Prepended to every key. A new value makes entries holding IR in an older
+// canonical form unreachable.
+constexpr std::string_view kCacheFormat = "function-optimization-cache-1";
+
+// Name of the function in canonical IR.
+constexpr std::string_view kCanonicalFunctionName = "f";
+
+// Returns `loc` with its file numbers, which refer to the files of `from`,
+// renumbered to refer to the same files in `to`.
+SourceInfo RemapSourceInfo(const SourceInfo& loc, const Package& from,
+                           Package& to) {
+  SourceInfo remapped;
+  remapped.locations.reserve(loc.locations.size());
+  for (const SourceLocation& location : loc.locations) {
+    std::optional<std::string> filename = from.GetFilename(location.fileno());
+    remapped.locations.push_back(SourceLocation(
+        filename.has_value() ? to.GetOrCreateFileno(*filename)
+                             : location.fileno(),
+        location.lineno(), location.colno()));
+  }
+  return remapped;
+}
+
+}  // namespace
+
+std::string ComputeFunctionOptimizationCacheKey(
+    std::string_view pipeline_fingerprint, std::string_view canonical_ir) {
+  return ContentAddressedDirectoryCache::ComputeKey(
+      {kCacheFormat, pipeline_fingerprint, canonical_ir});
+}
+
+bool IsCacheableFunction(const Function* f) {
+  if (f->ForeignFunctionData().has_value()) {
+    return false;
+  }
+  for (const Node* node : f->nodes()) {
+    if (node->OpIn({Op::kInvoke, Op::kMap, Op::kCountedFor,
+                    Op::kDynamicCountedFor})) {
+      return false;
+    }
+  }
+  return true;
+}
+
+absl::StatusOr<std::string> CanonicalFunctionIr(const Function* f) {
+  XLS_RET_CHECK(IsCacheableFunction(f)) << f->name();
+  Package canonical("canonical");
+  XLS_ASSIGN_OR_RETURN(Function * clone,
+                       f->Clone(kCanonicalFunctionName, &canonical));
+  // Number the files in the order the nodes refer to them.
+  for (Node* node : clone->nodes()) {
+    node->SetLoc(RemapSourceInfo(node->loc(), *f->package(), canonical));
+  }
+  return canonical.DumpIr();
+}
+
+absl::Status RestoreFunctionBody(Function* f, std::string_view canonical_ir) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> canonical,
+                       Parser::ParsePackage(canonical_ir));
+  XLS_ASSIGN_OR_RETURN(Function * cached,
+                       canonical->GetFunction(kCanonicalFunctionName));
+  XLS_RET_CHECK_EQ(cached->GetType()->ToString(), f->GetType()->ToString())
+      << "Cached function does not match the type of " << f->name();
+
+  std::vector<Node*> old_nodes;
+  for (Node* node : ReverseTopoSort(f)) {
+    if (!node->Is<Param>()) {
+      old_nodes.push_back(node);
+    }
+  }
+
+  absl::flat_hash_map<Node*, Node*> cached_to_new;
+  for (int64_t i = 0; i < cached->params().size(); ++i) {
+    cached_to_new[cached->param(i)] = f->param(i);
+  }
+  std::vector<std::pair<Node*, std::string>> names;
+  for (Node* node : TopoSort(cached)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    std::vector<Node*> new_operands;
+    new_operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      new_operands.push_back(cached_to_new.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(Node * new_node,
+                         node->CloneInNewFunction(new_operands, f));
+    new_node->SetLoc(RemapSourceInfo(node->loc(), *canonical, *f->package()));
+    if (node->HasAssignedName()) {
+      names.push_back({new_node, node->GetName()});
+    }
+    cached_to_new[node] = new_node;
+  }
+  XLS_RETURN_IF_ERROR(
+      f->set_return_value(cached_to_new.at(cached->return_value())));
+
+  // Users come before their operands so each node is unused when removed.
+  for (Node* node : old_nodes) {
+    XLS_RETURN_IF_ERROR(f->RemoveNode(node));
+  }
+  // The names no longer collide with those of the removed nodes.
+  for (auto& [node, name] : names) {
+    node->SetNameDirectly(name);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace xls
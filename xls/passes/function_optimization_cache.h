@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_PASSES_FUNCTION_OPTIMIZATION_CACHE_H_
+#define XLS_PASSES_FUNCTION_OPTIMIZATION_CACHE_H_
+
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/ir/function.h"
+
+namespace xls {
+
+// Describes a cache of optimized function bodies, so that functions which
+// appear identically in many packages (e.g., stdlib helpers converted from
+// DSLX) are optimized once. Entries are kept in memory, which lets a single
+// cache be shared by the optimization of a batch of packages, and optionally
+// also in a directory on disk.
+//
+// Only leaf functions (see IsCacheableFunction) are cached because the
+// optimization of a leaf function before inlining does not depend on the rest
+// of the package. Entries are the canonical IR of the optimized function.
+//
+// The key does not capture the version of the optimizer, so a cache directory
+// should not be shared between different XLS builds.
+inline constexpr ContentAddressedDirectoryCache::Options
+    kFunctionOptimizationCacheOptions = {
+        .directory_env_var = "XLS_OPT_FUNCTION_CACHE_DIR",
+        .extension = ".ir",
+        .description = "function optimization",
+        .keep_in_memory = true};
+
+// Returns the key of optimizing the function whose canonical IR (see
+// CanonicalFunctionIr) is `canonical_ir` with the pipeline and options
+// described by `pipeline_fingerprint`.
+std::string ComputeFunctionOptimizationCacheKey(
+    std::string_view pipeline_fingerprint, std::string_view canonical_ir);
+
+// Returns whether `f` can be cached: it calls no other functions and is not a
+// foreign function.
+bool IsCacheableFunction(const Function* f);
+
+// Returns `f` as the textual IR of a package holding only a copy of `f` with
+// a fixed name and renumbered nodes. Functions which were converted
+// identically in different packages have the same canonical IR.
+absl::StatusOr<std::string> CanonicalFunctionIr(const Function* f);
+
+// Replaces the body of `f` with the body of the function in `canonical_ir`, as
+// returned by CanonicalFunctionIr. The functions must have the same type.
+absl::Status RestoreFunctionBody(Function* f, std::string_view canonical_ir);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_FUNCTION_OPTIMIZATION_CACHE_H_
@@ -0,0 +1,110 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/passes/function_optimization_cache.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+class FunctionOptimizationCacheTest : public IrTestBase {};
+
+TEST_F(FunctionOptimizationCacheTest, KeyDependsOnAllComponents) {
+  std::string key = ComputeFunctionOptimizationCacheKey("opt", "fn f()");
+  EXPECT_EQ(ComputeFunctionOptimizationCacheKey("opt", "fn f()"), key);
+  EXPECT_NE(ComputeFunctionOptimizationCacheKey("opt2", "fn f()"), key);
+  EXPECT_NE(ComputeFunctionOptimizationCacheKey("opt", "fn g()"), key);
+}
+
+TEST_F(FunctionOptimizationCacheTest, CanonicalIrIgnoresNameAndNodeIds) {
+  auto p1 = CreatePackage();
+  FunctionBuilder fb1("helper", p1.get());
+  fb1.Add(fb1.Param("x", p1->GetBitsType(8)), fb1.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f1, fb1.Build());
+
+  // Nodes of another function shift the ids of the nodes of the second copy.
+  auto p2 = CreatePackage();
+  FunctionBuilder other("other", p2.get());
+  other.Not(other.Param("y", p2->GetBitsType(4)));
+  XLS_ASSERT_OK(other.Build().status());
+  FunctionBuilder fb2("__std__helper", p2.get());
+  fb2.Add(fb2.Param("x", p2->GetBitsType(8)), fb2.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f2, fb2.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir1, CanonicalFunctionIr(f1));
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir2, CanonicalFunctionIr(f2));
+  EXPECT_EQ(ir1, ir2);
+
+  FunctionBuilder fb3("different", p2.get());
+  fb3.Add(fb3.Param("x", p2->GetBitsType(8)), fb3.Literal(UBits(2, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f3, fb3.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string ir3, CanonicalFunctionIr(f3));
+  EXPECT_NE(ir1, ir3);
+}
+
+TEST_F(FunctionOptimizationCacheTest, OnlyLeafFunctionsAreCacheable) {
+  auto p = CreatePackage();
+  FunctionBuilder callee_fb("callee", p.get());
+  callee_fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * callee, callee_fb.Build());
+  FunctionBuilder caller_fb("caller", p.get());
+  caller_fb.Invoke({caller_fb.Param("x", p->GetBitsType(8))}, callee);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * caller, caller_fb.Build());
+
+  EXPECT_TRUE(IsCacheableFunction(callee));
+  EXPECT_FALSE(IsCacheableFunction(caller));
+}
+
+TEST_F(FunctionOptimizationCacheTest, RestoreFunctionBody) {
+  auto p = CreatePackage();
+  FunctionBuilder optimized_fb("optimized", p.get());
+  BValue x = optimized_fb.Param("x", p->GetBitsType(8));
+  optimized_fb.Not(x, SourceInfo(), "inverted");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * optimized, optimized_fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string canonical_ir,
+                           CanonicalFunctionIr(optimized));
+
+  FunctionBuilder fb("f", p.get());
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  fb.Xor(y, fb.Literal(UBits(0xff, 8)), SourceInfo(), "inverted");
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK(RestoreFunctionBody(f, canonical_ir));
+
+  EXPECT_THAT(f->return_value(), m::Not(m::Param("y")));
+  EXPECT_EQ(f->return_value()->GetName(), "inverted");
+  EXPECT_EQ(f->node_count(), 2);
+
+  FunctionBuilder wrong_type_fb("wrong_type", p.get());
+  wrong_type_fb.Param("z", p->GetBitsType(4));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * wrong_type, wrong_type_fb.Build());
+  EXPECT_FALSE(RestoreFunctionBody(wrong_type, canonical_ir).ok());
+}
+
+}  // namespace
+}  // namespace xls
@@ -15,25 +15,31 @@
 #include "xls/passes/inlining_pass.h"
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/call_graph.h"
+#include "xls/ir/function.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
@@ -97,9 +103,11 @@ static bool IsInlineable(const Invoke* invoke) {
 
 // Inlines the node "invoke" by replacing it with the contents of the called
 // function.
+//
+// `invoked` is the body to inline. It is usually the function called by
+// `invoke` but may be a specialization of it with the same params.
 template <bool kCheckNoSubInvokes = true>
-absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
-  Function* invoked = invoke->to_apply();
+absl::Status InlineInvoke(Invoke* invoke, Function* invoked, int inline_count) {
   absl::flat_hash_map<Node*, Node*> invoked_node_to_replacement;
   for (int64_t i = 0; i < invoked->params().size(); ++i) {
     Node* param = invoked->param(i);
@@ -200,10 +208,158 @@ absl::Status InlineInvoke(Invoke* invoke, int inline_count) {
   return invoke->function_base()->RemoveNode(invoke);
 }
 
+// The literal operands of an invoke; non-literal operands are nullopt.
+using LiteralArgs = std::vector<std::optional<Value>>;
+
+LiteralArgs GetLiteralArgs(Invoke* invoke) {
+  LiteralArgs args;
+  args.reserve(invoke->operand_count());
+  for (Node* operand : invoke->operands()) {
+    if (operand->Is<Literal>()) {
+      args.push_back(operand->As<Literal>()->value());
+    } else {
+      args.push_back(std::nullopt);
+    }
+  }
+  return args;
+}
+
+// Returns whether `f` refers to no other function, so it can be copied into a
+// package of its own.
+bool IsSelfContained(Function* f) {
+  return absl::c_none_of(f->nodes(), [](Node* node) {
+    return node->OpIn(
+        {Op::kInvoke, Op::kMap, Op::kCountedFor, Op::kDynamicCountedFor});
+  });
+}
+
+// Copies `callee` as the top of a new package and replaces the uses of each
+// param which has a literal argument with that literal. The params themselves
+// are kept so the copy can be inlined in place of `callee`.
+absl::StatusOr<std::unique_ptr<Package>> CreateSpecialization(
+    Function* callee, const LiteralArgs& args) {
+  auto package = std::make_unique<Package>(
+      absl::StrCat(callee->package()->name(), "_", callee->name(), "_spec"));
+  XLS_ASSIGN_OR_RETURN(Function * clone,
+                       callee->Clone(callee->name(), package.get()));
+  for (int64_t i = 0; i < args.size(); ++i) {
+    if (!args[i].has_value()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(
+        Literal * literal,
+        clone->MakeNode<Literal>(clone->param(i)->loc(), *args[i]));
+    XLS_RETURN_IF_ERROR(clone->param(i)->ReplaceUsesWith(literal));
+  }
+  XLS_RETURN_IF_ERROR(package->SetTop(clone));
+  return package;
+}
+
+// The simplified specializations of callees, each in its own package.
+class SpecializationCache {
+ public:
+  SpecializationCache(const OptimizationPass& simplification,
+                      const OptimizationPassOptions& options)
+      : simplification_(simplification), options_(options) {
+    // The scratch packages are not covered by the caller's cache, and the
+    // pool may already be running this pass.
+    scratch_options_ = options;
+    scratch_options_.function_base_thread_pool = nullptr;
+    scratch_options_.query_engine_cache = nullptr;
+  }
+
+  // Counts the invokes of each callee so cached bodies can be dropped once
+  // they are no longer needed.
+  void CountInvokes(Package* p) {
+    for (FunctionBase* f : p->GetFunctionBases()) {
+      for (Node* node : f->nodes()) {
+        if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
+          ++pending_invokes_[node->As<Invoke>()->to_apply()];
+        }
+      }
+    }
+  }
+
+  // Creates and simplifies the specializations needed by `invokes` which are
+  // not cached yet.
+  absl::Status Prepare(absl::Span<Invoke* const> invokes) {
+    std::vector<Package*> created;
+    for (Invoke* invoke : invokes) {
+      Function* callee = invoke->to_apply();
+      auto [contained_it, inserted_callee] =
+          self_contained_.insert({callee, false});
+      if (inserted_callee) {
+        contained_it->second = IsSelfContained(callee);
+      }
+      if (!contained_it->second) {
+        continue;
+      }
+      LiteralArgs args = GetLiteralArgs(invoke);
+      auto [it, inserted] = bodies_[callee].try_emplace(std::move(args));
+      if (!inserted) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(it->second, CreateSpecialization(callee, it->first));
+      created.push_back(it->second.get());
+    }
+
+    std::vector<absl::Status> statuses(created.size());
+    auto simplify = [&](int64_t i) {
+      PassResults results;
+      statuses[i] =
+          simplification_.Run(created[i], scratch_options_, &results).status();
+    };
+    // This pass may itself be running on a task of the pool (for example
+    // within a nested pipeline), so the simplifications must not block on
+    // tasks queued behind this one; ParallelFor runs them on this thread too.
+    if (options_.function_base_thread_pool != nullptr && created.size() > 1) {
+      options_.function_base_thread_pool->ParallelFor(created.size(),
+                                                      /*grain=*/1, simplify);
+    } else {
+      for (int64_t i = 0; i < created.size(); ++i) {
+        simplify(i);
+      }
+    }
+    for (const absl::Status& status : statuses) {
+      XLS_RETURN_IF_ERROR(status);
+    }
+    return absl::OkStatus();
+  }
+
+  // Returns the body to inline for `invoke`: its cached specialization if
+  // there is one, otherwise the callee itself.
+  absl::StatusOr<Function*> GetBody(Invoke* invoke) {
+    auto it = bodies_.find(invoke->to_apply());
+    if (it == bodies_.end()) {
+      return invoke->to_apply();
+    }
+    return it->second.at(GetLiteralArgs(invoke))->GetTopAsFunction();
+  }
+
+  // Records that an invoke of `callee` was inlined.
+  void Inlined(Function* callee) {
+    if (--pending_invokes_.at(callee) == 0) {
+      bodies_.erase(callee);
+    }
+  }
+
+ private:
+  const OptimizationPass& simplification_;
+  const OptimizationPassOptions& options_;
+  OptimizationPassOptions scratch_options_;
+  absl::flat_hash_map<Function*, int64_t> pending_invokes_;
+  absl::flat_hash_map<Function*, bool> self_contained_;
+  // Specializations of each callee, keyed by the literal arguments.
+  absl::flat_hash_map<
+      Function*, absl::flat_hash_map<LiteralArgs, std::unique_ptr<Package>>>
+      bodies_;
+};
+
 }  // namespace
 
 absl::Status InliningPass::InlineOneInvoke(Invoke* invoke) {
-  return InlineInvoke</*kCheckNoSubInvokes=*/false>(invoke, /*inline_count=*/0);
+  return InlineInvoke</*kCheckNoSubInvokes=*/false>(
+      invoke, invoke->to_apply(), /*inline_count=*/0);
 }
 
 absl::StatusOr<bool> InliningPass::RunInternal(
@@ -215,15 +371,34 @@ absl::StatusOr<bool> InliningPass::RunInternal(
   // function Foo is inlined into its callsites, no invokes remain in Foo. This
   // avoid duplicate work.
   int inline_count = 0;
+  std::optional<SpecializationCache> cache;
+  if (callee_simplification_ != nullptr) {
+    cache.emplace(*callee_simplification_, options);
+    cache->CountInvokes(p);
+  }
   for (FunctionBase* f : FunctionsInPostOrder(p)) {
-    // Create copy of nodes() because we will be adding and removing nodes
-    // during inlining.
-    std::vector<Node*> nodes(f->nodes().begin(), f->nodes().end());
-    for (Node* node : nodes) {
+    // Collect the invokes up front because we will be adding and removing
+    // nodes during inlining.
+    std::vector<Invoke*> invokes;
+    for (Node* node : f->nodes()) {
       if (node->Is<Invoke>() && IsInlineable(node->As<Invoke>())) {
-        XLS_RETURN_IF_ERROR(InlineInvoke(node->As<Invoke>(), inline_count++));
-        changed = true;
+        invokes.push_back(node->As<Invoke>());
+      }
+    }
+    if (cache.has_value()) {
+      XLS_RETURN_IF_ERROR(cache->Prepare(invokes));
+    }
+    for (Invoke* invoke : invokes) {
+      Function* callee = invoke->to_apply();
+      Function* body = callee;
+      if (cache.has_value()) {
+        XLS_ASSIGN_OR_RETURN(body, cache->GetBody(invoke));
+      }
+      XLS_RETURN_IF_ERROR(InlineInvoke(invoke, body, inline_count++));
+      if (cache.has_value()) {
+        cache->Inlined(callee);
       }
+      changed = true;
     }
   }
   return changed;
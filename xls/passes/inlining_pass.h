@@ -15,7 +15,9 @@
 #ifndef XLS_PASSES_INLINING_PASS_H_
 #define XLS_PASSES_INLINING_PASS_H_
 
+#include <memory>
 #include <string_view>
+#include <utility>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -31,6 +33,23 @@ class InliningPass : public OptimizationPass {
   static constexpr std::string_view kName = "inlining";
   InliningPass() : OptimizationPass(kName, "Inlines invocations") {}
 
+  // Inlines simplified specializations of the callees rather than the callees
+  // themselves. Each distinct combination of a callee and the literal operands
+  // of an invoke is copied into a scratch package with the literals
+  // substituted for the corresponding params, simplified once with
+  // `callee_simplification`, and cached; every matching invoke then inlines the
+  // cached body. As callees are visited leaves first, each body is simplified
+  // after its own invokes are inlined and before it is inlined into its
+  // callers, so intermediate IR stays close to its simplified size. A cached
+  // body is dropped once all invokes of its callee are inlined.
+  //
+  // If `options.function_base_thread_pool` is set, the specializations needed
+  // by a function are simplified concurrently.
+  InliningPass(std::string_view short_name, std::string_view long_name,
+               std::unique_ptr<OptimizationPass> callee_simplification)
+      : OptimizationPass(short_name, long_name),
+        callee_simplification_(std::move(callee_simplification)) {}
+
   // Inline a single invoke instruction. Provided for test and utility
   // (ir_minimizer) use.
   // Because this is only for ir-minimizer use it allows the inlined function to
@@ -41,6 +60,9 @@ class InliningPass : public OptimizationPass {
   absl::StatusOr<bool> RunInternal(Package* p,
                                    const OptimizationPassOptions& options,
                                    PassResults* results) const override;
+
+ private:
+  std::unique_ptr<OptimizationPass> callee_simplification_;
 };
 
 }  // namespace xls
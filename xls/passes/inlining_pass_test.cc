@@ -14,6 +14,7 @@
 
 #include "xls/passes/inlining_pass.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -23,12 +24,15 @@
 #include "absl/status/statusor.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/passes/constant_folding_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -295,5 +299,123 @@ fn caller(the_token: token, x: bits[32]) -> (token, bits[32]) {
   }
 }
 
+// Constant folding which counts the function bases it runs on.
+class CountingConstantFoldingPass : public ConstantFoldingPass {
+ public:
+  explicit CountingConstantFoldingPass(int64_t* runs) : runs_(runs) {}
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    ++*runs_;
+    return ConstantFoldingPass::RunOnFunctionBaseInternal(f, options, results);
+  }
+
+ private:
+  int64_t* runs_;
+};
+
+TEST_F(InliningPassTest, InlinesSimplifiedSpecializations) {
+  const std::string kProgram = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  umul.1: bits[32] = umul(y, y)
+  ret add.2: bits[32] = add(x, umul.1)
+}
+
+fn caller(a: bits[32], b: bits[32]) -> (bits[32], bits[32], bits[32]) {
+  literal.3: bits[32] = literal(value=3)
+  literal.4: bits[32] = literal(value=4)
+  invoke.5: bits[32] = invoke(a, literal.3, to_apply=callee)
+  invoke.6: bits[32] = invoke(b, literal.3, to_apply=callee)
+  invoke.7: bits[32] = invoke(a, literal.4, to_apply=callee)
+  ret tuple.8: (bits[32], bits[32], bits[32]) = tuple(invoke.5, invoke.6, invoke.7)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kProgram));
+  int64_t runs = 0;
+  InliningPass pass("simplifying_inlining", "Simplifying inlining",
+                    std::make_unique<CountingConstantFoldingPass>(&runs));
+  PassResults results;
+  ASSERT_THAT(pass.Run(package.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  // One specialization for each distinct literal argument.
+  EXPECT_EQ(runs, 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("caller"));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Add(m::Param("a"), m::Literal(9)),
+                       m::Add(m::Param("b"), m::Literal(9)),
+                       m::Add(m::Param("a"), m::Literal(16))));
+}
+
+TEST_F(InliningPassTest, SimplifiesCalleesBeforeTheirCallers) {
+  const std::string kProgram = R"(
+package some_package
+
+fn leaf(x: bits[32], y: bits[32]) -> bits[32] {
+  ret umul.1: bits[32] = umul(x, y)
+}
+
+fn middle(x: bits[32]) -> bits[32] {
+  literal.2: bits[32] = literal(value=5)
+  ret invoke.3: bits[32] = invoke(literal.2, literal.2, to_apply=leaf)
+}
+
+fn caller(a: bits[32]) -> bits[32] {
+  ret invoke.4: bits[32] = invoke(a, to_apply=middle)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kProgram));
+  int64_t runs = 0;
+  InliningPass pass("simplifying_inlining", "Simplifying inlining",
+                    std::make_unique<CountingConstantFoldingPass>(&runs));
+  PassResults results;
+  ASSERT_THAT(pass.Run(package.get(), OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(runs, 2);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("caller"));
+  EXPECT_THAT(f->return_value(), m::Literal(25));
+}
+
+// The pass runs on the only worker of the pool it simplifies specializations
+// on, as it does when nested in a pipeline running on that pool.
+TEST_F(InliningPassTest, SimplifiesSpecializationsFromAPoolWorker) {
+  const std::string kProgram = R"(
+package some_package
+
+fn callee(x: bits[32], y: bits[32]) -> bits[32] {
+  umul.1: bits[32] = umul(y, y)
+  ret add.2: bits[32] = add(x, umul.1)
+}
+
+fn caller(a: bits[32]) -> (bits[32], bits[32]) {
+  literal.3: bits[32] = literal(value=3)
+  literal.4: bits[32] = literal(value=4)
+  invoke.5: bits[32] = invoke(a, literal.3, to_apply=callee)
+  invoke.6: bits[32] = invoke(a, literal.4, to_apply=callee)
+  ret tuple.7: (bits[32], bits[32]) = tuple(invoke.5, invoke.6)
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto package, ParsePackage(kProgram));
+  InliningPass pass("simplifying_inlining", "Simplifying inlining",
+                    std::make_unique<ConstantFoldingPass>());
+  ThreadPool pool(1);
+  OptimizationPassOptions options;
+  options.function_base_thread_pool = &pool;
+  absl::StatusOr<bool> changed;
+  pool.Schedule([&]() {
+    PassResults results;
+    changed = pass.Run(package.get(), options, &results);
+  });
+  pool.WaitForIdle();
+  ASSERT_THAT(changed, IsOkAndHolds(true));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, package->GetFunction("caller"));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Add(m::Param("a"), m::Literal(9)),
+                       m::Add(m::Param("a"), m::Literal(16))));
+}
+
 }  // namespace
 }  // namespace xls
@@ -26,6 +26,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -38,7 +39,10 @@
 #include "xls/common/math_util.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/leaf_type_tree.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/delay_estimators.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -106,104 +110,472 @@ Node* GetCase(Select* select, const Bits& selector) {
   return select->get_case(static_cast<int64_t>(*selector_value));
 }
 
-absl::StatusOr<bool> MaybeMergeLutIntoSelects(
-    Node* selector, const QueryEngine& query_engine, int64_t opt_level,
-    std::optional<DataflowGraphAnalysis>& dataflow_graph_analysis) {
-  int64_t max_case_count = 0;
-  std::vector<Select*> candidate_selects;
-  candidate_selects.reserve(1);
-  for (Node* user : selector->users()) {
-    if (user->Is<Select>() && user->As<Select>()->selector() == selector) {
-      candidate_selects.push_back(user->As<Select>());
-      max_case_count = std::max(max_case_count, CaseCount(user->As<Select>()));
+// The truth tables of the bits of a node over every assignment to the unknown
+// bits of a min-cut; bit `a` of element `i` is the value of bit `i` of the
+// node when the unknown bits of the cut take the value `a`.
+using TruthTables = std::vector<InlineBitmap>;
+
+// Simulates the cone of a selector over every assignment to the unknown bits
+// of its min-cut at once, with one word-parallel truth table per bit. Only
+// bits-typed cones made of common logic, arithmetic & select operations are
+// supported; anything else should fall back to the interpreter.
+class BitParallelSimulator {
+ public:
+  BitParallelSimulator(int64_t unknown_bits, const QueryEngine& query_engine)
+      : assignment_count_(int64_t{1} << unknown_bits),
+        query_engine_(query_engine) {}
+
+  // Binds `node` to the given (partially-)known value, assigning its unknown
+  // bits to the next unknown bits of the assignment, starting from the LSB.
+  void SetCut(Node* node, TernarySpan ternary, int64_t& next_unknown) {
+    TruthTables tables;
+    tables.reserve(ternary.size());
+    for (TernaryValue value : ternary) {
+      if (value == TernaryValue::kUnknown) {
+        tables.push_back(Variable(next_unknown++));
+      } else {
+        tables.push_back(Constant(value == TernaryValue::kKnownOne));
+      }
     }
+    tables_[node] = std::move(tables);
   }
-  if (candidate_selects.empty()) {
-    return false;
+
+  // Returns the truth tables of `root`, or nullptr if its cone contains
+  // something that can't be simulated.
+  const TruthTables* Evaluate(Node* root) {
+    std::vector<std::pair<Node*, bool>> stack = {{root, false}};
+    while (!stack.empty()) {
+      auto [node, operands_ready] = stack.back();
+      stack.pop_back();
+      if (tables_.contains(node)) {
+        continue;
+      }
+      if (operands_ready) {
+        std::optional<TruthTables> tables = Simulate(node);
+        if (!tables.has_value()) {
+          return nullptr;
+        }
+        tables_[node] = *std::move(tables);
+        continue;
+      }
+      if (std::optional<Value> known = query_engine_.KnownValue(node);
+          known.has_value()) {
+        if (!known->IsBits()) {
+          return nullptr;
+        }
+        tables_[node] = FromBits(known->bits());
+        continue;
+      }
+      if (!node->GetType()->IsBits()) {
+        return nullptr;
+      }
+      stack.push_back({node, true});
+      for (Node* operand : node->operands()) {
+        if (!tables_.contains(operand)) {
+          stack.push_back({operand, false});
+        }
+      }
+    }
+    return &tables_.at(root);
   }
-  CHECK(!candidate_selects.empty());
 
-  // Find the minimum set of unknown bits that fully determine the value of the
-  // selector; we can treat the selector as defined by a LUT, then merge it into
-  // the select(s) it controls by reordering cases.
-  int64_t unknown_bits = 0;
-  int64_t max_bits_needed = Bits::MinBitCountUnsigned(max_case_count - 1);
-  if (max_bits_needed <= 1) {
-    // We can't narrow the controlled selects any further unless the selector is
-    // actually constant... which should be handled by other (cheaper) passes.
-    return false;
+  // Returns the value of `tables` under each assignment, in order.
+  std::vector<Bits> Values(const TruthTables& tables) const {
+    std::vector<Bits> values;
+    values.reserve(assignment_count_);
+    for (int64_t a = 0; a < assignment_count_; ++a) {
+      InlineBitmap value(tables.size());
+      for (int64_t i = 0; i < tables.size(); ++i) {
+        value.Set(i, tables[i].Get(a));
+      }
+      values.push_back(Bits::FromBitmap(std::move(value)));
+    }
+    return values;
   }
 
-  // Initialize the graph analysis if not done already.
-  if (!dataflow_graph_analysis.has_value()) {
-    dataflow_graph_analysis.emplace(selector->function_base(), &query_engine);
+ private:
+  InlineBitmap Constant(bool value) const {
+    return InlineBitmap(assignment_count_, value);
   }
 
-  VLOG(3) << "Finding min cut for " << selector->GetName() << " ("
-          << max_bits_needed << " bits needed)" << " controlling "
-          << candidate_selects.size() << " select(s)";
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<Node*> min_cut,
-      dataflow_graph_analysis->GetMinCutFor(
-          selector, /*max_unknown_bits=*/max_bits_needed, &unknown_bits));
-  if (min_cut.empty()) {
-    // There's no better alternative; this selector is already optimal.
-    return false;
+  // Returns the truth table of the `index`th unknown bit of the assignment.
+  InlineBitmap Variable(int64_t index) const {
+    static constexpr uint64_t kPatterns[] = {
+        0xAAAAAAAAAAAAAAAA, 0xCCCCCCCCCCCCCCCC, 0xF0F0F0F0F0F0F0F0,
+        0xFF00FF00FF00FF00, 0xFFFF0000FFFF0000, 0xFFFFFFFF00000000};
+    InlineBitmap table(assignment_count_);
+    for (int64_t w = 0; w < table.word_count(); ++w) {
+      if (index < 6) {
+        table.SetWord(w, kPatterns[index]);
+      } else if (((w >> (index - 6)) & 1) != 0) {
+        table.SetWord(w, ~uint64_t{0});
+      }
+    }
+    return table;
   }
-  VLOG(3) << "Found " << unknown_bits << "-bit min cut for "
-          << selector->GetName() << ": "
-          << absl::StrJoin(min_cut, ", ", [](std::string* out, Node* node) {
-               absl::StrAppend(out, node->GetName());
-             });
 
-  // Remove all candidate selects that wouldn't benefit from this transform.
-  const bool selector_is_trivial = IsTriviallyDerived(
-      selector, absl::flat_hash_set<Node*>(min_cut.begin(), min_cut.end()));
-  std::erase_if(candidate_selects, [&](Select* select) {
-    int64_t bits_needed = Bits::MinBitCountUnsigned(CaseCount(select) - 1);
-    if (unknown_bits < bits_needed) {
-      // This transform will narrow this select.
-      return false;
+  TruthTables FromBits(const Bits& bits) const {
+    TruthTables tables;
+    tables.reserve(bits.bit_count());
+    for (int64_t i = 0; i < bits.bit_count(); ++i) {
+      tables.push_back(Constant(bits.Get(i)));
     }
-    if (unknown_bits == bits_needed && !selector_is_trivial) {
-      // This transform will keep this select approximately the same width, but
-      // should save delay through the selector.
-      return false;
+    return tables;
+  }
+
+  static InlineBitmap And(InlineBitmap a, const InlineBitmap& b) {
+    a.Intersect(b);
+    return a;
+  }
+  static InlineBitmap Or(InlineBitmap a, const InlineBitmap& b) {
+    a.Union(b);
+    return a;
+  }
+  static InlineBitmap Xor(InlineBitmap a, const InlineBitmap& b) {
+    a.SymmetricDifference(b);
+    return a;
+  }
+  static InlineBitmap Not(InlineBitmap a) {
+    a.Invert();
+    return a;
+  }
+  static TruthTables Not(TruthTables a) {
+    for (InlineBitmap& table : a) {
+      table.Invert();
     }
-    // Without a way to tell whether this transform is still beneficial, we
-    // can't confidently use this optimization.
-    //
-    // TODO(epastor): Use delay & area estimators to check for net benefit.
-    return true;
-  });
-  if (candidate_selects.empty()) {
-    return false;
+    return a;
   }
 
-  std::vector<SharedLeafTypeTree<TernaryVector>> cut_ternaries;
-  cut_ternaries.reserve(min_cut.size());
+  // Returns the result of `s ? b : a`, bitwise.
+  static TruthTables Mux(const InlineBitmap& s, const TruthTables& a,
+                         const TruthTables& b) {
+    TruthTables result;
+    result.reserve(a.size());
+    for (int64_t i = 0; i < a.size(); ++i) {
+      result.push_back(Or(And(a[i], Not(s)), And(b[i], s)));
+    }
+    return result;
+  }
+
+  // Returns the sum of `a`, `b` & `carry`, truncated to the width of `a`; the
+  // carry out is left in `carry`.
+  static TruthTables Add(const TruthTables& a, const TruthTables& b,
+                         InlineBitmap& carry) {
+    TruthTables sum;
+    sum.reserve(a.size());
+    for (int64_t i = 0; i < a.size(); ++i) {
+      InlineBitmap half = Xor(a[i], b[i]);
+      sum.push_back(Xor(half, carry));
+      carry = Or(And(a[i], b[i]), And(std::move(half), carry));
+    }
+    return sum;
+  }
+
+  // Returns the carry out of `a - b`, which is set iff `a >= b` (unsigned).
+  InlineBitmap UGe(const TruthTables& a, const TruthTables& b) const {
+    InlineBitmap carry = Constant(true);
+    Add(a, Not(b), carry);
+    return carry;
+  }
+
+  InlineBitmap Eq(const TruthTables& a, const TruthTables& b) const {
+    InlineBitmap eq = Constant(true);
+    for (int64_t i = 0; i < a.size(); ++i) {
+      eq.Intersect(Not(Xor(a[i], b[i])));
+    }
+    return eq;
+  }
+
+  InlineBitmap EqConstant(const TruthTables& a, int64_t value) const {
+    InlineBitmap eq = Constant(true);
+    for (int64_t i = 0; i < a.size(); ++i) {
+      const bool bit = i < 63 && ((value >> i) & 1) != 0;
+      eq.Intersect(bit ? a[i] : Not(a[i]));
+    }
+    return eq;
+  }
+
+  // Returns the value of `tables` if it is the same under every assignment
+  // and fits in an int64_t.
+  static std::optional<int64_t> ConstantValue(const TruthTables& tables) {
+    int64_t value = 0;
+    for (int64_t i = 0; i < tables.size(); ++i) {
+      if (tables[i].IsAllOnes()) {
+        if (i >= 63) {
+          return std::nullopt;
+        }
+        value |= int64_t{1} << i;
+      } else if (!tables[i].IsAllZeroes()) {
+        return std::nullopt;
+      }
+    }
+    return value;
+  }
+
+  std::optional<TruthTables> Simulate(Node* node) const {
+    auto operand = [&](int64_t i) -> const TruthTables& {
+      return tables_.at(node->operand(i));
+    };
+    const int64_t width = node->BitCountOrDie();
+    switch (node->op()) {
+      case Op::kIdentity:
+        return operand(0);
+      case Op::kNot:
+        return Not(operand(0));
+      case Op::kAnd:
+      case Op::kOr:
+      case Op::kXor:
+      case Op::kNand:
+      case Op::kNor: {
+        TruthTables result = operand(0);
+        for (int64_t j = 1; j < node->operand_count(); ++j) {
+          for (int64_t i = 0; i < width; ++i) {
+            if (node->OpIn({Op::kAnd, Op::kNand})) {
+              result[i].Intersect(operand(j)[i]);
+            } else if (node->OpIn({Op::kOr, Op::kNor})) {
+              result[i].Union(operand(j)[i]);
+            } else {
+              result[i].SymmetricDifference(operand(j)[i]);
+            }
+          }
+        }
+        if (node->OpIn({Op::kNand, Op::kNor})) {
+          return Not(std::move(result));
+        }
+        return result;
+      }
+      case Op::kAndReduce:
+      case Op::kOrReduce:
+      case Op::kXorReduce: {
+        InlineBitmap result = Constant(node->op() == Op::kAndReduce);
+        for (const InlineBitmap& table : operand(0)) {
+          if (node->op() == Op::kAndReduce) {
+            result.Intersect(table);
+          } else if (node->op() == Op::kOrReduce) {
+            result.Union(table);
+          } else {
+            result.SymmetricDifference(table);
+          }
+        }
+        return TruthTables{std::move(result)};
+      }
+      case Op::kBitSlice: {
+        const int64_t start = node->As<BitSlice>()->start();
+        return TruthTables(operand(0).begin() + start,
+                           operand(0).begin() + start + width);
+      }
+      case Op::kConcat: {
+        TruthTables result;
+        result.reserve(width);
+        for (int64_t j = node->operand_count() - 1; j >= 0; --j) {
+          absl::c_copy(operand(j), std::back_inserter(result));
+        }
+        return result;
+      }
+      case Op::kReverse: {
+        TruthTables result = operand(0);
+        absl::c_reverse(result);
+        return result;
+      }
+      case Op::kZeroExt:
+      case Op::kSignExt: {
+        TruthTables result = operand(0);
+        InlineBitmap fill = node->op() == Op::kSignExt && !result.empty()
+                                ? result.back()
+                                : Constant(false);
+        result.resize(width, fill);
+        return result;
+      }
+      case Op::kEq:
+        return TruthTables{Eq(operand(0), operand(1))};
+      case Op::kNe:
+        return TruthTables{Not(Eq(operand(0), operand(1)))};
+      case Op::kUGe:
+        return TruthTables{UGe(operand(0), operand(1))};
+      case Op::kULt:
+        return TruthTables{Not(UGe(operand(0), operand(1)))};
+      case Op::kULe:
+        return TruthTables{UGe(operand(1), operand(0))};
+      case Op::kUGt:
+        return TruthTables{Not(UGe(operand(1), operand(0)))};
+      case Op::kAdd: {
+        InlineBitmap carry = Constant(false);
+        return Add(operand(0), operand(1), carry);
+      }
+      case Op::kSub: {
+        InlineBitmap carry = Constant(true);
+        return Add(operand(0), Not(operand(1)), carry);
+      }
+      case Op::kNeg: {
+        InlineBitmap carry = Constant(true);
+        return Add(Not(operand(0)), FromBits(Bits(width)), carry);
+      }
+      case Op::kShll:
+      case Op::kShrl:
+      case Op::kShra: {
+        const TruthTables& value = operand(0);
+        std::optional<int64_t> amount = ConstantValue(operand(1));
+        if (!amount.has_value()) {
+          return std::nullopt;
+        }
+        InlineBitmap fill = node->op() == Op::kShra && width > 0
+                                ? value.back()
+                                : Constant(false);
+        *amount = std::min(*amount, width);
+        TruthTables result(width, fill);
+        for (int64_t i = 0; i < width; ++i) {
+          int64_t source = node->op() == Op::kShll ? i - *amount : i + *amount;
+          if (source >= 0 && source < width) {
+            result[i] = value[source];
+          }
+        }
+        return result;
+      }
+      case Op::kSel: {
+        Select* select = node->As<Select>();
+        const TruthTables& selector = tables_.at(select->selector());
+        std::optional<TruthTables> result;
+        InlineBitmap matched = Constant(false);
+        for (int64_t k = 0; k < select->cases().size(); ++k) {
+          InlineBitmap match = EqConstant(selector, k);
+          matched.Union(match);
+          const TruthTables& value = tables_.at(select->get_case(k));
+          result = result.has_value() ? Mux(match, *result, value) : value;
+        }
+        if (select->default_value().has_value()) {
+          const TruthTables& value = tables_.at(*select->default_value());
+          result = result.has_value() ? Mux(matched, value, *result) : value;
+        }
+        return result;
+      }
+      case Op::kPrioritySel:
+      case Op::kOneHotSel: {
+        const bool priority = node->op() == Op::kPrioritySel;
+        const TruthTables& selector = operand(0);
+        absl::Span<Node* const> cases =
+            priority ? node->As<PrioritySelect>()->cases()
+                     : node->As<OneHotSelect>()->cases();
+        TruthTables result = FromBits(Bits(width));
+        InlineBitmap remaining = Constant(true);
+        for (int64_t k = 0; k < cases.size(); ++k) {
+          InlineBitmap chosen = selector[k];
+          if (priority) {
+            chosen.Intersect(remaining);
+            remaining.Intersect(Not(selector[k]));
+          }
+          const TruthTables& value = tables_.at(cases[k]);
+          for (int64_t i = 0; i < width; ++i) {
+            result[i].Union(And(chosen, value[i]));
+          }
+        }
+        if (priority) {
+          const TruthTables& value =
+              tables_.at(node->As<PrioritySelect>()->default_value());
+          for (int64_t i = 0; i < width; ++i) {
+            result[i].Union(And(remaining, value[i]));
+          }
+        }
+        return result;
+      }
+      default:
+        return std::nullopt;
+    }
+  }
+
+  const int64_t assignment_count_;
+  const QueryEngine& query_engine_;
+  absl::flat_hash_map<Node*, TruthTables> tables_;
+};
+
+// The largest min-cut (in unknown bits) which is simulated bit-parallel.
+constexpr int64_t kMaxSimulatedCutBits = 20;
+
+// Computes the value of the selector under each assignment to the unknown bits
+// of the min-cut (little-endian across the cut nodes, as the new selector is
+// assembled), or returns std::nullopt if the cone can't be simulated.
+std::optional<std::vector<Bits>> SimulateSelector(
+    Node* selector, absl::Span<Node* const> min_cut,
+    absl::Span<const SharedLeafTypeTree<TernaryVector>> cut_ternaries,
+    const QueryEngine& query_engine) {
+  if (!selector->GetType()->IsBits()) {
+    return std::nullopt;
+  }
+  int64_t unknown_bits = 0;
   for (size_t i = 0; i < min_cut.size(); ++i) {
-    Node* cut_node = min_cut[i];
-    std::optional<SharedLeafTypeTree<TernaryVector>> ternary =
-        query_engine.GetTernary(cut_node);
-    VLOG(4) << "Ternary for cut node " << cut_node->GetName() << ": "
-            << ternary->ToString(
-                   [](TernarySpan span) { return ToString(span); });
-    cut_ternaries.push_back(*std::move(ternary));
+    if (!min_cut[i]->GetType()->IsBits()) {
+      return std::nullopt;
+    }
+    unknown_bits += absl::c_count(cut_ternaries[i].AsView().Get({}),
+                                  TernaryValue::kUnknown);
+  }
+  if (unknown_bits > kMaxSimulatedCutBits) {
+    return std::nullopt;
   }
+  BitParallelSimulator simulator(unknown_bits, query_engine);
+  int64_t next_unknown = 0;
+  for (size_t i = 0; i < min_cut.size(); ++i) {
+    simulator.SetCut(min_cut[i], cut_ternaries[i].AsView().Get({}),
+                     next_unknown);
+  }
+  const TruthTables* tables = simulator.Evaluate(selector);
+  if (tables == nullptr) {
+    return std::nullopt;
+  }
+  return simulator.Values(*tables);
+}
 
-  VLOG(2) << "Merging a " << unknown_bits
-          << "-bit lookup table into its controlled selects: "
-          << absl::StrJoin(candidate_selects, ", ",
-                           [](std::string* out, Select* select) {
-                             absl::StrAppend(out, select->GetName());
-                           });
-  if (VLOG_IS_ON(3)) {
-    for (Select* candidate : candidate_selects) {
-      VLOG(3) << "- " << candidate->ToString();
+// Returns the standard delay estimate for `node`. Some nodes have no delay
+// model (these would be eliminated before codegen), so return zero for these.
+int64_t GetNodeDelay(Node* node) {
+  absl::StatusOr<int64_t> delay =
+      GetStandardDelayEstimator().GetOperationDelayInPs(node);
+  return delay.ok() ? *delay : 0;
+}
+
+// Returns the critical-path delay from the min-cut (or known values) to the
+// output of `selector`, which merging the LUT removes from the path into the
+// controlled selects.
+int64_t GetConeDelay(Node* selector, const absl::flat_hash_set<Node*>& cut,
+                     const QueryEngine& query_engine) {
+  absl::flat_hash_map<Node*, int64_t> arrival;
+  std::vector<std::pair<Node*, bool>> stack = {{selector, false}};
+  while (!stack.empty()) {
+    auto [node, operands_ready] = stack.back();
+    stack.pop_back();
+    if (arrival.contains(node)) {
+      continue;
     }
+    if (cut.contains(node) || query_engine.IsFullyKnown(node)) {
+      arrival[node] = 0;
+      continue;
+    }
+    if (!operands_ready) {
+      stack.push_back({node, true});
+      for (Node* operand : node->operands()) {
+        stack.push_back({operand, false});
+      }
+      continue;
+    }
+    int64_t start = 0;
+    for (Node* operand : node->operands()) {
+      start = std::max(start, arrival.at(operand));
+    }
+    arrival[node] = start + GetNodeDelay(node);
   }
+  return arrival.at(selector);
+}
 
+// The most a select may be widened by merging a LUT into it, in selector bits;
+// each bit doubles the number of cases.
+constexpr int64_t kMaxSelectWideningBits = 2;
+
+// Computes the value of the selector under each assignment to the min-cut by
+// running the interpreter once per assignment; used for the cones which the
+// bit-parallel simulator doesn't support.
+absl::StatusOr<std::vector<Bits>> InterpretSelector(
+    Node* selector, absl::Span<Node* const> min_cut,
+    absl::Span<const SharedLeafTypeTree<TernaryVector>> cut_ternaries,
+    const QueryEngine& query_engine) {
   // Populate an interpreter with all known values that feed into the
   // selector.
   IrInterpreter base_interpreter;
@@ -284,6 +656,129 @@ absl::StatusOr<bool> MaybeMergeLutIntoSelects(
       });
   XLS_RETURN_IF_ERROR(status);
   XLS_RET_CHECK_EQ(new_case_sequence.size(), new_case_count);
+  return new_case_sequence;
+}
+
+absl::StatusOr<bool> MaybeMergeLutIntoSelects(
+    Node* selector, const QueryEngine& query_engine, int64_t opt_level,
+    std::optional<DataflowGraphAnalysis>& dataflow_graph_analysis) {
+  int64_t max_case_count = 0;
+  std::vector<Select*> candidate_selects;
+  candidate_selects.reserve(1);
+  for (Node* user : selector->users()) {
+    if (user->Is<Select>() && user->As<Select>()->selector() == selector) {
+      candidate_selects.push_back(user->As<Select>());
+      max_case_count = std::max(max_case_count, CaseCount(user->As<Select>()));
+    }
+  }
+  if (candidate_selects.empty()) {
+    return false;
+  }
+  CHECK(!candidate_selects.empty());
+
+  // Find the minimum set of unknown bits that fully determine the value of the
+  // selector; we can treat the selector as defined by a LUT, then merge it into
+  // the select(s) it controls by reordering cases.
+  int64_t unknown_bits = 0;
+  int64_t max_bits_needed = Bits::MinBitCountUnsigned(max_case_count - 1);
+  if (max_bits_needed <= 1) {
+    // We can't narrow the controlled selects any further unless the selector is
+    // actually constant... which should be handled by other (cheaper) passes.
+    return false;
+  }
+
+  // Initialize the graph analysis if not done already.
+  if (!dataflow_graph_analysis.has_value()) {
+    dataflow_graph_analysis.emplace(selector->function_base(), &query_engine);
+  }
+
+  VLOG(3) << "Finding min cut for " << selector->GetName() << " ("
+          << max_bits_needed << " bits needed)" << " controlling "
+          << candidate_selects.size() << " select(s)";
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<Node*> min_cut,
+      dataflow_graph_analysis->GetMinCutFor(
+          selector, /*max_unknown_bits=*/max_bits_needed, &unknown_bits));
+  if (min_cut.empty()) {
+    // There's no better alternative; this selector is already optimal.
+    return false;
+  }
+  VLOG(3) << "Found " << unknown_bits << "-bit min cut for "
+          << selector->GetName() << ": "
+          << absl::StrJoin(min_cut, ", ", [](std::string* out, Node* node) {
+               absl::StrAppend(out, node->GetName());
+             });
+
+  // Remove all candidate selects that wouldn't benefit from this transform.
+  const bool selector_is_trivial = IsTriviallyDerived(
+      selector, absl::flat_hash_set<Node*>(min_cut.begin(), min_cut.end()));
+  std::optional<int64_t> cone_delay;
+  std::erase_if(candidate_selects, [&](Select* select) {
+    int64_t bits_needed = Bits::MinBitCountUnsigned(CaseCount(select) - 1);
+    if (unknown_bits < bits_needed) {
+      // This transform will narrow this select.
+      return false;
+    }
+    if (unknown_bits == bits_needed && !selector_is_trivial) {
+      // This transform will keep this select approximately the same width, but
+      // should save delay through the selector.
+      return false;
+    }
+    if (unknown_bits == bits_needed || bits_needed == 0 ||
+        unknown_bits - bits_needed > kMaxSelectWideningBits) {
+      // Either nothing is gained, or the select would grow too much.
+      return true;
+    }
+    // This transform will widen this select, adding a level of muxing per
+    // extra selector bit; it's only worthwhile if that's cheaper than the
+    // logic it removes from in front of the selector.
+    if (!cone_delay.has_value()) {
+      cone_delay = GetConeDelay(
+          selector, absl::flat_hash_set<Node*>(min_cut.begin(), min_cut.end()),
+          query_engine);
+    }
+    const int64_t level_delay = CeilOfRatio(GetNodeDelay(select), bits_needed);
+    return *cone_delay <= level_delay * (unknown_bits - bits_needed);
+  });
+  if (candidate_selects.empty()) {
+    return false;
+  }
+
+  std::vector<SharedLeafTypeTree<TernaryVector>> cut_ternaries;
+  cut_ternaries.reserve(min_cut.size());
+  for (size_t i = 0; i < min_cut.size(); ++i) {
+    Node* cut_node = min_cut[i];
+    std::optional<SharedLeafTypeTree<TernaryVector>> ternary =
+        query_engine.GetTernary(cut_node);
+    VLOG(4) << "Ternary for cut node " << cut_node->GetName() << ": "
+            << ternary->ToString(
+                   [](TernarySpan span) { return ToString(span); });
+    cut_ternaries.push_back(*std::move(ternary));
+  }
+
+  VLOG(2) << "Merging a " << unknown_bits
+          << "-bit lookup table into its controlled selects: "
+          << absl::StrJoin(candidate_selects, ", ",
+                           [](std::string* out, Select* select) {
+                             absl::StrAppend(out, select->GetName());
+                           });
+  if (VLOG_IS_ON(3)) {
+    for (Select* candidate : candidate_selects) {
+      VLOG(3) << "- " << candidate->ToString();
+    }
+  }
+
+  std::vector<Bits> new_case_sequence;
+  if (std::optional<std::vector<Bits>> simulated =
+          SimulateSelector(selector, min_cut, cut_ternaries, query_engine);
+      simulated.has_value()) {
+    new_case_sequence = *std::move(simulated);
+  } else {
+    XLS_ASSIGN_OR_RETURN(new_case_sequence,
+                         InterpretSelector(selector, min_cut, cut_ternaries,
+                                           query_engine));
+  }
+  const int64_t new_case_count = new_case_sequence.size();
 
   if (absl::c_all_of(new_case_sequence, [&](const Bits& index) {
         return index == new_case_sequence.front();
@@ -184,6 +184,35 @@ TEST_F(LutConversionPassTest, MultipleSources) {
                  m::Literal(0), m::Literal(0), m::Literal(5), m::Literal(0)}));
 }
 
+TEST_F(LutConversionPassTest, DecodedSelector) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn decode(x: bits[2]) -> bits[8] {
+        one: bits[4] = literal(value=1)
+        two: bits[4] = literal(value=2)
+        three: bits[2] = literal(value=3)
+        literal.10: bits[8] = literal(value=10)
+        literal.11: bits[8] = literal(value=11)
+        literal.12: bits[8] = literal(value=12)
+        literal.13: bits[8] = literal(value=13)
+        literal.99: bits[8] = literal(value=99)
+        wide_x: bits[4] = zero_ext(x, new_bit_count=4)
+        doubled_x: bits[4] = shll(wide_x, one)
+        odd_x: bits[4] = add(doubled_x, one)
+        is_three: bits[1] = eq(x, three)
+        selector: bits[4] = sel(is_three, cases=[odd_x, two])
+        ret result: bits[8] = sel(selector, cases=[literal.10, literal.11, literal.12, literal.13], default=literal.99)
+     }
+  )",
+                                                       p.get()));
+
+  solvers::z3::ScopedVerifyEquivalence stays_equivalent(f);
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Select(m::Param("x"), {m::Literal(11), m::Literal(13),
+                                        m::Literal(99), m::Literal(12)}));
+}
+
 // Found by minimizing a real example during development.
 TEST_F(LutConversionPassTest, ComplexExample) {
   auto p = CreatePackage();
@@ -34,6 +34,7 @@
 #include "absl/numeric/int128.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/types/span.h"
@@ -69,6 +70,7 @@
 #include "xls/passes/predicate_state.h"
 #include "xls/passes/proc_state_range_query_engine.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -1804,28 +1806,36 @@ void AnalysisLog(FunctionBase* f, const QueryEngine& query_engine) {
   }
 }
 
+// Limit on the number of select-arm contexts the context sensitive range
+// analysis specializes on. Past this the remaining contexts use the
+// context-free ranges so huge designs don't stall the pass. This is a count
+// rather than a time limit to keep the optimization deterministic.
+constexpr int64_t kMaxContextSpecializations = 4096;
+
 absl::StatusOr<AliasingQueryEngine> GetQueryEngine(FunctionBase* f,
-                                                   AnalysisType analysis) {
+                                                   AnalysisType analysis,
+                                                   QueryEngineCache* cache) {
   std::vector<std::unique_ptr<QueryEngine>> engines;
   engines.push_back(std::make_unique<StatelessQueryEngine>());
   if (analysis == AnalysisType::kRangeWithContext) {
     if (ProcStateRangeQueryEngine::CanAnalyzeProcStateEvolution(f)) {
       // NB ProcStateRange already includes a ternary qe
-      engines.push_back(std::make_unique<ProcStateRangeQueryEngine>());
+      engines.push_back(MakeProcStateRangeQueryEngine(f, cache));
     } else {
-      engines.push_back(std::make_unique<TernaryQueryEngine>());
+      engines.push_back(MakeTernaryQueryEngine(f, cache));
     }
-    engines.push_back(std::make_unique<ContextSensitiveRangeQueryEngine>());
+    engines.push_back(MakeContextSensitiveRangeQueryEngine(
+        f, kMaxContextSpecializations, cache));
   } else if (analysis == AnalysisType::kRange) {
     if (ProcStateRangeQueryEngine::CanAnalyzeProcStateEvolution(f)) {
       // NB ProcStateRange already includes a ternary qe
-      engines.push_back(std::make_unique<ProcStateRangeQueryEngine>());
+      engines.push_back(MakeProcStateRangeQueryEngine(f, cache));
     } else {
-      engines.push_back(std::make_unique<TernaryQueryEngine>());
-      engines.push_back(std::make_unique<RangeQueryEngine>());
+      engines.push_back(MakeTernaryQueryEngine(f, cache));
+      engines.push_back(MakeRangeQueryEngine(f, cache));
     }
   } else {
-    engines.push_back(std::make_unique<TernaryQueryEngine>());
+    engines.push_back(MakeTernaryQueryEngine(f, cache));
   }
   auto query_engine = std::make_unique<UnionQueryEngine>(std::move(engines));
   XLS_RETURN_IF_ERROR(query_engine->Populate(f).status());
@@ -1835,13 +1845,62 @@ absl::StatusOr<AliasingQueryEngine> GetQueryEngine(FunctionBase* f,
   return AliasingQueryEngine(std::move(query_engine));
 }
 
+// Returns whether the narrowing opportunities of every node of `f` depend only
+// on the nodes near it, so that a node which is outside the NarrowingCandidates
+// of the changes since the last run has no new opportunity. That is the case
+// when the analysis of each node depends only on the nodes it transitively
+// uses, but not for the context-sensitive analysis (which depends on the
+// selects guarding a node) nor for proc state ranges (which depend on the whole
+// proc).
+bool CanNarrowIncrementally(FunctionBase* f, AnalysisType analysis) {
+  switch (analysis) {
+    case AnalysisType::kTernary:
+      return true;
+    case AnalysisType::kRange:
+      return !ProcStateRangeQueryEngine::CanAnalyzeProcStateEvolution(f);
+    default:
+      return false;
+  }
+}
+
+// Returns the nodes whose narrowing opportunities may have changed given the
+// nodes which were added or had their operands or users change. Narrowing a
+// node looks at the analysis of the node and its operands, which only changes
+// if something the node transitively uses changed, and at its users and their
+// users, which only change if an operand of one of them changed.
+absl::flat_hash_set<Node*> NarrowingCandidates(
+    const absl::flat_hash_set<Node*>& changed) {
+  absl::flat_hash_set<Node*> candidates;
+  std::vector<Node*> worklist;
+  auto add = [&](Node* node) {
+    if (candidates.insert(node).second) {
+      worklist.push_back(node);
+    }
+  };
+  for (Node* node : changed) {
+    add(node);
+    for (Node* operand : node->operands()) {
+      add(operand);
+    }
+  }
+  while (!worklist.empty()) {
+    Node* node = worklist.back();
+    worklist.pop_back();
+    for (Node* user : node->users()) {
+      add(user);
+    }
+  }
+  return candidates;
+}
+
 }  // namespace
 
 absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
   XLS_ASSIGN_OR_RETURN(AliasingQueryEngine query_engine,
-                       GetQueryEngine(f, RealAnalysis(options)));
+                       GetQueryEngine(f, RealAnalysis(options),
+                                      options.query_engine_cache));
 
   PredicateDominatorAnalysis pda = PredicateDominatorAnalysis::Run(f);
   SpecializedQueryEngines sqe(RealAnalysis(options), pda, query_engine);
@@ -1849,7 +1908,33 @@ absl::StatusOr<bool> NarrowingPass::RunOnFunctionBaseInternal(
   NarrowVisitor narrower(sqe, RealAnalysis(options), options,
                          options.splits_enabled());
 
+  // On later runs with a cache only the nodes near the changes made since the
+  // previous run of a narrowing pass with the same configuration are visited.
+  QueryEngineCache* cache = options.query_engine_cache;
+  const std::string client =
+      absl::StrCat(kName, "/", static_cast<int>(RealAnalysis(options)),
+                   options.splits_enabled() ? "/splits" : "");
+  std::optional<absl::flat_hash_set<Node*>> candidates;
+  if (cache != nullptr) {
+    std::optional<absl::flat_hash_set<Node*>> changed =
+        cache->TakeChangedNodes(f, client);
+    if (changed.has_value() &&
+        CanNarrowIncrementally(f, RealAnalysis(options))) {
+      candidates = NarrowingCandidates(*changed);
+    }
+  }
+
   for (Node* node : TopoSort(f)) {
+    if (PassBudgetExhausted(options, results)) {
+      // The nodes not yet visited must be visited by the next run.
+      if (cache != nullptr) {
+        cache->ResetChangedNodes(f, client);
+      }
+      break;
+    }
+    if (candidates.has_value() && !candidates->contains(node)) {
+      continue;
+    }
     // We specifically want gate ops to be eligible for being reduced to a
     // constant since there entire purpose is for preventing power consumption
     // and literals are basically free.
@@ -35,10 +35,13 @@
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
 #include "xls/ir/value.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
 
 namespace m = ::xls::op_matchers;
@@ -63,10 +66,11 @@ class NarrowingPassTestBase : public IrTestBase {
 
   virtual NarrowingPass::AnalysisType analysis() const = 0;
 
-  absl::StatusOr<bool> Run(Package* p) {
+  absl::StatusOr<bool> Run(Package* p, QueryEngineCache* cache = nullptr) {
     PassResults results;
     OptimizationPassOptions options;
     options.convert_array_index_to_select = 2;
+    options.query_engine_cache = cache;
     return NarrowingPass(analysis()).Run(p, options, &results);
   }
 };
@@ -1561,6 +1565,33 @@ TEST_P(NarrowingPassTest, ArrayBoundsProof) {
   EXPECT_THAT(f->return_value(), m::ArrayIndex(_, {_}, m::AssumedInBounds()));
 }
 
+TEST_P(NarrowingPassTest, LaterRunsWithCacheSeeNewOpportunities) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue zero = fb.Literal(UBits(0, 8));
+  BValue masked = fb.And(x, zero);
+  BValue sum = fb.Add(x, y);
+  fb.Tuple({masked, sum});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  ASSERT_THAT(Run(p.get(), &cache), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Tuple(m::Literal(0), m::Add()));
+  XLS_ASSERT_OK(Run(p.get(), &cache).status());
+
+  // An opportunity created after the first runs is found by the next one.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * masked_sum,
+      f->MakeNode<NaryOp>(SourceInfo(),
+                          std::vector<Node*>{sum.node(), zero.node()},
+                          Op::kAnd));
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(1, masked_sum));
+  ASSERT_THAT(Run(p.get(), &cache), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Tuple(m::Literal(0), m::Literal(0)));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NarrowingPassTestInstantiation, NarrowingPassTest,
     ::testing::Values(NarrowingPass::AnalysisType::kTernary,
@@ -14,14 +14,20 @@
 
 #include "xls/passes/optimization_pass.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
+#include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -29,14 +35,26 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/math_util.h"
+#include "xls/common/resource_usage.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/ir/call_graph.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/concurrent_function_base_transform.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_instantiation.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/preserved_analyses.h"
+#include "xls/passes/query_engine_cache.h"
 
 namespace xls {
 
@@ -144,52 +162,289 @@ absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBase(
   return changed;
 }
 
+absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBaseAndRecord(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  QueryEngineCache::PreservationScope preservation(options.query_engine_cache,
+                                                   f, GetPreservedAnalyses());
+  if (!options.record_metrics) {
+    return RunOnFunctionBaseInternal(f, options, results);
+  }
+  FunctionBaseRunMetrics run{.function_base = f->name(),
+                             .thread = std::this_thread::get_id()};
+  absl::Duration analysis_before = ScopedAnalysisTimer::ElapsedOnThisThread();
+  run.start = absl::Now();
+  XLS_ASSIGN_OR_RETURN(bool changed,
+                       RunOnFunctionBaseInternal(f, options, results));
+  run.duration = absl::Now() - run.start;
+  run.changed = changed;
+  run.analysis_duration =
+      ScopedAnalysisTimer::ElapsedOnThisThread() - analysis_before;
+  results->function_base_runs.push_back(std::move(run));
+  return changed;
+}
+
+namespace {
+
+// Partitions `function_bases` into groups which may be transformed
+// independently of one another: FunctionBases which call or instantiate one
+// another (transitively) are placed in the same group. Each group lists
+// indices into `function_bases` in increasing order, and groups are ordered by
+// their first index.
+std::vector<std::vector<int64_t>> IndependentFunctionBaseGroups(
+    absl::Span<FunctionBase* const> function_bases) {
+  absl::flat_hash_map<FunctionBase*, int64_t> index;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    index[function_bases[i]] = i;
+  }
+  // Union-find over indices.
+  std::vector<int64_t> parent(function_bases.size());
+  absl::c_iota(parent, 0);
+  auto find = [&](int64_t i) {
+    while (parent[i] != i) {
+      parent[i] = parent[parent[i]];
+      i = parent[i];
+    }
+    return i;
+  };
+  auto unite = [&](FunctionBase* a, FunctionBase* b) {
+    auto it = index.find(b);
+    if (it == index.end()) {
+      return;
+    }
+    int64_t root_a = find(index.at(a));
+    int64_t root_b = find(it->second);
+    parent[std::max(root_a, root_b)] = std::min(root_a, root_b);
+  };
+  for (FunctionBase* f : function_bases) {
+    for (FunctionBase* callee : GetDependentFunctions(f)) {
+      unite(f, callee);
+    }
+    if (f->IsProc()) {
+      for (const std::unique_ptr<ProcInstantiation>& instantiation :
+           f->AsProcOrDie()->proc_instantiations()) {
+        unite(f, instantiation->proc());
+      }
+    }
+  }
+
+  std::vector<std::vector<int64_t>> groups;
+  absl::flat_hash_map<int64_t, int64_t> group_of_root;
+  for (int64_t i = 0; i < function_bases.size(); ++i) {
+    auto [it, inserted] = group_of_root.insert({find(i), groups.size()});
+    if (inserted) {
+      groups.emplace_back();
+    }
+    groups[it->second].push_back(i);
+  }
+  return groups;
+}
+
+}  // namespace
+
+absl::StatusOr<bool> OptimizationFunctionBasePass::RunOnFunctionBasesConcurrently(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  std::vector<FunctionBase*> function_bases = p->GetFunctionBases();
+  std::vector<std::vector<int64_t>> groups =
+      IndependentFunctionBaseGroups(function_bases);
+  VLOG(3) << absl::StreamFormat(
+      "Running %s on %d function bases in %d independent groups", long_name(),
+      function_bases.size(), groups.size());
+
+  // Each group is transformed serially on one thread with its own results.
+  struct GroupResult {
+    absl::Status status;
+    bool changed = false;
+    PassResults results;
+  };
+  std::vector<GroupResult> group_results(groups.size());
+  ConcurrentFunctionBaseTransform transform(p, function_bases);
+  options.function_base_thread_pool->ParallelFor(
+      groups.size(), /*grain=*/1, [&](int64_t g) {
+        GroupResult& group_result = group_results[g];
+        for (int64_t i : groups[g]) {
+          if (PassBudgetExhausted(options, &group_result.results)) {
+            break;
+          }
+          if (options.IsFrozen(function_bases[i])) {
+            continue;
+          }
+          ConcurrentFunctionBaseTransform::Scope scope(transform, i);
+          absl::StatusOr<bool> changed = RunOnFunctionBaseAndRecord(
+              function_bases[i], options, &group_result.results);
+          if (!changed.ok()) {
+            group_result.status = changed.status();
+            break;
+          }
+          group_result.changed = group_result.changed || *changed;
+        }
+      });
+  transform.Finish();
+
+  bool changed = false;
+  for (GroupResult& group_result : group_results) {
+    XLS_RETURN_IF_ERROR(group_result.status);
+    changed = changed || group_result.changed;
+    absl::c_move(group_result.results.invocations,
+                 std::back_inserter(results->invocations));
+    results->aggregate_results.AccumulateCompoundPassResult(
+        group_result.results.aggregate_results);
+    absl::c_move(group_result.results.function_base_runs,
+                 std::back_inserter(results->function_base_runs));
+    results->budget_exhausted =
+        results->budget_exhausted || group_result.results.budget_exhausted;
+  }
+  return changed;
+}
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::RunInternal(
     Package* p, const OptimizationPassOptions& options,
     PassResults* results) const {
+  if (options.function_base_thread_pool != nullptr &&
+      p->GetFunctionBases().size() > 1) {
+    return RunOnFunctionBasesConcurrently(p, options, results);
+  }
   bool changed = false;
   for (FunctionBase* f : p->GetFunctionBases()) {
+    if (PassBudgetExhausted(options, results)) {
+      break;
+    }
+    if (options.IsFrozen(f)) {
+      continue;
+    }
     XLS_ASSIGN_OR_RETURN(bool function_changed,
-                         RunOnFunctionBaseInternal(f, options, results));
+                         RunOnFunctionBaseAndRecord(f, options, results));
     changed = changed || function_changed;
   }
   return changed;
 }
 
+namespace {
+
+// Queue of the nodes left to simplify by TransformNodesToFixedPoint. Listens to
+// changes of the function so only the nodes affected by a simplification are
+// queued again.
+class SimplificationWorklist final : public ChangeListener {
+ public:
+  SimplificationWorklist(FunctionBase* f,
+                         std::optional<absl::Span<Node* const>> initial_order)
+      : f_(f) {
+    if (initial_order.has_value()) {
+      for (Node* node : *initial_order) {
+        Push(node);
+      }
+    } else {
+      for (Node* node : f->nodes()) {
+        Push(node);
+      }
+    }
+    f_->RegisterChangeListener(this);
+  }
+  ~SimplificationWorklist() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  // Returns the next node to simplify, or nullptr if there are none.
+  Node* Pop() {
+    while (!worklist_.empty()) {
+      auto [node, node_id] = worklist_.front();
+      worklist_.pop_front();
+      // Removed nodes are dropped from `queued_ids_` so `node` is only
+      // dereferenced if it still exists.
+      if (queued_ids_.erase(node_id) > 0) {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  // Queues `node` again if it has not been removed.
+  void Requeue(Node* node, int64_t node_id) {
+    if (!removed_ids_.contains(node_id)) {
+      Push(node);
+    }
+  }
+
+  void NodeAdded(Node* node) override { Push(node); }
+  void NodeDeleted(Node* node) override {
+    queued_ids_.erase(node->id());
+    removed_ids_.insert(node->id());
+    // The operands lost a user.
+    for (Node* operand : node->operands()) {
+      Push(operand);
+    }
+  }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    PushWithUsers(node);
+    Push(old_operand);
+    if (!operand_nos.empty()) {
+      Push(node->operand(operand_nos.front()));
+    }
+  }
+  void OperandRemoved(Node* node, Node* old_operand) override {
+    PushWithUsers(node);
+    Push(old_operand);
+  }
+  void OperandAdded(Node* node) override {
+    PushWithUsers(node);
+    Push(node->operands().back());
+  }
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    f_ = nullptr;
+  }
+
+ private:
+  // Node pointers may be reused after a node is removed so nodes are tracked
+  // by id.
+  void Push(Node* node) {
+    if (queued_ids_.insert(node->id()).second) {
+      worklist_.push_back({node, node->id()});
+    }
+  }
+  // Users may match patterns which look through `node` to its operands.
+  void PushWithUsers(Node* node) {
+    Push(node);
+    for (Node* user : node->users()) {
+      Push(user);
+    }
+  }
+
+  FunctionBase* f_;
+  std::deque<std::pair<Node*, int64_t>> worklist_;
+  absl::flat_hash_set<int64_t> queued_ids_;
+  absl::flat_hash_set<int64_t> removed_ids_;
+};
+
+}  // namespace
+
 absl::StatusOr<bool> OptimizationFunctionBasePass::TransformNodesToFixedPoint(
-    FunctionBase* f,
-    std::function<absl::StatusOr<bool>(Node*)> simplify_f) const {
-  // Store nodes by id to avoid running afoul of Node* pointer values being
-  // reused.
+    FunctionBase* f, std::function<absl::StatusOr<bool>(Node*)> simplify_f,
+    std::optional<absl::Span<Node* const>> initial_order) const {
   absl::flat_hash_set<int64_t> simplified_node_ids;
+  SimplificationWorklist worklist(f, initial_order);
   bool changed = false;
-  bool changed_this_time = false;
-  do {
-    changed_this_time = false;
-    auto node_it = f->nodes().begin();
-    while (node_it != f->nodes().end()) {
-      // Save the next iterator because node_it may be invalidated by the call
-      // to simplify_f if simpplify_f ends up deleting 'node'.
-      auto next_it = std::next(node_it);
-      Node* node = *node_it;
-      // If the node was previously simplified and is now dead, avoid running
-      // simplification on it again to avoid inf-looping while simplifying the
-      // same node over and over again.
-      if (!node->IsDead() || !simplified_node_ids.contains(node->id())) {
-        // Grab the node ID before simplifying because the node might be
-        // removed when simplifying.
-        int64_t node_id = node->id();
-        XLS_ASSIGN_OR_RETURN(bool node_changed, simplify_f(node));
-        if (node_changed) {
-          simplified_node_ids.insert(node_id);
-          changed_this_time = true;
-          changed = true;
-        }
-      }
-      node_it = next_it;
+  while (Node* node = worklist.Pop()) {
+    // If the node was previously simplified and is now dead, avoid running
+    // simplification on it again to avoid inf-looping while simplifying the
+    // same node over and over again.
+    if (node->IsDead() && simplified_node_ids.contains(node->id())) {
+      continue;
     }
-  } while (changed_this_time);
-
+    // Grab the node ID before simplifying because the node might be removed
+    // when simplifying.
+    int64_t node_id = node->id();
+    XLS_ASSIGN_OR_RETURN(bool node_changed, simplify_f(node));
+    if (node_changed) {
+      simplified_node_ids.insert(node_id);
+      changed = true;
+      // The node may have been changed in place.
+      worklist.Requeue(node, node_id);
+    }
+  }
   return changed;
 }
 
@@ -26,11 +26,13 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
@@ -40,9 +42,13 @@
 #include "xls/passes/pass_base.h"
 #include "xls/passes/pass_registry.h"
 #include "xls/passes/pipeline_generator.h"
+#include "xls/passes/preserved_analyses.h"
 
 namespace xls {
 
+class ContentAddressedDirectoryCache;
+class QueryEngineCache;
+
 inline constexpr int64_t kMaxOptLevel = 3;
 
 // Metadata for RAMs.
@@ -139,6 +145,11 @@ struct OptimizationPassOptions : public PassOptionsBase {
   // the optimization pass pipeline which holds this value.
   bool inline_procs = false;
 
+  // If set, proc inlining only merges strongly connected clusters of procs,
+  // split into pieces of at most this many procs, and keeps the channels
+  // between clusters. Otherwise all procs are inlined into the top proc.
+  std::optional<int64_t> max_proc_inlining_cluster_size = std::nullopt;
+
   // If this is not `std::nullopt`, convert array indexes with fewer than or
   // equal to the given number of possible indices (by range analysis) into
   // chains of selects. Otherwise, this optimization is skipped, since it can
@@ -159,6 +170,31 @@ struct OptimizationPassOptions : public PassOptionsBase {
 
   // Optimize for best case throughput, even at the cost of area.
   bool optimize_for_best_case_throughput = false;
+
+  // If non-null, OptimizationFunctionBasePasses transform independent
+  // FunctionBases (those which do not call or instantiate one another)
+  // concurrently on this pool. The resulting IR is identical to a serial run.
+  ThreadPool* function_base_thread_pool = nullptr;
+
+  // If non-null, passes obtain their query engines from this cache so that
+  // analyses are updated incrementally across passes rather than rebuilt from
+  // scratch each time. Must outlive the pass invocation.
+  QueryEngineCache* query_engine_cache = nullptr;
+
+  // If non-null, the pre-inlining passes reuse the optimized bodies of leaf
+  // functions found in this cache (see function_optimization_cache.h) and store
+  // the bodies of those they optimize. Must outlive the pass invocation.
+  ContentAddressedDirectoryCache* function_optimization_cache = nullptr;
+
+  // If non-null, function-base passes leave these FunctionBases untouched,
+  // e.g. because their optimized bodies were restored from a cache.
+  const absl::flat_hash_set<const FunctionBase*>* frozen_function_bases =
+      nullptr;
+
+  bool IsFrozen(const FunctionBase* f) const {
+    return frozen_function_bases != nullptr &&
+           frozen_function_bases->contains(f);
+  }
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -333,6 +369,13 @@ class OptimizationFunctionBasePass : public OptimizationPass {
                                          const OptimizationPassOptions& options,
                                          PassResults* results) const;
 
+  // The analyses cached in `options.query_engine_cache` which stay valid across
+  // the changes this pass makes to a function/proc. See PreservedAnalyses for
+  // when an analysis may be declared preserved.
+  virtual PreservedAnalyses GetPreservedAnalyses() const {
+    return PreservedAnalyses::None();
+  }
+
  protected:
   // Iterates over each function and proc in the package calling
   // RunOnFunctionBase.
@@ -344,16 +387,36 @@ class OptimizationFunctionBasePass : public OptimizationPass {
       FunctionBase* f, const OptimizationPassOptions& options,
       PassResults* results) const = 0;
 
-  // Calls the given function for every node in the graph in a loop until no
-  // further simplifications are possible.  simplify_f should return true if the
-  // IR was modified. simplify_f can add or remove nodes including the node
-  // passed to it.
+  // Calls RunOnFunctionBaseInternal with the preserved analyses declared to the
+  // query engine cache, recording the run in `results->function_base_runs` if
+  // metrics are being recorded.
+  absl::StatusOr<bool> RunOnFunctionBaseAndRecord(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const;
+
+  // Implementation of RunInternal used when
+  // `options.function_base_thread_pool` is set.
+  absl::StatusOr<bool> RunOnFunctionBasesConcurrently(
+      Package* p, const OptimizationPassOptions& options,
+      PassResults* results) const;
+
+  // Calls the given function for every node in the graph until no further
+  // simplifications are possible.  simplify_f should return true if the IR was
+  // modified. simplify_f can add or remove nodes including the node passed to
+  // it.
+  //
+  // Nodes are visited from a worklist seeded with every node in `f` (in the
+  // order of `initial_order` if given). After a change only the nodes near it
+  // are revisited: added nodes, nodes whose operands changed along with their
+  // users, and nodes which gained or lost users. simplify_f must therefore only
+  // depend on the neighborhood of the node it is given.
   //
   // TransformNodesToFixedPoint returns true iff any invocations of simplify_f
   // returned true.
   absl::StatusOr<bool> TransformNodesToFixedPoint(
-      FunctionBase* f,
-      std::function<absl::StatusOr<bool>(Node*)> simplify_f) const;
+      FunctionBase* f, std::function<absl::StatusOr<bool>(Node*)> simplify_f,
+      std::optional<absl::Span<Node* const>> initial_order =
+          std::nullopt) const;
 };
 
 // Abstract base class for passes operate on procs. The derived
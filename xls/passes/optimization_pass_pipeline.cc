@@ -19,6 +19,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <string_view>
@@ -26,11 +27,19 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
 #include "xls/common/module_initializer.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/package.h"
 #include "xls/passes/arith_simplification_pass.h"
 #include "xls/passes/array_simplification_pass.h"
@@ -50,6 +59,7 @@
 #include "xls/passes/dataflow_simplification_pass.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/dfe_pass.h"
+#include "xls/passes/function_optimization_cache.h"
 #include "xls/passes/identity_removal_pass.h"
 #include "xls/passes/inlining_pass.h"
 #include "xls/passes/label_recovery_pass.h"
@@ -67,9 +77,11 @@
 #include "xls/passes/proc_state_optimization_pass.h"
 #include "xls/passes/proc_state_provenance_narrowing_pass.h"
 #include "xls/passes/proc_state_tuple_flattening_pass.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/ram_rewrite_pass.h"
 #include "xls/passes/reassociation_pass.h"
 #include "xls/passes/receive_default_value_simplification_pass.h"
+#include "xls/passes/sat_sweeping_pass.h"  // IWYU pragma: keep
 #include "xls/passes/select_lifting_pass.h"
 #include "xls/passes/select_simplification_pass.h"
 #include "xls/passes/sparsify_select_pass.h"
@@ -164,6 +176,84 @@ PreInliningPassGroup::PreInliningPassGroup()
   Add<IfOptLevelAtLeast<1, Inner>>();
 }
 
+absl::StatusOr<std::string> PreInliningPassGroup::CacheFingerprint(
+    const OptimizationPassOptions& options) const {
+  XLS_ASSIGN_OR_RETURN(PassPipelineProto::Element proto, ToProto());
+  return absl::StrFormat(
+      "%s;opt_level=%d;skip_passes=%s;convert_array_index_to_select=%d;"
+      "split_next_value_selects=%d;use_context_narrowing_analysis=%d;"
+      "optimize_for_best_case_throughput=%d",
+      proto.ShortDebugString(), options.opt_level,
+      absl::StrJoin(options.skip_passes, ","),
+      options.convert_array_index_to_select.value_or(-1),
+      options.split_next_value_selects.value_or(-1),
+      options.use_context_narrowing_analysis,
+      options.optimize_for_best_case_throughput);
+}
+
+absl::StatusOr<CompoundPassResult> PreInliningPassGroup::RunNested(
+    Package* p, const OptimizationPassOptions& options, PassResults* results,
+    std::string_view top_level_name,
+    absl::Span<const OptimizationInvariantChecker* const> invariant_checkers)
+    const {
+  ContentAddressedDirectoryCache* cache = options.function_optimization_cache;
+  // With a bisect limit the bodies depend on where the limit falls.
+  if (cache == nullptr || options.bisect_limit.has_value()) {
+    return OptimizationCompoundPass::RunNested(p, options, results,
+                                               top_level_name,
+                                               invariant_checkers);
+  }
+  XLS_ASSIGN_OR_RETURN(std::string fingerprint, CacheFingerprint(options));
+
+  absl::flat_hash_set<const FunctionBase*> restored;
+  // The name and key of each leaf function missing from the cache.
+  std::vector<std::pair<std::string, std::string>> missed;
+  for (const std::unique_ptr<Function>& f : p->functions()) {
+    if (!IsCacheableFunction(f.get())) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(std::string canonical_ir,
+                         CanonicalFunctionIr(f.get()));
+    std::string key =
+        ComputeFunctionOptimizationCacheKey(fingerprint, canonical_ir);
+    if (std::optional<std::string> cached = cache->Lookup(key)) {
+      absl::Status status = RestoreFunctionBody(f.get(), *cached);
+      if (status.ok()) {
+        VLOG(2) << "Restored optimized function " << f->name()
+                << " from the function optimization cache";
+        restored.insert(f.get());
+        continue;
+      }
+      LOG(WARNING) << "Ignoring function optimization cache entry " << key
+                   << " for " << f->name() << ": " << status;
+    }
+    missed.push_back({f->name(), std::move(key)});
+  }
+
+  OptimizationPassOptions group_options = options;
+  group_options.frozen_function_bases = &restored;
+  XLS_ASSIGN_OR_RETURN(
+      CompoundPassResult result,
+      OptimizationCompoundPass::RunNested(p, group_options, results,
+                                          top_level_name, invariant_checkers));
+  if (!restored.empty()) {
+    result.set_changed(true);
+  }
+
+  for (const auto& [name, key] : missed) {
+    // Dead functions are removed by the group.
+    std::optional<Function*> f = p->TryGetFunction(name);
+    if (!f.has_value()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(std::string canonical_ir, CanonicalFunctionIr(*f));
+    if (absl::Status status = cache->Store(key, canonical_ir); !status.ok()) {
+      LOG(WARNING) << status;
+    }
+  }
+  return result;
+}
+
 UnrollingAndInliningPassGroup::UnrollingAndInliningPassGroup()
     : OptimizationCompoundPass(UnrollingAndInliningPassGroup::kName,
                                "full function inlining passes") {
@@ -173,6 +263,10 @@ UnrollingAndInliningPassGroup::UnrollingAndInliningPassGroup()
   Add<DeadFunctionEliminationPass>();
 }
 
+SimplifyingInliningPass::SimplifyingInliningPass()
+    : InliningPass(kName, "Inlines simplified specializations of callees",
+                   std::make_unique<CapOptLevel<2, SimplificationPass>>()) {}
+
 ProcStateFlatteningFixedPointPass::ProcStateFlatteningFixedPointPass()
     : OptimizationFixedPointCompoundPass(
           ProcStateFlatteningFixedPointPass::kName, "Proc State Flattening") {
@@ -298,20 +392,33 @@ std::unique_ptr<OptimizationCompoundPass> CreateOptimizationPassPipeline() {
       "ir", "Top level pass pipeline");
   top->AddInvariantChecker<VerifierChecker>();
 
-  top->Add<PreInliningPassGroup>();
-  top->Add<UnrollingAndInliningPassGroup>();
-  top->Add<PostInliningPassGroup>();
+  for (std::unique_ptr<OptimizationCompoundPass>& group :
+       CreateOptimizationPassPipelineGroups()) {
+    top->AddOwned(std::move(group));
+  }
 
   return top;
 }
 
+std::vector<std::unique_ptr<OptimizationCompoundPass>>
+CreateOptimizationPassPipelineGroups() {
+  std::vector<std::unique_ptr<OptimizationCompoundPass>> groups;
+  groups.push_back(std::make_unique<PreInliningPassGroup>());
+  groups.push_back(std::make_unique<UnrollingAndInliningPassGroup>());
+  groups.push_back(std::make_unique<PostInliningPassGroup>());
+  return groups;
+}
+
 absl::StatusOr<bool> RunOptimizationPassPipeline(Package* package,
                                                  int64_t opt_level) {
   std::unique_ptr<OptimizationCompoundPass> pipeline =
       CreateOptimizationPassPipeline();
+  QueryEngineCache query_engine_cache;
+  OptimizationPassOptions options =
+      OptimizationPassOptions().WithOptLevel(opt_level);
+  options.query_engine_cache = &query_engine_cache;
   PassResults results;
-  return pipeline->Run(
-      package, OptimizationPassOptions().WithOptLevel(opt_level), &results);
+  return pipeline->Run(package, options, &results);
 }
 
 absl::Status OptimizationPassPipelineGenerator::AddPassToPipeline(
@@ -380,6 +487,7 @@ XLS_REGISTER_MODULE_INITIALIZER(simp_pass, {
 
 REGISTER_OPT_PASS(PreInliningPassGroup);
 REGISTER_OPT_PASS(UnrollingAndInliningPassGroup);
+REGISTER_OPT_PASS(SimplifyingInliningPass);
 REGISTER_OPT_PASS(ProcStateFlatteningFixedPointPass);
 REGISTER_OPT_PASS(PostInliningPassGroup);
 
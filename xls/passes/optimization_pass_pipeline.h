@@ -23,8 +23,11 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/ir/package.h"
+#include "xls/passes/inlining_pass.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 #include "xls/passes/pass_pipeline.pb.h"
 
 namespace xls {
@@ -41,10 +44,28 @@ class FixedPointSimplificationPass : public OptimizationFixedPointCompoundPass {
 };
 
 // The passes which are executed before any inlining has been performed.
+//
+// If OptimizationPassOptions::function_optimization_cache is set, leaf
+// functions found in the cache get their previously optimized bodies and are
+// frozen while the group runs; the other leaf functions are stored in the cache
+// once optimized.
 class PreInliningPassGroup : public OptimizationCompoundPass {
  public:
   static constexpr std::string_view kName = "pre-inlining";
   explicit PreInliningPassGroup();
+
+ protected:
+  absl::StatusOr<CompoundPassResult> RunNested(
+      Package* p, const OptimizationPassOptions& options, PassResults* results,
+      std::string_view top_level_name,
+      absl::Span<const OptimizationInvariantChecker* const> invariant_checkers)
+      const override;
+
+ private:
+  // Describes this group and the options which affect the optimized bodies of
+  // functions, for keying the function optimization cache.
+  absl::StatusOr<std::string> CacheFingerprint(
+      const OptimizationPassOptions& options) const;
 };
 
 // The passes which perform full function inlining.
@@ -57,6 +78,15 @@ class UnrollingAndInliningPassGroup : public OptimizationCompoundPass {
   explicit UnrollingAndInliningPassGroup();
 };
 
+// Inlining which simplifies each callee, specialized on the literal arguments
+// of its invokes, once before inlining it (see InliningPass). Bounds the size
+// of intermediate IR when inlining large call graphs, e.g. unrolled loops.
+class SimplifyingInliningPass : public InliningPass {
+ public:
+  static constexpr std::string_view kName = "simplifying_inlining";
+  explicit SimplifyingInliningPass();
+};
+
 // Passes that flatten proc state of aggregate types into individual elements.
 class ProcStateFlatteningFixedPointPass
     : public OptimizationFixedPointCompoundPass {
@@ -78,6 +108,14 @@ class PostInliningPassGroup : public OptimizationCompoundPass {
 // and analysis passes in the order of execution.
 std::unique_ptr<OptimizationCompoundPass> CreateOptimizationPassPipeline();
 
+// Returns the top-level pass groups of the standard pipeline in order of
+// execution (PreInliningPassGroup, UnrollingAndInliningPassGroup and
+// PostInliningPassGroup). Running each in turn under the verifier is
+// equivalent to running CreateOptimizationPassPipeline(); tools use this to
+// checkpoint the IR between groups.
+std::vector<std::unique_ptr<OptimizationCompoundPass>>
+CreateOptimizationPassPipelineGroups();
+
 // Creates and runs the standard pipeline on the given package with default
 // options.
 absl::StatusOr<bool> RunOptimizationPassPipeline(
@@ -19,12 +19,17 @@
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
 #include "xls/common/status/matchers.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/examples/sample_packages.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
@@ -36,7 +41,9 @@
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/passes/function_optimization_cache.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
 
 namespace m = ::xls::op_matchers;
 
@@ -325,5 +332,98 @@ TEST_F(OptimizationPipelineTest, ProcScopedChannels) {
   ASSERT_THAT(Run(p.get()), IsOkAndHolds(true));
 }
 
+TEST_F(OptimizationPipelineTest, ConcurrentFunctionBasesMatchSerial) {
+  // No top is set so that every function survives the pipeline. `g` invokes
+  // `f` so the two are transformed together; `h` and `k` are independent.
+  constexpr std::string_view kIr = R"(
+package concurrent
+
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  not_x: bits[8] = not(x)
+  not_not_x: bits[8] = not(not_x)
+  ret add.1: bits[8] = add(not_not_x, y)
+}
+
+fn g(a: bits[8]) -> bits[8] {
+  zero: bits[8] = literal(value=0)
+  sum: bits[8] = add(a, zero)
+  ret r: bits[8] = invoke(sum, a, to_apply=f)
+}
+
+fn h(a: bits[16], b: bits[16]) -> bits[16] {
+  lit: bits[16] = literal(value=3)
+  m: bits[16] = umul(a, lit)
+  s: bits[16] = sub(m, b)
+  ret n: bits[16] = neg(s)
+}
+
+fn k(p: bits[1], a: bits[32], b: bits[32]) -> bits[32] {
+  sel: bits[32] = sel(p, cases=[a, b])
+  sel2: bits[32] = sel(p, cases=[a, sel])
+  ret and.2: bits[32] = and(sel2, sel2)
+}
+)";
+  auto run = [&](ThreadPool* pool) -> absl::StatusOr<std::string> {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<VerifiedPackage> p, ParsePackage(kIr));
+    OptimizationPassOptions options;
+    options.function_base_thread_pool = pool;
+    PassResults results;
+    XLS_RETURN_IF_ERROR(
+        CreateOptimizationPassPipeline()->Run(p.get(), options, &results)
+            .status());
+    return p->DumpIr();
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(std::string serial, run(nullptr));
+  ThreadPool pool(4);
+  XLS_ASSERT_OK_AND_ASSIGN(std::string concurrent, run(&pool));
+  EXPECT_EQ(serial, concurrent);
+}
+
+TEST_F(OptimizationPipelineTest, FunctionOptimizationCacheReusesLeafFunctions) {
+  constexpr std::string_view kHelper = R"(
+fn helper(x: bits[32]) -> bits[32] {
+  zero: bits[32] = literal(value=0)
+  sum: bits[32] = add(x, zero)
+  n: bits[32] = neg(sum)
+  ret nn: bits[32] = neg(n)
+}
+)";
+  constexpr std::string_view kMain = R"(
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  h: bits[32] = invoke(x, to_apply=helper)
+  ret prod: bits[32] = umul(h, y)
+}
+)";
+  ContentAddressedDirectoryCache cache(kFunctionOptimizationCacheOptions);
+  std::vector<std::unique_ptr<VerifiedPackage>> packages;
+  auto run = [&](std::string_view prefix) -> absl::StatusOr<Function*> {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<VerifiedPackage> p,
+        ParsePackage(absl::StrCat("package test\n", prefix, kHelper, kMain)));
+    OptimizationPassOptions options;
+    options.function_optimization_cache = &cache;
+    PassResults results;
+    XLS_RETURN_IF_ERROR(
+        CreateOptimizationPassPipeline()->Run(p.get(), options, &results)
+            .status());
+    XLS_ASSIGN_OR_RETURN(Function * main, p->GetFunction("main"));
+    packages.push_back(std::move(p));
+    return main;
+  };
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * first, run(""));
+  EXPECT_THAT(first->return_value(), m::UMul(m::Param("x"), m::Param("y")));
+  EXPECT_EQ(cache.hits(), 0);
+
+  // The nodes of the second copy of the helper have different ids.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * second, run(R"(
+fn unrelated(a: bits[8]) -> bits[8] {
+  ret not_a: bits[8] = not(a)
+}
+)"));
+  EXPECT_THAT(second->return_value(), m::UMul(m::Param("x"), m::Param("y")));
+  EXPECT_EQ(cache.hits(), 1);
+}
+
 }  // namespace
 }  // namespace xls
@@ -38,6 +38,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
@@ -505,6 +506,54 @@ TEST(PassesTest, TestTransformNodesToFixedPointWhileRemovingNodes) {
       IsOkAndHolds(false));
 }
 
+// Removes double negations, counting the nodes it visits.
+class DoubleNegationPass : public OptimizationFunctionBasePass {
+ public:
+  explicit DoubleNegationPass(int64_t* visits)
+      : OptimizationFunctionBasePass("double_neg", "double negation"),
+        visits_(visits) {}
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    return TransformNodesToFixedPoint(f, [&](Node* n) -> absl::StatusOr<bool> {
+      ++*visits_;
+      if (n->op() == Op::kNot && n->operand(0)->op() == Op::kNot) {
+        XLS_RETURN_IF_ERROR(n->ReplaceUsesWith(n->operand(0)->operand(0)));
+        return true;
+      }
+      return false;
+    });
+  }
+
+ private:
+  int64_t* visits_;
+};
+
+TEST(PassesTest, TestTransformNodesToFixedPointOnlyRevisitsChanges) {
+  auto m = std::make_unique<Package>("m");
+  FunctionBuilder fb("test", m.get());
+  BValue x = fb.Param("x", m->GetBitsType(32));
+  BValue sum = x;
+  for (int64_t i = 0; i < 100; ++i) {
+    sum = fb.Add(sum, x);
+  }
+  // not(not(not(not(sum)))), which takes two rewrites to simplify.
+  fb.Add(fb.Not(fb.Not(fb.Not(fb.Not(sum)))), x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  const int64_t node_count = f->node_count();
+  int64_t visits = 0;
+  PassResults results;
+  ASSERT_THAT(DoubleNegationPass(&visits).RunOnFunctionBase(
+                  f, OptimizationPassOptions(), &results),
+              IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(0), sum.node());
+  // Only the neighborhood of the rewritten nodes is visited again rather than
+  // the whole function.
+  EXPECT_LT(visits, node_count + 10);
+}
+
 TEST(RamDatastructuresTest, AddrWidthCorrect) {
   RamConfig config{.kind = RamKind::kAbstract, .depth = 2};
   EXPECT_EQ(config.addr_width(), 1);
@@ -18,15 +18,41 @@
 #include <cstdint>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "google/protobuf/duration.pb.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_metrics.pb.h"
 
 namespace xls {
+namespace {
+
+void ToDurationProto(absl::Duration duration,
+                     google::protobuf::Duration* proto) {
+  absl::Duration rem;
+  int64_t s = absl::IDivDuration(duration, absl::Seconds(1), &rem);
+  int64_t n = absl::IDivDuration(rem, absl::Nanoseconds(1), &rem);
+  proto->set_seconds(s);
+  proto->set_nanos(n);
+}
+
+void AccumulateFunctionBaseResults(
+    const absl::flat_hash_map<std::string, FunctionBaseResult>& from,
+    absl::flat_hash_map<std::string, FunctionBaseResult>& to) {
+  for (const auto& [name, from_result] : from) {
+    FunctionBaseResult& to_result = to[name];
+    to_result.run_count += from_result.run_count;
+    to_result.changed_count += from_result.changed_count;
+    to_result.duration += from_result.duration;
+    to_result.analysis_duration += from_result.analysis_duration;
+  }
+}
+
+}  // namespace
 
 void CompoundPassResult::AddSinglePassResult(std::string_view pass_name,
                                              bool changed,
@@ -39,6 +65,25 @@ void CompoundPassResult::AddSinglePassResult(std::string_view pass_name,
   result.metrics = result.metrics + metrics;
 }
 
+void CompoundPassResult::AddPassRunMetrics(const PassRunMetrics& run) {
+  SinglePassResult& result = pass_results_[run.pass_name];
+  result.analysis_duration += run.analysis_duration;
+  if (run.rss_before_bytes.has_value() && run.rss_after_bytes.has_value()) {
+    result.max_rss_delta_bytes =
+        std::max(result.max_rss_delta_bytes,
+                 *run.rss_after_bytes - *run.rss_before_bytes);
+  }
+  result.budget_exhausted_count += run.budget_exhausted ? 1 : 0;
+  for (const FunctionBaseRunMetrics& fb_run : run.function_base_runs) {
+    FunctionBaseResult& fb_result =
+        result.function_base_results[fb_run.function_base];
+    ++fb_result.run_count;
+    fb_result.changed_count += fb_run.changed ? 1 : 0;
+    fb_result.duration += fb_run.duration;
+    fb_result.analysis_duration += fb_run.analysis_duration;
+  }
+}
+
 void CompoundPassResult::AccumulateCompoundPassResult(
     const CompoundPassResult& other) {
   changed_ = changed_ || other.changed_;
@@ -48,6 +93,13 @@ void CompoundPassResult::AccumulateCompoundPassResult(
     pass_result.run_count += other_pass_result.run_count;
     pass_result.duration = pass_result.duration + other_pass_result.duration;
     pass_result.metrics = pass_result.metrics + other_pass_result.metrics;
+    pass_result.analysis_duration += other_pass_result.analysis_duration;
+    pass_result.max_rss_delta_bytes = std::max(
+        pass_result.max_rss_delta_bytes, other_pass_result.max_rss_delta_bytes);
+    pass_result.budget_exhausted_count +=
+        other_pass_result.budget_exhausted_count;
+    AccumulateFunctionBaseResults(other_pass_result.function_base_results,
+                                  pass_result.function_base_results);
   }
 }
 
@@ -79,12 +131,28 @@ PassResultProto SinglePassResult::ToProto() const {
   res.set_run_count(run_count);
   res.set_changed_count(changed_count);
   *res.mutable_metrics() = metrics.ToProto();
+  ToDurationProto(duration, res.mutable_pass_duration());
+  if (analysis_duration != absl::ZeroDuration()) {
+    ToDurationProto(analysis_duration, res.mutable_analysis_duration());
+  }
+  if (max_rss_delta_bytes != 0) {
+    res.set_max_rss_delta_bytes(max_rss_delta_bytes);
+  }
+  if (budget_exhausted_count != 0) {
+    res.set_budget_exhausted_count(budget_exhausted_count);
+  }
+  for (const auto& [name, result] : function_base_results) {
+    res.mutable_function_base_results()->insert({name, result.ToProto()});
+  }
+  return res;
+}
 
-  absl::Duration rem;
-  int64_t s = absl::IDivDuration(duration, absl::Seconds(1), &rem);
-  int64_t n = absl::IDivDuration(duration, absl::Nanoseconds(1), &rem);
-  res.mutable_pass_duration()->set_seconds(s);
-  res.mutable_pass_duration()->set_nanos(n);
+FunctionBaseResultProto FunctionBaseResult::ToProto() const {
+  FunctionBaseResultProto res;
+  res.set_run_count(run_count);
+  res.set_changed_count(changed_count);
+  ToDurationProto(duration, res.mutable_duration());
+  ToDurationProto(analysis_duration, res.mutable_analysis_duration());
   return res;
 }
 
@@ -96,4 +164,52 @@ PipelineMetricsProto CompoundPassResult::ToProto() const {
   return res;
 }
 
+PipelineMetricsProto PassResults::ToProto() const {
+  PipelineMetricsProto res = aggregate_results.ToProto();
+  if (pass_runs.empty()) {
+    return res;
+  }
+  // Runs are in start order so the first run is the earliest.
+  absl::Time origin = pass_runs.front().start;
+  absl::flat_hash_map<std::thread::id, int64_t> thread_indices;
+  thread_indices[pass_runs.front().thread] = 0;
+  auto thread_index = [&](std::thread::id id) {
+    return thread_indices.insert({id, thread_indices.size()}).first->second;
+  };
+  for (const PassRunMetrics& run : pass_runs) {
+    PassRunProto* run_proto = res.add_pass_runs();
+    run_proto->set_pass_name(run.pass_name);
+    run_proto->set_compound(run.compound);
+    ToDurationProto(run.start - origin, run_proto->mutable_start_time());
+    ToDurationProto(run.duration, run_proto->mutable_duration());
+    run_proto->set_changed(run.changed);
+    *run_proto->mutable_metrics() = run.metrics.ToProto();
+    ToDurationProto(run.analysis_duration,
+                    run_proto->mutable_analysis_duration());
+    if (run.rss_before_bytes.has_value()) {
+      run_proto->set_rss_before_bytes(*run.rss_before_bytes);
+    }
+    if (run.rss_after_bytes.has_value()) {
+      run_proto->set_rss_after_bytes(*run.rss_after_bytes);
+    }
+    if (run.peak_rss_bytes.has_value()) {
+      run_proto->set_peak_rss_bytes(*run.peak_rss_bytes);
+    }
+    if (run.budget_exhausted) {
+      run_proto->set_budget_exhausted(true);
+    }
+    for (const FunctionBaseRunMetrics& fb_run : run.function_base_runs) {
+      FunctionBaseRunProto* fb_proto = run_proto->add_function_base_runs();
+      fb_proto->set_function_base(fb_run.function_base);
+      ToDurationProto(fb_run.start - origin, fb_proto->mutable_start_time());
+      ToDurationProto(fb_run.duration, fb_proto->mutable_duration());
+      fb_proto->set_changed(fb_run.changed);
+      ToDurationProto(fb_run.analysis_duration,
+                      fb_proto->mutable_analysis_duration());
+      fb_proto->set_thread(thread_index(fb_run.thread));
+    }
+  }
+  return res;
+}
+
 }  // namespace xls
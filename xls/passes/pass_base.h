@@ -23,6 +23,7 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -40,8 +41,10 @@
 #include "xls/common/casts.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/logging/log_lines.h"
+#include "xls/common/resource_usage.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
@@ -75,6 +78,19 @@ struct PassOptionsBase {
   // If true, record metrics about runtime, number of nodes affected and other
   // information as appropriate for each pass run.
   bool record_metrics = false;
+
+  // Wall-clock budgets for the runs of passes, keyed by short name. A budget
+  // of a compound pass covers all the passes nested in it. Budgets are checked
+  // cooperatively (see PassBudgetExhausted): a pass which runs out of budget
+  // keeps the transformations made so far and control moves on to the next
+  // pass, and a compound pass which runs out of budget skips its remaining
+  // passes.
+  absl::flat_hash_map<std::string, absl::Duration> pass_time_budgets;
+
+  // The time at which the running pass runs out of budget. Set by compound
+  // passes from `pass_time_budgets` and never later than the deadline of the
+  // enclosing passes.
+  absl::Time deadline = absl::InfiniteFuture();
 };
 
 // An object containing information about the invocation of a pass (single call
@@ -90,6 +106,49 @@ struct PassInvocation {
   absl::Duration run_duration;
 };
 
+// Metrics about a single run of a pass on a single FunctionBase.
+struct FunctionBaseRunMetrics {
+  std::string function_base;
+  absl::Time start;
+  absl::Duration duration;
+  bool changed = false;
+  // Time spent constructing analyses (see ScopedAnalysisTimer) during the run.
+  absl::Duration analysis_duration;
+  std::thread::id thread;
+};
+
+// Metrics about a single run of a (possibly compound) pass. Only recorded if
+// PassOptionsBase::record_metrics is set.
+struct PassRunMetrics {
+  std::string pass_name;
+  bool compound = false;
+  absl::Time start;
+  absl::Duration duration;
+  bool changed = false;
+  TransformMetrics metrics{};
+  // Time spent constructing analyses (see ScopedAnalysisTimer) during the run.
+  absl::Duration analysis_duration;
+  std::optional<int64_t> rss_before_bytes;
+  std::optional<int64_t> rss_after_bytes;
+  std::optional<int64_t> peak_rss_bytes;
+  std::thread::id thread;
+  // The runs on individual FunctionBases performed by the pass, if it runs on
+  // each FunctionBase separately.
+  std::vector<FunctionBaseRunMetrics> function_base_runs;
+  // Whether the run was cut short because its time budget ran out.
+  bool budget_exhausted = false;
+};
+
+// Aggregate statistics about the runs of a pass on a single FunctionBase.
+struct FunctionBaseResult {
+  int64_t run_count = 0;
+  int64_t changed_count = 0;
+  absl::Duration duration;
+  absl::Duration analysis_duration;
+
+  FunctionBaseResultProto ToProto() const;
+};
+
 // Data structure holding statistics about a particular pass.
 struct SinglePassResult {
   // How many times the pass was run.
@@ -100,6 +159,14 @@ struct SinglePassResult {
   TransformMetrics metrics{};
   // Total duration of the running of the pass.
   absl::Duration duration;
+  // Total time spent constructing analyses across the runs.
+  absl::Duration analysis_duration;
+  // Largest growth of the resident set size across a single run.
+  int64_t max_rss_delta_bytes = 0;
+  // How many runs were cut short because their time budget ran out.
+  int64_t budget_exhausted_count = 0;
+  // Aggregate results for each FunctionBase. Indexed by name.
+  absl::flat_hash_map<std::string, FunctionBaseResult> function_base_results;
 
   PassResultProto ToProto() const;
 };
@@ -117,6 +184,10 @@ class CompoundPassResult {
                            absl::Duration duration,
                            const TransformMetrics& metrics);
 
+  // Add the profiling information of a run already counted by
+  // AddSinglePassResult.
+  void AddPassRunMetrics(const PassRunMetrics& run);
+
   // Accumulates the statistics in `other` into this one.
   void AccumulateCompoundPassResult(const CompoundPassResult& other);
 
@@ -138,8 +209,37 @@ struct PassResults {
 
   // The aggregate results of all actual invocations performed.
   CompoundPassResult aggregate_results;
+
+  // An entry for each run of each pass (including compound passes) in the order
+  // the runs started. Only populated if record_metrics is set.
+  std::vector<PassRunMetrics> pass_runs;
+
+  // The runs on individual FunctionBases by the currently running pass. They
+  // are moved into the pass's entry in `pass_runs` when it finishes.
+  std::vector<FunctionBaseRunMetrics> function_base_runs;
+
+  // Set when the currently running pass stops early because it ran out of time
+  // budget. Cleared when the pass finishes.
+  bool budget_exhausted = false;
+
+  // Returns the aggregate results along with the individual pass runs.
+  PipelineMetricsProto ToProto() const;
 };
 
+// Returns true if the running pass has passed the deadline set by its time
+// budget (see PassOptionsBase::pass_time_budgets) and records that in
+// `results`. Long-running passes should call this periodically and, once it
+// returns true, stop transforming and return the IR as transformed so far.
+inline bool PassBudgetExhausted(const PassOptionsBase& options,
+                                PassResults* results) {
+  if (options.deadline == absl::InfiniteFuture() ||
+      absl::Now() < options.deadline) {
+    return false;
+  }
+  results->budget_exhausted = true;
+  return true;
+}
+
 // Base class for all compiler passes. Template parameters:
 //
 //   IrT : The data type that the pass operates on (e.g., xls::Package). The
@@ -263,6 +363,14 @@ class InvariantCheckerBase {
   virtual ~InvariantCheckerBase() = default;
   virtual absl::Status Run(IrT* ir, const OptionsT& options,
                            ResultsT* results) const = 0;
+
+  // Runs once at the end of the compound pass to which the checker was added,
+  // after its last pass. Checkers which only check what changed in Run can
+  // check the whole IR here.
+  virtual absl::Status RunAtEnd(IrT* ir, const OptionsT& options,
+                                ResultsT* results) const {
+    return absl::OkStatus();
+  }
 };
 
 // CompoundPass is a container for other passes. For example, the scalar
@@ -335,8 +443,11 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
                                  "start",
                                  /*ordinal=*/0, /*changed=*/false));
     }
+    std::optional<OptionsT> budgeted_options = WithTimeBudget(*this, options);
+    const OptionsT& run_options =
+        budgeted_options.has_value() ? *budgeted_options : options;
     XLS_ASSIGN_OR_RETURN(CompoundPassResult compound_result,
-                         RunNested(ir, options, results, this->short_name(),
+                         RunNested(ir, run_options, results, this->short_name(),
                                    /*invariant_checkers=*/{}));
     return compound_result.changed();
   }
@@ -352,6 +463,20 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
       std::string_view top_level_name,
       absl::Span<const InvariantChecker* const> invariant_checkers) const;
 
+  // Returns a copy of `options` with the deadline of a run of `pass` starting
+  // now, or std::nullopt if `pass` has no time budget.
+  static std::optional<OptionsT> WithTimeBudget(const Pass& pass,
+                                                const OptionsT& options) {
+    auto it = options.pass_time_budgets.find(pass.short_name());
+    if (it == options.pass_time_budgets.end()) {
+      return std::nullopt;
+    }
+    OptionsT budgeted_options = options;
+    budgeted_options.deadline =
+        std::min(options.deadline, absl::Now() + it->second);
+    return budgeted_options;
+  }
+
   // Dump the IR to a file in the given directory. Name is determined by the
   // various arguments passed in. File names will be lexicographically ordered
   // by package name and ordinal.
@@ -362,7 +487,10 @@ class CompoundPassBase : public PassBase<IrT, OptionsT, ResultsT> {
         ir_dump_path / absl::StrFormat("%s.%s.%05d.%s.%s.ir", ir->name(),
                                        top_level_name, ordinal, tag,
                                        changed ? "changed" : "unchanged");
-    return SetFileContents(path, ir->DumpIr());
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<FileIrSink> sink,
+                         FileIrSink::Open(path));
+    ir->DumpIrTo(*sink);
+    return sink->Finish();
   }
 
   std::vector<std::unique_ptr<Pass>> passes_;
@@ -454,7 +582,16 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
 
   CompoundPassResult aggregate_result;
   bool changed = false;
+  // Whether this compound pass (or an enclosing one) ran out of budget.
+  bool out_of_budget = false;
+  bool nested_budget_exhausted = false;
   for (const auto& pass : passes_) {
+    if (absl::Now() >= options.deadline) {
+      VLOG(1) << "Skipping the remaining passes of " << this->short_name()
+              << " due to running out of time budget.";
+      out_of_budget = true;
+      break;
+    }
     VLOG(1) << absl::StreamFormat("Running %s (%s, #%d) pass on package %s",
                                   pass->long_name(), pass->short_name(),
                                   results->invocations.size(), ir->name());
@@ -484,20 +621,47 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     // do not check it in optimized builds.
     std::string ir_before = ir->DumpIr();
 #endif
+    // Reserve the entry of this run before running the pass so runs of nested
+    // passes are listed after it.
+    std::optional<int64_t> run_index;
+    absl::Duration analysis_before;
+    if (options.record_metrics) {
+      run_index = results->pass_runs.size();
+      results->pass_runs.push_back(PassRunMetrics{
+          .pass_name = pass->short_name(),
+          .compound = pass->IsCompound(),
+          .rss_before_bytes = GetCurrentRssBytes(),
+          .thread = std::this_thread::get_id()});
+      results->function_base_runs.clear();
+      analysis_before = ScopedAnalysisTimer::ElapsedOnThisThread();
+    }
+    std::optional<OptionsT> budgeted_options = WithTimeBudget(*pass, options);
+    const OptionsT& pass_options =
+        budgeted_options.has_value() ? *budgeted_options : options;
     absl::Time start = absl::Now();
     bool pass_changed;
     if (pass->IsCompound()) {
       XLS_ASSIGN_OR_RETURN(
           CompoundPassResult compound_result,
           (down_cast<CompoundPassBase<IrT, OptionsT, ResultsT>*>(pass.get())
-               ->RunNested(ir, options, results, top_level_name, checkers)),
+               ->RunNested(ir, pass_options, results, top_level_name,
+                           checkers)),
           _ << "Running pass #" << results->invocations.size() << ": "
             << pass->long_name() << " [short: " << pass->short_name() << "]");
       pass_changed = compound_result.changed();
     } else {
-      XLS_ASSIGN_OR_RETURN(pass_changed, pass->Run(ir, options, results));
+      XLS_ASSIGN_OR_RETURN(pass_changed, pass->Run(ir, pass_options, results));
     }
     absl::Duration duration = absl::Now() - start;
+    bool budget_exhausted = results->budget_exhausted;
+    results->budget_exhausted = false;
+    if (budget_exhausted) {
+      LOG(WARNING) << absl::StreamFormat(
+          "Pass %s ran out of time budget after %s; continuing with the IR as "
+          "transformed so far.",
+          pass->short_name(), FormatDuration(duration));
+      nested_budget_exhausted = true;
+    }
 #ifdef DEBUG
     std::string ir_after = ir->DumpIr();
     if (pass_changed) {
@@ -537,6 +701,31 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
 
     aggregate_result.AddSinglePassResult(pass->short_name(), pass_changed,
                                          duration, pass_metrics);
+    if (run_index.has_value()) {
+      PassRunMetrics& run = results->pass_runs[*run_index];
+      run.start = start;
+      run.duration = duration;
+      run.changed = pass_changed;
+      run.metrics = pass_metrics;
+      run.analysis_duration =
+          ScopedAnalysisTimer::ElapsedOnThisThread() - analysis_before;
+      run.rss_after_bytes = GetCurrentRssBytes();
+      run.peak_rss_bytes = GetPeakRssBytes();
+      run.function_base_runs = std::move(results->function_base_runs);
+      run.budget_exhausted = budget_exhausted;
+      results->function_base_runs.clear();
+      // Analyses built on other threads are only visible through the
+      // FunctionBase runs of this pass and of the passes nested in it.
+      for (int64_t i = *run_index; i < results->pass_runs.size(); ++i) {
+        for (const FunctionBaseRunMetrics& fb_run :
+             results->pass_runs[i].function_base_runs) {
+          if (fb_run.thread != run.thread) {
+            run.analysis_duration += fb_run.analysis_duration;
+          }
+        }
+      }
+      aggregate_result.AddPassRunMetrics(run);
+    }
 
     // Only run the verifiers if the pass changed.
     if (pass_changed) {
@@ -552,6 +741,20 @@ CompoundPassBase<IrT, OptionsT, ResultsT>::RunNested(
     XLS_VLOG_LINES(5, ir->DumpIr());
   }
 
+  for (const InvariantChecker* checker : invariant_checker_ptrs_) {
+    absl::Status status = checker->RunAtEnd(ir, options, results);
+    if (!status.ok()) {
+      return absl::Status(
+          status.code(),
+          absl::StrCat(status.message(), "; [end of compound pass '",
+                       this->long_name(), "']"));
+    }
+  }
+
+  if (out_of_budget ||
+      (nested_budget_exhausted && absl::Now() >= options.deadline)) {
+    results->budget_exhausted = true;
+  }
   aggregate_result.set_changed(changed);
   if (options.record_metrics) {
     // Update the full pass-result.
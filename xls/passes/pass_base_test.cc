@@ -14,6 +14,7 @@
 
 #include "xls/passes/pass_base.h"
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <utility>
@@ -23,6 +24,8 @@
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -39,12 +42,14 @@
 #include "xls/ir/value.h"
 #include "xls/passes/dce_pass.h"
 #include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_metrics.pb.h"
 
 namespace m = ::xls::op_matchers;
 namespace xls {
 namespace {
 
 using ::absl_testing::IsOk;
+using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::Eq;
 using ::testing::Field;
@@ -120,6 +125,32 @@ class LevelUpPass : public OptimizationFunctionBasePass {
   }
 };
 
+// Bumps the first literal and then stalls until the pass runs out of budget.
+class StallPass : public OptimizationFunctionBasePass {
+ public:
+  StallPass() : OptimizationFunctionBasePass("stall", "Stall Pass") {}
+  ~StallPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override {
+    for (Node* n : TopoSort(f)) {
+      if (n->Is<Literal>()) {
+        XLS_RETURN_IF_ERROR(
+            n->ReplaceUsesWithNew<Literal>(
+                 Value(bits_ops::Increment(n->As<Literal>()->value().bits())))
+                .status());
+        break;
+      }
+    }
+    while (!PassBudgetExhausted(options, results)) {
+      absl::SleepFor(absl::Milliseconds(1));
+    }
+    return true;
+  }
+};
+
 auto DceInvoke() { return Field(&PassInvocation::pass_name, Eq("dce")); }
 auto LevelUpInvoke() {
   return Field(&PassInvocation::pass_name, Eq("level_up"));
@@ -289,5 +320,121 @@ TEST_F(PassBaseTest, BisectLimitZero) {
   EXPECT_THAT(results.invocations, IsEmpty());
 }
 
+TEST_F(PassBaseTest, RecordsPassRunsWhenRecordingMetrics) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 64));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<LevelUpPass>();
+  auto* inner = opt.Add<OptimizationCompoundPass>("inner", "inner");
+  inner->Add<LevelUpPass>();
+  inner->Add<DeadCodeEliminationPass>();
+  PassResults results;
+  ASSERT_THAT(
+      opt.Run(p.get(),
+              OptimizationPassOptions(PassOptionsBase{.record_metrics = true}),
+              &results),
+      IsOk());
+
+  // Runs are listed in start order, so the compound pass precedes its passes.
+  EXPECT_THAT(results.pass_runs,
+              ElementsAre(Field(&PassRunMetrics::pass_name, Eq("level_up")),
+                          Field(&PassRunMetrics::pass_name, Eq("inner")),
+                          Field(&PassRunMetrics::pass_name, Eq("level_up")),
+                          Field(&PassRunMetrics::pass_name, Eq("dce"))));
+  const PassRunMetrics& inner_run = results.pass_runs[1];
+  EXPECT_TRUE(inner_run.compound);
+  for (int64_t i = 2; i < results.pass_runs.size(); ++i) {
+    EXPECT_GE(results.pass_runs[i].start, inner_run.start);
+    EXPECT_LE(results.pass_runs[i].start + results.pass_runs[i].duration,
+              inner_run.start + inner_run.duration);
+  }
+  EXPECT_THAT(results.pass_runs[0].function_base_runs,
+              ElementsAre(AllOf(
+                  Field(&FunctionBaseRunMetrics::function_base, TestName()),
+                  Field(&FunctionBaseRunMetrics::changed, true))));
+  EXPECT_THAT(results.function_base_runs, IsEmpty());
+
+  PipelineMetricsProto proto = results.ToProto();
+  EXPECT_EQ(proto.pass_runs_size(), 4);
+  EXPECT_EQ(proto.pass_runs(0).start_time().seconds(), 0);
+  EXPECT_EQ(proto.pass_runs(0).start_time().nanos(), 0);
+  EXPECT_EQ(proto.pass_runs(0).function_base_runs(0).thread(), 0);
+  const PassResultProto& level_up = proto.pass_results().at("level_up");
+  EXPECT_EQ(level_up.run_count(), 2);
+  EXPECT_EQ(level_up.function_base_results().at(TestName()).run_count(), 2);
+  EXPECT_EQ(level_up.function_base_results().at(TestName()).changed_count(),
+            2);
+}
+
+TEST_F(PassBaseTest, PassOutOfBudgetKeepsChangesAndContinues) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 64));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<StallPass>();
+  opt.Add<LevelUpPass>();
+  opt.Add<DeadCodeEliminationPass>();
+  OptimizationPassOptions options(PassOptionsBase{.record_metrics = true});
+  options.pass_time_budgets["stall"] = absl::Milliseconds(10);
+  PassResults results;
+  ASSERT_THAT(opt.Run(p.get(), options, &results), IsOk());
+
+  EXPECT_THAT(f->return_value(), m::Literal(UBits(2, 64)));
+  EXPECT_THAT(results.invocations,
+              ElementsAre(Field(&PassInvocation::pass_name, Eq("stall")),
+                          LevelUpInvoke(), DceInvoke()));
+  EXPECT_THAT(
+      results.pass_runs,
+      ElementsAre(Field(&PassRunMetrics::budget_exhausted, true),
+                  Field(&PassRunMetrics::budget_exhausted, false),
+                  Field(&PassRunMetrics::budget_exhausted, false)));
+  EXPECT_FALSE(results.budget_exhausted);
+  PipelineMetricsProto proto = results.ToProto();
+  EXPECT_TRUE(proto.pass_runs(0).budget_exhausted());
+  EXPECT_EQ(proto.pass_results().at("stall").budget_exhausted_count(), 1);
+  EXPECT_FALSE(
+      proto.pass_results().at("level_up").has_budget_exhausted_count());
+}
+
+TEST_F(PassBaseTest, CompoundPassOutOfBudgetSkipsRemainingPasses) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 64));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  OptimizationCompoundPass opt("opt", "opt");
+  auto* inner = opt.Add<OptimizationCompoundPass>("inner", "inner");
+  inner->Add<LevelUpPass>();
+  inner->Add<LevelUpPass>();
+  opt.Add<LevelUpPass>();
+  opt.Add<DeadCodeEliminationPass>();
+  OptimizationPassOptions options(PassOptionsBase{.record_metrics = true});
+  options.pass_time_budgets["inner"] = absl::ZeroDuration();
+  PassResults results;
+  ASSERT_THAT(opt.Run(p.get(), options, &results), IsOk());
+
+  EXPECT_THAT(f->return_value(), m::Literal(UBits(1, 64)));
+  EXPECT_THAT(results.invocations, ElementsAre(LevelUpInvoke(), DceInvoke()));
+  ASSERT_EQ(results.pass_runs.size(), 3);
+  EXPECT_EQ(results.pass_runs[0].pass_name, "inner");
+  EXPECT_TRUE(results.pass_runs[0].budget_exhausted);
+  EXPECT_FALSE(results.pass_runs[1].budget_exhausted);
+}
+
+TEST_F(PassBaseTest, DoesNotRecordPassRunsByDefault) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Literal(UBits(0, 64));
+  XLS_ASSERT_OK(fb.Build().status());
+  OptimizationCompoundPass opt("opt", "opt");
+  opt.Add<LevelUpPass>();
+  PassResults results;
+  ASSERT_THAT(opt.Run(p.get(), OptimizationPassOptions(), &results), IsOk());
+  EXPECT_THAT(results.pass_runs, IsEmpty());
+  EXPECT_THAT(results.function_base_runs, IsEmpty());
+}
+
 }  // namespace
 }  // namespace xls
@@ -0,0 +1,115 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/peephole_rewrite_pass.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/value.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/rewrite_rules.h"
+
+namespace xls {
+namespace {
+
+using P = RewritePattern;
+
+bool IsBits(Node* node) { return node->GetType()->IsBits(); }
+
+// Returns a rewrite which replaces the match with the node bound to
+// `capture`.
+RewriteFn ReplaceWith(std::string_view capture) {
+  return [capture = std::string(capture)](const RewriteMatch& match)
+             -> absl::StatusOr<std::optional<Node*>> {
+    return match[capture];
+  };
+}
+
+// Returns a rewrite which replaces the (bits-typed) match with a literal of
+// value `value` zero- or one-extended to the width of the match.
+RewriteFn ReplaceWithLiteral(int64_t value) {
+  return [value](const RewriteMatch& match)
+             -> absl::StatusOr<std::optional<Node*>> {
+    Node* root = match.root();
+    int64_t width = root->BitCountOrDie();
+    XLS_ASSIGN_OR_RETURN(
+        Node * literal,
+        root->function_base()->MakeNode<Literal>(
+            root->loc(),
+            Value(value == 0 ? Bits(width) : Bits::AllOnes(width))));
+    return literal;
+  };
+}
+
+}  // namespace
+
+absl::StatusOr<RewriteRuleSet> DefaultPeepholeRules() {
+  RewriteRuleSet rules;
+  XLS_RETURN_IF_ERROR(rules.AddRule(
+      "double_not", P::Of(Op::kNot, {P::Of(Op::kNot, {P::Any("x")})}),
+      ReplaceWith("x")));
+  XLS_RETURN_IF_ERROR(rules.AddRule(
+      "double_neg", P::Of(Op::kNeg, {P::Of(Op::kNeg, {P::Any("x")})}),
+      ReplaceWith("x")));
+  XLS_RETURN_IF_ERROR(
+      rules.AddRule("and_self", P::Of(Op::kAnd, {P::Any("x"), P::Any("x")}),
+                    ReplaceWith("x")));
+  XLS_RETURN_IF_ERROR(
+      rules.AddRule("or_self", P::Of(Op::kOr, {P::Any("x"), P::Any("x")}),
+                    ReplaceWith("x")));
+  XLS_RETURN_IF_ERROR(rules.AddRule(
+      "xor_self", P::Of(Op::kXor, {P::Any("x"), P::Any("x")}).Where(IsBits),
+      ReplaceWithLiteral(0)));
+  XLS_RETURN_IF_ERROR(rules.AddRule(
+      "sub_self", P::Of(Op::kSub, {P::Any("x"), P::Any("x")}),
+      ReplaceWithLiteral(0)));
+  XLS_RETURN_IF_ERROR(
+      rules.AddRule("eq_self", P::Of(Op::kEq, {P::Any("x"), P::Any("x")}),
+                    ReplaceWithLiteral(1)));
+  XLS_RETURN_IF_ERROR(
+      rules.AddRule("ne_self", P::Of(Op::kNe, {P::Any("x"), P::Any("x")}),
+                    ReplaceWithLiteral(0)));
+  return rules;
+}
+
+PeepholeRewritePass::PeepholeRewritePass()
+    : OptimizationFunctionBasePass(kName, "Peephole rewrites") {
+  absl::StatusOr<RewriteRuleSet> rules = DefaultPeepholeRules();
+  CHECK_OK(rules.status());
+  rules_ = *std::move(rules);
+}
+
+absl::StatusOr<bool> PeepholeRewritePass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  return rules_.Apply(f);
+}
+
+REGISTER_OPT_PASS(PeepholeRewritePass);
+
+}  // namespace xls
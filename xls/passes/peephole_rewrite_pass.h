@@ -0,0 +1,54 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PEEPHOLE_REWRITE_PASS_H_
+#define XLS_PASSES_PEEPHOLE_REWRITE_PASS_H_
+
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/rewrite_rules.h"
+
+namespace xls {
+
+// Returns the peephole rules applied by PeepholeRewritePass. New local
+// simplifications which only need to look at a node and its nearby operands
+// should be added here rather than as new passes, so that they are all matched
+// together in a single sweep.
+absl::StatusOr<RewriteRuleSet> DefaultPeepholeRules();
+
+// Applies the rules of DefaultPeepholeRules() in one sweep over the function.
+class PeepholeRewritePass : public OptimizationFunctionBasePass {
+ public:
+  static constexpr std::string_view kName = "peephole_rewrite";
+  PeepholeRewritePass();
+  ~PeepholeRewritePass() override = default;
+
+  const RewriteRuleSet& rules() const { return rules_; }
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override;
+
+ private:
+  RewriteRuleSet rules_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PEEPHOLE_REWRITE_PASS_H_
@@ -0,0 +1,103 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/peephole_rewrite_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/rewrite_rules.h"
+#include "xls/solvers/z3_ir_equivalence_testutils.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::xls::solvers::z3::ScopedVerifyEquivalence;
+
+class PeepholeRewritePassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Package* p) {
+    PassResults results;
+    return PeepholeRewritePass().Run(p, OptimizationPassOptions(), &results);
+  }
+};
+
+TEST_F(PeepholeRewritePassTest, SelfOperations) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn f(x: bits[8]) -> (bits[8], bits[8], bits[8], bits[8], bits[1]) {
+       xor.1: bits[8] = xor(x, x)
+       sub.2: bits[8] = sub(x, x)
+       and.3: bits[8] = and(x, x)
+       or.4: bits[8] = or(x, x)
+       eq.5: bits[1] = eq(x, x)
+       ret tuple.6: (bits[8], bits[8], bits[8], bits[8], bits[1]) = tuple(xor.1, sub.2, and.3, or.4, eq.5)
+     }
+  )",
+                                                       p.get()));
+  ScopedVerifyEquivalence stays_equivalent(f);
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(),
+              m::Tuple(m::Literal(UBits(0, 8)), m::Literal(UBits(0, 8)),
+                       m::Param("x"), m::Param("x"), m::Literal(UBits(1, 1))));
+}
+
+TEST_F(PeepholeRewritePassTest, DoubleInversions) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+     fn f(x: bits[8], y: bits[8]) -> bits[8] {
+       not.1: bits[8] = not(x)
+       not.2: bits[8] = not(not.1)
+       neg.3: bits[8] = neg(y)
+       neg.4: bits[8] = neg(neg.3)
+       ret add.5: bits[8] = add(not.2, neg.4)
+     }
+  )",
+                                                       p.get()));
+  ScopedVerifyEquivalence stays_equivalent(f);
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Add(m::Param("x"), m::Param("y")));
+}
+
+TEST_F(PeepholeRewritePassTest, DistinctOperandsUnchanged) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK(ParseFunction(R"(
+     fn f(x: bits[8], y: bits[8]) -> bits[8] {
+       xor.1: bits[8] = xor(x, y)
+       ret sub.2: bits[8] = sub(xor.1, x)
+     }
+  )",
+                              p.get())
+                    .status());
+  EXPECT_THAT(Run(p.get()), IsOkAndHolds(false));
+}
+
+TEST_F(PeepholeRewritePassTest, DefaultRulesAreValid) {
+  XLS_ASSERT_OK_AND_ASSIGN(RewriteRuleSet rules, DefaultPeepholeRules());
+  EXPECT_EQ(rules.rule_count(), PeepholeRewritePass().rules().rule_count());
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,69 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_PRESERVED_ANALYSES_H_
+#define XLS_PASSES_PRESERVED_ANALYSES_H_
+
+#include <cstdint>
+
+namespace xls {
+
+// The analyses cached by the QueryEngineCache whose invalidation a pass may
+// opt out of. The ternary query engine is not listed: it is updated
+// incrementally, so keeping it valid is cheap anyway.
+enum class AnalysisKind : uint8_t {
+  kRange,
+  kBdd,
+  kPostDominator,
+  kBitProvenance,
+};
+inline constexpr int64_t kAnalysisKindCount = 4;
+
+// The set of analyses which remain valid across the changes made by a pass
+// (in the style of LLVM's PreservedAnalyses). An analysis is preserved if its
+// results for every node remaining after the pass are unchanged. Additions of
+// nodes always invalidate every analysis, so only passes which replace and
+// remove nodes benefit from declaring anything.
+class PreservedAnalyses {
+ public:
+  static constexpr PreservedAnalyses None() { return PreservedAnalyses(0); }
+  static constexpr PreservedAnalyses All() {
+    return PreservedAnalyses((uint32_t{1} << kAnalysisKindCount) - 1);
+  }
+
+  constexpr PreservedAnalyses& Preserve(AnalysisKind kind) {
+    mask_ |= Bit(kind);
+    return *this;
+  }
+  constexpr bool IsPreserved(AnalysisKind kind) const {
+    return (mask_ & Bit(kind)) != 0;
+  }
+
+  friend constexpr bool operator==(PreservedAnalyses a, PreservedAnalyses b) {
+    return a.mask_ == b.mask_;
+  }
+
+ private:
+  explicit constexpr PreservedAnalyses(uint32_t mask) : mask_(mask) {}
+
+  static constexpr uint32_t Bit(AnalysisKind kind) {
+    return uint32_t{1} << static_cast<uint32_t>(kind);
+  }
+
+  uint32_t mask_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_PRESERVED_ANALYSES_H_
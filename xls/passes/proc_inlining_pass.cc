@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/container/btree_map.h"
 #include "absl/container/btree_set.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -41,6 +42,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/data_structures/leaf_type_tree.h"
+#include "xls/data_structures/strongly_connected_components.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
@@ -1199,7 +1201,7 @@ class ProcThread {
                                   send->GetName(), ch->name());
 
     Node* result;
-    if (ch->supported_ops() == ChannelOps::kSendReceive) {
+    if (virtual_channels.contains(ch)) {
       // Non-external send. Convert send into a virtual send.
       XLS_ASSIGN_OR_RETURN(result, CreateVirtualSend(send, activation_node,
                                                      virtual_channels.at(ch)));
@@ -1226,7 +1228,7 @@ class ProcThread {
                                   receive->GetName(), ch->name());
 
     Node* result;
-    if (ch->supported_ops() == ChannelOps::kSendReceive) {
+    if (virtual_channels.contains(ch)) {
       // Non-external receive. Convert receive into a virtual receive.
       XLS_ASSIGN_OR_RETURN(result,
                            CreateVirtualReceive(receive, activation_node,
@@ -1880,34 +1882,113 @@ absl::Status ConvertToNextValueNodes(Proc* proc) {
   return absl::OkStatus();
 }
 
-}  // namespace
+// The procs which send and receive on a channel.
+struct ChannelEndpoints {
+  absl::btree_set<int64_t> senders;
+  absl::btree_set<int64_t> receivers;
+  absl::flat_hash_set<Proc*> procs;
 
-absl::StatusOr<bool> ProcInliningPass::RunInternal(
-    Package* p, const OptimizationPassOptions& options,
-    PassResults* results) const {
-  if (!options.inline_procs || p->procs().size() <= 1) {
-    return false;
+  bool AllIn(const absl::flat_hash_set<Proc*>& set) const {
+    return absl::c_all_of(procs,
+                          [&](Proc* proc) { return set.contains(proc); });
   }
+};
 
-  if (!p->HasTop()) {
-    return absl::InvalidArgumentError(
-        "Must specify top-level proc name when running proc inlining");
+// Returns the endpoints of every channel used in `p`. Senders and receivers are
+// identified by their index in `p->procs()`.
+absl::StatusOr<absl::flat_hash_map<Channel*, ChannelEndpoints>>
+GetChannelEndpoints(Package* p) {
+  absl::flat_hash_map<Channel*, ChannelEndpoints> endpoints;
+  for (int64_t i = 0; i < p->procs().size(); ++i) {
+    Proc* proc = p->procs()[i].get();
+    for (Node* node : proc->nodes()) {
+      if (!node->Is<ChannelNode>()) {
+        continue;
+      }
+      XLS_ASSIGN_OR_RETURN(Channel * ch, GetChannelUsedByNode(node));
+      ChannelEndpoints& channel_endpoints = endpoints[ch];
+      if (node->Is<Send>()) {
+        channel_endpoints.senders.insert(i);
+      } else {
+        channel_endpoints.receivers.insert(i);
+      }
+      channel_endpoints.procs.insert(proc);
+    }
   }
+  return endpoints;
+}
 
-  FunctionBase* top_func_base = p->GetTop().value();
+// Groups the procs of `p` into clusters to inline together: the strongly
+// connected components (of size two or more) of the graph of internal channels
+// between procs. Components larger than `max_cluster_size` are split into
+// pieces of at most that many procs, taking procs in breadth-first order so
+// each piece is tightly connected. Clusters, and the procs within each
+// cluster, are in package order.
+std::vector<std::vector<Proc*>> GetProcClusters(
+    Package* p,
+    const absl::flat_hash_map<Channel*, ChannelEndpoints>& endpoints,
+    int64_t max_cluster_size) {
+  absl::btree_map<int64_t, absl::btree_set<int64_t>> graph;
+  absl::btree_map<int64_t, absl::btree_set<int64_t>> neighbors;
+  for (const auto& [ch, channel_endpoints] : endpoints) {
+    if (ch->supported_ops() != ChannelOps::kSendReceive) {
+      continue;
+    }
+    for (int64_t sender : channel_endpoints.senders) {
+      for (int64_t receiver : channel_endpoints.receivers) {
+        graph[sender].insert(receiver);
+        neighbors[sender].insert(receiver);
+        neighbors[receiver].insert(sender);
+      }
+    }
+  }
 
-  if (!top_func_base->IsProc()) {
-    return absl::InvalidArgumentError(absl::StrFormat(
-        "Top level %s should be a proc when running proc inlining",
-        top_func_base->name()));
+  std::vector<std::vector<int64_t>> pieces;
+  for (const absl::btree_set<int64_t>& component :
+       StronglyConnectedComponents(graph)) {
+    if (component.size() < 2) {
+      continue;
+    }
+    absl::btree_set<int64_t> unvisited = component;
+    while (!unvisited.empty()) {
+      // Breadth-first from the first unvisited proc, within the component.
+      std::vector<int64_t> piece = {*unvisited.begin()};
+      unvisited.erase(unvisited.begin());
+      for (int64_t next = 0;
+           next < piece.size() && piece.size() < max_cluster_size; ++next) {
+        for (int64_t neighbor : neighbors[piece[next]]) {
+          if (piece.size() < max_cluster_size && unvisited.erase(neighbor)) {
+            piece.push_back(neighbor);
+          }
+        }
+      }
+      if (piece.size() >= 2) {
+        absl::c_sort(piece);
+        pieces.push_back(std::move(piece));
+      }
+    }
   }
+  absl::c_sort(pieces);
 
-  std::vector<Proc*> procs_to_inline;
-  procs_to_inline.reserve(p->procs().size());
-  for (const std::unique_ptr<Proc>& proc : p->procs()) {
-    procs_to_inline.push_back(proc.get());
+  std::vector<std::vector<Proc*>> clusters;
+  clusters.reserve(pieces.size());
+  for (const std::vector<int64_t>& piece : pieces) {
+    std::vector<Proc*>& cluster = clusters.emplace_back();
+    for (int64_t index : piece) {
+      cluster.push_back(p->procs()[index].get());
+    }
   }
+  return clusters;
+}
 
+// Inlines `procs_to_inline` into a single new proc named `name` which replaces
+// them. Channels between the inlined procs are removed; other channels are
+// kept. `ii_source` is the proc whose initiation interval all inlined procs
+// must share. If `make_top` is set the new proc becomes the top of `p`.
+absl::Status InlineProcs(
+    Package* p, absl::Span<Proc* const> procs_to_inline, Proc* ii_source,
+    std::string name, bool make_top,
+    const absl::flat_hash_map<Channel*, ChannelEndpoints>& channel_endpoints) {
   for (Proc* proc : procs_to_inline) {
     XLS_RETURN_IF_ERROR(ConvertToNextStateElements(proc));
   }
@@ -1916,8 +1997,8 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
 
   {
     int64_t top_ii = 1;
-    if (top_func_base->GetInitiationInterval().has_value()) {
-      top_ii = top_func_base->GetInitiationInterval().value();
+    if (ii_source->GetInitiationInterval().has_value()) {
+      top_ii = ii_source->GetInitiationInterval().value();
     }
     for (Proc* proc : procs_to_inline) {
       int64_t inner_ii = 1;
@@ -1926,7 +2007,7 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
       }
       XLS_RET_CHECK_EQ(inner_ii, top_ii)
           << "Proc " << proc->name() << " had a different initiation interval "
-          << "when compared to the top proc (" << top_func_base->name() << ")";
+          << "when compared to the top proc (" << ii_source->name() << ")";
       if (!proc->next_values().empty()) {
         return absl::UnimplementedError(absl::StrFormat(
             "Proc %s uses next_value nodes, which are not currently "
@@ -1945,9 +2026,16 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   // the top-level proc state.
   std::vector<AbstractStateElement> state_elements;
 
+  // Channels between two procs which are both inlined become virtual channels;
+  // the others are kept.
+  absl::flat_hash_set<Proc*> inlined(procs_to_inline.begin(),
+                                     procs_to_inline.end());
   absl::flat_hash_map<Channel*, VirtualChannel> virtual_channels;
   for (Channel* ch : p->channels()) {
-    if (ch->supported_ops() == ChannelOps::kSendReceive) {
+    auto endpoints = channel_endpoints.find(ch);
+    if (ch->supported_ops() == ChannelOps::kSendReceive &&
+        (endpoints == channel_endpoints.end() ||
+         endpoints->second.AllIn(inlined))) {
       XLS_ASSIGN_OR_RETURN(virtual_channels[ch],
                            VirtualChannel::Create(ch, container_proc));
       if (virtual_channels[ch].ChannelDataState().has_value()) {
@@ -2021,12 +2109,13 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   VLOG(3) << "After transforming proc state:\n" << p->DumpIr();
 
   // Delete inlined procs.
-  XLS_RETURN_IF_ERROR(p->SetTop(container_proc));
-  std::string top_proc_name = top_func_base->AsProcOrDie()->name();
+  if (make_top) {
+    XLS_RETURN_IF_ERROR(p->SetTop(container_proc));
+  }
   for (Proc* proc : procs_to_inline) {
     XLS_RETURN_IF_ERROR(p->RemoveProc(proc));
   }
-  container_proc->SetName(top_proc_name);
+  container_proc->SetName(name);
 
   VLOG(3) << "After deleting inlined procs:\n" << p->DumpIr();
 
@@ -2038,7 +2127,7 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
       continue;
     }
     XLS_ASSIGN_OR_RETURN(Channel * ch, GetChannelUsedByNode(node));
-    if (ch->supported_ops() == ChannelOps::kSendReceive) {
+    if (virtual_channels.contains(ch)) {
       to_remove.push_back(node);
     }
   }
@@ -2049,18 +2138,79 @@ absl::StatusOr<bool> ProcInliningPass::RunInternal(
   // Delete channels used for communicating with the inlined procs.
   std::vector<Channel*> channels(p->channels().begin(), p->channels().end());
   for (Channel* ch : channels) {
-    if (ch->supported_ops() == ChannelOps::kSendReceive) {
+    if (virtual_channels.contains(ch)) {
       XLS_RETURN_IF_ERROR(p->RemoveChannel(ch));
     }
   }
 
   VLOG(3) << "After deleting inlined I/O:\n" << p->DumpIr();
 
-  XLS_RETURN_IF_ERROR(ConvertToNextValueNodes(container_proc));
+  return ConvertToNextValueNodes(container_proc);
+}
+
+}  // namespace
+
+absl::StatusOr<bool> ProcInliningPass::RunInternal(
+    Package* p, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  if (!options.inline_procs || p->procs().size() <= 1) {
+    return false;
+  }
+
+  if (!p->HasTop()) {
+    return absl::InvalidArgumentError(
+        "Must specify top-level proc name when running proc inlining");
+  }
+
+  FunctionBase* top_func_base = p->GetTop().value();
 
-  VLOG(3) << "After switching back to next-value nodes:\n" << p->DumpIr();
+  if (!top_func_base->IsProc()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Top level %s should be a proc when running proc inlining",
+        top_func_base->name()));
+  }
+  Proc* top = top_func_base->AsProcOrDie();
 
-  return true;
+  // Inlining a cluster only removes the channels internal to it, so the
+  // endpoints computed up front still tell which of the remaining channels
+  // are internal to a later cluster.
+  XLS_ASSIGN_OR_RETURN(
+      (absl::flat_hash_map<Channel*, ChannelEndpoints> channel_endpoints),
+      GetChannelEndpoints(p));
+
+  if (!options.max_proc_inlining_cluster_size.has_value()) {
+    std::vector<Proc*> procs_to_inline;
+    procs_to_inline.reserve(p->procs().size());
+    for (const std::unique_ptr<Proc>& proc : p->procs()) {
+      procs_to_inline.push_back(proc.get());
+    }
+    XLS_RETURN_IF_ERROR(InlineProcs(p, procs_to_inline, top, top->name(),
+                                    /*make_top=*/true, channel_endpoints));
+    return true;
+  }
+
+  XLS_RET_CHECK_GE(*options.max_proc_inlining_cluster_size, 2)
+      << "Proc inlining clusters must allow at least two procs";
+  std::vector<std::vector<Proc*>> clusters = GetProcClusters(
+      p, channel_endpoints, *options.max_proc_inlining_cluster_size);
+  VLOG(2) << absl::StreamFormat("Inlining %d clusters of procs",
+                                clusters.size());
+  // Clusters communicate over channels which are kept, so inlining can stop
+  // after any cluster when out of budget.
+  bool changed = false;
+  for (const std::vector<Proc*>& cluster : clusters) {
+    if (PassBudgetExhausted(options, results)) {
+      break;
+    }
+    bool contains_top = absl::c_linear_search(cluster, top);
+    Proc* ii_source = contains_top ? top : cluster.front();
+    std::string name = ii_source->name();
+    XLS_RETURN_IF_ERROR(InlineProcs(p, cluster, ii_source, std::move(name),
+                                    /*make_top=*/contains_top,
+                                    channel_endpoints));
+    changed = true;
+  }
+  return changed;
 }
 
 REGISTER_OPT_PASS(ProcInliningPass);
@@ -85,14 +85,16 @@ class ProcInliningPassTest : public IrTestBase {
  protected:
   ProcInliningPassTest() = default;
 
-  absl::StatusOr<bool> Run(Package* p,
-                           std::optional<std::string> top = std::nullopt) {
+  absl::StatusOr<bool> Run(
+      Package* p, std::optional<std::string> top = std::nullopt,
+      std::optional<int64_t> max_cluster_size = std::nullopt) {
     if (top.has_value()) {
       XLS_RETURN_IF_ERROR(p->SetTopByName(top.value()));
     }
 
     OptimizationPassOptions options;
     options.inline_procs = true;
+    options.max_proc_inlining_cluster_size = max_cluster_size;
     PassResults results;
     XLS_ASSIGN_OR_RETURN(bool changed,
                          ProcInliningPass().Run(p, options, &results));
@@ -523,6 +525,55 @@ TEST_F(ProcInliningPassTest, NestedProcs) {
                     .status());
 }
 
+TEST_F(ProcInliningPassTest, ClusteredInliningKeepsBoundaryChannels) {
+  // A and B communicate in a cycle and form a cluster. C only receives from A
+  // so it is left as a separate proc connected by a streaming channel.
+  auto p = CreatePackage();
+  Type* u32 = p->GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_in,
+      p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * ch_out,
+      p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * a_to_b,
+      p->CreateStreamingChannel("a_to_b", ChannelOps::kSendReceive, u32,
+                                /*initial_values=*/{},
+                                /*fifo_config=*/FifoConfigWithDepth(0)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * b_to_a,
+      p->CreateStreamingChannel("b_to_a", ChannelOps::kSendReceive, u32,
+                                /*initial_values=*/{},
+                                /*fifo_config=*/FifoConfigWithDepth(0)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * a_to_c,
+      p->CreateStreamingChannel("a_to_c", ChannelOps::kSendReceive, u32,
+                                /*initial_values=*/{},
+                                /*fifo_config=*/FifoConfigWithDepth(1)));
+
+  XLS_ASSERT_OK(MakePassThroughProc("A", ch_in, a_to_b, b_to_a, a_to_c, p.get())
+                    .status());
+  XLS_ASSERT_OK(MakeDoublerProc("B", a_to_b, b_to_a, p.get()).status());
+  XLS_ASSERT_OK(MakeLoopbackProc("C", a_to_c, ch_out, p.get()).status());
+
+  EXPECT_EQ(p->procs().size(), 3);
+  XLS_EXPECT_OK(
+      EvalAndExpect(p.get(), {{"in", {1, 2, 3}}}, {{"out", {2, 4, 6}}})
+          .status());
+
+  ASSERT_THAT(Run(p.get(), /*top=*/"A", /*max_cluster_size=*/2),
+              IsOkAndHolds(true));
+
+  EXPECT_EQ(p->procs().size(), 2);
+  EXPECT_TRUE(p->HasChannelWithName("a_to_c"));
+  EXPECT_FALSE(p->HasChannelWithName("a_to_b"));
+  XLS_EXPECT_OK(
+      EvalAndExpect(p.get(), {{"in", {1, 2, 3}}}, {{"out", {2, 4, 6}}})
+          .status());
+}
+
 TEST_F(ProcInliningPassTest, NestedProcsFifoDepth1) {
   // Nested procs where the inner proc does a trivial arithmetic operation.
   auto p = CreatePackage();
@@ -167,7 +167,14 @@ absl::StatusOr<bool> RemoveConstantStateElements(Proc* proc,
 // LeafTypeTrees.
 class StateDependencyVisitor : public DataflowVisitor<InlineBitmap> {
  public:
-  explicit StateDependencyVisitor(Proc* proc) : proc_(proc) {}
+  explicit StateDependencyVisitor(Proc* proc) : proc_(proc) {
+    // Proc::GetStateElementIndex is a linear scan; procs with thousands of
+    // state elements make that quadratic, so index them once up front.
+    state_element_indices_.reserve(proc->GetStateElementCount());
+    for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
+      state_element_indices_[proc->GetStateElement(i)] = i;
+    }
+  }
 
   absl::Status DefaultHandler(Node* node) override {
     // By default, conservatively assume that each element in `node` is
@@ -179,8 +186,10 @@ class StateDependencyVisitor : public DataflowVisitor<InlineBitmap> {
 
   absl::Status HandleStateRead(StateRead* state_read) override {
     // A state read is only dependent upon itself.
-    XLS_ASSIGN_OR_RETURN(int64_t index, proc_->GetStateElementIndex(
-                                            state_read->state_element()));
+    auto it = state_element_indices_.find(state_read->state_element());
+    XLS_RET_CHECK(it != state_element_indices_.end())
+        << "Not a state element of this proc: " << state_read->ToString();
+    const int64_t index = it->second;
     InlineBitmap bitmap(proc_->GetStateElementCount());
     bitmap.Set(index, true);
     return SetValue(state_read,
@@ -202,10 +211,15 @@ class StateDependencyVisitor : public DataflowVisitor<InlineBitmap> {
   // Returns the union of all of the bitmaps in the LeafTypeTree for `node`.
   InlineBitmap FlattenNodeBitmaps(Node* node) {
     InlineBitmap result(proc_->GetStateElementCount());
+    UnionNodeBitmaps(node, result);
+    return result;
+  }
+
+  // Unions all of the bitmaps in the LeafTypeTree for `node` into `result`.
+  void UnionNodeBitmaps(Node* node, InlineBitmap& result) {
     for (const InlineBitmap& bitmap : GetValue(node).elements()) {
       result.Union(bitmap);
     }
-    return result;
   }
 
  protected:
@@ -229,26 +243,27 @@ class StateDependencyVisitor : public DataflowVisitor<InlineBitmap> {
   }
 
   Proc* proc_;
+  absl::flat_hash_map<StateElement*, int64_t> state_element_indices_;
 };
 
 // Computes which state elements each node is dependent upon. Dependence is
 // represented as a bit-vector with one bit per state element in the proc.
 // Dependencies are only computed in a single forward pass so dependencies
 // through the proc back edge are not considered.
-absl::StatusOr<absl::flat_hash_map<Node*, InlineBitmap>>
+//
+// The per-node bit-vectors are not materialized; callers union the ones they
+// need directly out of the returned visitor.
+absl::StatusOr<std::unique_ptr<StateDependencyVisitor>>
 ComputeStateDependencies(Proc* proc) {
-  StateDependencyVisitor visitor(proc);
-  XLS_RETURN_IF_ERROR(proc->Accept(&visitor));
-  absl::flat_hash_map<Node*, InlineBitmap> state_dependencies;
-  for (Node* node : proc->nodes()) {
-    state_dependencies.insert({node, visitor.FlattenNodeBitmaps(node)});
-  }
+  auto visitor = std::make_unique<StateDependencyVisitor>(proc);
+  XLS_RETURN_IF_ERROR(proc->Accept(visitor.get()));
   if (VLOG_IS_ON(5)) {
     VLOG(5) << "State dependencies (** side-effecting operation):";
     for (Node* node : TopoSort(proc)) {
+      InlineBitmap dependencies = visitor->FlattenNodeBitmaps(node);
       std::vector<std::string> dependent_elements;
       for (int64_t i = 0; i < proc->GetStateElementCount(); ++i) {
-        if (state_dependencies.at(node).Get(i)) {
+        if (dependencies.Get(i)) {
           dependent_elements.push_back(proc->GetStateRead(i)->GetName());
         }
       }
@@ -257,7 +272,7 @@ ComputeStateDependencies(Proc* proc) {
                                  OpIsSideEffecting(node->op()) ? "**" : "");
     }
   }
-  return std::move(state_dependencies);
+  return std::move(visitor);
 }
 
 // Removes unobservable state elements. A state element X is observable if:
@@ -267,8 +282,9 @@ absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
   if (proc->GetStateElementCount() == 0) {
     return false;
   }
-  absl::flat_hash_map<Node*, InlineBitmap> state_dependencies;
-  XLS_ASSIGN_OR_RETURN(state_dependencies, ComputeStateDependencies(proc));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<StateDependencyVisitor> state_dependencies,
+      ComputeStateDependencies(proc));
 
   // Compute an adjacency matrix for which state elements affect each other.
   //
@@ -279,9 +295,9 @@ absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
   for (auto [elem, adj] :
        iter::zip(proc->StateElements(), state_dependencies_matrix)) {
     for (Next* next : proc->next_values(proc->GetStateRead(elem))) {
-      adj.Union(state_dependencies.at(next->value()));
+      state_dependencies->UnionNodeBitmaps(next->value(), adj);
       if (next->predicate().has_value()) {
-        adj.Union(state_dependencies.at(*next->predicate()));
+        state_dependencies->UnionNodeBitmaps(*next->predicate(), adj);
       }
     }
     // Avoid a copy of each state element's bitmap by extending after doing all
@@ -296,7 +312,8 @@ absl::StatusOr<bool> RemoveUnobservableStateElements(Proc* proc) {
         node->OpIn({Op::kStateRead, Op::kNext, Op::kGate})) {
       continue;
     }
-    state_dependencies_matrix.back().Union(state_dependencies.at(node));
+    state_dependencies->UnionNodeBitmaps(node,
+                                         state_dependencies_matrix.back());
   }
   state_dependencies_matrix.back() =
       std::move(state_dependencies_matrix.back())
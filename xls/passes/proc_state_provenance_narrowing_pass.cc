@@ -42,6 +42,7 @@
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/ternary_query_engine.h"
 
 namespace xls {
@@ -258,8 +259,9 @@ absl::StatusOr<bool> ProcStateProvenanceNarrowingPass::RunOnProcInternal(
       << proc;
   // Query engine to identify writes of (parts of) the initial value.
   TernaryQueryEngine tqe;
-  XLS_ASSIGN_OR_RETURN(BitProvenanceAnalysis provenance,
-                       BitProvenanceAnalysis::Create(proc));
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<const BitProvenanceAnalysis> provenance,
+      MakeBitProvenanceAnalysis(proc, options.query_engine_cache));
   XLS_RETURN_IF_ERROR(tqe.Populate(proc).status());
   bool made_changes = false;
 
@@ -276,7 +278,7 @@ absl::StatusOr<bool> ProcStateProvenanceNarrowingPass::RunOnProcInternal(
     const Bits& initial_bits = init.bits();
     XLS_ASSIGN_OR_RETURN(
         Bits unchanged_bits,
-        UnchangedBits(proc, state_element, initial_bits, tqe, provenance));
+        UnchangedBits(proc, state_element, initial_bits, tqe, *provenance));
     // Do the actual splitting
     if (unchanged_bits.IsZero()) {
       VLOG(3) << "Unable to narrow " << state_element->name()
@@ -32,6 +32,7 @@
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/interpreter/ir_interpreter.h"
 #include "xls/ir/bits.h"
@@ -183,27 +184,41 @@ class SegmentRangeData : public RangeDataProvider {
       const absl::flat_hash_map<StateElement*, RangeData>& ground_truth,
       StateRead* data_source, absl::Span<Node* const> topo_sort) {
     XLS_RET_CHECK(!nda.IsForward());
-    std::vector<DependencyBitmap> bitmaps;
+    // The segment walk re-runs range analysis over these nodes once per
+    // segment, so merge the per-next dependencies into a single dense bitmap
+    // and find the nodes of interest once rather than on every run.
     auto nexts =
         data_source->function_base()->AsProcOrDie()->next_values(data_source);
-    bitmaps.reserve(nexts.size());
+    std::optional<InlineBitmap> dependencies;
+    const absl::flat_hash_map<Node*, int64_t>* node_indices = nullptr;
     for (Next* n : nexts) {
       XLS_ASSIGN_OR_RETURN(DependencyBitmap bm, nda.GetDependents(n));
-      bitmaps.push_back(bm);
+      if (dependencies.has_value()) {
+        dependencies->Union(bm.bitmap());
+      } else {
+        dependencies = bm.bitmap();
+        node_indices = &bm.node_indices();
+      }
     }
-    return SegmentRangeData(bitmaps, ground_truth, data_source, topo_sort);
+    std::vector<Node*> interesting_nodes;
+    for (Node* node : topo_sort) {
+      bool interesting =
+          node->Is<Next>() && node->As<Next>()->state_read() == data_source;
+      if (!interesting && dependencies.has_value()) {
+        auto it = node_indices->find(node);
+        interesting =
+            it != node_indices->end() && dependencies->Get(it->second);
+      }
+      if (interesting) {
+        interesting_nodes.push_back(node);
+      }
+    }
+    return SegmentRangeData(std::move(interesting_nodes), ground_truth,
+                            data_source);
   }
 
   void SetParamIntervals(const IntervalSet& is) { current_segments_ = is; }
 
-  bool IsInteresting(Node* n) const {
-    return (n->Is<Next>() && n->As<Next>()->state_read() == data_source_) ||
-           absl::c_any_of(dependencies_,
-                          [&](const DependencyBitmap& d) -> bool {
-                            return d.IsDependent(n).value_or(false);
-                          });
-  }
-
   std::optional<RangeData> GetKnownIntervals(Node* node) final {
     if (node == data_source_) {
       CHECK(!current_segments_.IsEmpty());
@@ -231,31 +246,28 @@ class SegmentRangeData : public RangeDataProvider {
   }
 
   absl::Status IterateFunction(DfsVisitor* visitor) final {
-    for (Node* node : topo_sort_) {
-      // Don't bother to calculate anything nodes which don't reach a next
-      // instruction.
-      if (IsInteresting(node)) {
-        XLS_RETURN_IF_ERROR(node->VisitSingleNode(visitor)) << node;
-      }
+    // Don't bother to calculate anything nodes which don't reach a next
+    // instruction.
+    for (Node* node : interesting_nodes_) {
+      XLS_RETURN_IF_ERROR(node->VisitSingleNode(visitor)) << node;
     }
     return absl::OkStatus();
   }
 
  private:
   SegmentRangeData(
-      std::vector<DependencyBitmap> dependencies,
+      std::vector<Node*> interesting_nodes,
       const absl::flat_hash_map<StateElement*, RangeData>& ground_truth,
-      StateRead* data_source, absl::Span<Node* const> topo_sort)
-      : dependencies_(std::move(dependencies)),
+      StateRead* data_source)
+      : interesting_nodes_(std::move(interesting_nodes)),
         ground_truth_(ground_truth),
         data_source_(data_source),
-        current_segments_(data_source->BitCountOrDie()),
-        topo_sort_(topo_sort) {}
-  std::vector<DependencyBitmap> dependencies_;
+        current_segments_(data_source->BitCountOrDie()) {}
+  // The nodes which reach a next of `data_source_`, in topological order.
+  std::vector<Node*> interesting_nodes_;
   const absl::flat_hash_map<StateElement*, RangeData>& ground_truth_;
   StateRead* data_source_;
   IntervalSet current_segments_;
-  absl::Span<Node* const> topo_sort_;
 };
 bool AbsoluteValueLessThan(const Bits& l, const Bits& r) {
   CHECK_EQ(l.bit_count(), r.bit_count());
@@ -0,0 +1,604 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
+#include "xls/common/resource_usage.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/leaf_type_tree.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/interval_set.h"
+#include "xls/ir/node.h"
+#include "xls/ir/ternary.h"
+#include "xls/ir/value.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bdd_query_engine.h"
+#include "xls/passes/bit_provenance_analysis.h"
+#include "xls/passes/context_sensitive_range_query_engine.h"
+#include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/predicate_state.h"
+#include "xls/passes/preserved_analyses.h"
+#include "xls/passes/proc_state_range_query_engine.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/range_query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+// A query engine which forwards everything (including Populate) to another
+// engine. Populating is accounted as analysis time in pass metrics.
+class DelegatingQueryEngine : public QueryEngine {
+ public:
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    ScopedAnalysisTimer timer;
+    return engine()->Populate(f);
+  }
+  bool IsTracked(Node* node) const override {
+    return engine()->IsTracked(node);
+  }
+  std::optional<SharedLeafTypeTree<TernaryVector>> GetTernary(
+      Node* node) const override {
+    return engine()->GetTernary(node);
+  }
+  std::unique_ptr<QueryEngine> SpecializeGivenPredicate(
+      const absl::flat_hash_set<PredicateState>& state) const override {
+    return engine()->SpecializeGivenPredicate(state);
+  }
+  std::unique_ptr<QueryEngine> SpecializeGiven(
+      const absl::flat_hash_map<Node*, ValueKnowledge>& givens)
+      const override {
+    return engine()->SpecializeGiven(givens);
+  }
+  LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
+    return engine()->GetIntervals(node);
+  }
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return engine()->AtMostOneTrue(bits);
+  }
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return engine()->AtLeastOneTrue(bits);
+  }
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return engine()->Implies(a, b);
+  }
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return engine()->ImpliedNodeValue(predicate_bit_values, node);
+  }
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    return engine()->ImpliedNodeTernary(predicate_bit_values, node);
+  }
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override {
+    return engine()->KnownEquals(a, b);
+  }
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override {
+    return engine()->KnownNotEquals(a, b);
+  }
+  bool AtMostOneBitTrue(Node* node) const override {
+    return engine()->AtMostOneBitTrue(node);
+  }
+  bool AtLeastOneBitTrue(Node* node) const override {
+    return engine()->AtLeastOneBitTrue(node);
+  }
+  bool ExactlyOneBitTrue(Node* node) const override {
+    return engine()->ExactlyOneBitTrue(node);
+  }
+  bool IsKnown(const TreeBitLocation& bit) const override {
+    return engine()->IsKnown(bit);
+  }
+  std::optional<bool> KnownValue(const TreeBitLocation& bit) const override {
+    return engine()->KnownValue(bit);
+  }
+  std::optional<Value> KnownValue(Node* node) const override {
+    return engine()->KnownValue(node);
+  }
+  bool IsAllZeros(Node* node) const override {
+    return engine()->IsAllZeros(node);
+  }
+  bool IsAllOnes(Node* node) const override {
+    return engine()->IsAllOnes(node);
+  }
+  bool IsFullyKnown(Node* node) const override {
+    return engine()->IsFullyKnown(node);
+  }
+  Bits MaxUnsignedValue(Node* node) const override {
+    return engine()->MaxUnsignedValue(node);
+  }
+  Bits MinUnsignedValue(Node* node) const override {
+    return engine()->MinUnsignedValue(node);
+  }
+
+ protected:
+  virtual QueryEngine* engine() const = 0;
+};
+
+// The handle handed out to passes for an engine owned by the cache.
+class SharedQueryEngine final : public DelegatingQueryEngine {
+ public:
+  explicit SharedQueryEngine(QueryEngine* engine) : engine_(engine) {}
+
+ protected:
+  QueryEngine* engine() const override { return engine_; }
+
+ private:
+  QueryEngine* engine_;
+};
+
+// A ternary query engine which tracks the nodes whose value may have changed
+// since it was last populated and re-evaluates only those (and whatever they
+// affect) on the next Populate.
+class IncrementalTernaryQueryEngine final : public TernaryQueryEngine {
+ public:
+  IncrementalTernaryQueryEngine(FunctionBase* f, std::atomic<int64_t>* builds,
+                                std::atomic<int64_t>* reuses)
+      : f_(f), builds_(builds), reuses_(reuses) {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    XLS_RET_CHECK_EQ(f, f_);
+    if (populated_) {
+      ++*reuses_;
+    } else {
+      ++*builds_;
+      populated_ = true;
+    }
+    absl::flat_hash_set<Node*> dirty = std::move(dirty_);
+    dirty_.clear();
+    return Reevaluate(f, dirty);
+  }
+
+  void MarkDirty(Node* node) { dirty_.insert(node); }
+  void NodeDeleted(Node* node) {
+    dirty_.erase(node);
+    Forget(node);
+  }
+
+ private:
+  FunctionBase* f_;
+  std::atomic<int64_t>* builds_;
+  std::atomic<int64_t>* reuses_;
+  bool populated_ = false;
+  absl::flat_hash_set<Node*> dirty_;
+};
+
+// An engine which is rebuilt from scratch on Populate if its FunctionBase has
+// changed since the engine was last built.
+class RebuildingQueryEngine final : public DelegatingQueryEngine {
+ public:
+  RebuildingQueryEngine(std::function<std::unique_ptr<QueryEngine>()> factory,
+                        const int64_t* version, std::atomic<int64_t>* builds,
+                        std::atomic<int64_t>* reuses)
+      : factory_(std::move(factory)),
+        version_(version),
+        builds_(builds),
+        reuses_(reuses) {}
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    if (engine_ != nullptr && built_version_ == *version_) {
+      ++*reuses_;
+      return ReachedFixpoint::Unchanged;
+    }
+    ++*builds_;
+    engine_ = factory_();
+    built_version_ = *version_;
+    return engine_->Populate(f);
+  }
+
+ protected:
+  QueryEngine* engine() const override { return engine_.get(); }
+
+ private:
+  std::function<std::unique_ptr<QueryEngine>()> factory_;
+  const int64_t* version_;
+  std::atomic<int64_t>* builds_;
+  std::atomic<int64_t>* reuses_;
+  std::unique_ptr<QueryEngine> engine_;
+  int64_t built_version_ = 0;
+};
+
+// An analysis which is recomputed on request if its FunctionBase has changed
+// since the analysis was last computed.
+template <typename T>
+class CachedAnalysis {
+ public:
+  absl::StatusOr<std::shared_ptr<const T>> Get(
+      int64_t version, std::atomic<int64_t>* builds,
+      std::atomic<int64_t>* reuses,
+      absl::FunctionRef<absl::StatusOr<std::shared_ptr<const T>>()> compute) {
+    if (analysis_ != nullptr && built_version_ == version) {
+      ++*reuses;
+      return analysis_;
+    }
+    ++*builds;
+    ScopedAnalysisTimer timer;
+    XLS_ASSIGN_OR_RETURN(analysis_, compute());
+    built_version_ = version;
+    return analysis_;
+  }
+
+ private:
+  std::shared_ptr<const T> analysis_;
+  int64_t built_version_ = 0;
+};
+
+absl::StatusOr<std::shared_ptr<const PostDominatorAnalysis>>
+ComputePostDominatorAnalysis(FunctionBase* f) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<PostDominatorAnalysis> analysis,
+                       PostDominatorAnalysis::Run(f));
+  return std::shared_ptr<const PostDominatorAnalysis>(std::move(analysis));
+}
+
+absl::StatusOr<std::shared_ptr<const BitProvenanceAnalysis>>
+ComputeBitProvenanceAnalysis(FunctionBase* f) {
+  XLS_ASSIGN_OR_RETURN(BitProvenanceAnalysis analysis,
+                       BitProvenanceAnalysis::Create(f));
+  return std::make_shared<const BitProvenanceAnalysis>(std::move(analysis));
+}
+
+}  // namespace
+
+// The cached engines and analyses of a single FunctionBase.
+class QueryEngineCache::Entry final : public ChangeListener {
+ public:
+  Entry(QueryEngineCache* cache, FunctionBase* f) : cache_(cache), f_(f) {
+    f_->RegisterChangeListener(this);
+  }
+  ~Entry() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  QueryEngine* ternary() {
+    if (ternary_ == nullptr) {
+      ternary_ = std::make_unique<IncrementalTernaryQueryEngine>(
+          f_, &cache_->builds_, &cache_->reuses_);
+    }
+    return ternary_.get();
+  }
+
+  QueryEngine* range() {
+    if (range_ == nullptr) {
+      range_ = std::make_unique<RebuildingQueryEngine>(
+          [] { return std::make_unique<RangeQueryEngine>(); },
+          &version(AnalysisKind::kRange), &cache_->builds_, &cache_->reuses_);
+    }
+    return range_.get();
+  }
+
+  QueryEngine* context_sensitive_range(int64_t max_specializations) {
+    std::unique_ptr<RebuildingQueryEngine>& engine =
+        context_sensitive_range_[max_specializations];
+    if (engine == nullptr) {
+      engine = std::make_unique<RebuildingQueryEngine>(
+          [max_specializations] {
+            return std::make_unique<ContextSensitiveRangeQueryEngine>(
+                max_specializations);
+          },
+          &version(AnalysisKind::kRange), &cache_->builds_, &cache_->reuses_);
+    }
+    return engine.get();
+  }
+
+  QueryEngine* proc_state_range() {
+    if (proc_state_range_ == nullptr) {
+      proc_state_range_ = std::make_unique<RebuildingQueryEngine>(
+          [] { return std::make_unique<ProcStateRangeQueryEngine>(); },
+          &version(AnalysisKind::kRange), &cache_->builds_, &cache_->reuses_);
+    }
+    return proc_state_range_.get();
+  }
+
+  QueryEngine* bdd(int64_t path_limit) {
+    std::unique_ptr<RebuildingQueryEngine>& engine = bdd_[path_limit];
+    if (engine == nullptr) {
+      engine = std::make_unique<RebuildingQueryEngine>(
+          [path_limit] {
+            return std::make_unique<BddQueryEngine>(path_limit, IsCheapForBdds);
+          },
+          &version(AnalysisKind::kBdd), &cache_->builds_, &cache_->reuses_);
+    }
+    return engine.get();
+  }
+
+  absl::StatusOr<std::shared_ptr<const PostDominatorAnalysis>>
+  post_dominators() {
+    return post_dominators_.Get(
+        version(AnalysisKind::kPostDominator), &cache_->builds_,
+        &cache_->reuses_, [&] { return ComputePostDominatorAnalysis(f_); });
+  }
+
+  absl::StatusOr<std::shared_ptr<const BitProvenanceAnalysis>>
+  bit_provenance() {
+    return bit_provenance_.Get(
+        version(AnalysisKind::kBitProvenance), &cache_->builds_,
+        &cache_->reuses_, [&] { return ComputeBitProvenanceAnalysis(f_); });
+  }
+
+  void set_preserved(PreservedAnalyses preserved) { preserved_ = preserved; }
+
+  std::optional<absl::flat_hash_set<Node*>> TakeChangedNodes(
+      std::string_view client) {
+    auto [it, inserted] = changed_nodes_.try_emplace(client);
+    if (inserted) {
+      return std::nullopt;
+    }
+    absl::flat_hash_set<Node*> changed = std::move(it->second);
+    it->second.clear();
+    return changed;
+  }
+  void ResetChangedNodes(std::string_view client) {
+    changed_nodes_.erase(client);
+  }
+
+  void NodeAdded(Node* node) override {
+    // Preserved analyses know nothing about new nodes, so additions always
+    // invalidate everything.
+    for (int64_t& version : versions_) {
+      ++version;
+    }
+    if (ternary_ != nullptr) {
+      ternary_->MarkDirty(node);
+    }
+    RecordChange(node);
+  }
+  void NodeDeleted(Node* node) override {
+    Invalidate();
+    if (ternary_ != nullptr) {
+      ternary_->NodeDeleted(node);
+    }
+    // The operands are still attached, and each loses `node` as a user.
+    for (auto& [client, changed] : changed_nodes_) {
+      changed.erase(node);
+      changed.insert(node->operands().begin(), node->operands().end());
+    }
+  }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    Changed(node);
+    RecordChange(old_operand);
+  }
+  void OperandRemoved(Node* node, Node* old_operand) override {
+    Changed(node);
+    RecordChange(old_operand);
+  }
+  void OperandAdded(Node* node) override { Changed(node); }
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    f_ = nullptr;
+    // Destroys this entry.
+    cache_->RemoveEntry(function_base);
+  }
+
+ private:
+  int64_t& version(AnalysisKind kind) {
+    return versions_[static_cast<int64_t>(kind)];
+  }
+
+  void Invalidate() {
+    for (int64_t i = 0; i < kAnalysisKindCount; ++i) {
+      if (!preserved_.IsPreserved(static_cast<AnalysisKind>(i))) {
+        ++versions_[i];
+      }
+    }
+  }
+
+  void Changed(Node* node) {
+    Invalidate();
+    if (ternary_ != nullptr) {
+      ternary_->MarkDirty(node);
+    }
+    // The operands of `node` may have gained it as a user.
+    RecordChange(node);
+    for (Node* operand : node->operands()) {
+      RecordChange(operand);
+    }
+  }
+
+  void RecordChange(Node* node) {
+    for (auto& [client, changed] : changed_nodes_) {
+      changed.insert(node);
+    }
+  }
+
+  QueryEngineCache* cache_;
+  FunctionBase* f_;
+  // For each AnalysisKind, incremented on every change to `f_` which does not
+  // preserve the analysis.
+  std::array<int64_t, kAnalysisKindCount> versions_ = {};
+  // The analyses preserved by the pass currently changing `f_`.
+  PreservedAnalyses preserved_ = PreservedAnalyses::None();
+  std::unique_ptr<IncrementalTernaryQueryEngine> ternary_;
+  std::unique_ptr<RebuildingQueryEngine> range_;
+  absl::flat_hash_map<int64_t, std::unique_ptr<RebuildingQueryEngine>>
+      context_sensitive_range_;
+  std::unique_ptr<RebuildingQueryEngine> proc_state_range_;
+  absl::flat_hash_map<int64_t, std::unique_ptr<RebuildingQueryEngine>> bdd_;
+  CachedAnalysis<PostDominatorAnalysis> post_dominators_;
+  CachedAnalysis<BitProvenanceAnalysis> bit_provenance_;
+  // For each TakeChangedNodes client, the nodes changed since its last call.
+  absl::flat_hash_map<std::string, absl::flat_hash_set<Node*>> changed_nodes_;
+};
+
+QueryEngineCache::~QueryEngineCache() {
+  absl::MutexLock lock(&mutex_);
+  entries_.clear();
+}
+
+QueryEngineCache::Entry& QueryEngineCache::GetEntry(FunctionBase* f) {
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<Entry>& entry = entries_[f];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry>(this, f);
+  }
+  return *entry;
+}
+
+void QueryEngineCache::RemoveEntry(FunctionBase* f) {
+  std::unique_ptr<Entry> entry;
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(f);
+    if (it == entries_.end()) {
+      return;
+    }
+    entry = std::move(it->second);
+    entries_.erase(it);
+  }
+}
+
+std::unique_ptr<QueryEngine> QueryEngineCache::GetTernaryQueryEngine(
+    FunctionBase* f) {
+  return std::make_unique<SharedQueryEngine>(GetEntry(f).ternary());
+}
+
+std::unique_ptr<QueryEngine> QueryEngineCache::GetRangeQueryEngine(
+    FunctionBase* f) {
+  return std::make_unique<SharedQueryEngine>(GetEntry(f).range());
+}
+
+std::unique_ptr<QueryEngine>
+QueryEngineCache::GetContextSensitiveRangeQueryEngine(
+    FunctionBase* f, int64_t max_specializations) {
+  return std::make_unique<SharedQueryEngine>(
+      GetEntry(f).context_sensitive_range(max_specializations));
+}
+
+std::unique_ptr<QueryEngine> QueryEngineCache::GetProcStateRangeQueryEngine(
+    FunctionBase* f) {
+  return std::make_unique<SharedQueryEngine>(GetEntry(f).proc_state_range());
+}
+
+std::unique_ptr<QueryEngine> QueryEngineCache::GetBddQueryEngine(
+    FunctionBase* f, int64_t path_limit) {
+  return std::make_unique<SharedQueryEngine>(GetEntry(f).bdd(path_limit));
+}
+
+absl::StatusOr<std::shared_ptr<const PostDominatorAnalysis>>
+QueryEngineCache::GetPostDominatorAnalysis(FunctionBase* f) {
+  return GetEntry(f).post_dominators();
+}
+
+absl::StatusOr<std::shared_ptr<const BitProvenanceAnalysis>>
+QueryEngineCache::GetBitProvenanceAnalysis(FunctionBase* f) {
+  return GetEntry(f).bit_provenance();
+}
+
+std::optional<absl::flat_hash_set<Node*>> QueryEngineCache::TakeChangedNodes(
+    FunctionBase* f, std::string_view client) {
+  return GetEntry(f).TakeChangedNodes(client);
+}
+
+void QueryEngineCache::ResetChangedNodes(FunctionBase* f,
+                                         std::string_view client) {
+  GetEntry(f).ResetChangedNodes(client);
+}
+
+QueryEngineCache::PreservationScope::PreservationScope(
+    QueryEngineCache* cache, FunctionBase* f, PreservedAnalyses preserved) {
+  if (cache != nullptr) {
+    entry_ = &cache->GetEntry(f);
+    entry_->set_preserved(preserved);
+  }
+}
+
+QueryEngineCache::PreservationScope::~PreservationScope() {
+  if (entry_ != nullptr) {
+    entry_->set_preserved(PreservedAnalyses::None());
+  }
+}
+
+std::unique_ptr<QueryEngine> MakeTernaryQueryEngine(FunctionBase* f,
+                                                    QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetTernaryQueryEngine(f);
+  }
+  return std::make_unique<TernaryQueryEngine>();
+}
+
+std::unique_ptr<QueryEngine> MakeRangeQueryEngine(FunctionBase* f,
+                                                  QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetRangeQueryEngine(f);
+  }
+  return std::make_unique<RangeQueryEngine>();
+}
+
+std::unique_ptr<QueryEngine> MakeContextSensitiveRangeQueryEngine(
+    FunctionBase* f, int64_t max_specializations, QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetContextSensitiveRangeQueryEngine(f, max_specializations);
+  }
+  return std::make_unique<ContextSensitiveRangeQueryEngine>(
+      max_specializations);
+}
+
+std::unique_ptr<QueryEngine> MakeProcStateRangeQueryEngine(
+    FunctionBase* f, QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetProcStateRangeQueryEngine(f);
+  }
+  return std::make_unique<ProcStateRangeQueryEngine>();
+}
+
+std::unique_ptr<QueryEngine> MakeBddQueryEngine(FunctionBase* f,
+                                                int64_t path_limit,
+                                                QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetBddQueryEngine(f, path_limit);
+  }
+  return std::make_unique<BddQueryEngine>(path_limit, IsCheapForBdds);
+}
+
+absl::StatusOr<std::shared_ptr<const PostDominatorAnalysis>>
+MakePostDominatorAnalysis(FunctionBase* f, QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetPostDominatorAnalysis(f);
+  }
+  return ComputePostDominatorAnalysis(f);
+}
+
+absl::StatusOr<std::shared_ptr<const BitProvenanceAnalysis>>
+MakeBitProvenanceAnalysis(FunctionBase* f, QueryEngineCache* cache) {
+  if (cache != nullptr) {
+    return cache->GetBitProvenanceAnalysis(f);
+  }
+  return ComputeBitProvenanceAnalysis(f);
+}
+
+}  // namespace xls
@@ -0,0 +1,165 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_QUERY_ENGINE_CACHE_H_
+#define XLS_PASSES_QUERY_ENGINE_CACHE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/passes/bit_provenance_analysis.h"
+#include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/preserved_analyses.h"
+#include "xls/passes/query_engine.h"
+
+namespace xls {
+
+// Caches query engines for the FunctionBases of a package across passes so
+// that analyses are not recomputed from scratch every time a pass runs (e.g.,
+// in each iteration of a fixed-point compound pass). Cached engines listen for
+// changes to their FunctionBase (see ChangeListener):
+//
+//  * the ternary engine re-evaluates only the nodes whose inputs changed and
+//    stops propagating at nodes whose value did not change,
+//  * the range (including context-sensitive and proc state range) and BDD
+//    engines are rebuilt only if their FunctionBase changed since they were
+//    last populated.
+//
+// Engines returned by the cache are lightweight handles owned by the caller
+// which must be populated before use, exactly like freshly constructed engines;
+// populating is what brings the shared engine up to date. While a pass mutates
+// the IR the engine answers with the information computed at the last
+// Populate, again like a freshly constructed engine would.
+//
+// The cache also holds post-dominator and bit provenance analyses, which are
+// computed on first use and recomputed only once their FunctionBase changed.
+// Passes may declare that the changes they make preserve some analyses (see
+// PreservedAnalyses and PreservationScope), in which case those changes do not
+// invalidate them.
+//
+// The time spent populating cached engines is measured with a
+// ScopedAnalysisTimer, and so reported as analysis time in pass metrics.
+// Engines constructed outside of the cache are not measured.
+//
+// Engines for different FunctionBases may be used concurrently, but each
+// FunctionBase's engines must only be used by one thread at a time. The cache
+// must outlive the handles it returns.
+class QueryEngineCache {
+  class Entry;
+
+ public:
+  QueryEngineCache() = default;
+  ~QueryEngineCache();
+
+  QueryEngineCache(const QueryEngineCache&) = delete;
+  QueryEngineCache& operator=(const QueryEngineCache&) = delete;
+
+  std::unique_ptr<QueryEngine> GetTernaryQueryEngine(FunctionBase* f);
+  std::unique_ptr<QueryEngine> GetRangeQueryEngine(FunctionBase* f);
+  std::unique_ptr<QueryEngine> GetContextSensitiveRangeQueryEngine(
+      FunctionBase* f, int64_t max_specializations);
+  // `f` must be a proc for which
+  // ProcStateRangeQueryEngine::CanAnalyzeProcStateEvolution holds.
+  std::unique_ptr<QueryEngine> GetProcStateRangeQueryEngine(FunctionBase* f);
+
+  // The BDD engine only evaluates nodes for which IsCheapForBdds is true.
+  std::unique_ptr<QueryEngine> GetBddQueryEngine(FunctionBase* f,
+                                                 int64_t path_limit);
+
+  // Returns the analysis of `f`, computing it if it is not cached or was
+  // invalidated. The returned analysis stays alive while it is held, but is
+  // not updated when `f` changes.
+  absl::StatusOr<std::shared_ptr<const PostDominatorAnalysis>>
+  GetPostDominatorAnalysis(FunctionBase* f);
+  absl::StatusOr<std::shared_ptr<const BitProvenanceAnalysis>>
+  GetBitProvenanceAnalysis(FunctionBase* f);
+
+  // While alive, changes to `f` other than node additions do not invalidate
+  // the cached analyses in `preserved`. Scopes of the same FunctionBase must
+  // not overlap. A null `cache` makes the scope a no-op.
+  class PreservationScope {
+   public:
+    PreservationScope(QueryEngineCache* cache, FunctionBase* f,
+                      PreservedAnalyses preserved);
+    ~PreservationScope();
+
+    PreservationScope(const PreservationScope&) = delete;
+    PreservationScope& operator=(const PreservationScope&) = delete;
+
+   private:
+    Entry* entry_ = nullptr;
+  };
+
+  // Returns the nodes which were added to `f`, or whose operands or users
+  // changed, since the previous call with the same `client` key. Returns
+  // std::nullopt on the first call for `client`, which starts the recording,
+  // and after ResetChangedNodes. Deleted nodes are never returned. This lets a
+  // pass limit its work on later runs to the part of `f` which changed.
+  std::optional<absl::flat_hash_set<Node*>> TakeChangedNodes(
+      FunctionBase* f, std::string_view client);
+
+  // Makes the next TakeChangedNodes call for `client` return std::nullopt,
+  // e.g. because the client stopped before it looked at every node.
+  void ResetChangedNodes(FunctionBase* f, std::string_view client);
+
+  // Number of Populate calls on cached engines which computed the analysis
+  // from scratch, and which reused (all or part of) an earlier result.
+  int64_t builds() const { return builds_.load(std::memory_order_relaxed); }
+  int64_t reuses() const { return reuses_.load(std::memory_order_relaxed); }
+
+ private:
+  Entry& GetEntry(FunctionBase* f);
+  void RemoveEntry(FunctionBase* f);
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<FunctionBase*, std::unique_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  std::atomic<int64_t> builds_ = 0;
+  std::atomic<int64_t> reuses_ = 0;
+};
+
+// Returns an engine of the given kind for `f`: a handle to the engine in
+// `cache` if it is non-null, or a freshly constructed engine otherwise.
+std::unique_ptr<QueryEngine> MakeTernaryQueryEngine(FunctionBase* f,
+                                                    QueryEngineCache* cache);
+std::unique_ptr<QueryEngine> MakeRangeQueryEngine(FunctionBase* f,
+                                                  QueryEngineCache* cache);
+std::unique_ptr<QueryEngine> MakeContextSensitiveRangeQueryEngine(
+    FunctionBase* f, int64_t max_specializations, QueryEngineCache* cache);
+std::unique_ptr<QueryEngine> MakeProcStateRangeQueryEngine(
+    FunctionBase* f, QueryEngineCache* cache);
+std::unique_ptr<QueryEngine> MakeBddQueryEngine(FunctionBase* f,
+                                                int64_t path_limit,
+                                                QueryEngineCache* cache);
+
+// Returns the given analysis of `f`: the analysis cached in `cache` if it is
+// non-null, or a freshly computed analysis otherwise.
+absl::StatusOr<std::shared_ptr<const PostDominatorAnalysis>>
+MakePostDominatorAnalysis(FunctionBase* f, QueryEngineCache* cache);
+absl::StatusOr<std::shared_ptr<const BitProvenanceAnalysis>>
+MakeBitProvenanceAnalysis(FunctionBase* f, QueryEngineCache* cache);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_QUERY_ENGINE_CACHE_H_
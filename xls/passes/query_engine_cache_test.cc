@@ -0,0 +1,245 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/query_engine_cache.h"
+
+#include <memory>
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/passes/bdd_function.h"
+#include "xls/passes/bit_provenance_analysis.h"
+#include "xls/passes/post_dominator_analysis.h"
+#include "xls/passes/preserved_analyses.h"
+#include "xls/passes/query_engine.h"
+#include "xls/passes/ternary_query_engine.h"
+
+namespace xls {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Optional;
+using ::testing::UnorderedElementsAre;
+
+class QueryEngineCacheTest : public IrTestBase {};
+
+TEST_F(QueryEngineCacheTest, TernaryEngineTracksChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue masked = fb.And(x, fb.Literal(UBits(0x0f, 8)));
+  BValue y = fb.Or(masked, fb.Literal(UBits(0x80, 8)));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  {
+    std::unique_ptr<QueryEngine> qe = cache.GetTernaryQueryEngine(f);
+    XLS_ASSERT_OK(qe->Populate(f).status());
+    EXPECT_EQ(qe->ToString(y.node()), "0b1000_XXXX");
+  }
+  EXPECT_EQ(cache.builds(), 1);
+
+  // Replace the mask so that more bits of `y` are known.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * new_mask, f->MakeNode<Literal>(SourceInfo(), Value(UBits(3, 8))));
+  XLS_ASSERT_OK(masked.node()->ReplaceOperandNumber(1, new_mask));
+  {
+    std::unique_ptr<QueryEngine> qe = cache.GetTernaryQueryEngine(f);
+    XLS_ASSERT_OK(qe->Populate(f).status());
+    EXPECT_EQ(qe->ToString(y.node()), "0b1000_00XX");
+  }
+  EXPECT_EQ(cache.builds(), 1);
+  EXPECT_EQ(cache.reuses(), 1);
+
+  // The incrementally updated results match a fresh engine.
+  TernaryQueryEngine fresh;
+  XLS_ASSERT_OK(fresh.Populate(f).status());
+  std::unique_ptr<QueryEngine> qe = cache.GetTernaryQueryEngine(f);
+  XLS_ASSERT_OK(qe->Populate(f).status());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(qe->ToString(node), fresh.ToString(node)) << node;
+  }
+}
+
+TEST_F(QueryEngineCacheTest, DeletedNodesAreForgotten) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue dead = fb.Not(x);
+  fb.Identity(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  std::unique_ptr<QueryEngine> qe = cache.GetTernaryQueryEngine(f);
+  XLS_ASSERT_OK(qe->Populate(f).status());
+  EXPECT_TRUE(qe->IsTracked(dead.node()));
+  XLS_ASSERT_OK(f->RemoveNode(dead.node()));
+  EXPECT_FALSE(qe->IsTracked(dead.node()));
+  XLS_ASSERT_OK(qe->Populate(f).status());
+  EXPECT_TRUE(qe->IsTracked(x.node()));
+}
+
+TEST_F(QueryEngineCacheTest, BddEngineRebuiltOnlyOnChange) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(1));
+  BValue y = fb.Param("y", p->GetBitsType(1));
+  fb.And(x, fb.Not(x));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  for (int i = 0; i < 3; ++i) {
+    std::unique_ptr<QueryEngine> qe =
+        cache.GetBddQueryEngine(f, BddFunction::kDefaultPathLimit);
+    XLS_ASSERT_OK(qe->Populate(f).status());
+    EXPECT_TRUE(qe->IsAllZeros(f->return_value()));
+  }
+  EXPECT_EQ(cache.builds(), 1);
+  EXPECT_EQ(cache.reuses(), 2);
+
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(1, y.node()));
+  std::unique_ptr<QueryEngine> qe =
+      cache.GetBddQueryEngine(f, BddFunction::kDefaultPathLimit);
+  XLS_ASSERT_OK(qe->Populate(f).status());
+  EXPECT_FALSE(qe->IsAllZeros(f->return_value()));
+  EXPECT_EQ(cache.builds(), 2);
+}
+
+TEST_F(QueryEngineCacheTest, FunctionRemovedFromPackage) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  fb.Param("x", p->GetBitsType(8));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK(cache.GetTernaryQueryEngine(f)->Populate(f).status());
+  XLS_ASSERT_OK(p->RemoveFunction(f));
+  EXPECT_TRUE(p->functions().empty());
+}
+
+TEST_F(QueryEngineCacheTest, AnalysesRecomputedOnlyOnChange) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  fb.Negate(sum);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const PostDominatorAnalysis> first,
+      cache.GetPostDominatorAnalysis(f));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const PostDominatorAnalysis> second,
+      cache.GetPostDominatorAnalysis(f));
+  EXPECT_EQ(first, second);
+  EXPECT_TRUE(first->NodeIsPostDominatedBy(x.node(), sum.node()));
+  EXPECT_EQ(cache.builds(), 1);
+  EXPECT_EQ(cache.reuses(), 1);
+
+  XLS_ASSERT_OK(f->return_value()->ReplaceOperandNumber(0, x.node()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const PostDominatorAnalysis> third,
+      cache.GetPostDominatorAnalysis(f));
+  EXPECT_NE(third, first);
+  EXPECT_FALSE(third->NodeIsPostDominatedBy(x.node(), sum.node()));
+  EXPECT_EQ(cache.builds(), 2);
+}
+
+TEST_F(QueryEngineCacheTest, PreservedAnalysesSurviveChanges) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue dead = fb.Not(x);
+  fb.Identity(x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const BitProvenanceAnalysis> provenance,
+      cache.GetBitProvenanceAnalysis(f));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const PostDominatorAnalysis> post_dominators,
+      cache.GetPostDominatorAnalysis(f));
+  {
+    QueryEngineCache::PreservationScope scope(
+        &cache, f,
+        PreservedAnalyses::None().Preserve(AnalysisKind::kBitProvenance));
+    XLS_ASSERT_OK(f->RemoveNode(dead.node()));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const BitProvenanceAnalysis> preserved_provenance,
+      cache.GetBitProvenanceAnalysis(f));
+  EXPECT_EQ(preserved_provenance, provenance);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const PostDominatorAnalysis> new_post_dominators,
+      cache.GetPostDominatorAnalysis(f));
+  EXPECT_NE(new_post_dominators, post_dominators);
+
+  // Adding nodes invalidates even preserved analyses.
+  {
+    QueryEngineCache::PreservationScope scope(&cache, f,
+                                              PreservedAnalyses::All());
+    XLS_ASSERT_OK(f->MakeNode<UnOp>(SourceInfo(), x.node(), Op::kNeg).status());
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::shared_ptr<const BitProvenanceAnalysis> new_provenance,
+      cache.GetBitProvenanceAnalysis(f));
+  EXPECT_NE(new_provenance, provenance);
+}
+
+TEST_F(QueryEngineCacheTest, ChangedNodesAreRecordedPerClient) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue neg = fb.Negate(x);
+  BValue sum = fb.Add(neg, y);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  QueryEngineCache cache;
+  EXPECT_EQ(cache.TakeChangedNodes(f, "a"), std::nullopt);
+  EXPECT_THAT(cache.TakeChangedNodes(f, "a"), Optional(IsEmpty()));
+
+  // `sum` changes operand; both its old and new operand change users.
+  XLS_ASSERT_OK(sum.node()->ReplaceOperandNumber(0, x.node()));
+  EXPECT_EQ(cache.TakeChangedNodes(f, "b"), std::nullopt);
+  EXPECT_THAT(cache.TakeChangedNodes(f, "a"),
+              Optional(UnorderedElementsAre(sum.node(), neg.node(), x.node(),
+                                            y.node())));
+  EXPECT_THAT(cache.TakeChangedNodes(f, "a"), Optional(IsEmpty()));
+
+  // Deleted nodes are dropped; their operands lose a user.
+  XLS_ASSERT_OK(f->RemoveNode(neg.node()));
+  EXPECT_THAT(cache.TakeChangedNodes(f, "a"),
+              Optional(UnorderedElementsAre(x.node())));
+  EXPECT_THAT(cache.TakeChangedNodes(f, "b"),
+              Optional(UnorderedElementsAre(x.node())));
+
+  cache.ResetChangedNodes(f, "b");
+  EXPECT_EQ(cache.TakeChangedNodes(f, "b"), std::nullopt);
+}
+
+}  // namespace
+}  // namespace xls
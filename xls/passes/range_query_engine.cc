@@ -99,7 +99,8 @@ class RangeQueryVisitor : public DfsVisitor {
         engine_->known_bit_values_[node] =
             ternary_ops::ToKnownBitsValues(*memoized_result->ternary);
       }
-      engine_->interval_sets_[node] = memoized_result->interval_set;
+      engine_->interval_sets_[node] =
+          CopyOnWriteIntervalSetTree(std::move(memoized_result->interval_set));
       return true;
     }
     return false;
@@ -149,7 +150,9 @@ class RangeQueryVisitor : public DfsVisitor {
   }
 
   // Wrapper around engine_->SetIntervalSetTree that modifies rf_ if necessary.
-  void SetIntervalSetTree(Node* node, const IntervalSetTree& interval_sets) {
+  // Accepts an IntervalSetTree or a CopyOnWriteIntervalSetTree.
+  template <typename IntervalSetTreeT>
+  void SetIntervalSetTree(Node* node, IntervalSetTreeT&& interval_sets) {
     if (!engine_->interval_sets_.contains(node)) {
       for (const IntervalSet& set : interval_sets.elements()) {
         if (!set.IsMaximal()) {
@@ -157,45 +160,36 @@ class RangeQueryVisitor : public DfsVisitor {
           break;
         }
       }
-      engine_->SetIntervalSetTree(node, interval_sets);
+      engine_->SetIntervalSetTree(
+          node, std::forward<IntervalSetTreeT>(interval_sets));
       return;
     }
 
     // In the event of a hash collision, it is possible that this could report
     // having reached a fixed point when it hasn't actually. However, this is
     // fairly harmless and very unlikely.
-    size_t hash_before =
-        absl::Hash<IntervalSetTree>()(engine_->interval_sets_.at(node));
-    engine_->SetIntervalSetTree(node, interval_sets);
-    size_t hash_after =
-        absl::Hash<IntervalSetTree>()(engine_->interval_sets_.at(node));
+    size_t hash_before = absl::Hash<CopyOnWriteIntervalSetTree>()(
+        engine_->interval_sets_.at(node));
+    engine_->SetIntervalSetTree(node,
+                                std::forward<IntervalSetTreeT>(interval_sets));
+    size_t hash_after = absl::Hash<CopyOnWriteIntervalSetTree>()(
+        engine_->interval_sets_.at(node));
     if (!(hash_before == hash_after)) {
       rf_ = ReachedFixpoint::Changed;
     }
   }
-  void SetIntervalSetTree(Node* node, IntervalSetTree&& interval_sets) {
-    if (!engine_->interval_sets_.contains(node)) {
-      for (const IntervalSet& set : interval_sets.elements()) {
-        if (!set.IsMaximal()) {
-          rf_ = ReachedFixpoint::Changed;
-          break;
-        }
-      }
-      engine_->SetIntervalSetTree(node, std::move(interval_sets));
-      return;
-    }
 
-    // In the event of a hash collision, it is possible that this could report
-    // having reached a fixed point when it hasn't actually. However, this is
-    // fairly harmless and very unlikely.
-    size_t hash_before =
-        absl::Hash<IntervalSetTree>()(engine_->interval_sets_.at(node));
-    engine_->SetIntervalSetTree(node, std::move(interval_sets));
-    size_t hash_after =
-        absl::Hash<IntervalSetTree>()(engine_->interval_sets_.at(node));
-    if (!(hash_before == hash_after)) {
-      rf_ = ReachedFixpoint::Changed;
+  // Sets the intervals of `node` to (the subtree at `index` of) those of
+  // `source`, sharing their storage. Returns false (and does nothing) if
+  // `source` has no explicit intervals.
+  bool ShareIntervalSetTree(Node* node, Node* source,
+                            absl::Span<const int64_t> index = {}) {
+    auto it = engine_->interval_sets_.find(source);
+    if (it == engine_->interval_sets_.end()) {
+      return false;
     }
+    SetIntervalSetTree(node, it->second.Subtree(index));
+    return true;
   }
 
   absl::Status SetIntervalSet(Node* node, IntervalSet is) {
@@ -300,50 +294,59 @@ absl::StatusOr<ReachedFixpoint> RangeQueryEngine::PopulateWithGivens(
 
 IntervalSetTree RangeQueryEngine::GetIntervalSetTree(Node* node) const {
   if (interval_sets_.contains(node)) {
-    return interval_sets_.at(node);
+    return interval_sets_.at(node).ToOwned();
   }
   return UnconstrainedIntervalSetTree(node->GetType());
 }
 
 void RangeQueryEngine::SetIntervalSetTree(
     Node* node, const IntervalSetTree& interval_sets) {
-  auto [it, inserted] = interval_sets_.try_emplace(node, interval_sets);
-  MutableIntervalSetTreeView ist = it->second.AsMutableView();
-
-  if (!inserted) {
+  auto it = interval_sets_.find(node);
+  if (it == interval_sets_.end()) {
+    interval_sets_.emplace(node, CopyOnWriteIntervalSetTree(interval_sets));
+  } else {
     // We already had information for `node`; merge with `interval_sets`.
-    leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
-        ist, interval_sets.AsView(),
-        [](IntervalSet& lhs, const IntervalSet& rhs) {
-          lhs = IntervalSet::Intersect(lhs, rhs);
-        });
-  }
-
-  if (node->GetType()->IsBits()) {
-    interval_ops::KnownBits bits =
-        interval_ops::ExtractKnownBits(ist.Get({}), /*source=*/node);
-    known_bits_[node] = bits.known_bits;
-    known_bit_values_[node] = bits.known_bit_values;
+    IntersectIntervalSetTree(it->second, interval_sets.AsView());
   }
+  UpdateKnownBits(node);
 }
 
 void RangeQueryEngine::SetIntervalSetTree(Node* node,
                                           IntervalSetTree&& interval_sets) {
-  auto [it, inserted] = interval_sets_.try_emplace(node, interval_sets);
-  MutableIntervalSetTreeView ist = it->second.AsMutableView();
+  auto it = interval_sets_.find(node);
+  if (it == interval_sets_.end()) {
+    interval_sets_.emplace(
+        node, CopyOnWriteIntervalSetTree(std::move(interval_sets)));
+  } else {
+    IntersectIntervalSetTree(it->second, interval_sets.AsView());
+  }
+  UpdateKnownBits(node);
+}
 
-  if (!inserted) {
-    // We already had information for `node`; merge with `interval_sets`.
-    leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
-        ist, interval_sets.AsView(),
-        [](IntervalSet& lhs, const IntervalSet& rhs) {
-          lhs = IntervalSet::Intersect(lhs, rhs);
-        });
+void RangeQueryEngine::SetIntervalSetTree(
+    Node* node, CopyOnWriteIntervalSetTree interval_sets) {
+  auto it = interval_sets_.find(node);
+  if (it == interval_sets_.end()) {
+    interval_sets_.emplace(node, std::move(interval_sets));
+  } else if (it->second != interval_sets) {
+    IntersectIntervalSetTree(it->second, interval_sets.AsView());
   }
+  UpdateKnownBits(node);
+}
 
+void RangeQueryEngine::IntersectIntervalSetTree(
+    CopyOnWriteIntervalSetTree& tree, IntervalSetTreeView other) {
+  leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
+      tree.AsMutableView(), other,
+      [](IntervalSet& lhs, const IntervalSet& rhs) {
+        lhs = IntervalSet::Intersect(lhs, rhs);
+      });
+}
+
+void RangeQueryEngine::UpdateKnownBits(Node* node) {
   if (node->GetType()->IsBits()) {
-    interval_ops::KnownBits bits =
-        interval_ops::ExtractKnownBits(ist.Get({}), /*source=*/node);
+    interval_ops::KnownBits bits = interval_ops::ExtractKnownBits(
+        interval_sets_.at(node).Get({}), /*source=*/node);
     known_bits_[node] = bits.known_bits;
     known_bit_values_[node] = bits.known_bit_values;
   }
@@ -575,7 +578,10 @@ absl::Status RangeQueryVisitor::HandleGate(Gate* gate) {
 
 absl::Status RangeQueryVisitor::HandleIdentity(UnOp* identity) {
   INITIALIZE_OR_SKIP(identity);
-  SetIntervalSetTree(identity, GetIntervalSetTree(identity->operand(0)));
+  if (!ShareIntervalSetTree(identity, identity->operand(0))) {
+    SetIntervalSetTree(identity,
+                       UnconstrainedIntervalSetTree(identity->GetType()));
+  }
   return absl::OkStatus();
 }
 
@@ -630,7 +636,10 @@ absl::Status RangeQueryVisitor::HandleArrayIndex(ArrayIndex* array_index) {
   INITIALIZE_OR_SKIP(array_index);
 
   if (array_index->indices().empty()) {
-    SetIntervalSetTree(array_index, GetIntervalSetTree(array_index->array()));
+    if (!ShareIntervalSetTree(array_index, array_index->array())) {
+      SetIntervalSetTree(array_index,
+                         UnconstrainedIntervalSetTree(array_index->GetType()));
+    }
     return absl::OkStatus();
   }
 
@@ -669,6 +678,22 @@ absl::Status RangeQueryVisitor::HandleArrayIndex(ArrayIndex* array_index) {
     }
   }
 
+  if (absl::c_all_of(index_intervals,
+                     [](const IntervalSet& is) { return is.IsPrecise(); })) {
+    // Exactly one element is selected; share it rather than copying it.
+    std::vector<int64_t> element_index;
+    element_index.reserve(index_intervals.size());
+    for (int64_t i = 0; i < index_intervals.size(); ++i) {
+      Bits index = *index_intervals[i].GetPreciseValue();
+      // Out-of-bounds indices are clamped to the last element.
+      element_index.push_back(bits_ops::UGreaterThanOrEqual(index, dimension[i])
+                                  ? dimension[i] - 1
+                                  : static_cast<int64_t>(*index.ToUint64()));
+    }
+    ShareIntervalSetTree(array_index, array_index->array(), element_index);
+    return absl::OkStatus();
+  }
+
   IntervalSetTree result = EmptyIntervalSetTree(array_index->GetType());
 
   // Returns true if the given interval set covers the given index value for an
@@ -787,8 +812,10 @@ absl::Status RangeQueryVisitor::HandleArrayUpdate(ArrayUpdate* update) {
           *index_lb >=
               static_cast<uint64_t>(indexed_type->AsArrayOrDie()->size())) {
         // Definitely an out-of-bounds access, so no change.
-        SetIntervalSetTree(update,
-                           GetIntervalSetTree(update->array_to_update()));
+        if (!ShareIntervalSetTree(update, update->array_to_update())) {
+          SetIntervalSetTree(update,
+                             UnconstrainedIntervalSetTree(update->GetType()));
+        }
         return absl::OkStatus();
       }
 
@@ -1309,12 +1336,7 @@ absl::Status RangeQueryVisitor::HandleTuple(Tuple* tuple) {
 
 absl::Status RangeQueryVisitor::HandleTupleIndex(TupleIndex* index) {
   INITIALIZE_OR_SKIP(index);
-  if (std::optional<IntervalSetTreeView> view =
-          MaybeGetIntervalSetTreeView(index->operand(0));
-      view.has_value()) {
-    SetIntervalSetTree(index,
-                       leaf_type_tree::Clone(view->AsView({index->index()})));
-  }
+  ShareIntervalSetTree(index, index->operand(0), {index->index()});
   // If we don't have any explicit ranges for the tuple there's nothing for the
   // index either.
   return absl::OkStatus();
@@ -42,6 +42,7 @@ namespace xls {
 using IntervalSetTree = LeafTypeTree<IntervalSet>;
 using IntervalSetTreeView = LeafTypeTreeView<IntervalSet>;
 using MutableIntervalSetTreeView = MutableLeafTypeTreeView<IntervalSet>;
+using CopyOnWriteIntervalSetTree = CopyOnWriteLeafTypeTree<IntervalSet>;
 
 class RangeQueryVisitor;
 
@@ -230,6 +231,9 @@ class RangeQueryEngine : public QueryEngine {
   // node you defined.
   void SetIntervalSetTree(Node* node, const IntervalSetTree& interval_sets);
   void SetIntervalSetTree(Node* node, IntervalSetTree&& interval_sets);
+  // As above, but the node's intervals share storage with `interval_sets`
+  // until either is modified.
+  void SetIntervalSetTree(Node* node, CopyOnWriteIntervalSetTree interval_sets);
 
   // Initialize a node's known bits.
   // This must be called before `SetIntervalSetTree`.
@@ -241,9 +245,17 @@ class RangeQueryEngine : public QueryEngine {
  private:
   friend class RangeQueryVisitor;
 
+  // Intersects `tree` with `other` in place, unsharing `tree` if needed.
+  static void IntersectIntervalSetTree(CopyOnWriteIntervalSetTree& tree,
+                                       IntervalSetTreeView other);
+  // Recomputes the known bits of `node` from its interval set.
+  void UpdateKnownBits(Node* node);
+
   absl::flat_hash_map<Node*, Bits> known_bits_;
   absl::flat_hash_map<Node*, Bits> known_bit_values_;
-  absl::flat_hash_map<Node*, IntervalSetTree> interval_sets_;
+  // Interval sets are copy-on-write, so nodes which forward (part of) an
+  // operand's value share its storage.
+  absl::flat_hash_map<Node*, CopyOnWriteIntervalSetTree> interval_sets_;
 };
 
 std::string IntervalSetTreeToString(const IntervalSetTree& tree);
@@ -0,0 +1,328 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/rewrite_rules.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+
+namespace xls {
+
+RewritePattern RewritePattern::Any(std::string_view capture) {
+  RewritePattern pattern;
+  pattern.capture_ = std::string(capture);
+  return pattern;
+}
+
+RewritePattern RewritePattern::Of(Op op) {
+  RewritePattern pattern;
+  pattern.op_ = op;
+  return pattern;
+}
+
+RewritePattern RewritePattern::Of(Op op, std::vector<RewritePattern> operands) {
+  RewritePattern pattern;
+  pattern.op_ = op;
+  pattern.operands_ = std::move(operands);
+  return pattern;
+}
+
+RewritePattern RewritePattern::Literal(std::string_view capture) {
+  return Of(Op::kLiteral).Capture(capture);
+}
+
+RewritePattern RewritePattern::Capture(std::string_view capture) const {
+  RewritePattern pattern = *this;
+  pattern.capture_ = std::string(capture);
+  return pattern;
+}
+
+RewritePattern RewritePattern::Where(Predicate predicate) const {
+  RewritePattern pattern = *this;
+  pattern.predicates_.push_back(std::move(predicate));
+  return pattern;
+}
+
+Node* RewriteMatch::operator[](std::string_view capture) const {
+  auto it = captures_.find(capture);
+  CHECK(it != captures_.end()) << "No capture named " << capture;
+  return it->second;
+}
+
+namespace {
+
+// A single test of the node at `path`, the sequence of operand indices leading
+// from the root of the match to the node.
+struct Check {
+  enum class Kind {
+    // The node has op `op` and, if given, `operand_count` operands.
+    kOp,
+    // `predicate` holds for the node.
+    kPredicate,
+    // The node is bound to `capture`, or is the node `capture` is already
+    // bound to.
+    kCapture,
+  };
+
+  Kind kind;
+  std::vector<int64_t> path;
+  Op op = Op::kLiteral;
+  std::optional<int64_t> operand_count;
+  int64_t predicate_id = -1;
+  RewritePattern::Predicate predicate;
+  std::string capture;
+
+  // Returns whether this check always gives the same result as `other`, so
+  // both may be represented by the same decision tree edge.
+  bool SameAs(const Check& other) const {
+    if (kind != other.kind || path != other.path) {
+      return false;
+    }
+    switch (kind) {
+      case Kind::kOp:
+        return op == other.op && operand_count == other.operand_count;
+      case Kind::kPredicate:
+        return predicate_id == other.predicate_id;
+      case Kind::kCapture:
+        return capture == other.capture;
+    }
+    return false;
+  }
+};
+
+// Appends the checks of `pattern` (rooted at `path`) to `ops`, `predicates`
+// and `captures`, visiting the pattern in preorder so every op check comes
+// after the op checks of the nodes above it.
+void FlattenPattern(const RewritePattern& pattern, std::vector<int64_t>& path,
+                    int64_t& next_predicate_id, std::vector<Check>& ops,
+                    std::vector<Check>& predicates,
+                    std::vector<Check>& captures) {
+  if (pattern.op().has_value()) {
+    Check check{.kind = Check::Kind::kOp, .path = path, .op = *pattern.op()};
+    if (pattern.operands().has_value()) {
+      check.operand_count = pattern.operands()->size();
+    }
+    ops.push_back(std::move(check));
+  }
+  for (const RewritePattern::Predicate& predicate : pattern.predicates()) {
+    predicates.push_back(Check{.kind = Check::Kind::kPredicate,
+                               .path = path,
+                               .predicate_id = next_predicate_id++,
+                               .predicate = predicate});
+  }
+  if (!pattern.capture().empty()) {
+    captures.push_back(Check{.kind = Check::Kind::kCapture,
+                             .path = path,
+                             .capture = pattern.capture()});
+  }
+  if (pattern.operands().has_value()) {
+    for (int64_t i = 0; i < pattern.operands()->size(); ++i) {
+      path.push_back(i);
+      FlattenPattern(pattern.operands()->at(i), path, next_predicate_id, ops,
+                     predicates, captures);
+      path.pop_back();
+    }
+  }
+}
+
+// Returns the node reached by following `path` from `root`, or nullptr if the
+// path does not exist.
+Node* Resolve(Node* root, const std::vector<int64_t>& path) {
+  Node* node = root;
+  for (int64_t index : path) {
+    if (index >= node->operand_count()) {
+      return nullptr;
+    }
+    node = node->operand(index);
+  }
+  return node;
+}
+
+}  // namespace
+
+// A node of the decision tree. Reaching a node means all the checks on the
+// way from the root passed; the rules in `accepting_rules` match at that
+// point.
+struct RewriteRuleSet::DecisionNode {
+  std::vector<std::pair<Check, std::unique_ptr<DecisionNode>>> children;
+  std::vector<int64_t> accepting_rules;
+};
+
+RewriteRuleSet::RewriteRuleSet() = default;
+RewriteRuleSet::~RewriteRuleSet() = default;
+RewriteRuleSet::RewriteRuleSet(RewriteRuleSet&&) = default;
+RewriteRuleSet& RewriteRuleSet::operator=(RewriteRuleSet&&) = default;
+
+absl::Status RewriteRuleSet::AddRule(std::string_view name,
+                                     const RewritePattern& pattern,
+                                     RewriteFn rewrite) {
+  if (!pattern.op().has_value()) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "The pattern of rewrite rule `%s` must specify a root op", name));
+  }
+  if (!rule_names_.insert(std::string(name)).second) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Duplicate rewrite rule `%s`", name));
+  }
+
+  std::vector<Check> checks;
+  std::vector<Check> predicates;
+  std::vector<Check> captures;
+  std::vector<int64_t> path;
+  FlattenPattern(pattern, path, next_predicate_id_, checks, predicates,
+                 captures);
+  // Structural checks first since they are the cheapest and the most likely
+  // to be shared, then captures, which may reject repeated captures, and the
+  // predicates last.
+  checks.insert(checks.end(), std::make_move_iterator(captures.begin()),
+                std::make_move_iterator(captures.end()));
+  checks.insert(checks.end(), std::make_move_iterator(predicates.begin()),
+                std::make_move_iterator(predicates.end()));
+
+  std::unique_ptr<DecisionNode>& root = roots_[*pattern.op()];
+  if (root == nullptr) {
+    root = std::make_unique<DecisionNode>();
+  }
+  DecisionNode* node = root.get();
+  for (Check& check : checks) {
+    auto it = std::find_if(
+        node->children.begin(), node->children.end(),
+        [&](const auto& child) { return child.first.SameAs(check); });
+    if (it == node->children.end()) {
+      node->children.emplace_back(std::move(check),
+                                  std::make_unique<DecisionNode>());
+      it = std::prev(node->children.end());
+    }
+    node = it->second.get();
+  }
+  node->accepting_rules.push_back(rules_.size());
+  rules_.push_back(
+      Rule{.name = std::string(name), .rewrite = std::move(rewrite)});
+  return absl::OkStatus();
+}
+
+std::vector<std::pair<int64_t, RewriteMatch>> RewriteRuleSet::Match(
+    Node* node) const {
+  std::vector<std::pair<int64_t, RewriteMatch>> matches;
+  auto root = roots_.find(node->op());
+  if (root == roots_.end()) {
+    return matches;
+  }
+
+  RewriteMatch current(node);
+  auto visit = [&](auto& self, const DecisionNode& decision) -> void {
+    for (int64_t rule : decision.accepting_rules) {
+      matches.emplace_back(rule, current);
+    }
+    for (const auto& [check, child] : decision.children) {
+      Node* target = Resolve(node, check.path);
+      if (target == nullptr) {
+        continue;
+      }
+      switch (check.kind) {
+        case Check::Kind::kOp:
+          if (target->op() == check.op &&
+              (!check.operand_count.has_value() ||
+               target->operand_count() == *check.operand_count)) {
+            self(self, *child);
+          }
+          break;
+        case Check::Kind::kPredicate:
+          if (check.predicate(target)) {
+            self(self, *child);
+          }
+          break;
+        case Check::Kind::kCapture: {
+          auto [it, inserted] =
+              current.mutable_captures().try_emplace(check.capture, target);
+          if (inserted) {
+            self(self, *child);
+            current.mutable_captures().erase(check.capture);
+          } else if (it->second == target) {
+            self(self, *child);
+          }
+          break;
+        }
+      }
+    }
+  };
+  visit(visit, *root->second);
+
+  std::stable_sort(
+      matches.begin(), matches.end(),
+      [](const auto& a, const auto& b) { return a.first < b.first; });
+  return matches;
+}
+
+std::vector<std::string> RewriteRuleSet::MatchingRules(Node* node) const {
+  std::vector<std::string> names;
+  for (const auto& [rule, match] : Match(node)) {
+    names.push_back(rules_[rule].name);
+  }
+  return names;
+}
+
+absl::StatusOr<bool> RewriteRuleSet::Apply(FunctionBase* f) const {
+  bool changed = false;
+  for (Node* node : TopoSort(f)) {
+    if (node->IsDead() || !roots_.contains(node->op())) {
+      continue;
+    }
+    for (const auto& [rule_index, match] : Match(node)) {
+      const Rule& rule = rules_[rule_index];
+      XLS_ASSIGN_OR_RETURN(std::optional<Node*> replacement,
+                           rule.rewrite(match));
+      if (!replacement.has_value() || *replacement == node) {
+        continue;
+      }
+      VLOG(3) << absl::StreamFormat("Rule `%s` rewrites %s to %s", rule.name,
+                                    node->GetName(),
+                                    (*replacement)->GetName());
+      XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(*replacement));
+      ++rule.fire_count;
+      changed = true;
+      break;
+    }
+  }
+  return changed;
+}
+
+absl::flat_hash_map<std::string, int64_t> RewriteRuleSet::FireCounts() const {
+  absl::flat_hash_map<std::string, int64_t> counts;
+  for (const Rule& rule : rules_) {
+    counts[rule.name] = rule.fire_count;
+  }
+  return counts;
+}
+
+}  // namespace xls
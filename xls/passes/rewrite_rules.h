@@ -0,0 +1,173 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_REWRITE_RULES_H_
+#define XLS_PASSES_REWRITE_RULES_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+// A declarative description of a tree of IR nodes. For example (with the
+// `RewritePattern::` qualifiers elided)
+//
+//   Of(Op::kNot, {Of(Op::kNot, {Any("x")})})
+//
+// matches `not(not(x))` and binds the inner operand to the name "x". A
+// pattern which names the same capture more than once only matches if every
+// occurrence is the same node, so `Of(Op::kXor, {Any("x"), Any("x")})` matches
+// `xor(a, a)` but not `xor(a, b)`.
+class RewritePattern {
+ public:
+  using Predicate = std::function<bool(Node*)>;
+
+  // Matches any node, binding it to `capture` if it is non-empty.
+  static RewritePattern Any(std::string_view capture = "");
+
+  // Matches a node with the given op and any operands.
+  static RewritePattern Of(Op op);
+
+  // Matches a node with the given op which has exactly as many operands as
+  // `operands`, each matching the respective pattern.
+  static RewritePattern Of(Op op, std::vector<RewritePattern> operands);
+
+  // Matches a literal node.
+  static RewritePattern Literal(std::string_view capture = "");
+
+  // Returns a copy of this pattern which binds the matched node to `capture`.
+  RewritePattern Capture(std::string_view capture) const;
+
+  // Returns a copy of this pattern which additionally requires `predicate` to
+  // hold for the matched node.
+  RewritePattern Where(Predicate predicate) const;
+
+  std::optional<Op> op() const { return op_; }
+  const std::optional<std::vector<RewritePattern>>& operands() const {
+    return operands_;
+  }
+  const std::string& capture() const { return capture_; }
+  const std::vector<Predicate>& predicates() const { return predicates_; }
+
+ private:
+  std::optional<Op> op_;
+  std::optional<std::vector<RewritePattern>> operands_;
+  std::string capture_;
+  std::vector<Predicate> predicates_;
+};
+
+// The result of matching a rule's pattern against a node.
+class RewriteMatch {
+ public:
+  explicit RewriteMatch(Node* root) : root_(root) {}
+
+  // The node matched by the root of the pattern.
+  Node* root() const { return root_; }
+
+  // Returns the node bound to `capture`. The capture must exist in the rule's
+  // pattern.
+  Node* operator[](std::string_view capture) const;
+
+  const absl::flat_hash_map<std::string, Node*>& captures() const {
+    return captures_;
+  }
+  absl::flat_hash_map<std::string, Node*>& mutable_captures() {
+    return captures_;
+  }
+
+ private:
+  Node* root_;
+  absl::flat_hash_map<std::string, Node*> captures_;
+};
+
+// Builds the replacement for a matched node. Returning std::nullopt declines
+// the rewrite, in which case the next matching rule (if any) is tried.
+using RewriteFn =
+    std::function<absl::StatusOr<std::optional<Node*>>(const RewriteMatch&)>;
+
+// A set of peephole rewrite rules which are applied together in one sweep
+// over a function.
+//
+// Adding a rule compiles its pattern into a flat sequence of checks on the
+// nodes at fixed operand paths below the root (the op and operand count, the
+// predicates, and the captures). The check sequences of all rules are merged
+// into a decision tree which is indexed by the root op, so checks shared by
+// several rules, such as the ops of the root's operands, are evaluated once
+// per node rather than once per rule. When several rules match a node they
+// are tried in the order they were added.
+class RewriteRuleSet {
+ public:
+  RewriteRuleSet();
+  ~RewriteRuleSet();
+  RewriteRuleSet(RewriteRuleSet&&);
+  RewriteRuleSet& operator=(RewriteRuleSet&&);
+
+  // Adds a rule. The root of `pattern` must specify an op, and `name` must be
+  // unique within the set.
+  absl::Status AddRule(std::string_view name, const RewritePattern& pattern,
+                       RewriteFn rewrite);
+
+  int64_t rule_count() const { return rules_.size(); }
+
+  // Returns the names of the rules whose patterns match `node`, in the order
+  // in which they would be tried.
+  std::vector<std::string> MatchingRules(Node* node) const;
+
+  // Applies the rules to every node of `f` in a single topological sweep,
+  // replacing each node with the result of the first matching rule which
+  // does not decline. Nodes created by a rewrite are not themselves rewritten
+  // in the same sweep. Returns whether anything changed.
+  absl::StatusOr<bool> Apply(FunctionBase* f) const;
+
+  // Returns the number of times each rule fired over the lifetime of the set,
+  // keyed by rule name.
+  absl::flat_hash_map<std::string, int64_t> FireCounts() const;
+
+ private:
+  struct DecisionNode;
+  struct Rule {
+    std::string name;
+    RewriteFn rewrite;
+    // Mutable so Apply() can count firings of a const rule set.
+    mutable int64_t fire_count = 0;
+  };
+
+  // Collects the (rule index, match) pairs for every rule matching `node`,
+  // sorted by rule index.
+  std::vector<std::pair<int64_t, RewriteMatch>> Match(Node* node) const;
+
+  std::vector<Rule> rules_;
+  absl::flat_hash_set<std::string> rule_names_;
+  absl::flat_hash_map<Op, std::unique_ptr<DecisionNode>> roots_;
+  // Unique ids for predicates, which can never be shared between rules.
+  int64_t next_predicate_id_ = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_REWRITE_RULES_H_
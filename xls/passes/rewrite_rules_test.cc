@@ -0,0 +1,172 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/rewrite_rules.h"
+
+#include <optional>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_matcher.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace m = ::xls::op_matchers;
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+using P = RewritePattern;
+
+class RewriteRulesTest : public IrTestBase {};
+
+RewriteFn ReplaceWith(const char* capture) {
+  return [capture](const RewriteMatch& match)
+             -> absl::StatusOr<std::optional<Node*>> {
+    return match[capture];
+  };
+}
+
+RewriteFn Decline() {
+  return [](const RewriteMatch&) -> absl::StatusOr<std::optional<Node*>> {
+    return std::nullopt;
+  };
+}
+
+TEST_F(RewriteRulesTest, MatchesNestedPattern) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue single = fb.Not(x);
+  BValue twice = fb.Not(single);
+  XLS_ASSERT_OK(fb.Build().status());
+
+  RewriteRuleSet rules;
+  XLS_ASSERT_OK(rules.AddRule(
+      "double_not", P::Of(Op::kNot, {P::Of(Op::kNot, {P::Any("x")})}),
+      ReplaceWith("x")));
+  EXPECT_THAT(rules.MatchingRules(twice.node()), ElementsAre("double_not"));
+  EXPECT_THAT(rules.MatchingRules(single.node()), IsEmpty());
+  EXPECT_THAT(rules.MatchingRules(x.node()), IsEmpty());
+}
+
+TEST_F(RewriteRulesTest, RepeatedCaptureMustBeSameNode) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(8));
+  BValue b = fb.Param("b", p->GetBitsType(8));
+  BValue same = fb.Xor(a, a);
+  BValue different = fb.Xor(a, b);
+  BValue three = fb.Xor({a, a, a});
+  XLS_ASSERT_OK(fb.Build().status());
+
+  RewriteRuleSet rules;
+  XLS_ASSERT_OK(rules.AddRule(
+      "xor_self", P::Of(Op::kXor, {P::Any("x"), P::Any("x")}), Decline()));
+  XLS_ASSERT_OK(rules.AddRule("xor_any", P::Of(Op::kXor), Decline()));
+  EXPECT_THAT(rules.MatchingRules(same.node()),
+              ElementsAre("xor_self", "xor_any"));
+  EXPECT_THAT(rules.MatchingRules(different.node()), ElementsAre("xor_any"));
+  // The operand count is part of the pattern.
+  EXPECT_THAT(rules.MatchingRules(three.node()), ElementsAre("xor_any"));
+}
+
+TEST_F(RewriteRulesTest, PredicatesFilterMatches) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue add_zero = fb.Add(x, fb.Literal(UBits(0, 8)));
+  BValue add_one = fb.Add(x, fb.Literal(UBits(1, 8)));
+  XLS_ASSERT_OK(fb.Build().status());
+
+  RewriteRuleSet rules;
+  XLS_ASSERT_OK(rules.AddRule(
+      "add_zero",
+      P::Of(Op::kAdd, {P::Any("x"), P::Literal().Where([](Node* n) {
+                         return n->As<Literal>()->value().IsAllZeros();
+                       })}),
+      ReplaceWith("x")));
+  EXPECT_THAT(rules.MatchingRules(add_zero.node()), ElementsAre("add_zero"));
+  EXPECT_THAT(rules.MatchingRules(add_one.node()), IsEmpty());
+}
+
+TEST_F(RewriteRulesTest, DecliningRuleFallsThroughToNextRule) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  fb.Not(fb.Not(x));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  RewriteRuleSet rules;
+  XLS_ASSERT_OK(rules.AddRule(
+      "declines", P::Of(Op::kNot, {P::Of(Op::kNot, {P::Any("y")})}),
+      Decline()));
+  XLS_ASSERT_OK(rules.AddRule(
+      "double_not", P::Of(Op::kNot, {P::Of(Op::kNot, {P::Any("x")})}),
+      ReplaceWith("x")));
+  EXPECT_THAT(rules.Apply(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Param("x"));
+  EXPECT_THAT(rules.FireCounts(),
+              UnorderedElementsAre(Pair("declines", 0), Pair("double_not", 1)));
+}
+
+TEST_F(RewriteRulesTest, AppliesAllRulesInOneSweep) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  fb.Tuple({fb.Not(fb.Not(fb.Not(fb.Not(x)))), fb.Negate(fb.Negate(y))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  RewriteRuleSet rules;
+  XLS_ASSERT_OK(rules.AddRule(
+      "double_not", P::Of(Op::kNot, {P::Of(Op::kNot, {P::Any("x")})}),
+      ReplaceWith("x")));
+  XLS_ASSERT_OK(rules.AddRule(
+      "double_neg", P::Of(Op::kNeg, {P::Of(Op::kNeg, {P::Any("x")})}),
+      ReplaceWith("x")));
+  EXPECT_THAT(rules.Apply(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Tuple(m::Param("x"), m::Param("y")));
+  EXPECT_THAT(rules.Apply(f), IsOkAndHolds(false));
+}
+
+TEST_F(RewriteRulesTest, InvalidRules) {
+  RewriteRuleSet rules;
+  EXPECT_THAT(rules.AddRule("any", P::Any("x"), Decline()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  XLS_ASSERT_OK(rules.AddRule("not", P::Of(Op::kNot), Decline()));
+  EXPECT_THAT(rules.AddRule("not", P::Of(Op::kNeg), Decline()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(rules.rule_count(), 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,229 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/sat_sweeping_pass.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/optimization_pass_registry.h"
+#include "xls/passes/pass_base.h"
+#include "xls/passes/simulation_signatures.h"
+#include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_utils.h"
+#include "z3/src/api/z3.h"  // IWYU pragma: keep
+#include "z3/src/api/z3_api.h"
+
+namespace xls {
+
+namespace {
+
+// Nodes can only be equivalent if they have the same width and the same
+// simulation signature.
+using ClassKey = std::pair<int64_t, uint64_t>;
+
+// Incrementally checks equivalences between nodes of a single translated
+// function.
+class EquivalenceProver {
+ public:
+  explicit EquivalenceProver(
+      std::unique_ptr<solvers::z3::IrTranslator> translator)
+      : translator_(std::move(translator)),
+        ctx_(translator_->ctx()),
+        solver_(solvers::z3::CreateSolver(ctx_, /*num_threads=*/1)) {}
+  ~EquivalenceProver() { Z3_solver_dec_ref(ctx_, solver_); }
+
+  // Returns whether `a` and `b` are equal for all inputs. If they are not,
+  // `on_counterexample` is called with a model in which they differ. Queries
+  // which exceed the resource limit return false without a model.
+  template <typename F>
+  bool ProveEqual(Node* a, Node* b, F on_counterexample) {
+    Z3_solver_push(ctx_, solver_);
+    auto pop = absl::Cleanup([&] { Z3_solver_pop(ctx_, solver_, 1); });
+    Z3_ast equal = Z3_mk_eq(ctx_, Translate(a), Translate(b));
+    Z3_solver_assert(ctx_, solver_, Z3_mk_not(ctx_, equal));
+    switch (Z3_solver_check(ctx_, solver_)) {
+      case Z3_L_FALSE:
+        return true;
+      case Z3_L_TRUE: {
+        Z3_model model = Z3_solver_get_model(ctx_, solver_);
+        Z3_model_inc_ref(ctx_, model);
+        on_counterexample(model);
+        Z3_model_dec_ref(ctx_, model);
+        return false;
+      }
+      case Z3_L_UNDEF:
+        VLOG(3) << "Equivalence query exceeded its limit: " << a->GetName()
+                << " vs " << b->GetName();
+        return false;
+    }
+    return false;
+  }
+
+  // Records that `a` and `b` are known to be equal, which later queries can
+  // use as a lemma.
+  void AssertEqual(Node* a, Node* b) {
+    Z3_solver_assert(ctx_, solver_,
+                     Z3_mk_eq(ctx_, Translate(a), Translate(b)));
+  }
+
+  // Returns whether `a` and `b` take different values in `model`.
+  bool DifferIn(Z3_model model, Node* a, Node* b) {
+    Z3_ast a_value;
+    Z3_ast b_value;
+    if (!Z3_model_eval(ctx_, model, Translate(a), /*model_completion=*/true,
+                       &a_value) ||
+        !Z3_model_eval(ctx_, model, Translate(b), /*model_completion=*/true,
+                       &b_value)) {
+      return false;
+    }
+    return !Z3_is_eq_ast(ctx_, a_value, b_value);
+  }
+
+ private:
+  Z3_ast Translate(Node* node) { return translator_->GetTranslation(node); }
+
+  std::unique_ptr<solvers::z3::IrTranslator> translator_;
+  Z3_context ctx_;
+  Z3_solver solver_;
+};
+
+}  // namespace
+
+absl::StatusOr<bool> SatSweepingPass::RunOnFunctionBaseInternal(
+    FunctionBase* f, const OptimizationPassOptions& options,
+    PassResults* results) const {
+  XLS_ASSIGN_OR_RETURN((absl::flat_hash_map<Node*, uint64_t> signatures),
+                       ComputeSimulationSignatures(f));
+  std::vector<Node*> order = TopoSort(f);
+
+  // The members of each equivalence class in topological order.
+  absl::flat_hash_map<ClassKey, std::vector<Node*>> classes;
+  absl::flat_hash_map<Node*, ClassKey> class_of;
+  for (Node* node : order) {
+    if (!node->GetType()->IsBits() || node->Is<Literal>()) {
+      continue;
+    }
+    ClassKey key = {node->BitCountOrDie(), signatures.at(node)};
+    classes[key].push_back(node);
+    class_of[node] = key;
+  }
+  absl::erase_if(classes, [](const auto& entry) {
+    return entry.second.size() < 2;
+  });
+  if (classes.empty()) {
+    return false;
+  }
+
+  // Unsupported operations are translated as free variables, which keeps the
+  // proofs sound but means they are never proven equal to anything.
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<solvers::z3::IrTranslator> translator,
+      solvers::z3::IrTranslator::CreateAndTranslate(
+          f, /*allow_unsupported=*/true));
+  translator->SetRlimit(rlimit_per_query_);
+  EquivalenceProver prover(std::move(translator));
+  const absl::Time deadline = absl::Now() + time_budget_;
+
+  // Earlier members of each class which have not been merged into another
+  // node; later members are only compared against these.
+  absl::flat_hash_map<ClassKey, std::vector<Node*>> representatives;
+  // Pairs (representative, later member) shown to differ by a counterexample.
+  absl::flat_hash_set<std::pair<Node*, Node*>> known_different;
+  // Index of each node within its class.
+  absl::flat_hash_map<Node*, int64_t> class_index;
+  for (const auto& [_, members] : classes) {
+    for (int64_t i = 0; i < members.size(); ++i) {
+      class_index[members[i]] = i;
+    }
+  }
+
+  bool changed = false;
+  int64_t query_count = 0;
+  for (Node* node : order) {
+    auto key_it = class_of.find(node);
+    if (key_it == class_of.end() || !classes.contains(key_it->second)) {
+      continue;
+    }
+    const std::vector<Node*>& members = classes.at(key_it->second);
+    std::vector<Node*>& reps = representatives[key_it->second];
+    absl::Span<Node* const> later_members =
+        absl::MakeConstSpan(members).subspan(class_index.at(node) + 1);
+
+    Node* equivalent = nullptr;
+    int64_t queries = 0;
+    for (Node* rep : reps) {
+      if (queries == kMaxQueriesPerNode || absl::Now() >= deadline) {
+        break;
+      }
+      if (known_different.contains({rep, node})) {
+        continue;
+      }
+      ++queries;
+      ++query_count;
+      bool equal = prover.ProveEqual(rep, node, [&](Z3_model model) {
+        // The counterexample separates more than this pair; record every pair
+        // of a representative (or this node) and a later member it separates.
+        for (Node* later : later_members) {
+          for (Node* other : reps) {
+            if (prover.DifferIn(model, other, later)) {
+              known_different.insert({other, later});
+            }
+          }
+          if (prover.DifferIn(model, node, later)) {
+            known_different.insert({node, later});
+          }
+        }
+      });
+      if (equal) {
+        equivalent = rep;
+        break;
+      }
+    }
+
+    if (equivalent == nullptr) {
+      reps.push_back(node);
+      continue;
+    }
+    VLOG(3) << "Proved equivalent: " << node->ToString() << " and "
+            << equivalent->ToString();
+    prover.AssertEqual(equivalent, node);
+    XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(equivalent));
+    changed = true;
+  }
+  VLOG(2) << "SAT sweeping issued " << query_count << " queries on "
+          << f->name();
+
+  return changed;
+}
+
+REGISTER_OPT_PASS(SatSweepingPass);
+
+}  // namespace xls
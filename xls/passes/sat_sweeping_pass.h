@@ -0,0 +1,72 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_SAT_SWEEPING_PASS_H_
+#define XLS_PASSES_SAT_SWEEPING_PASS_H_
+
+#include <cstdint>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/ir/function_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+
+// Pass which merges nodes proven equivalent by a SAT solver, in the style of
+// FRAIG sweeping. Candidate pairs are found by random bit-parallel simulation
+// (see simulation_signatures.h): only nodes with the same simulation signature
+// can be equivalent. Each candidate is compared against the earlier nodes in
+// its class with an incremental Z3 query over the translation of the whole
+// function. Proven equivalences are asserted back into the solver to simplify
+// later queries, and counterexamples are used to rule out other members of the
+// class without querying the solver again.
+//
+// Unlike BddCsePass this is not limited by a BDD path limit, so it can prove
+// equivalences between arithmetic expressions. Queries which exceed the
+// per-query resource limit are treated as not equivalent, and no queries are
+// issued once the time budget is spent.
+class SatSweepingPass : public OptimizationFunctionBasePass {
+ public:
+  static constexpr std::string_view kName = "sat_sweep";
+
+  // Z3 resource limit for each equivalence query. Unlike a timeout this is
+  // deterministic.
+  static constexpr int64_t kDefaultRlimitPerQuery = 200000;
+  static constexpr absl::Duration kDefaultTimeBudget = absl::Seconds(10);
+  // Maximum number of earlier nodes each candidate is checked against.
+  static constexpr int64_t kMaxQueriesPerNode = 4;
+
+  explicit SatSweepingPass(int64_t rlimit_per_query = kDefaultRlimitPerQuery,
+                           absl::Duration time_budget = kDefaultTimeBudget)
+      : OptimizationFunctionBasePass(kName, "SAT sweeping"),
+        rlimit_per_query_(rlimit_per_query),
+        time_budget_(time_budget) {}
+  ~SatSweepingPass() override = default;
+
+ protected:
+  absl::StatusOr<bool> RunOnFunctionBaseInternal(
+      FunctionBase* f, const OptimizationPassOptions& options,
+      PassResults* results) const override;
+
+ private:
+  int64_t rlimit_per_query_;
+  absl::Duration time_budget_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_SAT_SWEEPING_PASS_H_
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/sat_sweeping_pass.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_base.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+
+class SatSweepingPassTest : public IrTestBase {
+ protected:
+  absl::StatusOr<bool> Run(Function* f,
+                           absl::Duration time_budget = absl::Seconds(60)) {
+    PassResults results;
+    return SatSweepingPass(SatSweepingPass::kDefaultRlimitPerQuery,
+                           time_budget)
+        .RunOnFunctionBase(f, OptimizationPassOptions(), &results);
+  }
+};
+
+// (x + y)^2 == x^2 + 2xy + y^2 holds modulo 2^n; BDDs of multipliers blow up
+// and are cut off by the BDD path limit.
+TEST_F(SatSweepingPassTest, MergesEquivalentArithmetic) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue sum = fb.Add(x, y);
+  BValue square = fb.UMul(sum, sum);
+  BValue two_xy = fb.Shll(fb.UMul(x, y), fb.Literal(UBits(1, 8)));
+  BValue expanded = fb.Add(fb.Add(fb.UMul(x, x), two_xy), fb.UMul(y, y));
+  fb.Tuple({square, expanded});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+}
+
+TEST_F(SatSweepingPassTest, DifferentExpressions) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  fb.Tuple({fb.UMul(x, y), fb.Add(x, y), fb.Subtract(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f), IsOkAndHolds(false));
+}
+
+TEST_F(SatSweepingPassTest, NoQueriesWithoutTimeBudget) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  fb.Tuple({fb.UMul(x, y), fb.UMul(y, x)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  EXPECT_THAT(Run(f, absl::ZeroDuration()), IsOkAndHolds(false));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_EQ(f->return_value()->operand(0), f->return_value()->operand(1));
+}
+
+}  // namespace
+}  // namespace xls
@@ -32,6 +32,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
@@ -68,6 +69,7 @@
 #include "xls/passes/optimization_pass_registry.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/range_query_engine.h"
 #include "xls/passes/stateless_query_engine.h"
 #include "xls/passes/ternary_query_engine.h"
@@ -76,6 +78,41 @@
 namespace xls {
 namespace {
 
+// Returns a representative for each of the given select arms such that arms
+// with the same representative are equivalent: either the same node or
+// literals of the same value. ROM-style selects have many distinct literal
+// arms which share values, which comparing by node identity alone misses.
+std::vector<Node*> ArmRepresentatives(absl::Span<Node* const> arms) {
+  std::vector<Node*> representatives;
+  representatives.reserve(arms.size());
+  absl::flat_hash_map<Value, Node*> literal_representatives;
+  for (Node* arm : arms) {
+    if (arm->Is<Literal>()) {
+      representatives.push_back(
+          literal_representatives.try_emplace(arm->As<Literal>()->value(), arm)
+              .first->second);
+    } else {
+      representatives.push_back(arm);
+    }
+  }
+  return representatives;
+}
+
+// Returns true if all of the given arms are equivalent in the sense of
+// ArmRepresentatives.
+bool AllArmsEquivalent(absl::Span<Node* const> arms) {
+  if (absl::c_all_of(arms, [&](Node* arm) { return arm == arms.front(); })) {
+    return true;
+  }
+  if (!arms.front()->Is<Literal>()) {
+    return false;
+  }
+  const Value& value = arms.front()->As<Literal>()->value();
+  return absl::c_all_of(arms, [&](Node* arm) {
+    return arm->Is<Literal>() && arm->As<Literal>()->value() == value;
+  });
+}
+
 // Slice out changed bits and store them into a tuple.
 struct RemoveUnchangedBits {
   const TreeBitSources& source;
@@ -1062,8 +1099,11 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
   // Select with identical cases can be replaced with the value.
   if (node->Is<Select>()) {
     Select* sel = node->As<Select>();
-    if (sel->AllCases(
-            [&](Node* other_case) { return other_case == sel->any_case(); })) {
+    std::vector<Node*> arms(sel->cases().begin(), sel->cases().end());
+    if (sel->default_value().has_value()) {
+      arms.push_back(*sel->default_value());
+    }
+    if (AllArmsEquivalent(arms)) {
       VLOG(2) << absl::StrFormat("Simplifying select with identical cases: %s",
                                  node->ToString());
       XLS_RETURN_IF_ERROR(node->ReplaceUsesWith(sel->any_case()));
@@ -1078,7 +1118,7 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
       node->BitCountOrDie() > 1) {
     Node* selector = node->As<OneHotSelect>()->selector();
     absl::Span<Node* const> cases = node->As<OneHotSelect>()->cases();
-    if (absl::c_all_of(cases, [&](Node* c) { return c == cases[0]; })) {
+    if (AllArmsEquivalent(cases)) {
       FunctionBase* f = node->function_base();
       Node* is_nonzero;
       if (selector->GetType()->IsBits() && selector->BitCountOrDie() == 1) {
@@ -1201,35 +1241,43 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
   if (NarrowingEnabled(opt_level) && node->Is<OneHotSelect>()) {
     FunctionBase* f = node->function_base();
     OneHotSelect* sel = node->As<OneHotSelect>();
+    std::vector<Node*> representatives = ArmRepresentatives(sel->cases());
     if (!sel->cases().empty() &&
-        absl::flat_hash_set<Node*>(sel->cases().begin(), sel->cases().end())
+        absl::flat_hash_set<Node*>(representatives.begin(),
+                                   representatives.end())
                 .size() != sel->cases().size()) {
       // For any case that's equal to another case, we or together the one hot
       // selectors and common out the value to squeeze the width of the one hot
       // select.
-      std::vector<Node*> new_selectors;
+      std::vector<std::vector<Node*>> case_selectors;
       std::vector<Node*> new_cases;
+      absl::flat_hash_map<Node*, int64_t> new_case_indices;
       for (int64_t i = 0; i < sel->cases().size(); ++i) {
-        Node* old_case = sel->get_case(i);
+        Node* old_case = representatives[i];
         XLS_ASSIGN_OR_RETURN(Node * old_selector,
                              f->MakeNode<BitSlice>(node->loc(), sel->selector(),
                                                    /*start=*/i, 1));
-        auto it = std::find_if(
-            new_cases.begin(), new_cases.end(),
-            [old_case](Node* new_case) { return old_case == new_case; });
-        if (it == new_cases.end()) {
-          new_selectors.push_back(old_selector);
+        auto [it, inserted] =
+            new_case_indices.try_emplace(old_case, new_cases.size());
+        if (inserted) {
+          case_selectors.push_back({old_selector});
           new_cases.push_back(old_case);
         } else {
           // Or together the selectors, no need to append the old case.
-          int64_t index = std::distance(new_cases.begin(), it);
-          XLS_ASSIGN_OR_RETURN(
-              new_selectors[index],
-              f->MakeNode<NaryOp>(
-                  node->loc(),
-                  std::vector<Node*>{new_selectors[index], old_selector},
-                  Op::kOr));
+          case_selectors[it->second].push_back(old_selector);
+        }
+      }
+      std::vector<Node*> new_selectors;
+      new_selectors.reserve(case_selectors.size());
+      for (std::vector<Node*>& selectors : case_selectors) {
+        if (selectors.size() == 1) {
+          new_selectors.push_back(selectors.front());
+          continue;
         }
+        XLS_ASSIGN_OR_RETURN(
+            Node * new_selector,
+            f->MakeNode<NaryOp>(node->loc(), std::move(selectors), Op::kOr));
+        new_selectors.push_back(new_selector);
       }
       std::reverse(new_selectors.begin(), new_selectors.end());
       XLS_ASSIGN_OR_RETURN(Node * new_selector,
@@ -1257,10 +1305,11 @@ absl::StatusOr<bool> SimplifyNode(Node* node, const QueryEngine& query_engine,
     };
     std::vector<SelectorRange> new_selector_ranges;
     std::vector<Node*> new_cases;
+    std::vector<Node*> representatives = ArmRepresentatives(sel->cases());
     new_selector_ranges.push_back({.start = 0});
-    new_cases.push_back(sel->get_case(0));
+    new_cases.push_back(representatives[0]);
     for (int64_t i = 1; i < sel->cases().size(); ++i) {
-      Node* old_case = sel->get_case(i);
+      Node* old_case = representatives[i];
       if (old_case == new_cases.back()) {
         new_selector_ranges.back().width++;
       } else {
@@ -2216,13 +2265,14 @@ absl::StatusOr<bool> SelectSimplificationPassBase::RunOnFunctionBaseInternal(
   UnionQueryEngine query_engine(std::move(query_engines));
   XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
 
-  XLS_ASSIGN_OR_RETURN(BitProvenanceAnalysis provenance,
-                       BitProvenanceAnalysis::Create(func));
+  XLS_ASSIGN_OR_RETURN(
+      std::shared_ptr<const BitProvenanceAnalysis> provenance,
+      MakeBitProvenanceAnalysis(func, options.query_engine_cache));
 
   bool changed = false;
   for (Node* node : TopoSort(func)) {
     XLS_ASSIGN_OR_RETURN(bool node_changed,
-                         SimplifyNode(node, query_engine, provenance,
+                         SimplifyNode(node, query_engine, *provenance,
                                       options.opt_level, range_analysis_));
     changed = changed || node_changed;
   }
@@ -2233,10 +2283,11 @@ absl::StatusOr<bool> SelectSimplificationPassBase::RunOnFunctionBaseInternal(
   // optimizations.
   if (options.splits_enabled()) {
     // We need to recalculate provenance and qe if changes happened.
-    std::optional<BitProvenanceAnalysis> post_simplify_provenance;
+    std::shared_ptr<const BitProvenanceAnalysis> post_simplify_provenance;
     if (changed) {
-      XLS_ASSIGN_OR_RETURN(post_simplify_provenance,
-                           BitProvenanceAnalysis::Create(func));
+      XLS_ASSIGN_OR_RETURN(
+          post_simplify_provenance,
+          MakeBitProvenanceAnalysis(func, options.query_engine_cache));
       XLS_RETURN_IF_ERROR(query_engine.Populate(func).status());
     } else {
       post_simplify_provenance = std::move(provenance);
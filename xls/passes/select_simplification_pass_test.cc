@@ -718,6 +718,42 @@ TEST_P(SelectSimplificationPassTest, OneHotSelectCommoning) {
                       /*cases=*/{m::Param("x"), m::Param("y")}));
 }
 
+TEST_P(SelectSimplificationPassTest, OneHotSelectCommoningEqualLiterals) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+ fn f(s: bits[4], x: bits[3]) -> bits[3] {
+  literal.1: bits[3] = literal(value=5)
+  literal.2: bits[3] = literal(value=5)
+  ret one_hot_sel.3: bits[3] = one_hot_sel(s, cases=[literal.1, x, literal.2, x])
+}
+  )",
+                                                       p.get()));
+  solvers::z3::ScopedVerifyEquivalence stays_equivalent{f};
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(
+      f->return_value(),
+      m::OneHotSelect(m::Concat(m::Or(m::BitSlice(/*start=*/1, /*width=*/1),
+                                      m::BitSlice(/*start=*/3, /*width=*/1)),
+                                m::Or(m::BitSlice(/*start=*/0, /*width=*/1),
+                                      m::BitSlice(/*start=*/2, /*width=*/1))),
+                      /*cases=*/{m::Literal(5), m::Param("x")}));
+}
+
+TEST_P(SelectSimplificationPassTest, SelectWithEqualLiteralCases) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
+ fn f(s: bits[2]) -> bits[8] {
+  literal.1: bits[8] = literal(value=42)
+  literal.2: bits[8] = literal(value=42)
+  literal.3: bits[8] = literal(value=42)
+  ret sel.4: bits[8] = sel(s, cases=[literal.1, literal.2, literal.3], default=literal.1)
+}
+  )",
+                                                       p.get()));
+  EXPECT_THAT(Run(f), IsOkAndHolds(true));
+  EXPECT_THAT(f->return_value(), m::Literal(42));
+}
+
 TEST_P(SelectSimplificationPassTest, PrioritySelectCommoning) {
   auto p = CreatePackage();
   XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(R"(
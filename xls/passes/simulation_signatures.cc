@@ -0,0 +1,394 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/simulation_signatures.h"
+
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/data_structures/inline_bitmap.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+// Number of input vectors simulated at once; one per bit of a word.
+constexpr int64_t kLanes = 64;
+constexpr uint64_t kAllLanes = ~uint64_t{0};
+
+// The simulated value of a bits-typed node: element i holds bit i of the node
+// in each of the kLanes input vectors.
+using LaneWords = std::vector<uint64_t>;
+
+LaneWords RandomWords(int64_t width, std::mt19937_64& rng) {
+  LaneWords result(width);
+  for (uint64_t& word : result) {
+    word = rng();
+  }
+  return result;
+}
+
+LaneWords Not(const LaneWords& a) {
+  LaneWords result(a.size());
+  for (int64_t i = 0; i < a.size(); ++i) {
+    result[i] = ~a[i];
+  }
+  return result;
+}
+
+// Returns a + b + carry_in, setting `carry_out` (if given) to the carry out of
+// the most significant bit.
+LaneWords Add(const LaneWords& a, const LaneWords& b, uint64_t carry_in,
+              uint64_t* carry_out = nullptr) {
+  LaneWords result(a.size());
+  uint64_t carry = carry_in;
+  for (int64_t i = 0; i < a.size(); ++i) {
+    result[i] = a[i] ^ b[i] ^ carry;
+    carry = (a[i] & b[i]) | (carry & (a[i] ^ b[i]));
+  }
+  if (carry_out != nullptr) {
+    *carry_out = carry;
+  }
+  return result;
+}
+
+uint64_t Eq(const LaneWords& a, const LaneWords& b) {
+  uint64_t result = kAllLanes;
+  for (int64_t i = 0; i < a.size(); ++i) {
+    result &= ~(a[i] ^ b[i]);
+  }
+  return result;
+}
+
+// Returns the lanes in which a < b as unsigned numbers. a - b borrows exactly
+// when a < b, i.e., when a + ~b + 1 does not carry out.
+uint64_t ULt(const LaneWords& a, const LaneWords& b) {
+  uint64_t carry;
+  Add(a, Not(b), kAllLanes, &carry);
+  return ~carry;
+}
+
+// Flipping the sign bits maps signed order onto unsigned order.
+uint64_t SLt(LaneWords a, LaneWords b) {
+  if (!a.empty()) {
+    a.back() = ~a.back();
+    b.back() = ~b.back();
+  }
+  return ULt(a, b);
+}
+
+// Returns the lanes in which `a` equals the constant `value`.
+uint64_t EqConstant(const LaneWords& a, uint64_t value) {
+  uint64_t result = kAllLanes;
+  for (int64_t i = 0; i < a.size(); ++i) {
+    bool bit = i < 64 && ((value >> i) & 1);
+    result &= bit ? a[i] : ~a[i];
+  }
+  return result;
+}
+
+// Ors `value` into `result` in the lanes selected by `lanes`.
+void OrInLanes(uint64_t lanes, const LaneWords& value, LaneWords& result) {
+  for (int64_t i = 0; i < result.size(); ++i) {
+    result[i] |= lanes & value[i];
+  }
+}
+
+// Shifts `x` by the per-lane amount `amount` with a barrel shifter; bits
+// shifted in are zero, or copies of the sign bit for arithmetic right shifts.
+LaneWords Shift(Op op, const LaneWords& x, const LaneWords& amount) {
+  const int64_t width = x.size();
+  const uint64_t fill = (op == Op::kShra && width > 0) ? x.back() : 0;
+  LaneWords result = x;
+  // Lanes in which the amount is at least `width`.
+  uint64_t overflow = 0;
+  for (int64_t k = 0; k < amount.size(); ++k) {
+    if (k >= 63 || (int64_t{1} << k) >= width) {
+      overflow |= amount[k];
+      continue;
+    }
+    const int64_t distance = int64_t{1} << k;
+    LaneWords shifted(width);
+    for (int64_t i = 0; i < width; ++i) {
+      if (op == Op::kShll) {
+        shifted[i] = i >= distance ? result[i - distance] : 0;
+      } else {
+        shifted[i] = i + distance < width ? result[i + distance] : fill;
+      }
+    }
+    for (int64_t i = 0; i < width; ++i) {
+      result[i] = (amount[k] & shifted[i]) | (~amount[k] & result[i]);
+    }
+  }
+  for (uint64_t& word : result) {
+    word = (overflow & fill) | (~overflow & word);
+  }
+  return result;
+}
+
+// Evaluates `node` one lane at a time with the IR interpreter. Used for
+// operations without a bit-parallel implementation.
+absl::StatusOr<LaneWords> InterpretLanes(
+    Node* node, absl::Span<const LaneWords* const> operands) {
+  LaneWords result(node->BitCountOrDie(), 0);
+  std::vector<Value> operand_values(operands.size());
+  for (int64_t lane = 0; lane < kLanes; ++lane) {
+    for (int64_t i = 0; i < operands.size(); ++i) {
+      InlineBitmap bitmap(operands[i]->size());
+      for (int64_t b = 0; b < operands[i]->size(); ++b) {
+        bitmap.Set(b, ((*operands[i])[b] >> lane) & 1);
+      }
+      operand_values[i] = Value(Bits::FromBitmap(std::move(bitmap)));
+    }
+    XLS_ASSIGN_OR_RETURN(Value value, InterpretNode(node, operand_values));
+    const Bits& bits = value.bits();
+    for (int64_t b = 0; b < bits.bit_count(); ++b) {
+      result[b] |= static_cast<uint64_t>(bits.Get(b)) << lane;
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<LaneWords> Simulate(Node* node,
+                                   absl::Span<const LaneWords* const> ops) {
+  const int64_t width = node->BitCountOrDie();
+  auto broadcast = [&](uint64_t lanes) {
+    LaneWords result(width, 0);
+    if (width > 0) {
+      result[0] = lanes;
+    }
+    return result;
+  };
+  auto bitwise = [&](auto combine) {
+    LaneWords result = *ops[0];
+    for (const LaneWords* operand : ops.subspan(1)) {
+      for (int64_t i = 0; i < width; ++i) {
+        result[i] = combine(result[i], (*operand)[i]);
+      }
+    }
+    return result;
+  };
+  auto reduce = [&](auto combine, uint64_t identity) {
+    uint64_t result = identity;
+    for (uint64_t word : *ops[0]) {
+      result = combine(result, word);
+    }
+    return broadcast(result);
+  };
+  auto select = [&](uint64_t lanes, const LaneWords& value) {
+    LaneWords result(width, 0);
+    OrInLanes(lanes, value, result);
+    return result;
+  };
+  auto land = [](uint64_t a, uint64_t b) { return a & b; };
+  auto lor = [](uint64_t a, uint64_t b) { return a | b; };
+  auto lxor = [](uint64_t a, uint64_t b) { return a ^ b; };
+
+  switch (node->op()) {
+    case Op::kLiteral: {
+      const Bits& bits = node->As<Literal>()->value().bits();
+      LaneWords result(width);
+      for (int64_t i = 0; i < width; ++i) {
+        result[i] = bits.Get(i) ? kAllLanes : 0;
+      }
+      return result;
+    }
+    case Op::kIdentity:
+      return *ops[0];
+    case Op::kNot:
+      return Not(*ops[0]);
+    case Op::kAnd:
+      return bitwise(land);
+    case Op::kOr:
+      return bitwise(lor);
+    case Op::kXor:
+      return bitwise(lxor);
+    case Op::kNand:
+      return Not(bitwise(land));
+    case Op::kNor:
+      return Not(bitwise(lor));
+    case Op::kAndReduce:
+      return reduce(land, kAllLanes);
+    case Op::kOrReduce:
+      return reduce(lor, 0);
+    case Op::kXorReduce:
+      return reduce(lxor, 0);
+    case Op::kBitSlice: {
+      const int64_t start = node->As<BitSlice>()->start();
+      return LaneWords(ops[0]->begin() + start,
+                       ops[0]->begin() + start + width);
+    }
+    case Op::kConcat: {
+      // The last operand holds the least significant bits.
+      LaneWords result;
+      result.reserve(width);
+      for (int64_t i = ops.size() - 1; i >= 0; --i) {
+        result.insert(result.end(), ops[i]->begin(), ops[i]->end());
+      }
+      return result;
+    }
+    case Op::kZeroExt:
+    case Op::kSignExt: {
+      LaneWords result = *ops[0];
+      uint64_t fill =
+          node->op() == Op::kSignExt && !result.empty() ? result.back() : 0;
+      result.resize(width, fill);
+      return result;
+    }
+    case Op::kEq:
+      return broadcast(Eq(*ops[0], *ops[1]));
+    case Op::kNe:
+      return broadcast(~Eq(*ops[0], *ops[1]));
+    case Op::kULt:
+      return broadcast(ULt(*ops[0], *ops[1]));
+    case Op::kUGt:
+      return broadcast(ULt(*ops[1], *ops[0]));
+    case Op::kULe:
+      return broadcast(~ULt(*ops[1], *ops[0]));
+    case Op::kUGe:
+      return broadcast(~ULt(*ops[0], *ops[1]));
+    case Op::kSLt:
+      return broadcast(SLt(*ops[0], *ops[1]));
+    case Op::kSGt:
+      return broadcast(SLt(*ops[1], *ops[0]));
+    case Op::kSLe:
+      return broadcast(~SLt(*ops[1], *ops[0]));
+    case Op::kSGe:
+      return broadcast(~SLt(*ops[0], *ops[1]));
+    case Op::kAdd:
+      return Add(*ops[0], *ops[1], 0);
+    case Op::kSub:
+      return Add(*ops[0], Not(*ops[1]), kAllLanes);
+    case Op::kNeg:
+      return Add(LaneWords(width, 0), Not(*ops[0]), kAllLanes);
+    case Op::kShll:
+    case Op::kShrl:
+    case Op::kShra:
+      return Shift(node->op(), *ops[0], *ops[1]);
+    case Op::kGate:
+      return select(ops[0]->front(), *ops[1]);
+    case Op::kSel: {
+      Select* sel = node->As<Select>();
+      LaneWords result(width, 0);
+      uint64_t matched = 0;
+      for (int64_t i = 0; i < sel->cases().size(); ++i) {
+        uint64_t lanes = EqConstant(*ops[0], i);
+        matched |= lanes;
+        OrInLanes(lanes, *ops[1 + i], result);
+      }
+      if (sel->default_value().has_value()) {
+        OrInLanes(~matched, *ops.back(), result);
+      }
+      return result;
+    }
+    case Op::kOneHotSel: {
+      LaneWords result(width, 0);
+      for (int64_t i = 1; i < ops.size(); ++i) {
+        OrInLanes((*ops[0])[i - 1], *ops[i], result);
+      }
+      return result;
+    }
+    case Op::kPrioritySel: {
+      PrioritySelect* sel = node->As<PrioritySelect>();
+      LaneWords result(width, 0);
+      uint64_t remaining = kAllLanes;
+      for (int64_t i = 0; i < sel->cases().size(); ++i) {
+        OrInLanes(remaining & (*ops[0])[i], *ops[1 + i], result);
+        remaining &= ~(*ops[0])[i];
+      }
+      OrInLanes(remaining, *ops.back(), result);
+      return result;
+    }
+    default:
+      return InterpretLanes(node, ops);
+  }
+}
+
+}  // namespace
+
+absl::StatusOr<absl::flat_hash_map<Node*, uint64_t>>
+ComputeSimulationSignatures(FunctionBase* f, int64_t rounds) {
+  std::vector<Node*> order = TopoSort(f);
+  absl::flat_hash_map<Node*, uint64_t> signatures;
+  // A fixed seed keeps the signatures, and so the pass, deterministic.
+  std::mt19937_64 rng(0x5eed);
+  for (int64_t round = 0; round < rounds; ++round) {
+    absl::flat_hash_map<Node*, LaneWords> values;
+    absl::flat_hash_map<Node*, int64_t> pending_users;
+    for (Node* node : order) {
+      if (!node->GetType()->IsBits()) {
+        continue;
+      }
+      std::vector<const LaneWords*> operands;
+      bool free_input = OpIsSideEffecting(node->op());
+      for (Node* operand : node->operands()) {
+        auto it = values.find(operand);
+        if (it == values.end()) {
+          free_input = true;
+          break;
+        }
+        operands.push_back(&it->second);
+      }
+      LaneWords value;
+      if (!free_input) {
+        absl::StatusOr<LaneWords> simulated = Simulate(node, operands);
+        // Nodes the interpreter cannot evaluate in isolation (e.g., invokes)
+        // are treated as free inputs.
+        free_input = !simulated.ok();
+        if (simulated.ok()) {
+          value = *std::move(simulated);
+        }
+      }
+      if (free_input) {
+        value = RandomWords(node->BitCountOrDie(), rng);
+      }
+      signatures[node] = absl::HashOf(signatures[node], value);
+
+      for (int64_t i = 0; i < node->operand_count(); ++i) {
+        Node* operand = node->operand(i);
+        // `users()` counts a user once however many times it uses a node.
+        if (absl::c_linear_search(node->operands().subspan(0, i), operand)) {
+          continue;
+        }
+        auto it = pending_users.find(operand);
+        if (it != pending_users.end() && --it->second == 0) {
+          values.erase(operand);
+          pending_users.erase(it);
+        }
+      }
+      if (!node->users().empty()) {
+        values[node] = std::move(value);
+        pending_users[node] = node->users().size();
+      }
+    }
+  }
+  return signatures;
+}
+
+}  // namespace xls
@@ -0,0 +1,47 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_PASSES_SIMULATION_SIGNATURES_H_
+#define XLS_PASSES_SIMULATION_SIGNATURES_H_
+
+#include <cstdint>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// Computes a signature for every bits-typed node of `f` by simulating `f` on
+// random inputs. Each round simulates 64 input vectors at once: every bit of a
+// node is held as a 64-bit word with one bit per input vector, so bitwise and
+// arithmetic operations are evaluated a word at a time. Operations without a
+// bit-parallel implementation are evaluated with the IR interpreter.
+//
+// Nodes which compute the same value have the same signature. Nodes with the
+// same signature are likely, but not certain, to compute the same value; more
+// rounds make a spurious match less likely.
+//
+// Parameters, state and other nodes whose value cannot be simulated (e.g.,
+// side-effecting operations and nodes with non-bits operands) are free inputs
+// which get random values. The simulated values of a node are dropped once all
+// its users are simulated, so memory is proportional to the width of the graph
+// rather than its size. Signatures are deterministic.
+absl::StatusOr<absl::flat_hash_map<Node*, uint64_t>>
+ComputeSimulationSignatures(FunctionBase* f, int64_t rounds = 2);
+
+}  // namespace xls
+
+#endif  // XLS_PASSES_SIMULATION_SIGNATURES_H_
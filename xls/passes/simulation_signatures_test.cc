@@ -0,0 +1,96 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/passes/simulation_signatures.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+namespace {
+
+class SimulationSignaturesTest : public IrTestBase {};
+
+TEST_F(SimulationSignaturesTest, EquivalentExpressionsShareSignatures) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(16));
+  BValue y = fb.Param("y", p->GetBitsType(16));
+  BValue x_plus_y = fb.Add(x, y);
+  BValue y_plus_x = fb.Add(y, x);
+  BValue x_minus_y = fb.Subtract(x, y);
+  BValue x_plus_neg_y = fb.Add(x, fb.Negate(y));
+  BValue x_ult_y = fb.ULt(x, y);
+  BValue y_ugt_x = fb.UGt(y, x);
+  BValue x_slt_y = fb.SLt(x, y);
+  BValue not_x_sge_y = fb.Not(fb.SGe(x, y));
+  fb.Tuple({x_plus_y, y_plus_x, x_minus_y, x_plus_neg_y, x_ult_y, y_ugt_x,
+            x_slt_y, not_x_sge_y});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN((absl::flat_hash_map<Node*, uint64_t> signatures),
+                           ComputeSimulationSignatures(f));
+  EXPECT_EQ(signatures.at(x_plus_y.node()), signatures.at(y_plus_x.node()));
+  EXPECT_EQ(signatures.at(x_minus_y.node()),
+            signatures.at(x_plus_neg_y.node()));
+  EXPECT_EQ(signatures.at(x_ult_y.node()), signatures.at(y_ugt_x.node()));
+  EXPECT_EQ(signatures.at(x_slt_y.node()), signatures.at(not_x_sge_y.node()));
+  EXPECT_NE(signatures.at(x.node()), signatures.at(y.node()));
+  EXPECT_NE(signatures.at(x_plus_y.node()), signatures.at(x_minus_y.node()));
+  EXPECT_NE(signatures.at(x_ult_y.node()), signatures.at(x_slt_y.node()));
+}
+
+// Multiplication is simulated with the interpreter and shifts are simulated
+// bit-parallel, so this checks the two against each other.
+TEST_F(SimulationSignaturesTest, ShiftMatchesMultiplyByPowerOfTwo) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue s = fb.Param("s", p->GetBitsType(3));
+  BValue shifted = fb.Shll(x, s);
+  BValue multiplied = fb.UMul(x, fb.Decode(s, /*width=*/8), /*result_width=*/8);
+  fb.Tuple({shifted, multiplied});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN((absl::flat_hash_map<Node*, uint64_t> signatures),
+                           ComputeSimulationSignatures(f));
+  EXPECT_EQ(signatures.at(shifted.node()), signatures.at(multiplied.node()));
+}
+
+TEST_F(SimulationSignaturesTest, SignaturesAreDeterministic) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Concat({fb.Shra(x, fb.BitSlice(y, 0, 6)), fb.SignExtend(y, 40)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN((absl::flat_hash_map<Node*, uint64_t> first),
+                           ComputeSimulationSignatures(f));
+  XLS_ASSERT_OK_AND_ASSIGN((absl::flat_hash_map<Node*, uint64_t> second),
+                           ComputeSimulationSignatures(f));
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first.size(), f->node_count());
+}
+
+}  // namespace
+}  // namespace xls
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
@@ -78,7 +79,28 @@ static absl::Status SparsifySelect(FunctionBase* f, Select* select,
   for (const Interval& interval : IntervalsSortedBySize(selector_intervals)) {
     std::vector<Node*> cases_in_range;
 
-    {
+    if (!interval.IsImproper() && interval.LowerBound().FitsInUint64() &&
+        interval.UpperBound().FitsInUint64()) {
+      // Common case: copy the in-range cases directly rather than
+      // materializing a Bits value for every element of the interval.
+      uint64_t lower = *interval.LowerBound().ToUint64();
+      uint64_t upper = *interval.UpperBound().ToUint64();
+      uint64_t case_count = select->cases().size();
+      if (upper >= case_count && !select->default_value().has_value()) {
+        return absl::InternalError(
+            "SparsifySelectPass: select had not enough cases and no default");
+      }
+      cases_in_range.reserve(upper - lower + 1);
+      if (lower < case_count) {
+        absl::Span<Node* const> in_range = select->cases().subspan(
+            lower, std::min(upper, case_count - 1) - lower + 1);
+        cases_in_range.insert(cases_in_range.end(), in_range.begin(),
+                              in_range.end());
+      }
+      while (cases_in_range.size() < upper - lower + 1) {
+        cases_in_range.push_back(select->default_value().value());
+      }
+    } else {
       absl::Status failure = absl::OkStatus();
       interval.ForEachElement([&](const Bits& bits) -> bool {
         std::optional<uint64_t> index =
@@ -17,7 +17,6 @@
 #include <array>
 #include <cstdint>
 #include <iterator>
-#include <memory>
 #include <optional>
 #include <utility>
 #include <vector>
@@ -573,11 +572,7 @@ absl::StatusOr<bool> StrengthReduceNode(
 absl::StatusOr<bool> StrengthReductionPass::RunOnFunctionBaseInternal(
     FunctionBase* f, const OptimizationPassOptions& options,
     PassResults* results) const {
-  std::vector<std::unique_ptr<QueryEngine>> query_engines;
-  query_engines.push_back(std::make_unique<StatelessQueryEngine>());
-  query_engines.push_back(std::make_unique<TernaryQueryEngine>());
-
-  UnionQueryEngine query_engine(std::move(query_engines));
+  StaticUnionQueryEngine<StatelessQueryEngine, TernaryQueryEngine> query_engine;
   XLS_RETURN_IF_ERROR(query_engine.Populate(f).status());
 
   XLS_ASSIGN_OR_RETURN(absl::flat_hash_set<Node*> reducible_adds,
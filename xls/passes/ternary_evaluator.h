@@ -15,8 +15,11 @@
 #ifndef XLS_PASSES_TERNARY_EVALUATOR_H_
 #define XLS_PASSES_TERNARY_EVALUATOR_H_
 
+#include <cstdint>
+
 #include "absl/log/log.h"
 #include "xls/ir/abstract_evaluator.h"
+#include "xls/ir/packed_ternary.h"
 #include "xls/ir/ternary.h"
 
 namespace xls {
@@ -61,6 +64,55 @@ class TernaryEvaluator
     }
     return TernaryValue::kUnknown;
   }
+
+  // The arithmetic and comparison operations below hide the bit-at-a-time
+  // implementations in AbstractEvaluator with word-parallel ones operating on
+  // PackedTernary, which is much faster for wide operands. Additions track the
+  // carry into each bit exactly, so they are at least as precise as the
+  // ripple-carry versions.
+  Vector Add(Span a, Span b) const {
+    return packed_ternary_ops::Add(PackedTernary::FromTernary(a),
+                                   PackedTernary::FromTernary(b))
+        .ToTernary();
+  }
+  Vector Sub(Span a, Span b) const {
+    return packed_ternary_ops::Sub(PackedTernary::FromTernary(a),
+                                   PackedTernary::FromTernary(b))
+        .ToTernary();
+  }
+  Vector Neg(Span x) const {
+    return packed_ternary_ops::Neg(PackedTernary::FromTernary(x)).ToTernary();
+  }
+
+  // Multiplications returning a Vector of a.size() + b.size() unless a result
+  // width is given.
+  Vector UMul(Span a, Span b) const { return UMul(a, b, a.size() + b.size()); }
+  Vector UMul(Span a, Span b, int64_t result_width) const {
+    return packed_ternary_ops::UMul(PackedTernary::FromTernary(a),
+                                    PackedTernary::FromTernary(b),
+                                    result_width)
+        .ToTernary();
+  }
+  Vector SMul(Span a, Span b) const { return SMul(a, b, a.size() + b.size()); }
+  Vector SMul(Span a, Span b, int64_t result_width) const {
+    return packed_ternary_ops::SMul(PackedTernary::FromTernary(a),
+                                    PackedTernary::FromTernary(b),
+                                    result_width)
+        .ToTernary();
+  }
+
+  TernaryValue Equals(Span a, Span b) const {
+    return packed_ternary_ops::Equals(PackedTernary::FromTernary(a),
+                                      PackedTernary::FromTernary(b));
+  }
+  TernaryValue ULessThan(Span a, Span b) const {
+    return packed_ternary_ops::ULessThan(PackedTernary::FromTernary(a),
+                                         PackedTernary::FromTernary(b));
+  }
+  TernaryValue SLessThan(Span a, Span b) const {
+    return packed_ternary_ops::SLessThan(PackedTernary::FromTernary(a),
+                                         PackedTernary::FromTernary(b));
+  }
 };
 
 }  // namespace xls
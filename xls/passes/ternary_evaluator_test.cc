@@ -27,6 +27,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/ternary.h"
@@ -265,6 +266,23 @@ TEST_F(TernaryLogicTest, ULessThan) {
   }
 }
 
+// The packed adder tracks carries exactly, so it must know every bit which the
+// ripple-carry adder of the AbstractEvaluator knows.
+TEST_F(TernaryLogicTest, AddIsAtLeastAsPreciseAsRippleCarry) {
+  using Base = AbstractEvaluator<TernaryValue, TernaryEvaluator>;
+  for (const TernaryVector& lhs : EnumerateTernaryVectors(/*width=*/3)) {
+    for (const TernaryVector& rhs : EnumerateTernaryVectors(/*width=*/3)) {
+      TernaryVector ripple = evaluator_.Base::Add(lhs, rhs);
+      XLS_ASSERT_OK_AND_ASSIGN(
+          TernaryVector combined,
+          ternary_ops::Union(ripple, evaluator_.Add(lhs, rhs)));
+      EXPECT_EQ(combined, evaluator_.Add(lhs, rhs))
+          << ToString(lhs) << " + " << ToString(rhs) << ": ripple-carry gives "
+          << ToString(ripple);
+    }
+  }
+}
+
 TEST_F(TernaryLogicTest, BinarySelect) {
   for (const TernaryVector& selector : EnumerateTernaryVectors(/*width=*/1)) {
     for (const TernaryVector& on_true : EnumerateTernaryVectors(/*width=*/2)) {
@@ -14,6 +14,7 @@
 
 #include "xls/passes/ternary_query_engine.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -24,6 +25,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
@@ -113,8 +115,8 @@ static constexpr int64_t kIndexBitLimit = 10;
 // pathological cases are encountered.
 bool IsExpensiveToEvaluate(
     Node* node,
-    const absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>>&
-        known_bits) {
+    const absl::flat_hash_map<
+        Node*, CopyOnWriteLeafTypeTree<TernaryEvaluator::Vector>>& known_bits) {
   // How many bits of output we allow for complex evaluations.
   static constexpr int64_t kComplexEvaluationLimit = 256;
   // How many bits of data we are willing to keep track of for compound
@@ -180,17 +182,46 @@ class TernaryNodeEvaluator : public AbstractNodeEvaluator<TernaryEvaluator> {
     return SetValue(n, std::move(unconstrained));
   }
 
+  // Arithmetic goes straight to the packed implementations so that products
+  // are only computed to the width of the node.
+  absl::Status HandleSub(BinOp* sub) override {
+    XLS_ASSIGN_OR_RETURN(auto lhs, GetValue(sub->operand(0)));
+    XLS_ASSIGN_OR_RETURN(auto rhs, GetValue(sub->operand(1)));
+    return SetValue(sub, evaluator().Sub(lhs, rhs));
+  }
+  absl::Status HandleUMul(ArithOp* mul) override {
+    XLS_ASSIGN_OR_RETURN(auto lhs, GetValue(mul->operand(0)));
+    XLS_ASSIGN_OR_RETURN(auto rhs, GetValue(mul->operand(1)));
+    return SetValue(mul, evaluator().UMul(lhs, rhs, mul->BitCountOrDie()));
+  }
+  absl::Status HandleSMul(ArithOp* mul) override {
+    XLS_ASSIGN_OR_RETURN(auto lhs, GetValue(mul->operand(0)));
+    XLS_ASSIGN_OR_RETURN(auto rhs, GetValue(mul->operand(1)));
+    return SetValue(mul, evaluator().SMul(lhs, rhs, mul->BitCountOrDie()));
+  }
+
   absl::Status HandleArrayIndex(ArrayIndex* index) override {
     XLS_ASSIGN_OR_RETURN(auto indices, GetValueList(index->indices()));
-    XLS_ASSIGN_OR_RETURN(auto array, GetCompoundValue(index->array()));
-    if (indices.empty()) {
-      // Some passes end up creating these index-less array index's with the
-      // understanding they are identity ops.
-      return SetValue(index, CompoundValue::CreateFromVector(
-                                 array.type(), CompoundValue::DataContainerT(
-                                                   array.elements().begin(),
-                                                   array.elements().end())));
+    if (absl::c_all_of(indices, ternary_ops::IsFullyKnown)) {
+      // Only one element can be selected (this includes index-less array
+      // indexes, which some passes create as identity ops), so share it with
+      // the array rather than copying it.
+      XLS_ASSIGN_OR_RETURN(CopyOnWriteLeafTypeTree<TernaryVector> array,
+                           GetSharedValue(index->array()));
+      std::vector<int64_t> element_index;
+      element_index.reserve(indices.size());
+      Type* type = array.type();
+      for (TernaryEvaluator::Span ternary_index : indices) {
+        // Out-of-bounds indices are clamped to the last element.
+        int64_t size = type->AsArrayOrDie()->size();
+        element_index.push_back(std::min(
+            ToSaturatedInt64(ternary_ops::ToKnownBitsValues(ternary_index)),
+            size - 1));
+        type = type->AsArrayOrDie()->element_type();
+      }
+      return SetValue(index, array.Subtree(element_index));
     }
+    XLS_ASSIGN_OR_RETURN(auto array, GetCompoundValue(index->array()));
 
     std::vector<CompoundValueView> possibilities;
     auto collect_possible_element =
@@ -336,13 +367,17 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::PopulateWithGivens(
     XLS_RETURN_IF_ERROR(n->VisitSingleNode(&ternary_visitor));
   }
 
-  absl::flat_hash_map<Node*, LeafTypeTree<TernaryVector>> new_values =
+  TernaryNodeEvaluator::ValueMap new_values =
       std::move(ternary_visitor).values();
   ReachedFixpoint rf = ReachedFixpoint::Unchanged;
   for (Node* node : f->nodes()) {
     CHECK(new_values.contains(node));
     if (values_.contains(node) &&
         values_[node].type() == new_values[node].type()) {
+      if (values_[node] == new_values[node]) {
+        // Avoid unsharing the existing value when nothing changes.
+        continue;
+      }
       leaf_type_tree::SimpleUpdateFrom<TernaryVector, TernaryVector>(
           values_[node].AsMutableView(), new_values[node].AsView(),
           [&rf](TernaryVector& lhs, const TernaryVector& rhs) {
@@ -358,6 +393,39 @@ absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::PopulateWithGivens(
   return rf;
 }
 
+absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Reevaluate(
+    FunctionBase* f, const absl::flat_hash_set<Node*>& nodes) {
+  TernaryEvaluator evaluator;
+  TernaryNodeEvaluator ternary_visitor(evaluator);
+  ternary_visitor.SetValues(std::move(values_));
+  absl::flat_hash_set<Node*> pending = nodes;
+  ReachedFixpoint rf = ReachedFixpoint::Unchanged;
+  for (Node* n : TopoSort(f)) {
+    if (!pending.contains(n)) {
+      auto it = ternary_visitor.values().find(n);
+      if (it != ternary_visitor.values().end() &&
+          it->second.type() == n->GetType()) {
+        continue;
+      }
+    }
+    std::optional<CopyOnWriteLeafTypeTree<TernaryVector>> previous =
+        ternary_visitor.ExtractValue(n);
+    if (IsExpensiveToEvaluate(n, ternary_visitor.values())) {
+      XLS_RETURN_IF_ERROR(ternary_visitor.DefaultHandler(n));
+    } else {
+      XLS_RETURN_IF_ERROR(n->VisitSingleNode(&ternary_visitor));
+    }
+    if (!previous.has_value() || *previous != ternary_visitor.values().at(n)) {
+      rf = ReachedFixpoint::Changed;
+      for (Node* user : n->users()) {
+        pending.insert(user);
+      }
+    }
+  }
+  values_ = std::move(ternary_visitor).values();
+  return rf;
+}
+
 absl::StatusOr<ReachedFixpoint> TernaryQueryEngine::Populate(FunctionBase* f) {
   NoOpGivens givens;
   return PopulateWithGivens(f, givens);
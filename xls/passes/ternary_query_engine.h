@@ -21,6 +21,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
@@ -55,13 +56,28 @@ class TernaryQueryEngine : public QueryEngine {
   absl::StatusOr<ReachedFixpoint> PopulateWithGivens(
       FunctionBase* f, const TernaryDataProvider& givens);
 
+  // Recomputes the values of `nodes`, of any node of `f` which is not yet
+  // tracked, and of every node whose operands' values change as a result.
+  // Unlike Populate, recomputed values replace (rather than refine) the
+  // previous ones, so this is suitable for bringing the engine up to date after
+  // `f` was modified. Evaluation stops propagating at nodes whose value is
+  // unchanged.
+  absl::StatusOr<ReachedFixpoint> Reevaluate(
+      FunctionBase* f, const absl::flat_hash_set<Node*>& nodes);
+
+  // Drops all information about `node`, e.g. because it is being deleted.
+  void Forget(Node* node) { values_.erase(node); }
+
   bool IsTracked(Node* node) const override {
     return values_.contains(node) && values_.at(node).type() == node->GetType();
   }
 
+  // The returned tree shares (and keeps alive) the engine's storage for the
+  // node's value.
   std::optional<SharedLeafTypeTree<TernaryVector>> GetTernary(
       Node* node) const override {
-    return GetTernaryView(node).AsShared();
+    CHECK(IsTracked(node)) << node;
+    return values_.at(node).AsShared();
   }
 
   LeafTypeTreeView<TernaryVector> GetTernaryView(Node* node) const {
@@ -106,7 +122,10 @@ class TernaryQueryEngine : public QueryEngine {
 
  private:
   // Holds which bits values are known for nodes in the function.
-  absl::flat_hash_map<Node*, LeafTypeTree<TernaryEvaluator::Vector>> values_;
+  // Values are copy-on-write, so nodes which forward (part of) an operand's
+  // value share its storage.
+  absl::flat_hash_map<Node*, CopyOnWriteLeafTypeTree<TernaryEvaluator::Vector>>
+      values_;
 };
 
 }  // namespace xls
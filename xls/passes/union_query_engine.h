@@ -15,18 +15,26 @@
 #ifndef XLS_PASSES_UNION_QUERY_ENGINE_H_
 #define XLS_PASSES_UNION_QUERY_ENGINE_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/log/check.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/change_listener.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/interval_set.h"
 #include "xls/ir/node.h"
 #include "xls/ir/ternary.h"
@@ -127,6 +135,351 @@ class UnionQueryEngine : public UnownedUnionQueryEngine {
   std::vector<std::unique_ptr<QueryEngine>> owned_engines_;
 };
 
+// A query engine that combines the results of a set of query engines fixed at
+// compile time, e.g. `StaticUnionQueryEngine<StatelessQueryEngine,
+// TernaryQueryEngine>`. Answers are the same as those of a UnionQueryEngine
+// over the same engines, but the engines are held by value and called without
+// virtual dispatch, and the merged results of `GetTernary` and `GetIntervals`
+// are memoized per node. The memo is dropped by `Populate` and by any change
+// to the function populated, as stateless answers may depend on it.
+//
+// The same `const` restriction as for UnionQueryEngine applies.
+template <typename... Engines>
+class StaticUnionQueryEngine final : public QueryEngine, public ChangeListener {
+ public:
+  static_assert(sizeof...(Engines) > 0);
+  static_assert((std::is_base_of_v<QueryEngine, Engines> && ...));
+
+  StaticUnionQueryEngine() = default;
+  explicit StaticUnionQueryEngine(Engines... engines)
+      : engines_(std::move(engines)...) {}
+  ~StaticUnionQueryEngine() override {
+    if (f_ != nullptr) {
+      f_->UnregisterChangeListener(this);
+    }
+  }
+
+  // Registered as a change listener, so not copyable or movable.
+  StaticUnionQueryEngine(const StaticUnionQueryEngine&) = delete;
+  StaticUnionQueryEngine& operator=(const StaticUnionQueryEngine&) = delete;
+
+  // Returns the unioned engine of type `E`.
+  template <typename E>
+  E& engine() {
+    return std::get<E>(engines_);
+  }
+  template <typename E>
+  const E& engine() const {
+    return std::get<E>(engines_);
+  }
+
+  absl::StatusOr<ReachedFixpoint> Populate(FunctionBase* f) override {
+    InvalidateMemo();
+    if (f != f_) {
+      if (f_ != nullptr) {
+        f_->UnregisterChangeListener(this);
+      }
+      f_ = f;
+      f_->RegisterChangeListener(this);
+    }
+    ReachedFixpoint result = ReachedFixpoint::Unchanged;
+    absl::Status status = absl::OkStatus();
+    std::apply(
+        [&](Engines&... engines) {
+          (
+              [&]<typename E>(E& e) {
+                if (!status.ok()) {
+                  return;
+                }
+                absl::StatusOr<ReachedFixpoint> rf = e.E::Populate(f);
+                if (!rf.ok()) {
+                  status = rf.status();
+                  return;
+                }
+                // Same lattice as UnownedUnionQueryEngine::Populate.
+                if (result == ReachedFixpoint::Unchanged) {
+                  result = *rf;
+                } else if (result == ReachedFixpoint::Changed &&
+                           *rf == ReachedFixpoint::Unknown) {
+                  result = ReachedFixpoint::Unknown;
+                }
+              }(engines),
+              ...);
+        },
+        engines_);
+    if (!status.ok()) {
+      return status;
+    }
+    return result;
+  }
+
+  bool IsTracked(Node* node) const override {
+    return AnyOf(
+        [&]<typename E>(const E& e) { return e.E::IsTracked(node); });
+  }
+
+  std::optional<SharedLeafTypeTree<TernaryVector>> GetTernary(
+      Node* node) const override {
+    if (auto it = ternary_memo_.find(node); it != ternary_memo_.end()) {
+      return it->second.AsShared();
+    }
+    std::optional<SharedLeafTypeTree<TernaryVector>> shared;
+    std::optional<LeafTypeTree<TernaryVector>> owned;
+    ForEach([&]<typename E>(const E& e) {
+      if (!e.E::IsTracked(node)) {
+        return;
+      }
+      std::optional<SharedLeafTypeTree<TernaryVector>> ternary =
+          e.E::GetTernary(node);
+      if (!ternary) {
+        return;
+      }
+      if (!shared && !owned) {
+        // Avoid copying if only one engine knows anything.
+        shared = *std::move(ternary);
+        return;
+      }
+      if (shared) {
+        owned = std::move(*shared).ToOwned();
+        shared.reset();
+      }
+      leaf_type_tree::SimpleUpdateFrom<TernaryVector, TernaryVector>(
+          owned->AsMutableView(), ternary->AsView(),
+          [](TernaryVector& lhs, const TernaryVector& rhs) {
+            CHECK_OK(ternary_ops::UpdateWithUnion(lhs, rhs));
+          });
+    });
+    if (!owned) {
+      return shared;
+    }
+    // The memo shares its elements with the returned tree, so the result stays
+    // valid after the memo is dropped.
+    auto [it, inserted] = ternary_memo_.emplace(
+        node, CopyOnWriteLeafTypeTree<TernaryVector>(*std::move(owned)));
+    return it->second.AsShared();
+  }
+
+  LeafTypeTree<IntervalSet> GetIntervals(Node* node) const override {
+    if (auto it = interval_memo_.find(node); it != interval_memo_.end()) {
+      return it->second.ToOwned();
+    }
+    LeafTypeTree<IntervalSet> result(node->GetType());
+    for (int64_t i = 0; i < result.size(); ++i) {
+      result.elements()[i] =
+          IntervalSet::Maximal(result.leaf_types()[i]->GetFlatBitCount());
+    }
+    ForEach([&]<typename E>(const E& e) {
+      if (e.E::IsTracked(node)) {
+        leaf_type_tree::SimpleUpdateFrom<IntervalSet, IntervalSet>(
+            result.AsMutableView(), e.E::GetIntervals(node).AsView(),
+            [](IntervalSet& lhs, const IntervalSet& rhs) {
+              lhs = IntervalSet::Intersect(lhs, rhs);
+            });
+      }
+    });
+    interval_memo_.emplace(node, CopyOnWriteLeafTypeTree<IntervalSet>(result));
+    return result;
+  }
+
+  std::unique_ptr<QueryEngine> SpecializeGivenPredicate(
+      const absl::flat_hash_set<PredicateState>& state) const override {
+    std::vector<std::unique_ptr<QueryEngine>> engines;
+    engines.reserve(sizeof...(Engines));
+    ForEach([&]<typename E>(const E& e) {
+      engines.push_back(e.E::SpecializeGivenPredicate(state));
+    });
+    return std::make_unique<UnionQueryEngine>(std::move(engines));
+  }
+
+  std::unique_ptr<QueryEngine> SpecializeGiven(
+      const absl::flat_hash_map<Node*, ValueKnowledge>& givens) const override {
+    std::vector<std::unique_ptr<QueryEngine>> engines;
+    engines.reserve(sizeof...(Engines));
+    ForEach([&]<typename E>(const E& e) {
+      engines.push_back(e.E::SpecializeGiven(givens));
+    });
+    return std::make_unique<UnionQueryEngine>(std::move(engines));
+  }
+
+  bool AtMostOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return AnyOf(
+        [&]<typename E>(const E& e) { return e.E::AtMostOneTrue(bits); });
+  }
+
+  bool AtLeastOneTrue(absl::Span<TreeBitLocation const> bits) const override {
+    return AnyOf(
+        [&]<typename E>(const E& e) { return e.E::AtLeastOneTrue(bits); });
+  }
+
+  bool KnownEquals(const TreeBitLocation& a,
+                   const TreeBitLocation& b) const override {
+    return AnyOf(
+        [&]<typename E>(const E& e) { return e.E::KnownEquals(a, b); });
+  }
+
+  bool KnownNotEquals(const TreeBitLocation& a,
+                      const TreeBitLocation& b) const override {
+    return AnyOf(
+        [&]<typename E>(const E& e) { return e.E::KnownNotEquals(a, b); });
+  }
+
+  bool Implies(const TreeBitLocation& a,
+               const TreeBitLocation& b) const override {
+    return AnyOf([&]<typename E>(const E& e) { return e.E::Implies(a, b); });
+  }
+
+  std::optional<Bits> ImpliedNodeValue(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    std::optional<Bits> result;
+    AnyOf([&]<typename E>(const E& e) {
+      result = e.E::ImpliedNodeValue(predicate_bit_values, node);
+      return result.has_value();
+    });
+    return result;
+  }
+
+  std::optional<TernaryVector> ImpliedNodeTernary(
+      absl::Span<const std::pair<TreeBitLocation, bool>> predicate_bit_values,
+      Node* node) const override {
+    std::optional<TernaryVector> result;
+    ForEach([&]<typename E>(const E& e) {
+      std::optional<TernaryVector> implied =
+          e.E::ImpliedNodeTernary(predicate_bit_values, node);
+      if (!implied.has_value()) {
+        return;
+      }
+      if (result.has_value()) {
+        CHECK_OK(ternary_ops::UpdateWithUnion(*result, *implied));
+      } else {
+        result = std::move(implied);
+      }
+    });
+    return result;
+  }
+
+  bool IsKnown(const TreeBitLocation& bit) const override {
+    return AnyOf([&]<typename E>(const E& e) { return e.E::IsKnown(bit); });
+  }
+  using QueryEngine::KnownValue;
+  std::optional<bool> KnownValue(const TreeBitLocation& bit) const override {
+    std::optional<bool> result;
+    AnyOf([&]<typename E>(const E& e) {
+      result = e.E::KnownValue(bit);
+      return result.has_value();
+    });
+    return result;
+  }
+  bool IsAllZeros(Node* n) const override {
+    bool result = false;
+    if (AnyOf([&]<typename E>(const E& e) {
+          if (!e.E::IsFullyKnown(n)) {
+            return false;
+          }
+          result = e.E::IsAllZeros(n);
+          return true;
+        })) {
+      return result;
+    }
+    if constexpr (sizeof...(Engines) <= 1) {
+      return false;
+    } else {
+      return QueryEngine::IsAllZeros(n);
+    }
+  }
+  bool IsAllOnes(Node* n) const override {
+    bool result = false;
+    if (AnyOf([&]<typename E>(const E& e) {
+          if (!e.E::IsFullyKnown(n)) {
+            return false;
+          }
+          result = e.E::IsAllOnes(n);
+          return true;
+        })) {
+      return result;
+    }
+    if constexpr (sizeof...(Engines) <= 1) {
+      return false;
+    } else {
+      return QueryEngine::IsAllOnes(n);
+    }
+  }
+
+  Bits MaxUnsignedValue(Node* node) const override {
+    CHECK(node->GetType()->IsBits()) << node;
+    std::optional<Bits> result;
+    ForEach([&]<typename E>(const E& e) {
+      Bits eng_res = e.E::IsTracked(node)
+                         ? e.E::MaxUnsignedValue(node)
+                         : Bits::AllOnes(node->BitCountOrDie());
+      if (!result.has_value() || bits_ops::ULessThan(eng_res, *result)) {
+        result = std::move(eng_res);
+      }
+    });
+    return *std::move(result);
+  }
+  Bits MinUnsignedValue(Node* node) const override {
+    CHECK(node->GetType()->IsBits()) << node;
+    std::optional<Bits> result;
+    ForEach([&]<typename E>(const E& e) {
+      Bits eng_res = e.E::IsTracked(node) ? e.E::MinUnsignedValue(node)
+                                          : Bits(node->BitCountOrDie());
+      if (!result.has_value() || bits_ops::UGreaterThan(eng_res, *result)) {
+        result = std::move(eng_res);
+      }
+    });
+    return *std::move(result);
+  }
+
+  // ChangeListener implementation. Adding a node can't change the answer for
+  // any existing node, but everything else may.
+  void NodeDeleted(Node* node) override { InvalidateMemo(); }
+  void OperandChanged(Node* node, Node* old_operand,
+                      absl::Span<const int64_t> operand_nos) override {
+    InvalidateMemo();
+  }
+  void OperandRemoved(Node* node, Node* old_operand) override {
+    InvalidateMemo();
+  }
+  void OperandAdded(Node* node) override { InvalidateMemo(); }
+  void FunctionBaseDeleted(FunctionBase* function_base) override {
+    InvalidateMemo();
+    f_ = nullptr;
+  }
+
+ private:
+  // Calls `fn` on each engine in order.
+  template <typename Fn>
+  void ForEach(Fn&& fn) const {
+    std::apply([&](const Engines&... engines) { (fn(engines), ...); },
+               engines_);
+  }
+  // Calls `fn` on each engine in order until it returns true. Returns whether
+  // any call did.
+  template <typename Fn>
+  bool AnyOf(Fn&& fn) const {
+    return std::apply(
+        [&](const Engines&... engines) { return (fn(engines) || ...); },
+        engines_);
+  }
+
+  void InvalidateMemo() {
+    if (!ternary_memo_.empty()) {
+      ternary_memo_.clear();
+    }
+    if (!interval_memo_.empty()) {
+      interval_memo_.clear();
+    }
+  }
+
+  std::tuple<Engines...> engines_;
+  FunctionBase* f_ = nullptr;
+  mutable absl::flat_hash_map<Node*, CopyOnWriteLeafTypeTree<TernaryVector>>
+      ternary_memo_;
+  mutable absl::flat_hash_map<Node*, CopyOnWriteLeafTypeTree<IntervalSet>>
+      interval_memo_;
+};
+
 }  // namespace xls
 
 #endif  // XLS_PASSES_UNION_QUERY_ENGINE_H_
@@ -39,6 +39,7 @@
 #include "xls/ir/ternary.h"
 #include "xls/ir/type.h"
 #include "xls/passes/query_engine.h"
+#include "xls/passes/stateless_query_engine.h"
 
 namespace xls {
 namespace {
@@ -431,5 +432,82 @@ TEST_F(UnionQueryEngineTest, TokenValueUnknown) {
   EXPECT_EQ(union_query_engine.KnownValue(tok.node()), std::nullopt);
 }
 
+TEST_F(UnionQueryEngineTest, StaticMatchesDynamic) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", fb.package()->GetBitsType(8));
+  BValue y = fb.Param("y", fb.package()->GetBitsType(8));
+  BValue tuple = fb.Tuple({x, y});
+  XLS_ASSERT_OK(fb.Build());
+
+  FakeQueryEngine query_engine_a;
+  query_engine_a.AddKnownBit(TreeBitLocation(x.node(), 4), true);
+  query_engine_a.AddImplication(TreeBitLocation(x.node(), 3),
+                                TreeBitLocation(x.node(), 7));
+  IntervalSet x_a = IntervalSet::Of({Interval(UBits(20, 8), UBits(40, 8))});
+  query_engine_a.AddIntervals(
+      tuple.node(), LeafTypeTree<IntervalSet>(tuple.node()->GetType(),
+                                              {x_a, IntervalSet::Maximal(8)}));
+  FakeQueryEngine query_engine_b;
+  query_engine_b.AddKnownBit(TreeBitLocation(x.node(), 0), false);
+  query_engine_b.AddInequality(TreeBitLocation(x.node(), 2),
+                               TreeBitLocation(x.node(), 3));
+  IntervalSet y_b = IntervalSet::Of({Interval(UBits(200, 8), UBits(240, 8))});
+  query_engine_b.AddIntervals(
+      tuple.node(), LeafTypeTree<IntervalSet>(tuple.node()->GetType(),
+                                              {IntervalSet::Maximal(8), y_b}));
+  std::vector<std::unique_ptr<QueryEngine>> engines;
+  engines.push_back(std::make_unique<FakeQueryEngine>(query_engine_a));
+  engines.push_back(std::make_unique<FakeQueryEngine>(query_engine_b));
+  UnionQueryEngine union_query_engine(std::move(engines));
+  StaticUnionQueryEngine<FakeQueryEngine, FakeQueryEngine> static_query_engine(
+      query_engine_a, query_engine_b);
+
+  for (QueryEngine* engine :
+       std::vector<QueryEngine*>{&union_query_engine, &static_query_engine}) {
+    EXPECT_TRUE(engine->IsTracked(x.node()));
+    EXPECT_FALSE(engine->IsTracked(y.node()));
+    // Query twice to exercise the memoized result.
+    EXPECT_EQ(ToString(engine->GetTernary(x.node())->Get({})), "0bXXX1_XXX0");
+    EXPECT_EQ(ToString(engine->GetTernary(x.node())->Get({})), "0bXXX1_XXX0");
+    EXPECT_TRUE(engine->KnownNotEquals(TreeBitLocation(x.node(), 2),
+                                       TreeBitLocation(x.node(), 3)));
+    EXPECT_TRUE(engine->Implies(TreeBitLocation(x.node(), 3),
+                                TreeBitLocation(x.node(), 7)));
+    EXPECT_FALSE(engine->Implies(TreeBitLocation(x.node(), 7),
+                                 TreeBitLocation(x.node(), 3)));
+    for (int64_t i = 0; i < 2; ++i) {
+      LeafTypeTree<IntervalSet> tuple_intervals =
+          engine->GetIntervals(tuple.node());
+      EXPECT_EQ(tuple_intervals.elements()[0], x_a);
+      EXPECT_EQ(tuple_intervals.elements()[1], y_b);
+    }
+  }
+}
+
+TEST_F(UnionQueryEngineTest, StaticMemoDroppedOnChange) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", fb.package()->GetBitsType(4));
+  BValue y = fb.Param("y", fb.package()->GetBitsType(2));
+  BValue ext = fb.ZeroExtend(x, 8);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // Two engines which both have an answer, so the merged result is memoized.
+  StaticUnionQueryEngine<StatelessQueryEngine, StatelessQueryEngine>
+      query_engine;
+  XLS_ASSERT_OK(query_engine.Populate(f));
+  std::optional<SharedLeafTypeTree<TernaryVector>> before =
+      query_engine.GetTernary(ext.node());
+  ASSERT_TRUE(before.has_value());
+  EXPECT_EQ(ToString(before->Get({})), "0b0000_XXXX");
+
+  XLS_ASSERT_OK(ext.node()->ReplaceOperandNumber(0, y.node()));
+  EXPECT_EQ(ToString(query_engine.GetTernary(ext.node())->Get({})),
+            "0b0000_00XX");
+  // Results handed out before the change stay valid.
+  EXPECT_EQ(ToString(before->Get({})), "0b0000_XXXX");
+}
+
 }  // namespace
 }  // namespace xls
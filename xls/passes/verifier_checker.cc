@@ -14,7 +14,11 @@
 
 #include "xls/passes/verifier_checker.h"
 
+#include <memory>
+
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
@@ -24,6 +28,28 @@ namespace xls {
 absl::Status VerifierChecker::Run(Package* p,
                                   const OptimizationPassOptions& options,
                                   PassResults* results) const {
+  if (!incremental_) {
+    return VerifyPackage(p);
+  }
+  absl::MutexLock lock(&mutex_);
+  std::unique_ptr<IncrementalVerifier>& verifier = verifiers_[p];
+  if (verifier == nullptr) {
+    verifier = std::make_unique<IncrementalVerifier>(p);
+  }
+  return verifier->Verify();
+}
+
+absl::Status VerifierChecker::RunAtEnd(Package* p,
+                                       const OptimizationPassOptions& options,
+                                       PassResults* results) const {
+  if (!incremental_) {
+    return absl::OkStatus();
+  }
+  {
+    // The next run on the package starts over with a full verification.
+    absl::MutexLock lock(&mutex_);
+    verifiers_.erase(p);
+  }
   return VerifyPackage(p);
 }
 
@@ -15,18 +15,39 @@
 #ifndef XLS_PASSES_VERIFIER_CHECKER_H_
 #define XLS_PASSES_VERIFIER_CHECKER_H_
 
+#include <memory>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/synchronization/mutex.h"
 #include "xls/ir/package.h"
+#include "xls/ir/verifier.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_base.h"
 
 namespace xls {
 
-// Invariant checker which just runs xls::Verifier.
+// Invariant checker which runs xls::Verifier. By default the verification is
+// incremental (see IncrementalVerifier): the package is verified in full the
+// first time the checker runs on it and at the end of the compound pass to
+// which the checker was added, and in between only the changes made by each
+// pass are verified.
 class VerifierChecker : public OptimizationInvariantChecker {
  public:
+  explicit VerifierChecker(bool incremental = true)
+      : incremental_(incremental) {}
+
   absl::Status Run(Package* p, const OptimizationPassOptions& options,
                    PassResults* results) const override;
+  absl::Status RunAtEnd(Package* p, const OptimizationPassOptions& options,
+                        PassResults* results) const override;
+
+ private:
+  bool incremental_;
+  mutable absl::Mutex mutex_;
+  mutable absl::flat_hash_map<Package*, std::unique_ptr<IncrementalVerifier>>
+      verifiers_ ABSL_GUARDED_BY(mutex_);
 };
 
 }  // namespace xls
@@ -27,28 +27,181 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "llvm/include/llvm/IR/DataLayout.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/function_interpreter.h"
+#include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bit_push_buffer.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/block.h"
 #include "xls/ir/events.h"
 #include "xls/ir/format_preference.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/package.h"
+#include "xls/ir/register.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/jit/block_jit.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/jit/llvm_type_converter.h"
+#include "xls/jit/orc_jit.h"
+#include "xls/jit/type_layout.h"
 #include "xls/public/c_api_format_preference.h"
 #include "xls/public/c_api_impl_helpers.h"
 #include "xls/public/c_api_vast.h"
 #include "xls/public/runtime_build_actions.h"
 
+namespace {
+
+std::vector<xls::Value> ToCppValues(absl::Span<const xls_value* const> values) {
+  std::vector<xls::Value> result;
+  result.reserve(values.size());
+  for (const xls_value* value : values) {
+    CHECK(value != nullptr);
+    result.push_back(*reinterpret_cast<const xls::Value*>(value));
+  }
+  return result;
+}
+
+// Adapts `status` to the C API convention of returning whether the call
+// succeeded and populating `error_out` otherwise.
+bool ReturnStatus(const absl::Status& status, char** error_out) {
+  if (!status.ok()) {
+    *error_out = xls::ToOwnedCString(status.ToString());
+    return false;
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+absl::Status BufferTooSmallError(const xls::TypeLayout& layout,
+                                 size_t buffer_size) {
+  return absl::InvalidArgumentError(absl::StrFormat(
+      "Buffer of %d bytes is too small for a value of type %s (%d bytes)",
+      buffer_size, layout.type()->ToString(), layout.size()));
+}
+
+absl::Status ValueToBuffer(const xls::TypeLayout& layout,
+                           const xls::Value& value,
+                           absl::Span<uint8_t> buffer) {
+  if (!xls::ValueConformsToType(value, layout.type())) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Value %s is not of type %s", value.ToString(),
+                        layout.type()->ToString()));
+  }
+  if (buffer.size() < layout.size()) {
+    return BufferTooSmallError(layout, buffer.size());
+  }
+  layout.ValueToNativeLayout(value, buffer.data());
+  return absl::OkStatus();
+}
+
+// Returns an error if `layout` is not a layout of `type`, naming the use of
+// the layout in the message.
+absl::Status CheckLayoutType(const xls::TypeLayout& layout, xls::Type* type,
+                             std::string_view what) {
+  if (!layout.type()->IsEqualTo(type)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Layout of %s has type %s, expected %s", what,
+        layout.type()->ToString(), type->ToString()));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<xls::TypeLayout> CreateTypeLayout(xls::Type* type) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<xls::OrcJit> orc_jit,
+                       xls::OrcJit::Create());
+  XLS_ASSIGN_OR_RETURN(llvm::DataLayout data_layout,
+                       orc_jit->CreateDataLayout());
+  xls::LlvmTypeConverter type_converter(orc_jit->GetContext(), data_layout);
+  return type_converter.CreateTypeLayout(type);
+}
+
+// The state behind an `xls_block_jit`: the jitted block, its continuation and
+// the values currently driven on its input ports.
+class BlockJitRuntime {
+ public:
+  static absl::StatusOr<std::unique_ptr<BlockJitRuntime>> Create(
+      xls::Package* package, std::string_view block_name) {
+    XLS_ASSIGN_OR_RETURN(xls::Block * block, package->GetBlock(block_name));
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<xls::BlockJit> jit,
+                         xls::BlockJit::Create(block));
+    std::unique_ptr<xls::BlockJitContinuation> continuation =
+        jit->NewContinuation();
+    absl::flat_hash_map<std::string, xls::Value> inputs;
+    for (xls::InputPort* port : block->GetInputPorts()) {
+      inputs[port->name()] = xls::ZeroOfType(port->GetType());
+    }
+    absl::flat_hash_map<std::string, xls::Value> registers;
+    for (xls::Register* reg : block->GetRegisters()) {
+      registers[reg->name()] = xls::ZeroOfType(reg->type());
+    }
+    XLS_RETURN_IF_ERROR(continuation->SetRegisters(registers));
+    return absl::WrapUnique(new BlockJitRuntime(
+        std::move(jit), std::move(continuation), std::move(inputs)));
+  }
+
+  absl::Status SetInputPort(std::string_view name, const xls::Value& value) {
+    auto it = inputs_.find(name);
+    if (it == inputs_.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("No input port named `%s`", name));
+    }
+    it->second = value;
+    return absl::OkStatus();
+  }
+
+  absl::Status RunCycles(int64_t cycle_count) {
+    XLS_RETURN_IF_ERROR(continuation_->SetInputPorts(inputs_));
+    continuation_->ClearEvents();
+    for (int64_t i = 0; i < cycle_count; ++i) {
+      XLS_RETURN_IF_ERROR(jit_->RunOneCycle(*continuation_));
+    }
+    return xls::InterpreterEventsToStatus(continuation_->GetEvents());
+  }
+
+  absl::StatusOr<xls::Value> GetOutputPort(std::string_view name) const {
+    absl::flat_hash_map<std::string, xls::Value> outputs =
+        continuation_->GetOutputPortsMap();
+    auto it = outputs.find(name);
+    if (it == outputs.end()) {
+      return absl::NotFoundError(
+          absl::StrFormat("No output port named `%s`", name));
+    }
+    return std::move(it->second);
+  }
+
+ private:
+  BlockJitRuntime(std::unique_ptr<xls::BlockJit> jit,
+                  std::unique_ptr<xls::BlockJitContinuation> continuation,
+                  absl::flat_hash_map<std::string, xls::Value> inputs)
+      : jit_(std::move(jit)),
+        continuation_(std::move(continuation)),
+        inputs_(std::move(inputs)) {}
+
+  std::unique_ptr<xls::BlockJit> jit_;
+  std::unique_ptr<xls::BlockJitContinuation> continuation_;
+  absl::flat_hash_map<std::string, xls::Value> inputs_;
+};
+
+}  // namespace
+
 extern "C" {
 
 void xls_init_xls(const char* usage, int argc, char* argv[]) {
@@ -560,4 +713,443 @@ bool xls_interpret_function(struct xls_function* function, size_t argc,
   return true;
 }
 
+int64_t xls_function_type_get_param_count(
+    struct xls_function_type* xls_function_type) {
+  CHECK(xls_function_type != nullptr);
+  return reinterpret_cast<xls::FunctionType*>(xls_function_type)
+      ->parameter_count();
+}
+
+bool xls_function_type_get_param_type(
+    struct xls_function_type* xls_function_type, int64_t index,
+    char** error_out, struct xls_type** result_out) {
+  CHECK(xls_function_type != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  xls::FunctionType* ft =
+      reinterpret_cast<xls::FunctionType*>(xls_function_type);
+  if (index < 0 || index >= ft->parameter_count()) {
+    *result_out = nullptr;
+    *error_out = xls::ToOwnedCString(absl::StrFormat(
+        "Parameter index %d out of range for function type %s", index,
+        ft->ToString()));
+    return false;
+  }
+  *result_out = reinterpret_cast<struct xls_type*>(ft->parameter_type(index));
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_function_type_get_return_type(
+    struct xls_function_type* xls_function_type, char** error_out,
+    struct xls_type** result_out) {
+  CHECK(xls_function_type != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  *result_out = reinterpret_cast<struct xls_type*>(
+      reinterpret_cast<xls::FunctionType*>(xls_function_type)->return_type());
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_type_layout_create(struct xls_type* type, char** error_out,
+                            struct xls_type_layout** result_out) {
+  CHECK(type != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<xls::TypeLayout> layout =
+      CreateTypeLayout(reinterpret_cast<xls::Type*>(type));
+  if (!layout.ok()) {
+    *result_out = nullptr;
+    *error_out = xls::ToOwnedCString(layout.status().ToString());
+    return false;
+  }
+  *result_out = reinterpret_cast<struct xls_type_layout*>(
+      new xls::TypeLayout(*std::move(layout)));
+  *error_out = nullptr;
+  return true;
+}
+
+void xls_type_layout_free(struct xls_type_layout* layout) {
+  delete reinterpret_cast<xls::TypeLayout*>(layout);
+}
+
+int64_t xls_type_layout_get_size(const struct xls_type_layout* layout) {
+  CHECK(layout != nullptr);
+  return reinterpret_cast<const xls::TypeLayout*>(layout)->size();
+}
+
+int64_t xls_type_layout_get_element_count(
+    const struct xls_type_layout* layout) {
+  CHECK(layout != nullptr);
+  return reinterpret_cast<const xls::TypeLayout*>(layout)->elements().size();
+}
+
+void xls_type_layout_get_element(const struct xls_type_layout* layout,
+                                 int64_t index, int64_t* offset_out,
+                                 int64_t* data_size_out,
+                                 int64_t* padded_size_out) {
+  CHECK(layout != nullptr);
+  CHECK(offset_out != nullptr);
+  CHECK(data_size_out != nullptr);
+  CHECK(padded_size_out != nullptr);
+  const xls::ElementLayout& element =
+      reinterpret_cast<const xls::TypeLayout*>(layout)->elements().at(index);
+  *offset_out = element.offset;
+  *data_size_out = element.data_size;
+  *padded_size_out = element.padded_size;
+}
+
+bool xls_type_layout_value_to_buffer(const struct xls_type_layout* layout,
+                                     const struct xls_value* value,
+                                     uint8_t* buffer, size_t buffer_size,
+                                     char** error_out) {
+  CHECK(layout != nullptr);
+  CHECK(value != nullptr);
+  CHECK(buffer != nullptr);
+  CHECK(error_out != nullptr);
+  return ReturnStatus(
+      ValueToBuffer(*reinterpret_cast<const xls::TypeLayout*>(layout),
+                    *reinterpret_cast<const xls::Value*>(value),
+                    absl::MakeSpan(buffer, buffer_size)),
+      error_out);
+}
+
+bool xls_type_layout_buffer_to_value(const struct xls_type_layout* layout,
+                                     const uint8_t* buffer, size_t buffer_size,
+                                     char** error_out,
+                                     struct xls_value** result_out) {
+  CHECK(layout != nullptr);
+  CHECK(buffer != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  const xls::TypeLayout* xls_layout =
+      reinterpret_cast<const xls::TypeLayout*>(layout);
+  if (buffer_size < xls_layout->size()) {
+    *result_out = nullptr;
+    return ReturnStatus(BufferTooSmallError(*xls_layout, buffer_size),
+                        error_out);
+  }
+  *result_out = reinterpret_cast<struct xls_value*>(
+      new xls::Value(xls_layout->NativeLayoutToValue(buffer)));
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_interpret_function_with_buffers(
+    struct xls_function* function, size_t argc,
+    const struct xls_type_layout** arg_layouts, const uint8_t* const* args,
+    const struct xls_type_layout* result_layout, uint8_t* result,
+    char** error_out) {
+  CHECK(function != nullptr);
+  CHECK((arg_layouts != nullptr && args != nullptr) || argc == 0);
+  CHECK(result_layout != nullptr);
+  CHECK(result != nullptr);
+  CHECK(error_out != nullptr);
+  xls::Function* xls_function = reinterpret_cast<xls::Function*>(function);
+  absl::Status status = [&]() -> absl::Status {
+    XLS_RET_CHECK_EQ(argc, xls_function->params().size());
+    std::vector<xls::Value> xls_args;
+    xls_args.reserve(argc);
+    for (size_t i = 0; i < argc; ++i) {
+      CHECK(arg_layouts[i] != nullptr);
+      const xls::TypeLayout* layout =
+          reinterpret_cast<const xls::TypeLayout*>(arg_layouts[i]);
+      XLS_RETURN_IF_ERROR(CheckLayoutType(
+          *layout, xls_function->param(i)->GetType(),
+          absl::StrFormat("argument %d", i)));
+      xls_args.push_back(layout->NativeLayoutToValue(args[i]));
+    }
+    const xls::TypeLayout* xls_result_layout =
+        reinterpret_cast<const xls::TypeLayout*>(result_layout);
+    XLS_RETURN_IF_ERROR(CheckLayoutType(*xls_result_layout,
+                                        xls_function->GetType()->return_type(),
+                                        "result"));
+    XLS_ASSIGN_OR_RETURN(
+        xls::Value value,
+        xls::DropInterpreterEvents(
+            xls::InterpretFunction(xls_function, xls_args)));
+    xls_result_layout->ValueToNativeLayout(value, result);
+    return absl::OkStatus();
+  }();
+  return ReturnStatus(status, error_out);
+}
+
+bool xls_function_jit_create(struct xls_function* function, char** error_out,
+                             struct xls_function_jit** result_out) {
+  CHECK(function != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<std::unique_ptr<xls::FunctionJit>> jit =
+      xls::FunctionJit::Create(reinterpret_cast<xls::Function*>(function));
+  if (!jit.ok()) {
+    *result_out = nullptr;
+    *error_out = xls::ToOwnedCString(jit.status().ToString());
+    return false;
+  }
+  *result_out = reinterpret_cast<struct xls_function_jit*>(jit->release());
+  *error_out = nullptr;
+  return true;
+}
+
+void xls_function_jit_free(struct xls_function_jit* jit) {
+  delete reinterpret_cast<xls::FunctionJit*>(jit);
+}
+
+bool xls_function_jit_run(struct xls_function_jit* jit, size_t argc,
+                          const struct xls_value** args, char** error_out,
+                          struct xls_value** result_out) {
+  CHECK(jit != nullptr);
+  CHECK(args != nullptr || argc == 0);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<xls::Value> result =
+      xls::DropInterpreterEvents(reinterpret_cast<xls::FunctionJit*>(jit)->Run(
+          ToCppValues(absl::MakeConstSpan(args, argc))));
+  if (!result.ok()) {
+    *result_out = nullptr;
+    *error_out = xls::ToOwnedCString(result.status().ToString());
+    return false;
+  }
+  *result_out = reinterpret_cast<struct xls_value*>(
+      new xls::Value(*std::move(result)));
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_function_jit_run_batched(struct xls_function_jit* jit,
+                                  size_t batch_size, size_t argc,
+                                  const struct xls_value** args,
+                                  char** error_out,
+                                  struct xls_value** results_out) {
+  CHECK(jit != nullptr);
+  CHECK(args != nullptr || batch_size * argc == 0);
+  CHECK(error_out != nullptr);
+  CHECK(results_out != nullptr || batch_size == 0);
+  std::vector<std::vector<xls::Value>> batch;
+  batch.reserve(batch_size);
+  for (size_t i = 0; i < batch_size; ++i) {
+    batch.push_back(ToCppValues(absl::MakeConstSpan(args + i * argc, argc)));
+  }
+  absl::StatusOr<std::vector<xls::Value>> results = xls::DropInterpreterEvents(
+      reinterpret_cast<xls::FunctionJit*>(jit)->RunBatched(batch));
+  if (!results.ok()) {
+    *error_out = xls::ToOwnedCString(results.status().ToString());
+    return false;
+  }
+  for (size_t i = 0; i < batch_size; ++i) {
+    results_out[i] = reinterpret_cast<struct xls_value*>(
+        new xls::Value(std::move((*results)[i])));
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+int64_t xls_function_jit_get_arg_buffer_size(struct xls_function_jit* jit,
+                                             int64_t arg_index) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetArgTypeSize(arg_index);
+}
+
+int64_t xls_function_jit_get_arg_buffer_alignment(struct xls_function_jit* jit,
+                                                  int64_t arg_index) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetArgTypeAlignment(
+      arg_index);
+}
+
+int64_t xls_function_jit_get_result_buffer_size(struct xls_function_jit* jit) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetReturnTypeSize();
+}
+
+int64_t xls_function_jit_get_result_buffer_alignment(
+    struct xls_function_jit* jit) {
+  CHECK(jit != nullptr);
+  return reinterpret_cast<xls::FunctionJit*>(jit)->GetReturnTypeAlignment();
+}
+
+bool xls_function_jit_run_batched_with_buffers(struct xls_function_jit* jit,
+                                               size_t batch_size, size_t argc,
+                                               uint8_t* const* args,
+                                               uint8_t* const* results,
+                                               char** error_out) {
+  CHECK(jit != nullptr);
+  CHECK(args != nullptr || batch_size * argc == 0);
+  CHECK(results != nullptr || batch_size == 0);
+  CHECK(error_out != nullptr);
+  xls::FunctionJit* xls_jit = reinterpret_cast<xls::FunctionJit*>(jit);
+  const int64_t result_size = xls_jit->GetReturnTypeSize();
+  xls::InterpreterEvents events;
+  for (size_t i = 0; i < batch_size; ++i) {
+    absl::Status status = xls_jit->RunWithViews(
+        absl::MakeConstSpan(args + i * argc, argc),
+        absl::MakeSpan(results[i], result_size), &events);
+    if (status.ok()) {
+      status = xls::InterpreterEventsToStatus(events);
+    }
+    if (!status.ok()) {
+      *error_out = xls::ToOwnedCString(status.ToString());
+      return false;
+    }
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_proc_jit_runtime_create(struct xls_package* package, char** error_out,
+                                 struct xls_proc_jit_runtime** result_out) {
+  CHECK(package != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<std::unique_ptr<xls::SerialProcRuntime>> runtime =
+      xls::CreateJitSerialProcRuntime(reinterpret_cast<xls::Package*>(package));
+  if (!runtime.ok()) {
+    *result_out = nullptr;
+    *error_out = xls::ToOwnedCString(runtime.status().ToString());
+    return false;
+  }
+  *result_out =
+      reinterpret_cast<struct xls_proc_jit_runtime*>(runtime->release());
+  *error_out = nullptr;
+  return true;
+}
+
+void xls_proc_jit_runtime_free(struct xls_proc_jit_runtime* runtime) {
+  delete reinterpret_cast<xls::SerialProcRuntime*>(runtime);
+}
+
+bool xls_proc_jit_runtime_tick(struct xls_proc_jit_runtime* runtime,
+                               char** error_out) {
+  CHECK(runtime != nullptr);
+  CHECK(error_out != nullptr);
+  absl::Status status =
+      reinterpret_cast<xls::SerialProcRuntime*>(runtime)->Tick();
+  return ReturnStatus(status, error_out);
+}
+
+bool xls_proc_jit_runtime_tick_until_blocked(
+    struct xls_proc_jit_runtime* runtime, int64_t max_ticks, char** error_out,
+    int64_t* ticks_out) {
+  CHECK(runtime != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(ticks_out != nullptr);
+  absl::StatusOr<int64_t> ticks =
+      reinterpret_cast<xls::SerialProcRuntime*>(runtime)->TickUntilBlocked(
+          max_ticks);
+  if (!ticks.ok()) {
+    return ReturnStatus(ticks.status(), error_out);
+  }
+  *ticks_out = *ticks;
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_proc_jit_runtime_push_channel_value(
+    struct xls_proc_jit_runtime* runtime, const char* channel_name,
+    const struct xls_value* value, char** error_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(value != nullptr);
+  CHECK(error_out != nullptr);
+  absl::StatusOr<xls::ChannelQueue*> queue =
+      reinterpret_cast<xls::SerialProcRuntime*>(runtime)
+          ->queue_manager()
+          .GetQueueByName(channel_name);
+  if (!queue.ok()) {
+    return ReturnStatus(queue.status(), error_out);
+  }
+  return ReturnStatus(
+      (*queue)->Write(*reinterpret_cast<const xls::Value*>(value)), error_out);
+}
+
+bool xls_proc_jit_runtime_pop_channel_value(
+    struct xls_proc_jit_runtime* runtime, const char* channel_name,
+    char** error_out, struct xls_value** result_out) {
+  CHECK(runtime != nullptr);
+  CHECK(channel_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  *result_out = nullptr;
+  absl::StatusOr<xls::ChannelQueue*> queue =
+      reinterpret_cast<xls::SerialProcRuntime*>(runtime)
+          ->queue_manager()
+          .GetQueueByName(channel_name);
+  if (!queue.ok()) {
+    return ReturnStatus(queue.status(), error_out);
+  }
+  std::optional<xls::Value> value = (*queue)->Read();
+  if (value.has_value()) {
+    *result_out =
+        reinterpret_cast<struct xls_value*>(new xls::Value(*std::move(value)));
+  }
+  *error_out = nullptr;
+  return true;
+}
+
+bool xls_block_jit_create(struct xls_package* package, const char* block_name,
+                          char** error_out, struct xls_block_jit** result_out) {
+  CHECK(package != nullptr);
+  CHECK(block_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<std::unique_ptr<BlockJitRuntime>> runtime =
+      BlockJitRuntime::Create(reinterpret_cast<xls::Package*>(package),
+                              block_name);
+  if (!runtime.ok()) {
+    *result_out = nullptr;
+    *error_out = xls::ToOwnedCString(runtime.status().ToString());
+    return false;
+  }
+  *result_out = reinterpret_cast<struct xls_block_jit*>(runtime->release());
+  *error_out = nullptr;
+  return true;
+}
+
+void xls_block_jit_free(struct xls_block_jit* jit) {
+  delete reinterpret_cast<BlockJitRuntime*>(jit);
+}
+
+bool xls_block_jit_set_input_port(struct xls_block_jit* jit,
+                                  const char* port_name,
+                                  const struct xls_value* value,
+                                  char** error_out) {
+  CHECK(jit != nullptr);
+  CHECK(port_name != nullptr);
+  CHECK(value != nullptr);
+  CHECK(error_out != nullptr);
+  return ReturnStatus(
+      reinterpret_cast<BlockJitRuntime*>(jit)->SetInputPort(
+          port_name, *reinterpret_cast<const xls::Value*>(value)),
+      error_out);
+}
+
+bool xls_block_jit_run_cycles(struct xls_block_jit* jit, int64_t cycle_count,
+                              char** error_out) {
+  CHECK(jit != nullptr);
+  CHECK(error_out != nullptr);
+  return ReturnStatus(
+      reinterpret_cast<BlockJitRuntime*>(jit)->RunCycles(cycle_count),
+      error_out);
+}
+
+bool xls_block_jit_get_output_port(struct xls_block_jit* jit,
+                                   const char* port_name, char** error_out,
+                                   struct xls_value** result_out) {
+  CHECK(jit != nullptr);
+  CHECK(port_name != nullptr);
+  CHECK(error_out != nullptr);
+  CHECK(result_out != nullptr);
+  absl::StatusOr<xls::Value> value =
+      reinterpret_cast<BlockJitRuntime*>(jit)->GetOutputPort(port_name);
+  if (!value.ok()) {
+    *result_out = nullptr;
+    return ReturnStatus(value.status(), error_out);
+  }
+  *result_out =
+      reinterpret_cast<struct xls_value*>(new xls::Value(*std::move(value)));
+  *error_out = nullptr;
+  return true;
+}
+
 }  // extern "C"
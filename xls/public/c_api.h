@@ -50,6 +50,10 @@ struct xls_function_base;
 struct xls_type;
 struct xls_function_type;
 struct xls_schedule_and_codegen_result;
+struct xls_type_layout;
+struct xls_function_jit;
+struct xls_proc_jit_runtime;
+struct xls_block_jit;
 
 void xls_init_xls(const char* usage, int argc, char* argv[]);
 
@@ -246,6 +250,66 @@ bool xls_function_get_name(struct xls_function* function, char** error_out,
 bool xls_function_type_to_string(struct xls_function_type* xls_function_type,
                                  char** error_out, char** string_out);
 
+// Returns the number of parameters of the given `xls_function_type`.
+int64_t xls_function_type_get_param_count(
+    struct xls_function_type* xls_function_type);
+
+// Returns the type of parameter `index` of the given `xls_function_type`.
+bool xls_function_type_get_param_type(
+    struct xls_function_type* xls_function_type, int64_t index,
+    char** error_out, struct xls_type** result_out);
+
+// Returns the return type of the given `xls_function_type`.
+bool xls_function_type_get_return_type(
+    struct xls_function_type* xls_function_type, char** error_out,
+    struct xls_type** result_out);
+
+// -- Type layouts
+//
+// A type layout describes how a value of a type is stored in a flat byte
+// buffer: the native data layout used by the JIT on the host. Buffers in this
+// layout can be passed directly to the `_with_buffers` entry points below, so
+// that streaming values through the interpreter or JIT needs no `xls_value`
+// allocations. Each leaf (bits) element of the type is stored in host byte
+// order at its own byte offset, zero-padded to its padded size.
+
+// Creates the layout of `type`. The resulting `xls_type_layout` is owned by
+// the caller and must be freed via `xls_type_layout_free`; the package owning
+// `type` must outlive it.
+bool xls_type_layout_create(struct xls_type* type, char** error_out,
+                            struct xls_type_layout** result_out);
+
+void xls_type_layout_free(struct xls_type_layout* layout);
+
+// Returns the number of bytes a value in the layout occupies.
+int64_t xls_type_layout_get_size(const struct xls_type_layout* layout);
+
+// Returns the number of leaf elements of the layout, in the order they appear
+// in a flattening of the type.
+int64_t xls_type_layout_get_element_count(
+    const struct xls_type_layout* layout);
+
+// Returns the byte offset, the number of data bytes and the number of bytes
+// (including zero padding) of leaf element `index` of the layout.
+void xls_type_layout_get_element(const struct xls_type_layout* layout,
+                                 int64_t index, int64_t* offset_out,
+                                 int64_t* data_size_out,
+                                 int64_t* padded_size_out);
+
+// Writes `value` into `buffer`, which holds `buffer_size` bytes, in the given
+// layout.
+bool xls_type_layout_value_to_buffer(const struct xls_type_layout* layout,
+                                     const struct xls_value* value,
+                                     uint8_t* buffer, size_t buffer_size,
+                                     char** error_out);
+
+// Reads the value stored in `buffer` in the given layout into `result_out`
+// (owned by the caller).
+bool xls_type_layout_buffer_to_value(const struct xls_type_layout* layout,
+                                     const uint8_t* buffer, size_t buffer_size,
+                                     char** error_out,
+                                     struct xls_value** result_out);
+
 // Interprets the given `function` using the given `args` (an array of size
 // `argc`) -- interpretation runs to a function result placed in `result_out`,
 // or `error_out` is populated and false is returned in the event of an error.
@@ -253,6 +317,127 @@ bool xls_interpret_function(struct xls_function* function, size_t argc,
                             const struct xls_value** args, char** error_out,
                             struct xls_value** result_out);
 
+// As `xls_interpret_function`, but the `argc` arguments are read from `args`
+// and the result is written to `result`, buffers in the layouts given by
+// `arg_layouts` and `result_layout` respectively.
+bool xls_interpret_function_with_buffers(
+    struct xls_function* function, size_t argc,
+    const struct xls_type_layout** arg_layouts, const uint8_t* const* args,
+    const struct xls_type_layout* result_layout, uint8_t* result,
+    char** error_out);
+
+// -- Function JIT
+
+// Compiles the given `function` with the JIT. The resulting `xls_function_jit`
+// is owned by the caller and must be freed via `xls_function_jit_free`; the
+// package containing `function` must outlive it.
+bool xls_function_jit_create(struct xls_function* function, char** error_out,
+                             struct xls_function_jit** result_out);
+
+void xls_function_jit_free(struct xls_function_jit* jit);
+
+// Runs the jitted function using the given `args` (an array of size `argc`),
+// placing the result in `result_out`. Same contract as
+// `xls_interpret_function`.
+bool xls_function_jit_run(struct xls_function_jit* jit, size_t argc,
+                          const struct xls_value** args, char** error_out,
+                          struct xls_value** result_out);
+
+// Runs the jitted function `batch_size` times with a single call into the
+// jitted code. `args` is an array of `batch_size * argc` values where the
+// arguments of invocation `i` are `args[i * argc]` through
+// `args[i * argc + argc - 1]`. `results_out` is a caller-allocated array of
+// `batch_size` pointers which is populated with the results (each owned by
+// the caller) in the same order.
+bool xls_function_jit_run_batched(struct xls_function_jit* jit,
+                                  size_t batch_size, size_t argc,
+                                  const struct xls_value** args,
+                                  char** error_out,
+                                  struct xls_value** results_out);
+
+// Returns the size and alignment in bytes of the buffers holding argument
+// `arg_index` and the result in the JIT's native data layout, as used by
+// `xls_function_jit_run_batched_with_buffers`. This is the layout described
+// by `xls_type_layout_create` for the corresponding types.
+int64_t xls_function_jit_get_arg_buffer_size(struct xls_function_jit* jit,
+                                             int64_t arg_index);
+int64_t xls_function_jit_get_arg_buffer_alignment(struct xls_function_jit* jit,
+                                                  int64_t arg_index);
+int64_t xls_function_jit_get_result_buffer_size(struct xls_function_jit* jit);
+int64_t xls_function_jit_get_result_buffer_alignment(
+    struct xls_function_jit* jit);
+
+// Runs the jitted function `batch_size` times on raw buffers in the JIT's
+// native data layout, avoiding any conversion to and from `xls_value`. `args`
+// holds `batch_size * argc` buffers laid out as for
+// `xls_function_jit_run_batched` and `results` holds `batch_size` buffers.
+// Each buffer must be sized and aligned as given by the getters above.
+bool xls_function_jit_run_batched_with_buffers(struct xls_function_jit* jit,
+                                               size_t batch_size, size_t argc,
+                                               uint8_t* const* args,
+                                               uint8_t* const* results,
+                                               char** error_out);
+
+// -- Proc JIT runtime
+
+// Creates a JIT-backed runtime for all procs in the given `package`. The
+// resulting runtime is owned by the caller and must be freed via
+// `xls_proc_jit_runtime_free`; `package` must outlive it.
+bool xls_proc_jit_runtime_create(struct xls_package* package, char** error_out,
+                                 struct xls_proc_jit_runtime** result_out);
+
+void xls_proc_jit_runtime_free(struct xls_proc_jit_runtime* runtime);
+
+// Ticks every proc in the network once.
+bool xls_proc_jit_runtime_tick(struct xls_proc_jit_runtime* runtime,
+                               char** error_out);
+
+// Ticks the network until all procs with IO are blocked on receives, or
+// fails after `max_ticks` ticks. The number of ticks executed is placed in
+// `ticks_out`.
+bool xls_proc_jit_runtime_tick_until_blocked(
+    struct xls_proc_jit_runtime* runtime, int64_t max_ticks, char** error_out,
+    int64_t* ticks_out);
+
+// Enqueues `value` onto the channel named `channel_name`.
+bool xls_proc_jit_runtime_push_channel_value(
+    struct xls_proc_jit_runtime* runtime, const char* channel_name,
+    const struct xls_value* value, char** error_out);
+
+// Dequeues a value from the channel named `channel_name` into `result_out`
+// (owned by the caller). If the channel is empty, `result_out` is set to null
+// and true is returned.
+bool xls_proc_jit_runtime_pop_channel_value(
+    struct xls_proc_jit_runtime* runtime, const char* channel_name,
+    char** error_out, struct xls_value** result_out);
+
+// -- Block JIT
+
+// Compiles the block named `block_name` in `package` with the JIT. All input
+// ports and registers start at zero. The resulting
+// `xls_block_jit` is owned by the caller and must be freed via
+// `xls_block_jit_free`; `package` must outlive it.
+bool xls_block_jit_create(struct xls_package* package, const char* block_name,
+                          char** error_out, struct xls_block_jit** result_out);
+
+void xls_block_jit_free(struct xls_block_jit* jit);
+
+// Sets the value driven on input port `port_name` for subsequent cycles.
+bool xls_block_jit_set_input_port(struct xls_block_jit* jit,
+                                  const char* port_name,
+                                  const struct xls_value* value,
+                                  char** error_out);
+
+// Runs `cycle_count` clock cycles of the block with the current inputs.
+bool xls_block_jit_run_cycles(struct xls_block_jit* jit, int64_t cycle_count,
+                              char** error_out);
+
+// Gets the value of output port `port_name` after the last cycle run into
+// `result_out` (owned by the caller).
+bool xls_block_jit_get_output_port(struct xls_block_jit* jit,
+                                   const char* port_name, char** error_out,
+                                   struct xls_value** result_out);
+
 }  // extern "C"
 
 #endif  // XLS_PUBLIC_C_API_H_
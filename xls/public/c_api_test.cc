@@ -366,6 +366,279 @@ fn f(x: bits[32] id=3) -> bits[32] {
   ASSERT_TRUE(xls_value_eq(ft, result));
 }
 
+TEST(XlsCApiTest, JitFunctionRunBatchedAndWithBuffers) {
+  const std::string kPackage = R"(package p
+
+fn double(x: bits[32] id=1) -> bits[32] {
+  ret add.2: bits[32] = add(x, x, id=2)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_function* function = nullptr;
+  ASSERT_TRUE(xls_package_get_function(package, "double", &error, &function));
+
+  struct xls_function_jit* jit = nullptr;
+  ASSERT_TRUE(xls_function_jit_create(function, &error, &jit)) << error;
+  absl::Cleanup free_jit([jit] { xls_function_jit_free(jit); });
+
+  struct xls_value* x = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:21", &error, &x));
+  absl::Cleanup free_x([x] { xls_value_free(x); });
+  struct xls_value* y = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:100", &error, &y));
+  absl::Cleanup free_y([y] { xls_value_free(y); });
+
+  {
+    const struct xls_value* args[] = {x};
+    struct xls_value* result = nullptr;
+    ASSERT_TRUE(xls_function_jit_run(jit, /*argc=*/1, args, &error, &result))
+        << error;
+    absl::Cleanup free_result([result] { xls_value_free(result); });
+    char* result_str = nullptr;
+    ASSERT_TRUE(xls_value_to_string(result, &result_str));
+    absl::Cleanup free_result_str([result_str] { xls_c_str_free(result_str); });
+    EXPECT_EQ(std::string_view(result_str), "bits[32]:42");
+  }
+
+  {
+    const struct xls_value* args[] = {x, y};
+    struct xls_value* results[2] = {nullptr, nullptr};
+    ASSERT_TRUE(xls_function_jit_run_batched(jit, /*batch_size=*/2,
+                                             /*argc=*/1, args, &error, results))
+        << error;
+    absl::Cleanup free_results([&results] {
+      xls_value_free(results[0]);
+      xls_value_free(results[1]);
+    });
+    char* result_str = nullptr;
+    ASSERT_TRUE(xls_value_to_string(results[1], &result_str));
+    absl::Cleanup free_result_str([result_str] { xls_c_str_free(result_str); });
+    EXPECT_EQ(std::string_view(result_str), "bits[32]:200");
+  }
+
+  ASSERT_EQ(xls_function_jit_get_arg_buffer_size(jit, 0), sizeof(uint32_t));
+  ASSERT_EQ(xls_function_jit_get_result_buffer_size(jit), sizeof(uint32_t));
+  ASSERT_LE(xls_function_jit_get_arg_buffer_alignment(jit, 0),
+            alignof(uint32_t));
+  ASSERT_LE(xls_function_jit_get_result_buffer_alignment(jit),
+            alignof(uint32_t));
+  uint32_t inputs[3] = {1, 2, 3};
+  uint32_t outputs[3] = {0, 0, 0};
+  uint8_t* arg_buffers[3];
+  uint8_t* result_buffers[3];
+  for (int i = 0; i < 3; ++i) {
+    arg_buffers[i] = reinterpret_cast<uint8_t*>(&inputs[i]);
+    result_buffers[i] = reinterpret_cast<uint8_t*>(&outputs[i]);
+  }
+  ASSERT_TRUE(xls_function_jit_run_batched_with_buffers(
+      jit, /*batch_size=*/3, /*argc=*/1, arg_buffers, result_buffers, &error))
+      << error;
+  EXPECT_EQ(outputs[0], 2);
+  EXPECT_EQ(outputs[1], 4);
+  EXPECT_EQ(outputs[2], 6);
+}
+
+TEST(XlsCApiTest, TypeLayoutsAndInterpretWithBuffers) {
+  const std::string kPackage = R"(package p
+
+fn double(x: bits[32] id=1) -> bits[32] {
+  ret add.2: bits[32] = add(x, x, id=2)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_function* function = nullptr;
+  ASSERT_TRUE(xls_package_get_function(package, "double", &error, &function));
+  struct xls_function_type* function_type = nullptr;
+  ASSERT_TRUE(xls_function_get_type(function, &error, &function_type));
+  ASSERT_EQ(xls_function_type_get_param_count(function_type), 1);
+
+  struct xls_type* param_type = nullptr;
+  ASSERT_TRUE(xls_function_type_get_param_type(function_type, 0, &error,
+                                               &param_type))
+      << error;
+  struct xls_type* return_type = nullptr;
+  ASSERT_TRUE(
+      xls_function_type_get_return_type(function_type, &error, &return_type))
+      << error;
+
+  struct xls_type_layout* arg_layout = nullptr;
+  ASSERT_TRUE(xls_type_layout_create(param_type, &error, &arg_layout))
+      << error;
+  absl::Cleanup free_arg_layout(
+      [arg_layout] { xls_type_layout_free(arg_layout); });
+  struct xls_type_layout* result_layout = nullptr;
+  ASSERT_TRUE(xls_type_layout_create(return_type, &error, &result_layout))
+      << error;
+  absl::Cleanup free_result_layout(
+      [result_layout] { xls_type_layout_free(result_layout); });
+
+  EXPECT_EQ(xls_type_layout_get_size(arg_layout), sizeof(uint32_t));
+  ASSERT_EQ(xls_type_layout_get_element_count(arg_layout), 1);
+  int64_t offset = -1;
+  int64_t data_size = -1;
+  int64_t padded_size = -1;
+  xls_type_layout_get_element(arg_layout, 0, &offset, &data_size,
+                              &padded_size);
+  EXPECT_EQ(offset, 0);
+  EXPECT_EQ(data_size, 4);
+  EXPECT_EQ(padded_size, 4);
+
+  struct xls_value* x = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:21", &error, &x));
+  absl::Cleanup free_x([x] { xls_value_free(x); });
+  uint32_t input = 0;
+  ASSERT_TRUE(xls_type_layout_value_to_buffer(
+      arg_layout, x, reinterpret_cast<uint8_t*>(&input), sizeof(input),
+      &error))
+      << error;
+  EXPECT_EQ(input, 21);
+
+  uint32_t output = 0;
+  const struct xls_type_layout* arg_layouts[] = {arg_layout};
+  const uint8_t* args[] = {reinterpret_cast<const uint8_t*>(&input)};
+  ASSERT_TRUE(xls_interpret_function_with_buffers(
+      function, /*argc=*/1, arg_layouts, args, result_layout,
+      reinterpret_cast<uint8_t*>(&output), &error))
+      << error;
+  EXPECT_EQ(output, 42);
+
+  struct xls_value* result = nullptr;
+  ASSERT_TRUE(xls_type_layout_buffer_to_value(
+      result_layout, reinterpret_cast<const uint8_t*>(&output), sizeof(output),
+      &error, &result))
+      << error;
+  absl::Cleanup free_result([result] { xls_value_free(result); });
+  char* result_str = nullptr;
+  ASSERT_TRUE(xls_value_to_string(result, &result_str));
+  absl::Cleanup free_result_str([result_str] { xls_c_str_free(result_str); });
+  EXPECT_EQ(std::string_view(result_str), "bits[32]:42");
+
+  uint8_t too_small[2];
+  EXPECT_FALSE(xls_type_layout_value_to_buffer(arg_layout, x, too_small,
+                                               sizeof(too_small), &error));
+  absl::Cleanup free_error([error] { xls_c_str_free(error); });
+  EXPECT_THAT(error, HasSubstr("too small"));
+}
+
+TEST(XlsCApiTest, JitProcRuntimePushAndPop) {
+  const std::string kPackage = R"(package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid)
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid)
+
+top proc doubler() {
+  tok: token = literal(value=token, id=1)
+  rcv: (token, bits[32]) = receive(tok, channel=in, id=2)
+  rcv_tok: token = tuple_index(rcv, index=0, id=3)
+  data: bits[32] = tuple_index(rcv, index=1, id=4)
+  doubled: bits[32] = add(data, data, id=5)
+  snd: token = send(rcv_tok, doubled, channel=out, id=6)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_proc_jit_runtime* runtime = nullptr;
+  ASSERT_TRUE(xls_proc_jit_runtime_create(package, &error, &runtime)) << error;
+  absl::Cleanup free_runtime([runtime] { xls_proc_jit_runtime_free(runtime); });
+
+  struct xls_value* empty = nullptr;
+  ASSERT_TRUE(
+      xls_proc_jit_runtime_pop_channel_value(runtime, "out", &error, &empty));
+  EXPECT_EQ(empty, nullptr);
+
+  for (const char* input : {"bits[32]:1", "bits[32]:2"}) {
+    struct xls_value* value = nullptr;
+    ASSERT_TRUE(xls_parse_typed_value(input, &error, &value));
+    absl::Cleanup free_value([value] { xls_value_free(value); });
+    ASSERT_TRUE(
+        xls_proc_jit_runtime_push_channel_value(runtime, "in", value, &error))
+        << error;
+  }
+
+  int64_t ticks = 0;
+  ASSERT_TRUE(xls_proc_jit_runtime_tick_until_blocked(
+      runtime, /*max_ticks=*/100, &error, &ticks))
+      << error;
+
+  for (std::string_view want : {"bits[32]:2", "bits[32]:4"}) {
+    struct xls_value* value = nullptr;
+    ASSERT_TRUE(
+        xls_proc_jit_runtime_pop_channel_value(runtime, "out", &error, &value))
+        << error;
+    ASSERT_NE(value, nullptr);
+    absl::Cleanup free_value([value] { xls_value_free(value); });
+    char* value_str = nullptr;
+    ASSERT_TRUE(xls_value_to_string(value, &value_str));
+    absl::Cleanup free_value_str([value_str] { xls_c_str_free(value_str); });
+    EXPECT_EQ(std::string_view(value_str), want);
+  }
+
+  struct xls_value* value = nullptr;
+  EXPECT_FALSE(
+      xls_proc_jit_runtime_pop_channel_value(runtime, "bogus", &error, &value));
+  absl::Cleanup free_error([error] { xls_c_str_free(error); });
+  EXPECT_THAT(error, HasSubstr("bogus"));
+}
+
+TEST(XlsCApiTest, JitBlockRunCycles) {
+  const std::string kPackage = R"(package p
+
+block accumulator(clk: clock, x: bits[32], out: bits[32]) {
+  reg sum(bits[32])
+  x: bits[32] = input_port(name=x, id=1)
+  sum_q: bits[32] = register_read(register=sum, id=2)
+  sum_d: bits[32] = add(sum_q, x, id=3)
+  sum_write: () = register_write(sum_d, register=sum, id=4)
+  out: () = output_port(sum_q, name=out, id=5)
+}
+)";
+
+  char* error = nullptr;
+  struct xls_package* package = nullptr;
+  ASSERT_TRUE(xls_parse_ir_package(kPackage.c_str(), "p.ir", &error, &package))
+      << "xls_parse_ir_package error: " << error;
+  absl::Cleanup free_package([package] { xls_package_free(package); });
+
+  struct xls_block_jit* jit = nullptr;
+  ASSERT_TRUE(xls_block_jit_create(package, "accumulator", &error, &jit))
+      << error;
+  absl::Cleanup free_jit([jit] { xls_block_jit_free(jit); });
+
+  struct xls_value* x = nullptr;
+  ASSERT_TRUE(xls_parse_typed_value("bits[32]:5", &error, &x));
+  absl::Cleanup free_x([x] { xls_value_free(x); });
+  ASSERT_TRUE(xls_block_jit_set_input_port(jit, "x", x, &error)) << error;
+
+  // The output shows the register value at the start of the last cycle.
+  ASSERT_TRUE(xls_block_jit_run_cycles(jit, /*cycle_count=*/3, &error))
+      << error;
+  struct xls_value* out = nullptr;
+  ASSERT_TRUE(xls_block_jit_get_output_port(jit, "out", &error, &out))
+      << error;
+  absl::Cleanup free_out([out] { xls_value_free(out); });
+  char* out_str = nullptr;
+  ASSERT_TRUE(xls_value_to_string(out, &out_str));
+  absl::Cleanup free_out_str([out_str] { xls_c_str_free(out_str); });
+  EXPECT_EQ(std::string_view(out_str), "bits[32]:10");
+}
+
 TEST(XlsCApiTest, ParsePackageAndOptimizeFunctionInIt) {
   const std::string kPackage = R"(
 package p
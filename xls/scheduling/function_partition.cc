@@ -15,29 +15,32 @@
 #include "xls/scheduling/function_partition.h"
 
 #include <cstdint>
-#include <iterator>
-#include <limits>
 #include <utility>
 #include <vector>
 
-#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
 #include "absl/types/span.h"
+#include "xls/data_structures/push_relabel_max_flow.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
-#include "ortools/graph/ebert_graph.h"
-#include "ortools/graph/max_flow.h"
 
 namespace xls {
 namespace sched {
 
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
     FunctionBase* f, absl::Span<Node* const> partitionable_nodes) {
+  PushRelabelMaxFlow max_flow;
+  return MinCostFunctionPartition(f, partitionable_nodes, max_flow);
+}
+
+std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    PushRelabelMaxFlow& max_flow) {
   if (VLOG_IS_ON(4)) {
     VLOG(4) << "Computing min-cut of function " << f->name()
             << ", partitionable nodes:";
@@ -50,36 +53,33 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
       partitionable_nodes.begin(), partitionable_nodes.end());
   CHECK_EQ(partitionable_nodes_set.size(), partitionable_nodes.size());
 
-  operations_research::SimpleMaxFlow max_flow;
-  using NodeId = operations_research::NodeIndex;
+  using NodeId = int64_t;
 
+  max_flow.Reset(/*vertex_count=*/2);
   const NodeId source = 0;
   const NodeId sink = 1;
+  auto next_node_id = [&]() { return max_flow.AddVertex(); };
 
-  NodeId num_nodes = 2;
-  auto next_node_id = [&]() { return num_nodes++; };
-
+  // The XLS node of mincut graph node `i + 2` is
+  // `xls_nodes_in_mincut_graph[i]`; the mincut graph nodes after those have no
+  // corresponding XLS node.
   std::vector<Node*> xls_nodes_in_mincut_graph;
-
-  // Maps to/from XLS Nodes to nodes in the mincut graph.
   absl::flat_hash_map<Node*, NodeId> xls_to_mincut_node;
-  absl::flat_hash_map<NodeId, Node*> mincut_to_xls_node;
 
-  const int64_t kMaxWeight = std::numeric_limits<int64_t>::max();
+  const int64_t kMaxWeight = PushRelabelMaxFlow::kInfiniteCapacity;
 
   // Adds an edge to the mincut graph. To enforce that the cut is a dicut (no
   // circular dependencies between the two partitions), add an opposing edge of
   // maximum weight.
   auto add_edge = [&](NodeId src, NodeId tgt, int64_t weight) {
-    max_flow.AddArcWithCapacity(src, tgt, weight);
-    max_flow.AddArcWithCapacity(tgt, src, kMaxWeight);
+    max_flow.AddArc(src, tgt, weight);
+    max_flow.AddArc(tgt, src, kMaxWeight);
   };
 
   auto add_node_to_mincut_graph = [&](Node* node) {
     CHECK(!xls_to_mincut_node.contains(node));
     NodeId graph_node_id = next_node_id();
     xls_to_mincut_node[node] = graph_node_id;
-    mincut_to_xls_node[graph_node_id] = node;
     xls_nodes_in_mincut_graph.push_back(node);
     return graph_node_id;
   };
@@ -176,30 +176,18 @@ std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
     }
   }
 
-  CHECK_EQ(max_flow.Solve(source, sink),
-           operations_research::SimpleMaxFlow::OPTIMAL);
+  max_flow.Solve(source, sink);
 
   // Map the mincut graph partition back to the XLS graph.
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions;
   auto& [source_partition, sink_partition] = partitions;
-
-  absl::flat_hash_set<NodeId> source_partition_id_set;
-  {
-    std::vector<NodeId> source_partition_ids;
-    max_flow.GetSourceSideMinCut(&source_partition_ids);
-    absl::c_move(source_partition_ids,
-                 std::inserter(source_partition_id_set,
-                               source_partition_id_set.begin()));
-  }
-  for (NodeId id = 0; id < num_nodes; ++id) {
-    if (mincut_to_xls_node.contains(id)) {
-      Node* node = mincut_to_xls_node.at(id);
-      if (partitionable_nodes_set.contains(node)) {
-        if (source_partition_id_set.contains(id)) {
-          source_partition.push_back(node);
-        } else {
-          sink_partition.push_back(node);
-        }
+  for (int64_t i = 0; i < xls_nodes_in_mincut_graph.size(); ++i) {
+    Node* node = xls_nodes_in_mincut_graph[i];
+    if (partitionable_nodes_set.contains(node)) {
+      if (max_flow.IsOnSourceSide(i + 2)) {
+        source_partition.push_back(node);
+      } else {
+        sink_partition.push_back(node);
       }
     }
   }
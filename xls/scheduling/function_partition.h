@@ -19,6 +19,7 @@
 #include <vector>
 
 #include "absl/types/span.h"
+#include "xls/data_structures/push_relabel_max_flow.h"
 #include "xls/ir/node.h"
 
 namespace xls {
@@ -55,6 +56,13 @@ namespace sched {
 std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
     FunctionBase* f, absl::Span<Node* const> partitionable_nodes);
 
+// As above, but builds the flow network in `max_flow`, reusing its storage
+// from previous partitions. Callers computing many partitions should keep one
+// PushRelabelMaxFlow per thread.
+std::pair<std::vector<Node*>, std::vector<Node*>> MinCostFunctionPartition(
+    FunctionBase* f, absl::Span<Node* const> partitionable_nodes,
+    PushRelabelMaxFlow& max_flow);
+
 }  // namespace sched
 }  // namespace xls
 
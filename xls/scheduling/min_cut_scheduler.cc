@@ -33,6 +33,8 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/data_structures/push_relabel_max_flow.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
@@ -51,6 +53,7 @@ namespace {
 // 'cycle + 1'.
 absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
                              const DelayEstimator& delay_estimator,
+                             PushRelabelMaxFlow& max_flow,
                              sched::ScheduleBounds* bounds) {
   VLOG(3) << "Splitting after cycle " << cycle;
 
@@ -64,7 +67,7 @@ absl::Status SplitAfterCycle(FunctionBase* f, int64_t cycle,
   }
 
   std::pair<std::vector<Node*>, std::vector<Node*>> partitions =
-      sched::MinCostFunctionPartition(f, partitionable_nodes);
+      sched::MinCostFunctionPartition(f, partitionable_nodes, max_flow);
 
   // Tighten bounds based on the cut.
   for (Node* node : partitions.first) {
@@ -149,7 +152,7 @@ std::vector<std::vector<int64_t>> GetMinCutCycleOrders(int64_t length) {
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints) {
+    absl::Span<const SchedulingConstraint> constraints, int64_t thread_count) {
   VLOG(3) << "MinCutScheduler()";
   VLOG(3) << "  pipeline stages = " << pipeline_stages;
   XLS_VLOG_LINES(4, f->DumpIr());
@@ -196,29 +199,54 @@ absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
   }
 
   // Try a number of different orderings of cycle boundary at which the min-cut
-  // is performed and keep the best one.
-  int64_t best_register_count = std::numeric_limits<int64_t>::max();
-  std::optional<sched::ScheduleBounds> best_bounds;
-  for (const std::vector<int64_t>& cut_order :
-       GetMinCutCycleOrders(pipeline_stages - 1)) {
+  // is performed and keep the best one. The trials are independent, so they
+  // may run concurrently; each keeps its own flow network, which is reused
+  // across its cuts.
+  std::vector<std::vector<int64_t>> cut_orders =
+      GetMinCutCycleOrders(pipeline_stages - 1);
+  auto run_trial = [&](absl::Span<const int64_t> cut_order)
+      -> absl::StatusOr<sched::ScheduleBounds> {
     VLOG(3) << absl::StreamFormat("Trying cycle order: {%s}",
                                   absl::StrJoin(cut_order, ", "));
     sched::ScheduleBounds trial_bounds = *bounds;
+    PushRelabelMaxFlow max_flow;
     // Partition the nodes at each cycle boundary. For each iteration, this
     // splits the nodes into those which must be scheduled at or before the
     // cycle and those which must be scheduled after. Upon loop completion each
     // node will have a range of exactly one cycle.
     for (int64_t cycle : cut_order) {
       XLS_RETURN_IF_ERROR(
-          SplitAfterCycle(f, cycle, delay_estimator, &trial_bounds));
+          SplitAfterCycle(f, cycle, delay_estimator, max_flow, &trial_bounds));
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateLowerBounds());
       XLS_RETURN_IF_ERROR(trial_bounds.PropagateUpperBounds());
     }
+    return trial_bounds;
+  };
+  std::vector<absl::StatusOr<sched::ScheduleBounds>> trials(cut_orders.size());
+  if (thread_count > 1 && cut_orders.size() > 1) {
+    ThreadPool pool(
+        std::min(thread_count, static_cast<int64_t>(cut_orders.size())));
+    for (int64_t i = 0; i < cut_orders.size(); ++i) {
+      pool.Schedule([&, i]() { trials[i] = run_trial(cut_orders[i]); });
+    }
+    pool.WaitForIdle();
+  } else {
+    for (int64_t i = 0; i < cut_orders.size(); ++i) {
+      trials[i] = run_trial(cut_orders[i]);
+    }
+  }
+
+  // Compare the trials in order so that the result does not depend on the
+  // thread count.
+  int64_t best_register_count = std::numeric_limits<int64_t>::max();
+  std::optional<sched::ScheduleBounds> best_bounds;
+  for (absl::StatusOr<sched::ScheduleBounds>& trial_bounds : trials) {
+    XLS_RETURN_IF_ERROR(trial_bounds.status());
     XLS_ASSIGN_OR_RETURN(int64_t trial_register_count,
-                         CountInteriorPipelineRegisters(f, trial_bounds));
+                         CountInteriorPipelineRegisters(f, *trial_bounds));
     if (!best_bounds.has_value() ||
         best_register_count > trial_register_count) {
-      best_bounds = std::move(trial_bounds);
+      best_bounds = *std::move(trial_bounds);
       best_register_count = trial_register_count;
     }
   }
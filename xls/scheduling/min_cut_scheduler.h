@@ -31,10 +31,14 @@ namespace xls {
 // period. Attempts to split nodes into stages such that the total number of
 // flops in the pipeline stages is minimized without violating the target clock
 // period.
+//
+// If `thread_count` is greater than one, the orderings of cycle boundaries at
+// which to cut (see GetMinCutCycleOrders) are tried concurrently.
 absl::StatusOr<ScheduleCycleMap> MinCutScheduler(
     FunctionBase* f, int64_t pipeline_stages, int64_t clock_period_ps,
     const DelayEstimator& delay_estimator, sched::ScheduleBounds* bounds,
-    absl::Span<const SchedulingConstraint> constraints);
+    absl::Span<const SchedulingConstraint> constraints,
+    int64_t thread_count = 1);
 
 // Returns the list of ordering of cycles (pipeline stages) in which to compute
 // min cut of the graph. Each min cut of the graph computes which XLS node
@@ -0,0 +1,112 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/modulo_resources.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+
+namespace {
+
+bool IsShareable(Node* node) {
+  if (node->operand_count() == 0 || OpIsSideEffecting(node->op())) {
+    return false;
+  }
+  switch (node->op()) {
+    case Op::kAfterAll:
+    case Op::kMinDelay:
+    case Op::kNext:
+      return false;
+    default:
+      return node->GetType()->GetFlatBitCount() > 0;
+  }
+}
+
+// Returns a key which is equal for operations that one instance can implement.
+std::string ShapeKey(Node* node) {
+  return absl::StrCat(
+      OpToString(node->op()), ":", node->GetType()->ToString(), "(",
+      absl::StrJoin(node->operands(), ",",
+                    [](std::string* out, Node* operand) {
+                      absl::StrAppend(out, operand->GetType()->ToString());
+                    }),
+      ")");
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<ModuloResourceClass>> ComputeModuloResourceClasses(
+    FunctionBase* f, int64_t initiation_interval,
+    const AreaEstimator& area_estimator) {
+  std::vector<ModuloResourceClass> classes;
+  if (initiation_interval <= 1) {
+    return classes;
+  }
+  absl::flat_hash_map<std::string, int64_t> class_index;
+  for (Node* node : f->nodes()) {
+    if (!IsShareable(node)) {
+      continue;
+    }
+    auto [it, inserted] = class_index.try_emplace(ShapeKey(node), -1);
+    if (inserted) {
+      absl::StatusOr<double> area =
+          area_estimator.GetOperationAreaInSquareMicrons(node);
+      if (!area.ok()) {
+        // Operations the model knows nothing about are not worth sharing.
+        continue;
+      }
+      int64_t operand_bits = 0;
+      for (Node* operand : node->operands()) {
+        operand_bits += operand->GetType()->GetFlatBitCount();
+      }
+      XLS_ASSIGN_OR_RETURN(
+          double mux_area,
+          area_estimator.GetRegisterAreaInSquareMicrons(operand_bits));
+      if (*area <= mux_area) {
+        continue;
+      }
+      it->second = classes.size();
+      classes.push_back(ModuloResourceClass{});
+    }
+    if (it->second >= 0) {
+      classes[it->second].nodes.push_back(node);
+    }
+  }
+  std::erase_if(classes, [&](ModuloResourceClass& resource_class) {
+    const int64_t count = resource_class.nodes.size();
+    resource_class.limit =
+        (count + initiation_interval - 1) / initiation_interval;
+    return resource_class.limit >= count;
+  });
+  VLOG(3) << "Found " << classes.size() << " shareable resource classes in "
+          << f->name();
+  return classes;
+}
+
+}  // namespace xls
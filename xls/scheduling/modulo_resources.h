@@ -0,0 +1,51 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_SCHEDULING_MODULO_RESOURCES_H_
+#define XLS_SCHEDULING_MODULO_RESOURCES_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+
+namespace xls {
+
+// A set of operations of the same shape (op, result type and operand types)
+// which can be implemented by `limit` shared hardware instances, provided that
+// at most `limit` of them are scheduled in each cycle modulo the initiation
+// interval.
+struct ModuloResourceClass {
+  std::vector<Node*> nodes;
+  int64_t limit;
+};
+
+// Returns the classes of operations of `f` which are worth sharing across the
+// cycles of `initiation_interval`: operations whose area according to
+// `area_estimator` exceeds that of registering their operands, a proxy for the
+// input muxes needed to share them. Each class is limited to the minimum
+// number of instances which can execute all of its operations once per
+// initiation interval. Returns no classes if `initiation_interval` is 1 or
+// less.
+absl::StatusOr<std::vector<ModuloResourceClass>> ComputeModuloResourceClasses(
+    FunctionBase* f, int64_t initiation_interval,
+    const AreaEstimator& area_estimator);
+
+}  // namespace xls
+
+#endif  // XLS_SCHEDULING_MODULO_RESOURCES_H_
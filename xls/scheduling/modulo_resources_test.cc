@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/scheduling/modulo_resources.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/op.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+// Multiplies cost 100 per result bit, everything else 0.1 per result bit; a
+// register costs 1 per bit.
+class MulHeavyAreaEstimator : public AreaEstimator {
+ public:
+  MulHeavyAreaEstimator() : AreaEstimator("mul_heavy") {}
+
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override {
+    double per_bit = node->op() == Op::kUMul ? 100.0 : 0.1;
+    return per_bit * node->GetType()->GetFlatBitCount();
+  }
+
+ private:
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override {
+    return 1.0;
+  }
+};
+
+class ModuloResourcesTest : public IrTestBase {};
+
+TEST_F(ModuloResourcesTest, GroupsExpensiveOperationsByShape) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(16));
+  BValue b = fb.Param("b", p->GetBitsType(16));
+  BValue c = fb.Param("c", p->GetBitsType(8));
+  BValue mul0 = fb.UMul(a, b);
+  BValue mul1 = fb.UMul(b, a);
+  BValue mul2 = fb.UMul(a, a);
+  // A different shape from the other multiplies.
+  BValue narrow = fb.UMul(c, c);
+  BValue sum = fb.Add(fb.Add(mul0, mul1), mul2);
+  fb.Tuple({sum, narrow});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  MulHeavyAreaEstimator area_estimator;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<ModuloResourceClass> classes,
+      ComputeModuloResourceClasses(f, /*initiation_interval=*/2,
+                                   area_estimator));
+  // The adds are cheaper than the muxes needed to share them, and a single
+  // 8-bit multiply needs its own instance anyway.
+  ASSERT_EQ(classes.size(), 1);
+  EXPECT_THAT(classes[0].nodes,
+              UnorderedElementsAre(mul0.node(), mul1.node(), mul2.node()));
+  EXPECT_EQ(classes[0].limit, 2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      classes, ComputeModuloResourceClasses(f, /*initiation_interval=*/3,
+                                            area_estimator));
+  ASSERT_EQ(classes.size(), 1);
+  EXPECT_EQ(classes[0].limit, 1);
+}
+
+TEST_F(ModuloResourcesTest, NothingToShareAtFullThroughput) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue a = fb.Param("a", p->GetBitsType(16));
+  fb.Add(fb.UMul(a, a), fb.UMul(a, a));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  MulHeavyAreaEstimator area_estimator;
+  EXPECT_THAT(ComputeModuloResourceClasses(f, /*initiation_interval=*/1,
+                                           area_estimator),
+              absl_testing::IsOkAndHolds(IsEmpty()));
+  EXPECT_THAT(ComputeModuloResourceClasses(f, /*initiation_interval=*/2,
+                                           area_estimator),
+              absl_testing::IsOkAndHolds(ElementsAre(testing::_)));
+}
+
+}  // namespace
+}  // namespace xls
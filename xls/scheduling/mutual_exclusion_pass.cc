@@ -21,6 +21,7 @@
 #include <memory>
 #include <numeric>
 #include <optional>
+#include <random>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -44,8 +45,11 @@
 #include "xls/common/casts.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/graph_coloring.h"
 #include "xls/data_structures/transitive_closure.h"
+#include "xls/interpreter/ir_interpreter.h"
+#include "xls/interpreter/random_value.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/channel.h"
@@ -70,6 +74,10 @@ namespace xls {
 
 namespace {
 
+// Merge class graphs with more nodes than this are colored with DSatur and a
+// local search rather than with Recursive Largest First.
+constexpr int64_t kMaxRecursiveLargestFirstNodes = 256;
+
 bool FunctionIsOneBit(Node* node) {
   return node->GetType()->IsBits() &&
          node->GetType()->AsBitsOrDie()->bit_count() == 1;
@@ -121,6 +129,176 @@ Z3_lbool RunSolver(Z3_context c, Z3_ast asserted) {
   return satisfiable;
 }
 
+// Number of random samples on which predicates are simulated, one per bit of
+// their signatures.
+constexpr int64_t kSimulationSamples = 64;
+
+// Minimum number of solver queries worth spreading over several threads.
+constexpr int64_t kMinConcurrentQueries = 16;
+
+// Whether the value of `node` is unconstrained in the Z3 translation of its
+// function, so that any value is a possible one.
+bool IsUnconstrained(Node* node) {
+  return node->Is<Param>() ||
+         (OpIsSideEffecting(node->op()) && node->op() != Op::kGate);
+}
+
+// Evaluates the given predicates on kSimulationSamples random assignments to
+// the unconstrained nodes of `f`. Returns the signature of each predicate,
+// whose bit i is its value in sample i, so a nonzero AND of two signatures
+// proves that the predicates are not mutually exclusive. Predicates which
+// depend on nodes the interpreter cannot evaluate are left out.
+absl::flat_hash_map<Node*, uint64_t> SimulatePredicates(
+    FunctionBase* f,
+    absl::Span<const std::pair<Node*, int64_t>> predicate_nodes) {
+  absl::flat_hash_set<Node*> cone;
+  std::vector<Node*> stack;
+  for (const auto& [node, index] : predicate_nodes) {
+    stack.push_back(node);
+  }
+  while (!stack.empty()) {
+    Node* node = stack.back();
+    stack.pop_back();
+    if (cone.insert(node).second) {
+      stack.insert(stack.end(), node->operands().begin(),
+                   node->operands().end());
+    }
+  }
+  std::vector<Node*> order;
+  for (Node* node : TopoSort(f)) {
+    if (cone.contains(node)) {
+      order.push_back(node);
+    }
+  }
+
+  // A fixed seed keeps the pass deterministic.
+  std::mt19937_64 rng(0);
+  absl::flat_hash_set<Node*> inexact;
+  absl::flat_hash_map<Node*, Value> values;
+  absl::flat_hash_map<Node*, uint64_t> signatures;
+  std::vector<Value> operand_values;
+  for (int64_t sample = 0; sample < kSimulationSamples; ++sample) {
+    for (Node* node : order) {
+      std::optional<Value> value;
+      if (IsUnconstrained(node)) {
+        value = RandomValue(node->GetType(), rng);
+      } else if (!inexact.contains(node) &&
+                 absl::c_none_of(node->operands(), [&](Node* operand) {
+                   return inexact.contains(operand);
+                 })) {
+        operand_values.clear();
+        for (Node* operand : node->operands()) {
+          operand_values.push_back(values.at(operand));
+        }
+        absl::StatusOr<Value> result = InterpretNode(node, operand_values);
+        if (result.ok()) {
+          value = *std::move(result);
+        }
+      }
+      if (!value.has_value()) {
+        inexact.insert(node);
+        value = ZeroOfType(node->GetType());
+      }
+      values.insert_or_assign(node, *std::move(value));
+    }
+    for (const auto& [node, index] : predicate_nodes) {
+      if (values.at(node).bits().IsOne()) {
+        signatures[node] |= uint64_t{1} << sample;
+      } else {
+        signatures.try_emplace(node, 0);
+      }
+    }
+  }
+  absl::erase_if(signatures,
+                 [&](const std::pair<Node* const, uint64_t>& entry) {
+                   return inexact.contains(entry.first);
+                 });
+  return signatures;
+}
+
+// Returns the nodes which `pred` implies by construction: itself and,
+// recursively, the operands of ANDs (as built by AddPredicate).
+std::vector<Node*> ImpliedPredicates(Node* pred) {
+  std::vector<Node*> result;
+  absl::flat_hash_set<Node*> visited;
+  std::vector<Node*> stack = {pred};
+  while (!stack.empty()) {
+    Node* node = stack.back();
+    stack.pop_back();
+    if (!visited.insert(node).second) {
+      continue;
+    }
+    result.push_back(node);
+    if (node->op() == Op::kAnd) {
+      stack.insert(stack.end(), node->operands().begin(),
+                   node->operands().end());
+    }
+  }
+  return result;
+}
+
+// A pair of predicates whose mutual exclusion is left to Z3.
+struct SolverQuery {
+  Node* a;
+  Node* b;
+  bool required_for_compilation;
+  // The proven-mutually-exclusive channels both predicates control, if
+  // `required_for_compilation`.
+  absl::flat_hash_set<Channel*> channels;
+};
+
+// Returns whether `query.a AND query.b` is satisfiable.
+Z3_lbool SolvePair(solvers::z3::IrTranslator* translator,
+                   const SolverQuery& query, int64_t z3_rlimit) {
+  Z3_context ctx = translator->ctx();
+  // We try to find out if `a ∧ b` is satisfiable, which is true iff
+  // `a NAND b` is not valid.
+  Z3_ast a_and_b = solvers::z3::BitVectorToBoolean(
+      ctx, Z3_mk_bvand(ctx, translator->GetTranslation(query.a),
+                       translator->GetTranslation(query.b)));
+  translator->SetRlimit(query.required_for_compilation ? 0 : z3_rlimit);
+  return RunSolver(ctx, a_and_b);
+}
+
+// Runs the given queries on `thread_count` threads. Z3 contexts may not be
+// shared between threads, so each thread gets its own translation of `f`;
+// these are made up front, so the IR is only read by one thread at a time.
+absl::StatusOr<std::vector<Z3_lbool>> SolveConcurrently(
+    FunctionBase* f, absl::Span<const SolverQuery> queries, int64_t z3_rlimit,
+    int64_t thread_count) {
+  const int64_t shard_count =
+      std::min(thread_count, static_cast<int64_t>(queries.size()));
+  std::vector<std::unique_ptr<solvers::z3::IrTranslator>> translators;
+  translators.reserve(shard_count);
+  for (int64_t shard = 0; shard < shard_count; ++shard) {
+    XLS_ASSIGN_OR_RETURN(
+        std::unique_ptr<solvers::z3::IrTranslator> translator,
+        solvers::z3::IrTranslator::CreateAndTranslate(f, true));
+    translators.push_back(std::move(translator));
+  }
+
+  std::vector<Z3_lbool> results(queries.size(), Z3_L_UNDEF);
+  std::vector<absl::Status> statuses(shard_count);
+  {
+    ThreadPool pool(shard_count);
+    for (int64_t shard = 0; shard < shard_count; ++shard) {
+      pool.Schedule([&, shard]() {
+        solvers::z3::IrTranslator* translator = translators[shard].get();
+        solvers::z3::ScopedErrorHandler seh(translator->ctx());
+        for (int64_t i = shard; i < queries.size(); i += shard_count) {
+          results[i] = SolvePair(translator, queries[i], z3_rlimit);
+        }
+        statuses[shard] = seh.status();
+      });
+    }
+    pool.WaitForIdle();
+  }
+  for (const absl::Status& status : statuses) {
+    XLS_RETURN_IF_ERROR(status);
+  }
+  return results;
+}
+
 // Returns a list of all predicates in a deterministic order, paired with their
 // index in the list.
 std::vector<std::pair<Node*, int64_t>> PredicateNodes(Predicates* p,
@@ -341,20 +519,40 @@ absl::StatusOr<std::vector<absl::flat_hash_set<Node*>>> ComputeMergeClasses(
     node_to_index[ordered_nodes[i]] = i;
   }
 
-  std::vector<int64_t> iota(ordered_nodes.size());
-  std::iota(iota.begin(), iota.end(), 0);
-  std::vector<absl::flat_hash_set<int64_t>> coloring_indices =
-      RecursiveLargestFirstColoring<int64_t>(
-          absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
-          [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
-            absl::flat_hash_set<Node*> inv_neighbors =
-                inverted_neighborhoods.at(ordered_nodes.at(node_index));
-            absl::flat_hash_set<int64_t> result;
-            for (Node* inv_neighbor : inv_neighbors) {
-              result.insert(node_to_index.at(inv_neighbor));
-            }
-            return result;
-          });
+  std::vector<absl::flat_hash_set<int64_t>> coloring_indices;
+  if (ordered_nodes.size() > kMaxRecursiveLargestFirstNodes) {
+    // RLF is quadratic in the number of nodes (and copies a neighborhood per
+    // query), so color big graphs with DSatur and a bounded local search.
+    std::vector<std::pair<int64_t, int64_t>> edges;
+    for (int64_t i = 0; i < ordered_nodes.size(); ++i) {
+      for (Node* inv_neighbor : inverted_neighborhoods.at(ordered_nodes[i])) {
+        int64_t j = node_to_index.at(inv_neighbor);
+        if (i < j) {
+          edges.push_back({i, j});
+        }
+      }
+    }
+    CsrGraph graph = CsrGraph::FromEdges(ordered_nodes.size(), edges);
+    for (const std::vector<int64_t>& color_class :
+         ColorClasses(ImproveColoring(graph, DSaturColoring(graph)))) {
+      coloring_indices.push_back(absl::flat_hash_set<int64_t>(
+          color_class.begin(), color_class.end()));
+    }
+  } else {
+    std::vector<int64_t> iota(ordered_nodes.size());
+    std::iota(iota.begin(), iota.end(), 0);
+    coloring_indices = RecursiveLargestFirstColoring<int64_t>(
+        absl::flat_hash_set<int64_t>(iota.begin(), iota.end()),
+        [&](int64_t node_index) -> absl::flat_hash_set<int64_t> {
+          absl::flat_hash_set<Node*> inv_neighbors =
+              inverted_neighborhoods.at(ordered_nodes.at(node_index));
+          absl::flat_hash_set<int64_t> result;
+          for (Node* inv_neighbor : inv_neighbors) {
+            result.insert(node_to_index.at(inv_neighbor));
+          }
+          return result;
+        });
+  }
 
   std::vector<absl::flat_hash_set<Node*>> coloring;
   for (const absl::flat_hash_set<int64_t>& color_class : coloring_indices) {
@@ -1102,7 +1300,7 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f) {
 }
 
 absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
-                                    int64_t z3_rlimit) {
+                                    int64_t z3_rlimit, int64_t thread_count) {
   if (f->IsBlock()) {
     return absl::OkStatus();
   }
@@ -1193,10 +1391,35 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
     }
   }
 
+  // Settle as many pairs as possible without Z3: a sample on which both
+  // predicates are true disproves their mutual exclusion, and a pair is
+  // mutually exclusive if predicates they imply are.
+  absl::flat_hash_map<Node*, uint64_t> signatures =
+      SimulatePredicates(f, predicate_nodes);
+  absl::flat_hash_map<Node*, std::vector<Node*>> implications;
+  for (const auto& [node, index] : predicate_nodes) {
+    implications[node] = ImpliedPredicates(node);
+  }
+  auto implied_exclusive = [&](Node* node_a, Node* node_b) {
+    for (Node* implied_a : implications.at(node_a)) {
+      for (Node* implied_b : implications.at(node_b)) {
+        if (implied_a != implied_b &&
+            p->QueryMutuallyExclusive(implied_a, implied_b) ==
+                std::make_optional(true)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  };
+
   int64_t known_false = 0;
   int64_t known_true = 0;
   int64_t unknown = 0;
+  int64_t simulated = 0;
+  int64_t implied = 0;
 
+  std::vector<SolverQuery> queries;
   for (const auto& [node_a, index_a] : predicate_nodes) {
     XLS_ASSIGN_OR_RETURN(
         absl::flat_hash_set<Channel*> channels_a,
@@ -1217,14 +1440,6 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
         continue;
       }
 
-      Z3_ast z3_a = translator->GetTranslation(node_a);
-      Z3_ast z3_b = translator->GetTranslation(node_b);
-
-      // We try to find out if `a ∧ b` is satisfiable, which is true iff
-      // `a NAND b` is not valid.
-      Z3_ast a_and_b =
-          solvers::z3::BitVectorToBoolean(ctx, Z3_mk_bvand(ctx, z3_a, z3_b));
-
       // Check whether `a` and `b` must be proven mutually exclusive in order
       // for channel operations to be legal; if so, we remove the rlimit on the
       // prover.
@@ -1232,53 +1447,108 @@ absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
           absl::flat_hash_set<Channel*> channels_b,
           GetControlledProvenMutuallyExclusiveChannels(node_b, p, f));
       bool required_for_compilation = HasIntersection(channels_a, channels_b);
-      translator->SetRlimit(required_for_compilation ? 0 : z3_rlimit);
       if (required_for_compilation) {
         LOG(INFO) << "Removing Z3's rlimit for mutual exclusion between "
                   << node_a->GetName() << " and " << node_b->GetName()
                   << " as mutual exclusion is required for compilation.";
+      } else if (signatures.contains(node_a) && signatures.contains(node_b) &&
+                 (signatures.at(node_a) & signatures.at(node_b)) != 0) {
+        // Pairs required for compilation are left to Z3 so that failures are
+        // reported with its verdict.
+        simulated += 1;
+        known_false += 1;
+        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
+        continue;
       }
-      Z3_lbool satisfiable = RunSolver(ctx, a_and_b);
-
-      if (satisfiable == Z3_L_FALSE) {
+      if (implied_exclusive(node_a, node_b)) {
+        implied += 1;
         known_true += 1;
         XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(node_a, node_b));
-      } else if (satisfiable == Z3_L_TRUE) {
-        known_false += 1;
-        XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(node_a, node_b));
-        if (required_for_compilation) {
-          return absl::FailedPreconditionError(absl::StrFormat(
-              "Proved that %s and %s, which control operations on "
-              "proven-mutually-exclusive channels (%s), are not mutually "
-              "exclusive.",
-              node_a->GetName(), node_b->GetName(),
-              absl::StrJoin(Intersection(channels_a, channels_b), ", ",
-                            [](std::string* out, Channel* channel) {
-                              absl::StrAppend(out, channel->name());
-                            })));
-        }
-      } else {
-        unknown += 1;
-        VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
-                << node_a->GetName() << " and " << node_b->GetName();
-        if (required_for_compilation) {
-          return absl::FailedPreconditionError(absl::StrFormat(
-              "Z3 failed to prove that %s and %s, which control operations on "
-              "proven-mutually-exclusive channels (%s), are mutually "
-              "exclusive.",
-              node_a->GetName(), node_b->GetName(),
-              absl::StrJoin(Intersection(channels_a, channels_b), ", ",
-                            [](std::string* out, Channel* channel) {
-                              absl::StrAppend(out, channel->name());
-                            })));
-        }
+        continue;
+      }
+      queries.push_back(SolverQuery{
+          .a = node_a,
+          .b = node_b,
+          .required_for_compilation = required_for_compilation,
+          .channels = required_for_compilation
+                          ? Intersection(channels_a, channels_b)
+                          : absl::flat_hash_set<Channel*>()});
+    }
+  }
+
+  // Query the least specific pairs first, so their results can settle the
+  // pairs of the predicates which imply them.
+  std::stable_sort(queries.begin(), queries.end(),
+                   [&](const SolverQuery& x, const SolverQuery& y) {
+                     return implications.at(x.a).size() +
+                                implications.at(x.b).size() <
+                            implications.at(y.a).size() +
+                                implications.at(y.b).size();
+                   });
+
+  auto record = [&](const SolverQuery& query,
+                    Z3_lbool satisfiable) -> absl::Status {
+    auto channel_names = [&]() {
+      return absl::StrJoin(query.channels, ", ",
+                           [](std::string* out, Channel* channel) {
+                             absl::StrAppend(out, channel->name());
+                           });
+    };
+    if (satisfiable == Z3_L_FALSE) {
+      known_true += 1;
+      return p->MarkMutuallyExclusive(query.a, query.b);
+    }
+    if (satisfiable == Z3_L_TRUE) {
+      known_false += 1;
+      XLS_RETURN_IF_ERROR(p->MarkNotMutuallyExclusive(query.a, query.b));
+      if (query.required_for_compilation) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "Proved that %s and %s, which control operations on "
+            "proven-mutually-exclusive channels (%s), are not mutually "
+            "exclusive.",
+            query.a->GetName(), query.b->GetName(), channel_names()));
+      }
+      return absl::OkStatus();
+    }
+    unknown += 1;
+    VLOG(3) << "Z3 ran out of time checking mutual exclusion of "
+            << query.a->GetName() << " and " << query.b->GetName();
+    if (query.required_for_compilation) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Z3 failed to prove that %s and %s, which control operations on "
+          "proven-mutually-exclusive channels (%s), are mutually "
+          "exclusive.",
+          query.a->GetName(), query.b->GetName(), channel_names()));
+    }
+    return absl::OkStatus();
+  };
+
+  if (thread_count > 1 && queries.size() >= kMinConcurrentQueries) {
+    XLS_ASSIGN_OR_RETURN(
+        std::vector<Z3_lbool> results,
+        SolveConcurrently(f, queries, z3_rlimit, thread_count));
+    for (int64_t i = 0; i < queries.size(); ++i) {
+      XLS_RETURN_IF_ERROR(record(queries[i], results[i]));
+    }
+  } else {
+    for (const SolverQuery& query : queries) {
+      // An earlier query may have settled this one.
+      if (implied_exclusive(query.a, query.b)) {
+        implied += 1;
+        known_true += 1;
+        XLS_RETURN_IF_ERROR(p->MarkMutuallyExclusive(query.a, query.b));
+        continue;
       }
+      XLS_RETURN_IF_ERROR(
+          record(query, SolvePair(translator.get(), query, z3_rlimit)));
     }
   }
 
   VLOG(3) << "known_false = " << known_false;
   VLOG(3) << "known_true  = " << known_true;
   VLOG(3) << "unknown     = " << unknown;
+  VLOG(3) << "simulated   = " << simulated;
+  VLOG(3) << "implied     = " << implied;
 
   XLS_RETURN_IF_ERROR(seh.status());
 
@@ -1306,7 +1576,8 @@ absl::StatusOr<bool> MutualExclusionPass::RunOnFunctionBaseInternal(
 
   Predicates p;
   XLS_RETURN_IF_ERROR(AddSendReceivePredicates(&p, f));
-  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(&p, f, z3_rlimit));
+  XLS_RETURN_IF_ERROR(ComputeMutualExclusion(
+      &p, f, z3_rlimit, options.scheduling_options.scheduling_threads()));
   XLS_ASSIGN_OR_RETURN(std::vector<absl::flat_hash_set<Node*>> merge_classes,
                        ComputeMergeClasses(&p, f, scm));
 
@@ -104,8 +104,14 @@ absl::Status AddSelectPredicates(Predicates* p, FunctionBase* f);
 
 // Use an SMT solver to populate the given `Predicates*` with information about
 // whether nodes are used in a mutually exclusive way.
+//
+// Before any pair of predicates is given to the solver, random simulation is
+// used to find pairs which are true together, and pairs are settled without a
+// query when predicates they imply are known to be mutually exclusive. The
+// remaining queries are spread over `thread_count` threads.
 absl::Status ComputeMutualExclusion(Predicates* p, FunctionBase* f,
-                                    int64_t z3_rlimit);
+                                    int64_t z3_rlimit,
+                                    int64_t thread_count = 1);
 
 // Pass which merges together nodes that are determined to be mutually exclusive
 // via SMT solver analysis.
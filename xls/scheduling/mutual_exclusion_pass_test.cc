@@ -18,6 +18,7 @@
 #include <memory>
 #include <optional>
 #include <string_view>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -31,6 +32,7 @@
 #include "xls/ir/function_builder.h"
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
@@ -133,6 +135,24 @@ absl::StatusOr<Node*> FindOp(FunctionBase* f, Op op) {
   return result;
 }
 
+// A proc with `count` sends on `channel`, the i-th predicated on `sel == i` if
+// `exclusive` and on `sel != i` otherwise.
+absl::StatusOr<Proc*> CreateSelectorSendsProc(Package* p, std::string_view name,
+                                              Channel* channel, int64_t count,
+                                              bool exclusive) {
+  ProcBuilder pb(name, p);
+  BValue tok = pb.StateElement("__token", Value::Token());
+  BValue sel = pb.StateElement("__sel", Value(UBits(0, 8)));
+  std::vector<BValue> sends;
+  for (int64_t i = 0; i < count; ++i) {
+    BValue index = pb.Literal(UBits(i, 8));
+    BValue pred = exclusive ? pb.Eq(sel, index) : pb.Ne(sel, index);
+    sends.push_back(
+        pb.SendIf(channel, tok, pred, pb.Literal(UBits(100 + i, 32))));
+  }
+  return pb.Build({pb.AfterAll(sends), pb.Add(sel, pb.Literal(UBits(1, 8)))});
+}
+
 int64_t NumberOfOp(FunctionBase* f, Op op) {
   int64_t result = 0;
   for (Node* node : f->nodes()) {
@@ -718,5 +738,58 @@ TEST_F(MutualExclusionPassTest, AvoidsCycles) {
   EXPECT_EQ(NumberOfOp(proc, Op::kReceive), 3);
 }
 
+TEST_F(MutualExclusionPassTest, ManyExclusiveSendsOnSeveralThreads) {
+  for (int64_t threads : {1, 4}) {
+    auto p = CreatePackage();
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * test_channel,
+        p->CreateStreamingChannel(
+            "test_channel", ChannelOps::kSendOnly, p->GetBitsType(32),
+            /*initial_values=*/{}, /*fifo_config=*/std::nullopt,
+            /*flow_control=*/FlowControl::kReadyValid,
+            /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Proc * proc, CreateSelectorSendsProc(p.get(), "main", test_channel,
+                                             /*count=*/12, /*exclusive=*/true));
+    EXPECT_THAT(RunMutualExclusionPass(
+                    proc, SchedulingOptions().scheduling_threads(threads)),
+                IsOkAndHolds(true));
+    EXPECT_EQ(NumberOfOp(proc, Op::kSend), 1) << threads;
+    XLS_EXPECT_OK(VerifyProc(proc, true));
+  }
+}
+
+TEST_F(MutualExclusionPassTest, SimulationDisprovesExclusion) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * test_channel,
+      p->CreateStreamingChannel(
+          "test_channel", ChannelOps::kSendOnly, p->GetBitsType(32),
+          /*initial_values=*/{}, /*fifo_config=*/std::nullopt,
+          /*flow_control=*/FlowControl::kReadyValid,
+          /*strictness=*/ChannelStrictness::kArbitraryStaticOrder));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Proc * proc, CreateSelectorSendsProc(p.get(), "main", test_channel,
+                                           /*count=*/4, /*exclusive=*/false));
+  Predicates predicates;
+  for (Node* node : proc->nodes()) {
+    if (node->Is<Send>()) {
+      predicates.SetPredicate(node, *node->As<Send>()->predicate());
+    }
+  }
+  // With no Z3 resources at all, only the simulation can settle the pairs.
+  XLS_ASSERT_OK(ComputeMutualExclusion(&predicates, proc, /*z3_rlimit=*/1));
+  for (Node* a : proc->nodes()) {
+    for (Node* b : proc->nodes()) {
+      if (a != b && a->Is<Send>() && b->Is<Send>()) {
+        EXPECT_THAT(
+            predicates.QueryMutuallyExclusive(*a->As<Send>()->predicate(),
+                                              *b->As<Send>()->predicate()),
+            Optional(false));
+      }
+    }
+  }
+}
+
 }  // namespace
 }  // namespace xls
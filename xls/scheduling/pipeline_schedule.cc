@@ -36,6 +36,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/estimators/delay_model/timing_engine.h"
 #include "xls/fdo/delay_manager.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/function.h"
@@ -274,60 +275,24 @@ absl::Status PipelineSchedule::VerifyTiming(
   const absl::flat_hash_set<Node*> dead_after_synthesis =
       GetDeadAfterSynthesisNodes(function_base_);
 
-  // Critical path from start of the cycle that a node is scheduled through the
-  // node itself. If the schedule meets timing, then this value should be less
-  // than or equal to clock_period_ps for every node (except those that cannot
-  // affect anything that will be synthesized).
-  absl::flat_hash_map<Node*, int64_t> node_cp;
-  // The predecessor (operand) of the node through which the critical-path from
-  // the start of the cycle extends.
-  absl::flat_hash_map<Node*, Node*> cp_pred;
-  // The node with the longest critical path from the start of the stage in the
-  // entire schedule.
-  Node* max_cp_node = nullptr;
+  // Critical paths from the start of each stage, grouped by stage. If the
+  // schedule meets timing then no path is longer than clock_period_ps. Nodes
+  // which cannot affect anything that will be synthesized are left out.
+  TimingEngine timing(function_base_, delay_estimator);
   for (Node* node : TopoSort(function_base_)) {
-    // The critical-path delay from the start of the stage to the start of the
-    // node.
-    int64_t cp_to_node_start = 0;
-    cp_pred[node] = nullptr;
-    for (Node* operand : node->operands()) {
-      if (dead_after_synthesis.contains(operand)) {
-        continue;
-      }
-      if (cycle(operand) == cycle(node)) {
-        if (cp_to_node_start < node_cp.at(operand)) {
-          cp_to_node_start = node_cp.at(operand);
-          cp_pred[node] = operand;
-        }
-      }
-    }
-    int64_t node_delay = 0;
     if (!dead_after_synthesis.contains(node)) {
-      XLS_ASSIGN_OR_RETURN(node_delay,
-                           delay_estimator.GetOperationDelayInPs(node));
-    }
-    node_cp[node] = cp_to_node_start + node_delay;
-    if (max_cp_node == nullptr || node_cp[node] > node_cp[max_cp_node]) {
-      max_cp_node = node;
+      XLS_RETURN_IF_ERROR(timing.Add(node, cycle(node)));
     }
   }
 
-  if (node_cp[max_cp_node] > clock_period_ps) {
-    std::vector<Node*> path;
-    Node* node = max_cp_node;
-    do {
-      path.push_back(node);
-      node = cp_pred[node];
-    } while (node != nullptr);
-    std::reverse(path.begin(), path.end());
+  if (timing.CriticalPathDelay() > clock_period_ps) {
+    std::vector<Node*> path = timing.CriticalPath();
     return absl::InternalError(absl::StrFormat(
         "Schedule does not meet timing (%dps). Longest failing path (%dps): %s",
-        clock_period_ps, node_cp[max_cp_node],
+        clock_period_ps, timing.CriticalPathDelay(),
         absl::StrJoin(path, " -> ", [&](std::string* out, Node* n) {
-          absl::StrAppend(
-              out, absl::StrFormat(
-                       "%s (%dps)", n->GetName(),
-                       delay_estimator.GetOperationDelayInPs(n).value()));
+          absl::StrAppend(out, absl::StrFormat("%s (%dps)", n->GetName(),
+                                               timing.NodeDelay(n)));
         })));
   }
   return absl::OkStatus();
@@ -16,13 +16,16 @@
 
 #include <cstdint>
 #include <limits>
+#include <memory>
 #include <optional>
+#include <string>
 #include <string_view>
 #include <utility>
 #include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/status_matchers.h"
@@ -31,6 +34,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
 #include "xls/common/status/matchers.h"
+#include "xls/estimators/area_model/area_estimator.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
 #include "xls/fdo/delay_manager.h"
@@ -40,6 +44,7 @@
 #include "xls/ir/ir_matcher.h"
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
 #include "xls/ir/op.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/type.h"
@@ -220,6 +225,35 @@ TEST_F(PipelineScheduleTest, InfeasibleScheduleWithReturnValueUsers) {
               "that is impossible due to users of these node(s): ret_value")));
 }
 
+TEST_F(PipelineScheduleTest, MinCutScheduleDoesNotDependOnThreadCount) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u32 = p->GetBitsType(32);
+  auto x = fb.Param("x", u32);
+  auto y = fb.Param("y", u32);
+  auto z = fb.Param("z", u32);
+  fb.Negate(fb.Concat({(fb.Not(fb.Negate(x | y)) - z) * x, z + z}));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule serial_schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                              .clock_period_ps(2)
+                              .pipeline_stages(4)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule parallel_schedule,
+      RunPipelineSchedule(f, TestDelayEstimator(),
+                          SchedulingOptions(SchedulingStrategy::MIN_CUT)
+                              .clock_period_ps(2)
+                              .pipeline_stages(4)
+                              .scheduling_threads(3)));
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(parallel_schedule.cycle(node), serial_schedule.cycle(node))
+        << node->GetName();
+  }
+}
+
 TEST_F(PipelineScheduleTest, AsapScheduleNoParameters) {
   auto p = CreatePackage();
   FunctionBuilder fb(TestName(), p.get());
@@ -461,6 +495,39 @@ TEST_F(PipelineScheduleTest, JustPipelineLengthGiven) {
   EXPECT_THAT(scheduled_ops(5), UnorderedElementsAre(Op::kNeg));
 }
 
+TEST_F(PipelineScheduleTest, ParallelClockPeriodSearchMatchesSerialSearch) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  // A chain of 12 divides of 2ps each. Some stage of a 5 stage pipeline must
+  // hold 3 of them, so the minimum clock period is 6ps, although the 24ps
+  // critical path spread evenly over the stages would allow 5ps.
+  BValue value = x;
+  for (int64_t i = 0; i < 12; ++i) {
+    value = fb.UDiv(value, x);
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule serial_schedule,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions().pipeline_stages(5)));
+  EXPECT_EQ(serial_schedule.min_clock_period_ps(), 6);
+  for (int64_t threads : {2, 3, 8, 64}) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        PipelineSchedule schedule,
+        RunPipelineSchedule(
+            func, TestDelayEstimator(),
+            SchedulingOptions().pipeline_stages(5).clock_search_threads(
+                threads)));
+    EXPECT_EQ(schedule.min_clock_period_ps(),
+              serial_schedule.min_clock_period_ps())
+        << "threads: " << threads;
+    EXPECT_EQ(schedule.length(), 5);
+  }
+}
+
 TEST_F(PipelineScheduleTest, LongPipelineLength) {
   // Generate an absurdly long pipeline schedule. Most stages are empty, but it
   // should not crash.
@@ -1904,5 +1971,138 @@ TEST_F(PipelineScheduleTest,
   EXPECT_THAT(p->GetFunctionBases(), Each(CyclesMatch(schedules, clone)));
 }
 
+TEST_F(PipelineScheduleTest, IncrementalScheduleKeepsUnchangedNodes) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  BValue a = fb.Not(fb.Not(fb.Add(x, y)));
+  BValue b = fb.Negate(fb.Not(a));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(b));
+
+  SchedulingOptions options = SchedulingOptions().pipeline_stages(4);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule prior,
+      RunPipelineSchedule(f, TestDelayEstimator(), options));
+  absl::flat_hash_map<std::string, int64_t> prior_stages;
+  for (Node* node : f->nodes()) {
+    prior_stages[node->GetName()] = prior.cycle(node);
+  }
+
+  // Replace the negate at the end of the function with a new node.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Node * replacement,
+      f->MakeNode<UnOp>(SourceInfo(), b.node()->operand(0), Op::kNot));
+  XLS_ASSERT_OK(f->set_return_value(replacement));
+  XLS_ASSERT_OK(f->RemoveNode(b.node()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunIncrementalPipelineSchedule(f, TestDelayEstimator(), options,
+                                     prior_stages, {replacement}));
+  XLS_ASSERT_OK(schedule.Verify());
+  for (Node* node : f->nodes()) {
+    if (node != replacement && !node->Is<Literal>()) {
+      EXPECT_EQ(schedule.cycle(node), prior_stages.at(node->GetName()))
+          << node->GetName();
+    }
+  }
+}
+
+TEST_F(PipelineScheduleTest, IncrementalScheduleReleasesInfeasiblePins) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue a = fb.Not(x);
+  BValue b = fb.Not(a);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(b));
+
+  // A prior schedule which places `b` before its operand cannot be kept as is.
+  absl::flat_hash_map<std::string, int64_t> prior_stages = {
+      {x.node()->GetName(), 0},
+      {a.node()->GetName(), 1},
+      {b.node()->GetName(), 0},
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunIncrementalPipelineSchedule(f, TestDelayEstimator(),
+                                     SchedulingOptions().pipeline_stages(2),
+                                     prior_stages, {x.node()}));
+  XLS_ASSERT_OK(schedule.Verify());
+  // Releasing the neighbors of `x` is enough to keep `b` in its prior stage.
+  EXPECT_EQ(schedule.cycle(a.node()), 0);
+  EXPECT_EQ(schedule.cycle(b.node()), 0);
+}
+
+// Multiplies cost 100 per result bit, everything else 0.1 per result bit; a
+// register costs 1 per bit.
+class MulHeavyAreaEstimator : public AreaEstimator {
+ public:
+  MulHeavyAreaEstimator() : AreaEstimator("pipeline_schedule_test_mul_heavy") {}
+
+  absl::StatusOr<double> GetOperationAreaInSquareMicrons(
+      Node* node) const override {
+    double per_bit = node->op() == Op::kUMul ? 100.0 : 0.1;
+    return per_bit * node->GetType()->GetFlatBitCount();
+  }
+
+ private:
+  absl::StatusOr<double> GetOneBitRegisterAreaInSquareMicrons() const override {
+    return 1.0;
+  }
+};
+
+TEST_F(PipelineScheduleTest, ModuloResourceSharingSpreadsMultiplies) {
+  static const absl::Status registered =
+      GetAreaEstimatorManagerSingleton().AddAreaEstimator(
+          std::make_unique<MulHeavyAreaEstimator>());
+  XLS_ASSERT_OK(registered);
+
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u16 = p->GetBitsType(16);
+  BValue mul0 = fb.UMul(fb.Param("a", u16), fb.Param("b", u16));
+  BValue mul1 = fb.UMul(fb.Param("c", u16), fb.Param("d", u16));
+  fb.Add(mul0, mul1);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  // Without sharing, everything fits in a single stage.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule unshared,
+      RunPipelineSchedule(
+          func, TestDelayEstimator(),
+          SchedulingOptions().clock_period_ps(10).worst_case_throughput(2)));
+  EXPECT_EQ(unshared.length(), 1);
+
+  // With sharing, the multiplies go in cycles of different parity so a single
+  // multiplier can serve both every other cycle.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule shared,
+      RunPipelineSchedule(func, TestDelayEstimator(),
+                          SchedulingOptions()
+                              .clock_period_ps(10)
+                              .worst_case_throughput(2)
+                              .modulo_resource_sharing(true)
+                              .area_model("pipeline_schedule_test_mul_heavy")));
+  EXPECT_NE(shared.cycle(mul0.node()) % 2, shared.cycle(mul1.node()) % 2);
+  EXPECT_EQ(shared.length(), 2);
+}
+
+TEST_F(PipelineScheduleTest, ModuloResourceSharingRequiresAreaModel) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  Type* u16 = p->GetBitsType(16);
+  fb.UMul(fb.Param("a", u16), fb.Param("b", u16));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.Build());
+
+  EXPECT_THAT(RunPipelineSchedule(func, TestDelayEstimator(),
+                                  SchedulingOptions()
+                                      .clock_period_ps(10)
+                                      .worst_case_throughput(2)
+                                      .modulo_resource_sharing(true)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("--area_model")));
+}
+
 }  // namespace
 }  // namespace xls
@@ -14,15 +14,18 @@
 
 #include "xls/scheduling/pipeline_scheduling_pass.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <optional>
 #include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/node.h"
 #include "xls/ir/proc.h"
 #include "xls/ir/proc_elaboration.h"
@@ -64,34 +67,76 @@ absl::StatusOr<bool> PipelineSchedulingPass::RunInternal(
     XLS_ASSIGN_OR_RETURN(elab, ProcElaboration::Elaborate(top));
   }
 
+  struct ScheduleRequest {
+    FunctionBase* f;
+    SchedulingOptions scheduling_options;
+    absl::flat_hash_map<Node*, int64_t> schedule_cycle_map_before;
+  };
+  std::vector<ScheduleRequest> requests;
   for (FunctionBase* f : schedulable_functions) {
     if (f->ForeignFunctionData().has_value()) {
       continue;
     }
-    absl::flat_hash_map<Node*, int64_t> schedule_cycle_map_before;
-    SchedulingOptions scheduling_options = options.scheduling_options;
+    ScheduleRequest& request = requests.emplace_back(
+        ScheduleRequest{.f = f,
+                        .scheduling_options = options.scheduling_options});
     auto schedule_itr = unit->schedules().find(f);
     if (schedule_itr != unit->schedules().end()) {
       const PipelineSchedule& schedule = schedule_itr->second;
-      schedule_cycle_map_before = schedule.GetCycleMap();
-      if (!scheduling_options.use_fdo()) {
-        AddCycleConstraints(schedule, scheduling_options);
+      request.schedule_cycle_map_before = schedule.GetCycleMap();
+      if (!request.scheduling_options.use_fdo()) {
+        AddCycleConstraints(schedule, request.scheduling_options);
       }
     }
+  }
+
+  auto schedule_one =
+      [&](const ScheduleRequest& request) -> absl::StatusOr<PipelineSchedule> {
+    return options.synthesizer == nullptr
+               ? RunPipelineSchedule(request.f, *options.delay_estimator,
+                                     request.scheduling_options, elab)
+               : RunPipelineScheduleWithFdo(
+                     request.f, *options.delay_estimator,
+                     request.scheduling_options, *options.synthesizer, elab);
+  };
+
+  // The schedules of different FunctionBases are independent: each one only
+  // reads its own FunctionBase (and the shared elaboration), so they can be
+  // solved concurrently. FDO invokes external synthesis tools and is always
+  // run serially.
+  std::vector<absl::StatusOr<PipelineSchedule>> schedules;
+  schedules.reserve(requests.size());
+  int64_t thread_count = options.scheduling_options.scheduling_threads();
+  if (thread_count > 1 && requests.size() > 1 &&
+      options.synthesizer == nullptr) {
+    for (int64_t i = 0; i < requests.size(); ++i) {
+      schedules.push_back(absl::UnknownError("Not scheduled"));
+    }
+    {
+      ThreadPool pool(
+          std::min(thread_count, static_cast<int64_t>(requests.size())));
+      for (int64_t i = 0; i < requests.size(); ++i) {
+        pool.Schedule([&, i]() { schedules[i] = schedule_one(requests[i]); });
+      }
+      pool.WaitForIdle();
+    }
+  } else {
+    for (const ScheduleRequest& request : requests) {
+      schedules.push_back(schedule_one(request));
+      if (!schedules.back().ok()) {
+        break;
+      }
+    }
+  }
 
-    XLS_ASSIGN_OR_RETURN(
-        PipelineSchedule schedule,
-        options.synthesizer == nullptr
-            ? RunPipelineSchedule(f, *options.delay_estimator,
-                                  scheduling_options, elab)
-            : RunPipelineScheduleWithFdo(f, *options.delay_estimator,
-                                         scheduling_options,
-                                         *options.synthesizer, elab));
+  for (int64_t i = 0; i < schedules.size(); ++i) {
+    XLS_ASSIGN_OR_RETURN(PipelineSchedule schedule, std::move(schedules[i]));
 
     // Compute `changed` before moving schedule into unit->schedules.
-    changed = changed || (schedule_cycle_map_before != schedule.GetCycleMap());
+    changed = changed ||
+              (requests[i].schedule_cycle_map_before != schedule.GetCycleMap());
 
-    unit->schedules().insert_or_assign(schedule_itr, f, std::move(schedule));
+    unit->schedules().insert_or_assign(requests[i].f, std::move(schedule));
   }
   return changed;
 }
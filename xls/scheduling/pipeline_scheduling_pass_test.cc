@@ -14,6 +14,7 @@
 
 #include "xls/scheduling/pipeline_scheduling_pass.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string_view>
 #include <utility>
@@ -22,6 +23,7 @@
 #include "gtest/gtest.h"
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/file/get_runfile_path.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
@@ -162,6 +164,35 @@ TEST_F(PipelineSchedulingPassTest, MultipleProcs) {
                     HasSubstr("proc proc1(st: bits[1]")));
 }
 
+TEST_F(PipelineSchedulingPassTest, ConcurrentSchedulingMatchesSerial) {
+  auto p = CreatePackage();
+  for (int64_t i = 0; i < 6; ++i) {
+    XLS_ASSERT_OK_AND_ASSIGN(
+        Channel * ch,
+        p->CreateStreamingChannel(absl::StrCat("ch", i), ChannelOps::kSendOnly,
+                                  p->GetBitsType(32)));
+    ProcBuilder pb(absl::StrCat("proc", i), p.get());
+    BValue tok = pb.Literal(Value::Token());
+    BValue st = pb.StateElement("st", Value(UBits(0, 32)));
+    BValue next = pb.Add(pb.UMul(st, st), pb.Literal(UBits(i + 1, 32)));
+    pb.Send(ch, tok, next);
+    XLS_ASSERT_OK(pb.Build({next}).status());
+  }
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RunResultT serial,
+      RunPipelineSchedulingPass(p.get(),
+                                SchedulingOptions().clock_period_ps(2)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      RunResultT concurrent,
+      RunPipelineSchedulingPass(
+          p.get(),
+          SchedulingOptions().clock_period_ps(2).scheduling_threads(4)));
+  EXPECT_TRUE(concurrent.first);
+  EXPECT_EQ(concurrent.second.schedules().size(), 6);
+  EXPECT_EQ(concurrent.second.DumpIr(), serial.second.DumpIr());
+}
+
 TEST_F(PipelineSchedulingPassTest, MixedFunctionAndProcScheduling) {
   auto p = CreatePackage();
 
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <random>
@@ -28,6 +29,7 @@
 #include "absl/base/log_severity.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/random/distributions.h"
@@ -40,7 +42,10 @@
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/binary_search.h"
+#include "xls/estimators/area_model/area_estimator.h"
+#include "xls/estimators/area_model/area_estimators.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/fdo/delay_manager.h"
 #include "xls/fdo/iterative_sdc_scheduler.h"
@@ -57,6 +62,7 @@
 #include "xls/ir/proc_elaboration.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/scheduling/min_cut_scheduler.h"
+#include "xls/scheduling/modulo_resources.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/schedule_bounds.h"
 #include "xls/scheduling/schedule_util.h"
@@ -168,19 +174,22 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
     absl::Span<Node* const> topo_sort,
     const absl::flat_hash_set<Node*> dead_after_synthesis,
     const DelayEstimator& delay_estimator) {
+  std::vector<Node*> live_nodes;
+  live_nodes.reserve(topo_sort.size());
+  absl::c_copy_if(topo_sort, std::back_inserter(live_nodes), [&](Node* node) {
+    return !dead_after_synthesis.contains(node);
+  });
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       delay_estimator.GetOperationDelaysInPs(live_nodes));
   int64_t function_cp = 0;
   absl::flat_hash_map<Node*, int64_t> node_cp;
-  for (Node* node : topo_sort) {
-    if (dead_after_synthesis.contains(node)) {
-      continue;
-    }
+  for (int64_t i = 0; i < live_nodes.size(); ++i) {
+    Node* node = live_nodes[i];
     int64_t node_start = 0;
     for (Node* operand : node->operands()) {
       node_start = std::max(node_start, node_cp[operand]);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay,
-                         delay_estimator.GetOperationDelayInPs(node));
-    node_cp[node] = node_start + node_delay;
+    node_cp[node] = node_start + delays[i];
     function_cp = std::max(function_cp, node_cp[node]);
   }
   return function_cp;
@@ -191,14 +200,69 @@ absl::StatusOr<int64_t> ComputeCriticalPath(
                              delay_estimator);
 }
 
+// Returns the minimum clock period in the inclusive range [start, end], where
+// `end` is known to be feasible, for which `feasible` holds. Each round probes
+// up to `schedulers.size()` candidate periods which split the range evenly,
+// concurrently and on one scheduler each, then narrows the range to lie between
+// the largest infeasible and the smallest feasible candidate. The search ends
+// as soon as the range holds a single period, so a range no wider than the
+// number of schedulers takes one round. Scheduler `i` is always given the
+// `i`-th smallest candidate, so each incremental model sees nearby periods in
+// successive rounds and can reuse its last feasible solution where it still
+// applies.
+int64_t ParallelSearchMinClockPeriod(
+    int64_t start, int64_t end, absl::Span<SDCScheduler* const> schedulers,
+    absl::FunctionRef<bool(SDCScheduler&, int64_t)> feasible) {
+  ThreadPool pool(schedulers.size());
+  std::vector<int64_t> candidates;
+  // Not std::vector<bool>, whose elements may not be written concurrently.
+  std::vector<char> results;
+  while (start < end) {
+    const int64_t width = end - start;
+    const int64_t count =
+        std::min(static_cast<int64_t>(schedulers.size()), width);
+    candidates.resize(count);
+    results.assign(count, false);
+    for (int64_t i = 0; i < count; ++i) {
+      candidates[i] = start + width * (i + 1) / (count + 1);
+      pool.Schedule([&, i]() {
+        results[i] = feasible(*schedulers[i], candidates[i]);
+      });
+    }
+    pool.WaitForIdle();
+    VLOG(4) << absl::StreamFormat(
+        "Probed clock periods [%s] over interval [%d, %d]: [%s]",
+        absl::StrJoin(candidates, ", "), start, end,
+        absl::StrJoin(results, ", ", [](std::string* out, char result) {
+          absl::StrAppend(out, result ? "feasible" : "infeasible");
+        }));
+
+    // The candidates are increasing, so the first feasible one bounds the
+    // minimum from above and the infeasible one before it bounds it from below.
+    int64_t first_feasible = absl::c_find(results, true) - results.begin();
+    if (first_feasible < count) {
+      end = candidates[first_feasible];
+    }
+    if (first_feasible > 0) {
+      start = candidates[first_feasible - 1] + 1;
+    }
+  }
+  return end;
+}
+
 // Returns the minimum clock period in picoseconds for which it is feasible to
 // schedule the function into a pipeline with the given number of stages. If
 // `target_clock_period_ps` is specified, will not try to check lower clock
 // periods than this.
+//
+// If `search_threads` is greater than one, candidate clock periods are checked
+// that many at a time in parallel, each on its own copy of `scheduler` built
+// from `f`, `delay_estimator` and `constraints`.
 absl::StatusOr<int64_t> FindMinimumClockPeriod(
     FunctionBase* f, std::optional<int64_t> pipeline_stages,
     std::optional<int64_t> worst_case_throughput,
     const DelayEstimator& delay_estimator, SDCScheduler& scheduler,
+    absl::Span<const SchedulingConstraint> constraints, int64_t search_threads,
     SchedulingFailureBehavior failure_behavior,
     std::optional<int64_t> target_clock_period_ps = std::nullopt) {
   VLOG(4) << "FindMinimumClockPeriod()";
@@ -246,20 +310,60 @@ absl::StatusOr<int64_t> FindMinimumClockPeriod(
   // Don't waste time explaining infeasibility for the failing points in the
   // search.
   failure_behavior.explain_infeasibility = false;
-  int64_t min_clk_period_ps = BinarySearchMinTrue(
-      optimistic_clk_period_ps, pessimistic_clk_period_ps,
-      [&](int64_t clk_period_ps) {
-        return scheduler
-            .Schedule(pipeline_stages, clk_period_ps, failure_behavior,
-                      /*check_feasibility=*/true, worst_case_throughput)
-            .ok();
-      },
-      BinarySearchAssumptions::kEndKnownTrue);
+  auto feasible = [&](SDCScheduler& worker, int64_t clk_period_ps) {
+    return worker
+        .Schedule(pipeline_stages, clk_period_ps, failure_behavior,
+                  /*check_feasibility=*/true, worst_case_throughput)
+        .ok();
+  };
+  int64_t min_clk_period_ps;
+  if (search_threads > 1 &&
+      pessimistic_clk_period_ps - optimistic_clk_period_ps > 1) {
+    const int64_t worker_count = std::min(
+        search_threads, pessimistic_clk_period_ps - optimistic_clk_period_ps);
+    std::vector<std::unique_ptr<SDCScheduler>> extra_schedulers;
+    std::vector<SDCScheduler*> schedulers = {&scheduler};
+    while (static_cast<int64_t>(schedulers.size()) < worker_count) {
+      XLS_ASSIGN_OR_RETURN(extra_schedulers.emplace_back(),
+                           SDCScheduler::Create(f, delay_estimator));
+      XLS_RETURN_IF_ERROR(extra_schedulers.back()->AddConstraints(constraints));
+      schedulers.push_back(extra_schedulers.back().get());
+    }
+    min_clk_period_ps = ParallelSearchMinClockPeriod(
+        optimistic_clk_period_ps, pessimistic_clk_period_ps, schedulers,
+        feasible);
+  } else {
+    min_clk_period_ps = BinarySearchMinTrue(
+        optimistic_clk_period_ps, pessimistic_clk_period_ps,
+        [&](int64_t clk_period_ps) {
+          return feasible(scheduler, clk_period_ps);
+        },
+        BinarySearchAssumptions::kEndKnownTrue);
+  }
   VLOG(4) << "minimum clock period = " << min_clk_period_ps;
 
   return min_clk_period_ps;
 }
 
+// Configures `scheduler` to share the operations which the area model in
+// `options` deems worth sharing across the cycles of `initiation_interval`.
+absl::Status SetUpModuloResourceSharing(FunctionBase* f,
+                                        const SchedulingOptions& options,
+                                        int64_t initiation_interval,
+                                        SDCScheduler& scheduler) {
+  if (!options.area_model().has_value()) {
+    return absl::InvalidArgumentError(
+        "Modulo resource sharing requires an area model; set `--area_model`.");
+  }
+  XLS_ASSIGN_OR_RETURN(AreaEstimator * area_estimator,
+                       GetAreaEstimator(*options.area_model()));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<ModuloResourceClass> classes,
+      ComputeModuloResourceClasses(f, initiation_interval, *area_estimator));
+  scheduler.SetModuloResourceClasses(std::move(classes));
+  return absl::OkStatus();
+}
+
 // Returns the minimum inverse worst-case throughput for which it is feasible to
 // schedule the function into a pipeline with the given number of stages and
 // target clock period.
@@ -481,7 +585,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
             f, options.pipeline_stages(),
             /*worst_case_throughput=*/f->IsProc() ? f->GetInitiationInterval()
                                                   : std::nullopt,
-            io_delay_added, *sdc_scheduler, options.failure_behavior()));
+            io_delay_added, *sdc_scheduler, options.constraints(),
+            options.clock_search_threads(), options.failure_behavior()));
     min_clock_period_ps_for_tracing = clock_period_ps;
 
     if (options.period_relaxation_percent().has_value()) {
@@ -576,6 +681,13 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
     }
 
     XLS_RETURN_IF_ERROR(initialize_sdc_scheduler());
+    if (options.modulo_resource_sharing()) {
+      XLS_RETURN_IF_ERROR(SetUpModuloResourceSharing(
+          f, options,
+          worst_case_throughput.value_or(
+              f->GetInitiationInterval().value_or(1)),
+          *sdc_scheduler));
+    }
     absl::StatusOr<ScheduleCycleMap> schedule_cycle_map =
         sdc_scheduler->Schedule(options.pipeline_stages(), clock_period_ps,
                                 options.failure_behavior(),
@@ -603,7 +715,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
           XLS_RETURN_IF_ERROR(initialize_sdc_scheduler());
           absl::StatusOr<int64_t> min_clock_period_ps = FindMinimumClockPeriod(
               f, options.pipeline_stages(), worst_case_throughput,
-              io_delay_added, *sdc_scheduler, options.failure_behavior(),
+              io_delay_added, *sdc_scheduler, options.constraints(),
+              options.clock_search_threads(), options.failure_behavior(),
               target_clock_period_ps);
           if (min_clock_period_ps.ok()) {
             min_clock_period_ps_for_tracing = *min_clock_period_ps;
@@ -679,7 +792,8 @@ absl::StatusOr<PipelineSchedule> RunPipelineScheduleInternal(
           MinCutScheduler(
               f,
               options.pipeline_stages().value_or(bounds.max_lower_bound() + 1),
-              clock_period_ps, io_delay_added, &bounds, options.constraints()));
+              clock_period_ps, io_delay_added, &bounds, options.constraints(),
+              options.scheduling_threads()));
     } else if (options.strategy() == SchedulingStrategy::RANDOM) {
       std::mt19937_64 gen(options.seed().value_or(0));
 
@@ -725,6 +839,63 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
                                      /*synthesizer=*/nullptr);
 }
 
+absl::StatusOr<PipelineSchedule> RunIncrementalPipelineSchedule(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    const absl::flat_hash_map<std::string, int64_t>& prior_stages,
+    const absl::flat_hash_set<Node*>& changed_nodes,
+    const std::optional<ProcElaboration>& elab) {
+  // Nodes which are free to move, and the most recently released ones.
+  absl::flat_hash_set<Node*> released = changed_nodes;
+  std::vector<Node*> frontier(changed_nodes.begin(), changed_nodes.end());
+  int64_t radius = 0;
+  for (int64_t target_radius = 1;; target_radius *= 2) {
+    SchedulingOptions pinned_options = options;
+    int64_t pinned_count = 0;
+    for (Node* node : f->nodes()) {
+      // Literals are cheap to rematerialize and are left to the scheduler.
+      if (released.contains(node) || node->Is<Literal>()) {
+        continue;
+      }
+      auto it = prior_stages.find(node->GetName());
+      if (it == prior_stages.end()) {
+        continue;
+      }
+      pinned_options.add_constraint(NodeInCycleConstraint(node, it->second));
+      ++pinned_count;
+    }
+    absl::StatusOr<PipelineSchedule> schedule =
+        RunPipelineSchedule(f, delay_estimator, pinned_options, elab);
+    if (schedule.ok() || pinned_count == 0) {
+      return schedule;
+    }
+    VLOG(2) << absl::StreamFormat(
+        "Incremental schedule of %s with %d pinned nodes (radius %d) is "
+        "infeasible: %s",
+        f->name(), pinned_count, radius, schedule.status().message());
+
+    const int64_t released_count = released.size();
+    for (; radius < target_radius && !frontier.empty(); ++radius) {
+      std::vector<Node*> next_frontier;
+      auto release = [&](Node* neighbor) {
+        if (released.insert(neighbor).second) {
+          next_frontier.push_back(neighbor);
+        }
+      };
+      for (Node* node : frontier) {
+        absl::c_for_each(node->operands(), release);
+        absl::c_for_each(node->users(), release);
+      }
+      frontier = std::move(next_frontier);
+    }
+    if (static_cast<int64_t>(released.size()) == released_count) {
+      // The neighborhood cannot grow any further; give up on the prior
+      // schedule entirely.
+      return RunPipelineSchedule(f, delay_estimator, options, elab);
+    }
+  }
+}
+
 absl::StatusOr<PipelineSchedule> RunPipelineScheduleWithFdo(
     FunctionBase* f, const DelayEstimator& delay_estimator,
     const SchedulingOptions& options, const synthesis::Synthesizer& synthesizer,
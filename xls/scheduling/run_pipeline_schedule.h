@@ -15,12 +15,17 @@
 #ifndef XLS_SCHEDULING_RUN_PIPELINE_SCHEDULE_H_
 #define XLS_SCHEDULING_RUN_PIPELINE_SCHEDULE_H_
 
+#include <cstdint>
 #include <optional>
+#include <string>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
 #include "xls/ir/proc_elaboration.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -35,6 +40,21 @@ absl::StatusOr<PipelineSchedule> RunPipelineSchedule(
     const SchedulingOptions& options,
     const std::optional<ProcElaboration>& elab = std::nullopt);
 
+// Reschedules `f` after a small edit, keeping as much of a prior schedule as
+// possible. `prior_stages` maps node names to their stage in the prior
+// schedule (nodes absent from `f` are ignored) and `changed_nodes` are the
+// nodes of `f` touched by the edit. Every other node is first pinned to its
+// prior stage; if that is infeasible, a neighborhood of the changed nodes of
+// geometrically growing radius is released until a schedule is found, falling
+// back on scheduling `f` from scratch. The number of solves is logarithmic in
+// the size of `f` and unchanged nodes usually keep their stages.
+absl::StatusOr<PipelineSchedule> RunIncrementalPipelineSchedule(
+    FunctionBase* f, const DelayEstimator& delay_estimator,
+    const SchedulingOptions& options,
+    const absl::flat_hash_map<std::string, int64_t>& prior_stages,
+    const absl::flat_hash_set<Node*>& changed_nodes,
+    const std::optional<ProcElaboration>& elab = std::nullopt);
+
 // Produce a pipeline schedule using feedback-directed scheduling.
 absl::StatusOr<PipelineSchedule> RunPipelineScheduleWithFdo(
     FunctionBase* f, const DelayEstimator& delay_estimator,
@@ -17,17 +17,18 @@
 #include <algorithm>
 #include <cstdint>
 #include <limits>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
 #include "xls/ir/topo_sort.h"
@@ -38,12 +39,7 @@ namespace sched {
 
 ScheduleBounds::ScheduleBounds(FunctionBase* f, int64_t clock_period_ps,
                                const DelayEstimator& delay_estimator)
-    : clock_period_ps_(clock_period_ps), delay_estimator_(&delay_estimator) {
-  auto topo_sort_it = TopoSort(f);
-  topo_sort_ = std::vector<Node*>(topo_sort_it.begin(), topo_sort_it.end());
-  dead_after_synthesis_ = GetDeadAfterSynthesisNodes(f);
-  Reset();
-}
+    : ScheduleBounds(f, TopoSort(f), clock_period_ps, delay_estimator) {}
 
 ScheduleBounds::ScheduleBounds(FunctionBase* f, std::vector<Node*> topo_sort,
                                int64_t clock_period_ps,
@@ -52,80 +48,152 @@ ScheduleBounds::ScheduleBounds(FunctionBase* f, std::vector<Node*> topo_sort,
       dead_after_synthesis_(GetDeadAfterSynthesisNodes(f)),
       clock_period_ps_(clock_period_ps),
       delay_estimator_(&delay_estimator) {
+  int64_t max_id = -1;
+  for (Node* node : topo_sort_) {
+    max_id = std::max(max_id, node->id());
+  }
+  topo_index_.resize(max_id + 1, -1);
+  for (int64_t i = 0; i < topo_sort_.size(); ++i) {
+    topo_index_[topo_sort_[i]->id()] = i;
+  }
+  delays_.resize(topo_sort_.size());
   Reset();
 }
 
 void ScheduleBounds::Reset() {
+  const int64_t node_count = topo_sort_.size();
   max_lower_bound_ = 0;
-  min_upper_bound_ = 0;
-  for (Node* node : topo_sort_) {
-    bounds_[node] = {0, std::numeric_limits<int64_t>::max()};
-    max_lower_bound_ = 0;
-    min_upper_bound_ = std::numeric_limits<int64_t>::max();
+  min_upper_bound_ = node_count == 0 ? 0 : std::numeric_limits<int64_t>::max();
+  bounds_.assign(node_count, {0, std::numeric_limits<int64_t>::max()});
+  lb_in_cycle_delay_.assign(node_count, 0);
+  ub_in_cycle_delay_.assign(node_count, 0);
+  // Every node is visited by the first propagation.
+  lb_pending_.assign(node_count, false);
+  ub_pending_.assign(node_count, false);
+  lb_queue_ = {};
+  ub_queue_ = {};
+  for (int64_t i = 0; i < node_count; ++i) {
+    MarkLbPending(i);
+    MarkUbPending(i);
   }
 }
 
 std::string ScheduleBounds::ToString() const {
   std::string out = "Bounds:\n";
-  if (!bounds_.empty()) {
-    for (Node* node : TopoSort(bounds_.begin()->first->function_base())) {
-      if (bounds_.contains(node)) {
-        absl::StrAppendFormat(&out, "  %s : [%d, %d]\n", node->GetName(),
-                              lb(node), ub(node));
-      }
-    }
+  for (Node* node : topo_sort_) {
+    absl::StrAppendFormat(&out, "  %s : [%d, %d]\n", node->GetName(), lb(node),
+                          ub(node));
   }
   return out;
 }
 
-absl::StatusOr<int64_t> ScheduleBounds::GetDelay(Node* node) const {
-  // Treat nodes that will be dead after synthesis as having a delay of 0.
-  if (dead_after_synthesis_.contains(node)) {
-    return 0;
+absl::Status ScheduleBounds::CheckLb(int64_t index, int64_t value) const {
+  if (value > bounds_[index].second) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
+                        topo_sort_[index]->GetName(), value));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ScheduleBounds::CheckUb(int64_t index, int64_t value) const {
+  if (value < bounds_[index].first) {
+    return absl::ResourceExhaustedError(
+        absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
+                        topo_sort_[index]->GetName(), value));
+  }
+  return absl::OkStatus();
+}
+
+void ScheduleBounds::MarkLbPending(int64_t index) {
+  if (!lb_pending_[index]) {
+    lb_pending_[index] = true;
+    lb_queue_.push(index);
+  }
+}
+
+void ScheduleBounds::MarkUsersLbPending(int64_t index) {
+  for (Node* user : topo_sort_[index]->users()) {
+    MarkLbPending(TopoIndex(user));
   }
-  return delay_estimator_->GetOperationDelayInPs(node);
+}
+
+void ScheduleBounds::MarkUbPending(int64_t index) {
+  if (!ub_pending_[index]) {
+    ub_pending_[index] = true;
+    ub_queue_.push(index);
+  }
+}
+
+void ScheduleBounds::MarkOperandsUbPending(int64_t index) {
+  for (Node* operand : topo_sort_[index]->operands()) {
+    MarkUbPending(TopoIndex(operand));
+  }
+}
+
+absl::StatusOr<int64_t> ScheduleBounds::GetDelay(int64_t index) {
+  std::optional<int64_t>& delay = delays_[index];
+  if (!delay.has_value()) {
+    Node* node = topo_sort_[index];
+    // Treat nodes that will be dead after synthesis as having a delay of 0.
+    if (dead_after_synthesis_.contains(node)) {
+      delay = 0;
+    } else {
+      XLS_ASSIGN_OR_RETURN(delay,
+                           delay_estimator_->GetOperationDelayInPs(node));
+    }
+  }
+  return *delay;
 }
 
 absl::Status ScheduleBounds::PropagateLowerBounds() {
   VLOG(4) << "PropagateLowerBounds()";
-  // The delay in picoseconds from the beginning of a cycle to the start of the
-  // node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
-
-  // Compute the lower bound of each node based on the lower bounds of the
-  // operands of the node.
-  for (Node* node : topo_sort_) {
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
+  // Compute the lower bound of each pending node based on the lower bounds of
+  // the operands of the node. Positions are visited in topological order so
+  // each node is visited at most once.
+  while (!lb_queue_.empty()) {
+    const int64_t index = lb_queue_.top();
+    Node* node = topo_sort_[index];
+    const int64_t original_lb = bounds_[index].first;
+    int64_t node_lb = original_lb;
+    // The delay in picoseconds from the beginning of a cycle to the start of
+    // the node.
+    int64_t node_in_cycle_delay = 0;
     VLOG(4) << absl::StreamFormat("  %s : original lb=%d", node->GetName(),
-                                  lb(node));
+                                  original_lb);
     for (Node* operand : node->operands()) {
-      int64_t operand_lb = lb(operand);
-      if (operand_lb < lb(node)) {
+      const int64_t operand_index = TopoIndex(operand);
+      int64_t operand_lb = bounds_[operand_index].first;
+      if (operand_lb < node_lb) {
         continue;
       }
-      XLS_ASSIGN_OR_RETURN(int64_t operand_delay, GetDelay(operand));
-      if (operand_lb > lb(node)) {
+      XLS_ASSIGN_OR_RETURN(int64_t operand_delay, GetDelay(operand_index));
+      if (operand_lb > node_lb) {
         VLOG(4) << absl::StreamFormat(
             "    tightened lb to %d because of operand %s", operand_lb,
             operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb));
-        node_in_cycle_delay = in_cycle_delay.at(operand) + operand_delay;
+        XLS_RETURN_IF_ERROR(CheckLb(index, operand_lb));
+        node_lb = operand_lb;
+        node_in_cycle_delay =
+            lb_in_cycle_delay_[operand_index] + operand_delay;
         continue;
       }
       int64_t min_delay =
           operand->Is<MinDelay>() ? operand->As<MinDelay>()->delay() : 0;
-      if (operand_lb + min_delay > lb(node)) {
+      if (operand_lb + min_delay > node_lb) {
         VLOG(4) << absl::StreamFormat(
             "    tightened lb to %d because of operand %s", operand_lb,
             operand->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeLb(node, operand_lb + min_delay));
+        XLS_RETURN_IF_ERROR(CheckLb(index, operand_lb + min_delay));
+        node_lb = operand_lb + min_delay;
         node_in_cycle_delay = 0;
         continue;
       }
-      node_in_cycle_delay = std::max(
-          node_in_cycle_delay, in_cycle_delay.at(operand) + operand_delay);
+      node_in_cycle_delay =
+          std::max(node_in_cycle_delay,
+                   lb_in_cycle_delay_[operand_index] + operand_delay);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay, GetDelay(node));
+    XLS_ASSIGN_OR_RETURN(int64_t node_delay, GetDelay(index));
     if (node_delay > clock_period_ps_) {
       return absl::ResourceExhaustedError(absl::StrFormat(
           "Node %s has a greater delay (%dps) than the clock period (%dps)",
@@ -133,45 +201,58 @@ absl::Status ScheduleBounds::PropagateLowerBounds() {
     }
     if (node_in_cycle_delay + node_delay > clock_period_ps_) {
       // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened lb to " << lb(node) + 1;
-      XLS_RETURN_IF_ERROR(TightenNodeLb(node, lb(node) + 1));
+      VLOG(4) << "    overflows clock period, tightened lb to " << node_lb + 1;
+      XLS_RETURN_IF_ERROR(CheckLb(index, node_lb + 1));
+      ++node_lb;
       node_in_cycle_delay = 0;
     }
+
+    lb_queue_.pop();
+    lb_pending_[index] = false;
+    max_lower_bound_ = std::max(max_lower_bound_, node_lb);
+    if (node_lb != original_lb ||
+        node_in_cycle_delay != lb_in_cycle_delay_[index]) {
+      bounds_[index].first = node_lb;
+      lb_in_cycle_delay_[index] = node_in_cycle_delay;
+      MarkUsersLbPending(index);
+    }
   }
   return absl::OkStatus();
 }
 
 absl::Status ScheduleBounds::PropagateUpperBounds() {
   VLOG(4) << "PropagateUpperBounds()";
-  // The delay in picoseconds from the end of a cycle to the end of the node.
-  absl::flat_hash_map<Node*, int64_t> in_cycle_delay;
-
-  // Compute the upper bound of each node based on the upper bounds of the
-  // users of the node.
-  for (auto it = topo_sort_.rbegin(); it != topo_sort_.rend(); ++it) {
-    Node* node = *it;
-    int64_t& node_in_cycle_delay = in_cycle_delay[node];
+  // Compute the upper bound of each pending node based on the upper bounds of
+  // the users of the node, visiting positions in reverse topological order.
+  while (!ub_queue_.empty()) {
+    const int64_t index = ub_queue_.top();
+    Node* node = topo_sort_[index];
+    const int64_t original_ub = bounds_[index].second;
+    int64_t node_ub = original_ub;
+    // The delay in picoseconds from the end of a cycle to the end of the node.
+    int64_t node_in_cycle_delay = 0;
     VLOG(4) << absl::StreamFormat("  %s : original ub=%d", node->GetName(),
-                                  ub(node));
+                                  original_ub);
     for (Node* user : node->users()) {
-      int64_t user_ub = ub(user);
-      if (user_ub == std::numeric_limits<int64_t>::max() ||
-          user_ub > ub(node)) {
+      const int64_t user_index = TopoIndex(user);
+      int64_t user_ub = bounds_[user_index].second;
+      if (user_ub == std::numeric_limits<int64_t>::max() || user_ub > node_ub) {
         continue;
       }
-      XLS_ASSIGN_OR_RETURN(int64_t user_delay, GetDelay(user));
-      if (user_ub < ub(node)) {
+      XLS_ASSIGN_OR_RETURN(int64_t user_delay, GetDelay(user_index));
+      if (user_ub < node_ub) {
         VLOG(4) << absl::StreamFormat(
             "    tightened ub to %d because of user %s", user_ub,
             user->GetName());
-        XLS_RETURN_IF_ERROR(TightenNodeUb(node, user_ub));
-        node_in_cycle_delay = in_cycle_delay.at(user) + user_delay;
+        XLS_RETURN_IF_ERROR(CheckUb(index, user_ub));
+        node_ub = user_ub;
+        node_in_cycle_delay = ub_in_cycle_delay_[user_index] + user_delay;
         continue;
       }
-      node_in_cycle_delay =
-          std::max(node_in_cycle_delay, in_cycle_delay.at(user) + user_delay);
+      node_in_cycle_delay = std::max(
+          node_in_cycle_delay, ub_in_cycle_delay_[user_index] + user_delay);
     }
-    XLS_ASSIGN_OR_RETURN(int64_t node_delay, GetDelay(node));
+    XLS_ASSIGN_OR_RETURN(int64_t node_delay, GetDelay(index));
     if (node_delay > clock_period_ps_) {
       return absl::ResourceExhaustedError(absl::StrFormat(
           "Node %s has a greater delay (%dps) than the clock period (%dps)",
@@ -179,10 +260,21 @@ absl::Status ScheduleBounds::PropagateUpperBounds() {
     }
     if (node_in_cycle_delay + node_delay > clock_period_ps_) {
       // Node does not fit in this cycle. Move to next cycle.
-      VLOG(4) << "    overflows clock period, tightened ub to " << ub(node) - 1;
-      XLS_RETURN_IF_ERROR(TightenNodeUb(node, ub(node) - 1));
+      VLOG(4) << "    overflows clock period, tightened ub to " << node_ub - 1;
+      XLS_RETURN_IF_ERROR(CheckUb(index, node_ub - 1));
+      --node_ub;
       node_in_cycle_delay = 0;
     }
+
+    ub_queue_.pop();
+    ub_pending_[index] = false;
+    min_upper_bound_ = std::min(min_upper_bound_, node_ub);
+    if (node_ub != original_ub ||
+        node_in_cycle_delay != ub_in_cycle_delay_[index]) {
+      bounds_[index].second = node_ub;
+      ub_in_cycle_delay_[index] = node_in_cycle_delay;
+      MarkOperandsUbPending(index);
+    }
   }
   return absl::OkStatus();
 }
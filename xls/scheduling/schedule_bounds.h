@@ -17,15 +17,17 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/str_format.h"
+#include "xls/common/status/status_macros.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/node.h"
 
@@ -66,25 +68,27 @@ class ScheduleBounds {
   void Reset();
 
   // Return the lower/upper bound of the given node.
-  int64_t lb(Node* node) const { return bounds_.at(node).first; }
-  int64_t ub(Node* node) const { return bounds_.at(node).second; }
+  int64_t lb(Node* node) const { return bounds_[TopoIndex(node)].first; }
+  int64_t ub(Node* node) const { return bounds_[TopoIndex(node)].second; }
 
   // Return the lower and upper bound as a pair (lower bound is first element).
   const std::pair<int64_t, int64_t>& bounds(Node* node) const {
-    return bounds_.at(node);
+    return bounds_[TopoIndex(node)];
   }
 
   // Sets the lower bound of the given node to the maximum of its existing value
   // and the given value. Raises a ResourceExhaustedError if the new value
   // results in infeasible bounds (lower bound is greater than upper bound).
   absl::Status TightenNodeLb(Node* node, int64_t value) {
-    if (value > ub(node)) {
-      return absl::ResourceExhaustedError(
-          absl::StrFormat("Unable to tighten the lower bound of node %s to %d.",
-                          node->GetName(), value));
-    }
-    bounds_.at(node).first = std::max(bounds_.at(node).first, value);
+    int64_t index = TopoIndex(node);
+    XLS_RETURN_IF_ERROR(CheckLb(index, value));
     max_lower_bound_ = std::max(max_lower_bound_, value);
+    if (value > bounds_[index].first) {
+      bounds_[index].first = value;
+      // The node's own in-cycle delay may change as well as its users'.
+      MarkLbPending(index);
+      MarkUsersLbPending(index);
+    }
     return absl::OkStatus();
   }
 
@@ -92,13 +96,14 @@ class ScheduleBounds {
   // and the given value. Raises a ResourceExhaustedError if the new value
   // results in infeasible bounds (lower bound is greater than upper bound).
   absl::Status TightenNodeUb(Node* node, int64_t value) {
-    if (value < lb(node)) {
-      return absl::ResourceExhaustedError(
-          absl::StrFormat("Unable to tighten the upper bound of node %s to %d.",
-                          node->GetName(), value));
-    }
-    bounds_.at(node).second = std::min(bounds_.at(node).second, value);
+    int64_t index = TopoIndex(node);
+    XLS_RETURN_IF_ERROR(CheckUb(index, value));
     min_upper_bound_ = std::min(min_upper_bound_, value);
+    if (value < bounds_[index].second) {
+      bounds_[index].second = value;
+      MarkUbPending(index);
+      MarkOperandsUbPending(index);
+    }
     return absl::OkStatus();
   }
 
@@ -114,23 +119,63 @@ class ScheduleBounds {
   // throughout the graph. This method only tightens bounds (increases lower
   // bounds and decreases upper bounds). Returns an error if propagation results
   // in infeasible bounds (lower bound is greater than upper bound for a node).
+  //
+  // Propagation is incremental: only the fan-out (fan-in) of nodes whose
+  // bounds changed since the last propagation is revisited, and it stops at
+  // nodes whose bound and in-cycle delay are unaffected.
   absl::Status PropagateLowerBounds();
   absl::Status PropagateUpperBounds();
 
  private:
-  absl::StatusOr<int64_t> GetDelay(Node* node) const;
+  int64_t TopoIndex(Node* node) const { return topo_index_.at(node->id()); }
+
+  // Returns an error if `value` is not a feasible lower (upper) bound of the
+  // node at topological position `index`.
+  absl::Status CheckLb(int64_t index, int64_t value) const;
+  absl::Status CheckUb(int64_t index, int64_t value) const;
+
+  // Schedules the node at topological position `index` (or its users or
+  // operands) to be revisited by the next propagation.
+  void MarkLbPending(int64_t index);
+  void MarkUsersLbPending(int64_t index);
+  void MarkUbPending(int64_t index);
+  void MarkOperandsUbPending(int64_t index);
+
+  // Returns the delay of the node at topological position `index`.
+  absl::StatusOr<int64_t> GetDelay(int64_t index);
 
   // A topological sort of the nodes in the function.
   std::vector<Node*> topo_sort_;
 
+  // Position of each node in `topo_sort_`, indexed by node id.
+  std::vector<int64_t> topo_index_;
+
   // The set of nodes that can't affect anything that will be synthesized.
   absl::flat_hash_set<Node*> dead_after_synthesis_;
 
   int64_t clock_period_ps_;
   const DelayEstimator* delay_estimator_;
 
+  // The following are indexed by topological position.
+  //
   // The bounds of each node stored as a {lower, upper} pair.
-  absl::flat_hash_map<Node*, std::pair<int64_t, int64_t>> bounds_;
+  std::vector<std::pair<int64_t, int64_t>> bounds_;
+  // The delay of each node, computed on first use.
+  std::vector<std::optional<int64_t>> delays_;
+  // The delay in picoseconds from the beginning of the node's lower bound
+  // cycle to the start of the node, as of the last lower bound propagation.
+  std::vector<int64_t> lb_in_cycle_delay_;
+  // The delay in picoseconds from the end of the node to the end of its upper
+  // bound cycle, as of the last upper bound propagation.
+  std::vector<int64_t> ub_in_cycle_delay_;
+  // Nodes to revisit in the next propagation. The queues hold each pending
+  // position once, ordered so that lower bounds are propagated in topological
+  // order and upper bounds in reverse topological order.
+  std::vector<bool> lb_pending_;
+  std::vector<bool> ub_pending_;
+  std::priority_queue<int64_t, std::vector<int64_t>, std::greater<>>
+      lb_queue_;
+  std::priority_queue<int64_t> ub_queue_;
 
   int64_t max_lower_bound_;
   int64_t min_upper_bound_;
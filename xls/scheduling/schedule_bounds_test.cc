@@ -194,6 +194,53 @@ TEST_F(ScheduleBoundsTest, SimpleExpressionTightenBounds) {
   EXPECT_EQ(bounds.lb(result.node()), 23);
 }
 
+TEST_F(ScheduleBoundsTest, IncrementalPropagationMatchesFullPropagation) {
+  auto p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  auto x = fb.Param("x", p->GetBitsType(32));
+  auto y = fb.Param("y", p->GetBitsType(32));
+  auto a = fb.Add(x, y);
+  auto b = fb.Negate(a);
+  auto c = fb.Add(a, y);
+  auto d = fb.UMul(b, c);
+  auto e = fb.Subtract(d, x);
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  // Propagate, then tighten one node and propagate only its fan-out.
+  ScheduleBounds incremental(f, /*clock_period_ps=*/2, delay_estimator_);
+  XLS_ASSERT_OK(incremental.PropagateLowerBounds());
+  EXPECT_EQ(incremental.lb(d.node()), 1);
+  EXPECT_EQ(incremental.lb(e.node()), 1);
+  XLS_ASSERT_OK(incremental.TightenNodeLb(b.node(), 1));
+  XLS_ASSERT_OK(incremental.PropagateLowerBounds());
+
+  ScheduleBounds full(f, /*clock_period_ps=*/2, delay_estimator_);
+  XLS_ASSERT_OK(full.TightenNodeLb(b.node(), 1));
+  XLS_ASSERT_OK(full.PropagateLowerBounds());
+
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(incremental.lb(node), full.lb(node)) << node->GetName();
+  }
+  // `d` now starts partway through cycle 1, pushing `e` to cycle 2.
+  EXPECT_EQ(incremental.lb(a.node()), 0);
+  EXPECT_EQ(incremental.lb(c.node()), 0);
+  EXPECT_EQ(incremental.lb(d.node()), 1);
+  EXPECT_EQ(incremental.lb(e.node()), 2);
+  EXPECT_EQ(incremental.max_lower_bound(), 2);
+
+  // The same holds for upper bounds.
+  XLS_ASSERT_OK(incremental.TightenNodeUb(e.node(), 3));
+  XLS_ASSERT_OK(incremental.PropagateUpperBounds());
+  XLS_ASSERT_OK(incremental.TightenNodeUb(c.node(), 1));
+  XLS_ASSERT_OK(incremental.PropagateUpperBounds());
+  XLS_ASSERT_OK(full.TightenNodeUb(e.node(), 3));
+  XLS_ASSERT_OK(full.TightenNodeUb(c.node(), 1));
+  XLS_ASSERT_OK(full.PropagateUpperBounds());
+  for (Node* node : f->nodes()) {
+    EXPECT_EQ(incremental.ub(node), full.ub(node)) << node->GetName();
+  }
+}
+
 }  // namespace
 }  // namespace sched
 }  // namespace xls
@@ -65,6 +65,10 @@ absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   }
   scheduling_options.minimize_worst_case_throughput(
       proto.minimize_worst_case_throughput());
+  scheduling_options.modulo_resource_sharing(proto.modulo_resource_sharing());
+  if (!proto.area_model().empty()) {
+    scheduling_options.area_model(proto.area_model());
+  }
   if (proto.additional_input_delay_ps() != 0) {
     scheduling_options.additional_input_delay_ps(
         proto.additional_input_delay_ps());
@@ -231,8 +235,17 @@ absl::StatusOr<SchedulingOptions> OptionsFromFlagProto(
   scheduling_options.fdo_synthesis_libraries(proto.fdo_synthesis_libraries());
   scheduling_options.fdo_default_driver_cell(proto.fdo_default_driver_cell());
   scheduling_options.fdo_default_load(proto.fdo_default_load());
+  if (proto.fdo_synthesis_workers() > 0) {
+    scheduling_options.fdo_synthesis_workers(proto.fdo_synthesis_workers());
+  }
 
   scheduling_options.schedule_all_procs(proto.multi_proc());
+  if (proto.scheduling_threads() > 1) {
+    scheduling_options.scheduling_threads(proto.scheduling_threads());
+  }
+  if (proto.clock_search_threads() > 1) {
+    scheduling_options.clock_search_threads(proto.clock_search_threads());
+  }
 
   return scheduling_options;
 }
@@ -249,7 +249,10 @@ class SchedulingOptions {
         fdo_refinement_stochastic_ratio_(1.0),
         fdo_path_evaluate_strategy_(PathEvaluateStrategy::WINDOW),
         fdo_synthesizer_name_("yosys"),
-        schedule_all_procs_(false) {}
+        fdo_synthesis_workers_(0),
+        schedule_all_procs_(false),
+        scheduling_threads_(1),
+        clock_search_threads_(1) {}
 
   // Returns the scheduling strategy.
   SchedulingStrategy strategy() const { return strategy_; }
@@ -344,6 +347,24 @@ class SchedulingOptions {
     return worst_case_throughput_;
   }
 
+  // Sets/gets whether to schedule operations modulo the worst-case throughput
+  // (the initiation interval) so that operations which the area model deems
+  // expensive can share hardware instances across the cycles of the
+  // initiation interval. Only used by the SDC scheduler.
+  SchedulingOptions& modulo_resource_sharing(bool value) {
+    modulo_resource_sharing_ = value;
+    return *this;
+  }
+  bool modulo_resource_sharing() const { return modulo_resource_sharing_; }
+
+  // Sets/gets the area model used to pick the operations to share when
+  // `modulo_resource_sharing` is set.
+  SchedulingOptions& area_model(std::string_view value) {
+    area_model_ = value;
+    return *this;
+  }
+  std::optional<std::string> area_model() const { return area_model_; }
+
   // Sets/gets the additional delay added to each input.
   //
   // TODO(tedhong): 2022-02-11, Update so that this sets/gets the
@@ -528,12 +549,39 @@ class SchedulingOptions {
   }
   std::string fdo_default_load() const { return fdo_default_load_; }
 
+  // The maximum number of synthesis jobs FDO runs concurrently. Values of 0 or
+  // less run every job of an iteration at once.
+  SchedulingOptions& fdo_synthesis_workers(int64_t value) {
+    fdo_synthesis_workers_ = value;
+    return *this;
+  }
+  int64_t fdo_synthesis_workers() const { return fdo_synthesis_workers_; }
+
   SchedulingOptions& schedule_all_procs(bool value) {
     schedule_all_procs_ = value;
     return *this;
   }
   bool schedule_all_procs() const { return schedule_all_procs_; }
 
+  // The number of threads to use to schedule independent functions and procs
+  // concurrently, and for independent work within the scheduling of each one
+  // (e.g., the trials of the min-cut scheduler). Values of 1 or less do
+  // everything one at a time.
+  SchedulingOptions& scheduling_threads(int64_t value) {
+    scheduling_threads_ = value;
+    return *this;
+  }
+  int64_t scheduling_threads() const { return scheduling_threads_; }
+
+  // The number of candidate clock periods to check in parallel when searching
+  // for the minimum feasible clock period (e.g., if no clock period is given).
+  // Values of 1 or less use a serial binary search.
+  SchedulingOptions& clock_search_threads(int64_t value) {
+    clock_search_threads_ = value;
+    return *this;
+  }
+  int64_t clock_search_threads() const { return clock_search_threads_; }
+
  private:
   SchedulingStrategy strategy_;
   int64_t opt_level_;
@@ -546,6 +594,8 @@ class SchedulingOptions {
   bool recover_after_minimizing_clock_;
   bool minimize_worst_case_throughput_;
   std::optional<int64_t> worst_case_throughput_;
+  bool modulo_resource_sharing_ = false;
+  std::optional<std::string> area_model_;
   std::optional<int64_t> additional_input_delay_ps_;
   std::optional<int64_t> additional_output_delay_ps_;
   std::optional<int64_t> ffi_fallback_delay_ps_;
@@ -566,7 +616,10 @@ class SchedulingOptions {
   std::string fdo_synthesis_libraries_;
   std::string fdo_default_driver_cell_;
   std::string fdo_default_load_;
+  int64_t fdo_synthesis_workers_;
   bool schedule_all_procs_;
+  int64_t scheduling_threads_;
+  int64_t clock_search_threads_;
 };
 
 // A map from node to cycle as a bare-bones representation of a schedule.
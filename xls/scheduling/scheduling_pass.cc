@@ -22,13 +22,12 @@
 #include "absl/algorithm/container.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
-#include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
 #include "absl/strings/str_split.h"
 #include "xls/common/logging/log_lines.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/package.h"
 #include "xls/scheduling/pipeline_schedule.h"
 
@@ -42,16 +41,21 @@ namespace xls {
 }
 
 std::string SchedulingUnit::DumpIr() const {
+  StringIrSink sink;
+  DumpIrTo(sink);
+  return sink.Release();
+}
+
+void SchedulingUnit::DumpIrTo(IrSink& sink) const {
   // Dump the IR followed by the schedule. The schedule is commented out
   // ('//') so the output is parsable.
-  std::string out = ir_->DumpIr();
+  ir_->DumpIrTo(sink);
 
   absl::StatusOr<std::vector<FunctionBase*>> schedulable_functions =
       GetSchedulableFunctions();
   if (!schedulable_functions.ok()) {
-    absl::StrAppend(&out, "\n\n// ", schedulable_functions.status().message(),
-                    "\n");
-    return out;
+    sink.Append("\n\n// ", schedulable_functions.status().message(), "\n");
+    return;
   }
   for (FunctionBase* scheduled_function : *schedulable_functions) {
     auto itr = schedules_.find(scheduled_function);
@@ -59,12 +63,11 @@ std::string SchedulingUnit::DumpIr() const {
       continue;
     }
     const PipelineSchedule& schedule = itr->second;
-    absl::StrAppend(&out, "\n\n// Pipeline Schedule\n");
+    sink.Append("\n\n// Pipeline Schedule\n");
     for (auto line : absl::StrSplit(schedule.ToString(), '\n')) {
-      absl::StrAppend(&out, "// ", line, "\n");
+      sink.Append("// ", line, "\n");
     }
   }
-  return out;
 }
 
 absl::StatusOr<std::vector<FunctionBase*>>
@@ -25,6 +25,7 @@
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/fdo/synthesizer.h"
 #include "xls/ir/function_base.h"
+#include "xls/ir/ir_sink.h"
 #include "xls/ir/package.h"
 #include "xls/passes/pass_base.h"
 #include "xls/scheduling/pipeline_schedule.h"
@@ -53,6 +54,7 @@ class SchedulingUnit {
   // Dumps the IR for schedulable FunctionBases along with their schedules. The
   // schedules are guarded by "//" comments.
   std::string DumpIr() const;
+  void DumpIrTo(IrSink& sink) const;
   std::string name() const { return ir_->name(); }
   int64_t GetNodeCount() const { return ir_->GetNodeCount(); }
 
@@ -24,6 +24,7 @@
 #include <variant>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
@@ -46,6 +47,7 @@
 #include "xls/ir/proc.h"
 #include "xls/ir/state_element.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/scheduling/modulo_resources.h"
 #include "xls/scheduling/schedule_util.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "ortools/math_opt/cpp/math_opt.h"
@@ -63,14 +65,20 @@ absl::StatusOr<DelayMap> ComputeNodeDelays(
     FunctionBase* f, const absl::flat_hash_set<Node*>& dead_after_synthesis,
     const DelayEstimator& delay_estimator) {
   DelayMap result;
+  result.reserve(f->node_count());
+  std::vector<Node*> live_nodes;
   for (Node* node : f->nodes()) {
     if (dead_after_synthesis.contains(node)) {
       result[node] = 0;
     } else {
-      XLS_ASSIGN_OR_RETURN(result[node],
-                           delay_estimator.GetOperationDelayInPs(node));
+      live_nodes.push_back(node);
     }
   }
+  XLS_ASSIGN_OR_RETURN(std::vector<int64_t> delays,
+                       delay_estimator.GetOperationDelaysInPs(live_nodes));
+  for (int64_t i = 0; i < live_nodes.size(); ++i) {
+    result[live_nodes[i]] = delays[i];
+  }
   return result;
 }
 
@@ -189,6 +197,32 @@ ComputeCombinationalDelayConstraints(
   return result;
 }
 
+// Returns the operations of the first resource class with more operations in
+// a single cycle modulo `initiation_interval` than it has instances, latest
+// first; returns an empty vector if there is no such class.
+std::vector<Node*> FindModuloConflict(
+    absl::Span<const ModuloResourceClass> classes,
+    const ScheduleCycleMap& cycle_map, int64_t initiation_interval) {
+  for (const ModuloResourceClass& resource_class : classes) {
+    std::vector<std::vector<Node*>> slots(initiation_interval);
+    for (Node* node : resource_class.nodes) {
+      slots[cycle_map.at(node) % initiation_interval].push_back(node);
+    }
+    for (std::vector<Node*>& slot : slots) {
+      if (static_cast<int64_t>(slot.size()) <= resource_class.limit) {
+        continue;
+      }
+      absl::c_sort(slot, [&](Node* a, Node* b) {
+        int64_t a_cycle = cycle_map.at(a);
+        int64_t b_cycle = cycle_map.at(b);
+        return a_cycle != b_cycle ? a_cycle > b_cycle : a->id() > b->id();
+      });
+      return slot;
+    }
+  }
+  return {};
+}
+
 }  // namespace
 
 SDCSchedulingModel::SDCSchedulingModel(
@@ -538,6 +572,31 @@ absl::StatusOr<ScheduleCycleMap> SDCSchedulingModel::ExtractResult(
   return cycle_map;
 }
 
+bool SDCSchedulingModel::IsSatisfiedBy(
+    const math_opt::VariableMap<double>& variable_values) const {
+  static constexpr double kTolerance = 1e-6;
+  for (const math_opt::Variable& var : model_.Variables()) {
+    auto it = variable_values.find(var);
+    if (it == variable_values.end()) {
+      return false;
+    }
+    if (it->second < var.lower_bound() - kTolerance ||
+        it->second > var.upper_bound() + kTolerance) {
+      return false;
+    }
+  }
+  for (const math_opt::LinearConstraint& constraint :
+       model_.LinearConstraints()) {
+    double value = constraint.AsBoundedLinearExpression().expression.Evaluate(
+        variable_values);
+    if (value < constraint.lower_bound() - kTolerance ||
+        value > constraint.upper_bound() + kTolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
 void SDCSchedulingModel::SetClockPeriod(int64_t clock_period_ps) {
   absl::flat_hash_map<Node*, std::vector<Node*>> prev_delay_constraints =
       std::move(delay_constraints_);
@@ -837,6 +896,13 @@ math_opt::LinearConstraint SDCSchedulingModel::DiffGreaterThanConstraint(
       absl::StrFormat("%s:%s-%s≥%d", name, x->GetName(), y->GetName(), limit));
 }
 
+math_opt::LinearConstraint SDCSchedulingModel::CycleAtLeastConstraint(
+    Node* x, int64_t cycle, std::string_view name) {
+  return model_.AddLinearConstraint(
+      cycle_var_.at(x) >= static_cast<double>(cycle),
+      absl::StrFormat("%s:%s≥%d", name, x->GetName(), cycle));
+}
+
 math_opt::LinearConstraint SDCSchedulingModel::DiffEqualsConstraint(
     Node* x, Node* y, int64_t diff, std::string_view name) {
   if (x == y) {
@@ -1021,6 +1087,7 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
   }
 
   model_.SetPipelineLength(pipeline_stages);
+  std::optional<int64_t> pipeline_length = pipeline_stages;
   if (!pipeline_stages.has_value() && !check_feasibility) {
     // Find the minimum feasible pipeline length.
     model_.MinimizePipelineLength();
@@ -1037,10 +1104,16 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
         model_.ExtractPipelineLength(
             result_with_minimized_pipeline_length.variable_values()));
     model_.SetPipelineLength(min_pipeline_length);
+    pipeline_length = min_pipeline_length;
   }
 
   if (check_feasibility) {
     model_.RemoveObjective();
+    if (last_solution_.has_value() && model_.IsSatisfiedBy(*last_solution_)) {
+      VLOG(3) << "Previous solution is still feasible at clock period "
+              << clock_period_ps << "ps; skipping solve.";
+      return model_.ExtractResult(*last_solution_);
+    }
   } else {
     model_.SetObjective();
   }
@@ -1049,9 +1122,105 @@ absl::StatusOr<ScheduleCycleMap> SDCScheduler::Schedule(
   if (result.termination.reason == math_opt::TerminationReason::kOptimal ||
       (check_feasibility &&
        result.termination.reason == math_opt::TerminationReason::kFeasible)) {
-    return model_.ExtractResult(result.variable_values());
+    last_solution_ = result.variable_values();
+    XLS_ASSIGN_OR_RETURN(ScheduleCycleMap cycle_map,
+                         model_.ExtractResult(*last_solution_));
+    const int64_t initiation_interval = f_->GetInitiationInterval().value_or(1);
+    if (!check_feasibility && !modulo_resource_classes_.empty() &&
+        initiation_interval > 1) {
+      XLS_RET_CHECK(pipeline_length.has_value());
+      return ResolveModuloConflicts(std::move(cycle_map), initiation_interval,
+                                    *pipeline_length,
+                                    /*fixed_pipeline_length=*/
+                                    pipeline_stages.has_value());
+    }
+    return cycle_map;
   }
   return BuildError(result, failure_behavior);
 }
 
+absl::StatusOr<ScheduleCycleMap> SDCScheduler::ResolveModuloConflicts(
+    ScheduleCycleMap cycle_map, int64_t initiation_interval,
+    int64_t pipeline_length, bool fixed_pipeline_length) {
+  // A simplified form of SDC-based modulo scheduling (Zhang & Liu, ICCAD
+  // 2013): while some cycle modulo the initiation interval holds more
+  // operations of a resource class than the class has instances, one of them
+  // is constrained to a later cycle and the schedule is re-solved. Unless the
+  // pipeline length was given, it may grow by up to one initiation interval.
+  const ScheduleCycleMap unshared_cycle_map = cycle_map;
+  const math_opt::VariableMap<double> unshared_solution = *last_solution_;
+  const int64_t max_length =
+      fixed_pipeline_length ? pipeline_length
+                            : pipeline_length + initiation_interval;
+  int64_t length = pipeline_length;
+  int64_t max_iterations = 0;
+  for (const ModuloResourceClass& resource_class : modulo_resource_classes_) {
+    max_iterations += resource_class.nodes.size() * max_length;
+  }
+
+  // Solves the model, lengthening the pipeline as needed and allowed. Returns
+  // whether a schedule was found.
+  auto solve = [&]() -> absl::StatusOr<bool> {
+    while (true) {
+      XLS_ASSIGN_OR_RETURN(math_opt::SolveResult result, solver_->Solve());
+      if (result.termination.reason == math_opt::TerminationReason::kOptimal) {
+        last_solution_ = result.variable_values();
+        return true;
+      }
+      if (length >= max_length) {
+        return false;
+      }
+      model_.SetPipelineLength(++length);
+    }
+  };
+
+  std::vector<math_opt::LinearConstraint> added;
+  bool resolved = false;
+  for (int64_t iteration = 0; iteration < max_iterations; ++iteration) {
+    std::vector<Node*> conflict = FindModuloConflict(
+        modulo_resource_classes_, cycle_map, initiation_interval);
+    if (conflict.empty()) {
+      resolved = true;
+      break;
+    }
+    // Try delaying the latest operation first, as that disturbs the fewest
+    // others.
+    bool delayed = false;
+    for (Node* node : conflict) {
+      math_opt::LinearConstraint constraint = model_.CycleAtLeastConstraint(
+          node, cycle_map.at(node) + 1, "modulo_resource");
+      const int64_t length_before = length;
+      XLS_ASSIGN_OR_RETURN(delayed, solve());
+      if (delayed) {
+        added.push_back(constraint);
+        break;
+      }
+      model_.UnderlyingModel().DeleteLinearConstraint(constraint);
+      length = length_before;
+      model_.SetPipelineLength(length);
+    }
+    if (!delayed) {
+      break;
+    }
+    XLS_ASSIGN_OR_RETURN(cycle_map, model_.ExtractResult(*last_solution_));
+  }
+
+  // Leave the model as it was so later calls are unaffected.
+  for (const math_opt::LinearConstraint& constraint : added) {
+    model_.UnderlyingModel().DeleteLinearConstraint(constraint);
+  }
+  model_.SetPipelineLength(pipeline_length);
+  if (resolved) {
+    VLOG(2) << "Resolved modulo resource conflicts of " << f_->name()
+            << " with " << added.size() << " constraints; pipeline length "
+            << pipeline_length << " -> " << length;
+    return cycle_map;
+  }
+  LOG(WARNING) << "Unable to share resources of " << f_->name()
+               << " across its initiation interval of " << initiation_interval
+               << "; scheduling without resource sharing.";
+  last_solution_ = unshared_solution;
+  return unshared_cycle_map;
+}
+
 }  // namespace xls
@@ -31,6 +31,7 @@
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
+#include "xls/scheduling/modulo_resources.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "ortools/math_opt/cpp/math_opt.h"
 
@@ -96,6 +97,13 @@ class SDCSchedulingModel {
       const operations_research::math_opt::VariableMap<double>& variable_values)
       const;
 
+  // Returns true if `variable_values` assigns every variable of the current
+  // model and satisfies all of its variable bounds and linear constraints
+  // (within a small tolerance).
+  bool IsSatisfiedBy(
+      const operations_research::math_opt::VariableMap<double>& variable_values)
+      const;
+
   absl::flat_hash_map<Node*, operations_research::math_opt::Variable>
   GetCycleVars() const {
     return cycle_var_;
@@ -121,6 +129,9 @@ class SDCSchedulingModel {
   operations_research::math_opt::LinearConstraint DiffEqualsConstraint(
       Node* x, Node* y, int64_t diff, std::string_view name);
 
+  operations_research::math_opt::LinearConstraint CycleAtLeastConstraint(
+      Node* x, int64_t cycle, std::string_view name);
+
  private:
   operations_research::math_opt::Variable AddUpperBoundSlack(
       operations_research::math_opt::LinearConstraint c,
@@ -222,6 +233,14 @@ class SDCScheduler {
   absl::Status AddConstraints(
       absl::Span<const SchedulingConstraint> constraints);
 
+  // Sets the resource classes whose operations must not exceed their limit in
+  // any cycle modulo the initiation interval in the schedules returned by
+  // Schedule() (other than feasibility checks). If no such schedule can be
+  // found, the schedule without resource sharing is returned.
+  void SetModuloResourceClasses(std::vector<ModuloResourceClass> classes) {
+    modulo_resource_classes_ = std::move(classes);
+  }
+
   // Schedule to minimize the total pipeline registers using SDC scheduling
   // the constraint matrix is totally unimodular, this ILP problem can be solved
   // by LP.
@@ -236,7 +255,12 @@ class SDCScheduler {
   //
   // With `check_feasibility = true`, the objective function will be constant,
   // and the LP solver will merely attempt to show that the generated set of
-  // constraints is feasible, rather than find an register-optimal schedule.
+  // constraints is feasible, rather than find an register-optimal schedule. In
+  // that case, if the solution of the previous successful call still satisfies
+  // the updated constraints (e.g., after loosening the clock period or
+  // throughput), it is returned without invoking the solver. This makes
+  // repeated feasibility checks, as in a binary search over the clock period,
+  // cheap whenever the previous schedule was not tight.
   //
   // References:
   //   - Cong, Jason, and Zhiru Zhang. "An efficient and versatile scheduling
@@ -260,11 +284,24 @@ class SDCScheduler {
       const operations_research::math_opt::SolveResult& result,
       SchedulingFailureBehavior failure_behavior);
 
+  // Adjusts `cycle_map`, the solution of the current model, until it respects
+  // `modulo_resource_classes_`.
+  absl::StatusOr<ScheduleCycleMap> ResolveModuloConflicts(
+      ScheduleCycleMap cycle_map, int64_t initiation_interval,
+      int64_t pipeline_length, bool fixed_pipeline_length);
+
   FunctionBase* f_;
   DelayMap delay_map_;
 
   SDCSchedulingModel model_;
   std::unique_ptr<operations_research::math_opt::IncrementalSolver> solver_;
+
+  // The variable values of the last successful solve, used to warm start
+  // feasibility checks.
+  std::optional<operations_research::math_opt::VariableMap<double>>
+      last_solution_;
+
+  std::vector<ModuloResourceClass> modulo_resource_classes_;
 };
 
 }  // namespace xls
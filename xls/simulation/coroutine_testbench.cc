@@ -0,0 +1,359 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/coroutine_testbench.h"
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
+#include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/simulation/testbench_metadata.h"
+
+namespace xls {
+namespace verilog {
+
+std::coroutine_handle<>
+TestbenchTask::promise_type::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+  promise_type& promise = handle.promise();
+  if (promise.continuation) {
+    promise.thread->current_ = promise.continuation;
+    return promise.continuation;
+  }
+  promise.thread->current_ = nullptr;
+  return std::noop_coroutine();
+}
+
+void TestbenchTask::promise_type::unhandled_exception() {
+  LOG(FATAL) << "Exception thrown by testbench thread "
+             << (thread == nullptr ? "<unknown>" : thread->name());
+}
+
+std::coroutine_handle<> TestbenchTask::await_suspend(Handle awaiting) {
+  CoroutineTestbenchThread* thread = awaiting.promise().thread;
+  handle_.promise().thread = thread;
+  handle_.promise().continuation = awaiting;
+  thread->current_ = handle_;
+  return handle_;
+}
+
+CoroutineTestbenchThread::CoroutineTestbenchThread(
+    std::string_view name, CoroutineTestbench* testbench,
+    absl::Span<const std::string> driven_ports,
+    std::function<TestbenchTask(CoroutineTestbenchThread&)> body)
+    : name_(name),
+      testbench_(testbench),
+      driven_ports_(driven_ports.begin(), driven_ports.end()),
+      body_(std::move(body)) {}
+
+CoroutineTestbenchThread& CoroutineTestbenchThread::Set(
+    std::string_view port_name, const Value& value) {
+  if (!driven_ports_.contains(port_name)) {
+    Fail(absl::InvalidArgumentError(
+        absl::StrFormat("Cannot drive port `%s`; it is not one of the ports "
+                        "driven by the thread",
+                        port_name)));
+    return *this;
+  }
+  Type* type = testbench_->input_types_.at(port_name);
+  if (!ValueConformsToType(value, type)) {
+    Fail(absl::InvalidArgumentError(
+        absl::StrFormat("Value %s does not match type %s of port `%s`",
+                        value.ToString(), type->ToString(), port_name)));
+    return *this;
+  }
+  testbench_->inputs_[port_name] = value;
+  return *this;
+}
+
+CoroutineTestbenchThread& CoroutineTestbenchThread::Set(
+    std::string_view port_name, const Bits& value) {
+  return Set(port_name, Value(value));
+}
+
+CoroutineTestbenchThread& CoroutineTestbenchThread::Set(
+    std::string_view port_name, uint64_t value) {
+  auto it = testbench_->input_types_.find(port_name);
+  if (it == testbench_->input_types_.end() || !it->second->IsBits()) {
+    Fail(absl::InvalidArgumentError(
+        absl::StrFormat("`%s` is not a bits-typed input port", port_name)));
+    return *this;
+  }
+  absl::StatusOr<Bits> bits =
+      UBitsWithStatus(value, it->second->GetFlatBitCount());
+  if (!bits.ok()) {
+    Fail(bits.status());
+    return *this;
+  }
+  return Set(port_name, *bits);
+}
+
+Value CoroutineTestbenchThread::Get(std::string_view port_name) {
+  if (testbench_->outputs_ == nullptr) {
+    Fail(absl::FailedPreconditionError(absl::StrFormat(
+        "Cannot get port `%s` before the first cycle is evaluated",
+        port_name)));
+    return Value();
+  }
+  auto it = testbench_->outputs_->find(port_name);
+  if (it == testbench_->outputs_->end()) {
+    Fail(absl::InvalidArgumentError(
+        absl::StrFormat("`%s` is not an output port", port_name)));
+    return Value();
+  }
+  return it->second;
+}
+
+CoroutineTestbenchThread::Awaiter CoroutineTestbenchThread::NextCycle() {
+  return AdvanceNCycles(1);
+}
+
+CoroutineTestbenchThread::Awaiter CoroutineTestbenchThread::AdvanceNCycles(
+    int64_t n_cycles) {
+  if (n_cycles < 0) {
+    Fail(absl::InvalidArgumentError(
+        absl::StrFormat("Cannot advance %d cycles", n_cycles)));
+    n_cycles = 0;
+  }
+  return WaitUntil(Wait{.at_end_of_cycle = false,
+                        .cycle = testbench_->cycle_ + n_cycles});
+}
+
+CoroutineTestbenchThread::Awaiter CoroutineTestbenchThread::AtEndOfCycle() {
+  return WaitUntil(
+      Wait{.at_end_of_cycle = true, .cycle = NextEvaluatedCycle()});
+}
+
+CoroutineTestbenchThread::Awaiter CoroutineTestbenchThread::AtEndOfCycleWhen(
+    std::string_view port_name) {
+  return WaitUntil(Wait{.at_end_of_cycle = true,
+                        .cycle = NextEvaluatedCycle(),
+                        .port_name = std::string(port_name)});
+}
+
+CoroutineTestbenchThread::Awaiter CoroutineTestbenchThread::WaitForCycleAfter(
+    std::string_view port_name) {
+  return WaitUntil(Wait{.at_end_of_cycle = true,
+                        .cycle = NextEvaluatedCycle(),
+                        .port_name = std::string(port_name),
+                        .resume_next_cycle = true});
+}
+
+CoroutineTestbenchThread::Awaiter
+CoroutineTestbenchThread::WaitForCycleAfterNot(std::string_view port_name) {
+  return WaitUntil(Wait{.at_end_of_cycle = true,
+                        .cycle = NextEvaluatedCycle(),
+                        .port_name = std::string(port_name),
+                        .value = false,
+                        .resume_next_cycle = true});
+}
+
+void CoroutineTestbenchThread::Fail(absl::Status status) {
+  if (status_.ok()) {
+    status_ = std::move(status);
+  }
+}
+
+int64_t CoroutineTestbenchThread::cycle() const { return testbench_->cycle_; }
+
+int64_t CoroutineTestbenchThread::NextEvaluatedCycle() const {
+  return testbench_->at_end_of_cycle_ ? testbench_->cycle_ + 1
+                                      : testbench_->cycle_;
+}
+
+CoroutineTestbenchThread::Awaiter CoroutineTestbenchThread::WaitUntil(
+    Wait wait) {
+  if (wait.port_name.has_value()) {
+    auto it = testbench_->output_types_.find(*wait.port_name);
+    if (it == testbench_->output_types_.end() ||
+        it->second->GetFlatBitCount() != 1 || !it->second->IsBits()) {
+      Fail(absl::InvalidArgumentError(absl::StrFormat(
+          "`%s` is not a single-bit output port", *wait.port_name)));
+    }
+  }
+  wait_ = std::move(wait);
+  return Awaiter{};
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<CoroutineTestbench>>
+CoroutineTestbench::Create(Block* block, const BlockEvaluator& evaluator,
+                           const std::optional<ResetProto>& reset) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
+                       evaluator.NewContinuation(block));
+  auto testbench = absl::WrapUnique(
+      new CoroutineTestbench(block, reset, std::move(continuation)));
+  for (InputPort* port : block->GetInputPorts()) {
+    testbench->input_types_[port->name()] = port->GetType();
+    testbench->inputs_[port->name()] = ZeroOfType(port->GetType());
+  }
+  for (OutputPort* port : block->GetOutputPorts()) {
+    testbench->output_types_[port->name()] = port->output_type();
+  }
+  if (reset.has_value() && !testbench->input_types_.contains(reset->name())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Block `%s` has no reset port `%s`", block->name(), reset->name()));
+  }
+  return testbench;
+}
+
+CoroutineTestbench::CoroutineTestbench(
+    Block* block, std::optional<ResetProto> reset,
+    std::unique_ptr<BlockContinuation> continuation)
+    : block_(block),
+      reset_(std::move(reset)),
+      continuation_(std::move(continuation)) {}
+
+absl::StatusOr<CoroutineTestbenchThread*> CoroutineTestbench::AddThread(
+    std::string_view name, absl::Span<const std::string> driven_ports,
+    std::function<TestbenchTask(CoroutineTestbenchThread&)> body) {
+  for (const std::string& port : driven_ports) {
+    if (!input_types_.contains(port)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Block `%s` has no input port `%s`", block_->name(), port));
+    }
+    if (reset_.has_value() && port == reset_->name()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Reset port `%s` is driven by the testbench", port));
+    }
+    auto [it, inserted] = port_drivers_.insert({port, nullptr});
+    if (!inserted) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("Port `%s` is already driven by thread %s", port,
+                          it->second->name()));
+    }
+  }
+
+  threads_.push_back(absl::WrapUnique(
+      new CoroutineTestbenchThread(name, this, driven_ports, std::move(body))));
+  CoroutineTestbenchThread* thread = threads_.back().get();
+  for (const std::string& port : driven_ports) {
+    port_drivers_[port] = thread;
+  }
+  thread->task_.emplace(thread->body_(*thread));
+  thread->task_->handle_.promise().thread = thread;
+  thread->current_ = thread->task_->handle_;
+  thread->wait_ = CoroutineTestbenchThread::Wait{
+      .at_end_of_cycle = false, .cycle = reset_.has_value() ? kResetCycles : 0};
+  return thread;
+}
+
+bool CoroutineTestbench::IsReady(const CoroutineTestbenchThread& thread) const {
+  const CoroutineTestbenchThread::Wait& wait = thread.wait_;
+  if (thread.current_ == nullptr || !thread.status_.ok() ||
+      wait.at_end_of_cycle != at_end_of_cycle_ || wait.cycle > cycle_) {
+    return false;
+  }
+  if (!wait.port_name.has_value()) {
+    return true;
+  }
+  const Value& value = outputs_->at(*wait.port_name);
+  return value.bits().Get(0) == wait.value;
+}
+
+void CoroutineTestbench::RunReadyThreads() {
+  bool progress = true;
+  while (progress) {
+    progress = false;
+    for (std::unique_ptr<CoroutineTestbenchThread>& thread : threads_) {
+      if (!IsReady(*thread)) {
+        continue;
+      }
+      progress = true;
+      if (thread->wait_.resume_next_cycle) {
+        thread->wait_ = CoroutineTestbenchThread::Wait{
+            .at_end_of_cycle = false, .cycle = cycle_ + 1};
+        continue;
+      }
+      thread->current_.resume();
+    }
+  }
+}
+
+absl::Status CoroutineTestbench::CheckThreadStatus() const {
+  for (const std::unique_ptr<CoroutineTestbenchThread>& thread : threads_) {
+    if (!thread->status_.ok()) {
+      return absl::Status(
+          thread->status_.code(),
+          absl::StrFormat("Thread %s failed in cycle %d: %s", thread->name(),
+                          cycle_, thread->status_.message()));
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CoroutineTestbench::Run(int64_t cycle_limit) {
+  const int64_t reset_cycles = reset_.has_value() ? kResetCycles : 0;
+  for (;; ++cycle_) {
+    at_end_of_cycle_ = false;
+    RunReadyThreads();
+    XLS_RETURN_IF_ERROR(CheckThreadStatus());
+
+    std::vector<std::string_view> running;
+    for (const std::unique_ptr<CoroutineTestbenchThread>& thread : threads_) {
+      if (thread->current_ != nullptr) {
+        running.push_back(thread->name());
+      }
+    }
+    if (running.empty()) {
+      return absl::OkStatus();
+    }
+    if (cycle_ >= cycle_limit + reset_cycles) {
+      return absl::DeadlineExceededError(
+          absl::StrFormat("Threads did not finish within %d cycles: %s",
+                          cycle_limit, absl::StrJoin(running, ", ")));
+    }
+
+    if (reset_.has_value()) {
+      bool asserted = cycle_ < reset_cycles;
+      inputs_[reset_->name()] =
+          Value(UBits(asserted != reset_->active_low() ? 1 : 0, 1));
+    }
+    XLS_RETURN_IF_ERROR(continuation_->RunOneCycle(inputs_));
+    if (!continuation_->events().assert_msgs.empty()) {
+      return absl::AbortedError(absl::StrFormat(
+          "Assertion failed in cycle %d: %s", cycle_,
+          absl::StrJoin(continuation_->events().assert_msgs, "; ")));
+    }
+    outputs_ = &continuation_->output_ports();
+
+    at_end_of_cycle_ = true;
+    RunReadyThreads();
+    XLS_RETURN_IF_ERROR(CheckThreadStatus());
+  }
+}
+
+}  // namespace verilog
+}  // namespace xls
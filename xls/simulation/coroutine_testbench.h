@@ -0,0 +1,283 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SIMULATION_COROUTINE_TESTBENCH_H_
+#define XLS_SIMULATION_COROUTINE_TESTBENCH_H_
+
+#include <coroutine>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/interpreter/block_evaluator.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/value.h"
+
+// A testbench which drives an XLS block directly with a BlockEvaluator
+// (typically the BlockJit) rather than through a generated Verilog testbench.
+//
+// Each testbench thread is a C++20 coroutine which drives a set of input ports
+// and suspends until a clock edge or a condition on the outputs, e.g.:
+//
+//   tb->AddThread("producer", {"in_vld", "in_data"},
+//                 [](CoroutineTestbenchThread& t) -> TestbenchTask {
+//                   for (int64_t i = 0; i < 10; ++i) {
+//                     t.Set("in_vld", 1).Set("in_data", i);
+//                     co_await t.WaitForCycleAfter("in_rdy");
+//                   }
+//                   t.Set("in_vld", 0);
+//                 });
+//   XLS_RETURN_IF_ERROR(tb->Run());
+//
+// All threads are run by a single scheduler cycle by cycle, so hundreds of
+// concurrent threads cost no more than the cycles they simulate.
+//
+// Within a cycle, threads first run at the start of the cycle (where they set
+// input ports), then the block is evaluated for the cycle, then threads which
+// wait for the end of the cycle run and may sample the output ports. Inputs
+// set at the end of a cycle take effect in the next cycle. Set values are
+// sticky; ports which are never set are driven with zero.
+
+namespace xls {
+namespace verilog {
+
+class CoroutineTestbench;
+class CoroutineTestbenchThread;
+
+// The return type of a testbench thread coroutine. A TestbenchTask may also be
+// co_awaited from another task of the same thread to run it as a subroutine.
+class TestbenchTask {
+ public:
+  struct promise_type {
+    TestbenchTask get_return_object() {
+      return TestbenchTask(
+          std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    // Returns control to the awaiting task, if any.
+    struct FinalAwaiter {
+      bool await_ready() noexcept { return false; }
+      std::coroutine_handle<> await_suspend(
+          std::coroutine_handle<promise_type> handle) noexcept;
+      void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception();
+
+    CoroutineTestbenchThread* thread = nullptr;
+    std::coroutine_handle<> continuation;
+  };
+  using Handle = std::coroutine_handle<promise_type>;
+
+  TestbenchTask(TestbenchTask&& other)
+      : handle_(std::exchange(other.handle_, nullptr)) {}
+  TestbenchTask& operator=(TestbenchTask&& other) {
+    std::swap(handle_, other.handle_);
+    return *this;
+  }
+  TestbenchTask(const TestbenchTask&) = delete;
+  TestbenchTask& operator=(const TestbenchTask&) = delete;
+  ~TestbenchTask() {
+    if (handle_) {
+      handle_.destroy();
+    }
+  }
+
+  // Awaiting a task runs it to completion (across cycles) before the awaiting
+  // task continues.
+  bool await_ready() const { return false; }
+  std::coroutine_handle<> await_suspend(Handle awaiting);
+  void await_resume() const {}
+
+ private:
+  friend class CoroutineTestbench;
+
+  explicit TestbenchTask(Handle handle) : handle_(handle) {}
+
+  Handle handle_;
+};
+
+// A single testbench thread. Passed to the thread's coroutine to drive inputs,
+// sample outputs and wait for clock edges.
+class CoroutineTestbenchThread {
+ public:
+  // Suspends the thread. Returned by the waiting methods below.
+  struct [[nodiscard]] Awaiter {
+    bool await_ready() const { return false; }
+    void await_suspend(std::coroutine_handle<>) const {}
+    void await_resume() const {}
+  };
+
+  // Sets the given input port to the given value. The value is driven from the
+  // current cycle (or, at the end of a cycle, the next cycle) on until the
+  // port is set again.
+  CoroutineTestbenchThread& Set(std::string_view port_name,
+                                const Value& value);
+  CoroutineTestbenchThread& Set(std::string_view port_name, const Bits& value);
+  CoroutineTestbenchThread& Set(std::string_view port_name, uint64_t value);
+
+  // Returns the value of the given output port at the end of the last
+  // evaluated cycle.
+  Value Get(std::string_view port_name);
+
+  // Resumes the thread at the start of the next cycle.
+  Awaiter NextCycle();
+
+  // Resumes the thread at the start of the cycle `n_cycles` from now.
+  Awaiter AdvanceNCycles(int64_t n_cycles);
+
+  // Resumes the thread at the end of the current cycle (or, at the end of a
+  // cycle, of the next cycle), after the block is evaluated but before the
+  // next cycle's inputs are set.
+  Awaiter AtEndOfCycle();
+
+  // Resumes the thread at the end of the first cycle in which the given
+  // single-bit output is asserted.
+  Awaiter AtEndOfCycleWhen(std::string_view port_name);
+
+  // Resumes the thread at the start of the cycle *after* the first cycle in
+  // which the given single-bit output is asserted (not asserted).
+  Awaiter WaitForCycleAfter(std::string_view port_name);
+  Awaiter WaitForCycleAfterNot(std::string_view port_name);
+
+  // Records an error which fails CoroutineTestbench::Run(). Only the first
+  // error of a thread is kept.
+  void Fail(absl::Status status);
+
+  // The cycle the thread is executing in.
+  int64_t cycle() const;
+
+  std::string_view name() const { return name_; }
+
+ private:
+  friend class CoroutineTestbench;
+  friend struct TestbenchTask::promise_type::FinalAwaiter;
+  friend class TestbenchTask;
+
+  // What the thread is suspended on.
+  struct Wait {
+    // Whether the thread resumes at the start or the end of `cycle`.
+    bool at_end_of_cycle;
+    int64_t cycle;
+    // If present, the thread only resumes at the end of a cycle in which the
+    // given output port equals `value`...
+    std::optional<std::string> port_name;
+    bool value = true;
+    // ... and, if `resume_next_cycle`, at the start of the following cycle.
+    bool resume_next_cycle = false;
+  };
+
+  CoroutineTestbenchThread(
+      std::string_view name, CoroutineTestbench* testbench,
+      absl::Span<const std::string> driven_ports,
+      std::function<TestbenchTask(CoroutineTestbenchThread&)> body);
+
+  // The cycle in which a condition may first be checked, or a port set by
+  // the thread now first takes effect.
+  int64_t NextEvaluatedCycle() const;
+
+  Awaiter WaitUntil(Wait wait);
+
+  std::string name_;
+  CoroutineTestbench* testbench_;
+  absl::flat_hash_set<std::string> driven_ports_;
+
+  // The coroutine body is kept alive for the lifetime of the coroutine (it
+  // may own captures referenced by the coroutine frame).
+  std::function<TestbenchTask(CoroutineTestbenchThread&)> body_;
+  std::optional<TestbenchTask> task_;
+  // The innermost running task of the thread, which is resumed.
+  std::coroutine_handle<> current_;
+
+  Wait wait_;
+  absl::Status status_;
+};
+
+// Drives a block with concurrent coroutine testbench threads.
+class CoroutineTestbench {
+ public:
+  // Creates a testbench for `block`, evaluated with `evaluator`. If `reset` is
+  // given then the testbench asserts the reset port for kResetCycles cycles
+  // before the threads start.
+  static absl::StatusOr<std::unique_ptr<CoroutineTestbench>> Create(
+      Block* block, const BlockEvaluator& evaluator,
+      const std::optional<ResetProto>& reset = std::nullopt);
+
+  // Adds a thread which may drive the given input ports. An input port may be
+  // driven by only one thread.
+  absl::StatusOr<CoroutineTestbenchThread*> AddThread(
+      std::string_view name, absl::Span<const std::string> driven_ports,
+      std::function<TestbenchTask(CoroutineTestbenchThread&)> body);
+
+  // Runs the threads until all are done. Returns an error if a thread failed,
+  // the block raised an assertion, or the threads did not finish within
+  // `cycle_limit` cycles (not counting reset cycles).
+  absl::Status Run(int64_t cycle_limit = 10'000);
+
+  // Number of cycles evaluated so far, including reset cycles.
+  int64_t cycle_count() const { return cycle_; }
+
+ private:
+  friend class CoroutineTestbenchThread;
+
+  CoroutineTestbench(Block* block, std::optional<ResetProto> reset,
+                     std::unique_ptr<BlockContinuation> continuation);
+
+  // Runs every thread which is ready in the current phase until none is.
+  void RunReadyThreads();
+
+  // Returns the first error recorded by a thread.
+  absl::Status CheckThreadStatus() const;
+
+  // Returns whether the thread is waiting for the current phase of the
+  // current cycle and its condition (if any) holds.
+  bool IsReady(const CoroutineTestbenchThread& thread) const;
+
+  Block* block_;
+  std::optional<ResetProto> reset_;
+  std::unique_ptr<BlockContinuation> continuation_;
+
+  // Values driven on the input ports for the next evaluated cycle.
+  absl::flat_hash_map<std::string, Value> inputs_;
+  absl::flat_hash_map<std::string, Type*> input_types_;
+  absl::flat_hash_map<std::string, Type*> output_types_;
+  // Output port values of the last evaluated cycle, owned by continuation_.
+  const absl::flat_hash_map<std::string, Value>* outputs_ = nullptr;
+
+  std::vector<std::unique_ptr<CoroutineTestbenchThread>> threads_;
+  absl::flat_hash_map<std::string, CoroutineTestbenchThread*> port_drivers_;
+
+  // The current cycle, and whether threads are running at its end (after the
+  // block has been evaluated for it).
+  int64_t cycle_ = 0;
+  bool at_end_of_cycle_ = false;
+};
+
+}  // namespace verilog
+}  // namespace xls
+
+#endif  // XLS_SIMULATION_COROUTINE_TESTBENCH_H_
@@ -0,0 +1,276 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/simulation/coroutine_testbench.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/strings/str_cat.h"
+#include "xls/codegen/module_signature.pb.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/block.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/register.h"
+#include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
+#include "xls/simulation/testbench_metadata.h"
+
+namespace xls {
+namespace verilog {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+
+class CoroutineTestbenchTest : public IrTestBase {
+ protected:
+  // Returns a block computing `out = register(a + b)`.
+  absl::StatusOr<Block*> MakeRegisteredAdder(Package* p) {
+    BlockBuilder bb(TestName(), p);
+    XLS_RETURN_IF_ERROR(bb.AddClockPort("clk"));
+    BValue a = bb.InputPort("a", p->GetBitsType(32));
+    BValue b = bb.InputPort("b", p->GetBitsType(32));
+    bb.OutputPort("out", bb.InsertRegister("sum", bb.Add(a, b)));
+    return bb.Build();
+  }
+
+  // Returns a block computing `rdy = register(vld)`.
+  absl::StatusOr<Block*> MakeDelayedReady(Package* p) {
+    BlockBuilder bb(TestName(), p);
+    XLS_RETURN_IF_ERROR(bb.AddClockPort("clk"));
+    BValue vld = bb.InputPort("vld", p->GetBitsType(1));
+    bb.OutputPort("rdy", bb.InsertRegister("vld_d", vld));
+    return bb.Build();
+  }
+};
+
+TEST_F(CoroutineTestbenchTest, ConcurrentDriversAndChecker) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MakeRegisteredAdder(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CoroutineTestbench> tb,
+      CoroutineTestbench::Create(block, kJitBlockEvaluator));
+
+  XLS_ASSERT_OK(tb->AddThread(
+                      "drive_a", {"a"},
+                      [](CoroutineTestbenchThread& t) -> TestbenchTask {
+                        for (uint64_t i = 0; i < 10; ++i) {
+                          t.Set("a", i);
+                          co_await t.NextCycle();
+                        }
+                      })
+                    .status());
+  XLS_ASSERT_OK(tb->AddThread(
+                      "drive_b", {"b"},
+                      [](CoroutineTestbenchThread& t) -> TestbenchTask {
+                        for (uint64_t i = 0; i < 10; ++i) {
+                          t.Set("b", 10 * i);
+                          co_await t.NextCycle();
+                        }
+                      })
+                    .status());
+  int64_t checked = 0;
+  XLS_ASSERT_OK(
+      tb->AddThread("check", {},
+                    [&checked](CoroutineTestbenchThread& t) -> TestbenchTask {
+                      // The sum is registered.
+                      co_await t.NextCycle();
+                      for (uint64_t i = 0; i < 10; ++i) {
+                        co_await t.AtEndOfCycle();
+                        EXPECT_EQ(t.Get("out"), Value(UBits(11 * i, 32)))
+                            << "cycle " << t.cycle();
+                        ++checked;
+                      }
+                    })
+          .status());
+
+  XLS_ASSERT_OK(tb->Run());
+  EXPECT_EQ(checked, 10);
+  EXPECT_EQ(tb->cycle_count(), 11);
+}
+
+TEST_F(CoroutineTestbenchTest, ManyThreads) {
+  constexpr int64_t kPorts = 128;
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.AddClockPort("clk"));
+  for (int64_t i = 0; i < kPorts; ++i) {
+    BValue in = bb.InputPort(absl::StrCat("in", i), p->GetBitsType(8));
+    bb.OutputPort(absl::StrCat("out", i),
+                  bb.InsertRegister(absl::StrCat("r", i), in));
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CoroutineTestbench> tb,
+      CoroutineTestbench::Create(block, kJitBlockEvaluator));
+
+  int64_t checked = 0;
+  for (int64_t i = 0; i < kPorts; ++i) {
+    std::string in = absl::StrCat("in", i);
+    XLS_ASSERT_OK(
+        tb->AddThread(
+              absl::StrCat("thread", i), {in},
+              [i, in, &checked](CoroutineTestbenchThread& t) -> TestbenchTask {
+                co_await t.AdvanceNCycles(i % 7);
+                t.Set(in, i);
+                co_await t.NextCycle();
+                co_await t.AtEndOfCycle();
+                EXPECT_EQ(t.Get(absl::StrCat("out", i)), Value(UBits(i, 8)));
+                ++checked;
+              })
+            .status());
+  }
+
+  XLS_ASSERT_OK(tb->Run());
+  EXPECT_EQ(checked, kPorts);
+  EXPECT_EQ(tb->cycle_count(), 8);
+}
+
+TestbenchTask Handshake(CoroutineTestbenchThread& t, int64_t& done_cycle) {
+  t.Set("vld", 1);
+  co_await t.WaitForCycleAfter("rdy");
+  t.Set("vld", 0);
+  done_cycle = t.cycle();
+}
+
+TEST_F(CoroutineTestbenchTest, WaitForCycleAfterInSubtask) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MakeDelayedReady(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CoroutineTestbench> tb,
+      CoroutineTestbench::Create(block, kJitBlockEvaluator));
+
+  int64_t done_cycle = -1;
+  int64_t returned_cycle = -1;
+  XLS_ASSERT_OK(
+      tb->AddThread("producer", {"vld"},
+                    [&](CoroutineTestbenchThread& t) -> TestbenchTask {
+                      co_await Handshake(t, done_cycle);
+                      returned_cycle = t.cycle();
+                      co_await t.WaitForCycleAfterNot("rdy");
+                    })
+          .status());
+
+  XLS_ASSERT_OK(tb->Run());
+  // vld is set in cycle 0 and rdy follows in cycle 1.
+  EXPECT_EQ(done_cycle, 2);
+  EXPECT_EQ(returned_cycle, 2);
+  // vld is cleared in cycle 2, so rdy is low in cycle 3.
+  EXPECT_EQ(tb->cycle_count(), 4);
+}
+
+TEST_F(CoroutineTestbenchTest, WaitsForReset) {
+  auto p = CreatePackage();
+  BlockBuilder bb(TestName(), p.get());
+  XLS_ASSERT_OK(bb.AddClockPort("clk"));
+  BValue rst = bb.ResetPort("rst");
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Register * reg,
+      bb.block()->AddRegister("count", p->GetBitsType(8),
+                              Reset{.reset_value = Value(UBits(0, 8)),
+                                    .asynchronous = false,
+                                    .active_low = false}));
+  BValue count = bb.RegisterRead(reg);
+  bb.RegisterWrite(reg, bb.Add(count, bb.Literal(UBits(1, 8))),
+                   /*load_enable=*/std::nullopt, rst);
+  bb.OutputPort("count", count);
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, bb.Build());
+
+  ResetProto reset;
+  reset.set_name("rst");
+  reset.set_asynchronous(false);
+  reset.set_active_low(false);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CoroutineTestbench> tb,
+      CoroutineTestbench::Create(block, kJitBlockEvaluator, reset));
+  EXPECT_THAT(
+      tb->AddThread("rst", {"rst"},
+                    [](CoroutineTestbenchThread& t) -> TestbenchTask {
+                      co_return;
+                    })
+          .status(),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("driven by the testbench")));
+
+  std::vector<Value> counts;
+  XLS_ASSERT_OK(
+      tb->AddThread("check", {},
+                    [&counts](CoroutineTestbenchThread& t) -> TestbenchTask {
+                      EXPECT_EQ(t.cycle(), kResetCycles);
+                      for (int64_t i = 0; i < 3; ++i) {
+                        co_await t.AtEndOfCycle();
+                        counts.push_back(t.Get("count"));
+                      }
+                    })
+          .status());
+
+  XLS_ASSERT_OK(tb->Run());
+  EXPECT_THAT(counts, testing::ElementsAre(Value(UBits(0, 8)),
+                                           Value(UBits(1, 8)),
+                                           Value(UBits(2, 8))));
+}
+
+TEST_F(CoroutineTestbenchTest, Errors) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block, MakeDelayedReady(p.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<CoroutineTestbench> tb,
+      CoroutineTestbench::Create(block, kJitBlockEvaluator));
+
+  EXPECT_THAT(tb->AddThread("bad", {"nope"},
+                            [](CoroutineTestbenchThread& t) -> TestbenchTask {
+                              co_return;
+                            })
+                  .status(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("has no input port `nope`")));
+
+  // Nothing ever drives vld, so rdy is never asserted.
+  XLS_ASSERT_OK(tb->AddThread("waiter", {},
+                              [](CoroutineTestbenchThread& t) -> TestbenchTask {
+                                co_await t.WaitForCycleAfter("rdy");
+                              })
+                    .status());
+  EXPECT_THAT(tb->Run(/*cycle_limit=*/20),
+              StatusIs(absl::StatusCode::kDeadlineExceeded,
+                       HasSubstr("within 20 cycles: waiter")));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      tb, CoroutineTestbench::Create(block, kJitBlockEvaluator));
+  XLS_ASSERT_OK(tb->AddThread("driver", {},
+                              [](CoroutineTestbenchThread& t) -> TestbenchTask {
+                                co_await t.NextCycle();
+                                t.Set("vld", 1);
+                              })
+                    .status());
+  EXPECT_THAT(tb->Run(),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Thread driver failed in cycle 1: Cannot "
+                                 "drive port `vld`")));
+}
+
+}  // namespace
+}  // namespace verilog
+}  // namespace xls
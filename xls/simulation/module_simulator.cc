@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <optional>
 #include <string>
@@ -29,6 +30,7 @@
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/log/vlog_is_on.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -39,12 +41,19 @@
 #include "xls/codegen/module_signature.pb.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
+#include "xls/interpreter/block_evaluator.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/block.h"
 #include "xls/ir/channel.pb.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
 #include "xls/ir/xls_type.pb.h"
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/module_testbench_thread.h"
+#include "xls/simulation/testbench_metadata.h"
 #include "xls/simulation/testbench_signal_capture.h"
 #include "xls/tools/eval_utils.h"
 
@@ -292,6 +301,268 @@ absl::StatusOr<const BlockPortMappingProto*> BlockPortMappingForModule(
   return &*iter;
 }
 
+// Drives a block evaluated in-process one cycle at a time. Like the `reg`s of
+// the Verilog testbench, input port values persist until they are set again.
+// Ports are set and read as flattened Bits.
+class BlockDriver {
+ public:
+  // Creates a driver for `block` with all inputs zero and, if the signature
+  // has a reset, holds the block in reset for the kResetCycles cycles the
+  // testbench does.
+  static absl::StatusOr<std::unique_ptr<BlockDriver>> Create(
+      Block* block, const BlockEvaluator& evaluator,
+      const ModuleSignature& signature) {
+    XLS_ASSIGN_OR_RETURN(std::unique_ptr<BlockContinuation> continuation,
+                         evaluator.NewContinuation(block));
+    auto driver = absl::WrapUnique(new BlockDriver(std::move(continuation)));
+    for (InputPort* port : block->GetInputPorts()) {
+      driver->input_types_[port->name()] = port->GetType();
+      driver->inputs_[port->name()] = ZeroOfType(port->GetType());
+    }
+    if (signature.proto().has_reset()) {
+      const ResetProto& reset = signature.proto().reset();
+      XLS_RETURN_IF_ERROR(
+          driver->Set(reset.name(), UBits(reset.active_low() ? 0 : 1, 1)));
+      for (int64_t i = 0; i < kResetCycles; ++i) {
+        XLS_RETURN_IF_ERROR(
+            driver->continuation_->RunOneCycle(driver->inputs_));
+      }
+      XLS_RETURN_IF_ERROR(
+          driver->Set(reset.name(), UBits(reset.active_low() ? 1 : 0, 1)));
+    }
+    return driver;
+  }
+
+  absl::Status Set(std::string_view name, const Bits& value) {
+    auto it = input_types_.find(name);
+    XLS_RET_CHECK(it != input_types_.end())
+        << absl::StreamFormat("`%s` is not an input port of the block", name);
+    XLS_ASSIGN_OR_RETURN(inputs_[name],
+                         UnflattenBitsToValue(value, it->second));
+    return absl::OkStatus();
+  }
+  // There are no X values in block evaluation; X is driven as zero.
+  absl::Status SetX(std::string_view name) {
+    auto it = input_types_.find(name);
+    XLS_RET_CHECK(it != input_types_.end())
+        << absl::StreamFormat("`%s` is not an input port of the block", name);
+    inputs_[name] = ZeroOfType(it->second);
+    return absl::OkStatus();
+  }
+
+  // Evaluates a cycle with the current inputs. Afterwards, `Get` returns the
+  // values of the outputs sampled at the end of the cycle and the registers
+  // hold the values latched at the following clock edge.
+  absl::Status RunCycle() {
+    XLS_RETURN_IF_ERROR(continuation_->RunOneCycle(inputs_));
+    if (!continuation_->events().assert_msgs.empty()) {
+      return absl::AbortedError(
+          absl::StrFormat("Assertion failed in cycle %d: %s", cycle_,
+                          continuation_->events().assert_msgs.front()));
+    }
+    ++cycle_;
+    return absl::OkStatus();
+  }
+
+  // Returns the value of the given output port at the end of the last cycle,
+  // or the value driven on the given input port.
+  absl::StatusOr<Bits> Get(std::string_view name) const {
+    const absl::flat_hash_map<std::string, Value>& outputs =
+        continuation_->output_ports();
+    if (auto it = outputs.find(name); it != outputs.end()) {
+      return FlattenValueToBits(it->second);
+    }
+    auto it = inputs_.find(name);
+    XLS_RET_CHECK(it != inputs_.end())
+        << absl::StreamFormat("`%s` is not a port of the block", name);
+    return FlattenValueToBits(it->second);
+  }
+
+  // Returns whether the given single-bit port is asserted.
+  absl::StatusOr<bool> IsAsserted(std::string_view name) const {
+    XLS_ASSIGN_OR_RETURN(Bits bits, Get(name));
+    return bits.IsOne();
+  }
+
+  // The number of cycles run since reset.
+  int64_t cycle() const { return cycle_; }
+
+ private:
+  explicit BlockDriver(std::unique_ptr<BlockContinuation> continuation)
+      : continuation_(std::move(continuation)) {}
+
+  std::unique_ptr<BlockContinuation> continuation_;
+  absl::flat_hash_map<std::string, Type*> input_types_;
+  absl::flat_hash_map<std::string, Value> inputs_;
+  int64_t cycle_ = 0;
+};
+
+// Block-evaluation counterpart of the thread created by DriveInputChannel:
+// drives the inputs of a channel one at a time, each after its valid holdoff,
+// until the block accepts it.
+class InputChannelDriver {
+ public:
+  InputChannelDriver(const BlockPortMappingProto& port_mapping,
+                     absl::Span<const Bits> inputs,
+                     absl::Span<const ValidHoldoff> valid_holdoffs)
+      : port_mapping_(port_mapping),
+        inputs_(inputs),
+        valid_holdoffs_(valid_holdoffs) {}
+
+  // Drives the channel's ports for the coming cycle.
+  absl::Status StartCycle(BlockDriver& driver) {
+    while (true) {
+      switch (state_) {
+        case State::kStartInput:
+          if (index_ == inputs_.size()) {
+            if (port_mapping_.has_valid_port_name()) {
+              XLS_RETURN_IF_ERROR(
+                  driver.Set(port_mapping_.valid_port_name(), UBits(0, 1)));
+            }
+            XLS_RETURN_IF_ERROR(driver.SetX(port_mapping_.data_port_name()));
+            state_ = State::kDone;
+            return absl::OkStatus();
+          }
+          holdoff_cycle_ = 0;
+          state_ = State::kHoldoff;
+          break;
+        case State::kHoldoff:
+          if (!valid_holdoffs_.empty() &&
+              holdoff_cycle_ < valid_holdoffs_[index_].cycles) {
+            const ValidHoldoff& holdoff = valid_holdoffs_[index_];
+            XLS_RET_CHECK(port_mapping_.has_valid_port_name())
+                << absl::StreamFormat(
+                       "Valid hold-off specified for channel without a valid "
+                       "signal: `%s`",
+                       port_mapping_.data_port_name());
+            XLS_RETURN_IF_ERROR(
+                driver.Set(port_mapping_.valid_port_name(), UBits(0, 1)));
+            if (holdoff.driven_values.empty() ||
+                std::holds_alternative<IsX>(
+                    holdoff.driven_values[holdoff_cycle_])) {
+              XLS_RETURN_IF_ERROR(driver.SetX(port_mapping_.data_port_name()));
+            } else {
+              XLS_RETURN_IF_ERROR(driver.Set(
+                  port_mapping_.data_port_name(),
+                  std::get<Bits>(holdoff.driven_values[holdoff_cycle_])));
+            }
+            ++holdoff_cycle_;
+            return absl::OkStatus();
+          }
+          XLS_RETURN_IF_ERROR(
+              driver.Set(port_mapping_.data_port_name(), inputs_[index_]));
+          if (port_mapping_.has_valid_port_name()) {
+            XLS_RETURN_IF_ERROR(
+                driver.Set(port_mapping_.valid_port_name(), UBits(1, 1)));
+          }
+          if (port_mapping_.has_ready_port_name()) {
+            state_ = State::kWaitForReady;
+            return absl::OkStatus();
+          }
+          // Without a ready signal nothing holds the thread in this cycle.
+          ++index_;
+          state_ = State::kStartInput;
+          break;
+        case State::kWaitForReady:
+        case State::kDone:
+          return absl::OkStatus();
+      }
+    }
+  }
+
+  // Samples the channel's ports at the end of the cycle.
+  absl::Status EndCycle(const BlockDriver& driver) {
+    if (state_ == State::kWaitForReady) {
+      XLS_ASSIGN_OR_RETURN(bool ready,
+                           driver.IsAsserted(port_mapping_.ready_port_name()));
+      if (ready) {
+        ++index_;
+        state_ = State::kStartInput;
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  enum class State : int8_t { kStartInput, kHoldoff, kWaitForReady, kDone };
+
+  const BlockPortMappingProto& port_mapping_;
+  absl::Span<const Bits> inputs_;
+  absl::Span<const ValidHoldoff> valid_holdoffs_;
+  State state_ = State::kStartInput;
+  int64_t index_ = 0;
+  int64_t holdoff_cycle_ = 0;
+};
+
+// Block-evaluation counterpart of the threads created by CaptureOutputChannel:
+// drives the ready signal of a channel per the ready holdoffs and captures
+// the outputs of the channel.
+class OutputChannelCapture {
+ public:
+  OutputChannelCapture(const BlockPortMappingProto& port_mapping,
+                       int64_t output_count,
+                       absl::Span<const int64_t> ready_holdoffs)
+      : port_mapping_(port_mapping), output_count_(output_count) {
+    // Expand the holdoffs the same way CaptureOutputChannel lowers them.
+    int64_t assertion_length = 1;
+    for (int64_t holdoff : ready_holdoffs) {
+      if (holdoff == 0) {
+        ++assertion_length;
+      } else {
+        ready_pattern_.insert(ready_pattern_.end(), assertion_length, true);
+        ready_pattern_.insert(ready_pattern_.end(), holdoff, false);
+        assertion_length = 1;
+      }
+    }
+  }
+
+  absl::Status StartCycle(BlockDriver& driver, int64_t cycle) {
+    if (port_mapping_.has_ready_port_name()) {
+      bool ready = cycle >= ready_pattern_.size() || ready_pattern_[cycle];
+      XLS_RETURN_IF_ERROR(
+          driver.Set(port_mapping_.ready_port_name(), UBits(ready ? 1 : 0, 1)));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status EndCycle(const BlockDriver& driver) {
+    if (done()) {
+      return absl::OkStatus();
+    }
+    if (port_mapping_.has_valid_port_name()) {
+      XLS_ASSIGN_OR_RETURN(bool valid,
+                           driver.IsAsserted(port_mapping_.valid_port_name()));
+      if (!valid) {
+        return absl::OkStatus();
+      }
+    }
+    if (port_mapping_.has_ready_port_name()) {
+      XLS_ASSIGN_OR_RETURN(bool ready,
+                           driver.IsAsserted(port_mapping_.ready_port_name()));
+      if (!ready) {
+        return absl::OkStatus();
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(Bits data, driver.Get(port_mapping_.data_port_name()));
+    outputs_.push_back(std::move(data));
+    return absl::OkStatus();
+  }
+
+  bool done() const { return outputs_.size() == output_count_; }
+  std::vector<Bits>& outputs() { return outputs_; }
+
+ private:
+  const BlockPortMappingProto& port_mapping_;
+  int64_t output_count_;
+  std::vector<bool> ready_pattern_;
+  std::vector<Bits> outputs_;
+};
+
+absl::Status SimulationTimeoutError(int64_t cycle_limit) {
+  return absl::DeadlineExceededError(absl::StrFormat(
+      "Simulation exceeded maximum length of %d cycles.", cycle_limit));
+}
+
 }  // namespace
 
 std::vector<DutInput> ModuleSimulator::DeassertControlSignals() const {
@@ -356,6 +627,67 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
     return absl::InvalidArgumentError("Expected clock in signature");
   }
 
+  if (block_ != nullptr) {
+    return RunBatchedOnBlock(inputs);
+  }
+
+  std::vector<BitsMap> outputs;
+  int64_t shard_count = std::min<int64_t>(
+      max_simulator_processes_,
+      static_cast<int64_t>(inputs.size()) / kMinInputsPerSimulatorProcess);
+  if (shard_count > 1) {
+    XLS_ASSIGN_OR_RETURN(outputs, RunBatchedInShards(inputs, shard_count));
+  } else {
+    XLS_ASSIGN_OR_RETURN(outputs, RunBatchedOnSimulator(inputs));
+  }
+
+  if (VLOG_IS_ON(1)) {
+    VLOG(1) << "Results:\n";
+    for (int64_t i = 0; i < outputs.size(); ++i) {
+      VLOG(1) << "  Set " << i << ":";
+      for (const auto& pair : outputs[i]) {
+        VLOG(1) << "    " << pair.first << " : " << pair.second.ToDebugString();
+      }
+    }
+  }
+
+  return outputs;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunBatchedInShards(absl::Span<const BitsMap> inputs,
+                                    int64_t shard_count) const {
+  // Each shard is a contiguous slice of the inputs simulated by its own
+  // testbench, starting from reset. The outputs of a function depend only on
+  // its inputs so the concatenated shard outputs match those of a single run.
+  std::vector<absl::Span<const BitsMap>> shards;
+  int64_t shard_size = (inputs.size() + shard_count - 1) / shard_count;
+  for (int64_t start = 0; start < inputs.size(); start += shard_size) {
+    shards.push_back(inputs.subspan(start, shard_size));
+  }
+  std::vector<absl::StatusOr<std::vector<BitsMap>>> shard_outputs(
+      shards.size());
+  {
+    ThreadPool pool(shards.size());
+    for (int64_t i = 0; i < shards.size(); ++i) {
+      pool.Schedule([this, &shards, &shard_outputs, i]() {
+        shard_outputs[i] = RunBatchedOnSimulator(shards[i]);
+      });
+    }
+    pool.WaitForIdle();
+  }
+
+  std::vector<BitsMap> outputs;
+  outputs.reserve(inputs.size());
+  for (absl::StatusOr<std::vector<BitsMap>>& shard_output : shard_outputs) {
+    XLS_RETURN_IF_ERROR(shard_output.status());
+    absl::c_move(*shard_output, std::back_inserter(outputs));
+  }
+  return outputs;
+}
+
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunBatchedOnSimulator(absl::Span<const BitsMap> inputs) const {
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ModuleTestbench> tb,
                        ModuleTestbench::CreateFromVerilogText(
                            verilog_text_, file_type_, signature_, simulator_,
@@ -495,17 +827,108 @@ ModuleSimulator::RunBatched(absl::Span<const BitsMap> inputs) const {
       outputs[i][pair.first] = *pair.second;
     }
   }
+  return outputs;
+}
 
-  if (VLOG_IS_ON(1)) {
-    VLOG(1) << "Results:\n";
-    for (int64_t i = 0; i < outputs.size(); ++i) {
-      VLOG(1) << "  Set " << i << ":";
-      for (const auto& pair : outputs[i]) {
-        VLOG(1) << "    " << pair.first << " : " << pair.second.ToDebugString();
+absl::StatusOr<std::vector<ModuleSimulator::BitsMap>>
+ModuleSimulator::RunBatchedOnBlock(absl::Span<const BitsMap> inputs) const {
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BlockDriver> driver,
+      BlockDriver::Create(block_, *block_evaluator_, signature_));
+
+  auto drive_data = [&](int64_t index) -> absl::Status {
+    for (const PortProto& input : signature_.data_inputs()) {
+      XLS_RETURN_IF_ERROR(
+          driver->Set(input.name(), inputs[index].at(input.name())));
+    }
+    return absl::OkStatus();
+  };
+  std::vector<BitsMap> outputs(inputs.size());
+  auto capture_outputs = [&](int64_t index) -> absl::Status {
+    for (const PortProto& output : signature_.data_outputs()) {
+      XLS_ASSIGN_OR_RETURN(outputs[index][output.name()],
+                           driver->Get(output.name()));
+    }
+    return absl::OkStatus();
+  };
+
+  // The cycles below follow those of the testbench built by RunBatched.
+  if (signature_.proto().has_fixed_latency()) {
+    const int64_t latency = signature_.proto().fixed_latency().latency();
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      XLS_RETURN_IF_ERROR(drive_data(i));
+      for (int64_t c = 0; c < latency; ++c) {
+        XLS_RETURN_IF_ERROR(driver->RunCycle());
       }
+      XLS_RETURN_IF_ERROR(driver->RunCycle());
+      XLS_RETURN_IF_ERROR(capture_outputs(i));
+      // Hold the inputs for the cycle after the output is read.
+      XLS_RETURN_IF_ERROR(driver->RunCycle());
     }
-  }
+  } else if (signature_.proto().has_pipeline()) {
+    const int64_t latency = signature_.proto().pipeline().latency();
+    std::optional<PipelineControl> pipeline_control;
+    if (signature_.proto().pipeline().has_pipeline_control()) {
+      pipeline_control = signature_.proto().pipeline().pipeline_control();
+    }
+    const bool has_valid =
+        pipeline_control.has_value() && pipeline_control->has_valid();
+    if (pipeline_control.has_value() && pipeline_control->has_manual()) {
+      XLS_RETURN_IF_ERROR(driver->Set(pipeline_control->manual().input_name(),
+                                      Bits::AllOnes(latency)));
+    }
+    auto check_output_valid = [&](bool expected) -> absl::Status {
+      if (!has_valid || !pipeline_control->valid().has_output_name()) {
+        return absl::OkStatus();
+      }
+      const std::string& name = pipeline_control->valid().output_name();
+      XLS_ASSIGN_OR_RETURN(bool valid, driver->IsAsserted(name));
+      if (valid != expected) {
+        return absl::FailedPreconditionError(absl::StrFormat(
+            "Expected output `%s` to have value %d in cycle %d, actual: %d",
+            name, expected, driver->cycle() - 1, valid));
+      }
+      return absl::OkStatus();
+    };
 
+    // Input `i` is driven in cycle `i` and its outputs emerge in cycle
+    // `i + latency`.
+    for (int64_t cycle = 0; cycle < inputs.size() + latency; ++cycle) {
+      if (cycle < inputs.size()) {
+        XLS_RETURN_IF_ERROR(drive_data(cycle));
+      } else if (cycle == inputs.size()) {
+        for (const PortProto& input : signature_.data_inputs()) {
+          XLS_RETURN_IF_ERROR(driver->SetX(input.name()));
+        }
+      }
+      if (has_valid) {
+        XLS_RETURN_IF_ERROR(
+            driver->Set(pipeline_control->valid().input_name(),
+                        UBits(cycle < inputs.size() ? 1 : 0, 1)));
+      }
+      XLS_RETURN_IF_ERROR(driver->RunCycle());
+      if (cycle >= latency) {
+        XLS_RETURN_IF_ERROR(check_output_valid(true));
+        XLS_RETURN_IF_ERROR(capture_outputs(cycle - latency));
+      } else if (signature_.proto().has_reset()) {
+        // Without a reset the output valid would be X in the Verilog.
+        XLS_RETURN_IF_ERROR(check_output_valid(false));
+      }
+    }
+    // valid == 0 should have propagated all the way through the pipeline to
+    // output_valid.
+    XLS_RETURN_IF_ERROR(driver->RunCycle());
+    XLS_RETURN_IF_ERROR(check_output_valid(false));
+  } else if (signature_.proto().has_combinational()) {
+    for (int64_t i = 0; i < inputs.size(); ++i) {
+      XLS_RETURN_IF_ERROR(drive_data(i));
+      XLS_RETURN_IF_ERROR(driver->RunCycle());
+      XLS_RETURN_IF_ERROR(capture_outputs(i));
+    }
+  } else {
+    return absl::UnimplementedError(absl::StrCat(
+        "Unsupported interface: ", signature_.proto().interface_oneof_case()));
+  }
   return outputs;
 }
 
@@ -544,6 +967,10 @@ absl::StatusOr<std::string> ModuleSimulator::GenerateProcTestbenchVerilog(
     const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
     const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
     std::optional<ReadyValidHoldoffs> holdoffs) const {
+  if (block_ != nullptr) {
+    return absl::UnimplementedError(
+        "No Verilog testbench is generated when simulating a block");
+  }
   XLS_ASSIGN_OR_RETURN(
       ProcTestbench proc_tb,
       CreateProcTestbench(channel_inputs, output_channel_counts,
@@ -551,33 +978,10 @@ absl::StatusOr<std::string> ModuleSimulator::GenerateProcTestbenchVerilog(
   return proc_tb.testbench->GenerateVerilog();
 }
 
-absl::StatusOr<ModuleSimulator::ProcTestbench>
-ModuleSimulator::CreateProcTestbench(
+absl::Status ModuleSimulator::ValidateProcInputs(
     const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
     const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
-    std::optional<ReadyValidHoldoffs> holdoffs) const {
-  VLOG(1) << "Generating testbench for Verilog module with signature:\n"
-          << signature_.ToString();
-  if (VLOG_IS_ON(1)) {
-    absl::flat_hash_map<std::string, std::vector<Value>> channel_inputs_values;
-    for (const auto& [channel_name, channel_values] : channel_inputs) {
-      XLS_ASSIGN_OR_RETURN(ChannelProto channel_proto,
-                           signature_.GetInputChannelProtoByName(channel_name));
-      XLS_ASSIGN_OR_RETURN(
-          const BlockPortMappingProto* block_port_proto,
-          BlockPortMappingForModule(channel_proto, signature_.module_name()));
-      XLS_ASSIGN_OR_RETURN(PortProto data_port,
-                           signature_.GetInputPortProtoByName(
-                               block_port_proto->data_port_name()));
-      XLS_ASSIGN_OR_RETURN(
-          channel_inputs_values[channel_name],
-          BitsListToValueList(channel_values, data_port.type()));
-    }
-    VLOG(1) << "Input channel values:\n";
-    VLOG(1) << ChannelValuesToString(channel_inputs_values);
-  }
-  VLOG(2) << "Verilog:\n" << verilog_text_;
-
+    const std::optional<ReadyValidHoldoffs>& holdoffs) const {
   for (const auto& [channel_name, channel_values] : channel_inputs) {
     XLS_RETURN_IF_ERROR(
         signature_.ValidateChannelBitsInputs(channel_name, channel_values));
@@ -608,6 +1012,38 @@ ModuleSimulator::CreateProcTestbench(
       !signature_.proto().has_combinational()) {
     return absl::InvalidArgumentError("Expected clock in signature");
   }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<ModuleSimulator::ProcTestbench>
+ModuleSimulator::CreateProcTestbench(
+    const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+    std::optional<ReadyValidHoldoffs> holdoffs) const {
+  VLOG(1) << "Generating testbench for Verilog module with signature:\n"
+          << signature_.ToString();
+  if (VLOG_IS_ON(1)) {
+    absl::flat_hash_map<std::string, std::vector<Value>> channel_inputs_values;
+    for (const auto& [channel_name, channel_values] : channel_inputs) {
+      XLS_ASSIGN_OR_RETURN(ChannelProto channel_proto,
+                           signature_.GetInputChannelProtoByName(channel_name));
+      XLS_ASSIGN_OR_RETURN(
+          const BlockPortMappingProto* block_port_proto,
+          BlockPortMappingForModule(channel_proto, signature_.module_name()));
+      XLS_ASSIGN_OR_RETURN(PortProto data_port,
+                           signature_.GetInputPortProtoByName(
+                               block_port_proto->data_port_name()));
+      XLS_ASSIGN_OR_RETURN(
+          channel_inputs_values[channel_name],
+          BitsListToValueList(channel_values, data_port.type()));
+    }
+    VLOG(1) << "Input channel values:\n";
+    VLOG(1) << ChannelValuesToString(channel_inputs_values);
+  }
+  VLOG(2) << "Verilog:\n" << verilog_text_;
+
+  XLS_RETURN_IF_ERROR(
+      ValidateProcInputs(channel_inputs, output_channel_counts, holdoffs));
 
   XLS_ASSIGN_OR_RETURN(std::unique_ptr<ModuleTestbench> tb,
                        ModuleTestbench::CreateFromVerilogText(
@@ -666,18 +1102,24 @@ ModuleSimulator::RunInputSeriesProc(
     const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
     const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
     std::optional<ReadyValidHoldoffs> holdoffs) const {
-  XLS_ASSIGN_OR_RETURN(
-      ProcTestbench proc_tb,
-      CreateProcTestbench(channel_inputs, output_channel_counts,
-                          std::move(holdoffs)));
-  XLS_RETURN_IF_ERROR(proc_tb.testbench->Run());
-
   absl::flat_hash_map<std::string, std::vector<Bits>> outputs;
-  for (const ChannelProto& channel_proto : signature_.GetOutputChannels()) {
-    std::string_view channel_name = channel_proto.name();
-    outputs[channel_name] = std::vector<Bits>();
-    for (std::unique_ptr<Bits>& bits : proc_tb.outputs.at(channel_name)) {
-      outputs[channel_name].push_back(std::move(*bits));
+  if (block_ != nullptr) {
+    XLS_ASSIGN_OR_RETURN(outputs,
+                         RunInputSeriesProcOnBlock(
+                             channel_inputs, output_channel_counts, holdoffs));
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        ProcTestbench proc_tb,
+        CreateProcTestbench(channel_inputs, output_channel_counts,
+                            std::move(holdoffs)));
+    XLS_RETURN_IF_ERROR(proc_tb.testbench->Run());
+
+    for (const ChannelProto& channel_proto : signature_.GetOutputChannels()) {
+      std::string_view channel_name = channel_proto.name();
+      outputs[channel_name] = std::vector<Bits>();
+      for (std::unique_ptr<Bits>& bits : proc_tb.outputs.at(channel_name)) {
+        outputs[channel_name].push_back(std::move(*bits));
+      }
     }
   }
 
@@ -703,6 +1145,81 @@ ModuleSimulator::RunInputSeriesProc(
   return outputs;
 }
 
+absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Bits>>>
+ModuleSimulator::RunInputSeriesProcOnBlock(
+    const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+    const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+    const std::optional<ReadyValidHoldoffs>& holdoffs) const {
+  XLS_RETURN_IF_ERROR(
+      ValidateProcInputs(channel_inputs, output_channel_counts, holdoffs));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<BlockDriver> driver,
+      BlockDriver::Create(block_, *block_evaluator_, signature_));
+
+  std::vector<InputChannelDriver> input_drivers;
+  for (const ChannelProto& channel_proto : signature_.GetInputChannels()) {
+    std::string_view channel_name = channel_proto.name();
+    absl::Span<const ValidHoldoff> valid_holdoffs;
+    if (holdoffs.has_value() &&
+        holdoffs->valid_holdoffs.contains(channel_name)) {
+      valid_holdoffs = holdoffs->valid_holdoffs.at(channel_name);
+    }
+    XLS_ASSIGN_OR_RETURN(
+        const BlockPortMappingProto* block_port_proto,
+        BlockPortMappingForModule(channel_proto, signature_.module_name()));
+    input_drivers.emplace_back(*block_port_proto,
+                               channel_inputs.at(channel_name), valid_holdoffs);
+  }
+  std::vector<std::pair<std::string, OutputChannelCapture>> output_captures;
+  for (const ChannelProto& channel_proto : signature_.GetOutputChannels()) {
+    std::string_view channel_name = channel_proto.name();
+    absl::Span<const int64_t> ready_holdoffs;
+    if (holdoffs.has_value() &&
+        holdoffs->ready_holdoffs.contains(channel_name)) {
+      ready_holdoffs = holdoffs->ready_holdoffs.at(channel_name);
+    }
+    XLS_ASSIGN_OR_RETURN(
+        const BlockPortMappingProto* block_port_proto,
+        BlockPortMappingForModule(channel_proto, signature_.module_name()));
+    output_captures.emplace_back(
+        std::string{channel_name},
+        OutputChannelCapture(*block_port_proto,
+                             output_channel_counts.at(channel_name),
+                             ready_holdoffs));
+  }
+
+  // As in the testbench, run until every output has been captured.
+  auto all_captured = [&]() {
+    return absl::c_all_of(output_captures, [](const auto& name_and_capture) {
+      return name_and_capture.second.done();
+    });
+  };
+  while (!all_captured()) {
+    if (driver->cycle() >= kDefaultSimulationCycleLimit) {
+      return SimulationTimeoutError(kDefaultSimulationCycleLimit);
+    }
+    for (InputChannelDriver& input_driver : input_drivers) {
+      XLS_RETURN_IF_ERROR(input_driver.StartCycle(*driver));
+    }
+    for (auto& [_, capture] : output_captures) {
+      XLS_RETURN_IF_ERROR(capture.StartCycle(*driver, driver->cycle()));
+    }
+    XLS_RETURN_IF_ERROR(driver->RunCycle());
+    for (InputChannelDriver& input_driver : input_drivers) {
+      XLS_RETURN_IF_ERROR(input_driver.EndCycle(*driver));
+    }
+    for (auto& [_, capture] : output_captures) {
+      XLS_RETURN_IF_ERROR(capture.EndCycle(*driver));
+    }
+  }
+
+  absl::flat_hash_map<std::string, std::vector<Bits>> outputs;
+  for (auto& [channel_name, capture] : output_captures) {
+    outputs[channel_name] = std::move(capture.outputs());
+  }
+  return outputs;
+}
+
 absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Value>>>
 ModuleSimulator::RunInputSeriesProc(
     const absl::flat_hash_map<std::string, std::vector<Value>>& channel_inputs,
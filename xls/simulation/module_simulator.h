@@ -15,6 +15,7 @@
 #ifndef XLS_SIMULATION_MODULE_SIMULATOR_H_
 #define XLS_SIMULATION_MODULE_SIMULATOR_H_
 
+#include <algorithm>
 #include <cstdint>
 #include <memory>
 #include <optional>
@@ -27,7 +28,9 @@
 #include "absl/types/span.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/interpreter/block_evaluator.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/block.h"
 #include "xls/ir/value.h"
 #include "xls/simulation/module_testbench.h"
 #include "xls/simulation/module_testbench_thread.h"
@@ -77,7 +80,8 @@ struct ReadyValidHoldoffs {
 };
 
 // Abstraction for simulating a module described by a SignatureProto using a
-// testbench run under the Verilog simulator.
+// testbench run under the Verilog simulator, or by evaluating the block IR the
+// module was generated from in-process.
 class ModuleSimulator {
  public:
   // Type alias for passing named Bits value to and from module simulation.
@@ -97,6 +101,21 @@ class ModuleSimulator {
         simulator_(simulator),
         includes_(includes) {}
 
+  // Constructor for a simulator which evaluates `block`, the block IR from
+  // which the module described by `signature` was generated, with `evaluator`
+  // (e.g., kJitBlockEvaluator) instead of running Verilog under a simulator.
+  // The inputs are driven and the outputs sampled in the same cycles as in the
+  // Verilog testbench. The block evaluators have no X values: X inputs are
+  // driven as zero and expectations of X outputs are not checked. `block` and
+  // `evaluator` must outlive the simulator.
+  ModuleSimulator(const ModuleSignature& signature, Block* block,
+                  const BlockEvaluator* evaluator)
+      : signature_(signature),
+        file_type_(FileType::kVerilog),
+        simulator_(nullptr),
+        block_(block),
+        block_evaluator_(evaluator) {}
+
   // Simulates the module with the given inputs as Bits types. Returns a
   // map containing the outputs by port name.
   absl::StatusOr<BitsMap> RunFunction(const BitsMap& inputs) const;
@@ -105,9 +124,23 @@ class ModuleSimulator {
   // otherwise an error is returned. Returns the single output value.
   absl::StatusOr<Bits> RunAndReturnSingleOutput(const BitsMap& inputs) const;
 
+  // Sets the maximum number of Verilog simulator processes RunBatched may run
+  // in parallel. Batches with at least kMinInputsPerSimulatorProcess inputs per
+  // process are split into contiguous shards, each simulated from reset by its
+  // own testbench, and the outputs are concatenated in input order. Defaults to
+  // one, i.e., a single simulator invocation per batch.
+  void set_max_simulator_processes(int64_t count) {
+    max_simulator_processes_ = std::max<int64_t>(count, 1);
+  }
+
+  // The smallest number of inputs worth a simulator process of its own: below
+  // this, compiling and starting the simulator dominates the simulation time.
+  static constexpr int64_t kMinInputsPerSimulatorProcess = 64;
+
   // Runs the given batch of argument values through the module with a single
-  // invocation of the Verilog simulator. Generally, this is much faster than
-  // running via separate calls to Run.
+  // invocation of the Verilog simulator (or one per shard, see
+  // set_max_simulator_processes). Generally, this is much faster than running
+  // via separate calls to Run.
   absl::StatusOr<std::vector<BitsMap>> RunBatched(
       absl::Span<const BitsMap> inputs) const;
 
@@ -136,7 +169,7 @@ class ModuleSimulator {
   absl::StatusOr<Value> RunFunction(absl::Span<const Value> inputs) const;
 
   // Returns the (System)Verilog testbench for testing the module with the given
-  // inputs and expected outputs counts.
+  // inputs and expected outputs counts. Not supported when simulating a block.
   absl::StatusOr<std::string> GenerateProcTestbenchVerilog(
       const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
       const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
@@ -159,11 +192,41 @@ class ModuleSimulator {
       const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
       std::optional<ReadyValidHoldoffs> holdoffs) const;
 
+  // Checks the arguments of RunInputSeriesProc against the signature.
+  absl::Status ValidateProcInputs(
+      const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+      const std::optional<ReadyValidHoldoffs>& holdoffs) const;
+
+  // Runs `inputs` through a single testbench under the Verilog simulator.
+  absl::StatusOr<std::vector<BitsMap>> RunBatchedOnSimulator(
+      absl::Span<const BitsMap> inputs) const;
+
+  // Splits `inputs` into `shard_count` shards and runs them through
+  // RunBatchedOnSimulator concurrently.
+  absl::StatusOr<std::vector<BitsMap>> RunBatchedInShards(
+      absl::Span<const BitsMap> inputs, int64_t shard_count) const;
+
+  // Implementations of RunBatched and RunInputSeriesProc which evaluate
+  // `block_` rather than running a Verilog testbench.
+  absl::StatusOr<std::vector<BitsMap>> RunBatchedOnBlock(
+      absl::Span<const BitsMap> inputs) const;
+  absl::StatusOr<absl::flat_hash_map<std::string, std::vector<Bits>>>
+  RunInputSeriesProcOnBlock(
+      const absl::flat_hash_map<std::string, std::vector<Bits>>& channel_inputs,
+      const absl::flat_hash_map<std::string, int64_t>& output_channel_counts,
+      const std::optional<ReadyValidHoldoffs>& holdoffs) const;
+
   ModuleSignature signature_;
   std::string verilog_text_;
   FileType file_type_;
   const VerilogSimulator* simulator_;
   absl::Span<const VerilogInclude> includes_;
+  int64_t max_simulator_processes_ = 1;
+
+  // The block to evaluate in place of Verilog simulation, if any.
+  Block* block_ = nullptr;
+  const BlockEvaluator* block_evaluator_ = nullptr;
 };
 
 }  // namespace verilog
@@ -32,11 +32,14 @@
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
 #include "xls/ir/bits.h"
+#include "xls/ir/bits_ops.h"
+#include "xls/ir/block.h"
 #include "xls/ir/channel.h"
 #include "xls/ir/channel_ops.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/package.h"
 #include "xls/ir/value.h"
+#include "xls/jit/block_jit.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/run_pipeline_schedule.h"
 #include "xls/scheduling/scheduling_options.h"
@@ -574,6 +577,108 @@ TEST_P(ModuleSimulatorCodegenTest, ProcEmptyTuple) {
               "Input value 'input' is wrong type. Expected '()', got '(())'")));
 }
 
+TEST_P(ModuleSimulatorCodegenTest, PipelinedAddWithValidOnBlockJit) {
+  Package package(TestName());
+  FunctionBuilder fb("x_plus_y_plus_z_plus_x", &package);
+  Type* u32 = package.GetBitsType(32);
+  auto x = fb.Param("x", u32);
+  auto y = fb.Param("y", u32);
+  auto z = fb.Param("z", u32);
+  auto out = x + y + z + x;
+
+  XLS_ASSERT_OK_AND_ASSIGN(Function * func, fb.BuildWithReturnValue(out));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(func, *delay_estimator_,
+                          SchedulingOptions().pipeline_stages(5)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPipelineModuleText(schedule, func,
+                           BuildPipelineOptions()
+                               .valid_control("valid_in", "valid_out")
+                               .reset("rst", false, false, false)
+                               .use_system_verilog(UseSystemVerilog())));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           package.GetBlock(result.signature.module_name()));
+
+  std::vector<absl::flat_hash_map<std::string, Bits>> inputs;
+  for (int64_t i = 0; i < 8; ++i) {
+    inputs.push_back({{"x", UBits(42 + i, 32)},
+                      {"y", UBits(123 * i, 32)},
+                      {"z", UBits(3, 32)}});
+  }
+  ModuleSimulator verilog_simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  ModuleSimulator block_simulator(result.signature, block, &kJitBlockEvaluator);
+  XLS_ASSERT_OK_AND_ASSIGN(auto expected,
+                           verilog_simulator.RunBatched(inputs));
+  EXPECT_THAT(block_simulator.RunBatched(inputs), IsOkAndHolds(expected));
+  EXPECT_EQ(expected[1].at("out"), UBits(43 + 123 + 3 + 43, 32));
+}
+
+TEST_P(ModuleSimulatorCodegenTest, PipelinedProcWithHoldoffsOnBlockJit) {
+  Package package(TestName());
+  Type* u32 = package.GetBitsType(32);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * a, package.CreateStreamingChannel(
+                       "a", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * b, package.CreateStreamingChannel(
+                       "b", ChannelOps::kReceiveOnly, u32));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, package.CreateStreamingChannel(
+                         "out", ChannelOps::kSendOnly, u32));
+  TokenlessProcBuilder pb(TestName(), "tkn", &package);
+  BValue sum = pb.Add(pb.Receive(a), pb.Receive(b));
+  pb.Send(out, pb.Negate(sum));
+  XLS_ASSERT_OK_AND_ASSIGN(Proc * proc, pb.Build({}));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PipelineSchedule schedule,
+      RunPipelineSchedule(proc, *delay_estimator_,
+                          SchedulingOptions().pipeline_stages(3)));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleGeneratorResult result,
+      ToPipelineModuleText(schedule, proc,
+                           BuildPipelineOptions()
+                               .reset("rst", false, false, false)
+                               .use_system_verilog(UseSystemVerilog())));
+  XLS_ASSERT_OK_AND_ASSIGN(Block * block,
+                           package.GetBlock(result.signature.module_name()));
+
+  absl::flat_hash_map<std::string, std::vector<Bits>> inputs = {
+      {"a", {UBits(1, 32), UBits(2, 32), UBits(3, 32), UBits(4, 32)}},
+      {"b", {UBits(10, 32), UBits(20, 32), UBits(30, 32), UBits(40, 32)}}};
+  absl::flat_hash_map<std::string, int64_t> output_counts = {{"out", 4}};
+  ReadyValidHoldoffs holdoffs{
+      .valid_holdoffs = {{"a",
+                          {ValidHoldoff{.cycles = 2},
+                           ValidHoldoff{.cycles = 0},
+                           ValidHoldoff{.cycles = 1,
+                                        .driven_values = {UBits(7, 32)}},
+                           ValidHoldoff{.cycles = 3}}}},
+      .ready_holdoffs = {{"out", {0, 2, 0, 1, 3}}}};
+
+  ModuleSimulator verilog_simulator =
+      NewModuleSimulator(result.verilog_text, result.signature);
+  ModuleSimulator block_simulator(result.signature, block, &kJitBlockEvaluator);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto expected,
+      verilog_simulator.RunInputSeriesProc(inputs, output_counts, holdoffs));
+  EXPECT_THAT(
+      block_simulator.RunInputSeriesProc(inputs, output_counts, holdoffs),
+      IsOkAndHolds(expected));
+  EXPECT_EQ(expected.at("out")[3], bits_ops::Negate(UBits(44, 32)));
+
+  // Waiting for more outputs than the proc produces times out.
+  output_counts["out"] = 5;
+  EXPECT_THAT(
+      block_simulator.RunInputSeriesProc(inputs, output_counts).status(),
+      StatusIs(absl::StatusCode::kDeadlineExceeded));
+}
+
 INSTANTIATE_TEST_SUITE_P(ModuleSimulatorCodegenTestInstantiation,
                          ModuleSimulatorCodegenTest,
                          testing::ValuesIn(kDefaultSimulationTargets),
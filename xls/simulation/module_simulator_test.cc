@@ -410,6 +410,30 @@ TEST_P(ModuleSimulatorTest, CombinationalBatched) {
   EXPECT_THAT(outputs[2], ElementsAre(Pair("out", UBits(100, 8))));
 }
 
+TEST_P(ModuleSimulatorTest, CombinationalBatchedAcrossProcesses) {
+  XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeCombinationalModule());
+  ModuleSimulator simulator =
+      NewModuleSimulator(verilog_signature.first, verilog_signature.second);
+  simulator.set_max_simulator_processes(4);
+
+  // Enough inputs for three shards, the last of which is short.
+  using BitsMap = ModuleSimulator::BitsMap;
+  const int64_t kInputCount =
+      3 * ModuleSimulator::kMinInputsPerSimulatorProcess + 5;
+  std::vector<BitsMap> inputs;
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    inputs.push_back(BitsMap{{"x", UBits(i % 256, 8)}, {"y", UBits(3, 8)}});
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<BitsMap> outputs,
+                           simulator.RunBatched(inputs));
+
+  ASSERT_EQ(outputs.size(), kInputCount);
+  for (int64_t i = 0; i < kInputCount; ++i) {
+    EXPECT_THAT(outputs[i], ElementsAre(Pair("out", UBits((i + 253) % 256, 8))))
+        << "input " << i;
+  }
+}
+
 TEST_P(ModuleSimulatorTest, ReadyValidBatched) {
   XLS_ASSERT_OK_AND_ASSIGN(auto verilog_signature, MakeReadyValidModule());
   ModuleSimulator simulator =
@@ -64,9 +64,6 @@ namespace xls {
 namespace verilog {
 namespace {
 
-// The number of cycles that the design under test (DUT) is being reset.
-static constexpr int64_t kResetCycles = 5;
-
 std::string GetTimeoutMessage(int64_t cycle_limit) {
   return absl::StrFormat("ERROR: timeout, simulation ran too long (%d cycles).",
                          cycle_limit);
@@ -775,7 +772,7 @@ static std::string GetPipePathMacroName(std::string_view stream_name) {
 }
 
 absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateInputStream(
-    std::string_view name, int64_t width) {
+    std::string_view name, int64_t width, TestbenchStreamEncoding encoding) {
   if (stream_names_.contains(name)) {
     return absl::InvalidArgumentError(
         absl::StrFormat("Already a I/O stream named `%s`", name));
@@ -785,12 +782,13 @@ absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateInputStream(
       new TestbenchStream{.name = std::string{name},
                           .direction = TestbenchStreamDirection::kInput,
                           .path_macro_name = GetPipePathMacroName(name),
-                          .width = width}));
+                          .width = width,
+                          .encoding = encoding}));
   return streams_.back().get();
 }
 
 absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateOutputStream(
-    std::string_view name, int64_t width) {
+    std::string_view name, int64_t width, TestbenchStreamEncoding encoding) {
   if (stream_names_.contains(name)) {
     return absl::InvalidArgumentError(
         absl::StrFormat("Already a I/O stream named `%s`", name));
@@ -800,7 +798,8 @@ absl::StatusOr<const TestbenchStream*> ModuleTestbench::CreateOutputStream(
       new TestbenchStream{.name = std::string{name},
                           .direction = TestbenchStreamDirection::kOutput,
                           .path_macro_name = GetPipePathMacroName(name),
-                          .width = width}));
+                          .width = width,
+                          .encoding = encoding}));
   return streams_.back().get();
 }
 
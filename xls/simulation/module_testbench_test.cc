@@ -970,6 +970,52 @@ TEST_P(ModuleTestbenchTest, StreamingIo) {
       {{output_stream->name, SequentialConsumer()}}));
 }
 
+TEST_P(ModuleTestbenchTest, BinaryStreamingIo) {
+  constexpr int64_t kInputCount = 100000;
+  // Not a multiple of eight, so each value is padded.
+  constexpr int64_t kWidth = 20;
+
+  VerilogFile f = NewVerilogFile();
+  Module* m = MakeTwoStageIdentityPipeline(&f, kWidth);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ModuleTestbench> tb,
+      ModuleTestbench::CreateFromVastModule(
+          m, GetSimulator(), "clk", /*reset=*/std::nullopt,
+          /*includes=*/{}, /*simulation_cycle_limit=*/kInputCount + 10));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      const TestbenchStream* input_stream,
+      tb->CreateInputStream("my_input", kWidth,
+                            TestbenchStreamEncoding::kBinary));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      const TestbenchStream* output_stream,
+      tb->CreateOutputStream("my_output", kWidth,
+                             TestbenchStreamEncoding::kBinary));
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ModuleTestbenchThread * input_thread,
+      tb->CreateThreadDrivingAllInputs("input", /*default_value=*/ZeroOrX::kX));
+  {
+    SequentialBlock& seq = input_thread->MainBlock();
+    SequentialBlock& loop = seq.Repeat(kInputCount);
+    loop.ReadFromStreamAndSet("in", input_stream).NextCycle();
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(ModuleTestbenchThread * output_thread,
+                           tb->CreateThread("output",
+                                            /*dut_inputs=*/{}));
+  {
+    SequentialBlock& seq = output_thread->MainBlock();
+    seq.NextCycle().NextCycle();
+    SequentialBlock& loop = seq.Repeat(kInputCount);
+    loop.AtEndOfCycle().CaptureAndWriteToStream("out", output_stream);
+  }
+
+  // Values which have a zero byte are in there too, e.g. 0x10000.
+  XLS_ASSERT_OK(tb->RunWithStreamingIo(
+      {{input_stream->name, SequentialProducer(kWidth, kInputCount)}},
+      {{output_stream->name, SequentialConsumer()}}));
+}
+
 TEST_P(ModuleTestbenchTest, CycleLimit) {
   VerilogFile f = NewVerilogFile();
   Module* m = MakeTwoStageIdentityPipeline(&f);
@@ -41,6 +41,9 @@ inline constexpr int64_t kClockPeriod = 10;
 static_assert(kClockPeriod > 3);
 static_assert(kClockPeriod % 2 == 0);
 
+// The number of cycles that the design under test (DUT) is being reset.
+inline constexpr int64_t kResetCycles = 5;
+
 // Metadata about the testbench and the underlying device-under-test.
 class TestbenchMetadata {
  public:
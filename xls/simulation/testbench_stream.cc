@@ -14,7 +14,10 @@
 
 #include "xls/simulation/testbench_stream.h"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <filesystem>  // NOLINT
 #include <functional>
 #include <memory>
@@ -29,9 +32,13 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast/vast.h"
+#include "xls/common/file/file_descriptor.h"
 #include "xls/common/file/named_pipe.h"
+#include "xls/common/math_util.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/thread.h"
 #include "xls/ir/bits.h"
@@ -42,6 +49,28 @@
 
 namespace xls {
 namespace verilog {
+namespace {
+
+// Size of the stdio buffers of binary streams, so values cross the pipe in
+// large writes.
+constexpr int64_t kBinaryStreamBufferSize = 1 << 16;
+
+int64_t BinaryFrameSize(const TestbenchStream& stream) {
+  return CeilOfRatio(stream.width, int64_t{8});
+}
+
+// Opens `path` for binary I/O with a large stdio buffer.
+absl::StatusOr<FileStream> OpenBinaryStream(const std::filesystem::path& path,
+                                            const std::string& mode) {
+  XLS_ASSIGN_OR_RETURN(FileStream file, FileStream::Open(path, mode));
+  if (setvbuf(file.get(), nullptr, _IOFBF, kBinaryStreamBufferSize) != 0) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to set buffer of %s", path.string()));
+  }
+  return file;
+}
+
+}  // namespace
 
 /* static */ VastStreamEmitter VastStreamEmitter::Create(
     const TestbenchStream& stream, Module* m) {
@@ -56,6 +85,12 @@ namespace verilog {
   emitter.error_string_ = m->AddReg(
       absl::StrFormat("__%s_error_str", stream.name),
       m->file()->BitVectorType(kStringSize * 8, SourceInfo()), SourceInfo());
+  if (stream.encoding == TestbenchStreamEncoding::kBinary) {
+    emitter.buffer_ = m->AddReg(
+        absl::StrFormat("__%s_buf", stream.name),
+        m->file()->BitVectorType(BinaryFrameSize(stream) * 8, SourceInfo()),
+        SourceInfo());
+  }
   return emitter;
 }
 
@@ -74,8 +109,12 @@ void VastStreamEmitter::EmitOpen(StatementBlock* block) const {
           block->file()->Make<MacroRef>(SourceInfo(), stream_.path_macro_name),
           block->file()->Make<QuotedString>(
               SourceInfo(),
-              stream_.direction == TestbenchStreamDirection::kInput ? "r"
-                                                                    : "w")});
+              absl::StrCat(
+                  stream_.direction == TestbenchStreamDirection::kInput ? "r"
+                                                                        : "w",
+                  stream_.encoding == TestbenchStreamEncoding::kBinary
+                      ? "b"
+                      : ""))});
   block->Add<BlockingAssignment>(SourceInfo(), file_descriptor_, fopen_call);
   Conditional* conditional = block->Add<Conditional>(
       SourceInfo(),
@@ -100,6 +139,10 @@ void VastStreamEmitter::EmitOpen(StatementBlock* block) const {
 }
 
 void VastStreamEmitter::EmitRead(StatementBlock* block, LogicRef* lhs) const {
+  if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+    EmitBinaryRead(block, lhs);
+    return;
+  }
   // Emit code:
   //
   //   cnt = $fscanf(fd, "%x\n", lhs);
@@ -128,6 +171,10 @@ void VastStreamEmitter::EmitRead(StatementBlock* block, LogicRef* lhs) const {
 
 void VastStreamEmitter::EmitWrite(StatementBlock* block,
                                   Expression* value) const {
+  if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+    EmitBinaryWrite(block, value);
+    return;
+  }
   // Emit code:
   //
   //   $fwriteh(fd, <value>);
@@ -141,6 +188,60 @@ void VastStreamEmitter::EmitWrite(StatementBlock* block,
           block->file()->Make<QuotedString>(SourceInfo(), R"(\n)")});
 }
 
+void VastStreamEmitter::EmitBinaryRead(StatementBlock* block,
+                                       LogicRef* lhs) const {
+  // Emit code:
+  //
+  //   cnt = $fread(buf, fd);
+  //   if (cnt != <frame size>) begin
+  //     $display("FAILED: ...");
+  //     $finish;
+  //   end
+  //   lhs = buf;
+  //
+  // $fread fills `buf` starting with its most significant byte.
+  const int64_t frame_size = BinaryFrameSize(stream_);
+  SystemFunctionCall* call = block->file()->Make<SystemFunctionCall>(
+      SourceInfo(), "fread",
+      std::vector<Expression*>{buffer_, file_descriptor_});
+  block->Add<BlockingAssignment>(SourceInfo(), count_, call);
+  Conditional* conditional = block->Add<Conditional>(
+      SourceInfo(),
+      block->file()->NotEquals(
+          count_, block->file()->PlainLiteral(frame_size, SourceInfo()),
+          SourceInfo()));
+  conditional->consequent()->Add<Display>(
+      SourceInfo(),
+      std::vector<Expression*>{block->file()->Make<QuotedString>(
+          SourceInfo(),
+          absl::StrFormat("FAILED: $fread of file for stream `%s` failed.",
+                          stream_.name))});
+  conditional->consequent()->Add<Finish>(SourceInfo());
+  block->Add<BlockingAssignment>(SourceInfo(), lhs, buffer_);
+}
+
+void VastStreamEmitter::EmitBinaryWrite(StatementBlock* block,
+                                        Expression* value) const {
+  // Emit code:
+  //
+  //   buf = <value>;
+  //   $fwrite(fd, "%c...%c", buf[8n-1:8n-8], ..., buf[7:0]);
+  const int64_t frame_size = BinaryFrameSize(stream_);
+  block->Add<BlockingAssignment>(SourceInfo(), buffer_, value);
+  std::string format;
+  std::vector<Expression*> bytes;
+  for (int64_t i = frame_size - 1; i >= 0; --i) {
+    format += "%c";
+    bytes.push_back(
+        block->file()->Slice(buffer_, 8 * i + 7, 8 * i, SourceInfo()));
+  }
+  std::vector<Expression*> args = {
+      file_descriptor_,
+      block->file()->Make<QuotedString>(SourceInfo(), format)};
+  args.insert(args.end(), bytes.begin(), bytes.end());
+  block->Add<SystemTaskCall>(SourceInfo(), "fwrite", args);
+}
+
 void VastStreamEmitter::EmitClose(StatementBlock* block) const {
   block->Add<SystemTaskCall>(SourceInfo(), "fclose",
                              std::vector<Expression*>{file_descriptor_});
@@ -159,6 +260,10 @@ void TestbenchStreamThread::RunInputStream(
   VLOG(1) << absl::StrFormat("RunInputStream [%s]", stream_.name);
   thread_ = absl::WrapUnique(new Thread([this, producer]() {
     VLOG(1) << absl::StrFormat("Thread for stream `%s` started", stream_.name);
+    if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+      ProduceBinary(producer);
+      return;
+    }
     absl::StatusOr<FileLineWriter> writer =
         FileLineWriter::Create(named_pipe_.path());
     if (!writer.ok()) {
@@ -196,6 +301,10 @@ void TestbenchStreamThread::RunOutputStream(
   VLOG(1) << absl::StrFormat("RunOutputStream [%s]", stream_.name);
   thread_ = absl::WrapUnique(new Thread([this, consumer]() {
     VLOG(1) << absl::StrFormat("Thread for stream `%s` started", stream_.name);
+    if (stream_.encoding == TestbenchStreamEncoding::kBinary) {
+      ConsumeBinary(consumer);
+      return;
+    }
     absl::StatusOr<FileLineReader> reader =
         FileLineReader::Create(named_pipe_.path());
     if (!reader.ok()) {
@@ -255,6 +364,69 @@ void TestbenchStreamThread::RunOutputStream(
   }));
 }
 
+void TestbenchStreamThread::ProduceBinary(Producer producer) {
+  absl::StatusOr<FileStream> file =
+      OpenBinaryStream(named_pipe_.path(), "wb");
+  if (!file.ok()) {
+    LOG(ERROR) << absl::StrFormat("Opening stream `%s` failed: %s",
+                                  stream_.name, file.status().message());
+    MaybeSetError(file.status());
+    return;
+  }
+  std::vector<uint8_t> frame(BinaryFrameSize(stream_));
+  while (std::optional<Bits> bits = producer()) {
+    CHECK_EQ(bits->bit_count(), stream_.width);
+    // ToBytes is least significant byte first.
+    bits->ToBytes(absl::MakeSpan(frame));
+    std::reverse(frame.begin(), frame.end());
+    if (fwrite(frame.data(), frame.size(), 1, file->get()) != 1) {
+      absl::Status status = absl::InternalError(absl::StrFormat(
+          "Writing value to stream `%s` failed", stream_.name));
+      VLOG(1) << status;
+      MaybeSetError(status);
+      return;
+    }
+  }
+  VLOG(1) << absl::StrFormat("Producer returned std::nullopt for stream `%s`",
+                             stream_.name);
+}
+
+void TestbenchStreamThread::ConsumeBinary(Consumer consumer) {
+  absl::StatusOr<FileStream> file =
+      OpenBinaryStream(named_pipe_.path(), "rb");
+  if (!file.ok()) {
+    LOG(ERROR) << absl::StrFormat("Opening stream `%s` failed: %s",
+                                  stream_.name, file.status().message());
+    MaybeSetError(file.status());
+    return;
+  }
+  std::vector<uint8_t> frame(BinaryFrameSize(stream_));
+  while (true) {
+    size_t read = fread(frame.data(), 1, frame.size(), file->get());
+    if (read == 0 && feof(file->get())) {
+      // The other end of the pipe has been closed.
+      VLOG(1) << absl::StrFormat("Stream `%s` has been closed.", stream_.name);
+      return;
+    }
+    if (read != frame.size()) {
+      absl::Status status = absl::InternalError(absl::StrFormat(
+          "Error reading from stream `%s`: got %d of %d bytes of a value",
+          stream_.name, read, frame.size()));
+      LOG(ERROR) << status;
+      MaybeSetError(status);
+      return;
+    }
+    std::reverse(frame.begin(), frame.end());
+    absl::Status result = consumer(Bits::FromBytes(frame, stream_.width));
+    if (!result.ok()) {
+      VLOG(1) << absl::StrFormat(
+          "Consumer for stream `%s` returned an error: %s", stream_.name,
+          result.message());
+      MaybeSetError(result);
+    }
+  }
+}
+
 absl::Status TestbenchStreamThread::Join() {
   thread_->Join();
   return status_;
@@ -37,6 +37,18 @@ namespace verilog {
 // flowing from the testbench.
 enum class TestbenchStreamDirection : int8_t { kInput, kOutput };
 
+// How values are framed on a stream.
+//
+// `kText` writes each value as a line of hex digits, which the testbench reads
+// with $fscanf and writes with $fwriteh. X values written by the testbench are
+// detected and reported as errors.
+//
+// `kBinary` writes each value as ceil(width / 8) bytes, most significant byte
+// first and zero-padded, which the testbench reads with $fread and writes with
+// $fwrite("%c..."). This avoids formatting and parsing hex text on both sides
+// of the pipe, but X bits can't be represented and are written as zeros.
+enum class TestbenchStreamEncoding : int8_t { kText, kBinary };
+
 // An abstraction representing a stream for communicating with Verilog
 // testbench.
 struct TestbenchStream {
@@ -50,6 +62,8 @@ struct TestbenchStream {
 
   // The width of the data to read/write to the testbench.
   int64_t width;
+
+  TestbenchStreamEncoding encoding = TestbenchStreamEncoding::kText;
 };
 
 // Class for emitting VAST code for reading and writing values to streams.
@@ -72,6 +86,9 @@ class VastStreamEmitter {
  private:
   explicit VastStreamEmitter(const TestbenchStream& stream) : stream_(stream) {}
 
+  void EmitBinaryRead(StatementBlock* block, LogicRef* lhs) const;
+  void EmitBinaryWrite(StatementBlock* block, Expression* value) const;
+
   const TestbenchStream& stream_;
 
   // References to declared variables.
@@ -79,6 +96,8 @@ class VastStreamEmitter {
   LogicRef* count_;
   LogicRef* errno_;
   LogicRef* error_string_;
+  // A byte-aligned staging register for binary streams.
+  LogicRef* buffer_ = nullptr;
 };
 
 // A wrapper around a thread which read/writes data via a stream to/from a
@@ -121,6 +140,10 @@ class TestbenchStreamThread {
   // an error code.
   void MaybeSetError(const absl::Status& status);
 
+  // The bodies of the threads for binary streams.
+  void ProduceBinary(Producer producer);
+  void ConsumeBinary(Consumer consumer);
+
   const TestbenchStream& stream_;
   NamedPipe named_pipe_;
   std::unique_ptr<Thread> thread_;
@@ -18,6 +18,7 @@
 
 // TODO(rspringer): No array support yet. Should be pretty trivial to add.
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <iostream>
 #include <optional>
@@ -25,6 +26,7 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
@@ -41,11 +43,16 @@ ABSL_FLAG(
     "will be made to try to find the package's entry function. "
     "If that fails, an error will be returned.");
 ABSL_FLAG(std::string, ir_path, "", "Path to the XLS IR to process.");
+ABSL_FLAG(int64_t, min_alias_size, 10,
+          "Subterms of at least this size which are shared in the translated "
+          "function are emitted once as let-bindings rather than repeated at "
+          "each use.");
 
 namespace xls {
 
 static absl::Status RealMain(const std::filesystem::path& ir_path,
-                             std::optional<std::string> top) {
+                             std::optional<std::string> top,
+                             int64_t min_alias_size) {
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
   Function* function;
@@ -55,6 +62,11 @@ static absl::Status RealMain(const std::filesystem::path& ir_path,
     XLS_ASSIGN_OR_RETURN(function, package->GetFunction(top.value()));
   }
 
+  // The SMT2 printer let-binds shared subterms (as `a!N`); since the
+  // translator reuses the terms of structurally identical nodes, this keeps
+  // the output linear in the size of the function rather than of its tree.
+  Z3_global_param_set("pp.min_alias_size",
+                      absl::StrCat(min_alias_size).c_str());
   XLS_ASSIGN_OR_RETURN(auto translator,
                        solvers::z3::IrTranslator::CreateAndTranslate(function));
   Z3_set_ast_print_mode(translator->ctx(), Z3_PRINT_SMTLIB2_COMPLIANT);
@@ -72,5 +84,6 @@ int main(int argc, char* argv[]) {
   if (!absl::GetFlag(FLAGS_top).empty()) {
     top = absl::GetFlag(FLAGS_top);
   }
-  return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_ir_path), top));
+  return xls::ExitStatus(xls::RealMain(absl::GetFlag(FLAGS_ir_path), top,
+                                         absl::GetFlag(FLAGS_min_alias_size)));
 }
@@ -14,22 +14,33 @@
 
 #include "xls/solvers/z3_ir_equivalence.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/common/visitor.h"
+#include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
 #include "xls/ir/node.h"
@@ -38,19 +49,21 @@
 #include "xls/ir/package.h"
 #include "xls/ir/source_location.h"
 #include "xls/ir/topo_sort.h"
+#include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/ir/value_utils.h"
+#include "xls/passes/node_dependency_analysis.h"
 #include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_op_translator.h"
+#include "xls/solvers/z3_portfolio.h"
+#include "xls/solvers/z3_utils.h"
+#include "z3/src/api/z3.h"  // IWYU pragma: keep
+#include "z3/src/api/z3_api.h"
 
 namespace xls::solvers::z3 {
+namespace {
 
-absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
-                                                 absl::Duration timeout) {
-  std::unique_ptr<Package> to_test = std::make_unique<Package>(
-      absl::StrFormat("%s_tester", a->package()->name()));
-  XLS_ASSIGN_OR_RETURN(
-      Function * to_test_func,
-      a->Clone(absl::StrFormat("%s_test", a->name()), to_test.get()));
-
+absl::Status CheckSameSignature(Function* a, Function* b) {
   XLS_RET_CHECK(
       a->return_value()->GetType()->IsEqualTo(b->return_value()->GetType()))
       << a->return_value()->GetType() << " vs " << b->return_value()->GetType();
@@ -59,16 +72,28 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
     XLS_RET_CHECK(
         a->params()[i]->GetType()->IsEqualTo(b->params()[i]->GetType()));
   }
+  return absl::OkStatus();
+}
+
+std::vector<int64_t> NodeKey(Node* node, absl::Span<Node* const> operands) {
+  std::vector<int64_t> key;
+  key.reserve(operands.size() + 1);
+  key.push_back(static_cast<int64_t>(node->op()));
+  for (Node* operand : operands) {
+    key.push_back(operand->id());
+  }
+  return key;
+}
 
-  // Patch b into to_test. Wire up parameters to those at the same index in the
-  // to_test_function.  We do this so we can test whether the two functions are
-  // semantically equivalent by making a single Z3-AST function and checking a
-  // single eq node's value.
+// Clones `b` into `f`, wiring up the parameters of `b` to those at the same
+// index in `f`. Returns the map from the nodes of `b` to their clones.
+absl::StatusOr<absl::flat_hash_map<Node*, Node*>> PatchIn(Function* b,
+                                                          Function* f) {
   absl::flat_hash_map<Node*, Node*> node_map;
   for (Node* n : TopoSort(b)) {
     if (n->Is<Param>()) {
       XLS_ASSIGN_OR_RETURN(int64_t index, b->GetParamIndex(n->As<Param>()));
-      node_map[n] = to_test_func->param(index);
+      node_map[n] = f->param(index);
       continue;
     }
     std::vector<Node*> new_ops;
@@ -76,9 +101,137 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
     for (Node* op : n->operands()) {
       new_ops.push_back(node_map[op]);
     }
-    XLS_ASSIGN_OR_RETURN(node_map[n],
-                         n->CloneInNewFunction(new_ops, to_test_func));
+    XLS_ASSIGN_OR_RETURN(node_map[n], n->CloneInNewFunction(new_ops, f));
   }
+  return node_map;
+}
+
+// One slice of the output bits checked by TryProveEquivalencePartitioned.
+struct OutputPartition {
+  // Human-readable description of the slice, e.g., "bits [0, 8) of output.1".
+  std::string description;
+  // Node of the checked function which is one iff the slices of the two
+  // outputs differ.
+  Node* mismatch;
+};
+
+// Adds to `f` a mismatch node for each slice of at most `bits_per_partition`
+// bits of the leaves of `a_value` and `b_value`, which must have the same
+// type. Token leaves are skipped since they carry no value.
+absl::Status AddOutputPartitions(Function* f, Node* a_value, Node* b_value,
+                                 std::string_view path,
+                                 int64_t bits_per_partition,
+                                 std::vector<OutputPartition>& partitions) {
+  Type* type = a_value->GetType();
+  if (type->IsTuple()) {
+    for (int64_t i = 0; i < type->AsTupleOrDie()->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(Node * a_element,
+                           f->MakeNode<TupleIndex>(SourceInfo(), a_value, i));
+      XLS_ASSIGN_OR_RETURN(Node * b_element,
+                           f->MakeNode<TupleIndex>(SourceInfo(), b_value, i));
+      XLS_RETURN_IF_ERROR(AddOutputPartitions(
+          f, a_element, b_element, absl::StrCat(path, ".", i),
+          bits_per_partition, partitions));
+    }
+    return absl::OkStatus();
+  }
+  if (type->IsArray()) {
+    for (int64_t i = 0; i < type->AsArrayOrDie()->size(); ++i) {
+      XLS_ASSIGN_OR_RETURN(
+          Node * index,
+          f->MakeNode<Literal>(SourceInfo(), Value(UBits(i, 64))));
+      XLS_ASSIGN_OR_RETURN(
+          Node * a_element,
+          f->MakeNode<ArrayIndex>(SourceInfo(), a_value,
+                                  absl::Span<Node* const>{index}));
+      XLS_ASSIGN_OR_RETURN(
+          Node * b_element,
+          f->MakeNode<ArrayIndex>(SourceInfo(), b_value,
+                                  absl::Span<Node* const>{index}));
+      XLS_RETURN_IF_ERROR(AddOutputPartitions(
+          f, a_element, b_element, absl::StrCat(path, "[", i, "]"),
+          bits_per_partition, partitions));
+    }
+    return absl::OkStatus();
+  }
+  if (type->IsToken()) {
+    return absl::OkStatus();
+  }
+  XLS_RET_CHECK(type->IsBits());
+  int64_t width = type->GetFlatBitCount();
+  for (int64_t start = 0; start < width; start += bits_per_partition) {
+    int64_t slice_width = std::min(bits_per_partition, width - start);
+    XLS_ASSIGN_OR_RETURN(
+        Node * a_slice,
+        f->MakeNode<BitSlice>(SourceInfo(), a_value, start, slice_width));
+    XLS_ASSIGN_OR_RETURN(
+        Node * b_slice,
+        f->MakeNode<BitSlice>(SourceInfo(), b_value, start, slice_width));
+    XLS_ASSIGN_OR_RETURN(
+        Node * mismatch,
+        f->MakeNode<CompareOp>(SourceInfo(), a_slice, b_slice, Op::kNe));
+    partitions.push_back(OutputPartition{
+        .description = absl::StrFormat("bits [%d, %d) of %s", start,
+                                       start + slice_width, path),
+        .mismatch = mismatch});
+  }
+  return absl::OkStatus();
+}
+
+// Extracts the cone of influence of `partition` (per `cones`) from `f` into a
+// new function in `package` which has all the params of `f` and returns the
+// partition's mismatch node.
+absl::StatusOr<Function*> ExtractCone(Function* f,
+                                      const OutputPartition& partition,
+                                      const NodeDependencyAnalysis& cones,
+                                      Package* package) {
+  XLS_ASSIGN_OR_RETURN(DependencyBitmap cone,
+                       cones.GetDependents(partition.mismatch));
+  Function* extracted = package->AddFunction(
+      std::make_unique<Function>(absl::StrCat(f->name(), "_cone"), package));
+  absl::flat_hash_map<Node*, Node*> node_map;
+  for (Param* param : f->params()) {
+    XLS_ASSIGN_OR_RETURN(node_map[param],
+                         param->CloneInNewFunction({}, extracted));
+  }
+  for (Node* node : TopoSort(f)) {
+    if (node->Is<Param>()) {
+      continue;
+    }
+    XLS_ASSIGN_OR_RETURN(bool in_cone, cone.IsDependent(node));
+    if (!in_cone) {
+      continue;
+    }
+    std::vector<Node*> new_operands;
+    new_operands.reserve(node->operand_count());
+    for (Node* operand : node->operands()) {
+      new_operands.push_back(node_map.at(operand));
+    }
+    XLS_ASSIGN_OR_RETURN(node_map[node],
+                         node->CloneInNewFunction(new_operands, extracted));
+  }
+  XLS_RETURN_IF_ERROR(
+      extracted->set_return_value(node_map.at(partition.mismatch)));
+  return extracted;
+}
+
+}  // namespace
+
+absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
+                                                 absl::Duration timeout) {
+  std::unique_ptr<Package> to_test = std::make_unique<Package>(
+      absl::StrFormat("%s_tester", a->package()->name()));
+  XLS_ASSIGN_OR_RETURN(
+      Function * to_test_func,
+      a->Clone(absl::StrFormat("%s_test", a->name()), to_test.get()));
+
+  XLS_RETURN_IF_ERROR(CheckSameSignature(a, b));
+
+  // Patch b into to_test. We do this so we can test whether the two functions
+  // are semantically equivalent by making a single Z3-AST function and checking
+  // a single eq node's value.
+  XLS_ASSIGN_OR_RETURN((absl::flat_hash_map<Node*, Node*> node_map),
+                       PatchIn(b, to_test_func));
 
   // Add check
 
@@ -120,6 +273,160 @@ absl::StatusOr<ProverResult> TryProveEquivalence(Function* a, Function* b,
       std::move(base_result));
 }
 
+absl::StatusOr<ProverResult> TryProveEquivalencePortfolio(
+    Function* a, Function* b, absl::Duration timeout,
+    std::vector<PortfolioStrategyResult>* strategy_results) {
+  XLS_RETURN_IF_ERROR(CheckSameSignature(a, b));
+  Type* return_type = a->return_value()->GetType();
+  if (TypeHasToken(return_type)) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cannot check equivalence of functions returning %s with a portfolio",
+        return_type->ToString()));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> a_translator,
+                       IrTranslator::CreateAndTranslate(a));
+  Z3_context ctx = a_translator->ctx();
+  std::vector<Z3_ast> params;
+  for (Param* param : a->params()) {
+    params.push_back(a_translator->GetTranslation(param));
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> b_translator,
+                       IrTranslator::CreateAndTranslate(ctx, b, params));
+  std::vector<Z3_ast> a_bits =
+      a_translator->FlattenValue(return_type, a_translator->GetReturnNode());
+  std::vector<Z3_ast> b_bits =
+      b_translator->FlattenValue(return_type, b_translator->GetReturnNode());
+  XLS_RET_CHECK_EQ(a_bits.size(), b_bits.size());
+  std::vector<Z3_ast> mismatches;
+  mismatches.reserve(a_bits.size());
+  for (int64_t i = 0; i < a_bits.size(); ++i) {
+    mismatches.push_back(Z3_mk_not(ctx, Z3_mk_eq(ctx, a_bits[i], b_bits[i])));
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      PortfolioResult result,
+      CheckSatPortfolio(ctx, /*constraints=*/{}, mismatches, timeout));
+  auto cleanup = absl::Cleanup([&] {
+    if (result.model.has_value()) {
+      Z3_model_dec_ref(ctx, *result.model);
+    }
+  });
+  if (strategy_results != nullptr) {
+    *strategy_results = result.strategy_results;
+  }
+  switch (result.result) {
+    case Z3_L_FALSE:
+      return ProvenTrue();
+    case Z3_L_TRUE: {
+      XLS_RET_CHECK(result.model.has_value());
+      absl::StatusOr<absl::flat_hash_map<const Param*, Value>> counterexample =
+          absl::flat_hash_map<const Param*, Value>();
+      for (int64_t i = 0; i < a->params().size(); ++i) {
+        absl::StatusOr<Value> value = NodeValue(
+            ctx, *result.model, params[i], a->param(i)->GetType());
+        if (!value.ok()) {
+          counterexample = std::move(value).status();
+          break;
+        }
+        counterexample->emplace(a->param(i), *std::move(value));
+      }
+      return ProvenFalse{
+          .counterexample = std::move(counterexample),
+          .message = SolverResultToString(ctx, *result.model, Z3_L_TRUE),
+      };
+    }
+    case Z3_L_UNDEF:
+      return absl::DeadlineExceededError(
+          "No portfolio strategy proved or disproved equivalence");
+  }
+  return absl::InternalError(
+      absl::StrCat("Invalid Z3 result: ", result.result));
+}
+
+absl::StatusOr<ProverResult> TryProveEquivalencePartitioned(
+    Function* a, Function* b, int64_t bits_per_partition,
+    ThreadPool& thread_pool, absl::Duration timeout) {
+  XLS_RET_CHECK_GT(bits_per_partition, 0);
+  XLS_RETURN_IF_ERROR(CheckSameSignature(a, b));
+  Package miter_package(absl::StrFormat("%s_tester", a->package()->name()));
+  XLS_ASSIGN_OR_RETURN(
+      Function * miter,
+      a->Clone(absl::StrFormat("%s_test", a->name()), &miter_package));
+  XLS_ASSIGN_OR_RETURN((absl::flat_hash_map<Node*, Node*> node_map),
+                       PatchIn(b, miter));
+  std::vector<OutputPartition> partitions;
+  XLS_RETURN_IF_ERROR(AddOutputPartitions(
+      miter, miter->return_value(), node_map.at(b->return_value()), "output",
+      bits_per_partition, partitions));
+  std::vector<Node*> mismatches;
+  mismatches.reserve(partitions.size());
+  for (const OutputPartition& partition : partitions) {
+    mismatches.push_back(partition.mismatch);
+  }
+  NodeDependencyAnalysis cones =
+      NodeDependencyAnalysis::BackwardDependents(miter, mismatches);
+
+  // Extract the cones serially, each into its own package, so the provers
+  // running concurrently share no mutable IR.
+  std::vector<std::unique_ptr<Package>> packages;
+  std::vector<Function*> extracted;
+  packages.reserve(partitions.size());
+  extracted.reserve(partitions.size());
+  for (int64_t i = 0; i < partitions.size(); ++i) {
+    packages.push_back(std::make_unique<Package>(
+        absl::StrFormat("%s_partition_%d", miter_package.name(), i)));
+    XLS_ASSIGN_OR_RETURN(
+        Function * cone,
+        ExtractCone(miter, partitions[i], cones, packages.back().get()));
+    extracted.push_back(cone);
+  }
+
+  std::vector<std::optional<absl::StatusOr<ProverResult>>> results(
+      partitions.size());
+  // Once any partition is disproven the whole check is, so partitions which
+  // have not started yet are skipped.
+  std::atomic<bool> disproven = false;
+  thread_pool.ParallelFor(partitions.size(), /*grain=*/1, [&](int64_t i) {
+    if (disproven.load(std::memory_order_relaxed)) {
+      return;
+    }
+    Function* f = extracted[i];
+    results[i] =
+        TryProve(f, f->return_value(), Predicate::EqualToZero(), timeout);
+    if (results[i]->ok() && std::holds_alternative<ProvenFalse>(**results[i])) {
+      disproven.store(true, std::memory_order_relaxed);
+    }
+  });
+
+  for (int64_t i = 0; i < partitions.size(); ++i) {
+    if (!results[i].has_value() || !results[i]->ok() ||
+        !std::holds_alternative<ProvenFalse>(**results[i])) {
+      continue;
+    }
+    ProvenFalse f = std::get<ProvenFalse>(**std::move(results[i]));
+    VLOG(1) << "Counterexample found for " << partitions[i].description;
+    f.message = absl::StrCat(partitions[i].description, " differ: ", f.message);
+    if (f.counterexample.ok()) {
+      // Params of `a` which the solver left unconstrained don't affect the
+      // result, so any value completes the assignment.
+      absl::flat_hash_map<const Param*, Value> full_counterexample;
+      for (int64_t p = 0; p < a->params().size(); ++p) {
+        auto it = f.counterexample->find(extracted[i]->param(p));
+        full_counterexample[a->param(p)] =
+            it == f.counterexample->end() ? ZeroOfType(a->param(p)->GetType())
+                                          : it->second;
+      }
+      f.counterexample = std::move(full_counterexample);
+    }
+    return f;
+  }
+  for (std::optional<absl::StatusOr<ProverResult>>& result : results) {
+    XLS_RET_CHECK(result.has_value());
+    XLS_RETURN_IF_ERROR(result->status());
+  }
+  return ProvenTrue();
+}
+
 absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* original,
     const std::function<absl::Status(Package*, Function*)>& run_pass,
@@ -135,4 +442,125 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
   return TryProveEquivalence(original, to_transform_func, timeout);
 }
 
+/* static */ absl::StatusOr<std::unique_ptr<EquivalenceSession>>
+EquivalenceSession::Create(Function* base, absl::Duration timeout) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> translator,
+                       IrTranslator::CreateAndTranslate(base));
+  translator->SetTimeout(timeout);
+  return absl::WrapUnique(new EquivalenceSession(base, std::move(translator)));
+}
+
+EquivalenceSession::EquivalenceSession(Function* base,
+                                       std::unique_ptr<IrTranslator> translator)
+    : base_(base),
+      translator_(std::move(translator)),
+      solver_(CreateSolver(translator_->ctx(), /*num_threads=*/1)) {
+  for (Param* param : base_->params()) {
+    params_.push_back(translator_->GetTranslation(param));
+  }
+  for (Node* node : base_->nodes()) {
+    if (!node->Is<Param>()) {
+      base_nodes_[NodeKey(node, node->operands())].push_back(node);
+    }
+  }
+}
+
+EquivalenceSession::~EquivalenceSession() {
+  Z3_solver_dec_ref(translator_->ctx(), solver_);
+}
+
+absl::StatusOr<absl::flat_hash_map<Node*, Node*>>
+EquivalenceSession::MatchBaseNodes(Function* version) const {
+  absl::flat_hash_map<Node*, Node*> matches;
+  std::vector<Node*> base_operands;
+  for (Node* node : TopoSort(version)) {
+    if (node->Is<Param>()) {
+      XLS_ASSIGN_OR_RETURN(int64_t index,
+                           version->GetParamIndex(node->As<Param>()));
+      matches[node] = base_->param(index);
+      continue;
+    }
+    base_operands.clear();
+    for (Node* operand : node->operands()) {
+      auto it = matches.find(operand);
+      if (it == matches.end()) {
+        break;
+      }
+      base_operands.push_back(it->second);
+    }
+    if (base_operands.size() != node->operand_count()) {
+      continue;
+    }
+    auto it = base_nodes_.find(NodeKey(node, base_operands));
+    if (it == base_nodes_.end()) {
+      continue;
+    }
+    for (Node* candidate : it->second) {
+      if (node->IsDefinitelyEqualTo(candidate)) {
+        matches[node] = candidate;
+        break;
+      }
+    }
+  }
+  return matches;
+}
+
+absl::StatusOr<ProverResult> EquivalenceSession::TryProveEquivalence(
+    Function* version) {
+  XLS_RETURN_IF_ERROR(CheckSameSignature(base_, version));
+  XLS_ASSIGN_OR_RETURN(auto matches, MatchBaseNodes(version));
+  absl::flat_hash_map<Node*, Z3_ast> known_translations;
+  for (const auto& [node, base_node] : matches) {
+    known_translations[node] = translator_->GetTranslation(base_node);
+  }
+  last_reused_node_count_ = matches.size();
+  last_translated_node_count_ = version->node_count() - matches.size();
+  VLOG(1) << absl::StreamFormat(
+      "Equivalence session: %s reuses %d node translations of %s and "
+      "translates %d nodes",
+      version->name(), last_reused_node_count_, base_->name(),
+      last_translated_node_count_);
+
+  Z3_context ctx = translator_->ctx();
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<IrTranslator> version_translator,
+                       IrTranslator::CreateAndTranslate(
+                           ctx, version, params_, known_translations));
+  XLS_ASSIGN_OR_RETURN(
+      Z3_ast ne, translator_->TranslateNe(translator_->GetReturnNode(),
+                                          version_translator->GetReturnNode(),
+                                          base_->return_value()->GetType()));
+
+  Z3_solver_push(ctx, solver_);
+  auto pop = absl::Cleanup([&] { Z3_solver_pop(ctx, solver_, 1); });
+  Z3_solver_assert(ctx, solver_, Z3OpTranslator(ctx).NeZeroBool(ne));
+  Z3_lbool satisfiable = Z3_solver_check(ctx, solver_);
+  VLOG(1) << SolverResultToString(ctx, solver_, satisfiable);
+  switch (satisfiable) {
+    case Z3_L_FALSE:
+      return ProvenTrue();
+    case Z3_L_TRUE: {
+      absl::StatusOr<absl::flat_hash_map<const Param*, Value>> counterexample =
+          absl::flat_hash_map<const Param*, Value>();
+      Z3_model model = Z3_solver_get_model(ctx, solver_);
+      for (int64_t i = 0; i < base_->params().size(); ++i) {
+        Param* param = base_->param(i);
+        absl::StatusOr<Value> value =
+            NodeValue(ctx, model, params_[i], param->GetType());
+        if (!value.ok()) {
+          counterexample = std::move(value).status();
+          break;
+        }
+        counterexample->emplace(param, *std::move(value));
+      }
+      return ProvenFalse{
+          .counterexample = std::move(counterexample),
+          .message = SolverResultToString(ctx, solver_, satisfiable),
+      };
+    }
+    case Z3_L_UNDEF:
+      return absl::DeadlineExceededError("Z3 solver timed out");
+  }
+  return absl::InternalError(absl::StrCat("Invalid Z3 result: ", satisfiable));
+}
+
 }  // namespace xls::solvers::z3
@@ -15,14 +15,23 @@
 #ifndef XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 #define XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/function.h"
+#include "xls/ir/node.h"
 #include "xls/ir/package.h"
 #include "xls/solvers/z3_ir_translator.h"
+#include "xls/solvers/z3_portfolio.h"
+#include "z3/src/api/z3.h"  // IWYU pragma: keep
+#include "z3/src/api/z3_api.h"
 
 namespace xls::solvers::z3 {
 
@@ -50,6 +59,79 @@ absl::StatusOr<ProverResult> TryProveEquivalence(
     Function* a, Function* b,
     absl::Duration timeout = absl::InfiniteDuration());
 
+// As above, but races the strategies of a solver portfolio (see
+// z3_portfolio.h) in parallel threads and returns the first definitive answer.
+// If `strategy_results` is non-null it is set to how each strategy fared. The
+// return type of the functions must not contain tokens.
+absl::StatusOr<ProverResult> TryProveEquivalencePortfolio(
+    Function* a, Function* b, absl::Duration timeout = absl::InfiniteDuration(),
+    std::vector<PortfolioStrategyResult>* strategy_results = nullptr);
+
+// As above, but splits the (flattened) outputs into slices of at most
+// `bits_per_partition` bits and proves each slice equivalent separately, on
+// `thread_pool`. Each query only contains the slice's cone of influence, which
+// is often much cheaper to solve than one query over the whole output. A
+// counterexample for any slice is a counterexample for the functions; it is
+// returned as a full assignment of the params of `a`. `timeout` applies to
+// each slice.
+absl::StatusOr<ProverResult> TryProveEquivalencePartitioned(
+    Function* a, Function* b, int64_t bits_per_partition,
+    ThreadPool& thread_pool, absl::Duration timeout = absl::InfiniteDuration());
+
+// Checks many versions of one function against it, e.g., the output of each
+// pass of a pipeline against the pipeline's input, sharing one Z3 context and
+// solver across the queries. The base function is translated once, up front.
+// Each version only translates the nodes which do not compute exactly the
+// same expression as a node of the base function (the cone of logic changed
+// by the transformation); the rest reuse the base's translation. Each query
+// is solved within its own push/pop scope, so the solver can carry what it
+// has learned about the base function over to later queries.
+//
+// The base function must outlive the session and must not be modified while
+// the session is in use.
+class EquivalenceSession {
+ public:
+  static absl::StatusOr<std::unique_ptr<EquivalenceSession>> Create(
+      Function* base, absl::Duration timeout = absl::InfiniteDuration());
+
+  EquivalenceSession(const EquivalenceSession&) = delete;
+  EquivalenceSession& operator=(const EquivalenceSession&) = delete;
+  ~EquivalenceSession();
+
+  // Verify that `version` has the same behavior as the base function. Both
+  // functions must have exactly the same types. Counterexamples refer to the
+  // params of the base function.
+  absl::StatusOr<ProverResult> TryProveEquivalence(Function* version);
+
+  Function* base() const { return base_; }
+
+  // Over the most recent query, the number of nodes of the version which
+  // reused the translation of a base node and the number which had to be
+  // translated.
+  int64_t last_reused_node_count() const { return last_reused_node_count_; }
+  int64_t last_translated_node_count() const {
+    return last_translated_node_count_;
+  }
+
+ private:
+  EquivalenceSession(Function* base, std::unique_ptr<IrTranslator> translator);
+
+  // Maps each node of `version` which computes exactly the same expression as
+  // some base node, i.e., has an equivalent op whose operands map to the
+  // operands of the base node, to that base node.
+  absl::StatusOr<absl::flat_hash_map<Node*, Node*>> MatchBaseNodes(
+      Function* version) const;
+
+  Function* base_;
+  std::unique_ptr<IrTranslator> translator_;
+  Z3_solver solver_;
+  std::vector<Z3_ast> params_;
+  // Base nodes keyed by their op followed by the ids of their operands.
+  absl::flat_hash_map<std::vector<int64_t>, std::vector<Node*>> base_nodes_;
+  int64_t last_reused_node_count_ = 0;
+  int64_t last_translated_node_count_ = 0;
+};
+
 }  // namespace xls::solvers::z3
 
 #endif  // XLS_SOLVERS_Z3_IR_EQUIVALENCE_H_
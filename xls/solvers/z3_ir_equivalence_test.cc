@@ -15,8 +15,11 @@
 #include "xls/solvers/z3_ir_equivalence.h"
 
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <string_view>
+#include <variant>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest-spi.h"
@@ -25,8 +28,10 @@
 #include "absl/status/status_matchers.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/function.h"
 #include "xls/ir/function_builder.h"
@@ -34,12 +39,14 @@
 #include "xls/ir/ir_test_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/package.h"
 #include "xls/ir/topo_sort.h"
 #include "xls/ir/value.h"
 #include "xls/solvers/z3_ir_equivalence_testutils.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_ir_translator_matchers.h"
+#include "xls/solvers/z3_portfolio.h"
 
 namespace m = xls::op_matchers;
 namespace xls::solvers::z3 {
@@ -47,8 +54,10 @@ namespace {
 
 using ::absl_testing::IsOk;
 using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
 
 using ::testing::AnyOf;
+using ::testing::HasSubstr;
 using ::testing::Not;
 using ::testing::Pair;
 using ::testing::UnorderedElementsAre;
@@ -390,5 +399,146 @@ TEST_F(EquivalenceTest, MultiFunctionDetectsDifference) {
   EXPECT_THAT(TryProveEquivalence(f1, f2), IsOkAndHolds(IsProvenFalse()));
 }
 
+TEST_F(EquivalenceTest, PortfolioDetectsSameAndDifferent) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  fb.Tuple({fb.UMul(x, y), fb.Add(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  FunctionBuilder same_fb(absl::StrCat(TestName(), "_same"), p.get());
+  BValue same_x = same_fb.Param("x", p->GetBitsType(8));
+  BValue same_y = same_fb.Param("y", p->GetBitsType(8));
+  same_fb.Tuple({same_fb.UMul(same_y, same_x), same_fb.Add(same_y, same_x)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * same, same_fb.Build());
+
+  FunctionBuilder different_fb(absl::StrCat(TestName(), "_different"),
+                               p.get());
+  BValue different_x = different_fb.Param("x", p->GetBitsType(8));
+  BValue different_y = different_fb.Param("y", p->GetBitsType(8));
+  different_fb.Tuple({different_fb.UMul(different_x, different_y),
+                      different_fb.Subtract(different_x, different_y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * different, different_fb.Build());
+
+  std::vector<PortfolioStrategyResult> strategy_results;
+  EXPECT_THAT(TryProveEquivalencePortfolio(f, same, absl::InfiniteDuration(),
+                                           &strategy_results),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(strategy_results.size(), std::size(kAllPortfolioStrategies));
+  XLS_ASSERT_OK_AND_ASSIGN(ProverResult r,
+                           TryProveEquivalencePortfolio(f, different));
+  ASSERT_THAT(r, IsProvenFalse());
+  EXPECT_THAT(
+      std::get<ProvenFalse>(r).counterexample,
+      IsOkAndHolds(UnorderedElementsAre(Pair(f->param(0), testing::_),
+                                        Pair(f->param(1), testing::_))));
+}
+
+TEST_F(EquivalenceTest, PartitionedDetectsSameAndDifferent) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(8));
+  BValue y = fb.Param("y", p->GetBitsType(8));
+  BValue z = fb.Param("z", p->GetBitsType(8));
+  fb.Tuple({fb.UMul(x, y), fb.Array({fb.Add(x, y), z}, p->GetBitsType(8))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+
+  FunctionBuilder same_fb(absl::StrCat(TestName(), "_same"), p.get());
+  BValue same_x = same_fb.Param("x", p->GetBitsType(8));
+  BValue same_y = same_fb.Param("y", p->GetBitsType(8));
+  BValue same_z = same_fb.Param("z", p->GetBitsType(8));
+  same_fb.Tuple({same_fb.UMul(same_y, same_x),
+                 same_fb.Array({same_fb.Add(same_y, same_x), same_z},
+                               p->GetBitsType(8))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * same, same_fb.Build());
+
+  // Only the high bits of the first array element can differ.
+  FunctionBuilder different_fb(absl::StrCat(TestName(), "_different"),
+                               p.get());
+  BValue different_x = different_fb.Param("x", p->GetBitsType(8));
+  BValue different_y = different_fb.Param("y", p->GetBitsType(8));
+  BValue different_z = different_fb.Param("z", p->GetBitsType(8));
+  BValue sum = different_fb.Add(different_x, different_y);
+  different_fb.Tuple(
+      {different_fb.UMul(different_x, different_y),
+       different_fb.Array(
+           {different_fb.Concat({different_fb.Not(different_fb.BitSlice(
+                                     sum, /*start=*/4, /*width=*/4)),
+                                 different_fb.BitSlice(sum, /*start=*/0,
+                                                       /*width=*/4)}),
+            different_z},
+           p->GetBitsType(8))});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * different, different_fb.Build());
+
+  ThreadPool thread_pool(4);
+  EXPECT_THAT(TryProveEquivalencePartitioned(f, same, /*bits_per_partition=*/4,
+                                             thread_pool),
+              IsOkAndHolds(IsProvenTrue()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProverResult r,
+      TryProveEquivalencePartitioned(f, different, /*bits_per_partition=*/4,
+                                     thread_pool));
+  ASSERT_THAT(r, IsProvenFalse());
+  EXPECT_THAT(std::get<ProvenFalse>(r).message,
+              HasSubstr("bits [4, 8) of output.1[0]"));
+  // `z` is not in the cone of the mismatch but is still assigned.
+  EXPECT_THAT(
+      std::get<ProvenFalse>(r).counterexample,
+      IsOkAndHolds(UnorderedElementsAre(Pair(f->param(0), testing::_),
+                                        Pair(f->param(1), testing::_),
+                                        Pair(f->param(2), testing::_))));
+  EXPECT_THAT(TryProveEquivalencePartitioned(f, same, /*bits_per_partition=*/0,
+                                             thread_pool),
+              StatusIs(absl::StatusCode::kInternal));
+}
+
+TEST_F(EquivalenceTest, SessionChecksManyVersions) {
+  std::unique_ptr<Package> p = CreatePackage();
+  FunctionBuilder fb(TestName(), p.get());
+  BValue x = fb.Param("x", p->GetBitsType(32));
+  BValue y = fb.Param("y", p->GetBitsType(32));
+  fb.Tuple({fb.Add(x, y), fb.UMul(x, y)});
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.Build());
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<EquivalenceSession> session,
+                           EquivalenceSession::Create(f));
+
+  // Commute the add; only it and the tuple using it need translating.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * commuted, f->Clone("commuted"));
+  for (Node* n : TopoSort(commuted)) {
+    if (n->op() == Op::kAdd) {
+      XLS_ASSERT_OK(
+          n->ReplaceUsesWithNew<BinOp>(n->operand(1), n->operand(0), n->op())
+              .status());
+    }
+  }
+  EXPECT_THAT(session->TryProveEquivalence(commuted),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(session->last_translated_node_count(), 2);
+
+  // Turn the add into a subtract.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * subtracted, f->Clone("subtracted"));
+  for (Node* n : TopoSort(subtracted)) {
+    if (n->op() == Op::kAdd) {
+      XLS_ASSERT_OK(n->ReplaceUsesWithNew<BinOp>(n->operand(0), n->operand(1),
+                                                 Op::kSub)
+                        .status());
+    }
+  }
+  XLS_ASSERT_OK_AND_ASSIGN(ProverResult r,
+                           session->TryProveEquivalence(subtracted));
+  ASSERT_THAT(r, IsProvenFalse());
+  EXPECT_THAT(
+      std::get<ProvenFalse>(r).counterexample,
+      IsOkAndHolds(UnorderedElementsAre(Pair(f->param(0), testing::_),
+                                        Pair(f->param(1), testing::_))));
+
+  // The failed query must not leak into later ones.
+  XLS_ASSERT_OK_AND_ASSIGN(Function * copy, f->Clone("copy"));
+  EXPECT_THAT(session->TryProveEquivalence(copy),
+              IsOkAndHolds(IsProvenTrue()));
+  EXPECT_EQ(session->last_translated_node_count(), 0);
+}
+
 }  // namespace
 }  // namespace xls::solvers::z3
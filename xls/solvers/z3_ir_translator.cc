@@ -15,6 +15,7 @@
 #include "xls/solvers/z3_ir_translator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <iterator>
@@ -35,10 +36,12 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/data_structures/leaf_type_tree.h"
 #include "xls/ir/abstract_evaluator.h"
 #include "xls/ir/abstract_node_evaluator.h"
@@ -217,6 +220,29 @@ absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
   return translator;
 }
 
+absl::StatusOr<std::unique_ptr<IrTranslator>> IrTranslator::CreateAndTranslate(
+    Z3_context ctx, FunctionBase* function_base,
+    absl::Span<const Z3_ast> imported_params,
+    const absl::flat_hash_map<Node*, Z3_ast>& known_translations,
+    bool allow_unsupported) {
+  auto translator =
+      absl::WrapUnique(new IrTranslator(ctx, function_base, imported_params));
+  translator->allow_unsupported_ = allow_unsupported;
+  XLS_RET_CHECK(!function_base->IsBlock());
+  for (const auto& [node, translation] : known_translations) {
+    XLS_RET_CHECK_EQ(node->function_base(), function_base);
+    translator->translations_[node] = translation;
+    translator->MarkVisited(node);
+  }
+  // Not FunctionBase::Accept, which expects every node to be visited.
+  for (Node* node : function_base->nodes()) {
+    if (node->users().empty()) {
+      XLS_RETURN_IF_ERROR(node->Accept(translator.get()));
+    }
+  }
+  return translator;
+}
+
 absl::Status IrTranslator::Retranslate(
     const absl::flat_hash_map<const Node*, Z3_ast>& replacements) {
   ResetVisitedState();
@@ -335,9 +361,13 @@ absl::StatusOr<Z3_ast> IrTranslator::ToFloat32(Z3_ast tuple) {
 
 template <typename OpT, typename FnT>
 absl::Status IrTranslator::HandleBinary(OpT* op, FnT f) {
+  StructuralKey key = GetStructuralKey(op);
+  if (ReuseStructuralTranslation(op, key)) {
+    return absl::OkStatus();
+  }
   ScopedErrorHandler seh(ctx_);
   Z3_ast result = f(ctx_, GetBitVec(op->operand(0)), GetBitVec(op->operand(1)));
-  NoteTranslation(op, result);
+  NoteStructuralTranslation(op, std::move(key), result);
   return seh.status();
 }
 
@@ -543,6 +573,15 @@ absl::Status IrTranslator::HandleEq(CompareOp* eq) {
   return seh.status();
 }
 
+absl::StatusOr<Z3_ast> IrTranslator::TranslateNe(Z3_ast lhs, Z3_ast rhs,
+                                                 Type* type) {
+  Z3OpTranslator t(ctx_);
+  ScopedErrorHandler seh(ctx_);
+  XLS_ASSIGN_OR_RETURN(Z3_ast result, ComputeNe(ctx_, lhs, rhs, type, t));
+  XLS_RETURN_IF_ERROR(seh.status());
+  return result;
+}
+
 absl::Status IrTranslator::HandleNe(CompareOp* ne) {
   Z3OpTranslator t(ctx_);
   ScopedErrorHandler seh(ctx_);
@@ -598,6 +637,10 @@ absl::Status IrTranslator::HandleShll(BinOp* shll) {
 template <typename OpT, typename FnT>
 absl::Status IrTranslator::HandleNary(OpT* op, FnT f, bool invert_result,
                                       bool skip_empty_operands) {
+  StructuralKey key = GetStructuralKey(op);
+  if (ReuseStructuralTranslation(op, key)) {
+    return absl::OkStatus();
+  }
   ScopedErrorHandler seh(ctx_);
   absl::Span<Node* const> operands = op->operands();
   XLS_RET_CHECK(!operands.empty()) << op->ToString();
@@ -619,7 +662,7 @@ absl::Status IrTranslator::HandleNary(OpT* op, FnT f, bool invert_result,
   if (invert_result) {
     accum = Z3OpTranslator(ctx_).Not(*accum);
   }
-  NoteTranslation(op, *accum);
+  NoteStructuralTranslation(op, std::move(key), *accum);
   return seh.status();
 }
 
@@ -914,6 +957,13 @@ absl::Status IrTranslator::HandleTupleIndex(TupleIndex* tuple_index) {
 // evaluator.
 absl::Status IrTranslator::HandleUnaryViaAbstractEval(Node* op) {
   CHECK_EQ(op->operand_count(), 1);
+  StructuralKey key = GetStructuralKey(
+      op, op->Is<OneHot>()
+              ? static_cast<int64_t>(op->As<OneHot>()->priority())
+              : 0);
+  if (ReuseStructuralTranslation(op, key)) {
+    return absl::OkStatus();
+  }
   ScopedErrorHandler seh(ctx_);
   Z3AbstractEvaluator evaluator(ctx_);
 
@@ -931,7 +981,7 @@ absl::Status IrTranslator::HandleUnaryViaAbstractEval(Node* op) {
   std::reverse(output_bits.begin(), output_bits.end());
   Z3_ast result = t.ConcatN(output_bits);
   CHECK_EQ(op->BitCountOrDie(), t.GetBvBitCount(result));
-  NoteTranslation(op, result);
+  NoteStructuralTranslation(op, std::move(key), result);
   return seh.status();
 }
 
@@ -940,9 +990,13 @@ absl::Status IrTranslator::HandleUnaryViaAbstractEval(Node* op) {
 template <typename FnT>
 absl::Status IrTranslator::HandleUnary(Node* op, FnT f) {
   CHECK_EQ(op->operand_count(), 1);
+  StructuralKey key = GetStructuralKey(op);
+  if (ReuseStructuralTranslation(op, key)) {
+    return absl::OkStatus();
+  }
   ScopedErrorHandler seh(ctx_);
   Z3_ast result = f(ctx_, GetBitVec(op->operand(0)));
-  NoteTranslation(op, result);
+  NoteStructuralTranslation(op, std::move(key), result);
   return seh.status();
 }
 
@@ -1453,12 +1507,16 @@ void IrTranslator::HandleMul(ArithOp* mul, bool is_signed) {
   // In XLS IR, multiply operands can potentially be of different widths. In Z3,
   // they can't, so we need to zext (for a umul) the operands to the size of the
   // result.
+  StructuralKey key = GetStructuralKey(mul);
+  if (ReuseStructuralTranslation(mul, key)) {
+    return;
+  }
   Z3_ast lhs = GetValue(mul->operand(0));
   Z3_ast rhs = GetValue(mul->operand(1));
   int result_size = mul->BitCountOrDie();
 
   Z3_ast result = DoMul(ctx_, lhs, rhs, is_signed, result_size);
-  NoteTranslation(mul, result);
+  NoteStructuralTranslation(mul, std::move(key), result);
 }
 
 absl::Status IrTranslator::HandleSMul(ArithOp* mul) {
@@ -1574,6 +1632,36 @@ void IrTranslator::NoteTranslation(Node* node, Z3_ast translated) {
   translations_[node] = translated;
 }
 
+IrTranslator::StructuralKey IrTranslator::GetStructuralKey(Node* node,
+                                                           int64_t attribute) {
+  StructuralKey key{.op = node->op(),
+                    .type = node->GetType(),
+                    .attribute = attribute,
+                    .operands = {}};
+  key.operands.reserve(node->operand_count());
+  for (Node* operand : node->operands()) {
+    key.operands.push_back(GetValue(operand));
+  }
+  return key;
+}
+
+bool IrTranslator::ReuseStructuralTranslation(Node* node,
+                                              const StructuralKey& key) {
+  auto it = structural_translations_.find(key);
+  if (it == structural_translations_.end()) {
+    return false;
+  }
+  ++structural_hit_count_;
+  NoteTranslation(node, it->second);
+  return true;
+}
+
+void IrTranslator::NoteStructuralTranslation(Node* node, StructuralKey key,
+                                             Z3_ast translated) {
+  structural_translations_.emplace(std::move(key), translated);
+  NoteTranslation(node, translated);
+}
+
 // Converts the predicate into a boolean objective that can be fed to the
 // Z3 solver.
 //
@@ -1676,6 +1764,48 @@ namespace {
 
 enum class PredicateCombination : std::uint8_t { kDisjunction, kConjunction };
 
+// Checks whether the assertions of `solver`, which state that the claim being
+// proven about `f` is violated, are satisfiable.
+absl::StatusOr<ProverResult> CheckSolver(FunctionBase* f,
+                                         IrTranslator* translator,
+                                         Z3_solver solver) {
+  Z3_context ctx = translator->ctx();
+  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
+
+  VLOG(1) << solvers::z3::SolverResultToString(ctx, solver, satisfiable);
+  switch (satisfiable) {
+    case Z3_L_FALSE:
+      // Unsatisfiable; no value contradicts the claim, so the result is true.
+      return ProvenTrue();
+    case Z3_L_TRUE: {
+      // Satisfiable; found a value that contradicts the claim.
+      absl::StatusOr<absl::flat_hash_map<const Param*, Value>> counterexample =
+          absl::flat_hash_map<const Param*, Value>();
+      auto model = Z3_solver_get_model(ctx, solver);
+      for (const Param* param : f->params()) {
+        absl::StatusOr<Value> value = NodeValue(
+            ctx, model, translator->GetTranslation(param), param->GetType());
+        if (value.ok()) {
+          counterexample->emplace(param, *std::move(value));
+        } else {
+          counterexample = std::move(value).status();
+          break;
+        }
+      }
+      return ProvenFalse{
+          .counterexample = std::move(counterexample),
+          .message =
+              solvers::z3::SolverResultToString(ctx, solver, satisfiable),
+      };
+    }
+    case Z3_L_UNDEF:
+      // No result; timeout.
+      return absl::DeadlineExceededError("Z3 solver timed out");
+  }
+
+  return absl::InternalError(absl::StrCat("Invalid Z3 result: ", satisfiable));
+}
+
 absl::StatusOr<ProverResult> TryProveCombination(
     FunctionBase* f, std::unique_ptr<IrTranslator> translator,
     absl::Span<const PredicateOfNode> terms,
@@ -1718,40 +1848,7 @@ absl::StatusOr<ProverResult> TryProveCombination(
   auto cleanup = absl::Cleanup([&] { Z3_solver_dec_ref(ctx, solver); });
 
   Z3_solver_assert(ctx, solver, objective.value());
-  Z3_lbool satisfiable = Z3_solver_check(ctx, solver);
-
-  VLOG(1) << solvers::z3::SolverResultToString(ctx, solver, satisfiable);
-  switch (satisfiable) {
-    case Z3_L_FALSE:
-      // Unsatisfiable; no value contradicts the claim, so the result is true.
-      return ProvenTrue();
-    case Z3_L_TRUE: {
-      // Satisfiable; found a value that contradicts the claim.
-      absl::StatusOr<absl::flat_hash_map<const Param*, Value>> counterexample =
-          absl::flat_hash_map<const Param*, Value>();
-      auto model = Z3_solver_get_model(ctx, solver);
-      for (const Param* param : f->params()) {
-        absl::StatusOr<Value> value = NodeValue(
-            ctx, model, translator->GetTranslation(param), param->GetType());
-        if (value.ok()) {
-          counterexample->emplace(param, *std::move(value));
-        } else {
-          counterexample = std::move(value).status();
-          break;
-        }
-      }
-      return ProvenFalse{
-          .counterexample = std::move(counterexample),
-          .message =
-              solvers::z3::SolverResultToString(ctx, solver, satisfiable),
-      };
-    }
-    case Z3_L_UNDEF:
-      // No result; timeout.
-      return absl::DeadlineExceededError("Z3 solver timed out");
-  }
-
-  return absl::InternalError(absl::StrCat("Invalid Z3 result: ", satisfiable));
+  return CheckSolver(f, translator.get(), solver);
 }
 
 }  // namespace
@@ -1816,6 +1913,93 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                              allow_unsupported);
 }
 
+absl::StatusOr<std::vector<PartitionProverResult>> TryProvePartitioned(
+    FunctionBase* f, Node* subject, const Predicate& p,
+    int64_t partition_bit_count, int64_t thread_count,
+    absl::Duration timeout) {
+  XLS_RET_CHECK_GE(partition_bit_count, 0);
+  XLS_RET_CHECK_LT(partition_bit_count, 63);
+  int64_t input_bit_count = 0;
+  for (Param* param : f->params()) {
+    if (!TypeHasToken(param->GetType())) {
+      input_bit_count += param->GetType()->GetFlatBitCount();
+    }
+  }
+  if (partition_bit_count > input_bit_count) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Cannot partition on %d bits; %s has only %d input bits",
+        partition_bit_count, f->name(), input_bit_count));
+  }
+  const int64_t partition_count = int64_t{1} << partition_bit_count;
+
+  ThreadPool pool(thread_count);
+  // Each worker has its own Z3 context. Translation may add types to the
+  // package, so it is done up front on this thread.
+  struct Worker {
+    std::unique_ptr<IrTranslator> translator;
+    Z3_ast objective;
+    // The partitioning bits, as 1-bit bit vectors.
+    std::vector<Z3_ast> partition_bits;
+  };
+  std::vector<Worker> workers(std::min(pool.num_threads(), partition_count));
+  for (Worker& worker : workers) {
+    XLS_ASSIGN_OR_RETURN(worker.translator,
+                         IrTranslator::CreateAndTranslate(f));
+    worker.translator->SetTimeout(timeout);
+    XLS_ASSIGN_OR_RETURN(
+        worker.objective,
+        PredicateToNegatedObjective(p, subject,
+                                    worker.translator->GetTranslation(subject),
+                                    worker.translator.get()));
+    for (Param* param : f->params()) {
+      if (TypeHasToken(param->GetType())) {
+        continue;
+      }
+      // Most significant bit of each leaf first.
+      for (Z3_ast bit : worker.translator->FlattenValue(
+               param->GetType(), worker.translator->GetTranslation(param),
+               /*little_endian=*/true)) {
+        if (worker.partition_bits.size() < partition_bit_count) {
+          worker.partition_bits.push_back(bit);
+        }
+      }
+    }
+  }
+
+  // Workers claim partitions in order until none are left, reusing a single
+  // solver across their partitions.
+  std::vector<PartitionProverResult> results(partition_count);
+  std::atomic<int64_t> next_partition = 0;
+  for (Worker& worker : workers) {
+    pool.Schedule([&] {
+      Z3_context ctx = worker.translator->ctx();
+      Z3OpTranslator t(ctx);
+      Z3_solver solver = solvers::z3::CreateSolver(ctx, /*num_threads=*/1);
+      Z3_solver_assert(ctx, solver, worker.objective);
+      for (int64_t partition = next_partition++; partition < partition_count;
+           partition = next_partition++) {
+        absl::Time start = absl::Now();
+        Z3_solver_push(ctx, solver);
+        for (int64_t i = 0; i < partition_bit_count; ++i) {
+          Z3_ast bit = worker.partition_bits[i];
+          bool value = ((partition >> (partition_bit_count - 1 - i)) & 1) != 0;
+          Z3_solver_assert(ctx, solver,
+                           value ? t.NeZeroBool(bit) : t.EqZeroBool(bit));
+        }
+        results[partition] = PartitionProverResult{
+            .partition = partition,
+            .result = CheckSolver(f, worker.translator.get(), solver),
+            .duration = absl::Now() - start,
+        };
+        Z3_solver_pop(ctx, solver, 1);
+      }
+      Z3_solver_dec_ref(ctx, solver);
+    });
+  }
+  pool.WaitForIdle();
+  return results;
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
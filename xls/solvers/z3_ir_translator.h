@@ -24,6 +24,7 @@
 #include <string>
 #include <string_view>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -40,6 +41,7 @@
 #include "xls/ir/function_base.h"
 #include "xls/ir/node.h"
 #include "xls/ir/nodes.h"
+#include "xls/ir/op.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "z3/src/api/z3.h"  // IWYU pragma: keep
@@ -77,6 +79,17 @@ class IrTranslator : public DfsVisitorWithDefault {
       Z3_context ctx, FunctionBase* function_base,
       absl::Span<const Z3_ast> imported_params, bool allow_unsupported = false);
 
+  // As above, but binds each node in `known_translations` to the given
+  // (already translated) Z3 value instead of translating it. Those nodes are
+  // not visited, so operands only used by them are not translated either; this
+  // lets a modified version of a function reuse the translation of the nodes
+  // it shares with the original and translate only the nodes that changed.
+  static absl::StatusOr<std::unique_ptr<IrTranslator>> CreateAndTranslate(
+      Z3_context ctx, FunctionBase* function_base,
+      absl::Span<const Z3_ast> imported_params,
+      const absl::flat_hash_map<Node*, Z3_ast>& known_translations,
+      bool allow_unsupported = false);
+
   // Translates the given node into a Z3 AST using a preexisting context
   // (i.e., that used by another Z3Translator).
   static absl::StatusOr<std::unique_ptr<IrTranslator>> CreateAndTranslate(
@@ -106,6 +119,11 @@ class IrTranslator : public DfsVisitorWithDefault {
   // Convenience version for the above for the function return Node.
   Z3_ast GetReturnNode();
 
+  // Returns a 1-bit Z3 bit vector which is set iff `lhs` and `rhs`, the
+  // translations of two values of XLS type `type`, differ. Aggregates are
+  // compared leaf by leaf, as for the `ne` op.
+  absl::StatusOr<Z3_ast> TranslateNe(Z3_ast lhs, Z3_ast rhs, Type* type);
+
   // Returns the kind (bit vector, tuple, function decl, etc.) of a Z3 sort.
   Z3_sort_kind GetValueKind(Z3_ast value);
 
@@ -212,7 +230,31 @@ class IrTranslator : public DfsVisitorWithDefault {
 
   FunctionBase* xls_function() { return xls_function_; }
 
+  // Returns the number of nodes whose translation was reused from a
+  // structurally identical node (same op, type, attributes and operand
+  // translations) instead of being rebuilt.
+  int64_t structural_hit_count() const { return structural_hit_count_; }
+
  private:
+  // Identifies a node by its structure rather than its identity. Operands are
+  // keyed by their translations, which Z3 hash-conses, so two nodes computing
+  // the same function of the same terms have equal keys.
+  struct StructuralKey {
+    Op op;
+    Type* type;
+    // Op-specific attribute not captured by the type, e.g. one_hot priority.
+    int64_t attribute;
+    std::vector<Z3_ast> operands;
+
+    bool operator==(const StructuralKey& other) const = default;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const StructuralKey& key) {
+      return H::combine(std::move(h), key.op, key.type, key.attribute,
+                        key.operands);
+    }
+  };
+
   IrTranslator(Z3_config config, FunctionBase* source);
 
   IrTranslator(Z3_context ctx, FunctionBase* source,
@@ -289,6 +331,17 @@ class IrTranslator : public DfsVisitorWithDefault {
   // Records the mapping of the specified XLS IR node to Z3 value.
   void NoteTranslation(Node* node, Z3_ast translated);
 
+  // Returns the structural key of `node`; all operands must be translated.
+  StructuralKey GetStructuralKey(Node* node, int64_t attribute = 0);
+
+  // If a node with the given key has already been translated, records its
+  // translation for `node` and returns true.
+  bool ReuseStructuralTranslation(Node* node, const StructuralKey& key);
+
+  // Records `translated` both for `node` and for its structural key.
+  void NoteStructuralTranslation(Node* node, StructuralKey key,
+                                 Z3_ast translated);
+
   // Creates a Z3 tuple from the given XLS type or Z3 sort and Z3 elements.
   Z3_ast CreateTuple(Type* tuple_type, absl::Span<const Z3_ast> elements);
   Z3_ast CreateTuple(Z3_sort tuple_sort, absl::Span<const Z3_ast> elements);
@@ -323,6 +376,11 @@ class IrTranslator : public DfsVisitorWithDefault {
   // we shouldn't delete our context, etc.!
   bool borrowed_context_;
   absl::flat_hash_map<const Node*, Z3_ast> translations_;
+  // Translations of the pure ops handled by the Handle{Unary,Binary,Nary}
+  // helpers and multiplies, by structural key. Keys only refer to Z3 terms, so
+  // entries stay valid across Retranslate().
+  absl::flat_hash_map<StructuralKey, Z3_ast> structural_translations_;
+  int64_t structural_hit_count_ = 0;
   // Params specified in the context-borrowing CreateAndTranslate() builder.
   // Parameters already translated in a separate function traversal that should
   // be used as this translation's parameter set.
@@ -444,6 +502,28 @@ absl::StatusOr<ProverResult> TryProve(FunctionBase* f, Node* subject,
                                       Predicate p, int64_t rlimit,
                                       bool allow_unsupported = false);
 
+// The result of proving one partition of the input space in
+// TryProvePartitioned().
+struct PartitionProverResult {
+  // The value of the partitioning input bits, most significant first.
+  int64_t partition;
+  // ProvenTrue or ProvenFalse for this partition, or a DeadlineExceeded error
+  // if the solver timed out.
+  absl::StatusOr<ProverResult> result;
+  absl::Duration duration;
+};
+
+// As TryProve, but splits the input space on its `partition_bit_count` most
+// significant bits (taken from the parameters in order, most significant bit
+// of each leaf first) into 2^partition_bit_count sub-queries, each of which is
+// given `timeout`. The sub-queries are solved on `thread_count` threads (one
+// per CPU if zero); each thread translates `f` once into its own Z3 context and
+// reuses one solver across its partitions, pushing and popping the partition
+// constraint. Returns the result of every partition, in partition order.
+absl::StatusOr<std::vector<PartitionProverResult>> TryProvePartitioned(
+    FunctionBase* f, Node* subject, const Predicate& p,
+    int64_t partition_bit_count, int64_t thread_count, absl::Duration timeout);
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
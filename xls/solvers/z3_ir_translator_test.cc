@@ -206,6 +206,70 @@ fn f(x: bits[32], y: bits[32]) -> bits[32] {
   EXPECT_THAT(proven, IsProvenTrue());
 }
 
+TEST_F(Z3IrTranslatorTest, StructurallyIdenticalNodesShareTranslation) {
+  const std::string program = R"(
+fn f(x: bits[8], y: bits[8]) -> bits[8] {
+  umul.1: bits[8] = umul(x, y)
+  umul.2: bits[8] = umul(x, y)
+  reverse.3: bits[8] = reverse(umul.1)
+  reverse.4: bits[8] = reverse(umul.2)
+  one_hot.5: bits[9] = one_hot(reverse.3, lsb_prio=true)
+  one_hot.6: bits[9] = one_hot(reverse.4, lsb_prio=false)
+  ret sub.7: bits[8] = sub(reverse.3, reverse.4)
+}
+)";
+  std::unique_ptr<Package> package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(auto translator,
+                           IrTranslator::CreateAndTranslate(f));
+  EXPECT_EQ(translator->GetTranslation(FindNode("umul.1", f)),
+            translator->GetTranslation(FindNode("umul.2", f)));
+  EXPECT_EQ(translator->GetTranslation(FindNode("reverse.3", f)),
+            translator->GetTranslation(FindNode("reverse.4", f)));
+  // The one_hots differ only in priority, which must be part of the key.
+  EXPECT_NE(translator->GetTranslation(FindNode("one_hot.5", f)),
+            translator->GetTranslation(FindNode("one_hot.6", f)));
+  EXPECT_EQ(translator->structural_hit_count(), 2);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ProverResult proven,
+      TryProve(f, f->return_value(), Predicate::EqualToZero(),
+               absl::InfiniteDuration()));
+  EXPECT_THAT(proven, IsProvenTrue());
+}
+
+TEST_F(Z3IrTranslatorTest, PartitionedProofFindsFailingPartition) {
+  const std::string program = R"(
+fn f(x: bits[8], y: bits[4]) -> bits[1] {
+  literal.1: bits[8] = literal(value=0xab)
+  ret ne.2: bits[1] = ne(x, literal.1)
+}
+)";
+  std::unique_ptr<Package> package = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(Function * f, ParseFunction(program, package.get()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::vector<solvers::z3::PartitionProverResult> results,
+      solvers::z3::TryProvePartitioned(
+          f, f->return_value(), Predicate::NotEqualToZero(),
+          /*partition_bit_count=*/2, /*thread_count=*/2,
+          absl::InfiniteDuration()));
+  ASSERT_EQ(results.size(), 4);
+  for (int64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(results[i].partition, i);
+    // 0xab is 0b10101011, so only partition 0b10 contains a counterexample.
+    if (i == 2) {
+      EXPECT_THAT(results[i].result, IsOkAndHolds(IsProvenFalse()));
+    } else {
+      EXPECT_THAT(results[i].result, IsOkAndHolds(IsProvenTrue()));
+    }
+  }
+  EXPECT_THAT(solvers::z3::TryProvePartitioned(
+                  f, f->return_value(), Predicate::NotEqualToZero(),
+                  /*partition_bit_count=*/13, /*thread_count=*/1,
+                  absl::InfiniteDuration()),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+}
+
 TEST_F(Z3IrTranslatorTest, TupleIndexMinusSelf) {
   const std::string program = R"(
 fn f(p: (bits[1], bits[32])) -> bits[32] {
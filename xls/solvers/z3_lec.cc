@@ -21,6 +21,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
@@ -32,11 +33,17 @@
 #include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "absl/strings/strip.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/codegen/vast/vast.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/bits_ops.h"
 #include "xls/ir/format_preference.h"
@@ -44,10 +51,12 @@
 #include "xls/ir/node.h"
 #include "xls/ir/node_util.h"
 #include "xls/ir/nodes.h"
+#include "xls/netlist/find_logic_clouds.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_netlist_translator.h"
+#include "xls/solvers/z3_portfolio.h"
 #include "xls/solvers/z3_utils.h"
 #include "z3/src/api/z3_api.h"
 
@@ -55,6 +64,8 @@ namespace xls {
 namespace solvers {
 namespace z3 {
 
+using ::xls::netlist::rtl::Cell;
+using ::xls::netlist::rtl::Cluster;
 using ::xls::netlist::rtl::Module;
 using ::xls::netlist::rtl::Netlist;
 using ::xls::netlist::rtl::NetRef;
@@ -67,6 +78,22 @@ bool CheckingSingleStage(std::optional<PipelineSchedule> schedule,
   return schedule && stage != -1;
 }
 
+// Returns the pipeline stage whose outputs the given flop holds, from the
+// "p<stage + 1>_" prefix of pipeline register names (see
+// Lec::NodeToNetlistName()), or nullopt if it is not a pipeline register.
+std::optional<int> PipelineRegisterStage(const Cell* flop) {
+  std::string_view name = flop->name();
+  if (!absl::ConsumePrefix(&name, "p")) {
+    return std::nullopt;
+  }
+  int register_index;
+  if (!absl::SimpleAtoi(name.substr(0, name.find('_')), &register_index) ||
+      register_index < 1) {
+    return std::nullopt;
+  }
+  return register_index - 1;
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<Lec>> Lec::Create(const LecParams& params) {
@@ -88,6 +115,24 @@ absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateForStage(
   return lec;
 }
 
+absl::StatusOr<std::unique_ptr<Lec>> Lec::CreateForLogicCloud(
+    const LecParams& params, const PipelineSchedule& schedule, int stage,
+    const Cluster& cloud) {
+  auto lec = absl::WrapUnique<Lec>(new Lec(params.ir_function, params.netlist,
+                                           params.netlist_module_name, schedule,
+                                           stage));
+  lec->cloud_cells_.emplace(cloud.other_cells().begin(),
+                            cloud.other_cells().end());
+  for (const Cell* flop : cloud.terminating_flops()) {
+    lec->cloud_cells_->insert(flop);
+    for (const auto& output : flop->outputs()) {
+      lec->cloud_outputs_.insert(output.netref);
+    }
+  }
+  XLS_RETURN_IF_ERROR(lec->Init());
+  return lec;
+}
+
 Lec::Lec(Function* ir_function, Netlist* netlist,
          const std::string& netlist_module_name,
          std::optional<PipelineSchedule> schedule, int stage)
@@ -148,6 +193,7 @@ absl::Status Lec::Init() {
         ir_outputs_.push_back(ir_bits[i]);
         netlist_outputs_.push_back(netlist_bits[i]);
         eq_nodes.push_back(Z3_mk_eq(ctx(), ir_bits[i], netlist_bits[i]));
+        output_mismatches_.push_back(Z3_mk_not(ctx(), eq_nodes.back()));
       }
     }
   }
@@ -215,6 +261,17 @@ void Lec::CollectIrOutputNodes() {
 
   // Ensure a deterministic output order.
   ir_output_nodes_ = SetToSortedVector(stage_outputs);
+
+  // A logic cloud only computes the stage outputs held in its flops.
+  if (cloud_cells_.has_value()) {
+    std::erase_if(ir_output_nodes_, [&](const Node* node) {
+      absl::StatusOr<std::vector<NetRef>> refs = GetIrNetrefs(node);
+      return !refs.ok() ||
+             std::none_of(refs->begin(), refs->end(), [&](NetRef ref) {
+               return cloud_outputs_.contains(ref);
+             });
+    });
+  }
 }
 
 absl::StatusOr<std::vector<NetRef>> Lec::GetIrNetrefs(const Node* node) {
@@ -275,6 +332,7 @@ absl::Status Lec::AddConstraints(Function* constraints) {
   Z3_ast eq_node = Z3_mk_eq(ctx(), constraint_translator->GetReturnNode(),
                             Z3_mk_int(ctx(), 1, Z3_mk_bv_sort(ctx(), 1)));
   Z3_solver_assert(ctx(), solver_.value(), eq_node);
+  constraints_.push_back(eq_node);
   return absl::OkStatus();
 }
 
@@ -288,11 +346,34 @@ bool Lec::Run() {
   return !satisfiable_;
 }
 
+absl::StatusOr<bool> Lec::RunPortfolio(
+    absl::Duration timeout, absl::Span<const PortfolioStrategy> strategies) {
+  LOG(INFO) << "Beginning portfolio execution";
+  XLS_ASSIGN_OR_RETURN(PortfolioResult result,
+                       CheckSatPortfolio(ctx(), constraints_,
+                                         output_mismatches_, timeout,
+                                         strategies));
+  portfolio_results_ = std::move(result.strategy_results);
+  for (const PortfolioStrategyResult& strategy_result : portfolio_results_) {
+    LOG(INFO) << "Portfolio strategy " << strategy_result.ToString();
+  }
+  if (result.result == Z3_L_UNDEF) {
+    return absl::DeadlineExceededError(
+        "No portfolio strategy proved or disproved equivalence.");
+  }
+  if (model_) {
+    Z3_model_dec_ref(ctx(), model_.value());
+  }
+  satisfiable_ = result.result == Z3_L_TRUE;
+  model_ = result.model;
+  return !satisfiable_;
+}
+
 std::string Lec::ResultToString() {
   std::vector<std::string> output;
-  output.push_back(SolverResultToString(ctx(), solver_.value(),
-                                        satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE,
-                                        /*hexify=*/true));
+  output.push_back(SolverResultToString(
+      ctx(), satisfiable_ ? model_.value() : nullptr,
+      satisfiable_ ? Z3_L_TRUE : Z3_L_FALSE, /*hexify=*/true));
   if (satisfiable_) {
     for (const Node* node : ir_output_nodes_) {
       std::pair<std::string, std::string> outputs = GetComparisonStrings(node);
@@ -383,7 +464,9 @@ absl::StatusOr<std::vector<Z3_ast>> Lec::GetNetlistZ3ForIr(const Node* node) {
   XLS_ASSIGN_OR_RETURN(std::vector<NetRef> netrefs, GetIrNetrefs(node));
   netlist_output.reserve(netrefs.size());
   for (const auto& netref : netrefs) {
-    if (netref == nullptr) {
+    if (netref == nullptr ||
+        (cloud_cells_.has_value() && !cloud_outputs_.contains(netref))) {
+      // Bits held outside of the logic cloud being checked are "don't care".
       netlist_output.push_back(nullptr);
     } else if (netref->name() == "output_valid") {
       // Drop output wires not part of the original signature.
@@ -408,9 +491,16 @@ absl::Status Lec::CreateNetlistTranslator() {
     }
   }
 
-  XLS_ASSIGN_OR_RETURN(netlist_translator_,
-                       NetlistTranslator::CreateAndTranslate(
-                           ir_translator_->ctx(), module_, module_refs));
+  if (cloud_cells_.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        netlist_translator_,
+        NetlistTranslator::CreateAndTranslate(ir_translator_->ctx(), module_,
+                                              module_refs, *cloud_cells_));
+  } else {
+    XLS_ASSIGN_OR_RETURN(netlist_translator_,
+                         NetlistTranslator::CreateAndTranslate(
+                             ir_translator_->ctx(), module_, module_refs));
+  }
 
   return absl::OkStatus();
 }
@@ -515,6 +605,62 @@ std::string Lec::NodeToNetlistName(const Node* node,
   return name;
 }
 
+absl::StatusOr<std::vector<LogicCloudLecResult>> RunLogicCloudLec(
+    const LecParams& params, const PipelineSchedule& schedule,
+    ThreadPool& thread_pool) {
+  XLS_ASSIGN_OR_RETURN(const Module* module,
+                       params.netlist->GetModule(params.netlist_module_name));
+  std::vector<Cluster> clouds = netlist::rtl::FindLogicClouds(*module);
+  std::erase_if(clouds, [](const Cluster& cloud) {
+    return cloud.terminating_flops().empty();
+  });
+
+  std::vector<LogicCloudLecResult> results(clouds.size());
+  std::vector<int64_t> matched;
+  for (int64_t i = 0; i < clouds.size(); ++i) {
+    clouds[i].SortCells();
+    LogicCloudLecResult& result = results[i];
+    std::optional<int> stage;
+    for (const Cell* flop : clouds[i].terminating_flops()) {
+      result.terminating_flops.push_back(flop->name());
+      std::optional<int> flop_stage = PipelineRegisterStage(flop);
+      if (!flop_stage.has_value() || *flop_stage >= schedule.length()) {
+        result.equivalent = absl::NotFoundError(absl::StrFormat(
+            "Flop %s is not a pipeline register of the schedule",
+            flop->name()));
+      } else if (stage.has_value() && *stage != *flop_stage) {
+        result.equivalent = absl::InvalidArgumentError(absl::StrFormat(
+            "Logic cloud terminating in %s spans stages %d and %d",
+            flop->name(), *stage, *flop_stage));
+      } else {
+        stage = flop_stage;
+        continue;
+      }
+      break;
+    }
+    result.stage = stage.value_or(-1);
+    if (result.equivalent.ok()) {
+      matched.push_back(i);
+    }
+  }
+
+  VLOG(1) << "Checking " << matched.size() << " of " << clouds.size()
+          << " logic clouds";
+  thread_pool.ParallelFor(matched.size(), /*grain=*/1, [&](int64_t m) {
+    const int64_t i = matched[m];
+    LogicCloudLecResult& result = results[i];
+    absl::StatusOr<std::unique_ptr<Lec>> lec =
+        Lec::CreateForLogicCloud(params, schedule, result.stage, clouds[i]);
+    if (lec.ok()) {
+      result.equivalent = (*lec)->Run();
+      result.result = (*lec)->ResultToString();
+    } else {
+      result.equivalent = lec.status();
+    }
+  });
+  return results;
+}
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
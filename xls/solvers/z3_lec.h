@@ -22,14 +22,20 @@
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/node.h"
 #include "xls/ir/package.h"
+#include "xls/netlist/find_logic_clouds.h"
 #include "xls/netlist/netlist.h"
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/solvers/z3_ir_translator.h"
 #include "xls/solvers/z3_netlist_translator.h"
+#include "xls/solvers/z3_portfolio.h"
 #include "z3/src/api/z3.h"  // IWYU pragma: keep
 #include "z3/src/api/z3_api.h"
 
@@ -67,6 +73,15 @@ class Lec {
   // cell/wire to stage is derived from there.
   static absl::StatusOr<std::unique_ptr<Lec>> CreateForStage(
       const LecParams& params, const PipelineSchedule& schedule, int stage);
+
+  // Creates a LEC object for one logic cloud of the netlist module (see
+  // netlist/find_logic_clouds.h) which computes outputs of the given pipeline
+  // stage. Only the cells of the cloud are translated, and only the stage
+  // outputs held in the cloud's terminating flops are compared, so the checks
+  // of the clouds of a stage together cover the check of the whole stage.
+  static absl::StatusOr<std::unique_ptr<Lec>> CreateForLogicCloud(
+      const LecParams& params, const PipelineSchedule& schedule, int stage,
+      const netlist::rtl::Cluster& cloud);
   ~Lec();
 
   // Applies additional constraints (aside from the LEC itself), such as
@@ -82,6 +97,19 @@ class Lec {
   // Returns true of the netlist and IR are proved to be equivalent.
   bool Run();
 
+  // As Run(), but races the strategies of a solver portfolio (see
+  // z3_portfolio.h) in parallel threads and takes the first definitive answer.
+  // Returns a DeadlineExceededError if no strategy finishes within `timeout`.
+  absl::StatusOr<bool> RunPortfolio(
+      absl::Duration timeout,
+      absl::Span<const PortfolioStrategy> strategies =
+          kAllPortfolioStrategies);
+
+  // How each strategy fared in the last RunPortfolio().
+  absl::Span<const PortfolioStrategyResult> portfolio_results() const {
+    return portfolio_results_;
+  }
+
   // Dumps all Z3 values corresponding to IR nodes in the input function.
   void DumpIrTree();
 
@@ -157,9 +185,21 @@ class Lec {
   std::vector<Z3_ast> ir_outputs_;
   std::vector<Z3_ast> netlist_outputs_;
 
+  // The query asserted into the solver, kept for RunPortfolio(): the input
+  // constraints, and one term per output bit which holds when that bit of the
+  // IR and netlist differ.
+  std::vector<Z3_ast> constraints_;
+  std::vector<Z3_ast> output_mismatches_;
+  std::vector<PortfolioStrategyResult> portfolio_results_;
+
   std::optional<PipelineSchedule> schedule_;
   int stage_;
 
+  // When checking a single logic cloud, its cells and the nets driven by its
+  // terminating flops.
+  std::optional<absl::flat_hash_set<const netlist::rtl::Cell*>> cloud_cells_;
+  absl::flat_hash_set<netlist::rtl::NetRef> cloud_outputs_;
+
   // Z3 elements are, under the hood, void pointers, but let's respect the
   // interface and use std::optional to determine live-ness.
   std::optional<Z3_solver> solver_;
@@ -170,6 +210,33 @@ class Lec {
   std::optional<Z3_model> model_;
 };
 
+// The outcome of checking one logic cloud with RunLogicCloudLec().
+struct LogicCloudLecResult {
+  // The pipeline stage the cloud computes outputs of.
+  int stage;
+  // Names of the flops terminating the cloud.
+  std::vector<std::string> terminating_flops;
+  // Whether the cloud was proven equivalent to its part of the stage, or why
+  // it could not be checked.
+  absl::StatusOr<bool> equivalent = false;
+  // Description of the result (see Lec::ResultToString()); empty if the cloud
+  // could not be checked.
+  std::string result;
+};
+
+// Checks a pipelined netlist against the IR one logic cloud at a time. Each
+// flop-terminated cloud of the netlist module is matched to the pipeline stage
+// whose outputs its flops hold (by the "p<stage + 1>_" prefix codegen gives
+// pipeline registers), translated independently, and proven on
+// `thread_pool`; clouds are much smaller than stages and share no Z3 state, so
+// they are proven concurrently. Logic after the last flops (with no
+// terminating flop) is not checked. Clouds which cannot be matched to a single
+// stage are reported with an error in their result rather than failing the
+// whole check. Results are in the order of FindLogicClouds().
+absl::StatusOr<std::vector<LogicCloudLecResult>> RunLogicCloudLec(
+    const LecParams& params, const PipelineSchedule& schedule,
+    ThreadPool& thread_pool);
+
 }  // namespace z3
 }  // namespace solvers
 }  // namespace xls
@@ -16,13 +16,18 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "xls/common/status/matchers.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/node.h"
@@ -39,6 +44,7 @@ namespace solvers {
 namespace z3 {
 namespace {
 
+using ::absl_testing::IsOkAndHolds;
 using ::xls::netlist::rtl::Netlist;
 
 absl::StatusOr<bool> Match(const std::string& ir_text,
@@ -359,6 +365,92 @@ endmodule
   }
 }
 
+// Checks the netlist of FailsBadMultiStage one logic cloud at a time: the
+// swapped cell is isolated to its own cloud, and the logic after the last
+// flops is not checked.
+TEST(Z3LecTest, LogicCloudsMultiStage) {
+  std::string ir_text = R"(
+package p
+
+top fn main(i0: bits[1], i1: bits[1], i2: bits[1], i3: bits[1]) -> bits[1] {
+  and.1: bits[1] = and(i0, i1)
+  and.2: bits[1] = and(i2, i3)
+  or.3: bits[1] = or(and.1, and.2)
+  ret not.4: bits[1] = not(or.3)
+}
+)";
+
+  std::string netlist_text = R"(
+module main ( clk, i3, i2, i1, i0, out_0);
+  input clk, i3, i2, i1, i0;
+  output out_0;
+  wire p0_i3, p0_i2, p0_i1, p0_i0,
+       p1_and_1_comb, p1_and_2_comb, p1_and_1, p1_and_2,
+       p2_or_3_comb, p2_or_3;
+
+  DFF p0_i3_reg ( .D(i3), .CLK(clk), .Q(p0_i3) );
+  DFF p0_i2_reg ( .D(i2), .CLK(clk), .Q(p0_i2) );
+  DFF p0_i1_reg ( .D(i1), .CLK(clk), .Q(p0_i1) );
+  DFF p0_i0_reg ( .D(i0), .CLK(clk), .Q(p0_i0) );
+
+  AND p1_and_1 ( .A(p0_i0), .B(p0_i1), .Z(p1_and_1_comb) );
+  OR p1_and_2 ( .A(p0_i2), .B(p0_i3), .Z(p1_and_2_comb) );
+  DFF p1_and_1_reg ( .D(p1_and_1_comb), .CLK(clk), .Q(p1_and_1) );
+  DFF p1_and_2_reg ( .D(p1_and_2_comb), .CLK(clk), .Q(p1_and_2) );
+
+  OR p2_or_3 ( .A(p1_and_1), .B(p1_and_2), .Z(p2_or_3_comb) );
+  DFF p2_or_3_reg ( .D(p2_or_3_comb), .CLK(clk), .Q(p2_or_3) );
+
+  INV p3_not_4 ( .A(p2_or_3), .ZN(out_0) );
+endmodule
+)";
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<Package> package,
+                           Parser::ParsePackage(ir_text));
+  XLS_ASSERT_OK_AND_ASSIGN(Function * entry_function,
+                           package->GetTopAsFunction());
+  XLS_ASSERT_OK_AND_ASSIGN(netlist::CellLibrary cell_library,
+                           netlist::MakeFakeCellLibrary());
+  netlist::rtl::Scanner scanner(netlist_text);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<Netlist> netlist,
+      netlist::rtl::Parser::ParseNetlist(&cell_library, &scanner));
+
+  LecParams params;
+  params.ir_package = package.get();
+  params.ir_function = entry_function;
+  params.netlist = netlist.get();
+  params.netlist_module_name = "main";
+
+  ScheduleCycleMap cycle_map;
+  for (Node* node : entry_function->nodes()) {
+    if (node->Is<Param>() || absl::StrContains(node->GetName(), "and")) {
+      cycle_map[node] = 0;
+    } else if (absl::StrContains(node->GetName(), "or")) {
+      cycle_map[node] = 1;
+    } else {
+      cycle_map[node] = 2;
+    }
+  }
+  PipelineSchedule schedule(entry_function, cycle_map, /*length=*/3);
+
+  ThreadPool thread_pool(2);
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<LogicCloudLecResult> results,
+                           RunLogicCloudLec(params, schedule, thread_pool));
+  ASSERT_EQ(results.size(), 3);
+  absl::flat_hash_map<std::string, LogicCloudLecResult> by_flop;
+  for (LogicCloudLecResult& result : results) {
+    ASSERT_EQ(result.terminating_flops.size(), 1);
+    by_flop.emplace(result.terminating_flops[0], std::move(result));
+  }
+  EXPECT_EQ(by_flop.at("p1_and_1_reg").stage, 0);
+  EXPECT_THAT(by_flop.at("p1_and_1_reg").equivalent, IsOkAndHolds(true));
+  EXPECT_EQ(by_flop.at("p1_and_2_reg").stage, 0);
+  EXPECT_THAT(by_flop.at("p1_and_2_reg").equivalent, IsOkAndHolds(false));
+  EXPECT_EQ(by_flop.at("p2_or_3_reg").stage, 1);
+  EXPECT_THAT(by_flop.at("p2_or_3_reg").equivalent, IsOkAndHolds(true));
+}
+
 // This test verifies that we can do a multibit LEC with >1b inputs.
 // There are three defined stages:
 // [inputs] -> p0_AND -> p1_OR -> p2 NOT -> [outputs]
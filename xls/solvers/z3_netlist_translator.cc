@@ -17,6 +17,7 @@
 #include <deque>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -62,6 +63,19 @@ NetlistTranslator::CreateAndTranslate(
   return translator;
 }
 
+absl::StatusOr<std::unique_ptr<NetlistTranslator>>
+NetlistTranslator::CreateAndTranslate(
+    Z3_context ctx, const Module* module,
+    const absl::flat_hash_map<std::string, const Module*>& module_refs,
+    absl::flat_hash_set<const Cell*> cells) {
+  auto translator =
+      absl::WrapUnique(new NetlistTranslator(ctx, module, module_refs));
+  translator->cells_ = std::move(cells);
+  XLS_RETURN_IF_ERROR(translator->Init());
+  XLS_RETURN_IF_ERROR(translator->Translate());
+  return translator;
+}
+
 absl::StatusOr<Z3_ast> NetlistTranslator::GetTranslation(NetRef ref) {
   XLS_RET_CHECK(translated_.contains(ref)) << ref->name();
   return translated_.at(ref);
@@ -167,6 +181,9 @@ absl::Status NetlistTranslator::Translate() {
     // Check every connected cell to see if all of its inputs are now
     // available.
     for (auto& cell : ref->connected_cells()) {
+      if (cells_.has_value() && !cells_->contains(cell)) {
+        continue;
+      }
       // Skip if this cell if the wire is its output!
       bool is_output = false;
       for (const auto& output : cell->outputs()) {
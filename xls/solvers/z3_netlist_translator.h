@@ -16,6 +16,7 @@
 #define XLS_SOLVERS_Z3_NETLIST_TRANSLATOR_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,16 @@ class NetlistTranslator {
       const absl::flat_hash_map<std::string, const netlist::rtl::Module*>&
           module_refs);
 
+  // As above, but only translates `cells` (e.g., one logic cloud; see
+  // netlist/find_logic_clouds.h) and cells without inputs, such as tie cells.
+  // Nets driven by any other cell stay untranslated unless they are bound by
+  // Retranslate(), as are the cells reading them.
+  static absl::StatusOr<std::unique_ptr<NetlistTranslator>> CreateAndTranslate(
+      Z3_context ctx, const netlist::rtl::Module* module,
+      const absl::flat_hash_map<std::string, const netlist::rtl::Module*>&
+          module_refs,
+      absl::flat_hash_set<const netlist::rtl::Cell*> cells);
+
   // Returns the Z3 equivalent for the specified net.
   absl::StatusOr<Z3_ast> GetTranslation(netlist::rtl::NetRef ref);
 
@@ -104,6 +115,9 @@ class NetlistTranslator {
 
   const absl::flat_hash_map<std::string, const netlist::rtl::Module*>
       module_refs_;
+
+  // If set, the only cells with inputs which are translated.
+  std::optional<absl::flat_hash_set<const netlist::rtl::Cell*>> cells_;
 };
 
 }  // namespace z3
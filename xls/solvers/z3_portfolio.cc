@@ -0,0 +1,331 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/solvers/z3_portfolio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/thread.h"
+#include "z3/src/api/z3.h"  // IWYU pragma: keep
+#include "z3/src/api/z3_api.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+namespace {
+
+// How often the losing strategies are interrupted until they stop; an
+// interrupt which arrives between two solver checks is otherwise lost.
+constexpr absl::Duration kInterruptPeriod = absl::Milliseconds(10);
+
+std::string_view LboolToString(Z3_lbool value) {
+  switch (value) {
+    case Z3_L_TRUE:
+      return "sat";
+    case Z3_L_FALSE:
+      return "unsat";
+    case Z3_L_UNDEF:
+      return "unknown";
+  }
+  return "invalid";
+}
+
+void IgnoreError(Z3_context ctx, Z3_error_code error) {
+  VLOG(1) << "Z3 error in portfolio strategy: " << Z3_get_error_msg(ctx, error);
+}
+
+// One strategy's attempt at the query, with its own context holding its own
+// translation of the query.
+class StrategyRun {
+ public:
+  StrategyRun(PortfolioStrategy strategy, Z3_context source,
+              absl::Span<const Z3_ast> constraints,
+              absl::Span<const Z3_ast> disjuncts, absl::Duration timeout)
+      : timeout_(timeout) {
+    result_.strategy = strategy;
+    Z3_config config = Z3_mk_config();
+    Z3_set_param_value(config, "model", "true");
+    ctx_ = Z3_mk_context(config);
+    Z3_del_config(config);
+    // Errors surface as an undefined result instead of aborting.
+    Z3_set_error_handler(ctx_, IgnoreError);
+    for (Z3_ast constraint : constraints) {
+      constraints_.push_back(Z3_translate(source, constraint, ctx_));
+    }
+    for (Z3_ast disjunct : disjuncts) {
+      disjuncts_.push_back(Z3_translate(source, disjunct, ctx_));
+    }
+  }
+
+  ~StrategyRun() {
+    if (model_.has_value()) {
+      Z3_model_dec_ref(ctx_, *model_);
+    }
+    Z3_del_context(ctx_);
+  }
+
+  // Runs the strategy to completion, giving up once `cancelled` is set.
+  void Run(const std::atomic<bool>& cancelled) {
+    absl::Time start = absl::Now();
+    deadline_ = start + timeout_;
+    switch (result_.strategy) {
+      case PortfolioStrategy::kBitBlastSat:
+        RunBitBlastSat(cancelled);
+        break;
+      case PortfolioStrategy::kDefaultSmt:
+        RunDefaultSmt(cancelled);
+        break;
+      case PortfolioStrategy::kPerOutputBit:
+        RunPerOutputBit(cancelled);
+        break;
+    }
+    result_.elapsed = absl::Now() - start;
+    VLOG(1) << "Portfolio strategy finished: " << result_.ToString();
+  }
+
+  // May be called from any thread.
+  void Interrupt() { Z3_interrupt(ctx_); }
+
+  Z3_context ctx() const { return ctx_; }
+  const PortfolioStrategyResult& result() const { return result_; }
+  std::optional<Z3_model> model() const { return model_; }
+
+ private:
+  // Checks `solver` under the remaining time budget, recording a model if it
+  // is satisfiable.
+  Z3_lbool Check(Z3_solver solver, const std::atomic<bool>& cancelled) {
+    if (cancelled.load()) {
+      result_.reason_unknown = "cancelled";
+      return Z3_L_UNDEF;
+    }
+    absl::Duration remaining = deadline_ - absl::Now();
+    if (remaining <= absl::ZeroDuration()) {
+      result_.reason_unknown = "timeout";
+      return Z3_L_UNDEF;
+    }
+    if (remaining != absl::InfiniteDuration()) {
+      Z3_params params = Z3_mk_params(ctx_);
+      Z3_params_inc_ref(ctx_, params);
+      Z3_params_set_uint(
+          ctx_, params, Z3_mk_string_symbol(ctx_, "timeout"),
+          static_cast<unsigned>(std::clamp<int64_t>(
+              absl::ToInt64Milliseconds(remaining), 1,
+              std::numeric_limits<unsigned>::max())));
+      Z3_solver_set_params(ctx_, solver, params);
+      Z3_params_dec_ref(ctx_, params);
+    }
+    Z3_lbool satisfiable = Z3_solver_check(ctx_, solver);
+    if (satisfiable == Z3_L_TRUE) {
+      model_ = Z3_solver_get_model(ctx_, solver);
+      Z3_model_inc_ref(ctx_, *model_);
+    } else if (satisfiable == Z3_L_UNDEF) {
+      result_.reason_unknown = Z3_solver_get_reason_unknown(ctx_, solver);
+    }
+    return satisfiable;
+  }
+
+  // Asserts the whole query into `solver` and checks it.
+  void CheckQuery(Z3_solver solver, const std::atomic<bool>& cancelled) {
+    for (Z3_ast constraint : constraints_) {
+      Z3_solver_assert(ctx_, solver, constraint);
+    }
+    Z3_solver_assert(ctx_, solver,
+                     Z3_mk_or(ctx_, disjuncts_.size(), disjuncts_.data()));
+    result_.result = Check(solver, cancelled);
+    Z3_solver_dec_ref(ctx_, solver);
+  }
+
+  void RunBitBlastSat(const std::atomic<bool>& cancelled) {
+    // Tactics are reference counted; hold each one until the solver is built.
+    std::vector<Z3_tactic> tactics;
+    auto hold = [&](Z3_tactic tactic) {
+      Z3_tactic_inc_ref(ctx_, tactic);
+      tactics.push_back(tactic);
+      return tactic;
+    };
+    Z3_tactic tactic = hold(Z3_mk_tactic(ctx_, "sat"));
+    for (const char* name : {"bit-blast", "simplify"}) {
+      tactic = hold(
+          Z3_tactic_and_then(ctx_, hold(Z3_mk_tactic(ctx_, name)), tactic));
+    }
+    Z3_solver solver = Z3_mk_solver_from_tactic(ctx_, tactic);
+    Z3_solver_inc_ref(ctx_, solver);
+    for (Z3_tactic held : tactics) {
+      Z3_tactic_dec_ref(ctx_, held);
+    }
+    CheckQuery(solver, cancelled);
+  }
+
+  void RunDefaultSmt(const std::atomic<bool>& cancelled) {
+    Z3_solver solver = Z3_mk_solver(ctx_);
+    Z3_solver_inc_ref(ctx_, solver);
+    CheckQuery(solver, cancelled);
+  }
+
+  void RunPerOutputBit(const std::atomic<bool>& cancelled) {
+    Z3_solver solver = Z3_mk_solver(ctx_);
+    Z3_solver_inc_ref(ctx_, solver);
+    for (Z3_ast constraint : constraints_) {
+      Z3_solver_assert(ctx_, solver, constraint);
+    }
+    result_.result = Z3_L_FALSE;
+    for (Z3_ast disjunct : disjuncts_) {
+      Z3_solver_push(ctx_, solver);
+      Z3_solver_assert(ctx_, solver, disjunct);
+      Z3_lbool satisfiable = Check(solver, cancelled);
+      Z3_solver_pop(ctx_, solver, 1);
+      if (satisfiable != Z3_L_FALSE) {
+        result_.result = satisfiable;
+        break;
+      }
+    }
+    Z3_solver_dec_ref(ctx_, solver);
+  }
+
+  absl::Duration timeout_;
+  absl::Time deadline_;
+  Z3_context ctx_;
+  std::vector<Z3_ast> constraints_;
+  std::vector<Z3_ast> disjuncts_;
+  PortfolioStrategyResult result_;
+  std::optional<Z3_model> model_;
+};
+
+// Tracks which strategy answered first.
+struct Race {
+  bool Decided() const ABSL_SHARED_LOCKS_REQUIRED(mutex) {
+    return winner.has_value() || finished == run_count;
+  }
+  bool AllFinished() const ABSL_SHARED_LOCKS_REQUIRED(mutex) {
+    return finished == run_count;
+  }
+
+  absl::Mutex mutex;
+  std::optional<int64_t> winner ABSL_GUARDED_BY(mutex);
+  int64_t finished ABSL_GUARDED_BY(mutex) = 0;
+  int64_t run_count = 0;
+  std::atomic<bool> cancelled = false;
+};
+
+}  // namespace
+
+std::string_view PortfolioStrategyToString(PortfolioStrategy strategy) {
+  switch (strategy) {
+    case PortfolioStrategy::kBitBlastSat:
+      return "bit-blast-sat";
+    case PortfolioStrategy::kDefaultSmt:
+      return "default-smt";
+    case PortfolioStrategy::kPerOutputBit:
+      return "per-output-bit";
+  }
+  return "invalid";
+}
+
+std::string PortfolioStrategyResult::ToString() const {
+  std::string output =
+      absl::StrFormat("%s: %s in %s", PortfolioStrategyToString(strategy),
+                      LboolToString(result), absl::FormatDuration(elapsed));
+  if (result == Z3_L_UNDEF && !reason_unknown.empty()) {
+    absl::StrAppendFormat(&output, " (%s)", reason_unknown);
+  }
+  return output;
+}
+
+absl::StatusOr<PortfolioResult> CheckSatPortfolio(
+    Z3_context ctx, absl::Span<const Z3_ast> constraints,
+    absl::Span<const Z3_ast> disjuncts, absl::Duration timeout,
+    absl::Span<const PortfolioStrategy> strategies) {
+  XLS_RET_CHECK(!strategies.empty());
+  // Translation reads `ctx`, so it happens before any thread starts.
+  std::vector<std::unique_ptr<StrategyRun>> runs;
+  runs.reserve(strategies.size());
+  for (PortfolioStrategy strategy : strategies) {
+    runs.push_back(std::make_unique<StrategyRun>(strategy, ctx, constraints,
+                                                 disjuncts, timeout));
+  }
+
+  Race race;
+  race.run_count = runs.size();
+  std::vector<std::unique_ptr<Thread>> threads;
+  threads.reserve(runs.size());
+  for (int64_t i = 0; i < runs.size(); ++i) {
+    threads.push_back(std::make_unique<Thread>([&race, &runs, i]() {
+      runs[i]->Run(race.cancelled);
+      absl::MutexLock lock(&race.mutex);
+      ++race.finished;
+      if (!race.winner.has_value() &&
+          runs[i]->result().result != Z3_L_UNDEF) {
+        race.winner = i;
+      }
+    }));
+  }
+  {
+    absl::MutexLock lock(&race.mutex);
+    race.mutex.Await(absl::Condition(&race, &Race::Decided));
+    race.cancelled.store(true);
+    while (!race.AllFinished()) {
+      for (const std::unique_ptr<StrategyRun>& run : runs) {
+        run->Interrupt();
+      }
+      race.mutex.AwaitWithTimeout(absl::Condition(&race, &Race::AllFinished),
+                                  kInterruptPeriod);
+    }
+  }
+  for (std::unique_ptr<Thread>& thread : threads) {
+    thread->Join();
+  }
+
+  PortfolioResult result;
+  for (const std::unique_ptr<StrategyRun>& run : runs) {
+    result.strategy_results.push_back(run->result());
+  }
+  std::optional<int64_t> winner;
+  {
+    absl::MutexLock lock(&race.mutex);
+    winner = race.winner;
+  }
+  if (winner.has_value()) {
+    const StrategyRun& run = *runs[*winner];
+    result.result = run.result().result;
+    result.winner = run.result().strategy;
+    if (run.model().has_value()) {
+      Z3_model model = Z3_model_translate(run.ctx(), *run.model(), ctx);
+      Z3_model_inc_ref(ctx, model);
+      result.model = model;
+    }
+  }
+  return result;
+}
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
@@ -0,0 +1,95 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+// Races several ways of deciding a Z3 query against each other; large
+// datapaths often time out under one strategy but are quickly decided by
+// another.
+#ifndef XLS_SOLVERS_Z3_PORTFOLIO_H_
+#define XLS_SOLVERS_Z3_PORTFOLIO_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "z3/src/api/z3.h"  // IWYU pragma: keep
+#include "z3/src/api/z3_api.h"
+
+namespace xls {
+namespace solvers {
+namespace z3 {
+
+enum class PortfolioStrategy : uint8_t {
+  // Simplifies and bit-blasts the query and decides it with the SAT solver.
+  kBitBlastSat,
+  // Z3's default SMT solver.
+  kDefaultSmt,
+  // Decides each disjunct of the query (e.g., the mismatch of each output bit)
+  // separately with the default solver, stopping at the first satisfiable one.
+  kPerOutputBit,
+};
+
+inline constexpr PortfolioStrategy kAllPortfolioStrategies[] = {
+    PortfolioStrategy::kBitBlastSat,
+    PortfolioStrategy::kDefaultSmt,
+    PortfolioStrategy::kPerOutputBit,
+};
+
+std::string_view PortfolioStrategyToString(PortfolioStrategy strategy);
+
+// How a single strategy of a portfolio fared.
+struct PortfolioStrategyResult {
+  PortfolioStrategy strategy;
+  // Z3_L_UNDEF if the strategy timed out, gave up, or was interrupted because
+  // another strategy answered first.
+  Z3_lbool result = Z3_L_UNDEF;
+  absl::Duration elapsed;
+  // Z3's explanation for an undefined result.
+  std::string reason_unknown;
+
+  std::string ToString() const;
+};
+
+struct PortfolioResult {
+  // Z3_L_UNDEF if no strategy reached a definitive answer.
+  Z3_lbool result = Z3_L_UNDEF;
+  std::optional<PortfolioStrategy> winner;
+  // For a satisfiable query, the winner's model translated into the context of
+  // the query. The caller owns a reference to it.
+  std::optional<Z3_model> model;
+  // One entry per strategy, in the order the strategies were given.
+  std::vector<PortfolioStrategyResult> strategy_results;
+};
+
+// Decides whether the conjunction of `constraints` and the disjunction of
+// `disjuncts`, all boolean terms of `ctx`, is satisfiable. Each of `strategies`
+// runs in its own thread on a translation of the query into its own context;
+// the first definitive answer is returned, and the remaining strategies are
+// interrupted. `ctx` must not be used by other threads during the call.
+absl::StatusOr<PortfolioResult> CheckSatPortfolio(
+    Z3_context ctx, absl::Span<const Z3_ast> constraints,
+    absl::Span<const Z3_ast> disjuncts,
+    absl::Duration timeout = absl::InfiniteDuration(),
+    absl::Span<const PortfolioStrategy> strategies = kAllPortfolioStrategies);
+
+}  // namespace z3
+}  // namespace solvers
+}  // namespace xls
+
+#endif  // XLS_SOLVERS_Z3_PORTFOLIO_H_
@@ -0,0 +1,126 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/solvers/z3_portfolio.h"
+
+#include <cstdint>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/time.h"
+#include "xls/common/status/matchers.h"
+#include "z3/src/api/z3.h"  // IWYU pragma: keep
+#include "z3/src/api/z3_api.h"
+
+namespace xls::solvers::z3 {
+namespace {
+
+using ::testing::Optional;
+using ::testing::SizeIs;
+
+class Z3PortfolioTest : public testing::Test {
+ public:
+  Z3PortfolioTest() {
+    config_ = Z3_mk_config();
+    ctx_ = Z3_mk_context(config_);
+    x_ = MakeBitVector("x");
+    y_ = MakeBitVector("y");
+  }
+
+  ~Z3PortfolioTest() override {
+    Z3_del_context(ctx_);
+    Z3_del_config(config_);
+  }
+
+ protected:
+  Z3_ast MakeBitVector(const char* name) {
+    return Z3_mk_const(ctx_, Z3_mk_string_symbol(ctx_, name),
+                       Z3_mk_bv_sort(ctx_, 8));
+  }
+  Z3_ast Literal(int64_t value) {
+    return Z3_mk_int64(ctx_, value, Z3_mk_bv_sort(ctx_, 8));
+  }
+  Z3_ast Ne(Z3_ast a, Z3_ast b) {
+    return Z3_mk_not(ctx_, Z3_mk_eq(ctx_, a, b));
+  }
+
+  Z3_config config_;
+  Z3_context ctx_;
+  Z3_ast x_;
+  Z3_ast y_;
+};
+
+TEST_F(Z3PortfolioTest, ProvesUnsatisfiable) {
+  std::vector<Z3_ast> disjuncts = {
+      Ne(Z3_mk_bvmul(ctx_, x_, y_), Z3_mk_bvmul(ctx_, y_, x_)),
+      Ne(Z3_mk_bvadd(ctx_, x_, y_), Z3_mk_bvadd(ctx_, y_, x_)),
+  };
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      CheckSatPortfolio(ctx_, /*constraints=*/{}, disjuncts));
+  EXPECT_EQ(result.result, Z3_L_FALSE);
+  EXPECT_TRUE(result.winner.has_value());
+  EXPECT_FALSE(result.model.has_value());
+  EXPECT_THAT(result.strategy_results, SizeIs(3));
+}
+
+TEST_F(Z3PortfolioTest, FindsModelUnderConstraints) {
+  std::vector<Z3_ast> constraints = {Z3_mk_bvugt(ctx_, x_, Literal(200))};
+  std::vector<Z3_ast> disjuncts = {Ne(x_, Literal(255)), Ne(y_, Literal(0))};
+  XLS_ASSERT_OK_AND_ASSIGN(PortfolioResult result,
+                           CheckSatPortfolio(ctx_, constraints, disjuncts));
+  ASSERT_EQ(result.result, Z3_L_TRUE);
+  ASSERT_TRUE(result.model.has_value());
+  std::vector<Z3_ast> query = {
+      constraints[0], Z3_mk_or(ctx_, disjuncts.size(), disjuncts.data())};
+  Z3_ast satisfied = Z3_mk_and(ctx_, query.size(), query.data());
+  Z3_ast value;
+  ASSERT_TRUE(Z3_model_eval(ctx_, *result.model, satisfied,
+                            /*model_completion=*/true, &value));
+  EXPECT_EQ(Z3_get_bool_value(ctx_, value), Z3_L_TRUE);
+  Z3_model_dec_ref(ctx_, *result.model);
+}
+
+TEST_F(Z3PortfolioTest, RunsOnlyGivenStrategies) {
+  std::vector<Z3_ast> disjuncts = {Ne(x_, x_), Ne(y_, y_)};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      CheckSatPortfolio(ctx_, /*constraints=*/{}, disjuncts,
+                        absl::InfiniteDuration(),
+                        {PortfolioStrategy::kPerOutputBit}));
+  EXPECT_EQ(result.result, Z3_L_FALSE);
+  EXPECT_THAT(result.winner, Optional(PortfolioStrategy::kPerOutputBit));
+  ASSERT_THAT(result.strategy_results, SizeIs(1));
+  EXPECT_EQ(result.strategy_results[0].result, Z3_L_FALSE);
+}
+
+TEST_F(Z3PortfolioTest, ReportsUndefinedWithoutTime) {
+  std::vector<Z3_ast> disjuncts = {Ne(x_, y_)};
+  XLS_ASSERT_OK_AND_ASSIGN(
+      PortfolioResult result,
+      CheckSatPortfolio(ctx_, /*constraints=*/{}, disjuncts,
+                        absl::ZeroDuration()));
+  EXPECT_EQ(result.result, Z3_L_UNDEF);
+  EXPECT_FALSE(result.winner.has_value());
+  for (const PortfolioStrategyResult& strategy_result :
+       result.strategy_results) {
+    EXPECT_EQ(strategy_result.result, Z3_L_UNDEF);
+    EXPECT_EQ(strategy_result.reason_unknown, "timeout");
+  }
+}
+
+}  // namespace
+}  // namespace xls::solvers::z3
@@ -117,6 +117,13 @@ Z3_solver CreateSolver(Z3_context ctx, int num_threads) {
 
 std::string SolverResultToString(Z3_context ctx, Z3_solver solver,
                                  Z3_lbool satisfiable, bool hexify) {
+  Z3_model model = satisfiable == Z3_L_TRUE ? Z3_solver_get_model(ctx, solver)
+                                            : nullptr;
+  return SolverResultToString(ctx, model, satisfiable, hexify);
+}
+
+std::string SolverResultToString(Z3_context ctx, Z3_model model,
+                                 Z3_lbool satisfiable, bool hexify) {
   std::string result_str;
   switch (satisfiable) {
     case Z3_L_TRUE:
@@ -135,7 +142,6 @@ std::string SolverResultToString(Z3_context ctx, Z3_solver solver,
   std::string output =
       absl::StrFormat("Solver result; satisfiable: %s\n", result_str);
   if (satisfiable == Z3_L_TRUE) {
-    Z3_model model = Z3_solver_get_model(ctx, solver);
     absl::StrAppend(&output, "\n  Model:\n```", Z3_model_to_string(ctx, model),
                     "```");
   }
@@ -65,6 +65,11 @@ Z3_solver CreateSolver(Z3_context ctx, int num_threads);
 std::string SolverResultToString(Z3_context ctx, Z3_solver solver,
                                  Z3_lbool satisfiable, bool hexify = true);
 
+// As above, but prints the given model, which is only used (and so may be
+// null) when "satisfiable" is Z3_L_TRUE.
+std::string SolverResultToString(Z3_context ctx, Z3_model model,
+                                 Z3_lbool satisfiable, bool hexify = true);
+
 // Returns a string representation of the given node interpreted under the given
 // model.
 // If "hexify" is true, then all output values will be converted from boolean or
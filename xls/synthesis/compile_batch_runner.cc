@@ -0,0 +1,137 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/compile_batch_runner.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "google/protobuf/io/coded_stream.h"
+#include "google/protobuf/io/zero_copy_stream_impl_lite.h"
+#include "grpcpp/support/status.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+// Returns the deterministic serialization of `request`, which identifies it in
+// the cache.
+std::string CacheKey(const CompileRequest& request) {
+  std::string key;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&key);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    coded_stream.SetSerializationDeterministic(true);
+    request.SerializeToCodedStream(&coded_stream);
+  }
+  return key;
+}
+
+}  // namespace
+
+CompileBatchRunner::CompileBatchRunner(CompileFn compile, int64_t num_workers,
+                                       int64_t max_cache_entries)
+    : compile_(std::move(compile)),
+      max_cache_entries_(max_cache_entries),
+      pool_(num_workers) {}
+
+absl::StatusOr<CompileResponse> CompileBatchRunner::CompileCached(
+    const CompileRequest& request) {
+  if (max_cache_entries_ <= 0) {
+    return compile_(request);
+  }
+  std::string key = CacheKey(request);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+      ++cache_hits_;
+      return it->second;
+    }
+  }
+  absl::StatusOr<CompileResponse> response = compile_(request);
+  if (response.ok()) {
+    absl::MutexLock lock(&mutex_);
+    if (cache_.try_emplace(key, *response).second) {
+      cache_order_.push_back(std::move(key));
+      if (static_cast<int64_t>(cache_order_.size()) > max_cache_entries_) {
+        cache_.erase(cache_order_.front());
+        cache_order_.pop_front();
+      }
+    }
+  }
+  return response;
+}
+
+absl::StatusOr<CompileResponse> CompileBatchRunner::Compile(
+    const CompileRequest& request) {
+  absl::StatusOr<CompileResponse> response;
+  absl::BlockingCounter done(1);
+  pool_.Schedule([&]() {
+    response = CompileCached(request);
+    done.DecrementCount();
+  });
+  done.Wait();
+  return response;
+}
+
+CompileBatchResponse CompileBatchRunner::CompileBatch(
+    const CompileBatchRequest& batch) {
+  std::vector<absl::StatusOr<CompileResponse>> responses(
+      batch.requests_size());
+  absl::BlockingCounter done(batch.requests_size());
+  for (int64_t i = 0; i < batch.requests_size(); ++i) {
+    pool_.Schedule([&, i]() {
+      responses[i] = CompileCached(batch.requests(i));
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+
+  CompileBatchResponse result;
+  for (absl::StatusOr<CompileResponse>& response : responses) {
+    CompileResult* compile_result = result.add_results();
+    compile_result->set_status_code(
+        static_cast<int32_t>(response.status().code()));
+    if (response.ok()) {
+      *compile_result->mutable_response() = *std::move(response);
+    } else {
+      compile_result->set_error_message(response.status().message());
+    }
+  }
+  return result;
+}
+
+int64_t CompileBatchRunner::cache_hits() const {
+  absl::MutexLock lock(&mutex_);
+  return cache_hits_;
+}
+
+::grpc::Status ToGrpcStatus(const absl::Status& status) {
+  if (status.ok()) {
+    return ::grpc::Status::OK;
+  }
+  return ::grpc::Status(grpc::StatusCode::INTERNAL,
+                        std::string(status.message()));
+}
+
+}  // namespace synthesis
+}  // namespace xls
@@ -0,0 +1,83 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_SYNTHESIS_COMPILE_BATCH_RUNNER_H_
+#define XLS_SYNTHESIS_COMPILE_BATCH_RUNNER_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/thread_pool.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+
+// Runs the compile requests of a synthesis server on a fixed pool of workers,
+// so concurrent `Compile` and `CompileBatch` RPCs share (and are bounded by)
+// the same set of synthesis jobs. Successful responses are cached keyed on the
+// complete request (Verilog text, top module and target frequency), so sweeps
+// which revisit a design point do not re-run synthesis.
+//
+// CompileBatchRunner is thread-safe.
+class CompileBatchRunner {
+ public:
+  using CompileFn =
+      std::function<absl::StatusOr<CompileResponse>(const CompileRequest&)>;
+
+  // `compile` must be safe to call concurrently. If `num_workers` is zero or
+  // negative, AvailableCPUs() workers are used. At most `max_cache_entries`
+  // responses are cached (oldest evicted first); zero disables the cache.
+  CompileBatchRunner(CompileFn compile, int64_t num_workers,
+                     int64_t max_cache_entries);
+
+  // Compiles a single request on the worker pool, blocking until it finishes.
+  absl::StatusOr<CompileResponse> Compile(const CompileRequest& request);
+
+  // Compiles every request of `batch` on the worker pool and blocks until all
+  // of them finish.
+  CompileBatchResponse CompileBatch(const CompileBatchRequest& batch);
+
+  int64_t cache_hits() const;
+
+ private:
+  // Compiles `request` on the calling thread, consulting the cache.
+  absl::StatusOr<CompileResponse> CompileCached(const CompileRequest& request);
+
+  CompileFn compile_;
+  int64_t max_cache_entries_;
+  ThreadPool pool_;
+
+  mutable absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, CompileResponse> cache_
+      ABSL_GUARDED_BY(mutex_);
+  // Keys of `cache_` in insertion order, for eviction.
+  std::deque<std::string> cache_order_ ABSL_GUARDED_BY(mutex_);
+  int64_t cache_hits_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Converts the status of a compile request into the status of its RPC.
+::grpc::Status ToGrpcStatus(const absl::Status& status);
+
+}  // namespace synthesis
+}  // namespace xls
+
+#endif  // XLS_SYNTHESIS_COMPILE_BATCH_RUNNER_H_
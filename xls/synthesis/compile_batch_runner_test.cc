@@ -0,0 +1,136 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/synthesis/compile_batch_runner.h"
+
+#include <atomic>
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/matchers.h"
+#include "xls/synthesis/synthesis.pb.h"
+
+namespace xls {
+namespace synthesis {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::testing::Property;
+
+CompileRequest MakeRequest(int64_t target_frequency_hz) {
+  CompileRequest request;
+  request.set_module_text("module foo(); endmodule");
+  request.set_top_module_name("foo");
+  request.set_target_frequency_hz(target_frequency_hz);
+  return request;
+}
+
+// Fake synthesis which reports the target frequency as the slack and fails
+// for a target frequency of zero.
+absl::StatusOr<CompileResponse> FakeCompile(const CompileRequest& request) {
+  if (request.target_frequency_hz() == 0) {
+    return absl::InvalidArgumentError("no target frequency");
+  }
+  CompileResponse response;
+  response.set_slack_ps(request.target_frequency_hz());
+  return response;
+}
+
+TEST(CompileBatchRunnerTest, CompilesBatchInOrder) {
+  CompileBatchRunner runner(FakeCompile, /*num_workers=*/4,
+                            /*max_cache_entries=*/0);
+  CompileBatchRequest batch;
+  for (int64_t i = 1; i <= 20; ++i) {
+    *batch.add_requests() = MakeRequest(i);
+  }
+  CompileBatchResponse response = runner.CompileBatch(batch);
+  ASSERT_EQ(response.results_size(), 20);
+  for (int64_t i = 0; i < 20; ++i) {
+    EXPECT_EQ(response.results(i).status_code(), 0);
+    EXPECT_EQ(response.results(i).response().slack_ps(), i + 1);
+  }
+}
+
+TEST(CompileBatchRunnerTest, FailuresDoNotFailTheBatch) {
+  CompileBatchRunner runner(FakeCompile, /*num_workers=*/2,
+                            /*max_cache_entries=*/0);
+  CompileBatchRequest batch;
+  *batch.add_requests() = MakeRequest(0);
+  *batch.add_requests() = MakeRequest(5);
+  CompileBatchResponse response = runner.CompileBatch(batch);
+  ASSERT_EQ(response.results_size(), 2);
+  EXPECT_EQ(response.results(0).status_code(),
+            static_cast<int32_t>(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(response.results(0).error_message(),
+              HasSubstr("no target frequency"));
+  EXPECT_FALSE(response.results(0).has_response());
+  EXPECT_EQ(response.results(1).response().slack_ps(), 5);
+}
+
+TEST(CompileBatchRunnerTest, CachesIdenticalRequests) {
+  std::atomic<int64_t> compiles = 0;
+  CompileBatchRunner runner(
+      [&](const CompileRequest& request) {
+        ++compiles;
+        return FakeCompile(request);
+      },
+      /*num_workers=*/2, /*max_cache_entries=*/8);
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse first,
+                           runner.Compile(MakeRequest(7)));
+  EXPECT_EQ(first.slack_ps(), 7);
+  XLS_ASSERT_OK_AND_ASSIGN(CompileResponse second,
+                           runner.Compile(MakeRequest(7)));
+  EXPECT_EQ(second.slack_ps(), 7);
+  EXPECT_EQ(compiles, 1);
+  EXPECT_EQ(runner.cache_hits(), 1);
+
+  // A different target frequency is a different design point.
+  XLS_ASSERT_OK(runner.Compile(MakeRequest(8)).status());
+  EXPECT_EQ(compiles, 2);
+
+  // Failures are not cached.
+  EXPECT_THAT(runner.Compile(MakeRequest(0)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(runner.Compile(MakeRequest(0)),
+              StatusIs(absl::StatusCode::kInvalidArgument));
+  EXPECT_EQ(compiles, 4);
+}
+
+TEST(CompileBatchRunnerTest, EvictsOldestCacheEntry) {
+  std::atomic<int64_t> compiles = 0;
+  CompileBatchRunner runner(
+      [&](const CompileRequest& request) {
+        ++compiles;
+        return FakeCompile(request);
+      },
+      /*num_workers=*/1, /*max_cache_entries=*/2);
+  for (int64_t frequency : {1, 2, 3, 1}) {
+    XLS_ASSERT_OK(runner.Compile(MakeRequest(frequency)).status());
+  }
+  EXPECT_EQ(compiles, 4);
+  EXPECT_EQ(runner.cache_hits(), 0);
+  EXPECT_THAT(runner.Compile(MakeRequest(3)),
+              IsOkAndHolds(Property(&CompileResponse::slack_ps, 3)));
+  EXPECT_EQ(runner.cache_hits(), 1);
+}
+
+}  // namespace
+}  // namespace synthesis
+}  // namespace xls
@@ -82,6 +82,24 @@ class FakeSynthesisServiceImpl : public SynthesisService::Service {
     return ::grpc::Status::OK;
   }
 
+  ::grpc::Status CompileBatch(::grpc::ServerContext* server_context,
+                              const CompileBatchRequest* request,
+                              CompileBatchResponse* result) override {
+    for (const CompileRequest& compile_request : request->requests()) {
+      CompileResult* compile_result = result->add_results();
+      ::grpc::Status status =
+          Compile(server_context, &compile_request,
+                  compile_result->mutable_response());
+      compile_result->set_status_code(
+          static_cast<int32_t>(status.error_code()));
+      if (!status.ok()) {
+        compile_result->clear_response();
+        compile_result->set_error_message(status.error_message());
+      }
+    }
+    return ::grpc::Status::OK;
+  }
+
  private:
   int64_t max_frequency_hz_;
   bool serve_errors_;
@@ -12,10 +12,9 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
-#include <stdlib.h>  // NOLINT (for setenv)
-
 #include <cmath>
 #include <cstdint>
+#include <cstdlib>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <string>
@@ -25,8 +24,10 @@
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "grpcpp/security/server_credentials.h"
@@ -39,6 +40,7 @@
 #include "xls/common/file/temp_directory.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/synthesis/compile_batch_runner.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
@@ -56,31 +58,56 @@ ABSL_FLAG(int32_t, port, 10000, "Port to listen on.");
 ABSL_FLAG(std::string, metrics_command, "bazel run :dummy_metrics_main",
           "Command to run to generate JSON synthesis metrics.");
 ABSL_FLAG(bool, save_temps, false, "Do not delete temporary files.");
+ABSL_FLAG(int64_t, num_workers, 0,
+          "Number of metrics commands to run concurrently. If zero, the "
+          "number of available CPUs is used.");
+ABSL_FLAG(int64_t, max_cache_entries, 1024,
+          "Maximum number of synthesis responses to cache; zero disables the "
+          "cache.");
 
 namespace xls {
 namespace synthesis {
 namespace {
 
+// Returns `value` quoted for use as a single word in a shell command.
+std::string ShellQuote(std::string_view value) {
+  return absl::StrCat("'", absl::StrReplaceAll(value, {{"'", "'\\''"}}), "'");
+}
+
 // Service implementation that dispatches compile requests.
 class JsonMetricsSynthesisServiceImpl : public SynthesisService::Service {
  public:
-  explicit JsonMetricsSynthesisServiceImpl(std::string_view metrics_command)
-      : metrics_command_(metrics_command) {}
+  explicit JsonMetricsSynthesisServiceImpl(std::string_view metrics_command,
+                                           int64_t num_workers,
+                                           int64_t max_cache_entries)
+      : metrics_command_(metrics_command),
+        runner_(
+            [this](const CompileRequest& request)
+                -> absl::StatusOr<CompileResponse> {
+              auto start = absl::Now();
+              CompileResponse result;
+              XLS_RETURN_IF_ERROR(RunMetrics(&request, &result));
+              result.set_elapsed_runtime_ms(
+                  absl::ToInt64Milliseconds(absl::Now() - start));
+              return result;
+            },
+            num_workers, max_cache_entries) {}
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override {
-    auto start = absl::Now();
-
-    absl::Status metrics_status = RunMetrics(request, result);
-    if (!metrics_status.ok()) {
-      return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                            std::string(metrics_status.message()));
+    absl::StatusOr<CompileResponse> response = runner_.Compile(*request);
+    if (!response.ok()) {
+      return ToGrpcStatus(response.status());
     }
+    *result = *std::move(response);
+    return ::grpc::Status::OK;
+  }
 
-    result->set_elapsed_runtime_ms(
-        absl::ToInt64Milliseconds(absl::Now() - start));
-
+  ::grpc::Status CompileBatch(::grpc::ServerContext* server_context,
+                              const CompileBatchRequest* request,
+                              CompileBatchResponse* result) override {
+    *result = runner_.CompileBatch(*request);
     return ::grpc::Status::OK;
   }
 
@@ -96,19 +123,20 @@ class JsonMetricsSynthesisServiceImpl : public SynthesisService::Service {
     XLS_RETURN_IF_ERROR(SetFileContents(verilog_path, request->module_text()));
 
     double clock_period_ps = 1e12 / request->target_frequency_hz();
-    setenv("CONSTANT_CLOCK_PORT", "clk", 1);
-    setenv("CONSTANT_CLOCK_PERIOD_PS", absl::StrCat(clock_period_ps).c_str(),
-           1);
-    setenv("CONSTANT_TOP", request->top_module_name().c_str(), 1);
-    setenv("INPUT_RTL", verilog_path.c_str(), 1);
-
     std::filesystem::path netlist_path = temp_dir_path / "netlist.v";
-    setenv("OUTPUT_NETLIST", netlist_path.c_str(), 1);
-
     std::filesystem::path metrics_path = temp_dir_path / "metrics.json";
-    setenv("OUTPUT_METRICS", metrics_path.c_str(), 1);
 
-    if (EXIT_SUCCESS != system(metrics_command_.c_str())) {
+    // Requests may run concurrently, so the metrics command's environment is
+    // exported by its own shell rather than through setenv.
+    std::string command = absl::StrCat(
+        "export CONSTANT_CLOCK_PORT=clk CONSTANT_CLOCK_PERIOD_PS=",
+        ShellQuote(absl::StrCat(clock_period_ps)),
+        " CONSTANT_TOP=", ShellQuote(request->top_module_name()),
+        " INPUT_RTL=", ShellQuote(verilog_path.string()),
+        " OUTPUT_NETLIST=", ShellQuote(netlist_path.string()),
+        " OUTPUT_METRICS=", ShellQuote(metrics_path.string()), "; ",
+        metrics_command_);
+    if (EXIT_SUCCESS != system(command.c_str())) {
       return absl::InternalError(absl::StrCat(
           "Metrics command \"", metrics_command_, "\" execution failed"));
     }
@@ -145,12 +173,15 @@ class JsonMetricsSynthesisServiceImpl : public SynthesisService::Service {
 
  private:
   std::string metrics_command_;
+  CompileBatchRunner runner_;
 };
 
 void RealMain() {
   int port = absl::GetFlag(FLAGS_port);
   const std::string server_address = absl::StrCat("0.0.0.0:", port);
-  JsonMetricsSynthesisServiceImpl service(absl::GetFlag(FLAGS_metrics_command));
+  JsonMetricsSynthesisServiceImpl service(
+      absl::GetFlag(FLAGS_metrics_command), absl::GetFlag(FLAGS_num_workers),
+      absl::GetFlag(FLAGS_max_cache_entries));
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
@@ -16,14 +16,18 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "grpcpp/channel.h"
 #include "grpcpp/client_context.h"
 #include "grpcpp/create_channel.h"
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/status.h"
+#include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/synthesis/credentials.h"
 #include "xls/synthesis/synthesis.pb.h"
@@ -60,5 +64,38 @@ absl::StatusOr<CompileResponse> SynthesizeViaClient(
   return response;
 }
 
+absl::StatusOr<std::vector<absl::StatusOr<CompileResponse>>>
+SynthesizeBatchViaClient(const std::string& server,
+                         absl::Span<const CompileRequest> requests) {
+  std::shared_ptr<grpc::ChannelCredentials> creds = GetChannelCredentials();
+  std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(server, creds);
+  std::unique_ptr<SynthesisService::Stub> stub(
+      SynthesisService::NewStub(channel));
+  grpc::ClientContext context;
+
+  CompileBatchRequest batch;
+  batch.mutable_requests()->Reserve(requests.size());
+  for (const CompileRequest& request : requests) {
+    *batch.add_requests() = request;
+  }
+  CompileBatchResponse batch_response;
+  XLS_RETURN_IF_ERROR(GrpcToAbslStatus(
+      stub->CompileBatch(&context, batch, &batch_response)));
+  XLS_RET_CHECK_EQ(batch_response.results_size(), requests.size());
+
+  std::vector<absl::StatusOr<CompileResponse>> responses;
+  responses.reserve(requests.size());
+  for (CompileResult& result : *batch_response.mutable_results()) {
+    if (result.status_code() == 0) {
+      responses.push_back(std::move(*result.mutable_response()));
+    } else {
+      responses.push_back(absl::Status(
+          static_cast<absl::StatusCode>(result.status_code()),
+          result.error_message()));
+    }
+  }
+  return responses;
+}
+
 }  // namespace synthesis
 }  // namespace xls
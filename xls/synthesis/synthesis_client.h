@@ -16,8 +16,10 @@
 #define XLS_SYNTHESIS_SYNTHESIS_CLIENT_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "xls/synthesis/synthesis.pb.h"
 
 namespace xls {
@@ -27,6 +29,13 @@ namespace synthesis {
 absl::StatusOr<CompileResponse> SynthesizeViaClient(
     const std::string& server, const CompileRequest& request);
 
+// Sends all of `requests` to the server in a single CompileBatch RPC, letting
+// the server synthesize them concurrently. Returns the result of each request
+// in order; an error is returned only if the RPC itself fails.
+absl::StatusOr<std::vector<absl::StatusOr<CompileResponse>>>
+SynthesizeBatchViaClient(const std::string& server,
+                         absl::Span<const CompileRequest> requests);
+
 }  // namespace synthesis
 }  // namespace xls
 
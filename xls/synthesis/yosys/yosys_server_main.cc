@@ -66,6 +66,12 @@ ABSL_FLAG(std::string, default_driver_cell, "",
           "The default driver cell to use during synthesis.");
 ABSL_FLAG(std::string, default_load, "",
           "The default load cell to use during synthesis.");
+ABSL_FLAG(int64_t, num_workers, 0,
+          "Number of synthesis jobs to run concurrently. If zero, the number "
+          "of available CPUs is used.");
+ABSL_FLAG(int64_t, max_cache_entries, 1024,
+          "Maximum number of synthesis responses to cache; zero disables the "
+          "cache.");
 
 namespace xls {
 namespace synthesis {
@@ -113,7 +119,8 @@ void RealMain() {
       yosys_path, nextpnr_path, synthesis_target, sta_path, synthesis_libraries,
       sta_libraries, absl::GetFlag(FLAGS_default_driver_cell),
       absl::GetFlag(FLAGS_default_load), absl::GetFlag(FLAGS_save_temps),
-      absl::GetFlag(FLAGS_return_netlist), synthesis_only);
+      absl::GetFlag(FLAGS_return_netlist), synthesis_only,
+      absl::GetFlag(FLAGS_num_workers), absl::GetFlag(FLAGS_max_cache_entries));
 
   ::grpc::ServerBuilder builder;
   std::shared_ptr<::grpc::ServerCredentials> creds = GetServerCredentials();
@@ -39,6 +39,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/synthesis/compile_batch_runner.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/yosys/yosys_util.h"
 
@@ -48,18 +49,32 @@ namespace synthesis {
 ::grpc::Status YosysSynthesisServiceImpl::Compile(
     ::grpc::ServerContext* server_context, const CompileRequest* request,
     CompileResponse* result) {
+  absl::StatusOr<CompileResponse> response = runner_.Compile(*request);
+  if (!response.ok()) {
+    return ToGrpcStatus(response.status());
+  }
+  *result = *std::move(response);
+  return ::grpc::Status::OK;
+}
+
+::grpc::Status YosysSynthesisServiceImpl::CompileBatch(
+    ::grpc::ServerContext* server_context, const CompileBatchRequest* request,
+    CompileBatchResponse* result) {
+  *result = runner_.CompileBatch(*request);
+  return ::grpc::Status::OK;
+}
+
+absl::StatusOr<CompileResponse> YosysSynthesisServiceImpl::CompileUncached(
+    const CompileRequest& request) const {
   auto start = absl::Now();
 
-  absl::Status synthesis_status = RunSynthesis(request, result);
-  if (!synthesis_status.ok()) {
-    return ::grpc::Status(grpc::StatusCode::INTERNAL,
-                          std::string(synthesis_status.message()));
-  }
+  CompileResponse result;
+  XLS_RETURN_IF_ERROR(RunSynthesis(&request, &result));
 
-  result->set_elapsed_runtime_ms(
+  result.set_elapsed_runtime_ms(
       absl::ToInt64Milliseconds(absl::Now() - start));
 
-  return ::grpc::Status::OK;
+  return result;
 }
 
 // Run the given arguments as a subprocess with InvokeSubprocess.
@@ -15,6 +15,7 @@
 #ifndef XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 #define XLS_SYNTHESIS_YOSYS_YOSYS_SYNTHESIS_SERVICE_H_
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <string>
 #include <string_view>
@@ -26,6 +27,7 @@
 #include "grpcpp/server.h"
 #include "grpcpp/server_context.h"
 #include "grpcpp/support/status.h"
+#include "xls/synthesis/compile_batch_runner.h"
 #include "xls/synthesis/synthesis.pb.h"
 #include "xls/synthesis/synthesis_service.grpc.pb.h"
 
@@ -39,7 +41,8 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
       std::string_view synthesis_target, std::string_view sta_path,
       std::string_view synthesis_libraries, std::string_view sta_libraries,
       std::string_view default_driver_cell, std::string_view default_load,
-      bool save_temps, bool return_netlist, bool synthesis_only)
+      bool save_temps, bool return_netlist, bool synthesis_only,
+      int64_t num_workers = 0, int64_t max_cache_entries = 0)
       : yosys_path_(yosys_path),
         nextpnr_path_(nextpnr_path),
         synthesis_target_(synthesis_target),
@@ -50,12 +53,26 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
         default_load_(default_load),
         save_temps_(save_temps),
         return_netlist_(return_netlist),
-        synthesis_only_(synthesis_only) {}
+        synthesis_only_(synthesis_only),
+        runner_(
+            [this](const CompileRequest& request) {
+              return CompileUncached(request);
+            },
+            num_workers, max_cache_entries) {}
 
   ::grpc::Status Compile(::grpc::ServerContext* server_context,
                          const CompileRequest* request,
                          CompileResponse* result) override;
 
+  ::grpc::Status CompileBatch(::grpc::ServerContext* server_context,
+                              const CompileBatchRequest* request,
+                              CompileBatchResponse* result) override;
+
+  // Synthesizes `request` on the calling thread, bypassing the worker pool
+  // and the response cache.
+  absl::StatusOr<CompileResponse> CompileUncached(
+      const CompileRequest& request) const;
+
   // Run the given arguments as a subprocess with InvokeSubprocess.
   // InvokeSubprocess is wrapped because the error message can be very large (it
   // includes both stdout and stderr) which breaks propagation of the error via
@@ -103,6 +120,7 @@ class YosysSynthesisServiceImpl : public SynthesisService::Service {
   bool save_temps_;
   bool return_netlist_;
   bool synthesis_only_;
+  CompileBatchRunner runner_;
 };
 
 }  // namespace synthesis
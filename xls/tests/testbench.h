@@ -29,6 +29,7 @@
 #include "absl/synchronization/mutex.h"
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
+#include "absl/types/span.h"
 #include "xls/tests/testbench_thread.h"
 
 namespace xls {
@@ -76,6 +77,11 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   //                     are considered equivalent.
   //   log_errors      : The function to log errors when compare_results returns
   //                     false.
+  //   batch_size      : The number of inputs each worker evaluates at a time.
+  //   compute_actual_batch: If non-null, called once per batch (instead of
+  //                     compute_actual once per input) to fill in the XLS
+  //                     results for all inputs of the batch, e.g. with a
+  //                     single batched JIT invocation.
   //
   // All lambdas must be thread-safe.
   //
@@ -90,18 +96,25 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
             std::function<ResultT(ShardDataT*, InputT)> compute_expected,
             std::function<ResultT(ShardDataT*, InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t batch_size = 1,
+            std::function<void(ShardDataT*, absl::Span<const InputT>,
+                               absl::Span<ResultT>)>
+                compute_actual_batch = nullptr)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
             compare_results, log_errors),
         create_shard_(create_shard),
         compute_expected_(compute_expected),
-        compute_actual_(compute_actual) {
+        compute_actual_(compute_actual),
+        batch_size_(batch_size),
+        compute_actual_batch_(compute_actual_batch) {
     this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
           &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
           this->index_to_input_, create_shard_, compute_expected_,
-          compute_actual_, this->compare_results_, this->log_errors_);
+          compute_actual_, this->compare_results_, this->log_errors_,
+          batch_size_, compute_actual_batch_);
     };
   }
 
@@ -109,6 +122,10 @@ class Testbench : public internal::TestbenchBase<InputT, ResultT, ShardDataT> {
   std::function<std::unique_ptr<ShardDataT>()> create_shard_;
   std::function<ResultT(ShardDataT*, InputT)> compute_expected_;
   std::function<ResultT(ShardDataT*, InputT)> compute_actual_;
+  uint64_t batch_size_;
+  std::function<void(ShardDataT*, absl::Span<const InputT>,
+                     absl::Span<ResultT>)>
+      compute_actual_batch_;
 };
 
 // Shard-data-less implementation.
@@ -123,23 +140,32 @@ class Testbench<InputT, ResultT, ShardDataT,
             std::function<ResultT(InputT)> compute_expected,
             std::function<ResultT(InputT)> compute_actual,
             std::function<bool(ResultT, ResultT)> compare_results,
-            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+            std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+            uint64_t batch_size = 1,
+            std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+                compute_actual_batch = nullptr)
       : internal::TestbenchBase<InputT, ResultT, ShardDataT>(
             start, end, num_threads, max_failures, index_to_input,
             compare_results, log_errors),
         compute_expected_(compute_expected),
-        compute_actual_(compute_actual) {
+        compute_actual_(compute_actual),
+        batch_size_(batch_size),
+        compute_actual_batch_(compute_actual_batch) {
     this->thread_create_fn_ = [this](uint64_t start, uint64_t end) {
       return std::make_unique<TestbenchThread<InputT, ResultT, ShardDataT>>(
           &this->mutex_, &this->wake_me_, start, end, this->max_failures_,
           this->index_to_input_, compute_expected_, compute_actual_,
-          this->compare_results_, this->log_errors_);
+          this->compare_results_, this->log_errors_, batch_size_,
+          compute_actual_batch_);
     };
   }
 
  private:
   std::function<ResultT(InputT)> compute_expected_;
   std::function<ResultT(InputT)> compute_actual_;
+  uint64_t batch_size_;
+  std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+      compute_actual_batch_;
 };
 
 // INTERNAL IMPL ---------------------------------
@@ -44,6 +44,7 @@
 #include <thread>
 #include <type_traits>
 
+#include "absl/types/span.h"
 #include "xls/tests/testbench.h"
 #include "xls/tests/testbench_builder_utils.h"
 
@@ -56,6 +57,8 @@ class TestbenchBuilder {
  public:
   using CompareResultsFnT = std::function<bool(const ResultT&, const ResultT&)>;
   using ComputeFnT = std::function<ResultT(ShardDataT*, InputT)>;
+  using ComputeBatchFnT = std::function<void(
+      ShardDataT*, absl::Span<const InputT>, absl::Span<ResultT>)>;
   using CreateShardDataFnT = std::function<std::unique_ptr<ShardDataT>()>;
   using IndexToInputFnT = std::function<InputT(int64_t)>;
   using LogErrorsFnT = std::function<void(int64_t, InputT, ResultT, ResultT)>;
@@ -68,11 +71,27 @@ class TestbenchBuilder {
         compute_actual_(compute_actual),
         create_shard_data_(create_shard_data) {}
 
+  // Sets how many consecutive sample indices a worker thread takes at a time;
+  // a batch function set via SetComputeActualBatchFn() sees batches of at most
+  // this many inputs. Defaults to 1.
+  TestbenchBuilder& SetBatchSize(int64_t batch_size) {
+    batch_size_ = batch_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetCompareResultsFn(const CompareResultsFnT& fn) {
     compare_results_ = fn;
     return *this;
   }
 
+  // Replaces the per-input "compute actual" function with one which is given
+  // the worker's shard data and fills in the results of a whole batch of
+  // inputs, e.g. with a single FunctionJit::RunBatchedWithViews() call.
+  TestbenchBuilder& SetComputeActualBatchFn(const ComputeBatchFnT& fn) {
+    compute_actual_batch_ = fn;
+    return *this;
+  }
+
   TestbenchBuilder& SetIndexToInputFn(const IndexToInputFnT& fn) {
     index_to_input_ = fn;
     return *this;
@@ -114,8 +133,10 @@ class TestbenchBuilder {
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
   int64_t max_failures_ = 1;
+  uint64_t batch_size_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
+  ComputeBatchFnT compute_actual_batch_;
   std::optional<CompareResultsFnT> compare_results_;
   CreateShardDataFnT create_shard_data_;
   std::optional<IndexToInputFnT> index_to_input_;
@@ -132,6 +153,8 @@ class TestbenchBuilder<
  public:
   using CompareResultsFnT = std::function<bool(const ResultT&, const ResultT&)>;
   using ComputeFnT = std::function<ResultT(InputT)>;
+  using ComputeBatchFnT =
+      std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>;
   using IndexToInputFnT = std::function<InputT(int64_t)>;
   using LogErrorsFnT = std::function<void(int64_t, InputT, ResultT, ResultT)>;
   using PrintInputFnT = std::function<std::string(const InputT&)>;
@@ -140,11 +163,25 @@ class TestbenchBuilder<
   TestbenchBuilder(ComputeFnT compute_expected, ComputeFnT compute_actual)
       : compute_expected_(compute_expected), compute_actual_(compute_actual) {}
 
+  // Sets the number of inputs per batch, i.e. the largest span passed to the
+  // function set via SetComputeActualBatchFn(). Defaults to 1.
+  TestbenchBuilder& SetBatchSize(int64_t batch_size) {
+    batch_size_ = batch_size;
+    return *this;
+  }
+
   TestbenchBuilder& SetCompareResultsFn(const CompareResultsFnT& fn) {
     compare_results_ = fn;
     return *this;
   }
 
+  // Sets a function which fills in the actual results for a span of inputs in
+  // one call; when set, the per-input "compute actual" function is not used.
+  TestbenchBuilder& SetComputeActualBatchFn(const ComputeBatchFnT& fn) {
+    compute_actual_batch_ = fn;
+    return *this;
+  }
+
   TestbenchBuilder& SetIndexToInputFn(const IndexToInputFnT& fn) {
     index_to_input_ = fn;
     return *this;
@@ -186,8 +223,10 @@ class TestbenchBuilder<
   uint64_t num_samples_ = 16 * 1024;
   uint64_t num_threads_ = std::thread::hardware_concurrency();
   int64_t max_failures_ = 1;
+  uint64_t batch_size_ = 1;
   ComputeFnT compute_expected_;
   ComputeFnT compute_actual_;
+  ComputeBatchFnT compute_actual_batch_;
   std::optional<CompareResultsFnT> compare_results_;
   std::optional<IndexToInputFnT> index_to_input_;
   std::optional<PrintInputFnT> print_input_;
@@ -232,7 +271,8 @@ TestbenchBuilder<InputT, ResultT, ShardDataT, EnableT>::Build() {
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, create_shard_data_, this->compute_expected_,
-      this->compute_actual_, compare_results, log_errors);
+      this->compute_actual_, compare_results, log_errors, this->batch_size_,
+      this->compute_actual_batch_);
 }
 
 // Non-shard-data-containing Build() implementation.
@@ -272,7 +312,8 @@ Testbench<InputT, ResultT> TestbenchBuilder<
   return Testbench<InputT, ResultT, ShardDataT>(
       /*start=*/0, this->num_samples_, this->num_threads_, this->max_failures_,
       index_to_input, this->compute_expected_, this->compute_actual_,
-      compare_results, log_errors);
+      compare_results, log_errors, this->batch_size_,
+      this->compute_actual_batch_);
 }
 
 }  // namespace xls
@@ -15,16 +15,19 @@
 #ifndef XLS_TESTS_TESTBENCH_THREAD_H_
 #define XLS_TESTS_TESTBENCH_THREAD_H_
 
+#include <algorithm>
 #include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/types/span.h"
 #include "xls/common/thread.h"
 #include "xls/ir/package.h"
 
@@ -35,7 +38,9 @@ class TestbenchThreadBase;
 
 // TestbenchThread handles the work of _actually_ running tests.
 // It simply iterates over its given range of the index space and calls the
-// expected/actual calculators.
+// expected/actual calculators. The range is walked in batches of `batch_size`
+// indices; if a batched "actual" calculator is given it is called once per
+// batch, so e.g. a JIT can evaluate the whole batch in a single call.
 //
 // Just as with Testbench, TestbenchThread supports execution both with and
 // without per-shard data, and uses the same type of construct to expose an API
@@ -56,6 +61,9 @@ class TestbenchThread
   //  - generate_expected: Given an input, generates the "expected" value.
   //  - generate_actual: Given an input, generates a value from the module
   //                     under test.
+  //  - batch_size: The number of inputs to evaluate per batch.
+  //  - generate_actual_batch: If non-null, used instead of generate_actual to
+  //                           fill in the results of a whole batch of inputs.
   TestbenchThread(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
       uint64_t start_index, uint64_t end_index, uint64_t max_failures,
@@ -64,13 +72,19 @@ class TestbenchThread
       std::function<ResultT(ShardDataT*, InputT)> generate_expected,
       std::function<ResultT(ShardDataT*, InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      uint64_t batch_size = 1,
+      std::function<void(ShardDataT*, absl::Span<const InputT>,
+                         absl::Span<ResultT>)>
+          generate_actual_batch = nullptr)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
             wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            max_failures, batch_size, index_to_input, compare_results,
+            log_errors),
         create_shard_fn_(create_shard),
         generate_expected_(generate_expected),
-        generate_actual_(generate_actual) {
+        generate_actual_(generate_actual),
+        generate_actual_batch_(generate_actual_batch) {
     this->generate_expected_fn_ = [this](InputT& input) {
       return generate_expected_(shard_data_.get(), input);
     };
@@ -78,6 +92,13 @@ class TestbenchThread
     this->generate_actual_fn_ = [this](InputT& input) {
       return generate_actual_(shard_data_.get(), input);
     };
+
+    if (generate_actual_batch_) {
+      this->generate_actual_batch_fn_ = [this](absl::Span<const InputT> inputs,
+                                               absl::Span<ResultT> results) {
+        generate_actual_batch_(shard_data_.get(), inputs, results);
+      };
+    }
   }
 
   void Init() override { shard_data_ = create_shard_fn_(); }
@@ -87,6 +108,9 @@ class TestbenchThread
   std::function<std::unique_ptr<ShardDataT>()> create_shard_fn_;
   std::function<ResultT(ShardDataT*, InputT)> generate_expected_;
   std::function<ResultT(ShardDataT*, InputT)> generate_actual_;
+  std::function<void(ShardDataT*, absl::Span<const InputT>,
+                     absl::Span<ResultT>)>
+      generate_actual_batch_;
 };
 
 // And the without-shard-data case.
@@ -103,12 +127,17 @@ class TestbenchThread<
       std::function<ResultT(InputT)> generate_expected,
       std::function<ResultT(InputT)> generate_actual,
       std::function<bool(ResultT, ResultT)> compare_results,
-      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
+      std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors,
+      uint64_t batch_size = 1,
+      std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+          generate_actual_batch = nullptr)
       : TestbenchThreadBase<InputT, ResultT, ShardDataT>(
             wake_parent_mutex, wake_parent, start_index, end_index,
-            max_failures, index_to_input, compare_results, log_errors),
+            max_failures, batch_size, index_to_input, compare_results,
+            log_errors),
         generate_expected_(generate_expected),
         generate_actual_(generate_actual) {
+    this->generate_actual_batch_fn_ = generate_actual_batch;
     this->generate_expected_fn_ = [this](InputT& input) {
       return generate_expected_(input);
     };
@@ -132,7 +161,7 @@ class TestbenchThreadBase {
   TestbenchThreadBase(
       absl::Mutex* wake_parent_mutex, absl::CondVar* wake_parent,
       uint64_t start_index, uint64_t end_index, uint64_t max_failures,
-      std::function<InputT(uint64_t)> index_to_input,
+      uint64_t batch_size, std::function<InputT(uint64_t)> index_to_input,
       std::function<bool(ResultT, ResultT)> compare_results,
       std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors)
       : wake_parent_mutex_(wake_parent_mutex),
@@ -144,6 +173,7 @@ class TestbenchThreadBase {
         start_index_(start_index),
         end_index_(end_index),
         max_failures_(max_failures),
+        batch_size_(std::max<uint64_t>(batch_size, 1)),
         num_passes_(0),
         num_failures_(0),
         index_to_input_(index_to_input),
@@ -177,26 +207,58 @@ class TestbenchThreadBase {
     }
 
     running_.store(true);
-    for (uint64_t i = start_index_; i < end_index_; i++) {
+    std::vector<InputT> inputs;
+    std::vector<ResultT> actuals;
+    inputs.reserve(batch_size_);
+    uint64_t failures = 0;
+    uint64_t next_cancel_check = start_index_;
+    for (uint64_t batch_start = start_index_;
+         batch_start < end_index_ && return_status.ok();
+         batch_start += batch_size_) {
       // Don't check for cancelled on every iteration; it's a touch slow.
-      if (i % 128 == 0 && cancelled_.load()) {
-        return_status = absl::CancelledError("This thread was cancelled.");
-        break;
+      if (batch_start >= next_cancel_check) {
+        if (cancelled_.load(std::memory_order_relaxed)) {
+          return_status = absl::CancelledError("This thread was cancelled.");
+          break;
+        }
+        next_cancel_check = batch_start + kCancelCheckInterval;
       }
 
-      InputT input = index_to_input_(i);
-      ResultT expected = generate_expected_fn_(input);
-      ResultT actual = generate_actual_fn_(input);
-      if (!compare_results_(expected, actual)) {
-        num_failures_.store(num_failures_.load() + 1);
-        log_errors_(i, input, expected, actual);
-        if (max_failures_ <= num_failures_.load()) {
+      uint64_t batch_end = std::min(end_index_, batch_start + batch_size_);
+      inputs.clear();
+      for (uint64_t i = batch_start; i < batch_end; ++i) {
+        inputs.push_back(index_to_input_(i));
+      }
+      if (generate_actual_batch_fn_) {
+        actuals.resize(inputs.size());
+        generate_actual_batch_fn_(inputs, absl::MakeSpan(actuals));
+      } else {
+        actuals.clear();
+        for (InputT& input : inputs) {
+          actuals.push_back(generate_actual_fn_(input));
+        }
+      }
+
+      // Results are published once per batch so the monitoring thread only
+      // contends with us on a single (relaxed) atomic add per batch.
+      uint64_t batch_passes = 0;
+      uint64_t batch_failures = 0;
+      for (int64_t k = 0; k < inputs.size(); ++k) {
+        ResultT expected = generate_expected_fn_(inputs[k]);
+        if (compare_results_(expected, actuals[k])) {
+          ++batch_passes;
+          continue;
+        }
+        ++batch_failures;
+        log_errors_(batch_start + k, inputs[k], expected, actuals[k]);
+        if (max_failures_ <= failures + batch_failures) {
           return_status = absl::UnknownError("Maximum error count reached.");
           break;
         }
-      } else {
-        num_passes_.store(num_passes_.load() + 1);
       }
+      failures += batch_failures;
+      num_passes_.fetch_add(batch_passes, std::memory_order_relaxed);
+      num_failures_.fetch_add(batch_failures, std::memory_order_relaxed);
     }
 
     running_.store(false);
@@ -226,9 +288,11 @@ class TestbenchThreadBase {
 
   bool ready() { return ready_.load(); }
 
-  uint64_t num_failures() { return num_failures_.load(); }
+  uint64_t num_failures() {
+    return num_failures_.load(std::memory_order_relaxed);
+  }
 
-  uint64_t num_passes() { return num_passes_.load(); }
+  uint64_t num_passes() { return num_passes_.load(std::memory_order_relaxed); }
 
   absl::Status status() {
     absl::MutexLock lock(&mutex_);
@@ -236,6 +300,9 @@ class TestbenchThreadBase {
   }
 
  protected:
+  // How many indices to evaluate between checks for cancellation.
+  static constexpr uint64_t kCancelCheckInterval = 128;
+
   // Kicks the parent threads's condvar to indicate that this thread has
   // finished its work (successfully or otherwise).
   void WakeParent() {
@@ -262,12 +329,17 @@ class TestbenchThreadBase {
 
   // Bookkeeping data.
   uint64_t max_failures_;
-  std::atomic<uint64_t> num_passes_;
+  uint64_t batch_size_;
+  // Only ever written by this worker and read by the monitoring thread; kept
+  // on their own cache line so polling doesn't slow down the worker.
+  alignas(64) std::atomic<uint64_t> num_passes_;
   std::atomic<uint64_t> num_failures_;
 
   std::function<InputT(uint64_t)> index_to_input_;
   std::function<ResultT(InputT&)> generate_expected_fn_;
   std::function<ResultT(InputT&)> generate_actual_fn_;
+  std::function<void(absl::Span<const InputT>, absl::Span<ResultT>)>
+      generate_actual_batch_fn_;
   std::function<bool(ResultT, ResultT)> compare_results_;
   std::function<void(int64_t, InputT, ResultT, ResultT)> log_errors_;
 
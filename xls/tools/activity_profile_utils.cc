@@ -0,0 +1,178 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/activity_profile_utils.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "google/protobuf/text_format.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/proc_runtime_telemetry.h"
+#include "xls/ir/activity_profile.pb.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/nodes.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+
+namespace xls {
+
+namespace {
+
+std::optional<Node*> GetPredicate(Node* node) {
+  if (node->Is<ChannelNode>()) {
+    return node->As<ChannelNode>()->predicate();
+  }
+  if (node->Is<Next>()) {
+    return node->As<Next>()->predicate();
+  }
+  if (node->Is<StateRead>()) {
+    return node->As<StateRead>()->predicate();
+  }
+  return std::nullopt;
+}
+
+}  // namespace
+
+ActivityProfileObserver::ActivityProfileObserver(Package* package,
+                                                 std::optional<JitRuntime*> jit)
+    : package_(package), jit_(jit) {
+  for (FunctionBase* fb : package->GetFunctionBases()) {
+    for (Node* node : fb->nodes()) {
+      if (std::optional<Node*> predicate = GetPredicate(node)) {
+        predicates_[node] = *predicate;
+        predicate_values_[*predicate] = false;
+      }
+    }
+  }
+}
+
+void ActivityProfileObserver::Record(Node* node, bool value) {
+  if (paused_) {
+    return;
+  }
+  if (auto it = predicate_values_.find(node); it != predicate_values_.end()) {
+    it->second = value;
+  }
+  NodeCounts& counts = counts_[node];
+  ++counts.evaluations;
+  if (auto it = predicates_.find(node); it != predicates_.end()) {
+    counts.activations += predicate_values_.at(it->second) ? 1 : 0;
+  } else {
+    ++counts.activations;
+  }
+}
+
+void ActivityProfileObserver::NodeEvaluated(Node* n, const Value& v) {
+  Record(n, predicate_values_.contains(n) && v.IsAllOnes());
+}
+
+void ActivityProfileObserver::RecordNodeValue(int64_t node_ptr,
+                                              const uint8_t* data) {
+  Node* node = reinterpret_cast<Node*>(static_cast<intptr_t>(node_ptr));
+  // Predicates are bits[1], which the JIT stores in a single byte.
+  Record(node, predicate_values_.contains(node) && (data[0] & 1) != 0);
+}
+
+ActivityProfileProto ActivityProfileObserver::proto(
+    const ProcRuntimeTelemetry* telemetry) const {
+  ActivityProfileProto res;
+  if (telemetry != nullptr) {
+    res.set_network_tick_count(telemetry->tick_count());
+  }
+  // A proc has completed as many activations as its least evaluated node, as a
+  // blocked activation only evaluates the nodes before the blocking receive.
+  absl::flat_hash_map<FunctionBase*, int64_t> proc_ticks;
+  for (FunctionBase* fb : package_->GetFunctionBases()) {
+    if (fb->IsProc()) {
+      proc_ticks[fb] = std::numeric_limits<int64_t>::max();
+    }
+    for (Node* node : fb->nodes()) {
+      auto it = counts_.find(node);
+      if (it == counts_.end()) {
+        continue;
+      }
+      ActivityProfileProto::NodeActivity* activity = res.add_nodes();
+      activity->set_function_base(fb->name());
+      activity->set_node_id(node->id());
+      activity->set_node_name(node->GetName());
+      activity->set_evaluation_count(it->second.evaluations);
+      activity->set_activation_count(it->second.activations);
+      if (fb->IsProc()) {
+        proc_ticks[fb] = std::min(proc_ticks[fb], it->second.evaluations);
+      }
+    }
+  }
+  for (const std::unique_ptr<Proc>& proc : package_->procs()) {
+    ActivityProfileProto::ProcActivity* activity = res.add_procs();
+    activity->set_proc(proc->name());
+    int64_t ticks = proc_ticks.at(proc.get());
+    activity->set_tick_count(
+        ticks == std::numeric_limits<int64_t>::max() ? 0 : ticks);
+  }
+  if (telemetry != nullptr) {
+    // Sort the channels for a stable output order.
+    absl::btree_map<std::string, std::vector<int64_t>> histograms;
+    for (ChannelQueue* queue : telemetry->queues()) {
+      histograms[queue->channel_instance()->ToString()] =
+          telemetry->GetChannelStats(queue->channel_instance())
+              .occupancy_histogram;
+    }
+    for (const auto& [channel, histogram] : histograms) {
+      ActivityProfileProto::ChannelOccupancy* occupancy = res.add_channels();
+      occupancy->set_channel(channel);
+      occupancy->mutable_histogram()->Assign(histogram.begin(),
+                                             histogram.end());
+    }
+  }
+  return res;
+}
+
+ScopedRecordActivityProfile::~ScopedRecordActivityProfile() {
+  if (!txtproto_ && !binproto_) {
+    return;
+  }
+  ActivityProfileProto proto = obs_.proto(telemetry_);
+  if (txtproto_) {
+    std::string out;
+    if (google::protobuf::TextFormat::PrintToString(proto, &out)) {
+      absl::Status write = SetFileContents(*txtproto_, out);
+      if (!write.ok()) {
+        LOG(ERROR) << "Unable to write textproto: " << write;
+      }
+    }
+  }
+  if (binproto_) {
+    absl::Status write = SetFileContents(*binproto_, proto.SerializeAsString());
+    if (!write.ok()) {
+      LOG(ERROR) << "Unable to write proto: " << write;
+    }
+  }
+}
+
+}  // namespace xls
@@ -0,0 +1,120 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_ACTIVITY_PROFILE_UTILS_H_
+#define XLS_TOOLS_ACTIVITY_PROFILE_UTILS_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "xls/interpreter/observer.h"
+#include "xls/interpreter/proc_runtime_telemetry.h"
+#include "xls/ir/activity_profile.pb.h"
+#include "xls/ir/node.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/observer.h"
+
+namespace xls {
+
+// Observer which counts how often each node is evaluated and, for predicated
+// ops, how often their predicate held. Only predicate values are inspected;
+// with the JIT they are read directly from the raw buffers so no values are
+// unpacked. The observer callbacks are only compiled into the JIT when
+// observers are supported (see EvaluatorOptions::support_observers) so there
+// is no overhead when profiling is off.
+class ActivityProfileObserver final : public EvaluationObserver,
+                                      public RuntimeObserver {
+ public:
+  explicit ActivityProfileObserver(
+      Package* package, std::optional<JitRuntime*> jit = std::nullopt);
+
+  void NodeEvaluated(Node* n, const Value& v) override;
+  std::optional<RuntimeObserver*> AsRawObserver() override {
+    if (jit_) {
+      return this;
+    }
+    return std::nullopt;
+  }
+  void RecordNodeValue(int64_t node_ptr, const uint8_t* data) override;
+
+  // Returns the profile. The network tick count and channel occupancy
+  // histograms are taken from `telemetry`, the per-tick sampler of the proc
+  // runtime being profiled, and are omitted if it is null.
+  ActivityProfileProto proto(
+      const ProcRuntimeTelemetry* telemetry = nullptr) const;
+  void SetPaused(bool v) { paused_ = v; }
+
+ private:
+  struct NodeCounts {
+    int64_t evaluations = 0;
+    int64_t activations = 0;
+  };
+
+  void Record(Node* node, bool value);
+
+  Package* package_;
+  std::optional<JitRuntime*> jit_;
+  absl::flat_hash_map<Node*, NodeCounts> counts_;
+  // Predicate of each predicated node.
+  absl::flat_hash_map<Node*, Node*> predicates_;
+  // Value each node used as a predicate had when last evaluated.
+  absl::flat_hash_map<Node*, bool> predicate_values_;
+  bool paused_ = false;
+};
+
+// Collects an activity profile over its lifetime if either output path is set
+// and writes it out on destruction, like ScopedRecordNodeCoverage.
+class ScopedRecordActivityProfile {
+ public:
+  ScopedRecordActivityProfile(std::optional<std::string> binproto,
+                              std::optional<std::string> txtproto,
+                              Package* package,
+                              std::optional<JitRuntime*> jit = std::nullopt)
+      : binproto_(std::move(binproto)),
+        txtproto_(std::move(txtproto)),
+        obs_(package, jit) {}
+  ~ScopedRecordActivityProfile();
+  std::optional<ActivityProfileObserver*> observer() {
+    if (binproto_ || txtproto_) {
+      return &obs_;
+    }
+    return std::nullopt;
+  }
+
+  // Set to true to pause collection.
+  void SetPaused(bool paused) { obs_.SetPaused(paused); }
+
+  // Sets the telemetry from which the channel occupancy of the written
+  // profile is taken. It must outlive this object.
+  void SetTelemetry(const ProcRuntimeTelemetry* telemetry) {
+    telemetry_ = telemetry;
+  }
+
+ private:
+  std::optional<std::string> binproto_;
+  std::optional<std::string> txtproto_;
+  ActivityProfileObserver obs_;
+  const ProcRuntimeTelemetry* telemetry_ = nullptr;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_ACTIVITY_PROFILE_UTILS_H_
@@ -0,0 +1,88 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/activity_profile_utils.h"
+
+#include <memory>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "xls/common/status/matchers.h"
+#include "xls/interpreter/evaluator_options.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/activity_profile.pb.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+
+class ActivityProfileUtilsTest : public IrTestBase {};
+
+TEST_F(ActivityProfileUtilsTest, CountsActivationsTicksAndOccupancy) {
+  auto p = CreatePackage();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      Channel * out, p->CreateStreamingChannel("out", ChannelOps::kSendOnly,
+                                               p->GetBitsType(32)));
+  TokenlessProcBuilder pb(TestName(), "tkn", p.get());
+  BValue x = pb.StateElement("x", Value(UBits(0, 32)));
+  pb.SendIf(out, pb.BitSlice(x, /*start=*/0, /*width=*/1), x, SourceInfo(),
+            "send_odd");
+  pb.Next(x, pb.Add(x, pb.Literal(UBits(1, 32))));
+  XLS_ASSERT_OK(pb.Build().status());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<SerialProcRuntime> runtime,
+      CreateInterpreterSerialProcRuntime(
+          p.get(), EvaluatorOptions().set_support_observers(true)));
+  ActivityProfileObserver observer(p.get());
+  XLS_ASSERT_OK(runtime->SetObserver(&observer));
+  runtime->EnableTelemetry();
+  for (int64_t i = 0; i < 4; ++i) {
+    XLS_ASSERT_OK(runtime->Tick());
+  }
+
+  ActivityProfileProto profile = observer.proto(runtime->telemetry());
+  EXPECT_EQ(profile.network_tick_count(), 4);
+  ASSERT_EQ(profile.procs_size(), 1);
+  EXPECT_EQ(profile.procs(0).tick_count(), 4);
+
+  bool found_send = false;
+  for (const ActivityProfileProto::NodeActivity& node : profile.nodes()) {
+    if (node.node_name() == "send_odd") {
+      found_send = true;
+      EXPECT_EQ(node.evaluation_count(), 4);
+      EXPECT_EQ(node.activation_count(), 2);
+    } else {
+      EXPECT_EQ(node.activation_count(), node.evaluation_count());
+    }
+  }
+  EXPECT_TRUE(found_send);
+
+  // The queue holds 0, 1, 1 and 2 elements after each tick.
+  ASSERT_EQ(profile.channels_size(), 1);
+  EXPECT_THAT(profile.channels(0).histogram(), ElementsAre(1, 2, 1));
+}
+
+}  // namespace
+}  // namespace xls
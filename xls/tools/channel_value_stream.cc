@@ -0,0 +1,221 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/channel_value_stream.h"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/ir/value.h"
+#include "xls/ir/xls_value.pb.h"
+
+namespace xls {
+namespace {
+
+constexpr std::string_view kMagic = kChannelValueStreamMagic;
+
+// Values larger than this are rejected as corrupt rather than allocated.
+constexpr uint32_t kMaxRecordSize = uint32_t{1} << 30;
+
+std::array<char, 4> EncodeLength(uint32_t length) {
+  return {static_cast<char>(length & 0xff),
+          static_cast<char>((length >> 8) & 0xff),
+          static_cast<char>((length >> 16) & 0xff),
+          static_cast<char>((length >> 24) & 0xff)};
+}
+
+uint32_t DecodeLength(const std::array<char, 4>& bytes) {
+  uint32_t length = 0;
+  for (int64_t i = 3; i >= 0; --i) {
+    length = (length << 8) | static_cast<uint8_t>(bytes[i]);
+  }
+  return length;
+}
+
+// Reads the next value from `file`, or returns std::nullopt at the end of the
+// file.
+absl::StatusOr<std::optional<Value>> ReadValue(std::ifstream& file) {
+  std::array<char, 4> length_bytes;
+  file.read(length_bytes.data(), length_bytes.size());
+  if (file.gcount() == 0 && file.eof()) {
+    return std::nullopt;
+  }
+  if (file.gcount() != length_bytes.size()) {
+    return absl::DataLossError("Channel value stream ends inside a record.");
+  }
+  uint32_t length = DecodeLength(length_bytes);
+  if (length > kMaxRecordSize) {
+    return absl::DataLossError(absl::StrFormat(
+        "Channel value stream record of %d bytes is too large.", length));
+  }
+  std::string bytes(length, '\0');
+  file.read(bytes.data(), length);
+  if (file.gcount() != length) {
+    return absl::DataLossError("Channel value stream ends inside a record.");
+  }
+  ValueProto proto;
+  if (!proto.ParseFromString(bytes)) {
+    return absl::DataLossError(
+        "Channel value stream record is not a valid ValueProto.");
+  }
+  XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(proto));
+  return value;
+}
+
+}  // namespace
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelValueStreamWriter>>
+ChannelValueStreamWriter::Create(const std::filesystem::path& path) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to open channel value stream for writing: %s", path.string()));
+  }
+  file.write(kMagic.data(), kMagic.size());
+  return absl::WrapUnique(new ChannelValueStreamWriter(std::move(file)));
+}
+
+absl::Status ChannelValueStreamWriter::Write(const Value& value) {
+  XLS_ASSIGN_OR_RETURN(ValueProto proto, value.AsProto());
+  std::string bytes = proto.SerializeAsString();
+  std::array<char, 4> length_bytes = EncodeLength(bytes.size());
+  file_.write(length_bytes.data(), length_bytes.size());
+  file_.write(bytes.data(), bytes.size());
+  if (!file_) {
+    return absl::InternalError("Failed to write to channel value stream.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ChannelValueStreamWriter::Close() {
+  file_.close();
+  if (!file_) {
+    return absl::InternalError("Failed to close channel value stream.");
+  }
+  return absl::OkStatus();
+}
+
+/* static */ absl::StatusOr<std::unique_ptr<ChannelValueStreamReader>>
+ChannelValueStreamReader::Create(const std::filesystem::path& path,
+                                 int64_t buffer_capacity) {
+  if (buffer_capacity < 1) {
+    return absl::InvalidArgumentError(
+        "Channel value stream buffer capacity must be positive.");
+  }
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to open channel value stream: %s", path.string()));
+  }
+  std::string magic(kMagic.size(), '\0');
+  file.read(magic.data(), magic.size());
+  if (file.gcount() != kMagic.size() || magic != kMagic) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Not a channel value stream: %s", path.string()));
+  }
+  return absl::WrapUnique(
+      new ChannelValueStreamReader(std::move(file), buffer_capacity));
+}
+
+ChannelValueStreamReader::ChannelValueStreamReader(std::ifstream file,
+                                                   int64_t buffer_capacity)
+    : file_(std::move(file)), buffer_capacity_(buffer_capacity) {
+  thread_ = std::make_unique<Thread>([this] { ReadLoop(); });
+}
+
+ChannelValueStreamReader::~ChannelValueStreamReader() {
+  {
+    absl::MutexLock lock(&mutex_);
+    cancelled_ = true;
+  }
+  thread_->Join();
+}
+
+void ChannelValueStreamReader::ReadLoop() {
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      mutex_.Await(absl::Condition(
+          +[](ChannelValueStreamReader* reader)
+               ABSL_EXCLUSIVE_LOCKS_REQUIRED(reader->mutex_) {
+                 return reader->cancelled_ ||
+                        reader->buffer_.size() < reader->buffer_capacity_;
+               },
+          this));
+      if (cancelled_) {
+        done_ = true;
+        return;
+      }
+    }
+    // Read without holding the lock so the consumer is never blocked on I/O.
+    absl::StatusOr<std::optional<Value>> value = ReadValue(file_);
+    absl::MutexLock lock(&mutex_);
+    if (!value.ok() || !value->has_value()) {
+      status_ = value.status();
+      done_ = true;
+      return;
+    }
+    buffer_.push_back(**std::move(value));
+  }
+}
+
+void ChannelValueStreamReader::AwaitValueOrEnd() {
+  mutex_.Await(absl::Condition(
+      +[](ChannelValueStreamReader* reader)
+           ABSL_EXCLUSIVE_LOCKS_REQUIRED(reader->mutex_) {
+             return !reader->buffer_.empty() || reader->done_;
+           },
+      this));
+}
+
+absl::StatusOr<std::optional<Value>> ChannelValueStreamReader::Peek() {
+  absl::MutexLock lock(&mutex_);
+  AwaitValueOrEnd();
+  if (buffer_.empty()) {
+    XLS_RETURN_IF_ERROR(status_);
+    return std::nullopt;
+  }
+  return buffer_.front();
+}
+
+absl::StatusOr<std::optional<Value>> ChannelValueStreamReader::Next() {
+  absl::MutexLock lock(&mutex_);
+  AwaitValueOrEnd();
+  if (buffer_.empty()) {
+    XLS_RETURN_IF_ERROR(status_);
+    return std::nullopt;
+  }
+  Value value = std::move(buffer_.front());
+  buffer_.pop_front();
+  ++consumed_;
+  return value;
+}
+
+}  // namespace xls
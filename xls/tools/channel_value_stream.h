@@ -0,0 +1,113 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
+#define XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>  // NOLINT
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/thread.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Reading and writing of channel value streams: binary files holding the
+// sequence of values sent on one channel, which (unlike the textual formats in
+// eval_utils.h) can be processed incrementally and so may be arbitrarily
+// large.
+//
+// A stream file is the magic bytes `kChannelValueStreamMagic` followed by one
+// record per value: the length of the value's serialized ValueProto as a
+// 32-bit little-endian integer, then the serialized proto itself.
+inline constexpr char kChannelValueStreamMagic[] = "XLSCHVS1";
+
+// Writes a channel value stream.
+class ChannelValueStreamWriter {
+ public:
+  static absl::StatusOr<std::unique_ptr<ChannelValueStreamWriter>> Create(
+      const std::filesystem::path& path);
+
+  // Appends `value` to the stream.
+  absl::Status Write(const Value& value);
+
+  // Flushes the stream and closes the file.
+  absl::Status Close();
+
+ private:
+  explicit ChannelValueStreamWriter(std::ofstream file)
+      : file_(std::move(file)) {}
+
+  std::ofstream file_;
+};
+
+// Reads a channel value stream. Values are read and decoded ahead of their
+// consumption by a background thread, which keeps up to `buffer_capacity`
+// values buffered; file I/O thus overlaps with the (typically much slower)
+// consumer while memory use stays bounded regardless of the file size.
+class ChannelValueStreamReader {
+ public:
+  static absl::StatusOr<std::unique_ptr<ChannelValueStreamReader>> Create(
+      const std::filesystem::path& path, int64_t buffer_capacity = 4096);
+
+  ~ChannelValueStreamReader();
+
+  // Returns the next value of the stream, or std::nullopt once all values have
+  // been returned. Blocks until the value has been read.
+  absl::StatusOr<std::optional<Value>> Next();
+
+  // Returns the next value without consuming it; see Next().
+  absl::StatusOr<std::optional<Value>> Peek();
+
+  // Returns the number of values returned by Next() so far.
+  int64_t consumed() const { return consumed_; }
+
+ private:
+  ChannelValueStreamReader(std::ifstream file, int64_t buffer_capacity);
+
+  // Body of the background thread, which fills `buffer_` until the end of the
+  // file, an error, or destruction.
+  void ReadLoop();
+
+  // Waits until the buffer holds a value or nothing more will be read.
+  void AwaitValueOrEnd() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  std::ifstream file_;
+  const int64_t buffer_capacity_;
+  int64_t consumed_ = 0;
+
+  absl::Mutex mutex_;
+  std::deque<Value> buffer_ ABSL_GUARDED_BY(mutex_);
+  // Set by the reading thread when it stops, with the error (if any) which
+  // stopped it.
+  bool done_ ABSL_GUARDED_BY(mutex_) = false;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+  bool cancelled_ ABSL_GUARDED_BY(mutex_) = false;
+
+  std::unique_ptr<Thread> thread_;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_CHANNEL_VALUE_STREAM_H_
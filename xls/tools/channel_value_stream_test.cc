@@ -0,0 +1,108 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/tools/channel_value_stream.h"
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/file/temp_directory.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::absl_testing::StatusIs;
+using ::testing::Optional;
+
+TEST(ChannelValueStreamTest, RoundTripsValues) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.bin";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelValueStreamWriter> writer,
+                           ChannelValueStreamWriter::Create(path));
+  for (int64_t i = 0; i < 100; ++i) {
+    XLS_ASSERT_OK(writer->Write(
+        Value::Tuple({Value(UBits(i, 32)), Value(UBits(i % 2, 1))})));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  // A buffer smaller than the stream makes the reader refill it repeatedly.
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueStreamReader> reader,
+      ChannelValueStreamReader::Create(path, /*buffer_capacity=*/7));
+  for (int64_t i = 0; i < 100; ++i) {
+    Value expected =
+        Value::Tuple({Value(UBits(i, 32)), Value(UBits(i % 2, 1))});
+    EXPECT_THAT(reader->Peek(), IsOkAndHolds(Optional(expected)));
+    EXPECT_THAT(reader->Next(), IsOkAndHolds(Optional(expected)));
+  }
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(std::nullopt));
+  EXPECT_EQ(reader->consumed(), 100);
+}
+
+TEST(ChannelValueStreamTest, DestroyingUnfinishedReaderStopsReading) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.bin";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelValueStreamWriter> writer,
+                           ChannelValueStreamWriter::Create(path));
+  for (int64_t i = 0; i < 1000; ++i) {
+    XLS_ASSERT_OK(writer->Write(Value(UBits(i, 16))));
+  }
+  XLS_ASSERT_OK(writer->Close());
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<ChannelValueStreamReader> reader,
+      ChannelValueStreamReader::Create(path, /*buffer_capacity=*/4));
+  EXPECT_THAT(reader->Next(), IsOkAndHolds(Optional(Value(UBits(0, 16)))));
+  reader.reset();
+}
+
+TEST(ChannelValueStreamTest, TruncatedStreamIsAnError) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.bin";
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelValueStreamWriter> writer,
+                           ChannelValueStreamWriter::Create(path));
+  XLS_ASSERT_OK(writer->Write(Value(UBits(42, 8))));
+  XLS_ASSERT_OK(writer->Close());
+  XLS_ASSERT_OK_AND_ASSIGN(std::string contents, GetFileContents(path));
+  XLS_ASSERT_OK(SetFileContents(path, contents.substr(0, contents.size() - 1)));
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::unique_ptr<ChannelValueStreamReader> reader,
+                           ChannelValueStreamReader::Create(path));
+  EXPECT_THAT(reader->Next(), StatusIs(absl::StatusCode::kDataLoss));
+}
+
+TEST(ChannelValueStreamTest, RejectsOtherFiles) {
+  XLS_ASSERT_OK_AND_ASSIGN(TempDirectory temp_dir, TempDirectory::Create());
+  std::filesystem::path path = temp_dir.path() / "values.txt";
+  XLS_ASSERT_OK(SetFileContents(path, "bits[8]:42\n"));
+  EXPECT_THAT(ChannelValueStreamReader::Create(path),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       testing::HasSubstr("Not a channel value stream")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -383,6 +383,8 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
 
   options.gate_recvs(p.gate_recvs());
   options.materialize_internal_fifos(p.materialize_internal_fifos());
+  options.retime_registers(p.retime_registers());
+  options.pack_pipeline_registers(p.pack_pipeline_registers());
   options.array_index_bounds_checking(p.array_index_bounds_checking());
   switch (p.register_merge_strategy()) {
     case STRATEGY_DONT_MERGE:
@@ -407,6 +409,18 @@ absl::StatusOr<verilog::CodegenOptions> CodegenOptionsFromProto(
     options.codegen_version(p.codegen_version());
   }
 
+  if (p.has_codegen_threads()) {
+    options.codegen_threads(p.codegen_threads());
+  }
+
+  if (p.has_bill_of_materials_limit() && p.bill_of_materials_limit() >= 0) {
+    options.bill_of_materials_limit(p.bill_of_materials_limit());
+  }
+
+  if (p.has_verilog_line_map_stream_path()) {
+    options.verilog_line_map_stream_path(p.verilog_line_map_stream_path());
+  }
+
   return options;
 }
 
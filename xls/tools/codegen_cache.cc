@@ -0,0 +1,100 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/codegen_cache.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/package.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_cache.pb.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+namespace xls {
+namespace {
+
+// Leads every key; changing it orphans the entries of older builds, e.g. when
+// CodegenCacheEntryProto changes incompatibly.
+constexpr std::string_view kCacheFormat = "codegen-cache-1";
+
+}  // namespace
+
+std::string ComputeCodegenCacheKey(
+    Package* package, const PipelineScheduleOrGroup* schedules,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    const CodegenFlagsProto& codegen_flags_proto) {
+  std::vector<std::string> components = {std::string(kCacheFormat),
+                                         package->DumpIr()};
+
+  // The schedules, in a deterministic order.
+  std::vector<const PipelineSchedule*> ordered_schedules;
+  if (schedules != nullptr) {
+    if (std::holds_alternative<PipelineSchedule>(*schedules)) {
+      ordered_schedules.push_back(&std::get<PipelineSchedule>(*schedules));
+    } else {
+      for (const auto& [_, schedule] :
+           std::get<PackagePipelineSchedules>(*schedules)) {
+        ordered_schedules.push_back(&schedule);
+      }
+      std::sort(ordered_schedules.begin(), ordered_schedules.end(),
+                [](const PipelineSchedule* a, const PipelineSchedule* b) {
+                  return a->function_base()->name() <
+                         b->function_base()->name();
+                });
+    }
+  }
+  components.push_back(absl::StrCat(ordered_schedules.size()));
+  for (const PipelineSchedule* schedule : ordered_schedules) {
+    components.push_back(schedule->function_base()->name());
+    components.push_back(schedule->ToString());
+  }
+
+  components.push_back(scheduling_options_flags_proto.ShortDebugString());
+  components.push_back(codegen_flags_proto.ShortDebugString());
+  return ContentAddressedDirectoryCache::ComputeKey(
+      std::vector<std::string_view>(components.begin(), components.end()));
+}
+
+std::optional<CodegenCacheEntryProto> LookupCodegenCacheEntry(
+    ContentAddressedDirectoryCache& cache, std::string_view key) {
+  std::optional<std::string> contents = cache.Lookup(key);
+  if (!contents.has_value()) {
+    return std::nullopt;
+  }
+  CodegenCacheEntryProto entry;
+  if (!entry.ParseFromString(*contents)) {
+    cache.RecordUnusableEntry();
+    return std::nullopt;
+  }
+  return entry;
+}
+
+absl::Status StoreCodegenCacheEntry(ContentAddressedDirectoryCache& cache,
+                                    std::string_view key,
+                                    const CodegenCacheEntryProto& entry) {
+  return cache.Store(key, entry.SerializeAsString());
+}
+
+}  // namespace xls
@@ -0,0 +1,63 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_CODEGEN_CACHE_H_
+#define XLS_TOOLS_CODEGEN_CACHE_H_
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "absl/status/status.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/ir/package.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_cache.pb.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+namespace xls {
+
+// Describes a persistent cache of codegen outputs (Verilog text, line map,
+// module signature, schedule and block IR), so codegen_main can skip code
+// generation when the scheduled IR and the flags are unchanged since a
+// previous invocation.
+//
+// The key does not capture the version of the code generator, so a cache
+// directory should not be shared between different XLS builds.
+inline constexpr ContentAddressedDirectoryCache::Options kCodegenCacheOptions =
+    {.directory_env_var = "XLS_CODEGEN_CACHE_DIR",
+     .extension = ".cgpb",
+     .description = "codegen"};
+
+// Returns the key of generating code for the scheduled package `package`.
+// `schedules` is null for combinational code generation.
+std::string ComputeCodegenCacheKey(
+    Package* package, const PipelineScheduleOrGroup* schedules,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    const CodegenFlagsProto& codegen_flags_proto);
+
+// Returns the codegen outputs stored in `cache` under `key`, or std::nullopt
+// if there are none or they can't be parsed.
+std::optional<CodegenCacheEntryProto> LookupCodegenCacheEntry(
+    ContentAddressedDirectoryCache& cache, std::string_view key);
+
+// Stores the codegen outputs `entry` in `cache` under `key`.
+absl::Status StoreCodegenCacheEntry(ContentAddressedDirectoryCache& cache,
+                                    std::string_view key,
+                                    const CodegenCacheEntryProto& entry);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_CODEGEN_CACHE_H_
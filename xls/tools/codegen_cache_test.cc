@@ -0,0 +1,102 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/codegen_cache.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status_matchers.h"
+#include "absl/status/statusor.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/tools/codegen_cache.pb.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::IsOkAndHolds;
+using ::testing::Eq;
+using ::testing::Not;
+
+constexpr std::string_view kIr = R"(package p
+
+top fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret add.3: bits[32] = add(x, y, id=3)
+}
+)";
+
+absl::StatusOr<std::string> Key(std::string_view ir,
+                                const CodegenFlagsProto& codegen_flags) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir));
+  return ComputeCodegenCacheKey(package.get(), /*schedules=*/nullptr,
+                                SchedulingOptionsFlagsProto(), codegen_flags);
+}
+
+TEST(CodegenCacheTest, KeyDependsOnIrAndFlags) {
+  CodegenFlagsProto flags;
+  flags.set_generator(GENERATOR_KIND_COMBINATIONAL);
+  XLS_ASSERT_OK_AND_ASSIGN(std::string key, Key(kIr, flags));
+  EXPECT_THAT(Key(kIr, flags), IsOkAndHolds(Eq(key)));
+
+  CodegenFlagsProto other_flags = flags;
+  other_flags.set_module_name("other");
+  EXPECT_THAT(Key(kIr, other_flags), IsOkAndHolds(Not(Eq(key))));
+
+  EXPECT_THAT(Key(R"(package p
+
+top fn f(x: bits[32], y: bits[32]) -> bits[32] {
+  ret sub.3: bits[32] = sub(x, y, id=3)
+}
+)",
+                  flags),
+              IsOkAndHolds(Not(Eq(key))));
+}
+
+TEST(CodegenCacheTest, EntryRoundTrips) {
+  ContentAddressedDirectoryCache cache(kCodegenCacheOptions);
+  CodegenCacheEntryProto entry;
+  entry.set_verilog_text("module f();\nendmodule\n");
+  entry.mutable_signature()->set_module_name("f");
+  entry.set_ir(std::string(kIr));
+  XLS_ASSERT_OK(StoreCodegenCacheEntry(cache, "abc", entry));
+
+  std::optional<CodegenCacheEntryProto> found =
+      LookupCodegenCacheEntry(cache, "abc");
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(found->verilog_text(), entry.verilog_text());
+  EXPECT_EQ(found->signature().module_name(), "f");
+  EXPECT_EQ(found->ir(), kIr);
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(CodegenCacheTest, UnparsableEntryIsAMiss) {
+  ContentAddressedDirectoryCache cache(kCodegenCacheOptions);
+  XLS_ASSERT_OK(cache.Store("abc", "\xff\xff"));
+  EXPECT_EQ(LookupCodegenCacheEntry(cache, "abc"), std::nullopt);
+  EXPECT_EQ(cache.hits(), 0);
+  EXPECT_EQ(cache.misses(), 1);
+}
+
+}  // namespace
+}  // namespace xls
@@ -29,6 +29,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/str_split.h"
+#include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
@@ -47,6 +48,9 @@ ABSL_FLAG(std::string, output_schedule_ir_path, "",
           "Path to write the scheduled IR.");
 ABSL_FLAG(std::string, output_block_ir_path, "",
           "Path to write the block-level IR.");
+ABSL_FLAG(bool, output_binary_ir, false,
+          "Write the scheduled and block-level IR in the binary IR format "
+          "rather than the text format.");
 ABSL_FLAG(
     std::string, output_signature_path, "",
     "Specific output path for the module signature. If not specified then "
@@ -54,6 +58,11 @@ ABSL_FLAG(
 ABSL_FLAG(std::string, output_verilog_line_map_path, "",
           "Specific output path for Verilog line map. If not specified then "
           "Verilog line map is not generated.");
+ABSL_FLAG(bool, stream_verilog_line_map, false,
+          "If true, the Verilog line map is written to "
+          "--output_verilog_line_map_path while the Verilog is emitted, in a "
+          "compact delta-encoded binary format, rather than collected in "
+          "memory and written as a text proto. Use for large designs.");
 ABSL_FLAG(std::string, top, "",
           "Top entity of the package to generate the (System)Verilog code.");
 ABSL_FLAG(std::string, generator, "pipeline",
@@ -148,6 +157,14 @@ ABSL_FLAG(bool, gate_recvs, true,
 ABSL_FLAG(bool, materialize_internal_fifos, false,
           "If true, emit logic implementing fifos for any channels in the IR. "
           "If false use an externally provided fifo implementation.");
+ABSL_FLAG(bool, retime_registers, false,
+          "If true, move pipeline registers across the combinational logic "
+          "of each block to minimize the estimated clock period, and then the "
+          "number of register bits at that period. Requires a delay model.");
+ABSL_FLAG(bool, pack_pipeline_registers, false,
+          "If true, the bits-typed values carried from each pipeline stage to "
+          "the next share a single register (and load enable) per stage "
+          "rather than having a register each.");
 ABSL_FLAG(bool, array_index_bounds_checking, true,
           "If true, emit bounds checking on array-index operations in Verilog. "
           "Otherwise, the bounds checking is not evaluated.");
@@ -182,6 +199,14 @@ ABSL_FLAG(SeedSeq, randomize_order_seed, {},
           "output. If empty, will use a default order. This can be useful for "
           "creating multiple equivalent Verilog outputs to exercise the rest "
           "of the synthesis pipeline.");
+ABSL_FLAG(int64_t, codegen_threads, 1,
+          "Number of threads used to generate the Verilog modules of the "
+          "blocks of a design concurrently. The output does not depend on the "
+          "number of threads.");
+ABSL_FLAG(int64_t, bill_of_materials_limit, -1,
+          "Maximum number of entries in the bill of materials of the block "
+          "metrics in the module signature. Nodes beyond the limit are only "
+          "counted. Negative values do not limit the bill of materials.");
 
 // LINT.ThenChange(
 //   //xls/build_rules/xls_providers.bzl,
@@ -328,6 +353,8 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   POPULATE_FLAG(gate_recvs);
   POPULATE_FLAG(array_index_bounds_checking);
   POPULATE_FLAG(materialize_internal_fifos);
+  POPULATE_FLAG(retime_registers);
+  POPULATE_FLAG(pack_pipeline_registers);
   XLS_ASSIGN_OR_RETURN(
       RegisterMergeStrategyProto merge_strategy,
       MergeStrategyFromString(absl::GetFlag(FLAGS_register_merge_strategy)));
@@ -335,6 +362,8 @@ static absl::StatusOr<bool> SetOptionsFromFlags(CodegenFlagsProto &proto) {
   proto.set_register_merge_strategy(merge_strategy);
 
   // Misc
+  POPULATE_FLAG(codegen_threads);
+  POPULATE_FLAG(bill_of_materials_limit);
   if (FLAGS_randomize_order_seed.IsSpecifiedOnCommandLine()) {
     any_flags_set = true;
     absl::c_copy(absl::GetFlag(FLAGS_randomize_order_seed).elements,
@@ -375,4 +404,30 @@ absl::StatusOr<CodegenFlagsProto> GetCodegenFlags() {
   return proto;
 }
 
+VerilogLineMapOutput GetVerilogLineMapOutput(
+    CodegenFlagsProto* codegen_flags_proto) {
+  VerilogLineMapOutput output{
+      .path = absl::GetFlag(FLAGS_output_verilog_line_map_path)};
+  output.stream =
+      absl::GetFlag(FLAGS_stream_verilog_line_map) && !output.path.empty();
+  if (output.stream) {
+    codegen_flags_proto->set_verilog_line_map_stream_path(output.path);
+  }
+  return output;
+}
+
+absl::Status WriteVerilogLineMap(const VerilogLineMapOutput& output,
+                                 std::string_view verilog_path,
+                                 verilog::VerilogLineMap* line_map) {
+  if (output.path.empty() || output.stream) {
+    return absl::OkStatus();
+  }
+  if (!verilog_path.empty()) {
+    for (int64_t i = 0; i < line_map->mapping_size(); ++i) {
+      line_map->mutable_mapping(i)->set_verilog_file(std::string(verilog_path));
+    }
+  }
+  return SetTextProtoFile(output.path, *line_map);
+}
+
 }  // namespace xls
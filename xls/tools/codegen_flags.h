@@ -18,17 +18,22 @@
 #include <cstdint>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include "absl/flags/declare.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "xls/codegen/verilog_line_map.pb.h"
 #include "xls/tools/codegen_flags.pb.h"
 
 ABSL_DECLARE_FLAG(std::string, output_verilog_path);
 ABSL_DECLARE_FLAG(std::string, output_schedule_path);
 ABSL_DECLARE_FLAG(std::string, output_schedule_ir_path);
 ABSL_DECLARE_FLAG(std::string, output_block_ir_path);
+ABSL_DECLARE_FLAG(bool, output_binary_ir);
 ABSL_DECLARE_FLAG(std::string, output_signature_path);
 ABSL_DECLARE_FLAG(std::string, output_verilog_line_map_path);
+ABSL_DECLARE_FLAG(bool, stream_verilog_line_map);
 ABSL_DECLARE_FLAG(std::string, top);
 ABSL_DECLARE_FLAG(std::optional<std::string>,
                   codegen_options_used_textproto_file);
@@ -39,6 +44,27 @@ namespace xls {
 // Populates the codegen flags proto from the ABSL flags library values.
 absl::StatusOr<CodegenFlagsProto> GetCodegenFlags();
 
+// The Verilog line map output requested by --output_verilog_line_map_path and
+// --stream_verilog_line_map.
+struct VerilogLineMapOutput {
+  // Empty if no line map is requested.
+  std::string path;
+  // Whether code generation writes the line map to `path` itself, while the
+  // Verilog is emitted.
+  bool stream = false;
+};
+
+// Returns the requested line map output. If the line map is streamed, sets it
+// as the verilog_line_map_stream_path of `codegen_flags_proto`.
+VerilogLineMapOutput GetVerilogLineMapOutput(
+    CodegenFlagsProto* codegen_flags_proto);
+
+// Writes `line_map`, the line map of the Verilog written to `verilog_path`
+// (stdout if empty), to the requested output unless it was streamed.
+absl::Status WriteVerilogLineMap(const VerilogLineMapOutput& output,
+                                 std::string_view verilog_path,
+                                 verilog::VerilogLineMap* line_map);
+
 }  // namespace xls
 
 #endif  // XLS_TOOLS_CODEGEN_FLAGS_H_
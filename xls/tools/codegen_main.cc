@@ -18,26 +18,33 @@
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
 #include "xls/codegen/module_signature.h"
 #include "xls/common/exit_status.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/dev_tools/tool_timeout.h"
+#include "xls/ir/binary_package.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/tools/codegen.h"
+#include "xls/tools/codegen_cache.h"
+#include "xls/tools/codegen_cache.pb.h"
 #include "xls/tools/codegen_flags.h"
 #include "xls/tools/codegen_flags.pb.h"
 #include "xls/tools/scheduling_options_flags.h"
@@ -61,20 +68,96 @@ Emit a feed-forward pipelined module:
 namespace xls {
 namespace {
 
+// Schedules and generates code for `p` like ScheduleAndCodegen, but reuses the
+// outputs of a previous invocation stored in `cache` if the scheduled IR and
+// the flags are unchanged. On a hit the package is left without blocks, so
+// `ir` is set to the IR the package had after code generation.
+absl::StatusOr<CodegenResult> ScheduleAndCodegenWithCache(
+    Package* p,
+    const SchedulingOptionsFlagsProto& scheduling_options_flags_proto,
+    const CodegenFlagsProto& codegen_flags_proto, bool with_delay_model,
+    ContentAddressedDirectoryCache& cache, std::optional<std::string>& ir) {
+  PipelineScheduleOrGroup schedules = PackagePipelineSchedules();
+  PipelineScheduleOrGroup* schedules_ptr = nullptr;
+  if (codegen_flags_proto.generator() == GENERATOR_KIND_PIPELINE) {
+    XLS_ASSIGN_OR_RETURN(schedules,
+                         Schedule(p, scheduling_options_flags_proto,
+                                  codegen_flags_proto,
+                                  /*scheduling_time=*/nullptr));
+    schedules_ptr = &schedules;
+  }
+
+  std::string key = ComputeCodegenCacheKey(
+      p, schedules_ptr, scheduling_options_flags_proto, codegen_flags_proto);
+  if (std::optional<CodegenCacheEntryProto> entry =
+          LookupCodegenCacheEntry(cache, key);
+      entry.has_value()) {
+    XLS_ASSIGN_OR_RETURN(
+        verilog::ModuleSignature signature,
+        verilog::ModuleSignature::FromProto(entry->signature()));
+    CodegenResult result{.module_generator_result = {
+                             .verilog_text = entry->verilog_text(),
+                             .verilog_line_map = entry->verilog_line_map(),
+                             .signature = std::move(signature),
+                         }};
+    if (entry->has_package_pipeline_schedules()) {
+      result.package_pipeline_schedules_proto =
+          entry->package_pipeline_schedules();
+    }
+    ir = entry->ir();
+    return result;
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult result,
+      Codegen(p, scheduling_options_flags_proto, codegen_flags_proto,
+              with_delay_model, schedules_ptr, /*codegen_time=*/nullptr));
+  CodegenCacheEntryProto entry;
+  entry.set_verilog_text(result.module_generator_result.verilog_text);
+  *entry.mutable_verilog_line_map() =
+      result.module_generator_result.verilog_line_map;
+  *entry.mutable_signature() = result.module_generator_result.signature.proto();
+  if (result.package_pipeline_schedules_proto.has_value()) {
+    *entry.mutable_package_pipeline_schedules() =
+        *result.package_pipeline_schedules_proto;
+  }
+  entry.set_ir(p->DumpIr());
+  if (absl::Status status = StoreCodegenCacheEntry(cache, key, entry);
+      !status.ok()) {
+    LOG(WARNING) << "Unable to store codegen outputs in cache: " << status;
+  }
+  return result;
+}
+
+// Returns the IR of `p` after code generation, or that of a cached invocation
+// if `cached_ir` is set.
+absl::StatusOr<std::string> DumpCodegenIr(
+    Package* p, const std::optional<std::string>& cached_ir, bool binary) {
+  if (!cached_ir.has_value()) {
+    return DumpPackage(p, binary);
+  }
+  if (!binary) {
+    return *cached_ir;
+  }
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(*cached_ir));
+  return DumpPackage(package.get(), binary);
+}
+
 absl::Status RealMain(std::string_view ir_path) {
   auto timeout = StartTimeoutTimer();
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
   }
-  XLS_ASSIGN_OR_RETURN(std::string ir_contents, GetFileContents(ir_path));
-  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p,
-                       Parser::ParsePackage(ir_contents, ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> p, ReadPackageFile(ir_path));
 
   XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
                        GetCodegenFlags());
   if (!codegen_flags_proto.top().empty()) {
     XLS_RETURN_IF_ERROR(p->SetTopByName(codegen_flags_proto.top()));
   }
+  const VerilogLineMapOutput line_map_output =
+      GetVerilogLineMapOutput(&codegen_flags_proto);
 
   XLS_RET_CHECK(p->GetTop().has_value())
       << "Package " << p->name() << " needs a top function/proc.";
@@ -86,18 +169,33 @@ absl::Status RealMain(std::string_view ir_path) {
   XLS_ASSIGN_OR_RETURN(
       bool delay_model_flag_passed,
       IsDelayModelSpecifiedViaFlag(scheduling_options_flags_proto));
-  XLS_ASSIGN_OR_RETURN(
-      CodegenResult r,
-      ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
-                         codegen_flags_proto, delay_model_flag_passed));
+  CodegenResult r;
+  std::optional<std::string> cached_ir;
+  // Cache entries hold the line map in memory, so they are not used when it is
+  // streamed.
+  if (ContentAddressedDirectoryCache* cache =
+          ContentAddressedDirectoryCache::GetDefault(kCodegenCacheOptions);
+      cache != nullptr && !line_map_output.stream) {
+    XLS_ASSIGN_OR_RETURN(
+        r, ScheduleAndCodegenWithCache(
+               p.get(), scheduling_options_flags_proto, codegen_flags_proto,
+               delay_model_flag_passed, *cache, cached_ir));
+  } else {
+    XLS_ASSIGN_OR_RETURN(
+        r, ScheduleAndCodegen(p.get(), scheduling_options_flags_proto,
+                              codegen_flags_proto, delay_model_flag_passed));
+  }
   verilog::ModuleGeneratorResult result = r.module_generator_result;
   std::optional<PackagePipelineSchedulesProto> schedule =
       r.package_pipeline_schedules_proto;
 
+  const bool binary_ir = absl::GetFlag(FLAGS_output_binary_ir);
   if (!absl::GetFlag(FLAGS_output_schedule_ir_path).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        std::string ir,
+        DumpCodegenIr(main()->package(), cached_ir, binary_ir));
     XLS_RETURN_IF_ERROR(
-        SetFileContents(absl::GetFlag(FLAGS_output_schedule_ir_path),
-                        main()->package()->DumpIr()));
+        SetFileContents(absl::GetFlag(FLAGS_output_schedule_ir_path), ir));
   }
 
   if (!absl::GetFlag(FLAGS_output_schedule_path).empty()) {
@@ -111,11 +209,13 @@ absl::Status RealMain(std::string_view ir_path) {
   }
 
   if (!absl::GetFlag(FLAGS_output_block_ir_path).empty()) {
-    QCHECK_GE(p->blocks().size(), 1)
+    QCHECK(cached_ir.has_value() || p->blocks().size() >= 1)
         << "There should be at least one block in the package after generating "
            "module text.";
-    XLS_RETURN_IF_ERROR(SetFileContents(
-        absl::GetFlag(FLAGS_output_block_ir_path), p->DumpIr()));
+    XLS_ASSIGN_OR_RETURN(std::string ir,
+                         DumpCodegenIr(p.get(), cached_ir, binary_ir));
+    XLS_RETURN_IF_ERROR(
+        SetFileContents(absl::GetFlag(FLAGS_output_block_ir_path), ir));
   }
 
   if (!absl::GetFlag(FLAGS_output_signature_path).empty()) {
@@ -124,19 +224,8 @@ absl::Status RealMain(std::string_view ir_path) {
   }
 
   const std::string& verilog_path = absl::GetFlag(FLAGS_output_verilog_path);
-  if (!verilog_path.empty()) {
-    for (int64_t i = 0; i < result.verilog_line_map.mapping_size(); ++i) {
-      result.verilog_line_map.mutable_mapping(i)->set_verilog_file(
-          verilog_path);
-    }
-  }
-
-  const std::string& verilog_line_map_path =
-      absl::GetFlag(FLAGS_output_verilog_line_map_path);
-  if (!verilog_line_map_path.empty()) {
-    XLS_RETURN_IF_ERROR(
-        SetTextProtoFile(verilog_line_map_path, result.verilog_line_map));
-  }
+  XLS_RETURN_IF_ERROR(WriteVerilogLineMap(line_map_output, verilog_path,
+                                          &result.verilog_line_map));
 
   if (verilog_path.empty()) {
     std::cout << result.verilog_text;
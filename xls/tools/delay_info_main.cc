@@ -30,10 +30,12 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/estimators/delay_model/analyze_critical_path.h"
 #include "xls/estimators/delay_model/delay_estimator.h"
 #include "xls/estimators/delay_model/delay_estimators.h"
@@ -93,6 +95,10 @@ ABSL_FLAG(std::optional<int>, stage, std::nullopt,
 ABSL_FLAG(std::optional<std::string>, proto_out, std::nullopt,
           "File to write a binary xls.DelayInfoProto to containing delay info "
           "of the input.");
+ABSL_FLAG(int64_t, threads, 0,
+          "Number of threads with which to analyze the stages and state "
+          "elements; zero or negative uses all available CPUs. The output is "
+          "the same for any number of threads.");
 
 namespace xls::tools {
 namespace {
@@ -116,8 +122,14 @@ absl::Status RealMain(std::string_view input_path) {
                          p->GetFunctionBaseByName(absl::GetFlag(FLAGS_top)));
   }
 
-  XLS_ASSIGN_OR_RETURN(DelayEstimator * delay_estimator,
+  XLS_ASSIGN_OR_RETURN(DelayEstimator * underlying_delay_estimator,
                        GetDelayEstimator(absl::GetFlag(FLAGS_delay_model)));
+  // Every analysis below queries the same nodes, so they share one cache which
+  // is safe to use from the thread pool.
+  CachingDelayEstimator caching_delay_estimator("caching",
+                                                *underlying_delay_estimator);
+  const DelayEstimator* delay_estimator = &caching_delay_estimator;
+  ThreadPool thread_pool(absl::GetFlag(FLAGS_threads));
   std::unique_ptr<synthesis::Synthesizer> synthesizer;
   if (absl::GetFlag(FLAGS_compare_to_synthesis)) {
     synthesis::GrpcSynthesizerParameters parameters(
@@ -166,9 +178,10 @@ absl::Status RealMain(std::string_view input_path) {
           CreateDelayDiffForStage(top, schedule, *delay_estimator,
                                   synthesizer.get(), *requested_stage));
     } else {
-      XLS_ASSIGN_OR_RETURN(diff_by_stage, synthesis::CreateDelayDiffByStage(
-                                              top, schedule, *delay_estimator,
-                                              synthesizer.get()));
+      XLS_ASSIGN_OR_RETURN(
+          diff_by_stage,
+          synthesis::CreateDelayDiffByStage(top, schedule, *delay_estimator,
+                                            synthesizer.get(), &thread_pool));
       total_diff = diff_by_stage->total_diff;
     }
     for (int64_t i = 0; i < schedule.length(); ++i) {
@@ -206,32 +219,46 @@ absl::Status RealMain(std::string_view input_path) {
     }
     if (top->IsProc()) {
       Proc* proc = top->AsProcOrDie();
-      for (StateElement* state_element : proc->StateElements()) {
+      absl::Span<StateElement* const> state_elements = proc->StateElements();
+      // The analyses are independent, so run them concurrently and print the
+      // results in state element order.
+      std::vector<absl::StatusOr<std::vector<CriticalPathEntry>>>
+          state_critical_paths(state_elements.size());
+      // Each analysis topologically sorts `top`, which builds the proc's
+      // cached compact graph on first use. Build it here, before any analysis
+      // is scheduled, so the concurrent analyses only ever read it.
+      top->compact_graph();
+      for (int64_t i = 0; i < state_elements.size(); ++i) {
+        thread_pool.Schedule([&, i]() {
+          StateElement* state_element = state_elements[i];
+          state_critical_paths[i] = AnalyzeCriticalPath(
+              top, /*clock_period_ps=*/std::nullopt, *delay_estimator,
+              [&](Node* node) {
+                return node->Is<StateRead>() &&
+                       node->As<StateRead>()->state_element() == state_element;
+              },
+              /*sink_filter=*/
+              [&](Node* node) {
+                if (node->Is<StateRead>() &&
+                    node->As<StateRead>()->state_element() == state_element) {
+                  return true;
+                }
+                if (node->Is<Next>()) {
+                  return node->As<Next>()->state_read() ==
+                         proc->GetStateRead(state_element);
+                }
+                return node ==
+                       proc->GetNextStateElement(
+                           *proc->GetStateElementIndex(state_element));
+              });
+        });
+      }
+      thread_pool.WaitForIdle();
+      for (int64_t i = 0; i < state_elements.size(); ++i) {
         std::cout << absl::StrFormat("# Critical path for state element %s:\n",
-                                     state_element->name());
-        XLS_ASSIGN_OR_RETURN(
-            std::vector<CriticalPathEntry> state_critical_path,
-            AnalyzeCriticalPath(
-                top, /*clock_period_ps=*/std::nullopt, *delay_estimator,
-                [&](Node* node) {
-                  return node->Is<StateRead>() &&
-                         node->As<StateRead>()->state_element() ==
-                             state_element;
-                },
-                /*sink_filter=*/
-                [&](Node* node) {
-                  if (node->Is<StateRead>() &&
-                      node->As<StateRead>()->state_element() == state_element) {
-                    return true;
-                  }
-                  if (node->Is<Next>()) {
-                    return node->As<Next>()->state_read() ==
-                           proc->GetStateRead(state_element);
-                  }
-                  return node ==
-                         proc->GetNextStateElement(
-                             *proc->GetStateElementIndex(state_element));
-                }));
+                                     state_elements[i]->name());
+        XLS_ASSIGN_OR_RETURN(std::vector<CriticalPathEntry> state_critical_path,
+                             std::move(state_critical_paths[i]));
         std::cout << CriticalPathToString(state_critical_path) << "\n";
       }
     }
@@ -0,0 +1,438 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Converts a DSLX file to IR, optimizes it and generates Verilog from it in a
+// single process. The package is handed from stage to stage in memory, so the
+// IR is never re-parsed, and all the artifacts of the ir_converter_main,
+// opt_main and codegen_main tools are written along the way.
+
+#include <cstdint>
+#include <filesystem>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/cleanup/cleanup.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/globals.h"
+#include "absl/log/log.h"
+#include "absl/log/log_entry.h"
+#include "absl/log/log_sink.h"
+#include "absl/log/log_sink_registry.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/codegen/module_signature.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/common/thread.h"
+#include "xls/dev_tools/tool_timeout.h"
+#include "xls/dslx/default_dslx_stdlib_path.h"
+#include "xls/dslx/ir_convert/conversion_info.h"
+#include "xls/dslx/ir_convert/convert_options.h"
+#include "xls/dslx/ir_convert/ir_converter.h"
+#include "xls/dslx/warning_kind.h"
+#include "xls/ir/binary_package.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel.pb.h"
+#include "xls/ir/package.h"
+#include "xls/ir/ram_rewrite.pb.h"
+#include "xls/ir/xls_ir_interface.pb.h"
+#include "xls/passes/optimization_pass.h"
+#include "xls/passes/pass_pipeline.pb.h"
+#include "xls/scheduling/pipeline_schedule.pb.h"
+#include "xls/scheduling/scheduling_options.h"
+#include "xls/tools/codegen.h"
+#include "xls/tools/codegen_flags.h"
+#include "xls/tools/codegen_flags.pb.h"
+#include "xls/tools/opt.h"
+#include "xls/tools/scheduling_options_flags.h"
+#include "xls/tools/scheduling_options_flags.pb.h"
+
+static constexpr std::string_view kUsage = R"(
+Converts a DSLX file to IR, optimizes the IR and generates Verilog from it
+without re-parsing the IR between the stages. Accepts the codegen and scheduling
+flags of codegen_main; the IR conversion and optimization flags are those of
+ir_converter_main and opt_main, except for the renamed flags listed below.
+Example invocation:
+
+   dslx_to_verilog_main --dslx_top=main --output_ir_path=main.ir \
+       --output_opt_ir_path=main.opt.ir --generator=pipeline \
+       --pipeline_stages=2 --delay_model=unit \
+       --output_verilog_path=main.sv main.x
+)";
+
+// LINT.IfChange
+// IR conversion flags.
+ABSL_FLAG(std::string, dslx_top, "",
+          "The name of the top entity to convert (ir_converter_main's --top).");
+ABSL_FLAG(std::string, dslx_stdlib_path,
+          std::string(xls::kDefaultDslxStdlibPath),
+          "Path to DSLX standard library files.");
+ABSL_FLAG(std::string, dslx_path, "",
+          "Additional paths to search for modules (colon delimited).");
+ABSL_FLAG(bool, emit_fail_as_assert, true,
+          "Feature flag for emitting fail!() in the DSL as an assert IR op.");
+ABSL_FLAG(bool, convert_tests, false,
+          "Feature flag for emitting test procs/functions to IR.");
+ABSL_FLAG(std::string, disable_warnings, "",
+          "Comma-delimited list of warnings to disable.");
+ABSL_FLAG(bool, warnings_as_errors, true,
+          "Whether to fail early, as an error, if warnings are detected");
+ABSL_FLAG(std::optional<std::string>, default_fifo_config, std::nullopt,
+          "Textproto description of a default FifoConfigProto.");
+ABSL_FLAG(int64_t, conversion_threads, 1,
+          "Number of threads used to convert independent functions "
+          "concurrently; zero means one per available CPU.");
+ABSL_FLAG(bool, lazy_typecheck, false,
+          "If true, only typechecks the module members reachable from the "
+          "top.");
+ABSL_FLAG(std::string, output_ir_path, "",
+          "If non-empty, where to write the unoptimized IR "
+          "(ir_converter_main's --output_file).");
+ABSL_FLAG(std::string, interface_proto_file, "",
+          "If non-empty, where to write the xls.PackageInterfaceProto of the "
+          "converted package.");
+
+// IR optimization flags.
+ABSL_FLAG(std::string, opt_top, "",
+          "Top entity to optimize (opt_main's --top). Defaults to the top set "
+          "by the IR conversion.");
+ABSL_FLAG(int64_t, ir_opt_level, xls::kMaxOptLevel,
+          "Optimization level of the IR optimizer (opt_main's --opt_level).");
+ABSL_FLAG(std::string, ir_dump_path, "",
+          "Dump all intermediate IR files of the optimizer to the given "
+          "directory");
+ABSL_FLAG(std::vector<std::string>, skip_passes, {},
+          "If specified, passes in this comma-separated list of (short) "
+          "pass names are skipped.");
+ABSL_FLAG(std::optional<std::string>, passes, std::nullopt,
+          "Explicit list of passes to run instead of the standard pipeline; "
+          "see opt_main.");
+ABSL_FLAG(std::optional<int64_t>, convert_array_index_to_select, std::nullopt,
+          "See opt_main.");
+ABSL_FLAG(std::optional<int64_t>, split_next_value_selects, 4,
+          "See opt_main.");
+ABSL_FLAG(bool, inline_procs, false,
+          "Whether to inline all procs by calling the proc inlining pass.");
+ABSL_FLAG(std::string, ram_rewrites_pb, "",
+          "Path to protobuf describing ram rewrites.");
+ABSL_FLAG(bool, use_context_narrowing_analysis, false,
+          "Use context sensitive narrowing analysis.");
+ABSL_FLAG(bool, optimize_for_best_case_throughput, false,
+          "Optimize for best case throughput, even at the cost of area.");
+ABSL_FLAG(std::string, output_opt_ir_path, "",
+          "If non-empty, where to write the optimized IR (opt_main's "
+          "--output_path).");
+ABSL_FLAG(std::string, opt_log_path, "",
+          "If non-empty, the logs of the optimizer are also written to this "
+          "path (opt_main's --alsologto).");
+// LINT.ThenChange(//xls/build_rules/xls_ir_rules.bzl)
+
+// Code generation flags not shared with codegen_main.
+ABSL_FLAG(bool, codegen_use_ir_interface, false,
+          "Pass the interface of the converted package to code generation, as "
+          "codegen_main's --ir_interface_proto does. Ignored if the codegen "
+          "flags already hold a package interface.");
+
+namespace xls {
+namespace {
+
+// Writes files on threads of their own so that serializing an artifact to
+// disk overlaps with the following stages.
+class ArtifactWriter {
+ public:
+  ~ArtifactWriter() { CHECK(threads_.empty()) << "Finish() was not called."; }
+
+  void Write(std::filesystem::path path, std::string contents) {
+    threads_.push_back(std::make_unique<Thread>(
+        [this, path = std::move(path), contents = std::move(contents)]() {
+          absl::Status status = SetFileContents(path, contents);
+          absl::MutexLock lock(&mutex_);
+          status_.Update(status);
+        }));
+  }
+
+  // Waits for all writes and returns the first error, if any.
+  absl::Status Finish() {
+    for (std::unique_ptr<Thread>& thread : threads_) {
+      thread->Join();
+    }
+    threads_.clear();
+    absl::MutexLock lock(&mutex_);
+    return status_;
+  }
+
+ private:
+  std::vector<std::unique_ptr<Thread>> threads_;
+  absl::Mutex mutex_;
+  absl::Status status_ ABSL_GUARDED_BY(mutex_);
+};
+
+class FileStderrLogSink final : public absl::LogSink {
+ public:
+  explicit FileStderrLogSink(std::filesystem::path path)
+      : path_(std::move(path)) {
+    CHECK_OK(SetFileContents(path_, ""));
+  }
+
+  void Send(const absl::LogEntry& entry) override {
+    if (entry.log_severity() < absl::StderrThreshold()) {
+      return;
+    }
+    if (!entry.stacktrace().empty()) {
+      CHECK_OK(AppendStringToFile(path_, entry.stacktrace()));
+    } else {
+      CHECK_OK(AppendStringToFile(
+          path_, entry.text_message_with_prefix_and_newline()));
+    }
+  }
+
+ private:
+  const std::filesystem::path path_;
+};
+
+std::optional<int64_t> NegativeIsNullopt(std::optional<int64_t> v) {
+  if (v && *v < 0) {
+    return std::nullopt;
+  }
+  return v;
+}
+
+absl::StatusOr<dslx::PackageConversionData> ConvertDslx(
+    std::string_view dslx_file) {
+  std::vector<std::filesystem::path> dslx_paths;
+  for (std::string_view path :
+       absl::StrSplit(absl::GetFlag(FLAGS_dslx_path), ':')) {
+    dslx_paths.push_back(std::filesystem::path(path));
+  }
+  XLS_ASSIGN_OR_RETURN(dslx::WarningKindSet enabled_warnings,
+                       dslx::WarningKindSetFromDisabledString(
+                           absl::GetFlag(FLAGS_disable_warnings)));
+  std::optional<FifoConfig> default_fifo_config;
+  if (std::optional<std::string> textproto =
+          absl::GetFlag(FLAGS_default_fifo_config)) {
+    FifoConfigProto proto;
+    XLS_RETURN_IF_ERROR(ParseTextProto(
+        *textproto, std::filesystem::path("<cmdline arg>"), &proto));
+    XLS_ASSIGN_OR_RETURN(default_fifo_config, FifoConfig::FromProto(proto));
+  }
+  const dslx::ConvertOptions convert_options = {
+      .emit_positions = true,
+      .emit_fail_as_assert = absl::GetFlag(FLAGS_emit_fail_as_assert),
+      .warnings_as_errors = absl::GetFlag(FLAGS_warnings_as_errors),
+      .enabled_warnings = enabled_warnings,
+      .convert_tests = absl::GetFlag(FLAGS_convert_tests),
+      .default_fifo_config = default_fifo_config,
+      .lazy_typecheck = absl::GetFlag(FLAGS_lazy_typecheck),
+      .conversion_threads = absl::GetFlag(FLAGS_conversion_threads),
+  };
+
+  std::string dslx_top = absl::GetFlag(FLAGS_dslx_top);
+  bool printed_error = false;
+  std::vector<std::string_view> paths = {dslx_file};
+  XLS_ASSIGN_OR_RETURN(
+      dslx::PackageConversionData result,
+      dslx::ConvertFilesToPackage(
+          paths, absl::GetFlag(FLAGS_dslx_stdlib_path), dslx_paths,
+          convert_options,
+          /*top=*/
+          dslx_top.empty() ? std::nullopt
+                           : std::make_optional<std::string_view>(dslx_top),
+          /*package_name=*/std::nullopt, &printed_error));
+  if (printed_error) {
+    return absl::InternalError(
+        "IR conversion failed with an earlier non-fatal error.");
+  }
+  return result;
+}
+
+absl::Status OptimizeIr(Package* package) {
+  std::unique_ptr<absl::LogSink> log_file_sink;
+  if (std::string path = absl::GetFlag(FLAGS_opt_log_path); !path.empty()) {
+    log_file_sink = std::make_unique<FileStderrLogSink>(path);
+    absl::AddLogSink(log_file_sink.get());
+  }
+  absl::Cleanup log_file_sink_cleanup = [&log_file_sink] {
+    if (log_file_sink) {
+      absl::RemoveLogSink(log_file_sink.get());
+    }
+  };
+
+  std::vector<RamRewrite> ram_rewrites;
+  if (std::string path = absl::GetFlag(FLAGS_ram_rewrites_pb); !path.empty()) {
+    RamRewritesProto proto;
+    XLS_RETURN_IF_ERROR(
+        ParseTextProtoFile(std::filesystem::path(path), &proto));
+    XLS_ASSIGN_OR_RETURN(ram_rewrites, RamRewritesFromProto(proto));
+  }
+  std::variant<std::nullopt_t, std::string_view, PassPipelineProto>
+      pass_pipeline = std::nullopt;
+  std::optional<std::string> passes = absl::GetFlag(FLAGS_passes);
+  if (passes.has_value()) {
+    pass_pipeline = *passes;
+  }
+  std::string top = absl::GetFlag(FLAGS_opt_top);
+  return tools::OptimizeIrForTop(
+      package,
+      tools::OptOptions{
+          .opt_level = absl::GetFlag(FLAGS_ir_opt_level),
+          .top = top,
+          .ir_dump_path = absl::GetFlag(FLAGS_ir_dump_path),
+          .skip_passes = absl::GetFlag(FLAGS_skip_passes),
+          .convert_array_index_to_select = NegativeIsNullopt(
+              absl::GetFlag(FLAGS_convert_array_index_to_select)),
+          .split_next_value_selects =
+              NegativeIsNullopt(absl::GetFlag(FLAGS_split_next_value_selects)),
+          .inline_procs = absl::GetFlag(FLAGS_inline_procs),
+          .ram_rewrites = std::move(ram_rewrites),
+          .use_context_narrowing_analysis =
+              absl::GetFlag(FLAGS_use_context_narrowing_analysis),
+          .optimize_for_best_case_throughput =
+              absl::GetFlag(FLAGS_optimize_for_best_case_throughput),
+          .pass_pipeline = pass_pipeline,
+      });
+}
+
+// Schedules and generates code for `package` and writes the outputs requested
+// by the codegen_main flags.
+absl::Status GenerateVerilog(Package* package,
+                             const PackageInterfaceProto& interface,
+                             ArtifactWriter& writer) {
+  XLS_ASSIGN_OR_RETURN(CodegenFlagsProto codegen_flags_proto,
+                       GetCodegenFlags());
+  if (!codegen_flags_proto.top().empty()) {
+    XLS_RETURN_IF_ERROR(package->SetTopByName(codegen_flags_proto.top()));
+  }
+  if (absl::GetFlag(FLAGS_codegen_use_ir_interface) &&
+      !codegen_flags_proto.has_package_interface()) {
+    *codegen_flags_proto.mutable_package_interface() = interface;
+  }
+  const VerilogLineMapOutput line_map_output =
+      GetVerilogLineMapOutput(&codegen_flags_proto);
+  XLS_RET_CHECK(package->GetTop().has_value())
+      << "Package " << package->name() << " needs a top function/proc.";
+
+  XLS_ASSIGN_OR_RETURN(
+      SchedulingOptionsFlagsProto scheduling_options_flags_proto,
+      GetSchedulingOptionsFlagsProto());
+  XLS_ASSIGN_OR_RETURN(
+      bool delay_model_flag_passed,
+      IsDelayModelSpecifiedViaFlag(scheduling_options_flags_proto));
+  XLS_ASSIGN_OR_RETURN(
+      CodegenResult r,
+      ScheduleAndCodegen(package, scheduling_options_flags_proto,
+                         codegen_flags_proto, delay_model_flag_passed));
+  verilog::ModuleGeneratorResult& result = r.module_generator_result;
+
+  // Codegen adds the blocks to the package, so the scheduled IR is the same as
+  // the block IR, as in codegen_main.
+  const bool binary_ir = absl::GetFlag(FLAGS_output_binary_ir);
+  const std::string& schedule_ir_path =
+      absl::GetFlag(FLAGS_output_schedule_ir_path);
+  const std::string& block_ir_path = absl::GetFlag(FLAGS_output_block_ir_path);
+  if (!schedule_ir_path.empty() || !block_ir_path.empty()) {
+    XLS_RET_CHECK(block_ir_path.empty() || !package->blocks().empty())
+        << "There should be at least one block in the package after "
+           "generating module text.";
+    XLS_ASSIGN_OR_RETURN(std::string ir, DumpPackage(package, binary_ir));
+    if (!schedule_ir_path.empty()) {
+      writer.Write(schedule_ir_path, ir);
+    }
+    if (!block_ir_path.empty()) {
+      writer.Write(block_ir_path, std::move(ir));
+    }
+  }
+
+  if (std::string path = absl::GetFlag(FLAGS_output_schedule_path);
+      !path.empty()) {
+    if (r.package_pipeline_schedules_proto.has_value()) {
+      XLS_RETURN_IF_ERROR(
+          SetTextProtoFile(path, *r.package_pipeline_schedules_proto));
+    } else {
+      writer.Write(path, "");
+    }
+  }
+  if (std::string path = absl::GetFlag(FLAGS_output_signature_path);
+      !path.empty()) {
+    XLS_RETURN_IF_ERROR(SetTextProtoFile(path, result.signature.proto()));
+  }
+
+  const std::string& verilog_path = absl::GetFlag(FLAGS_output_verilog_path);
+  XLS_RETURN_IF_ERROR(WriteVerilogLineMap(line_map_output, verilog_path,
+                                          &result.verilog_line_map));
+  if (verilog_path.empty()) {
+    std::cout << result.verilog_text;
+  } else {
+    writer.Write(verilog_path, std::move(result.verilog_text));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status RunStages(std::string_view dslx_file, ArtifactWriter& writer) {
+  XLS_ASSIGN_OR_RETURN(dslx::PackageConversionData conversion,
+                       ConvertDslx(dslx_file));
+  if (std::string path = absl::GetFlag(FLAGS_output_ir_path); !path.empty()) {
+    writer.Write(path, conversion.DumpIr());
+  }
+  if (std::string path = absl::GetFlag(FLAGS_interface_proto_file);
+      !path.empty()) {
+    writer.Write(path, conversion.interface.SerializeAsString());
+  }
+
+  Package* package = conversion.package.get();
+  XLS_RETURN_IF_ERROR(OptimizeIr(package));
+  if (std::string path = absl::GetFlag(FLAGS_output_opt_ir_path);
+      !path.empty()) {
+    writer.Write(path, package->DumpIr());
+  }
+
+  return GenerateVerilog(package, conversion.interface, writer);
+}
+
+absl::Status RealMain(std::string_view dslx_file) {
+  auto timeout = StartTimeoutTimer();
+  ArtifactWriter writer;
+  absl::Status status = RunStages(dslx_file, writer);
+  // Wait for the artifacts written so far even on failure; they may help to
+  // debug the failing stage.
+  status.Update(writer.Finish());
+  return status;
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s DSLX_FILE",
+                                      argv[0]);
+  }
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0]));
+}
@@ -0,0 +1,197 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "grpc/grpc_security_constants.h"
+#include "grpcpp/channel.h"
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/format_preference.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/value.h"
+#include "xls/tools/eval_server.pb.h"
+#include "xls/tools/eval_service.grpc.pb.h"
+#include "xls/tools/eval_utils.h"
+
+static constexpr std::string_view kUsage = R"(
+Evaluates an IR function or proc network on a running eval_server_main, which
+keeps the parsed package and its compiled JIT resident between invocations.
+
+Evaluate a function, with the same input flags as eval_ir_main:
+
+   eval_client_main --input='bits[32]:42; bits[8]:1' IR_FILE
+   eval_client_main --input_file=INPUT_FILE IR_FILE
+
+Run a proc network for 10 ticks, with inputs in the format of
+eval_proc_main's --inputs_for_all_channels:
+
+   eval_client_main --proc --inputs_for_all_channels=INPUTS_FILE --ticks=10 \
+       IR_FILE
+)";
+
+ABSL_FLAG(std::string, server, "unix:/tmp/xls_eval_server.sock",
+          "Address of the eval_server_main to send requests to.");
+ABSL_FLAG(std::string, top, "", "Top entity to evaluate.");
+ABSL_FLAG(std::string, input, "",
+          "The input to the function as a semicolon-separated list of typed "
+          "values. For example: \"bits[32]:42; (bits[7]:0, bits[20]:4)\"");
+ABSL_FLAG(std::string, input_file, "",
+          "Inputs to the function, one semicolon-separated argument set per "
+          "line.");
+ABSL_FLAG(bool, proc, false, "Evaluate a proc network instead of a function.");
+ABSL_FLAG(std::string, inputs_for_all_channels, "",
+          "Path to a file with the values to enqueue on each input channel of "
+          "the proc network.");
+ABSL_FLAG(int64_t, ticks, 0,
+          "Number of ticks to run the proc network for. If zero, ticks until "
+          "the network is blocked.");
+ABSL_FLAG(int64_t, max_ticks, 100000,
+          "Maximum number of ticks when ticking until blocked.");
+ABSL_FLAG(bool, report_cache, false,
+          "Report on stderr whether the server had the package resident.");
+
+namespace xls {
+namespace {
+
+absl::Status GrpcToAbslStatus(const ::grpc::Status& grpc_status) {
+  return absl::Status(
+      // this assumes that the status code enums match up
+      static_cast<absl::StatusCode>(static_cast<int>(grpc_status.error_code())),
+      grpc_status.error_message());
+}
+
+absl::StatusOr<EvaluateFunctionRequest::ArgSet> ArgSetFromString(
+    std::string_view args_string) {
+  EvaluateFunctionRequest::ArgSet arg_set;
+  for (std::string_view value_string : absl::StrSplit(args_string, ';')) {
+    XLS_ASSIGN_OR_RETURN(Value arg, Parser::ParseTypedValue(value_string));
+    XLS_ASSIGN_OR_RETURN(*arg_set.add_args(), arg.AsProto());
+  }
+  return arg_set;
+}
+
+void ReportCache(bool cached) {
+  if (absl::GetFlag(FLAGS_report_cache)) {
+    std::cerr << (cached ? "// Package was resident.\n"
+                         : "// Package was not resident.\n");
+  }
+}
+
+absl::Status EvaluateFunction(EvalService::Stub* stub, std::string ir) {
+  EvaluateFunctionRequest request;
+  request.set_ir(std::move(ir));
+  request.set_top(absl::GetFlag(FLAGS_top));
+  if (!absl::GetFlag(FLAGS_input).empty()) {
+    QCHECK(absl::GetFlag(FLAGS_input_file).empty())
+        << "Cannot specify both --input and --input_file";
+    XLS_ASSIGN_OR_RETURN(*request.add_arg_sets(),
+                         ArgSetFromString(absl::GetFlag(FLAGS_input)));
+  } else {
+    QCHECK(!absl::GetFlag(FLAGS_input_file).empty())
+        << "Must specify --input or --input_file.";
+    XLS_ASSIGN_OR_RETURN(std::string inputs,
+                         GetFileContents(absl::GetFlag(FLAGS_input_file)));
+    for (std::string_view line :
+         absl::StrSplit(inputs, '\n', absl::SkipWhitespace())) {
+      XLS_ASSIGN_OR_RETURN(*request.add_arg_sets(), ArgSetFromString(line));
+    }
+  }
+
+  ::grpc::ClientContext context;
+  EvaluateFunctionResponse response;
+  XLS_RETURN_IF_ERROR(GrpcToAbslStatus(
+      stub->EvaluateFunction(&context, request, &response)));
+  ReportCache(response.cached());
+  for (const ValueProto& result : response.results()) {
+    XLS_ASSIGN_OR_RETURN(Value value, Value::FromProto(result));
+    std::cout << value.ToString(FormatPreference::kHex) << '\n';
+  }
+  return absl::OkStatus();
+}
+
+absl::Status EvaluateProc(EvalService::Stub* stub, std::string ir) {
+  EvaluateProcRequest request;
+  request.set_ir(std::move(ir));
+  request.set_top(absl::GetFlag(FLAGS_top));
+  request.set_ticks(absl::GetFlag(FLAGS_ticks));
+  request.set_max_ticks(absl::GetFlag(FLAGS_max_ticks));
+  if (!absl::GetFlag(FLAGS_inputs_for_all_channels).empty()) {
+    XLS_ASSIGN_OR_RETURN(
+        (absl::btree_map<std::string, std::vector<Value>> inputs),
+        ParseChannelValuesFromFile(
+            absl::GetFlag(FLAGS_inputs_for_all_channels)));
+    XLS_ASSIGN_OR_RETURN(*request.mutable_inputs(),
+                         ChannelValuesToProto(inputs));
+  }
+
+  ::grpc::ClientContext context;
+  EvaluateProcResponse response;
+  XLS_RETURN_IF_ERROR(
+      GrpcToAbslStatus(stub->EvaluateProc(&context, request, &response)));
+  ReportCache(response.cached());
+  XLS_ASSIGN_OR_RETURN(
+      (absl::btree_map<std::string, std::vector<Value>> outputs),
+      ParseChannelValuesFromProto(response.outputs()));
+  std::cout << ChannelValuesToString(outputs) << '\n';
+  return absl::OkStatus();
+}
+
+absl::Status RealMain(std::string_view ir_path) {
+  if (ir_path == "-") {
+    ir_path = "/dev/stdin";
+  }
+  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(ir_path));
+  std::shared_ptr<::grpc::Channel> channel =
+      ::grpc::CreateChannel(absl::GetFlag(FLAGS_server),
+                            ::grpc::experimental::LocalCredentials(UDS));
+  std::unique_ptr<EvalService::Stub> stub(EvalService::NewStub(channel));
+  if (absl::GetFlag(FLAGS_proc)) {
+    return EvaluateProc(stub.get(), std::move(ir));
+  }
+  return EvaluateFunction(stub.get(), std::move(ir));
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  if (positional_arguments.size() != 1) {
+    LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <ir-path>",
+                                      argv[0]);
+  }
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0]));
+}
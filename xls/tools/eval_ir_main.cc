@@ -76,6 +76,7 @@
 #include "xls/dslx/parse_and_typecheck.h"
 #include "xls/dslx/virtualizable_file_system.h"
 #include "xls/dslx/warning_kind.h"
+#include "xls/interpreter/compiled_function_interpreter.h"
 #include "xls/interpreter/function_interpreter.h"
 #include "xls/interpreter/observer.h"
 #include "xls/interpreter/random_value.h"
@@ -376,6 +377,7 @@ absl::StatusOr<std::vector<Value>> Eval(
     std::string_view expected_src = "expected") {
   EvalIrJitObserver observer(absl::GetFlag(FLAGS_use_llvm_jit_interpreter));
   std::unique_ptr<FunctionJit> jit;
+  std::unique_ptr<CompiledFunctionInterpreter> interpreter;
   if (use_jit) {
     // No support for procs yet.
     XLS_ASSIGN_OR_RETURN(
@@ -383,6 +385,8 @@ absl::StatusOr<std::vector<Value>> Eval(
                  f, absl::GetFlag(FLAGS_llvm_opt_level),
                  /*include_observer_callbacks=*/eval_observer.has_value(),
                  &observer));
+  } else {
+    XLS_ASSIGN_OR_RETURN(interpreter, CompiledFunctionInterpreter::Create(f));
   }
 
   std::vector<Value> results;
@@ -420,8 +424,8 @@ absl::StatusOr<std::vector<Value>> Eval(
       // resulting events once the JIT fully supports events. Note: This will
       // require rethinking some of the control flow because event comparison
       // only makes sense for certain modes (optimize_ir and test_llvm_jit).
-      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(InterpretFunction(
-                                       f, arg_set.args, eval_observer)));
+      XLS_ASSIGN_OR_RETURN(result, DropInterpreterEvents(interpreter->Run(
+                                       arg_set.args, eval_observer)));
     }
     std::cout << result.ToString(FormatPreference::kHex) << '\n';
 
@@ -30,6 +30,7 @@
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
@@ -60,6 +61,7 @@
 #include "xls/interpreter/channel_queue.h"
 #include "xls/interpreter/evaluator_options.h"
 #include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime_telemetry.h"
 #include "xls/interpreter/serial_proc_runtime.h"
 #include "xls/ir/bits.h"
 #include "xls/ir/block.h"
@@ -77,8 +79,11 @@
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
 #include "xls/jit/block_jit.h"
+#include "xls/jit/jit_channel_queue.h"
 #include "xls/jit/jit_proc_runtime.h"
 #include "xls/jit/jit_runtime.h"
+#include "xls/tools/activity_profile_utils.h"
+#include "xls/tools/channel_value_stream.h"
 #include "xls/tools/eval_utils.h"
 #include "xls/tools/memory_models.h"
 #include "xls/tools/node_coverage_utils.h"
@@ -128,6 +133,26 @@ ABSL_FLAG(
     "'expected_outputs_for_all_channels' are not specified the values of all "
     "the channel are displayed on stdout.");
 
+ABSL_FLAG(
+    std::vector<std::string>, input_streams_for_channels, {},
+    "Comma separated list of channel=filename pairs of channel value streams "
+    "(see xls/tools/channel_value_stream.h) to feed to input channels. "
+    "Streams are read incrementally as the procs consume them, so they may be "
+    "arbitrarily large. Only supported for proc backends.");
+ABSL_FLAG(
+    std::vector<std::string>, expected_output_streams_for_channels, {},
+    "Comma separated list of channel=filename pairs of channel value streams "
+    "which output channels are expected to produce. Outputs are compared as "
+    "they are produced rather than after the run. Only supported for proc "
+    "backends.");
+ABSL_FLAG(std::vector<std::string>, output_streams_for_channels, {},
+          "Comma separated list of channel=filename pairs of channel value "
+          "streams to write the values produced on output channels to as they "
+          "are produced. Only supported for proc backends.");
+ABSL_FLAG(int64_t, stream_buffer_size, 1024,
+          "Number of values of each channel value stream read ahead of the "
+          "simulation.");
+
 ABSL_FLAG(std::string, testvector_textproto, "",
           "A textproto file containing proc channel test vectors.");
 
@@ -183,6 +208,11 @@ ABSL_FLAG(int64_t, max_trace_verbosity, 0,
           "stripped from codegen output. 0 by default.");
 ABSL_FLAG(int64_t, trace_per_ticks, 100, "Print a trace every N ticks.");
 ABSL_FLAG(std::string, output_stats_path, "", "File to output statistics to.");
+ABSL_FLAG(std::string, telemetry_trace_path, "",
+          "If non-empty, proc runtime telemetry is collected and written to "
+          "this file as a Chrome trace (chrome://tracing or Perfetto) of the "
+          "occupancy of every channel and the procs blocked on receives in "
+          "every tick, and a summary is logged. Only used for procs.");
 ABSL_FLAG(bool, fail_on_assert, false,
           "When set to true, the simulation fails on the activation or cycle "
           "in which an assertion fires.");
@@ -194,6 +224,16 @@ ABSL_FLAG(std::optional<std::string>, output_node_coverage_stats_textproto,
           std::nullopt,
           "File to write a (text) NodeCoverageStatsProto showing which bits "
           "in the run were actually set for each node.");
+ABSL_FLAG(std::optional<std::string>, output_activity_profile_proto,
+          std::nullopt,
+          "File to write a (binary) ActivityProfileProto with per-node "
+          "activation counts, per-proc tick counts and per-channel occupancy "
+          "histograms of the run. Procs only.");
+ABSL_FLAG(std::optional<std::string>, output_activity_profile_textproto,
+          std::nullopt,
+          "File to write a (text) ActivityProfileProto with per-node "
+          "activation counts, per-proc tick counts and per-channel occupancy "
+          "histograms of the run. Procs only.");
 ABSL_FLAG(bool, abstract_ram_model, false,
           "Whether or not to use an abstract RAM model, as opposed to a "
           "rewritten RAM model, for proc memory.\n");
@@ -231,22 +271,107 @@ struct EvaluateProcsOptions {
   bool fail_on_assert = false;
   std::vector<int64_t> ticks = {-1};
   std::optional<std::string> top = std::nullopt;
+  // If non-empty, proc runtime telemetry is collected and written here.
+  std::string telemetry_trace_path;
 };
 
+// Channels whose values are streamed from or to channel value stream files
+// rather than held in memory; see channel_value_stream.h.
+struct ChannelStreams {
+  absl::btree_map<std::string, std::unique_ptr<ChannelValueStreamReader>>
+      inputs;
+  absl::btree_map<std::string, std::unique_ptr<ChannelValueStreamReader>>
+      expected_outputs;
+  absl::btree_map<std::string, std::unique_ptr<ChannelValueStreamWriter>>
+      outputs;
+
+  bool empty() const {
+    return inputs.empty() && expected_outputs.empty() && outputs.empty();
+  }
+};
+
+// Feeds the streamed inputs to their channels' queues as the procs read them.
+// Queue generators cannot fail, so the first error reading a stream is noted in
+// `status` instead.
+static absl::Status AttachInputStreams(ChannelStreams& streams,
+                                       ChannelQueueManager& queue_manager,
+                                       absl::Status& status) {
+  for (auto& [channel_name, reader] : streams.inputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * in_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    XLS_RETURN_IF_ERROR(in_queue->AttachGenerator(
+        [reader = reader.get(), &status]() -> std::optional<Value> {
+          absl::StatusOr<std::optional<Value>> value = reader->Next();
+          if (!value.ok()) {
+            status.Update(value.status());
+            return std::nullopt;
+          }
+          return *std::move(value);
+        }));
+  }
+  return absl::OkStatus();
+}
+
+// Moves the values produced so far on streamed output channels out of their
+// queues, checking them against the expected streams and writing them to the
+// output streams. Sets `checked_any_output` if an expected value was matched.
+static absl::Status DrainOutputStreams(ChannelStreams& streams,
+                                       ChannelQueueManager& queue_manager,
+                                       bool& checked_any_output) {
+  for (auto& [channel_name, reader] : streams.expected_outputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    while (std::optional<Value> out_val = out_queue->Read()) {
+      XLS_ASSIGN_OR_RETURN(std::optional<Value> expected, reader->Next());
+      if (!expected.has_value()) {
+        // As with in-memory expectations, outputs beyond the expected ones are
+        // not checked.
+        continue;
+      }
+      if (*expected != *out_val) {
+        return absl::UnknownError(absl::StrFormat(
+            "Outputs did not match expectations:\n\nMismatched (channel=%s) "
+            "after %d outputs (%s != %s)",
+            channel_name, reader->consumed() - 1, expected->ToString(),
+            out_val->ToString()));
+      }
+      checked_any_output = true;
+    }
+  }
+  for (auto& [channel_name, writer] : streams.outputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
+                         queue_manager.GetQueueByName(channel_name));
+    while (std::optional<Value> out_val = out_queue->Read()) {
+      XLS_RETURN_IF_ERROR(writer->Write(*out_val));
+    }
+  }
+  return absl::OkStatus();
+}
+
 static absl::Status EvaluateProcs(
     Package* package,
     const absl::btree_map<std::string, std::vector<Value>>& inputs_for_channels,
     absl::btree_map<std::string, std::vector<Value>>&
         expected_outputs_for_channels,
-    const RamRewritesProto& ram_rewrites,
+    ChannelStreams& streams, const RamRewritesProto& ram_rewrites,
     const EvaluateProcsOptions& options = {}) {
   std::unique_ptr<SerialProcRuntime> runtime;
   std::optional<JitRuntime*> jit;
+  JitChannelQueueManager* jit_queue_manager = nullptr;
   EvaluatorOptions evaluator_options;
   evaluator_options.set_trace_channels(absl::GetFlag(FLAGS_trace_channels));
-  bool uses_observers =
+  bool uses_coverage =
       absl::GetFlag(FLAGS_output_node_coverage_stats_proto).has_value() ||
       absl::GetFlag(FLAGS_output_node_coverage_stats_textproto).has_value();
+  bool uses_profile =
+      absl::GetFlag(FLAGS_output_activity_profile_proto).has_value() ||
+      absl::GetFlag(FLAGS_output_activity_profile_textproto).has_value();
+  if (uses_coverage && uses_profile) {
+    return absl::InvalidArgumentError(
+        "Node coverage and activity profiles cannot be recorded in the same "
+        "run.");
+  }
+  bool uses_observers = uses_coverage || uses_profile;
   if (options.top) {
     XLS_ASSIGN_OR_RETURN(Proc * proc, package->GetProc(*options.top));
     if (proc != package->GetTop()) {
@@ -258,8 +383,9 @@ static absl::Status EvaluateProcs(
   if (options.use_jit) {
     XLS_ASSIGN_OR_RETURN(
         runtime, CreateJitSerialProcRuntime(package, evaluator_options));
-    XLS_ASSIGN_OR_RETURN(auto jit_queue, runtime->GetJitChannelQueueManager());
-    jit = &jit_queue->runtime();
+    XLS_ASSIGN_OR_RETURN(jit_queue_manager,
+                         runtime->GetJitChannelQueueManager());
+    jit = &jit_queue_manager->runtime();
   } else {
     XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(
                                       package, evaluator_options));
@@ -271,9 +397,37 @@ static absl::Status EvaluateProcs(
     XLS_RETURN_IF_ERROR(runtime->SetObserver(*cov.observer()));
     LOG(ERROR) << "Set observer!";
   }
+  ScopedRecordActivityProfile profile(
+      absl::GetFlag(FLAGS_output_activity_profile_proto),
+      absl::GetFlag(FLAGS_output_activity_profile_textproto), package, jit);
+  if (profile.observer()) {
+    XLS_RETURN_IF_ERROR(runtime->SetObserver(*profile.observer()));
+  }
 
   ChannelQueueManager& queue_manager = runtime->queue_manager();
 
+  // The telemetry samples every queue once per tick; activity profiles take
+  // their channel occupancy from it too.
+  if (!options.telemetry_trace_path.empty() || profile.observer()) {
+    runtime->EnableTelemetry(
+        /*record_timeline=*/!options.telemetry_trace_path.empty());
+    profile.SetTelemetry(runtime->telemetry());
+  }
+  // Written even if the simulation fails, e.g. deadlocks, as that is when it
+  // is most useful.
+  absl::Cleanup write_telemetry = [&]() {
+    const ProcRuntimeTelemetry* telemetry = runtime->telemetry();
+    if (telemetry == nullptr || options.telemetry_trace_path.empty()) {
+      return;
+    }
+    LOG(INFO) << telemetry->Summary();
+    absl::Status status = SetFileContents(options.telemetry_trace_path,
+                                          telemetry->ToChromeTrace());
+    if (!status.ok()) {
+      LOG(ERROR) << "Unable to write proc runtime telemetry: " << status;
+    }
+  };
+
   std::vector<std::unique_ptr<memory_model::ProcMemoryModel>> memory_models;
 
   const bool abstract_ram_model = absl::GetFlag(FLAGS_abstract_ram_model);
@@ -290,6 +444,12 @@ static absl::Status EvaluateProcs(
       XLS_ASSIGN_OR_RETURN(memory_model,
                            memory_model::CreateAbstractProcMemoryModel(
                                ram_rewrite, queue_manager));
+    } else if (ram_rewrite.to_config().kind() == RamKindProto::RAM_1RW &&
+               jit_queue_manager != nullptr) {
+      // Service the JIT's queues in their native layout.
+      XLS_ASSIGN_OR_RETURN(memory_model,
+                           memory_model::CreateNativeRewrittenProcMemoryModel(
+                               ram_rewrite, *jit_queue_manager));
     } else if (ram_rewrite.to_config().kind() == RamKindProto::RAM_1RW) {
       XLS_ASSIGN_OR_RETURN(memory_model,
                            memory_model::CreateRewrittenProcMemoryModel(
@@ -321,6 +481,10 @@ static absl::Status EvaluateProcs(
                 << " outputs";
     }
   }
+  absl::Status input_stream_status;
+  XLS_RETURN_IF_ERROR(
+      AttachInputStreams(streams, queue_manager, input_stream_status));
+  bool checked_any_output = false;
 
   absl::Time start_time = absl::Now();
 
@@ -348,10 +512,14 @@ static absl::Status EvaluateProcs(
           ostr << channel_name << "[" << in_queue->GetSize() << "] " << " ";
         }
         LOG(INFO) << "Tick " << i << ": " << ostr.str();
+        if (runtime->telemetry() != nullptr) {
+          LOG(INFO) << runtime->telemetry()->Summary();
+        }
       }
       // Don't double print events (traces, assertions, etc)
       runtime->ClearInterpreterEvents();
       absl::Status tick_ret = runtime->Tick();
+      XLS_RETURN_IF_ERROR(input_stream_status);
 
       if (!tick_ret.ok()) {
         for (const auto& [channel_name, values] :
@@ -373,11 +541,12 @@ static absl::Status EvaluateProcs(
         }
         return tick_ret;
       }
-
       for (std::unique_ptr<memory_model::ProcMemoryModel>& memory :
            memory_models) {
         XLS_RETURN_IF_ERROR(memory->Tick());
       }
+      XLS_RETURN_IF_ERROR(
+          DrainOutputStreams(streams, queue_manager, checked_any_output));
 
       // Sort the keys for stable print order.
       absl::flat_hash_map<Proc*, std::vector<Value>> states;
@@ -429,6 +598,12 @@ static absl::Status EvaluateProcs(
             all_outputs_produced = false;
           }
         }
+        for (auto& [channel_name, reader] : streams.expected_outputs) {
+          XLS_ASSIGN_OR_RETURN(std::optional<Value> expected, reader->Peek());
+          if (expected.has_value()) {
+            all_outputs_produced = false;
+          }
+        }
         if (all_outputs_produced) {
           absl::btree_map<std::string, std::vector<Value>> unconsumed_inputs;
           for (const auto& [channel_name, _] : inputs_for_channels) {
@@ -455,8 +630,18 @@ static absl::Status EvaluateProcs(
   }
   absl::Duration elapsed_time = absl::Now() - start_time;
   LOG(INFO) << "Elapsed time: " << elapsed_time;
-  bool checked_any_output = false;
   std::vector<std::string> errors;
+  for (auto& [channel_name, reader] : streams.expected_outputs) {
+    XLS_ASSIGN_OR_RETURN(std::optional<Value> expected, reader->Peek());
+    if (expected.has_value()) {
+      errors.push_back(absl::StrFormat(
+          "Channel %s didn't produce all expected values (processed %d)",
+          channel_name, reader->consumed()));
+    }
+  }
+  for (auto& [channel_name, writer] : streams.outputs) {
+    XLS_RETURN_IF_ERROR(writer->Close());
+  }
   for (const auto& [channel_name, values] : expected_outputs_for_channels) {
     XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
                          queue_manager.GetQueueByName(channel_name));
@@ -488,13 +673,15 @@ static absl::Status EvaluateProcs(
         absl::StrFormat("Outputs did not match expectations:\n\n%s",
                         absl::StrJoin(errors, "\n")));
   }
-  if (!checked_any_output && !expected_outputs_for_channels.empty()) {
+  if (!checked_any_output && (!expected_outputs_for_channels.empty() ||
+                              !streams.expected_outputs.empty())) {
     return absl::UnknownError("No output verified (empty expected values?)");
   }
 
-  if (expected_outputs_for_channels.empty()) {
+  if (expected_outputs_for_channels.empty() &&
+      streams.expected_outputs.empty()) {
     for (const Channel* channel : package->channels()) {
-      if (!channel->CanSend()) {
+      if (!channel->CanSend() || streams.outputs.contains(channel->name())) {
         continue;
       }
       XLS_ASSIGN_OR_RETURN(ChannelQueue * out_queue,
@@ -1106,6 +1293,40 @@ GetValuesForEachChannels(
   return values_for_channels;
 }
 
+static absl::StatusOr<ChannelStreams> OpenChannelStreams() {
+  ChannelStreams streams;
+  const int64_t buffer_size = absl::GetFlag(FLAGS_stream_buffer_size);
+  XLS_ASSIGN_OR_RETURN(
+      auto input_files,
+      ParseChannelFilenames(absl::GetFlag(FLAGS_input_streams_for_channels)));
+  for (const auto& [channel_name, filename] : input_files) {
+    XLS_ASSIGN_OR_RETURN(
+        streams.inputs[channel_name],
+        ChannelValueStreamReader::Create(filename, buffer_size));
+  }
+  XLS_ASSIGN_OR_RETURN(auto expected_files,
+                       ParseChannelFilenames(absl::GetFlag(
+                           FLAGS_expected_output_streams_for_channels)));
+  for (const auto& [channel_name, filename] : expected_files) {
+    XLS_ASSIGN_OR_RETURN(
+        streams.expected_outputs[channel_name],
+        ChannelValueStreamReader::Create(filename, buffer_size));
+  }
+  XLS_ASSIGN_OR_RETURN(
+      auto output_files,
+      ParseChannelFilenames(absl::GetFlag(FLAGS_output_streams_for_channels)));
+  for (const auto& [channel_name, filename] : output_files) {
+    if (streams.expected_outputs.contains(channel_name)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Channel %s cannot have both an expected and an output stream.",
+          channel_name));
+    }
+    XLS_ASSIGN_OR_RETURN(streams.outputs[channel_name],
+                         ChannelValueStreamWriter::Create(filename));
+  }
+  return streams;
+}
+
 static absl::Status RealMain(
     std::string_view ir_file, std::string_view backend,
     std::string_view block_signature_proto, std::vector<int64_t> ticks,
@@ -1163,6 +1384,8 @@ static absl::Status RealMain(
                                         total_ticks));
   }
 
+  XLS_ASSIGN_OR_RETURN(ChannelStreams streams, OpenChannelStreams());
+
   RamRewritesProto ram_rewrites;
 
   if (!ram_rewrites_textproto_path.empty()) {
@@ -1174,6 +1397,10 @@ static absl::Status RealMain(
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
 
   if (backend.starts_with("block")) {
+    if (!streams.empty()) {
+      return absl::UnimplementedError(
+          "Channel value streams are not supported for block simulation.");
+    }
     RunBlockOptions block_options = {
         .ticks = ticks,
         .max_cycles_no_output = max_cycles_no_output,
@@ -1201,6 +1428,7 @@ static absl::Status RealMain(
       .fail_on_assert = fail_on_assert,
       .ticks = ticks,
       .top = absl::GetFlag(FLAGS_top),
+      .telemetry_trace_path = absl::GetFlag(FLAGS_telemetry_trace_path),
   };
 
   if (backend == "serial_jit") {
@@ -1211,7 +1439,7 @@ static absl::Status RealMain(
     LOG(QFATAL) << "Unknown backend type";
   }
   return EvaluateProcs(package.get(), inputs_for_channels,
-                       expected_outputs_for_channels, ram_rewrites,
+                       expected_outputs_for_channels, streams, ram_rewrites,
                        evaluate_procs_options);
 }
 
@@ -0,0 +1,232 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/eval_server.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/events.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/function_jit.h"
+#include "xls/jit/jit_proc_runtime.h"
+#include "xls/tools/eval_server.pb.h"
+#include "xls/tools/eval_utils.h"
+
+namespace xls {
+
+// A resident package and the JITs compiled for it so far.
+struct EvalServer::Entry {
+  explicit Entry(std::string ir_text) : ir(std::move(ir_text)) {}
+
+  const std::string ir;
+  // The value of `use_count_` when this entry was last used.
+  int64_t last_use = 0;
+
+  // Serializes evaluations, as neither the JITs nor the runtimes may be used
+  // concurrently.
+  absl::Mutex mutex;
+  std::unique_ptr<Package> package ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_map<std::string, std::unique_ptr<FunctionJit>> function_jits
+      ABSL_GUARDED_BY(mutex);
+  absl::flat_hash_map<std::string, std::unique_ptr<SerialProcRuntime>>
+      proc_runtimes ABSL_GUARDED_BY(mutex);
+};
+
+EvalServer::~EvalServer() = default;
+
+absl::StatusOr<std::shared_ptr<EvalServer::Entry>> EvalServer::GetEntry(
+    std::string_view ir, bool* cached) {
+  uint64_t key = absl::HashOf(ir);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = entries_.find(key);
+    // Hash collisions are handled by replacing the resident entry.
+    if (it != entries_.end() && it->second->ir == ir) {
+      it->second->last_use = ++use_count_;
+      *cached = true;
+      return it->second;
+    }
+  }
+  *cached = false;
+  // Parse outside of the lock so other packages can be served meanwhile.
+  auto entry = std::make_shared<Entry>(std::string(ir));
+  {
+    absl::MutexLock entry_lock(&entry->mutex);
+    XLS_ASSIGN_OR_RETURN(entry->package, Parser::ParsePackage(ir));
+  }
+  absl::MutexLock lock(&mutex_);
+  entry->last_use = ++use_count_;
+  entries_[key] = entry;
+  // The entry just added is never the least recently used.
+  while (entries_.size() > 1 && static_cast<int64_t>(entries_.size()) >
+                                    options_.max_cached_packages) {
+    auto lru = entries_.begin();
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->second->last_use < lru->second->last_use) {
+        lru = it;
+      }
+    }
+    // In-flight requests keep their entry alive through their reference.
+    entries_.erase(lru);
+  }
+  return entry;
+}
+
+absl::StatusOr<EvaluateFunctionResponse> EvalServer::EvaluateFunction(
+    const EvaluateFunctionRequest& request) {
+  EvaluateFunctionResponse response;
+  bool cached;
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<Entry> entry,
+                       GetEntry(request.ir(), &cached));
+  absl::MutexLock lock(&entry->mutex);
+  Function* f;
+  if (request.top().empty()) {
+    XLS_ASSIGN_OR_RETURN(f, entry->package->GetTopAsFunction());
+  } else {
+    XLS_ASSIGN_OR_RETURN(f, entry->package->GetFunction(request.top()));
+  }
+  std::unique_ptr<FunctionJit>& jit = entry->function_jits[f->name()];
+  cached = cached && jit != nullptr;
+  if (jit == nullptr) {
+    XLS_ASSIGN_OR_RETURN(jit, FunctionJit::Create(f, options_.llvm_opt_level));
+  }
+
+  std::vector<std::vector<Value>> arg_sets;
+  arg_sets.reserve(request.arg_sets_size());
+  for (const EvaluateFunctionRequest::ArgSet& arg_set : request.arg_sets()) {
+    std::vector<Value>& args = arg_sets.emplace_back();
+    args.reserve(arg_set.args_size());
+    for (const ValueProto& arg : arg_set.args()) {
+      XLS_ASSIGN_OR_RETURN(args.emplace_back(), Value::FromProto(arg));
+    }
+    if (args.size() != f->params().size()) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Function `%s` takes %d arguments, argument set %d has %d",
+          f->name(), f->params().size(), arg_sets.size() - 1, args.size()));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<Value> results,
+                       DropInterpreterEvents(jit->RunBatched(arg_sets)));
+  for (const Value& result : results) {
+    XLS_ASSIGN_OR_RETURN(*response.add_results(), result.AsProto());
+  }
+  response.set_cached(cached);
+  return response;
+}
+
+absl::StatusOr<EvaluateProcResponse> EvalServer::EvaluateProc(
+    const EvaluateProcRequest& request) {
+  EvaluateProcResponse response;
+  bool cached;
+  XLS_ASSIGN_OR_RETURN(std::shared_ptr<Entry> entry,
+                       GetEntry(request.ir(), &cached));
+  absl::MutexLock lock(&entry->mutex);
+  std::unique_ptr<SerialProcRuntime>& runtime =
+      entry->proc_runtimes[request.top()];
+  cached = cached && runtime != nullptr;
+  if (runtime == nullptr) {
+    std::optional<Proc*> top;
+    if (!request.top().empty()) {
+      XLS_ASSIGN_OR_RETURN(top, entry->package->GetProc(request.top()));
+    }
+    if (top.has_value() && (*top)->is_new_style_proc()) {
+      XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(*top));
+    } else {
+      XLS_ASSIGN_OR_RETURN(runtime,
+                           CreateJitSerialProcRuntime(entry->package.get()));
+    }
+  } else {
+    // Start over from the initial state; earlier requests may have left
+    // values in the queues.
+    runtime->ResetState();
+    runtime->ClearInterpreterEvents();
+    for (ChannelQueue* queue : runtime->queue_manager().queues()) {
+      while (queue->Read().has_value()) {
+      }
+    }
+  }
+
+  XLS_ASSIGN_OR_RETURN(
+      (absl::btree_map<std::string, std::vector<Value>> inputs),
+      ParseChannelValuesFromProto(request.inputs()));
+  for (const auto& [name, values] : inputs) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         runtime->queue_manager().GetQueueByName(name));
+    if (queue->channel()->supported_ops() != ChannelOps::kReceiveOnly) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Inputs must be on receive-only channels, `%s` is not", name));
+    }
+    for (const Value& value : values) {
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+    }
+  }
+
+  int64_t ticks = request.ticks();
+  if (ticks > 0) {
+    for (int64_t i = 0; i < ticks; ++i) {
+      XLS_RETURN_IF_ERROR(runtime->Tick());
+    }
+  } else {
+    std::optional<int64_t> max_ticks;
+    if (request.max_ticks() > 0) {
+      max_ticks = request.max_ticks();
+    }
+    XLS_ASSIGN_OR_RETURN(ticks, runtime->TickUntilBlocked(max_ticks));
+  }
+  for (ProcInstance* instance : runtime->elaboration().proc_instances()) {
+    XLS_RETURN_IF_ERROR(
+        InterpreterEventsToStatus(runtime->GetInterpreterEvents(instance)));
+  }
+
+  absl::btree_map<std::string, std::vector<Value>> outputs;
+  for (ChannelQueue* queue : runtime->queue_manager().queues()) {
+    if (queue->channel()->supported_ops() != ChannelOps::kSendOnly) {
+      continue;
+    }
+    std::vector<Value>& values = outputs[queue->channel()->name()];
+    while (std::optional<Value> value = queue->Read()) {
+      values.push_back(*std::move(value));
+    }
+  }
+  XLS_ASSIGN_OR_RETURN(*response.mutable_outputs(),
+                       ChannelValuesToProto(outputs));
+  response.set_ticks(ticks);
+  response.set_cached(cached);
+  return response;
+}
+
+}  // namespace xls
@@ -0,0 +1,81 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_EVAL_SERVER_H_
+#define XLS_TOOLS_EVAL_SERVER_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "xls/tools/eval_server.pb.h"
+
+namespace xls {
+
+struct EvalServerOptions {
+  // The maximum number of packages kept resident. When exceeded, the least
+  // recently used package (and its JITs) is dropped.
+  int64_t max_cached_packages = 64;
+  // The LLVM optimization level of the function JITs.
+  int64_t llvm_opt_level = 3;
+};
+
+// Evaluates IR functions and procs with the JIT, keeping parsed packages and
+// their compiled JITs resident between requests so that a long-lived process
+// can serve many evaluations of the same package without reparsing or
+// recompiling. Requests may be served concurrently; requests for the same
+// package are serialized.
+class EvalServer {
+ public:
+  explicit EvalServer(EvalServerOptions options = EvalServerOptions())
+      : options_(options) {}
+  ~EvalServer();
+
+  absl::StatusOr<EvaluateFunctionResponse> EvaluateFunction(
+      const EvaluateFunctionRequest& request);
+
+  // Each request runs the network from its initial state with empty channel
+  // queues (other than the given inputs).
+  absl::StatusOr<EvaluateProcResponse> EvaluateProc(
+      const EvaluateProcRequest& request);
+
+  int64_t cached_package_count() const {
+    absl::MutexLock lock(&mutex_);
+    return entries_.size();
+  }
+
+ private:
+  struct Entry;
+
+  // Returns the resident entry for `ir`, parsing the package if it is not
+  // resident. `cached` is set to whether it was.
+  absl::StatusOr<std::shared_ptr<Entry>> GetEntry(std::string_view ir,
+                                                  bool* cached);
+
+  EvalServerOptions options_;
+  mutable absl::Mutex mutex_;
+  // Keyed by the hash of the IR text.
+  absl::flat_hash_map<uint64_t, std::shared_ptr<Entry>> entries_
+      ABSL_GUARDED_BY(mutex_);
+  int64_t use_count_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_EVAL_SERVER_H_
@@ -0,0 +1,123 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "grpc/grpc_security_constants.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "xls/common/init_xls.h"
+#include "xls/tools/eval_server.h"
+#include "xls/tools/eval_server.pb.h"
+#include "xls/tools/eval_service.grpc.pb.h"
+
+static constexpr std::string_view kUsage = R"(
+Launches a long-lived evaluation server which keeps parsed packages and their
+compiled JITs resident between requests. Use eval_client_main to send it
+requests in place of invoking eval_ir_main or eval_proc_main.
+
+Invocation:
+
+  eval_server_main --address=unix:/tmp/xls_eval_server.sock
+)";
+
+ABSL_FLAG(std::string, address, "unix:/tmp/xls_eval_server.sock",
+          "Address to listen on. Only local (unix:) addresses are accepted.");
+ABSL_FLAG(int64_t, max_cached_packages, 64,
+          "Maximum number of packages to keep resident.");
+ABSL_FLAG(int64_t, llvm_opt_level, 3,
+          "The optimization level of the LLVM JIT. Valid values are from 0 "
+          "(no optimizations) to 3 (maximum optimizations).");
+
+namespace xls {
+namespace {
+
+::grpc::Status ToGrpcStatus(const absl::Status& status) {
+  // The status code enums match up.
+  return ::grpc::Status(static_cast<::grpc::StatusCode>(status.code()),
+                        std::string(status.message()));
+}
+
+class EvalServiceImpl : public EvalService::Service {
+ public:
+  explicit EvalServiceImpl(EvalServer* server) : server_(server) {}
+
+  ::grpc::Status EvaluateFunction(::grpc::ServerContext* server_context,
+                                  const EvaluateFunctionRequest* request,
+                                  EvaluateFunctionResponse* result) override {
+    absl::StatusOr<EvaluateFunctionResponse> response =
+        server_->EvaluateFunction(*request);
+    if (!response.ok()) {
+      return ToGrpcStatus(response.status());
+    }
+    *result = *std::move(response);
+    return ::grpc::Status::OK;
+  }
+
+  ::grpc::Status EvaluateProc(::grpc::ServerContext* server_context,
+                              const EvaluateProcRequest* request,
+                              EvaluateProcResponse* result) override {
+    absl::StatusOr<EvaluateProcResponse> response =
+        server_->EvaluateProc(*request);
+    if (!response.ok()) {
+      return ToGrpcStatus(response.status());
+    }
+    *result = *std::move(response);
+    return ::grpc::Status::OK;
+  }
+
+ private:
+  EvalServer* server_;
+};
+
+void RealMain() {
+  EvalServer server(EvalServerOptions{
+      .max_cached_packages = absl::GetFlag(FLAGS_max_cached_packages),
+      .llvm_opt_level = absl::GetFlag(FLAGS_llvm_opt_level)});
+  EvalServiceImpl service(&server);
+
+  std::string address = absl::GetFlag(FLAGS_address);
+  ::grpc::ServerBuilder builder;
+  builder.AddListeningPort(
+      address, ::grpc::experimental::LocalServerCredentials(UDS));
+  builder.RegisterService(&service);
+  std::unique_ptr<::grpc::Server> server_handle(builder.BuildAndStart());
+  QCHECK(server_handle != nullptr) << "Unable to listen on " << address;
+  LOG(INFO) << "Serving on: " << address;
+  server_handle->Wait();
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  xls::InitXls(kUsage, argc, argv);
+
+  xls::RealMain();
+
+  return EXIT_SUCCESS;
+}
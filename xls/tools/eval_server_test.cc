@@ -0,0 +1,145 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/eval_server.h"
+
+#include <cstdint>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "absl/status/status_matchers.h"
+#include "xls/common/proto_test_utils.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/value.h"
+#include "xls/tools/eval_server.pb.h"
+#include "xls/tools/proc_channel_values.pb.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::HasSubstr;
+using ::xls::proto_testing::EqualsProto;
+
+constexpr char kAddIr[] = R"(
+package p
+
+top fn add(x: bits[8], y: bits[8]) -> bits[8] {
+  ret add.1: bits[8] = add(x, y)
+}
+)";
+
+// A proc which sends the running sum of the values it receives.
+constexpr char kAccumulatorIr[] = R"(
+package p
+
+chan in(bits[32], id=0, kind=streaming, ops=receive_only, flow_control=ready_valid, metadata="")
+chan out(bits[32], id=1, kind=streaming, ops=send_only, flow_control=ready_valid, metadata="")
+
+proc accum(tkn: token, sum: bits[32], init={token, 0}) {
+  receive.1: (token, bits[32]) = receive(tkn, channel=in)
+  tuple_index.2: token = tuple_index(receive.1, index=0)
+  tuple_index.3: bits[32] = tuple_index(receive.1, index=1)
+  add.4: bits[32] = add(sum, tuple_index.3)
+  send.5: token = send(tuple_index.2, add.4, channel=out)
+  next (send.5, add.4)
+}
+)";
+
+EvaluateFunctionRequest AddRequest(int64_t x, int64_t y) {
+  EvaluateFunctionRequest request;
+  request.set_ir(kAddIr);
+  EvaluateFunctionRequest::ArgSet* arg_set = request.add_arg_sets();
+  *arg_set->add_args() = Value(UBits(x, 8)).AsProto().value();
+  *arg_set->add_args() = Value(UBits(y, 8)).AsProto().value();
+  return request;
+}
+
+TEST(EvalServerTest, FunctionStaysResident) {
+  EvalServer server;
+  XLS_ASSERT_OK_AND_ASSIGN(EvaluateFunctionResponse first,
+                           server.EvaluateFunction(AddRequest(1, 2)));
+  EXPECT_FALSE(first.cached());
+  ASSERT_EQ(first.results_size(), 1);
+  EXPECT_THAT(first.results(0),
+              EqualsProto(Value(UBits(3, 8)).AsProto().value()));
+
+  XLS_ASSERT_OK_AND_ASSIGN(EvaluateFunctionResponse second,
+                           server.EvaluateFunction(AddRequest(200, 100)));
+  EXPECT_TRUE(second.cached());
+  ASSERT_EQ(second.results_size(), 1);
+  EXPECT_THAT(second.results(0),
+              EqualsProto(Value(UBits(44, 8)).AsProto().value()));
+  EXPECT_EQ(server.cached_package_count(), 1);
+}
+
+TEST(EvalServerTest, EvictsLeastRecentlyUsed) {
+  EvalServer server(EvalServerOptions{.max_cached_packages = 1});
+  XLS_ASSERT_OK(server.EvaluateFunction(AddRequest(1, 2)));
+  EvaluateProcRequest proc_request;
+  proc_request.set_ir(kAccumulatorIr);
+  XLS_ASSERT_OK(server.EvaluateProc(proc_request));
+  EXPECT_EQ(server.cached_package_count(), 1);
+  XLS_ASSERT_OK_AND_ASSIGN(EvaluateFunctionResponse response,
+                           server.EvaluateFunction(AddRequest(1, 2)));
+  EXPECT_FALSE(response.cached());
+}
+
+TEST(EvalServerTest, ProcRestartsFromInitialState) {
+  EvalServer server;
+  EvaluateProcRequest request;
+  request.set_ir(kAccumulatorIr);
+  ProcChannelValuesProto::Channel* in =
+      request.mutable_inputs()->add_channels();
+  in->set_name("in");
+  *in->add_entry() = Value(UBits(1, 32)).AsProto().value();
+  *in->add_entry() = Value(UBits(2, 32)).AsProto().value();
+
+  ProcChannelValuesProto expected;
+  ProcChannelValuesProto::Channel* out = expected.add_channels();
+  out->set_name("out");
+  *out->add_entry() = Value(UBits(1, 32)).AsProto().value();
+  *out->add_entry() = Value(UBits(3, 32)).AsProto().value();
+
+  for (bool cached : {false, true}) {
+    XLS_ASSERT_OK_AND_ASSIGN(EvaluateProcResponse response,
+                             server.EvaluateProc(request));
+    EXPECT_EQ(response.cached(), cached);
+    EXPECT_THAT(response.outputs(), EqualsProto(expected));
+  }
+}
+
+TEST(EvalServerTest, RejectsBadRequests) {
+  EvalServer server;
+  EvaluateFunctionRequest request = AddRequest(1, 2);
+  request.mutable_arg_sets(0)->mutable_args()->RemoveLast();
+  EXPECT_THAT(server.EvaluateFunction(request),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("takes 2 arguments")));
+
+  EvaluateProcRequest proc_request;
+  proc_request.set_ir(kAccumulatorIr);
+  ProcChannelValuesProto::Channel* out =
+      proc_request.mutable_inputs()->add_channels();
+  out->set_name("out");
+  *out->add_entry() = Value(UBits(1, 32)).AsProto().value();
+  EXPECT_THAT(server.EvaluateProc(proc_request),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("receive-only")));
+}
+
+}  // namespace
+}  // namespace xls
@@ -0,0 +1,194 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/fifo_depth_optimizer.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/types/span.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/interpreter/channel_queue.h"
+#include "xls/interpreter/interpreter_proc_runtime.h"
+#include "xls/interpreter/proc_runtime_telemetry.h"
+#include "xls/interpreter/serial_proc_runtime.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/package.h"
+#include "xls/ir/proc_elaboration.h"
+#include "xls/ir/value.h"
+#include "xls/jit/jit_proc_runtime.h"
+
+namespace xls {
+namespace {
+
+bool IsInternalStreamingChannel(Channel* channel) {
+  return channel->kind() == ChannelKind::kStreaming &&
+         channel->supported_ops() == ChannelOps::kSendReceive;
+}
+
+}  // namespace
+
+absl::StatusOr<FifoSimulationResult> SimulateForFifoDepths(
+    Package* package, const ChannelWorkload& workload, int64_t max_ticks,
+    bool use_jit) {
+  std::unique_ptr<SerialProcRuntime> runtime;
+  if (use_jit) {
+    XLS_ASSIGN_OR_RETURN(runtime, CreateJitSerialProcRuntime(package));
+  } else {
+    XLS_ASSIGN_OR_RETURN(runtime, CreateInterpreterSerialProcRuntime(package));
+  }
+  ChannelQueueManager& queue_manager = runtime->queue_manager();
+  for (const auto& [channel_name, values] : workload) {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         queue_manager.GetQueueByName(channel_name));
+    XLS_RET_CHECK(!queue->channel_instance()->channel->CanSend())
+        << "Channel `" << channel_name << "` is not an input channel";
+    for (const Value& value : values) {
+      XLS_RETURN_IF_ERROR(queue->Write(value));
+    }
+  }
+
+  runtime->EnableTelemetry();
+  FifoSimulationResult result;
+  XLS_ASSIGN_OR_RETURN(result.tick_count, runtime->TickUntilBlocked(max_ticks));
+
+  const ProcRuntimeTelemetry* telemetry = runtime->telemetry();
+  for (ChannelInstance* instance :
+       queue_manager.elaboration().channel_instances()) {
+    Channel* channel = instance->channel;
+    if (IsInternalStreamingChannel(channel)) {
+      int64_t& max_occupancy = result.max_occupancies[channel->name()];
+      max_occupancy = std::max(
+          max_occupancy, telemetry->GetChannelStats(instance).max_occupancy);
+    } else if (channel->supported_ops() == ChannelOps::kSendOnly) {
+      std::vector<Value>& outputs = result.outputs[channel->name()];
+      ChannelQueue& queue = queue_manager.GetQueue(instance);
+      while (std::optional<Value> value = queue.Read()) {
+        outputs.push_back(*std::move(value));
+      }
+    }
+  }
+  return result;
+}
+
+absl::StatusOr<std::vector<FifoDepthRecommendation>> RecommendFifoDepths(
+    Package* package, absl::Span<const FifoSimulationResult> results) {
+  XLS_RET_CHECK(!results.empty()) << "No simulation results to analyze";
+  std::vector<FifoDepthRecommendation> recommendations;
+  for (Channel* channel : package->channels()) {
+    if (!IsInternalStreamingChannel(channel)) {
+      continue;
+    }
+    std::optional<int64_t> current_depth =
+        down_cast<StreamingChannel*>(channel)->GetFifoDepth();
+    if (!current_depth.has_value()) {
+      continue;
+    }
+    int64_t max_occupancy = 0;
+    for (const FifoSimulationResult& result : results) {
+      auto it = result.max_occupancies.find(channel->name());
+      XLS_RET_CHECK(it != result.max_occupancies.end())
+          << "Channel `" << channel->name() << "` was not simulated";
+      max_occupancy = std::max(max_occupancy, it->second);
+    }
+    recommendations.push_back(FifoDepthRecommendation{
+        .channel = std::string{channel->name()},
+        .current_depth = *current_depth,
+        .max_occupancy = max_occupancy,
+        .recommended_depth =
+            std::max(max_occupancy, std::min(*current_depth, int64_t{1})),
+    });
+  }
+  return recommendations;
+}
+
+absl::Status ApplyFifoDepths(
+    Package* package,
+    absl::Span<const FifoDepthRecommendation> recommendations) {
+  for (const FifoDepthRecommendation& recommendation : recommendations) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel,
+                         package->GetChannel(recommendation.channel));
+    XLS_RET_CHECK_EQ(channel->kind(), ChannelKind::kStreaming);
+    StreamingChannel* streaming_channel = down_cast<StreamingChannel*>(channel);
+    const ChannelConfig& config = streaming_channel->channel_config();
+    XLS_RET_CHECK(config.fifo_config().has_value())
+        << "Channel `" << channel->name() << "` has no FIFO";
+    const FifoConfig& fifo = *config.fifo_config();
+    streaming_channel->channel_config(config.WithFifoConfig(FifoConfig(
+        recommendation.recommended_depth, fifo.bypass(),
+        fifo.register_push_outputs(), fifo.register_pop_outputs())));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ValidateFifoDepths(Package* package,
+                                const ChannelWorkload& workload,
+                                const FifoSimulationResult& reference,
+                                int64_t max_ticks, bool use_jit) {
+  XLS_ASSIGN_OR_RETURN(
+      FifoSimulationResult result,
+      SimulateForFifoDepths(package, workload, max_ticks, use_jit));
+  for (const auto& [channel_name, outputs] : reference.outputs) {
+    auto it = result.outputs.find(channel_name);
+    if (it == result.outputs.end() || it->second != outputs) {
+      return absl::InternalError(absl::StrFormat(
+          "Outputs on channel `%s` changed after resizing FIFOs",
+          channel_name));
+    }
+  }
+  for (const auto& [channel_name, max_occupancy] : result.max_occupancies) {
+    XLS_ASSIGN_OR_RETURN(Channel * channel, package->GetChannel(channel_name));
+    std::optional<int64_t> depth =
+        down_cast<StreamingChannel*>(channel)->GetFifoDepth();
+    if (depth.has_value() && max_occupancy > *depth) {
+      return absl::FailedPreconditionError(absl::StrFormat(
+          "Channel `%s` held %d values but its FIFO has a depth of %d; the "
+          "hardware would stall on this workload",
+          channel_name, max_occupancy, *depth));
+    }
+  }
+  return absl::OkStatus();
+}
+
+std::string FifoDepthRecommendationsToString(
+    absl::Span<const FifoDepthRecommendation> recommendations) {
+  std::string result = absl::StrFormat("%-40s %8s %8s %8s\n", "channel",
+                                       "current", "observed", "minimal");
+  for (const FifoDepthRecommendation& recommendation : recommendations) {
+    absl::StrAppend(
+        &result,
+        absl::StrFormat("%-40s %8d %8d %8d%s\n", recommendation.channel,
+                        recommendation.current_depth,
+                        recommendation.max_occupancy,
+                        recommendation.recommended_depth,
+                        recommendation.recommended_depth >
+                                recommendation.current_depth
+                            ? " (undersized)"
+                            : ""));
+  }
+  return result;
+}
+
+}  // namespace xls
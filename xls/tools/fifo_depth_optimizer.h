@@ -0,0 +1,96 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef XLS_TOOLS_FIFO_DEPTH_OPTIMIZER_H_
+#define XLS_TOOLS_FIFO_DEPTH_OPTIMIZER_H_
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/btree_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+
+// Values to feed to each input channel of a proc network, by channel name.
+using ChannelWorkload = absl::btree_map<std::string, std::vector<Value>>;
+
+// The observable behavior of one simulation of a proc network.
+struct FifoSimulationResult {
+  // Largest occupancy at the end of a network tick of each internal streaming
+  // channel (a channel which is both sent and received within the network), by
+  // channel name.
+  absl::btree_map<std::string, int64_t> max_occupancies;
+  // Values produced on each output channel, by channel name.
+  absl::btree_map<std::string, std::vector<Value>> outputs;
+  // Number of network ticks until all procs were blocked.
+  int64_t tick_count = 0;
+};
+
+// Simulates the (old-style) proc network of `package` on `workload` until all
+// procs with IO are blocked, with channel telemetry enabled. Returns an error
+// if the network does not block within `max_ticks` ticks.
+absl::StatusOr<FifoSimulationResult> SimulateForFifoDepths(
+    Package* package, const ChannelWorkload& workload, int64_t max_ticks,
+    bool use_jit);
+
+struct FifoDepthRecommendation {
+  std::string channel;
+  // Depth currently configured on the channel.
+  int64_t current_depth;
+  // Largest end-of-tick occupancy observed across all simulations.
+  int64_t max_occupancy;
+  // Smallest depth which holds every value observed in flight. A FIFO which
+  // was never occupied at the end of a tick keeps at least a depth of one
+  // (unless it is already zero) because removing it entirely would turn the
+  // channel into a combinational path.
+  int64_t recommended_depth;
+};
+
+// Returns a recommendation for every internal streaming channel of `package`
+// which has a FIFO configuration, given the results of simulating it on
+// representative workloads. Recommendations larger than the current depth
+// indicate channels on which the hardware would apply backpressure (and
+// lose throughput) where the simulation did not.
+absl::StatusOr<std::vector<FifoDepthRecommendation>> RecommendFifoDepths(
+    Package* package, absl::Span<const FifoSimulationResult> results);
+
+// Sets the FIFO depth of each recommended channel to its recommended depth.
+absl::Status ApplyFifoDepths(
+    Package* package,
+    absl::Span<const FifoDepthRecommendation> recommendations);
+
+// Re-simulates `package`, whose FIFO depths have been changed, on `workload`
+// and checks that it produces the outputs of `reference` and never holds more
+// values in a FIFO than its configured depth. The proc runtimes do not apply
+// backpressure on full FIFOs, so the depth check is what establishes that the
+// hardware would not stall on the workload.
+absl::Status ValidateFifoDepths(Package* package,
+                                const ChannelWorkload& workload,
+                                const FifoSimulationResult& reference,
+                                int64_t max_ticks, bool use_jit);
+
+// Returns a human-readable table of the recommendations.
+std::string FifoDepthRecommendationsToString(
+    absl::Span<const FifoDepthRecommendation> recommendations);
+
+}  // namespace xls
+
+#endif  // XLS_TOOLS_FIFO_DEPTH_OPTIMIZER_H_
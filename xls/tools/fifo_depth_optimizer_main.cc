@@ -0,0 +1,155 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Recommends (and optionally applies) the minimal depth of every FIFO of a
+// proc network which holds all of the values the network keeps in flight on
+// the given workloads, by simulating the network with channel telemetry
+// enabled. Applied depths are validated by re-simulating the resized network.
+//
+// Example:
+//
+//   fifo_depth_optimizer_main --inputs_for_all_channels=in0.txt,in1.txt \
+//     --output_ir_path=resized.ir design.opt.ir
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/log/check.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "xls/common/exit_status.h"
+#include "xls/common/file/filesystem.h"
+#include "xls/common/init_xls.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/ir/ir_parser.h"
+#include "xls/ir/package.h"
+#include "xls/tools/eval_utils.h"
+#include "xls/tools/fifo_depth_optimizer.h"
+
+static constexpr std::string_view kUsage =
+    R"(Recommends minimal FIFO depths for a proc network from simulation.
+
+  fifo_depth_optimizer_main --inputs_for_all_channels=<files> <ir-path>
+)";
+
+ABSL_FLAG(std::vector<std::string>, inputs_for_all_channels, {},
+          "Comma-separated list of files, each holding one workload in the "
+          "format of eval_proc_main's --inputs_for_all_channels. The "
+          "recommended depths hold every value kept in flight on any of "
+          "them.");
+ABSL_FLAG(std::vector<std::string>, validation_inputs_for_all_channels, {},
+          "Comma-separated list of additional workloads on which the resized "
+          "network is validated. The profiling workloads are always "
+          "validated.");
+ABSL_FLAG(int64_t, max_ticks, 100000,
+          "Maximum number of network ticks to simulate each workload for "
+          "before all procs must be blocked.");
+ABSL_FLAG(std::string, backend, "serial_jit",
+          "Proc runtime to simulate with: \"serial_jit\" or "
+          "\"ir_interpreter\".");
+ABSL_FLAG(std::string, output_ir_path, "",
+          "If given, the FIFO depths are resized to the recommendations, "
+          "validated, and the resulting package is written to this path.");
+
+namespace xls {
+namespace {
+
+absl::StatusOr<std::vector<ChannelWorkload>> ParseWorkloads(
+    absl::Span<const std::string> paths) {
+  std::vector<ChannelWorkload> workloads;
+  for (const std::string& path : paths) {
+    XLS_ASSIGN_OR_RETURN(ChannelWorkload workload,
+                         ParseChannelValuesFromFile(path));
+    workloads.push_back(std::move(workload));
+  }
+  return workloads;
+}
+
+absl::Status RealMain(std::string_view ir_path) {
+  std::string backend = absl::GetFlag(FLAGS_backend);
+  if (backend != "serial_jit" && backend != "ir_interpreter") {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unsupported backend: ", backend));
+  }
+  bool use_jit = backend == "serial_jit";
+  int64_t max_ticks = absl::GetFlag(FLAGS_max_ticks);
+
+  XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Package> package,
+                       Parser::ParsePackage(ir_text, ir_path));
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<ChannelWorkload> workloads,
+      ParseWorkloads(absl::GetFlag(FLAGS_inputs_for_all_channels)));
+  if (workloads.empty()) {
+    return absl::InvalidArgumentError(
+        "--inputs_for_all_channels must name at least one workload");
+  }
+
+  std::vector<FifoSimulationResult> results;
+  for (const ChannelWorkload& workload : workloads) {
+    XLS_ASSIGN_OR_RETURN(FifoSimulationResult result,
+                         SimulateForFifoDepths(package.get(), workload,
+                                               max_ticks, use_jit));
+    results.push_back(std::move(result));
+  }
+  XLS_ASSIGN_OR_RETURN(std::vector<FifoDepthRecommendation> recommendations,
+                       RecommendFifoDepths(package.get(), results));
+  std::cout << FifoDepthRecommendationsToString(recommendations);
+
+  std::string output_ir_path = absl::GetFlag(FLAGS_output_ir_path);
+  if (output_ir_path.empty()) {
+    return absl::OkStatus();
+  }
+
+  // The validation workloads have no reference outputs of their own, so they
+  // are simulated on the original network before resizing.
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<ChannelWorkload> validation_workloads,
+      ParseWorkloads(absl::GetFlag(FLAGS_validation_inputs_for_all_channels)));
+  for (const ChannelWorkload& workload : validation_workloads) {
+    XLS_ASSIGN_OR_RETURN(FifoSimulationResult result,
+                         SimulateForFifoDepths(package.get(), workload,
+                                               max_ticks, use_jit));
+    workloads.push_back(workload);
+    results.push_back(std::move(result));
+  }
+
+  XLS_RETURN_IF_ERROR(ApplyFifoDepths(package.get(), recommendations));
+  for (int64_t i = 0; i < workloads.size(); ++i) {
+    XLS_RETURN_IF_ERROR(ValidateFifoDepths(package.get(), workloads[i],
+                                           results[i], max_ticks, use_jit));
+  }
+  LOG(INFO) << "Validated resized FIFOs on " << workloads.size()
+            << " workload(s)";
+  return SetFileContents(output_ir_path, package->DumpIr());
+}
+
+}  // namespace
+}  // namespace xls
+
+int main(int argc, char** argv) {
+  std::vector<std::string_view> positional_arguments =
+      xls::InitXls(kUsage, argc, argv);
+  QCHECK_EQ(positional_arguments.size(), 1)
+      << "Expected a single IR file argument.";
+  return xls::ExitStatus(xls::RealMain(positional_arguments[0]));
+}
@@ -0,0 +1,143 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "xls/tools/fifo_depth_optimizer.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "xls/common/casts.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/bits.h"
+#include "xls/ir/channel.h"
+#include "xls/ir/channel_ops.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/value.h"
+
+namespace xls {
+namespace {
+
+using ::absl_testing::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+class FifoDepthOptimizerTest : public IrTestBase {
+ protected:
+  // Builds a producer which forwards `in` onto an internal FIFO and a consumer
+  // which drains it into `out` only every other tick, so values pile up in
+  // the FIFO while the producer has inputs.
+  void BuildNetwork(Package* p, int64_t depth) {
+    Type* u32 = p->GetBitsType(32);
+    Channel* in =
+        p->CreateStreamingChannel("in", ChannelOps::kReceiveOnly, u32).value();
+    Channel* out =
+        p->CreateStreamingChannel("out", ChannelOps::kSendOnly, u32).value();
+    Channel* fifo =
+        p->CreateStreamingChannel(
+             "fifo", ChannelOps::kSendReceive, u32, /*initial_values=*/{},
+             ChannelConfig(FifoConfig(depth, /*bypass=*/false,
+                                      /*register_push_outputs=*/false,
+                                      /*register_pop_outputs=*/false)))
+            .value();
+
+    TokenlessProcBuilder producer("producer", "tkn", p);
+    producer.Send(fifo, producer.Receive(in));
+    XLS_ASSERT_OK(producer.Build().status());
+
+    TokenlessProcBuilder consumer("consumer", "tkn", p);
+    BValue phase = consumer.StateElement("phase", Value(UBits(0, 1)));
+    BValue value = consumer.ReceiveIf(fifo, phase);
+    consumer.SendIf(out, phase, value);
+    consumer.Next(phase, consumer.Not(phase));
+    XLS_ASSERT_OK(consumer.Build().status());
+  }
+
+  ChannelWorkload Workload(int64_t count) {
+    std::vector<Value> values;
+    for (int64_t i = 0; i < count; ++i) {
+      values.push_back(Value(UBits(i, 32)));
+    }
+    return ChannelWorkload{{"in", values}};
+  }
+};
+
+TEST_F(FifoDepthOptimizerTest, RecommendsAndAppliesObservedDepth) {
+  auto p = CreatePackage();
+  BuildNetwork(p.get(), /*depth=*/16);
+
+  XLS_ASSERT_OK_AND_ASSIGN(
+      FifoSimulationResult result,
+      SimulateForFifoDepths(p.get(), Workload(6), /*max_ticks=*/100,
+                            /*use_jit=*/false));
+  EXPECT_EQ(result.outputs.at("out").size(), 6);
+  int64_t max_occupancy = result.max_occupancies.at("fifo");
+  EXPECT_GT(max_occupancy, 1);
+  EXPECT_LT(max_occupancy, 16);
+
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<FifoDepthRecommendation> recommendations,
+                           RecommendFifoDepths(p.get(), {result}));
+  ASSERT_EQ(recommendations.size(), 1);
+  EXPECT_EQ(recommendations[0].channel, "fifo");
+  EXPECT_EQ(recommendations[0].current_depth, 16);
+  EXPECT_EQ(recommendations[0].recommended_depth, max_occupancy);
+
+  XLS_ASSERT_OK(ApplyFifoDepths(p.get(), recommendations));
+  XLS_ASSERT_OK_AND_ASSIGN(Channel * fifo, p->GetChannel("fifo"));
+  EXPECT_EQ(down_cast<StreamingChannel*>(fifo)->GetFifoDepth(), max_occupancy);
+  XLS_EXPECT_OK(ValidateFifoDepths(p.get(), Workload(6), result,
+                                   /*max_ticks=*/100, /*use_jit=*/false));
+}
+
+TEST_F(FifoDepthOptimizerTest, ValidationDetectsUndersizedFifo) {
+  auto p = CreatePackage();
+  BuildNetwork(p.get(), /*depth=*/16);
+  XLS_ASSERT_OK_AND_ASSIGN(
+      FifoSimulationResult short_result,
+      SimulateForFifoDepths(p.get(), Workload(2), /*max_ticks=*/100,
+                            /*use_jit=*/false));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      FifoSimulationResult long_result,
+      SimulateForFifoDepths(p.get(), Workload(8), /*max_ticks=*/100,
+                            /*use_jit=*/false));
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<FifoDepthRecommendation> recommendations,
+                           RecommendFifoDepths(p.get(), {short_result}));
+  XLS_ASSERT_OK(ApplyFifoDepths(p.get(), recommendations));
+
+  EXPECT_THAT(ValidateFifoDepths(p.get(), Workload(8), long_result,
+                                 /*max_ticks=*/100, /*use_jit=*/false),
+              StatusIs(absl::StatusCode::kFailedPrecondition,
+                       HasSubstr("would stall")));
+}
+
+TEST_F(FifoDepthOptimizerTest, KeepsUnoccupiedFifoRegistered) {
+  auto p = CreatePackage();
+  BuildNetwork(p.get(), /*depth=*/4);
+  FifoSimulationResult result;
+  result.max_occupancies["fifo"] = 0;
+  XLS_ASSERT_OK_AND_ASSIGN(std::vector<FifoDepthRecommendation> recommendations,
+                           RecommendFifoDepths(p.get(), {result}));
+  ASSERT_EQ(recommendations.size(), 1);
+  EXPECT_EQ(recommendations[0].recommended_depth, 1);
+  EXPECT_THAT(FifoDepthRecommendationsToString(recommendations),
+              HasSubstr("fifo"));
+}
+
+}  // namespace
+}  // namespace xls
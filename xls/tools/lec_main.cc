@@ -30,7 +30,10 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "xls/common/exit_status.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/get_runfile_path.h"
@@ -38,6 +41,7 @@
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/common/subprocess.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/function.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/nodes.h"
@@ -53,6 +57,7 @@
 #include "xls/scheduling/pipeline_schedule.h"
 #include "xls/scheduling/pipeline_schedule.pb.h"
 #include "xls/solvers/z3_lec.h"
+#include "xls/solvers/z3_portfolio.h"
 #include "z3/src/api/z3_api.h"
 
 ABSL_FLAG(std::string, cell_lib_path, "",
@@ -93,9 +98,22 @@ ABSL_FLAG(std::string, schedule_path, "",
           "impossible.");
 ABSL_FLAG(int32_t, timeout_sec, -1,
           "Amount of time to allow for a LEC operation.");
+ABSL_FLAG(bool, portfolio, false,
+          "If true, races several solver strategies (bit-blasting plus SAT, "
+          "the default SMT solver, and a per-output-bit decomposition) in "
+          "parallel threads, takes the first definitive answer, and prints how "
+          "each strategy fared. Not supported with --auto_stage.");
 ABSL_FLAG(bool, auto_stage, false,
           "If true, then the tool will determine on its own whether to perform "
           "staged or full LEC. This requires that a schedule be specified.");
+ABSL_FLAG(bool, logic_clouds, false,
+          "If true, checks every flop-bounded logic cloud of the netlist "
+          "against its part of the pipeline stage it belongs to as an "
+          "independent problem, and proves the clouds in parallel. Requires "
+          "--schedule_path.");
+ABSL_FLAG(int64_t, num_threads, 0,
+          "Number of threads to prove logic clouds on with --logic_clouds. If "
+          "zero, one per available CPU.");
 ABSL_FLAG(int32_t, stage, -1,
           "Pipeline stage to evaluate. Requires --schedule.\n"
           "If \"schedule\" is set, but this is not, then the entire module "
@@ -231,6 +249,35 @@ absl::Status AutoStage(const solvers::z3::LecParams& lec_params,
   return absl::OkStatus();
 }
 
+absl::Status LogicCloudLec(const solvers::z3::LecParams& lec_params,
+                           const PipelineSchedule& schedule,
+                           int64_t num_threads) {
+  ThreadPool thread_pool(num_threads);
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<solvers::z3::LogicCloudLecResult> results,
+      solvers::z3::RunLogicCloudLec(lec_params, schedule, thread_pool));
+  int64_t failures = 0;
+  for (const solvers::z3::LogicCloudLecResult& result : results) {
+    std::cout << "Stage " << result.stage << " cloud ("
+              << absl::StrJoin(result.terminating_flops, ", ") << ")...";
+    if (!result.equivalent.ok()) {
+      std::cout << "NOT CHECKED: " << result.equivalent.status() << '\n';
+      ++failures;
+    } else if (*result.equivalent) {
+      std::cout << "PASSED!\n";
+    } else {
+      std::cout << "FAILED!\n" << result.result << '\n';
+      ++failures;
+    }
+  }
+  if (failures > 0) {
+    return absl::InternalError(absl::StrCat(failures, " of ", results.size(),
+                                            " logic clouds were not proven "
+                                            "equivalent."));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 static absl::Status RealMain(
@@ -238,7 +285,8 @@ static absl::Status RealMain(
     std::string_view netlist_module_name, std::string_view cell_lib_path,
     std::string_view cell_proto_path, std::string_view netlist_path,
     std::string_view constraints_file, std::string_view schedule_path,
-    int stage, bool auto_stage, int timeout_sec) {
+    int stage, bool auto_stage, int timeout_sec, bool portfolio,
+    bool logic_clouds, int64_t num_threads) {
   solvers::z3::LecParams lec_params;
   XLS_ASSIGN_OR_RETURN(std::string ir_text, GetFileContents(ir_path));
   XLS_ASSIGN_OR_RETURN(auto package, Parser::ParsePackage(ir_text));
@@ -268,6 +316,9 @@ static absl::Status RealMain(
     if (auto_stage) {
       return AutoStage(lec_params, schedule, timeout_sec);
     }
+    if (logic_clouds) {
+      return LogicCloudLec(lec_params, schedule, num_threads);
+    }
     XLS_ASSIGN_OR_RETURN(
         lec, solvers::z3::Lec::CreateForStage(lec_params, schedule, stage));
   } else {
@@ -292,6 +343,23 @@ static absl::Status RealMain(
     XLS_RETURN_IF_ERROR(lec->AddConstraints(function));
   }
 
+  if (portfolio) {
+    absl::StatusOr<bool> equal = lec->RunPortfolio(
+        timeout_sec == -1 ? absl::InfiniteDuration()
+                          : absl::Seconds(timeout_sec));
+    for (const solvers::z3::PortfolioStrategyResult& result :
+         lec->portfolio_results()) {
+      std::cout << "Portfolio strategy " << result.ToString() << '\n';
+    }
+    XLS_RETURN_IF_ERROR(equal.status());
+    std::cout << lec->ResultToString() << '\n';
+    if (!*equal) {
+      std::cout << '\n' << "IR/netlist value dump:" << '\n';
+      lec->DumpIrTree();
+    }
+    return absl::OkStatus();
+  }
+
   struct sigaction old_action;
   if (timeout_sec != -1) {
     old_action = SetAlarm(timeout_sec);
@@ -343,9 +411,21 @@ int main(int argc, char* argv[]) {
   QCHECK(!(auto_stage && schedule_path.empty()))
       << "--schedule_path must be specified with --auto_stage.";
 
+  bool portfolio = absl::GetFlag(FLAGS_portfolio);
+  QCHECK(!(auto_stage && portfolio))
+      << "Only one of --portfolio or --auto_stage may be specified.";
+
+  bool logic_clouds = absl::GetFlag(FLAGS_logic_clouds);
+  QCHECK(!logic_clouds || !schedule_path.empty())
+      << "--schedule_path must be specified with --logic_clouds.";
+  QCHECK(!logic_clouds || (stage == -1 && !auto_stage && !portfolio))
+      << "--logic_clouds may not be combined with --stage, --auto_stage, or "
+         "--portfolio.";
+
   return xls::ExitStatus(xls::RealMain(
       ir_path, absl::GetFlag(FLAGS_entry_function_name),
       absl::GetFlag(FLAGS_netlist_module_name), cell_lib_path, cell_proto_path,
       netlist_path, absl::GetFlag(FLAGS_constraints_file), schedule_path, stage,
-      auto_stage, absl::GetFlag(FLAGS_timeout_sec)));
+      auto_stage, absl::GetFlag(FLAGS_timeout_sec), portfolio, logic_clouds,
+      absl::GetFlag(FLAGS_num_threads)));
 }
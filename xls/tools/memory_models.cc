@@ -14,11 +14,15 @@
 
 #include "xls/tools/memory_models.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -26,7 +30,9 @@
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/types/span.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
 #include "xls/interpreter/channel_queue.h"
@@ -34,6 +40,9 @@
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
 #include "xls/ir/value_utils.h"
+#include "xls/jit/jit_channel_queue.h"
+#include "xls/jit/jit_runtime.h"
+#include "xls/jit/type_layout.h"
 
 namespace xls {
 
@@ -207,8 +216,231 @@ class RewrittenProcMemoryModel : public ProcMemoryModel {
   ChannelQueue* write_completion_channel_;
 };
 
+// Like RewrittenProcMemoryModel, but operating on the native layout of the JIT.
+// Each word is stored as a complete response (a one-element tuple) so reads
+// write the stored bytes to the response queue directly. Requests are serviced
+// in order; with banking a request to a bank which already serviced a request
+// this tick stalls itself and all later requests until the next tick.
+class NativeRewrittenProcMemoryModel : public ProcMemoryModel {
+ public:
+  NativeRewrittenProcMemoryModel(const std::string& name, int64_t size,
+                                 int64_t latency, int64_t bank_count,
+                                 JitChannelQueue* request_channel,
+                                 JitChannelQueue* response_channel,
+                                 JitChannelQueue* write_completion_channel,
+                                 JitRuntime& runtime)
+      : name_(name),
+        size_(size),
+        latency_(latency),
+        bank_count_(bank_count),
+        request_layout_(runtime.CreateTypeLayout(
+            request_channel->channel()->type())),
+        response_layout_(runtime.CreateTypeLayout(
+            response_channel->channel()->type())),
+        completion_layout_(runtime.CreateTypeLayout(
+            write_completion_channel->channel()->type())),
+        request_channel_(request_channel),
+        response_channel_(response_channel),
+        write_completion_channel_(write_completion_channel),
+        bank_busy_tick_(bank_count, -1) {
+    Type* request_type = request_channel_->channel()->type();
+    CHECK(request_type->IsTuple());
+    CHECK_EQ(request_type->AsTupleOrDie()->size(), 6);
+    Type* response_type = response_channel_->channel()->type();
+    CHECK(response_type->IsTuple());
+    CHECK_EQ(response_type->AsTupleOrDie()->size(), 1);
+
+    // Leaves of the request are (addr, data..., write_mask..., read_mask...,
+    // we, re), where data has the same leaves as the stored response.
+    absl::Span<const ElementLayout> request_leaves = request_layout_.elements();
+    data_leaf_count_ = response_layout_.elements().size();
+    CHECK_GE(request_leaves.size(), data_leaf_count_ + 3);
+    CHECK_LE(request_leaves[0].data_size, sizeof(uint64_t));
+    for (int64_t i = 0; i < data_leaf_count_; ++i) {
+      CHECK_EQ(request_leaves[1 + i].data_size,
+               response_layout_.elements()[i].data_size);
+    }
+    we_leaf_ = request_leaves.size() - 2;
+    re_leaf_ = request_leaves.size() - 1;
+
+    // Blit the initial word once and replicate it; padding stays zeroed.
+    storage_.resize(size * response_layout_.size());
+    response_layout_.ValueToNativeLayout(
+        Value::Tuple({AllOnesOfType(
+            response_type->AsTupleOrDie()->element_type(0))}),
+        storage_.data());
+    for (int64_t addr = 1; addr < size; ++addr) {
+      std::memcpy(Word(addr), storage_.data(), response_layout_.size());
+    }
+    completion_buffer_.resize(std::max<int64_t>(completion_layout_.size(), 1));
+    completion_layout_.ValueToNativeLayout(Value::Tuple({}),
+                                           completion_buffer_.data());
+  }
+
+  absl::Status Tick() override {
+    ++tick_;
+    DeliverDueResponses();
+
+    struct Request {
+      // Offset of the raw request in `requests_`.
+      int64_t offset;
+      int64_t addr;
+      bool read;
+      bool write;
+    };
+    std::vector<Request> requests;
+    const int64_t request_size = request_layout_.size();
+    while (true) {
+      int64_t offset = requests.size() * request_size;
+      if (requests_.size() < offset + request_size) {
+        requests_.resize(offset + request_size);
+      }
+      uint8_t* raw = requests_.data() + offset;
+      if (stalled_request_.has_value()) {
+        std::memcpy(raw, stalled_request_->data(), request_size);
+        stalled_request_.reset();
+      } else if (!request_channel_->ReadRaw(raw)) {
+        break;
+      }
+
+      Request request{.offset = offset,
+                      .addr = static_cast<int64_t>(LeafAsUint64(raw, 0)),
+                      .read = LeafAsUint64(raw, re_leaf_) != 0,
+                      .write = LeafAsUint64(raw, we_leaf_) != 0};
+      if (request.read || request.write) {
+        if (request.addr < 0 || request.addr >= size_) {
+          return absl::InvalidArgumentError(absl::StrFormat(
+              "Request address %d to memory %s out of range [0, %li)",
+              request.addr, name_, size_));
+        }
+      }
+      XLS_RET_CHECK(!(request.read && request.write));
+
+      if (bank_count_ > 0 && (request.read || request.write)) {
+        int64_t& busy_tick = bank_busy_tick_[request.addr % bank_count_];
+        if (busy_tick == tick_) {
+          stalled_request_.emplace(raw, raw + request_size);
+          break;
+        }
+        busy_tick = tick_;
+      }
+      requests.push_back(request);
+    }
+
+    // Reads first
+    for (const Request& request : requests) {
+      if (!request.read) {
+        continue;
+      }
+      const uint8_t* word = Word(request.addr);
+      if (latency_ == 0) {
+        response_channel_->WriteRaw(word);
+      } else {
+        pending_reads_.push_back(PendingRead{
+            .due_tick = tick_ + latency_,
+            .response = std::vector<uint8_t>(
+                word, word + response_layout_.size())});
+      }
+    }
+    // Then writes
+    for (const Request& request : requests) {
+      if (!request.write) {
+        continue;
+      }
+      const uint8_t* raw = requests_.data() + request.offset;
+      uint8_t* word = Word(request.addr);
+      for (int64_t i = 0; i < data_leaf_count_; ++i) {
+        const ElementLayout& to = response_layout_.elements()[i];
+        std::memcpy(word + to.offset,
+                    raw + request_layout_.elements()[1 + i].offset,
+                    to.data_size);
+      }
+      if (latency_ == 0) {
+        write_completion_channel_->WriteRaw(completion_buffer_.data());
+      } else {
+        pending_write_completions_.push_back(tick_ + latency_);
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  struct PendingRead {
+    int64_t due_tick;
+    std::vector<uint8_t> response;
+  };
+
+  uint8_t* Word(int64_t addr) {
+    return storage_.data() + addr * response_layout_.size();
+  }
+
+  // Returns the (at most 64-bit) leaf `leaf` of the raw request `raw`.
+  uint64_t LeafAsUint64(const uint8_t* raw, int64_t leaf) const {
+    const ElementLayout& element = request_layout_.elements()[leaf];
+    uint64_t result = 0;
+    std::memcpy(&result, raw + element.offset,
+                std::min<int64_t>(element.data_size, sizeof(result)));
+    return result;
+  }
+
+  void DeliverDueResponses() {
+    while (!pending_reads_.empty() &&
+           pending_reads_.front().due_tick <= tick_) {
+      response_channel_->WriteRaw(pending_reads_.front().response.data());
+      pending_reads_.pop_front();
+    }
+    while (!pending_write_completions_.empty() &&
+           pending_write_completions_.front() <= tick_) {
+      write_completion_channel_->WriteRaw(completion_buffer_.data());
+      pending_write_completions_.pop_front();
+    }
+  }
+
+  std::string name_;
+  int64_t size_;
+  int64_t latency_;
+  int64_t bank_count_;
+
+  TypeLayout request_layout_;
+  TypeLayout response_layout_;
+  TypeLayout completion_layout_;
+  int64_t data_leaf_count_;
+  int64_t we_leaf_;
+  int64_t re_leaf_;
+
+  JitChannelQueue* request_channel_;
+  JitChannelQueue* response_channel_;
+  JitChannelQueue* write_completion_channel_;
+
+  // `size_` words, each in the native layout of the response type.
+  std::vector<uint8_t> storage_;
+  std::vector<uint8_t> completion_buffer_;
+  // Scratch space for the raw requests serviced in a tick.
+  std::vector<uint8_t> requests_;
+
+  int64_t tick_ = 0;
+  // Tick in which each bank last serviced a request.
+  std::vector<int64_t> bank_busy_tick_;
+  // Request held back by a bank conflict, serviced first in the next tick.
+  std::optional<std::vector<uint8_t>> stalled_request_;
+  std::deque<PendingRead> pending_reads_;
+  std::deque<int64_t> pending_write_completions_;
+};
+
+// The Value-based models service every request immediately.
+static absl::Status CheckNoTimingConfig(const RamRewriteProto& ram_rewrite) {
+  if (ram_rewrite.to_config().has_latency() ||
+      ram_rewrite.to_config().has_bank_count()) {
+    return absl::UnimplementedError(absl::StrFormat(
+        "RAM latency and banking of %s are only modeled with the JIT",
+        ram_rewrite.to_name_prefix()));
+  }
+  return absl::OkStatus();
+}
+
 absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
     const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager) {
+  XLS_RETURN_IF_ERROR(CheckNoTimingConfig(ram_rewrite));
   ChannelQueue* read_request_queue = nullptr;
   ChannelQueue* read_response_queue = nullptr;
   ChannelQueue* write_request_queue = nullptr;
@@ -266,6 +498,7 @@ absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
 
 absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateRewrittenProcMemoryModel(
     const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager) {
+  XLS_RETURN_IF_ERROR(CheckNoTimingConfig(ram_rewrite));
   XLS_ASSIGN_OR_RETURN(
       ChannelQueue * request_queue,
       queue_manager.GetQueueByName(ram_rewrite.to_name_prefix() + "_req"));
@@ -300,6 +533,48 @@ absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateRewrittenProcMemoryModel(
   return std::move(memory_model);
 }
 
+absl::StatusOr<std::unique_ptr<ProcMemoryModel>>
+CreateNativeRewrittenProcMemoryModel(const RamRewriteProto& ram_rewrite,
+                                     JitChannelQueueManager& queue_manager) {
+  auto get_jit_queue =
+      [&](std::string_view suffix) -> absl::StatusOr<JitChannelQueue*> {
+    XLS_ASSIGN_OR_RETURN(ChannelQueue * queue,
+                         queue_manager.GetQueueByName(absl::StrCat(
+                             ram_rewrite.to_name_prefix(), suffix)));
+    auto* jit_queue = dynamic_cast<JitChannelQueue*>(queue);
+    if (jit_queue == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrFormat("No %s channel found for RAM rewrite %s", suffix,
+                          ram_rewrite.to_name_prefix()));
+    }
+    return jit_queue;
+  };
+  XLS_ASSIGN_OR_RETURN(JitChannelQueue * request_queue, get_jit_queue("_req"));
+  XLS_ASSIGN_OR_RETURN(JitChannelQueue * response_queue,
+                       get_jit_queue("_resp"));
+  XLS_ASSIGN_OR_RETURN(JitChannelQueue * write_completion_queue,
+                       get_jit_queue("_write_completion"));
+
+  const RamConfigProto& config = ram_rewrite.to_config();
+  if (config.latency() < 0 || config.bank_count() < 0) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Negative latency or bank count for RAM rewrite %s",
+        ram_rewrite.to_name_prefix()));
+  }
+  Type* request_type = request_queue->channel()->type();
+  XLS_RET_CHECK(request_type->IsTuple() &&
+                request_type->AsTupleOrDie()->size() == 6)
+      << request_type->ToString();
+  XLS_RET_CHECK_LE(
+      request_type->AsTupleOrDie()->element_type(0)->GetFlatBitCount(), 64);
+
+  return std::make_unique<NativeRewrittenProcMemoryModel>(
+      ram_rewrite.to_name_prefix(),
+      /*size=*/ram_rewrite.from_config().depth(), config.latency(),
+      config.bank_count(), request_queue, response_queue,
+      write_completion_queue, queue_manager.runtime());
+}
+
 // TODO: Implement in XLS using XLS IR (DSLX/C++ source) google/xls#1638
 // Possibly replace with ram.x, which also implements different
 // simultaneous read/write behaviors.
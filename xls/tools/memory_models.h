@@ -29,6 +29,7 @@
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/ir/type.h"
 #include "xls/ir/value.h"
+#include "xls/jit/jit_channel_queue.h"
 
 namespace xls {
 
@@ -50,6 +51,16 @@ absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateAbstractProcMemoryModel(
 absl::StatusOr<std::unique_ptr<ProcMemoryModel>> CreateRewrittenProcMemoryModel(
     const RamRewriteProto& ram_rewrite, ChannelQueueManager& queue_manager);
 
+// Creates a model of a RAM rewritten to RAM_1RW like
+// CreateRewrittenProcMemoryModel, which instead stores its words in a flat
+// byte array in the native layout of the JIT and exchanges raw buffers with the
+// JIT channel queues, so servicing requests never converts to or from Values.
+// Unlike the Value-based models it honors the `latency` and `bank_count`
+// fields of the RAM config.
+absl::StatusOr<std::unique_ptr<ProcMemoryModel>>
+CreateNativeRewrittenProcMemoryModel(const RamRewriteProto& ram_rewrite,
+                                     JitChannelQueueManager& queue_manager);
+
 class BlockMemoryModel {
  public:
   BlockMemoryModel(const std::string& name, size_t size,
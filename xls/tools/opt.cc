@@ -14,34 +14,156 @@
 
 #include "xls/tools/opt.h"
 
+#include <cstdint>
 #include <filesystem>  // NOLINT
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
 #include "absl/types/span.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/file/filesystem.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/common/visitor.h"
+#include "xls/ir/binary_package.h"
 #include "xls/ir/function_base.h"
 #include "xls/ir/ir_parser.h"
 #include "xls/ir/package.h"
 #include "xls/ir/verifier.h"
+#include "xls/passes/function_optimization_cache.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_base.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
+#include "xls/passes/query_engine_cache.h"
 #include "xls/passes/verifier_checker.h"
+#include "xls/tools/opt_checkpoint.pb.h"
 
 namespace xls::tools {
+namespace {
+
+// Writes the IR of `package` and its position in the pipeline to
+// `checkpoint_dir`.
+absl::Status WriteOptCheckpoint(Package* package,
+                                const std::filesystem::path& checkpoint_dir,
+                                OptCheckpointProto checkpoint) {
+  std::string stem =
+      absl::StrFormat("%s.checkpoint.%d.%s", package->name(),
+                      checkpoint.completed_pass_groups(),
+                      checkpoint.last_pass_group());
+  absl::StatusOr<std::string> ir = SerializePackageToBinary(package);
+  if (absl::IsUnimplemented(ir.status())) {
+    // Constructs the binary format can't represent (e.g. new-style procs) are
+    // checkpointed as textual IR instead; both are read by ReadPackageFile.
+    ir = package->DumpIr();
+  }
+  XLS_RETURN_IF_ERROR(ir.status());
+  checkpoint.set_ir_file(absl::StrCat(stem, ".ir"));
+  XLS_RETURN_IF_ERROR(
+      SetFileContents(checkpoint_dir / checkpoint.ir_file(), *ir));
+  std::filesystem::path path =
+      checkpoint_dir / absl::StrCat(stem, ".textproto");
+  XLS_RETURN_IF_ERROR(SetTextProtoFile(path, checkpoint));
+  LOG(INFO) << "Wrote opt checkpoint: " << path;
+  return absl::OkStatus();
+}
+
+// Runs the standard pipeline one top-level group at a time, starting after the
+// checkpoint to resume from (if any) and writing a checkpoint after each group
+// (if requested).
+absl::Status RunCheckpointedPipeline(Package* package,
+                                     const OptOptions& options,
+                                     OptimizationPassOptions pass_options,
+                                     PassResults* results) {
+  std::vector<std::unique_ptr<OptimizationCompoundPass>> groups =
+      CreateOptimizationPassPipelineGroups();
+  int64_t first_group = 0;
+  int64_t prior_invocations = 0;
+  if (options.resume_from.has_value()) {
+    const OptCheckpointProto& checkpoint = *options.resume_from;
+    if (checkpoint.completed_pass_groups() < 0 ||
+        checkpoint.completed_pass_groups() >
+            static_cast<int64_t>(groups.size())) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Checkpoint completed %d pass groups but the pipeline has %d.",
+          checkpoint.completed_pass_groups(), groups.size()));
+    }
+    if (checkpoint.opt_level() != options.opt_level) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Checkpoint was taken at opt level %d; cannot resume at opt level "
+          "%d.",
+          checkpoint.opt_level(), options.opt_level));
+    }
+    first_group = checkpoint.completed_pass_groups();
+    prior_invocations = checkpoint.pass_invocations();
+    if (pass_options.bisect_limit.has_value()) {
+      if (*pass_options.bisect_limit < prior_invocations) {
+        return absl::InvalidArgumentError(absl::StrFormat(
+            "Bisect limit %d is before the checkpoint, which was taken after "
+            "%d passes.",
+            *pass_options.bisect_limit, prior_invocations));
+      }
+      *pass_options.bisect_limit -= prior_invocations;
+    }
+  }
+  if (!options.checkpoint_dir.empty()) {
+    XLS_RETURN_IF_ERROR(RecursivelyCreateDir(options.checkpoint_dir));
+  }
+
+  for (int64_t i = first_group; i < groups.size(); ++i) {
+    std::string group_name(groups[i]->short_name());
+    OptimizationCompoundPass stage("ir", "Top level pass pipeline");
+    stage.AddInvariantChecker<VerifierChecker>();
+    stage.AddOwned(std::move(groups[i]));
+    XLS_RETURN_IF_ERROR(stage.Run(package, pass_options, results).status());
+
+    if (options.checkpoint_dir.empty()) {
+      continue;
+    }
+    if (pass_options.bisect_limit.has_value() &&
+        results->invocations.size() >= *pass_options.bisect_limit) {
+      // Later passes were cut short, so the IR no longer corresponds to a
+      // position in the full pipeline.
+      LOG(INFO) << "Bisect limit reached; not writing further checkpoints.";
+      break;
+    }
+    OptCheckpointProto checkpoint;
+    checkpoint.set_completed_pass_groups(i + 1);
+    checkpoint.set_last_pass_group(group_name);
+    checkpoint.set_pass_invocations(prior_invocations +
+                                    results->invocations.size());
+    checkpoint.set_opt_level(options.opt_level);
+    XLS_RETURN_IF_ERROR(
+        WriteOptCheckpoint(package, options.checkpoint_dir, checkpoint));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::StatusOr<OptCheckpoint> ReadOptCheckpoint(
+    const std::filesystem::path& path, ThreadPool* thread_pool) {
+  XLS_ASSIGN_OR_RETURN(OptCheckpointProto checkpoint,
+                       ParseTextProtoFile<OptCheckpointProto>(path));
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Package> package,
+      ReadPackageFile(path.parent_path() / checkpoint.ir_file(), thread_pool));
+  return OptCheckpoint{.package = std::move(package),
+                       .checkpoint = std::move(checkpoint)};
+}
 
 absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   if (!options.top.empty()) {
@@ -61,6 +183,15 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   }
   VLOG(3) << "Top entity: '" << top.value()->name() << "'";
 
+  bool checkpointed =
+      !options.checkpoint_dir.empty() || options.resume_from.has_value();
+  if (checkpointed &&
+      !std::holds_alternative<std::nullopt_t>(options.pass_pipeline)) {
+    return absl::InvalidArgumentError(
+        "Checkpointing and resuming are only supported for the standard "
+        "pipeline.");
+  }
+
   using PipelineResult = absl::StatusOr<std::unique_ptr<OptimizationPass>>;
   XLS_ASSIGN_OR_RETURN(
       std::unique_ptr<OptimizationPass> pipeline,
@@ -96,6 +227,8 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
   pass_options.ir_dump_path = options.ir_dump_path;
   pass_options.skip_passes = options.skip_passes;
   pass_options.inline_procs = options.inline_procs;
+  pass_options.max_proc_inlining_cluster_size =
+      options.max_proc_inlining_cluster_size;
   pass_options.convert_array_index_to_select =
       options.convert_array_index_to_select;
   pass_options.split_next_value_selects = options.split_next_value_selects;
@@ -106,10 +239,31 @@ absl::Status OptimizeIrForTop(Package* package, const OptOptions& options) {
       options.optimize_for_best_case_throughput;
   pass_options.bisect_limit = options.bisect_limit;
   pass_options.record_metrics = options.metrics != nullptr;
+  pass_options.pass_time_budgets = options.pass_time_budgets;
+  pass_options.deadline = absl::Now() + options.time_budget;
+  pass_options.function_optimization_cache =
+      options.function_optimization_cache != nullptr
+          ? options.function_optimization_cache
+          : ContentAddressedDirectoryCache::GetDefault(
+                kFunctionOptimizationCacheOptions);
+  std::unique_ptr<ThreadPool> function_base_thread_pool;
+  if (options.function_base_threads > 1) {
+    function_base_thread_pool =
+        std::make_unique<ThreadPool>(options.function_base_threads);
+    pass_options.function_base_thread_pool = function_base_thread_pool.get();
+  }
+  QueryEngineCache query_engine_cache;
+  pass_options.query_engine_cache = &query_engine_cache;
   PassResults results;
-  XLS_RETURN_IF_ERROR(pipeline->Run(package, pass_options, &results).status());
+  if (checkpointed) {
+    XLS_RETURN_IF_ERROR(
+        RunCheckpointedPipeline(package, options, pass_options, &results));
+  } else {
+    XLS_RETURN_IF_ERROR(
+        pipeline->Run(package, pass_options, &results).status());
+  }
   if (options.metrics) {
-    *options.metrics = results.aggregate_results.ToProto();
+    *options.metrics = results.ToProto();
   }
   return absl::OkStatus();
 }
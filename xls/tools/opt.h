@@ -18,18 +18,26 @@
 #define XLS_TOOLS_OPT_H_
 
 #include <cstdint>
+#include <filesystem>  // NOLINT
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "xls/common/file/content_addressed_directory_cache.h"
+#include "xls/common/thread_pool.h"
 #include "xls/ir/package.h"
+#include "xls/passes/function_optimization_cache.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
+#include "xls/tools/opt_checkpoint.pb.h"
 
 namespace xls::tools {
 
@@ -44,6 +52,7 @@ struct OptOptions {
   std::optional<int64_t> convert_array_index_to_select = std::nullopt;
   std::optional<int64_t> split_next_value_selects = std::nullopt;
   bool inline_procs = false;
+  std::optional<int64_t> max_proc_inlining_cluster_size = std::nullopt;
   std::vector<RamRewrite> ram_rewrites = {};
   bool use_context_narrowing_analysis = false;
   bool optimize_for_best_case_throughput = false;
@@ -51,8 +60,39 @@ struct OptOptions {
       pass_pipeline = std::nullopt;
   std::optional<int64_t> bisect_limit;
   PipelineMetricsProto* metrics = nullptr;
+  // Number of threads used to run function-base passes on independent
+  // FunctionBases concurrently. Values <= 1 run serially.
+  int64_t function_base_threads = 1;
+  // If non-empty, the standard pipeline is run one top-level pass group at a
+  // time and a checkpoint of the IR is written to this directory after each
+  // group (see opt_checkpoint.proto).
+  std::string checkpoint_dir = "";
+  // If set, the package holds the IR of this checkpoint and the standard
+  // pipeline resumes after the last group the checkpoint completed.
+  std::optional<OptCheckpointProto> resume_from = std::nullopt;
+  // Wall-clock budgets of passes and pass groups, keyed by short name (see
+  // PassOptionsBase::pass_time_budgets).
+  absl::flat_hash_map<std::string, absl::Duration> pass_time_budgets;
+  // Wall-clock budget of the whole pipeline. Once it runs out the remaining
+  // passes are skipped and the IR is returned as optimized so far.
+  absl::Duration time_budget = absl::InfiniteDuration();
+  // Cache of optimized leaf functions, which may be shared when optimizing a
+  // batch of packages. If null, the cache named by the
+  // XLS_OPT_FUNCTION_CACHE_DIR environment variable is used, if any.
+  ContentAddressedDirectoryCache* function_optimization_cache = nullptr;
 };
 
+// A checkpoint read back from disk along with the IR it refers to.
+struct OptCheckpoint {
+  std::unique_ptr<Package> package;
+  OptCheckpointProto checkpoint;
+};
+
+// Reads a checkpoint written with OptOptions::checkpoint_dir. `path` is the
+// checkpoint's textproto; its IR is loaded from the file it names.
+absl::StatusOr<OptCheckpoint> ReadOptCheckpoint(
+    const std::filesystem::path& path, ThreadPool* thread_pool = nullptr);
+
 // Helper used in the opt_main tool, optimizes the given IR for a particular
 // top-level entity (e.g., function, proc, etc) at the given opt level and
 // modifies the package in place.
@@ -29,6 +29,7 @@
 
 #include "absl/algorithm/container.h"
 #include "absl/cleanup/cleanup.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/log/globals.h"
@@ -37,7 +38,10 @@
 #include "absl/log/log_sink.h"
 #include "absl/log/log_sink_registry.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/time.h"
 #include "absl/types/span.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/exit_status.h"
@@ -45,13 +49,17 @@
 #include "xls/common/init_xls.h"
 #include "xls/common/status/ret_check.h"
 #include "xls/common/status/status_macros.h"
+#include "xls/common/thread_pool.h"
 #include "xls/dev_tools/tool_timeout.h"
+#include "xls/ir/binary_package.h"
+#include "xls/ir/package.h"
 #include "xls/ir/ram_rewrite.pb.h"
 #include "xls/passes/optimization_pass.h"
 #include "xls/passes/optimization_pass_pipeline.h"
 #include "xls/passes/pass_metrics.pb.h"
 #include "xls/passes/pass_pipeline.pb.h"
 #include "xls/tools/opt.h"
+#include "xls/tools/opt_checkpoint.pb.h"
 
 static constexpr std::string_view kUsage = R"(
 Takes in an IR file and produces an IR file that has been run through the
@@ -61,8 +69,10 @@ Successfully optimized IR is printed to stdout.
 
 Expected invocation:
   opt_main <IR file>
+  opt_main --resume_from=<checkpoint textproto>
 where:
   - <IR file> is the path to the input IR file. '-' denotes stdin as input.
+    The file may be in the text or the binary IR format.
 
 Example invocation:
   opt_main path/to/file.ir
@@ -70,6 +80,9 @@ Example invocation:
 
 ABSL_FLAG(std::string, output_path, "-",
           "Output path for the optimized IR file; '-' denotes stdout.");
+ABSL_FLAG(bool, output_binary_ir, false,
+          "Emit the optimized IR in the binary IR format, which is faster to "
+          "load in later tools than the text format.");
 ABSL_FLAG(std::optional<std::string>, alsologto, std::nullopt,
           "Path to write logs to, in addition to stderr.");
 // LINT.IfChange
@@ -97,6 +110,11 @@ ABSL_FLAG(int64_t, opt_level, xls::kMaxOptLevel, []() -> const std::string& {
 }());
 ABSL_FLAG(bool, inline_procs, false,
           "Whether to inline all procs by calling the proc inlining pass.");
+ABSL_FLAG(std::optional<int64_t>, proc_inlining_max_cluster_size, std::nullopt,
+          "If set, proc inlining only merges strongly connected clusters of "
+          "procs of at most this many procs, keeping channels between "
+          "clusters, instead of inlining every proc into the top proc. "
+          "Bounds the size of the inlined procs for large proc networks.");
 ABSL_FLAG(std::string, ram_rewrites_pb, "",
           "Path to protobuf describing ram rewrites.");
 ABSL_FLAG(bool, use_context_narrowing_analysis, false,
@@ -131,11 +149,43 @@ ABSL_FLAG(std::optional<std::string>, passes_textproto, std::nullopt,
 ABSL_FLAG(std::optional<int64_t>, passes_bisect_limit, std::nullopt,
           "Number of passes to allow to execute. This can be used as compiler "
           "fuel to ensure the compiler finishes at a particular point.");
+ABSL_FLAG(std::string, checkpoint_dir, "",
+          "If specified, checkpoint the IR to this directory after each "
+          "top-level pass group of the standard pipeline (pre-inlining, "
+          "full-inlining and post-inlining). Each checkpoint is a binary IR "
+          "file plus a textproto recording the position in the pipeline, "
+          "which can be passed to --resume_from.");
+ABSL_FLAG(std::optional<std::string>, resume_from, std::nullopt,
+          "Path to a checkpoint textproto written with --checkpoint_dir. The "
+          "standard pipeline continues after the checkpointed pass group "
+          "using the checkpoint's IR, so no input IR file is given. "
+          "--passes_bisect_limit still counts passes from the start of the "
+          "original run.");
+ABSL_FLAG(std::vector<std::string>, pass_time_budgets, {},
+          "Comma-separated list of <pass short name>=<duration> wall-clock "
+          "budgets, e.g. 'bdd_simp=30s,post-inlining=10m'. The budget of a "
+          "compound pass covers the passes nested in it. A pass which runs "
+          "out of budget stops early, keeping the transformations made so "
+          "far, and the pipeline continues with the next pass. Budget hits "
+          "are recorded in the pipeline metrics.");
+ABSL_FLAG(absl::Duration, time_budget, absl::InfiniteDuration(),
+          "Wall-clock budget of the whole optimization pipeline, e.g. '1h'. "
+          "Once it runs out the remaining passes are skipped and the IR is "
+          "emitted as optimized so far.");
+ABSL_FLAG(int64_t, function_base_threads, 1,
+          "Number of threads used to run function-base passes on independent "
+          "functions and procs concurrently. The optimized IR is identical to "
+          "a single-threaded run.");
+ABSL_FLAG(int64_t, ir_parse_threads, 1,
+          "Number of threads used to parse the functions, procs and blocks of "
+          "textual input IR concurrently. The parsed IR is identical to a "
+          "single-threaded parse.");
 ABSL_FLAG(bool, list_passes, false,
           "If passed list the names of all passes and exit.");
 ABSL_FLAG(std::optional<std::string>, pipeline_metrics_proto, std::nullopt,
           "Output path for the pipeline metrics binary proto recording what "
-          "this opt performed.");
+          "this opt performed. See dev_tools/pipeline_metrics_to_trace_main "
+          "to view the pass runs as a trace.");
 ABSL_FLAG(std::optional<std::string>, pipeline_metrics_textproto, std::nullopt,
           "Output path for the pipeline metrics text proto recording what "
           "this opt performed.");
@@ -178,6 +228,26 @@ std::optional<T> NegativeIsNullopt(std::optional<T> v) {
   return v;
 }
 
+// Parses the <pass>=<duration> entries of --pass_time_budgets.
+absl::StatusOr<absl::flat_hash_map<std::string, absl::Duration>>
+ParsePassTimeBudgets(absl::Span<const std::string> entries) {
+  absl::flat_hash_map<std::string, absl::Duration> budgets;
+  for (const std::string& entry : entries) {
+    std::pair<std::string_view, std::string_view> name_and_budget =
+        absl::StrSplit(entry, absl::MaxSplits('=', 1));
+    absl::Duration budget;
+    if (name_and_budget.first.empty() ||
+        !absl::ParseDuration(name_and_budget.second, &budget)) {
+      return absl::InvalidArgumentError(absl::StrFormat(
+          "Invalid --pass_time_budgets entry '%s'; expected "
+          "<pass>=<duration>.",
+          entry));
+    }
+    budgets[name_and_budget.first] = budget;
+  }
+  return budgets;
+}
+
 absl::Status RealMain(std::string_view input_path) {
   auto timeout = StartTimeoutTimer();
   if (input_path == "-") {
@@ -207,6 +277,8 @@ absl::Status RealMain(std::string_view input_path) {
   std::optional<int64_t> split_next_value_selects =
       NegativeIsNullopt(absl::GetFlag(FLAGS_split_next_value_selects));
   bool inline_procs = absl::GetFlag(FLAGS_inline_procs);
+  std::optional<int64_t> max_proc_inlining_cluster_size =
+      NegativeIsNullopt(absl::GetFlag(FLAGS_proc_inlining_max_cluster_size));
   std::string ram_rewrites_pb = absl::GetFlag(FLAGS_ram_rewrites_pb);
   std::vector<RamRewrite> ram_rewrites_vec;
   if (!ram_rewrites_pb.empty()) {
@@ -223,7 +295,31 @@ absl::Status RealMain(std::string_view input_path) {
   std::optional<std::string> pass_list = absl::GetFlag(FLAGS_passes);
   std::optional<int64_t> bisect_limit =
       absl::GetFlag(FLAGS_passes_bisect_limit);
-  XLS_ASSIGN_OR_RETURN(std::string ir, GetFileContents(input_path));
+  XLS_ASSIGN_OR_RETURN(
+      (absl::flat_hash_map<std::string, absl::Duration> pass_time_budgets),
+      ParsePassTimeBudgets(absl::GetFlag(FLAGS_pass_time_budgets)));
+  std::unique_ptr<ThreadPool> parse_thread_pool;
+  if (int64_t threads = absl::GetFlag(FLAGS_ir_parse_threads); threads > 1) {
+    parse_thread_pool = std::make_unique<ThreadPool>(threads);
+  }
+  std::unique_ptr<Package> package;
+  std::optional<OptCheckpointProto> resume_from;
+  if (std::optional<std::string> checkpoint_path =
+          absl::GetFlag(FLAGS_resume_from)) {
+    if (!input_path.empty()) {
+      return absl::InvalidArgumentError(
+          "An input IR file cannot be given with --resume_from; the IR is "
+          "read from the checkpoint.");
+    }
+    XLS_ASSIGN_OR_RETURN(
+        OptCheckpoint checkpoint,
+        ReadOptCheckpoint(*checkpoint_path, parse_thread_pool.get()));
+    package = std::move(checkpoint.package);
+    resume_from = std::move(checkpoint.checkpoint);
+  } else {
+    XLS_ASSIGN_OR_RETURN(package,
+                         ReadPackageFile(input_path, parse_thread_pool.get()));
+  }
   std::optional<std::string> pipeline_textproto =
       absl::GetFlag(FLAGS_passes_textproto);
   std::optional<std::string> pipeline_binproto =
@@ -259,26 +355,30 @@ absl::Status RealMain(std::string_view input_path) {
   bool wants_metrics = absl::GetFlag(FLAGS_pipeline_metrics_proto) ||
                        absl::GetFlag(FLAGS_pipeline_metrics_textproto);
 
-  XLS_ASSIGN_OR_RETURN(
-      std::string opt_ir,
-      tools::OptimizeIrForTop(
-          ir,
-          OptOptions{
-              .opt_level = opt_level,
-              .top = top,
-              .ir_dump_path = ir_dump_path,
-              .skip_passes = std::move(skip_passes),
-              .convert_array_index_to_select = convert_array_index_to_select,
-              .split_next_value_selects = split_next_value_selects,
-              .inline_procs = inline_procs,
-              .ram_rewrites = std::move(ram_rewrites_vec),
-              .use_context_narrowing_analysis = use_context_narrowing_analysis,
-              .optimize_for_best_case_throughput =
-                  optimize_for_best_case_throughput,
-              .pass_pipeline = pass_pipeline,
-              .bisect_limit = bisect_limit,
-              .metrics = wants_metrics ? &metrics : nullptr,
-          }));
+  XLS_RETURN_IF_ERROR(tools::OptimizeIrForTop(
+      package.get(),
+      OptOptions{
+          .opt_level = opt_level,
+          .top = top,
+          .ir_dump_path = ir_dump_path,
+          .skip_passes = std::move(skip_passes),
+          .convert_array_index_to_select = convert_array_index_to_select,
+          .split_next_value_selects = split_next_value_selects,
+          .inline_procs = inline_procs,
+          .max_proc_inlining_cluster_size = max_proc_inlining_cluster_size,
+          .ram_rewrites = std::move(ram_rewrites_vec),
+          .use_context_narrowing_analysis = use_context_narrowing_analysis,
+          .optimize_for_best_case_throughput =
+              optimize_for_best_case_throughput,
+          .pass_pipeline = pass_pipeline,
+          .bisect_limit = bisect_limit,
+          .metrics = wants_metrics ? &metrics : nullptr,
+          .function_base_threads = absl::GetFlag(FLAGS_function_base_threads),
+          .checkpoint_dir = absl::GetFlag(FLAGS_checkpoint_dir),
+          .resume_from = std::move(resume_from),
+          .pass_time_budgets = std::move(pass_time_budgets),
+          .time_budget = absl::GetFlag(FLAGS_time_budget),
+      }));
   if (absl::GetFlag(FLAGS_pipeline_metrics_proto)) {
     XLS_RETURN_IF_ERROR(
         SetFileContents(*absl::GetFlag(FLAGS_pipeline_metrics_proto),
@@ -291,6 +391,9 @@ absl::Status RealMain(std::string_view input_path) {
         SetFileContents(*absl::GetFlag(FLAGS_pipeline_metrics_textproto), tf));
   }
 
+  XLS_ASSIGN_OR_RETURN(
+      std::string opt_ir,
+      DumpPackage(package.get(), absl::GetFlag(FLAGS_output_binary_ir)));
   if (output_path == "-") {
     std::cout << opt_ir;
     return absl::OkStatus();
@@ -310,6 +413,10 @@ int main(int argc, char** argv) {
         << xls::GetOptimizationPipelineGenerator().GetAvailablePassesStr();
     return 0;
   }
+  if (absl::GetFlag(FLAGS_resume_from).has_value()) {
+    return xls::ExitStatus(xls::tools::RealMain(
+        positional_arguments.empty() ? "" : positional_arguments[0]));
+  }
   if (positional_arguments.empty()) {
     LOG(QFATAL) << absl::StreamFormat("Expected invocation: %s <path>",
                                       argv[0]);
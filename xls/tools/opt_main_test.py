@@ -17,6 +17,7 @@
 
 import concurrent
 import concurrent.futures
+import os
 import subprocess
 from typing import Optional
 
@@ -56,6 +57,19 @@ top fn add_zero(x: bits[32]) -> bits[32] {
 }
 """
 
+INVOKE_IR = """package invoke
+
+fn callee(x: bits[32]) -> bits[32] {
+  literal.1: bits[32] = literal(value=0)
+  ret add.2: bits[32] = add(x, literal.1)
+}
+
+top fn main(x: bits[32], y: bits[32]) -> bits[32] {
+  invoke.3: bits[32] = invoke(x, to_apply=callee)
+  ret umul.4: bits[32] = umul(invoke.3, y)
+}
+"""
+
 
 class OptMainTest(parameterized.TestCase):
 
@@ -189,6 +203,67 @@ class OptMainTest(parameterized.TestCase):
     # add is not removed since the DCE was not run.
     self.assertIn('bits[32] = add', optimized_ir)
 
+  def test_resume_from_checkpoint(self):
+    ir_file = self.create_tempfile(content=INVOKE_IR)
+    checkpoint_dir = self.create_tempdir()
+    optimized_ir = subprocess.check_output([
+        OPT_MAIN_PATH,
+        ir_file.full_path,
+        f'--checkpoint_dir={checkpoint_dir.full_path}',
+    ]).decode('utf-8')
+    self.assertEqual(
+        optimized_ir,
+        subprocess.check_output([OPT_MAIN_PATH, ir_file.full_path]).decode(
+            'utf-8'
+        ),
+    )
+
+    checkpoints = sorted(
+        f for f in os.listdir(checkpoint_dir.full_path)
+        if f.endswith('.textproto')
+    )
+    self.assertEqual(
+        checkpoints,
+        [
+            'invoke.checkpoint.1.pre-inlining.textproto',
+            'invoke.checkpoint.2.full-inlining.textproto',
+            'invoke.checkpoint.3.post-inlining.textproto',
+        ],
+    )
+    for checkpoint in checkpoints:
+      with self.subTest(checkpoint):
+        resumed_ir = subprocess.check_output([
+            OPT_MAIN_PATH,
+            '--resume_from',
+            os.path.join(checkpoint_dir.full_path, checkpoint),
+        ]).decode('utf-8')
+        self.assertEqual(resumed_ir, optimized_ir)
+
+  def test_resume_from_checkpoint_at_other_opt_level(self):
+    ir_file = self.create_tempfile(content=INVOKE_IR)
+    checkpoint_dir = self.create_tempdir()
+    subprocess.check_call([
+        OPT_MAIN_PATH,
+        ir_file.full_path,
+        f'--checkpoint_dir={checkpoint_dir.full_path}',
+    ])
+    result = subprocess.run(
+        [
+            OPT_MAIN_PATH,
+            '--opt_level=1',
+            '--resume_from',
+            os.path.join(
+                checkpoint_dir.full_path,
+                'invoke.checkpoint.1.pre-inlining.textproto',
+            ),
+        ],
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        check=False,
+    )
+    self.assertNotEqual(result.returncode, 0)
+    self.assertIn('cannot resume at opt level 1', result.stderr.decode('utf-8'))
+
   @parameterized.parameters(range(0, 5))
   def test_proto_pipeline(self, opt_level):
     test_file = runfiles.get_path('xls/modules/aes/aes_ctr.ir')
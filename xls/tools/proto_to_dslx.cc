@@ -19,9 +19,11 @@
 #include <cstring>
 #include <deque>
 #include <filesystem>  // NOLINT
+#include <fstream>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <ostream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -31,7 +33,9 @@
 #include "absl/container/btree_map.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/functional/function_ref.h"
 #include "absl/log/log.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
@@ -42,6 +46,7 @@
 #include "google/protobuf/compiler/importer.h"
 #include "google/protobuf/descriptor.h"
 #include "google/protobuf/dynamic_message.h"
+#include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/file/temp_directory.h"
@@ -949,6 +954,207 @@ absl::StatusOr<dslx::Expr*> EmitData(std::string_view top_package,
   return module->Make<dslx::StructInstance>(span, struct_def, elements);
 }
 
+// Writes the DSLX text of message instances to a stream. The text is identical
+// to that of the StructInstance which EmitData would build, but no AST is
+// built for the data and repeated fields are written element by element, so
+// memory use does not grow with the amount of data.
+class DataWriter {
+ public:
+  DataWriter(std::string_view top_package, dslx::Module* module,
+             const NameToRecord& name_to_record, std::ostream& out)
+      : top_package_(top_package),
+        module_(module),
+        name_to_record_(name_to_record),
+        out_(out) {}
+
+  absl::Status WriteMessage(const Message& message) {
+    const Descriptor* descriptor = message.GetDescriptor();
+    const Reflection* reflection = message.GetReflection();
+    const MessageRecord& message_record =
+        *name_to_record_.at(GetParentPrefixedName(top_package_, descriptor));
+    out_ << message_record.dslx_type->ToString() << " { ";
+    bool first = true;
+    for (int field_idx = 0; field_idx < descriptor->field_count();
+         field_idx++) {
+      const FieldDescriptor* fd = descriptor->field(field_idx);
+      if (message_record.children.at(fd->name()).unsupported) {
+        continue;
+      }
+      switch (fd->type()) {
+        case FieldDescriptor::Type::TYPE_MESSAGE:
+          XLS_RETURN_IF_ERROR(
+              WriteStructField(message, fd, reflection, message_record, first));
+          break;
+        case FieldDescriptor::Type::TYPE_ENUM:
+          XLS_RETURN_IF_ERROR(
+              WriteEnumField(message, fd, reflection, message_record, first));
+          break;
+        default:
+          XLS_RETURN_IF_ERROR(WriteIntegralField(message, fd, reflection,
+                                                 message_record, first));
+      }
+    }
+    out_ << " }";
+    return absl::OkStatus();
+  }
+
+ private:
+  // Writes the name of the next member of the struct instance being written.
+  void WriteMemberName(std::string_view name, bool& first) {
+    if (!first) {
+      out_ << ", ";
+    }
+    first = false;
+    out_ << name << ": ";
+  }
+
+  // Writes the array member for a repeated field followed by its `_count`
+  // member, as EmitArray does: `write_element` writes each of the field's
+  // elements and the array is padded out with `zero_text`.
+  absl::Status WriteArray(
+      const Message& message, const FieldDescriptor* fd,
+      const Reflection* reflection, const MessageRecord& message_record,
+      absl::FunctionRef<absl::Status(int)> write_element,
+      std::string_view zero_text, bool& first) {
+    std::string_view field_name = fd->name();
+    int64_t total_submsgs = message_record.children.at(field_name).count;
+    int num_submsgs = reflection->FieldSize(message, fd);
+    WriteMemberName(field_name, first);
+    out_ << "[";
+    for (int submsg_idx = 0; submsg_idx < total_submsgs; submsg_idx++) {
+      if (submsg_idx != 0) {
+        out_ << ", ";
+      }
+      if (submsg_idx < num_submsgs) {
+        XLS_RETURN_IF_ERROR(write_element(submsg_idx));
+      } else {
+        out_ << zero_text;
+      }
+    }
+    out_ << "]";
+    WriteMemberName(absl::StrCat(field_name, "_count"), first);
+    out_ << "u32:" << num_submsgs;
+    return absl::OkStatus();
+  }
+
+  absl::Status WriteStructField(const Message& message,
+                                const FieldDescriptor* fd,
+                                const Reflection* reflection,
+                                const MessageRecord& message_record,
+                                bool& first) {
+    if (!fd->is_repeated()) {
+      WriteMemberName(fd->name(), first);
+      return WriteMessage(reflection->GetMessage(message, fd));
+    }
+    if (message_record.children.at(fd->name()).count == 0) {
+      return absl::OkStatus();
+    }
+    dslx::TypeAnnotation* typeref_type =
+        name_to_record_
+            .at(GetParentPrefixedName(top_package_, fd->message_type()))
+            ->dslx_type;
+    auto [it, inserted] = zero_structs_.try_emplace(typeref_type);
+    if (inserted) {
+      XLS_ASSIGN_OR_RETURN(dslx::Expr * zero,
+                           MakeZeroValuedElement(module_, typeref_type));
+      it->second = zero->ToString();
+    }
+    return WriteArray(
+        message, fd, reflection, message_record,
+        [&](int index) {
+          return WriteMessage(
+              reflection->GetRepeatedMessage(message, fd, index));
+        },
+        it->second, first);
+  }
+
+  absl::Status WriteEnumField(const Message& message,
+                              const FieldDescriptor* fd,
+                              const Reflection* reflection,
+                              const MessageRecord& message_record,
+                              bool& first) {
+    auto write_enum_value = [&](const google::protobuf::EnumValueDescriptor* evd) {
+      out_ << GetParentPrefixedName(top_package_, evd->type())
+           << "::" << evd->name();
+    };
+    if (!fd->is_repeated()) {
+      WriteMemberName(fd->name(), first);
+      write_enum_value(reflection->GetEnum(message, fd));
+      return absl::OkStatus();
+    }
+    if (message_record.children.at(fd->name()).count == 0) {
+      return absl::OkStatus();
+    }
+    const EnumDescriptor* ed = fd->enum_type();
+    std::string zero_text = absl::StrCat(
+        GetParentPrefixedName(top_package_, ed), "::", ed->value(0)->name());
+    return WriteArray(
+        message, fd, reflection, message_record,
+        [&](int index) {
+          write_enum_value(reflection->GetRepeatedEnum(message, fd, index));
+          return absl::OkStatus();
+        },
+        zero_text, first);
+  }
+
+  absl::Status WriteIntegralField(const Message& message,
+                                  const FieldDescriptor* fd,
+                                  const Reflection* reflection,
+                                  const MessageRecord& message_record,
+                                  bool& first) {
+    FieldDescriptor::Type field_type = std::get<FieldDescriptor::Type>(
+        message_record.children.at(fd->name()).type);
+    bool is_signed = IsFieldSigned(field_type);
+    std::string type_prefix = absl::StrFormat(
+        "%s[%d]:", is_signed ? "sN" : "uN", GetFieldWidth(field_type));
+    if (!fd->is_repeated()) {
+      WriteMemberName(fd->name(), first);
+      out_ << type_prefix << GetFieldValue(message, *reflection, *fd);
+      return absl::OkStatus();
+    }
+    if (message_record.children.at(fd->name()).count == 0) {
+      return absl::OkStatus();
+    }
+    return WriteArray(
+        message, fd, reflection, message_record,
+        [&](int index) {
+          uint64_t value = GetFieldValue(message, *reflection, *fd, index);
+          out_ << type_prefix;
+          if (is_signed) {
+            out_ << static_cast<int64_t>(value);
+          } else {
+            out_ << value;
+          }
+          return absl::OkStatus();
+        },
+        absl::StrCat(type_prefix, "0"), first);
+  }
+
+  std::string_view top_package_;
+  dslx::Module* module_;
+  const NameToRecord& name_to_record_;
+  std::ostream& out_;
+
+  // Text of the zero-valued instance of each struct type, used for padding.
+  absl::flat_hash_map<dslx::TypeAnnotation*, std::string> zero_structs_;
+};
+
+// Returns a new, empty instance of the named message.
+absl::StatusOr<std::unique_ptr<Message>> NewMessage(
+    std::string_view message_name, DescriptorPool* descriptor_pool,
+    google::protobuf::DynamicMessageFactory* factory) {
+  XLS_RET_CHECK(descriptor_pool != nullptr);
+  XLS_RET_CHECK(factory != nullptr);
+
+  const Descriptor* descriptor =
+      descriptor_pool->FindMessageTypeByName(ToProtoString(message_name));
+  XLS_RET_CHECK_NE(descriptor, nullptr);
+
+  const Message* message = factory->GetPrototype(descriptor);
+  XLS_RET_CHECK(message != nullptr);
+  return absl::WrapUnique(message->New());
+}
+
 absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxWithDescriptorPool(
     std::string_view message_name, std::string_view text_proto,
     std::string_view binding_name, DescriptorPool* descriptor_pool,
@@ -1005,6 +1211,40 @@ absl::Status ProtoToDslxManager::AddProtoInstantiationToDslxModule(
   return absl::OkStatus();
 }
 
+absl::Status ProtoToDslxManager::StreamProtoInstantiation(
+    std::string_view binding_name, const Message& message, std::ostream& out) {
+  XLS_RET_CHECK(module_ != nullptr);
+
+  auto write_separator = [&]() {
+    if (streamed_any_) {
+      out << "\n";
+    }
+    streamed_any_ = true;
+  };
+  const Descriptor* descriptor = message.GetDescriptor();
+  if (!name_to_records_.contains(descriptor)) {
+    int64_t first_new_member = module_->top().size();
+    XLS_RETURN_IF_ERROR(AddProtoTypeToDslxModule(message));
+    for (int64_t i = first_new_member; i < module_->top().size(); ++i) {
+      write_separator();
+      out << dslx::ToAstNode(module_->top()[i])->ToString();
+    }
+  }
+  NameToRecord& name_to_record = name_to_records_[descriptor];
+
+  write_separator();
+  out << "pub const " << binding_name << " = ";
+  DataWriter writer(descriptor->file()->package(), module_, name_to_record,
+                    out);
+  XLS_RETURN_IF_ERROR(writer.WriteMessage(message));
+  out << ";";
+  if (!out) {
+    return absl::InternalError(absl::StrFormat(
+        "Failed to write DSLX for constant `%s`", binding_name));
+  }
+  return absl::OkStatus();
+}
+
 absl::Status ProtoToDslxManager::AddProtoTypeToDslxModule(
     const Message& message) {
   XLS_RET_CHECK(module_ != nullptr);
@@ -1074,6 +1314,37 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslx(
                                        descriptor_pool.get(), file_table);
 }
 
+absl::Status StreamProtoToDslx(const std::filesystem::path& source_root,
+                               const std::filesystem::path& proto_schema_path,
+                               std::string_view message_name,
+                               const std::filesystem::path& text_proto_path,
+                               std::string_view binding_name,
+                               std::ostream& out) {
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<DescriptorPool> descriptor_pool,
+                       ProcessProtoSchema(source_root, proto_schema_path));
+  google::protobuf::DynamicMessageFactory factory;
+  XLS_ASSIGN_OR_RETURN(
+      std::unique_ptr<Message> message,
+      NewMessage(message_name, descriptor_pool.get(), &factory));
+
+  // Parse straight from the file rather than reading it into a string first.
+  std::ifstream text_proto_file(text_proto_path);
+  if (!text_proto_file) {
+    return absl::NotFoundError(absl::StrFormat(
+        "Unable to open text proto file: %s", text_proto_path.string()));
+  }
+  google::protobuf::io::IstreamInputStream input(&text_proto_file);
+  if (!google::protobuf::TextFormat::Parse(&input, message.get())) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Unable to parse text proto file: %s", text_proto_path.string()));
+  }
+
+  dslx::FileTable file_table;
+  dslx::Module module("the_module", /*fs_path=*/std::nullopt, file_table);
+  ProtoToDslxManager proto_to_dslx(&module);
+  return proto_to_dslx.StreamProtoInstantiation(binding_name, *message, out);
+}
+
 absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxViaText(
     std::string_view proto_def, std::string_view message_name,
     std::string_view text_proto, std::string_view binding_name,
@@ -1087,16 +1358,8 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslxViaText(
 absl::StatusOr<std::unique_ptr<Message>> ConstructProtoViaText(
     std::string_view text_proto, std::string_view message_name,
     DescriptorPool* descriptor_pool, google::protobuf::DynamicMessageFactory* factory) {
-  XLS_RET_CHECK(descriptor_pool != nullptr);
-  XLS_RET_CHECK(factory != nullptr);
-
-  const Descriptor* descriptor =
-      descriptor_pool->FindMessageTypeByName(ToProtoString(message_name));
-  XLS_RET_CHECK_NE(descriptor, nullptr);
-
-  const Message* message = factory->GetPrototype(descriptor);
-  XLS_RET_CHECK(message != nullptr);
-  std::unique_ptr<Message> new_message(message->New());
+  XLS_ASSIGN_OR_RETURN(std::unique_ptr<Message> new_message,
+                       NewMessage(message_name, descriptor_pool, factory));
 
   google::protobuf::TextFormat::ParseFromString(ToProtoString(text_proto),
                                       new_message.get());
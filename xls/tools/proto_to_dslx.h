@@ -17,6 +17,7 @@
 
 #include <filesystem>  // NOLINT
 #include <memory>
+#include <ostream>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -62,6 +63,17 @@ class ProtoToDslxManager {
   absl::Status AddProtoInstantiationToDslxModule(
       std::string_view binding_name, const google::protobuf::Message& message);
 
+  // As AddProtoInstantiationToDslxModule, but rather than adding the constant
+  // to the module, writes its DSLX text to `out` while walking the message, so
+  // that no AST or string is built for the (potentially very large) data. The
+  // definitions for the message's type are still added to the module the
+  // first time the type is seen, and are written to `out` ahead of the
+  // constant. Items written by consecutive calls are separated by newlines, so
+  // the text matches that of Module::ToString for the equivalent module.
+  absl::Status StreamProtoInstantiation(std::string_view binding_name,
+                                        const google::protobuf::Message& message,
+                                        std::ostream& out);
+
  private:
   // AddProtoTypeToDslxModule accepts a proto message and adds its type
   // definition into a corresponding DSLX module as a DSLX struct.
@@ -73,6 +85,9 @@ class ProtoToDslxManager {
   dslx::Module* module_ = nullptr;
   absl::flat_hash_map<const google::protobuf::Descriptor*, internal::NameToRecord>
       name_to_records_;
+
+  // Whether StreamProtoInstantiation has written anything yet.
+  bool streamed_any_ = false;
 };
 
 // Construct a DSLX module for the given proto definitions.
@@ -133,7 +148,18 @@ absl::StatusOr<std::unique_ptr<dslx::Module>> ProtoToDslx(
     std::string_view message_name, std::string_view text_proto,
     std::string_view binding_name, dslx::FileTable& file_table);
 
-// As above, but doesn't refer directly to the filesystem for resolution.
+// As ProtoToDslx, but parses the message incrementally from the file at
+// `text_proto_path` and writes the resulting DSLX text to `out` as it is
+// generated (see ProtoToDslxManager::StreamProtoInstantiation). The text is
+// the same as that of the module ProtoToDslx returns.
+absl::Status StreamProtoToDslx(const std::filesystem::path& source_root,
+                               const std::filesystem::path& proto_schema_path,
+                               std::string_view message_name,
+                               const std::filesystem::path& text_proto_path,
+                               std::string_view binding_name,
+                               std::ostream& out);
+
+// As ProtoToDslx, but doesn't refer directly to the filesystem for resolution.
 //
 // Args:
 //  proto_def: Contents of the proto schema file (i.e. `.proto` file).
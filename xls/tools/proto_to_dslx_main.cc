@@ -14,17 +14,19 @@
 
 // Converts a protobuf schema and instantiating message into DSLX structs and
 // constant data.
+#include <cstdint>
+#include <fstream>
+#include <ios>
 #include <string>
+#include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_format.h"
 #include "xls/common/exit_status.h"
-#include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
-#include "xls/dslx/frontend/module.h"
-#include "xls/dslx/frontend/pos.h"
 #include "xls/tools/proto_to_dslx.h"
 
 ABSL_FLAG(std::string, proto_def_path, "",
@@ -45,18 +47,33 @@ ABSL_FLAG(std::string, var_name, "",
 
 namespace xls {
 
+static constexpr int64_t kOutputBufferSize = 1 << 20;
+
 static absl::Status RealMain(const std::string& source_root_path,
                              const std::string& proto_def_path,
                              const std::string& proto_name,
                              const std::string& textproto_path,
                              const std::string& var_name,
                              const std::string& output_path) {
-  XLS_ASSIGN_OR_RETURN(std::string textproto, GetFileContents(textproto_path));
-  dslx::FileTable file_table;
-  XLS_ASSIGN_OR_RETURN(auto module,
-                       ProtoToDslx(source_root_path, proto_def_path, proto_name,
-                                   textproto, var_name, file_table));
-  return SetFileContents(output_path, module->ToString());
+  // The DSLX for large messages can be hundreds of megabytes, so it is written
+  // out as it is generated through a large buffer.
+  std::vector<char> buffer(kOutputBufferSize);
+  std::ofstream output;
+  output.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  output.open(output_path, std::ios::trunc);
+  if (!output) {
+    return absl::NotFoundError(
+        absl::StrFormat("Unable to open output file: %s", output_path));
+  }
+  XLS_RETURN_IF_ERROR(StreamProtoToDslx(source_root_path, proto_def_path,
+                                        proto_name, textproto_path, var_name,
+                                        output));
+  output.close();
+  if (!output) {
+    return absl::InternalError(
+        absl::StrFormat("Unable to write output file: %s", output_path));
+  }
+  return absl::OkStatus();
 }
 
 }  // namespace xls
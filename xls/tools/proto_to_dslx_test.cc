@@ -16,6 +16,7 @@
 
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <string>
 
 #include "gtest/gtest.h"
@@ -288,6 +289,70 @@ pub struct Top {
 pub const foo = Top { field_0: sN[32]:48879, enum_holder: [EnumHolder { imported_enum: [imported_Enum::VALUE_600, imported_Enum::VALUE_3, imported_Enum::VALUE_2, imported_Enum::VALUE_1], imported_enum_count: u32:4 }, EnumHolder { imported_enum: [imported_Enum::VALUE_3, imported_Enum::VALUE_2, imported_Enum::VALUE_1, imported_Enum::VALUE_1], imported_enum_count: u32:2 }], enum_holder_count: u32:2 };)");
 }
 
+// Streaming emission must produce exactly the text of the equivalent module,
+// including the zero-valued padding of under-filled repeated fields.
+TEST(ProtoToDslxTest, StreamingMatchesModuleText) {
+  const std::string kSchema = R"(
+syntax = "proto2";
+
+package xls;
+
+enum Color {
+  RED = 0;
+  GREEN = 1;
+}
+
+message Leaf {
+  optional uint32 value = 1;
+  repeated Color colors = 2;
+}
+
+message Node {
+  optional int32 offset = 1;
+  repeated int64 deltas = 2;
+  repeated Leaf leaves = 3;
+  optional Color color = 4;
+}
+
+message Top {
+  repeated Node nodes = 1;
+  optional Node spare = 2;
+}
+)";
+  const std::string kTextproto = R"(
+nodes {
+  offset: 3
+  deltas: -1
+  deltas: 2
+  leaves { value: 1 colors: GREEN colors: RED }
+  leaves { value: 2 }
+  color: GREEN
+}
+nodes {
+  deltas: 7
+  leaves { value: 3 colors: GREEN }
+}
+)";
+  XLS_ASSERT_OK_AND_ASSIGN(auto tempdir, TempDirectory::Create());
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto schema_file,
+      TempFile::CreateWithContentInDirectory(kSchema, tempdir.path()));
+  XLS_ASSERT_OK_AND_ASSIGN(
+      auto textproto_file,
+      TempFile::CreateWithContentInDirectory(kTextproto, tempdir.path()));
+  dslx::FileTable file_table;
+  XLS_ASSERT_OK_AND_ASSIGN(
+      std::unique_ptr<dslx::Module> module,
+      ProtoToDslx(tempdir.path(), schema_file.path(), "xls.Top", kTextproto,
+                  "foo", file_table));
+
+  std::ostringstream streamed;
+  XLS_ASSERT_OK(StreamProtoToDslx(tempdir.path(), schema_file.path(),
+                                  "xls.Top", textproto_file.path(), "foo",
+                                  streamed));
+  EXPECT_EQ(streamed.str(), module->ToString());
+}
+
 TEST(ProtoToDslxTest, HandlesStrings) {
   const std::string kSchema = R"(
 syntax = "proto2";
@@ -83,6 +83,17 @@ ABSL_FLAG(std::optional<int64_t>, worst_case_throughput, std::nullopt,
           "If zero, no throughput bound will be enforced.\n"
           "If negative, XLS will find the fastest throughput achievable given "
           "all other constraints specified.");
+ABSL_FLAG(bool, modulo_resource_sharing, false,
+          "If true, schedule operations modulo the worst-case throughput so "
+          "that operations which `--area_model` deems more expensive than the "
+          "muxes needed to share them never need more instances than the "
+          "initiation interval requires. For example, with "
+          "`--worst_case_throughput=2` two multiplies of the same shape are "
+          "placed in cycles of different parity. Has no effect at full "
+          "throughput.");
+ABSL_FLAG(std::string, area_model, "",
+          "Area model used to pick the operations to share with "
+          "`--modulo_resource_sharing`.");
 ABSL_FLAG(int64_t, additional_input_delay_ps, 0,
           "The additional delay added to each input.");
 ABSL_FLAG(int64_t, additional_output_delay_ps, 0,
@@ -158,10 +169,22 @@ ABSL_FLAG(std::string, fdo_default_driver_cell, "",
           "Cell to assume is driving primary inputs");
 ABSL_FLAG(std::string, fdo_default_load, "",
           "Cell to assume is being driven by primary outputs");
+ABSL_FLAG(int64_t, fdo_synthesis_workers, 0,
+          "Maximum number of synthesis jobs to run concurrently during FDO. "
+          "Values of 0 or less run every job of an iteration at once.");
 // TODO: google/xls#869 - Remove when proc-scoped channels supplant old-style
 // procs.
 ABSL_FLAG(bool, multi_proc, false,
           "If true, schedule all procs and codegen them all.");
+ABSL_FLAG(int64_t, scheduling_threads, 1,
+          "Number of threads to use to schedule independent procs and "
+          "functions concurrently (with `--multi_proc`). Values of 1 or less "
+          "schedule them one at a time.");
+ABSL_FLAG(int64_t, clock_search_threads, 1,
+          "Number of candidate clock periods to check in parallel when "
+          "searching for the minimum feasible clock period (e.g., without "
+          "`--clock_period_ps`). Values of 1 or less use a serial binary "
+          "search.");
 // LINT.ThenChange(
 //   //xls/build_rules/xls_providers.bzl,
 //   //docs_src/codegen_options.md
@@ -205,6 +228,8 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
         absl::GetFlag(FLAGS_worst_case_throughput)
             .value_or(proto.minimize_worst_case_throughput() ? 0 : 1));
   }
+  POPULATE_FLAG(modulo_resource_sharing);
+  POPULATE_FLAG(area_model);
   POPULATE_FLAG(additional_input_delay_ps);
   POPULATE_FLAG(additional_output_delay_ps);
   POPULATE_FLAG(ffi_fallback_delay_ps);
@@ -224,7 +249,10 @@ static absl::StatusOr<bool> SetOptionsFromFlags(
   POPULATE_FLAG(fdo_synthesis_libraries);
   POPULATE_FLAG(fdo_default_driver_cell);
   POPULATE_FLAG(fdo_default_load);
+  POPULATE_FLAG(fdo_synthesis_workers);
   POPULATE_FLAG(multi_proc);
+  POPULATE_FLAG(scheduling_threads);
+  POPULATE_FLAG(clock_search_threads);
 #undef POPULATE_FLAG
 #undef POPULATE_REPEATED_FLAG
 
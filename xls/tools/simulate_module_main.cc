@@ -107,6 +107,10 @@ ABSL_FLAG(std::vector<std::string>, output_channel_counts, {},
 ABSL_FLAG(std::string, verilog_simulator, "iverilog",
           "The Verilog simulator to use. If not specified, the default "
           "simulator is used.");
+ABSL_FLAG(int64_t, simulator_processes, 1,
+          "The maximum number of Verilog simulator processes to run in "
+          "parallel. Large batches of function arguments are split across "
+          "this many processes.");
 ABSL_FLAG(std::string, file_type, "",
           "The type of input file, may be either 'verilog' or "
           "'system_verilog'. If not specified the file type is determined by "
@@ -219,6 +223,8 @@ absl::Status RealMain(std::string_view verilog_text,
                       const verilog::VerilogSimulator* verilog_simulator) {
   verilog::ModuleSimulator simulator(signature, verilog_text, file_type,
                                      verilog_simulator);
+  simulator.set_max_simulator_processes(
+      absl::GetFlag(FLAGS_simulator_processes));
 
   if (std::holds_alternative<FunctionInput>(inputs)) {
     return RunFunction(simulator, signature, std::get<FunctionInput>(inputs));
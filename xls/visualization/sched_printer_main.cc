@@ -32,6 +32,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_join.h"
+#include "google/protobuf/text_format.h"
 #include "xls/common/file/filesystem.h"
 #include "xls/common/init_xls.h"
 #include "xls/common/status/status_macros.h"
@@ -50,11 +51,17 @@
 #include "xls/scheduling/scheduling_options.h"
 #include "xls/tools/scheduling_options_flags.h"
 #include "xls/tools/scheduling_options_flags.pb.h"
+#include "xls/visualization/schedule_columns.h"
+#include "xls/visualization/schedule_columns.pb.h"
 
 static constexpr std::string_view kUsage = R"(
 Dump scheduling result to stdout in Graphviz's dot plain text format.
 Explicitly show the pipeline stage.
 
+For large schedules, --output_format=columns writes the per-node stage, delay
+and slack as a binary xls.ScheduleColumnsProto, and
+--output_format=histograms prints only the per-stage slack histograms.
+
 Example invocation:
   sched_printer_main --clock_period_ps=500 \
        --pipeline_stages=7 \
@@ -62,6 +69,15 @@ Example invocation:
 )";
 
 ABSL_FLAG(std::string, top, "", "Top entity to use in lieu of the default.");
+ABSL_FLAG(std::string, output_format, "dot",
+          "Output format; one of `dot`, `columns` (binary "
+          "xls.ScheduleColumnsProto) or `histograms` (text "
+          "xls.ScheduleColumnsProto holding only the per-stage histograms).");
+ABSL_FLAG(std::string, output_path, "",
+          "Path to write the output to. If empty, the output is written to "
+          "stdout.");
+ABSL_FLAG(int64_t, histogram_bucket_count, 16,
+          "Number of slack buckets in each per-stage histogram.");
 
 namespace xls {
 namespace {
@@ -335,6 +351,27 @@ absl::StatusOr<PipelineSchedule> RunSchedulingPipeline(
   return schedule_status;
 }
 
+// Returns the schedule in dot format, with the critical path highlighted.
+absl::StatusOr<std::string> ScheduleToDot(
+    FunctionBase* main, const PipelineSchedule& schedule,
+    const SchedulingOptions& scheduling_options,
+    const DelayEstimator& delay_estimator) {
+  XLS_ASSIGN_OR_RETURN(
+      std::vector<CriticalPathEntry> cp,
+      AnalyzeCriticalPath(main, scheduling_options.clock_period_ps(),
+                          delay_estimator));
+
+  absl::flat_hash_set<Node*> nodes_on_cp;
+  for (const CriticalPathEntry& entry : cp) {
+    nodes_on_cp.insert(entry.node);
+  }
+
+  XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
+                       ComputeNodeDelays(main, delay_estimator));
+
+  return DumpScheduleResultToDot(schedule, delay_map, nodes_on_cp);
+}
+
 absl::Status RealMain(std::string_view ir_path) {
   if (ir_path == "-") {
     ir_path = "/dev/stdin";
@@ -370,22 +407,37 @@ absl::Status RealMain(std::string_view ir_path) {
       PipelineSchedule schedule,
       RunSchedulingPipeline(main, scheduling_options, delay_estimator));
 
-  XLS_ASSIGN_OR_RETURN(
-      std::vector<CriticalPathEntry> cp,
-      AnalyzeCriticalPath(main, scheduling_options.clock_period_ps(),
-                          *delay_estimator));
-
-  absl::flat_hash_set<Node*> nodes_on_cp;
-  for (const CriticalPathEntry& entry : cp) {
-    nodes_on_cp.insert(entry.node);
+  std::string output_format = absl::GetFlag(FLAGS_output_format);
+  std::string output;
+  if (output_format == "columns" || output_format == "histograms") {
+    ScheduleColumnsOptions options;
+    options.clock_period_ps = scheduling_options.clock_period_ps();
+    options.histogram_bucket_count =
+        absl::GetFlag(FLAGS_histogram_bucket_count);
+    options.emit_node_columns = output_format == "columns";
+    XLS_ASSIGN_OR_RETURN(
+        ScheduleColumnsProto columns,
+        ScheduleToColumns(schedule, *delay_estimator, options));
+    if (options.emit_node_columns) {
+      output = columns.SerializeAsString();
+    } else if (!google::protobuf::TextFormat::PrintToString(columns, &output)) {
+      return absl::InternalError("Unable to print schedule histograms.");
+    }
+  } else if (output_format == "dot") {
+    XLS_ASSIGN_OR_RETURN(output, ScheduleToDot(main, schedule,
+                                               scheduling_options,
+                                               *delay_estimator));
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Unknown --output_format: %s", output_format));
   }
 
-  XLS_ASSIGN_OR_RETURN(DelayMap delay_map,
-                       ComputeNodeDelays(main, *delay_estimator));
-
-  std::cout << DumpScheduleResultToDot(schedule, delay_map, nodes_on_cp);
-
-  return absl::OkStatus();
+  std::string output_path = absl::GetFlag(FLAGS_output_path);
+  if (output_path.empty()) {
+    std::cout << output;
+    return absl::OkStatus();
+  }
+  return SetFileContents(output_path, output);
 }
 
 }  // namespace
@@ -0,0 +1,162 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/visualization/schedule_columns.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "xls/common/status/ret_check.h"
+#include "xls/common/status/status_macros.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/ir/function_base.h"
+#include "xls/ir/node.h"
+#include "xls/ir/topo_sort.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/visualization/schedule_columns.pb.h"
+
+namespace xls {
+
+StageHistogramAggregator::StageHistogramAggregator(int64_t clock_period_ps,
+                                                   int64_t bucket_count,
+                                                   int64_t stage_count)
+    : bucket_width_ps_(
+          std::max<int64_t>(1, (clock_period_ps + bucket_count - 1) /
+                                   std::max<int64_t>(1, bucket_count))),
+      bucket_count_(bucket_count) {
+  CHECK_GT(bucket_count, 0);
+  if (stage_count > 0) {
+    GetStage(stage_count - 1);
+  }
+}
+
+StageHistogramProto& StageHistogramAggregator::GetStage(int64_t stage) {
+  CHECK_GE(stage, 0);
+  while (stages_.size() <= stage) {
+    StageHistogramProto& histogram = stages_.emplace_back();
+    histogram.set_stage(stages_.size() - 1);
+    histogram.set_bucket_width_ps(bucket_width_ps_);
+    histogram.mutable_slack_buckets()->Resize(bucket_count_, 0);
+  }
+  return stages_[stage];
+}
+
+void StageHistogramAggregator::Add(int64_t stage, int64_t path_delay_ps,
+                                   int64_t slack_ps) {
+  StageHistogramProto& histogram = GetStage(stage);
+  if (histogram.node_count() == 0) {
+    histogram.set_min_slack_ps(slack_ps);
+  }
+  histogram.set_node_count(histogram.node_count() + 1);
+  histogram.set_max_path_delay_ps(
+      std::max(histogram.max_path_delay_ps(), path_delay_ps));
+  histogram.set_min_slack_ps(std::min(histogram.min_slack_ps(), slack_ps));
+  if (slack_ps < 0) {
+    histogram.set_negative_slack_count(histogram.negative_slack_count() + 1);
+  }
+  int64_t bucket =
+      std::clamp<int64_t>(slack_ps / bucket_width_ps_, 0, bucket_count_ - 1);
+  histogram.set_slack_buckets(bucket, histogram.slack_buckets(bucket) + 1);
+}
+
+std::vector<StageHistogramProto> StageHistogramAggregator::Finish() const {
+  return stages_;
+}
+
+absl::StatusOr<ScheduleColumnsProto> ScheduleToColumns(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    const ScheduleColumnsOptions& options) {
+  XLS_RET_CHECK_GT(options.histogram_bucket_count, 0);
+  FunctionBase* f = schedule.function_base();
+  std::vector<Node*> topo_sort = TopoSort(f);
+  const int64_t node_count = topo_sort.size();
+  absl::flat_hash_map<Node*, int64_t> topo_index;
+  topo_index.reserve(node_count);
+  for (int64_t i = 0; i < node_count; ++i) {
+    topo_index[topo_sort[i]] = i;
+  }
+
+  // Longest path from the start of the node's stage through the end of the
+  // node, and from the end of the node to the end of its stage.
+  std::vector<int64_t> node_delays(node_count);
+  std::vector<int64_t> path_delays(node_count);
+  std::vector<int64_t> remaining_delays(node_count, 0);
+  int64_t max_path_delay = 0;
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* node = topo_sort[i];
+    int64_t delay_to_node_start = 0;
+    for (Node* operand : node->operands()) {
+      if (schedule.cycle(operand) == schedule.cycle(node)) {
+        delay_to_node_start = std::max(delay_to_node_start,
+                                       path_delays[topo_index.at(operand)]);
+      }
+    }
+    XLS_ASSIGN_OR_RETURN(node_delays[i],
+                         delay_estimator.GetOperationDelayInPs(node));
+    path_delays[i] = delay_to_node_start + node_delays[i];
+    max_path_delay = std::max(max_path_delay, path_delays[i]);
+  }
+  for (int64_t i = node_count - 1; i >= 0; --i) {
+    Node* node = topo_sort[i];
+    for (Node* user : node->users()) {
+      if (schedule.cycle(user) == schedule.cycle(node)) {
+        int64_t j = topo_index.at(user);
+        remaining_delays[i] =
+            std::max(remaining_delays[i], node_delays[j] + remaining_delays[j]);
+      }
+    }
+  }
+
+  const int64_t clock_period_ps =
+      options.clock_period_ps.value_or(max_path_delay);
+  ScheduleColumnsProto proto;
+  proto.set_function(f->name());
+  proto.set_clock_period_ps(clock_period_ps);
+  if (options.emit_node_columns) {
+    proto.mutable_node_ids()->Reserve(node_count);
+    proto.mutable_node_names()->Reserve(node_count);
+    proto.mutable_stages()->Reserve(node_count);
+    proto.mutable_node_delays_ps()->Reserve(node_count);
+    proto.mutable_path_delays_ps()->Reserve(node_count);
+    proto.mutable_slacks_ps()->Reserve(node_count);
+  }
+  StageHistogramAggregator aggregator(
+      clock_period_ps, options.histogram_bucket_count, schedule.length());
+  for (int64_t i = 0; i < node_count; ++i) {
+    Node* node = topo_sort[i];
+    int64_t stage = schedule.cycle(node);
+    int64_t slack = clock_period_ps - path_delays[i] - remaining_delays[i];
+    aggregator.Add(stage, path_delays[i], slack);
+    if (options.emit_node_columns) {
+      proto.add_node_ids(node->id());
+      proto.add_node_names(node->GetName());
+      proto.add_stages(stage);
+      proto.add_node_delays_ps(node_delays[i]);
+      proto.add_path_delays_ps(path_delays[i]);
+      proto.add_slacks_ps(slack);
+    }
+  }
+  for (StageHistogramProto& histogram : aggregator.Finish()) {
+    *proto.add_stage_histograms() = std::move(histogram);
+  }
+  return proto;
+}
+
+}  // namespace xls
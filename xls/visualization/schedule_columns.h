@@ -0,0 +1,73 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef XLS_VISUALIZATION_SCHEDULE_COLUMNS_H_
+#define XLS_VISUALIZATION_SCHEDULE_COLUMNS_H_
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "xls/estimators/delay_model/delay_estimator.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/visualization/schedule_columns.pb.h"
+
+namespace xls {
+
+// Accumulates per-stage statistics one node at a time, without retaining the
+// nodes themselves.
+class StageHistogramAggregator {
+ public:
+  // Slack in [0, clock_period_ps] is divided into `bucket_count` buckets.
+  // Histograms are returned for at least `stage_count` stages.
+  StageHistogramAggregator(int64_t clock_period_ps, int64_t bucket_count,
+                           int64_t stage_count = 0);
+
+  void Add(int64_t stage, int64_t path_delay_ps, int64_t slack_ps);
+
+  // Returns the histograms of all stages up to the largest stage added.
+  std::vector<StageHistogramProto> Finish() const;
+
+ private:
+  StageHistogramProto& GetStage(int64_t stage);
+
+  int64_t bucket_width_ps_;
+  int64_t bucket_count_;
+  std::vector<StageHistogramProto> stages_;
+};
+
+struct ScheduleColumnsOptions {
+  // Clock period against which slack is measured. If not given, the longest
+  // path delay of any stage is used.
+  std::optional<int64_t> clock_period_ps;
+
+  // Number of slack buckets in each stage histogram.
+  int64_t histogram_bucket_count = 16;
+
+  // Whether to emit the per-node columns; stage histograms are always emitted.
+  bool emit_node_columns = true;
+};
+
+// Returns the per-node stage, delay and slack of `schedule` as columns,
+// alongside the per-stage histograms. Runs in time linear in the size of the
+// scheduled function.
+absl::StatusOr<ScheduleColumnsProto> ScheduleToColumns(
+    const PipelineSchedule& schedule, const DelayEstimator& delay_estimator,
+    const ScheduleColumnsOptions& options = ScheduleColumnsOptions());
+
+}  // namespace xls
+
+#endif  // XLS_VISUALIZATION_SCHEDULE_COLUMNS_H_
@@ -0,0 +1,155 @@
+// Copyright 2024 The XLS Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "xls/visualization/schedule_columns.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "xls/common/status/matchers.h"
+#include "xls/ir/function.h"
+#include "xls/ir/function_builder.h"
+#include "xls/ir/ir_test_base.h"
+#include "xls/ir/package.h"
+#include "xls/ir/source_location.h"
+#include "xls/scheduling/pipeline_schedule.h"
+#include "xls/visualization/schedule_columns.pb.h"
+
+namespace xls {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+class ScheduleColumnsTest : public IrTestBase {
+ protected:
+  // Builds a two-stage schedule of:
+  //
+  //   stage 0: x, y, a = add(x, y), b = neg(a), d = not(y)
+  //   stage 1: c = add(b, x), tuple(c, d)
+  void BuildSchedule() {
+    package_ = CreatePackage();
+    FunctionBuilder fb(TestName(), package_.get());
+    BValue x = fb.Param("x", package_->GetBitsType(8));
+    BValue y = fb.Param("y", package_->GetBitsType(8));
+    BValue a = fb.Add(x, y, SourceInfo(), "a");
+    BValue b = fb.Negate(a, SourceInfo(), "b");
+    BValue d = fb.Not(y, SourceInfo(), "d");
+    BValue c = fb.Add(b, x, SourceInfo(), "c");
+    BValue tuple = fb.Tuple({c, d}, SourceInfo(), "tuple");
+    XLS_ASSERT_OK_AND_ASSIGN(Function * f, fb.BuildWithReturnValue(tuple));
+    ScheduleCycleMap cycle_map;
+    for (BValue node : {x, y, a, b, d}) {
+      cycle_map[node.node()] = 0;
+    }
+    for (BValue node : {c, tuple}) {
+      cycle_map[node.node()] = 1;
+    }
+    schedule_.emplace(f, cycle_map);
+  }
+
+  // Returns the node name to value mapping of the given column.
+  static absl::flat_hash_map<std::string, int64_t> ByName(
+      const ScheduleColumnsProto& proto,
+      absl::Span<const int64_t> column) {
+    absl::flat_hash_map<std::string, int64_t> result;
+    for (int64_t i = 0; i < proto.node_names_size(); ++i) {
+      result[proto.node_names(i)] = column[i];
+    }
+    return result;
+  }
+
+  std::unique_ptr<Package> package_;
+  std::optional<PipelineSchedule> schedule_;
+};
+
+TEST_F(ScheduleColumnsTest, NodeColumns) {
+  BuildSchedule();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleColumnsProto proto,
+      ScheduleToColumns(*schedule_, TestDelayEstimator(),
+                        {.clock_period_ps = 4, .histogram_bucket_count = 4}));
+  EXPECT_EQ(proto.clock_period_ps(), 4);
+  EXPECT_THAT(proto.node_ids(), SizeIs(7));
+  EXPECT_THAT(proto.stages(), SizeIs(7));
+  EXPECT_THAT(ByName(proto, proto.path_delays_ps()),
+              UnorderedElementsAre(std::pair("x", 0), std::pair("y", 0),
+                                   std::pair("a", 1), std::pair("b", 2),
+                                   std::pair("d", 1), std::pair("c", 1),
+                                   std::pair("tuple", 2)));
+  EXPECT_THAT(ByName(proto, proto.slacks_ps()),
+              UnorderedElementsAre(std::pair("x", 2), std::pair("y", 2),
+                                   std::pair("a", 2), std::pair("b", 2),
+                                   std::pair("d", 3), std::pair("c", 2),
+                                   std::pair("tuple", 2)));
+
+  ASSERT_THAT(proto.stage_histograms(), SizeIs(2));
+  const StageHistogramProto& stage0 = proto.stage_histograms(0);
+  EXPECT_EQ(stage0.node_count(), 5);
+  EXPECT_EQ(stage0.max_path_delay_ps(), 2);
+  EXPECT_EQ(stage0.min_slack_ps(), 2);
+  EXPECT_EQ(stage0.bucket_width_ps(), 1);
+  EXPECT_THAT(stage0.slack_buckets(), ElementsAre(0, 0, 4, 1));
+  const StageHistogramProto& stage1 = proto.stage_histograms(1);
+  EXPECT_EQ(stage1.stage(), 1);
+  EXPECT_EQ(stage1.node_count(), 2);
+  EXPECT_THAT(stage1.slack_buckets(), ElementsAre(0, 0, 2, 0));
+}
+
+TEST_F(ScheduleColumnsTest, HistogramsOnlyDefaultsToLongestStage) {
+  BuildSchedule();
+  XLS_ASSERT_OK_AND_ASSIGN(
+      ScheduleColumnsProto proto,
+      ScheduleToColumns(*schedule_, TestDelayEstimator(),
+                        {.histogram_bucket_count = 2,
+                         .emit_node_columns = false}));
+  EXPECT_EQ(proto.clock_period_ps(), 2);
+  EXPECT_THAT(proto.node_ids(), IsEmpty());
+  EXPECT_THAT(proto.slacks_ps(), IsEmpty());
+  ASSERT_THAT(proto.stage_histograms(), SizeIs(2));
+  EXPECT_EQ(proto.stage_histograms(0).min_slack_ps(), 0);
+  EXPECT_THAT(proto.stage_histograms(0).slack_buckets(), ElementsAre(4, 1));
+}
+
+TEST(StageHistogramAggregatorTest, CountsNegativeSlack) {
+  StageHistogramAggregator aggregator(/*clock_period_ps=*/100,
+                                      /*bucket_count=*/4, /*stage_count=*/3);
+  aggregator.Add(/*stage=*/1, /*path_delay_ps=*/120, /*slack_ps=*/-20);
+  aggregator.Add(/*stage=*/1, /*path_delay_ps=*/30, /*slack_ps=*/70);
+  aggregator.Add(/*stage=*/1, /*path_delay_ps=*/10, /*slack_ps=*/150);
+  std::vector<StageHistogramProto> histograms = aggregator.Finish();
+  ASSERT_THAT(histograms, SizeIs(3));
+  EXPECT_EQ(histograms[0].node_count(), 0);
+  EXPECT_EQ(histograms[1].node_count(), 3);
+  EXPECT_EQ(histograms[1].max_path_delay_ps(), 120);
+  EXPECT_EQ(histograms[1].min_slack_ps(), -20);
+  EXPECT_EQ(histograms[1].negative_slack_count(), 1);
+  EXPECT_EQ(histograms[1].bucket_width_ps(), 25);
+  EXPECT_THAT(histograms[1].slack_buckets(), ElementsAre(1, 0, 1, 1));
+  EXPECT_EQ(histograms[2].stage(), 2);
+}
+
+}  // namespace
+}  // namespace xls